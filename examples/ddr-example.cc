@@ -67,10 +67,8 @@ main(int argc, char* argv[])
     // -------- Create nodes and network stacks ---------------
     NS_LOG_INFO("creating internet stack");
     DDRHelper ddr;
-    Ipv4ListRoutingHelper list;
-    list.Add(ddr, 10);
     InternetStackHelper internet;
-    internet.SetRoutingHelper(list);
+    internet.SetRoutingHelper(ddr);
     internet.Install(nodes);
 
     NS_LOG_INFO("creating ipv4 addresses");
@@ -107,6 +105,7 @@ main(int argc, char* argv[])
         address.NewNetwork();
     }
 
+    DDRHelper::SetDelayMetrics();
     DDRHelper::PopulateRoutingTables();
 
     // -------------------- UDP traffic -----------------
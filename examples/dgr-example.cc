@@ -67,10 +67,8 @@ main(int argc, char* argv[])
     // -------- Create nodes and network stacks ---------------
     NS_LOG_INFO("creating internet stack");
     DGRHelper dgr;
-    Ipv4ListRoutingHelper list;
-    list.Add(dgr, 10);
     InternetStackHelper internet;
-    internet.SetRoutingHelper(list);
+    internet.SetRoutingHelper(dgr);
     internet.Install(nodes);
 
     NS_LOG_INFO("creating ipv4 addresses");
@@ -107,6 +105,7 @@ main(int argc, char* argv[])
         address.NewNetwork();
     }
 
+    DGRHelper::SetDelayMetrics();
     DGRHelper::PopulateRoutingTables();
 
     // -------------------- UDP traffic -----------------
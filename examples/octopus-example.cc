@@ -35,6 +35,7 @@ main(int argc, char* argv[])
     uint16_t udpPort = 9;
     uint32_t nPacket = 10;
     uint32_t packetSize = 1400; // bytes
+    std::string armState;       // file of the learned arms, none by default
 
     // Set up command line parameters used to control the experiment
     CommandLine cmd(__FILE__);
@@ -43,6 +44,9 @@ main(int argc, char* argv[])
     cmd.AddValue("budget", "budget", budget);
     cmd.AddValue("sender", "Node # of sender", sender);
     cmd.AddValue("sink", "Node # of sink", sink);
+    cmd.AddValue("armState",
+                 "File the arms start from if it was saved on this topology, and are saved to",
+                 armState);
 
     cmd.Parse(argc, argv);
 
@@ -66,10 +70,8 @@ main(int argc, char* argv[])
     // -------- Create nodes and network stacks ---------------
     NS_LOG_INFO("creating internet stack");
     OctopusHelper oct;
-    Ipv4ListRoutingHelper list;
-    list.Add(oct, 10);
     InternetStackHelper internet;
-    internet.SetRoutingHelper(list);
+    internet.SetRoutingHelper(oct);
     internet.Install(nodes);
 
     NS_LOG_INFO("creating ipv4 addresses");
@@ -107,6 +109,10 @@ main(int argc, char* argv[])
     }
 
     OctopusHelper::PopulateRoutingTables();
+    if (!armState.empty() && OctopusHelper::LoadArmStates(armState))
+    {
+        std::cout << "Warm start from the arms of " << armState << "\n";
+    }
 
     // -------------------- UDP traffic -----------------
     Ptr<Node> udpSinkNode = nodes.Get(sink);
@@ -164,6 +170,10 @@ main(int argc, char* argv[])
     // -------- Run the simulation --------------------------
     NS_LOG_INFO("Run Simulation.");
     Simulator::Run();
+    if (!armState.empty())
+    {
+        OctopusHelper::SaveArmStates(armState);
+    }
     Simulator::Destroy();
 
     delete[] ipic;
@@ -67,10 +67,8 @@ main(int argc, char* argv[])
     // -------- Create nodes and network stacks ---------------
     NS_LOG_INFO("creating internet stack");
     OSPFHelper ospf;
-    Ipv4ListRoutingHelper list;
-    list.Add(ospf, 10);
     InternetStackHelper internet;
-    internet.SetRoutingHelper(list);
+    internet.SetRoutingHelper(ospf);
     internet.Install(nodes);
 
     NS_LOG_INFO("creating ipv4 addresses");
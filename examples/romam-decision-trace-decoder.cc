@@ -0,0 +1,48 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+//
+// Decode the binary decision traces of the Romam routing protocols, written
+// when the ns3::RomamRouting::DecisionTracePrefix attribute is set, into CSV.
+//
+// Usage:
+//   ./ns3 run "romam-decision-trace-decoder --input=ddr-3.rdt --output=ddr-3.csv"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/romam-module.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("RomamDecisionTraceDecoder");
+
+int
+main(int argc, char* argv[])
+{
+    std::string input;
+    std::string output;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "Decision trace file", input);
+    cmd.AddValue("output", "CSV file, the standard output if empty", output);
+    cmd.Parse(argc, argv);
+    NS_ABORT_MSG_IF(input.empty(), "No decision trace to decode");
+
+    std::ifstream in(input, std::ios::binary);
+    NS_ABORT_MSG_IF(!in, "Cannot read the decision trace " << input);
+    std::ofstream out;
+    if (!output.empty())
+    {
+        out.open(output);
+        NS_ABORT_MSG_IF(!out, "Cannot write " << output);
+    }
+    if (!DecisionTrace::Decode(in, output.empty() ? std::cout : out))
+    {
+        std::cerr << input << " is not a decision trace or is truncated" << std::endl;
+        return 1;
+    }
+    return 0;
+}
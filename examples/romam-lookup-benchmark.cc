@@ -0,0 +1,347 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+//
+// Benchmark of the per-packet route lookup of the Romam routing protocols.
+//
+// For each configuration, the benchmark builds a size x size grid of routers
+// (100Mbps point-to-point links of 1ms, metric 1) or a topology file, installs
+// the protocol with the queue disc of the NSDI2025 experiments, and lets the
+// neighbors exchange their states for the warm-up time, so that the TSDBs and
+// arm values hold real state.  Then, from one event, it drives RouteOutput on
+// the first router to every other router in turn, with packets carrying a
+// RomamMetaTag with a timestamp, a budget drawn in [minBudget, maxBudget] us
+// and the flag, as RomamUdpApplication sends them.
+//
+// The configurations are:
+//   ospf                       OSPFRouting::LookupRoute
+//   dgr                        DGRRouting::LookupDGRRoute
+//   octopus                    OctopusRouting::LookupRoute
+//   ddr-ecmp, ddr-kshort,
+//   ddr-dgr, ddr-ddr           DDRRouting in every route select mode
+//
+// and a CSV line per configuration reports the ns per lookup and the heap
+// allocations per lookup, counted by the global operator new of this program.
+//
+// Usage:
+//   ./ns3 run "romam-lookup-benchmark --size=10 --lookups=1000000 --configs=ddr-ddr,ospf"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/romam-module.h"
+#include "ns3/topology-read-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("RomamLookupBenchmark");
+
+/// heap allocations of the process
+static std::atomic<uint64_t> g_allocations(0);
+
+void*
+operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/// the parameters of the lookups
+struct LookupParameters
+{
+    uint64_t lookups;   //!< number of lookups
+    uint32_t minBudget; //!< smallest budget, in us
+    uint32_t maxBudget; //!< largest budget, in us
+};
+
+/// the measures of one configuration
+struct LookupResult
+{
+    uint32_t nodes;         //!< routers of the topology
+    uint64_t lookups;       //!< lookups done
+    uint64_t failed;        //!< lookups without a route
+    double nsPerLookup;     //!< mean time of a lookup
+    double allocsPerLookup; //!< mean heap allocations of a lookup
+};
+
+/**
+ * \param items a comma separated list
+ * \return the items
+ */
+static std::vector<std::string>
+SplitList(const std::string& items)
+{
+    std::vector<std::string> list;
+    std::istringstream stream(items);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (!item.empty())
+        {
+            list.push_back(item);
+        }
+    }
+    return list;
+}
+
+/**
+ * \brief Drive the lookups of the first node to all the others.
+ * \param nodes the routers
+ * \param parameters the parameters of the lookups
+ * \param result filled with the measures
+ */
+static void
+RunLookups(NodeContainer nodes, LookupParameters parameters, LookupResult* result)
+{
+    Ptr<RomamRouting> routing = nodes.Get(0)->GetObject<RomamRouter>()->GetRoutingProtocol();
+    std::vector<Ipv4Address> destinations;
+    for (uint32_t i = 1; i < nodes.GetN(); i++)
+    {
+        destinations.push_back(nodes.Get(i)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal());
+    }
+    Ptr<UniformRandomVariable> budgets = CreateObject<UniformRandomVariable>();
+    std::vector<Ptr<Packet>> packets;
+    for (uint32_t i = 0; i < 1024; i++)
+    {
+        Ptr<Packet> packet = Create<Packet>(512);
+        RomamMetaTag metaTag;
+        metaTag.SetTimestamp(Simulator::Now());
+        metaTag.SetBudget(budgets->GetInteger(parameters.minBudget, parameters.maxBudget));
+        metaTag.SetFlag(true);
+        packet->AddPacketTag(metaTag);
+        packets.push_back(packet);
+    }
+    Ipv4Header header;
+    header.SetProtocol(17);
+    Socket::SocketErrno sockerr;
+
+    uint64_t failed = 0;
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < parameters.lookups; i++)
+    {
+        header.SetDestination(destinations[i % destinations.size()]);
+        if (!routing->RouteOutput(packets[i % packets.size()], header, nullptr, sockerr))
+        {
+            failed++;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+
+    result->nodes = nodes.GetN();
+    result->lookups = parameters.lookups;
+    result->failed = failed;
+    result->nsPerLookup =
+        std::chrono::duration<double, std::nano>(end - start).count() / parameters.lookups;
+    result->allocsPerLookup = static_cast<double>(allocations) / parameters.lookups;
+}
+
+/**
+ * \brief Build the network, warm it up and measure the lookups.
+ * \param config the configuration
+ * \param topo the topology file, or empty for the grid
+ * \param size the side of the grid
+ * \param warmup the time the neighbors exchange their states before the lookups
+ * \param parameters the parameters of the lookups
+ * \param result filled with the measures
+ * \return false if the topology cannot be read
+ */
+static bool
+RunConfig(const std::string& config,
+          const std::string& topo,
+          uint32_t size,
+          Time warmup,
+          LookupParameters parameters,
+          LookupResult& result)
+{
+    static const std::map<std::string, std::string> modes = {{"ddr-ecmp", "ECMP"},
+                                                             {"ddr-kshort", "KSHORT"},
+                                                             {"ddr-dgr", "DGR"},
+                                                             {"ddr-ddr", "DDR"}};
+    std::string protocol = config.substr(0, config.find('-'));
+    NS_ABORT_MSG_IF(protocol != "ospf" && protocol != "dgr" && protocol != "octopus" &&
+                        modes.find(config) == modes.end(),
+                    "Unknown configuration " << config);
+    if (protocol == "ddr")
+    {
+        Config::SetDefault("ns3::DDRRouting::RouteSelectMode", StringValue(modes.at(config)));
+    }
+    Config::SetGlobal("RomamKShortestPaths", UintegerValue(config == "ddr-kshort" ? 3 : 0));
+
+    NodeContainer nodes;
+    std::vector<std::pair<uint32_t, uint32_t>> links;
+    std::vector<std::string> delays;
+    if (topo.empty())
+    {
+        nodes.Create(size * size);
+        for (uint32_t r = 0; r < size; r++)
+        {
+            for (uint32_t c = 0; c < size; c++)
+            {
+                if (c + 1 < size)
+                {
+                    links.emplace_back(r * size + c, r * size + c + 1);
+                }
+                if (r + 1 < size)
+                {
+                    links.emplace_back(r * size + c, (r + 1) * size + c);
+                }
+            }
+        }
+        delays.assign(links.size(), "1");
+    }
+    else
+    {
+        TopologyReaderHelper topoHelp;
+        topoHelp.SetFileName(topo);
+        topoHelp.SetFileType("Inet");
+        Ptr<TopologyReader> inFile = topoHelp.GetTopologyReader();
+        nodes = inFile->Read();
+        if (inFile->LinksSize() == 0)
+        {
+            Simulator::Destroy();
+            return false;
+        }
+        for (auto iter = inFile->LinksBegin(); iter != inFile->LinksEnd(); iter++)
+        {
+            links.emplace_back(iter->GetFromNode()->GetId(), iter->GetToNode()->GetId());
+            delays.push_back(iter->GetAttribute("Weight"));
+        }
+    }
+
+    Ipv4ListRoutingHelper list;
+    OSPFHelper ospf;
+    DGRHelper dgr;
+    OctopusHelper octopus;
+    DDRHelper ddr;
+    TrafficControlHelper tch;
+    if (protocol == "ospf")
+    {
+        list.Add(ospf, 10);
+    }
+    else if (protocol == "dgr")
+    {
+        list.Add(dgr, 10);
+        tch.SetRootQueueDisc("ns3::DGRQueueDisc");
+    }
+    else if (protocol == "octopus")
+    {
+        list.Add(octopus, 10);
+        tch.SetRootQueueDisc("ns3::DDRQueueDisc");
+    }
+    else
+    {
+        list.Add(ddr, 10);
+        tch.SetRootQueueDisc("ns3::DDRQueueDisc");
+    }
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(list);
+    internet.Install(nodes);
+
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.252");
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+    for (std::size_t i = 0; i < links.size(); i++)
+    {
+        p2p.SetChannelAttribute("Delay", StringValue(delays[i] + "ms"));
+        NetDeviceContainer devices = p2p.Install(nodes.Get(links[i].first),
+                                                 nodes.Get(links[i].second));
+        if (protocol != "ospf")
+        {
+            tch.Install(devices);
+        }
+        Ipv4InterfaceContainer interfaces = address.Assign(devices);
+        interfaces.SetMetric(0, std::stoul(delays[i]));
+        interfaces.SetMetric(1, std::stoul(delays[i]));
+        address.NewNetwork();
+    }
+
+    if (protocol == "ospf")
+    {
+        OSPFHelper::PopulateRoutingTables();
+    }
+    else if (protocol == "dgr")
+    {
+        DGRHelper::PopulateRoutingTables();
+    }
+    else if (protocol == "octopus")
+    {
+        OctopusHelper::PopulateRoutingTables();
+    }
+    else
+    {
+        DDRHelper::PopulateRoutingTables();
+    }
+
+    Simulator::Schedule(warmup, &RunLookups, nodes, parameters, &result);
+    Simulator::Stop(warmup);
+    Simulator::Run();
+    Simulator::Destroy();
+    return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string configs("ospf,dgr,octopus,ddr-ecmp,ddr-kshort,ddr-dgr,ddr-ddr");
+    std::string topo;
+    uint32_t size = 8;
+    double warmup = 1.0;
+    LookupParameters parameters = {1000000, 10000, 100000};
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("configs", "Comma separated protocols and route select modes", configs);
+    cmd.AddValue("topo", "Inet topology file, instead of the grid", topo);
+    cmd.AddValue("size", "Side of the grid of routers", size);
+    cmd.AddValue("warmup", "Seconds of state exchanges before the lookups", warmup);
+    cmd.AddValue("lookups", "Lookups per configuration", parameters.lookups);
+    cmd.AddValue("minBudget", "Smallest budget of the packets, in us", parameters.minBudget);
+    cmd.AddValue("maxBudget", "Largest budget of the packets, in us", parameters.maxBudget);
+    cmd.Parse(argc, argv);
+    NS_ABORT_MSG_IF(parameters.lookups == 0, "No lookup to measure");
+
+    std::cout << "config,nodes,lookups,failed,ns_per_lookup,allocs_per_lookup\n";
+    for (const std::string& config : SplitList(configs))
+    {
+        LookupResult r = {};
+        if (!RunConfig(config, topo, size, Seconds(warmup), parameters, r))
+        {
+            NS_LOG_ERROR("Cannot read the topology " << topo);
+            return 1;
+        }
+        std::cout << config << ',' << r.nodes << ',' << r.lookups << ',' << r.failed << ','
+                  << r.nsPerLookup << ',' << r.allocsPerLookup << std::endl;
+    }
+    return 0;
+}
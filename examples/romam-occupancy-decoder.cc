@@ -0,0 +1,58 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+//
+// Decode the binary occupancy series of the DDR and DGR queue discs, written
+// when the RomamOccupancyInterval global value is set, into CSV.  With
+// --links, decode the link samples LinkStatsHelper::Write () wrote instead.
+//
+// Usage:
+//   ./ns3 run "romam-occupancy-decoder --input=romam-occupancy.bin --output=occupancy.csv"
+//   ./ns3 run "romam-occupancy-decoder --links --input=links.bin --output=links.csv"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/romam-module.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("RomamOccupancyDecoder");
+
+int
+main(int argc, char* argv[])
+{
+    std::string input;
+    std::string output;
+    bool links = false;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "Occupancy series file", input);
+    cmd.AddValue("links", "Decode a file of link samples", links);
+    cmd.AddValue("output", "CSV file, the standard output if empty", output);
+    cmd.Parse(argc, argv);
+    NS_ABORT_MSG_IF(input.empty(), "No occupancy series to decode");
+
+    std::ifstream in(input, std::ios::binary);
+    NS_ABORT_MSG_IF(!in, "Cannot read the occupancy series " << input);
+    std::ofstream out;
+    if (!output.empty())
+    {
+        out.open(output);
+        NS_ABORT_MSG_IF(!out, "Cannot write " << output);
+    }
+    std::ostream& os = output.empty() ? std::cout : out;
+    if (links && !LinkStatsHelper::Decode(in, os))
+    {
+        std::cerr << input << " is not a file of link samples or is truncated" << std::endl;
+        return 1;
+    }
+    if (!links && !OccupancySampler::Decode(in, os))
+    {
+        std::cerr << input << " is not a file of occupancy series or is truncated" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,250 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+//
+// Benchmark of the route computations of the Romam routing framework.
+//
+// For each topology file of topoDir and each engine, the benchmark builds the
+// network of the NSDI2025 experiments (100Mbps point-to-point links whose
+// metric is the Weight of the topology), then times separately:
+//
+//  - RouteManager::BuildLSDB ()
+//  - the route installation of the engine:
+//      dijkstra  RouteManager::InitializeDijkstraRoutes (), on OSPFRouting nodes
+//      spf       RouteManager::InitializeSPFRoutes (), on DDRRouting nodes
+//      ksp       RouteManager::InitializeKShortestPaths (), on DDRRouting nodes,
+//                with RomamKShortestPaths set to k
+//
+// and reports, one CSV line per run, the wall and CPU seconds of both steps,
+// the routes installed, the bytes the route engines keep, the bytes of the
+// k shortest path tables, the routing state of all the nodes and the LSDB,
+// and the peak RSS of the process.  The peak RSS only
+// grows, so it is the peak of all the runs done so far in the process: run one
+// topology and one engine per process to compare them.
+//
+// Usage:
+//   ./ns3 run "romam-route-benchmark --topos=abilene,att --engines=spf --repeat=5
+//              --output=route-benchmark.csv"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/romam-module.h"
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("RomamRouteBenchmark");
+
+/// the measures of one run
+struct BenchmarkResult
+{
+    uint32_t nodes;          //!< nodes of the topology
+    uint32_t links;          //!< links of the topology
+    double buildLsdbSeconds; //!< wall time of BuildLSDB ()
+    double buildLsdbCpu;     //!< CPU time of BuildLSDB ()
+    double installSeconds;   //!< wall time of the route installation
+    double installCpu;       //!< CPU time of the route installation
+    uint64_t routes;         //!< routes in the tables of all the nodes
+    uint64_t engineBytes;    //!< bytes the route engines keep
+    uint64_t kspTableBytes;  //!< bytes of the k shortest path tables
+    uint64_t routingBytes;   //!< bytes of the routing state of all the nodes
+    uint64_t lsdbBytes;      //!< bytes of the LSDB
+    long peakRssKb;          //!< peak resident set size of the process
+};
+
+/**
+ * \param items a comma separated list
+ * \return the items
+ */
+static std::vector<std::string>
+SplitList(const std::string& items)
+{
+    std::vector<std::string> list;
+    std::istringstream stream(items);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (!item.empty())
+        {
+            list.push_back(item);
+        }
+    }
+    return list;
+}
+
+/**
+ * \brief Build the network of a topology, compute its routes and destroy it.
+ * \param path the topology file, in the Inet format
+ * \param engine dijkstra, spf or ksp
+ * \param k the number of paths of the ksp engine
+ * \param result filled with the measures
+ * \return false if the topology cannot be read
+ */
+static bool
+RunBenchmark(const std::string& path,
+             const std::string& engine,
+             uint32_t k,
+             BenchmarkResult& result)
+{
+    RomamTopologyHelper topology;
+    if (!topology.Read(path))
+    {
+        return false;
+    }
+    NodeContainer nodes = topology.CreateNodes();
+
+    Ipv4ListRoutingHelper list;
+    OSPFHelper ospf;
+    DDRHelper ddr;
+    if (engine == "dijkstra")
+    {
+        list.Add(ospf, 10);
+    }
+    else
+    {
+        list.Add(ddr, 10);
+    }
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(list);
+    internet.Install(nodes);
+
+    topology.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+    topology.Install(nodes);
+    Config::SetGlobal("RomamKShortestPaths", UintegerValue(engine == "ksp" ? k : 0));
+
+    RouteManager::DeleteRoutes();
+    auto wall0 = std::chrono::steady_clock::now();
+    std::clock_t cpu0 = std::clock();
+    RouteManager::BuildLSDB();
+    auto wall1 = std::chrono::steady_clock::now();
+    std::clock_t cpu1 = std::clock();
+    if (engine == "dijkstra")
+    {
+        RouteManager::InitializeDijkstraRoutes();
+    }
+    else if (engine == "spf")
+    {
+        RouteManager::InitializeSPFRoutes();
+    }
+    else
+    {
+        RouteManager::InitializeKShortestPaths();
+    }
+    auto wall2 = std::chrono::steady_clock::now();
+    std::clock_t cpu2 = std::clock();
+
+    result.nodes = nodes.GetN();
+    result.links = topology.GetLinks().size();
+    result.buildLsdbSeconds = std::chrono::duration<double>(wall1 - wall0).count();
+    result.buildLsdbCpu = static_cast<double>(cpu1 - cpu0) / CLOCKS_PER_SEC;
+    result.installSeconds = std::chrono::duration<double>(wall2 - wall1).count();
+    result.installCpu = static_cast<double>(cpu2 - cpu1) / CLOCKS_PER_SEC;
+    result.engineBytes = RouteManager::GetRouteEngineMemoryUsage();
+    result.routingBytes = RouteManager::GetRoutingMemoryFootprint();
+    result.lsdbBytes = RouteManager::GetLSDBMemoryFootprint();
+    result.routes = 0;
+    result.kspTableBytes = 0;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<RomamRouter> router = nodes.Get(i)->GetObject<RomamRouter>();
+        if (!router)
+        {
+            continue;
+        }
+        Ptr<RomamRouting> routing = router->GetRoutingProtocol();
+        result.routes += routing->GetNRoutes();
+        Ptr<DDRRouting> ddrRouting = DynamicCast<DDRRouting>(routing);
+        if (ddrRouting)
+        {
+            result.kspTableBytes += ddrRouting->GetKShortestPathTable().GetMemoryUsage();
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.peakRssKb = usage.ru_maxrss;
+
+    Simulator::Destroy();
+    return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string topoDir("contrib/romam/topo");
+    std::string topos;
+    std::string engines("dijkstra,spf,ksp");
+    uint32_t repeat = 3;
+    uint32_t k = 3;
+    std::string output;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("topoDir", "Directory of the Inet_<name>_topo.txt files", topoDir);
+    cmd.AddValue("topos", "Comma separated topology names, all the files if empty", topos);
+    cmd.AddValue("engines", "Comma separated engines among dijkstra, spf and ksp", engines);
+    cmd.AddValue("repeat", "Runs of every topology and engine", repeat);
+    cmd.AddValue("k", "Paths per pair of routers of the ksp engine", k);
+    cmd.AddValue("output", "CSV file of the results, standard output if empty", output);
+    cmd.Parse(argc, argv);
+
+    std::vector<std::string> paths;
+    if (topos.empty())
+    {
+        for (const std::string& file : SystemPath::ReadFiles(topoDir))
+        {
+            if (file.rfind("Inet_", 0) == 0 && file.find("_topo") != std::string::npos)
+            {
+                paths.push_back(SystemPath::Append(topoDir, file));
+            }
+        }
+    }
+    else
+    {
+        for (const std::string& name : SplitList(topos))
+        {
+            paths.push_back(SystemPath::Append(topoDir, "Inet_" + name + "_topo.txt"));
+        }
+    }
+
+    std::ofstream file;
+    if (!output.empty())
+    {
+        file.open(output);
+        NS_ABORT_MSG_IF(!file, "Cannot write " << output);
+    }
+    std::ostream& os = output.empty() ? std::cout : file;
+    os << "topology,engine,run,nodes,links,build_lsdb_s,build_lsdb_cpu_s,install_s,"
+          "install_cpu_s,routes,engine_bytes,ksp_table_bytes,routing_bytes,lsdb_bytes,"
+          "peak_rss_kb\n";
+    for (const std::string& path : paths)
+    {
+        for (const std::string& engine : SplitList(engines))
+        {
+            NS_ABORT_MSG_IF(engine != "dijkstra" && engine != "spf" && engine != "ksp",
+                            "Unknown engine " << engine);
+            for (uint32_t run = 0; run < repeat; run++)
+            {
+                BenchmarkResult r;
+                if (!RunBenchmark(path, engine, k, r))
+                {
+                    NS_LOG_ERROR("Cannot read the topology " << path);
+                    break;
+                }
+                os << SystemPath::Split(path).back() << ',' << engine << ',' << run << ','
+                   << r.nodes << ',' << r.links << ',' << r.buildLsdbSeconds << ','
+                   << r.buildLsdbCpu << ',' << r.installSeconds << ',' << r.installCpu << ','
+                   << r.routes << ',' << r.engineBytes << ',' << r.kspTableBytes << ','
+                   << r.routingBytes << ',' << r.lsdbBytes << ',' << r.peakRssKb << std::endl;
+            }
+        }
+    }
+    return 0;
+}
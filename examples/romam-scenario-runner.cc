@@ -0,0 +1,548 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+//
+// Runs the scenarios of the NSDI2025 experiments back to back in one process.
+//
+// The mains of NSDI2025/exp*/code differ in the routing protocol, the budget,
+// the sender, the sink and the seed only.  This runner reads the topology
+// once, then for each scenario builds the network of the experiments
+// (100Mbps point-to-point links whose delay is the Weight of the topology),
+// sends nPacket packets of packetSize bytes at rate from the sender to a
+// RomamSink on the sink, runs the simulation and destroys it.
+//
+// The runs share what does not depend on the scenario: the LSDB is built by
+// the first run and read from lsdbFile by the later ones
+// (RomamLSDBCacheFile), and the tables of the first run of each route engine
+// are installed again by the later runs instead of being computed
+// (RomamRouteTableCache).
+//
+// A scenario is "protocol budget sender sink seed", one per line of the
+// scenarios file ('#' starts a comment) or one per ';' separated item of
+// --scenarios, the protocol being:
+//
+//   ospf       OSPFRouting, on Dijkstra routes
+//   dgr        DGRRouting with DGRQueueDiscs
+//   octopus    OctopusRouting with DDRQueueDiscs
+//   ddr:MODE   DDRRouting with DDRQueueDiscs, MODE being the RouteSelectMode,
+//              such as ECMP, KSHORT, DGR or DDR (kshortest.cc is ddr:KSHORT)
+//
+// and the budget in microseconds.  One CSV line per scenario, in the order of
+// the scenarios, reports the bytes the sink received, the summary of the
+// delay histogram of the sink, the failure batches and the wall seconds of
+// their route recomputes, and the wall seconds of the setup and the run.
+//
+// With --linkFailureRate or --nodeFailureRate, random links or nodes fail
+// while the sender runs, for failureDuration each, through a
+// FailureScenarioHelper: the failures and repairs of the same time cost one
+// route recompute.
+//
+// With --loopbacks, every router has a loopback /32 the sink is reached at,
+// and the links are unnumbered for the route computations, so the tables hold
+// a route per router instead of one per link end.
+//
+// With --workers=N, a prepare step first builds the LSDB file and the tables of
+// the route engines the scenarios use, then N forked workers run every Nth
+// scenario each.  The workers share the tables of the prepare step copy on
+// write, map the LSDB file read only, and write their lines to
+// <output>.worker<i>, which are merged into the output once all are done.
+//
+// Usage:
+//   ./ns3 run "romam-scenario-runner --topo=abilene
+//              --scenarios='ddr:DDR 20000 0 10 1;ospf 20000 0 10 1'
+//              --output=scenarios.csv"
+//   ./ns3 run "romam-scenario-runner --topo=att --scenarioFile=sweep.txt --workers=32
+//              --output=sweep.csv"
+//
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/romam-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("RomamScenarioRunner");
+
+/// a run of the experiments
+struct Scenario
+{
+    std::string protocol; //!< routing protocol, see the protocols above
+    uint32_t budget;      //!< delay budget of the packets, in microseconds
+    uint32_t sender;      //!< node of the sender
+    uint32_t sink;        //!< node of the sink
+    uint32_t seed;        //!< seed of the random number generators
+};
+
+/// the traffic and the failures of every scenario
+struct Traffic
+{
+    uint32_t packetSize;    //!< bytes of a packet
+    uint32_t nPacket;       //!< packets sent
+    DataRate rate;          //!< rate of the sender
+    Time start;             //!< start of the sender
+    Time stop;              //!< stop of the sender
+    Time end;               //!< end of the simulation
+    double linkFailureRate; //!< random link failures per second, while the sender runs
+    double nodeFailureRate; //!< random node failures per second, while the sender runs
+    Time failureDuration;   //!< how long a failure lasts
+};
+
+/**
+ * \brief Parse the scenarios of a list.
+ * \param is the scenarios, one per line
+ * \param scenarios the scenarios are appended to it
+ * \return false if a line is not a scenario
+ */
+static bool
+ParseScenarios(std::istream& is, std::vector<Scenario>& scenarios)
+{
+    std::string line;
+    while (std::getline(is, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        Scenario scenario;
+        if (!(fields >> scenario.protocol))
+        {
+            continue;
+        }
+        if (!(fields >> scenario.budget >> scenario.sender >> scenario.sink >> scenario.seed) ||
+            scenario.seed == 0)
+        {
+            std::cerr << "Bad scenario: " << line << std::endl;
+            return false;
+        }
+        scenarios.push_back(scenario);
+    }
+    return true;
+}
+
+/**
+ * \brief Split the protocol of a scenario.
+ * \param name the protocol of the scenario
+ * \param protocol set to ospf, dgr, octopus or ddr
+ * \param mode set to the RouteSelectMode of ddr, empty for the others
+ * \return false if the protocol is unknown
+ */
+static bool
+ParseProtocol(const std::string& name, std::string& protocol, std::string& mode)
+{
+    protocol = name;
+    mode.clear();
+    if (protocol.compare(0, 4, "ddr:") == 0)
+    {
+        mode = protocol.substr(4);
+        protocol = "ddr";
+    }
+    if (protocol != "ospf" && protocol != "dgr" && protocol != "octopus" &&
+        (protocol != "ddr" || mode.empty()))
+    {
+        std::cerr << "Unknown protocol " << name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Build the network of the experiments with a routing protocol, and
+ * install its routes.
+ * \param topology the topology, read once
+ * \param protocol ospf, dgr, octopus or ddr
+ * \param mode the RouteSelectMode of ddr
+ * \return the nodes, node i of the container being node i of the topology
+ */
+static NodeContainer
+BuildNetwork(RomamTopologyHelper& topology, const std::string& protocol, const std::string& mode)
+{
+    if (protocol == "ddr")
+    {
+        // the defaults outlive the simulation, the next ddr run sets its own
+        Config::SetDefault("ns3::DDRRouting::RouteSelectMode", StringValue(mode));
+    }
+    NodeContainer nodes = topology.CreateNodes();
+    OSPFHelper ospf;
+    DGRHelper dgr;
+    OctopusHelper octopus;
+    DDRHelper ddr;
+    const Ipv4RoutingHelper* routing = &ddr;
+    TrafficControlHelper tch;
+    if (protocol == "ospf")
+    {
+        // the queue discs Ipv4AddressHelper installs in ospf.cc
+        routing = &ospf;
+        tch = TrafficControlHelper::Default();
+    }
+    else if (protocol == "dgr")
+    {
+        routing = &dgr;
+        tch.SetRootQueueDisc("ns3::DGRQueueDisc");
+    }
+    else if (protocol == "octopus")
+    {
+        routing = &octopus;
+        tch.SetRootQueueDisc("ns3::DDRQueueDisc");
+    }
+    else
+    {
+        tch.SetRootQueueDisc("ns3::DDRQueueDisc");
+    }
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(*routing);
+    internet.Install(nodes);
+    topology.SetTrafficControl(tch);
+    topology.Install(nodes);
+
+    if (protocol == "ospf")
+    {
+        OSPFHelper::PopulateRoutingTables();
+    }
+    else if (protocol == "dgr")
+    {
+        DGRHelper::PopulateRoutingTables();
+    }
+    else if (protocol == "octopus")
+    {
+        OctopusHelper::PopulateRoutingTables();
+    }
+    else
+    {
+        DDRHelper::PopulateRoutingTables();
+    }
+    return nodes;
+}
+
+/**
+ * \brief Build the network of a scenario, run it and destroy it.
+ * \param topology the topology, read once
+ * \param scenario the scenario
+ * \param traffic the traffic of the sender
+ * \param os the CSV line of the run is written to it
+ * \return false if the scenario cannot run on the topology
+ */
+static bool
+RunScenario(RomamTopologyHelper& topology,
+            const Scenario& scenario,
+            const Traffic& traffic,
+            std::ostream& os)
+{
+    std::string protocol;
+    std::string mode;
+    if (!ParseProtocol(scenario.protocol, protocol, mode))
+    {
+        return false;
+    }
+    if (scenario.sender >= topology.GetNNodes() || scenario.sink >= topology.GetNNodes())
+    {
+        std::cerr << "No node " << std::max(scenario.sender, scenario.sink) << std::endl;
+        return false;
+    }
+
+    auto wall0 = std::chrono::steady_clock::now();
+    RngSeedManager::SetSeed(scenario.seed);
+    NodeContainer nodes = BuildNetwork(topology, protocol, mode);
+
+    uint16_t port = 9;
+    Ptr<Ipv4> sinkIpv4 = nodes.Get(scenario.sink)->GetObject<Ipv4>();
+    Ipv4Address sinkAddress = RomamRouter::GetNodeAddress(sinkIpv4);
+    RomamSinkHelper sinkHelper("ns3::UdpSocketFactory",
+                               InetSocketAddress(Ipv4Address::GetAny(), port));
+    ApplicationContainer sinkApp = sinkHelper.Install(nodes.Get(scenario.sink));
+    sinkApp.Start(Seconds(0));
+    sinkApp.Stop(traffic.end);
+
+    Ptr<Node> senderNode = nodes.Get(scenario.sender);
+    Ptr<Socket> socket = Socket::CreateSocket(senderNode, UdpSocketFactory::GetTypeId());
+    Ptr<RomamUdpApplication> app = CreateObject<RomamUdpApplication>();
+    app->Setup(socket,
+               InetSocketAddress(sinkAddress, port),
+               traffic.packetSize,
+               traffic.nPacket,
+               traffic.rate,
+               scenario.budget,
+               true);
+    senderNode->AddApplication(app);
+    app->SetStartTime(traffic.start);
+    app->SetStopTime(traffic.stop);
+
+    FailureScenarioHelper failures;
+    Ptr<ConstantRandomVariable> duration = CreateObject<ConstantRandomVariable>();
+    duration->SetAttribute("Constant", DoubleValue(traffic.failureDuration.GetSeconds()));
+    if (traffic.linkFailureRate > 0)
+    {
+        failures.GenerateFailures(FailureScenarioHelper::LINK_FAILURE,
+                                  traffic.linkFailureRate,
+                                  traffic.start,
+                                  traffic.stop,
+                                  duration);
+    }
+    if (traffic.nodeFailureRate > 0)
+    {
+        failures.GenerateFailures(FailureScenarioHelper::NODE_FAILURE,
+                                  traffic.nodeFailureRate,
+                                  traffic.start,
+                                  traffic.stop,
+                                  duration);
+    }
+    failures.Install(nodes);
+
+    auto wall1 = std::chrono::steady_clock::now();
+    Simulator::Stop(traffic.end);
+    Simulator::Run();
+    Ptr<RomamSink> sink = DynamicCast<RomamSink>(sinkApp.Get(0));
+    uint64_t rxBytes = sink->GetTotalRx();
+    const RomamSink::FlowDelays& delays = sink->GetDelays();
+    os << scenario.protocol << ',' << scenario.budget << ',' << scenario.sender << ','
+       << scenario.sink << ',' << scenario.seed << ',' << rxBytes << ','
+       << delays.histogram.GetCount() << ',' << delays.budgeted << ',' << delays.deadlineMet
+       << ',' << delays.histogram.GetMean().GetMicroSeconds() << ','
+       << delays.histogram.GetPercentile(99).GetMicroSeconds() << ','
+       << delays.histogram.GetMax().GetMicroSeconds() << ',' << failures.GetBatches().size()
+       << ',' << failures.GetRecomputes() << ',' << failures.GetRecomputeSeconds() << ',';
+    Simulator::Destroy();
+    auto wall2 = std::chrono::steady_clock::now();
+    os << std::chrono::duration<double>(wall1 - wall0).count() << ','
+       << std::chrono::duration<double>(wall2 - wall1).count() << std::endl;
+    return true;
+}
+
+/**
+ * \brief Build the LSDB file and the tables of the route engines the
+ * scenarios use, so the workers forked next all start from them.
+ * \param topology the topology, read once
+ * \param scenarios the scenarios
+ * \return false if a protocol is unknown
+ */
+static bool
+PrepareRoutes(RomamTopologyHelper& topology, const std::vector<Scenario>& scenarios)
+{
+    // ospf runs on the Dijkstra engine, the others share the SPF forest
+    bool dijkstra = false;
+    bool spf = false;
+    for (auto i = scenarios.begin(); i != scenarios.end(); i++)
+    {
+        std::string protocol;
+        std::string mode;
+        if (!ParseProtocol(i->protocol, protocol, mode))
+        {
+            return false;
+        }
+        bool& prepared = protocol == "ospf" ? dijkstra : spf;
+        if (!prepared)
+        {
+            BuildNetwork(topology, protocol, mode);
+            Simulator::Destroy();
+            prepared = true;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Run the scenarios on forked workers, and merge their lines.
+ * \param topology the topology, read once
+ * \param scenarios the scenarios, worker i running scenarios i, i + nWorkers...
+ * \param traffic the traffic of the sender
+ * \param nWorkers the number of workers
+ * \param base the lines of worker i go to base.worker<i>
+ * \param os the lines of all the scenarios are written to it, in their order
+ * \return false if a worker failed
+ */
+static bool
+RunWorkers(RomamTopologyHelper& topology,
+           const std::vector<Scenario>& scenarios,
+           const Traffic& traffic,
+           uint32_t nWorkers,
+           const std::string& base,
+           std::ostream& os)
+{
+    // the buffered output would be written again by every worker
+    os.flush();
+    std::cout.flush();
+    std::vector<pid_t> workers;
+    for (uint32_t w = 0; w < nWorkers; w++)
+    {
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            std::cerr << "Cannot fork worker " << w << std::endl;
+            break;
+        }
+        if (pid == 0)
+        {
+            std::ofstream part(base + ".worker" + std::to_string(w));
+            for (uint32_t i = w; i < scenarios.size(); i += nWorkers)
+            {
+                if (!RunScenario(topology, scenarios[i], traffic, part))
+                {
+                    _exit(1);
+                }
+            }
+            part.close();
+            _exit(part ? 0 : 1);
+        }
+        workers.push_back(pid);
+    }
+    bool ok = workers.size() == nWorkers;
+    for (auto i = workers.begin(); i != workers.end(); i++)
+    {
+        int status;
+        ok = waitpid(*i, &status, 0) == *i && WIFEXITED(status) && WEXITSTATUS(status) == 0 && ok;
+    }
+    // line j of worker w is the line of scenario w + j * nWorkers
+    std::vector<std::string> lines(scenarios.size());
+    for (uint32_t w = 0; w < nWorkers; w++)
+    {
+        std::string path = base + ".worker" + std::to_string(w);
+        std::ifstream part(path);
+        for (uint32_t i = w; ok && i < scenarios.size(); i += nWorkers)
+        {
+            ok = bool(std::getline(part, lines[i]));
+        }
+        part.close();
+        // the parts of the workers that failed, or never started, go too
+        std::remove(path.c_str());
+    }
+    if (!ok)
+    {
+        return false;
+    }
+    for (auto i = lines.begin(); i != lines.end(); i++)
+    {
+        os << *i << '\n';
+    }
+    os.flush();
+    return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string topo("abilene");
+    std::string topoDir("contrib/romam/topo");
+    std::string scenarioFile;
+    std::string scenarioList;
+    std::string lsdbFile("romam-scenario-runner.lsdb");
+    std::string output;
+    uint32_t nWorkers = 1;
+    bool loopbacks = false;
+    Traffic traffic = {1400,
+                       10,
+                       DataRate("10Mbps"),
+                       Seconds(1),
+                       Seconds(3),
+                       Seconds(11),
+                       0,
+                       0,
+                       Seconds(1)};
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("topo", "Topology, read from topoDir/Inet_<topo>_topo.txt", topo);
+    cmd.AddValue("topoDir", "Directory of the topologies", topoDir);
+    cmd.AddValue("scenarioFile", "File of the scenarios, one per line", scenarioFile);
+    cmd.AddValue("scenarios", "Scenarios separated by ';'", scenarioList);
+    cmd.AddValue("lsdbFile", "File the runs share the LSDB through", lsdbFile);
+    cmd.AddValue("packetSize", "Bytes of a packet", traffic.packetSize);
+    cmd.AddValue("nPacket", "Packets sent in a scenario", traffic.nPacket);
+    cmd.AddValue("rate", "Rate of the sender", traffic.rate);
+    cmd.AddValue("start", "Start of the sender", traffic.start);
+    cmd.AddValue("stop", "Stop of the sender", traffic.stop);
+    cmd.AddValue("end", "End of a simulation", traffic.end);
+    cmd.AddValue("linkFailureRate", "Random link failures per second", traffic.linkFailureRate);
+    cmd.AddValue("nodeFailureRate", "Random node failures per second", traffic.nodeFailureRate);
+    cmd.AddValue("failureDuration", "How long a failure lasts", traffic.failureDuration);
+    cmd.AddValue("loopbacks", "Reach the routers at loopbacks from 192.168.0.0", loopbacks);
+    cmd.AddValue("workers", "Number of forked workers running the scenarios", nWorkers);
+    cmd.AddValue("output", "CSV file of the results (stdout if empty)", output);
+    cmd.Parse(argc, argv);
+
+    std::vector<Scenario> scenarios;
+    if (!scenarioFile.empty())
+    {
+        std::ifstream file(scenarioFile);
+        if (!file || !ParseScenarios(file, scenarios))
+        {
+            std::cerr << "Cannot read the scenarios of " << scenarioFile << std::endl;
+            return 1;
+        }
+    }
+    std::replace(scenarioList.begin(), scenarioList.end(), ';', '\n');
+    std::istringstream list(scenarioList);
+    if (!ParseScenarios(list, scenarios))
+    {
+        return 1;
+    }
+
+    if (traffic.linkFailureRate > 0 || traffic.nodeFailureRate > 0)
+    {
+        // the routers recompute their routes on the interface events of the failures
+        for (std::string protocol : {"DDRRouting", "DGRRouting", "OSPFRouting"})
+        {
+            Config::SetDefault("ns3::" + protocol + "::RespondToInterfaceEvents",
+                               BooleanValue(true));
+        }
+    }
+
+    RomamTopologyHelper topology;
+    std::string path = topoDir + "/Inet_" + topo + "_topo.txt";
+    if (!topology.Read(path))
+    {
+        std::cerr << "Cannot read " << path << std::endl;
+        return 1;
+    }
+    topology.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+    if (loopbacks)
+    {
+        topology.SetLoopbackBase(Ipv4Address("192.168.0.0"));
+    }
+    Config::SetGlobal("RomamLSDBCacheFile", StringValue(lsdbFile));
+    Config::SetGlobal("RomamRouteTableCache", BooleanValue(true));
+    Config::SetDefault("ns3::RomamSink::EnableDelayHistograms", BooleanValue(true));
+
+    std::ofstream file;
+    if (!output.empty())
+    {
+        file.open(output);
+    }
+    std::ostream& os = output.empty() ? std::cout : file;
+    os << "protocol,budget_us,sender,sink,seed,rx_bytes,received,budgeted,deadline_met,"
+          "mean_delay_us,p99_delay_us,max_delay_us,failure_batches,recomputes,"
+          "recompute_seconds,setup_seconds,run_seconds\n";
+    if (nWorkers > 1)
+    {
+        if (!PrepareRoutes(topology, scenarios) ||
+            !RunWorkers(topology,
+                        scenarios,
+                        traffic,
+                        nWorkers,
+                        output.empty() ? "romam-scenario-runner" : output,
+                        os))
+        {
+            std::cerr << "The workers did not run all the scenarios" << std::endl;
+            return 1;
+        }
+        RouteManager::ClearRouteTableCache();
+        return 0;
+    }
+    for (auto i = scenarios.begin(); i != scenarios.end(); i++)
+    {
+        if (!RunScenario(topology, *i, traffic, os))
+        {
+            return 1;
+        }
+    }
+    RouteManager::ClearRouteTableCache();
+    return 0;
+}
@@ -0,0 +1,48 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+//
+// Decode the binary throughput samples of the RomamSinks, written
+// when the RomamThroughputInterval global value is set, into CSV.
+//
+// Usage:
+//   ./ns3 run "romam-throughput-decoder --input=romam-throughput.bin --output=throughput.csv"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/romam-module.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("RomamThroughputDecoder");
+
+int
+main(int argc, char* argv[])
+{
+    std::string input;
+    std::string output;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "Throughput samples file", input);
+    cmd.AddValue("output", "CSV file, the standard output if empty", output);
+    cmd.Parse(argc, argv);
+    NS_ABORT_MSG_IF(input.empty(), "No throughput samples to decode");
+
+    std::ifstream in(input, std::ios::binary);
+    NS_ABORT_MSG_IF(!in, "Cannot read the throughput samples " << input);
+    std::ofstream out;
+    if (!output.empty())
+    {
+        out.open(output);
+        NS_ABORT_MSG_IF(!out, "Cannot write " << output);
+    }
+    if (!ThroughputSampler::Decode(in, output.empty() ? std::cout : out))
+    {
+        std::cerr << input << " is not a file of throughput samples or is truncated" << std::endl;
+        return 1;
+    }
+    return 0;
+}
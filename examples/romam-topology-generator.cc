@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+//
+// Generate a synthetic topology in the Inet format of the topo directory,
+// with TopologyGeneratorHelper.
+//
+// The types of topologies are:
+//   grid      --rows x --columns routers
+//   fattree   the switches of a --k-ary fat-tree
+//   waxman    --nodes routers, linked with the Waxman --alpha and --beta
+//   ba        --nodes routers, each new one linked to --m routers (Barabasi-Albert)
+//   cliques   a ring of --cliques cliques of --cliqueSize routers
+//
+// The weight of the links, their delay in milliseconds and metric in the
+// examples, is drawn from --weight, an ns-3 random variable such as
+// "ns3::UniformRandomVariable[Min=1|Max=10]".
+//
+// Usage:
+//   ./ns3 run "romam-topology-generator --type=ba --nodes=5000 --m=2
+//              --output=contrib/romam/topo/Inet_ba5000_topo.txt"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/romam-module.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("RomamTopologyGenerator");
+
+int
+main(int argc, char* argv[])
+{
+    std::string type("grid");
+    uint32_t rows = 32;
+    uint32_t columns = 32;
+    uint32_t k = 16;
+    uint32_t nodes = 1000;
+    double alpha = 0.1;
+    double beta = 0.2;
+    uint32_t m = 2;
+    uint32_t cliques = 100;
+    uint32_t cliqueSize = 10;
+    std::string weight("ns3::ConstantRandomVariable[Constant=1]");
+    std::string output;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("type", "grid, fattree, waxman, ba or cliques", type);
+    cmd.AddValue("rows", "Rows of the grid", rows);
+    cmd.AddValue("columns", "Columns of the grid", columns);
+    cmd.AddValue("k", "Arity of the fat-tree, even", k);
+    cmd.AddValue("nodes", "Routers of the random graphs", nodes);
+    cmd.AddValue("alpha", "Ratio of long links to short ones of the Waxman graph", alpha);
+    cmd.AddValue("beta", "Density of links of the Waxman graph", beta);
+    cmd.AddValue("m", "Links of each new router of the Barabasi-Albert graph", m);
+    cmd.AddValue("cliques", "Cliques of the ring", cliques);
+    cmd.AddValue("cliqueSize", "Routers of a clique", cliqueSize);
+    cmd.AddValue("weight", "Random variable the weights of the links are drawn from", weight);
+    cmd.AddValue("output", "Topology file, Inet_<type>_topo.txt if empty", output);
+    cmd.Parse(argc, argv);
+
+    ObjectFactory factory;
+    std::istringstream weightStream(weight);
+    weightStream >> factory;
+    NS_ABORT_MSG_IF(weightStream.fail(), "Bad weight distribution " << weight);
+
+    TopologyGeneratorHelper generator;
+    generator.SetWeight(factory.Create<RandomVariableStream>());
+    if (type == "grid")
+    {
+        generator.GenerateGrid(rows, columns);
+    }
+    else if (type == "fattree")
+    {
+        generator.GenerateFatTree(k);
+    }
+    else if (type == "waxman")
+    {
+        generator.GenerateWaxman(nodes, alpha, beta);
+    }
+    else if (type == "ba")
+    {
+        generator.GenerateBarabasiAlbert(nodes, m);
+    }
+    else if (type == "cliques")
+    {
+        generator.GenerateRingOfCliques(cliques, cliqueSize);
+    }
+    else
+    {
+        NS_ABORT_MSG("Unknown topology type " << type);
+    }
+
+    if (output.empty())
+    {
+        output = "Inet_" + type + "_topo.txt";
+    }
+    generator.Write(output);
+    std::cout << output << ": " << generator.GetNNodes() << " nodes, "
+              << generator.GetLinks().size() << " links" << std::endl;
+    return 0;
+}
@@ -7,6 +7,7 @@
 #include "ns3/romam-module.h"
 #include "ns3/traffic-control-helper.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/uinteger.h"
 
 namespace ns3
 {
@@ -14,10 +15,12 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE("DDRRoutingHelper");
 
 DDRHelper::DDRHelper()
+    : m_maxCandidates(0)
 {
 }
 
 DDRHelper::DDRHelper(const DDRHelper& o)
+    : m_maxCandidates(o.m_maxCandidates)
 {
 }
 
@@ -40,13 +43,24 @@ DDRHelper::Create(Ptr<Node> node) const
 
     NS_LOG_LOGIC("Adding DDRRouting Protocol to node " << node->GetId());
     Ptr<DDRRouting> routing = CreateObject<DDRRouting>();
+    if (m_maxCandidates > 0)
+    {
+        routing->SetAttribute("MaxCandidates", UintegerValue(m_maxCandidates));
+    }
     router->SetRoutingProtocol(routing);
     return routing;
 }
 
+void
+DDRHelper::SetMaxCandidates(uint32_t maxCandidates)
+{
+    m_maxCandidates = maxCandidates;
+}
+
 void
 DDRHelper::PopulateRoutingTables(void)
 {
+    PhaseProfiler::Reset();
     std::clock_t t;
     t = clock();
     RouteManager::BuildLSDB();
@@ -68,8 +82,10 @@ DDRHelper::PopulateRoutingTables(void)
 
     t = clock() - t;
     uint32_t time_init_ms = 1000.0 * t / CLOCKS_PER_SEC;
+    NS_LOG_INFO("Candidate routes pruned by MaxCandidates: " << RouteManager::GetNPrunedRoutes());
 
     std::cout << "CPU time used for DDR Init: " << time_init_ms << " ms\n";
+    PhaseProfiler::Report();
 }
 
 void
@@ -80,6 +96,12 @@ DDRHelper::RecomputeRoutingTables(void)
     RouteManager::InitializeSPFRoutes();
 }
 
+void
+DDRHelper::SetDelayMetrics(void)
+{
+    RouteManager::SetDelayMetrics();
+}
+
 QueueDiscContainer
 DDRHelper::Install(Ptr<Node> node) const
 {
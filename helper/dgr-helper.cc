@@ -24,6 +24,7 @@
 #include "ns3/romam-module.h"
 #include "ns3/traffic-control-helper.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/uinteger.h"
 
 namespace ns3
 {
@@ -31,10 +32,12 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE("DGRRoutingHelper");
 
 DGRHelper::DGRHelper()
+    : m_maxCandidates(0)
 {
 }
 
 DGRHelper::DGRHelper(const DGRHelper& o)
+    : m_maxCandidates(o.m_maxCandidates)
 {
 }
 
@@ -57,13 +60,24 @@ DGRHelper::Create(Ptr<Node> node) const
 
     NS_LOG_LOGIC("Adding DGRRouting Protocol to node " << node->GetId());
     Ptr<DGRRouting> routing = CreateObject<DGRRouting>();
+    if (m_maxCandidates > 0)
+    {
+        routing->SetAttribute("MaxCandidates", UintegerValue(m_maxCandidates));
+    }
     router->SetRoutingProtocol(routing);
     return routing;
 }
 
+void
+DGRHelper::SetMaxCandidates(uint32_t maxCandidates)
+{
+    m_maxCandidates = maxCandidates;
+}
+
 void
 DGRHelper::PopulateRoutingTables(void)
 {
+    PhaseProfiler::Reset();
     std::clock_t t;
     t = clock();
     RouteManager::BuildLSDB();
@@ -71,7 +85,9 @@ DGRHelper::PopulateRoutingTables(void)
 
     t = clock() - t;
     uint32_t time_init_ms = 1000.0 * t / CLOCKS_PER_SEC;
+    NS_LOG_INFO("Candidate routes pruned by MaxCandidates: " << RouteManager::GetNPrunedRoutes());
     std::cout << "CPU time used for DGR Init: " << time_init_ms << "\n";
+    PhaseProfiler::Report();
 }
 
 void
@@ -82,6 +98,12 @@ DGRHelper::RecomputeRoutingTables(void)
     RouteManager::InitializeSPFRoutes();
 }
 
+void
+DGRHelper::SetDelayMetrics(void)
+{
+    RouteManager::SetDelayMetrics();
+}
+
 QueueDiscContainer
 DGRHelper::Install(Ptr<Node> node) const
 {
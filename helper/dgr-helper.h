@@ -18,6 +18,9 @@ namespace ns3
  * \ingroup ipv4Helpers
  *
  * \brief Helper class that adds ns3::Ipv4GlobalRouting objects
+ *
+ * It installs DGRRouting as the only routing protocol of the nodes, see
+ * RomamRoutingHelper.
  */
 class DGRHelper : public Ipv4RoutingHelper
 {
@@ -42,6 +45,13 @@ class DGRHelper : public Ipv4RoutingHelper
      */
     DGRHelper* Copy(void) const;
 
+    /**
+     * \brief Set the MaxCandidates attribute of the routers of the helper,
+     * as DDRHelper::SetMaxCandidates () does.
+     * \param maxCandidates the candidates kept per destination, 0 for all
+     */
+    void SetMaxCandidates(uint32_t maxCandidates);
+
     /**
      * \param node the node on which the routing protocol will run
      * \returns a newly-created routing protocol
@@ -74,6 +84,16 @@ class DGRHelper : public Ipv4RoutingHelper
      */
     static void RecomputeRoutingTables(void);
 
+    /**
+     * \brief Set the metric of every interface of the nodes in the simulation
+     * from the propagation delay of its channel, so the delay budgets are
+     * checked against the real delays of the paths.  It is to be called
+     * before PopulateRoutingTables ().
+     *
+     * All this function does is call RouteManager::SetDelayMetrics ().
+     */
+    static void SetDelayMetrics(void);
+
     /**
      * \param node Node
      * \return a QueueDisc container with the queue discs installed on the node
@@ -108,6 +128,8 @@ class DGRHelper : public Ipv4RoutingHelper
      * \return
      */
     DGRHelper& operator=(const DGRHelper&);
+
+    uint32_t m_maxCandidates; //!< MaxCandidates of the routers, 0 to leave it
 };
 
 } // namespace ns3
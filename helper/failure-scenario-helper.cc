@@ -0,0 +1,331 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "failure-scenario-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/channel.h"
+#include "ns3/ipv4.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/romam-module.h"
+#include "ns3/simulator.h"
+
+#include <chrono>
+#include <string>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FailureScenarioHelper");
+
+FailureScenarioHelper::FailureScenarioHelper()
+    : m_tracker(nullptr)
+{
+    m_gap = CreateObject<ExponentialRandomVariable>();
+    m_pick = CreateObject<UniformRandomVariable>();
+}
+
+void
+FailureScenarioHelper::AddLinkFailure(Time at, Time duration, uint32_t a, uint32_t b)
+{
+    NS_LOG_FUNCTION(this << at << duration << a << b);
+    m_failures.push_back(Failure{LINK_FAILURE, 0, at, duration, a, b});
+}
+
+uint32_t
+FailureScenarioHelper::AddSrlg(const std::vector<std::pair<uint32_t, uint32_t>>& links)
+{
+    NS_LOG_FUNCTION(this << links.size());
+    m_srlgs.push_back(links);
+    return m_srlgs.size() - 1;
+}
+
+void
+FailureScenarioHelper::AddSrlgFailure(Time at, Time duration, uint32_t srlg)
+{
+    NS_LOG_FUNCTION(this << at << duration << srlg);
+    NS_ABORT_MSG_IF(srlg >= m_srlgs.size(), "No shared risk link group " << srlg);
+    m_failures.push_back(Failure{SRLG_FAILURE, srlg, at, duration, 0, 0});
+}
+
+void
+FailureScenarioHelper::AddNodeFailure(Time at, Time duration, uint32_t node)
+{
+    NS_LOG_FUNCTION(this << at << duration << node);
+    m_failures.push_back(Failure{NODE_FAILURE, node, at, duration, 0, 0});
+}
+
+void
+FailureScenarioHelper::GenerateFailures(FailureKind kind,
+                                        double rate,
+                                        Time start,
+                                        Time stop,
+                                        Ptr<RandomVariableStream> duration)
+{
+    NS_LOG_FUNCTION(this << kind << rate << start << stop);
+    NS_ABORT_MSG_IF(rate <= 0, "The failure rate must be positive");
+    NS_ABORT_MSG_IF(kind == SRLG_FAILURE && m_srlgs.empty(), "No shared risk link group");
+    m_generators.push_back(Generator{kind, rate, start, stop, duration});
+}
+
+void
+FailureScenarioHelper::SetConvergenceTracker(RouteConvergenceTracker* tracker)
+{
+    m_tracker = tracker;
+}
+
+int64_t
+FailureScenarioHelper::AssignStreams(int64_t stream)
+{
+    m_gap->SetStream(stream);
+    m_pick->SetStream(stream + 1);
+    return 2;
+}
+
+void
+FailureScenarioHelper::Clear()
+{
+    m_failures.clear();
+    m_srlgs.clear();
+    m_generators.clear();
+    m_batches.clear();
+    m_changes.clear();
+    m_held.clear();
+}
+
+uint32_t
+FailureScenarioHelper::FindLinks(Ptr<Node> node,
+                                 Ptr<Node> peer,
+                                 std::vector<Interface>& interfaces)
+{
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    uint32_t found = 0;
+    for (uint32_t d = 0; d < node->GetNDevices(); d++)
+    {
+        Ptr<NetDevice> device = node->GetDevice(d);
+        Ptr<Channel> channel = device->GetChannel();
+        if (!channel || channel->GetNDevices() != 2)
+        {
+            continue;
+        }
+        Ptr<NetDevice> other = channel->GetDevice(channel->GetDevice(0) == device ? 1 : 0);
+        if (peer && other->GetNode() != peer)
+        {
+            continue;
+        }
+        Ptr<Ipv4> otherIpv4 = other->GetNode()->GetObject<Ipv4>();
+        int32_t iface = ipv4->GetInterfaceForDevice(device);
+        int32_t otherIface = otherIpv4 ? otherIpv4->GetInterfaceForDevice(other) : -1;
+        if (iface < 0 || otherIface < 0)
+        {
+            continue;
+        }
+        interfaces.emplace_back(node->GetId(), iface);
+        interfaces.emplace_back(other->GetNode()->GetId(), otherIface);
+        found++;
+    }
+    return found;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>>
+FailureScenarioHelper::ListLinks(NodeContainer nodes)
+{
+    std::map<uint32_t, uint32_t> indices;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        indices[nodes.Get(i)->GetId()] = i;
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> links;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        std::vector<Interface> interfaces;
+        FindLinks(nodes.Get(i), nullptr, interfaces);
+        // the far end of every link follows the near one
+        for (std::size_t k = 1; k < interfaces.size(); k += 2)
+        {
+            auto j = indices.find(interfaces[k].first);
+            if (j != indices.end() && j->second > i)
+            {
+                links.emplace_back(i, j->second);
+            }
+        }
+    }
+    return links;
+}
+
+void
+FailureScenarioHelper::Install(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION(this << nodes.GetN());
+    NS_ABORT_MSG_IF(!m_batches.empty(), "FailureScenarioHelper installed twice");
+    std::vector<Failure> failures = m_failures;
+    std::vector<std::pair<uint32_t, uint32_t>> links;
+    for (const Generator& generator : m_generators)
+    {
+        if (generator.kind == LINK_FAILURE && links.empty())
+        {
+            links = ListLinks(nodes);
+        }
+        uint32_t n = generator.kind == LINK_FAILURE   ? links.size()
+                     : generator.kind == SRLG_FAILURE ? m_srlgs.size()
+                                                      : nodes.GetN();
+        NS_ABORT_MSG_IF(n == 0, "Nothing to fail");
+        Time at = generator.start + Seconds(m_gap->GetValue(1 / generator.rate, 0));
+        while (at < generator.stop)
+        {
+            uint32_t target = m_pick->GetInteger(0, n - 1);
+            Time duration = generator.duration ? Seconds(generator.duration->GetValue()) : Time();
+            Failure failure{generator.kind, target, at, duration, 0, 0};
+            if (generator.kind == LINK_FAILURE)
+            {
+                failure.a = links[target].first;
+                failure.b = links[target].second;
+            }
+            failures.push_back(failure);
+            at += Seconds(m_gap->GetValue(1 / generator.rate, 0));
+        }
+    }
+
+    // the changes of each time, in time order
+    std::map<Time, Changes> changes;
+    for (const Failure& failure : failures)
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> failed;
+        std::vector<Interface> interfaces;
+        switch (failure.kind)
+        {
+        case LINK_FAILURE:
+            failed.emplace_back(failure.a, failure.b);
+            break;
+        case SRLG_FAILURE:
+            failed = m_srlgs[failure.target];
+            break;
+        case NODE_FAILURE:
+            NS_ABORT_MSG_IF(failure.target >= nodes.GetN(), "No node " << failure.target);
+            FindLinks(nodes.Get(failure.target), nullptr, interfaces);
+            break;
+        }
+        for (const auto& link : failed)
+        {
+            uint32_t found = 0;
+            if (link.first < nodes.GetN() && link.second < nodes.GetN())
+            {
+                found = FindLinks(nodes.Get(link.first), nodes.Get(link.second), interfaces);
+            }
+            NS_ABORT_MSG_IF(found == 0,
+                            "No link between nodes " << link.first << " and " << link.second);
+        }
+        Changes& start = changes[failure.at];
+        start.failures++;
+        start.downs.insert(start.downs.end(), interfaces.begin(), interfaces.end());
+        if (failure.duration.IsStrictlyPositive())
+        {
+            Changes& end = changes[failure.at + failure.duration];
+            end.repairs++;
+            end.ups.insert(end.ups.end(), interfaces.begin(), interfaces.end());
+        }
+    }
+
+    Time now = Simulator::Now();
+    for (auto& i : changes)
+    {
+        NS_ABORT_MSG_IF(i.first < now, "Failure scheduled in the past, at " << i.first);
+        uint32_t index = m_batches.size();
+        m_batches.push_back(Batch{i.first, i.second.failures, i.second.repairs, 0, 0,
+                                  false, false, 0});
+        m_changes.push_back(std::move(i.second));
+        Simulator::Schedule(i.first - now, &FailureScenarioHelper::Apply, this, index);
+    }
+    NS_LOG_INFO(failures.size() << " failures in " << m_batches.size() << " batches");
+}
+
+void
+FailureScenarioHelper::Apply(uint32_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+    Batch& batch = m_batches[index];
+    Changes& changes = m_changes[index];
+    if (m_tracker)
+    {
+        m_tracker->MarkEvent("batch " + std::to_string(index));
+    }
+    // the downs first, so that a link its failures hand over to each other
+    // stays down, without a flap
+    for (const Interface& interface : changes.downs)
+    {
+        if (m_held[interface]++ == 0)
+        {
+            NodeList::GetNode(interface.first)->GetObject<Ipv4>()->SetDown(interface.second);
+            batch.downs++;
+        }
+    }
+    for (const Interface& interface : changes.ups)
+    {
+        auto held = m_held.find(interface);
+        NS_ASSERT(held != m_held.end() && held->second > 0);
+        if (--held->second == 0)
+        {
+            m_held.erase(held);
+            NodeList::GetNode(interface.first)->GetObject<Ipv4>()->SetUp(interface.second);
+            batch.ups++;
+        }
+    }
+    batch.applied = true;
+    RouteRecomputeScheduler* scheduler = RouteManager::GetRecomputeScheduler();
+    if (scheduler->IsPending())
+    {
+        auto begin = std::chrono::steady_clock::now();
+        scheduler->Flush();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        batch.recomputed = true;
+        batch.recomputeSeconds = elapsed.count();
+    }
+    NS_LOG_INFO("Batch " << index << ": " << batch.downs << " interfaces down, " << batch.ups
+                         << " up, recompute " << batch.recomputeSeconds << " s");
+}
+
+const std::vector<FailureScenarioHelper::Batch>&
+FailureScenarioHelper::GetBatches() const
+{
+    return m_batches;
+}
+
+uint32_t
+FailureScenarioHelper::GetRecomputes() const
+{
+    uint32_t recomputes = 0;
+    for (const Batch& batch : m_batches)
+    {
+        recomputes += batch.recomputed ? 1 : 0;
+    }
+    return recomputes;
+}
+
+double
+FailureScenarioHelper::GetRecomputeSeconds() const
+{
+    double seconds = 0;
+    for (const Batch& batch : m_batches)
+    {
+        seconds += batch.recomputeSeconds;
+    }
+    return seconds;
+}
+
+void
+FailureScenarioHelper::Print(std::ostream& os) const
+{
+    os << "time_s,failures,repairs,downs,ups,recomputed,recompute_seconds\n";
+    for (const Batch& batch : m_batches)
+    {
+        if (batch.applied)
+        {
+            os << batch.time.GetSeconds() << ',' << batch.failures << ',' << batch.repairs << ','
+               << batch.downs << ',' << batch.ups << ',' << batch.recomputed << ','
+               << batch.recomputeSeconds << '\n';
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef FAILURE_SCENARIO_HELPER_H
+#define FAILURE_SCENARIO_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+
+#include <map>
+#include <ostream>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+class RouteConvergenceTracker;
+
+/**
+ * \brief A helper to fail and repair links and nodes on a schedule, with one
+ * route recompute per batch of simultaneous events.
+ *
+ * The schedule holds failures of a link, of a shared risk link group (SRLG),
+ * the links failing together, or of a node, all the links of it, each with
+ * the time it starts and how long it lasts.  They are given one by one or
+ * drawn by GenerateFailures (), as a Poisson process of a rate.  The nodes
+ * are given by their index in the NodeContainer passed to Install (), and a
+ * link by the nodes at its ends, which a point-to-point channel joins.
+ *
+ * A link fails with the interfaces at both its ends set down, and is
+ * repaired with them set up, once no failure holds it down anymore.  The
+ * failures and repairs of the same time are applied in one event, after
+ * which the pending route recompute of RouteManager runs at once, so a batch
+ * costs one recompute whatever the number of interfaces it changes.  The
+ * wall time of the recomputes is recorded by batch.  The routing protocols
+ * only ask for a recompute on the interface events with their
+ * RespondToInterfaceEvents attribute set.
+ *
+ * With SetConvergenceTracker (), every batch starts an event of the tracker,
+ * which then times the table changes that follow it.
+ *
+ * The events refer to the helper, which must outlive the simulation.
+ */
+class FailureScenarioHelper
+{
+  public:
+    /// what a failure takes down
+    enum FailureKind
+    {
+        LINK_FAILURE, //!< a link
+        SRLG_FAILURE, //!< the links of a shared risk link group
+        NODE_FAILURE  //!< the links of a node
+    };
+
+    /// a batch of failures and repairs applied at the same time
+    struct Batch
+    {
+        Time time;               //!< when the batch is applied
+        uint32_t failures;       //!< failures starting then
+        uint32_t repairs;        //!< failures ending then
+        uint32_t downs;          //!< interfaces set down
+        uint32_t ups;            //!< interfaces set up
+        bool applied;            //!< the batch was applied
+        bool recomputed;         //!< a route recompute ran after the batch
+        double recomputeSeconds; //!< wall time of the recompute
+    };
+
+    FailureScenarioHelper();
+
+    /**
+     * \brief Fail a link.
+     * \param at when the link fails
+     * \param duration how long it stays down, forever if zero
+     * \param a index of the node at one end
+     * \param b index of the node at the other end
+     */
+    void AddLinkFailure(Time at, Time duration, uint32_t a, uint32_t b);
+
+    /**
+     * \brief Add a shared risk link group.
+     * \param links the links of the group, by the nodes at their ends
+     * \return the index of the group
+     */
+    uint32_t AddSrlg(const std::vector<std::pair<uint32_t, uint32_t>>& links);
+
+    /**
+     * \brief Fail all the links of a shared risk link group at once.
+     * \param at when the links fail
+     * \param duration how long they stay down, forever if zero
+     * \param srlg the index of the group
+     */
+    void AddSrlgFailure(Time at, Time duration, uint32_t srlg);
+
+    /**
+     * \brief Fail all the links of a node at once.
+     * \param at when the node fails
+     * \param duration how long it stays down, forever if zero
+     * \param node index of the node
+     */
+    void AddNodeFailure(Time at, Time duration, uint32_t node);
+
+    /**
+     * \brief Draw failures as a Poisson process between two times, each of a
+     * link, group or node picked uniformly, at Install ().
+     * \param kind what the failures take down
+     * \param rate the mean number of failures per second
+     * \param start when the process starts
+     * \param stop when it stops
+     * \param duration draws how long each failure lasts, in seconds
+     */
+    void GenerateFailures(FailureKind kind,
+                          double rate,
+                          Time start,
+                          Time stop,
+                          Ptr<RandomVariableStream> duration);
+
+    /**
+     * \brief Start an event of a tracker at every batch, named "batch <index>".
+     * \param tracker the tracker, or null for none
+     */
+    void SetConvergenceTracker(RouteConvergenceTracker* tracker);
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this helper.
+     * \param stream The first stream index to use
+     * \return The number of stream indices assigned by this helper
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * \brief Remove the failures, groups and batches.
+     */
+    void Clear();
+
+    /**
+     * \brief Draw the failures of GenerateFailures (), find the interfaces of
+     * the failures and schedule the batches.
+     * \param nodes the nodes the failures index
+     */
+    void Install(NodeContainer nodes);
+
+    /**
+     * \return the batches, in time order, the ones not applied yet included
+     */
+    const std::vector<Batch>& GetBatches() const;
+
+    /**
+     * \return the number of route recomputes the batches ran
+     */
+    uint32_t GetRecomputes() const;
+
+    /**
+     * \return the wall time of the route recomputes of the batches, in seconds
+     */
+    double GetRecomputeSeconds() const;
+
+    /**
+     * \brief Print a CSV line per batch applied.
+     * \param os the output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    /// a failure of the schedule
+    struct Failure
+    {
+        FailureKind kind; //!< what it takes down
+        uint32_t target;  //!< the index of the node or the group
+        Time at;          //!< when it starts
+        Time duration;    //!< how long it lasts, forever if zero
+        uint32_t a;       //!< the node at one end, for a link
+        uint32_t b;       //!< the node at the other end, for a link
+    };
+
+    /// a random process of failures
+    struct Generator
+    {
+        FailureKind kind;                   //!< what the failures take down
+        double rate;                        //!< mean failures per second
+        Time start;                         //!< start of the process
+        Time stop;                          //!< end of the process
+        Ptr<RandomVariableStream> duration; //!< the durations in seconds
+    };
+
+    /// an interface, by its node and its index
+    typedef std::pair<uint32_t, uint32_t> Interface;
+
+    /// the interfaces failures set down and repairs set up in a batch
+    struct Changes
+    {
+        uint32_t failures;            //!< failures starting
+        uint32_t repairs;             //!< failures ending
+        std::vector<Interface> downs; //!< interfaces of the failures starting
+        std::vector<Interface> ups;   //!< interfaces of the failures ending
+    };
+
+    /**
+     * \brief Append the interfaces at both ends of the links of a node.
+     * \param node the node
+     * \param peer the node at the other end, or null for all the links
+     * \param interfaces the interfaces appended to
+     * \return the number of links found
+     */
+    static uint32_t FindLinks(Ptr<Node> node, Ptr<Node> peer, std::vector<Interface>& interfaces);
+
+    /**
+     * \param nodes the nodes of Install ()
+     * \return the links between the nodes, by the indices of their ends
+     */
+    static std::vector<std::pair<uint32_t, uint32_t>> ListLinks(NodeContainer nodes);
+
+    /**
+     * \brief Set down and up the interfaces of a batch, then run the pending
+     * route recompute.
+     * \param index the index of the batch
+     */
+    void Apply(uint32_t index);
+
+    std::vector<Failure> m_failures;                                 //!< the failures
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> m_srlgs; //!< the groups
+    std::vector<Generator> m_generators;                             //!< the random processes
+    Ptr<ExponentialRandomVariable> m_gap;                            //!< draws the arrival gaps
+    Ptr<UniformRandomVariable> m_pick;                               //!< draws the failed elements
+
+    std::vector<Batch> m_batches;         //!< the batches, in time order
+    std::vector<Changes> m_changes;       //!< the interfaces of every batch
+    std::map<Interface, uint32_t> m_held; //!< failures holding down every interface down
+    RouteConvergenceTracker* m_tracker;   //!< the tracker of the batches, if any
+};
+
+} // namespace ns3
+
+#endif /* FAILURE_SCENARIO_HELPER_H */
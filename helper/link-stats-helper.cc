@@ -0,0 +1,299 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "link-stats-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/data-rate.h"
+#include "ns3/ddr-queue-disc.h"
+#include "ns3/dgr-queue-disc.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/traffic-control-layer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LinkStatsHelper");
+
+/// the magic of a file of link samples
+static const char LINK_STATS_MAGIC[8] = {'R', 'O', 'M', 'A', 'M', 'L', 'N', 'K'};
+/// layout of the file, to be changed along with the structures below
+static const uint32_t LINK_STATS_FORMAT = 1;
+
+/// beginning of the file
+struct LinkStatsFileHeader
+{
+    char magic[8];     //!< LINK_STATS_MAGIC
+    uint32_t format;   //!< LINK_STATS_FORMAT
+    uint32_t nLinks;   //!< links that follow
+    uint32_t nSamples; //!< samples of every link
+    uint32_t reserved; //!< 0
+    int64_t start;     //!< time of the first sample kept, in ns
+    int64_t interval;  //!< time from one sample to the next, in ns
+    uint64_t nLost;    //!< samples overwritten before the first one kept
+};
+
+static_assert(sizeof(LinkStatsFileHeader) == 48, "LinkStatsFileHeader must have no padding");
+static_assert(sizeof(LinkStatsHelper::LinkInfo) == 16, "LinkInfo must have no padding");
+
+LinkStatsHelper::LinkStatsHelper()
+    : m_interval(MilliSeconds(10)),
+      m_capacity(4096),
+      m_head(0),
+      m_nSamples(0),
+      m_nLost(0)
+{
+}
+
+LinkStatsHelper::~LinkStatsHelper()
+{
+    m_event.Cancel();
+}
+
+void
+LinkStatsHelper::SetInterval(Time interval)
+{
+    NS_ABORT_MSG_IF(!interval.IsStrictlyPositive(), "The interval must be positive");
+    m_interval = interval;
+}
+
+void
+LinkStatsHelper::SetCapacity(uint32_t capacity)
+{
+    NS_ABORT_MSG_IF(capacity == 0, "The capacity must be positive");
+    m_capacity = capacity;
+}
+
+uint32_t
+LinkStatsHelper::Install(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION(this << nodes.GetN());
+    m_event.Cancel();
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<Node> node = nodes.Get(i);
+        Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer>();
+        if (!tc)
+        {
+            continue;
+        }
+        for (uint32_t d = 0; d < node->GetNDevices(); d++)
+        {
+            Ptr<NetDevice> device = node->GetDevice(d);
+            Ptr<QueueDisc> qdisc = tc->GetRootQueueDiscOnDevice(device);
+            if (!DynamicCast<DDRQueueDisc>(qdisc) && !DynamicCast<DGRQueueDisc>(qdisc))
+            {
+                continue;
+            }
+            DataRateValue rate;
+            bool known = device->GetAttributeFailSafe("DataRate", rate);
+            uint64_t bitRate = known ? rate.Get().GetBitRate() : 0;
+            m_links.push_back(LinkInfo{node->GetId(), device->GetIfIndex(), bitRate});
+            const QueueDisc::Stats& stats = qdisc->GetStats();
+            m_counters.push_back(Counters{qdisc,
+                                          stats.nTotalSentBytes,
+                                          stats.nTotalSentPackets,
+                                          stats.nTotalDroppedPackets});
+        }
+    }
+    m_sentBytes.assign(m_links.size() * static_cast<std::size_t>(m_capacity), 0);
+    m_sentPackets.assign(m_sentBytes.size(), 0);
+    m_dropped.assign(m_sentBytes.size(), 0);
+    m_head = 0;
+    m_nSamples = 0;
+    m_nLost = 0;
+    m_start = Simulator::Now() + m_interval;
+    m_event = Simulator::Schedule(m_interval, &LinkStatsHelper::Sample, this);
+    NS_LOG_INFO("Sampling " << m_links.size() << " links every " << m_interval.As(Time::MS));
+    return m_links.size();
+}
+
+void
+LinkStatsHelper::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    m_event.Cancel();
+}
+
+void
+LinkStatsHelper::Sample()
+{
+    uint32_t slot = m_head + m_nSamples;
+    if (slot >= m_capacity)
+    {
+        slot -= m_capacity;
+    }
+    if (m_nSamples == m_capacity)
+    {
+        // the ring is full, the new sample takes the place of the oldest one
+        m_head = m_head + 1 == m_capacity ? 0 : m_head + 1;
+        m_nLost++;
+    }
+    else
+    {
+        m_nSamples++;
+    }
+    for (std::size_t l = 0; l < m_counters.size(); l++)
+    {
+        // O(1): the queue disc counts what it sends and drops
+        Counters& counters = m_counters[l];
+        const QueueDisc::Stats& stats = counters.qdisc->GetStats();
+        std::size_t i = l * m_capacity + slot;
+        m_sentBytes[i] = stats.nTotalSentBytes - counters.sentBytes;
+        m_sentPackets[i] = stats.nTotalSentPackets - counters.sentPackets;
+        m_dropped[i] = stats.nTotalDroppedPackets - counters.dropped;
+        counters.sentBytes = stats.nTotalSentBytes;
+        counters.sentPackets = stats.nTotalSentPackets;
+        counters.dropped = stats.nTotalDroppedPackets;
+    }
+    m_event = Simulator::Schedule(m_interval, &LinkStatsHelper::Sample, this);
+}
+
+const std::vector<LinkStatsHelper::LinkInfo>&
+LinkStatsHelper::GetLinks() const
+{
+    return m_links;
+}
+
+uint32_t
+LinkStatsHelper::GetNSamples() const
+{
+    return m_nSamples;
+}
+
+std::size_t
+LinkStatsHelper::GetSlot(uint32_t link, uint32_t sample) const
+{
+    NS_ASSERT(link < m_links.size() && sample < m_nSamples);
+    uint32_t slot = m_head + sample;
+    if (slot >= m_capacity)
+    {
+        slot -= m_capacity;
+    }
+    return link * static_cast<std::size_t>(m_capacity) + slot;
+}
+
+/**
+ * \param bytes the bytes a link sent in a sample
+ * \param rate the data rate of the link in bit/s, 0 if unknown
+ * \param interval the duration of the sample, in seconds
+ * \return the share of the rate the link sent at
+ */
+static double
+ComputeUtilization(uint64_t bytes, uint64_t rate, double interval)
+{
+    return rate > 0 ? bytes * 8.0 / (rate * interval) : 0.0;
+}
+
+/**
+ * \param sent the packets a link sent in a sample
+ * \param dropped the packets it dropped
+ * \return the share of the packets dropped
+ */
+static double
+ComputeLossRate(uint32_t sent, uint32_t dropped)
+{
+    return dropped > 0 ? static_cast<double>(dropped) / (sent + dropped) : 0.0;
+}
+
+double
+LinkStatsHelper::GetUtilization(uint32_t link, uint32_t sample) const
+{
+    return ComputeUtilization(m_sentBytes[GetSlot(link, sample)],
+                               m_links[link].rate,
+                               m_interval.GetSeconds());
+}
+
+double
+LinkStatsHelper::GetLossRate(uint32_t link, uint32_t sample) const
+{
+    std::size_t i = GetSlot(link, sample);
+    return ComputeLossRate(m_sentPackets[i], m_dropped[i]);
+}
+
+bool
+LinkStatsHelper::Write(const std::string& path) const
+{
+    NS_LOG_FUNCTION(this << path);
+    LinkStatsFileHeader header;
+    std::memcpy(header.magic, LINK_STATS_MAGIC, sizeof(header.magic));
+    header.format = LINK_STATS_FORMAT;
+    header.nLinks = m_links.size();
+    header.nSamples = m_nSamples;
+    header.reserved = 0;
+    header.interval = m_interval.GetNanoSeconds();
+    header.start = m_start.GetNanoSeconds() + header.interval * static_cast<int64_t>(m_nLost);
+    header.nLost = m_nLost;
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(m_links.data()), m_links.size() * sizeof(LinkInfo));
+    // the rings of every column, oldest sample first
+    uint32_t first = std::min(m_nSamples, m_capacity - m_head);
+    for (const std::vector<uint32_t>* column : {&m_sentBytes, &m_sentPackets, &m_dropped})
+    {
+        for (std::size_t l = 0; l < m_links.size(); l++)
+        {
+            const uint32_t* ring = column->data() + l * m_capacity;
+            out.write(reinterpret_cast<const char*>(ring + m_head), first * sizeof(uint32_t));
+            out.write(reinterpret_cast<const char*>(ring),
+                      (m_nSamples - first) * sizeof(uint32_t));
+        }
+    }
+    if (!out)
+    {
+        NS_LOG_WARN("Cannot write the link samples to " << path);
+        return false;
+    }
+    return true;
+}
+
+bool
+LinkStatsHelper::Decode(std::istream& is, std::ostream& os)
+{
+    LinkStatsFileHeader header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, LINK_STATS_MAGIC, sizeof(header.magic)) != 0 ||
+        header.format != LINK_STATS_FORMAT)
+    {
+        return false;
+    }
+    std::vector<LinkInfo> links(header.nLinks);
+    std::size_t cells = static_cast<std::size_t>(header.nLinks) * header.nSamples;
+    std::vector<uint32_t> sentBytes(cells);
+    std::vector<uint32_t> sentPackets(cells);
+    std::vector<uint32_t> dropped(cells);
+    if (!is.read(reinterpret_cast<char*>(links.data()), links.size() * sizeof(LinkInfo)) ||
+        !is.read(reinterpret_cast<char*>(sentBytes.data()), cells * sizeof(uint32_t)) ||
+        !is.read(reinterpret_cast<char*>(sentPackets.data()), cells * sizeof(uint32_t)) ||
+        !is.read(reinterpret_cast<char*>(dropped.data()), cells * sizeof(uint32_t)))
+    {
+        return false;
+    }
+    if (header.nLost > 0)
+    {
+        os << "# " << header.nLost << " samples lost\n";
+    }
+    double interval = header.interval * 1e-9;
+    os << "node,ifindex,time_ns,sent_bytes,sent_packets,dropped_packets,utilization,loss_rate\n";
+    for (uint32_t l = 0; l < header.nLinks; l++)
+    {
+        for (uint32_t s = 0; s < header.nSamples; s++)
+        {
+            std::size_t i = static_cast<std::size_t>(l) * header.nSamples + s;
+            os << links[l].nodeId << ',' << links[l].ifIndex << ','
+               << header.start + s * header.interval << ',' << sentBytes[i] << ','
+               << sentPackets[i] << ',' << dropped[i] << ','
+               << ComputeUtilization(sentBytes[i], links[l].rate, interval) << ','
+               << ComputeLossRate(sentPackets[i], dropped[i]) << '\n';
+        }
+    }
+    return true;
+}
+
+} // namespace ns3
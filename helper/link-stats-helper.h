@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef LINK_STATS_HELPER_H
+#define LINK_STATS_HELPER_H
+
+#include "ns3/event-id.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <istream>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class QueueDisc;
+
+/**
+ * \brief A helper to sample the traffic and the drops of every link of the
+ * network, from the DDR and DGR queue discs of the devices.
+ *
+ * Install () registers the DDRQueueDisc and DGRQueueDisc at the root of the
+ * devices of the nodes, and a single simulator event then reads the byte,
+ * packet and drop counters of all of them every interval, which the queue
+ * discs keep anyway, so the packets pay nothing, unlike with a FlowMonitor
+ * or trace sinks per device.  A sample of a link is what it sent and dropped
+ * in the interval.
+ *
+ * The samples are kept in a ring of SetCapacity () samples shared by the
+ * links, the oldest being overwritten, so the memory is bounded whatever the
+ * duration.  Write () stores them in a columnar file, link by time: a header
+ * of the magic "ROMAMLNK", the format, the number of links and samples, the
+ * time of the first sample kept, the interval and the samples lost, the
+ * LinkInfo of every link, then the matrix of the bytes sent, the one of the
+ * packets sent and the one of the packets dropped, each a row of samples per
+ * link, all in the byte order of the host that wrote it.  Decode () prints
+ * the file as CSV, with the utilization of the links and their loss rate.
+ *
+ * The event refers to the helper, which must outlive the simulation.
+ */
+class LinkStatsHelper
+{
+  public:
+    /// the description of a link in the file
+    struct LinkInfo
+    {
+        uint32_t nodeId;  //!< node of the queue disc
+        uint32_t ifIndex; //!< device of the queue disc
+        uint64_t rate;    //!< data rate of the device in bit/s, 0 if unknown
+    };
+
+    LinkStatsHelper();
+    ~LinkStatsHelper();
+
+    LinkStatsHelper(const LinkStatsHelper&) = delete;
+    LinkStatsHelper& operator=(const LinkStatsHelper&) = delete;
+
+    /**
+     * \param interval the time from one sample to the next, 10 ms by default
+     */
+    void SetInterval(Time interval);
+
+    /**
+     * \param capacity the samples kept of every link, 4096 by default
+     */
+    void SetCapacity(uint32_t capacity);
+
+    /**
+     * \brief Register the DDR and DGR queue discs at the root of the devices
+     * of nodes, and start sampling an interval from now.
+     *
+     * The queue discs must be installed.  Samples taken before are dropped.
+     *
+     * \param nodes the nodes
+     * \return the number of links registered
+     */
+    uint32_t Install(NodeContainer nodes);
+
+    /**
+     * \brief Stop sampling, keeping the samples.
+     */
+    void Stop();
+
+    /**
+     * \return the links, by registration
+     */
+    const std::vector<LinkInfo>& GetLinks() const;
+
+    /**
+     * \return the number of samples kept of every link
+     */
+    uint32_t GetNSamples() const;
+
+    /**
+     * \param link the index of a link
+     * \param sample the index of a sample, 0 for the oldest kept
+     * \return the share of the data rate of the link it sent at in the
+     * sample, 0 if the rate is unknown
+     */
+    double GetUtilization(uint32_t link, uint32_t sample) const;
+
+    /**
+     * \param link the index of a link
+     * \param sample the index of a sample, 0 for the oldest kept
+     * \return the share of the packets of the sample the link dropped
+     */
+    double GetLossRate(uint32_t link, uint32_t sample) const;
+
+    /**
+     * \brief Write the samples to a file.
+     * \param path the path of the file
+     * \return false if the file cannot be written
+     */
+    bool Write(const std::string& path) const;
+
+    /**
+     * \brief Print a file of samples as CSV: a header line, then a line per
+     * link and sample.
+     * \param is the file
+     * \param os the output stream
+     * \return false if the file is not a file of link samples or is truncated
+     */
+    static bool Decode(std::istream& is, std::ostream& os);
+
+  private:
+    /// the counters of a queue disc at the last sample
+    struct Counters
+    {
+        Ptr<QueueDisc> qdisc; //!< the queue disc
+        uint64_t sentBytes;   //!< bytes sent
+        uint32_t sentPackets; //!< packets sent
+        uint32_t dropped;     //!< packets dropped
+    };
+
+    /**
+     * \brief Take a sample of every link and schedule the next one.
+     */
+    void Sample();
+
+    /**
+     * \param link the index of a link
+     * \param sample the index of a sample, 0 for the oldest kept
+     * \return the index of the sample in the columns
+     */
+    std::size_t GetSlot(uint32_t link, uint32_t sample) const;
+
+    Time m_interval;                     //!< time from one sample to the next
+    uint32_t m_capacity;                 //!< samples of the ring of a link
+    Time m_start;                        //!< time of the first sample
+    std::vector<LinkInfo> m_links;       //!< the links, by registration
+    std::vector<Counters> m_counters;    //!< the counters of the links
+    std::vector<uint32_t> m_sentBytes;   //!< bytes sent, m_capacity per link
+    std::vector<uint32_t> m_sentPackets; //!< packets sent, m_capacity per link
+    std::vector<uint32_t> m_dropped;     //!< packets dropped, m_capacity per link
+    uint32_t m_head;                     //!< slot of the oldest sample kept
+    uint32_t m_nSamples;                 //!< samples kept
+    uint64_t m_nLost;                    //!< samples overwritten
+    EventId m_event;                     //!< the next Sample ()
+};
+
+} // namespace ns3
+
+#endif /* LINK_STATS_HELPER_H */
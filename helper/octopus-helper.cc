@@ -12,6 +12,22 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("OctopusHelper");
 
+/**
+ * \param node a node
+ * \return the Octopus routing protocol of the node, or null if it is not an
+ * Octopus router
+ */
+static Ptr<OctopusRouting>
+GetOctopusRouting(Ptr<Node> node)
+{
+    Ptr<OctopusRouter> router = node->GetObject<OctopusRouter>();
+    if (!router)
+    {
+        return nullptr;
+    }
+    return DynamicCast<OctopusRouting>(router->GetRoutingProtocol());
+}
+
 OctopusHelper::OctopusHelper()
 {
 }
@@ -46,6 +62,7 @@ OctopusHelper::Create(Ptr<Node> node) const
 void
 OctopusHelper::PopulateRoutingTables(void)
 {
+    PhaseProfiler::Reset();
     std::clock_t t;
     t = clock();
     RouteManager::BuildLSDB();
@@ -53,20 +70,17 @@ OctopusHelper::PopulateRoutingTables(void)
     // Initialize Sockets
     for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
     {
-        Ptr<Node> node = *i;
-        Ptr<OctopusRouter> router = node->GetObject<OctopusRouter>();
-        if (!router)
+        Ptr<OctopusRouting> octopus = GetOctopusRouting(*i);
+        if (octopus)
         {
-            continue;
+            octopus->InitializeSocketList();
         }
-        Ptr<RomamRouting> routing = router->GetRoutingProtocol();
-        Ptr<OctopusRouting> octopus = DynamicCast<OctopusRouting>(routing);
-        octopus->InitializeSocketList();
     }
 
     t = clock() - t;
     uint32_t time_init_ms = 1000.0 * t / CLOCKS_PER_SEC;
     std::cout << "CPU time used for Romam Routing Protocol Init: " << time_init_ms << " ms\n";
+    PhaseProfiler::Report();
 }
 
 void
@@ -77,4 +91,60 @@ OctopusHelper::RecomputeRoutingTables(void)
     RouteManager::InitializeSPFRoutes();
 }
 
+bool
+OctopusHelper::SaveArmStates(const std::string& path)
+{
+    std::vector<ArmState> routeArms;
+    std::vector<ArmState> valueArms;
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<OctopusRouting> octopus = GetOctopusRouting(*i);
+        if (octopus)
+        {
+            octopus->SaveArmStates(routeArms, valueArms);
+        }
+    }
+    return ArmStateFile::Save(routeArms, valueArms, LSDBFile::ComputeTopologyHash(), path);
+}
+
+bool
+OctopusHelper::LoadArmStates(const std::string& path)
+{
+    std::vector<ArmState> routeArms;
+    std::vector<ArmState> valueArms;
+    if (!ArmStateFile::Load(path, LSDBFile::ComputeTopologyHash(), routeArms, valueArms))
+    {
+        return false;
+    }
+    // the arms of a node are handed to it at once
+    uint32_t nNodes = NodeList::GetNNodes();
+    std::vector<std::vector<ArmState>> nodeRouteArms(nNodes);
+    std::vector<std::vector<ArmState>> nodeValueArms(nNodes);
+    for (const ArmState& state : routeArms)
+    {
+        if (state.nodeId < nNodes)
+        {
+            nodeRouteArms[state.nodeId].push_back(state);
+        }
+    }
+    for (const ArmState& state : valueArms)
+    {
+        if (state.nodeId < nNodes)
+        {
+            nodeValueArms[state.nodeId].push_back(state);
+        }
+    }
+    uint32_t nRestored = 0;
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        Ptr<OctopusRouting> octopus = GetOctopusRouting(NodeList::GetNode(i));
+        if (octopus)
+        {
+            nRestored += octopus->RestoreArmStates(nodeRouteArms[i], nodeValueArms[i]);
+        }
+    }
+    NS_LOG_LOGIC("Restored " << nRestored << " arms from " << path);
+    return true;
+}
+
 } // namespace ns3
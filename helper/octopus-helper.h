@@ -8,6 +8,8 @@
 #include "ns3/node-container.h"
 #include "ns3/object-factory.h"
 
+#include <string>
+
 // #include "ns3/romam-module.h"
 
 namespace ns3
@@ -17,6 +19,9 @@ namespace ns3
  * \ingroup ipv4Helpers
  *
  * \brief Helper class that adds ns3::RomamRouting objects
+ *
+ * It installs OctopusRouting as the only routing protocol of the nodes, see
+ * RomamRoutingHelper.
  */
 class OctopusHelper : public Ipv4RoutingHelper
 {
@@ -73,6 +78,24 @@ class OctopusHelper : public Ipv4RoutingHelper
      */
     static void RecomputeRoutingTables(void);
 
+    /**
+     * \brief Write the arms of all the Octopus routers to a file, for the
+     * next runs on the same topology to start from, e.g., at the end of a
+     * simulation, before Simulator::Destroy ().
+     * \param path the file
+     * \return true if the file was written
+     */
+    static bool SaveArmStates(const std::string& path);
+
+    /**
+     * \brief Set the arms of all the Octopus routers to those of a file
+     * written by SaveArmStates (), after PopulateRoutingTables ().
+     * \param path the file
+     * \return false if the file is missing or was written on another
+     * topology, the arms then starting unexplored
+     */
+    static bool LoadArmStates(const std::string& path);
+
   private:
     /**
      * \brief Assignment operator declared private and not implemented to disallow
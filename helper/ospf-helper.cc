@@ -44,6 +44,7 @@ OSPFHelper::Create(Ptr<Node> node) const
 void
 OSPFHelper::PopulateRoutingTables(void)
 {
+    PhaseProfiler::Reset();
     std::clock_t t;
     t = clock();
     RouteManager::BuildLSDB();
@@ -51,6 +52,7 @@ OSPFHelper::PopulateRoutingTables(void)
     t = clock() - t;
     uint32_t time_init_ms = 1000.0 * t / CLOCKS_PER_SEC;
     std::cout << "CPU time used for OSPF Routing Protocol Init: " << time_init_ms << "\n";
+    PhaseProfiler::Report();
 }
 
 void
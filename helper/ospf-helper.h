@@ -17,6 +17,9 @@ namespace ns3
  * \ingroup ipv4Helpers
  *
  * \brief Helper class that adds ns3::RomamRouting objects
+ *
+ * It installs OSPFRouting as the only routing protocol of the nodes, see
+ * RomamRoutingHelper.
  */
 class OSPFHelper : public Ipv4RoutingHelper
 {
@@ -18,6 +18,12 @@ namespace ns3
  * \ingroup ipv4Helpers
  *
  * \brief Helper class that adds ns3::RomamRouting objects
+ *
+ * The routing helpers of the module (DDRHelper, DGRHelper, OSPFHelper and
+ * OctopusHelper) are given to InternetStackHelper::SetRoutingHelper ()
+ * directly: their protocol is then the only routing protocol of the nodes,
+ * and delivers the local packets itself, so no Ipv4ListRouting is put in
+ * front of it, which would only add a dispatch to every forwarding decision.
  */
 class RomamRoutingHelper : public Ipv4RoutingHelper
 {
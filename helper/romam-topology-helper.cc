@@ -0,0 +1,265 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "romam-topology-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/ipv4-address-generator.h"
+#include "ns3/ipv4.h"
+#include "ns3/log.h"
+#include "ns3/mac48-address.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/queue.h"
+#include "ns3/route-manager.h"
+
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RomamTopologyHelper");
+
+/**
+ * \brief Create the device of one end of a link, as PointToPointHelper does.
+ * \param node the node of the end
+ * \param deviceFactory the factory of the device
+ * \param queueFactory the factory of the queue of the device
+ * \return the device
+ */
+static Ptr<PointToPointNetDevice>
+CreateDevice(Ptr<Node> node, ObjectFactory& deviceFactory, ObjectFactory& queueFactory)
+{
+    Ptr<PointToPointNetDevice> device = deviceFactory.Create<PointToPointNetDevice>();
+    device->SetAddress(Mac48Address::Allocate());
+    node->AddDevice(device);
+    Ptr<Queue<Packet>> queue = queueFactory.Create<Queue<Packet>>();
+    device->SetQueue(queue);
+    // the queue discs are stopped and woken by the queue of the device
+    Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface>();
+    ndqi->GetTxQueue(0)->ConnectQueueTraces(queue);
+    device->AggregateObject(ndqi);
+    return device;
+}
+
+/**
+ * \brief Add a device to the Ipv4 of its node, with an address of a subnet.
+ * \param ipv4 the Ipv4 of the node
+ * \param device the device
+ * \param address the address of the device
+ * \param mask the mask of the subnet
+ * \param metric the metric of the interface
+ * \return the index of the interface
+ */
+static uint32_t
+AddInterface(Ptr<Ipv4> ipv4,
+             Ptr<NetDevice> device,
+             Ipv4Address address,
+             Ipv4Mask mask,
+             uint16_t metric)
+{
+    int32_t ifIndex = ipv4->AddInterface(device);
+    NS_ABORT_MSG_IF(ifIndex == -1, "Cannot add an interface for " << address);
+    Ipv4AddressGenerator::AddAllocated(address);
+    ipv4->AddAddress(ifIndex, Ipv4InterfaceAddress(address, mask));
+    ipv4->SetMetric(ifIndex, metric);
+    ipv4->SetUp(ifIndex);
+    return ifIndex;
+}
+
+RomamTopologyHelper::RomamTopologyHelper()
+    : m_tch(TrafficControlHelper::Default()),
+      m_delayUnit(MilliSeconds(1)),
+      m_network("10.0.0.0"),
+      m_mask("255.255.255.252"),
+      m_loopbacks(false),
+      m_nNodes(0)
+{
+    m_queueFactory.SetTypeId("ns3::DropTailQueue<Packet>");
+    m_deviceFactory.SetTypeId("ns3::PointToPointNetDevice");
+    m_channelFactory.SetTypeId("ns3::PointToPointChannel");
+}
+
+void
+RomamTopologyHelper::SetDeviceAttribute(std::string name, const AttributeValue& value)
+{
+    m_deviceFactory.Set(name, value);
+}
+
+void
+RomamTopologyHelper::SetChannelAttribute(std::string name, const AttributeValue& value)
+{
+    m_channelFactory.Set(name, value);
+}
+
+void
+RomamTopologyHelper::SetTrafficControl(const TrafficControlHelper& tch)
+{
+    m_tch = tch;
+}
+
+void
+RomamTopologyHelper::SetDelayUnit(Time unit)
+{
+    m_delayUnit = unit;
+}
+
+void
+RomamTopologyHelper::SetBase(Ipv4Address network, Ipv4Mask mask)
+{
+    NS_ABORT_MSG_IF(~mask.Get() < 3, "The subnet of a link needs two hosts");
+    m_network = network.CombineMask(mask);
+    m_mask = mask;
+}
+
+void
+RomamTopologyHelper::SetLoopbackBase(Ipv4Address network)
+{
+    m_loopbacks = true;
+    m_loopbackBase = network;
+}
+
+bool
+RomamTopologyHelper::Read(const std::string& path)
+{
+    NS_LOG_FUNCTION(this << path);
+    RomamTopologyReader reader;
+    if (!reader.Read(path))
+    {
+        return false;
+    }
+    SetTopology(reader);
+    return true;
+}
+
+void
+RomamTopologyHelper::SetTopology(const RomamTopologyReader& reader)
+{
+    NS_LOG_FUNCTION(this);
+    const std::vector<RomamTopologyReader::Link>& links = reader.GetLinks();
+    m_nNodes = reader.GetNNodes();
+    m_edges.clear();
+    m_edges.reserve(links.size());
+    m_links.clear();
+    for (const RomamTopologyReader::Link& link : links)
+    {
+        NS_ABORT_MSG_IF(link.weight > std::numeric_limits<uint16_t>::max(),
+                        "Weight " << link.weight << " is not a metric");
+        m_edges.push_back(Edge{link.from, link.to, static_cast<uint16_t>(link.weight)});
+    }
+}
+
+void
+RomamTopologyHelper::SetTopology(const TopologyGeneratorHelper& generator)
+{
+    NS_LOG_FUNCTION(this);
+    const std::vector<TopologyGeneratorHelper::Link>& links = generator.GetLinks();
+    m_nNodes = generator.GetNNodes();
+    m_edges.clear();
+    m_edges.reserve(links.size());
+    m_links.clear();
+    for (const TopologyGeneratorHelper::Link& link : links)
+    {
+        NS_ABORT_MSG_IF(link.weight > std::numeric_limits<uint16_t>::max(),
+                        "Weight " << link.weight << " is not a metric");
+        m_edges.push_back(Edge{link.from, link.to, static_cast<uint16_t>(link.weight)});
+    }
+}
+
+uint32_t
+RomamTopologyHelper::GetNNodes() const
+{
+    return m_nNodes;
+}
+
+NodeContainer
+RomamTopologyHelper::CreateNodes() const
+{
+    NS_LOG_FUNCTION(this);
+    NodeContainer nodes;
+    nodes.Create(m_nNodes);
+    return nodes;
+}
+
+NetDeviceContainer
+RomamTopologyHelper::Install(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_IF(nodes.GetN() != m_nNodes,
+                    "The topology has " << m_nNodes << " nodes, not " << nodes.GetN());
+    uint32_t subnetSize = ~m_mask.Get() + 1;
+    NS_ABORT_MSG_IF(static_cast<uint64_t>(m_edges.size()) * subnetSize >
+                        ~m_network.Get() + static_cast<uint64_t>(1),
+                    "Not enough subnets from " << m_network << " for " << m_edges.size()
+                                               << " links");
+
+    std::vector<Ptr<Ipv4>> ipv4s(m_nNodes);
+    for (uint32_t i = 0; i < m_nNodes; i++)
+    {
+        ipv4s[i] = nodes.Get(i)->GetObject<Ipv4>();
+        NS_ABORT_MSG_IF(!ipv4s[i], "Node " << i << " has no Internet stack");
+    }
+    if (m_loopbacks)
+    {
+        NS_ABORT_MSG_IF(m_nNodes > ~m_loopbackBase.Get(),
+                        "Not enough addresses after " << m_loopbackBase << " for " << m_nNodes
+                                                      << " loopbacks");
+        for (uint32_t i = 0; i < m_nNodes; i++)
+        {
+            Ipv4Address loopback(m_loopbackBase.Get() + i + 1);
+            Ipv4AddressGenerator::AddAllocated(loopback);
+            ipv4s[i]->AddAddress(0, Ipv4InterfaceAddress(loopback, Ipv4Mask::GetOnes()));
+        }
+    }
+
+    NetDeviceContainer devices;
+    for (const Edge& edge : m_edges)
+    {
+        Ptr<PointToPointNetDevice> fromDevice =
+            CreateDevice(nodes.Get(edge.from), m_deviceFactory, m_queueFactory);
+        Ptr<PointToPointNetDevice> toDevice =
+            CreateDevice(nodes.Get(edge.to), m_deviceFactory, m_queueFactory);
+        Ptr<PointToPointChannel> channel = m_channelFactory.Create<PointToPointChannel>();
+        channel->SetAttribute("Delay", TimeValue(m_delayUnit * edge.weight));
+        fromDevice->Attach(channel);
+        toDevice->Attach(channel);
+        devices.Add(fromDevice);
+        devices.Add(toDevice);
+    }
+    m_tch.Install(devices);
+
+    m_links.clear();
+    m_links.reserve(m_edges.size());
+    uint32_t network = m_network.Get();
+    for (uint32_t i = 0; i < m_edges.size(); i++)
+    {
+        const Edge& edge = m_edges[i];
+        Link link;
+        link.from = edge.from;
+        link.to = edge.to;
+        link.metric = RouteManager::GetDelayMetric(m_delayUnit * edge.weight);
+        link.fromIfIndex = AddInterface(ipv4s[edge.from],
+                                        devices.Get(2 * i),
+                                        Ipv4Address(network + 1),
+                                        m_mask,
+                                        link.metric);
+        link.toIfIndex = AddInterface(ipv4s[edge.to],
+                                      devices.Get(2 * i + 1),
+                                      Ipv4Address(network + 2),
+                                      m_mask,
+                                      link.metric);
+        m_links.push_back(link);
+        network += subnetSize;
+    }
+    NS_LOG_LOGIC("Installed " << m_links.size() << " links");
+    return devices;
+}
+
+const std::vector<RomamTopologyHelper::Link>&
+RomamTopologyHelper::GetLinks() const
+{
+    return m_links;
+}
+
+} // namespace ns3
@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROMAM_TOPOLOGY_HELPER_H
+#define ROMAM_TOPOLOGY_HELPER_H
+
+#include "romam-topology-reader.h"
+#include "topology-generator-helper.h"
+
+#include "ns3/attribute.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/traffic-control-helper.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief A helper to build the point-to-point network of a router topology
+ * in one pass.
+ *
+ * The topology is read from a file in the Inet format of the topo
+ * directory, or taken from a TopologyGeneratorHelper.  The weight of a link
+ * is its delay, in units of SetDelayUnit (), and its metric is that delay in
+ * units of RouteManager::GetMetricDelay (), so the distances of the SPF trees
+ * are propagation delays.  Install ()
+ * then creates the devices and channels of all the links, installs the
+ * queue discs on all of them with one TrafficControlHelper call and gives
+ * each link a subnet of consecutive addresses, without going through
+ * PointToPointHelper, TrafficControlHelper and Ipv4AddressHelper once per
+ * link.
+ *
+ * Unlike TopologyReader, which numbers the nodes in the order they appear in
+ * the links, node i of the container is the node of id i of the topology.
+ * The links Install () creates are kept in a table, with the interfaces of
+ * their two ends, for the code that needs the adjacency of the routers
+ * without walking their Ipv4 interfaces.
+ */
+class RomamTopologyHelper
+{
+  public:
+    /// A link of the topology
+    struct Link
+    {
+        uint32_t from;        //!< index of a node
+        uint32_t to;          //!< index of the other node
+        uint32_t fromIfIndex; //!< interface of the link on the first node
+        uint32_t toIfIndex;   //!< interface of the link on the other node
+        uint16_t metric;      //!< metric of the link, from its delay
+    };
+
+    RomamTopologyHelper();
+
+    /**
+     * \brief Set an attribute of the PointToPointNetDevices created.
+     * \param name the name of the attribute
+     * \param value the value of the attribute
+     */
+    void SetDeviceAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * \brief Set an attribute of the PointToPointChannels created; their
+     * Delay is set from the weights of the links.
+     * \param name the name of the attribute
+     * \param value the value of the attribute
+     */
+    void SetChannelAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * \brief Set the queue disc installed on every device.  Without it, the
+     * default one of TrafficControlHelper is, as Ipv4AddressHelper does.
+     * \param tch the helper holding the queue disc configuration
+     */
+    void SetTrafficControl(const TrafficControlHelper& tch);
+
+    /**
+     * \brief Set the time of a unit of weight, 1ms by default.
+     * \param unit the delay of a link of weight 1
+     */
+    void SetDelayUnit(Time unit);
+
+    /**
+     * \brief Set the addresses of the links, each one taking the next subnet
+     * of the mask from the network: 10.0.0.0/30 by default.
+     * \param network the first subnet
+     * \param mask the mask of a subnet, of at least two hosts
+     */
+    void SetBase(Ipv4Address network, Ipv4Mask mask);
+
+    /**
+     * \brief Give every router a loopback address, node i taking the
+     * (i + 1)th address after network as a /32 on its loopback interface.
+     *
+     * The routers are then reached at their loopback address: it is the one
+     * RomamRouter::GetNodeAddress () returns, the route computations install
+     * a route to it, and the addresses of the links stay unnumbered for
+     * them, so the tables of the routers hold routes to the routers instead
+     * of to the ends of every link.
+     *
+     * \param network the address before the loopback of node 0
+     */
+    void SetLoopbackBase(Ipv4Address network);
+
+    /**
+     * \brief Read a topology in the Inet format: a line "nodes links", a
+     * line "id x y" per node, then a line "from to weight" per link, with a
+     * RomamTopologyReader.
+     * \param path the file
+     * \return false if the file cannot be read or holds no link
+     */
+    bool Read(const std::string& path);
+
+    /**
+     * \brief Take the topology of a reader.
+     * \param reader the reader
+     */
+    void SetTopology(const RomamTopologyReader& reader);
+
+    /**
+     * \brief Take the topology of a generator.
+     * \param generator the generator
+     */
+    void SetTopology(const TopologyGeneratorHelper& generator);
+
+    /**
+     * \return the number of nodes of the topology
+     */
+    uint32_t GetNNodes() const;
+
+    /**
+     * \brief Create the nodes of the topology, node i of the container being
+     * the node of id i.
+     * \return the nodes
+     */
+    NodeContainer CreateNodes() const;
+
+    /**
+     * \brief Build the links of the topology between the nodes, which must
+     * have an Internet stack.
+     * \param nodes the nodes of the topology, in the order of their id
+     * \return the devices, the two ends of each link in turn
+     */
+    NetDeviceContainer Install(NodeContainer nodes);
+
+    /**
+     * \return the links installed, in the order of the topology
+     */
+    const std::vector<Link>& GetLinks() const;
+
+  private:
+    /// A link of the topology, before it is installed
+    struct Edge
+    {
+        uint32_t from;   //!< index of a node
+        uint32_t to;     //!< index of the other node
+        uint16_t weight; //!< weight of the link
+    };
+
+    ObjectFactory m_queueFactory;   //!< queues of the devices
+    ObjectFactory m_deviceFactory;  //!< devices of the links
+    ObjectFactory m_channelFactory; //!< channels of the links
+    TrafficControlHelper m_tch;     //!< queue discs of the devices
+    Time m_delayUnit;               //!< delay of a unit of weight
+    Ipv4Address m_network;          //!< subnet of the first link
+    Ipv4Mask m_mask;                //!< mask of the subnets
+    bool m_loopbacks;               //!< give every router a loopback address
+    Ipv4Address m_loopbackBase;     //!< address before the loopback of node 0
+    uint32_t m_nNodes;              //!< number of nodes
+    std::vector<Edge> m_edges;      //!< the links to install
+    std::vector<Link> m_links;      //!< the links installed
+};
+
+} // namespace ns3
+
+#endif /* ROMAM_TOPOLOGY_HELPER_H */
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "romam-topology-reader.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RomamTopologyReader");
+
+/**
+ * \brief Skip the blanks of a line.
+ * \param p the position, moved past the blanks
+ * \param end the end of the content
+ */
+static void
+SkipBlanks(const char*& p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    {
+        p++;
+    }
+}
+
+/**
+ * \brief Move to the start of the next line.
+ * \param p the position, moved past the end of its line
+ * \param end the end of the content
+ */
+static void
+SkipLine(const char*& p, const char* end)
+{
+    const void* newline = std::memchr(p, '\n', end - p);
+    p = newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+/**
+ * \brief Parse an unsigned integer of the line, after blanks.
+ * \param p the position, moved past the integer
+ * \param end the end of the content
+ * \param value set to the integer
+ * \return false if no integer of 32 bits is there
+ */
+static bool
+ParseInteger(const char*& p, const char* end, uint32_t& value)
+{
+    SkipBlanks(p, end);
+    if (p == end || *p < '0' || *p > '9')
+    {
+        return false;
+    }
+    uint64_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        v = v * 10 + (*p - '0');
+        if (v > UINT32_MAX)
+        {
+            return false;
+        }
+        p++;
+    }
+    value = v;
+    return true;
+}
+
+/**
+ * \brief Move to the next line that is not blank.
+ * \param p the position, moved to the start of the line
+ * \param end the end of the content
+ */
+static void
+SkipEmptyLines(const char*& p, const char* end)
+{
+    const char* q = p;
+    while (q < end)
+    {
+        SkipBlanks(q, end);
+        if (q < end && *q != '\n')
+        {
+            break;
+        }
+        if (q < end)
+        {
+            q++;
+        }
+        p = q;
+    }
+}
+
+RomamTopologyReader::RomamTopologyReader()
+    : m_nNodes(0)
+{
+}
+
+bool
+RomamTopologyReader::Read(const std::string& path)
+{
+    NS_LOG_FUNCTION(this << path);
+    Clear();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        NS_LOG_ERROR("Cannot open the topology " << path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        NS_LOG_ERROR("Cannot read the topology " << path);
+        close(fd);
+        return false;
+    }
+    std::size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        NS_LOG_ERROR("Cannot map the topology " << path);
+        return false;
+    }
+    // the file is read once, front to back
+    madvise(map, size, MADV_SEQUENTIAL);
+    bool valid = Parse(static_cast<const char*>(map), size);
+    munmap(map, size);
+    if (!valid)
+    {
+        NS_LOG_ERROR("Cannot parse the topology " << path);
+    }
+    return valid;
+}
+
+bool
+RomamTopologyReader::Parse(const char* data, std::size_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    Clear();
+    const char* p = data;
+    const char* end = data + size;
+    uint32_t nNodes;
+    uint32_t nLinks;
+    SkipEmptyLines(p, end);
+    if (!ParseInteger(p, end, nNodes) || !ParseInteger(p, end, nLinks) || nLinks == 0)
+    {
+        return false;
+    }
+    SkipLine(p, end);
+    // the coordinates of the nodes are not used
+    for (uint32_t i = 0; i < nNodes && p < end; i++)
+    {
+        SkipLine(p, end);
+    }
+    // a link line takes 6 bytes at least, whatever the count of the header says
+    m_links.reserve(std::min<std::size_t>(nLinks, (end - p) / 6 + 1));
+    while (m_links.size() < nLinks)
+    {
+        SkipEmptyLines(p, end);
+        if (p == end)
+        {
+            break;
+        }
+        Link link;
+        if (!ParseInteger(p, end, link.from) || !ParseInteger(p, end, link.to) ||
+            !ParseInteger(p, end, link.weight))
+        {
+            NS_LOG_WARN("Malformed link " << m_links.size());
+            Clear();
+            return false;
+        }
+        if (link.from >= nNodes || link.to >= nNodes)
+        {
+            NS_LOG_WARN("Link " << link.from << " " << link.to << " to an unknown node");
+            Clear();
+            return false;
+        }
+        m_links.push_back(link);
+        SkipLine(p, end);
+    }
+    m_nNodes = nNodes;
+    NS_LOG_LOGIC("Read " << nNodes << " nodes and " << m_links.size() << " links");
+    return !m_links.empty();
+}
+
+uint32_t
+RomamTopologyReader::GetNNodes() const
+{
+    return m_nNodes;
+}
+
+const std::vector<RomamTopologyReader::Link>&
+RomamTopologyReader::GetLinks() const
+{
+    return m_links;
+}
+
+void
+RomamTopologyReader::Clear()
+{
+    m_nNodes = 0;
+    std::vector<Link>().swap(m_links);
+}
+
+} // namespace ns3
@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROMAM_TOPOLOGY_READER_H
+#define ROMAM_TOPOLOGY_READER_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief A reader of the topology files in the Inet format of the topo
+ * directory, for files of millions of links.
+ *
+ * The file is a line "nodes links", a line "id x y" per node, then a line
+ * "from to weight" per link, the fields being unsigned integers; what
+ * follows the weight on a link line is ignored.  Instead of going through
+ * the streams and the attribute maps of TopologyReader, Read () maps the
+ * file, parses the integers in place and appends every link to an array of
+ * 12 bytes per link, which RomamTopologyHelper builds the network from.
+ */
+class RomamTopologyReader
+{
+  public:
+    /// A link of the topology
+    struct Link
+    {
+        uint32_t from;   //!< index of a node
+        uint32_t to;     //!< index of the other node
+        uint32_t weight; //!< weight of the link
+    };
+
+    RomamTopologyReader();
+
+    /**
+     * \brief Read a topology file, replacing the topology.
+     * \param path the file
+     * \return false if the file cannot be read, is malformed or holds no link
+     */
+    bool Read(const std::string& path);
+
+    /**
+     * \brief Parse a topology held in memory, replacing the topology.
+     * \param data the content of a topology file
+     * \param size the size of the content
+     * \return false if the content is malformed or holds no link
+     */
+    bool Parse(const char* data, std::size_t size);
+
+    /**
+     * \return the number of nodes of the topology
+     */
+    uint32_t GetNNodes() const;
+
+    /**
+     * \return the links of the topology, in the order of the file
+     */
+    const std::vector<Link>& GetLinks() const;
+
+    /**
+     * \brief Remove the topology, releasing the links.
+     */
+    void Clear();
+
+  private:
+    uint32_t m_nNodes;         //!< number of nodes
+    std::vector<Link> m_links; //!< the links
+};
+
+} // namespace ns3
+
+#endif /* ROMAM_TOPOLOGY_READER_H */
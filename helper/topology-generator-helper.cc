@@ -0,0 +1,311 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "topology-generator-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TopologyGeneratorHelper");
+
+/// side of the square the nodes of the geometric graphs are placed in
+static const double SQUARE_SIDE = 1000;
+
+/**
+ * \param parents the parent of every node, a node being the root of its set
+ * \param i a node
+ * \return the root of the set of the node
+ */
+static uint32_t
+FindRoot(std::vector<uint32_t>& parents, uint32_t i)
+{
+    while (parents[i] != i)
+    {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+TopologyGeneratorHelper::TopologyGeneratorHelper()
+    : m_nNodes(0)
+{
+    Ptr<ConstantRandomVariable> weight = CreateObject<ConstantRandomVariable>();
+    weight->SetAttribute("Constant", DoubleValue(1));
+    m_weight = weight;
+    m_uniform = CreateObject<UniformRandomVariable>();
+}
+
+void
+TopologyGeneratorHelper::SetWeight(Ptr<RandomVariableStream> weight)
+{
+    NS_ABORT_MSG_IF(!weight, "No weight distribution");
+    m_weight = weight;
+}
+
+int64_t
+TopologyGeneratorHelper::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_weight->SetStream(stream);
+    m_uniform->SetStream(stream + 1);
+    return 2;
+}
+
+void
+TopologyGeneratorHelper::GenerateGrid(uint32_t rows, uint32_t columns)
+{
+    NS_LOG_FUNCTION(this << rows << columns);
+    NS_ABORT_MSG_IF(rows == 0 || columns == 0, "A grid needs rows and columns");
+    Reset(rows * columns);
+    m_links.reserve(2 * rows * columns);
+    for (uint32_t r = 0; r < rows; r++)
+    {
+        for (uint32_t c = 0; c < columns; c++)
+        {
+            uint32_t i = r * columns + c;
+            m_points[i] = std::make_pair(c, r);
+            if (c + 1 < columns)
+            {
+                AddLink(i, i + 1);
+            }
+            if (r + 1 < rows)
+            {
+                AddLink(i, i + columns);
+            }
+        }
+    }
+}
+
+void
+TopologyGeneratorHelper::GenerateFatTree(uint32_t k)
+{
+    NS_LOG_FUNCTION(this << k);
+    NS_ABORT_MSG_IF(k == 0 || k % 2 != 0, "The arity of a fat-tree must be even");
+    uint32_t half = k / 2;
+    uint32_t nCores = half * half;
+    Reset(nCores + k * k);
+    m_links.reserve(k * k * half);
+    for (uint32_t i = 0; i < nCores; i++)
+    {
+        m_points[i] = std::make_pair(i, 0);
+    }
+    for (uint32_t pod = 0; pod < k; pod++)
+    {
+        uint32_t aggregation = nCores + pod * k;
+        uint32_t edge = aggregation + half;
+        for (uint32_t j = 0; j < half; j++)
+        {
+            m_points[aggregation + j] = std::make_pair(pod * half + j, 1);
+            m_points[edge + j] = std::make_pair(pod * half + j, 2);
+            // aggregation switch j reaches the j-th group of core switches
+            for (uint32_t c = 0; c < half; c++)
+            {
+                AddLink(j * half + c, aggregation + j);
+            }
+            for (uint32_t e = 0; e < half; e++)
+            {
+                AddLink(aggregation + j, edge + e);
+            }
+        }
+    }
+}
+
+void
+TopologyGeneratorHelper::GenerateWaxman(uint32_t nNodes, double alpha, double beta)
+{
+    NS_LOG_FUNCTION(this << nNodes << alpha << beta);
+    NS_ABORT_MSG_IF(nNodes == 0, "A graph needs nodes");
+    NS_ABORT_MSG_IF(alpha <= 0 || alpha > 1 || beta <= 0 || beta > 1,
+                    "The Waxman parameters must be in (0, 1]");
+    Reset(nNodes);
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        m_points[i] = std::make_pair(m_uniform->GetValue(0, SQUARE_SIDE),
+                                     m_uniform->GetValue(0, SQUARE_SIDE));
+    }
+    double scale = alpha * SQUARE_SIDE * std::sqrt(2.0);
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        for (uint32_t j = i + 1; j < nNodes; j++)
+        {
+            double d = std::hypot(m_points[i].first - m_points[j].first,
+                                  m_points[i].second - m_points[j].second);
+            if (m_uniform->GetValue(0, 1) < beta * std::exp(-d / scale))
+            {
+                AddLink(i, j);
+            }
+        }
+    }
+    Connect();
+}
+
+void
+TopologyGeneratorHelper::GenerateBarabasiAlbert(uint32_t nNodes, uint32_t m)
+{
+    NS_LOG_FUNCTION(this << nNodes << m);
+    NS_ABORT_MSG_IF(m == 0 || nNodes <= m, "A Barabasi-Albert graph needs more than m nodes");
+    Reset(nNodes);
+    m_links.reserve((m + 1) * m / 2 + (nNodes - m - 1) * m);
+    // every node appears once per link it has, so a uniform draw follows the degrees
+    std::vector<uint32_t> ends;
+    ends.reserve(2 * m * nNodes);
+    for (uint32_t i = 0; i <= m; i++)
+    {
+        for (uint32_t j = i + 1; j <= m; j++)
+        {
+            AddLink(i, j);
+            ends.push_back(i);
+            ends.push_back(j);
+        }
+    }
+    std::vector<uint32_t> targets;
+    for (uint32_t i = m + 1; i < nNodes; i++)
+    {
+        targets.clear();
+        while (targets.size() < m)
+        {
+            uint32_t target = ends[m_uniform->GetInteger(0, ends.size() - 1)];
+            if (std::find(targets.begin(), targets.end(), target) == targets.end())
+            {
+                targets.push_back(target);
+            }
+        }
+        for (uint32_t target : targets)
+        {
+            AddLink(target, i);
+            ends.push_back(target);
+            ends.push_back(i);
+        }
+    }
+}
+
+void
+TopologyGeneratorHelper::GenerateRingOfCliques(uint32_t nCliques, uint32_t cliqueSize)
+{
+    NS_LOG_FUNCTION(this << nCliques << cliqueSize);
+    NS_ABORT_MSG_IF(nCliques == 0 || cliqueSize == 0, "A ring of cliques needs nodes");
+    Reset(nCliques * cliqueSize);
+    m_links.reserve(nCliques * (cliqueSize * (cliqueSize - 1) / 2 + 1));
+    for (uint32_t c = 0; c < nCliques; c++)
+    {
+        uint32_t first = c * cliqueSize;
+        for (uint32_t i = first; i < first + cliqueSize; i++)
+        {
+            m_points[i] = std::make_pair(i - first, c);
+            for (uint32_t j = i + 1; j < first + cliqueSize; j++)
+            {
+                AddLink(i, j);
+            }
+        }
+    }
+    // two cliques are only linked once, and one clique is not linked to itself
+    uint32_t nRingLinks = nCliques == 2 ? 1 : (nCliques == 1 ? 0 : nCliques);
+    for (uint32_t c = 0; c < nRingLinks; c++)
+    {
+        AddLink(c * cliqueSize + cliqueSize - 1, (c + 1) % nCliques * cliqueSize);
+    }
+}
+
+uint32_t
+TopologyGeneratorHelper::GetNNodes() const
+{
+    return m_nNodes;
+}
+
+const std::vector<TopologyGeneratorHelper::Link>&
+TopologyGeneratorHelper::GetLinks() const
+{
+    return m_links;
+}
+
+NodeContainer
+TopologyGeneratorHelper::CreateNodes() const
+{
+    NS_LOG_FUNCTION(this);
+    NodeContainer nodes;
+    nodes.Create(m_nNodes);
+    return nodes;
+}
+
+void
+TopologyGeneratorHelper::Write(const std::string& path) const
+{
+    NS_LOG_FUNCTION(this << path);
+    std::ofstream out(path);
+    NS_ABORT_MSG_IF(!out, "Cannot write the topology " << path);
+    out << m_nNodes << ' ' << m_links.size() << '\n';
+    for (uint32_t i = 0; i < m_nNodes; i++)
+    {
+        out << i << ' ' << std::lround(m_points[i].first) << ' ' << std::lround(m_points[i].second)
+            << '\n';
+    }
+    for (const Link& link : m_links)
+    {
+        out << link.from << ' ' << link.to << ' ' << link.weight << '\n';
+    }
+    NS_ABORT_MSG_IF(!out, "Cannot write the topology " << path);
+}
+
+void
+TopologyGeneratorHelper::Reset(uint32_t nNodes)
+{
+    m_nNodes = nNodes;
+    m_points.assign(nNodes, std::make_pair(0.0, 0.0));
+    m_links.clear();
+}
+
+void
+TopologyGeneratorHelper::AddLink(uint32_t from, uint32_t to)
+{
+    long weight = std::lround(m_weight->GetValue());
+    m_links.push_back(Link{from, to, static_cast<uint32_t>(std::max(weight, 1L))});
+}
+
+void
+TopologyGeneratorHelper::Connect()
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<uint32_t> parents(m_nNodes);
+    for (uint32_t i = 0; i < m_nNodes; i++)
+    {
+        parents[i] = i;
+    }
+    for (const Link& link : m_links)
+    {
+        parents[FindRoot(parents, link.from)] = FindRoot(parents, link.to);
+    }
+    // the nodes linked to node 0 so far, to draw the end of the next link from
+    std::vector<uint32_t> connected;
+    std::vector<std::vector<uint32_t>> components(m_nNodes);
+    for (uint32_t i = 0; i < m_nNodes; i++)
+    {
+        components[FindRoot(parents, i)].push_back(i);
+    }
+    uint32_t nComponents = 0;
+    for (uint32_t i = 0; i < m_nNodes; i++)
+    {
+        const std::vector<uint32_t>& component = components[FindRoot(parents, i)];
+        if (component.empty() || component.front() != i)
+        {
+            continue;
+        }
+        if (!connected.empty())
+        {
+            uint32_t from = connected[m_uniform->GetInteger(0, connected.size() - 1)];
+            AddLink(from, component[m_uniform->GetInteger(0, component.size() - 1)]);
+        }
+        connected.insert(connected.end(), component.begin(), component.end());
+        nComponents++;
+    }
+    NS_LOG_LOGIC("Linked " << nComponents << " components");
+}
+
+} // namespace ns3
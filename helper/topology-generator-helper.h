@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TOPOLOGY_GENERATOR_HELPER_H
+#define TOPOLOGY_GENERATOR_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief A helper to generate synthetic router topologies, for runs larger
+ * than the topologies of the topo directory.
+ *
+ * Each Generate function replaces the topology with a new one: a grid, a
+ * k-ary fat-tree, a Waxman or Barabasi-Albert random graph, or a ring of
+ * cliques.  The graphs are connected and have no parallel link.  The weight
+ * of every link, which the examples use as both its delay in milliseconds
+ * and its metric, is drawn from a random variable.
+ *
+ * The topology is written to a file in the Inet format of the topo
+ * directory, which TopologyReaderHelper reads, or used directly: nodes
+ * from CreateNodes() and links from GetLinks().
+ */
+class TopologyGeneratorHelper
+{
+  public:
+    /// A link of the topology
+    struct Link
+    {
+        uint32_t from;   //!< index of a node
+        uint32_t to;     //!< index of the other node
+        uint32_t weight; //!< weight of the link, at least 1
+    };
+
+    TopologyGeneratorHelper();
+
+    /**
+     * \brief Draw the weights of the links from a random variable, rounded to
+     * the nearest integer of at least 1.  The weights are 1 by default.
+     * \param weight the random variable
+     */
+    void SetWeight(Ptr<RandomVariableStream> weight);
+
+    /**
+     * \brief Assign a fixed random variable stream number to the random
+     * variables used by this helper.
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this helper
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * \brief Generate a grid, each router linked to its horizontal and
+     * vertical neighbors, as the NxN topologies of the topo directory.
+     * \param rows the number of rows
+     * \param columns the number of columns
+     */
+    void GenerateGrid(uint32_t rows, uint32_t columns);
+
+    /**
+     * \brief Generate the switches of a k-ary fat-tree: (k/2)^2 core
+     * switches, then k pods of k/2 aggregation and k/2 edge switches.
+     * \param k the arity, even
+     */
+    void GenerateFatTree(uint32_t k);
+
+    /**
+     * \brief Generate a Waxman random graph.
+     *
+     * The nodes are placed uniformly in a square, and two nodes at distance
+     * d are linked with probability beta exp (-d / (alpha L)), L being the
+     * diagonal of the square.  The components are then linked to each other.
+     *
+     * \param nNodes the number of nodes
+     * \param alpha the ratio of long links to short ones, in (0, 1]
+     * \param beta the density of links, in (0, 1]
+     */
+    void GenerateWaxman(uint32_t nNodes, double alpha, double beta);
+
+    /**
+     * \brief Generate a Barabasi-Albert graph: from a clique of m + 1 nodes,
+     * each new node is linked to m nodes drawn in proportion to their degree.
+     * \param nNodes the number of nodes, more than m
+     * \param m the links of each new node, at least 1
+     */
+    void GenerateBarabasiAlbert(uint32_t nNodes, uint32_t m);
+
+    /**
+     * \brief Generate a ring of cliques, the last node of each clique linked
+     * to the first one of the next clique.
+     * \param nCliques the number of cliques
+     * \param cliqueSize the number of nodes of a clique
+     */
+    void GenerateRingOfCliques(uint32_t nCliques, uint32_t cliqueSize);
+
+    /**
+     * \return the number of nodes
+     */
+    uint32_t GetNNodes() const;
+
+    /**
+     * \return the links
+     */
+    const std::vector<Link>& GetLinks() const;
+
+    /**
+     * \brief Create the nodes of the topology, node i of the container being
+     * the node of index i of the links.
+     * \return the nodes
+     */
+    NodeContainer CreateNodes() const;
+
+    /**
+     * \brief Write the topology in the Inet format: a line "nodes links",
+     * a line "id x y" per node, then a line "from to weight" per link.
+     * \param path the file
+     */
+    void Write(const std::string& path) const;
+
+  private:
+    /**
+     * \brief Start a new topology.
+     * \param nNodes the number of nodes
+     */
+    void Reset(uint32_t nNodes);
+
+    /**
+     * \brief Add a link, with a weight drawn.
+     * \param from index of a node
+     * \param to index of the other node
+     */
+    void AddLink(uint32_t from, uint32_t to);
+
+    /**
+     * \brief Link every component of the topology to the ones before it, by
+     * a link between random nodes.
+     */
+    void Connect();
+
+    uint32_t m_nNodes;                               //!< number of nodes
+    std::vector<std::pair<double, double>> m_points; //!< coordinates of the nodes
+    std::vector<Link> m_links;                       //!< the links
+    Ptr<RandomVariableStream> m_weight;              //!< weight of the links
+    Ptr<UniformRandomVariable> m_uniform;            //!< draws of the random graphs
+};
+
+} // namespace ns3
+
+#endif /* TOPOLOGY_GENERATOR_HELPER_H */
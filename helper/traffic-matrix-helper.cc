@@ -0,0 +1,209 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "traffic-matrix-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4.h"
+#include "ns3/log.h"
+#include "ns3/romam-module.h"
+#include "ns3/string.h"
+#include "ns3/udp-socket-factory.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TrafficMatrixHelper");
+
+TrafficMatrixHelper::TrafficMatrixHelper(uint16_t port)
+    : m_port(port),
+      m_packetSize(1024),
+      m_flag(false)
+{
+    m_sourceFactory.SetTypeId("ns3::RomamUdpApplication");
+    m_sinkFactory.SetTypeId("ns3::RomamSink");
+    m_sinkFactory.Set("Protocol", TypeIdValue(UdpSocketFactory::GetTypeId()));
+    m_sinkFactory.Set("Local", AddressValue(InetSocketAddress(Ipv4Address::GetAny(), port)));
+}
+
+void
+TrafficMatrixHelper::AddDemand(uint32_t source, uint32_t destination, DataRate rate)
+{
+    if (source == destination || rate.GetBitRate() == 0)
+    {
+        return;
+    }
+    m_demands.push_back(Demand{source, destination, rate});
+}
+
+void
+TrafficMatrixHelper::LoadFile(const std::string& path)
+{
+    NS_LOG_FUNCTION(this << path);
+    std::ifstream in(path);
+    NS_ABORT_MSG_IF(!in, "Cannot read the traffic matrix " << path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string source;
+        uint32_t destination;
+        std::string rate;
+        if (!(fields >> source) || source[0] == '#')
+        {
+            continue;
+        }
+        NS_ABORT_MSG_IF(!(fields >> destination >> rate), "Bad traffic matrix line: " << line);
+        AddDemand(std::stoul(source), destination, DataRate(rate));
+    }
+}
+
+void
+TrafficMatrixHelper::GenerateUniform(uint32_t nNodes, DataRate rate)
+{
+    NS_LOG_FUNCTION(this << nNodes << rate);
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        for (uint32_t j = 0; j < nNodes; j++)
+        {
+            AddDemand(i, j, rate);
+        }
+    }
+}
+
+void
+TrafficMatrixHelper::GenerateGravity(const std::vector<double>& weights, DataRate total)
+{
+    NS_LOG_FUNCTION(this << weights.size() << total);
+    double sum = 0;
+    double sumSquares = 0;
+    for (double w : weights)
+    {
+        sum += w;
+        sumSquares += w * w;
+    }
+    // the sum of the products of the weights of the pairs of distinct nodes
+    double pairs = sum * sum - sumSquares;
+    if (pairs <= 0)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < weights.size(); i++)
+    {
+        for (uint32_t j = 0; j < weights.size(); j++)
+        {
+            double share = weights[i] * weights[j] / pairs;
+            AddDemand(i, j, DataRate(static_cast<uint64_t>(total.GetBitRate() * share)));
+        }
+    }
+}
+
+void
+TrafficMatrixHelper::GenerateHotspot(uint32_t nNodes,
+                                     const std::vector<uint32_t>& hotspots,
+                                     DataRate rate,
+                                     double hotspotFactor)
+{
+    NS_LOG_FUNCTION(this << nNodes << hotspots.size() << rate << hotspotFactor);
+    DataRate hotRate(static_cast<uint64_t>(rate.GetBitRate() * hotspotFactor));
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        for (uint32_t j = 0; j < nNodes; j++)
+        {
+            bool hot = std::find(hotspots.begin(), hotspots.end(), j) != hotspots.end();
+            AddDemand(i, j, hot ? hotRate : rate);
+        }
+    }
+}
+
+void
+TrafficMatrixHelper::Clear()
+{
+    m_demands.clear();
+}
+
+const std::vector<TrafficMatrixHelper::Demand>&
+TrafficMatrixHelper::GetDemands() const
+{
+    return m_demands;
+}
+
+void
+TrafficMatrixHelper::SetBudget(Ptr<RandomVariableStream> budget)
+{
+    m_budget = budget;
+}
+
+void
+TrafficMatrixHelper::SetPacketSize(uint32_t packetSize)
+{
+    m_packetSize = packetSize;
+}
+
+void
+TrafficMatrixHelper::SetFlag(bool flag)
+{
+    m_flag = flag;
+}
+
+void
+TrafficMatrixHelper::SetSourceAttribute(std::string name, const AttributeValue& value)
+{
+    m_sourceFactory.Set(name, value);
+}
+
+void
+TrafficMatrixHelper::SetSinkAttribute(std::string name, const AttributeValue& value)
+{
+    m_sinkFactory.Set(name, value);
+}
+
+ApplicationContainer
+TrafficMatrixHelper::Install(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION(this << m_demands.size());
+    std::map<uint32_t, Ptr<RomamUdpApplication>> sources;
+    std::map<uint32_t, Ptr<Application>> sinks;
+    for (const Demand& demand : m_demands)
+    {
+        NS_ABORT_MSG_IF(demand.source >= nodes.GetN() || demand.destination >= nodes.GetN(),
+                        "Demand " << demand.source << " -> " << demand.destination
+                                  << " out of the " << nodes.GetN() << " nodes");
+        Ptr<Node> destination = nodes.Get(demand.destination);
+        if (sinks.find(demand.destination) == sinks.end())
+        {
+            Ptr<Application> sink = m_sinkFactory.Create<Application>();
+            destination->AddApplication(sink);
+            sinks[demand.destination] = sink;
+        }
+        Ptr<RomamUdpApplication>& source = sources[demand.source];
+        if (!source)
+        {
+            source = m_sourceFactory.Create<RomamUdpApplication>();
+            source->SetFlag(m_flag);
+            nodes.Get(demand.source)->AddApplication(source);
+        }
+        Ipv4Address address = RomamRouter::GetNodeAddress(destination->GetObject<Ipv4>());
+        uint32_t budget = m_budget ? m_budget->GetInteger() : RomamUdpApplication::NO_BUDGET;
+        source->AddFlow(InetSocketAddress(address, m_port), demand.rate, m_packetSize, 0, budget);
+    }
+    ApplicationContainer apps;
+    for (const auto& source : sources)
+    {
+        apps.Add(source.second);
+    }
+    for (const auto& sink : sinks)
+    {
+        apps.Add(sink.second);
+    }
+    NS_LOG_LOGIC("Installed " << m_demands.size() << " flows from " << sources.size()
+                              << " sources to " << sinks.size() << " sinks");
+    return apps;
+}
+
+} // namespace ns3
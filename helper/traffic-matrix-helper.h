@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TRAFFIC_MATRIX_HELPER_H
+#define TRAFFIC_MATRIX_HELPER_H
+
+#include "ns3/application-container.h"
+#include "ns3/attribute.h"
+#include "ns3/data-rate.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief A helper to install the UDP flows of a traffic matrix in one pass.
+ *
+ * The matrix holds demands between nodes, given by their index in the
+ * NodeContainer passed to Install ().  It is read from a file or generated:
+ * uniform, gravity or hotspot.  Install () puts one RomamUdpApplication on
+ * every source node, sending all its demands from one socket, and one
+ * RomamSink on every destination node, shared by all the flows to it, so
+ * that the number of applications and sockets grows with the nodes, not
+ * with the flows.
+ */
+class TrafficMatrixHelper
+{
+  public:
+    /// A flow of the matrix
+    struct Demand
+    {
+        uint32_t source;      //!< index of the sending node
+        uint32_t destination; //!< index of the receiving node
+        DataRate rate;        //!< the rate of the flow
+    };
+
+    /**
+     * \param port the port of the sinks
+     */
+    TrafficMatrixHelper(uint16_t port = 9);
+
+    /**
+     * \brief Add a demand; the ones of a node to itself or of rate 0 are ignored.
+     * \param source index of the sending node
+     * \param destination index of the receiving node
+     * \param rate the rate of the flow
+     */
+    void AddDemand(uint32_t source, uint32_t destination, DataRate rate);
+
+    /**
+     * \brief Add the demands of a file, a line "source destination rate" each,
+     * such as "0 10 2Mbps".  The lines starting with # are skipped.
+     * \param path the file
+     */
+    void LoadFile(const std::string& path);
+
+    /**
+     * \brief Add a demand of the same rate between every pair of nodes.
+     * \param nNodes the number of nodes
+     * \param rate the rate of each demand
+     */
+    void GenerateUniform(uint32_t nNodes, DataRate rate);
+
+    /**
+     * \brief Add a demand between every pair of nodes, proportional to the
+     * product of their weights.
+     * \param weights the weight of every node
+     * \param total the sum of the rates of all the demands
+     */
+    void GenerateGravity(const std::vector<double>& weights, DataRate total);
+
+    /**
+     * \brief Add a demand between every pair of nodes, hotspotFactor times
+     * larger toward the hotspots.
+     * \param nNodes the number of nodes
+     * \param hotspots the indices of the hotspot nodes
+     * \param rate the rate of the demands to the other nodes
+     * \param hotspotFactor the ratio of the rate of the demands to a hotspot
+     */
+    void GenerateHotspot(uint32_t nNodes,
+                         const std::vector<uint32_t>& hotspots,
+                         DataRate rate,
+                         double hotspotFactor);
+
+    /**
+     * \brief Remove all the demands.
+     */
+    void Clear();
+
+    /**
+     * \return the demands
+     */
+    const std::vector<Demand>& GetDemands() const;
+
+    /**
+     * \brief Draw the budget of every flow, as given to RomamUdpApplication::Setup (),
+     * from a random variable.  Without one, the flows have no budget.
+     * \param budget the random variable
+     */
+    void SetBudget(Ptr<RandomVariableStream> budget);
+
+    /**
+     * \param packetSize the packet size of the flows
+     */
+    void SetPacketSize(uint32_t packetSize);
+
+    /**
+     * \param flag the flag of the packets, for the sinks to log their delay
+     */
+    void SetFlag(bool flag);
+
+    /**
+     * Helper function used to set the attributes of the RomamUdpApplications.
+     *
+     * \param name the name of the application attribute to set
+     * \param value the value of the application attribute to set
+     */
+    void SetSourceAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * Helper function used to set the attributes of the RomamSinks.
+     *
+     * \param name the name of the application attribute to set
+     * \param value the value of the application attribute to set
+     */
+    void SetSinkAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * \brief Install the sources and the sinks of the demands.
+     *
+     * A destination is reached at RomamRouter::GetNodeAddress (): its
+     * loopback address if it has one, else the first address of its first
+     * interface after the loopback.
+     *
+     * \param nodes the nodes the demands index
+     * \returns Container of Ptr to the applications installed, the sources first
+     */
+    ApplicationContainer Install(NodeContainer nodes);
+
+  private:
+    uint16_t m_port;                    //!< port of the sinks
+    uint32_t m_packetSize;              //!< packet size of the flows
+    bool m_flag;                        //!< flag of the packets
+    Ptr<RandomVariableStream> m_budget; //!< budget of the flows, none if null
+    std::vector<Demand> m_demands;      //!< the matrix
+    ObjectFactory m_sourceFactory;      //!< factory of the RomamUdpApplications
+    ObjectFactory m_sinkFactory;        //!< factory of the RomamSinks
+};
+
+} // namespace ns3
+
+#endif /* TRAFFIC_MATRIX_HELPER_H */
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "delay-histogram.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DelayHistogram");
+
+DelayHistogram::DelayHistogram(uint32_t subBucketBits, uint32_t maxBits)
+    : m_subBucketBits(subBucketBits),
+      m_maxValue((uint64_t(1) << maxBits) - 1),
+      m_count(0),
+      m_min(std::numeric_limits<uint64_t>::max()),
+      m_max(0),
+      m_sum(0)
+{
+    NS_LOG_FUNCTION(this << subBucketBits << maxBits);
+    NS_ASSERT_MSG(subBucketBits >= 2 && subBucketBits <= 16, "Bad sub-bucket bits");
+    NS_ASSERT_MSG(maxBits >= subBucketBits && maxBits <= 62, "Bad maximum bits");
+    m_counts.assign(GetIndex(m_maxValue) + 1, 0);
+}
+
+uint32_t
+DelayHistogram::GetIndex(uint64_t value) const
+{
+    uint64_t subBuckets = uint64_t(1) << m_subBucketBits;
+    if (value < subBuckets)
+    {
+        return value;
+    }
+    // the powers of two above the first share the upper half of their buckets
+    uint32_t msb = 63 - __builtin_clzll(value);
+    uint32_t shift = msb - m_subBucketBits + 1;
+    return (shift << (m_subBucketBits - 1)) + (value >> shift);
+}
+
+uint64_t
+DelayHistogram::GetHighestValue(uint32_t index) const
+{
+    uint64_t subBuckets = uint64_t(1) << m_subBucketBits;
+    if (index < subBuckets)
+    {
+        return index;
+    }
+    uint32_t shift = (index >> (m_subBucketBits - 1)) - 1;
+    uint64_t sub = index - (uint64_t(shift) << (m_subBucketBits - 1));
+    return ((sub + 1) << shift) - 1;
+}
+
+void
+DelayHistogram::Record(Time delay)
+{
+    int64_t ns = delay.GetNanoSeconds();
+    uint64_t value = ns > 0 ? ns : 0;
+    m_counts[GetIndex(std::min(value, m_maxValue))]++;
+    m_count++;
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+    m_sum += value;
+}
+
+void
+DelayHistogram::Merge(const DelayHistogram& other)
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT_MSG(other.m_counts.size() == m_counts.size() &&
+                      other.m_subBucketBits == m_subBucketBits,
+                  "Merging histograms of different parameters");
+    for (std::size_t i = 0; i < m_counts.size(); i++)
+    {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_count += other.m_count;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    m_sum += other.m_sum;
+}
+
+void
+DelayHistogram::Reset()
+{
+    NS_LOG_FUNCTION(this);
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_count = 0;
+    m_min = std::numeric_limits<uint64_t>::max();
+    m_max = 0;
+    m_sum = 0;
+}
+
+uint64_t
+DelayHistogram::GetCount() const
+{
+    return m_count;
+}
+
+Time
+DelayHistogram::GetMin() const
+{
+    return m_count == 0 ? Time(0) : NanoSeconds(m_min);
+}
+
+Time
+DelayHistogram::GetMax() const
+{
+    return NanoSeconds(m_max);
+}
+
+Time
+DelayHistogram::GetMean() const
+{
+    return m_count == 0 ? Time(0) : NanoSeconds(static_cast<int64_t>(m_sum / m_count));
+}
+
+Time
+DelayHistogram::GetPercentile(double percentile) const
+{
+    if (m_count == 0)
+    {
+        return Time(0);
+    }
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    // the rank of the delay at the percentile, from 1
+    uint64_t rank = std::max<uint64_t>(1, std::ceil(percentile / 100.0 * m_count));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < m_counts.size(); i++)
+    {
+        seen += m_counts[i];
+        if (seen >= rank)
+        {
+            return NanoSeconds(std::min(GetHighestValue(i), m_max));
+        }
+    }
+    return NanoSeconds(m_max);
+}
+
+std::size_t
+DelayHistogram::GetMemoryUsage() const
+{
+    return sizeof(*this) + m_counts.capacity() * sizeof(uint64_t);
+}
+
+} // namespace ns3
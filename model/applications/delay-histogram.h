@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef DELAY_HISTOGRAM_H
+#define DELAY_HISTOGRAM_H
+
+#include "ns3/nstime.h"
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Fixed-memory log-linear histogram of delays, in the manner of an
+ * HdrHistogram.
+ *
+ * The delays are counted in nanoseconds.  The values below 2^subBucketBits
+ * have a bucket each; above, every power of two is split in
+ * 2^(subBucketBits - 1) buckets of equal width, so that a bucket is never
+ * wider than 2^(1 - subBucketBits) of its values.  The delays above
+ * 2^maxBits ns are counted in the last bucket.  Recording is O(1) and the
+ * memory only depends on the two parameters.
+ */
+class DelayHistogram
+{
+  public:
+    /**
+     * \param subBucketBits log2 of the buckets of the first power of two, from 2 to 16
+     * \param maxBits log2 of the largest delay told apart, in ns, at most 62
+     */
+    DelayHistogram(uint32_t subBucketBits = 7, uint32_t maxBits = 40);
+
+    /**
+     * \brief Count a delay.
+     * \param delay the delay, a negative one counts as 0
+     */
+    void Record(Time delay);
+
+    /**
+     * \brief Add the counts of a histogram with the same parameters.
+     * \param other the histogram
+     */
+    void Merge(const DelayHistogram& other);
+
+    /**
+     * \brief Forget all the delays.
+     */
+    void Reset();
+
+    /**
+     * \return the number of delays counted
+     */
+    uint64_t GetCount() const;
+
+    /**
+     * \return the smallest delay counted, or 0 if none
+     */
+    Time GetMin() const;
+
+    /**
+     * \return the largest delay counted, or 0 if none
+     */
+    Time GetMax() const;
+
+    /**
+     * \return the mean of the delays counted, exact, or 0 if none
+     */
+    Time GetMean() const;
+
+    /**
+     * \param percentile the percentile, from 0 to 100
+     * \return the largest delay of the bucket holding the percentile, at
+     * most GetMax (), or 0 if no delay is counted
+     */
+    Time GetPercentile(double percentile) const;
+
+    /**
+     * \return the number of bytes of the histogram
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    /**
+     * \param value a delay in ns
+     * \return the index of its bucket
+     */
+    uint32_t GetIndex(uint64_t value) const;
+
+    /**
+     * \param index a bucket index
+     * \return the largest value of the bucket, in ns
+     */
+    uint64_t GetHighestValue(uint32_t index) const;
+
+    uint32_t m_subBucketBits;       //!< log2 of the buckets below 2^m_subBucketBits
+    uint64_t m_maxValue;            //!< largest value with its own bucket, in ns
+    std::vector<uint64_t> m_counts; //!< delays counted, by bucket
+    uint64_t m_count;               //!< delays counted
+    uint64_t m_min;                 //!< smallest delay counted, in ns
+    uint64_t m_max;                 //!< largest delay counted, in ns
+    long double m_sum;              //!< sum of the delays counted, in ns
+};
+
+} // namespace ns3
+
+#endif /* DELAY_HISTOGRAM_H */
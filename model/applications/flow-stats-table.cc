@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "flow-stats-table.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowStatsTable");
+
+bool
+FlowKey::operator==(const FlowKey& other) const
+{
+    return source == other.source && destination == other.destination &&
+           sourcePort == other.sourcePort && destinationPort == other.destinationPort &&
+           protocol == other.protocol;
+}
+
+FlowStats::FlowStats()
+    : packets(0),
+      bytes(0),
+      delayed(0),
+      delaySum(0),
+      delayMin(std::numeric_limits<int64_t>::max()),
+      delayMax(std::numeric_limits<int64_t>::min()),
+      outOfOrder(0),
+      maxSeq(0),
+      hasSeq(false)
+{
+}
+
+void
+FlowStats::AddPacket(uint32_t size)
+{
+    packets++;
+    bytes += size;
+}
+
+void
+FlowStats::AddDelay(int64_t delay)
+{
+    delayed++;
+    delaySum += delay;
+    delayMin = std::min(delayMin, delay);
+    delayMax = std::max(delayMax, delay);
+}
+
+void
+FlowStats::AddSequence(uint32_t seq)
+{
+    if (hasSeq && seq < maxSeq)
+    {
+        outOfOrder++;
+        return;
+    }
+    maxSeq = seq;
+    hasSeq = true;
+}
+
+FlowStatsTable::FlowStatsTable(uint32_t maxFlows)
+    : m_maxFlows(maxFlows),
+      m_nFlows(0)
+{
+    NS_LOG_FUNCTION(this << maxFlows);
+    uint32_t nSlots = 1;
+    while (nSlots < 2 * static_cast<uint64_t>(maxFlows))
+    {
+        nSlots <<= 1;
+    }
+    m_slots.assign(nSlots, Slot{FlowKey{}, FlowStats(), false});
+}
+
+uint32_t
+FlowStatsTable::Probe(const FlowKey& key) const
+{
+    // splitmix64 finalizer of the 5-tuple
+    uint64_t h = (uint64_t(key.source) << 32 | key.destination) ^
+                 (uint64_t(key.sourcePort) << 24 | uint64_t(key.destinationPort) << 8 |
+                  key.protocol) * 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    uint32_t mask = m_slots.size() - 1;
+    uint32_t i = h & mask;
+    // at most half of the slots are used, so an empty one ends the probe
+    while (m_slots[i].used && !(m_slots[i].key == key))
+    {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+FlowStats&
+FlowStatsTable::Get(const FlowKey& key)
+{
+    uint32_t i = Probe(key);
+    Slot& slot = m_slots[i];
+    if (slot.used)
+    {
+        return slot.stats;
+    }
+    if (m_nFlows == m_maxFlows)
+    {
+        return m_otherFlows;
+    }
+    slot.key = key;
+    slot.used = true;
+    m_nFlows++;
+    return slot.stats;
+}
+
+const FlowStats*
+FlowStatsTable::Find(const FlowKey& key) const
+{
+    const Slot& slot = m_slots[Probe(key)];
+    return slot.used ? &slot.stats : nullptr;
+}
+
+const FlowStats&
+FlowStatsTable::GetOtherFlows() const
+{
+    return m_otherFlows;
+}
+
+uint32_t
+FlowStatsTable::GetNFlows() const
+{
+    return m_nFlows;
+}
+
+void
+FlowStatsTable::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    std::fill(m_slots.begin(), m_slots.end(), Slot{FlowKey{}, FlowStats(), false});
+    m_nFlows = 0;
+    m_otherFlows = FlowStats();
+}
+
+std::size_t
+FlowStatsTable::GetMemoryUsage() const
+{
+    return sizeof(*this) + m_slots.capacity() * sizeof(Slot);
+}
+
+} // namespace ns3
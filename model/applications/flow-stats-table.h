@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef FLOW_STATS_TABLE_H
+#define FLOW_STATS_TABLE_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief The 5-tuple of a flow received by a sink.
+ */
+struct FlowKey
+{
+    uint32_t source;          //!< source IPv4 address
+    uint32_t destination;     //!< destination IPv4 address
+    uint16_t sourcePort;      //!< source port
+    uint16_t destinationPort; //!< destination port
+    uint8_t protocol;         //!< IP protocol number
+
+    /**
+     * \param other another key
+     * \return true if the keys are the same 5-tuple
+     */
+    bool operator==(const FlowKey& other) const;
+};
+
+/**
+ * \brief Counters of a flow received by a sink.
+ */
+struct FlowStats
+{
+    FlowStats();
+
+    /**
+     * \brief Count a packet.
+     * \param size the size of the packet
+     */
+    void AddPacket(uint32_t size);
+
+    /**
+     * \brief Count the delay of a packet.
+     * \param delay the one way delay, in nanoseconds
+     */
+    void AddDelay(int64_t delay);
+
+    /**
+     * \brief Count the sequence number of a SeqTsSizeHeader.
+     * \param seq the sequence number
+     */
+    void AddSequence(uint32_t seq);
+
+    uint64_t packets;    //!< packets received
+    uint64_t bytes;      //!< bytes received
+    uint64_t delayed;    //!< packets whose delay is counted
+    int64_t delaySum;    //!< sum of the delays, in nanoseconds
+    int64_t delayMin;    //!< smallest delay, in nanoseconds
+    int64_t delayMax;    //!< largest delay, in nanoseconds
+    uint64_t outOfOrder; //!< sequence numbers below the highest one seen before
+    uint32_t maxSeq;     //!< highest sequence number seen
+    bool hasSeq;         //!< whether a sequence number was seen
+};
+
+/**
+ * \brief Open addressing hash table of the flows of a sink, of fixed size.
+ *
+ * The slots are one flat array, probed linearly, and never more than half
+ * full.  Once the table holds its maximum number of flows, the packets of
+ * new flows are counted together in the stats of the other flows, so the
+ * memory stays bounded whatever the traffic.
+ */
+class FlowStatsTable
+{
+  public:
+    /**
+     * \param maxFlows the number of flows with stats of their own
+     */
+    FlowStatsTable(uint32_t maxFlows = 0);
+
+    /**
+     * \param key the 5-tuple of a flow
+     * \return the stats of the flow, added if the table is not full, or the
+     * stats of the other flows
+     */
+    FlowStats& Get(const FlowKey& key);
+
+    /**
+     * \param key the 5-tuple of a flow
+     * \return the stats of the flow, or null if it has none of its own
+     */
+    const FlowStats* Find(const FlowKey& key) const;
+
+    /**
+     * \return the stats of the flows that found the table full
+     */
+    const FlowStats& GetOtherFlows() const;
+
+    /**
+     * \return the number of flows with stats of their own
+     */
+    uint32_t GetNFlows() const;
+
+    /**
+     * \brief Forget all the flows.
+     */
+    void Clear();
+
+    /**
+     * \brief Call a function on every flow of the table, in slot order.
+     * \param f the function, called with the key and the stats of each flow
+     */
+    template <typename F>
+    void ForEach(F f) const;
+
+    /**
+     * \return the number of bytes of the table
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    /**
+     * \param key a 5-tuple
+     * \return the slot holding the key, or the empty slot it would take
+     */
+    uint32_t Probe(const FlowKey& key) const;
+
+    /// a slot of the table
+    struct Slot
+    {
+        FlowKey key;     //!< the 5-tuple of the flow
+        FlowStats stats; //!< the counters of the flow
+        bool used;       //!< whether the slot holds a flow
+    };
+
+    std::vector<Slot> m_slots; //!< the slots, a power of two of them
+    uint32_t m_maxFlows;       //!< flows with stats of their own
+    uint32_t m_nFlows;         //!< flows in the slots
+    FlowStats m_otherFlows;    //!< the flows that found the table full
+};
+
+template <typename F>
+void
+FlowStatsTable::ForEach(F f) const
+{
+    for (const Slot& slot : m_slots)
+    {
+        if (slot.used)
+        {
+            f(slot.key, slot.stats);
+        }
+    }
+}
+
+} // namespace ns3
+
+#endif /* FLOW_STATS_TABLE_H */
@@ -2,23 +2,34 @@
 #include "romam-sink.h"
 
 #include "../datapath/romam-tags.h"
+#include "throughput-sampler.h"
 
 #include "ns3/address-utils.h"
 #include "ns3/address.h"
 #include "ns3/boolean.h"
+#include "ns3/buffer.h"
+#include "ns3/enum.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/inet6-socket-address.h"
 #include "ns3/log.h"
 #include "ns3/node.h"
+#include "ns3/nstime.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
 #include "ns3/socket.h"
+#include "ns3/string.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/udp-socket.h"
+#include "ns3/uinteger.h"
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <set>
+#include <sstream>
 
 namespace ns3
 {
@@ -27,6 +38,30 @@ NS_LOG_COMPONENT_DEFINE("RomamSink");
 
 NS_OBJECT_ENSURE_REGISTERED(RomamSink);
 
+static_assert(sizeof(RomamSink::DelayRecord) == 24, "DelayRecord must have no padding");
+
+/**
+ * \brief Open a file the sinks of the simulation share, to append to it.
+ * \param out the stream to open
+ * \param path the file
+ * \param mode the mode besides appending or truncating
+ * \return true if this is the first opening of the file in the simulation,
+ * which truncates it
+ */
+static bool
+OpenSharedFile(std::ofstream& out, const std::string& path, std::ios::openmode mode)
+{
+    // the files the sinks wrote to, which they append to from then on
+    static std::set<std::string> started;
+    bool first = started.insert(path).second;
+    out.open(path, std::ios::out | mode | (first ? std::ios::trunc : std::ios::app));
+    if (!out)
+    {
+        NS_FATAL_ERROR("Cannot open " << path);
+    }
+    return first;
+}
+
 TypeId
 RomamSink::GetTypeId(void)
 {
@@ -66,18 +101,100 @@ RomamSink::GetTypeId(void)
                           "Enable record delay",
                           BooleanValue(false),
                           MakeBooleanAccessor(&RomamSink::m_recordDelay),
-                          MakeBooleanChecker());
+                          MakeBooleanChecker())
+            .AddAttribute("DelayLogFormat",
+                          "How the delay of the flagged packets is logged",
+                          EnumValue(TEXT_DELAY_LOG),
+                          MakeEnumAccessor(&RomamSink::m_delayLogFormat),
+                          MakeEnumChecker(TEXT_DELAY_LOG,
+                                          "Text",
+                                          BINARY_DELAY_LOG,
+                                          "Binary",
+                                          NO_DELAY_LOG,
+                                          "None"))
+            .AddAttribute("DelayLogFile",
+                          "The file of the binary delay log, shared by the sinks naming it",
+                          StringValue("sinked-packet.delay.bin"),
+                          MakeStringAccessor(&RomamSink::m_delayLogFile),
+                          MakeStringChecker())
+            .AddAttribute("DelayLogBufferSize",
+                          "The number of delay records buffered before they are written "
+                          "to the binary delay log",
+                          UintegerValue(65536),
+                          MakeUintegerAccessor(&RomamSink::m_delayLogBufferSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("EnableDelayHistograms",
+                          "Count the delays and deadlines of the flagged packets, of all the "
+                          "packets and by flow",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RomamSink::m_enableHistograms),
+                          MakeBooleanChecker())
+            .AddAttribute("HistogramSubBucketBits",
+                          "The precision of the delay histograms: a bucket is at most "
+                          "2^(1 - bits) of its delays wide",
+                          UintegerValue(7),
+                          MakeUintegerAccessor(&RomamSink::m_subBucketBits),
+                          MakeUintegerChecker<uint32_t>(2, 16))
+            .AddAttribute("MaxHistogramFlows",
+                          "The number of flows with a delay histogram of their own; the "
+                          "others only count in the histogram of all the flows",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&RomamSink::m_maxHistogramFlows),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("DelaySummaryFile",
+                          "The file the sinks append the summary of their delay histograms "
+                          "to at stop, none if empty",
+                          StringValue(""),
+                          MakeStringAccessor(&RomamSink::m_delaySummaryFile),
+                          MakeStringChecker())
+            .AddAttribute("EnableFlowStats",
+                          "Count the packets, bytes, delays and reorderings of every flow, "
+                          "by 5-tuple",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RomamSink::m_enableFlowStats),
+                          MakeBooleanChecker())
+            .AddAttribute("MaxFlows",
+                          "The number of flows with counters of their own; the others are "
+                          "counted together",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&RomamSink::m_maxFlows),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("FlowStatsInterval",
+                          "The time between two snapshots of the flow stats, 0 to only "
+                          "write one at stop",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RomamSink::m_flowStatsInterval),
+                          MakeTimeChecker())
+            .AddAttribute("FlowStatsFile",
+                          "The file the sinks append the snapshots of their flow stats to",
+                          StringValue("flow-stats.txt"),
+                          MakeStringAccessor(&RomamSink::m_flowStatsFile),
+                          MakeStringChecker())
+            .AddTraceSource("Delay",
+                            "A sampled flagged packet has been received",
+                            MakeTraceSourceAccessor(&RomamSink::m_delayTrace),
+                            "ns3::RomamSink::DelayCallback")
+            .AddTraceSource("DeadlineMiss",
+                            "A flagged packet has been received after its budget",
+                            MakeTraceSourceAccessor(&RomamSink::m_deadlineMissTrace),
+                            "ns3::RomamSink::DeadlineMissCallback");
     return tid;
 }
 
+RomamSink::FlowDelays::FlowDelays(uint32_t subBucketBits)
+    : histogram(subBucketBits),
+      budgeted(0),
+      deadlineMet(0)
+{
+}
+
 RomamSink::RomamSink()
+    : m_delays(7),
+      m_protocol(17)
 {
     NS_LOG_FUNCTION(this);
     m_socket = 0;
     m_totalRx = 0;
-    m_old = 0;
-    // uint32_t interval = 10;
-    // Simulator::Schedule (MilliSeconds (interval), &MonitorThroughput, interval);
 }
 
 RomamSink::~RomamSink()
@@ -85,18 +202,6 @@ RomamSink::~RomamSink()
     NS_LOG_FUNCTION(this);
 }
 
-// void
-// RomamSink::MonitorThroughput (uint32_t interval)
-// {
-//   uint64_t value_new = GetTotalRx ();
-//   Time curTime = Now ();
-//   std::ostream* os = m_throughputStream->GetStream ();
-//   * os << curTime.GetMilliSeconds () << ""
-//        << 8 * (value_new - m_old)/ (1000 * 1000 * interval / 100)
-//        << std::endl;
-//   Simulator::Schedule (MilliSeconds (interval), &MonitorThroughput, interval);
-// }
-
 uint64_t
 RomamSink::GetTotalRx() const
 {
@@ -122,9 +227,9 @@ Time
 RomamSink::GetDelay(const Ptr<Packet>& p) const
 {
     NS_LOG_FUNCTION(this);
-    TimestampTag txTimeTag;
-    p->PeekPacketTag(txTimeTag);
-    Time txTime = txTimeTag.GetTimestamp();
+    RomamMetaTag metaTag;
+    RomamMetaTag::Peek(p, metaTag);
+    Time txTime = metaTag.GetTimestamp();
     Time delay = Simulator::Now() - txTime;
     return delay;
 }
@@ -141,10 +246,254 @@ RomamSink::SetRecordDelay(bool recordDelay)
     m_recordDelay = recordDelay;
 }
 
+const RomamSink::FlowDelays&
+RomamSink::GetDelays() const
+{
+    return m_delays;
+}
+
+const RomamSink::FlowDelays*
+RomamSink::GetFlowDelays(const Address& from) const
+{
+    auto i = m_flows.find(GetFlowKey(from));
+    return i == m_flows.end() ? nullptr : &i->second;
+}
+
+uint64_t
+RomamSink::GetFlowKey(const Address& from)
+{
+    if (!InetSocketAddress::IsMatchingType(from))
+    {
+        return 0;
+    }
+    InetSocketAddress address = InetSocketAddress::ConvertFrom(from);
+    return (uint64_t(address.GetIpv4().Get()) << 16) | address.GetPort();
+}
+
+void
+RomamSink::CountDelay(const RomamMetaTag& metaTag,
+                      Time delay,
+                      bool deadlineMet,
+                      const Address& from)
+{
+    auto count = [&metaTag, delay, deadlineMet](FlowDelays& delays) {
+        delays.histogram.Record(delay);
+        delays.budgeted += metaTag.HasBudget();
+        delays.deadlineMet += metaTag.HasBudget() && deadlineMet;
+    };
+    count(m_delays);
+    uint64_t key = GetFlowKey(from);
+    auto i = m_flows.find(key);
+    if (i == m_flows.end() && m_flows.size() < m_maxHistogramFlows)
+    {
+        i = m_flows.emplace(key, FlowDelays(m_subBucketBits)).first;
+    }
+    if (i != m_flows.end())
+    {
+        count(i->second);
+    }
+}
+
+void
+RomamSink::WriteDelaySummary() const
+{
+    NS_LOG_FUNCTION(this);
+    std::ofstream out;
+    if (OpenSharedFile(out, m_delaySummaryFile, std::ios::openmode()))
+    {
+        out << "# node source port packets min p50 p90 p99 p99.9 max mean (ms) budgeted met\n";
+    }
+    auto write = [this, &out](const std::string& source, uint16_t port, const FlowDelays& d) {
+        const DelayHistogram& h = d.histogram;
+        out << GetNode()->GetId() << ' ' << source << ' ' << port << ' ' << h.GetCount();
+        for (Time t : {h.GetMin(),
+                       h.GetPercentile(50),
+                       h.GetPercentile(90),
+                       h.GetPercentile(99),
+                       h.GetPercentile(99.9),
+                       h.GetMax(),
+                       h.GetMean()})
+        {
+            out << ' ' << t.GetMicroSeconds() / 1000.0;
+        }
+        out << ' ' << d.budgeted << ' ' << d.deadlineMet << '\n';
+    };
+    write("all", 0, m_delays);
+    for (const auto& flow : m_flows)
+    {
+        std::ostringstream source;
+        source << Ipv4Address(flow.first >> 16);
+        write(source.str(), flow.first & 0xffff, flow.second);
+    }
+}
+
+const FlowStatsTable&
+RomamSink::GetFlowStats() const
+{
+    return m_flowStats;
+}
+
+FlowKey
+RomamSink::MakeFlowKey(const Address& from, const Address& localAddress) const
+{
+    FlowKey key = {0, 0, 0, 0, m_protocol};
+    if (InetSocketAddress::IsMatchingType(from))
+    {
+        InetSocketAddress address = InetSocketAddress::ConvertFrom(from);
+        key.source = address.GetIpv4().Get();
+        key.sourcePort = address.GetPort();
+    }
+    if (InetSocketAddress::IsMatchingType(localAddress))
+    {
+        InetSocketAddress address = InetSocketAddress::ConvertFrom(localAddress);
+        key.destination = address.GetIpv4().Get();
+        key.destinationPort = address.GetPort();
+    }
+    return key;
+}
+
+void
+RomamSink::SnapshotFlowStats()
+{
+    NS_LOG_FUNCTION(this);
+    WriteFlowStats();
+    m_flowStatsEvent =
+        Simulator::Schedule(m_flowStatsInterval, &RomamSink::SnapshotFlowStats, this);
+}
+
+void
+RomamSink::WriteFlowStats() const
+{
+    NS_LOG_FUNCTION(this);
+    std::ofstream out;
+    if (OpenSharedFile(out, m_flowStatsFile, std::ios::openmode()))
+    {
+        out << "# time (s) node protocol source port destination port packets bytes delayed "
+               "mean min max (ms) out-of-order\n";
+    }
+    double now = Simulator::Now().GetSeconds();
+    uint32_t node = GetNode()->GetId();
+    auto write = [&out, now, node](const FlowKey& key, const FlowStats& stats, bool other) {
+        out << now << ' ' << node << ' ' << unsigned(key.protocol) << ' ';
+        if (other)
+        {
+            out << "other 0 other 0";
+        }
+        else
+        {
+            out << Ipv4Address(key.source) << ' ' << key.sourcePort << ' '
+                << Ipv4Address(key.destination) << ' ' << key.destinationPort;
+        }
+        out << ' ' << stats.packets << ' ' << stats.bytes << ' ' << stats.delayed;
+        if (stats.delayed > 0)
+        {
+            out << ' ' << stats.delaySum / stats.delayed / 1e6 << ' ' << stats.delayMin / 1e6
+                << ' ' << stats.delayMax / 1e6;
+        }
+        else
+        {
+            out << " 0 0 0";
+        }
+        out << ' ' << stats.outOfOrder << '\n';
+    };
+    m_flowStats.ForEach(
+        [&write](const FlowKey& key, const FlowStats& stats) { write(key, stats, false); });
+    if (m_flowStats.GetOtherFlows().packets > 0)
+    {
+        write(FlowKey{0, 0, 0, 0, m_protocol}, m_flowStats.GetOtherFlows(), true);
+    }
+}
+
+void
+RomamSink::LogDelay(const RomamMetaTag& metaTag, Time delay, const Address& from)
+{
+    if (m_delayLogFormat == NO_DELAY_LOG)
+    {
+        return;
+    }
+    if (m_delayLogFormat == TEXT_DELAY_LOG)
+    {
+        std::ostream* os = m_delayStream->GetStream();
+        *os << metaTag.GetTimestamp().GetMicroSeconds() / 1000.0 << "    "
+            << delay.GetMicroSeconds() / 1000.0 << std::endl;
+        return;
+    }
+    DelayRecord record;
+    record.txTime = metaTag.GetTimestamp().GetNanoSeconds();
+    record.delay = delay.GetNanoSeconds();
+    record.source = 0;
+    record.port = 0;
+    record.node = static_cast<uint16_t>(GetNode()->GetId());
+    if (InetSocketAddress::IsMatchingType(from))
+    {
+        InetSocketAddress address = InetSocketAddress::ConvertFrom(from);
+        record.source = address.GetIpv4().Get();
+        record.port = address.GetPort();
+    }
+    m_delayRecords.push_back(record);
+    if (m_delayRecords.size() >= m_delayLogBufferSize)
+    {
+        FlushDelayLog();
+    }
+}
+
+void
+RomamSink::FlushDelayLog()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_delayRecords.empty())
+    {
+        return;
+    }
+    std::ofstream out;
+    if (OpenSharedFile(out, m_delayLogFile, std::ios::binary))
+    {
+        out.write(DELAY_LOG_MAGIC, sizeof(DELAY_LOG_MAGIC));
+    }
+    out.write(reinterpret_cast<const char*>(m_delayRecords.data()),
+              m_delayRecords.size() * sizeof(DelayRecord));
+    NS_LOG_LOGIC("Wrote " << m_delayRecords.size() << " delay records to " << m_delayLogFile);
+    m_delayRecords.clear();
+}
+
+bool
+RomamSink::ConvertDelayLog(const std::string& binaryPath, const std::string& textPath)
+{
+    NS_LOG_FUNCTION(binaryPath << textPath);
+    std::ifstream in(binaryPath, std::ios::in | std::ios::binary);
+    char magic[sizeof(DELAY_LOG_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, DELAY_LOG_MAGIC, sizeof(magic)) != 0)
+    {
+        NS_LOG_WARN(binaryPath << " is not a delay log");
+        return false;
+    }
+    std::ofstream out(textPath, std::ios::out | std::ios::trunc);
+    if (!out)
+    {
+        return false;
+    }
+    std::vector<DelayRecord> records(4096);
+    while (in)
+    {
+        in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(DelayRecord));
+        std::size_t n = in.gcount() / sizeof(DelayRecord);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            // truncated to microseconds first, as the text log is
+            out << (records[i].txTime / 1000) / 1000.0 << "    "
+                << (records[i].delay / 1000) / 1000.0 << '\n';
+        }
+    }
+    return static_cast<bool>(out);
+}
+
 void
 RomamSink::DoDispose(void)
 {
     NS_LOG_FUNCTION(this);
+    FlushDelayLog();
+    m_flowStatsEvent.Cancel();
+    ThroughputSampler::Remove(this);
     m_socket = 0;
     m_socketList.clear();
 
@@ -187,6 +536,23 @@ RomamSink::StartApplication() // Called at time specified by Start
                                 MakeCallback(&RomamSink::HandleAccept, this));
     m_socket->SetCloseCallbacks(MakeCallback(&RomamSink::HandlePeerClose, this),
                                 MakeCallback(&RomamSink::HandlePeerError, this));
+    if (m_delayLogFormat == BINARY_DELAY_LOG)
+    {
+        m_delayRecords.reserve(m_delayLogBufferSize);
+    }
+    m_delays = FlowDelays(m_subBucketBits);
+    m_flows.clear();
+    m_protocol = m_tid == UdpSocketFactory::GetTypeId() ? 17 : 6; // UDP, else TCP
+    if (m_enableFlowStats)
+    {
+        m_flowStats = FlowStatsTable(m_maxFlows);
+        if (m_flowStatsInterval.IsStrictlyPositive())
+        {
+            m_flowStatsEvent =
+                Simulator::Schedule(m_flowStatsInterval, &RomamSink::SnapshotFlowStats, this);
+        }
+    }
+    ThroughputSampler::Add(this);
 }
 
 void
@@ -204,6 +570,17 @@ RomamSink::StopApplication() // Called at time specified by Stop
         m_socket->Close();
         m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
     }
+    FlushDelayLog();
+    if (m_enableHistograms && !m_delaySummaryFile.empty())
+    {
+        WriteDelaySummary();
+    }
+    if (m_enableFlowStats)
+    {
+        m_flowStatsEvent.Cancel();
+        WriteFlowStats();
+    }
+    ThroughputSampler::Remove(this);
 }
 
 int i = 0; // count packets
@@ -228,28 +605,25 @@ RomamSink::HandleRead(Ptr<Socket> socket)
         // packet->PrintPacketTags (std::cout);
         // std::cout << std::endl;
         // get packet
-        FlagTag flagTag;
-        if (packet->PeekPacketTag(flagTag) && flagTag.GetFlag() == true)
+        RomamMetaTag metaTag;
+        if (RomamMetaTag::Peek(packet, metaTag) && metaTag.GetFlag() == true)
         {
-            TimestampTag timeTag;
-            packet->PeekPacketTag(timeTag);
-            std::ostream* os = m_delayStream->GetStream();
-            // timeTag.GetSeconds () << " "
-            // BudgetTag bgtTag;
-            // packet->PeekPacketTag(bgtTag);
-
-            // *os << bgtTag.GetBudget() << std::endl;
-            // if (GetDelay(packet).GetMicroSeconds() < bgtTag.GetBudget())
-            // {
-            //     *os << "1" << std::endl;
-            // }
-            // else
-            // {
-            //     *os << "0" << std::endl;
-            // }
-
-            *os << timeTag.GetTimestamp().GetMicroSeconds() / 1000.0 << "    "
-                << GetDelay(packet).GetMicroSeconds() / 1000.0 << std::endl;
+            Time delay = GetDelay(packet);
+            if (metaTag.IsSampled())
+            {
+                LogDelay(metaTag, delay, from);
+                m_delayTrace(packet, from, delay);
+            }
+            Time budget = MicroSeconds(metaTag.GetBudget());
+            bool deadlineMet = !metaTag.HasBudget() || delay <= budget;
+            if (m_enableHistograms)
+            {
+                CountDelay(metaTag, delay, deadlineMet, from);
+            }
+            if (!deadlineMet)
+            {
+                m_deadlineMissTrace(packet, from, delay, budget);
+            }
         }
         // get delay
         m_totalRx += packet->GetSize();
@@ -270,6 +644,16 @@ RomamSink::HandleRead(Ptr<Socket> socket)
                                    << " total Rx " << m_totalRx << " bytes");
         }
         socket->GetSockName(localAddress);
+        if (m_enableFlowStats)
+        {
+            FlowStats& stats = m_flowStats.Get(MakeFlowKey(from, localAddress));
+            stats.AddPacket(packet->GetSize());
+            RomamMetaTag metaTag;
+            if (RomamMetaTag::Peek(packet, metaTag))
+            {
+                stats.AddDelay(GetDelay(packet).GetNanoSeconds());
+            }
+        }
         m_rxTrace(packet, from);
         m_rxTraceWithAddresses(packet, from, localAddress);
 
@@ -282,43 +666,60 @@ RomamSink::HandleRead(Ptr<Socket> socket)
     // std::cout<<"total"<<i<<"packets"<< std::endl;
 }
 
+RomamSink::SeqTsSizeStream::SeqTsSizeStream()
+    : nHeaderBytes(0),
+      remaining(0)
+{
+}
+
 void
 RomamSink::PacketReceived(const Ptr<Packet>& p, const Address& from, const Address& localAddress)
 {
-    SeqTsSizeHeader header;
-    Ptr<Packet> buffer;
-
-    auto itBuffer = m_buffer.find(from);
-    if (itBuffer == m_buffer.end())
+    SeqTsSizeStream& stream = m_streams[from];
+    uint32_t headerSize = stream.header.GetSerializedSize();
+    stream.headerBytes.resize(headerSize);
+    uint32_t size = p->GetSize();
+    uint32_t offset = 0;
+    while (offset < size)
     {
-        itBuffer = m_buffer.insert(std::make_pair(from, Create<Packet>(0))).first;
-    }
-
-    buffer = itBuffer->second;
-    buffer->AddAtEnd(p);
-    buffer->PeekHeader(header);
-
-    NS_ABORT_IF(header.GetSize() == 0);
-
-    while (buffer->GetSize() >= header.GetSize())
-    {
-        NS_LOG_DEBUG("Removing packet of size " << header.GetSize() << " from buffer of size "
-                                                << buffer->GetSize());
-        Ptr<Packet> complete = buffer->CreateFragment(0, static_cast<uint32_t>(header.GetSize()));
-        buffer->RemoveAtStart(static_cast<uint32_t>(header.GetSize()));
-
-        complete->RemoveHeader(header);
-
-        m_rxTraceWithSeqTsSize(complete, from, localAddress, header);
-
-        if (buffer->GetSize() > header.GetSerializedSize())
+        if (stream.remaining > 0)
         {
-            buffer->PeekHeader(header);
+            // the payload of the message only moves the offset
+            uint32_t n = std::min<uint64_t>(stream.remaining, size - offset);
+            offset += n;
+            stream.remaining -= n;
         }
         else
         {
-            break;
+            uint32_t n = std::min(headerSize - stream.nHeaderBytes, size - offset);
+            Ptr<const Packet> segment = offset == 0 ? p : p->CreateFragment(offset, n);
+            segment->CopyData(stream.headerBytes.data() + stream.nHeaderBytes, n);
+            offset += n;
+            stream.nHeaderBytes += n;
+            if (stream.nHeaderBytes < headerSize)
+            {
+                break;
+            }
+            Buffer buffer;
+            buffer.AddAtStart(headerSize);
+            buffer.Begin().Write(stream.headerBytes.data(), headerSize);
+            stream.header.Deserialize(buffer.Begin());
+            stream.nHeaderBytes = 0;
+            NS_ABORT_IF(stream.header.GetSize() < headerSize);
+            stream.remaining = stream.header.GetSize() - headerSize;
+        }
+        if (stream.remaining > 0)
+        {
+            continue;
+        }
+        NS_LOG_DEBUG("Received message of size " << stream.header.GetSize() << " at offset "
+                                                 << offset << " of a segment of " << size);
+        if (m_enableFlowStats)
+        {
+            m_flowStats.Get(MakeFlowKey(from, localAddress)).AddSequence(stream.header.GetSeq());
         }
+        Ptr<Packet> complete = Create<Packet>(stream.header.GetSize() - headerSize);
+        m_rxTraceWithSeqTsSize(complete, from, localAddress, stream.header);
     }
 }
 
@@ -3,6 +3,9 @@
 #ifndef ROMAM_SINK_H
 #define ROMAM_SINK_H
 
+#include "delay-histogram.h"
+#include "flow-stats-table.h"
+
 #include "ns3/address.h"
 #include "ns3/application.h"
 #include "ns3/event-id.h"
@@ -12,7 +15,10 @@
 #include "ns3/seq-ts-size-header.h"
 #include "ns3/traced-callback.h"
 
+#include <stdint.h>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -20,6 +26,7 @@ namespace ns3
 class Address;
 class Socket;
 class Packet;
+class RomamMetaTag;
 
 /**
  * \ingroup applications
@@ -65,6 +72,98 @@ class RomamSink : public Application
 
     virtual ~RomamSink();
 
+    /// How HandleRead () logs the delay of the sampled flagged packets
+    enum DelayLogFormat
+    {
+        TEXT_DELAY_LOG,   //!< one line per packet to sinked-packet.delay
+        BINARY_DELAY_LOG, //!< one DelayRecord per packet, buffered, to DelayLogFile
+        NO_DELAY_LOG      //!< no per packet output, for the histograms alone
+    };
+
+    /**
+     * \brief Record of a flagged packet in a binary delay log.
+     *
+     * The log starts with DELAY_LOG_MAGIC, then holds the records of all the
+     * sinks writing to it, in host byte order, in the order of their flushes.
+     */
+    struct DelayRecord
+    {
+        int64_t txTime;  //!< send time, in nanoseconds
+        int64_t delay;   //!< one way delay, in nanoseconds
+        uint32_t source; //!< source IPv4 address of the flow
+        uint16_t port;   //!< source port of the flow
+        uint16_t node;   //!< ID of the node of the sink, truncated
+    };
+
+    /// First bytes of a binary delay log
+    static constexpr char DELAY_LOG_MAGIC[8] = {'R', 'O', 'M', 'D', 'L', 'Y', '1', '\0'};
+
+    /**
+     * \brief Write a binary delay log in the text format of sinked-packet.delay,
+     * a line of send time and delay in milliseconds per packet.
+     * \param binaryPath the binary log
+     * \param textPath the text file to write
+     * \return false if the binary log cannot be read or the text file written
+     */
+    static bool ConvertDelayLog(const std::string& binaryPath, const std::string& textPath);
+
+    /**
+     * \brief Delays and deadlines of the flagged packets of a flow, or of all
+     * the flows of the sink.
+     */
+    struct FlowDelays
+    {
+        /**
+         * \param subBucketBits the precision of the histogram
+         */
+        FlowDelays(uint32_t subBucketBits);
+
+        DelayHistogram histogram; //!< the delays
+        uint64_t budgeted;        //!< packets with a budget
+        uint64_t deadlineMet;     //!< packets with a budget, received within it
+    };
+
+    /**
+     * \return the delays of all the flagged packets received, counted if
+     * EnableDelayHistograms is set
+     */
+    const FlowDelays& GetDelays() const;
+
+    /**
+     * \param from the address of the source of a flow
+     * \return the delays of the flagged packets of the flow, or null if it
+     * has no histogram
+     */
+    const FlowDelays* GetFlowDelays(const Address& from) const;
+
+    /**
+     * \return the counters by 5-tuple of the packets received, kept if
+     * EnableFlowStats is set
+     */
+    const FlowStatsTable& GetFlowStats() const;
+
+    /**
+     * TracedCallback signature for the delay of a flagged packet
+     *
+     * \param p The packet received
+     * \param from From address
+     * \param delay The one way delay of the packet
+     */
+    typedef void (*DelayCallback)(Ptr<const Packet> p, const Address& from, Time delay);
+
+    /**
+     * TracedCallback signature for a flagged packet received after its budget
+     *
+     * \param p The packet received
+     * \param from From address
+     * \param delay The one way delay of the packet
+     * \param budget The delay budget of the packet
+     */
+    typedef void (*DeadlineMissCallback)(Ptr<const Packet> p,
+                                         const Address& from,
+                                         Time delay,
+                                         Time budget);
+
     /**
      * \return the total bytes received in this sink app
      */
@@ -99,8 +198,6 @@ class RomamSink : public Application
                                       const Address& to,
                                       const SeqTsSizeHeader& header);
 
-    void MonitorThroughput(uint32_t interval);
-
     bool GetRecordDelay() const;
     void SetRecordDelay(bool recordDelay);
 
@@ -135,16 +232,82 @@ class RomamSink : public Application
     void HandlePeerError(Ptr<Socket> socket);
 
     /**
-     * \brief Packet received: assemble byte stream to extract SeqTsSizeHeader
+     * \brief Packet received: follow the byte stream to extract SeqTsSizeHeader
      * \param p received packet
      * \param from from address
      * \param localAddress local address
      *
-     * The method assembles a received byte stream and extracts SeqTsSizeHeader
-     * instances from the stream to export in a trace source.
+     * The method follows the offset of the byte stream of the peer in the
+     * current message, and extracts SeqTsSizeHeader instances from the
+     * stream to export in a trace source.  Only the bytes of the headers are
+     * copied, from the segments that hold some; the payload of a message is
+     * counted, not assembled, and the trace gets a packet of its size, as
+     * the senders of the header fill it with zeros.
      */
     void PacketReceived(const Ptr<Packet>& p, const Address& from, const Address& localAddress);
 
+    /**
+     * \brief Log the delay of a sampled flagged packet
+     * \param metaTag the metadata of the packet
+     * \param delay the delay of the packet
+     * \param from from address
+     */
+    void LogDelay(const RomamMetaTag& metaTag, Time delay, const Address& from);
+
+    /**
+     * \brief Count the delay of a flagged packet in the histograms
+     * \param metaTag the metadata of the packet
+     * \param delay the delay of the packet
+     * \param deadlineMet false if the packet has a budget and missed it
+     * \param from from address
+     */
+    void CountDelay(const RomamMetaTag& metaTag,
+                    Time delay,
+                    bool deadlineMet,
+                    const Address& from);
+
+    /**
+     * \brief Append the histograms of the sink to DelaySummaryFile.
+     *
+     * The first summary of the simulation in a file truncates it and writes
+     * a header.
+     */
+    void WriteDelaySummary() const;
+
+    /**
+     * \param from an address
+     * \return the key of the flow from the address
+     */
+    static uint64_t GetFlowKey(const Address& from);
+
+    /**
+     * \param from from address
+     * \param localAddress local address
+     * \return the 5-tuple of the flow, zero for the non IPv4 addresses
+     */
+    FlowKey MakeFlowKey(const Address& from, const Address& localAddress) const;
+
+    /**
+     * \brief Append the flow stats to FlowStatsFile and schedule the next
+     * snapshot.
+     */
+    void SnapshotFlowStats();
+
+    /**
+     * \brief Append the flow stats to FlowStatsFile, a line per flow.
+     *
+     * The first snapshot of the simulation in a file truncates it and writes
+     * a header.
+     */
+    void WriteFlowStats() const;
+
+    /**
+     * \brief Append the buffered delay records to DelayLogFile and empty the buffer.
+     *
+     * The first flush of the simulation to a file truncates it.
+     */
+    void FlushDelayLog();
+
     /**
      * \brief Hashing for the Address class
      */
@@ -168,7 +331,18 @@ class RomamSink : public Application
         }
     };
 
-    std::unordered_map<Address, Ptr<Packet>, AddressHash> m_buffer; //!< Buffer for received packets
+    /// where the byte stream of a peer is in its messages, see PacketReceived ()
+    struct SeqTsSizeStream
+    {
+        SeqTsSizeStream();
+
+        SeqTsSizeHeader header;           //!< the header of the message being received
+        std::vector<uint8_t> headerBytes; //!< the bytes of the next header received so far
+        uint32_t nHeaderBytes;            //!< the number of them
+        uint64_t remaining;               //!< the payload bytes of the message still to come
+    };
+
+    std::unordered_map<Address, SeqTsSizeStream, AddressHash> m_streams; //!< streams by peer
 
     // In the case of TCP, each socket accept returns a new socket, so the
     // listening socket is stored separately from the accepted sockets
@@ -179,13 +353,29 @@ class RomamSink : public Application
     uint64_t m_totalRx; //!< Total bytes received
     TypeId m_tid;       //!< Protocol TypeId
 
-    uint64_t m_old;
     bool m_recordDelay;
     Ptr<OutputStreamWrapper> m_delayStream =
         Create<OutputStreamWrapper>("sinked-packet.delay", std::ios::out);
 
-    Ptr<OutputStreamWrapper> m_throughputStream =
-        Create<OutputStreamWrapper>("throughput.txt", std::ios::out);
+    DelayLogFormat m_delayLogFormat;         //!< how the delays are logged
+    std::string m_delayLogFile;              //!< the binary delay log
+    uint32_t m_delayLogBufferSize;           //!< records buffered before a flush
+    std::vector<DelayRecord> m_delayRecords; //!< the records not flushed yet
+
+    bool m_enableHistograms;                          //!< count the delays in histograms
+    uint32_t m_subBucketBits;                         //!< precision of the histograms
+    uint32_t m_maxHistogramFlows;                     //!< flows with a histogram of their own
+    std::string m_delaySummaryFile;                   //!< file of the summary at stop
+    FlowDelays m_delays;                              //!< the delays of all the flows
+    std::unordered_map<uint64_t, FlowDelays> m_flows; //!< the delays by flow key
+
+    bool m_enableFlowStats;      //!< count the packets by 5-tuple
+    uint32_t m_maxFlows;         //!< flows with counters of their own
+    Time m_flowStatsInterval;    //!< time between the snapshots, 0 for at stop only
+    std::string m_flowStatsFile; //!< file of the snapshots
+    uint8_t m_protocol;          //!< IP protocol number of the sockets
+    FlowStatsTable m_flowStats;  //!< the counters by 5-tuple
+    EventId m_flowStatsEvent;    //!< the next snapshot
 
     bool m_enableSeqTsSizeHeader{false}; //!< Enable or disable the export of SeqTsSize header
 
@@ -197,6 +387,10 @@ class RomamSink : public Application
     /// headers
     TracedCallback<Ptr<const Packet>, const Address&, const Address&, const SeqTsSizeHeader&>
         m_rxTraceWithSeqTsSize;
+    /// Traced Callback: delay of the sampled flagged packets
+    TracedCallback<Ptr<const Packet>, const Address&, Time> m_delayTrace;
+    /// Traced Callback: flagged packets received after their budget
+    TracedCallback<Ptr<const Packet>, const Address&, Time, Time> m_deadlineMissTrace;
 };
 
 } // namespace ns3
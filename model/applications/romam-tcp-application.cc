@@ -3,9 +3,11 @@
 #include "romam-tcp-application.h"
 
 #include "../datapath/romam-tags.h"
+#include "../utility/event-accounting.h"
 
 #include "ns3/address.h"
 #include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/log.h"
 #include "ns3/network-module.h"
 #include "ns3/node.h"
@@ -67,11 +69,31 @@ RomamTcpApplication::GetTypeId(void)
                           UintegerValue(MAX_UINT_32),
                           MakeUintegerAccessor(&RomamTcpApplication::m_budget),
                           MakeUintegerChecker<uint32_t>())
+            .AddAttribute("Priority",
+                          "Mark the segments with the priority ToS, which DDRQueueDisc can "
+                          "classify on",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RomamTcpApplication::m_priority),
+                          MakeBooleanChecker())
+            .AddAttribute("FillTxBuffer",
+                          "Send as many bytes as GetTxAvailable allows in each packet, "
+                          "instead of SendSize bytes, so that filling the socket buffer takes "
+                          "one call; the bytes of a packet share its timestamp",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RomamTcpApplication::m_fillTxBuffer),
+                          MakeBooleanChecker())
             .AddAttribute("EnableFlag",
                           "EnableFalg in DGR header for test",
                           BooleanValue(false),
                           MakeBooleanAccessor(&RomamTcpApplication::m_flag),
                           MakeBooleanChecker())
+            .AddAttribute("TraceSampleRate",
+                          "The fraction of the flagged packets the sinks log the delay of; "
+                          "the others they only count.  The packets are picked by a hash of "
+                          "their node and byte offset, the same in every run",
+                          DoubleValue(1),
+                          MakeDoubleAccessor(&RomamTcpApplication::m_sampleRate),
+                          MakeDoubleChecker<double>(0, 1))
             .AddTraceSource("Tx",
                             "A new packet is sent",
                             MakeTraceSourceAccessor(&RomamTcpApplication::m_txTrace),
@@ -85,7 +107,10 @@ RomamTcpApplication::RomamTcpApplication()
       m_totBytes(0),
       m_unsentPacket(0),
       m_budget(MAX_UINT_32),
-      m_flag(false)
+      m_flag(false),
+      m_priority(false),
+      m_fillTxBuffer(false),
+      m_sampleRate(1)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -108,6 +133,12 @@ RomamTcpApplication::SetFlag(bool flag)
     m_flag = flag;
 }
 
+void
+RomamTcpApplication::SetPriority(bool priority)
+{
+    m_priority = priority;
+}
+
 void
 RomamTcpApplication::Setup(Ptr<Socket> socket,
                            Address sinkAddress,
@@ -202,6 +233,17 @@ RomamTcpApplication::StartApplication(void) // Called at time specified by Start
                                      MakeCallback(&RomamTcpApplication::ConnectionFailed, this));
         m_socket->SetSendCallback(MakeCallback(&RomamTcpApplication::DataSend, this));
     }
+    if (m_priority)
+    {
+        // packet tags do not survive segmentation, the ToS does
+        m_socket->SetIpTos(PriorityTag::PRIORITY_TOS);
+    }
+    m_metaTag = RomamMetaTag();
+    m_metaTag.SetFlag(m_flag);
+    if (m_budget != MAX_UINT_32)
+    {
+        m_metaTag.SetBudget(m_budget);
+    }
     if (m_connected)
     {
         m_socket->GetSockName(from);
@@ -231,6 +273,7 @@ void
 RomamTcpApplication::SendData(const Address& from, const Address& to)
 {
     NS_LOG_FUNCTION(this);
+    EventAccounting::Scope scope(EventAccounting::APPLICATION);
 
     while (m_maxBytes == 0 || m_totBytes < m_maxBytes)
     { // Time to send more
@@ -240,6 +283,15 @@ RomamTcpApplication::SendData(const Address& from, const Address& to)
         // m_sendSize is uint32_t.
         uint64_t toSend = m_sendSize;
         // Make sure we don't send too many
+        if (m_fillTxBuffer && !m_unsentPacket)
+        {
+            toSend = m_socket->GetTxAvailable();
+            if (toSend == 0)
+            {
+                // the "DataSent" callback will pop when some buffer space has freed up
+                break;
+            }
+        }
         if (m_maxBytes > 0)
         {
             toSend = std::min(toSend, m_maxBytes - m_totBytes);
@@ -248,13 +300,6 @@ RomamTcpApplication::SendData(const Address& from, const Address& to)
         NS_LOG_LOGIC("sending packet at " << Simulator::Now());
         Ptr<Packet> packet;
 
-        TimestampTag txTimeTag;
-        FlagTag flagTag;
-        BudgetTag budgetTag;
-        txTimeTag.SetTimestamp(Simulator::Now());
-        flagTag.SetFlag(m_flag);
-        // flagTag.Print (std::cout);
-
         if (m_unsentPacket)
         {
             packet = m_unsentPacket;
@@ -262,14 +307,16 @@ RomamTcpApplication::SendData(const Address& from, const Address& to)
         }
         else
         {
+            // the payload is virtual, zero filled bytes that are never allocated
             packet = Create<Packet>(toSend);
-            packet->AddPacketTag(txTimeTag);
-            packet->AddPacketTag(flagTag);
-            if (m_budget != MAX_UINT_32)
+            RomamMetaTag metaTag = m_metaTag;
+            metaTag.SetTimestamp(Simulator::Now());
+            if (m_flag && m_sampleRate < 1)
             {
-                budgetTag.SetBudget(m_budget);
-                packet->AddPacketTag(budgetTag);
+                uint64_t key = (static_cast<uint64_t>(GetNode()->GetId()) << 48) ^ m_totBytes;
+                metaTag.SetSampled(RomamMetaTag::Sample(key, m_sampleRate));
             }
+            packet->AddPacketTag(metaTag);
         }
         int actual = m_socket->Send(packet);
         if ((unsigned)actual == toSend)
@@ -3,6 +3,8 @@
 #ifndef ROMAM_TCP_APPLICATION_H
 #define ROMAM_TCP_APPLICATION_H
 
+#include "../datapath/romam-tags.h"
+
 #include "ns3/address.h"
 #include "ns3/application.h"
 #include "ns3/event-id.h"
@@ -46,6 +48,12 @@ class RomamTcpApplication : public Application
      */
     void SetFlag(bool flag);
 
+    /**
+     * \brief Mark the segments with the priority ToS.
+     * \param priority whether the flow has priority
+     */
+    void SetPriority(bool priority);
+
     /**
      * \brief Get the socket this application is attached to.
      * \return pointer to associated socket
@@ -85,6 +93,10 @@ class RomamTcpApplication : public Application
     Ptr<Packet> m_unsentPacket; //!< Variable to cache unsent packet
     uint32_t m_budget;          //!< Budget time in ms
     bool m_flag{false};         //!< flag for test
+    bool m_priority;            //!< whether the segments carry the priority ToS
+    bool m_fillTxBuffer;        //!< send as much as the socket takes in one packet
+    double m_sampleRate;        //!< fraction of the flagged packets sampled
+    RomamMetaTag m_metaTag;     //!< tag of the packets but their timestamp, built at start
     // bool            m_enableSeqTsSizeHeader {false}; //!< Enable or disable the SeqTsSizeHeader
 
     /// Traced Callback: sent packets
@@ -3,6 +3,7 @@
 #include "romam-udp-application.h"
 
 #include "../datapath/romam-tags.h"
+#include "../utility/event-accounting.h"
 
 #include "ns3/applications-module.h"
 #include "ns3/core-module.h"
@@ -12,9 +13,10 @@
 #include "ns3/point-to-point-module.h"
 #include "ns3/timestamp-tag.h"
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
-
-#define MAX_UINT_32 0xffffffff
+#include <sstream>
 
 namespace ns3
 {
@@ -32,11 +34,13 @@ RomamUdpApplication::RomamUdpApplication()
       m_sendEvent(),
       m_running(false),
       m_packetSent(0),
-      m_budget(MAX_UINT_32),
+      m_budget(NO_BUDGET),
       m_flag(false),
-      m_vbr(false),
-      m_priority(false)
+      m_priority(false),
+      m_sampleRate(1)
 {
+    m_uniform = CreateObject<UniformRandomVariable>();
+    m_exponential = CreateObject<ExponentialRandomVariable>();
 }
 
 RomamUdpApplication::~RomamUdpApplication()
@@ -51,12 +55,49 @@ RomamUdpApplication::GetTypeId()
                             .SetParent<Application>()
                             .SetGroupName("Romam")
                             .AddConstructor<RomamUdpApplication>()
-        // .AddAttribute ("Variable_bitrate",
-        //                "Enable the VBR",
-        //                BooleanValue (false),
-        //                MakeBooleanAccessor (&RomamUdpApplication::m_vbr),
-        //                MakeBooleanChecker ())
-        ;
+            .AddAttribute("ArrivalProcess",
+                          "When the packets of the flows are sent",
+                          EnumValue(CBR_ARRIVALS),
+                          MakeEnumAccessor(&RomamUdpApplication::m_arrivals),
+                          MakeEnumChecker(CBR_ARRIVALS,
+                                          "Cbr",
+                                          VBR_ARRIVALS,
+                                          "Vbr",
+                                          POISSON_ARRIVALS,
+                                          "Poisson",
+                                          ON_OFF_ARRIVALS,
+                                          "OnOff",
+                                          TRACE_ARRIVALS,
+                                          "Trace"))
+            .AddAttribute("OnTime",
+                          "A RandomVariableStream giving the duration of the on periods, in s",
+                          StringValue("ns3::ConstantRandomVariable[Constant=1.0]"),
+                          MakePointerAccessor(&RomamUdpApplication::m_onTime),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("OffTime",
+                          "A RandomVariableStream giving the duration of the off periods, in s",
+                          StringValue("ns3::ConstantRandomVariable[Constant=1.0]"),
+                          MakePointerAccessor(&RomamUdpApplication::m_offTime),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("TraceFile",
+                          "The trace replayed by every flow, a line \"time size\" per packet, "
+                          "with the time in seconds from the start",
+                          StringValue(""),
+                          MakeStringAccessor(&RomamUdpApplication::m_traceFile),
+                          MakeStringChecker())
+            .AddAttribute("BatchInterval",
+                          "The minimum time between two send events; the packets due in "
+                          "between wait for the next event",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RomamUdpApplication::m_batchInterval),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("TraceSampleRate",
+                          "The fraction of the flagged packets the sinks log the delay of; "
+                          "the others they only count.  The packets are picked by a hash of "
+                          "their node, flow and sequence number, the same in every run",
+                          DoubleValue(1),
+                          MakeDoubleAccessor(&RomamUdpApplication::m_sampleRate),
+                          MakeDoubleChecker<double>(0, 1));
     return tid;
 }
 
@@ -94,20 +135,102 @@ RomamUdpApplication::Setup(Ptr<Socket> socket,
     m_flag = flag;
 }
 
+void
+RomamUdpApplication::SetFlag(bool flag)
+{
+    m_flag = flag;
+}
+
 void
 RomamUdpApplication::SetPriority(bool priority)
 {
     m_priority = priority;
 }
 
+void
+RomamUdpApplication::AddFlow(Address peer,
+                             DataRate dataRate,
+                             uint32_t packetSize,
+                             uint32_t nPackets,
+                             uint32_t budget)
+{
+    m_flows.push_back(Flow{peer, dataRate, packetSize, nPackets, 0, budget, Time(), 0});
+}
+
+void
+RomamUdpApplication::LoadTrafficMatrix(const std::string& path, uint32_t packetSize)
+{
+    std::ifstream in(path);
+    NS_ABORT_MSG_IF(!in, "Cannot read the traffic matrix " << path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string address;
+        uint16_t port;
+        std::string rate;
+        if (!(fields >> address) || address[0] == '#')
+        {
+            continue;
+        }
+        NS_ABORT_MSG_IF(!(fields >> port >> rate), "Bad traffic matrix line: " << line);
+        AddFlow(InetSocketAddress(Ipv4Address(address.c_str()), port), DataRate(rate), packetSize);
+    }
+}
+
+int64_t
+RomamUdpApplication::AssignStreams(int64_t stream)
+{
+    m_uniform->SetStream(stream);
+    m_exponential->SetStream(stream + 1);
+    m_onTime->SetStream(stream + 2);
+    m_offTime->SetStream(stream + 3);
+    return 4;
+}
+
 void
 RomamUdpApplication::StartApplication(void)
 {
     m_running = true;
     m_packetSent = 0;
+    m_start = Simulator::Now();
+    m_active.clear();
+    if (!m_peer.IsInvalid())
+    {
+        // the first packet goes whatever nPackets, as it always did
+        m_active.push_back(Flow{m_peer,
+                                m_dataRate,
+                                m_packetSize,
+                                std::max(m_nPackets, 1u),
+                                0,
+                                m_budget,
+                                Time(),
+                                0});
+    }
+    m_active.insert(m_active.end(), m_flows.begin(), m_flows.end());
+    if (!m_socket)
+    {
+        m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+    }
     m_socket->Bind();
-    m_socket->Connect(m_peer);
-    SendPacket();
+    if (m_active.size() == 1)
+    {
+        m_socket->Connect(m_active[0].peer);
+    }
+    if (m_priority)
+    {
+        m_socket->SetIpTos(PriorityTag::PRIORITY_TOS);
+    }
+    if (m_arrivals == TRACE_ARRIVALS && m_trace.empty())
+    {
+        LoadTrace();
+    }
+    m_schedule = decltype(m_schedule)();
+    for (uint32_t i = 0; i < m_active.size(); i++)
+    {
+        StartFlow(i);
+    }
+    SendDue();
 }
 
 void
@@ -118,6 +241,7 @@ RomamUdpApplication::StopApplication(void)
     {
         Simulator::Cancel(m_sendEvent);
     }
+    m_schedule = decltype(m_schedule)();
     if (m_socket)
     {
         m_socket->Close();
@@ -125,55 +249,152 @@ RomamUdpApplication::StopApplication(void)
 }
 
 void
-RomamUdpApplication::SendPacket()
+RomamUdpApplication::LoadTrace()
+{
+    std::ifstream in(m_traceFile);
+    NS_ABORT_MSG_IF(!in, "Cannot read the trace " << m_traceFile);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        double time;
+        uint32_t size;
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        NS_ABORT_MSG_IF(!(fields >> time >> size), "Bad trace line: " << line);
+        m_trace.emplace_back(Seconds(time), size);
+    }
+    std::stable_sort(m_trace.begin(), m_trace.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+}
+
+void
+RomamUdpApplication::StartFlow(uint32_t index)
+{
+    Flow& flow = m_active[index];
+    flow.packetSent = 0;
+    flow.next = 0;
+    if (m_arrivals == ON_OFF_ARRIVALS)
+    {
+        flow.onEnd = Simulator::Now() + Seconds(m_onTime->GetValue());
+    }
+    if (m_arrivals == TRACE_ARRIVALS)
+    {
+        if (!m_trace.empty())
+        {
+            m_schedule.emplace(m_start + m_trace[0].first, index);
+        }
+        return;
+    }
+    m_schedule.emplace(Simulator::Now(), index);
+}
+
+void
+RomamUdpApplication::SendDue()
+{
+    EventAccounting::Scope scope(EventAccounting::APPLICATION);
+    Time now = Simulator::Now();
+    while (!m_schedule.empty() && m_schedule.top().first <= now)
+    {
+        Departure departure = m_schedule.top();
+        m_schedule.pop();
+        Flow& flow = m_active[departure.second];
+        uint32_t size =
+            m_arrivals == TRACE_ARRIVALS ? m_trace[flow.next].second : flow.packetSize;
+        SendPacket(flow, size);
+        ScheduleNext(departure.second, departure.first);
+    }
+    ScheduleTx();
+}
+
+void
+RomamUdpApplication::SendPacket(Flow& flow, uint32_t size)
 {
-    TimestampTag txTimeTag;
-    FlagTag flagTag;
-    BudgetTag budgetTag;
+    RomamMetaTag metaTag;
 
-    Ptr<Packet> packet = Create<Packet>(m_packetSize);
+    Ptr<Packet> packet = Create<Packet>(size);
     if (m_priority)
     {
-        PriorityTag priorityTag;
-        priorityTag.SetPriority(true);
-        packet->AddPacketTag(priorityTag);
+        metaTag.SetPriority(true);
     }
     Time txTime = Simulator::Now();
-    if (m_budget != MAX_UINT_32)
+    if (flow.budget != NO_BUDGET)
+    {
+        metaTag.SetBudget(flow.budget);
+    }
+    metaTag.SetFlag(m_flag);
+    if (m_flag && m_sampleRate < 1)
+    {
+        uint64_t index = &flow - m_active.data();
+        uint64_t key = (static_cast<uint64_t>(GetNode()->GetId()) << 48) ^ (index << 32) ^
+                       flow.packetSent;
+        metaTag.SetSampled(RomamMetaTag::Sample(key, m_sampleRate));
+    }
+    metaTag.SetTimestamp(txTime);
+    packet->AddPacketTag(metaTag);
+    if (m_active.size() == 1)
     {
-        budgetTag.SetBudget(m_budget);
-        packet->AddPacketTag(budgetTag);
+        m_socket->Send(packet);
     }
-    flagTag.SetFlag(m_flag);
-    txTimeTag.SetTimestamp(txTime);
-    packet->AddPacketTag(txTimeTag);
-    packet->AddPacketTag(flagTag);
-    // std::cout << "Send a packet\n";
-    m_socket->Send(packet);
-    if (++m_packetSent < m_nPackets)
+    else
     {
-        ScheduleTx();
+        m_socket->SendTo(packet, 0, flow.peer);
     }
+    flow.packetSent++;
+    m_packetSent++;
 }
 
 void
-RomamUdpApplication::ScheduleTx()
+RomamUdpApplication::ScheduleNext(uint32_t index, Time last)
 {
-    if (m_running)
+    Flow& flow = m_active[index];
+    if (flow.nPackets != 0 && flow.packetSent >= flow.nPackets)
+    {
+        return;
+    }
+    double gap = flow.packetSize * 8 / static_cast<double>(flow.dataRate.GetBitRate());
+    Time next;
+    switch (m_arrivals)
     {
-        if (m_vbr)
+    case CBR_ARRIVALS:
+        next = last + Seconds(gap);
+        break;
+    case VBR_ARRIVALS:
+        next = last + Seconds(static_cast<double>(m_uniform->GetInteger(1, 100)) / 100 * gap);
+        break;
+    case POISSON_ARRIVALS:
+        next = last + Seconds(m_exponential->GetValue(gap, 0));
+        break;
+    case ON_OFF_ARRIVALS:
+        next = last + Seconds(gap);
+        if (next > flow.onEnd)
         {
-            Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable>();
-            double rate = static_cast<double>(rand->GetInteger(1, 100)) / 100;
-            Time tNext(
-                Seconds(rate * m_packetSize * 8 / static_cast<double>(m_dataRate.GetBitRate())));
-            m_sendEvent = Simulator::Schedule(tNext, &RomamUdpApplication::SendPacket, this);
+            next = flow.onEnd + Seconds(m_offTime->GetValue());
+            flow.onEnd = next + Seconds(m_onTime->GetValue());
         }
-        else
+        break;
+    case TRACE_ARRIVALS:
+        if (++flow.next >= m_trace.size())
         {
-            Time tNext(Seconds(m_packetSize * 8 / static_cast<double>(m_dataRate.GetBitRate())));
-            m_sendEvent = Simulator::Schedule(tNext, &RomamUdpApplication::SendPacket, this);
+            return;
         }
+        next = m_start + m_trace[flow.next].first;
+        break;
+    }
+    m_schedule.emplace(next, index);
+}
+
+void
+RomamUdpApplication::ScheduleTx()
+{
+    if (m_running && !m_schedule.empty())
+    {
+        Time next = std::max(m_schedule.top().first, Simulator::Now() + m_batchInterval);
+        m_sendEvent =
+            Simulator::Schedule(next - Simulator::Now(), &RomamUdpApplication::SendDue, this);
     }
 }
 
@@ -181,6 +402,14 @@ void
 RomamUdpApplication::ChangeRate(DataRate newDataRate)
 {
     m_dataRate = newDataRate;
+    for (Flow& flow : m_active)
+    {
+        flow.dataRate = newDataRate;
+    }
+    for (Flow& flow : m_flows)
+    {
+        flow.dataRate = newDataRate;
+    }
 }
 
 } // namespace ns3
\ No newline at end of file
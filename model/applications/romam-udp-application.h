@@ -10,13 +10,39 @@
 #include "ns3/point-to-point-module.h"
 
 #include <iostream>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace ns3
 {
 
+/**
+ * \brief UDP source of the flagged, budgeted packets the sinks measure.
+ *
+ * The application sends to the peer of Setup (), and to the flows added with
+ * AddFlow () or LoadTrafficMatrix (), each with its own rate and arrival
+ * process.  All the flows share the socket and one send event: the event
+ * fires at the earliest send time of the flows, or every BatchInterval, and
+ * sends every packet due by then.
+ */
 class RomamUdpApplication : public Application
 {
   public:
+    /// When the packets of a flow are sent
+    enum ArrivalProcess
+    {
+        CBR_ARRIVALS,     //!< at the data rate
+        VBR_ARRIVALS,     //!< after a gap uniform in 1% to 100% of the CBR gap
+        POISSON_ARRIVALS, //!< after exponential gaps of mean the CBR gap
+        ON_OFF_ARRIVALS,  //!< at the data rate during the OnTime periods, none during OffTime
+        TRACE_ARRIVALS    //!< at the times and sizes of TraceFile, from the start
+    };
+
+    /// Budget of the packets sent without one
+    static constexpr uint32_t NO_BUDGET = 0xffffffff;
+
     RomamUdpApplication();
     ~RomamUdpApplication() override;
 
@@ -60,13 +86,49 @@ class RomamUdpApplication : public Application
                bool flag = false);
 
     /**
-     * Update the sending rate.
+     * Add a flow, sent with the flag and priority of the application.
+     * \param peer The destination address.
+     * \param dataRate The data rate of the flow.
+     * \param packetSize The packet size to transmit.
+     * \param nPackets The number of packets to transmit, 0 for no limit
+     * \param budget The packet budget, as in Setup (), or NO_BUDGET
+     */
+    void AddFlow(Address peer,
+                 DataRate dataRate,
+                 uint32_t packetSize,
+                 uint32_t nPackets = 0,
+                 uint32_t budget = NO_BUDGET);
+
+    /**
+     * Add a flow for every line "address port rate" of a traffic matrix file,
+     * such as "10.1.2.2 9 2Mbps".  The lines starting with # are skipped.
+     * \param path The traffic matrix file.
+     * \param packetSize The packet size of the flows.
+     */
+    void LoadTrafficMatrix(const std::string& path, uint32_t packetSize);
+
+    /**
+     * Update the sending rate of all the flows.
      * \param newDataRate The new DataRate
      */
     void ChangeRate(DataRate newDataRate);
 
     /**
-     * Set the priority tag.
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.
+     * \param stream The first stream index to use
+     * \return The number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * Set the flag of the packets, for the sinks to log their delay.
+     * \param flag The packet flag
+     */
+    void SetFlag(bool flag);
+
+    /**
+     * Set the priority tag, and the priority ToS of the socket.
      * \param priority
      */
     void SetPriority(bool priority);
@@ -75,10 +137,57 @@ class RomamUdpApplication : public Application
     void StartApplication(void) override;
     void StopApplication(void) override;
 
-    /// Schedule a new transmission
+    /// A destination of the application
+    struct Flow
+    {
+        Address peer;        //!< The destination address
+        DataRate dataRate;   //!< The data rate of the flow
+        uint32_t packetSize; //!< The packet size
+        uint32_t nPackets;   //!< The number of packets to send, 0 for no limit
+        uint32_t packetSent; //!< The number of packets sent
+        uint32_t budget;     //!< The packet budget, or NO_BUDGET
+        Time onEnd;          //!< End of the current on period, with ON_OFF_ARRIVALS
+        std::size_t next;    //!< Next line of the trace, with TRACE_ARRIVALS
+    };
+
+    /// A send time and the flow sending then, earliest first in m_schedule
+    typedef std::pair<Time, uint32_t> Departure;
+
+    /**
+     * Send the packets due, and schedule the send event at the next departure.
+     */
+    void SendDue();
+
+    /**
+     * Send a packet.
+     * \param flow The flow
+     * \param size The packet size
+     */
+    void SendPacket(Flow& flow, uint32_t size);
+
+    /**
+     * Queue the first departure of a flow.
+     * \param index The flow index
+     */
+    void StartFlow(uint32_t index);
+
+    /**
+     * Queue the next departure of a flow, if it has packets left.
+     * \param index The flow index
+     * \param last The time of the last departure
+     */
+    void ScheduleNext(uint32_t index, Time last);
+
+    /**
+     * Schedule the send event at the earliest departure, no sooner than the
+     * end of the batch.
+     */
     void ScheduleTx();
-    /// Send a packet
-    void SendPacket();
+
+    /**
+     * Read TraceFile into m_trace.
+     */
+    void LoadTrace();
 
     Ptr<Socket> m_socket;  //!< The transmission socket
     Address m_peer;        //!< The destination address
@@ -90,8 +199,23 @@ class RomamUdpApplication : public Application
     uint32_t m_packetSent; //!< The number of packets sent.
     uint32_t m_budget;     //!< The budget time in millisecond
     bool m_flag;           //!< The packet flag
-    bool m_vbr;            //!< true meanse VBR
     bool m_priority;       //!< priority
+    double m_sampleRate;   //!< fraction of the flagged packets sampled
+
+    ArrivalProcess m_arrivals;                    //!< when the packets are sent
+    Ptr<RandomVariableStream> m_onTime;           //!< duration of the on periods
+    Ptr<RandomVariableStream> m_offTime;          //!< duration of the off periods
+    std::string m_traceFile;                      //!< the trace to replay
+    Time m_batchInterval;                         //!< minimum time between two send events
+    Ptr<UniformRandomVariable> m_uniform;         //!< draws the VBR gaps
+    Ptr<ExponentialRandomVariable> m_exponential; //!< draws the Poisson gaps
+    /// send times, from the start, and sizes of the packets of TraceFile
+    std::vector<std::pair<Time, uint32_t>> m_trace;
+    std::vector<Flow> m_flows;  //!< the flows of AddFlow ()
+    std::vector<Flow> m_active; //!< the flows of the run, the one of Setup () first
+    Time m_start;               //!< when the application started
+    /// the next departure of every flow with packets left
+    std::priority_queue<Departure, std::vector<Departure>, std::greater<Departure>> m_schedule;
 };
 
 } // namespace ns3
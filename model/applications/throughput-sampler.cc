@@ -0,0 +1,272 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "throughput-sampler.h"
+
+#include "romam-sink.h"
+
+#include "ns3/address.h"
+#include "ns3/assert.h"
+#include "ns3/global-value.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/type-id.h"
+#include "ns3/udp-socket-factory.h"
+
+#include <cstring>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ThroughputSampler");
+
+/// time from one sample of the sinks to the next
+static GlobalValue g_throughputInterval(
+    "RomamThroughputInterval",
+    "Time from one sample of the bytes received by the RomamSinks to the next "
+    "(0 to not sample them)",
+    TimeValue(Seconds(0)),
+    MakeTimeChecker(Seconds(0)));
+
+/// file the samples of the sinks are written to
+static GlobalValue g_throughputFile("RomamThroughputFile",
+                                    "File the rows of the bytes received by the RomamSinks "
+                                    "are written to",
+                                    StringValue("romam-throughput.bin"),
+                                    MakeStringChecker());
+
+/// the magic of a file of samples
+static const char THROUGHPUT_MAGIC[8] = {'R', 'O', 'M', 'A', 'M', 'T', 'H', 'R'};
+/// layout of the file, to be changed along with the structures below
+static const uint32_t THROUGHPUT_FORMAT = 1;
+
+/// beginning of the file
+struct ThroughputFileHeader
+{
+    char magic[8];     //!< THROUGHPUT_MAGIC
+    uint32_t format;   //!< THROUGHPUT_FORMAT
+    uint32_t reserved; //!< 0
+    int64_t start;     //!< time of the first sample, in ns
+    int64_t interval;  //!< time from one sample to the next, in ns
+};
+
+static_assert(sizeof(ThroughputFileHeader) == 32, "ThroughputFileHeader must have no padding");
+static_assert(sizeof(ThroughputSampler::RecordHeader) == 16, "RecordHeader must have no padding");
+static_assert(sizeof(ThroughputSampler::Column) == 12, "Column must have no padding");
+
+ThroughputSampler* ThroughputSampler::s_sampler = nullptr;
+
+ThroughputSampler::ThroughputSampler()
+    : m_nLive(0)
+{
+    TimeValue interval;
+    g_throughputInterval.GetValue(interval);
+    m_interval = interval.Get();
+    StringValue path;
+    g_throughputFile.GetValue(path);
+    m_path = path.Get();
+    m_start = Simulator::Now() + m_interval;
+
+    ThroughputFileHeader header;
+    std::memcpy(header.magic, THROUGHPUT_MAGIC, sizeof(header.magic));
+    header.format = THROUGHPUT_FORMAT;
+    header.reserved = 0;
+    header.start = m_start.GetNanoSeconds();
+    header.interval = m_interval.GetNanoSeconds();
+    m_out.open(m_path, std::ios::binary | std::ios::trunc);
+    m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!m_out)
+    {
+        NS_LOG_WARN("Cannot write the throughput samples to " << m_path);
+    }
+}
+
+bool
+ThroughputSampler::IsEnabled()
+{
+    TimeValue interval;
+    g_throughputInterval.GetValue(interval);
+    return interval.Get().IsStrictlyPositive();
+}
+
+void
+ThroughputSampler::Add(Ptr<RomamSink> sink)
+{
+    NS_LOG_FUNCTION(sink);
+    if (!IsEnabled())
+    {
+        return;
+    }
+    if (!s_sampler)
+    {
+        s_sampler = new ThroughputSampler();
+        Simulator::ScheduleDestroy(&ThroughputSampler::Destroy);
+    }
+    ThroughputSampler& sampler = *s_sampler;
+    if (sampler.m_nLive++ == 0)
+    {
+        sampler.Start();
+    }
+
+    Column column;
+    column.nodeId = sink->GetNode()->GetId();
+    column.address = 0;
+    column.port = 0;
+    AddressValue local;
+    sink->GetAttribute("Local", local);
+    if (InetSocketAddress::IsMatchingType(local.Get()))
+    {
+        InetSocketAddress address = InetSocketAddress::ConvertFrom(local.Get());
+        column.address = address.GetIpv4().Get();
+        column.port = address.GetPort();
+    }
+    TypeIdValue protocol;
+    sink->GetAttribute("Protocol", protocol);
+    column.protocol = protocol.Get() == UdpSocketFactory::GetTypeId() ? 17 : 6;
+    column.reserved = 0;
+    RecordHeader record = {SINK_RECORD,
+                           static_cast<uint32_t>(sampler.m_sinks.size()),
+                           Simulator::Now().GetNanoSeconds()};
+    sampler.m_out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    sampler.m_out.write(reinterpret_cast<const char*>(&column), sizeof(column));
+    sampler.m_sinks.push_back(PeekPointer(sink));
+    sampler.m_counts.push_back(sink->GetTotalRx());
+}
+
+void
+ThroughputSampler::Remove(const RomamSink* sink)
+{
+    if (!s_sampler)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < s_sampler->m_sinks.size(); i++)
+    {
+        if (s_sampler->m_sinks[i] == sink)
+        {
+            NS_LOG_FUNCTION(sink);
+            s_sampler->m_counts[i] = sink->GetTotalRx();
+            s_sampler->m_sinks[i] = nullptr;
+            if (--s_sampler->m_nLive == 0)
+            {
+                s_sampler->m_event.Cancel();
+            }
+            return;
+        }
+    }
+}
+
+void
+ThroughputSampler::Start()
+{
+    // the samples missed while no sink was started are skipped, not taken
+    Time now = Simulator::Now();
+    uint64_t next = 0;
+    if (now >= m_start)
+    {
+        next = (now - m_start).GetTimeStep() / m_interval.GetTimeStep() + 1;
+    }
+    Time at = TimeStep(m_start.GetTimeStep() + m_interval.GetTimeStep() * next);
+    m_event = Simulator::Schedule(at - now, &ThroughputSampler::Sample, this);
+}
+
+void
+ThroughputSampler::Sample()
+{
+    for (uint32_t i = 0; i < m_sinks.size(); i++)
+    {
+        if (m_sinks[i])
+        {
+            m_counts[i] = m_sinks[i]->GetTotalRx();
+        }
+    }
+    RecordHeader record = {ROW_RECORD,
+                           static_cast<uint32_t>(m_counts.size()),
+                           Simulator::Now().GetNanoSeconds()};
+    m_out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    m_out.write(reinterpret_cast<const char*>(m_counts.data()),
+                m_counts.size() * sizeof(uint64_t));
+    if (m_nLive > 0)
+    {
+        m_event = Simulator::Schedule(m_interval, &ThroughputSampler::Sample, this);
+    }
+}
+
+void
+ThroughputSampler::Destroy()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT(s_sampler);
+    s_sampler->m_event.Cancel();
+    s_sampler->m_out.close();
+    if (!s_sampler->m_out)
+    {
+        NS_LOG_WARN("Cannot write the throughput samples to " << s_sampler->m_path);
+    }
+    else
+    {
+        NS_LOG_LOGIC("Wrote the samples of " << s_sampler->m_sinks.size() << " sinks to "
+                                             << s_sampler->m_path);
+    }
+    delete s_sampler;
+    s_sampler = nullptr;
+}
+
+bool
+ThroughputSampler::Decode(std::istream& is, std::ostream& os)
+{
+    ThroughputFileHeader header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, THROUGHPUT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.format != THROUGHPUT_FORMAT)
+    {
+        return false;
+    }
+    os << "time_ns,node,address,port,protocol,rx_bytes,interval_bytes\n";
+    std::vector<Column> columns;
+    std::vector<uint64_t> counts;
+    std::vector<uint64_t> previous;
+    RecordHeader record;
+    while (is.read(reinterpret_cast<char*>(&record), sizeof(record)))
+    {
+        if (record.type == SINK_RECORD)
+        {
+            if (record.n != columns.size())
+            {
+                return false;
+            }
+            Column column;
+            if (!is.read(reinterpret_cast<char*>(&column), sizeof(column)))
+            {
+                return false;
+            }
+            columns.push_back(column);
+            previous.push_back(0);
+            continue;
+        }
+        if (record.type != ROW_RECORD || record.n > columns.size())
+        {
+            return false;
+        }
+        counts.resize(record.n);
+        if (!is.read(reinterpret_cast<char*>(counts.data()), counts.size() * sizeof(uint64_t)))
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < record.n; i++)
+        {
+            const Column& column = columns[i];
+            os << record.time << ',' << column.nodeId << ',' << Ipv4Address(column.address)
+               << ',' << column.port << ',' << static_cast<uint32_t>(column.protocol) << ','
+               << counts[i] << ',' << counts[i] - previous[i] << '\n';
+            previous[i] = counts[i];
+        }
+    }
+    // a file ends on a whole record
+    return is.eof() && is.gcount() == 0;
+}
+
+} // namespace ns3
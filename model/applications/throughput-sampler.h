@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef THROUGHPUT_SAMPLER_H
+#define THROUGHPUT_SAMPLER_H
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class RomamSink;
+
+/**
+ * \brief Bytes received by every RomamSink, sampled at fixed intervals into
+ * one file.
+ *
+ * A single simulator event reads the counter of every sink registered, every
+ * RomamThroughputInterval, and appends a row of them to RomamThroughputFile,
+ * so the sinks schedule nothing and share one buffered stream.  A sink gets
+ * the next column when it starts, and keeps it, frozen at its last value,
+ * once it stops.
+ *
+ * The file starts with the magic "ROMAMTHR", the format, the time of the
+ * first sample and the interval, then holds records, each a RecordHeader: a
+ * SINK_RECORD announces the Column of a sink before the first row that has
+ * it, and a ROW_RECORD is followed by the total bytes received by each
+ * column, as 64-bit counts, all in the byte order of the host that wrote it.
+ * Decode () prints the file as CSV.
+ *
+ * The sampler is off while RomamThroughputInterval is zero.  Once on, its
+ * event runs while a sink is started, and the file is closed when the
+ * simulator is destroyed.
+ */
+class ThroughputSampler
+{
+  public:
+    /// the kinds of records of the file
+    enum RecordType
+    {
+        SINK_RECORD = 1, //!< a Column follows, n is its index
+        ROW_RECORD = 2,  //!< n counts follow, one per column
+    };
+
+    /// the beginning of a record
+    struct RecordHeader
+    {
+        uint32_t type; //!< the RecordType
+        uint32_t n;    //!< the column of a SINK_RECORD, the counts of a ROW_RECORD
+        int64_t time;  //!< time of the record, in ns
+    };
+
+    /// the description of the sink of a column
+    struct Column
+    {
+        uint32_t nodeId;  //!< node of the sink
+        uint32_t address; //!< IPv4 address the sink is bound to, 0 for any
+        uint16_t port;    //!< port the sink is bound to
+        uint8_t protocol; //!< IP protocol number of the sink, 17 for UDP and 6 for TCP
+        uint8_t reserved; //!< 0
+    };
+
+    /**
+     * \return true if the sinks are to be sampled
+     */
+    static bool IsEnabled();
+
+    /**
+     * \brief Start sampling a sink, if the sampler is enabled.
+     * \param sink the sink, started
+     */
+    static void Add(Ptr<RomamSink> sink);
+
+    /**
+     * \brief Stop sampling a sink, keeping its column.
+     * \param sink the sink
+     */
+    static void Remove(const RomamSink* sink);
+
+    /**
+     * \brief Print a file of samples as CSV: a header line, then a line per
+     * column and row.
+     * \param is the file
+     * \param os the output stream
+     * \return false if the file is not a file of samples or is truncated
+     */
+    static bool Decode(std::istream& is, std::ostream& os);
+
+  private:
+    ThroughputSampler();
+
+    ThroughputSampler(const ThroughputSampler&) = delete;
+    ThroughputSampler& operator=(const ThroughputSampler&) = delete;
+
+    /**
+     * \brief Schedule the next sample, on the grid of the samples from
+     * m_start, when the first sink is added or one is added again.
+     */
+    void Start();
+
+    /**
+     * \brief Append a row of the sinks to the file, and schedule the next
+     * sample while a sink is left.
+     */
+    void Sample();
+
+    /**
+     * \brief Close the file, and delete the sampler.
+     */
+    static void Destroy();
+
+    static ThroughputSampler* s_sampler; //!< the sampler of the simulation, if one
+
+    Time m_start;                          //!< time of the first sample
+    Time m_interval;                       //!< time from one sample to the next
+    std::string m_path;                    //!< the file of the samples
+    std::ofstream m_out;                   //!< the file
+    std::vector<const RomamSink*> m_sinks; //!< the sink of each column, null once stopped
+    std::vector<uint64_t> m_counts;        //!< the last count of each column
+    uint32_t m_nLive;                      //!< columns whose sink is not stopped
+    EventId m_event;                       //!< the next Sample ()
+};
+
+} // namespace ns3
+
+#endif /* THROUGHPUT_SAMPLER_H */
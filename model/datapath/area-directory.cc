@@ -0,0 +1,452 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "area-directory.h"
+
+#include "../utility/romam-router.h"
+#include "../utility/router-directory.h"
+#include "lsa.h"
+#include "lsdb-graph.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <utility>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AreaDirectory");
+
+/// distance of the vertices a border router does not reach
+static const uint32_t UNREACHABLE = std::numeric_limits<uint32_t>::max();
+
+/**
+ * \brief Compute the distances from a border router over the vertices its
+ * tree spans: the ones of its area and of the backbone.
+ * \param graph the graph of the LSDB
+ * \param source the vertex of the border router
+ * \param areas the area of every vertex
+ * \param backbone whether every vertex is in the backbone
+ * \param distances filled with the distance of every vertex, or UNREACHABLE
+ */
+static void
+ComputeDistances(const LSDBGraph& graph,
+                 uint32_t source,
+                 const std::vector<uint32_t>& areas,
+                 const std::vector<uint8_t>& backbone,
+                 std::vector<uint32_t>& distances)
+{
+    // the distance and the vertex of the candidates, the closest first
+    typedef std::pair<uint32_t, uint32_t> Candidate;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    distances.assign(graph.GetNVertices(), UNREACHABLE);
+    distances[source] = 0;
+    candidates.emplace(0, source);
+    while (!candidates.empty())
+    {
+        Candidate v = candidates.top();
+        candidates.pop();
+        if (v.first > distances[v.second])
+        {
+            continue;
+        }
+        for (uint32_t e = graph.GetEdgesBegin(v.second); e < graph.GetEdgesEnd(v.second); e++)
+        {
+            uint32_t w = graph.GetTarget(e);
+            uint32_t distance = v.first + graph.GetMetric(e);
+            if ((areas[w] == areas[source] || backbone[w]) && distance < distances[w])
+            {
+                distances[w] = distance;
+                candidates.emplace(distance, w);
+            }
+        }
+    }
+}
+
+/**
+ * \param a a summary
+ * \param b another summary
+ * \return true if the prefix of a comes first
+ */
+static bool
+ComparePrefixes(const AreaDirectory::Summary& a, const AreaDirectory::Summary& b)
+{
+    return a.network.Get() != b.network.Get() ? a.network.Get() < b.network.Get()
+                                              : a.mask.Get() < b.mask.Get();
+}
+
+bool
+AreaDirectory::Summary::operator==(const Summary& other) const
+{
+    return network == other.network && mask == other.mask && cost == other.cost;
+}
+
+AreaDirectory::AreaDirectory()
+    : m_enabled(false),
+      m_version(0)
+{
+}
+
+void
+AreaDirectory::AddRange(uint32_t area, Ipv4Address network, Ipv4Mask mask)
+{
+    NS_LOG_FUNCTION(this << area << network << mask);
+    m_ranges.push_back(Range{area, network.CombineMask(mask), mask});
+}
+
+void
+AreaDirectory::Clear()
+{
+    m_enabled = false;
+    m_members.clear();
+    m_prefixes.clear();
+    m_index.clear();
+    m_borders.clear();
+}
+
+bool
+AreaDirectory::IsEnabled() const
+{
+    return m_enabled;
+}
+
+uint64_t
+AreaDirectory::GetVersion() const
+{
+    return m_version;
+}
+
+uint32_t
+AreaDirectory::AddPrefix(Ipv4Address network, Ipv4Mask mask)
+{
+    uint64_t key = (static_cast<uint64_t>(network.Get()) << 32) | mask.Get();
+    auto i = m_index.emplace(key, m_prefixes.size());
+    if (i.second)
+    {
+        m_prefixes.push_back(Prefix{network, mask, {}, false});
+    }
+    return i.first->second;
+}
+
+bool
+AreaDirectory::Build(const LSDB* lsdb, const RouterDirectory* directory)
+{
+    NS_LOG_FUNCTION(this << lsdb);
+    std::unordered_map<uint32_t, Member> previousMembers;
+    std::unordered_map<uint32_t, Border> previousBorders;
+    previousMembers.swap(m_members);
+    previousBorders.swap(m_borders);
+    Clear();
+    m_version++;
+
+    LSDBGraph graph;
+    graph.Build(lsdb);
+    uint32_t n = graph.GetNVertices();
+    std::vector<uint32_t> areas(n, BACKBONE);
+    for (uint32_t v = 0; v < n; v++)
+    {
+        LSA* lsa = graph.GetLSA(v);
+        if (lsa->GetLSType() == LSA::RouterLSA)
+        {
+            Ptr<Node> node = directory->GetNodeByRouterId(lsa->GetLinkStateId());
+            Ptr<RomamRouter> router = node ? node->GetObject<RomamRouter>() : nullptr;
+            areas[v] = router ? router->GetAreaId() : BACKBONE;
+            m_enabled = m_enabled || areas[v] != BACKBONE;
+        }
+    }
+    if (!m_enabled)
+    {
+        return !previousBorders.empty();
+    }
+    // a network is in the area of its designated router
+    std::vector<uint32_t> designated(n, LSDBGraph::NO_VERTEX);
+    for (uint32_t v = 0; v < n; v++)
+    {
+        LSA* lsa = graph.GetLSA(v);
+        if (lsa->GetLSType() == LSA::NetworkLSA)
+        {
+            designated[v] = graph.GetVertex(lsa->GetAdvertisingRouter());
+            areas[v] = designated[v] != LSDBGraph::NO_VERTEX ? areas[designated[v]] : BACKBONE;
+        }
+    }
+
+    //
+    // The area border routers have a neighbor in the backbone, on a
+    // point-to-point link or on a network.
+    //
+    auto isBorder = [&graph, &areas](uint32_t v) {
+        for (uint32_t e = graph.GetEdgesBegin(v); e < graph.GetEdgesEnd(v); e++)
+        {
+            uint32_t w = graph.GetTarget(e);
+            if (areas[w] == BACKBONE)
+            {
+                return true;
+            }
+            if (graph.GetLSA(w)->GetLSType() != LSA::NetworkLSA)
+            {
+                continue;
+            }
+            for (uint32_t f = graph.GetEdgesBegin(w); f < graph.GetEdgesEnd(w); f++)
+            {
+                if (areas[graph.GetTarget(f)] == BACKBONE)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    std::vector<uint32_t> borders;
+    std::vector<uint8_t> backbone(n, 0);
+    for (uint32_t v = 0; v < n; v++)
+    {
+        if (graph.GetLSA(v)->GetLSType() == LSA::RouterLSA)
+        {
+            if (areas[v] != BACKBONE && isBorder(v))
+            {
+                borders.push_back(v);
+                backbone[v] = 1;
+            }
+            backbone[v] = backbone[v] || areas[v] == BACKBONE;
+        }
+    }
+    for (uint32_t v = 0; v < n; v++)
+    {
+        if (graph.GetLSA(v)->GetLSType() == LSA::NetworkLSA)
+        {
+            backbone[v] = areas[v] == BACKBONE ||
+                          (designated[v] != LSDBGraph::NO_VERTEX && backbone[designated[v]]);
+        }
+        m_members[graph.GetLSA(v)->GetLinkStateId().Get()] = Member{areas[v], backbone[v] != 0};
+    }
+
+    // the prefixes of every vertex, with the metric to them
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> attached(n);
+    for (uint32_t v = 0; v < n; v++)
+    {
+        LSA* lsa = graph.GetLSA(v);
+        if (lsa->GetLSType() == LSA::NetworkLSA)
+        {
+            Ipv4Mask mask = lsa->GetNetworkLSANetworkMask();
+            attached[v].emplace_back(AddPrefix(lsa->GetLinkStateId().CombineMask(mask), mask), 0);
+        }
+        for (uint32_t i = 0; i < lsa->GetNLinkRecords(); i++)
+        {
+            const LinkRecord* l = lsa->GetLinkRecord(i);
+            if (lsa->GetLSType() == LSA::RouterLSA && l->GetLinkType() == LinkRecord::StubNetwork)
+            {
+                Ipv4Mask mask(l->GetLinkData().Get());
+                uint32_t prefix = AddPrefix(l->GetLinkId().CombineMask(mask), mask);
+                attached[v].emplace_back(prefix, l->GetMetric());
+            }
+        }
+        for (const auto& a : attached[v])
+        {
+            Prefix& prefix = m_prefixes[a.first];
+            if (std::find(prefix.areas.begin(), prefix.areas.end(), areas[v]) == prefix.areas.end())
+            {
+                prefix.areas.push_back(areas[v]);
+            }
+            prefix.backbone = prefix.backbone || backbone[v];
+        }
+    }
+
+    //
+    // A border router advertises into the backbone the prefixes of its area
+    // the backbone does not reach, at the distance it reaches them at.
+    //
+    std::vector<std::map<uint32_t, uint32_t>> reached(borders.size());
+    std::vector<std::vector<uint32_t>> borderDistances(borders.size());
+    std::vector<uint32_t> distances;
+    for (std::size_t b = 0; b < borders.size(); b++)
+    {
+        ComputeDistances(graph, borders[b], areas, backbone, distances);
+        for (uint32_t v = 0; v < n; v++)
+        {
+            if (distances[v] == UNREACHABLE)
+            {
+                continue;
+            }
+            for (const auto& a : attached[v])
+            {
+                auto i = reached[b].emplace(a.first, distances[v] + a.second).first;
+                i->second = std::min(i->second, distances[v] + a.second);
+            }
+        }
+        for (uint32_t c : borders)
+        {
+            borderDistances[b].push_back(distances[c]);
+        }
+        Border& border = m_borders[graph.GetLSA(borders[b])->GetLinkStateId().Get()];
+        border.area = areas[borders[b]];
+        for (const auto& i : reached[b])
+        {
+            if (IsVisible(i.first, border.area, false) && !IsVisible(i.first, BACKBONE, true))
+            {
+                const Prefix& prefix = m_prefixes[i.first];
+                border.intoBackbone.push_back(
+                    Summary{prefix.network, prefix.mask, i.second, i.first});
+            }
+        }
+        Aggregate(border.area, border.intoBackbone);
+        std::sort(border.intoBackbone.begin(), border.intoBackbone.end(), &ComparePrefixes);
+    }
+
+    //
+    // It advertises into its area the prefixes out of it: the ones of the
+    // backbone it reaches, and the ones the border routers of the other areas
+    // advertise into the backbone, through them.
+    //
+    for (std::size_t b = 0; b < borders.size(); b++)
+    {
+        Border& border = m_borders.at(graph.GetLSA(borders[b])->GetLinkStateId().Get());
+        std::map<uint32_t, uint32_t> costs;
+        for (const auto& i : reached[b])
+        {
+            if (!IsVisible(i.first, border.area, false))
+            {
+                costs[i.first] = i.second;
+            }
+        }
+        for (std::size_t c = 0; c < borders.size(); c++)
+        {
+            const Border& other = m_borders.at(graph.GetLSA(borders[c])->GetLinkStateId().Get());
+            if (other.area == border.area || borderDistances[b][c] == UNREACHABLE)
+            {
+                continue;
+            }
+            for (const Summary& summary : other.intoBackbone)
+            {
+                if (!IsVisible(summary.prefix, border.area, false))
+                {
+                    uint32_t cost = borderDistances[b][c] + summary.cost;
+                    auto i = costs.emplace(summary.prefix, cost).first;
+                    i->second = std::min(i->second, cost);
+                }
+            }
+        }
+        for (const auto& i : costs)
+        {
+            const Prefix& prefix = m_prefixes[i.first];
+            border.intoArea.push_back(Summary{prefix.network, prefix.mask, i.second, i.first});
+        }
+        std::sort(border.intoArea.begin(), border.intoArea.end(), &ComparePrefixes);
+    }
+    NS_LOG_LOGIC(borders.size() << " area border routers, " << m_prefixes.size() << " prefixes");
+
+    bool changed = previousMembers.size() != m_members.size() ||
+                   previousBorders.size() != m_borders.size();
+    for (auto i = m_members.begin(); !changed && i != m_members.end(); i++)
+    {
+        auto j = previousMembers.find(i->first);
+        changed = j == previousMembers.end() || j->second.area != i->second.area ||
+                  j->second.backbone != i->second.backbone;
+    }
+    for (auto i = m_borders.begin(); !changed && i != m_borders.end(); i++)
+    {
+        auto j = previousBorders.find(i->first);
+        changed = j == previousBorders.end() || j->second.area != i->second.area ||
+                  j->second.intoBackbone != i->second.intoBackbone ||
+                  j->second.intoArea != i->second.intoArea;
+    }
+    return changed;
+}
+
+void
+AreaDirectory::Aggregate(uint32_t area, std::vector<Summary>& summaries)
+{
+    for (const Range& range : m_ranges)
+    {
+        if (range.area != area)
+        {
+            continue;
+        }
+        uint32_t length = range.mask.GetPrefixLength();
+        std::vector<Summary> kept;
+        Summary aggregate{range.network, range.mask, 0, 0};
+        bool found = false;
+        for (const Summary& summary : summaries)
+        {
+            if (summary.mask.GetPrefixLength() < length ||
+                summary.network.CombineMask(range.mask) != range.network)
+            {
+                kept.push_back(summary);
+                continue;
+            }
+            if (!found)
+            {
+                aggregate.prefix = AddPrefix(range.network, range.mask);
+                found = true;
+            }
+            // the range is reached wherever one of its prefixes is
+            std::vector<uint32_t> owners = m_prefixes[summary.prefix].areas;
+            Prefix& prefix = m_prefixes[aggregate.prefix];
+            for (uint32_t owner : owners)
+            {
+                if (std::find(prefix.areas.begin(), prefix.areas.end(), owner) ==
+                    prefix.areas.end())
+                {
+                    prefix.areas.push_back(owner);
+                }
+            }
+            prefix.backbone = prefix.backbone || m_prefixes[summary.prefix].backbone;
+            aggregate.cost = std::max(aggregate.cost, summary.cost);
+        }
+        if (found)
+        {
+            kept.push_back(aggregate);
+            summaries.swap(kept);
+        }
+    }
+}
+
+void
+AreaDirectory::Classify(const LSDBGraph& graph,
+                        std::vector<uint32_t>& areas,
+                        std::vector<uint8_t>& backbone) const
+{
+    NS_LOG_FUNCTION(this);
+    areas.assign(graph.GetNVertices(), BACKBONE);
+    backbone.assign(graph.GetNVertices(), 1);
+    for (uint32_t v = 0; v < graph.GetNVertices(); v++)
+    {
+        auto i = m_members.find(graph.GetLSA(v)->GetLinkStateId().Get());
+        if (i != m_members.end())
+        {
+            areas[v] = i->second.area;
+            backbone[v] = i->second.backbone ? 1 : 0;
+        }
+    }
+}
+
+const std::vector<AreaDirectory::Summary>*
+AreaDirectory::GetSummaries(Ipv4Address border, uint32_t area) const
+{
+    auto i = m_borders.find(border.Get());
+    if (i == m_borders.end())
+    {
+        return nullptr;
+    }
+    if (area == BACKBONE)
+    {
+        return &i->second.intoBackbone;
+    }
+    return area == i->second.area ? &i->second.intoArea : nullptr;
+}
+
+bool
+AreaDirectory::IsVisible(uint32_t prefix, uint32_t area, bool backbone) const
+{
+    NS_ASSERT(prefix < m_prefixes.size());
+    const Prefix& p = m_prefixes[prefix];
+    return (backbone && p.backbone) ||
+           std::find(p.areas.begin(), p.areas.end(), area) != p.areas.end();
+}
+
+} // namespace ns3
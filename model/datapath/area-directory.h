@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef AREA_DIRECTORY_H
+#define AREA_DIRECTORY_H
+
+#include "ns3/ipv4-address.h"
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class LSDB;
+class LSDBGraph;
+class RouterDirectory;
+
+/**
+ * \brief The areas of the routers of an LSDB, and the prefixes their border
+ * routers advertise to the other areas, for a hierarchical routing.
+ *
+ * A router is in the area of the AreaId attribute of its RomamRouter, area 0
+ * being the backbone, and a network LSA in the area of its designated
+ * router.  A router outside the backbone with a neighbor in it is an area
+ * border router, which belongs to the backbone as well.  With more than one
+ * area, the route computations only span the area of a router, plus the
+ * backbone for a border router, so that the SPF runs and the routes to the
+ * addresses of the routers scale with the size of the areas instead of the
+ * size of the network.
+ *
+ * The other areas are reached through summaries, as the OSPF summary LSAs
+ * do.  A border router advertises into the backbone the prefixes of its
+ * area, and into its area the prefixes outside it, each at the distance the
+ * border router reaches it at.  The prefixes are the stub records of the
+ * router LSAs and the networks of the network LSAs.  The ranges of an area
+ * replace the prefixes they cover by themselves, at the highest of their
+ * costs, in the summaries advertised into the backbone.  A router routes a
+ * prefix out of its areas towards the border routers its tree reaches at the
+ * lowest total cost, a border router towards the ones of the backbone only.
+ *
+ * The areas are only joined through the backbone: there are no virtual
+ * links, and the links between two areas out of the backbone are not used.
+ * The AS-external routes are only installed through the ASBRs the tree of a
+ * router reaches, in its areas.
+ */
+class AreaDirectory
+{
+  public:
+    /// the area ID of the backbone
+    static constexpr uint32_t BACKBONE = 0;
+
+    /// a prefix a border router advertises into an area
+    struct Summary
+    {
+        Ipv4Address network; //!< the network of the prefix
+        Ipv4Mask mask;       //!< its mask
+        uint32_t cost;       //!< the distance from the border router to it
+        uint32_t prefix;     //!< the index of the prefix, for IsVisible ()
+
+        /**
+         * \param other another summary
+         * \return true if both advertise the same prefix at the same cost
+         */
+        bool operator==(const Summary& other) const;
+    };
+
+    AreaDirectory();
+
+    /**
+     * \brief Summarize the prefixes of an area a range covers by the range,
+     * from the next Build () on.
+     * \param area the area ID
+     * \param network the network of the range
+     * \param mask its mask
+     */
+    void AddRange(uint32_t area, Ipv4Address network, Ipv4Mask mask);
+
+    /**
+     * \brief Find the areas and border routers of the LSDB and compute their
+     * summaries, replacing the current content.
+     * \param lsdb the database
+     * \param directory the routers of the database
+     * \return true if the areas or the summaries changed
+     */
+    bool Build(const LSDB* lsdb, const RouterDirectory* directory);
+
+    /**
+     * \brief Remove the areas and summaries, keeping the ranges.
+     */
+    void Clear();
+
+    /**
+     * \return true if some router is out of the backbone
+     */
+    bool IsEnabled() const;
+
+    /**
+     * \return a number the builds increment, to tell when to classify the
+     * vertices of a graph again
+     */
+    uint64_t GetVersion() const;
+
+    /**
+     * \brief Give the vertices of a graph of the LSDB their areas.
+     * \param graph the graph
+     * \param areas filled with the area of every vertex
+     * \param backbone filled with 1 for the vertices in the backbone, border
+     * routers included, and 0 for the others
+     */
+    void Classify(const LSDBGraph& graph,
+                  std::vector<uint32_t>& areas,
+                  std::vector<uint8_t>& backbone) const;
+
+    /**
+     * \param border the router ID of a border router
+     * \param area the area ID
+     * \return the summaries the router advertises into the area, or null if
+     * it is not a border router of the area
+     */
+    const std::vector<Summary>* GetSummaries(Ipv4Address border, uint32_t area) const;
+
+    /**
+     * \param prefix the index of a prefix
+     * \param area the area a tree spans
+     * \param backbone whether the tree spans the backbone as well
+     * \return true if the tree reaches the prefix, through a vertex it spans
+     */
+    bool IsVisible(uint32_t prefix, uint32_t area, bool backbone) const;
+
+  private:
+    /// the area of a router or network LSA
+    struct Member
+    {
+        uint32_t area; //!< the area ID
+        bool backbone; //!< in the backbone, as an area border router would be
+    };
+
+    /// a prefix of the LSDB, or a range
+    struct Prefix
+    {
+        Ipv4Address network;         //!< the network
+        Ipv4Mask mask;               //!< its mask
+        std::vector<uint32_t> areas; //!< the areas of the vertices it is attached to
+        bool backbone;               //!< attached to a vertex in the backbone
+    };
+
+    /// the summaries of a border router
+    struct Border
+    {
+        uint32_t area;                     //!< its own area
+        std::vector<Summary> intoBackbone; //!< the prefixes of its area
+        std::vector<Summary> intoArea;     //!< the prefixes out of its area
+    };
+
+    /// a range of an area
+    struct Range
+    {
+        uint32_t area;       //!< the area ID
+        Ipv4Address network; //!< the network of the range
+        Ipv4Mask mask;       //!< its mask
+    };
+
+    /**
+     * \param network a network
+     * \param mask its mask
+     * \return the index of the prefix, added if new
+     */
+    uint32_t AddPrefix(Ipv4Address network, Ipv4Mask mask);
+
+    /**
+     * \brief Replace the summaries of an area covered by its ranges by the
+     * ranges.
+     * \param area the area ID
+     * \param summaries the summaries advertised out of the area
+     */
+    void Aggregate(uint32_t area, std::vector<Summary>& summaries);
+
+    bool m_enabled;                                 //!< some router is out of the backbone
+    uint64_t m_version;                             //!< number of builds
+    std::unordered_map<uint32_t, Member> m_members; //!< area, by link state ID
+    std::vector<Prefix> m_prefixes;                 //!< the prefixes, by index
+    std::unordered_map<uint64_t, uint32_t> m_index; //!< index of a prefix, by network and mask
+    std::unordered_map<uint32_t, Border> m_borders; //!< summaries, by border router ID
+    std::vector<Range> m_ranges;                    //!< the ranges of the areas
+};
+
+} // namespace ns3
+
+#endif /* AREA_DIRECTORY_H */
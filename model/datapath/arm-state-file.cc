@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "arm-state-file.h"
+
+#include "ns3/log.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ArmStateFile");
+
+/// "ROMAMARM", which also tells the byte order of the file
+static const uint64_t ARM_FILE_MAGIC = 0x4d52414d414d4f52ULL;
+/// layout of the file, to be changed along with the structures below
+static const uint32_t ARM_FILE_FORMAT = 1;
+
+/// beginning of the file
+struct ArmFileHeader
+{
+    uint64_t magic;        //!< ARM_FILE_MAGIC
+    uint32_t format;       //!< ARM_FILE_FORMAT
+    uint32_t nRouteArms;   //!< number of arms of the host routes
+    uint64_t topologyHash; //!< hash of the topology the arms were learned on
+    uint32_t nValueArms;   //!< number of arms of the ArmValueDB
+    uint32_t reserved;     //!< 0
+};
+
+static_assert(sizeof(ArmFileHeader) == 32, "ArmFileHeader must have no padding");
+static_assert(sizeof(ArmState) == 24, "ArmState must have no padding");
+
+bool
+ArmStateFile::Save(const std::vector<ArmState>& routeArms,
+                   const std::vector<ArmState>& valueArms,
+                   uint64_t topologyHash,
+                   const std::string& path)
+{
+    NS_LOG_FUNCTION(routeArms.size() << valueArms.size() << topologyHash << path);
+    ArmFileHeader header;
+    header.magic = ARM_FILE_MAGIC;
+    header.format = ARM_FILE_FORMAT;
+    header.nRouteArms = routeArms.size();
+    header.topologyHash = topologyHash;
+    header.nValueArms = valueArms.size();
+    header.reserved = 0;
+
+    // the runs of a sweep may share the file: write a private one and rename it
+    std::ostringstream tmp;
+    tmp << path << ".tmp." << getpid();
+    {
+        std::ofstream out(tmp.str(), std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(routeArms.data()),
+                  routeArms.size() * sizeof(ArmState));
+        out.write(reinterpret_cast<const char*>(valueArms.data()),
+                  valueArms.size() * sizeof(ArmState));
+        if (!out)
+        {
+            NS_LOG_WARN("Cannot write the arm state file " << tmp.str());
+            std::remove(tmp.str().c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp.str().c_str(), path.c_str()) != 0)
+    {
+        NS_LOG_WARN("Cannot replace the arm state file " << path);
+        std::remove(tmp.str().c_str());
+        return false;
+    }
+    NS_LOG_LOGIC("Saved " << routeArms.size() << " + " << valueArms.size() << " arms to "
+                          << path);
+    return true;
+}
+
+bool
+ArmStateFile::Load(const std::string& path,
+                   uint64_t topologyHash,
+                   std::vector<ArmState>& routeArms,
+                   std::vector<ArmState>& valueArms)
+{
+    NS_LOG_FUNCTION(path << topologyHash);
+    routeArms.clear();
+    valueArms.clear();
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+    {
+        NS_LOG_LOGIC("No arm state file " << path);
+        return false;
+    }
+    std::size_t size = in.tellg();
+    in.seekg(0);
+    ArmFileHeader header;
+    if (size < sizeof(header) || !in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        return false;
+    }
+    std::size_t expected =
+        sizeof(header) +
+        (static_cast<std::size_t>(header.nRouteArms) + header.nValueArms) * sizeof(ArmState);
+    if (header.magic != ARM_FILE_MAGIC || header.format != ARM_FILE_FORMAT ||
+        size != expected || header.topologyHash != topologyHash)
+    {
+        NS_LOG_LOGIC("The arm state file " << path << " does not match the topology");
+        return false;
+    }
+    routeArms.resize(header.nRouteArms);
+    valueArms.resize(header.nValueArms);
+    in.read(reinterpret_cast<char*>(routeArms.data()), routeArms.size() * sizeof(ArmState));
+    in.read(reinterpret_cast<char*>(valueArms.data()), valueArms.size() * sizeof(ArmState));
+    if (!in)
+    {
+        NS_LOG_WARN("Cannot read the arm state file " << path);
+        routeArms.clear();
+        valueArms.clear();
+        return false;
+    }
+    NS_LOG_LOGIC("Loaded " << routeArms.size() << " + " << valueArms.size() << " arms from "
+                           << path);
+    return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ARM_STATE_FILE_H
+#define ARM_STATE_FILE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief The statistics of an Octopus arm, as an ArmStateFile keeps them.
+ */
+struct ArmState
+{
+    uint32_t nodeId;       //!< the node of the arm
+    uint32_t dest;         //!< destination of a host route, neighbor interface of an ArmValueDB arm
+    uint32_t iface;        //!< output interface of the arm
+    uint32_t nPulls;       //!< number of pulls
+    double cumulativeLoss; //!< cumulative loss
+};
+
+/**
+ * \brief Binary file of the arms of the Octopus routers, to start the runs
+ * of a sweep over one topology from what an earlier run learned instead of
+ * from unexplored arms.
+ *
+ * The file holds a header, then the flat arrays of the arms of the host
+ * routes (ArmedSpfRIE) and of the ArmValueDB entries, in host byte order.
+ * As for an LSDBFile, the header carries the hash of the topology the arms
+ * were learned on; a file whose hash, format or byte order does not match is
+ * ignored, and the arms start from scratch.
+ */
+class ArmStateFile
+{
+  public:
+    /**
+     * \brief Write arm states to a file, replacing it atomically.
+     * \param routeArms the arms of the host routes
+     * \param valueArms the arms of the ArmValueDB
+     * \param topologyHash the hash of the topology they were learned on
+     * \param path the file
+     * \return true if the file was written
+     */
+    static bool Save(const std::vector<ArmState>& routeArms,
+                     const std::vector<ArmState>& valueArms,
+                     uint64_t topologyHash,
+                     const std::string& path);
+
+    /**
+     * \brief Read arm states from a file.
+     * \param path the file
+     * \param topologyHash the hash of the current topology
+     * \param routeArms replaced with the arms of the host routes
+     * \param valueArms replaced with the arms of the ArmValueDB
+     * \return false if the file is missing, malformed or learned on another
+     * topology
+     */
+    static bool Load(const std::string& path,
+                     uint64_t topologyHash,
+                     std::vector<ArmState>& routeArms,
+                     std::vector<ArmState>& valueArms);
+};
+
+} // namespace ns3
+
+#endif /* ARM_STATE_FILE_H */
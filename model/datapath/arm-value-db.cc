@@ -13,6 +13,12 @@ ArmValue::ArmValue()
 {
 }
 
+ArmValue::ArmValue(double cumulative, uint32_t nPulls)
+    : m_cumulative(cumulative),
+      m_num_pulls(nPulls)
+{
+}
+
 ArmValue::~ArmValue()
 {
 }
@@ -48,60 +54,108 @@ ArmValue::Print(std::ostream& os) const
 //-- NeighborArms
 //------------------------------------------------------
 NeighborArms::NeighborArms()
-    : m_arms()
+    : m_nPresent(0)
 {
 }
 
 NeighborArms::~NeighborArms()
 {
-    for (auto it = m_arms.begin(); it != m_arms.end(); it++)
-    {
-        // NS_LOG_LOGIC("Free database entries");
-        ArmValue* temp = it->second;
-        delete temp;
-    }
-    m_arms.clear();
 }
 
-ArmValue*
+ArmValue
 NeighborArms::GetArmValue(uint32_t nIface) const
 {
-    NAMap_t::const_iterator ci = m_arms.find(nIface);
-    if (ci != m_arms.end())
+    if (nIface < m_cumulative.size())
     {
-        return ci->second;
+        return ArmValue(m_cumulative[nIface], m_nPulls[nIface]);
     }
-    return nullptr;
+    return ArmValue();
 }
 
 uint32_t
 NeighborArms::GetNumArmValuePairs() const
 {
-    return m_arms.size();
+    return m_nPresent;
 }
 
 void
 NeighborArms::UpdateArm(uint32_t nIface, double reward)
 {
-    auto it = m_arms.find(nIface);
-    if (it == m_arms.end())
+    if (nIface >= m_cumulative.size())
     {
-        ArmValue* vu = new ArmValue();
-        m_arms.insert(NAPair_t(nIface, vu));
-        vu->UpdateArm(reward);
+        m_cumulative.resize(nIface + 1, 0.0);
+        m_nPulls.resize(nIface + 1, 0);
+        m_present.resize(nIface + 1, 0);
     }
-    it->second->UpdateArm(reward);
+    if (!m_present[nIface])
+    {
+        m_present[nIface] = 1;
+        m_nPresent++;
+    }
+    m_nPulls[nIface] += 1;
+    m_cumulative[nIface] += reward;
+}
+
+void
+NeighborArms::SetArmValue(uint32_t nIface, const ArmValue& value)
+{
+    if (nIface >= m_cumulative.size())
+    {
+        m_cumulative.resize(nIface + 1, 0.0);
+        m_nPulls.resize(nIface + 1, 0);
+        m_present.resize(nIface + 1, 0);
+    }
+    if (!m_present[nIface])
+    {
+        m_present[nIface] = 1;
+        m_nPresent++;
+    }
+    m_nPulls[nIface] = value.GetNumPulls();
+    m_cumulative[nIface] = value.GetCumulativeLoss();
+}
+
+bool
+NeighborArms::HasArm(uint32_t nIface) const
+{
+    return nIface < m_present.size() && m_present[nIface];
+}
+
+uint32_t
+NeighborArms::GetNArms() const
+{
+    return m_cumulative.size();
+}
+
+const double*
+NeighborArms::GetCumulativeLosses() const
+{
+    return m_cumulative.data();
+}
+
+const uint32_t*
+NeighborArms::GetNumPulls() const
+{
+    return m_nPulls.data();
+}
+
+std::size_t
+NeighborArms::GetMemoryFootprint() const
+{
+    return m_cumulative.capacity() * sizeof(double) + m_nPulls.capacity() * sizeof(uint32_t) +
+           m_present.capacity() * sizeof(uint8_t);
 }
 
 void
 NeighborArms::Print(std::ostream& os) const
 {
     os << "Next_Iface    ArmValue" << std::endl;
-    NAMap_t::const_iterator ci;
-    for (ci = m_arms.begin(); ci != m_arms.end(); ci++)
+    for (uint32_t n = 0; n < m_cumulative.size(); n++)
     {
-        os << ci->first << "    ";
-        ci->second->Print(os);
+        if (m_present[n])
+        {
+            os << n << "    ";
+            GetArmValue(n).Print(os);
+        }
     }
 }
 
@@ -118,68 +172,77 @@ ArmValueDB::ArmValueDB()
 
 ArmValueDB::~ArmValueDB()
 {
-    // NS_LOG_LOGIC ("Clear map");
-    for (auto it = m_database.begin(); it != m_database.end(); it++)
-    {
-        // NS_LOG_LOGIC("Free database entries");
-        NeighborArms* temp = it->second;
-        delete temp;
-    }
-
-    m_database.clear();
 }
 
-NeighborArms*
+const NeighborArms*
 ArmValueDB::GetNeighborArms(uint32_t iface) const
 {
     // NS_LOG_FUNCTION (this << iface);
-    ArmValueDBMap_t::const_iterator ci = m_database.find(iface);
-    if (ci != m_database.end())
+    if (iface < m_database.size() && m_database[iface].GetNumArmValuePairs() > 0)
     {
-        return ci->second;
+        return &m_database[iface];
     }
     return nullptr;
 }
 
-ArmValue*
+ArmValue
 ArmValueDB::GetArmValue(uint32_t iface, uint32_t nIface) const
 {
     // NS_LOG_FUNCTION (this << iface);
-    //
-    // Look up a NSE by it's interface.
-    //
-    ArmValueDBMap_t::const_iterator ci = m_database.find(iface);
-    if (ci != m_database.end())
+    if (iface < m_database.size())
     {
-        return ci->second->GetArmValue(nIface);
+        return m_database[iface].GetArmValue(nIface);
     }
-    return nullptr;
+    return ArmValue();
 }
 
 void
 ArmValueDB::UpdateArm(uint32_t iface, uint32_t nIface, double reward)
 {
-    auto it = m_database.find(iface);
-    if (it != m_database.end())
+    if (iface >= m_database.size())
+    {
+        m_database.resize(iface + 1);
+    }
+    m_database[iface].UpdateArm(nIface, reward);
+}
+
+void
+ArmValueDB::SetArmValue(uint32_t iface, uint32_t nIface, const ArmValue& value)
+{
+    if (iface >= m_database.size())
     {
-        it->second->UpdateArm(nIface, reward);
+        m_database.resize(iface + 1);
     }
-    else
+    m_database[iface].SetArmValue(nIface, value);
+}
+
+uint32_t
+ArmValueDB::GetNInterfaces() const
+{
+    return m_database.size();
+}
+
+std::size_t
+ArmValueDB::GetMemoryFootprint() const
+{
+    std::size_t bytes = m_database.capacity() * sizeof(NeighborArms);
+    for (const NeighborArms& arms : m_database)
     {
-        NeighborArms* neighbor = new NeighborArms();
-        m_database.insert(ArmValueDBPair_t(iface, neighbor));
-        neighbor->UpdateArm(nIface, reward);
+        bytes += arms.GetMemoryFootprint();
     }
+    return bytes;
 }
 
 void
 ArmValueDB::Print(std::ostream& os) const
 {
-    ArmValueDBMap_t::const_iterator ci;
-    for (ci = m_database.begin(); ci != m_database.end(); ci++)
+    for (uint32_t iface = 0; iface < m_database.size(); iface++)
     {
-        os << "Interface = " << ci->first << std::endl;
-        ci->second->Print(os);
+        if (m_database[iface].GetNumArmValuePairs() > 0)
+        {
+            os << "Interface = " << iface << std::endl;
+            m_database[iface].Print(os);
+        }
     }
 }
 
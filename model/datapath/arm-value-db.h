@@ -2,21 +2,29 @@
 #ifndef ARM_VALUE_DB_H
 #define ARM_VALUE_DB_H
 
-#define STATESIZE 10
 #include "database.h"
 
 #include "ns3/core-module.h"
 
-#include <map>
-#include <utility>
+#include <vector>
 
 namespace ns3
 {
 
+/**
+ * \brief The cumulative loss and number of pulls of an arm, by value.
+ */
 class ArmValue
 {
   public:
     ArmValue();
+
+    /**
+     * \param cumulative the cumulative loss
+     * \param nPulls the number of pulls
+     */
+    ArmValue(double cumulative, uint32_t nPulls);
+
     ~ArmValue();
     double GetCumulativeLoss() const;
     uint32_t GetNumPulls() const;
@@ -28,27 +36,71 @@ class ArmValue
     uint32_t m_num_pulls; //!< number of pulls
 };
 
+/**
+ * \brief The arms of an interface, indexed by the neighbor interface.
+ *
+ * The cumulative losses and the numbers of pulls are kept in two dense
+ * arrays, so that a loop over the arms of an interface reads contiguous
+ * memory and can be vectorized.  An arm that was never updated has a null
+ * loss and no pull.
+ */
 class NeighborArms
 {
   public:
     NeighborArms();
     ~NeighborArms();
 
-    ArmValue* GetArmValue(uint32_t nIface) const;
+    ArmValue GetArmValue(uint32_t nIface) const;
     uint32_t GetNumArmValuePairs() const;
     void UpdateArm(uint32_t nIface, double reward);
     void Print(std::ostream& os) const;
 
+    /**
+     * \brief Set the value of an arm, e.g., to that of an earlier run.
+     * \param nIface the neighbor interface
+     * \param value the cumulative loss and number of pulls
+     */
+    void SetArmValue(uint32_t nIface, const ArmValue& value);
+
+    /**
+     * \param nIface the neighbor interface
+     * \return true if the arm was updated at least once
+     */
+    bool HasArm(uint32_t nIface) const;
+
+    /**
+     * \return the size of the arrays, one more than the highest neighbor
+     * interface updated
+     */
+    uint32_t GetNArms() const;
+
+    /**
+     * \return the GetNArms () cumulative losses, by neighbor interface
+     */
+    const double* GetCumulativeLosses() const;
+
+    /**
+     * \return the GetNArms () numbers of pulls, by neighbor interface
+     */
+    const uint32_t* GetNumPulls() const;
+
+    /**
+     * \return the number of bytes of the arrays
+     */
+    std::size_t GetMemoryFootprint() const;
+
   private:
-    typedef std::map<uint32_t, ArmValue*> NAMap_t;   //!< status, statistic*/
-    typedef std::pair<uint32_t, ArmValue*> NAPair_t; //!< pair of <interface, StatusUnit>
-    NAMap_t m_arms;
+    std::vector<double> m_cumulative; //!< cumulative loss, by neighbor interface
+    std::vector<uint32_t> m_nPulls;   //!< number of pulls, by neighbor interface
+    std::vector<uint8_t> m_present;   //!< whether the arm was updated, by neighbor interface
+    uint32_t m_nPresent;              //!< number of arms updated
 };
 
 /**
  * \brief The DGR neighbor status database
  *
- * Each node in DGR maintains a neighbor status data base.
+ * Each node in DGR maintains a neighbor status data base.  The arms of the
+ * interfaces are kept in a dense array, indexed by interface.
  */
 class ArmValueDB : public Database
 {
@@ -63,8 +115,6 @@ class ArmValueDB : public Database
 
     /**
      * \brief Destroy an empty Neighbor Status Database.
-     *
-     * Before distroy the database, resources should be release by clear ()
      */
     ~ArmValueDB();
 
@@ -73,16 +123,40 @@ class ArmValueDB : public Database
     ArmValueDB& operator=(const ArmValueDB&) = delete;
 
     /**
-     * \brief Get the NeighborStatusEntry of a Interface
+     * \brief Get the arms of a Interface
      *
      * \param iface The interface number
-     * \return NeighborStatusEntry*
+     * \return the arms, or nullptr if none of them was updated.  The pointer
+     * is valid until an arm of a higher interface is first updated.
      */
-    NeighborArms* GetNeighborArms(uint32_t iface) const;
+    const NeighborArms* GetNeighborArms(uint32_t iface) const;
 
-    ArmValue* GetArmValue(uint32_t iface, uint32_t nIface) const;
+    /**
+     * \param iface the interface
+     * \param nIface the neighbor interface
+     * \return the value of the arm, null if it was never updated
+     */
+    ArmValue GetArmValue(uint32_t iface, uint32_t nIface) const;
     void UpdateArm(uint32_t iface, uint32_t nIface, double reward);
 
+    /**
+     * \brief Set the value of an arm, e.g., to that of an earlier run.
+     * \param iface the interface
+     * \param nIface the neighbor interface
+     * \param value the cumulative loss and number of pulls
+     */
+    void SetArmValue(uint32_t iface, uint32_t nIface, const ArmValue& value);
+
+    /**
+     * \return one more than the highest interface with an arm
+     */
+    uint32_t GetNInterfaces() const;
+
+    /**
+     * \return the number of bytes of the arms of all the interfaces
+     */
+    std::size_t GetMemoryFootprint() const;
+
     /**
      * \brief Print the database
      *
@@ -90,9 +164,7 @@ class ArmValueDB : public Database
     void Print(std::ostream& os) const override;
 
   private:
-    typedef std::map<uint32_t, NeighborArms*> ArmValueDBMap_t;
-    typedef std::pair<uint32_t, NeighborArms*> ArmValueDBPair_t;
-    ArmValueDBMap_t m_database; //!< database of <interface, NeighborArms>
+    std::vector<NeighborArms> m_database; //!< database of NeighborArms, by interface
 };
 
 } // namespace ns3
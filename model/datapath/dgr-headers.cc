@@ -2,8 +2,11 @@
 
 #include "dgr-headers.h"
 
+#include "ns3/assert.h"
 #include "ns3/log.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -93,8 +96,24 @@ operator<<(std::ostream& os, const DgrNse& h)
 //----------------------------------------------------------------------
 //-- DgrHeader
 //------------------------------------------------------
+/// version of the header with 32-bit NSEs
+static const uint8_t DGR_VERSION = 2;
+/// version of the compact header
+static const uint8_t DGR_COMPACT_VERSION = 3;
+/// flag of a compact header carrying only the states that changed
+static const uint8_t DGR_DELTA_FLAG = 0x1;
+/// flag of a header followed by the downstream delays of the sender
+static const uint8_t DGR_DOWNSTREAM_FLAG = 0x2;
+/// size of a downstream delay
+static const uint32_t DGR_DOWNSTREAM_SIZE = 4 + 4;
+
 DgrHeader::DgrHeader()
-    : m_command(1)
+    : m_command(1),
+      m_compact(false),
+      m_delta(false),
+      m_downstream(false),
+      m_nNses(0),
+      m_storage(nullptr)
 {
 }
 
@@ -118,19 +137,39 @@ void
 DgrHeader::Print(std::ostream& os) const
 {
     os << "command " << int(m_command);
-    for (std::list<DgrNse>::const_iterator iter = m_nseList.begin(); iter != m_nseList.end();
-         iter++)
+    if (m_compact)
+    {
+        os << (m_delta ? " compact delta" : " compact");
+    }
+    const DgrNse* nses = GetNses();
+    for (uint32_t n = 0; n < m_nNses; n++)
     {
         os << " | ";
-        iter->Print(os);
+        nses[n].Print(os);
+    }
+    for (const DgrDownstream& entry : m_downstreams)
+    {
+        os << " | Dest: " << entry.dest << ", Delay: " << entry.delay;
     }
 }
 
 uint32_t
 DgrHeader::GetSerializedSize() const
 {
+    if (m_compact)
+    {
+        // one byte per interface, then the states two per byte
+        return 4 + m_nNses + (m_nNses + 1) / 2 + GetDownstreamSize();
+    }
     DgrNse nse;
-    return 4 + m_nseList.size() * nse.GetSerializedSize();
+    // the NSEs are counted when the downstream delays follow them
+    return 4 + (m_downstream ? 2 : 0) + m_nNses * nse.GetSerializedSize() + GetDownstreamSize();
+}
+
+uint32_t
+DgrHeader::GetDownstreamSize() const
+{
+    return m_downstream ? 2 + m_downstreams.size() * DGR_DOWNSTREAM_SIZE : 0;
 }
 
 void
@@ -138,14 +177,59 @@ DgrHeader::Serialize(Buffer::Iterator start) const
 {
     Buffer::Iterator i = start;
     i.WriteU8(uint8_t(m_command)); // command : request and respond
-    i.WriteU8(2);                  // version 2
-    i.WriteU16(0);                 // blank
-
-    for (std::list<DgrNse>::const_iterator iter = m_nseList.begin(); iter != m_nseList.end();
-         iter++)
+    const DgrNse* nses = GetNses();
+    if (m_compact)
+    {
+        NS_ASSERT_MSG(m_nNses <= COMPACT_MAX_NSES, "Too many NSEs for a compact header");
+        i.WriteU8(DGR_COMPACT_VERSION);
+        i.WriteU8((m_delta ? DGR_DELTA_FLAG : 0) | (m_downstream ? DGR_DOWNSTREAM_FLAG : 0));
+        i.WriteU8(m_nNses);
+        for (uint32_t n = 0; n < m_nNses; n++)
+        {
+            NS_ASSERT_MSG(nses[n].GetInterface() <= COMPACT_MAX_INTERFACE,
+                          "Interface " << nses[n].GetInterface()
+                                       << " does not fit a compact header");
+            i.WriteU8(nses[n].GetInterface());
+        }
+        uint8_t pair = 0;
+        for (uint32_t n = 0; n < m_nNses; n++)
+        {
+            uint32_t state = std::min(nses[n].GetState(), COMPACT_MAX_STATE);
+            pair = n % 2 == 0 ? state << 4 : pair | state;
+            if (n % 2 == 1)
+            {
+                i.WriteU8(pair);
+            }
+        }
+        if (m_nNses % 2 == 1)
+        {
+            i.WriteU8(pair);
+        }
+    }
+    else
+    {
+        i.WriteU8(DGR_VERSION);                             // version 2
+        i.WriteU16(m_downstream ? DGR_DOWNSTREAM_FLAG : 0); // blank
+        if (m_downstream)
+        {
+            i.WriteU16(m_nNses);
+        }
+        for (uint32_t n = 0; n < m_nNses; n++)
+        {
+            nses[n].Serialize(i);
+            i.Next(nses[n].GetSerializedSize());
+        }
+    }
+    if (!m_downstream)
     {
-        iter->Serialize(i);
-        i.Next(iter->GetSerializedSize());
+        return;
+    }
+    NS_ASSERT_MSG(m_downstreams.size() <= MAX_DOWNSTREAMS, "Too many downstream delays");
+    i.WriteU16(m_downstreams.size());
+    for (const DgrDownstream& entry : m_downstreams)
+    {
+        i.WriteU32(entry.dest.Get());
+        i.WriteU32(entry.delay);
     }
 }
 
@@ -153,6 +237,8 @@ uint32_t
 DgrHeader::Deserialize(Buffer::Iterator start)
 {
     Buffer::Iterator i = start;
+    ClearNses();
+    ClearDownstreams();
 
     uint8_t temp;
     temp = i.ReadU8();
@@ -165,13 +251,50 @@ DgrHeader::Deserialize(Buffer::Iterator start)
         return 0;
     }
 
-    if (i.ReadU8() != 2)
+    uint8_t version = i.ReadU8();
+    if (version == DGR_COMPACT_VERSION)
+    {
+        m_compact = true;
+        uint8_t flags = i.ReadU8();
+        m_delta = (flags & DGR_DELTA_FLAG) != 0;
+        uint8_t nseNumber = i.ReadU8();
+        if (i.GetRemainingSize() < nseNumber + (nseNumber + 1) / 2)
+        {
+            return 0;
+        }
+        // the interfaces come first, the states are filled in after
+        DgrNse nse;
+        for (uint32_t n = 0; n < nseNumber; n++)
+        {
+            nse.SetInterface(i.ReadU8());
+            AddNse(nse);
+        }
+        DgrNse* nses = GetWritableNses();
+        uint8_t pair = 0;
+        for (uint32_t n = 0; n < nseNumber; n++)
+        {
+            if (n % 2 == 0)
+            {
+                pair = i.ReadU8();
+            }
+            nses[n].SetState(n % 2 == 0 ? pair >> 4 : pair & COMPACT_MAX_STATE);
+        }
+        if ((flags & DGR_DOWNSTREAM_FLAG) && !DeserializeDownstreams(i))
+        {
+            return 0;
+        }
+        return GetSerializedSize();
+    }
+    if (version != DGR_VERSION)
     {
         // std::cout << "DGR received a message with mismatch version, ignoring.\n";
         return 0;
     }
+    m_compact = false;
+    m_delta = false;
 
-    if (i.ReadU16() != 0)
+    uint16_t blank = i.ReadU16();
+    if (blank != 0 && blank != DGR_DOWNSTREAM_FLAG)
     {
         // std::cout << "DGR received a message with invalid filled flags, ignoring.\n";
         return 0;
@@ -179,17 +302,55 @@ DgrHeader::Deserialize(Buffer::Iterator start)
 
     DgrNse nse;
     uint32_t nseSize = nse.GetSerializedSize();
-    uint8_t nseNumber =
+    uint32_t nseNumber =
         i.GetRemainingSize() / nseSize; // !!!!!!!!!!!!! the size should be the same with nse.
-    for (uint8_t n = 0; n < nseNumber; n++)
+    if (blank == DGR_DOWNSTREAM_FLAG)
+    {
+        if (i.GetRemainingSize() < 2)
+        {
+            return 0;
+        }
+        nseNumber = i.ReadU16();
+        if (i.GetRemainingSize() < nseNumber * nseSize)
+        {
+            return 0;
+        }
+    }
+    for (uint32_t n = 0; n < nseNumber; n++)
     {
         i.Next(nse.Deserialize(i));
-        m_nseList.push_back(nse);
+        AddNse(nse);
+    }
+    if (blank == DGR_DOWNSTREAM_FLAG && !DeserializeDownstreams(i))
+    {
+        return 0;
     }
 
     return GetSerializedSize();
 }
 
+bool
+DgrHeader::DeserializeDownstreams(Buffer::Iterator& i)
+{
+    if (i.GetRemainingSize() < 2)
+    {
+        return false;
+    }
+    uint16_t number = i.ReadU16();
+    if (number > MAX_DOWNSTREAMS || i.GetRemainingSize() < number * DGR_DOWNSTREAM_SIZE)
+    {
+        return false;
+    }
+    m_downstream = true;
+    m_downstreams.resize(number);
+    for (DgrDownstream& entry : m_downstreams)
+    {
+        entry.dest = Ipv4Address(i.ReadU32());
+        entry.delay = i.ReadU32();
+    }
+    return true;
+}
+
 void
 DgrHeader::SetCommand(Command_e command)
 {
@@ -203,27 +364,139 @@ DgrHeader::GetCommand() const
 }
 
 void
-DgrHeader::AddNse(DgrNse nse)
+DgrHeader::SetCompact(bool compact)
 {
-    m_nseList.push_back(nse);
+    m_compact = compact;
+}
+
+bool
+DgrHeader::IsCompact() const
+{
+    return m_compact;
+}
+
+void
+DgrHeader::SetDelta(bool delta)
+{
+    m_delta = delta;
+}
+
+bool
+DgrHeader::IsDelta() const
+{
+    return m_delta;
+}
+
+void
+DgrHeader::SetDownstream(bool downstream)
+{
+    m_downstream = downstream;
+}
+
+bool
+DgrHeader::HasDownstream() const
+{
+    return m_downstream;
+}
+
+void
+DgrHeader::AddDownstream(const DgrDownstream& entry)
+{
+    m_downstream = true;
+    m_downstreams.push_back(entry);
+}
+
+void
+DgrHeader::ClearDownstreams()
+{
+    m_downstream = false;
+    m_downstreams.clear();
+}
+
+uint16_t
+DgrHeader::GetNDownstreams() const
+{
+    return m_downstreams.size();
+}
+
+const DgrDownstream*
+DgrHeader::GetDownstreams() const
+{
+    return m_downstreams.data();
+}
+
+void
+DgrHeader::SetNseStorage(std::vector<DgrNse>* storage)
+{
+    ClearNses();
+    m_storage = storage;
+    if (m_storage)
+    {
+        m_storage->clear();
+    }
+}
+
+std::vector<DgrNse>*
+DgrHeader::GetNseVector()
+{
+    return m_storage ? m_storage : &m_overflow;
+}
+
+const std::vector<DgrNse>*
+DgrHeader::GetNseVector() const
+{
+    return m_storage ? m_storage : &m_overflow;
+}
+
+void
+DgrHeader::AddNse(const DgrNse& nse)
+{
+    if (!m_storage && m_nNses < INLINE_NSES)
+    {
+        m_inline[m_nNses++] = nse;
+        return;
+    }
+    std::vector<DgrNse>* nses = GetNseVector();
+    if (!m_storage && m_nNses == INLINE_NSES)
+    {
+        // the entries move out of line together, to stay contiguous
+        nses->assign(m_inline, m_inline + INLINE_NSES);
+    }
+    nses->push_back(nse);
+    m_nNses++;
 }
 
 void
 DgrHeader::ClearNses()
 {
-    m_nseList.clear();
+    m_nNses = 0;
+    GetNseVector()->clear();
 }
 
 uint16_t
 DgrHeader::GetNseNumber() const
 {
-    return m_nseList.size();
+    return m_nNses;
 }
 
-std::list<DgrNse>
-DgrHeader::GetNseList() const
+const DgrNse*
+DgrHeader::GetNses() const
 {
-    return m_nseList;
+    if (m_storage || m_nNses > INLINE_NSES)
+    {
+        return GetNseVector()->data();
+    }
+    return m_inline;
+}
+
+DgrNse*
+DgrHeader::GetWritableNses()
+{
+    if (m_storage || m_nNses > INLINE_NSES)
+    {
+        return GetNseVector()->data();
+    }
+    return m_inline;
 }
 
 std::ostream&
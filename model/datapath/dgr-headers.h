@@ -7,7 +7,7 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/packet.h"
 
-#include <list>
+#include <vector>
 
 // ---Delay Guaranteed Routing Packet Header---
 //   | 8 bite  | 8 bite  | 8 bite  | 8 bite  |
@@ -15,6 +15,26 @@
 //   | Interface ID      |      States       |
 //                      ...
 //                      ...
+//
+// ---Compact Delay Guaranteed Routing Packet Header---
+//   | 8 bite  | 8 bite  | 8 bite  | 8 bite  |
+//   | version | commond |  flags  | entries |
+//   | iface 0 | iface 1 |       ...         |
+//   |st0 |st1 |st2 |st3 |       ...         |
+//
+// The compact header carries 8-bit interface IDs and 4-bit states, two per
+// byte, and a delta flag when it only holds the states that changed.
+//
+// ---Downstream delays, after the NSEs of either header---
+//   | 8 bite  | 8 bite  | 8 bite  | 8 bite  |
+//   |      entries      |
+//   |            destination                |
+//   |               delay                   |
+//                      ...
+//
+// A header with the downstream flag (the Empty field of the first header,
+// the flags of the compact one) carries them; the first header then has the
+// 16-bit number of its NSEs before them.
 
 namespace ns3
 {
@@ -90,6 +110,17 @@ class DgrNse : public Header
  */
 std::ostream& operator<<(std::ostream& os, const DgrNse& h);
 
+/**
+ * \ingroup dgr
+ * \brief The best delay of the sender towards a destination, over the delay
+ * bound of its shortest route
+ */
+struct DgrDownstream
+{
+    Ipv4Address dest; //!< a destination of the next-hop group
+    uint32_t delay;   //!< the delay over the bound of the shortest route, in us
+};
+
 /**
  * \ingroup dgr
  * \brief dgr header
@@ -141,6 +172,74 @@ class DgrHeader : public Header
         RESPONSE = 0x2
     };
 
+    /// largest interface ID of the compact format
+    static constexpr uint32_t COMPACT_MAX_INTERFACE = 0xff;
+    /// largest state of the compact format
+    static constexpr uint32_t COMPACT_MAX_STATE = 0xf;
+    /// largest number of NSEs of the compact format
+    static constexpr uint32_t COMPACT_MAX_NSES = 0xff;
+
+    /**
+     * \brief Use the compact format, in which every NSE must fit.
+     * \param compact true for the compact format
+     */
+    void SetCompact(bool compact);
+
+    /**
+     * \returns true if the header is in the compact format
+     */
+    bool IsCompact() const;
+
+    /**
+     * \brief Tell the NSEs are only the states that changed since the last
+     * update, which the compact format alone carries.
+     * \param delta true for a delta update
+     */
+    void SetDelta(bool delta);
+
+    /**
+     * \returns true if the NSEs are only the states that changed
+     */
+    bool IsDelta() const;
+
+    /// largest number of downstream delays of a header
+    static constexpr uint32_t MAX_DOWNSTREAMS = 128;
+
+    /**
+     * \brief Carry the downstream delays of the sender, which replace those
+     * of its last update, even if there are none.
+     * \param downstream true to carry them
+     */
+    void SetDownstream(bool downstream);
+
+    /**
+     * \returns true if the header carries the downstream delays of the sender
+     */
+    bool HasDownstream() const;
+
+    /**
+     * \brief Add a downstream delay to the message, which then carries them.
+     * \param entry the downstream delay
+     */
+    void AddDownstream(const DgrDownstream& entry);
+
+    /**
+     * \brief Clear the downstream delays from the header, which no longer
+     * carries them.
+     */
+    void ClearDownstreams();
+
+    /**
+     * \returns the number of downstream delays in the message
+     */
+    uint16_t GetNDownstreams() const;
+
+    /**
+     * \returns the GetNDownstreams () contiguous downstream delays of the
+     * message, valid until it changes
+     */
+    const DgrDownstream* GetDownstreams() const;
+
     /**
      * \brief Set the command
      * \param command the command
@@ -153,11 +252,25 @@ class DgrHeader : public Header
      */
     Command_e GetCommand() const;
 
+    /// number of NSEs stored in the header itself
+    static constexpr uint32_t INLINE_NSES = 8;
+
+    /**
+     * \brief Keep the NSEs in a vector of the caller, whose capacity is
+     * reused from one message to the next, instead of in the header.
+     *
+     * The NSEs are removed.  The vector must outlive the header and its
+     * copies, which share it.
+     *
+     * \param storage the vector, or nullptr for the header's own storage
+     */
+    void SetNseStorage(std::vector<DgrNse>* storage);
+
     /**
      * \brief Add a DGR Neighbor Status Entry (NSE) to the message
      * \param nse the Neighbor Status Entry
      */
-    void AddNse(DgrNse nse);
+    void AddNse(const DgrNse& nse);
 
     /**
      * \brief Clear all the NSEs from the header
@@ -171,14 +284,49 @@ class DgrHeader : public Header
     uint16_t GetNseNumber() const;
 
     /**
-     * \brief Get the list of NSEs included in the message
-     * \returns the list of DNEs in the message
+     * \brief Get the NSEs included in the message, without copying them
+     * \returns the GetNseNumber () contiguous NSEs of the message, valid until
+     * it changes
      */
-    std::list<DgrNse> GetNseList() const;
+    const DgrNse* GetNses() const;
 
   private:
-    uint8_t m_command;           //!< command type
-    std::list<DgrNse> m_nseList; //!< list of the DNEs in the message
+    /**
+     * \returns the vector the NSEs go to once out of line
+     */
+    std::vector<DgrNse>* GetNseVector();
+
+    /**
+     * \returns the vector the NSEs go to once out of line
+     */
+    const std::vector<DgrNse>* GetNseVector() const;
+
+    /**
+     * \returns the NSEs, to change in place
+     */
+    DgrNse* GetWritableNses();
+
+    /**
+     * \brief Read the downstream delays after the NSEs.
+     * \param i Buffer iterator, moved past them
+     * \return false if they do not fit the buffer
+     */
+    bool DeserializeDownstreams(Buffer::Iterator& i);
+
+    /**
+     * \returns the bytes of the downstream delays, 0 if none are carried
+     */
+    uint32_t GetDownstreamSize() const;
+
+    uint8_t m_command;                        //!< command type
+    bool m_compact;                           //!< whether the compact format is used
+    bool m_delta;                             //!< whether only the changed states are carried
+    bool m_downstream;                        //!< whether the downstream delays are carried
+    uint16_t m_nNses;                         //!< number of NSEs in the message
+    DgrNse m_inline[INLINE_NSES];             //!< the NSEs of a small message without storage
+    std::vector<DgrNse> m_overflow;           //!< the NSEs of a large message without storage
+    std::vector<DgrNse>* m_storage;           //!< the NSEs, if the caller gave storage
+    std::vector<DgrDownstream> m_downstreams; //!< the downstream delays
 };
 
 /**
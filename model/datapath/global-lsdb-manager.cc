@@ -4,22 +4,35 @@
 
 #include "../romam-routing.h"
 #include "../utility/ospf-router.h"
+#include "../utility/phase-profiler.h"
 #include "../utility/romam-router.h"
 #include "lsa.h"
+#include "lsdb-file.h"
 
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
+#include "ns3/global-value.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+
+#include <mpi.h>
+#endif
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <iostream>
 #include <queue>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -28,6 +41,50 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("GlobalLSDBManager");
 
+/// number of threads discovering the LSAs of the routers
+static GlobalValue g_lsaDiscoveryThreads(
+    "RomamLsaDiscoveryThreads",
+    "Number of threads discovering the LSAs of the different routers when the LSDB is "
+    "built (1 discovers them on the simulation thread, 0 uses one thread per hardware "
+    "thread)",
+    UintegerValue(1),
+    MakeUintegerChecker<uint32_t>());
+
+/**
+ * \param rtr a router
+ * \param lsas filled with the LSAs the router discovers
+ */
+static void
+CollectLSAs(const Ptr<RomamRouter>& rtr, std::vector<Ptr<LSA>>& lsas)
+{
+    uint32_t numLSAs = rtr->DiscoverLSAs();
+    NS_LOG_LOGIC("Found " << numLSAs << " LSAs");
+    for (uint32_t j = 0; j < numLSAs; ++j)
+    {
+        //
+        // This is the call to actually fetch a Link State Advertisement from the
+        // router, which the LSDB shares.
+        //
+        Ptr<LSA> lsa = rtr->GetLSA(j);
+        NS_LOG_LOGIC(*lsa);
+        lsas.push_back(lsa);
+    }
+}
+
+/**
+ * \brief Tell whether the simulation is distributed over several MPI ranks.
+ * \return true if the routers of other ranks are discovered there
+ */
+static bool
+IsDistributed()
+{
+#ifdef NS3_MPI
+    return MpiInterface::IsEnabled() && MpiInterface::GetSize() > 1;
+#else
+    return false;
+#endif
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalLSDBManager Implementation
@@ -38,16 +95,12 @@ GlobalLSDBManager::GlobalLSDBManager()
     : m_spfroot(0)
 {
     NS_LOG_FUNCTION(this);
-    m_lsdb = new LSDB();
+    m_lsdb = Create<LSDB>();
 }
 
 GlobalLSDBManager::~GlobalLSDBManager()
 {
     NS_LOG_FUNCTION(this);
-    if (m_lsdb)
-    {
-        delete m_lsdb;
-    }
 }
 
 //
@@ -57,16 +110,79 @@ GlobalLSDBManager::~GlobalLSDBManager()
 // that describe the links and networks that are "adjacent" (i.e., that are
 // on the other side of a point-to-point link).  We take these LSAs and put
 // add them to the Link State DataBase (LSDB) from which the routes will
-// ultimately be computed.
+// ultimately be computed.  Only the routers marked dirty since they were last
+// asked, or never asked, export their LSAs again.
+//
+// In a distributed simulation, every rank holds the whole topology but only
+// asks its own routers, and the ranks exchange the LSAs they found.
 //
 void
 GlobalLSDBManager::BuildLinkStateDatabase()
+{
+    NS_LOG_FUNCTION(this);
+    std::set<uint32_t> changed;
+    RefreshLinkStateDatabase(changed);
+}
+
+void
+GlobalLSDBManager::BuildLinkStateDatabase(const std::string& file)
+{
+    NS_LOG_FUNCTION(this << file);
+    if (!m_originated.empty())
+    {
+        BuildLinkStateDatabase();
+        return;
+    }
+    uint64_t hash = LSDBFile::ComputeTopologyHash();
+    Ptr<LSDB> lsdb = LSDBFile::Load(file, hash);
+    if (!lsdb)
+    {
+        BuildLinkStateDatabase();
+        // the ranks of a distributed simulation built the same LSDB
+        if (Simulator::GetSystemId() == 0)
+        {
+            LSDBFile::Save(*m_lsdb, hash, file);
+        }
+        return;
+    }
+
+    //
+    // The routers did not discover the LSAs of the file: the first update
+    // after one of them turns dirty compares its LSAs with the stored ones by
+    // content.
+    //
+    m_lsdb = lsdb;
+    std::vector<LSA*> lsas;
+    m_lsdb->GetLSAs(lsas);
+    for (auto i = lsas.begin(); i != lsas.end(); i++)
+    {
+        m_originated[(*i)->GetAdvertisingRouter().Get()].push_back((*i)->GetLinkStateId());
+    }
+    for (NodeList::Iterator i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouter> rtr = (*i)->GetObject<RomamRouter>();
+        if (rtr)
+        {
+            m_originated[rtr->GetRouterId().Get()];
+            rtr->MarkClean();
+        }
+    }
+    NS_LOG_LOGIC("Loaded " << lsas.size() << " LSAs from " << file);
+    m_directory.Build();
+    m_areas.Build(PeekPointer(m_lsdb), &m_directory);
+}
+
+bool
+GlobalLSDBManager::RefreshLinkStateDatabase(std::set<uint32_t>& changed)
 {
     NS_LOG_FUNCTION(this);
     //
     // Walk the list of nodes looking for the RomamRouter Interface.  Nodes with
     // global router interfaces are, not too surprisingly, our routers.
     //
+    bool distributed = IsDistributed();
+    uint32_t systemId = Simulator::GetSystemId();
+    std::vector<Ptr<RomamRouter>> dirty;
     NodeList::Iterator listEnd = NodeList::End();
     for (NodeList::Iterator i = NodeList::Begin(); i != listEnd; i++)
     {
@@ -78,62 +194,367 @@ GlobalLSDBManager::BuildLinkStateDatabase()
             std::cout << "No Router found\n";
             continue;
         }
+        // the routers of the other ranks are asked there (distributed sim)
+        if (distributed && node->GetSystemId() != systemId)
+        {
+            continue;
+        }
+        if (rtr->IsDirty() || m_originated.find(rtr->GetRouterId().Get()) == m_originated.end())
+        {
+            dirty.push_back(rtr);
+        }
+    }
+    NS_LOG_LOGIC(dirty.size() << " routers to discover again");
+    // every rank takes part in the exchange, even with nothing to send
+    if (dirty.empty() && !distributed)
+    {
+        return false;
+    }
 
-        // Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
-        // //
-        // // Ignore nodes that aren't participating in routing.
-        // //
-        // if (!rtr)
-        // {
-        //     std::cout << "No RomamRouter\n";
-        //     continue;
-        // }
+    //
+    // You must call DiscoverLSAs () before trying to use any routing info or to
+    // update LSAs.  DiscoverLSAs () drives the process of discovering routes in
+    // the RomamRouter.  Afterward, you may use GetNumLSAs (), which is a very
+    // computationally inexpensive call.  If you call GetNumLSAs () before calling
+    // DiscoverLSAs () will get zero as the number since no routes have been
+    // found.
+    //
+    std::vector<Ipv4Address> routerIds(dirty.size());
+    std::vector<std::vector<Ptr<LSA>>> discovered(dirty.size());
+    for (uint32_t r = 0; r < dirty.size(); r++)
+    {
+        routerIds[r] = dirty[r]->GetRouterId();
+    }
+    DiscoverLSAs(dirty, discovered);
+#ifdef NS3_MPI
+    if (distributed)
+    {
+        ExchangeLSAs(routerIds, discovered);
+    }
+#endif
 
-        //
-        // You must call DiscoverLSAs () before trying to use any routing info or to
-        // update LSAs.  DiscoverLSAs () drives the process of discovering routes in
-        // the RomamRouter.  Afterward, you may use GetNumLSAs (), which is a very
-        // computationally inexpensive call.  If you call GetNumLSAs () before calling
-        // DiscoverLSAs () will get zero as the number since no routes have been
-        // found.
-        //
-        Ptr<RomamRouting> grouting = rtr->GetRoutingProtocol();
-        uint32_t numLSAs = rtr->DiscoverLSAs();
-        NS_LOG_LOGIC("Found " << numLSAs << " LSAs");
+    //
+    // The LSAs a router no longer advertises are removed before any is
+    // inserted, so that an LSA which moved to another router, such as the
+    // network LSA of a link whose designated router changed, is kept.
+    //
+    for (uint32_t r = 0; r < routerIds.size(); r++)
+    {
+        std::set<uint32_t> ids;
+        for (auto i = discovered[r].begin(); i != discovered[r].end(); i++)
+        {
+            if ((*i)->GetLSType() != LSA::ASExternalLSAs)
+            {
+                ids.insert((*i)->GetLinkStateId().Get());
+            }
+        }
+        std::vector<Ipv4Address>& originated = m_originated[routerIds[r].Get()];
+        for (auto i = originated.begin(); i != originated.end(); i++)
+        {
+            LSA* current = m_lsdb->GetLSA(*i);
+            if (ids.count(i->Get()) == 0 && current &&
+                current->GetAdvertisingRouter() == routerIds[r])
+            {
+                GetWritableLSDB()->Remove(*i);
+                changed.insert(i->Get());
+            }
+        }
+    }
 
-        for (uint32_t j = 0; j < numLSAs; ++j)
+    bool externals = false;
+    for (uint32_t r = 0; r < routerIds.size(); r++)
+    {
+        Ipv4Address routerId = routerIds[r];
+        std::vector<Ipv4Address>& originated = m_originated[routerId.Get()];
+        originated.clear();
+        std::vector<Ptr<LSA>> extLSAs;
+        for (auto i = discovered[r].begin(); i != discovered[r].end(); i++)
         {
-            LSA* lsa = new LSA();
+            Ptr<LSA> lsa = *i;
+            if (lsa->GetLSType() == LSA::ASExternalLSAs)
+            {
+                extLSAs.push_back(lsa);
+                continue;
+            }
+            originated.push_back(lsa->GetLinkStateId());
             //
-            // This is the call to actually fetch a Link State Advertisement from the
-            // router.
+            // Write the newly discovered link state advertisement to the database,
+            // unless it is the one there already: the router keeps the instance of
+            // an LSA that did not change, and one read from a file is the same
+            // advertisement.
             //
-            rtr->GetLSA(j, *lsa);
-            NS_LOG_LOGIC(*lsa);
-            //
-            // Write the newly discovered link state advertisement to the database.
-            //
-            m_lsdb->Insert(lsa->GetLinkStateId(), lsa);
+            LSA* current = m_lsdb->GetLSA(lsa->GetLinkStateId());
+            if (current == PeekPointer(lsa) || (current && current->IsSameAdvertisement(*lsa)))
+            {
+                continue;
+            }
+            changed.insert(lsa->GetLinkStateId().Get());
+            GetWritableLSDB()->Insert(lsa->GetLinkStateId(), lsa);
+        }
+        externals = RefreshExtLSAs(routerId, extLSAs) || externals;
+    }
+    m_directory.Build();
+    bool areas = m_areas.Build(PeekPointer(m_lsdb), &m_directory);
+    return externals || areas;
+}
+
+#ifdef NS3_MPI
+void
+GlobalLSDBManager::ExchangeLSAs(std::vector<Ipv4Address>& routerIds,
+                                std::vector<std::vector<Ptr<LSA>>>& discovered)
+{
+    NS_LOG_FUNCTION(this << routerIds.size());
+    std::vector<LSA*> local;
+    for (auto i = discovered.begin(); i != discovered.end(); i++)
+    {
+        for (auto j = i->begin(); j != i->end(); j++)
+        {
+            local.push_back(PeekPointer(*j));
+        }
+    }
+    std::vector<char> buffer;
+    LSDBFile::Pack(local, buffer);
+
+    MPI_Comm comm = MpiInterface::GetCommunicator();
+    uint32_t nRanks = MpiInterface::GetSize();
+    int size = buffer.size();
+    std::vector<int> sizes(nRanks);
+    MPI_Allgather(&size, 1, MPI_INT, sizes.data(), 1, MPI_INT, comm);
+    // the sizes are multiples of 4 bytes, which keeps every buffer aligned
+    std::vector<int> offsets(nRanks, 0);
+    for (uint32_t r = 1; r < nRanks; r++)
+    {
+        offsets[r] = offsets[r - 1] + sizes[r - 1];
+    }
+    std::vector<char> all(offsets.back() + sizes.back());
+    MPI_Allgatherv(buffer.data(),
+                   size,
+                   MPI_BYTE,
+                   all.data(),
+                   sizes.data(),
+                   offsets.data(),
+                   MPI_BYTE,
+                   comm);
+
+    //
+    // The LSAs of the other ranks are grouped by advertising router, which is
+    // the router that discovered them.
+    //
+    std::unordered_map<uint32_t, uint32_t> index;
+    uint32_t systemId = Simulator::GetSystemId();
+    for (uint32_t r = 0; r < nRanks; r++)
+    {
+        if (r == systemId)
+        {
+            continue;
+        }
+        std::vector<Ptr<LSA>> lsas;
+        NS_ABORT_MSG_UNLESS(LSDBFile::Unpack(all.data() + offsets[r], sizes[r], lsas),
+                            "Malformed LSAs from rank " << r);
+        NS_LOG_LOGIC("Received " << lsas.size() << " LSAs from rank " << r);
+        for (auto i = lsas.begin(); i != lsas.end(); i++)
+        {
+            Ipv4Address routerId = (*i)->GetAdvertisingRouter();
+            auto found = index.find(routerId.Get());
+            if (found == index.end())
+            {
+                found = index.emplace(routerId.Get(), routerIds.size()).first;
+                routerIds.push_back(routerId);
+                discovered.emplace_back();
+            }
+            discovered[found->second].push_back(*i);
+        }
+    }
+}
+#endif
+
+void
+GlobalLSDBManager::DiscoverLSAs(const std::vector<Ptr<RomamRouter>>& routers,
+                                std::vector<std::vector<Ptr<LSA>>>& discovered)
+{
+    NS_LOG_FUNCTION(this << routers.size());
+    UintegerValue threads;
+    g_lsaDiscoveryThreads.GetValue(threads);
+    uint32_t nThreads = threads.Get() > 0
+                            ? threads.Get()
+                            : std::max(std::thread::hardware_concurrency(), 1U);
+    RomamRouter::StartLinkCache();
+    if (nThreads == 1 || routers.size() < 2)
+    {
+        for (uint32_t r = 0; r < routers.size(); r++)
+        {
+            CollectLSAs(routers[r], discovered[r]);
+        }
+        RomamRouter::StopLinkCache();
+        return;
+    }
+
+    //
+    // The discoveries share the reference counts and the aggregates of the
+    // nodes they read, which are not thread safe, so the routers reading a
+    // node in common are put in different rounds, each router in the first
+    // round none of its nodes is read in yet.
+    //
+    std::vector<std::vector<uint32_t>> rounds;
+    std::vector<uint32_t> bridged;
+    std::vector<std::vector<uint32_t>> nodeRounds(NodeList::GetNNodes());
+    std::vector<uint32_t> nodes;
+    std::vector<bool> taken;
+    for (uint32_t r = 0; r < routers.size(); r++)
+    {
+        if (!routers[r]->GetDiscoveryNodes(nodes))
+        {
+            bridged.push_back(r);
+            continue;
+        }
+        taken.assign(rounds.size() + 1, false);
+        for (uint32_t n : nodes)
+        {
+            for (uint32_t k : nodeRounds[n])
+            {
+                taken[k] = true;
+            }
+        }
+        uint32_t k = std::find(taken.begin(), taken.end(), false) - taken.begin();
+        if (k == rounds.size())
+        {
+            rounds.emplace_back();
+        }
+        rounds[k].push_back(r);
+        for (uint32_t n : nodes)
+        {
+            if (nodeRounds[n].empty() || nodeRounds[n].back() != k)
+            {
+                nodeRounds[n].push_back(k);
+            }
+        }
+    }
+    NS_LOG_LOGIC(routers.size() << " routers discovered in " << rounds.size() << " rounds, "
+                                << bridged.size() << " alone");
+
+    for (const std::vector<uint32_t>& round : rounds)
+    {
+        std::atomic<uint32_t> next(0);
+        auto work = [&routers, &discovered, &round, &next]() {
+            for (uint32_t i = next++; i < round.size(); i = next++)
+            {
+                CollectLSAs(routers[round[i]], discovered[round[i]]);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (uint32_t t = 1; t < std::min<std::size_t>(nThreads, round.size()); t++)
+        {
+            workers.emplace_back(work);
+        }
+        work();
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+    for (uint32_t r : bridged)
+    {
+        CollectLSAs(routers[r], discovered[r]);
+    }
+    RomamRouter::StopLinkCache();
+}
+
+bool
+GlobalLSDBManager::RefreshExtLSAs(Ipv4Address routerId, const std::vector<Ptr<LSA>>& lsas)
+{
+    NS_LOG_FUNCTION(this << routerId << lsas.size());
+    std::vector<LSA*> current;
+    for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs(); i++)
+    {
+        LSA* lsa = m_lsdb->GetExtLSA(i);
+        if (lsa->GetAdvertisingRouter() == routerId)
+        {
+            current.push_back(lsa);
         }
     }
-    // m_lsdb->Print(std::cout);
+    bool same = current.size() == lsas.size();
+    for (uint32_t i = 0; same && i < lsas.size(); i++)
+    {
+        same = current[i] == PeekPointer(lsas[i]) || current[i]->IsSameAdvertisement(*lsas[i]);
+    }
+    if (same)
+    {
+        return false;
+    }
+    LSDB* lsdb = GetWritableLSDB();
+    lsdb->RemoveExtLSAs(routerId);
+    for (auto i = lsas.begin(); i != lsas.end(); i++)
+    {
+        lsdb->Insert((*i)->GetLinkStateId(), *i);
+    }
+    return true;
 }
 
 LSDB*
 GlobalLSDBManager::GetLSDB(void) const
+{
+    return PeekPointer(m_lsdb);
+}
+
+Ptr<LSDB>
+GlobalLSDBManager::GetSnapshot(void) const
 {
     return m_lsdb;
 }
 
-void
-GlobalLSDBManager::DeleteLinkStateDatabase()
+LSDB*
+GlobalLSDBManager::GetWritableLSDB()
 {
-    if (m_lsdb)
+    // the manager holds one reference, any other is a reader's
+    if (m_lsdb->GetReferenceCount() > 1)
     {
-        NS_LOG_LOGIC("Delete LSDB, creating a new one");
-        delete m_lsdb;
-        m_lsdb = new LSDB();
+        NS_LOG_LOGIC("LSDB version " << m_lsdb->GetVersion() << " is pinned, writing to a copy");
+        m_lsdb = m_lsdb->Clone();
     }
+    return PeekPointer(m_lsdb);
+}
+
+const RouterDirectory*
+GlobalLSDBManager::GetRouterDirectory(void) const
+{
+    return &m_directory;
+}
+
+const AreaDirectory*
+GlobalLSDBManager::GetAreaDirectory(void) const
+{
+    return &m_areas;
+}
+
+void
+GlobalLSDBManager::AddAreaRange(uint32_t area, Ipv4Address network, Ipv4Mask mask)
+{
+    NS_LOG_FUNCTION(this << area << network << mask);
+    m_areas.AddRange(area, network, mask);
+}
+
+void
+GlobalLSDBManager::DeleteLinkStateDatabase()
+{
+    // the readers that pinned the previous version keep it
+    NS_LOG_LOGIC("Release LSDB, creating a new one");
+    m_lsdb = Create<LSDB>();
+    // every router exports its LSAs again on the next build
+    m_originated.clear();
+    m_directory.Clear();
+    m_areas.Clear();
+}
+
+bool
+GlobalLSDBManager::UpdateLinkStateDatabase(std::set<uint32_t>& changed)
+{
+    NS_LOG_FUNCTION(this);
+    PhaseProfiler::Scope scope(PhaseProfiler::BUILD_LSDB);
+    changed.clear();
+    bool externals = RefreshLinkStateDatabase(changed);
+    NS_LOG_LOGIC(changed.size() << " LSAs changed, AS-external LSAs or areas "
+                                << (externals ? "changed" : "unchanged"));
+    return externals;
 }
 
 } // namespace ns3
@@ -3,6 +3,8 @@
 #ifndef GLOBAL_LSDB_MANAGER_H
 #define GLOBAL_LSDB_MANAGER_H
 
+#include "../utility/router-directory.h"
+#include "area-directory.h"
 #include "lsdb.h"
 
 #include "ns3/ipv4-address.h"
@@ -12,12 +14,17 @@
 #include <list>
 #include <map>
 #include <queue>
+#include <set>
 #include <stdint.h>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
 {
 
+class RomamRouter;
+
 class GlobalLSDBManager
 {
   public:
@@ -27,23 +34,154 @@ class GlobalLSDBManager
     /**
      * @brief Build the Link State Database (LSDB) by gathering Link State Advertisements
      * from each node exporting a Router interface.
+     *
+     * Only the routers that are dirty, or whose LSAs are not in the LSDB yet,
+     * discover their LSAs again, and the LSAs that changed replace the stored
+     * ones in place.
+     *
+     * In a distributed simulation, where every rank creates the whole
+     * topology, a rank only asks the routers of its own nodes, the ranks
+     * exchange the LSAs over MPI, and every rank ends up with the same LSDB.
+     * The exchange is collective: every rank builds and updates its LSDB at
+     * the same times, as the same events drive the updates.
      */
     virtual void BuildLinkStateDatabase();
 
     /**
-     * @brief Delete the Link State Database (LSDB), create a new one.
+     * @brief Build the Link State Database (LSDB), starting from a file saved
+     * by an earlier run on the same topology.
+     *
+     * A fresh LSDB is read from the file if it was built from the current
+     * topology, and the routers are not asked for their LSAs.  Otherwise it
+     * is built as BuildLinkStateDatabase () does, and saved to the file.  An
+     * LSDB built already is only brought up to date.
+     *
+     * @param file the LSDB file
+     */
+    void BuildLinkStateDatabase(const std::string& file);
+
+    /**
+     * @brief Release the Link State Database (LSDB), create a new one.
+     *
+     * The snapshots readers hold stay valid.
      */
     void DeleteLinkStateDatabase();
 
+    /**
+     * @brief Bring the Link State Database (LSDB) up to date, as
+     * BuildLinkStateDatabase () does, and report what changed.
+     *
+     * @param changed filled with the link state IDs of the router and network LSAs
+     * that were added, removed or modified
+     * @return true if the AS-external LSAs, the areas of the routers or the
+     * summaries of the area border routers changed as well
+     */
+    bool UpdateLinkStateDatabase(std::set<uint32_t>& changed);
+
     /**
      * @brief Get LSDB
+     *
+     * The LSDB is only valid until the next update; pin it with GetSnapshot ()
+     * to keep it.
+     *
      * @return LSDB
      */
     LSDB* GetLSDB(void) const;
 
+    /**
+     * @brief Pin the current version of the LSDB.
+     *
+     * While a reader holds the snapshot, the updates write to a copy that
+     * shares the unchanged LSAs, and publish it as the new current version,
+     * so the snapshot never changes.  A version is freed when the manager and
+     * the last reader release it.  Holding a snapshot longer than needed
+     * makes the next update copy the LSA pointers of the database.
+     *
+     * @return the current version of the LSDB
+     */
+    Ptr<LSDB> GetSnapshot(void) const;
+
+    /**
+     * @brief Get the router directory built along with the LSDB
+     * @return the router directory
+     */
+    const RouterDirectory* GetRouterDirectory(void) const;
+
+    /**
+     * @brief Get the areas and the summaries of the area border routers,
+     * built along with the LSDB
+     * @return the area directory
+     */
+    const AreaDirectory* GetAreaDirectory(void) const;
+
+    /**
+     * @brief Summarize the prefixes of an area a range covers by the range,
+     * from the next LSDB build or update on.
+     * @param area the area ID
+     * @param network the network of the range
+     * @param mask its mask
+     */
+    void AddAreaRange(uint32_t area, Ipv4Address network, Ipv4Mask mask);
+
   private:
-    Vertex* m_spfroot; //!< the root node
-    LSDB* m_lsdb;      //!< the Link State DataBase (LSDB) of the Global Route Manager
+    /**
+     * @brief Discover the LSAs of the dirty routers again and write the ones
+     * that changed to the LSDB.
+     * @param changed extended with the link state IDs of the router and network
+     * LSAs that were added, removed or modified
+     * @return true if AS-external LSAs, the areas or the summaries changed
+     */
+    bool RefreshLinkStateDatabase(std::set<uint32_t>& changed);
+
+    /**
+     * @brief Replace the AS-external LSAs of a router, unless they did not change.
+     * @param routerId the router ID of the router
+     * @param lsas its newly discovered AS-external LSAs
+     * @return true if the LSAs changed
+     */
+    bool RefreshExtLSAs(Ipv4Address routerId, const std::vector<Ptr<LSA>>& lsas);
+
+    /**
+     * @brief Have routers discover their LSAs, on the threads of
+     * RomamLsaDiscoveryThreads.
+     *
+     * The routers are split in rounds in which no two of them read a node in
+     * common, see RomamRouter::GetDiscoveryNodes (), and the routers of a
+     * round discover their LSAs on all the threads; the routers on bridged
+     * links discover theirs alone once the rounds are done.  The LSAs of a
+     * router are the ones of a discovery on the simulation thread.
+     *
+     * @param routers the routers
+     * @param discovered filled with the LSAs of each router
+     */
+    void DiscoverLSAs(const std::vector<Ptr<RomamRouter>>& routers,
+                      std::vector<std::vector<Ptr<LSA>>>& discovered);
+
+#ifdef NS3_MPI
+    /**
+     * @brief Send the LSAs discovered on this rank to the others, and add
+     * the ones they discovered, in a distributed simulation.
+     * @param routerIds the router IDs of the routers that discovered LSAs,
+     * extended with the routers of the other ranks
+     * @param discovered the LSAs of each router, extended likewise
+     */
+    void ExchangeLSAs(std::vector<Ipv4Address>& routerIds,
+                      std::vector<std::vector<Ptr<LSA>>>& discovered);
+#endif
+
+    /**
+     * @brief Get the current LSDB for a change, first replacing it with a copy
+     * if a reader pinned it.
+     * @return the LSDB to change
+     */
+    LSDB* GetWritableLSDB();
+
+    Vertex* m_spfroot;           //!< the root node
+    Ptr<LSDB> m_lsdb;            //!< current version of the Link State DataBase (LSDB)
+    RouterDirectory m_directory; //!< router ID and address lookups for the LSDB nodes
+    AreaDirectory m_areas;       //!< the areas of the LSDB nodes
+    /// link state IDs of the router and network LSAs last discovered, by router ID
+    std::unordered_map<uint32_t, std::vector<Ipv4Address>> m_originated;
 };
 
 } // namespace ns3
@@ -125,7 +125,8 @@ LSA::LSA()
     m_networkLSANetworkMask ("0.0.0.0"),
     m_attachedRouters (),
     m_status (LSA::LSA_SPF_NOT_EXPLORED),
-    m_node_id (0)
+    m_node_id (0),
+    m_sequenceNumber (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -142,7 +143,8 @@ LSA::LSA (
     m_networkLSANetworkMask ("0.0.0.0"),
     m_attachedRouters (),
     m_status (status),
-    m_node_id (0)
+    m_node_id (0),
+    m_sequenceNumber (0)
 {
   NS_LOG_FUNCTION (this << status << linkStateId << advertisingRtr);
 }
@@ -152,7 +154,8 @@ LSA::LSA (LSA& lsa)
     m_advertisingRtr (lsa.m_advertisingRtr),
     m_networkLSANetworkMask (lsa.m_networkLSANetworkMask),
     m_status (lsa.m_status),
-    m_node_id (lsa.m_node_id)
+    m_node_id (lsa.m_node_id),
+    m_sequenceNumber (lsa.m_sequenceNumber)
 {
   NS_LOG_FUNCTION (this << &lsa);
   NS_ASSERT_MSG (IsEmpty (),
@@ -170,6 +173,7 @@ LSA::operator= (const LSA& lsa)
   m_networkLSANetworkMask = lsa.m_networkLSANetworkMask, 
   m_status = lsa.m_status;
   m_node_id = lsa.m_node_id;
+  m_sequenceNumber = lsa.m_sequenceNumber;
 
   ClearLinkRecords ();
   CopyLinkRecords (lsa);
@@ -180,22 +184,8 @@ void
 LSA::CopyLinkRecords (const LSA& lsa)
 {
   NS_LOG_FUNCTION (this << &lsa);
-  for (ListOfLinkRecords_t::const_iterator i = lsa.m_linkRecords.begin ();
-       i != lsa.m_linkRecords.end (); 
-       i++)
-    {
-      LinkRecord *pSrc = *i;
-      LinkRecord *pDst = new LinkRecord;
-
-      pDst->SetLinkType (pSrc->GetLinkType ());
-      pDst->SetLinkId (pSrc->GetLinkId ());
-      pDst->SetLinkData (pSrc->GetLinkData ());
-      pDst->SetMetric (pSrc->GetMetric ());
-
-      m_linkRecords.push_back (pDst);
-      pDst = 0;
-    }
-
+  m_linkRecords.insert (m_linkRecords.end (), lsa.m_linkRecords.begin (),
+                        lsa.m_linkRecords.end ());
   m_attachedRouters = lsa.m_attachedRouters;
 }
 
@@ -209,18 +199,6 @@ void
 LSA::ClearLinkRecords (void)
 {
   NS_LOG_FUNCTION (this);
-  for ( ListOfLinkRecords_t::iterator i = m_linkRecords.begin ();
-        i != m_linkRecords.end (); 
-        i++)
-    {
-      NS_LOG_LOGIC ("Free link record");
-
-      LinkRecord *p = *i;
-      delete p;
-      p = 0;
-
-      *i = 0;
-    }
   NS_LOG_LOGIC ("Clear list");
   m_linkRecords.clear ();
 }
@@ -229,7 +207,8 @@ uint32_t
 LSA::AddLinkRecord (LinkRecord* lr)
 {
   NS_LOG_FUNCTION (this << lr);
-  m_linkRecords.push_back (lr);
+  m_linkRecords.push_back (*lr);
+  delete lr;
   return m_linkRecords.size ();
 }
 
@@ -240,22 +219,12 @@ LSA::GetNLinkRecords (void) const
   return m_linkRecords.size ();
 }
 
-LinkRecord *
+const LinkRecord *
 LSA::GetLinkRecord (uint32_t n) const
 {
   NS_LOG_FUNCTION (this << n);
-  uint32_t j = 0;
-  for ( ListOfLinkRecords_t::const_iterator i = m_linkRecords.begin ();
-        i != m_linkRecords.end (); 
-        i++, j++)
-    {
-      if (j == n) 
-        {
-          return *i;
-        }
-    }
-  NS_ASSERT_MSG (false, "LSA::GetLinkRecord (): invalid index");
-  return 0;
+  NS_ASSERT_MSG (n < m_linkRecords.size (), "LSA::GetLinkRecord (): invalid index");
+  return &m_linkRecords[n];
 }
 
 bool
@@ -347,18 +316,33 @@ Ipv4Address
 LSA::GetAttachedRouter (uint32_t n) const
 {
   NS_LOG_FUNCTION (this << n);
-  uint32_t j = 0;
-  for ( ListOfAttachedRouters_t::const_iterator i = m_attachedRouters.begin ();
-        i != m_attachedRouters.end (); 
-        i++, j++)
+  NS_ASSERT_MSG (n < m_attachedRouters.size (), "LSA::GetAttachedRouter (): invalid index");
+  return m_attachedRouters[n];
+}
+
+bool
+LSA::IsSameAdvertisement (const LSA& lsa) const
+{
+  NS_LOG_FUNCTION (this << &lsa);
+  if (m_lsType != lsa.m_lsType || m_linkStateId != lsa.m_linkStateId
+      || m_advertisingRtr != lsa.m_advertisingRtr
+      || m_networkLSANetworkMask != lsa.m_networkLSANetworkMask
+      || m_linkRecords.size () != lsa.m_linkRecords.size ()
+      || m_attachedRouters != lsa.m_attachedRouters)
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < m_linkRecords.size (); i++)
     {
-      if (j == n) 
+      const LinkRecord& a = m_linkRecords[i];
+      const LinkRecord& b = lsa.m_linkRecords[i];
+      if (a.m_linkType != b.m_linkType || a.m_linkId != b.m_linkId
+          || a.m_linkData != b.m_linkData || a.m_metric != b.m_metric)
         {
-          return *i;
+          return false;
         }
     }
-  NS_ASSERT_MSG (false, "LSA::GetAttachedRouter (): invalid index");
-  return Ipv4Address ("0.0.0.0");
+  return true;
 }
 
 void
@@ -382,6 +366,26 @@ LSA::SetNode (Ptr<Node> node)
   m_node_id = node->GetId ();
 }
 
+uint64_t
+LSA::GetSequenceNumber (void) const
+{
+  return m_sequenceNumber;
+}
+
+void
+LSA::SetSequenceNumber (uint64_t sequenceNumber)
+{
+  NS_LOG_FUNCTION (this << sequenceNumber);
+  m_sequenceNumber = sequenceNumber;
+}
+
+std::size_t
+LSA::GetMemoryFootprint (void) const
+{
+  return sizeof (LSA) + m_linkRecords.capacity () * sizeof (LinkRecord) +
+    m_attachedRouters.capacity () * sizeof (Ipv4Address);
+}
+
 void
 LSA::Print (std::ostream &os) const
 {
@@ -409,6 +413,7 @@ LSA::Print (std::ostream &os) const
 
   os << "m_linkStateId = " << m_linkStateId << " (Router ID)" << std::endl;
   os << "m_advertisingRtr = " << m_advertisingRtr << " (Router ID)" << std::endl;
+  os << "m_sequenceNumber = " << m_sequenceNumber << std::endl;
 
   if (m_lsType == LSA::RouterLSA) 
     {
@@ -416,7 +421,7 @@ LSA::Print (std::ostream &os) const
             i != m_linkRecords.end (); 
             i++)
         {
-          LinkRecord *p = *i;
+          const LinkRecord *p = &*i;
 
           os << "---------- RouterLSA Link Record ----------" << std::endl;
           os << "m_linkType = " << p->m_linkType;
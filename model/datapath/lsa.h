@@ -5,8 +5,10 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/node.h"
 #include "ns3/channel.h"
 #include "ns3/ipv4-address.h"
@@ -224,9 +226,14 @@ private:
  * 
  * Roughly equivalent to a global incarnation of the OSPF link state header
  * combined with a list of Link Records.  Since it's global, there's
- * no need for age or sequence number.  See \RFC{2328}, Appendix A.
+ * no need for age.  See \RFC{2328}, Appendix A.
+ *
+ * An LSA is reference counted, so that the router that discovered it and the
+ * databases it is in share one instance.  Apart from the sequence number and
+ * SPF status the databases keep in it, it must not be modified once it is
+ * shared: a change of the advertisement is a new LSA.
  */
-class LSA
+class LSA : public SimpleRefCount<LSA>
 {
 public:
 /**
@@ -317,6 +324,9 @@ public:
 /**
  * @brief Add a given Global Routing Link Record to the LSA.
  *
+ * The record is copied into the LSA, which keeps its records contiguous, and
+ * lr is freed.
+ *
  * @param lr The Global Routing Link Record to be added.
  * @returns The number of link records in the list.
  */
@@ -335,7 +345,7 @@ public:
  * @param n The LSA number desired.
  * @returns The number of link records in the list.
  */
-  LinkRecord* GetLinkRecord (uint32_t n) const;
+  const LinkRecord* GetLinkRecord (uint32_t n) const;
 
 /**
  * @brief Release all of the Global Routing Link Records present in the Global
@@ -351,6 +361,15 @@ public:
  */
   bool IsEmpty (void) const;
 
+/**
+ * @brief Check whether two LSAs advertise the same links.
+ *
+ * @param lsa the other LSA
+ * @returns true if the LSAs only differ in their SPF status and sequence
+ * number
+ */
+  bool IsSameAdvertisement (const LSA& lsa) const;
+
 /**
  * @brief Print the contents of the Global Routing Link State Advertisement and
  * any Global Routing Link Records present in the list.  Quite verbose.
@@ -473,6 +492,30 @@ public:
  */
   void SetNode (Ptr<Node> node);
 
+/**
+ * @brief Get the sequence number of the advertisement.
+ *
+ * The LSDB stamps every LSA it stores with a number no LSA had before, so
+ * a new instance of an advertisement always has a higher number than the
+ * one it replaces.  An LSA that is not in a database has number 0.
+ *
+ * @returns the sequence number
+ */
+  uint64_t GetSequenceNumber (void) const;
+
+/**
+ * @brief Set the sequence number of the advertisement
+ * @param sequenceNumber the sequence number
+ */
+  void SetSequenceNumber (uint64_t sequenceNumber);
+
+/**
+ * @brief Get the memory the advertisement takes.
+ * @returns the number of bytes of the LSA and of its link records and
+ * attached routers
+ */
+  std::size_t GetMemoryFootprint (void) const;
+
 private:
 /**
  * The type of the LSA.  Each LSA type has a separate advertisement
@@ -500,14 +543,14 @@ private:
 /**
  * A convenience typedef to avoid too much writers cramp.
  */
-  typedef std::list<LinkRecord*> ListOfLinkRecords_t;
+  typedef std::vector<LinkRecord> ListOfLinkRecords_t;
 
 /**
  * Each Link State Advertisement contains a number of Link Records that
  * describe the kinds of links that are attached to a given node.  We 
  * consider PointToPoint and StubNetwork links.
  *
- * m_linkRecords is an STL list container to hold the Link Records that have
+ * m_linkRecords is an STL vector container to hold the Link Records that have
  * been discovered and prepared for the advertisement.
  *
  * @see GlobalRouting::DiscoverLSAs ()
@@ -522,12 +565,12 @@ private:
 /**
  * A convenience typedef to avoid too much writers cramp.
  */
-  typedef std::list<Ipv4Address> ListOfAttachedRouters_t;
+  typedef std::vector<Ipv4Address> ListOfAttachedRouters_t;
 
 /**
  * Each Network LSA contains a list of attached routers
  *
- * m_attachedRouters is an STL list container to hold the addresses that have
+ * m_attachedRouters is an STL vector container to hold the addresses that have
  * been discovered and prepared for the advertisement.
  *
  * @see GlobalRouting::DiscoverLSAs ()
@@ -542,6 +585,7 @@ private:
  */
   SPFStatus m_status;
   uint32_t m_node_id; //!< node ID
+  uint64_t m_sequenceNumber; //!< instance of the advertisement, see GetSequenceNumber ()
 };
 
 /**
@@ -0,0 +1,420 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "lsdb-file.h"
+
+#include "../routing_algorithm/dijkstra-route-info-entry.h"
+#include "../utility/romam-router.h"
+#include "lsa.h"
+
+#include "ns3/channel.h"
+#include "ns3/ipv4.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LSDBFile");
+
+/// "ROMAMLSD", which also tells the byte order of the file
+static const uint64_t FILE_MAGIC = 0x44534c4d414d4f52ULL;
+/// layout of the file, to be changed along with the structures below
+static const uint32_t FILE_FORMAT = 1;
+
+/// beginning of the file
+struct FileHeader
+{
+    uint64_t magic;        //!< FILE_MAGIC
+    uint32_t format;       //!< FILE_FORMAT
+    uint32_t nLSAs;        //!< number of FileLSA
+    uint64_t topologyHash; //!< hash of the topology the LSDB was built from
+    uint32_t nRecords;     //!< number of FileLinkRecord
+    uint32_t nAttached;    //!< number of attached router addresses
+};
+
+/// an LSA, whose records and attached routers are ranges of the flat arrays
+struct FileLSA
+{
+    uint32_t type;          //!< LSA::LSType
+    uint32_t linkStateId;   //!< link state ID
+    uint32_t advertisingId; //!< advertising router
+    uint32_t mask;          //!< network mask
+    uint32_t nodeId;        //!< originating node
+    uint32_t firstRecord;   //!< index of the first link record
+    uint32_t nRecords;      //!< number of link records
+    uint32_t firstAttached; //!< index of the first attached router
+    uint32_t nAttached;     //!< number of attached routers
+};
+
+/// a link record
+struct FileLinkRecord
+{
+    uint32_t linkId;   //!< link ID
+    uint32_t linkData; //!< link data
+    uint16_t metric;   //!< metric
+    uint16_t type;     //!< LinkRecord::LinkType
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader must have no padding");
+static_assert(sizeof(FileLSA) == 36, "FileLSA must have no padding");
+static_assert(sizeof(FileLinkRecord) == 12, "FileLinkRecord must have no padding");
+
+/**
+ * \brief Fold a value into an FNV-1a hash.
+ * \param hash the hash
+ * \param value the value
+ */
+static void
+Mix(uint64_t& hash, uint64_t value)
+{
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        hash ^= (value >> (8 * i)) & 0xff;
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+/**
+ * \brief Fold a string into an FNV-1a hash.
+ * \param hash the hash
+ * \param value the string
+ */
+static void
+Mix(uint64_t& hash, const std::string& value)
+{
+    Mix(hash, value.size());
+    for (auto i = value.begin(); i != value.end(); i++)
+    {
+        hash ^= static_cast<uint8_t>(*i);
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+/**
+ * \brief Append an LSA to the flat arrays.
+ * \param lsa the LSA
+ * \param lsas the LSAs
+ * \param records the link records
+ * \param attached the attached routers
+ */
+static void
+Flatten(const LSA* lsa,
+        std::vector<FileLSA>& lsas,
+        std::vector<FileLinkRecord>& records,
+        std::vector<uint32_t>& attached)
+{
+    FileLSA entry;
+    entry.type = lsa->GetLSType();
+    entry.linkStateId = lsa->GetLinkStateId().Get();
+    entry.advertisingId = lsa->GetAdvertisingRouter().Get();
+    entry.mask = lsa->GetNetworkLSANetworkMask().Get();
+    entry.nodeId = lsa->GetNode()->GetId();
+    entry.firstRecord = records.size();
+    entry.nRecords = lsa->GetNLinkRecords();
+    entry.firstAttached = attached.size();
+    entry.nAttached = lsa->GetNAttachedRouters();
+    for (uint32_t j = 0; j < entry.nRecords; j++)
+    {
+        const LinkRecord* l = lsa->GetLinkRecord(j);
+        FileLinkRecord record;
+        record.linkId = l->GetLinkId().Get();
+        record.linkData = l->GetLinkData().Get();
+        record.metric = l->GetMetric();
+        record.type = l->GetLinkType();
+        records.push_back(record);
+    }
+    for (uint32_t j = 0; j < entry.nAttached; j++)
+    {
+        attached.push_back(lsa->GetAttachedRouter(j).Get());
+    }
+    lsas.push_back(entry);
+}
+
+uint64_t
+LSDBFile::ComputeTopologyHash()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    Mix(hash, NodeList::GetNNodes());
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<Node> node = *i;
+        Mix(hash, node->GetId());
+        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
+        Mix(hash, rtr ? rtr->GetRouterId().Get() : UINT64_MAX);
+        if (rtr)
+        {
+            Mix(hash, rtr->GetAreaId());
+            Mix(hash, rtr->GetNInjectedRoutes());
+            for (uint32_t j = 0; j < rtr->GetNInjectedRoutes(); j++)
+            {
+                Mix(hash, rtr->GetInjectedRoute(j)->GetDestNetwork().Get());
+                Mix(hash, rtr->GetInjectedRoute(j)->GetDestNetworkMask().Get());
+            }
+        }
+        Mix(hash, node->GetNDevices());
+        for (uint32_t j = 0; j < node->GetNDevices(); j++)
+        {
+            Ptr<NetDevice> nd = node->GetDevice(j);
+            Mix(hash, nd->GetInstanceTypeId().GetName());
+            Ptr<Channel> ch = nd->GetChannel();
+            if (!ch)
+            {
+                Mix(hash, UINT64_MAX);
+                continue;
+            }
+            Mix(hash, ch->GetNDevices());
+            for (std::size_t k = 0; k < ch->GetNDevices(); k++)
+            {
+                Ptr<NetDevice> peer = ch->GetDevice(k);
+                Mix(hash, peer->GetNode()->GetId());
+                Mix(hash, peer->GetIfIndex());
+            }
+        }
+        Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+        if (!ipv4)
+        {
+            Mix(hash, UINT64_MAX);
+            continue;
+        }
+        Mix(hash, ipv4->GetNInterfaces());
+        for (uint32_t j = 0; j < ipv4->GetNInterfaces(); j++)
+        {
+            Ptr<NetDevice> nd = ipv4->GetNetDevice(j);
+            Mix(hash, nd ? nd->GetIfIndex() : UINT64_MAX);
+            Mix(hash, ipv4->IsUp(j));
+            Mix(hash, ipv4->IsForwarding(j));
+            Mix(hash, ipv4->GetMetric(j));
+            Mix(hash, ipv4->GetNAddresses(j));
+            for (uint32_t k = 0; k < ipv4->GetNAddresses(j); k++)
+            {
+                Mix(hash, ipv4->GetAddress(j, k).GetLocal().Get());
+                Mix(hash, ipv4->GetAddress(j, k).GetMask().Get());
+            }
+        }
+    }
+    return hash;
+}
+
+/**
+ * \brief Lay LSAs out as a file.
+ * \param stored the LSAs
+ * \param topologyHash the topology hash of the header
+ * \param buffer replaced with the header and the flat arrays
+ */
+static void
+Serialize(const std::vector<LSA*>& stored, uint64_t topologyHash, std::vector<char>& buffer)
+{
+    std::vector<FileLSA> lsas;
+    std::vector<FileLinkRecord> records;
+    std::vector<uint32_t> attached;
+    for (auto i = stored.begin(); i != stored.end(); i++)
+    {
+        Flatten(*i, lsas, records, attached);
+    }
+
+    FileHeader header;
+    header.magic = FILE_MAGIC;
+    header.format = FILE_FORMAT;
+    header.nLSAs = lsas.size();
+    header.topologyHash = topologyHash;
+    header.nRecords = records.size();
+    header.nAttached = attached.size();
+
+    std::size_t lsaBytes = lsas.size() * sizeof(FileLSA);
+    std::size_t recordBytes = records.size() * sizeof(FileLinkRecord);
+    std::size_t attachedBytes = attached.size() * sizeof(uint32_t);
+    buffer.resize(sizeof(header) + lsaBytes + recordBytes + attachedBytes);
+    char* out = buffer.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, lsas.data(), lsaBytes);
+    out += lsaBytes;
+    std::memcpy(out, records.data(), recordBytes);
+    out += recordBytes;
+    std::memcpy(out, attached.data(), attachedBytes);
+}
+
+/**
+ * \brief Read the header of LSAs laid out as a file, and check their size.
+ * \param data the LSAs
+ * \param size the size of the LSAs
+ * \param header filled with the header
+ * \return false if the format, the byte order or the size does not match
+ */
+static bool
+ReadHeader(const char* data, std::size_t size, FileHeader& header)
+{
+    if (size < sizeof(FileHeader))
+    {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    std::size_t expected = sizeof(FileHeader) +
+                           static_cast<std::size_t>(header.nLSAs) * sizeof(FileLSA) +
+                           static_cast<std::size_t>(header.nRecords) * sizeof(FileLinkRecord) +
+                           static_cast<std::size_t>(header.nAttached) * sizeof(uint32_t);
+    return header.magic == FILE_MAGIC && header.format == FILE_FORMAT && size == expected;
+}
+
+/**
+ * \brief Materialize the LSAs laid out as a file.
+ * \param data the LSAs, whose header was checked by ReadHeader ()
+ * \param header the header
+ * \param stored extended with the LSAs
+ * \return false if an LSA is corrupted
+ */
+static bool
+Deserialize(const char* data, const FileHeader& header, std::vector<Ptr<LSA>>& stored)
+{
+    // the arrays follow the header, whose size keeps them aligned
+    auto lsas = reinterpret_cast<const FileLSA*>(data + sizeof(FileHeader));
+    auto records = reinterpret_cast<const FileLinkRecord*>(lsas + header.nLSAs);
+    auto attached = reinterpret_cast<const uint32_t*>(records + header.nRecords);
+    stored.reserve(stored.size() + header.nLSAs);
+    for (uint32_t i = 0; i < header.nLSAs; i++)
+    {
+        const FileLSA& entry = lsas[i];
+        if (entry.firstRecord + static_cast<uint64_t>(entry.nRecords) > header.nRecords ||
+            entry.firstAttached + static_cast<uint64_t>(entry.nAttached) > header.nAttached ||
+            entry.nodeId >= NodeList::GetNNodes())
+        {
+            return false;
+        }
+        Ptr<LSA> lsa = Create<LSA>();
+        lsa->SetLSType(static_cast<LSA::LSType>(entry.type));
+        lsa->SetLinkStateId(Ipv4Address(entry.linkStateId));
+        lsa->SetAdvertisingRouter(Ipv4Address(entry.advertisingId));
+        lsa->SetNetworkLSANetworkMask(Ipv4Mask(entry.mask));
+        lsa->SetNode(NodeList::GetNode(entry.nodeId));
+        for (uint32_t j = entry.firstRecord; j < entry.firstRecord + entry.nRecords; j++)
+        {
+            lsa->AddLinkRecord(
+                new LinkRecord(static_cast<LinkRecord::LinkType>(records[j].type),
+                               Ipv4Address(records[j].linkId),
+                               Ipv4Address(records[j].linkData),
+                               records[j].metric));
+        }
+        for (uint32_t j = entry.firstAttached; j < entry.firstAttached + entry.nAttached; j++)
+        {
+            lsa->AddAttachedRouter(Ipv4Address(attached[j]));
+        }
+        stored.push_back(lsa);
+    }
+    return true;
+}
+
+bool
+LSDBFile::Save(const LSDB& lsdb, uint64_t topologyHash, const std::string& path)
+{
+    NS_LOG_FUNCTION(&lsdb << topologyHash << path);
+    std::vector<LSA*> stored;
+    lsdb.GetLSAs(stored);
+    for (uint32_t i = 0; i < lsdb.GetNumExtLSAs(); i++)
+    {
+        stored.push_back(lsdb.GetExtLSA(i));
+    }
+    std::vector<char> buffer;
+    Serialize(stored, topologyHash, buffer);
+
+    // the runs of a sweep may share the file: write a private one and rename it
+    std::ostringstream tmp;
+    tmp << path << ".tmp." << getpid();
+    {
+        std::ofstream out(tmp.str(), std::ios::binary | std::ios::trunc);
+        out.write(buffer.data(), buffer.size());
+        if (!out)
+        {
+            NS_LOG_WARN("Cannot write the LSDB file " << tmp.str());
+            std::remove(tmp.str().c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp.str().c_str(), path.c_str()) != 0)
+    {
+        NS_LOG_WARN("Cannot replace the LSDB file " << path);
+        std::remove(tmp.str().c_str());
+        return false;
+    }
+    NS_LOG_LOGIC("Saved " << stored.size() << " LSAs to " << path);
+    return true;
+}
+
+Ptr<LSDB>
+LSDBFile::Load(const std::string& path, uint64_t topologyHash)
+{
+    NS_LOG_FUNCTION(path << topologyHash);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        NS_LOG_LOGIC("No LSDB file " << path);
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(FileHeader))
+    {
+        close(fd);
+        return nullptr;
+    }
+    std::size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        NS_LOG_WARN("Cannot map the LSDB file " << path);
+        return nullptr;
+    }
+
+    const char* data = static_cast<const char*>(map);
+    FileHeader header;
+    if (!ReadHeader(data, size, header) || header.topologyHash != topologyHash)
+    {
+        NS_LOG_LOGIC("The LSDB file " << path << " does not match the topology");
+        munmap(map, size);
+        return nullptr;
+    }
+    std::vector<Ptr<LSA>> lsas;
+    bool valid = Deserialize(data, header, lsas);
+    munmap(map, size);
+    if (!valid)
+    {
+        NS_LOG_WARN("The LSDB file " << path << " is corrupted");
+        return nullptr;
+    }
+    Ptr<LSDB> lsdb = Create<LSDB>();
+    for (auto i = lsas.begin(); i != lsas.end(); i++)
+    {
+        lsdb->Insert((*i)->GetLinkStateId(), *i);
+    }
+    NS_LOG_LOGIC("Loaded " << header.nLSAs << " LSAs from " << path);
+    return lsdb;
+}
+
+void
+LSDBFile::Pack(const std::vector<LSA*>& lsas, std::vector<char>& buffer)
+{
+    NS_LOG_FUNCTION(lsas.size());
+    Serialize(lsas, 0, buffer);
+}
+
+bool
+LSDBFile::Unpack(const char* data, std::size_t size, std::vector<Ptr<LSA>>& lsas)
+{
+    NS_LOG_FUNCTION(size);
+    FileHeader header;
+    return ReadHeader(data, size, header) && Deserialize(data, header, lsas);
+}
+
+} // namespace ns3
@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef LSDB_FILE_H
+#define LSDB_FILE_H
+
+#include "lsdb.h"
+
+#include "ns3/ptr.h"
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Binary file of an LSDB, to start the runs of a sweep over one
+ * topology without discovering the LSAs again.
+ *
+ * The file holds a header, then flat arrays of LSAs, link records and
+ * attached routers, in host byte order.  It is read through a read-only
+ * memory mapping, and only the LSAs are materialized.  The header carries a
+ * hash of the topology the LSDB was built from; a file whose hash, format or
+ * byte order does not match is ignored, and the caller rebuilds the LSDB.
+ */
+class LSDBFile
+{
+  public:
+    /**
+     * \brief Hash what the LSAs of the current simulation are built from.
+     *
+     * The hash covers the nodes, their router IDs, areas and injected routes,
+     * the state, metric and addresses of their interfaces, and the channels
+     * between their devices.
+     *
+     * \return the topology hash
+     */
+    static uint64_t ComputeTopologyHash();
+
+    /**
+     * \brief Write an LSDB to a file, replacing it atomically.
+     * \param lsdb the database
+     * \param topologyHash the hash of the topology it was built from
+     * \param path the file
+     * \return true if the file was written
+     */
+    static bool Save(const LSDB& lsdb, uint64_t topologyHash, const std::string& path);
+
+    /**
+     * \brief Read an LSDB from a file.
+     * \param path the file
+     * \param topologyHash the hash of the current topology
+     * \return the database, or null if the file is missing, malformed or
+     * built from another topology
+     */
+    static Ptr<LSDB> Load(const std::string& path, uint64_t topologyHash);
+
+    /**
+     * \brief Write LSAs to a buffer, laid out as a file with no topology hash.
+     *
+     * This is how the ranks of a distributed simulation send each other the
+     * LSAs of their routers.
+     *
+     * \param lsas the LSAs
+     * \param buffer replaced with the LSAs
+     */
+    static void Pack(const std::vector<LSA*>& lsas, std::vector<char>& buffer);
+
+    /**
+     * \brief Read the LSAs of a buffer written by Pack ().
+     * \param data the buffer
+     * \param size the size of the buffer
+     * \param lsas extended with the LSAs, in the order they were packed
+     * \return false if the buffer is malformed
+     */
+    static bool Unpack(const char* data, std::size_t size, std::vector<Ptr<LSA>>& lsas);
+};
+
+} // namespace ns3
+
+#endif /* LSDB_FILE_H */
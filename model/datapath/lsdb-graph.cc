@@ -0,0 +1,307 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "lsdb-graph.h"
+
+#include "lsdb.h"
+
+#include "../utility/memory-footprint.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <utility>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LSDBGraph");
+
+LSDBGraph::LSDBGraph()
+    : m_version(0),
+      m_lsdb(nullptr)
+{
+    NS_LOG_FUNCTION(this);
+    m_offsets.push_back(0);
+    m_stubOffsets.push_back(0);
+    m_externalOffsets.push_back(0);
+}
+
+void
+LSDBGraph::Build(const LSDB* lsdb)
+{
+    NS_LOG_FUNCTION(this << lsdb);
+    m_lsdb = lsdb;
+    m_version = lsdb->GetVersion();
+    lsdb->GetLSAs(m_lsas);
+    m_index.clear();
+    m_offsets.clear();
+    m_targets.clear();
+    m_metrics.clear();
+    m_linkData.clear();
+    m_links.clear();
+    m_reverse.clear();
+    m_stubOffsets.clear();
+    m_stubs.clear();
+    m_advertisers.clear();
+    m_externalOffsets.clear();
+    m_externals.clear();
+
+    // the routers attached to a network are named by the link data of their
+    // transit network records
+    std::unordered_map<uint32_t, uint32_t> attached;
+    for (uint32_t v = 0; v < m_lsas.size(); v++)
+    {
+        m_index[m_lsas[v]->GetLinkStateId().Get()] = v;
+        for (uint32_t i = 0; i < m_lsas[v]->GetNLinkRecords(); i++)
+        {
+            const LinkRecord* l = m_lsas[v]->GetLinkRecord(i);
+            if (l->GetLinkType() == LinkRecord::TransitNetwork)
+            {
+                attached.emplace(l->GetLinkData().Get(), v);
+            }
+        }
+    }
+
+    for (uint32_t v = 0; v < m_lsas.size(); v++)
+    {
+        m_offsets.push_back(m_targets.size());
+        m_stubOffsets.push_back(m_stubs.size());
+        LSA* lsa = m_lsas[v];
+        if (lsa->GetLSType() == LSA::NetworkLSA)
+        {
+            for (uint32_t i = 0; i < lsa->GetNAttachedRouters(); i++)
+            {
+                auto w = attached.find(lsa->GetAttachedRouter(i).Get());
+                if (w == attached.end())
+                {
+                    continue;
+                }
+                m_targets.push_back(w->second);
+                m_metrics.push_back(0);
+                m_linkData.push_back(lsa->GetAttachedRouter(i));
+                m_links.push_back(nullptr);
+            }
+            continue;
+        }
+        for (uint32_t i = 0; i < lsa->GetNLinkRecords(); i++)
+        {
+            const LinkRecord* l = lsa->GetLinkRecord(i);
+            if (l->GetLinkType() == LinkRecord::StubNetwork)
+            {
+                m_stubs.push_back(l);
+                continue;
+            }
+            NS_ASSERT_MSG(l->GetLinkType() == LinkRecord::PointToPoint ||
+                              l->GetLinkType() == LinkRecord::TransitNetwork,
+                          "illegal Link Type");
+            auto w = m_index.find(l->GetLinkId().Get());
+            NS_ASSERT_MSG(w != m_index.end(), "No LSA for link " << l->GetLinkId());
+            m_targets.push_back(w->second);
+            m_metrics.push_back(l->GetMetric());
+            m_linkData.push_back(l->GetLinkData());
+            m_links.push_back(l);
+        }
+    }
+    m_offsets.push_back(m_targets.size());
+    m_stubOffsets.push_back(m_stubs.size());
+
+    // the external LSAs of a router are attached together, at the place of
+    // its first one, so count them by router before placing them
+    std::unordered_map<uint32_t, uint32_t> advertisers;
+    std::vector<uint32_t> groups;
+    for (uint32_t i = 0; i < lsdb->GetNumExtLSAs(); i++)
+    {
+        uint32_t v = GetVertex(lsdb->GetExtLSA(i)->GetAdvertisingRouter());
+        if (v == NO_VERTEX || m_lsas[v]->GetLSType() != LSA::RouterLSA)
+        {
+            groups.push_back(NO_VERTEX); // no tree reaches it
+            continue;
+        }
+        auto a = advertisers.emplace(v, m_advertisers.size()).first;
+        if (a->second == m_advertisers.size())
+        {
+            m_advertisers.push_back(v);
+            m_externalOffsets.push_back(0);
+        }
+        m_externalOffsets[a->second]++;
+        groups.push_back(a->second);
+    }
+    uint32_t next = 0;
+    for (uint32_t& offset : m_externalOffsets)
+    {
+        std::swap(offset, next);
+        next += offset;
+    }
+    m_externalOffsets.push_back(next);
+    m_externals.resize(next);
+    std::vector<uint32_t> placed(m_externalOffsets.begin(), m_externalOffsets.end() - 1);
+    for (uint32_t i = 0; i < groups.size(); i++)
+    {
+        if (groups[i] != NO_VERTEX)
+        {
+            m_externals[placed[groups[i]]++] = lsdb->GetExtLSA(i);
+        }
+    }
+
+    m_reverse.assign(m_targets.size(), NO_EDGE);
+    for (uint32_t v = 0; v < m_lsas.size(); v++)
+    {
+        for (uint32_t e = m_offsets[v]; e < m_offsets[v + 1]; e++)
+        {
+            uint32_t w = m_targets[e];
+            for (uint32_t r = m_offsets[w]; r < m_offsets[w + 1]; r++)
+            {
+                if (m_targets[r] == v)
+                {
+                    m_reverse[e] = r;
+                    break;
+                }
+            }
+        }
+    }
+    NS_LOG_LOGIC("Built a graph of " << m_lsas.size() << " vertices, " << m_targets.size()
+                                     << " edges, " << m_stubs.size() << " stubs and "
+                                     << m_externals.size() << " externals");
+}
+
+bool
+LSDBGraph::IsCurrent(const LSDB* lsdb) const
+{
+    return lsdb == m_lsdb && lsdb->GetVersion() == m_version;
+}
+
+uint32_t
+LSDBGraph::GetNVertices() const
+{
+    return m_lsas.size();
+}
+
+uint32_t
+LSDBGraph::GetVertex(Ipv4Address id) const
+{
+    auto i = m_index.find(id.Get());
+    return i == m_index.end() ? NO_VERTEX : i->second;
+}
+
+LSA*
+LSDBGraph::GetLSA(uint32_t v) const
+{
+    NS_ASSERT(v < m_lsas.size());
+    return m_lsas[v];
+}
+
+LSA*
+LSDBGraph::GetLSA(Ipv4Address id) const
+{
+    auto i = m_index.find(id.Get());
+    return i == m_index.end() ? nullptr : m_lsas[i->second];
+}
+
+uint32_t
+LSDBGraph::GetEdgesBegin(uint32_t v) const
+{
+    NS_ASSERT(v < m_lsas.size());
+    return m_offsets[v];
+}
+
+uint32_t
+LSDBGraph::GetEdgesEnd(uint32_t v) const
+{
+    NS_ASSERT(v < m_lsas.size());
+    return m_offsets[v + 1];
+}
+
+uint32_t
+LSDBGraph::GetTarget(uint32_t e) const
+{
+    return m_targets[e];
+}
+
+uint32_t
+LSDBGraph::GetMetric(uint32_t e) const
+{
+    return m_metrics[e];
+}
+
+Ipv4Address
+LSDBGraph::GetLinkData(uint32_t e) const
+{
+    return m_linkData[e];
+}
+
+const LinkRecord*
+LSDBGraph::GetLinkRecord(uint32_t e) const
+{
+    return m_links[e];
+}
+
+uint32_t
+LSDBGraph::GetReverse(uint32_t e) const
+{
+    return m_reverse[e];
+}
+
+uint32_t
+LSDBGraph::GetStubsBegin(uint32_t v) const
+{
+    NS_ASSERT(v < m_lsas.size());
+    return m_stubOffsets[v];
+}
+
+uint32_t
+LSDBGraph::GetStubsEnd(uint32_t v) const
+{
+    NS_ASSERT(v < m_lsas.size());
+    return m_stubOffsets[v + 1];
+}
+
+const LinkRecord*
+LSDBGraph::GetStub(uint32_t s) const
+{
+    return m_stubs[s];
+}
+
+uint32_t
+LSDBGraph::GetNAdvertisers() const
+{
+    return m_advertisers.size();
+}
+
+uint32_t
+LSDBGraph::GetAdvertiser(uint32_t a) const
+{
+    return m_advertisers[a];
+}
+
+uint32_t
+LSDBGraph::GetExternalsBegin(uint32_t a) const
+{
+    return m_externalOffsets[a];
+}
+
+uint32_t
+LSDBGraph::GetExternalsEnd(uint32_t a) const
+{
+    return m_externalOffsets[a + 1];
+}
+
+LSA*
+LSDBGraph::GetExternal(uint32_t x) const
+{
+    return m_externals[x];
+}
+
+std::size_t
+LSDBGraph::GetMemoryUsage() const
+{
+    return m_lsas.capacity() * sizeof(LSA*) + GetHashMapFootprint(m_index) +
+           (m_offsets.capacity() + m_targets.capacity() + m_metrics.capacity() +
+            m_reverse.capacity() + m_stubOffsets.capacity() + m_advertisers.capacity() +
+            m_externalOffsets.capacity()) *
+               sizeof(uint32_t) +
+           m_linkData.capacity() * sizeof(Ipv4Address) +
+           (m_links.capacity() + m_stubs.capacity()) * sizeof(LinkRecord*) +
+           m_externals.capacity() * sizeof(LSA*);
+}
+
+} // namespace ns3
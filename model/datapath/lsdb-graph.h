@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef LSDB_GRAPH_H
+#define LSDB_GRAPH_H
+
+#include "lsa.h"
+
+#include "ns3/ipv4-address.h"
+
+#include <cstddef>
+#include <limits>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class LSDB;
+
+/**
+ * \brief Compressed sparse row snapshot of the transit links of an LSDB.
+ *
+ * The router and network LSAs get dense vertex indices, and the links an SPF
+ * computation follows from each vertex are stored contiguously, in the order
+ * of the LSA: the point-to-point and transit network records of a router LSA,
+ * and the routers attached to a network LSA.  Each edge keeps its target,
+ * metric and link data, and the index of the first edge leading back from its
+ * target, so that the SPF engines never walk the link record lists nor search
+ * the LSDB while they expand a vertex.
+ *
+ * The prefixes the second stage of an SPF run attaches to the tree are
+ * extracted once per build as well: the stub network records of every router
+ * LSA, and the AS-external LSAs grouped by advertising router, the routers in
+ * the order of their first external LSA in the database.
+ *
+ * The graph refers to the LSAs of the database it was built from, and has to
+ * be rebuilt once the database changed, which IsCurrent () tells.
+ */
+class LSDBGraph
+{
+  public:
+    /// vertex index returned for an unknown link state ID
+    static constexpr uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+    /// edge index returned for a missing reverse edge
+    static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+    LSDBGraph();
+
+    /**
+     * \brief Build the graph of an LSDB, replacing the current content.
+     * \param lsdb the database
+     */
+    void Build(const LSDB* lsdb);
+
+    /**
+     * \param lsdb a database
+     * \return true if the graph was built from the current content of lsdb
+     */
+    bool IsCurrent(const LSDB* lsdb) const;
+
+    /**
+     * \return the number of vertices
+     */
+    uint32_t GetNVertices() const;
+
+    /**
+     * \param id a link state ID
+     * \return the index of the vertex of the LSA, or NO_VERTEX if none
+     */
+    uint32_t GetVertex(Ipv4Address id) const;
+
+    /**
+     * \param v a vertex index
+     * \return the LSA of the vertex
+     */
+    LSA* GetLSA(uint32_t v) const;
+
+    /**
+     * \param id a link state ID
+     * \return the LSA with the ID, or null if none
+     */
+    LSA* GetLSA(Ipv4Address id) const;
+
+    /**
+     * \param v a vertex index
+     * \return the index of the first edge leaving the vertex
+     */
+    uint32_t GetEdgesBegin(uint32_t v) const;
+
+    /**
+     * \param v a vertex index
+     * \return the index past the last edge leaving the vertex
+     */
+    uint32_t GetEdgesEnd(uint32_t v) const;
+
+    /**
+     * \param e an edge index
+     * \return the vertex index of the target of the edge
+     */
+    uint32_t GetTarget(uint32_t e) const;
+
+    /**
+     * \param e an edge index
+     * \return the metric of the edge, 0 from a network to its routers
+     */
+    uint32_t GetMetric(uint32_t e) const;
+
+    /**
+     * \param e an edge index
+     * \return the link data of the record of the edge, or the address of the
+     * attached router for an edge leaving a network
+     */
+    Ipv4Address GetLinkData(uint32_t e) const;
+
+    /**
+     * \param e an edge index
+     * \return the link record of the edge, or null for an edge leaving a network
+     */
+    const LinkRecord* GetLinkRecord(uint32_t e) const;
+
+    /**
+     * \param e an edge index
+     * \return the first edge from the target of e back to its source, or NO_EDGE
+     */
+    uint32_t GetReverse(uint32_t e) const;
+
+    /**
+     * \param v a vertex index
+     * \return the index of the first stub network record of the vertex
+     */
+    uint32_t GetStubsBegin(uint32_t v) const;
+
+    /**
+     * \param v a vertex index
+     * \return the index past the last stub network record of the vertex
+     */
+    uint32_t GetStubsEnd(uint32_t v) const;
+
+    /**
+     * \param s a stub index
+     * \return the stub network record
+     */
+    const LinkRecord* GetStub(uint32_t s) const;
+
+    /**
+     * \return the number of routers advertising AS-external LSAs
+     */
+    uint32_t GetNAdvertisers() const;
+
+    /**
+     * \param a an advertiser index
+     * \return the vertex index of the advertising router
+     */
+    uint32_t GetAdvertiser(uint32_t a) const;
+
+    /**
+     * \param a an advertiser index
+     * \return the index of the first external LSA of the router
+     */
+    uint32_t GetExternalsBegin(uint32_t a) const;
+
+    /**
+     * \param a an advertiser index
+     * \return the index past the last external LSA of the router
+     */
+    uint32_t GetExternalsEnd(uint32_t a) const;
+
+    /**
+     * \param x an external index
+     * \return the AS-external LSA, in the order of the database for a router
+     */
+    LSA* GetExternal(uint32_t x) const;
+
+    /**
+     * \return the number of bytes the vertices and edges take
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    uint64_t m_version;                             //!< version of the LSDB built from
+    const LSDB* m_lsdb;                             //!< the LSDB built from
+    std::vector<LSA*> m_lsas;                       //!< LSA by vertex index
+    std::unordered_map<uint32_t, uint32_t> m_index; //!< vertex index by link state ID
+    std::vector<uint32_t> m_offsets;                //!< first edge by vertex, and the edge count
+    std::vector<uint32_t> m_targets;                //!< target vertex by edge
+    std::vector<uint32_t> m_metrics;                //!< metric by edge
+    std::vector<Ipv4Address> m_linkData;            //!< link data by edge
+    std::vector<const LinkRecord*> m_links;         //!< link record by edge
+    std::vector<uint32_t> m_reverse;                //!< reverse edge by edge
+    std::vector<uint32_t> m_stubOffsets;            //!< first stub by vertex, and the stub count
+    std::vector<const LinkRecord*> m_stubs;         //!< stub network records, by vertex
+    std::vector<uint32_t> m_advertisers;            //!< vertex by advertiser of external LSAs
+    std::vector<uint32_t> m_externalOffsets;        //!< first external by advertiser, and the count
+    std::vector<LSA*> m_externals;                  //!< external LSAs, by advertiser
+};
+
+} // namespace ns3
+
+#endif /* LSDB_GRAPH_H */
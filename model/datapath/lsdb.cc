@@ -4,6 +4,7 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
@@ -14,6 +15,7 @@
 #include "ns3/ipv4-list-routing.h"
 
 #include "lsdb.h"
+#include "../utility/memory-footprint.h"
 #include <ctime>
 #include <chrono>
 
@@ -21,6 +23,9 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("LinkStateDataBase");
 
+/// the last version given to the content of an LSDB
+static std::atomic<uint64_t> g_lsdbVersion (0);
+
 /**
  * \brief Stream insertion operator.
  *
@@ -69,8 +74,13 @@ Vertex::Vertex () :
   m_distanceFromRoot (DISTINFINITY), 
   m_rootOif (DISTINFINITY),
   m_nextHop ("0.0.0.0"),
+  m_nExits (0),
   m_parents (),
-  m_children (),
+  m_arena (0),
+  m_index (0),
+  m_firstChild (VertexArena::NO_LINK),
+  m_lastChild (VertexArena::NO_LINK),
+  m_nChildren (0),
   m_vertexProcessed (false)
 {
   NS_LOG_FUNCTION (this);
@@ -82,8 +92,13 @@ Vertex::Vertex (LSA* lsa) :
   m_distanceFromRoot (DISTINFINITY), 
   m_rootOif (DISTINFINITY),
   m_nextHop ("0.0.0.0"),
+  m_nExits (0),
   m_parents (),
-  m_children (),
+  m_arena (0),
+  m_index (0),
+  m_firstChild (VertexArena::NO_LINK),
+  m_lastChild (VertexArena::NO_LINK),
+  m_nChildren (0),
   m_vertexProcessed (false)
 {
   NS_LOG_FUNCTION (this << lsa);
@@ -102,53 +117,9 @@ Vertex::Vertex (LSA* lsa) :
 
 Vertex::~Vertex ()
 {
+  // only the vertices of an arena have children, and the arena releases
+  // them all at once
   NS_LOG_FUNCTION (this);
-
-  NS_LOG_LOGIC ("Children vertices - " << m_children);
-  NS_LOG_LOGIC ("Parent verteices - " << m_parents);
-
-  // find this node from all its parents and remove the entry of this node
-  // from all its parents
-  for (ListOfVertex_t::iterator piter = m_parents.begin (); 
-       piter != m_parents.end ();
-       piter++)
-    {
-      // remove the current vertex from its parent's children list. Check
-      // if the size of the list is reduced, or the child<->parent relation
-      // is not bidirectional
-      uint32_t orgCount = (*piter)->m_children.size ();
-      (*piter)->m_children.remove (this);
-      uint32_t newCount = (*piter)->m_children.size ();
-      if (orgCount > newCount)
-        {
-          NS_ASSERT_MSG (orgCount > newCount, "Unable to find the current vertex from its parents --- impossible!");
-        }
-    }
-
-  // delete children
-  while (m_children.size () > 0)
-    {
-      // pop out children one by one. Some children may disappear 
-      // when deleting some other children in the list. As a result,
-      // it is necessary to use pop to walk through all children, instead
-      // of using iterator.
-      //
-      // Note that m_children.pop_front () is not necessary as this
-      // p is removed from the children list when p is deleted
-      Vertex* p = m_children.front ();
-      // 'p' == 0, this child is already deleted by its other parent
-      if (p == 0) continue;
-      NS_LOG_LOGIC ("Parent vertex-" << m_vertexId << " deleting its child vertex-" << p->GetVertexId ());
-      delete p;
-      p = 0;
-    }
-  m_children.clear ();
-  // delete parents
-  m_parents.clear ();
-  // delete root exit direction
-  m_ecmpRootExits.clear ();
-
-  NS_LOG_LOGIC ("Vertex-" << m_vertexId << " completed deleted");
 }
 
 Vertex::VertexType
@@ -213,8 +184,9 @@ Vertex::SetRootExitDirection (Ipv4Address nextHop, int32_t id)
   NS_LOG_FUNCTION (this << nextHop << id);
 
   // always maintain only one root's exit
-  m_ecmpRootExits.clear ();
-  m_ecmpRootExits.push_back (NodeExit_t (nextHop, id));
+  m_nExits = 0;
+  m_moreExits.clear ();
+  AppendExit (NodeExit_t (nextHop, id));
   // update the following in order to be backward compatitable with
   // GetNextHop and GetOutgoingInterface methods
   m_nextHop = nextHop;
@@ -232,20 +204,16 @@ Vertex::NodeExit_t
 Vertex::GetRootExitDirection (uint32_t i) const
 {
   NS_LOG_FUNCTION (this << i);
-  typedef ListOfNodeExit_t::const_iterator CIter_t;
-
-  NS_ASSERT_MSG (i < m_ecmpRootExits.size (), "Index out-of-range when accessing Vertex::m_ecmpRootExits!");
-  CIter_t iter = m_ecmpRootExits.begin ();
-  while (i-- > 0) { iter++; }
 
-  return *iter;
+  NS_ASSERT_MSG (i < m_nExits, "Index out-of-range when accessing the root exits of a Vertex!");
+  return GetExit (i);
 }
 
 Vertex::NodeExit_t 
 Vertex::GetRootExitDirection () const
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT_MSG (m_ecmpRootExits.size () <= 1, "Assumed there is at most one exit from the root to this vertex");
+  NS_ASSERT_MSG (m_nExits <= 1, "Assumed there is at most one exit from the root to this vertex");
   return GetRootExitDirection (0);
 }
 
@@ -256,12 +224,28 @@ Vertex::MergeRootExitDirections (const Vertex* vertex)
 
   // obtain the external list of exit directions
   //
-  // Append the external list into 'this' and remove duplication afterward
-  const ListOfNodeExit_t& extList = vertex->m_ecmpRootExits;
-  m_ecmpRootExits.insert (m_ecmpRootExits.end (), 
-                          extList.begin (), extList.end ());
-  m_ecmpRootExits.sort ();
-  m_ecmpRootExits.unique ();
+  // Append the exits of the external list that 'this' does not have, then
+  // keep the exits sorted; both lists hold a handful of distinct exits
+  for (uint32_t i = 0; i < vertex->m_nExits; i++)
+    {
+      const NodeExit_t& exit = vertex->GetExit (i);
+      bool known = false;
+      for (uint32_t j = 0; j < m_nExits && !known; j++)
+        {
+          known = GetExit (j) == exit;
+        }
+      if (!known)
+        {
+          AppendExit (exit);
+        }
+    }
+  for (uint32_t i = 1; i < m_nExits; i++)
+    {
+      for (uint32_t j = i; j > 0 && GetExit (j) < GetExit (j - 1); j--)
+        {
+          std::swap (GetExit (j), GetExit (j - 1));
+        }
+    }
 }
 
 void 
@@ -271,20 +255,49 @@ Vertex::InheritAllRootExitDirections (const Vertex* vertex)
 
   // discard all exit direction currently associated with this vertex,
   // and copy all the exit directions from the given vertex
-  if (m_ecmpRootExits.size () > 0)
+  if (m_nExits > 0)
     {
       NS_LOG_WARN ("x root exit directions in this vertex are going to be discarded");
     }
-  m_ecmpRootExits.clear ();
-  m_ecmpRootExits.insert (m_ecmpRootExits.end (), 
-                          vertex->m_ecmpRootExits.begin (), vertex->m_ecmpRootExits.end ());
+  m_nExits = 0;
+  m_moreExits.clear ();
+  for (uint32_t i = 0; i < vertex->m_nExits; i++)
+    {
+      AppendExit (vertex->GetExit (i));
+    }
 }
 
 uint32_t 
 Vertex::GetNRootExitDirections () const
 {
   NS_LOG_FUNCTION (this);
-  return m_ecmpRootExits.size ();
+  return m_nExits;
+}
+
+Vertex::NodeExit_t&
+Vertex::GetExit (uint32_t i)
+{
+  return i < N_INLINE_EXITS ? m_inlineExits[i] : m_moreExits[i - N_INLINE_EXITS];
+}
+
+const Vertex::NodeExit_t&
+Vertex::GetExit (uint32_t i) const
+{
+  return i < N_INLINE_EXITS ? m_inlineExits[i] : m_moreExits[i - N_INLINE_EXITS];
+}
+
+void
+Vertex::AppendExit (const NodeExit_t& exit)
+{
+  if (m_nExits < N_INLINE_EXITS)
+    {
+      m_inlineExits[m_nExits] = exit;
+    }
+  else
+    {
+      m_moreExits.push_back (exit);
+    }
+  m_nExits++;
 }
 
 Vertex*
@@ -298,12 +311,7 @@ Vertex::GetParent (uint32_t i) const
       NS_LOG_LOGIC ("Index to Vertex's parent is out-of-range.");
       return 0;
     }
-  ListOfVertex_t::const_iterator iter = m_parents.begin ();
-  while (i-- > 0) 
-    {
-      iter++;
-    }
-  return *iter;
+  return m_parents[i];
 }
 
 void
@@ -326,8 +334,8 @@ Vertex::MergeParent (const Vertex* v)
   m_parents.insert (m_parents.end (), 
                     v->m_parents.begin (), v->m_parents.end ());
   // remove duplication
-  m_parents.sort ();
-  m_parents.unique ();
+  std::sort (m_parents.begin (), m_parents.end ());
+  m_parents.erase (std::unique (m_parents.begin (), m_parents.end ()), m_parents.end ());
   NS_LOG_LOGIC ("After merge, list of parents = " << m_parents);
 }
 
@@ -335,34 +343,23 @@ uint32_t
 Vertex::GetNChildren (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_children.size ();
+  return m_nChildren;
 }
 
-Vertex*
-Vertex::GetChild (uint32_t n) const
+uint32_t
+Vertex::AddChild (Vertex* child)
 {
-  NS_LOG_FUNCTION (this << n);
-  uint32_t j = 0;
-
-  for ( ListOfVertex_t::const_iterator i = m_children.begin ();
-        i != m_children.end ();
-        i++, j++)
-    {
-      if (j == n)
-        {
-          return *i;
-        }
-    }
-  NS_ASSERT_MSG (false, "Index <n> out of range.");
-  return 0;
+  NS_LOG_FUNCTION (this << child);
+  NS_ASSERT_MSG (m_arena && child->m_arena == m_arena,
+                 "Only the vertices of one VertexArena can be parent and child");
+  m_arena->LinkChild (this, child);
+  return m_nChildren;
 }
 
 uint32_t
-Vertex::AddChild (Vertex* child)
+Vertex::GetIndex (void) const
 {
-  NS_LOG_FUNCTION (this << child);
-  m_children.push_back (child);
-  return m_children.size ();
+  return m_index;
 }
 
 void 
@@ -383,11 +380,130 @@ void
 Vertex::ClearVertexProcessed (void)
 {
   NS_LOG_FUNCTION (this);
-  for (uint32_t i = 0; i < this->GetNChildren (); i++)
+  ForEachChild ([] (Vertex* child) { child->ClearVertexProcessed (); });
+  this->SetVertexProcessed (false);
+}
+
+void
+Vertex::Reset (LSA* lsa, uint32_t index)
+{
+  NS_LOG_FUNCTION (this << lsa << index);
+  m_vertexType = VertexUnknown;
+  m_vertexId = lsa->GetLinkStateId ();
+  m_lsa = lsa;
+  m_distanceFromRoot = DISTINFINITY;
+  m_rootOif = DISTINFINITY;
+  m_nextHop = Ipv4Address ("0.0.0.0");
+  m_nExits = 0;
+  m_moreExits.clear ();
+  m_parents.clear ();
+  m_index = index;
+  m_firstChild = VertexArena::NO_LINK;
+  m_lastChild = VertexArena::NO_LINK;
+  m_nChildren = 0;
+  m_vertexProcessed = false;
+  if (lsa->GetLSType () == LSA::RouterLSA)
     {
-      this->GetChild (i)->ClearVertexProcessed ();
+      m_vertexType = Vertex::VertexRouter;
+    }
+  else if (lsa->GetLSType () == LSA::NetworkLSA)
+    {
+      m_vertexType = Vertex::VertexNetwork;
     }
-  this->SetVertexProcessed (false);
+}
+
+// ---------------------------------------------------------------------------
+//
+// VertexArena Implementation
+//
+// ---------------------------------------------------------------------------
+
+VertexArena::VertexArena ()
+  : m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+VertexArena::~VertexArena ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Vertex*
+VertexArena::Allocate (LSA* lsa)
+{
+  NS_LOG_FUNCTION (this << lsa);
+  if (m_size == GetCapacity ())
+    {
+      m_chunks.emplace_back (new Vertex[CHUNK_SIZE]);
+      for (uint32_t i = 0; i < CHUNK_SIZE; i++)
+        {
+          m_chunks.back ()[i].m_arena = this;
+        }
+    }
+  Vertex* v = Get (m_size);
+  v->Reset (lsa, m_size);
+  m_size++;
+  return v;
+}
+
+void
+VertexArena::Clear ()
+{
+  NS_LOG_FUNCTION (this << m_size);
+  m_size = 0;
+  m_childLinks.clear ();
+}
+
+Vertex*
+VertexArena::Get (uint32_t index) const
+{
+  return &m_chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+}
+
+void
+VertexArena::ClearProcessed ()
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_size; i++)
+    {
+      Get (i)->m_vertexProcessed = false;
+    }
+}
+
+std::size_t
+VertexArena::GetMemoryUsage () const
+{
+  return GetCapacity () * sizeof (Vertex) + m_childLinks.capacity () * sizeof (ChildLink);
+}
+
+void
+VertexArena::LinkChild (Vertex* parent, Vertex* child)
+{
+  uint32_t link = m_childLinks.size ();
+  m_childLinks.push_back (ChildLink{child->m_index, NO_LINK});
+  if (parent->m_lastChild == NO_LINK)
+    {
+      parent->m_firstChild = link;
+    }
+  else
+    {
+      m_childLinks[parent->m_lastChild].next = link;
+    }
+  parent->m_lastChild = link;
+  parent->m_nChildren++;
+}
+
+uint32_t
+VertexArena::GetSize () const
+{
+  return m_size;
+}
+
+uint32_t
+VertexArena::GetCapacity () const
+{
+  return m_chunks.size () * CHUNK_SIZE;
 }
 
 // ---------------------------------------------------------------------------
@@ -398,7 +514,12 @@ Vertex::ClearVertexProcessed (void)
 
 LSDB::LSDB ()
   : m_database (),
-    m_extdatabase ()
+    m_index (),
+    m_linkDataIndex (),
+    m_sorted (true),
+    m_linkDataShared (false),
+    m_extdatabase (),
+    m_version (++g_lsdbVersion)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -406,58 +527,181 @@ LSDB::LSDB ()
 LSDB::~LSDB ()
 {
   NS_LOG_FUNCTION (this);
-  LSDBMap_t::iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  for (uint32_t j = 0; j < m_database.size (); j++)
     {
-      NS_LOG_LOGIC ("free LSA");
-      LSA* temp = i->second;
-      delete temp;
+      NS_LOG_LOGIC ("release LSA");
+      m_database.at (j)->Unref ();
     }
   for (uint32_t j = 0; j < m_extdatabase.size (); j++)
     {
-      NS_LOG_LOGIC ("free ASexternalLSA");
-      LSA* temp = m_extdatabase.at (j);
-      delete temp;
+      NS_LOG_LOGIC ("release ASexternalLSA");
+      m_extdatabase.at (j)->Unref ();
     }
   NS_LOG_LOGIC ("clear map");
   m_database.clear ();
+  m_index.clear ();
+  m_linkDataIndex.clear ();
 }
 
 void
 LSDB::Initialize ()
 {
   NS_LOG_FUNCTION (this);
-  LSDBMap_t::iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  for (std::vector<LSA*>::iterator i = m_database.begin (); i != m_database.end (); i++)
     {
-      LSA* temp = i->second;
-      temp->SetStatus (LSA::LSA_SPF_NOT_EXPLORED);
+      (*i)->SetStatus (LSA::LSA_SPF_NOT_EXPLORED);
     }
 }
 
 void
-LSDB::Insert (Ipv4Address addr, LSA* lsa)
+LSDB::Insert (Ipv4Address addr, Ptr<LSA> shared)
 {
-  NS_LOG_FUNCTION (this << addr << lsa);
+  NS_LOG_FUNCTION (this << addr << shared);
+  // the database holds a reference on the LSAs it stores
+  LSA* lsa = PeekPointer (shared);
+  lsa->Ref ();
+  lsa->SetSequenceNumber (NewVersion ());
   if (lsa->GetLSType () == LSA::ASExternalLSAs) 
     {
       m_extdatabase.push_back (lsa);
-    } 
-  else
+      return;
+    }
+  std::pair<LSDBIndex_t::iterator, bool> found = m_index.emplace (addr.Get (), lsa);
+  if (!found.second)
+    {
+      NS_LOG_LOGIC ("LSA " << addr << " replaces the one in the database");
+      LSA* old = found.first->second;
+      UnindexLinkData (old);
+      *std::find (m_database.begin (), m_database.end (), old) = lsa;
+      found.first->second = lsa;
+      IndexLinkData (lsa);
+      old->Unref ();
+      return;
+    }
+  if (!m_database.empty () && addr < m_database.back ()->GetLinkStateId ())
+    {
+      m_sorted = false;
+    }
+  m_database.push_back (lsa);
+  IndexLinkData (lsa);
+}
+
+bool
+LSDB::Remove (Ipv4Address addr)
+{
+  NS_LOG_FUNCTION (this << addr);
+  LSDBIndex_t::iterator i = m_index.find (addr.Get ());
+  if (i == m_index.end ())
+    {
+      return false;
+    }
+  LSA* lsa = i->second;
+  m_index.erase (i);
+  // erasing keeps the others in order
+  m_database.erase (std::find (m_database.begin (), m_database.end (), lsa));
+  UnindexLinkData (lsa);
+  lsa->Unref ();
+  NewVersion ();
+  return true;
+}
+
+uint32_t
+LSDB::RemoveExtLSAs (Ipv4Address advertisingRouter)
+{
+  NS_LOG_FUNCTION (this << advertisingRouter);
+  std::vector<LSA*>::iterator kept = std::stable_partition (
+    m_extdatabase.begin (), m_extdatabase.end (),
+    [advertisingRouter] (const LSA* lsa) {
+      return lsa->GetAdvertisingRouter () != advertisingRouter;
+    });
+  uint32_t removed = m_extdatabase.end () - kept;
+  for (std::vector<LSA*>::iterator i = kept; i != m_extdatabase.end (); i++)
+    {
+      (*i)->Unref ();
+    }
+  m_extdatabase.erase (kept, m_extdatabase.end ());
+  if (removed > 0)
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      NewVersion ();
     }
+  return removed;
+}
+
+void
+LSDB::IndexLinkData (LSA* lsa)
+{
+  Ipv4Address addr = lsa->GetLinkStateId ();
+  for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+    {
+      const LinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != LinkRecord::TransitNetwork)
+        {
+          continue;
+        }
+      // the lowest link state ID wins, as when the database was scanned in order
+      std::pair<LSDBIndex_t::iterator, bool> found =
+        m_linkDataIndex.emplace (lr->GetLinkData ().Get (), lsa);
+      if (found.second)
+        {
+          continue;
+        }
+      m_linkDataShared = true;
+      if (addr < found.first->second->GetLinkStateId ())
+        {
+          found.first->second = lsa;
+        }
+    }
+}
+
+void
+LSDB::UnindexLinkData (LSA* lsa)
+{
+  bool orphaned = false;
+  for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+    {
+      const LinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != LinkRecord::TransitNetwork)
+        {
+          continue;
+        }
+      LSDBIndex_t::iterator i = m_linkDataIndex.find (lr->GetLinkData ().Get ());
+      if (i != m_linkDataIndex.end () && i->second == lsa)
+        {
+          m_linkDataIndex.erase (i);
+          orphaned = true;
+        }
+    }
+  if (!orphaned || !m_linkDataShared)
+    {
+      return;
+    }
+  // another LSA may advertise the link data that lost its entry
+  for (std::vector<LSA*>::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      if (*i != lsa)
+        {
+          IndexLinkData (*i);
+        }
+    }
+}
+
+uint64_t
+LSDB::NewVersion ()
+{
+  m_version = ++g_lsdbVersion;
+  return m_version;
 }
 
 void
 LSDB::Print (std::ostream &os) const
 {
-  LSDBMap_t::const_iterator ci;
+  std::vector<LSA*> lsas;
+  GetSortedLSAs (lsas);
   std::cout << "const iterator\n";
-  for (ci = m_database.begin (); ci != m_database.end (); ci ++)
+  for (std::vector<LSA*>::const_iterator ci = lsas.begin (); ci != lsas.end (); ci ++)
     {
-      os << "IPv4 Address = " << ci->first << std::endl;
-      ci->second->Print (os);
+      os << "IPv4 Address = " << (*ci)->GetLinkStateId () << std::endl;
+      (*ci)->Print (os);
     }
 }
 
@@ -475,47 +719,117 @@ LSDB::GetNumExtLSAs () const
   return m_extdatabase.size ();
 }
 
+void
+LSDB::GetLinkStateIds (std::vector<Ipv4Address>& ids) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<LSA*> lsas;
+  GetSortedLSAs (lsas);
+  ids.clear ();
+  ids.reserve (lsas.size ());
+  for (std::vector<LSA*>::const_iterator i = lsas.begin (); i != lsas.end (); i++)
+    {
+      ids.push_back ((*i)->GetLinkStateId ());
+    }
+}
+
+void
+LSDB::GetLSAs (std::vector<LSA*>& lsas) const
+{
+  NS_LOG_FUNCTION (this);
+  GetSortedLSAs (lsas);
+}
+
+void
+LSDB::GetSortedLSAs (std::vector<LSA*>& lsas) const
+{
+  lsas.assign (m_database.begin (), m_database.end ());
+  if (!m_sorted)
+    {
+      std::sort (lsas.begin (), lsas.end (), [] (const LSA* a, const LSA* b) {
+        return a->GetLinkStateId () < b->GetLinkStateId ();
+      });
+    }
+}
+
+std::size_t
+LSDB::GetMemoryFootprint () const
+{
+  std::size_t bytes = (m_database.capacity () + m_extdatabase.capacity ()) * sizeof (LSA*) +
+    GetHashMapFootprint (m_index) + GetHashMapFootprint (m_linkDataIndex);
+  for (const LSA* lsa : m_database)
+    {
+      bytes += lsa->GetMemoryFootprint ();
+    }
+  for (const LSA* lsa : m_extdatabase)
+    {
+      bytes += lsa->GetMemoryFootprint ();
+    }
+  return bytes;
+}
+
+LSDB*
+LSDB::Copy () const
+{
+  NS_LOG_FUNCTION (this);
+  LSDB* copy = new LSDB ();
+  copy->m_database.reserve (m_database.size ());
+  copy->m_index.reserve (m_index.size ());
+  copy->m_linkDataIndex.reserve (m_linkDataIndex.size ());
+  for (std::vector<LSA*>::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      Ptr<LSA> lsa = Create<LSA> (**i);
+      copy->Insert ((*i)->GetLinkStateId (), lsa);
+      lsa->SetSequenceNumber ((*i)->GetSequenceNumber ());
+    }
+  for (std::vector<LSA*>::const_iterator i = m_extdatabase.begin ();
+       i != m_extdatabase.end (); i++)
+    {
+      Ptr<LSA> lsa = Create<LSA> (**i);
+      copy->Insert ((*i)->GetLinkStateId (), lsa);
+      lsa->SetSequenceNumber ((*i)->GetSequenceNumber ());
+    }
+  return copy;
+}
+
+Ptr<LSDB>
+LSDB::Clone () const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<LSDB> clone = Create<LSDB> ();
+  clone->m_database = m_database;
+  clone->m_index = m_index;
+  clone->m_linkDataIndex = m_linkDataIndex;
+  clone->m_sorted = m_sorted;
+  clone->m_linkDataShared = m_linkDataShared;
+  clone->m_extdatabase = m_extdatabase;
+  clone->m_version = m_version;
+  for (std::vector<LSA*>::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      (*i)->Ref ();
+    }
+  for (std::vector<LSA*>::const_iterator i = m_extdatabase.begin ();
+       i != m_extdatabase.end (); i++)
+    {
+      (*i)->Ref ();
+    }
+  return clone;
+}
+
 LSA*
 LSDB::GetLSA (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
-//
-// Look up an LSA by its address.
-//
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
-    {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
-    }
-  return 0;
+  LSDBIndex_t::const_iterator i = m_index.find (addr.Get ());
+  return i == m_index.end () ? 0 : i->second;
 }
 
 LSA*
 LSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
-//
-// Look up an LSA by its address.
-//
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
-    {
-      LSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
-        {
-          LinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == LinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
-        }
-    }
-  return 0;
+  LSDBIndex_t::const_iterator i = m_linkDataIndex.find (addr.Get ());
+  return i == m_linkDataIndex.end () ? 0 : i->second;
 }
 
 } // namespace ns3
@@ -12,8 +12,10 @@
 
 #include <list>
 #include <map>
+#include <memory>
 #include <queue>
 #include <stdint.h>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -21,6 +23,8 @@ namespace ns3
 
 const uint32_t DISTINFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
+class VertexArena;
+
 /**
  * \ingroup globalrouting
  *
@@ -46,6 +50,10 @@ const uint32_t DISTINFINITY = 0xffffffff; //!< "infinite" distance between nodes
  * Vertex objects in the SPF tree, along with the details of the link
  * records that connect them provide the information required to construct the
  * required routes.
+ *
+ * A vertex of a VertexArena has a dense id, and its children are linked in
+ * the flat arrays of the arena rather than in lists of their own; the first
+ * root exits are kept in the vertex itself, as a vertex seldom has more.
  */
 class Vertex
 {
@@ -99,7 +107,8 @@ class Vertex
     /**
      * @brief Destroy an Vertex (Shortest Path First Vertex).
      *
-     * The children vertices of the Vertex are recursively deleted.
+     * The children vertices of the Vertex are recursively deleted, unless the
+     * Vertex belongs to a VertexArena, which releases its vertices at once.
      *
      * @see Vertex::Vertex ()
      */
@@ -428,32 +437,17 @@ class Vertex
     uint32_t GetNChildren(void) const;
 
     /**
-     * @brief Get a borrowed Vertex pointer to the specified child of "this"
-     * Vertex.
+     * @brief Call a function on each child of "this" Vertex, in the order the
+     * children were added.
      *
-     * Each router node in the simulation is associated with an Vertex object.
-     * When calculating routes, each of these routers is, in turn, chosen as the
-     * "root" of the calculation and routes to all of the other routers are
-     * eventually saved in the routing tables of each of the chosen nodes.
+     * The links to the children live in the arena of the vertex, so a walk
+     * over the children of all the vertices of a tree is linear in its edges.
      *
-     * The "Root" vertex is then the Vertex representing the router that is
-     * having its routing tables set and is the root of the SPF tree.  Each vertex
-     * in the SPF tree can have a number of children that represent host or
-     * network routes available via that vertex.
-     *
-     * This method the number of children of "this" Vertex (which reside in
-     * the SPF tree.
-     *
-     * @see Vertex::GetNChildren
-     * @param n The index (from 0 to the number of children minus 1) of the
-     * child Vertex to return.
-     * @warning The pointer returned by GetChild () is a borrowed pointer.  You
-     * do not have any ownership of the underlying object and must not delete
-     * that object.
-     * @returns A pointer to the specified child Vertex (which resides in the
-     * SPF tree).
+     * @tparam F callable on a Vertex*
+     * @param f the function, which may add children to the vertices
      */
-    Vertex* GetChild(uint32_t n) const;
+    template <typename F>
+    void ForEachChild(F f) const;
 
     /**
      * @brief Get a borrowed Vertex pointer to the specified child of "this"
@@ -473,9 +467,8 @@ class Vertex
      * the SPF tree.
      *
      * @see Vertex::GetNChildren
-     * @warning Ownership of the pointer added to the children of "this"
-     * Vertex is transferred to the "this" Vertex.  You must not delete the
-     * (now) child Vertex after calling this method.
+     * @warning Only the vertices of a VertexArena have children, and "this"
+     * Vertex and the child must belong to the same arena.
      * @param child A pointer to the Vertex (which resides in the SPF tree) to
      * be added to the list of children of "this" Vertex.
      * @returns The number of children of "this" Vertex after the addition of
@@ -483,6 +476,12 @@ class Vertex
      */
     uint32_t AddChild(Vertex* child);
 
+    /**
+     * @returns the dense id of "this" Vertex in its arena, from 0 in the order
+     * of allocation
+     */
+    uint32_t GetIndex(void) const;
+
     /**
      * @brief Set the value of the VertexProcessed flag
      *
@@ -516,14 +515,51 @@ class Vertex
     uint32_t m_distanceFromRoot;                    //!< Distance from root node
     int32_t m_rootOif;                              //!< root Output Interface
     Ipv4Address m_nextHop;                          //!< next hop
-    typedef std::list<NodeExit_t> ListOfNodeExit_t; //!< container of Exit nodes
-    ListOfNodeExit_t m_ecmpRootExits; //!< store the multiple root's exits for supporting ECMP
-    typedef std::list<Vertex*> ListOfVertex_t; //!< container of Vertexes
-    ListOfVertex_t m_parents;                  //!< parent list
-    ListOfVertex_t m_children;                 //!< Children list
+    typedef std::vector<NodeExit_t> ListOfNodeExit_t; //!< container of Exit nodes
+    static const uint32_t N_INLINE_EXITS = 2;         //!< root exits kept in the vertex
+    NodeExit_t m_inlineExits[N_INLINE_EXITS];         //!< the first root exits, for ECMP
+    ListOfNodeExit_t m_moreExits;                     //!< the root exits after the inline ones
+    uint32_t m_nExits;                                //!< number of root exits
+    typedef std::vector<Vertex*> ListOfVertex_t; //!< container of Vertexes
+    ListOfVertex_t m_parents;                    //!< parent list
+    VertexArena* m_arena;                        //!< the arena of the vertex, if it is pooled
+    uint32_t m_index;                            //!< dense id of the vertex in its arena
+    uint32_t m_firstChild;                       //!< first child link in the arena, or NO_LINK
+    uint32_t m_lastChild;                        //!< last child link in the arena, or NO_LINK
+    uint32_t m_nChildren;                        //!< number of children
     bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF
                             //!< computation
 
+    /**
+     * @param i the index of a root exit
+     * @returns the root exit
+     */
+    NodeExit_t& GetExit(uint32_t i);
+
+    /**
+     * @param i the index of a root exit
+     * @returns the root exit
+     */
+    const NodeExit_t& GetExit(uint32_t i) const;
+
+    /**
+     * @brief Append a root exit.
+     * @param exit the root exit
+     */
+    void AppendExit(const NodeExit_t& exit);
+
+    /**
+     * @brief Make a vertex of an arena an initialized Vertex again.
+     *
+     * The lists keep their storage, so a reused vertex does not allocate.
+     *
+     * @param lsa The Link State Advertisement used for finding initial values.
+     * @param index the dense id of the vertex in its arena
+     */
+    void Reset(LSA* lsa, uint32_t index);
+
+    friend class VertexArena;
+
     /**
      * @brief The Vertex copy construction is disallowed.  There's no need for
      * it and a compiler provided shallow copy would be wrong.
@@ -549,6 +585,105 @@ class Vertex
     friend std::ostream& operator<<(std::ostream& os, const Vertex::ListOfVertex_t& vs);
 };
 
+/**
+ * @brief Storage for the vertices of SPF computations.
+ *
+ * The vertices are kept in chunks that outlive the computations: Clear ()
+ * releases all the vertices at once, without running their destructors, and
+ * the next computation reuses them along with the storage of their parent and
+ * root exit lists.  A vertex allocated from an arena must not be deleted, and
+ * the pointers to it are invalid once the arena is cleared.
+ *
+ * The vertices are numbered densely in the order of allocation, and the arena
+ * keeps the links from the vertices to their children in one flat array: a
+ * vertex holds its first and last link, and a link the child and the next
+ * link of the same parent.  A vertex has a link from each of its parents.
+ */
+class VertexArena
+{
+  public:
+    VertexArena();
+    ~VertexArena();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    VertexArena(const VertexArena&) = delete;
+    VertexArena& operator=(const VertexArena&) = delete;
+
+    /**
+     * @brief Get a vertex initialized as by Vertex (lsa).
+     * @param lsa The Link State Advertisement used for finding initial values.
+     * @returns a vertex owned by the arena
+     */
+    Vertex* Allocate(LSA* lsa);
+
+    /**
+     * @brief Release all the vertices allocated since the last call.
+     */
+    void Clear();
+
+    /**
+     * @returns the number of vertices allocated since the last Clear ()
+     */
+    uint32_t GetSize() const;
+
+    /**
+     * @returns the number of vertices the arena can hold without allocating
+     */
+    uint32_t GetCapacity() const;
+
+    /**
+     * @param index the dense id of a vertex allocated since the last Clear ()
+     * @returns the vertex
+     */
+    Vertex* Get(uint32_t index) const;
+
+    /**
+     * @brief Clear the VertexProcessed flag of all the vertices in use, in
+     * one pass over their ids.
+     */
+    void ClearProcessed();
+
+    /**
+     * @returns the number of bytes of the vertices and of the child links
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    friend class Vertex;
+
+    /// a link from a vertex to one of its children
+    struct ChildLink
+    {
+        uint32_t child; //!< the dense id of the child
+        uint32_t next;  //!< the next link of the same parent, or NO_LINK
+    };
+
+    /// the end of the links of a vertex
+    static const uint32_t NO_LINK = 0xffffffff;
+
+    /**
+     * @brief Link a child to the end of the children of a vertex.
+     * @param parent the vertex
+     * @param child the child
+     */
+    void LinkChild(Vertex* parent, Vertex* child);
+
+    static const uint32_t CHUNK_SIZE = 256;          //!< vertices per chunk
+    std::vector<std::unique_ptr<Vertex[]>> m_chunks; //!< the storage
+    uint32_t m_size;                                 //!< vertices in use
+    std::vector<ChildLink> m_childLinks;             //!< the links to the children
+};
+
+template <typename F>
+void
+Vertex::ForEachChild(F f) const
+{
+    for (uint32_t l = m_firstChild; l != VertexArena::NO_LINK; l = m_arena->m_childLinks[l].next)
+    {
+        f(m_arena->Get(m_arena->m_childLinks[l].child));
+    }
+}
+
 /**
  * @brief The Link State DataBase (LSDB) of the DGR Route Manager.
  *
@@ -560,7 +695,9 @@ class Vertex
  * also export their own LSAs.
  *
  * This class implements a searchable database of LSAs gathered from every
- * router in the simulation.
+ * router in the simulation.  The router and network LSAs are stored in a
+ * vector, and hashed by link state ID and by the link data of their transit
+ * network records, so that both lookups take constant time.
  */
 class LSDB : public Database
 {
@@ -586,8 +723,12 @@ class LSDB : public Database
      * @brief Insert an IP address / Link State Advertisement pair into the Link
      * State Database.
      *
-     * The IPV4 address and the LSA given as parameters are converted
-     * to an STL pair and are inserted into the database map.
+     * The LSA is appended to the database and indexed by the IPV4 address and
+     * by the link data of its transit network records.  An LSA whose address
+     * is in the database already replaces the stored one in place, and the
+     * database releases the stored one.  The database holds a reference on
+     * the LSA, which it may share with others, and stamps it with a new
+     * sequence number.
      *
      * @see LSA
      * @see Ipv4Address
@@ -595,14 +736,14 @@ class LSDB : public Database
      * ID.
      * @param lsa A pointer to the Link State Advertisement for the router.
      */
-    void Insert(Ipv4Address addr, LSA* lsa);
+    void Insert(Ipv4Address addr, Ptr<LSA> lsa);
 
     /**
      * @brief Look up the Link State Advertisement associated with the given
      * link state ID (address).
      *
-     * The database map is searched for the given IPV4 address and corresponding
-     * LSA is returned.
+     * The database index is searched for the given IPV4 address and
+     * corresponding LSA is returned.
      *
      * @see LSA
      * @see Ipv4Address
@@ -612,17 +753,37 @@ class LSDB : public Database
      * by the IP address addr.
      */
     LSA* GetLSA(Ipv4Address addr) const;
+
+    /**
+     * @brief Remove and release the router or network Link State Advertisement
+     * of the given link state ID (address), if any.
+     *
+     * @param addr The link state ID of the LSA.
+     * @returns true if an LSA was removed
+     */
+    bool Remove(Ipv4Address addr);
+
+    /**
+     * @brief Remove and release all the External Link State Advertisements of an
+     * advertising router.
+     *
+     * @param advertisingRouter the router ID of the router
+     * @returns the number of LSAs removed
+     */
+    uint32_t RemoveExtLSAs(Ipv4Address advertisingRouter);
+
     /**
      * @brief Look up the Link State Advertisement associated with the given
      * link state ID (address).  This is a variation of the GetLSA call
      * to allow the LSA to be found by matching addr with the LinkData field
-     * of the TransitNetwork link record.
+     * of the TransitNetwork link record.  If several LSAs match, the one with
+     * the lowest link state ID is returned.
      *
      * @see GetLSA
      * @param addr The IP address associated with the LSA.  Typically the Router
+     * ID.
      * @returns A pointer to the Link State Advertisement for the router specified
      * by the IP address addr.
-     * ID.
      */
     LSA* GetLSAByLinkData(Ipv4Address addr) const;
 
@@ -631,8 +792,9 @@ class LSDB : public Database
      *
      * This function walks the database and resets the status flags of all of the
      * contained Link State Advertisements to LSA_SPF_NOT_EXPLORED.  This is done
-     * prior to each SPF calculation to reset the state of the Vertex structures
-     * that will reference the LSAs during the calculation.
+     * prior to an SPF calculation that keeps its state in the LSAs; the SPF
+     * engines of the module stamp the status of the vertices with their run
+     * instead, and never call it.
      *
      * @see LSA
      * @see Vertex
@@ -659,6 +821,65 @@ class LSDB : public Database
      */
     uint32_t GetNumExtLSAs() const;
 
+    /**
+     * @brief Get the link state IDs of all the router and network Link State
+     * Advertisements of the database.
+     *
+     * @param ids filled with the link state IDs, in ascending order
+     */
+    void GetLinkStateIds(std::vector<Ipv4Address>& ids) const;
+
+    /**
+     * @brief Get all the router and network Link State Advertisements of the
+     * database.
+     *
+     * @param lsas filled with the LSAs, in ascending order of link state ID
+     */
+    void GetLSAs(std::vector<LSA*>& lsas) const;
+
+    /**
+     * @brief Get the version of the content of the database.
+     *
+     * Every insertion or removal gives the database a version no database
+     * had before, so a structure derived from a database can tell whether it
+     * is still current.  Only a Clone () that was not changed yet shares the
+     * version of its database.  The LSAs stored since a version are the ones whose
+     * sequence number is higher.  The versions only grow, and the check is
+     * one compare, inline.
+     *
+     * @returns the version of the database
+     */
+    uint64_t GetVersion() const;
+
+    /**
+     * @brief Get the memory the database takes.
+     *
+     * The LSAs are counted whole, with their link records, even when a
+     * Clone () shares them with the database.
+     *
+     * @returns the number of bytes of the LSAs, the arrays and the indices
+     */
+    std::size_t GetMemoryFootprint() const;
+
+    /**
+     * @brief Make a deep copy of the database, for a route computation that
+     * must not share the SPF status of the LSAs.
+     *
+     * @returns a new database holding copies of all the LSAs, owned by the caller
+     */
+    LSDB* Copy() const;
+
+    /**
+     * @brief Make a copy of the database that shares its LSAs, for a writer
+     * that must not change a version that readers hold.
+     *
+     * The copy takes a reference on every LSA rather than copying it, and has
+     * the version of the database until it is changed.
+     *
+     * @returns the copy
+     */
+    Ptr<LSDB> Clone() const;
+
     /**
      * \brief Print the database
      *
@@ -680,15 +901,51 @@ class LSDB : public Database
     LSDB& operator=(LSDB& lsdb);
 
   private:
-    typedef std::map<Ipv4Address, LSA*>
-        LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
-    typedef std::pair<Ipv4Address, LSA*>
-        LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
+    /// index of Link State Advertisements by IPv4 address (Ipv4Address::Get ())
+    typedef std::unordered_map<uint32_t, LSA*> LSDBIndex_t;
+
+    /**
+     * @brief Get the router and network LSAs in ascending order of link state ID.
+     * @param lsas filled with the LSAs
+     */
+    void GetSortedLSAs(std::vector<LSA*>& lsas) const;
+
+    /**
+     * @brief Index an LSA of m_database by the link data of its transit
+     * network records.
+     * @param lsa the LSA
+     */
+    void IndexLinkData(LSA* lsa);
 
-    LSDBMap_t m_database;            //!< database of IPv4 addresses / Link State Advertisements
+    /**
+     * @brief Drop an LSA of m_database from the link data index, handing its
+     * entries to the other LSAs that advertise the same link data.
+     * @param lsa the LSA
+     */
+    void UnindexLinkData(LSA* lsa);
+
+    /**
+     * @brief Give the content of the database a new version.
+     * @returns the version, which is also the sequence number of an LSA
+     * stored in that version
+     */
+    uint64_t NewVersion();
+
+    std::vector<LSA*> m_database;    //!< router and network LSAs, in insertion order
+    LSDBIndex_t m_index;             //!< LSAs of m_database by link state ID
+    LSDBIndex_t m_linkDataIndex;     //!< LSAs of m_database by transit network link data
+    bool m_sorted;                   //!< m_database is in ascending order of link state ID
+    bool m_linkDataShared;           //!< two LSAs ever advertised the same link data
     std::vector<LSA*> m_extdatabase; //!< database of External Link State Advertisements
+    uint64_t m_version;              //!< version of the content
 };
 
+inline uint64_t
+LSDB::GetVersion() const
+{
+    return m_version;
+}
+
 } // namespace ns3
 
 #endif /* LSDB_H */
\ No newline at end of file
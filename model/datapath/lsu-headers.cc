@@ -0,0 +1,415 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "lsu-headers.h"
+
+#include "ns3/assert.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+
+namespace ns3
+{
+
+/// version of the header
+static const uint8_t LSU_VERSION = 1;
+/// flag of a withdrawn LSA
+static const uint8_t LSU_WITHDRAWN_FLAG = 0x1;
+/// size of the header before its entries
+static const uint32_t LSU_HEADER_SIZE = 4;
+/// size of an LSU entry before its records and attached routers
+static const uint32_t LSU_LSA_SIZE = 28;
+/// size of a link record of an LSU entry
+static const uint32_t LSU_RECORD_SIZE = 12;
+
+/**
+ * \param p two bytes in network order
+ * \return their value
+ */
+static uint16_t
+ReadNetworkU16(const uint8_t* p)
+{
+    return (uint16_t(p[0]) << 8) | p[1];
+}
+
+/**
+ * \param p four bytes in network order
+ * \return their value
+ */
+static uint32_t
+ReadNetworkU32(const uint8_t* p)
+{
+    return (uint32_t(ReadNetworkU16(p)) << 16) | ReadNetworkU16(p + 2);
+}
+
+LsuHeader::LsuHeader()
+    : m_command(LSU)
+{
+}
+
+TypeId
+LsuHeader::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::LsuHeader")
+                            .SetParent<Header>()
+                            .SetGroupName("Romam")
+                            .AddConstructor<LsuHeader>();
+    return tid;
+}
+
+TypeId
+LsuHeader::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+void
+LsuHeader::Print(std::ostream& os) const
+{
+    os << (m_command == LSU ? "LSU" : m_command == LSACK ? "LSAck" : "Hello");
+    if (m_command == HELLO)
+    {
+        os << " from " << m_routerId;
+    }
+    for (Ipv4Address neighbor : m_neighbors)
+    {
+        os << " | Neighbor: " << neighbor;
+    }
+    for (const LsuEntry& entry : m_lsas)
+    {
+        os << " | " << entry.lsa->GetLinkStateId() << " from " << entry.lsa->GetAdvertisingRouter()
+           << ", Seq: " << entry.seq << (entry.withdrawn ? " withdrawn" : "");
+    }
+    for (const LsuSummary& summary : m_summaries)
+    {
+        os << " | " << summary.linkStateId << " from " << summary.advertisingRouter
+           << ", Seq: " << summary.seq << (summary.withdrawn ? " withdrawn" : "");
+    }
+    for (const LsAckEntry& entry : m_acks)
+    {
+        os << " | " << entry.linkStateId << " from " << entry.advertisingRouter
+           << ", Seq: " << entry.seq;
+    }
+}
+
+uint32_t
+LsuHeader::GetSerializedSize() const
+{
+    if (m_command == HELLO)
+    {
+        return LSU_HEADER_SIZE + 4 + m_neighbors.size() * 4;
+    }
+    uint32_t size = LSU_HEADER_SIZE + m_acks.size() * GetAckSize() +
+                    m_summaries.size() * LSU_LSA_SIZE + m_bodyBytes.size();
+    for (const LsuEntry& entry : m_lsas)
+    {
+        size += GetLsaSize(entry);
+    }
+    return size;
+}
+
+uint32_t
+LsuHeader::GetLsaSize(const LsuEntry& entry)
+{
+    if (entry.withdrawn)
+    {
+        return LSU_LSA_SIZE;
+    }
+    return LSU_LSA_SIZE + entry.lsa->GetNLinkRecords() * LSU_RECORD_SIZE +
+           entry.lsa->GetNAttachedRouters() * 4;
+}
+
+uint32_t
+LsuHeader::GetAckSize()
+{
+    return 4 + 4 + 4 + 4;
+}
+
+void
+LsuHeader::Serialize(Buffer::Iterator start) const
+{
+    Buffer::Iterator i = start;
+    i.WriteU8(uint8_t(m_command));
+    i.WriteU8(LSU_VERSION);
+    i.WriteHtonU16(GetNEntries());
+    if (m_command == HELLO)
+    {
+        i.WriteHtonU32(m_routerId.Get());
+        for (Ipv4Address neighbor : m_neighbors)
+        {
+            i.WriteHtonU32(neighbor.Get());
+        }
+        return;
+    }
+    for (const LsuEntry& entry : m_lsas)
+    {
+        const LSA* lsa = PeekPointer(entry.lsa);
+        uint16_t nRecords = entry.withdrawn ? 0 : lsa->GetNLinkRecords();
+        uint16_t nAttached = entry.withdrawn ? 0 : lsa->GetNAttachedRouters();
+        i.WriteU8(lsa->GetLSType());
+        i.WriteU8(entry.withdrawn ? LSU_WITHDRAWN_FLAG : 0);
+        i.WriteHtonU16(nRecords);
+        i.WriteHtonU16(nAttached);
+        i.WriteU16(0);
+        i.WriteHtonU32(entry.seq);
+        i.WriteHtonU32(lsa->GetLinkStateId().Get());
+        i.WriteHtonU32(lsa->GetAdvertisingRouter().Get());
+        i.WriteHtonU32(lsa->GetNetworkLSANetworkMask().Get());
+        i.WriteHtonU32(lsa->GetNode() ? lsa->GetNode()->GetId() : 0);
+        for (uint16_t j = 0; j < nRecords; j++)
+        {
+            const LinkRecord* record = lsa->GetLinkRecord(j);
+            i.WriteHtonU32(record->GetLinkId().Get());
+            i.WriteHtonU32(record->GetLinkData().Get());
+            i.WriteHtonU16(record->GetMetric());
+            i.WriteHtonU16(record->GetLinkType());
+        }
+        for (uint16_t j = 0; j < nAttached; j++)
+        {
+            i.WriteHtonU32(lsa->GetAttachedRouter(j).Get());
+        }
+    }
+    // a received LSU, whose bodies are already in network order
+    for (std::size_t n = 0; n < m_summaries.size(); n++)
+    {
+        const LsuSummary& summary = m_summaries[n];
+        const LsuBody& body = m_bodies[n];
+        i.WriteU8(summary.type);
+        i.WriteU8(summary.withdrawn ? LSU_WITHDRAWN_FLAG : 0);
+        i.WriteHtonU16(body.nRecords);
+        i.WriteHtonU16(body.nAttached);
+        i.WriteU16(0);
+        i.WriteHtonU32(summary.seq);
+        i.WriteHtonU32(summary.linkStateId.Get());
+        i.WriteHtonU32(summary.advertisingRouter.Get());
+        i.WriteHtonU32(body.mask);
+        i.WriteHtonU32(body.nodeId);
+        i.Write(m_bodyBytes.data() + body.offset,
+                body.nRecords * LSU_RECORD_SIZE + body.nAttached * 4u);
+    }
+    for (const LsAckEntry& entry : m_acks)
+    {
+        i.WriteU8(entry.type);
+        i.WriteU8(0);
+        i.WriteU16(0);
+        i.WriteHtonU32(entry.linkStateId.Get());
+        i.WriteHtonU32(entry.advertisingRouter.Get());
+        i.WriteHtonU32(entry.seq);
+    }
+}
+
+uint32_t
+LsuHeader::Deserialize(Buffer::Iterator start)
+{
+    Buffer::Iterator i = start;
+    ClearEntries();
+    if (i.GetRemainingSize() < LSU_HEADER_SIZE)
+    {
+        return 0;
+    }
+    uint8_t command = i.ReadU8();
+    if ((command != LSU && command != LSACK && command != HELLO) || i.ReadU8() != LSU_VERSION)
+    {
+        return 0;
+    }
+    m_command = Command(command);
+    uint16_t nEntries = i.ReadNtohU16();
+    if (m_command == HELLO)
+    {
+        if (i.GetRemainingSize() < 4 + nEntries * 4u)
+        {
+            return 0;
+        }
+        m_routerId = Ipv4Address(i.ReadNtohU32());
+        for (uint16_t n = 0; n < nEntries; n++)
+        {
+            m_neighbors.push_back(Ipv4Address(i.ReadNtohU32()));
+        }
+        return GetSerializedSize();
+    }
+    if (m_command == LSACK)
+    {
+        if (i.GetRemainingSize() < nEntries * GetAckSize())
+        {
+            return 0;
+        }
+        for (uint16_t n = 0; n < nEntries; n++)
+        {
+            LsAckEntry entry;
+            entry.type = i.ReadU8();
+            i.Next(3);
+            entry.linkStateId = Ipv4Address(i.ReadNtohU32());
+            entry.advertisingRouter = Ipv4Address(i.ReadNtohU32());
+            entry.seq = i.ReadNtohU32();
+            m_acks.push_back(entry);
+        }
+        return GetSerializedSize();
+    }
+    // the bodies are copied as they are, and decoded on demand
+    m_summaries.reserve(nEntries);
+    m_bodies.reserve(nEntries);
+    m_bodyBytes.reserve(i.GetRemainingSize());
+    for (uint16_t n = 0; n < nEntries; n++)
+    {
+        if (i.GetRemainingSize() < LSU_LSA_SIZE)
+        {
+            return 0;
+        }
+        LsuSummary summary;
+        LsuBody body;
+        summary.type = i.ReadU8();
+        summary.withdrawn = (i.ReadU8() & LSU_WITHDRAWN_FLAG) != 0;
+        body.nRecords = i.ReadNtohU16();
+        body.nAttached = i.ReadNtohU16();
+        i.Next(2);
+        summary.seq = i.ReadNtohU32();
+        summary.linkStateId = Ipv4Address(i.ReadNtohU32());
+        summary.advertisingRouter = Ipv4Address(i.ReadNtohU32());
+        body.mask = i.ReadNtohU32();
+        body.nodeId = i.ReadNtohU32();
+        uint32_t bytes = body.nRecords * LSU_RECORD_SIZE + body.nAttached * 4u;
+        if (body.nodeId >= NodeList::GetNNodes() || i.GetRemainingSize() < bytes)
+        {
+            return 0;
+        }
+        body.offset = m_bodyBytes.size();
+        m_bodyBytes.resize(body.offset + bytes);
+        i.Read(m_bodyBytes.data() + body.offset, bytes);
+        m_summaries.push_back(summary);
+        m_bodies.push_back(body);
+    }
+    return GetSerializedSize();
+}
+
+LsuEntry
+LsuHeader::DecodeLsa(uint32_t n) const
+{
+    NS_ASSERT_MSG(n < m_summaries.size(), "No received LSA instance " << n);
+    const LsuSummary& summary = m_summaries[n];
+    const LsuBody& body = m_bodies[n];
+    LsuEntry entry;
+    entry.seq = summary.seq;
+    entry.withdrawn = summary.withdrawn;
+    entry.lsa = Create<LSA>();
+    entry.lsa->SetLSType(static_cast<LSA::LSType>(summary.type));
+    entry.lsa->SetLinkStateId(summary.linkStateId);
+    entry.lsa->SetAdvertisingRouter(summary.advertisingRouter);
+    entry.lsa->SetNetworkLSANetworkMask(Ipv4Mask(body.mask));
+    entry.lsa->SetNode(NodeList::GetNode(body.nodeId));
+    const uint8_t* p = m_bodyBytes.data() + body.offset;
+    for (uint16_t j = 0; j < body.nRecords; j++, p += LSU_RECORD_SIZE)
+    {
+        Ipv4Address linkId(ReadNetworkU32(p));
+        Ipv4Address linkData(ReadNetworkU32(p + 4));
+        uint16_t metric = ReadNetworkU16(p + 8);
+        auto type = static_cast<LinkRecord::LinkType>(ReadNetworkU16(p + 10));
+        entry.lsa->AddLinkRecord(new LinkRecord(type, linkId, linkData, metric));
+    }
+    for (uint16_t j = 0; j < body.nAttached; j++, p += 4)
+    {
+        entry.lsa->AddAttachedRouter(Ipv4Address(ReadNetworkU32(p)));
+    }
+    return entry;
+}
+
+void
+LsuHeader::ClearEntries()
+{
+    m_lsas.clear();
+    m_acks.clear();
+    m_neighbors.clear();
+    m_summaries.clear();
+    m_bodies.clear();
+    m_bodyBytes.clear();
+}
+
+void
+LsuHeader::SetCommand(Command command)
+{
+    m_command = command;
+    ClearEntries();
+}
+
+LsuHeader::Command
+LsuHeader::GetCommand() const
+{
+    return m_command;
+}
+
+void
+LsuHeader::AddLsa(const LsuEntry& entry)
+{
+    NS_ASSERT_MSG(m_command == LSU, "Only an LSU carries LSAs");
+    NS_ASSERT_MSG(m_summaries.empty(), "A received LSU carries no LSA added");
+    NS_ASSERT_MSG(GetNEntries() < MAX_ENTRIES, "Too many entries for an LSU");
+    m_lsas.push_back(entry);
+}
+
+const std::vector<LsuEntry>&
+LsuHeader::GetLsas() const
+{
+    return m_lsas;
+}
+
+const std::vector<LsuSummary>&
+LsuHeader::GetLsaSummaries() const
+{
+    return m_summaries;
+}
+
+void
+LsuHeader::AddAck(const LsAckEntry& entry)
+{
+    NS_ASSERT_MSG(m_command == LSACK, "Only an LSAck carries acknowledgments");
+    NS_ASSERT_MSG(GetNEntries() < MAX_ENTRIES, "Too many entries for an LSAck");
+    m_acks.push_back(entry);
+}
+
+const std::vector<LsAckEntry>&
+LsuHeader::GetAcks() const
+{
+    return m_acks;
+}
+
+void
+LsuHeader::SetRouterId(Ipv4Address routerId)
+{
+    m_routerId = routerId;
+}
+
+Ipv4Address
+LsuHeader::GetRouterId() const
+{
+    return m_routerId;
+}
+
+void
+LsuHeader::AddNeighbor(Ipv4Address routerId)
+{
+    NS_ASSERT_MSG(m_command == HELLO, "Only a Hello carries neighbors");
+    NS_ASSERT_MSG(GetNEntries() < MAX_ENTRIES, "Too many entries for a Hello");
+    m_neighbors.push_back(routerId);
+}
+
+const std::vector<Ipv4Address>&
+LsuHeader::GetNeighbors() const
+{
+    return m_neighbors;
+}
+
+uint32_t
+LsuHeader::GetNEntries() const
+{
+    if (m_command == HELLO)
+    {
+        return m_neighbors.size();
+    }
+    return m_command == LSU ? m_lsas.size() + m_summaries.size() : m_acks.size();
+}
+
+std::ostream&
+operator<<(std::ostream& os, const LsuHeader& h)
+{
+    h.Print(os);
+    return os;
+}
+
+} // namespace ns3
@@ -0,0 +1,270 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef LSU_HEADERS_H
+#define LSU_HEADERS_H
+
+#include "lsa.h"
+
+#include "ns3/header.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ptr.h"
+
+#include <stdint.h>
+#include <vector>
+
+// ---Link State Update / Link State Acknowledgment / Hello Header---
+//   | 8 bite  | 8 bite  | 8 bite  | 8 bite  |
+//   | commond | version |      entries      |
+//
+// ---LSU entry---
+//   |  type   |  flags  |     records       |
+//   |     attached      |      Empty        |
+//   |            sequence number            |
+//   |             link state ID             |
+//   |          advertising router           |
+//   |             network mask              |
+//   |                node ID                |
+//   |   link ID, link data, metric, type    |  (12 bytes per record)
+//                      ...
+//   |            attached router            |
+//                      ...
+//
+// ---LSAck entry---
+//   |  type   |            Empty            |
+//   |             link state ID             |
+//   |          advertising router           |
+//   |            sequence number            |
+//
+// ---Hello, after the header---
+//   |               router ID               |
+//   |          neighbor router ID           |  (one per entry)
+//                      ...
+//
+// A withdrawn LSA has the withdrawn flag, and neither records nor attached
+// routers.
+
+namespace ns3
+{
+
+/**
+ * \ingroup romam
+ * \brief An LSA flooded in a Link State Update, with the sequence number of
+ * its instance
+ */
+struct LsuEntry
+{
+    Ptr<LSA> lsa;   //!< the LSA, with no records if it is withdrawn
+    uint32_t seq;   //!< the sequence number of the instance
+    bool withdrawn; //!< the advertising router no longer originates the LSA
+};
+
+/**
+ * \ingroup romam
+ * \brief The fields of an LSA instance of a received LSU that identify it,
+ * read without its link records and attached routers
+ */
+struct LsuSummary
+{
+    uint8_t type;                  //!< LSA::LSType
+    Ipv4Address linkStateId;       //!< link state ID
+    Ipv4Address advertisingRouter; //!< advertising router
+    uint32_t seq;                  //!< the sequence number of the instance
+    bool withdrawn;                //!< the advertising router no longer originates the LSA
+};
+
+/**
+ * \ingroup romam
+ * \brief The acknowledgment of an LSA instance
+ */
+struct LsAckEntry
+{
+    uint8_t type;                  //!< LSA::LSType
+    Ipv4Address linkStateId;       //!< link state ID
+    Ipv4Address advertisingRouter; //!< advertising router
+    uint32_t seq;                  //!< the sequence number of the instance
+};
+
+/**
+ * \ingroup romam
+ * \brief The Link State Update (LSU), Link State Acknowledgment (LSAck) and
+ * Hello of the distributed OSPF control plane, each carrying a batch of
+ * entries: LSA instances, acknowledgments, or the router IDs of the neighbors
+ * the sender of a Hello heard from
+ *
+ * An LSU refers to the LSAs it sends, which the flooding database of the
+ * sender shares with it, and writes their records straight from the LSAs.
+ * A received LSU decodes the LSAs lazily: Deserialize () only reads the
+ * LsuSummary of every instance, and keeps the bytes of their bodies, which
+ * DecodeLsa () turns into an LSA for the instances the receiver keeps, so
+ * that a duplicate or older instance is dropped without being parsed.
+ */
+class LsuHeader : public Header
+{
+  public:
+    LsuHeader();
+
+    /// the kind of the header
+    enum Command
+    {
+        LSU = 0x1,   //!< a batch of LSA instances
+        LSACK = 0x2, //!< a batch of acknowledgments
+        HELLO = 0x3, //!< the router ID of the sender and of its neighbors
+    };
+
+    /**
+     * \brief Get the type ID.
+     * \return The object TypeId
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \brief Return the instance type identifier
+     * \return Instance type ID.
+     */
+    TypeId GetInstanceTypeId() const override;
+
+    void Print(std::ostream& os) const override;
+
+    /**
+     * \brief Get the serialized size of the packet
+     * \return size
+     */
+    uint32_t GetSerializedSize() const override;
+
+    /**
+     * \brief Serialize the packet.
+     * \param start Buffer iterator
+     */
+    void Serialize(Buffer::Iterator start) const override;
+
+    /**
+     * \brief Deserialize the packet
+     * \param start Buffer iterator
+     * \return size of the packet
+     */
+    uint32_t Deserialize(Buffer::Iterator start) override;
+
+    /**
+     * \param command the kind of the header, which drops its entries
+     */
+    void SetCommand(Command command);
+
+    /**
+     * \return the kind of the header
+     */
+    Command GetCommand() const;
+
+    /**
+     * \brief Add an LSA instance to an LSU.
+     * \param entry the instance
+     */
+    void AddLsa(const LsuEntry& entry);
+
+    /**
+     * \return the LSA instances added to an LSU
+     */
+    const std::vector<LsuEntry>& GetLsas() const;
+
+    /**
+     * \return the LSA instances of a received LSU, undecoded
+     */
+    const std::vector<LsuSummary>& GetLsaSummaries() const;
+
+    /**
+     * \brief Decode an LSA instance of a received LSU.
+     * \param n the index of the instance in GetLsaSummaries ()
+     * \return the instance, with a new LSA
+     */
+    LsuEntry DecodeLsa(uint32_t n) const;
+
+    /**
+     * \brief Add an acknowledgment to an LSAck.
+     * \param entry the acknowledgment
+     */
+    void AddAck(const LsAckEntry& entry);
+
+    /**
+     * \return the acknowledgments of an LSAck
+     */
+    const std::vector<LsAckEntry>& GetAcks() const;
+
+    /**
+     * \param routerId the router ID of the sender of a Hello
+     */
+    void SetRouterId(Ipv4Address routerId);
+
+    /**
+     * \return the router ID of the sender of a Hello
+     */
+    Ipv4Address GetRouterId() const;
+
+    /**
+     * \brief Add a neighbor the sender of a Hello heard from.
+     * \param routerId the router ID of the neighbor
+     */
+    void AddNeighbor(Ipv4Address routerId);
+
+    /**
+     * \return the router IDs of the neighbors the sender of a Hello heard from
+     */
+    const std::vector<Ipv4Address>& GetNeighbors() const;
+
+    /**
+     * \return the number of entries
+     */
+    uint32_t GetNEntries() const;
+
+    /**
+     * \param entry an LSA instance
+     * \return the bytes it takes in an LSU
+     */
+    static uint32_t GetLsaSize(const LsuEntry& entry);
+
+    /**
+     * \return the bytes an acknowledgment takes in an LSAck
+     */
+    static uint32_t GetAckSize();
+
+    /// the most entries of a header
+    static const uint32_t MAX_ENTRIES = 0xffff;
+
+  private:
+    /// the fields of a received LSA instance beyond its LsuSummary
+    struct LsuBody
+    {
+        uint32_t mask;      //!< network mask
+        uint32_t nodeId;    //!< the node of the LSA
+        uint16_t nRecords;  //!< number of link records
+        uint16_t nAttached; //!< number of attached routers
+        uint32_t offset;    //!< first byte of the records and routers in m_bodyBytes
+    };
+
+    /**
+     * \brief Drop the entries, sent and received.
+     */
+    void ClearEntries();
+
+    Command m_command;              //!< the kind of the header
+    std::vector<LsuEntry> m_lsas;   //!< the LSA instances added to an LSU
+    std::vector<LsAckEntry> m_acks; //!< the acknowledgments of an LSAck
+
+    std::vector<LsuSummary> m_summaries; //!< the LSA instances of a received LSU
+    std::vector<LsuBody> m_bodies;       //!< the rest of them, by instance
+    std::vector<uint8_t> m_bodyBytes;    //!< their records and routers, in network order
+
+    Ipv4Address m_routerId;               //!< the sender of a Hello
+    std::vector<Ipv4Address> m_neighbors; //!< the neighbors the sender of a Hello heard from
+};
+
+/**
+ * \brief Stream insertion operator
+ *
+ * \param os the reference to the output stream
+ * \param h the LSU or LSAck header
+ * \returns the reference to the output stream
+ */
+std::ostream& operator<<(std::ostream& os, const LsuHeader& h);
+
+} // namespace ns3
+
+#endif /* LSU_HEADERS_H */
@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "neighbor-fsm.h"
+
+#include "ns3/assert.h"
+
+namespace ns3
+{
+
+// the initializers of the tables are in the scope of the class
+constexpr NeighborFsm::Transition NeighborFsm::TRANSITIONS[N_STATES][N_EVENTS] = {
+    // HELLO_RECEIVED, TWO_WAY_RECEIVED, ONE_WAY_RECEIVED, NEGOTIATION_DONE,
+    // EXCHANGE_DONE, LOADING_DONE, INACTIVITY_TIMER, KILL_NBR
+    {
+        // DOWN
+        {INIT, RESET_INACTIVITY},
+        {DOWN, NO_ACTION},
+        {DOWN, NO_ACTION},
+        {DOWN, NO_ACTION},
+        {DOWN, NO_ACTION},
+        {DOWN, NO_ACTION},
+        {DOWN, NO_ACTION},
+        {DOWN, NO_ACTION},
+    },
+    {
+        // INIT, which becomes adjacent on a point-to-point link
+        {INIT, RESET_INACTIVITY},
+        {EXSTART, NO_ACTION},
+        {INIT, NO_ACTION},
+        {INIT, NO_ACTION},
+        {INIT, NO_ACTION},
+        {INIT, NO_ACTION},
+        {DOWN, NEIGHBOR_DOWN},
+        {DOWN, NEIGHBOR_DOWN},
+    },
+    {
+        // TWO_WAY
+        {TWO_WAY, RESET_INACTIVITY},
+        {TWO_WAY, NO_ACTION},
+        {INIT, NO_ACTION},
+        {TWO_WAY, NO_ACTION},
+        {TWO_WAY, NO_ACTION},
+        {TWO_WAY, NO_ACTION},
+        {DOWN, NEIGHBOR_DOWN},
+        {DOWN, NEIGHBOR_DOWN},
+    },
+    {
+        // EXSTART
+        {EXSTART, RESET_INACTIVITY},
+        {EXSTART, NO_ACTION},
+        {INIT, CLEAR_ADJACENCY},
+        {EXCHANGE, START_EXCHANGE},
+        {EXSTART, NO_ACTION},
+        {EXSTART, NO_ACTION},
+        {DOWN, NEIGHBOR_DOWN},
+        {DOWN, NEIGHBOR_DOWN},
+    },
+    {
+        // EXCHANGE
+        {EXCHANGE, RESET_INACTIVITY},
+        {EXCHANGE, NO_ACTION},
+        {INIT, CLEAR_ADJACENCY},
+        {EXCHANGE, NO_ACTION},
+        {LOADING, NO_ACTION},
+        {EXCHANGE, NO_ACTION},
+        {DOWN, NEIGHBOR_DOWN},
+        {DOWN, NEIGHBOR_DOWN},
+    },
+    {
+        // LOADING
+        {LOADING, RESET_INACTIVITY},
+        {LOADING, NO_ACTION},
+        {INIT, CLEAR_ADJACENCY},
+        {LOADING, NO_ACTION},
+        {LOADING, NO_ACTION},
+        {FULL, ADJACENCY_FULL},
+        {DOWN, NEIGHBOR_DOWN},
+        {DOWN, NEIGHBOR_DOWN},
+    },
+    {
+        // FULL
+        {FULL, RESET_INACTIVITY},
+        {FULL, NO_ACTION},
+        {INIT, CLEAR_ADJACENCY},
+        {FULL, NO_ACTION},
+        {FULL, NO_ACTION},
+        {FULL, NO_ACTION},
+        {DOWN, NEIGHBOR_DOWN},
+        {DOWN, NEIGHBOR_DOWN},
+    },
+};
+
+constexpr NeighborFsm::Handler NeighborFsm::HANDLERS[N_ACTIONS] = {
+    &NeighborFsm::KeepInactivity,  // NO_ACTION
+    &NeighborFsm::ResetInactivity, // RESET_INACTIVITY
+    &NeighborFsm::KeepInactivity,  // START_EXCHANGE
+    &NeighborFsm::KeepInactivity,  // ADJACENCY_FULL
+    &NeighborFsm::KeepInactivity,  // CLEAR_ADJACENCY
+    &NeighborFsm::StopInactivity,  // NEIGHBOR_DOWN
+};
+
+/// the names of the states
+static const char* const STATE_NAMES[NeighborFsm::N_STATES] =
+    {"Down", "Init", "TwoWay", "ExStart", "Exchange", "Loading", "Full"};
+
+NeighborFsm::NeighborFsm()
+    : m_deadInterval(0),
+      m_deadline(-1),
+      m_state(DOWN)
+{
+}
+
+void
+NeighborFsm::SetDeadInterval(Time deadInterval)
+{
+    m_deadInterval = deadInterval.GetNanoSeconds();
+}
+
+NeighborFsm::Action
+NeighborFsm::Dispatch(Event event, Time now)
+{
+    NS_ASSERT(event < N_EVENTS);
+    const Transition& transition = TRANSITIONS[m_state][event];
+    (this->*HANDLERS[transition.action])(now.GetNanoSeconds());
+    m_state = transition.next;
+    return transition.action;
+}
+
+NeighborFsm::State
+NeighborFsm::GetState() const
+{
+    return m_state;
+}
+
+bool
+NeighborFsm::IsInactive(Time now) const
+{
+    return m_deadline >= 0 && now.GetNanoSeconds() >= m_deadline;
+}
+
+const char*
+NeighborFsm::GetStateName(State state)
+{
+    return state < N_STATES ? STATE_NAMES[state] : "Unknown";
+}
+
+void
+NeighborFsm::ResetInactivity(int64_t now)
+{
+    m_deadline = now + m_deadInterval;
+}
+
+void
+NeighborFsm::StopInactivity(int64_t now)
+{
+    m_deadline = -1;
+}
+
+void
+NeighborFsm::KeepInactivity(int64_t now)
+{
+}
+
+std::ostream&
+operator<<(std::ostream& os, NeighborFsm::State state)
+{
+    return os << NeighborFsm::GetStateName(state);
+}
+
+} // namespace ns3
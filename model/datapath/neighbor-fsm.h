@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef NEIGHBOR_FSM_H
+#define NEIGHBOR_FSM_H
+
+#include "ns3/nstime.h"
+
+#include <ostream>
+#include <stdint.h>
+
+namespace ns3
+{
+
+/**
+ * \ingroup romam
+ * \brief The state machine of an OSPF neighbor, after RFC 2328 section 10.
+ *
+ * The machine is a state and the deadline of its inactivity timer, and
+ * allocates nothing: a transition looks its next state and its action up in a
+ * constexpr table indexed by the state and the event.  The machine runs the
+ * part of the action on its timer, through a constexpr table of handlers, and
+ * returns the action, so its owner runs the part on the adjacency, such as
+ * the database exchange or the release of the retransmit list.  The owner
+ * checks the deadline with IsInactive () on its own timer, which serves all
+ * its neighbors.
+ *
+ * The links are point-to-point: a neighbor goes from Init straight to
+ * ExStart, and TwoWay is only kept for the networks whose routers do not all
+ * become adjacent.
+ */
+class NeighborFsm
+{
+  public:
+    /// the states of the neighbor
+    enum State : uint8_t
+    {
+        DOWN,     //!< no Hello received lately
+        INIT,     //!< a Hello received, which does not list the router
+        TWO_WAY,  //!< bidirectional, not to become adjacent
+        EXSTART,  //!< bidirectional, negotiating the database exchange
+        EXCHANGE, //!< exchanging the databases
+        LOADING,  //!< requesting the LSAs the exchange found missing
+        FULL,     //!< adjacent, the databases are synchronized
+        N_STATES, //!< the number of states
+    };
+
+    /// the events of the neighbor
+    enum Event : uint8_t
+    {
+        HELLO_RECEIVED,   //!< a Hello came from the neighbor
+        TWO_WAY_RECEIVED, //!< the Hello of the neighbor lists the router
+        ONE_WAY_RECEIVED, //!< the Hello of the neighbor does not list the router
+        NEGOTIATION_DONE, //!< the database exchange may start
+        EXCHANGE_DONE,    //!< the neighbor has the database of the router
+        LOADING_DONE,     //!< the router has the LSAs it was missing
+        INACTIVITY_TIMER, //!< no Hello came for the dead interval
+        KILL_NBR,         //!< the link to the neighbor went down
+        N_EVENTS,         //!< the number of events
+    };
+
+    /// what a transition asks of the machine and of its owner
+    enum Action : uint8_t
+    {
+        NO_ACTION,        //!< nothing
+        RESET_INACTIVITY, //!< start the inactivity timer again
+        START_EXCHANGE,   //!< send the database to the neighbor
+        ADJACENCY_FULL,   //!< the adjacency is up
+        CLEAR_ADJACENCY,  //!< drop what the neighbor has to acknowledge
+        NEIGHBOR_DOWN,    //!< stop the inactivity timer, and clear the adjacency
+        N_ACTIONS,        //!< the number of actions
+    };
+
+    NeighborFsm();
+
+    /**
+     * \param deadInterval the time without a Hello after which the neighbor
+     * is down
+     */
+    void SetDeadInterval(Time deadInterval);
+
+    /**
+     * \brief Handle an event.
+     * \param event the event
+     * \param now the current time
+     * \return the action of the transition, whose part on the timer is done
+     */
+    Action Dispatch(Event event, Time now);
+
+    /**
+     * \return the state
+     */
+    State GetState() const;
+
+    /**
+     * \param now the current time
+     * \return true if the inactivity timer runs and expired
+     */
+    bool IsInactive(Time now) const;
+
+    /**
+     * \param state a state
+     * \return its name
+     */
+    static const char* GetStateName(State state);
+
+  private:
+    /// a handler of the machine for an action
+    typedef void (NeighborFsm::*Handler)(int64_t now);
+
+    /// the next state and the action of a transition
+    struct Transition
+    {
+        State next;    //!< the next state
+        Action action; //!< the action
+    };
+
+    /**
+     * \brief Start the inactivity timer again.
+     * \param now the current time in ns
+     */
+    void ResetInactivity(int64_t now);
+
+    /**
+     * \brief Stop the inactivity timer.
+     * \param now the current time in ns
+     */
+    void StopInactivity(int64_t now);
+
+    /**
+     * \brief Leave the timer as it is.
+     * \param now the current time in ns
+     */
+    void KeepInactivity(int64_t now);
+
+    /// the transitions, by state and event
+    static const Transition TRANSITIONS[N_STATES][N_EVENTS];
+    /// the handlers of the actions, by action
+    static const Handler HANDLERS[N_ACTIONS];
+
+    int64_t m_deadInterval; //!< the dead interval, in ns
+    int64_t m_deadline;     //!< the expiry of the inactivity timer in ns, -1 if it is stopped
+    State m_state;          //!< the state
+};
+
+/**
+ * \brief Stream insertion operator
+ *
+ * \param os the reference to the output stream
+ * \param state the state of a neighbor
+ * \returns the reference to the output stream
+ */
+std::ostream& operator<<(std::ostream& os, NeighborFsm::State state);
+
+} // namespace ns3
+
+#endif /* NEIGHBOR_FSM_H */
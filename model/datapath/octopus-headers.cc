@@ -2,13 +2,17 @@
 
 #include "octopus-headers.h"
 
+#include "ns3/assert.h"
 #include "ns3/log.h"
 
+#include <cstring>
+
 namespace ns3
 {
 
 OctopusHeader::OctopusHeader()
-    : m_reward(0.0)
+    : m_command(ACK),
+      m_reward(0.0)
 {
 }
 
@@ -31,12 +35,26 @@ OctopusHeader::GetInstanceTypeId() const
 void
 OctopusHeader::Print(std::ostream& os) const
 {
+    if (m_command == ACK_BATCH)
+    {
+        for (auto i = m_batch.begin(); i != m_batch.end(); i++)
+        {
+            os << "destination: " << i->destination.Get() << ", reward: " << i->reward
+               << ", count: " << i->count << "; ";
+        }
+        return;
+    }
     os << "destination: " << m_destination.Get() << ", reward: " << m_reward;
 }
 
 uint32_t
 OctopusHeader::GetSerializedSize() const
 {
+    if (m_command == ACK_BATCH)
+    {
+        // command, number of entries, then destination, reward and count per entry
+        return 3 + 14 * m_batch.size();
+    }
     return 13;
 }
 
@@ -45,6 +63,19 @@ OctopusHeader::Serialize(Buffer::Iterator start) const
 {
     Buffer::Iterator i = start;
     i.WriteU8(uint8_t(m_command));
+    if (m_command == ACK_BATCH)
+    {
+        i.WriteHtonU16(m_batch.size());
+        for (auto j = m_batch.begin(); j != m_batch.end(); j++)
+        {
+            uint64_t reward;
+            std::memcpy(&reward, &j->reward, sizeof(reward));
+            i.WriteHtonU32(j->destination.Get());
+            i.WriteHtonU64(reward);
+            i.WriteHtonU16(j->count);
+        }
+        return;
+    }
     i.WriteHtonU32(m_destination.Get());
     i.WriteHtonU64(m_reward);
 }
@@ -54,6 +85,19 @@ OctopusHeader::Deserialize(Buffer::Iterator start)
 {
     Buffer::Iterator i = start;
     m_command = i.ReadU8();
+    if (m_command == ACK_BATCH)
+    {
+        uint16_t n = i.ReadNtohU16();
+        m_batch.resize(n);
+        for (uint16_t j = 0; j < n; j++)
+        {
+            m_batch[j].destination.Set(i.ReadNtohU32());
+            uint64_t reward = i.ReadNtohU64();
+            std::memcpy(&m_batch[j].reward, &reward, sizeof(reward));
+            m_batch[j].count = i.ReadNtohU16();
+        }
+        return GetSerializedSize();
+    }
     m_destination.Set(i.ReadNtohU32());
     m_reward = i.ReadNtohU64();
     return GetSerializedSize();
@@ -95,6 +139,29 @@ OctopusHeader::SetReward(double reward)
     m_reward = reward;
 }
 
+void
+OctopusHeader::AddBatchEntry(Ipv4Address destination, double reward, uint16_t count)
+{
+    BatchEntry entry;
+    entry.destination = destination;
+    entry.reward = reward;
+    entry.count = count;
+    m_batch.push_back(entry);
+}
+
+uint16_t
+OctopusHeader::GetNBatchEntries() const
+{
+    return m_batch.size();
+}
+
+const OctopusHeader::BatchEntry&
+OctopusHeader::GetBatchEntry(uint16_t i) const
+{
+    NS_ASSERT(i < m_batch.size());
+    return m_batch[i];
+}
+
 std::ostream&
 operator<<(std::ostream& os, const OctopusHeader& h)
 {
@@ -7,7 +7,7 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/packet.h"
 
-#include <list>
+#include <vector>
 
 namespace ns3
 {
@@ -57,7 +57,16 @@ class OctopusHeader : public Header
     enum Command_e
     {
         ACK = 0x1,
-        REQUEST = 0x2
+        REQUEST = 0x2,
+        ACK_BATCH = 0x3 //!< several rewards, see AddBatchEntry ()
+    };
+
+    /// a reward carried by an ACK_BATCH message
+    struct BatchEntry
+    {
+        Ipv4Address destination; //!< destination the reward applies to
+        double reward;           //!< mean reward of the coalesced ACKs
+        uint16_t count;          //!< number of coalesced ACKs
     };
 
     Command_e GetCommand() const;
@@ -67,10 +76,30 @@ class OctopusHeader : public Header
     double GetReward() const;
     void SetReward(double reward);
 
+    /**
+     * \brief Add a reward to an ACK_BATCH message.
+     * \param destination destination the reward applies to
+     * \param reward mean reward of the coalesced ACKs
+     * \param count number of coalesced ACKs
+     */
+    void AddBatchEntry(Ipv4Address destination, double reward, uint16_t count);
+
+    /**
+     * \return the number of rewards of an ACK_BATCH message
+     */
+    uint16_t GetNBatchEntries() const;
+
+    /**
+     * \param i the entry index
+     * \return the i-th reward of an ACK_BATCH message
+     */
+    const BatchEntry& GetBatchEntry(uint16_t i) const;
+
   private:
-    uint8_t m_command;
-    Ipv4Address m_destination;
-    double m_reward; //!< command type
+    uint8_t m_command;               //!< command type
+    Ipv4Address m_destination;       //!< destination of an ACK
+    double m_reward;                 //!< reward of an ACK
+    std::vector<BatchEntry> m_batch; //!< rewards of an ACK_BATCH
 };
 
 /**
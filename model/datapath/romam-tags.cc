@@ -6,6 +6,7 @@
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/stats-module.h"
+#include "ns3/timestamp-tag.h"
 #include "romam-tags.h"
 #include "ns3/log.h"
 
@@ -430,4 +431,338 @@ NSTag::Print (std::ostream &os) const
   os << "ns = " << m_ns;
 }
 
+RewardTag::RewardTag ()
+  : m_reward (0.0),
+    m_count (0)
+{
+}
+
+void
+RewardTag::SetDestination (Ipv4Address destination)
+{
+  m_destination = destination;
+}
+
+Ipv4Address
+RewardTag::GetDestination (void) const
+{
+  return m_destination;
+}
+
+void
+RewardTag::SetReward (double reward)
+{
+  m_reward = reward;
+}
+
+double
+RewardTag::GetReward (void) const
+{
+  return m_reward;
+}
+
+void
+RewardTag::SetCount (uint16_t count)
+{
+  m_count = count;
+}
+
+uint16_t
+RewardTag::GetCount (void) const
+{
+  return m_count;
+}
+
+TypeId
+RewardTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("RewardTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("romam")
+    .AddConstructor<RewardTag> ();
+  return tid;
+}
+
+TypeId
+RewardTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+RewardTag::GetSerializedSize (void) const
+{
+  return 14;     // 14 bytes
+}
+
+void
+RewardTag::Serialize (TagBuffer i) const
+{
+  i.WriteU32 (m_destination.Get ());
+  i.WriteDouble (m_reward);
+  i.WriteU16 (m_count);
+}
+
+void
+RewardTag::Deserialize (TagBuffer i)
+{
+  m_destination.Set (i.ReadU32 ());
+  m_reward = i.ReadDouble ();
+  m_count = i.ReadU16 ();
+}
+
+void
+RewardTag::Print (std::ostream &os) const
+{
+  os << "destination = " << m_destination << ", reward = " << m_reward
+     << ", count = " << m_count;
+}
+
+//----------------------------------------------------------------------
+//-- RomamMetaTag
+//------------------------------------------------------
+RomamMetaTag::RomamMetaTag ()
+  : m_budget (0),
+    m_timestamp (0),
+    m_distance (0),
+    m_fields (0)
+{
+}
+
+void
+RomamMetaTag::SetBudget (uint32_t budget)
+{
+  m_budget = budget;
+  m_fields |= BUDGET;
+}
+
+uint32_t
+RomamMetaTag::GetBudget (void) const
+{
+  return m_budget;
+}
+
+bool
+RomamMetaTag::HasBudget (void) const
+{
+  return m_fields & BUDGET;
+}
+
+void
+RomamMetaTag::SetTimestamp (Time timestamp)
+{
+  m_timestamp = timestamp.GetTimeStep ();
+}
+
+Time
+RomamMetaTag::GetTimestamp (void) const
+{
+  return TimeStep (m_timestamp);
+}
+
+void
+RomamMetaTag::SetDistance (uint32_t distance)
+{
+  m_distance = distance;
+  m_fields |= DISTANCE;
+}
+
+uint32_t
+RomamMetaTag::GetDistance (void) const
+{
+  return m_distance;
+}
+
+bool
+RomamMetaTag::HasDistance (void) const
+{
+  return m_fields & DISTANCE;
+}
+
+void
+RomamMetaTag::SetFlag (bool flag)
+{
+  m_fields = flag ? m_fields | FLAG : m_fields & ~FLAG;
+}
+
+bool
+RomamMetaTag::GetFlag (void) const
+{
+  return m_fields & FLAG;
+}
+
+void
+RomamMetaTag::SetSampled (bool sampled)
+{
+  m_fields = sampled ? m_fields & ~UNSAMPLED : m_fields | UNSAMPLED;
+}
+
+bool
+RomamMetaTag::IsSampled (void) const
+{
+  return !(m_fields & UNSAMPLED);
+}
+
+bool
+RomamMetaTag::Sample (uint64_t key, double rate)
+{
+  if (rate >= 1)
+    {
+      return true;
+    }
+  // the finalizer of splitmix64, so that close keys hash far apart
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ULL;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebULL;
+  key ^= key >> 31;
+  return (key >> 11) * 0x1.0p-53 < rate;
+}
+
+void
+RomamMetaTag::SetPriority (bool priority)
+{
+  m_fields |= PRIORITY;
+  m_fields = priority ? m_fields | PRIORITY_VALUE : m_fields & ~PRIORITY_VALUE;
+}
+
+bool
+RomamMetaTag::GetPriority (void) const
+{
+  return m_fields & PRIORITY_VALUE;
+}
+
+void
+RomamMetaTag::ClearPriority (void)
+{
+  m_fields &= ~(PRIORITY | PRIORITY_VALUE);
+}
+
+bool
+RomamMetaTag::HasPriority (void) const
+{
+  return m_fields & PRIORITY;
+}
+
+bool
+RomamMetaTag::Peek (Ptr<const Packet> packet, RomamMetaTag &tag)
+{
+  if (packet->PeekPacketTag (tag))
+    {
+      return true;
+    }
+  tag = RomamMetaTag ();
+  bool found = false;
+  BudgetTag budgetTag;
+  if (packet->PeekPacketTag (budgetTag))
+    {
+      tag.SetBudget (budgetTag.GetBudget ());
+      found = true;
+    }
+  TimestampTag timeTag;
+  if (packet->PeekPacketTag (timeTag))
+    {
+      tag.SetTimestamp (timeTag.GetTimestamp ());
+      found = true;
+    }
+  DistTag distTag;
+  if (packet->PeekPacketTag (distTag))
+    {
+      tag.SetDistance (distTag.GetDistance ());
+      found = true;
+    }
+  FlagTag flagTag;
+  if (packet->PeekPacketTag (flagTag))
+    {
+      tag.SetFlag (flagTag.GetFlag ());
+      found = true;
+    }
+  PriorityTag priorityTag;
+  if (packet->PeekPacketTag (priorityTag))
+    {
+      tag.SetPriority (priorityTag.GetPriority ());
+      found = true;
+    }
+  return found;
+}
+
+bool
+RomamMetaTag::operator== (const RomamMetaTag &other) const
+{
+  return m_budget == other.m_budget && m_timestamp == other.m_timestamp
+         && m_distance == other.m_distance && m_fields == other.m_fields;
+}
+
+TypeId
+RomamMetaTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RomamMetaTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("romam")
+    .AddConstructor<RomamMetaTag> ();
+  return tid;
+}
+
+TypeId
+RomamMetaTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+RomamMetaTag::GetSerializedSize (void) const
+{
+  return 17;     // 17 bytes
+}
+
+void
+RomamMetaTag::Serialize (TagBuffer i) const
+{
+  i.WriteU32 (m_budget);
+  i.WriteU64 (m_timestamp);
+  i.WriteU32 (m_distance);
+  i.WriteU8 (m_fields);
+}
+
+void
+RomamMetaTag::Deserialize (TagBuffer i)
+{
+  m_budget = i.ReadU32 ();
+  m_timestamp = i.ReadU64 ();
+  m_distance = i.ReadU32 ();
+  m_fields = i.ReadU8 ();
+}
+
+void
+RomamMetaTag::Print (std::ostream &os) const
+{
+  os << "budget = ";
+  if (HasBudget ())
+    {
+      os << m_budget;
+    }
+  else
+    {
+      os << "none";
+    }
+  os << ", timestamp = " << GetTimestamp () << ", distance = ";
+  if (HasDistance ())
+    {
+      os << m_distance;
+    }
+  else
+    {
+      os << "none";
+    }
+  os << ", flag = " << GetFlag () << ", sampled = " << IsSampled () << ", priority = ";
+  if (HasPriority ())
+    {
+      os << GetPriority ();
+    }
+  else
+    {
+      os << "none";
+    }
+}
+
 }
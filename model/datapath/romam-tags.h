@@ -6,6 +6,7 @@
 #include "ns3/tag.h"
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
 #include <list>
 
 namespace ns3 {
@@ -150,6 +151,13 @@ private:
 class PriorityTag : public Tag
 {
 public:
+    /**
+     * \brief The IPv4 ToS byte of the packets sent with a priority, the
+     * Expedited Forwarding DSCP, which queue discs can classify on without
+     * looking for the tag
+     */
+    static constexpr uint8_t PRIORITY_TOS = 0xb8;
+
     PriorityTag ();
 
     /**
@@ -277,6 +285,247 @@ private:
     bool m_ns;  
 };
 
+/**
+ * \brief This class implements a tag that piggybacks an Octopus
+ * reward on a data packet sent back to the neighbor the reward is for.
+*/
+class RewardTag : public Tag
+{
+public:
+    RewardTag ();
+
+    /**
+     * \brief Set the destination the reward applies to
+     * \param destination the destination address
+    */
+    void SetDestination (Ipv4Address destination);
+
+    /**
+     * \brief Get the destination the reward applies to
+     * \return the destination address
+    */
+    Ipv4Address GetDestination (void) const;
+
+    /**
+     * \brief Set the mean reward of the coalesced ACKs
+     * \param reward the reward
+    */
+    void SetReward (double reward);
+
+    /**
+     * \brief Get the mean reward of the coalesced ACKs
+     * \return the reward
+    */
+    double GetReward (void) const;
+
+    /**
+     * \brief Set the number of coalesced ACKs
+     * \param count the number of ACKs
+    */
+    void SetCount (uint16_t count);
+
+    /**
+     * \brief Get the number of coalesced ACKs
+     * \return the number of ACKs
+    */
+    uint16_t GetCount (void) const;
+
+    /**
+     * \brief Get the Type ID
+     * \return the object TypeId
+    */
+    static TypeId GetTypeId (void);
+
+    // inherited function, no need to doc.
+    TypeId GetInstanceTypeId (void) const override;
+    
+    // inherited function, no need to doc.
+    uint32_t GetSerializedSize (void) const override;
+
+    // inherited function, no need to doc.
+    void Serialize (TagBuffer i) const override;
+
+    // inherited function, no need to doc.
+    void Deserialize (TagBuffer i) override;
+
+    // inherited function, no need to doc.
+    void Print (std::ostream &os) const override;
+
+private:
+    Ipv4Address m_destination;
+    double m_reward;
+    uint16_t m_count;
+};
+
+/**
+ * \brief This class implements one tag that carries all the metadata of a
+ * delay guaranteed data packet: its budget, origin timestamp, distance,
+ * flag and priority.
+ *
+ * The separate BudgetTag, TimestampTag, DistTag, FlagTag and PriorityTag cost
+ * a scan of the packet tag list each; this tag costs one.  Peek () still
+ * reads the separate tags of a packet without this tag.
+*/
+class RomamMetaTag : public Tag
+{
+public:
+    RomamMetaTag ();
+
+    /**
+     * \brief Set the tag's budget
+     * \param budget the delay budget in microsecond
+    */
+    void SetBudget (uint32_t budget);
+
+    /**
+     * \brief Get the tag's budget
+     * \return the budget in microsecond, 0 if none is set
+    */
+    uint32_t GetBudget (void) const;
+
+    /**
+     * \return true if a budget is set
+    */
+    bool HasBudget (void) const;
+
+    /**
+     * \brief Set the time the packet was sent at
+     * \param timestamp the timestamp
+    */
+    void SetTimestamp (Time timestamp);
+
+    /**
+     * \brief Get the time the packet was sent at
+     * \return the timestamp, 0 if none is set
+    */
+    Time GetTimestamp (void) const;
+
+    /**
+     * \brief Set the distance to the destination of the last hop
+     * \param distance the distance
+    */
+    void SetDistance (uint32_t distance);
+
+    /**
+     * \brief Get the distance to the destination of the last hop
+     * \return the distance, 0 if none is set
+    */
+    uint32_t GetDistance (void) const;
+
+    /**
+     * \return true if a distance is set
+    */
+    bool HasDistance (void) const;
+
+    /**
+     * \brief Set the flag the sink monitors the delay of
+     * \param flag the flag
+    */
+    void SetFlag (bool flag);
+
+    /**
+     * \return the flag, false if none is set
+    */
+    bool GetFlag (void) const;
+
+    /**
+     * \brief Set whether the sink logs the delay of the flagged packet, or
+     * only counts it
+     * \param sampled whether the packet is sampled
+    */
+    void SetSampled (bool sampled);
+
+    /**
+     * \return whether the packet is sampled, true if none is set
+    */
+    bool IsSampled (void) const;
+
+    /**
+     * \brief Decide whether a packet is sampled, from a hash of its key, so
+     * that the same packets are sampled in every run
+     * \param key the key of the packet, its flow and sequence number say
+     * \param rate the fraction of the packets sampled, from 0 to 1
+     * \return true if the packet is sampled
+    */
+    static bool Sample (uint64_t key, double rate);
+
+    /**
+     * \brief Set the priority
+     * \param priority the priority
+    */
+    void SetPriority (bool priority);
+
+    /**
+     * \return the priority, false if none is set
+    */
+    bool GetPriority (void) const;
+
+    /**
+     * \brief Unset the priority, so the queue discs take the packet as best
+     * effort
+    */
+    void ClearPriority (void);
+
+    /**
+     * \return true if a priority is set, which the queue discs take as a
+     * priority packet whatever its value, like a PriorityTag
+    */
+    bool HasPriority (void) const;
+
+    /**
+     * \brief Read the metadata of a packet, from its RomamMetaTag or else
+     * from its separate tags
+     * \param packet the packet
+     * \param tag set to the metadata found
+     * \return true if the packet carries a RomamMetaTag or any separate tag
+    */
+    static bool Peek (Ptr<const Packet> packet, RomamMetaTag &tag);
+
+    /**
+     * \param other another tag
+     * \return true if both tags carry the same metadata
+    */
+    bool operator== (const RomamMetaTag &other) const;
+
+    /**
+     * \brief Get the Type ID
+     * \return the object TypeId
+    */
+    static TypeId GetTypeId (void);
+
+    // inherited function, no need to doc.
+    TypeId GetInstanceTypeId (void) const override;
+
+    // inherited function, no need to doc.
+    uint32_t GetSerializedSize (void) const override;
+
+    // inherited function, no need to doc.
+    void Serialize (TagBuffer i) const override;
+
+    // inherited function, no need to doc.
+    void Deserialize (TagBuffer i) override;
+
+    // inherited function, no need to doc.
+    void Print (std::ostream &os) const override;
+
+private:
+    /// bits of m_fields
+    enum Field
+    {
+      BUDGET = 0x01,         //!< a budget is set
+      DISTANCE = 0x02,       //!< a distance is set
+      FLAG = 0x04,           //!< the flag
+      PRIORITY = 0x08,       //!< a priority is set
+      PRIORITY_VALUE = 0x10, //!< the priority
+      UNSAMPLED = 0x20       //!< the packet is not sampled
+    };
+
+    uint32_t m_budget;   //!< budget in microsecond
+    int64_t m_timestamp; //!< timestamp in time steps
+    uint32_t m_distance; //!< distance of the last hop
+    uint8_t m_fields;    //!< Field bits
+};
+
 } // namespace ns3
 
 #endif /* ROMAM_TAGS_H */
\ No newline at end of file
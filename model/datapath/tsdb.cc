@@ -1,259 +1,384 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 
 #include "tsdb.h"
+#include "ns3/abort.h"
 #include "ns3/log.h"
 
+#include <algorithm>
+
 namespace ns3 {
 
 // NS_LOG_COMPONENT_DEFINE ("tsdb");
 
-StatusUnit::StatusUnit ()
-  : m_matrix {{0}},
-    m_state (0)
-{
-}
+//----------------------------------------------------------------------
+//-- TSDB
+//------------------------------------------------------
 
-StatusUnit::~StatusUnit ()
+/**
+ * \brief The status units of a TSDB, whatever their resolution.
+ */
+class TSDB::Table
 {
-}
+public:
+  virtual ~Table ()
+  {
+  }
+  virtual uint32_t GetNStates () const = 0;
+  virtual void SetEstimator (StatusEstimator estimator, uint32_t length) = 0;
+  virtual void Resize (uint32_t nInterfaces) = 0;
+  virtual bool Has (uint32_t iface, uint32_t n_iface) const = 0;
+  virtual void Update (uint32_t iface, uint32_t n_iface, int state) = 0;
+  virtual uint32_t GetEstimateDelayDDR (uint32_t iface, uint32_t n_iface) const = 0;
+  virtual uint32_t GetEstimateDelayDGR (uint32_t iface, uint32_t n_iface) const = 0;
+  virtual uint32_t GetPredictedDelay (uint32_t iface, uint32_t n_iface,
+                                      uint32_t steps) const = 0;
+  virtual uint32_t GetNumStatusUnit (uint32_t iface) const = 0;
+  virtual uint32_t GetNNeighborInterfaces () const = 0;
+  virtual int GetLastState (uint32_t iface, uint32_t n_iface) const = 0;
+  virtual std::size_t GetMemoryFootprint () const = 0;
+  virtual void Print (std::ostream &os) const = 0;
+};
 
-int
-StatusUnit::GetEstimateState () const
+/**
+ * \brief The status units of a TSDB, stored inline in one array.
+ * \tparam Unit the StatusUnit variant
+ */
+template <class Unit>
+class TSDB::UnitTable : public TSDB::Table
 {
-  int counter = m_matrix[m_state][m_state];
-  int ret = m_state;
-  for (int i = 0; i < 10; i ++)
-    {
-      if (m_matrix[m_state][i] > counter)
-        {
-          counter = m_matrix[m_state][i];
-          ret = i;
-        }
-    }
-  return ret;
-}
+public:
+  /**
+   * \param nStates the number of queue occupancy levels of Unit
+   */
+  UnitTable (uint32_t nStates)
+    : m_nStates (nStates),
+      m_nInterfaces (0),
+      m_stride (0)
+  {
+  }
 
-uint32_t
-StatusUnit::GetEstimateDelayDDR () const
+  uint32_t
+  GetNStates () const override
+  {
+    return m_nStates;
+  }
+
+  void
+  SetEstimator (StatusEstimator estimator, uint32_t length) override
+  {
+    m_prototype.SetEstimator (estimator, length);
+    m_nInterfaces = 0;
+    m_stride = 0;
+    m_units.clear ();
+    m_present.clear ();
+  }
+
+  void
+  Resize (uint32_t nInterfaces) override
+  {
+    if (nInterfaces > m_nInterfaces)
+      {
+        Reshape (nInterfaces, m_stride);
+      }
+  }
+
+  bool
+  Has (uint32_t iface, uint32_t n_iface) const override
+  {
+    return Find (iface, n_iface) != nullptr;
+  }
+
+  void
+  Update (uint32_t iface, uint32_t n_iface, int state) override
+  {
+    if (iface >= m_nInterfaces || n_iface >= m_stride)
+      {
+        Reshape (std::max (m_nInterfaces, iface + 1), std::max (m_stride, n_iface + 1));
+      }
+    std::size_t index = static_cast<std::size_t> (iface) * m_stride + n_iface;
+    m_present[index] = 1;
+    m_units[index].Update (state);
+  }
+
+  uint32_t
+  GetEstimateDelayDDR (uint32_t iface, uint32_t n_iface) const override
+  {
+    const Unit* su = Find (iface, n_iface);
+    return su ? su->GetEstimateDelayDDR () : 0;
+  }
+
+  uint32_t
+  GetEstimateDelayDGR (uint32_t iface, uint32_t n_iface) const override
+  {
+    const Unit* su = Find (iface, n_iface);
+    return su ? su->GetEstimateDelayDGR () : 0;
+  }
+
+  uint32_t
+  GetPredictedDelay (uint32_t iface, uint32_t n_iface, uint32_t steps) const override
+  {
+    const Unit* su = Find (iface, n_iface);
+    return su ? su->GetPredictedDelay (steps) : 0;
+  }
+
+  uint32_t
+  GetNNeighborInterfaces () const override
+  {
+    return m_stride;
+  }
+
+  int
+  GetLastState (uint32_t iface, uint32_t n_iface) const override
+  {
+    const Unit* su = Find (iface, n_iface);
+    return su ? su->GetLastState () : -1;
+  }
+
+  uint32_t
+  GetNumStatusUnit (uint32_t iface) const override
+  {
+    if (iface >= m_nInterfaces)
+      {
+        return 0;
+      }
+    auto row = m_present.begin () + static_cast<std::size_t> (iface) * m_stride;
+    return std::count (row, row + m_stride, 1);
+  }
+
+  std::size_t
+  GetMemoryFootprint () const override
+  {
+    std::size_t bytes = sizeof (*this) + m_prototype.GetMemoryFootprint () +
+      m_units.capacity () * sizeof (Unit) + m_present.capacity () * sizeof (uint8_t);
+    for (const Unit& su : m_units)
+      {
+        bytes += su.GetMemoryFootprint ();
+      }
+    return bytes;
+  }
+
+  void
+  Print (std::ostream &os) const override
+  {
+    for (uint32_t i = 0; i < m_nInterfaces; i ++)
+      {
+        if (GetNumStatusUnit (i) == 0)
+          {
+            continue;
+          }
+        os << "Interface = " << i << std::endl;
+        os << "Next_Iface    StatusUnit" << std::endl;
+        for (uint32_t j = 0; j < m_stride; j ++)
+          {
+            const Unit* su = Find (i, j);
+            if (su)
+              {
+                os << j << "    ";
+                su->Print (os);
+              }
+          }
+      }
+  }
+
+private:
+  /**
+   * \param iface the local interface number
+   * \param n_iface the interface number on the neighbor
+   * \return the unit, or nullptr if no state was received yet
+   */
+  const Unit*
+  Find (uint32_t iface, uint32_t n_iface) const
+  {
+    if (iface >= m_nInterfaces || n_iface >= m_stride)
+      {
+        return nullptr;
+      }
+    std::size_t index = static_cast<std::size_t> (iface) * m_stride + n_iface;
+    return m_present[index] ? &m_units[index] : nullptr;
+  }
+
+  /**
+   * \brief Lay the units out again for larger dimensions.
+   * \param nInterfaces the number of local interfaces
+   * \param stride the number of neighbor interfaces per local interface
+   */
+  void
+  Reshape (uint32_t nInterfaces, uint32_t stride)
+  {
+    if (stride == m_stride)
+      {
+        // the rows keep their place, the new ones go at the end
+        m_units.resize (static_cast<std::size_t> (nInterfaces) * stride, m_prototype);
+        m_present.resize (m_units.size (), 0);
+        m_nInterfaces = nInterfaces;
+        return;
+      }
+    std::vector<Unit> units (static_cast<std::size_t> (nInterfaces) * stride, m_prototype);
+    std::vector<uint8_t> present (units.size (), 0);
+    for (uint32_t i = 0; i < m_nInterfaces; i ++)
+      {
+        for (uint32_t j = 0; j < m_stride; j ++)
+          {
+            std::size_t from = static_cast<std::size_t> (i) * m_stride + j;
+            std::size_t to = static_cast<std::size_t> (i) * stride + j;
+            units[to] = m_units[from];
+            present[to] = m_present[from];
+          }
+      }
+    m_units.swap (units);
+    m_present.swap (present);
+    m_nInterfaces = nInterfaces;
+    m_stride = stride;
+  }
+
+  Unit m_prototype;               //!< the unit a new slot starts from
+  uint32_t m_nStates;             //!< number of queue occupancy levels of Unit
+  uint32_t m_nInterfaces;         //!< number of rows
+  uint32_t m_stride;              //!< number of neighbor interfaces per row
+  std::vector<Unit> m_units;      //!< units, at iface * m_stride + n_iface
+  std::vector<uint8_t> m_present; //!< whether the unit of the same index was received
+};
+
+template <uint32_t N>
+TSDB::Table*
+TSDB::CreateTable (bool compact)
 {
-  // std::cout << "current delay: " << GetEstimateDelayDGR () << std::endl;
-  // Print (std::cout);
-  uint32_t ret = 0;
-  int counter = 0;
-  for (int i = 0; i < STATESIZE; i ++)
+  if (compact)
     {
-      ret += m_matrix[m_state][i]* (i);
-      counter += m_matrix[m_state][i];
+      return new TSDB::UnitTable<StatusUnit<N, uint16_t> > (N);
     }
-  return ret*2000/counter;
-}
-uint32_t
-StatusUnit::GetEstimateDelayDGR () const
-{
-  return m_state*2000;
+  return new TSDB::UnitTable<StatusUnit<N, int> > (N);
 }
 
-int
-StatusUnit::GetCurrentState () const
+NS_OBJECT_ENSURE_REGISTERED (TSDB);
+
+TSDB::TSDB ()
+  : m_compact (false),
+    m_estimator (CUMULATIVE_ESTIMATOR),
+    m_estimatorLength (0),
+    m_epoch (0)
 {
-  int counter = m_matrix[m_state][m_state];
-  int ret = m_state;
-  for (int i = 0; i < 10; i ++)
-    {
-      if (m_matrix[m_state][i] > counter)
-        {
-          counter = m_matrix[m_state][i];
-          ret = i;
-        }
-    }
-  return ret;
+  // NS_LOG_FUNCTION (this);
+  SetResolution (10, false);
 }
 
-int
-StatusUnit::GetLastState () const
+TSDB::~TSDB ()
 {
-  return m_state;
+  // NS_LOG_FUNCTION (this);
 }
 
 void
-StatusUnit::Update (int state)
+TSDB::Initialize ()
 {
-  m_matrix[m_state][state] ++;
-  m_state = state;
+  // NS_LOG_FUNCTION (this);
+  SetResolution (GetNStates (), m_compact);
 }
 
 void
-StatusUnit::Print (std::ostream &os) const
+TSDB::SetResolution (uint32_t nStates, bool compact)
 {
-  os << "Last state = " << GetLastState ()
-     << ", Current State = " << GetEstimateState ()
-     << std::endl;
-  os << "current Markov Transition Probability Matrix: "
-     << std::endl;
-  for (int i = 0; i < 10; i ++)
+  switch (nStates)
     {
-      for (int j = 0; j < 10; j ++)
-        {
-          os << m_matrix[i][j];
-          os << " ";
-        }
-      os << std::endl;
+    case 4:
+      m_table.reset (CreateTable<4> (compact));
+      break;
+    case 10:
+      m_table.reset (CreateTable<10> (compact));
+      break;
+    case 16:
+      m_table.reset (CreateTable<16> (compact));
+      break;
+    case 32:
+      m_table.reset (CreateTable<32> (compact));
+      break;
+    default:
+      NS_ABORT_MSG ("Unsupported number of TSDB states: " << nStates);
     }
+  m_compact = compact;
+  m_table->SetEstimator (m_estimator, m_estimatorLength);
+  m_epoch++;
 }
 
-//----------------------------------------------------------------------
-//-- NeighborStatusEntry
-//------------------------------------------------------
-NeighborStatusEntry::NeighborStatusEntry ()
-    : m_database ()
+void
+TSDB::SetEstimator (StatusEstimator estimator, uint32_t length)
 {
+  m_estimator = estimator;
+  m_estimatorLength = length;
+  m_table->SetEstimator (estimator, length);
+  m_epoch++;
 }
 
-NeighborStatusEntry::~NeighborStatusEntry ()
+uint32_t
+TSDB::GetNStates () const
 {
-  m_database.clear ();
+  return m_table->GetNStates ();
 }
 
 void
-NeighborStatusEntry::Insert (uint32_t n_iface, StatusUnit* su)
+TSDB::Resize (uint32_t nInterfaces)
 {
-  NSMap_t::iterator it = m_database.find (n_iface);
-  if (it != m_database.end ())
-    {
-      it->second = su;
-    }
-  else
-    {
-      m_database.insert (NSPair_t (n_iface, su));
-    }
+  m_table->Resize (nInterfaces);
 }
 
-StatusUnit*
-NeighborStatusEntry::GetStatusUnit (uint32_t n_iface) const
+bool
+TSDB::HasStatusUnit (uint32_t iface, uint32_t n_iface) const
 {
-  // NS_LOG_FUNCTION (this << n_iface);
-  //
-  // Look up a SU by it's interface.
-  //
-  NSMap_t::const_iterator ci = m_database.find (n_iface);
-  if (ci != m_database.end ())
-    {
-      return ci->second;
-    }
-  return nullptr;
+  return m_table->Has (iface, n_iface);
 }
 
-
-uint32_t
-NeighborStatusEntry::GetNumStatusUnit () const
+void
+TSDB::Update (uint32_t iface, uint32_t n_iface, int state)
 {
-  return m_database.size ();
+  m_table->Update (iface, n_iface, state);
+  m_epoch++;
 }
 
-void
-NeighborStatusEntry::Print (std::ostream &os) const
+uint32_t
+TSDB::GetEstimateDelayDDR (uint32_t iface, uint32_t n_iface) const
 {
-  os << "Next_Iface    StatusUnit" << std::endl;
-  NSMap_t::const_iterator ci;
-  for (ci = m_database.begin (); ci != m_database.end (); ci ++)
-    {
-      os << ci->first << "    ";
-      ci->second->Print (os);
-    }
+  return m_table->GetEstimateDelayDDR (iface, n_iface);
 }
 
-//----------------------------------------------------------------------
-//-- TSDB
-//------------------------------------------------------
-NS_OBJECT_ENSURE_REGISTERED (TSDB);
-
-TSDB::TSDB ()
-    : m_database ()
+uint32_t
+TSDB::GetEstimateDelayDGR (uint32_t iface, uint32_t n_iface) const
 {
-  // NS_LOG_FUNCTION (this);
+  return m_table->GetEstimateDelayDGR (iface, n_iface);
 }
 
-TSDB::~TSDB ()
+uint32_t
+TSDB::GetPredictedDelay (uint32_t iface, uint32_t n_iface, uint32_t steps) const
 {
-  // NS_LOG_FUNCTION (this);
-  // TSDBMap_t::iterator i;
-  // for (i = m_database.begin (); i != m_database.end (); i ++)
-  //   {
-  //     NS_LOG_LOGIC ("Free NSE");
-  //     NeighborStatusEntry* temp = i->second;
-  //     delete temp;
-  //   }
-  // NS_LOG_LOGIC ("Clear map");
-  Initialize ();
+  return m_table->GetPredictedDelay (iface, n_iface, steps);
 }
 
-void
-TSDB::Initialize ()
+uint32_t
+TSDB::GetNumStatusUnit (uint32_t iface) const
 {
-  // NS_LOG_FUNCTION (this);
-  m_database.clear ();
+  return m_table->GetNumStatusUnit (iface);
 }
 
-NeighborStatusEntry*
-TSDB::GetNeighborStatusEntry (uint32_t iface) const
+uint32_t
+TSDB::GetNNeighborInterfaces () const
 {
-  // NS_LOG_FUNCTION (this << iface);
-  //
-  // Look up a NSE by it's interface.
-  //
-  TSDBMap_t::const_iterator ci = m_database.find (iface);
-  if (ci != m_database.end ())
-    {
-      return ci->second;
-    }
-  return nullptr;
+  return m_table->GetNNeighborInterfaces ();
 }
 
-NeighborStatusEntry*
-TSDB::HandleNeighborStatusEntry (uint32_t iface)
+int
+TSDB::GetLastState (uint32_t iface, uint32_t n_iface) const
 {
-  // NS_LOG_FUNCTION (this << iface);
-  //
-  // Look up a NSE by it's interface.
-  //
-  TSDBMap_t::iterator iter = m_database.find (iface);
-  if (iter != m_database.end ())
-    {
-      return iter->second;
-    }
-  return nullptr;
+  return m_table->GetLastState (iface, n_iface);
 }
 
-
-void
-TSDB::Insert (uint32_t iface, NeighborStatusEntry* nse)
+std::size_t
+TSDB::GetMemoryFootprint () const
 {
-  // NS_LOG_FUNCTION (this << iface << nse);
-  TSDBMap_t::iterator it = m_database.find (iface);
-  if (it != m_database.end ())
-    {
-      std::cout << "Find a current nse" << std::endl;
-      it->second = nse;
-    }
-  else
-    {
-      // std::cout << "not find, insert a new one";
-      m_database.insert (NSDBPair_t (iface, nse));
-    }
+  return m_table->GetMemoryFootprint ();
 }
 
 void
 TSDB::Print (std::ostream &os) const
 {
-  os << "At node: ???" << std::endl;
-  TSDBMap_t::const_iterator ci;
-  std::cout << "const iterator";
-  for (ci = m_database.begin (); ci != m_database.end (); ci ++)
-    {
-      os << "Interface = " << ci->first << std::endl;
-      ci->second->Print (os);
-    }
-
+  m_table->Print (os);
 }
 
-}
\ No newline at end of file
+}
@@ -2,70 +2,159 @@
 #ifndef TSDB_H
 #define TSDB_H
 
-#define STATESIZE 10
+#include "ns3/assert.h"
 #include "ns3/core-module.h"
-#include <map>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdint.h>
 #include <utility>
+#include <vector>
 #include "database.h"
 namespace ns3 {
 
+/**
+ * \brief How a StatusUnit weighs the transitions it saw.
+ */
+enum StatusEstimator
+{
+  CUMULATIVE_ESTIMATOR, //!< every transition since the start
+  DECAYED_ESTIMATOR,    //!< a row is halved when it holds the estimator length
+  WINDOWED_ESTIMATOR    //!< only the transitions of the last estimator length updates
+};
+
+/**
+ * \brief Markov chain of the queue occupancy level of a neighbor interface.
+ *
+ * The unit counts the transitions between the levels the neighbor reported,
+ * and keeps for each level the number and sum of the levels that followed it
+ * and the most frequent of them, so that the estimates cost O(1).  A counter
+ * about to overflow halves the counters of its row, which keeps the
+ * transition frequencies.
+ *
+ * Counting every transition makes the estimates slower and slower to follow
+ * a change of load, so the unit may instead decay its counts, or only count
+ * the transitions of a sliding window, whose oldest transition is forgotten
+ * on each update.
+ *
+ * The delay several updates ahead comes from the powers of the normalized
+ * transition matrix.  The powers of two are computed on demand and kept
+ * until the next update, as is the last prediction, so that repeated
+ * predictions between two updates cost O(1).
+ *
+ * \tparam N the number of queue occupancy levels
+ * \tparam Counter the type of the transition counters
+ */
+template <uint32_t N, typename Counter>
 class StatusUnit
 {
+  static_assert (N >= 2 && N <= 256, "the levels must fit in a uint8_t");
+
   public:
+    /// delay of one level in microsecond, a full queue standing for 20 ms
+    static const uint32_t LEVEL_DELAY = 20000 / N;
+
     StatusUnit ();
-    ~StatusUnit ();
     int GetLastState () const;
     int GetCurrentState () const;
     int GetEstimateState () const;
     uint32_t GetEstimateDelayDGR () const;  // in microsecond
     uint32_t GetEstimateDelayDDR () const;   // in microsecond
+    /**
+     * \param steps the number of updates ahead
+     * \return the expected queue delay after the steps, in microsecond: the
+     * last one for 0 steps, GetEstimateDelayDDR () for 1
+     */
+    uint32_t GetPredictedDelay (uint32_t steps) const;
+    /**
+     * \param state the level reported, the last one if it is larger
+     */
     void Update (int state);
+    /**
+     * \brief Choose how the transitions are weighed, and forget them.
+     * \param estimator the estimator
+     * \param length the number of transitions a row holds before it is
+     * halved, or the number of transitions in the window, at most the largest
+     * Counter
+     */
+    void SetEstimator (StatusEstimator estimator, uint32_t length);
+    /**
+     * \return the number of bytes of the window and of the powers the unit
+     * allocated, beyond its own size
+     */
+    std::size_t GetMemoryFootprint () const;
     void Print (std::ostream &os) const;
   private:
-    int m_matrix[STATESIZE][STATESIZE];
-    int m_state; /** last state */
-};
+    /**
+     * \brief Halve the counters of a row and compute its statistics again.
+     * \param row the row
+     */
+    void Rescale (int row);
 
-class NeighborStatusEntry
-{
-public:
-  NeighborStatusEntry ();
-  ~NeighborStatusEntry ();
-
-  void Insert (uint32_t n_iface , StatusUnit* su);
-  StatusUnit* GetStatusUnit (uint32_t n_iface) const;
-  uint32_t GetNumStatusUnit () const;
-  void Print (std::ostream &os) const;
-  
-private:
-  typedef std::map<uint32_t, StatusUnit*>
-      NSMap_t; /** status, statistic*/
-  typedef std::pair<uint32_t, StatusUnit*> 
-      NSPair_t; //!< pair of <interface, StatusUnit>
-  NSMap_t m_database;
-};
+    /**
+     * \brief Find the most frequent state of a row again.
+     * \param row the row
+     */
+    void FindMax (int row);
+
+    /**
+     * \brief Forget the oldest transition of the window.
+     */
+    void Forget ();
+
+    /**
+     * \brief Compute the powers of the transition matrix up to one.
+     * \param j the power, 2^j, to compute
+     * \return the power, N x N row major
+     */
+    const float* GetPower (uint32_t j) const;
+
+    /**
+     * \brief Multiply two N x N row major matrices.
+     *
+     * The inner loop runs over contiguous rows of constant length, which the
+     * compiler vectorizes.
+     *
+     * \param a the left matrix
+     * \param b the right matrix
+     * \param c set to a b, distinct from both
+     */
+    static void Multiply (const float* a, const float* b, float* c);
 
+    Counter m_matrix[N][N];
+    int m_state; /** last state */
+    uint32_t m_rowCount[N]; /** number of transitions from each state */
+    uint32_t m_rowSum[N]; /** sum of the states reached from each state */
+    uint8_t m_rowMax[N]; /** most frequent state reached from each state */
+    StatusEstimator m_estimator; /** how the transitions are weighed */
+    uint32_t m_length; /** half-life or window of the estimator, in transitions */
+    std::vector<std::pair<uint8_t, uint8_t> > m_window; /** <from, to> transitions */
+    uint32_t m_oldest; /** index of the oldest transition of a full window */
+    mutable std::vector<float> m_powers; /** M^(2^j) at j N N, until the next update */
+    mutable uint32_t m_nPowers; /** number of powers in m_powers */
+    mutable uint32_t m_predictionSteps; /** steps of m_prediction, 0 for none */
+    mutable uint32_t m_prediction; /** last prediction, until the next update */
+};
 
 /**
  * \brief The DGR neighbor status database
  * 
- * Each node in DGR maintains a neighbor status data base.
+ * Each node in DGR maintains a neighbor status data base, holding one
+ * StatusUnit per pair of local interface and interface of the neighbor on it.
+ * Both are small dense integers, so the units are stored inline in one array,
+ * row by row of local interface, and found by index.  The resolution of the
+ * units is chosen at run time among compiled variants.
 */
 class TSDB : public Database
 {
   public:
     /**
      * @brief Construct an empty Neighbor Status Database.
-     * 
-     * The database map composing the Neighbor Status Database in initilaized in
-     * this constructor.
     */
     TSDB ();
 
     /**
-     * \brief Destroy an empty Neighbor Status Database.
-     * 
-     * Before distroy the database, resources should be release by clear ()
+     * \brief Destroy the Neighbor Status Database.
     */
     ~TSDB ();
 
@@ -79,31 +168,116 @@ class TSDB : public Database
     void Initialize ();
 
     /**
-     * \brief Get the NeighborStatusEntry of a Interface
-     * 
-     * \param iface The interface number
-     * \return NeighborStatusEntry*
+     * \brief Make room for the neighbors of a number of interfaces.
+     *
+     * The database never shrinks, and the status units learnt are kept.
+     *
+     * \param nInterfaces the number of local interfaces
+    */
+    void Resize (uint32_t nInterfaces);
+
+    /**
+     * \brief Choose the status units to use, and empty the database.
+     *
+     * The queue occupancy levels supported are 4, 10, 16 and 32.
+     *
+     * \param nStates the number of queue occupancy levels
+     * \param compact true for 16-bit transition counters, false for int ones
+    */
+    void SetResolution (uint32_t nStates, bool compact);
+
+    /**
+     * \brief Choose how the status units weigh the transitions, and empty
+     * the database.
+     *
+     * \param estimator the estimator
+     * \param length the half-life or window of the estimator, in
+     * transitions, at most 65535
     */
-    NeighborStatusEntry* GetNeighborStatusEntry (uint32_t iface) const;
+    void SetEstimator (StatusEstimator estimator, uint32_t length);
 
     /**
-     * \brief Handle the NeighborStatusEntry of a Interface
+     * \return the number of queue occupancy levels of the status units
+    */
+    uint32_t GetNStates () const;
+
+    /**
+     * \param iface The local interface number
+     * \param n_iface The interface number on the neighbor
+     * \return true if a state was received from the neighbor interface
+    */
+    bool HasStatusUnit (uint32_t iface, uint32_t n_iface) const;
+
+    /**
+     * \brief Record a state received from a neighbor interface
      * 
-     * \param iface The interface number
-     * \return NeighborStatusEntry*
+     * The status unit is created, and the database grown, if no state was
+     * received from the neighbor interface yet.
+     *
+     * \param iface The local interface number
+     * \param n_iface The interface number on the neighbor
+     * \param state The queue occupancy level received
+    */
+    void Update (uint32_t iface, uint32_t n_iface, int state);
+
+    /**
+     * \return a counter of the changes of the database, which every Update ()
+     * and every change of the resolution or of the estimator bumps, and
+     * which tells the users of the predictions they may be stale; it never
+     * goes back, so a cache validates with one compare
+    */
+    uint32_t GetEpoch () const;
+
+    /**
+     * \param iface The local interface number
+     * \param n_iface The interface number on the neighbor
+     * \return the queue delay of the neighbor interface expected by DDR, in
+     * microsecond, or 0 if no state was received yet
+    */
+    uint32_t GetEstimateDelayDDR (uint32_t iface, uint32_t n_iface) const;
+
+    /**
+     * \param iface The local interface number
+     * \param n_iface The interface number on the neighbor
+     * \return the last queue delay of the neighbor interface, in microsecond,
+     * or 0 if no state was received yet
+    */
+    uint32_t GetEstimateDelayDGR (uint32_t iface, uint32_t n_iface) const;
+
+    /**
+     * \param iface The local interface number
+     * \param n_iface The interface number on the neighbor
+     * \param steps The number of updates ahead
+     * \return the queue delay of the neighbor interface expected after the
+     * steps, in microsecond, or 0 if no state was received yet
+    */
+    uint32_t GetPredictedDelay (uint32_t iface, uint32_t n_iface, uint32_t steps) const;
+
+    /**
+     * \param iface The local interface number
+     * \return the number of neighbor interfaces state was received from
+    */
+    uint32_t GetNumStatusUnit (uint32_t iface) const;
+
+    /**
+     * \return one more than the largest neighbor interface number state was
+     * received from
+    */
+    uint32_t GetNNeighborInterfaces () const;
+
+    /**
+     * \param iface The local interface number
+     * \param n_iface The interface number on the neighbor
+     * \return the last state received from the neighbor interface, or -1 if
+     * none was
     */
-    NeighborStatusEntry* HandleNeighborStatusEntry (uint32_t iface);
+    int GetLastState (uint32_t iface, uint32_t n_iface) const;
 
     /**
-     * \brief Insert an <interface, Neighbor Status Entry> into the NSDB
-     *  
-     * The interface and NeighborStatusEntry given as parameters are converted
-     * to an STL pair and insert into the database map.
-     * \param iface interface number
-     * \param nse the neighbor status entry 
+     * \return the number of bytes of the status units and of their table
     */
-    void Insert (uint32_t iface, NeighborStatusEntry* nse);
-    
+    std::size_t GetMemoryFootprint () const;
+
     /**
      * \brief Print the database
      * 
@@ -111,17 +285,327 @@ class TSDB : public Database
     void Print (std::ostream &os) const override;
 
   private:
-    typedef std::map<uint32_t, NeighborStatusEntry*> 
-        TSDBMap_t;  //!< container of <interface, NeighborStatusEntry>
-    typedef std::pair<uint32_t, NeighborStatusEntry*> 
-        NSDBPair_t; //!< pair of <interface, NeighborStatusEntry>
-    typedef std::map<uint32_t, NeighborStatusEntry*>::iterator
-        NeighborStatusMapI; //!< NSE type iterator
-    typedef std::map<uint32_t, NeighborStatusEntry*>::const_iterator
-        NeighborStatusMapCI; //!< NSE type const iterator
-    TSDBMap_t m_database; //!< database of <interface, NeighborStatusEntry>
+    class Table;
+    template <class Unit>
+    class UnitTable;
+
+    /**
+     * \brief Create the status units of a resolution.
+     * \tparam N the number of queue occupancy levels
+     * \param compact true for 16-bit transition counters
+     * \return the table
+    */
+    template <uint32_t N>
+    static Table* CreateTable (bool compact);
+
+    std::unique_ptr<Table> m_table; //!< the status units, of the chosen resolution
+    bool m_compact;                 //!< whether the transition counters are 16-bit
+    StatusEstimator m_estimator;    //!< how the units weigh the transitions
+    uint32_t m_estimatorLength;     //!< half-life or window of the estimator
+    uint32_t m_epoch;               //!< changes of the database so far
 };
 
+inline uint32_t
+TSDB::GetEpoch () const
+{
+  return m_epoch;
+}
+
+template <uint32_t N, typename Counter>
+StatusUnit<N, Counter>::StatusUnit ()
+  : m_matrix {{0}},
+    m_state (0),
+    m_rowCount {0},
+    m_rowSum {0},
+    m_estimator (CUMULATIVE_ESTIMATOR),
+    m_length (0),
+    m_oldest (0),
+    m_nPowers (0),
+    m_predictionSteps (0),
+    m_prediction (0)
+{
+  for (uint32_t i = 0; i < N; i ++)
+    {
+      m_rowMax[i] = i;
+    }
+}
+
+template <uint32_t N, typename Counter>
+int
+StatusUnit<N, Counter>::GetEstimateState () const
+{
+  return m_rowMax[m_state];
+}
+
+template <uint32_t N, typename Counter>
+uint32_t
+StatusUnit<N, Counter>::GetEstimateDelayDDR () const
+{
+  if (m_rowCount[m_state] == 0)
+    {
+      // nothing seen from this state yet, stay in it
+      return GetEstimateDelayDGR ();
+    }
+  return m_rowSum[m_state] * LEVEL_DELAY / m_rowCount[m_state];
+}
+
+template <uint32_t N, typename Counter>
+uint32_t
+StatusUnit<N, Counter>::GetEstimateDelayDGR () const
+{
+  return m_state * LEVEL_DELAY;
+}
+
+template <uint32_t N, typename Counter>
+int
+StatusUnit<N, Counter>::GetCurrentState () const
+{
+  return m_rowMax[m_state];
+}
+
+template <uint32_t N, typename Counter>
+uint32_t
+StatusUnit<N, Counter>::GetPredictedDelay (uint32_t steps) const
+{
+  if (steps == 0)
+    {
+      return GetEstimateDelayDGR ();
+    }
+  if (steps == 1)
+    {
+      return GetEstimateDelayDDR ();
+    }
+  if (m_predictionSteps == steps)
+    {
+      return m_prediction;
+    }
+  // distribution of the state after the steps, from the last state
+  float distribution[N] = {0};
+  float next[N];
+  distribution[m_state] = 1;
+  for (uint32_t j = 0; (steps >> j) != 0; j ++)
+    {
+      if (((steps >> j) & 1) == 0)
+        {
+          continue;
+        }
+      const float* power = GetPower (j);
+      std::fill (next, next + N, 0.0f);
+      for (uint32_t i = 0; i < N; i ++)
+        {
+          for (uint32_t k = 0; k < N; k ++)
+            {
+              next[k] += distribution[i] * power[i * N + k];
+            }
+        }
+      std::copy (next, next + N, distribution);
+    }
+  float expected = 0;
+  for (uint32_t i = 0; i < N; i ++)
+    {
+      expected += distribution[i] * i;
+    }
+  m_prediction = expected * LEVEL_DELAY;
+  m_predictionSteps = steps;
+  return m_prediction;
+}
+
+template <uint32_t N, typename Counter>
+const float*
+StatusUnit<N, Counter>::GetPower (uint32_t j) const
+{
+  if (m_nPowers == 0)
+    {
+      // a state nothing was seen from yet stays as it is, as in GetEstimateDelayDDR ()
+      m_powers.assign (N * N, 0.0f);
+      for (uint32_t i = 0; i < N; i ++)
+        {
+          if (m_rowCount[i] == 0)
+            {
+              m_powers[i * N + i] = 1;
+              continue;
+            }
+          for (uint32_t k = 0; k < N; k ++)
+            {
+              m_powers[i * N + k] = static_cast<float> (m_matrix[i][k]) / m_rowCount[i];
+            }
+        }
+      m_nPowers = 1;
+    }
+  for (; m_nPowers <= j; m_nPowers ++)
+    {
+      m_powers.resize ((m_nPowers + 1) * N * N);
+      const float* last = &m_powers[(m_nPowers - 1) * N * N];
+      Multiply (last, last, &m_powers[m_nPowers * N * N]);
+    }
+  return &m_powers[j * N * N];
+}
+
+template <uint32_t N, typename Counter>
+void
+StatusUnit<N, Counter>::Multiply (const float* a, const float* b, float* c)
+{
+  for (uint32_t i = 0; i < N; i ++)
+    {
+      float* row = c + i * N;
+      std::fill (row, row + N, 0.0f);
+      for (uint32_t k = 0; k < N; k ++)
+        {
+          float aik = a[i * N + k];
+          const float* rowB = b + k * N;
+          for (uint32_t j = 0; j < N; j ++)
+            {
+              row[j] += aik * rowB[j];
+            }
+        }
+    }
+}
+
+template <uint32_t N, typename Counter>
+int
+StatusUnit<N, Counter>::GetLastState () const
+{
+  return m_state;
+}
+
+template <uint32_t N, typename Counter>
+void
+StatusUnit<N, Counter>::Update (int state)
+{
+  state = std::min (std::max (state, 0), static_cast<int> (N) - 1);
+  m_nPowers = 0;
+  m_predictionSteps = 0;
+  if (m_estimator == WINDOWED_ESTIMATOR)
+    {
+      if (m_window.size () == m_length)
+        {
+          Forget ();
+          m_window[m_oldest] = std::make_pair (m_state, state);
+          m_oldest = (m_oldest + 1) % m_length;
+        }
+      else
+        {
+          m_window.push_back (std::make_pair (m_state, state));
+        }
+    }
+  if (m_matrix[m_state][state] == std::numeric_limits<Counter>::max ())
+    {
+      Rescale (m_state);
+    }
+  uint32_t count = ++ m_matrix[m_state][state];
+  m_rowCount[m_state] ++;
+  m_rowSum[m_state] += state;
+  //
+  // The most frequent state of a row is the row's own state if it is one of
+  // them, the first of them otherwise, and counts only grow one at a time.
+  //
+  uint8_t& best = m_rowMax[m_state];
+  uint32_t bestCount = m_matrix[m_state][best];
+  if (count > bestCount)
+    {
+      best = state;
+    }
+  else if (count == bestCount && best != m_state && (state == m_state || state < best))
+    {
+      best = state;
+    }
+  if (m_estimator == DECAYED_ESTIMATOR && m_rowCount[m_state] >= m_length)
+    {
+      Rescale (m_state);
+    }
+  m_state = state;
+}
+
+template <uint32_t N, typename Counter>
+void
+StatusUnit<N, Counter>::Forget ()
+{
+  int from = m_window[m_oldest].first;
+  int to = m_window[m_oldest].second;
+  m_matrix[from][to] --;
+  m_rowCount[from] --;
+  m_rowSum[from] -= to;
+  // only the most frequent state losing a count can change the most frequent
+  if (m_rowMax[from] == to)
+    {
+      FindMax (from);
+    }
+}
+
+template <uint32_t N, typename Counter>
+void
+StatusUnit<N, Counter>::FindMax (int row)
+{
+  m_rowMax[row] = row;
+  for (uint32_t i = 0; i < N; i ++)
+    {
+      if (m_matrix[row][i] > m_matrix[row][m_rowMax[row]])
+        {
+          m_rowMax[row] = i;
+        }
+    }
+}
+
+template <uint32_t N, typename Counter>
+void
+StatusUnit<N, Counter>::SetEstimator (StatusEstimator estimator, uint32_t length)
+{
+  NS_ASSERT_MSG (estimator == CUMULATIVE_ESTIMATOR || length > 0,
+                 "The estimator needs a length");
+  NS_ASSERT_MSG (length <= std::numeric_limits<Counter>::max (),
+                 "The estimator length does not fit in the counters");
+  *this = StatusUnit ();
+  m_estimator = estimator;
+  m_length = length;
+  if (estimator == WINDOWED_ESTIMATOR)
+    {
+      m_window.reserve (length);
+    }
+}
+
+template <uint32_t N, typename Counter>
+void
+StatusUnit<N, Counter>::Rescale (int row)
+{
+  m_rowCount[row] = 0;
+  m_rowSum[row] = 0;
+  for (uint32_t i = 0; i < N; i ++)
+    {
+      m_matrix[row][i] /= 2;
+      m_rowCount[row] += m_matrix[row][i];
+      m_rowSum[row] += m_matrix[row][i] * i;
+    }
+  FindMax (row);
+}
+
+template <uint32_t N, typename Counter>
+std::size_t
+StatusUnit<N, Counter>::GetMemoryFootprint () const
+{
+  return m_window.capacity () * sizeof (std::pair<uint8_t, uint8_t>) +
+    m_powers.capacity () * sizeof (float);
+}
+
+template <uint32_t N, typename Counter>
+void
+StatusUnit<N, Counter>::Print (std::ostream &os) const
+{
+  os << "Last state = " << GetLastState ()
+     << ", Current State = " << GetEstimateState ()
+     << std::endl;
+  os << "current Markov Transition Probability Matrix: "
+     << std::endl;
+  for (uint32_t i = 0; i < N; i ++)
+    {
+      for (uint32_t j = 0; j < N; j ++)
+        {
+          os << m_matrix[i][j];
+          os << " ";
+        }
+      os << std::endl;
+    }
+}
+
 }
 
 #endif /* TSDB_H */
\ No newline at end of file
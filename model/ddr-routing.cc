@@ -5,10 +5,17 @@
 #include "datapath/dgr-headers.h"
 #include "datapath/romam-tags.h"
 #include "priority_manage/ddr-queue-disc.h"
+#include "routing_algorithm/policy-table.h"
 #include "routing_algorithm/spf-route-info-entry.h"
+#include "utility/address-interner.h"
+#include "utility/agent-channel.h"
+#include "utility/event-accounting.h"
+#include "utility/memory-footprint.h"
 #include "utility/route-manager.h"
 
 #include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/global-value.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/ipv4-route.h"
@@ -17,22 +24,29 @@
 #include "ns3/loopback-net-device.h"
 #include "ns3/names.h"
 #include "ns3/network-module.h"
+#include "ns3/node-list.h"
 #include "ns3/node.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
+#include "ns3/string.h"
 #include "ns3/traffic-control-module.h"
 #include "ns3/udp-header.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #define DDR_PORT 666
 #define DDR_BROAD_CAST "224.0.0.13"
+#define DDR_CONTROL_PROTOCOL 253 // RFC 3692 experimental, for the ControlChannel
 
 namespace ns3
 {
@@ -41,6 +55,30 @@ NS_LOG_COMPONENT_DEFINE("DDRRouting");
 
 NS_OBJECT_ENSURE_REGISTERED(DDRRouting);
 
+/// width of the windows the control bursts of the unsolicited updates are counted in
+static GlobalValue g_controlBurstWindow(
+    "RomamControlBurstWindow",
+    "Width of the windows the unsolicited neighbor state updates the DDR nodes send are counted "
+    "in, for DDRRouting::GetControlBurstPeak ()",
+    TimeValue(MicroSeconds(100)),
+    MakeTimeChecker(Time(1)));
+
+/**
+ * \return the value of RomamControlBurstWindow
+ */
+static Time
+GetControlBurstWindow()
+{
+    TimeValue value;
+    g_controlBurstWindow.GetValue(value);
+    return value.Get();
+}
+
+int64_t DDRRouting::s_burstWindow = -1;
+uint32_t DDRRouting::s_burstCount = 0;
+uint32_t DDRRouting::s_burstPeak = 0;
+Time DDRRouting::s_burstPeakTime;
+
 TypeId
 DDRRouting::GetTypeId(void)
 {
@@ -61,26 +99,300 @@ DDRRouting::GetTypeId(void)
                           BooleanValue(false),
                           MakeBooleanAccessor(&DDRRouting::m_respondToInterfaceEvents),
                           MakeBooleanChecker())
+            .AddAttribute("IncrementalUpdates",
+                          "Set to true to update only the SPF trees and forwarding tables "
+                          "an interface event changes, instead of recomputing all the routes",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DDRRouting::m_incrementalUpdates),
+                          MakeBooleanChecker())
+            .AddAttribute("FastReroute",
+                          "Set to true to forward the packets of the routes of an interface "
+                          "that went down on their loop-free alternates, until the routes are "
+                          "recomputed",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DDRRouting::m_fastReroute),
+                          MakeBooleanChecker())
             .AddAttribute("SamplePeriod",
                           "Time between two Unsolicited Neighbor State Updates.",
                           TimeValue(MilliSeconds(10)),
                           MakeTimeAccessor(&DDRRouting::m_unsolicitedUpdate),
                           MakeTimeChecker())
+            .AddAttribute("RandomStartPhase",
+                          "Set to true to send the first unsolicited update at a uniform random "
+                          "time within SamplePeriod, so the nodes do not update in lockstep",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DDRRouting::m_randomStartPhase),
+                          MakeBooleanChecker())
+            .AddAttribute("UpdateJitter",
+                          "Fraction of every period to the next unsolicited update a uniform "
+                          "random part of which is taken off, 0.25 in RFC 4271; 0 for none",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&DDRRouting::m_updateJitter),
+                          MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute("UpdateTimerWheel",
+                          "Set to true to run the unsolicited updates on the TimerWheel of the "
+                          "node, which fires them on its next tick, so up to one Resolution "
+                          "late; they are simulator events of their exact times otherwise",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DDRRouting::m_updateTimerWheel),
+                          MakeBooleanChecker())
+            .AddAttribute("AdaptiveSamplePeriod",
+                          "Set to true to start from SamplePeriod and halve the time between two "
+                          "unsolicited updates when a local queue changed of state since the last "
+                          "one, or lengthen it by a quarter when none did",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DDRRouting::m_adaptiveSamplePeriod),
+                          MakeBooleanChecker())
+            .AddAttribute("MinSamplePeriod",
+                          "Shortest time between two unsolicited updates with AdaptiveSamplePeriod",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&DDRRouting::m_minSamplePeriod),
+                          MakeTimeChecker(MicroSeconds(1)))
+            .AddAttribute("MaxSamplePeriod",
+                          "Longest time between two unsolicited updates with AdaptiveSamplePeriod",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&DDRRouting::m_maxSamplePeriod),
+                          MakeTimeChecker(MicroSeconds(1)))
             .AddAttribute("RouteSelectMode",
-                          "Routing Select Mode",
+                          "Routing Select Mode; DGR-DAG and DDR-DAG select among the "
+                          "loop-free successors only, with no loop limit in the packets; POLICY "
+                          "takes the next hops of a PolicyTable, DDR's where it has none",
                           EnumValue(NONE),
                           MakeEnumAccessor(&DDRRouting::m_routeSelectMode),
-                          MakeEnumChecker(NONE, "ECMP", KSHORT, "KSHORT", DGR, "DGR", DDR, "DDR"));
+                          MakeEnumChecker(NONE,
+                                          "ECMP",
+                                          KSHORT,
+                                          "KSHORT",
+                                          DGR,
+                                          "DGR",
+                                          DDR,
+                                          "DDR",
+                                          DGR_DAG,
+                                          "DGR-DAG",
+                                          DDR_DAG,
+                                          "DDR-DAG",
+                                          POLICY,
+                                          "POLICY"))
+            .AddAttribute("PolicyTable",
+                          "File of the PolicyTable the POLICY route select mode looks the next "
+                          "hops up in, loaded once for all the routers",
+                          StringValue(""),
+                          MakeStringAccessor(&DDRRouting::m_policyPath),
+                          MakeStringChecker())
+            .AddAttribute("StateLevels",
+                          "Number of queue occupancy levels the neighbor states are reported "
+                          "and predicted in: 4, 10, 16 or 32",
+                          UintegerValue(10),
+                          MakeUintegerAccessor(&DDRRouting::m_stateLevels),
+                          MakeUintegerChecker<uint32_t>(4, 32))
+            .AddAttribute("CompactStatusCounters",
+                          "Set to true to count the neighbor state transitions on 16 bits, "
+                          "which halves the counters of a state before they overflow",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DDRRouting::m_compactStatusCounters),
+                          MakeBooleanChecker())
+            .AddAttribute("StatusEstimator",
+                          "How the neighbor state predictions weigh the transitions seen: all "
+                          "of them, decayed counts, or a sliding window",
+                          EnumValue(CUMULATIVE_ESTIMATOR),
+                          MakeEnumAccessor(&DDRRouting::m_statusEstimator),
+                          MakeEnumChecker(CUMULATIVE_ESTIMATOR,
+                                          "Cumulative",
+                                          DECAYED_ESTIMATOR,
+                                          "Decayed",
+                                          WINDOWED_ESTIMATOR,
+                                          "Windowed"))
+            .AddAttribute("StatusEstimatorLength",
+                          "Number of transitions from a state after which the Decayed "
+                          "estimator halves their counts, or that the Windowed estimator keeps",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&DDRRouting::m_statusEstimatorLength),
+                          MakeUintegerChecker<uint32_t>(1, 65535))
+            .AddAttribute("PredictionHorizon",
+                          "Number of neighbor state updates ahead the DDR route select mode "
+                          "predicts the queue delay of the next hop for (1 is the next state)",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&DDRRouting::m_predictionHorizon),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("CompactStatusUpdates",
+                          "Set to true to send the neighbor states in the compact format, with "
+                          "only the states that changed between two full refreshes, when the "
+                          "states and interfaces fit in it",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DDRRouting::m_compactStatusUpdates),
+                          MakeBooleanChecker())
+            .AddAttribute("TriggeredStatusUpdates",
+                          "Set to true to also send the neighbor states when the occupancy "
+                          "level of a local DDR queue disc changes, as its StateHysteresis and "
+                          "StateMinInterval attributes allow",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DDRRouting::m_triggeredStatusUpdates),
+                          MakeBooleanChecker())
+            .AddAttribute("OracleNeighborState",
+                          "Set to true to read the queue delays of the neighbors from their "
+                          "DDR queue discs rather than from the TSDB, for an upper bound of "
+                          "the decisions: no neighbor state is sent or received, and the "
+                          "decision cache is bypassed",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DDRRouting::m_oracleNeighborState),
+                          MakeBooleanChecker())
+            .AddAttribute("UseControlChannel",
+                          "Set to true to exchange the neighbor states through a ControlChannel, "
+                          "IP protocol 253 delivered straight to the router, instead of a UDP "
+                          "socket per interface address",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DDRRouting::m_useControlChannel),
+                          MakeBooleanChecker())
+            .AddAttribute("FullStatusRefresh",
+                          "Number of neighbor state updates from one full refresh of the "
+                          "compact format to the next",
+                          UintegerValue(10),
+                          MakeUintegerAccessor(&DDRRouting::m_fullStatusRefresh),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("DecisionCacheSize",
+                          "Number of flows whose DDR decision is cached, so that their next "
+                          "packets skip the evaluation of the candidates; 0 disables the cache",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&DDRRouting::SetDecisionCacheSize,
+                                               &DDRRouting::GetDecisionCacheSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("DecisionCacheTimeout",
+                          "Age after which a cached DDR decision is taken again, even if no "
+                          "neighbor state, local queue level or route changed; 0 for none",
+                          TimeValue(MicroSeconds(500)),
+                          MakeTimeAccessor(&DDRRouting::SetDecisionCacheTimeout,
+                                           &DDRRouting::GetDecisionCacheTimeout),
+                          MakeTimeChecker())
+            .AddAttribute("OutputRouteCacheSize",
+                          "Number of destinations whose shortest route the node keeps for the "
+                          "packets it sends, until the routes change, so that a source "
+                          "sending to one peer looks its route up once; 0 disables the cache",
+                          UintegerValue(16),
+                          MakeUintegerAccessor(&DDRRouting::SetOutputRouteCacheSize,
+                                               &DDRRouting::GetOutputRouteCacheSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("DecisionBudgetBucket",
+                          "Width of the ranges of remaining budgets whose packets of a flow "
+                          "share a cached DDR decision",
+                          TimeValue(MicroSeconds(100)),
+                          MakeTimeAccessor(&DDRRouting::m_decisionBudgetBucket),
+                          MakeTimeChecker(MicroSeconds(1)))
+            .AddAttribute("DgrDecisionTables",
+                          "Set to true to have the DGR route select modes draw the routes of a "
+                          "packet from a table of the feasible routes of its destination by "
+                          "DecisionBudgetBucket, rebuilt once a neighbor state or a local queue "
+                          "level of its routes changed, instead of evaluating every candidate",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DDRRouting::m_dgrDecisionTables),
+                          MakeBooleanChecker())
+            .AddAttribute("BudgetAdmission",
+                          "What the source does with a budgeted packet whose budget is below "
+                          "the distance of the shortest route to its destination: send it "
+                          "anyway, drop it, or send it as best effort, without its priority",
+                          EnumValue(ADMIT_ALL),
+                          MakeEnumAccessor(&DDRRouting::m_budgetAdmission),
+                          MakeEnumChecker(ADMIT_ALL,
+                                          "All",
+                                          ADMIT_DROP,
+                                          "Drop",
+                                          ADMIT_DOWNGRADE,
+                                          "Downgrade"))
+            .AddAttribute("SplitPolicy",
+                          "How the NONE and KSHORT route select modes weigh the routes they split "
+                          "the budgeted packets among, NONE among the loop-free successors: not "
+                          "at all, evenly, by inverse distance, or by the data rate of the first "
+                          "link",
+                          EnumValue(SPLIT_OFF),
+                          MakeEnumAccessor(&DDRRouting::m_splitPolicy),
+                          MakeEnumChecker(SPLIT_OFF,
+                                          "Off",
+                                          SPLIT_EQUAL,
+                                          "Equal",
+                                          SPLIT_COST,
+                                          "InverseCost",
+                                          SPLIT_CAPACITY,
+                                          "Capacity"))
+            .AddAttribute("SplitByFlow",
+                          "Set to true to pick the route of a packet in a split by the hash of "
+                          "its flow, which keeps the flow on one route; set to false for a "
+                          "random draw per packet",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&DDRRouting::m_splitByFlow),
+                          MakeBooleanChecker())
+            .AddAttribute("DownstreamDelays",
+                          "Number of destinations whose best delay over the shortest route, from "
+                          "the local and next hop queues, the neighbor state updates carry, the "
+                          "largest first, for the DDR route select mode of the neighbors; 0 for "
+                          "none",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&DDRRouting::m_downstreamDelays),
+                          MakeUintegerChecker<uint32_t>(0, DgrHeader::MAX_DOWNSTREAMS))
+            .AddAttribute("KShortestHotDestinations",
+                          "Number of destinations, the most looked up in a KShortestHotWindow, "
+                          "the KSHORT route select mode keeps all the k shortest paths of; the "
+                          "others keep their best path only.  0 to keep all the paths of every "
+                          "destination",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&DDRRouting::m_hotDestinations),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("KShortestHotWindow",
+                          "Period over which the KSHORT lookups of the destinations are counted "
+                          "to pick the KShortestHotDestinations",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&DDRRouting::m_hotWindow),
+                          MakeTimeChecker(Time(1)));
     return tid;
 }
 
 DDRRouting::DDRRouting()
     : m_randomEcmpRouting(false),
       m_respondToInterfaceEvents(false),
-      m_tsdb()
+      m_incrementalUpdates(false),
+      m_fastReroute(false),
+      m_nDownInterfaces(0),
+      m_hostRouteSequence(0),
+      m_tsdb(),
+      m_stateLevels(10),
+      m_compactStatusCounters(false),
+      m_statusEstimator(CUMULATIVE_ESTIMATOR),
+      m_statusEstimatorLength(64),
+      m_predictionHorizon(1),
+      m_compactStatusUpdates(false),
+      m_triggeredStatusUpdates(false),
+      m_oracleNeighborState(false),
+      m_useControlChannel(false),
+      m_fullStatusRefresh(10),
+      m_updatesSinceRefresh(0),
+      m_decisionBudgetBucket(MicroSeconds(100)),
+      m_decisionGeneration(0),
+      m_dgrDecisionTables(false),
+      m_tableGeneration(1),
+      m_stateStamp(0),
+      m_budgetAdmission(ADMIT_ALL),
+      m_splitPolicy(SPLIT_OFF),
+      m_splitByFlow(true),
+      m_metricDelay(std::max<int64_t>(1, RouteManager::GetMetricDelay().GetMicroSeconds())),
+      m_downstreamDelays(0),
+      m_hotDestinations(0),
+      m_nFull(0),
+      m_agentChannel(nullptr),
+      m_agentNode(0),
+      m_policyNode(0),
+      m_policyStamp(UINT64_MAX),
+      m_policyState(0),
+      m_nextUnsolicitedUpdate(0),
+      m_adaptiveSamplePeriod(false),
+      m_minSamplePeriod(MilliSeconds(1)),
+      m_maxSamplePeriod(MilliSeconds(100)),
+      m_samplePeriod(0),
+      m_randomStartPhase(false),
+      m_updateJitter(0.0),
+      m_updateTimerWheel(false),
+      m_initialized(false)
 {
     NS_LOG_FUNCTION(this);
     m_rand = CreateObject<UniformRandomVariable>();
+    m_jitter = CreateObject<UniformRandomVariable>();
 }
 
 DDRRouting::~DDRRouting()
@@ -88,175 +400,194 @@ DDRRouting::~DDRRouting()
     NS_LOG_FUNCTION(this);
 }
 
-Ptr<Ipv4Route>
-DDRRouting::RouteOutput(Ptr<Packet> p,
-                        const Ipv4Header& header,
-                        Ptr<NetDevice> oif,
-                        Socket::SocketErrno& sockerr)
-{
-    // std::cout << "at Node: " << m_ipv4->GetNetDevice (0)->GetNode ()->GetId () << "RouteOutput"
-    // << std::endl;
-    NS_LOG_FUNCTION(this << p << &header << oif << &sockerr);
-    //
-    // First, see if this is a multicast packet we have a route for.  If we
-    // have a route, then send the packet down each of the specified interfaces.
-    //
-    if (header.GetDestination().IsMulticast())
-    {
-        NS_LOG_LOGIC("Multicast destination-- returning false");
-        return 0; // Let other routing protocols try to handle this
-    }
+/**
+ * \param metaTag the metadata of a delay guaranteed packet
+ * \return the budget the packet has left, in us, 0 if it is over
+ */
+static uint32_t
+GetRemainingBudget(const RomamMetaTag& metaTag)
+{
+    int64_t deadline = metaTag.GetBudget() + metaTag.GetTimestamp().GetMicroSeconds();
+    int64_t now = Simulator::Now().GetMicroSeconds();
+    return deadline < now ? 0 : deadline - now;
+}
 
+Ptr<Ipv4Route>
+DDRRouting::SelectOutputRoute(Ptr<Packet> p, const Ipv4Header& header, Ptr<NetDevice> oif)
+{
     //
     // See if this is a Delay-Guarenteed packet we have a route for.
     //
-    NS_LOG_LOGIC("Delay-Guarenteed destination- looking up");
     Ptr<Ipv4Route> rtentry;
-    BudgetTag budgetTag;
+    RomamMetaTag metaTag;
     if (!p)
     {
-        rtentry = LookupECMPRoute(header.GetDestination(), oif);
+        rtentry = LookupOutputECMPRoute(header.GetDestination(), oif);
     }
-    else if (p->PeekPacketTag(budgetTag))
+    else if (RomamMetaTag::Peek(p, metaTag) && metaTag.HasBudget())
     {
-        switch (m_routeSelectMode)
+        RomamMetaTag routed = metaTag;
+        if (m_budgetAdmission != ADMIT_ALL && !IsBudgetFeasible(header.GetDestination(), metaTag))
         {
-        case NONE:
-            rtentry = LookupECMPRoute(header.GetDestination(), oif);
-            break;
-        case KSHORT:
-            rtentry = LookupKShortRoute(header.GetDestination(), p, oif);
-            break;
-        case DGR:
-            rtentry = LookupDGRRoute(header.GetDestination(), p, oif);
-            break;
-        case DDR:
-            rtentry = LookupDDRRoute(header.GetDestination(), p, oif);
-            break;
-        default:
-            rtentry = LookupECMPRoute(header.GetDestination(), oif);
+            CountLookup(RoutingStats::ADMISSION_REJECTS);
+            if (m_budgetAdmission == ADMIT_DROP)
+            {
+                ROMAM_HOT_LOG_LOGIC("No route can meet the budget, dropping the packet");
+                return nullptr;
+            }
+            ROMAM_HOT_LOG_LOGIC("No route can meet the budget, sending the packet as best effort");
+            routed.ClearPriority();
+            rtentry = LookupOutputECMPRoute(header.GetDestination(), oif);
+        }
+        else
+        {
+            if (m_agentChannel && !oif)
+            {
+                rtentry = LookupAgentRoute(header.GetDestination(), routed, nullptr);
+            }
+            if (!rtentry)
+            {
+                switch (m_routeSelectMode)
+                {
+                case NONE:
+                    rtentry = m_splitPolicy == SPLIT_OFF || oif
+                                  ? LookupOutputECMPRoute(header.GetDestination(), oif)
+                                  : LookupSplitRoute(header.GetDestination(),
+                                                     nullptr,
+                                                     GetSplitHash(header, p));
+                    break;
+                case KSHORT:
+                    rtentry = LookupKShortRoute(
+                        header.GetDestination(),
+                        routed,
+                        oif,
+                        m_splitPolicy == SPLIT_OFF ? 0 : GetSplitHash(header, p));
+                    break;
+                case DGR:
+                case DGR_DAG:
+                    rtentry = LookupDGRRoute(header.GetDestination(), routed, oif);
+                    break;
+                case POLICY:
+                    if (!oif)
+                    {
+                        rtentry = LookupPolicyRoute(header.GetDestination(), routed, nullptr);
+                    }
+                    if (rtentry)
+                    {
+                        break;
+                    }
+                    // no decision for the key, DDR decides
+                    [[fallthrough]];
+                case DDR:
+                case DDR_DAG:
+                    rtentry = LookupDDRRoute(
+                        header.GetDestination(),
+                        routed,
+                        oif,
+                        m_decisionCache.GetSize() > 0 ? FlowCache::HashFlow(header, p) : 0);
+                    break;
+                default:
+                    rtentry = LookupECMPRoute(header.GetDestination(), oif);
+                }
+            }
+        }
+        if (rtentry && !(routed == metaTag))
+        {
+            p->ReplacePacketTag(routed);
         }
-        // rtentry = LookupDGRRoute (header.GetDestination (), p, oif);
-    }
-    else
-    {
-        rtentry = LookupECMPRoute(header.GetDestination(), oif);
-    }
-
-    if (rtentry)
-    {
-        sockerr = Socket::ERROR_NOTERROR;
     }
     else
     {
-        sockerr = Socket::ERROR_NOROUTETOHOST;
+        rtentry = LookupOutputECMPRoute(header.GetDestination(), oif);
     }
     return rtentry;
 }
 
-bool
-DDRRouting::RouteInput(Ptr<const Packet> p,
-                       const Ipv4Header& header,
-                       Ptr<const NetDevice> idev,
-                       const UnicastForwardCallback& ucb,
-                       const MulticastForwardCallback& mcb,
-                       const LocalDeliverCallback& lcb,
-                       const ErrorCallback& ecb)
+Ptr<Ipv4Route>
+DDRRouting::SelectInputRoute(Ptr<const Packet>& p,
+                             const Ipv4Header& header,
+                             Ptr<const NetDevice> idev)
 {
-    NS_LOG_FUNCTION(this << p << header << header.GetSource() << header.GetDestination() << idev
-                         << &lcb << &ecb);
-    // Check if input device supports IP
-    NS_ASSERT(m_ipv4->GetInterfaceForDevice(idev) >= 0);
-    uint32_t iif = m_ipv4->GetInterfaceForDevice(idev);
-
-    if (m_ipv4->IsDestinationAddress(header.GetDestination(), iif))
+    Ptr<Ipv4Route> rtentry;
+    RomamMetaTag metaTag;
+    if (RomamMetaTag::Peek(p, metaTag) && metaTag.HasBudget())
     {
-        if (!lcb.IsNull())
+        RomamMetaTag routed = metaTag;
+        if (m_agentChannel)
         {
-            NS_LOG_LOGIC("Local delivery to " << header.GetDestination());
-            // std::cout << "Local delivery to " << header.GetDestination () << std::endl;
-            lcb(p, header, iif);
-            return true;
+            rtentry = LookupAgentRoute(header.GetDestination(), routed, idev);
         }
-        else
+        if (!rtentry)
         {
-            // The local delivery callback is null.  This may be a multicast
-            // or broadcast packet, so return false so that another
-            // multicast routing protocol can handle it.  It should be possible
-            // to extend this to explicitly check whether it is a unicast
-            // packet, and invoke the error callback if so
-            // std::cout << "ERROR !!!!" << std::endl;
-            return false;
+            switch (m_routeSelectMode)
+            {
+            case NONE:
+                rtentry = m_splitPolicy == SPLIT_OFF
+                              ? LookupECMPRoute(header.GetDestination())
+                              : LookupSplitRoute(header.GetDestination(),
+                                                 idev,
+                                                 GetSplitHash(header, p));
+                break;
+            case KSHORT:
+                rtentry = LookupKShortRoute(
+                    header.GetDestination(),
+                    routed,
+                    idev,
+                    m_splitPolicy == SPLIT_OFF ? 0 : GetSplitHash(header, p));
+                break;
+            case DGR:
+            case DGR_DAG:
+                rtentry = LookupDGRRoute(header.GetDestination(), routed, idev);
+                break;
+            case POLICY:
+                rtentry = LookupPolicyRoute(header.GetDestination(), routed, idev);
+                if (rtentry)
+                {
+                    break;
+                }
+                // no decision for the key, DDR decides
+                [[fallthrough]];
+            case DDR:
+            case DDR_DAG:
+                rtentry = LookupDDRRoute(
+                    header.GetDestination(),
+                    routed,
+                    idev,
+                    m_decisionCache.GetSize() > 0 ? FlowCache::HashFlow(header, p) : 0);
+                break;
+            default:
+                rtentry = LookupECMPRoute(header.GetDestination());
+            }
         }
-    }
-    // Check if input device supports IP forwarding
-    if (m_ipv4->IsForwarding(iif) == false)
-    {
-        NS_LOG_LOGIC("Forwarding disabled for this interface");
-        // std::cout << "RI: Forwarding disabled for this interface" << std::endl;
-        ecb(p, header, Socket::ERROR_NOROUTETOHOST);
-        return true;
-    }
-    // Next, try to find a route
-    NS_LOG_LOGIC("Unicast destination- looking up global route");
-    Ptr<Ipv4Route> rtentry;
-    BudgetTag budgetTag;
-    Ptr<Packet> p_copy;
-    if (p->PeekPacketTag(budgetTag))
-    {
-        p_copy = p->Copy();
-        switch (m_routeSelectMode)
+        if (rtentry && !(routed == metaTag))
         {
-        case NONE:
-            rtentry = LookupECMPRoute(header.GetDestination());
-            break;
-        case KSHORT:
-            rtentry = LookupKShortRoute(header.GetDestination(), p_copy, idev);
-            break;
-        case DGR:
-            rtentry = LookupDGRRoute(header.GetDestination(), p_copy, idev);
-            break;
-        case DDR:
-            rtentry = LookupDDRRoute(header.GetDestination(), p_copy, idev);
-            break;
-        default:
-            rtentry = LookupECMPRoute(header.GetDestination());
+            // the one copy of the packet, to write its new metadata
+            Ptr<Packet> copy = p->Copy();
+            copy->ReplacePacketTag(routed);
+            p = copy;
         }
-        // rtentry = LookupDGRRoute (header.GetDestination (), p_copy, idev);
     }
     else
     {
         rtentry = LookupECMPRoute(header.GetDestination());
     }
-    if (rtentry)
-    {
-        // std::cout << "find a way" << std::endl;
-        if (p_copy)
-        {
-            p = p_copy->Copy();
-        }
-        NS_LOG_LOGIC("Found unicast destination- calling unicast callback");
-        ucb(rtentry, p, header);
-        return true;
-    }
-    else
-    {
-        NS_LOG_LOGIC("Did not find unicast destination- returning false");
-        return false; // Let other routing protocols try to handle this
-                      // route request.
-    }
+    return rtentry;
 }
 
 void
 DDRRouting::NotifyInterfaceUp(uint32_t i)
 {
     NS_LOG_FUNCTION(this << i);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    if (m_initialized)
+    {
+        BuildInterfaceBindings();
+    }
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_FUNCTION("Update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeSPFRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -264,12 +595,16 @@ void
 DDRRouting::NotifyInterfaceDown(uint32_t i)
 {
     NS_LOG_FUNCTION(this << i);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    if (m_initialized)
+    {
+        BuildInterfaceBindings();
+    }
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_FUNCTION("Update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeSPFRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -277,12 +612,17 @@ void
 DDRRouting::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this << interface << address);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    InvalidateIpv4Routes();
+    if (m_initialized)
+    {
+        BuildInterfaceBindings();
+    }
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_FUNCTION("Update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeSPFRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -290,21 +630,68 @@ void
 DDRRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this << interface << address);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    InvalidateIpv4Routes();
+    if (m_initialized)
+    {
+        BuildInterfaceBindings();
+    }
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_FUNCTION("Update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeSPFRoutes();
+        RecomputeRoutes();
     }
 }
 
 void
-DDRRouting::SetIpv4(Ptr<Ipv4> ipv4)
+DDRRouting::SetDecisionCacheSize(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    m_decisionCache.SetSize(size);
+}
+
+uint32_t
+DDRRouting::GetDecisionCacheSize() const
+{
+    return m_decisionCache.GetSize();
+}
+
+void
+DDRRouting::SetDecisionCacheTimeout(Time timeout)
+{
+    NS_LOG_FUNCTION(this << timeout);
+    m_decisionCacheTimeout = timeout;
+    m_decisionCache.SetTimeout(timeout);
+}
+
+Time
+DDRRouting::GetDecisionCacheTimeout() const
+{
+    return m_decisionCacheTimeout;
+}
+
+void
+DDRRouting::SetOutputRouteCacheSize(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    m_outputRouteCache.SetSize(size);
+}
+
+uint32_t
+DDRRouting::GetOutputRouteCacheSize() const
+{
+    return m_outputRouteCache.GetSize();
+}
+
+void
+DDRRouting::RecomputeRoutes()
 {
-    NS_LOG_FUNCTION(this << ipv4);
-    NS_ASSERT(!m_ipv4 && ipv4);
-    m_ipv4 = ipv4;
+    NS_LOG_FUNCTION(this);
+    uint32_t nodeId = m_ipv4->GetObject<Node>()->GetId();
+    RouteManager::ScheduleRecompute(nodeId,
+                                    m_incrementalUpdates ? &RouteManager::UpdateSPFRoutes
+                                                         : &RouteManager::RecomputeSPFRoutes);
 }
 
 // Formatted like output of "route -n" command
@@ -375,564 +762,1593 @@ DDRRouting::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit)
     (*os).copyfmt(oldState);
 }
 
-void
-DDRRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
+uint32_t
+DDRRouting::GetNHostRoutes() const
 {
-    NS_LOG_FUNCTION(this << dest << nextHop << interface);
-    ShortestPathForestRIE* route = new ShortestPathForestRIE();
-    *route = ShortestPathForestRIE::CreateHostRouteTo(dest, nextHop, interface);
-    m_hostRoutes.push_back(route);
+    return m_hostRoutes.size();
 }
 
-void
-DDRRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
+ShortestPathForestRIE*
+DDRRouting::GetHostRoute(uint32_t index) const
 {
-    NS_LOG_FUNCTION(this << dest << interface);
-    ShortestPathForestRIE* route = new ShortestPathForestRIE();
-    *route = ShortestPathForestRIE::CreateHostRouteTo(dest, interface);
-    m_hostRoutes.push_back(route);
+    const HostRouteRef& ref = m_hostRoutes[index];
+    const NextHopGroup* group = LookupNextHopGroup(ref.dest);
+    NS_ASSERT_MSG(group, "Host route missing from destination index");
+    const ShortestPathForestRIE* route = m_routePool.Get(group->routes[ref.rank]);
+    m_hostRouteView = ShortestPathForestRIE::CreateHostRouteTo(Ipv4Address(ref.dest),
+                                                               route->GetGateway(),
+                                                               route->GetInterface(),
+                                                               route->GetNextIface(),
+                                                               route->GetDistance());
+    return &m_hostRouteView;
 }
 
 void
-DDRRouting::AddHostRouteTo(Ipv4Address dest,
-                           Ipv4Address nextHop,
-                           uint32_t interface,
-                           uint32_t nextInterface,
-                           uint32_t distance)
+DDRRouting::RemoveHostRoute(uint32_t index)
 {
-    NS_LOG_FUNCTION(this << dest << nextHop << interface << nextInterface << distance);
-    ShortestPathForestRIE* route = new ShortestPathForestRIE();
-    *route =
-        ShortestPathForestRIE::CreateHostRouteTo(dest, nextHop, interface, nextInterface, distance);
-    m_hostRoutes.push_back(route);
+    NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
+    HostRouteRef ref = m_hostRoutes[index];
+    NextHopGroup* group = UnshareNextHopGroup(ref.dest);
+    RoutePool::Handle handle = group->routes[ref.rank];
+    ShortestPathForestRIE* route = m_routePool.Get(handle);
+    // keep the insertion order, RouteOutput/RouteInput tie-breaks depend on it
+    group->routes.erase(group->routes.begin() + ref.rank);
+    for (RankedHostRoutes::iterator j = group->byDistance.begin(); j != group->byDistance.end();
+         j++)
+    {
+        if (j->route == route)
+        {
+            group->byDistance.erase(j);
+            break;
+        }
+    }
+    IndexCandidates(group);
+    m_routePool.Free(handle);
+    if (group->routes.empty())
+    {
+        delete group;
+        m_hostRouteIndex[AddressInterner::Get()->FindAddress(Ipv4Address(ref.dest))] = nullptr;
+    }
+    m_hostRoutes.erase(m_hostRoutes.begin() + index);
+    for (HostRoutes::iterator i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    {
+        if (i->dest == ref.dest && i->rank > ref.rank)
+        {
+            i->rank--;
+        }
+    }
+    NS_LOG_LOGIC("Done removing host route "
+                 << index << "; host route remaining size = " << m_hostRoutes.size());
 }
 
 void
-DDRRouting::AddNetworkRouteTo(Ipv4Address network,
-                              Ipv4Mask networkMask,
-                              Ipv4Address nextHop,
-                              uint32_t interface)
+DDRRouting::ClearHostRoutes()
 {
-    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
-    ShortestPathForestRIE* route = new ShortestPathForestRIE();
-    *route = ShortestPathForestRIE::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
-    m_networkRoutes.push_back(route);
+    for (NextHopGroup* group : m_hostRouteIndex)
+    {
+        if (group && --group->nDests == 0)
+        {
+            delete group;
+        }
+    }
+    m_hostRouteIndex.clear();
+    m_hostRoutes.clear();
+    m_routePool.Clear();
 }
 
 void
-DDRRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface)
+DDRRouting::NotifyRoutesChanged()
 {
-    NS_LOG_FUNCTION(this << network << networkMask << interface);
-    ShortestPathForestRIE* route = new ShortestPathForestRIE();
-    *route = ShortestPathForestRIE::CreateNetworkRouteTo(network, networkMask, interface);
-    m_networkRoutes.push_back(route);
+    m_decisionGeneration++;
+    m_tableGeneration++;
 }
 
 void
-DDRRouting::AddASExternalRouteTo(Ipv4Address network,
-                                 Ipv4Mask networkMask,
-                                 Ipv4Address nextHop,
-                                 uint32_t interface)
+DDRRouting::NotifyRoutesInstalled()
+{
+    ShareNextHopGroups();
+    BuildHostRouteSplits();
+}
+
+std::size_t
+DDRRouting::GetMemoryFootprint() const
+{
+    std::size_t bytes = m_routePool.GetMemoryUsage() +
+                        m_hostRoutes.capacity() * sizeof(HostRouteRef) + GetPrefixRouteFootprint();
+    // the interner is shared by every node, only the slots of this one are counted
+    bytes += m_hostRouteIndex.capacity() * sizeof(NextHopGroup*);
+    std::unordered_set<const NextHopGroup*> counted;
+    for (const NextHopGroup* group : m_hostRouteIndex)
+    {
+        if (group && counted.insert(group).second)
+        {
+            bytes += sizeof(NextHopGroup) + GetRouteTableFootprint(group->routes, m_routePool) +
+                     group->byDistance.capacity() * sizeof(RankedHostRoute) +
+                     GetCandidateArraysFootprint(group->candidates) +
+                     group->successors.capacity() * sizeof(RankedHostRoute) +
+                     GetCandidateArraysFootprint(group->successorCandidates) +
+                     GetDecisionTableFootprint(group->dgrTable);
+        }
+    }
+    bytes += m_kShortestPaths.GetMemoryUsage() + m_tsdb.GetMemoryFootprint() +
+             m_bindings.capacity() * sizeof(InterfaceBinding) +
+             m_sentStates.capacity() * sizeof(int32_t) +
+             m_receivedNses.capacity() * sizeof(DgrNse) + m_deltaStates.capacity() * sizeof(int) +
+             m_downstreamEpochs.capacity() * sizeof(uint32_t) +
+             m_sampledStates.capacity() * sizeof(int32_t) +
+             m_sentDownstreams.capacity() * sizeof(DgrDownstream) +
+             m_oracleQueues.capacity() * sizeof(Ptr<DDRQueueDisc>) +
+             m_oracleOffsets.capacity() * sizeof(uint32_t) +
+             m_feasibleRoutes.capacity() * sizeof(uint32_t) +
+             m_stateEpochs.capacity() * sizeof(uint32_t) +
+             m_localLevels.capacity() * sizeof(uint32_t) +
+             m_hostRouteSplits.GetMemoryUsage() + m_kShortestSplits.GetMemoryUsage() +
+             m_decisionCache.GetMemoryUsage() + m_outputRouteCache.GetMemoryUsage();
+    return bytes;
+}
+
+int64_t
+DDRRouting::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_rand->SetStream(stream);
+    m_jitter->SetStream(stream + 1);
+    return 2;
+}
+
+KShortestPathTable&
+DDRRouting::GetKShortestPathTable()
 {
-    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
-    ShortestPathForestRIE* route = new ShortestPathForestRIE();
-    *route = ShortestPathForestRIE::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
-    m_ASexternalRoutes.push_back(route);
+    // the paths are about to change
+    m_kShortestSplits.Clear();
+    return m_kShortestPaths;
 }
 
 uint32_t
-DDRRouting::GetNRoutes(void) const
+DDRRouting::GetKShortestHotDestinations() const
 {
-    NS_LOG_FUNCTION(this);
-    uint32_t n = 0;
-    n += m_hostRoutes.size();
-    n += m_networkRoutes.size();
-    n += m_ASexternalRoutes.size();
-    return n;
+    return m_hotDestinations;
 }
 
-ShortestPathForestRIE*
-DDRRouting::GetRoute(uint32_t index) const
+void
+DDRRouting::CountKShortestLookup(uint32_t d)
 {
-    NS_LOG_FUNCTION(this << index);
-    if (index < m_hostRoutes.size())
+    if (m_hotCounts.size() != m_kShortestPaths.GetNDestinations())
     {
-        uint32_t tmp = 0;
-        for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
-        {
-            if (tmp == index)
-            {
-                return *i;
-            }
-            tmp++;
-        }
+        // a new table, its destinations all trimmed or all full
+        m_hotCounts.assign(m_kShortestPaths.GetNDestinations(), 0);
+        m_hotWindowEnd = Time();
     }
-    index -= m_hostRoutes.size();
-    uint32_t tmp = 0;
-    if (index < m_networkRoutes.size())
+    if (Simulator::Now() >= m_hotWindowEnd)
     {
-        for (NetworkRoutesCI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
-        {
-            if (tmp == index)
-            {
-                return *j;
-            }
-            tmp++;
-        }
+        ReviewHotDestinations();
     }
-    index -= m_networkRoutes.size();
-    tmp = 0;
-    for (ASExternalRoutesCI k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+    m_hotCounts[d]++;
+    if (m_kShortestPaths.IsTrimmed(d) && m_nFull < m_hotDestinations)
     {
-        if (tmp == index)
-        {
-            return *k;
-        }
-        tmp++;
+        // counted even if it fails, not to try again on every packet
+        m_nFull++;
+        RouteManager::RestoreKShortestPaths(m_ipv4->GetObject<Node>()->GetId(), d);
     }
-    NS_ASSERT(false);
-    // quiet compiler.
-    return 0;
 }
 
 void
-DDRRouting::RemoveRoute(uint32_t index)
+DDRRouting::ReviewHotDestinations()
 {
-    NS_LOG_FUNCTION(this << index);
-    if (index < m_hostRoutes.size())
+    NS_LOG_FUNCTION(this);
+    std::vector<uint32_t> hot;
+    for (uint32_t d = 0; d < m_hotCounts.size(); d++)
     {
-        uint32_t tmp = 0;
-        for (HostRoutesI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+        if (m_hotCounts[d] > 0)
         {
-            if (tmp == index)
-            {
-                NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
-                delete *i;
-                m_hostRoutes.erase(i);
-                NS_LOG_LOGIC("Done removing host route "
-                             << index << "; host route remaining size = " << m_hostRoutes.size());
-                return;
-            }
-            tmp++;
+            hot.push_back(d);
         }
     }
-    index -= m_hostRoutes.size();
-    uint32_t tmp = 0;
-    for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    if (hot.size() > m_hotDestinations)
+    {
+        auto busier = [this](uint32_t a, uint32_t b) { return m_hotCounts[a] > m_hotCounts[b]; };
+        std::nth_element(hot.begin(), hot.begin() + m_hotDestinations, hot.end(), busier);
+        hot.resize(m_hotDestinations);
+    }
+    std::vector<bool> full(m_hotCounts.size(), false);
+    uint32_t nodeId = m_ipv4->GetObject<Node>()->GetId();
+    for (uint32_t d : hot)
     {
-        if (tmp == index)
+        full[d] = true;
+        if (m_kShortestPaths.IsTrimmed(d))
         {
-            NS_LOG_LOGIC("Removing route " << index << "; size = " << m_networkRoutes.size());
-            delete *j;
-            m_networkRoutes.erase(j);
-            NS_LOG_LOGIC("Done removing network route "
-                         << index << "; network route remaining size = " << m_networkRoutes.size());
-            return;
+            RouteManager::RestoreKShortestPaths(nodeId, d);
         }
-        tmp++;
     }
-    index -= m_networkRoutes.size();
-    tmp = 0;
-    for (ASExternalRoutesI k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+    for (uint32_t d = 0; d < full.size(); d++)
     {
-        if (tmp == index)
+        if (!full[d] && !m_kShortestPaths.IsTrimmed(d))
         {
-            NS_LOG_LOGIC("Removing route " << index << "; size = " << m_ASexternalRoutes.size());
-            delete *k;
-            m_ASexternalRoutes.erase(k);
-            NS_LOG_LOGIC("Done removing network route "
-                         << index << "; network route remaining size = " << m_networkRoutes.size());
-            return;
+            GetKShortestPathTable().Trim(d);
         }
-        tmp++;
     }
-    NS_ASSERT(false);
+    NS_LOG_LOGIC(hot.size() << " destinations keep their k shortest paths");
+    m_nFull = hot.size();
+    std::fill(m_hotCounts.begin(), m_hotCounts.end(), 0);
+    m_hotWindowEnd = Simulator::Now() + m_hotWindow;
 }
 
-int64_t
-DDRRouting::AssignStreams(int64_t stream)
+void
+DDRRouting::AddHostRoute(const ShortestPathForestRIE& route)
 {
-    NS_LOG_FUNCTION(this << stream);
-    m_rand->SetStream(stream);
-    return 1;
+    NS_LOG_FUNCTION(this << route);
+    NS_ASSERT(route.IsHost());
+    uint32_t dest = route.GetDest().Get();
+    NextHopGroup* group = UnshareNextHopGroup(dest);
+    RoutePool::Handle handle = m_routePool.Allocate(route);
+    m_hostRoutes.push_back(HostRouteRef{dest, static_cast<uint32_t>(group->routes.size())});
+    group->routes.push_back(handle);
+    // after the routes of the same distance, which keeps them in insertion order
+    RankedHostRoute ranked = {m_routePool.Get(handle), route.GetDistance(), m_hostRouteSequence++};
+    RankedHostRoutes::iterator at =
+        std::upper_bound(group->byDistance.begin(),
+                         group->byDistance.end(),
+                         ranked,
+                         [](const RankedHostRoute& a, const RankedHostRoute& b) {
+                             return a.distance < b.distance;
+                         });
+    group->byDistance.insert(at, ranked);
+    IndexCandidates(group);
 }
 
-Ptr<Ipv4Route>
-DDRRouting::LookupECMPRoute(Ipv4Address dest, Ptr<NetDevice> oif)
+void
+DDRRouting::FillCandidateArrays(const RankedHostRoutes& routes, CandidateArrays& candidates)
 {
-    /**
-     * Get the shortest path in the routing table
-     */
-    NS_LOG_FUNCTION(this << dest << oif);
-    NS_LOG_LOGIC("Looking for route for destination " << dest);
+    candidates.distance.clear();
+    candidates.iface.clear();
+    candidates.nextIface.clear();
+    // the downstream delays are dropped until the next updates of the neighbors
+    candidates.downstream.assign(routes.size(), 0);
+    candidates.downstreamEpoch.assign(routes.size(), 0);
+    for (const RankedHostRoute& ranked : routes)
+    {
+        candidates.distance.push_back(ranked.distance);
+        candidates.iface.push_back(ranked.route->GetInterface());
+        candidates.nextIface.push_back(ranked.route->GetNextIface());
+    }
+}
 
-    Ptr<Ipv4Route> rtentry = 0;
-    // store all available routes that bring packets to their destination
-    typedef std::vector<ShortestPathForestRIE*> RouteVec_t;
-    RouteVec_t allRoutes;
+std::size_t
+DDRRouting::GetCandidateArraysFootprint(const CandidateArrays& candidates)
+{
+    return (candidates.distance.capacity() + candidates.iface.capacity() +
+            candidates.nextIface.capacity() + candidates.downstream.capacity() +
+            candidates.downstreamEpoch.capacity()) *
+           sizeof(uint32_t);
+}
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+std::size_t
+DDRRouting::GetDecisionTableFootprint(const NextHopGroup::DecisionTable& table)
+{
+    std::size_t bytes =
+        table.ifaces.capacity() * sizeof(uint32_t) + GetHashMapFootprint(table.rows);
+    for (const auto& row : table.rows)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
-        {
-            if (oif)
-            {
-                if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
-            }
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found DGR host route" << *i);
-        }
+        bytes += row.second.capacity() * sizeof(uint32_t);
     }
-    if (allRoutes.size() > 0) // if route(s) is found
+    return bytes;
+}
+
+void
+DDRRouting::IndexCandidates(NextHopGroup* group)
+{
+    FillCandidateArrays(group->byDistance, group->candidates);
+    group->successors.clear();
+    // until the routes are installed
+    group->split = NO_SPLIT;
+    bool split = m_routeSelectMode == NONE && m_splitPolicy != SPLIT_OFF;
+    if ((IsLoopFreeMode() || split) && !group->byDistance.empty())
     {
-        uint32_t routRef = 0;
-        uint32_t shortestDist = allRoutes.at(0)->GetDistance();
-        for (uint32_t i = 0; i < allRoutes.size(); i++)
+        uint64_t shortest = group->byDistance.front().distance;
+        for (const RankedHostRoute& ranked : group->byDistance)
         {
-            if (allRoutes.at(i)->GetDistance() < shortestDist)
+            // dist (N, D) < dist (S, D), the metric of the link to N moved over
+            uint16_t metric = m_ipv4->GetMetric(ranked.route->GetInterface());
+            if (ranked.distance < shortest + metric)
             {
-                routRef = i;
-                shortestDist = allRoutes.at(i)->GetDistance();
+                group->successors.push_back(ranked);
             }
         }
-        ShortestPathForestRIE* route = allRoutes.at(routRef);
-
-        // create a Ipv4Route object from the selected routing table entry
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(route->GetInterface(), 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        uint32_t interfaceIdx = route->GetInterface();
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
-        return rtentry;
-    }
-    else
-    {
-        return 0;
     }
+    FillCandidateArrays(group->successors, group->successorCandidates);
 }
 
-Ptr<Ipv4Route>
-DDRRouting::LookupDDRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
+DDRRouting::NextHopGroup*
+DDRRouting::UnshareNextHopGroup(uint32_t dest)
 {
-    BudgetTag bgtTag;
-    TimestampTag timeTag;
-    p->PeekPacketTag(bgtTag);
-    p->PeekPacketTag(timeTag);
-    // avoid loop
-    DistTag distTag;
-    uint32_t dist = UINT32_MAX;
-    dist -= 1;
-    if (p->PeekPacketTag(distTag))
+    uint32_t index = AddressInterner::Get()->InternAddress(Ipv4Address(dest));
+    if (index >= m_hostRouteIndex.size())
     {
-        dist = distTag.GetDistance();
+        m_hostRouteIndex.resize(index + 1, nullptr);
     }
-
-    // budget in microseconds
-    uint32_t bgt;
-    if (bgtTag.GetBudget() + timeTag.GetTimestamp().GetMicroSeconds() <
-        Simulator::Now().GetMicroSeconds())
+    NextHopGroup*& group = m_hostRouteIndex[index];
+    if (!group)
     {
-        bgt = 0;
+        group = new NextHopGroup();
+        group->nDests = 1;
+        return group;
     }
-    else
+    if (group->nDests == 1)
     {
-        bgt = (bgtTag.GetBudget() + timeTag.GetTimestamp().GetMicroSeconds() -
-               Simulator::Now().GetMicroSeconds());
+        return group;
     }
-    NS_LOG_FUNCTION(this << dest << idev);
-    NS_LOG_LOGIC("Looking for route for destination " << dest);
-    Ptr<Ipv4Route> rtentry = 0;
-    // store all available routes that bring packets to their destination
-    typedef std::vector<ShortestPathForestRIE*> RouteVec_t;
-    // typedef std::vector<ShortestPathForestRIE *>::const_iterator RouteVecCI_t;
-    RouteVec_t allRoutes;
-
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    NS_LOG_LOGIC("Copying the next-hop group of " << Ipv4Address(dest));
+    NextHopGroup* shared = group;
+    shared->nDests--;
+    group = new NextHopGroup();
+    group->nDests = 1;
+    group->routes.reserve(shared->routes.size());
+    std::unordered_map<const ShortestPathForestRIE*, ShortestPathForestRIE*> copies;
+    for (RoutePool::Handle handle : shared->routes)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
-        {
-            if (idev)
-            {
-                if (idev == m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
-            }
-
-            // if interface is down, continue
-            if (!m_ipv4->IsUp((*i)->GetInterface()))
-                continue;
-
-            // get the local queue delay in microsecond
-            Ptr<NetDevice> dev_local = m_ipv4->GetNetDevice((*i)->GetInterface());
-            // get the queue disc on the device
-            Ptr<QueueDisc> disc = m_ipv4->GetObject<Node>()
-                                      ->GetObject<TrafficControlLayer>()
-                                      ->GetRootQueueDiscOnDevice(dev_local);
-            Ptr<DDRQueueDisc> dvq = DynamicCast<DDRQueueDisc>(disc);
-            // uint32_t status_local = dvq->GetQueueStatus ();
-            // uint32_t delay_local = status_local * 2000;
-            uint32_t delay_local = dvq->GetQueueDelay();
-
-            // Get the neighbor queue status in microsecond
-            uint32_t delay_neighbor = 0;
-            if ((*i)->GetNextIface() != 0xffffffff)
-            {
-                uint32_t iface = (*i)->GetInterface();
-                uint32_t niface = (*i)->GetNextIface();
-                NeighborStatusEntry* entry = m_tsdb.GetNeighborStatusEntry(iface);
-                StatusUnit* su = entry->GetStatusUnit(niface);
-                delay_neighbor = su->GetEstimateDelayDDR();
-                // std::cout << "Neighbor delay: " << delay_neighbor << std::endl;
-            }
-            // in microsecond
-            uint32_t estimate_delay =
-                ((*i)->GetDistance() + 1) * 1000 + delay_local + delay_neighbor;
-
-            if (estimate_delay > bgt)
-            {
-                NS_LOG_LOGIC("Too far to the destination, skipping");
-                continue;
-            }
-
-            if ((*i)->GetDistance() > dist)
-            {
-                NS_LOG_LOGIC("Loop avoidance, skipping");
-                continue;
-            }
-
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size()
-                         << "Found DGR host route" << *i << " with Cost: " << (*i)->GetDistance());
-        }
+        const ShortestPathForestRIE* route = m_routePool.Get(handle);
+        RoutePool::Handle copy = m_routePool.Allocate(
+            ShortestPathForestRIE::CreateHostRouteTo(Ipv4Address(dest),
+                                                     route->GetGateway(),
+                                                     route->GetInterface(),
+                                                     route->GetNextIface(),
+                                                     route->GetDistance()));
+        group->routes.push_back(copy);
+        copies[route] = m_routePool.Get(copy);
     }
-    if (allRoutes.size() > 0) // if route(s) is found
+    group->byDistance = shared->byDistance;
+    group->candidates = shared->candidates;
+    group->successors = shared->successors;
+    group->successorCandidates = shared->successorCandidates;
+    for (RankedHostRoute& ranked : group->byDistance)
     {
-        uint32_t selectIndex = 0;
-        uint32_t shortestDist = allRoutes.at(0)->GetDistance();
-        for (uint32_t i = 0; i < allRoutes.size(); i++)
-        {
-            if (allRoutes.at(i)->GetDistance() < shortestDist)
-            {
-                selectIndex = i;
-                shortestDist = allRoutes.at(i)->GetDistance();
-            }
-        }
-
-        ShortestPathForestRIE* route = allRoutes.at(selectIndex);
-        uint32_t interfaceIdx = route->GetInterface();
-
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(interfaceIdx, 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
-
-        distTag.SetDistance(route->GetDistance());
-        p->ReplacePacketTag(distTag);
-        return rtentry;
+        ranked.route = copies[ranked.route];
     }
-    else
+    for (RankedHostRoute& ranked : group->successors)
     {
-        return LookupECMPRoute(dest);
+        ranked.route = copies[ranked.route];
     }
+    return group;
 }
 
-Ptr<Ipv4Route>
-DDRRouting::LookupDGRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
+/**
+ * \param route a host route
+ * \return the hash of the next hop of the route
+ */
+static std::size_t
+HashNextHop(const ShortestPathForestRIE* route)
 {
-    // std::cout <<"DGR routing" << std::endl;
-    BudgetTag bgtTag;
-    TimestampTag timeTag;
-    p->PeekPacketTag(bgtTag);
-    p->PeekPacketTag(timeTag);
-    // avoid loop
-    DistTag distTag;
-    uint32_t dist = UINT32_MAX;
-    dist -= 1;
-    if (p->PeekPacketTag(distTag))
+    std::size_t hash = route->GetGateway().Get();
+    hash = hash * 31 + route->GetInterface();
+    hash = hash * 31 + route->GetNextIface();
+    hash = hash * 31 + route->GetDistance();
+    return hash;
+}
+
+/**
+ * \param a a host route
+ * \param b another host route
+ * \return true if both routes go through the same next hop, at the same distance
+ */
+static bool
+IsSameNextHop(const ShortestPathForestRIE* a, const ShortestPathForestRIE* b)
+{
+    return a->GetGateway() == b->GetGateway() && a->GetInterface() == b->GetInterface() &&
+           a->GetNextIface() == b->GetNextIface() && a->GetDistance() == b->GetDistance();
+}
+
+void
+DDRRouting::ShareNextHopGroups()
+{
+    NS_LOG_FUNCTION(this);
+    auto isSameNextHop = [this](RoutePool::Handle a, RoutePool::Handle b) {
+        return IsSameNextHop(m_routePool.Get(a), m_routePool.Get(b));
+    };
+    std::unordered_multimap<std::size_t, NextHopGroup*> groups;
+    uint32_t nShared = 0;
+    uint32_t nDests = 0;
+    for (NextHopGroup*& slot : m_hostRouteIndex)
     {
-        dist = distTag.GetDistance();
+        if (!slot)
+        {
+            continue;
+        }
+        nDests++;
+        NextHopGroup* group = slot;
+        std::size_t hash = group->routes.size();
+        for (RoutePool::Handle handle : group->routes)
+        {
+            hash = hash * 131 + HashNextHop(m_routePool.Get(handle));
+        }
+        NextHopGroup* same = nullptr;
+        auto range = groups.equal_range(hash);
+        for (auto j = range.first; j != range.second && !same; j++)
+        {
+            if (j->second == group || std::equal(group->routes.begin(),
+                                                 group->routes.end(),
+                                                 j->second->routes.begin(),
+                                                 j->second->routes.end(),
+                                                 isSameNextHop))
+            {
+                same = j->second;
+            }
+        }
+        if (!same)
+        {
+            groups.emplace(hash, group);
+            continue;
+        }
+        if (same == group)
+        {
+            continue;
+        }
+        // the ranks into the group stay valid, both groups list the same routes
+        if (--group->nDests == 0)
+        {
+            for (RoutePool::Handle handle : group->routes)
+            {
+                m_routePool.Free(handle);
+            }
+            delete group;
+        }
+        same->nDests++;
+        slot = same;
+        nShared++;
     }
+    NS_LOG_LOGIC(nShared << " of " << nDests
+                         << " destinations share the next-hop group of another one");
+}
 
-    // std::cout << "budget: " << bgtTag.GetBudget() << std::endl;
-    // budget in microseconds
-    uint32_t bgt;
-    if (bgtTag.GetBudget() + timeTag.GetTimestamp().GetMicroSeconds() <
-        Simulator::Now().GetMicroSeconds())
+const DDRRouting::HostRouteCandidates&
+DDRRouting::FindHostRoutes(Ipv4Address dest) const
+{
+    static const HostRouteCandidates noCandidates;
+    const NextHopGroup* group = LookupNextHopGroup(dest.Get());
+    if (!group)
     {
-        bgt = 0;
+        return noCandidates;
     }
-    else
+    return group->routes;
+}
+
+const DDRRouting::RankedHostRoutes&
+DDRRouting::FindHostRoutesByDistance(Ipv4Address dest) const
+{
+    static const RankedHostRoutes noCandidates;
+    const NextHopGroup* group = LookupNextHopGroup(dest.Get());
+    if (!group)
     {
-        bgt = (bgtTag.GetBudget() + timeTag.GetTimestamp().GetMicroSeconds() -
-               Simulator::Now().GetMicroSeconds());
+        return noCandidates;
     }
-    NS_LOG_FUNCTION(this << dest << idev);
-    NS_LOG_LOGIC("Looking for route for destination " << dest);
-    Ptr<Ipv4Route> rtentry = 0;
-    // store all available routes that bring packets to their destination
-    typedef std::vector<ShortestPathForestRIE*> RouteVec_t;
-    // typedef std::vector<ShortestPathForestRIE *>::const_iterator RouteVecCI_t;
-    RouteVec_t allRoutes;
+    return group->byDistance;
+}
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+const DDRRouting::NextHopGroup&
+DDRRouting::FindNextHopGroup(Ipv4Address dest) const
+{
+    static const NextHopGroup noGroup = NextHopGroup();
+    const NextHopGroup* group = LookupNextHopGroup(dest.Get());
+    if (!group)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        return noGroup;
+    }
+    return *group;
+}
+
+DDRRouting::NextHopGroup*
+DDRRouting::LookupNextHopGroup(uint32_t dest) const
+{
+    // NO_INDEX is past the end of the slots, as is an address interned by another node
+    uint32_t index = AddressInterner::Get()->FindAddress(Ipv4Address(dest));
+    return index < m_hostRouteIndex.size() ? m_hostRouteIndex[index] : nullptr;
+}
+
+bool
+DDRRouting::IsBudgetFeasible(Ipv4Address dest, const RomamMetaTag& metaTag) const
+{
+    const CandidateArrays& candidates = FindNextHopGroup(dest).candidates;
+    if (candidates.distance.empty())
+    {
+        // no host route to bound the delay with, the network routes decide
+        return true;
+    }
+    // the candidates are sorted by distance, the first one is the lower bound
+    return static_cast<uint64_t>(candidates.distance[0]) * m_metricDelay <=
+           GetRemainingBudget(metaTag);
+}
+
+void
+DDRRouting::BuildInterfaceBindings()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t nInterfaces = m_ipv4->GetNInterfaces();
+    m_bindings.resize(nInterfaces);
+    m_nDownInterfaces = 0;
+    m_decisionGeneration++;
+    m_tableGeneration++;
+    Ptr<TrafficControlLayer> tc = m_ipv4->GetObject<Node>()->GetObject<TrafficControlLayer>();
+    for (uint32_t i = 0; i < nInterfaces; i++)
+    {
+        InterfaceBinding& binding = m_bindings[i];
+        binding.device = m_ipv4->GetNetDevice(i);
+        binding.qdisc = nullptr;
+        binding.up = m_ipv4->IsUp(i);
+        binding.metric = m_ipv4->GetMetric(i);
+        m_nDownInterfaces += binding.up ? 0 : 1;
+        if (tc && !DynamicCast<LoopbackNetDevice>(binding.device))
+        {
+            binding.qdisc = DynamicCast<DDRQueueDisc>(tc->GetRootQueueDiscOnDevice(binding.device));
+        }
+        if (binding.qdisc && !m_oracleNeighborState &&
+            (m_triggeredStatusUpdates || m_decisionCache.GetSize() > 0 || m_dgrDecisionTables))
+        {
+            binding.qdisc->SetStateChangeCallback(
+                m_tsdb.GetNStates(),
+                MakeCallback(&DDRRouting::NotifyQueueState, this));
+        }
+    }
+    m_tsdb.Resize(nInterfaces);
+    m_downstreamEpochs.resize(nInterfaces, 0);
+    m_stateEpochs.resize(nInterfaces, 0);
+    m_localLevels.resize(nInterfaces, 0);
+}
+
+void
+DDRRouting::BuildOracleQueues()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t nInterfaces = m_ipv4->GetNInterfaces();
+    m_oracleQueues.clear();
+    m_oracleOffsets.assign(1, 0);
+    for (uint32_t i = 0; i < nInterfaces; i++)
+    {
+        Ptr<NetDevice> device = m_ipv4->GetNetDevice(i);
+        Ptr<Channel> channel = device->GetChannel();
+        if (channel && channel->GetNDevices() == 2 && !DynamicCast<LoopbackNetDevice>(device))
         {
-            if (idev)
+            Ptr<NetDevice> peer = channel->GetDevice(channel->GetDevice(0) == device ? 1 : 0);
+            Ptr<Node> node = peer->GetNode();
+            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+            Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer>();
+            for (uint32_t j = 0; ipv4 && tc && j < ipv4->GetNInterfaces(); j++)
             {
-                if (idev == m_ipv4->GetNetDevice((*i)->GetInterface()))
+                m_oracleQueues.push_back(
+                    DynamicCast<DDRQueueDisc>(tc->GetRootQueueDiscOnDevice(ipv4->GetNetDevice(j))));
+            }
+        }
+        m_oracleOffsets.push_back(m_oracleQueues.size());
+    }
+}
+
+uint32_t
+DDRRouting::GetOracleDelay(uint32_t iface, uint32_t nextIface) const
+{
+    if (iface + 1 >= m_oracleOffsets.size())
+    {
+        return 0;
+    }
+    uint32_t slot = m_oracleOffsets[iface] + nextIface;
+    if (slot >= m_oracleOffsets[iface + 1] || !m_oracleQueues[slot])
+    {
+        return 0;
+    }
+    return m_oracleQueues[slot]->GetQueueDelay();
+}
+
+const DDRRouting::InterfaceBinding&
+DDRRouting::GetInterfaceBinding(uint32_t iface)
+{
+    if (iface >= m_bindings.size())
+    {
+        // an interface was added after the last refresh
+        BuildInterfaceBindings();
+    }
+    NS_ASSERT(iface < m_bindings.size());
+    return m_bindings[iface];
+}
+
+bool
+DDRRouting::IsLoopFreeAlternate(const ShortestPathForestRIE* route, uint32_t primary)
+{
+    const InterfaceBinding& binding = GetInterfaceBinding(route->GetInterface());
+    if (!binding.up)
+    {
+        return false;
+    }
+    uint64_t distance = route->GetDistance();
+    return distance <= primary || distance < 2 * static_cast<uint64_t>(binding.metric) + primary;
+}
+
+bool
+DDRRouting::IsLoopFreeMode() const
+{
+    return m_routeSelectMode == DGR_DAG || m_routeSelectMode == DDR_DAG;
+}
+
+double
+DDRRouting::GetSplitWeight(uint32_t iface, uint32_t distance) const
+{
+    switch (m_splitPolicy)
+    {
+    case SPLIT_COST:
+        return 1.0 / std::max<uint32_t>(distance, 1);
+    case SPLIT_CAPACITY: {
+        DataRateValue rate;
+        if (m_ipv4->GetNetDevice(iface)->GetAttributeFailSafe("DataRate", rate))
+        {
+            return rate.Get().GetBitRate();
+        }
+        // no share for a device with no data rate, unless none of the split has one
+        return 0;
+    }
+    default:
+        return 1;
+    }
+}
+
+void
+DDRRouting::BuildHostRouteSplits()
+{
+    m_hostRouteSplits.Clear();
+    if (m_routeSelectMode != NONE || m_splitPolicy == SPLIT_OFF)
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this);
+    std::vector<double> weights;
+    for (NextHopGroup* group : m_hostRouteIndex)
+    {
+        // a shared group is split once, for all its destinations
+        if (!group || group->split != NO_SPLIT || group->successors.size() < 2)
+        {
+            continue;
+        }
+        uint32_t n = std::min<std::size_t>(group->successors.size(), SplitTable::N_BUCKETS);
+        weights.clear();
+        for (uint32_t k = 0; k < n; k++)
+        {
+            const RankedHostRoute& ranked = group->successors[k];
+            weights.push_back(GetSplitWeight(ranked.route->GetInterface(), ranked.distance));
+        }
+        group->split = m_hostRouteSplits.Add(weights);
+    }
+    NS_LOG_LOGIC(m_hostRouteSplits.GetNTables() << " next-hop groups split, in "
+                                                << m_hostRouteSplits.GetMemoryUsage() << " bytes");
+}
+
+void
+DDRRouting::BuildKShortestSplits()
+{
+    NS_LOG_FUNCTION(this);
+    m_kShortestSplits.Clear();
+    std::vector<double> weights;
+    for (uint32_t d = 0; d < m_kShortestPaths.GetNDestinations(); d++)
+    {
+        // one table per destination, so that the destination indexes the tables
+        uint32_t n = std::min<uint32_t>(m_kShortestPaths.GetNPaths(d), SplitTable::N_BUCKETS);
+        weights.clear();
+        for (uint32_t i = 0; i < n; i++)
+        {
+            const KShortestPathTable::Path& path = m_kShortestPaths.GetPath(d, i);
+            weights.push_back(GetSplitWeight(path.iface, path.distance));
+        }
+        if (weights.empty())
+        {
+            // a destination with no path keeps its table, never picked
+            weights.push_back(1);
+        }
+        m_kShortestSplits.Add(weights);
+    }
+}
+
+uint32_t
+DDRRouting::GetSplitHash(const Ipv4Header& header, Ptr<const Packet> p)
+{
+    if (m_splitByFlow)
+    {
+        return FlowCache::HashFlow(header, p);
+    }
+    return m_rand->GetInteger(0, SplitTable::N_BUCKETS - 1);
+}
+
+Ptr<Ipv4Route>
+DDRRouting::LookupSplitRoute(Ipv4Address dest, Ptr<const NetDevice> idev, uint32_t hash)
+{
+    ROMAM_HOT_LOG_FUNCTION(this << dest << idev << hash);
+    const NextHopGroup& group = FindNextHopGroup(dest);
+    if (group.split != NO_SPLIT && !group.successors.empty())
+    {
+        CountLookup(RoutingStats::CANDIDATES_SCANNED);
+        uint32_t k = m_hostRouteSplits.Pick(group.split, hash);
+        ShortestPathForestRIE* route = group.successors[k].route;
+        uint32_t iface = route->GetInterface();
+        if (iface != GetCachedInterfaceIndex(m_ipv4, idev) && GetInterfaceBinding(iface).up)
+        {
+            ROMAM_HOT_LOG_LOGIC("Found split host route " << route);
+            return GetIpv4Route(route, m_ipv4);
+        }
+        ROMAM_HOT_LOG_LOGIC("Split route down or back through the input device, skipping");
+        CountLookup(RoutingStats::LOOP_REJECTS);
+    }
+    return LookupECMPRoute(dest);
+}
+
+uint32_t
+DDRRouting::CountWithinLimits(const CandidateArrays& candidates,
+                              uint32_t dist,
+                              uint32_t bgt,
+                              uint32_t hopOffset,
+                              uint32_t metricDelay,
+                              DecisionTrace::Reason& reason)
+{
+    const uint32_t* distance = candidates.distance.data();
+    uint32_t n = candidates.distance.size();
+    uint32_t nLoop = 0;
+    uint32_t nBudget = 0;
+    for (uint32_t k = 0; k < n; k++)
+    {
+        nLoop += distance[k] <= dist;
+        nBudget += (static_cast<uint64_t>(distance[k]) + hopOffset) * metricDelay <= bgt;
+    }
+    if (std::min(nLoop, nBudget) < n)
+    {
+        // the loop limit is checked first on the candidate over both
+        reason = nLoop <= nBudget ? DecisionTrace::LOOP_LIMIT : DecisionTrace::BUDGET_LIMIT;
+    }
+    return std::min(nLoop, nBudget);
+}
+
+/**
+ * \brief Find the candidates of a block whose estimated delay meets a budget.
+ *
+ * The loop has no data-dependent branch, so that the compiler vectorizes it;
+ * the unusable candidates have a queueing delay of UINT32_MAX, over any budget.
+ *
+ * \param hops the delay bounds of the distances of the candidates, in us
+ * \param delays the queueing delays of the candidates, in us
+ * \param n the number of candidates, at most 32
+ * \param bgt the budget, in us
+ * \return the bitmask of the candidates that meet the budget
+ */
+static uint32_t
+MatchBudget(const uint32_t* hops, const uint32_t* delays, uint32_t n, uint32_t bgt)
+{
+    uint32_t mask = 0;
+    for (uint32_t k = 0; k < n; k++)
+    {
+        uint64_t estimate = static_cast<uint64_t>(hops[k]) + delays[k];
+        mask |= static_cast<uint32_t>(estimate <= bgt) << k;
+    }
+    return mask;
+}
+
+uint32_t
+DDRRouting::EvaluateCandidateBlock(const CandidateArrays& candidates,
+                                   uint32_t begin,
+                                   uint32_t end,
+                                   uint32_t bgt,
+                                   uint32_t hopOffset,
+                                   bool predicted,
+                                   uint32_t inputIface,
+                                   CandidateBlock& block)
+{
+    NS_ASSERT(end - begin <= CANDIDATE_BLOCK);
+    uint32_t n = end - begin;
+    block.looping = 0;
+    block.usable = 0;
+    for (uint32_t k = 0; k < n; k++)
+    {
+        uint32_t iface = candidates.iface[begin + k];
+        uint32_t nextIface = candidates.nextIface[begin + k];
+        uint64_t bound =
+            (static_cast<uint64_t>(candidates.distance[begin + k]) + hopOffset) * m_metricDelay;
+        block.hops[k] = std::min<uint64_t>(bound, UINT32_MAX);
+        block.delays[k] = UINT32_MAX;
+        if (iface == inputIface)
+        {
+            block.looping |= 1u << k;
+            continue;
+        }
+        const InterfaceBinding& binding = GetInterfaceBinding(iface);
+        if (!binding.up)
+        {
+            continue;
+        }
+        // the local queue delay, and the neighbor one, 0 if no state was received from it yet;
+        // the DDR mode takes the downstream delay of the neighbor instead if it sent one
+        uint32_t delay = binding.qdisc->GetQueueDelay();
+        uint32_t epoch = candidates.downstreamEpoch[begin + k];
+        if (predicted && epoch != 0 && epoch == m_downstreamEpochs[iface])
+        {
+            delay += candidates.downstream[begin + k];
+        }
+        else if (m_oracleNeighborState)
+        {
+            delay += nextIface != 0xffffffff ? GetOracleDelay(iface, nextIface) : 0;
+        }
+        else if (nextIface != 0xffffffff)
+        {
+            delay += predicted ? m_tsdb.GetPredictedDelay(iface, nextIface, m_predictionHorizon)
+                               : m_tsdb.GetEstimateDelayDGR(iface, nextIface);
+        }
+        block.delays[k] = delay;
+        block.usable |= 1u << k;
+    }
+    return MatchBudget(block.hops, block.delays, n, bgt);
+}
+
+uint32_t
+DDRRouting::GetDownstreamDelay(const CandidateArrays& candidates)
+{
+    uint64_t best = UINT32_MAX;
+    for (uint32_t k = 0; k < candidates.distance.size(); k++)
+    {
+        uint64_t excess =
+            static_cast<uint64_t>(candidates.distance[k] - candidates.distance[0]) * m_metricDelay;
+        if (excess >= best)
+        {
+            // the candidates are by distance, none after this one does better
+            break;
+        }
+        uint32_t iface = candidates.iface[k];
+        uint32_t nextIface = candidates.nextIface[k];
+        const InterfaceBinding& binding = GetInterfaceBinding(iface);
+        if (!binding.up || !binding.qdisc)
+        {
+            continue;
+        }
+        uint64_t delay = excess + binding.qdisc->GetQueueDelay();
+        if (nextIface != 0xffffffff)
+        {
+            delay += m_oracleNeighborState
+                         ? GetOracleDelay(iface, nextIface)
+                         : m_tsdb.GetPredictedDelay(iface, nextIface, m_predictionHorizon);
+        }
+        best = std::min(best, delay);
+    }
+    return best;
+}
+
+void
+DDRRouting::AddDownstreamDelays(DgrHeader& hdr)
+{
+    if (m_downstreamDelays == 0)
+    {
+        return;
+    }
+    // even without any, the update drops the delays sent before
+    hdr.SetDownstream(true);
+    m_sentDownstreams.clear();
+    const AddressInterner* interner = AddressInterner::Get();
+    std::unordered_set<const NextHopGroup*> seen;
+    for (uint32_t index = 0; index < m_hostRouteIndex.size(); index++)
+    {
+        const NextHopGroup* group = m_hostRouteIndex[index];
+        if (!group || group->candidates.distance.empty() || !seen.insert(group).second)
+        {
+            continue;
+        }
+        uint32_t delay = GetDownstreamDelay(group->candidates);
+        if (delay != UINT32_MAX)
+        {
+            m_sentDownstreams.push_back(DgrDownstream{interner->GetAddress(index), delay});
+        }
+    }
+    // the largest delays are those the neighbors would least expect
+    uint32_t n = std::min<std::size_t>(m_sentDownstreams.size(), m_downstreamDelays);
+    std::partial_sort(m_sentDownstreams.begin(),
+                      m_sentDownstreams.begin() + n,
+                      m_sentDownstreams.end(),
+                      [](const DgrDownstream& a, const DgrDownstream& b) {
+                          return a.delay != b.delay ? a.delay > b.delay : a.dest < b.dest;
+                      });
+    for (uint32_t k = 0; k < n; k++)
+    {
+        hdr.AddDownstream(m_sentDownstreams[k]);
+    }
+}
+
+void
+DDRRouting::HandleDownstreamDelays(const DgrHeader& hdr, uint32_t incomingInterface)
+{
+    NS_LOG_FUNCTION(this << incomingInterface << hdr.GetNDownstreams());
+    GetInterfaceBinding(incomingInterface);
+    // the delays the neighbor sent before are left with an older epoch
+    uint32_t epoch = ++m_downstreamEpochs[incomingInterface];
+    const DgrDownstream* entries = hdr.GetDownstreams();
+    for (uint32_t n = 0; n < hdr.GetNDownstreams(); n++)
+    {
+        NextHopGroup* group = LookupNextHopGroup(entries[n].dest.Get());
+        if (!group)
+        {
+            continue;
+        }
+        for (CandidateArrays* candidates : {&group->candidates, &group->successorCandidates})
+        {
+            for (uint32_t k = 0; k < candidates->iface.size(); k++)
+            {
+                if (candidates->iface[k] == incomingInterface)
                 {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
+                    candidates->downstream[k] = entries[n].delay;
+                    candidates->downstreamEpoch[k] = epoch;
                 }
             }
+        }
+    }
+    // the delays of the cached decisions changed
+    m_decisionGeneration++;
+}
 
-            // if interface is down, continue
-            if (!m_ipv4->IsUp((*i)->GetInterface()))
-                continue;
+void
+DDRRouting::CountCandidateBlock(const CandidateBlock& block, uint32_t feasible, uint32_t n) const
+{
+    uint32_t scanned = (1u << n) - 1;
+    CountLookup(RoutingStats::CANDIDATES_SCANNED, n);
+    CountLookup(RoutingStats::LOOP_REJECTS, __builtin_popcount(block.looping & scanned));
+    CountLookup(RoutingStats::BUDGET_REJECTS,
+                __builtin_popcount(block.usable & ~feasible & scanned));
+}
+
+Ptr<Ipv4Route>
+DDRRouting::LookupECMPRoute(Ipv4Address dest, Ptr<NetDevice> oif)
+{
+    /**
+     * Get the shortest path in the routing table
+     */
+    ROMAM_HOT_LOG_FUNCTION(this << dest << oif);
+    ROMAM_HOT_LOG_LOGIC("Looking for route for destination " << dest);
+
+    Ptr<Ipv4Route> rtentry = 0;
+    // the shortest route, taken in one pass over the candidates
+    ShortestPathForestRIE* best = nullptr;
+
+    const HostRouteCandidates& candidates = FindHostRoutes(dest);
+    ROMAM_HOT_LOG_LOGIC("Number of candidate host routes = " << candidates.size());
+    CountLookup(RoutingStats::CANDIDATES_SCANNED, candidates.size());
+    // until the routes are recomputed, the shortest routes are those before the failure
+    bool reroute = m_fastReroute && m_nDownInterfaces > 0 && !candidates.empty();
+    uint32_t primary = reroute ? FindHostRoutesByDistance(dest).front().distance : 0;
+    uint32_t outputIface = GetCachedInterfaceIndex(m_ipv4, oif);
+    for (RoutePool::Handle handle : candidates)
+    {
+        ShortestPathForestRIE* route = m_routePool.Get(handle);
+        NS_ASSERT(route->IsHost());
+        if (oif && route->GetInterface() != outputIface)
+        {
+            ROMAM_HOT_LOG_LOGIC("Not on requested interface, skipping");
+            continue;
+        }
+        if (reroute && !IsLoopFreeAlternate(route, primary))
+        {
+            ROMAM_HOT_LOG_LOGIC("Down or not a loop-free alternate, skipping");
+            CountLookup(RoutingStats::LOOP_REJECTS);
+            continue;
+        }
+        ROMAM_HOT_LOG_LOGIC("Found DDR host route " << route);
+        if (!best || route->GetDistance() < best->GetDistance())
+        {
+            best = route;
+        }
+    }
+    if (!best) // no host route, fall back to the matching prefixes
+    {
+        auto onRequestedInterface = [oif, outputIface](ShortestPathForestRIE* route) {
+            return !oif || route->GetInterface() == outputIface;
+        };
+        best = LookupShortestPrefixRoute(dest, onRequestedInterface);
+    }
+    if (best) // if route(s) is found
+    {
+        // create a Ipv4Route object from the selected routing table entry
+        rtentry = GetIpv4Route(best, m_ipv4);
+        return rtentry;
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+Ptr<Ipv4Route>
+DDRRouting::LookupOutputECMPRoute(Ipv4Address dest, Ptr<NetDevice> oif)
+{
+    if (m_outputRouteCache.GetSize() == 0)
+    {
+        return LookupECMPRoute(dest, oif);
+    }
+    uint32_t key = FlowCache::Combine(dest.Get(), GetCachedInterfaceIndex(m_ipv4, oif));
+    key = FlowCache::Combine(key, m_routeSelectMode);
+    uint32_t flowlet;
+    Ptr<Ipv4Route> rtentry = m_outputRouteCache.Lookup(key, dest, m_tableGeneration, flowlet);
+    if (rtentry)
+    {
+        ROMAM_HOT_LOG_LOGIC("Found the route of " << dest << " in the output route cache");
+        CountLookup(RoutingStats::OUTPUT_CACHE_HITS);
+        return rtentry;
+    }
+    rtentry = LookupECMPRoute(dest, oif);
+    if (rtentry)
+    {
+        m_outputRouteCache.Insert(key, dest, m_tableGeneration, flowlet, rtentry);
+    }
+    return rtentry;
+}
+
+Ptr<Ipv4Route>
+DDRRouting::LookupDDRRoute(Ipv4Address dest,
+                           RomamMetaTag& metaTag,
+                           Ptr<const NetDevice> idev,
+                           uint32_t flowHash)
+{
+    // avoid loop, unless the successors already do
+    bool loopFree = IsLoopFreeMode();
+    uint32_t dist = UINT32_MAX;
+    dist -= 1;
+    if (!loopFree && metaTag.HasDistance())
+    {
+        dist = metaTag.GetDistance();
+    }
 
-            // get the local queue delay in microsecond
-            Ptr<NetDevice> dev_local = m_ipv4->GetNetDevice((*i)->GetInterface());
-            // get the queue disc on the device
-            Ptr<QueueDisc> disc = m_ipv4->GetObject<Node>()
-                                      ->GetObject<TrafficControlLayer>()
-                                      ->GetRootQueueDiscOnDevice(dev_local);
-            Ptr<DDRQueueDisc> dvq = DynamicCast<DDRQueueDisc>(disc);
-            // uint32_t status_local = dvq->GetQueueStatus ();
-            // uint32_t delay_local = status_local * 2000;
-            uint32_t delay_local = dvq->GetQueueDelay();
-
-            // Get the neighbor queue status in microsecond
-            uint32_t delay_neighbor = 0;
-            if ((*i)->GetNextIface() != 0xffffffff)
+    // budget in microseconds
+    uint32_t bgt = GetRemainingBudget(metaTag);
+    ROMAM_HOT_LOG_FUNCTION(this << dest << idev << flowHash);
+    ROMAM_HOT_LOG_LOGIC("Looking for route for destination " << dest);
+    Ptr<Ipv4Route> rtentry = 0;
+    uint32_t inputIface = GetCachedInterfaceIndex(m_ipv4, idev);
+    // the oracle neighbor states change with no epoch to invalidate a decision with
+    bool cached = m_decisionCache.GetSize() > 0 && !m_oracleNeighborState;
+    uint32_t key = 0;
+    uint32_t generation = 0;
+    uint32_t flowlet = 0;
+    if (cached)
+    {
+        // the packets of a flow with about the same budget and the same loop
+        // limit, from the same device, take the same decision
+        key = FlowCache::Combine(flowHash, bgt / m_decisionBudgetBucket.GetMicroSeconds());
+        key = FlowCache::Combine(key, dist);
+        key = FlowCache::Combine(key, inputIface);
+        generation = m_decisionGeneration + m_tsdb.GetEpoch();
+        uint32_t distance;
+        rtentry = m_decisionCache.Lookup(key, dest, generation, flowlet, &distance);
+        if (rtentry)
+        {
+            ROMAM_HOT_LOG_LOGIC("Found the decision of the flow in the decision cache");
+            if (IsDecisionTraced())
             {
-                uint32_t iface = (*i)->GetInterface();
-                uint32_t niface = (*i)->GetNextIface();
-                NeighborStatusEntry* entry = m_tsdb.GetNeighborStatusEntry(iface);
-                StatusUnit* su = entry->GetStatusUnit(niface);
-                delay_neighbor = su->GetEstimateDelayDGR();
+                TraceDecision(dest,
+                              m_ipv4->GetInterfaceForDevice(rtentry->GetOutputDevice()),
+                              0,
+                              bgt,
+                              DecisionTrace::NO_VALUE,
+                              distance,
+                              DecisionTrace::FEASIBLE);
             }
-            // in microsecond
-            uint32_t estimate_delay = (*i)->GetDistance() * 1000 + delay_local + delay_neighbor;
-
-            if (estimate_delay > bgt)
+            if (!loopFree)
             {
-                NS_LOG_LOGIC("Too far to the destination, skipping");
-                continue;
+                metaTag.SetDistance(distance);
             }
+            return rtentry;
+        }
+    }
+    const NextHopGroup& group = FindNextHopGroup(dest);
+    const RankedHostRoutes& ranked = loopFree ? group.successors : group.byDistance;
+    const CandidateArrays& arrays = loopFree ? group.successorCandidates : group.candidates;
+    ROMAM_HOT_LOG_LOGIC("Number of candidate host routes = " << arrays.distance.size());
+    uint32_t considered = 0;
+    DecisionTrace::Reason reason = DecisionTrace::EXHAUSTED;
+    // the queueing delays only add to the estimate, of a candidate and the next ones
+    uint32_t limit = CountWithinLimits(arrays, dist, bgt, 1, m_metricDelay, reason);
+    CandidateBlock block;
+    for (uint32_t begin = 0; begin < limit; begin += CANDIDATE_BLOCK)
+    {
+        uint32_t end = std::min(begin + CANDIDATE_BLOCK, limit);
+        uint32_t feasible =
+            EvaluateCandidateBlock(arrays, begin, end, bgt, 1, true, inputIface, block);
+        // the shortest of the routes that fit, the first inserted on a tie
+        uint32_t k = feasible ? __builtin_ctz(feasible) : end - begin;
+        CountCandidateBlock(block, feasible, feasible ? k + 1 : k);
+        considered += feasible ? k + 1 : k;
+        if (!feasible)
+        {
+            continue;
+        }
+        ShortestPathForestRIE* route = ranked[begin + k].route;
+        uint32_t distance = arrays.distance[begin + k];
+        NS_ASSERT(route->IsHost());
+        ROMAM_HOT_LOG_LOGIC("Found DDR host route" << route << " with Cost: " << distance);
+        rtentry = GetIpv4Route(route, m_ipv4);
+        TraceDecision(dest,
+                      route->GetInterface(),
+                      considered,
+                      bgt,
+                      block.hops[k] + block.delays[k],
+                      distance,
+                      DecisionTrace::FEASIBLE);
+        if (cached)
+        {
+            m_decisionCache.Insert(key, dest, generation, flowlet, rtentry, distance);
+        }
+
+        if (!loopFree)
+        {
+            metaTag.SetDistance(distance);
+        }
+        return rtentry;
+    }
+    if (limit < arrays.distance.size())
+    {
+        ROMAM_HOT_LOG_LOGIC("No candidate left can avoid a loop or meet the budget");
+        CountLookup(RoutingStats::CANDIDATES_SCANNED);
+        CountLookup(reason == DecisionTrace::LOOP_LIMIT ? RoutingStats::LOOP_REJECTS
+                                                        : RoutingStats::BUDGET_REJECTS);
+        considered++;
+    }
+    CountEcmpFallback(dest);
+    rtentry = LookupECMPRoute(dest);
+    if (IsDecisionTraced())
+    {
+        int32_t iface = rtentry ? m_ipv4->GetInterfaceForDevice(rtentry->GetOutputDevice()) : -1;
+        TraceDecision(dest,
+                      iface,
+                      considered,
+                      bgt,
+                      DecisionTrace::NO_VALUE,
+                      DecisionTrace::NO_VALUE,
+                      reason);
+    }
+    return rtentry;
+}
+
+void
+DDRRouting::CollectDgrRoutes(const RankedHostRoutes& ranked,
+                             const CandidateArrays& arrays,
+                             uint32_t dist,
+                             uint32_t bgt,
+                             uint32_t inputIface,
+                             uint32_t& considered,
+                             DecisionTrace::Reason& reason)
+{
+    // the feasible routes, in storage reused across the lookups
+    std::vector<uint32_t>& allRoutes = m_feasibleRoutes;
+    std::size_t capacity = allRoutes.capacity();
+    allRoutes.clear();
+    // the queueing delays only add to the estimate, of a candidate and the next ones
+    uint32_t limit = CountWithinLimits(arrays, dist, bgt, 0, m_metricDelay, reason);
+    CandidateBlock block;
+    for (uint32_t begin = 0; begin < limit; begin += CANDIDATE_BLOCK)
+    {
+        uint32_t end = std::min(begin + CANDIDATE_BLOCK, limit);
+        uint32_t feasible =
+            EvaluateCandidateBlock(arrays, begin, end, bgt, 0, false, inputIface, block);
+        CountCandidateBlock(block, feasible, end - begin);
+        considered += end - begin;
+        for (; feasible; feasible &= feasible - 1)
+        {
+            allRoutes.push_back(begin + __builtin_ctz(feasible));
+            ROMAM_HOT_LOG_LOGIC(allRoutes.size()
+                                << "Found DGR host route " << ranked[allRoutes.back()].route
+                                << " with Cost: " << ranked[allRoutes.back()].distance);
+        }
+    }
+    if (limit < arrays.distance.size())
+    {
+        ROMAM_HOT_LOG_LOGIC("No candidate left can avoid a loop or meet the budget");
+        CountLookup(RoutingStats::CANDIDATES_SCANNED);
+        CountLookup(reason == DecisionTrace::LOOP_LIMIT ? RoutingStats::LOOP_REJECTS
+                                                        : RoutingStats::BUDGET_REJECTS);
+        considered++;
+    }
+    CountScratchGrowth(capacity, allRoutes.capacity());
+    // draw in insertion order, so that a seed keeps picking the same routes
+    std::sort(allRoutes.begin(), allRoutes.end(), [&ranked](uint32_t a, uint32_t b) {
+        return ranked[a].sequence < ranked[b].sequence;
+    });
+}
+
+const std::vector<uint32_t>*
+DDRRouting::FindDecisionRow(NextHopGroup& group,
+                            bool loopFree,
+                            uint32_t dist,
+                            uint32_t bgt,
+                            uint32_t inputIface)
+{
+    const RankedHostRoutes& ranked = loopFree ? group.successors : group.byDistance;
+    const CandidateArrays& arrays = loopFree ? group.successorCandidates : group.candidates;
+    // the candidates within the loop limit, a prefix since they are by distance
+    uint32_t limit =
+        std::upper_bound(arrays.distance.begin(), arrays.distance.end(), dist) -
+        arrays.distance.begin();
+    uint32_t iface = std::min<uint32_t>(inputIface, 0xffff);
+    if (limit >= 0x8000 || (iface == 0xffff && inputIface != NO_INTERFACE))
+    {
+        // out of the keys of the rows
+        return nullptr;
+    }
+    DecisionTable& table = group.dgrTable;
+    if (table.generation != m_tableGeneration || table.stamp != m_stateStamp)
+    {
+        if (table.generation != m_tableGeneration)
+        {
+            table.generation = m_tableGeneration;
+            table.ifaces = arrays.iface;
+            std::sort(table.ifaces.begin(), table.ifaces.end());
+            table.ifaces.erase(std::unique(table.ifaces.begin(), table.ifaces.end()),
+                               table.ifaces.end());
+            table.epochs = UINT64_MAX;
+        }
+        // only the states of the interfaces of the candidates change the rows
+        uint64_t epochs = 0;
+        for (uint32_t i : table.ifaces)
+        {
+            epochs += i < m_stateEpochs.size() ? m_stateEpochs[i] : 0;
+        }
+        if (epochs != table.epochs)
+        {
+            table.epochs = epochs;
+            table.rows.clear();
+        }
+        table.stamp = m_stateStamp;
+    }
+    uint64_t bucket = bgt / m_decisionBudgetBucket.GetMicroSeconds();
+    uint64_t key = bucket << 32 | static_cast<uint64_t>(loopFree) << 31 | limit << 16 | iface;
+    auto row = table.rows.find(key);
+    if (row == table.rows.end())
+    {
+        // the routes that meet the lowest budget of the bucket meet all of them
+        uint32_t considered = 0;
+        DecisionTrace::Reason reason = DecisionTrace::EXHAUSTED;
+        CollectDgrRoutes(ranked,
+                         arrays,
+                         dist,
+                         bucket * m_decisionBudgetBucket.GetMicroSeconds(),
+                         inputIface,
+                         considered,
+                         reason);
+        row = table.rows.emplace(key, m_feasibleRoutes).first;
+    }
+    return &row->second;
+}
+
+Ptr<Ipv4Route>
+DDRRouting::LookupAgentRoute(Ipv4Address dest, RomamMetaTag& metaTag, Ptr<const NetDevice> idev)
+{
+    return LookupInterfaceRoute(dest,
+                                m_agentChannel->GetDecision(m_agentNode, dest),
+                                metaTag,
+                                idev,
+                                RoutingStats::AGENT_DECISIONS);
+}
 
-            if ((*i)->GetDistance() > dist)
+void
+DDRRouting::BindPolicyTable()
+{
+    NS_LOG_FUNCTION(this << m_policyPath);
+    m_policy = PolicyTable::Get(m_policyPath);
+    NS_ABORT_MSG_IF(!m_policy, "Cannot load the policy table \"" << m_policyPath << "\"");
+    m_policyNode = m_ipv4->GetObject<Node>()->GetId();
+    // the destinations of the table are the routers, by any of their addresses
+    m_policyDests.clear();
+    AddressInterner* interner = AddressInterner::Get();
+    for (auto n = NodeList::Begin(); n != NodeList::End(); n++)
+    {
+        Ptr<Ipv4> ipv4 = (*n)->GetObject<Ipv4>();
+        for (uint32_t j = 1; ipv4 && j < ipv4->GetNInterfaces(); j++)
+        {
+            for (uint32_t a = 0; a < ipv4->GetNAddresses(j); a++)
             {
-                NS_LOG_LOGIC("Loop avoidance, skipping");
-                continue;
+                uint32_t index = interner->InternAddress(ipv4->GetAddress(j, a).GetLocal());
+                if (index >= m_policyDests.size())
+                {
+                    m_policyDests.resize(index + 1, UINT32_MAX);
+                }
+                m_policyDests[index] = (*n)->GetId();
             }
+        }
+    }
+    m_policyStamp = UINT64_MAX;
+}
+
+uint32_t
+DDRRouting::GetPolicyState()
+{
+    if (m_policyStamp == m_stateStamp)
+    {
+        return m_policyState;
+    }
+    uint32_t nStates = m_tsdb.GetNStates();
+    uint32_t local = 0;
+    for (uint32_t i = 1; i < m_localLevels.size(); i++)
+    {
+        local = std::max(local, m_localLevels[i]);
+    }
+    uint32_t nInterfaces = std::min(m_policy->GetNInterfaces() + 1, m_ipv4->GetNInterfaces());
+    m_policyNeighbors.assign(nInterfaces, 0);
+    for (uint32_t i = 1; i < nInterfaces; i++)
+    {
+        int state = -1;
+        for (uint32_t j = 0; j < m_tsdb.GetNNeighborInterfaces(); j++)
+        {
+            state = std::max(state, m_tsdb.GetLastState(i, j));
+        }
+        m_policyNeighbors[i] = state < 0 ? 0 : m_policy->Quantize(state, nStates);
+    }
+    m_policyState = m_policy->GetStateKey(m_policy->Quantize(local, nStates), m_policyNeighbors);
+    m_policyStamp = m_stateStamp;
+    return m_policyState;
+}
+
+Ptr<Ipv4Route>
+DDRRouting::LookupPolicyRoute(Ipv4Address dest, RomamMetaTag& metaTag, Ptr<const NetDevice> idev)
+{
+    if (!m_policy)
+    {
+        BindPolicyTable();
+    }
+    uint32_t index = AddressInterner::Get()->FindAddress(dest);
+    uint32_t destNode = index < m_policyDests.size() ? m_policyDests[index] : UINT32_MAX;
+    uint32_t iface = m_policy->GetDecision(m_policyNode,
+                                           destNode,
+                                           GetPolicyState(),
+                                           m_policy->GetBudgetBucket(GetRemainingBudget(metaTag)));
+    Ptr<Ipv4Route> rtentry =
+        LookupInterfaceRoute(dest, iface, metaTag, idev, RoutingStats::POLICY_DECISIONS);
+    if (!rtentry)
+    {
+        CountLookup(RoutingStats::POLICY_MISSES);
+    }
+    return rtentry;
+}
+
+Ptr<Ipv4Route>
+DDRRouting::LookupInterfaceRoute(Ipv4Address dest,
+                                 uint32_t iface,
+                                 RomamMetaTag& metaTag,
+                                 Ptr<const NetDevice> idev,
+                                 RoutingStats::Counter counter)
+{
+    if (iface == 0 || iface == GetCachedInterfaceIndex(m_ipv4, idev) ||
+        iface >= m_ipv4->GetNInterfaces() || !GetInterfaceBinding(iface).up)
+    {
+        return nullptr;
+    }
+    // the candidates the route select mode would consider, so that the
+    // decision cannot make a loop the mode avoids
+    bool loopFree = IsLoopFreeMode();
+    uint32_t dist = UINT32_MAX - 1;
+    if (!loopFree && metaTag.HasDistance())
+    {
+        dist = metaTag.GetDistance();
+    }
+    const NextHopGroup& group = FindNextHopGroup(dest);
+    const RankedHostRoutes& ranked = loopFree ? group.successors : group.byDistance;
+    for (const RankedHostRoute& candidate : ranked)
+    {
+        if (candidate.distance > dist)
+        {
+            break;
+        }
+        if (candidate.route->GetInterface() != iface)
+        {
+            continue;
+        }
+        ROMAM_HOT_LOG_LOGIC("Decided route " << candidate.route << " on interface " << iface);
+        CountLookup(counter);
+        if (!loopFree)
+        {
+            metaTag.SetDistance(candidate.distance);
+        }
+        return GetIpv4Route(candidate.route, m_ipv4);
+    }
+    return nullptr;
+}
+
+Ptr<Ipv4Route>
+DDRRouting::LookupDGRRoute(Ipv4Address dest, RomamMetaTag& metaTag, Ptr<const NetDevice> idev)
+{
+    // std::cout <<"DGR routing" << std::endl;
+    // avoid loop, unless the successors already do
+    bool loopFree = IsLoopFreeMode();
+    uint32_t dist = UINT32_MAX;
+    dist -= 1;
+    if (!loopFree && metaTag.HasDistance())
+    {
+        dist = metaTag.GetDistance();
+    }
 
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size()
-                         << "Found DGR host route" << *i << " with Cost: " << (*i)->GetDistance());
-        }
+    // std::cout << "budget: " << bgtTag.GetBudget() << std::endl;
+    // budget in microseconds
+    uint32_t bgt = GetRemainingBudget(metaTag);
+    ROMAM_HOT_LOG_FUNCTION(this << dest << idev);
+    ROMAM_HOT_LOG_LOGIC("Looking for route for destination " << dest);
+    Ptr<Ipv4Route> rtentry = 0;
+    uint32_t inputIface = GetCachedInterfaceIndex(m_ipv4, idev);
+
+    NextHopGroup* tabled = m_dgrDecisionTables && !m_oracleNeighborState
+                               ? LookupNextHopGroup(dest.Get())
+                               : nullptr;
+    const NextHopGroup& group = tabled ? *tabled : FindNextHopGroup(dest);
+    const RankedHostRoutes& ranked = loopFree ? group.successors : group.byDistance;
+    ROMAM_HOT_LOG_LOGIC("Number of candidate host routes = " << ranked.size());
+    uint32_t considered = 0;
+    DecisionTrace::Reason reason = DecisionTrace::EXHAUSTED;
+    const std::vector<uint32_t>* allRoutes =
+        tabled ? FindDecisionRow(*tabled, loopFree, dist, bgt, inputIface) : nullptr;
+    if (allRoutes && !allRoutes->empty())
+    {
+        ROMAM_HOT_LOG_LOGIC("Found the feasible routes in the decision table");
+    }
+    else
+    {
+        // none meets the lowest budget of the bucket, some may meet the budget
+        const CandidateArrays& arrays = loopFree ? group.successorCandidates : group.candidates;
+        CollectDgrRoutes(ranked, arrays, dist, bgt, inputIface, considered, reason);
+        allRoutes = &m_feasibleRoutes;
     }
-    if (allRoutes.size() > 0) // if route(s) is found
+    if (allRoutes->size() > 0) // if route(s) is found
     {
         // random select
-        uint32_t selectIndex = m_rand->GetInteger(0, allRoutes.size() - 1);
-
-        ShortestPathForestRIE* route = allRoutes.at(selectIndex);
-        uint32_t interfaceIdx = route->GetInterface();
-
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(interfaceIdx, 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
-
-        distTag.SetDistance(route->GetDistance());
-        p->ReplacePacketTag(distTag);
+        uint32_t selectIndex = m_rand->GetInteger(0, allRoutes->size() - 1);
+
+        ShortestPathForestRIE* route = ranked[allRoutes->at(selectIndex)].route;
+        rtentry = GetIpv4Route(route, m_ipv4);
+        TraceDecision(dest,
+                      route->GetInterface(),
+                      considered,
+                      bgt,
+                      DecisionTrace::NO_VALUE,
+                      route->GetDistance(),
+                      DecisionTrace::FEASIBLE);
+
+        if (!loopFree)
+        {
+            metaTag.SetDistance(route->GetDistance());
+        }
         return rtentry;
     }
     else
     {
+        TraceDecision(dest,
+                      -1,
+                      considered,
+                      bgt,
+                      DecisionTrace::NO_VALUE,
+                      DecisionTrace::NO_VALUE,
+                      reason);
         return 0;
     }
 }
 
 Ptr<Ipv4Route>
-DDRRouting::LookupKShortRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
+DDRRouting::LookupKShortRoute(Ipv4Address dest,
+                              RomamMetaTag& metaTag,
+                              Ptr<const NetDevice> idev,
+                              uint32_t splitHash)
 {
     // avoid loop
-    DistTag distTag;
     uint32_t dist = UINT32_MAX;
     dist -= 1;
-    if (p->PeekPacketTag(distTag))
+    if (metaTag.HasDistance())
     {
-        dist = distTag.GetDistance();
+        dist = metaTag.GetDistance();
     }
-    NS_LOG_FUNCTION(this << dest << idev);
-    NS_LOG_LOGIC("Looking for route for destination " << dest);
+    ROMAM_HOT_LOG_FUNCTION(this << dest << idev);
+    ROMAM_HOT_LOG_LOGIC("Looking for route for destination " << dest);
     Ptr<Ipv4Route> rtentry = 0;
-    // store all available routes that bring packets to their destination
-    typedef std::vector<ShortestPathForestRIE*> RouteVec_t;
-    // typedef std::vector<ShortestPathForestRIE *>::const_iterator RouteVecCI_t;
-    RouteVec_t allRoutes;
-
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    uint32_t inputIface = GetCachedInterfaceIndex(m_ipv4, idev);
+    uint32_t d = m_kShortestPaths.Find(dest);
+    if (d != KShortestPathTable::NO_DESTINATION && m_hotDestinations > 0)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        CountKShortestLookup(d);
+    }
+    auto makeRoute = [this, dest, &metaTag](const KShortestPathTable::Path& path) {
+        const CachedInterface& iface = GetCachedInterface(m_ipv4, path.iface);
+        Ptr<Ipv4Route> route = Create<Ipv4Route>();
+        route->SetDestination(dest);
+        route->SetSource(iface.source);
+        route->SetGateway(Ipv4Address(path.gateway));
+        route->SetOutputDevice(iface.device);
+        metaTag.SetDistance(path.distance);
+        return route;
+    };
+    if (d != KShortestPathTable::NO_DESTINATION && m_splitPolicy != SPLIT_OFF &&
+        m_kShortestPaths.GetNPaths(d) > 0)
+    {
+        if (m_kShortestSplits.GetNTables() != m_kShortestPaths.GetNDestinations())
+        {
+            BuildKShortestSplits();
+        }
+        // the path of the split, unless it goes back through the incoming device
+        const KShortestPathTable::Path& path =
+            m_kShortestPaths.GetPath(d, m_kShortestSplits.Pick(d, splitHash));
+        CountLookup(RoutingStats::CANDIDATES_SCANNED);
+        if (path.iface != inputIface)
+        {
+            ROMAM_HOT_LOG_LOGIC("Found split path on interface " << path.iface);
+            return makeRoute(path);
+        }
+        CountLookup(RoutingStats::LOOP_REJECTS);
+    }
+    if (d != KShortestPathTable::NO_DESTINATION)
+    {
+        //
+        // Pick one of the k shortest paths at random, leaving out those that
+        // go back through the incoming device: count them, then draw among them.
+        //
+        uint32_t nPaths = m_kShortestPaths.GetNPaths(d);
+        uint32_t nUsable = 0;
+        for (uint32_t i = 0; i < nPaths; i++)
         {
-            if (idev)
+            const KShortestPathTable::Path& path = m_kShortestPaths.GetPath(d, i);
+            nUsable += path.iface != inputIface ? 1 : 0;
+        }
+        ROMAM_HOT_LOG_LOGIC(nUsable << " of the " << nPaths << " shortest paths usable");
+        CountLookup(RoutingStats::CANDIDATES_SCANNED, nPaths);
+        CountLookup(RoutingStats::LOOP_REJECTS, nPaths - nUsable);
+        if (nUsable == 0)
+        {
+            return 0;
+        }
+        uint32_t select = m_rand->GetInteger(0, nUsable - 1);
+        for (uint32_t i = 0; i < nPaths; i++)
+        {
+            const KShortestPathTable::Path& path = m_kShortestPaths.GetPath(d, i);
+            if (path.iface == inputIface)
             {
-                if (idev == m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
+                continue;
             }
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size()
-                         << "Found route" << *i << " with Cost: " << (*i)->GetDistance());
+            if (select-- > 0)
+            {
+                continue;
+            }
+            return makeRoute(path);
         }
     }
-    if (allRoutes.size() > 0) // if route(s) is found
+    //
+    // Likewise pick one of the host routes at random: count those that are
+    // usable, then draw among them.
+    //
+    const HostRouteCandidates& candidates = FindHostRoutes(dest);
+    ROMAM_HOT_LOG_LOGIC("Number of candidate host routes = " << candidates.size());
+    CountLookup(RoutingStats::CANDIDATES_SCANNED, candidates.size());
+    auto usable = [this, inputIface](ShortestPathForestRIE* route) {
+        if (route->GetInterface() == inputIface)
+        {
+            return false;
+        }
+        return !m_fastReroute || GetInterfaceBinding(route->GetInterface()).up;
+    };
+    uint32_t nUsable = 0;
+    for (RoutePool::Handle handle : candidates)
     {
-        // random select
-        uint32_t selectIndex = m_rand->GetInteger(0, allRoutes.size() - 1);
-        ShortestPathForestRIE* route = allRoutes.at(selectIndex);
-        uint32_t interfaceIdx = route->GetInterface();
-
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(interfaceIdx, 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
-
-        distTag.SetDistance(route->GetDistance());
-        p->ReplacePacketTag(distTag);
-        return rtentry;
+        ShortestPathForestRIE* route = m_routePool.Get(handle);
+        NS_ASSERT(route->IsHost());
+        if (route->GetInterface() == inputIface)
+        {
+            ROMAM_HOT_LOG_LOGIC("Not on requested interface, skipping");
+            CountLookup(RoutingStats::LOOP_REJECTS);
+            continue;
+        }
+        nUsable += usable(route) ? 1 : 0;
     }
-    else
+    ROMAM_HOT_LOG_LOGIC(nUsable << " of the " << candidates.size() << " host routes usable");
+    if (nUsable == 0)
     {
         return 0;
     }
+    uint32_t select = m_rand->GetInteger(0, nUsable - 1);
+    for (RoutePool::Handle handle : candidates)
+    {
+        ShortestPathForestRIE* route = m_routePool.Get(handle);
+        if (!usable(route) || select-- > 0)
+        {
+            continue;
+        }
+        ROMAM_HOT_LOG_LOGIC("Found route " << route << " with Cost: " << route->GetDistance());
+        rtentry = GetIpv4Route(route, m_ipv4);
+        metaTag.SetDistance(route->GetDistance());
+        return rtentry;
+    }
+    return 0;
 }
 
 // Ptr<Ipv4Route>
@@ -1082,9 +2498,30 @@ DDRRouting::LookupKShortRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevi
 void
 DDRRouting::InitializeSocketList()
 {
-    // To Check: An random value is needed to initialize the protocol?
-    Time delay = m_unsolicitedUpdate;
-    m_nextUnsolicitedUpdate = Simulator::Schedule(delay, &DDRRouting::SendUnsolicitedUpdate, this);
+    if (m_oracleNeighborState)
+    {
+        // the queues of the neighbors are read directly, no state is exchanged
+        for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+        {
+            if (!IsExcludedInterface(i) && !DynamicCast<LoopbackNetDevice>(m_ipv4->GetNetDevice(i)))
+            {
+                m_ipv4->SetForwarding(i, true);
+            }
+        }
+        InvalidateInterfaceCache();
+        BuildOracleQueues();
+        return;
+    }
+    // a random phase keeps the nodes started together from updating together
+    Time delay = m_randomStartPhase ? Time::FromDouble(m_unsolicitedUpdate.GetDouble() *
+                                                           m_jitter->GetValue(0, 1),
+                                                       Time::GetResolution())
+                                    : m_unsolicitedUpdate;
+    if (m_updateTimerWheel)
+    {
+        m_timerWheel = TimerWheel::GetWheel(m_ipv4->GetObject<Node>());
+    }
+    ScheduleUnsolicitedUpdate(delay);
 
     uint32_t nodeId = m_ipv4->GetNetDevice(1)->GetNode()->GetId();
     std::stringstream ss;
@@ -1095,8 +2532,6 @@ DDRRouting::InitializeSocketList()
     // m_outStream = Create<OutputStreamWrapper> ("Node" + strNodeId + "queueStatusErr.txt",
     // std::ios::out);
 
-    m_nextUnsolicitedUpdate = Simulator::Schedule(delay, &DDRRouting::SendUnsolicitedUpdate, this);
-
     // Initialize the sockets for every netdevice
     for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
     {
@@ -1107,7 +2542,7 @@ DDRRouting::InitializeSocketList()
         }
 
         bool activeInterface = false;
-        if (m_interfaceExclusions.find(i) == m_interfaceExclusions.end())
+        if (!IsExcludedInterface(i))
         {
             activeInterface = true;
             m_ipv4->SetForwarding(i, true);
@@ -1121,6 +2556,16 @@ DDRRouting::InitializeSocketList()
 
             if (address.GetScope() != Ipv4InterfaceAddress::HOST && activeInterface == true)
             {
+                if (m_useControlChannel)
+                {
+                    // the channel sends from the first address, without a socket
+                    if (i >= m_controlInterfaces.size())
+                    {
+                        m_controlInterfaces.resize(i + 1, false);
+                    }
+                    m_controlInterfaces[i] = true;
+                    continue;
+                }
                 NS_LOG_LOGIC("DGR: add socket to " << address.GetLocal());
                 TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
                 Ptr<Node> theNode = m_ipv4->GetObject<Node>();
@@ -1135,12 +2580,19 @@ DDRRouting::InitializeSocketList()
                 socket->SetIpRecvTtl(true);
                 socket->SetRecvPktInfo(true);
 
-                m_unicastSocketList[socket] = i;
+                AddInterfaceSocket(socket, i);
             }
         }
     }
+    // the forwarding flags changed under the interface cache
+    InvalidateInterfaceCache();
 
-    if (!m_multicastRecvSocket)
+    if (m_useControlChannel)
+    {
+        m_controlChannel = ControlChannel::GetChannel(m_ipv4, DDR_CONTROL_PROTOCOL);
+        m_controlChannel->SetReceiveCallback(MakeCallback(&DDRRouting::ReceiveControl, this));
+    }
+    else if (!m_multicastRecvSocket)
     {
         NS_LOG_LOGIC("DGR: adding receiving socket");
         TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
@@ -1154,11 +2606,38 @@ DDRRouting::InitializeSocketList()
     }
 }
 
+bool
+DDRRouting::IsExcludedInterface(uint32_t interface) const
+{
+    return interface < m_interfaceExclusions.size() && m_interfaceExclusions[interface];
+}
+
+void
+DDRRouting::AddInterfaceSocket(Ptr<Socket> socket, uint32_t interface)
+{
+    m_unicastSocketList[socket] = interface;
+    if (interface >= m_interfaceSockets.size())
+    {
+        m_interfaceSockets.resize(interface + 1);
+    }
+    if (!m_interfaceSockets[interface])
+    {
+        m_interfaceSockets[interface] = socket;
+    }
+}
+
 void
 DDRRouting::DoInitialize()
 {
     NS_LOG_FUNCTION(this);
     m_initialized = true;
+    m_tsdb.SetResolution(m_stateLevels, m_compactStatusCounters);
+    m_tsdb.SetEstimator(m_statusEstimator, m_statusEstimatorLength);
+    BuildInterfaceBindings();
+    if (m_ipv4)
+    {
+        StartDecisionTrace(m_ipv4->GetObject<Node>()->GetId());
+    }
     Ipv4RoutingProtocol::DoInitialize();
 }
 
@@ -1166,21 +2645,35 @@ void
 DDRRouting::DoDispose(void)
 {
     NS_LOG_FUNCTION(this);
-    // TODO: Realise memorys
-    for (HostRoutesI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i = m_hostRoutes.erase(i))
+    ClearRoutes();
+    m_nextTriggeredUpdate.Cancel();
+    m_nextUnsolicitedUpdateEvent.Cancel();
+    if (m_timerWheel)
     {
-        delete (*i);
+        m_timerWheel->Cancel(m_nextUnsolicitedUpdate);
+        m_timerWheel = nullptr;
     }
-    for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end();
-         j = m_networkRoutes.erase(j))
+    // the queue discs may outlive the protocol
+    for (auto i = m_bindings.begin(); i != m_bindings.end(); i++)
     {
-        delete (*j);
+        if (i->qdisc)
+        {
+            i->qdisc->SetStateChangeCallback(m_tsdb.GetNStates(),
+                                             MakeNullCallback<void, uint32_t>());
+        }
     }
-    for (ASExternalRoutesI l = m_ASexternalRoutes.begin(); l != m_ASexternalRoutes.end();
-         l = m_ASexternalRoutes.erase(l))
+    m_bindings.clear();
+    m_oracleQueues.clear();
+    m_oracleOffsets.clear();
+    if (m_controlChannel)
     {
-        delete (*l);
+        // the channel stays in the Ipv4 of the node
+        m_controlChannel->SetReceiveCallback(ControlChannel::ReceiveCallback());
+        m_controlChannel = nullptr;
     }
+    m_controlInterfaces.clear();
+    InvalidateInterfaceCache();
+    StopDecisionTrace();
 
     Ipv4RoutingProtocol::DoDispose();
 }
@@ -1189,6 +2682,7 @@ void
 DDRRouting::Receive(Ptr<Socket> socket)
 {
     NS_LOG_FUNCTION(this << socket);
+    EventAccounting::Scope scope(EventAccounting::NEIGHBOR_STATE);
 
     Address sender;
     Ptr<Packet> packet = socket->RecvFrom(sender);
@@ -1223,6 +2717,17 @@ DDRRouting::Receive(Ptr<Socket> socket)
         NS_ABORT_MSG("No incoming Hop count on message, aborting");
     }
     uint8_t hopLimit = hoplimitTag.GetTtl();
+    ReceiveControl(packet, senderAddress, ipInterfaceIndex, hopLimit);
+}
+
+void
+DDRRouting::ReceiveControl(Ptr<Packet> packet,
+                           Ipv4Address senderAddress,
+                           uint32_t interface,
+                           uint8_t hopLimit)
+{
+    NS_LOG_FUNCTION(this << packet << senderAddress << interface << int(hopLimit));
+    EventAccounting::Scope scope(EventAccounting::NEIGHBOR_STATE);
 
     int32_t interfaceForAddress = m_ipv4->GetInterfaceForAddress(senderAddress);
     if (interfaceForAddress != -1)
@@ -1231,14 +2736,15 @@ DDRRouting::Receive(Ptr<Socket> socket)
         return;
     }
 
+    // the NSEs are decoded into storage reused from one update to the next
     DgrHeader hdr;
+    hdr.SetNseStorage(&m_receivedNses);
     packet->RemoveHeader(hdr);
 
     if (hdr.GetCommand() == DgrHeader::RESPONSE)
     {
-        NS_LOG_LOGIC("The message is a Response from " << senderAddr.GetIpv4() << ":"
-                                                       << senderAddr.GetPort());
-        HandleResponses(hdr, senderAddress, ipInterfaceIndex, hopLimit);
+        NS_LOG_LOGIC("The message is a Response from " << senderAddress);
+        HandleResponses(hdr, senderAddress, interface, hopLimit);
     }
     // else if (hdr.GetCommand () == DgrHeader::REQUEST)
     //   {
@@ -1257,93 +2763,364 @@ void
 DDRRouting::SendUnsolicitedUpdate()
 {
     NS_LOG_FUNCTION(this);
+    EventAccounting::Scope scope(EventAccounting::NEIGHBOR_STATE);
     if (m_nextTriggeredUpdate.IsRunning())
     {
         m_nextTriggeredUpdate.Cancel();
     }
+    CountControlBurst();
     DoSendNeighborStatusUpdate(true);
-    // todo : update the delay, do we need some random in the delay
-    Time delay = m_unsolicitedUpdate;
-    m_nextUnsolicitedUpdate = Simulator::Schedule(delay, &DDRRouting::SendUnsolicitedUpdate, this);
+    ScheduleUnsolicitedUpdate(JitterPeriod(GetNextSamplePeriod()));
+}
+
+void
+DDRRouting::ScheduleUnsolicitedUpdate(Time delay)
+{
+    NS_LOG_FUNCTION(this << delay);
+    if (m_timerWheel)
+    {
+        m_timerWheel->Cancel(m_nextUnsolicitedUpdate);
+        m_nextUnsolicitedUpdate =
+            m_timerWheel->Schedule(delay, MakeCallback(&DDRRouting::SendUnsolicitedUpdate, this));
+    }
+    else
+    {
+        m_nextUnsolicitedUpdateEvent.Cancel();
+        m_nextUnsolicitedUpdateEvent =
+            Simulator::Schedule(delay, &DDRRouting::SendUnsolicitedUpdate, this);
+    }
+}
+
+Time
+DDRRouting::JitterPeriod(Time period)
+{
+    if (m_updateJitter <= 0.0)
+    {
+        return period;
+    }
+    return Time::FromDouble(period.GetDouble() * (1 - m_jitter->GetValue(0, m_updateJitter)),
+                            Time::GetResolution());
+}
+
+void
+DDRRouting::CountControlBurst()
+{
+    int64_t width = GetControlBurstWindow().GetTimeStep();
+    int64_t window = Simulator::Now().GetTimeStep() / width;
+    if (window < s_burstWindow)
+    {
+        // another simulation
+        ResetControlBurst();
+    }
+    s_burstCount = window == s_burstWindow ? s_burstCount + 1 : 1;
+    s_burstWindow = window;
+    if (s_burstCount > s_burstPeak)
+    {
+        s_burstPeak = s_burstCount;
+        s_burstPeakTime = TimeStep(window * width);
+    }
+}
+
+uint32_t
+DDRRouting::GetControlBurstPeak()
+{
+    return s_burstPeak;
+}
+
+Time
+DDRRouting::GetControlBurstPeakTime()
+{
+    return s_burstPeakTime;
+}
+
+void
+DDRRouting::ResetControlBurst()
+{
+    s_burstWindow = -1;
+    s_burstCount = 0;
+    s_burstPeak = 0;
+    s_burstPeakTime = Time();
+}
+
+void
+DDRRouting::SetAgentChannel(const AgentChannel* channel, uint32_t node)
+{
+    NS_LOG_FUNCTION(this << channel << node);
+    m_agentChannel = channel;
+    m_agentNode = node;
+}
+
+void
+DDRRouting::FillAgentFeatures(float* ifaces,
+                              uint32_t nIfaces,
+                              float* routes,
+                              const std::vector<Ipv4Address>& dests)
+{
+    const uint32_t nIfaceFeatures = AgentChannel::IFACE_FEATURES;
+    const uint32_t nRouteFeatures = AgentChannel::ROUTE_FEATURES;
+    std::fill(ifaces, ifaces + nIfaces * nIfaceFeatures, 0.0f);
+    uint32_t nInterfaces = std::min(nIfaces, m_ipv4->GetNInterfaces());
+    for (uint32_t i = 1; i < nInterfaces; i++)
+    {
+        const InterfaceBinding& binding = GetInterfaceBinding(i);
+        float* features = ifaces + i * nIfaceFeatures;
+        features[0] = binding.up;
+        if (binding.qdisc)
+        {
+            features[1] = binding.qdisc->GetQueueStatus(m_tsdb.GetNStates());
+            features[2] = binding.qdisc->GetQueueDelay();
+        }
+    }
+    for (uint32_t d = 0; d < dests.size(); d++)
+    {
+        float* row = routes + d * nIfaces * nRouteFeatures;
+        std::fill(row, row + nIfaces * nRouteFeatures, -1.0f);
+        // by distance, so the first candidate of an interface is its shortest
+        const CandidateArrays& candidates = FindNextHopGroup(dests[d]).candidates;
+        for (uint32_t k = 0; k < candidates.distance.size(); k++)
+        {
+            uint32_t iface = candidates.iface[k];
+            if (iface >= nInterfaces || row[iface * nRouteFeatures] >= 0)
+            {
+                continue;
+            }
+            const InterfaceBinding& binding = GetInterfaceBinding(iface);
+            uint32_t nextIface = candidates.nextIface[k];
+            uint32_t delay = binding.qdisc ? binding.qdisc->GetQueueDelay() : 0;
+            if (nextIface != 0xffffffff)
+            {
+                delay += m_oracleNeighborState ? GetOracleDelay(iface, nextIface)
+                                               : m_tsdb.GetEstimateDelayDGR(iface, nextIface);
+            }
+            row[iface * nRouteFeatures] = candidates.distance[k];
+            row[iface * nRouteFeatures + 1] = delay;
+        }
+    }
+}
+
+Time
+DDRRouting::GetNextSamplePeriod()
+{
+    if (!m_adaptiveSamplePeriod)
+    {
+        return m_unsolicitedUpdate;
+    }
+    bool changed = false;
+    m_sampledStates.resize(m_ipv4->GetNInterfaces(), -1);
+    for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+    {
+        const InterfaceBinding& binding = GetInterfaceBinding(i);
+        int32_t state = m_ipv4->IsUp(i) && binding.qdisc
+                            ? binding.qdisc->GetQueueStatus(m_tsdb.GetNStates())
+                            : -1;
+        changed |= state != m_sampledStates[i];
+        m_sampledStates[i] = state;
+    }
+    if (m_samplePeriod.IsZero())
+    {
+        m_samplePeriod = m_unsolicitedUpdate;
+    }
+    else
+    {
+        m_samplePeriod = changed ? m_samplePeriod / 2 : m_samplePeriod + m_samplePeriod / 4;
+    }
+    m_samplePeriod = std::max(m_minSamplePeriod, std::min(m_maxSamplePeriod, m_samplePeriod));
+    NS_LOG_LOGIC("Next unsolicited update in " << m_samplePeriod.As(Time::US)
+                                               << (changed ? ", a state changed" : ""));
+    return m_samplePeriod;
+}
+
+void
+DDRRouting::SendTriggeredNeighborStatusUpdate()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_nextTriggeredUpdate.IsRunning())
+    {
+        return;
+    }
+    // not from the queue disc that triggered it, which is in the middle of an operation
+    m_nextTriggeredUpdate =
+        Simulator::ScheduleNow(&DDRRouting::DoSendNeighborStatusUpdate, this, false);
+}
+
+void
+DDRRouting::NotifyQueueState(uint32_t state)
+{
+    NS_LOG_FUNCTION(this << state);
+    // the local queue delays of the cached decisions changed
+    m_decisionGeneration++;
+    // and the ones of the decision tables of the interfaces whose level changed
+    for (uint32_t i = 0; i < m_bindings.size() && i < m_localLevels.size(); i++)
+    {
+        const InterfaceBinding& binding = m_bindings[i];
+        uint32_t level = binding.qdisc ? binding.qdisc->GetQueueStatus(m_tsdb.GetNStates()) : 0;
+        if (level != m_localLevels[i])
+        {
+            m_localLevels[i] = level;
+            m_stateEpochs[i]++;
+            m_stateStamp++;
+        }
+    }
+    if (m_triggeredStatusUpdates)
+    {
+        SendTriggeredNeighborStatusUpdate();
+    }
 }
 
 void
 DDRRouting::DoSendNeighborStatusUpdate(bool periodic)
 {
     NS_LOG_FUNCTION(this << (periodic ? " periodic" : " triggered"));
-    for (SocketListI iter = m_unicastSocketList.begin(); iter != m_unicastSocketList.end(); iter++)
-    {
-        uint32_t interface = iter->second;
-        if (m_interfaceExclusions.find(interface) == m_interfaceExclusions.end())
-        {
-            uint16_t mtu = m_ipv4->GetMtu(interface);
-            uint16_t maxNse = (mtu - Ipv4Header().GetSerializedSize() -
-                               UdpHeader().GetSerializedSize() - DgrHeader().GetSerializedSize()) /
-                              DgrNse().GetSerializedSize();
-            Ptr<Packet> p = Create<Packet>();
-            SocketIpTtlTag ttlTag;
-            ttlTag.SetTtl(1);
-            p->AddPacketTag(ttlTag);
-
-            DgrHeader hdr;
-            hdr.SetCommand(DgrHeader::RESPONSE);
-            // Find the Status of every netdevice and put it in
-            // TODO: Finish this function when finish the NSE definiation
-            for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+    EventAccounting::Scope scope(EventAccounting::NEIGHBOR_STATE);
+    //
+    // The payload is the same on every interface: build its packets once,
+    // split for the smallest MTU, and send copies, which share the buffer.
+    //
+    std::vector<Ptr<Packet>> packets;
+    DgrHeader hdr;
+    if (BuildCompactStatusUpdate(hdr))
+    {
+        // a compact update always fits in one packet
+        AddDownstreamDelays(hdr);
+        packets.push_back(Create<Packet>());
+        packets.back()->AddHeader(hdr);
+    }
+    else
+    {
+        uint16_t mtu = UINT16_MAX;
+        for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+        {
+            if (IsControlInterface(i) && !IsExcludedInterface(i))
             {
-                if (!m_ipv4->IsUp(i))
-                    continue;
-                Ptr<LoopbackNetDevice> check =
-                    DynamicCast<LoopbackNetDevice>(m_ipv4->GetNetDevice(i));
-                if (check)
-                {
-                    continue;
-                }
-                // get the device
-                Ptr<NetDevice> dev = m_ipv4->GetNetDevice(i);
-                // get the queue disc on devic
-                Ptr<QueueDisc> disc = m_ipv4->GetObject<Node>()
-                                          ->GetObject<TrafficControlLayer>()
-                                          ->GetRootQueueDiscOnDevice(dev);
-                Ptr<DDRQueueDisc> qdisc = DynamicCast<DDRQueueDisc>(disc);
-                DgrNse nse;
-                nse.SetInterface(i);
-                nse.SetState(qdisc->GetQueueStatus());
-                hdr.AddNse(nse);
-                if (hdr.GetNseNumber() == maxNse)
-                {
-                    p->AddHeader(hdr);
-                    NS_LOG_DEBUG("SendTo: " << *p);
-                    iter->first->SendTo(
-                        p,
-                        0,
-                        InetSocketAddress(DDR_BROAD_CAST,
-                                          DDR_PORT)); // Todo : defind the port for DGR routing
-                    p->RemoveHeader(hdr);
-                    hdr.ClearNses();
-                }
+                mtu = std::min(mtu, m_ipv4->GetMtu(i));
+            }
+        }
+        // the downstream delays go in the first packet
+        AddDownstreamDelays(hdr);
+        uint16_t transport = m_controlChannel ? 0 : UdpHeader().GetSerializedSize();
+        uint16_t maxNse = (mtu - Ipv4Header().GetSerializedSize() - transport -
+                           hdr.GetSerializedSize()) /
+                          DgrNse().GetSerializedSize();
+        hdr.SetCommand(DgrHeader::RESPONSE);
+        // Find the Status of every netdevice and put it in
+        for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+        {
+            if (!m_ipv4->IsUp(i))
+                continue;
+            // loopback and non-DDR devices have no DDR queue disc
+            const InterfaceBinding& binding = GetInterfaceBinding(i);
+            if (!binding.qdisc)
+            {
+                continue;
             }
-            if (hdr.GetNseNumber() > 0)
+            DgrNse nse;
+            nse.SetInterface(i);
+            nse.SetState(binding.qdisc->GetQueueStatus(m_tsdb.GetNStates()));
+            hdr.AddNse(nse);
+            if (hdr.GetNseNumber() == maxNse)
             {
-                p->AddHeader(hdr);
-                NS_LOG_DEBUG("SendTo: " << *p);
-                iter->first->SendTo(
-                    p,
-                    0,
-                    InetSocketAddress(DDR_BROAD_CAST, DDR_PORT)); // Todo: Defined the DGR port
+                packets.push_back(Create<Packet>());
+                packets.back()->AddHeader(hdr);
+                hdr.ClearNses();
+                hdr.ClearDownstreams();
             }
         }
+        if (hdr.GetNseNumber() > 0)
+        {
+            packets.push_back(Create<Packet>());
+            packets.back()->AddHeader(hdr);
+        }
+    }
+    SocketIpTtlTag ttlTag;
+    ttlTag.SetTtl(1);
+    for (auto p = packets.begin(); p != packets.end(); p++)
+    {
+        (*p)->AddPacketTag(ttlTag);
+    }
+
+    // one copy per interface, however many addresses it has
+    for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+    {
+        if (!IsControlInterface(i) || IsExcludedInterface(i))
+        {
+            continue;
+        }
+        for (auto p = packets.begin(); p != packets.end(); p++)
+        {
+            Ptr<Packet> copy = (*p)->Copy();
+            NS_LOG_DEBUG("SendTo: " << *copy);
+            SendControl(copy, i);
+        }
+    }
+}
+
+bool
+DDRRouting::IsControlInterface(uint32_t interface) const
+{
+    if (m_controlChannel)
+    {
+        return interface < m_controlInterfaces.size() && m_controlInterfaces[interface];
+    }
+    return interface < m_interfaceSockets.size() && m_interfaceSockets[interface];
+}
+
+void
+DDRRouting::SendControl(Ptr<Packet> p, uint32_t interface)
+{
+    if (m_controlChannel)
+    {
+        m_controlChannel->Send(p, interface, Ipv4Address(DDR_BROAD_CAST));
+        return;
+    }
+    // Todo: Defined the DGR port
+    m_interfaceSockets[interface]->SendTo(p, 0, InetSocketAddress(DDR_BROAD_CAST, DDR_PORT));
+}
+
+bool
+DDRRouting::BuildCompactStatusUpdate(DgrHeader& hdr)
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_compactStatusUpdates || m_tsdb.GetNStates() > DgrHeader::COMPACT_MAX_STATE + 1 ||
+        m_ipv4->GetNInterfaces() > DgrHeader::COMPACT_MAX_INTERFACE + 1)
+    {
+        return false;
+    }
+    bool full = m_updatesSinceRefresh == 0;
+    m_updatesSinceRefresh = (m_updatesSinceRefresh + 1) % std::max(m_fullStatusRefresh, 1U);
+    m_sentStates.resize(m_ipv4->GetNInterfaces(), -1);
+    hdr.SetCommand(DgrHeader::RESPONSE);
+    hdr.SetCompact(true);
+    hdr.SetDelta(!full);
+    for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+    {
+        // loopback and non-DDR devices have no DDR queue disc
+        const InterfaceBinding& binding = GetInterfaceBinding(i);
+        if (!m_ipv4->IsUp(i) || !binding.qdisc)
+        {
+            m_sentStates[i] = -1;
+            continue;
+        }
+        int32_t state = binding.qdisc->GetQueueStatus(m_tsdb.GetNStates());
+        if (full || state != m_sentStates[i])
+        {
+            DgrNse nse;
+            nse.SetInterface(i);
+            nse.SetState(state);
+            hdr.AddNse(nse);
+        }
+        m_sentStates[i] = state;
     }
+    return true;
 }
 
 void
-DDRRouting::HandleResponses(DgrHeader hdr,
+DDRRouting::HandleResponses(const DgrHeader& hdr,
                             Ipv4Address senderAddress,
                             uint32_t incomingInterface,
                             uint8_t hopLimit)
 {
     NS_LOG_FUNCTION(this << senderAddress << incomingInterface << int(hopLimit) << hdr);
-    if (m_interfaceExclusions.find(incomingInterface) != m_interfaceExclusions.end())
+    if (IsExcludedInterface(incomingInterface))
     {
         NS_LOG_LOGIC(
             "Ignoring an update message from an excluded interface: " << incomingInterface);
@@ -1353,26 +3130,51 @@ DDRRouting::HandleResponses(DgrHeader hdr,
     {
         NS_LOG_LOGIC("Ignoring an update message without neighbor state entries!");
     }
-
-    NeighborStatusEntry* entry = m_tsdb.HandleNeighborStatusEntry(incomingInterface);
-    if (entry == nullptr)
+    // the delay estimates through the interface change
+    if (incomingInterface < m_stateEpochs.size())
+    {
+        m_stateEpochs[incomingInterface]++;
+        m_stateStamp++;
+    }
+    if (hdr.HasDownstream())
     {
-        entry = new NeighborStatusEntry();
-        m_tsdb.Insert(incomingInterface, entry);
+        HandleDownstreamDelays(hdr, incomingInterface);
     }
 
-    std::list<DgrNse> nses = hdr.GetNseList();
-    for (std::list<DgrNse>::iterator iter = nses.begin(); iter != nses.end(); iter++)
+    const DgrNse* nses = hdr.GetNses();
+    const DgrNse* end = nses + hdr.GetNseNumber();
+    if (hdr.IsDelta())
     {
-        uint32_t n_iface = (*iter).GetInterface();
-        int n_state = (*iter).GetState();
-        StatusUnit* su = entry->GetStatusUnit(n_iface);
-        if (su == nullptr)
+        // the states the neighbor left out are the ones it sent last, and
+        // every update is a transition of the Markov chains
+        std::vector<int>& states = m_deltaStates;
+        states.resize(m_tsdb.GetNNeighborInterfaces());
+        for (uint32_t n = 0; n < states.size(); n++)
+        {
+            states[n] = m_tsdb.GetLastState(incomingInterface, n);
+        }
+        for (const DgrNse* nse = nses; nse != end; nse++)
+        {
+            if (nse->GetInterface() >= states.size())
+            {
+                states.resize(nse->GetInterface() + 1, -1);
+            }
+            states[nse->GetInterface()] = nse->GetState();
+        }
+        for (uint32_t n = 0; n < states.size(); n++)
         {
-            su = new StatusUnit();
-            entry->Insert(n_iface, su);
+            if (states[n] >= 0)
+            {
+                m_tsdb.Update(incomingInterface, n, states[n]);
+            }
         }
-        su->Update(n_state);
+        return;
+    }
+    for (const DgrNse* nse = nses; nse != end; nse++)
+    {
+        uint32_t n_iface = nse->GetInterface();
+        int n_state = nse->GetState();
+        m_tsdb.Update(incomingInterface, n_iface, n_state);
         // std::ostream* os = m_outStream->GetStream ();
         // *os << "Iface: " << n_iface << " Predict Err: " << abs(n_state - su->GetCurrentState ())
         // << std::endl; Print the su su->Print (std::cout);
@@ -1469,4 +3271,14 @@ DDRRouting::HandleResponses(DgrHeader hdr,
 //     }
 // }
 
-} // namespace ns3
\ No newline at end of file
+} // namespace ns3
+
+// the members of the core, logged under the component of the protocol
+#include "romam-routing-core-impl.h"
+
+namespace ns3
+{
+
+template class RomamRoutingCore<DDRRouting, ShortestPathForestRIE>;
+
+} // namespace ns3
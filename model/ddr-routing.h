@@ -3,7 +3,14 @@
 #ifndef DDR_ROUTING_H
 #define DDR_ROUTING_H
 
-#include "romam-routing.h"
+#include "romam-routing-core.h"
+#include "routing_algorithm/kshortest-path-table.h"
+#include "routing_algorithm/spf-route-info-entry.h"
+#include "utility/control-channel.h"
+#include "utility/flow-cache.h"
+#include "utility/route-entry-pool.h"
+#include "utility/split-table.h"
+#include "utility/timer-wheel.h"
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -12,9 +19,12 @@
 #include "ns3/ptr.h"
 #include "ns3/random-variable-stream.h"
 
-#include <list>
 #include <map>
+#include <memory>
 #include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -27,16 +37,40 @@ class Ipv4Header;
 class Node;
 class ShortestPathForestRIE;
 class TSDB;
+class DDRQueueDisc;
+class RomamMetaTag;
+class AgentChannel;
+class PolicyTable;
 
 typedef enum
 {
     NONE,
     KSHORT,
     DGR,
-    DDR
+    DDR,
+    DGR_DAG,
+    DDR_DAG,
+    POLICY
 } RouteSelectMode_t;
 
-class DDRRouting : public RomamRouting
+/// what the source does with a budgeted packet no route can deliver in time
+typedef enum
+{
+    ADMIT_ALL,      //!< send it anyway
+    ADMIT_DROP,     //!< drop it
+    ADMIT_DOWNGRADE //!< send it on the shortest routes without its priority
+} BudgetAdmission_t;
+
+/// how the NONE and KSHORT route select modes weigh the routes they split the packets among
+typedef enum
+{
+    SPLIT_OFF,     //!< no split: the shortest route (NONE), a uniform draw (KSHORT)
+    SPLIT_EQUAL,   //!< the same weight for every route
+    SPLIT_COST,    //!< the inverse of the distance of the route
+    SPLIT_CAPACITY //!< the data rate of the first link of the route
+} SplitPolicy_t;
+
+class DDRRouting : public RomamRoutingCore<DDRRouting, ShortestPathForestRIE>
 {
   public:
     /**
@@ -56,22 +90,10 @@ class DDRRouting : public RomamRouting
     ~DDRRouting() override;
 
     // These methods inherited from Ipv4Routing Protocol class
-    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
-                               const Ipv4Header& header,
-                               Ptr<NetDevice> oif,
-                               Socket::SocketErrno& sockerr) override;
-    bool RouteInput(Ptr<const Packet> p,
-                    const Ipv4Header& header,
-                    Ptr<const NetDevice> idev,
-                    const UnicastForwardCallback& ucb,
-                    const MulticastForwardCallback& mcb,
-                    const LocalDeliverCallback& lcb,
-                    const ErrorCallback& ecb) override;
     void NotifyInterfaceUp(uint32_t interface) override;
     void NotifyInterfaceDown(uint32_t interface) override;
     void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
     void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
-    void SetIpv4(Ptr<Ipv4> ipv4) override;
     void PrintRoutingTable(Ptr<OutputStreamWrapper> stream,
                            Time::Unit unit = Time::S) const override;
 
@@ -79,24 +101,7 @@ class DDRRouting : public RomamRouting
     void DoInitialize() override;
 
     // These methods inherited from RomamRouting class
-    void AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface) override;
-    void AddHostRouteTo(Ipv4Address dest, uint32_t interface) override;
-    void AddHostRouteTo(Ipv4Address dest,
-                        Ipv4Address nextHop,
-                        uint32_t interface,
-                        uint32_t nextInterface,
-                        uint32_t distance) override;
-    void AddNetworkRouteTo(Ipv4Address network,
-                           Ipv4Mask networkMask,
-                           Ipv4Address nextHop,
-                           uint32_t interface) override;
-    void AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface) override;
-    void AddASExternalRouteTo(Ipv4Address network,
-                              Ipv4Mask networkMask,
-                              Ipv4Address nextHop,
-                              uint32_t interface) override;
-    uint32_t GetNRoutes(void) const override;
-    void RemoveRoute(uint32_t i) override;
+    std::size_t GetMemoryFootprint() const override;
 
     /**
      * Assign a fixed random variable stream number to the random variables
@@ -108,7 +113,70 @@ class DDRRouting : public RomamRouting
      */
     int64_t AssignStreams(int64_t stream);
 
-    ShortestPathForestRIE* GetRoute(uint32_t i) const;
+    /**
+     * \brief Get the k shortest paths the KSHORT route select mode forwards on.
+     *
+     * The KShortestPathAlgorithm fills the table; while it is empty, KSHORT
+     * picks among the host routes to the destination instead.  ClearRoutes ()
+     * leaves the table alone.  Getting it drops the split tables of its
+     * paths, rebuilt at the next lookup.
+     *
+     * With the KShortestHotDestinations attribute set, the destinations keep
+     * their best path only, except the ones KSHORT looked up the most in the
+     * last KShortestHotWindow, which get their k shortest paths back through
+     * RouteManager::RestoreKShortestPaths ().
+     *
+     * \return the table
+     */
+    KShortestPathTable& GetKShortestPathTable();
+
+    /**
+     * \return the number of destinations KSHORT keeps the k shortest paths
+     * of, 0 for all of them
+     */
+    uint32_t GetKShortestHotDestinations() const;
+
+    /**
+     * \brief Get the largest control burst: the most unsolicited neighbor
+     * state updates the nodes sent in one RomamControlBurstWindow, since the
+     * simulation started or ResetControlBurst ().
+     * \return the number of updates
+     */
+    static uint32_t GetControlBurstPeak();
+
+    /**
+     * \return the start of the window of GetControlBurstPeak ()
+     */
+    static Time GetControlBurstPeakTime();
+
+    /**
+     * \brief Forget the control bursts counted so far.
+     */
+    static void ResetControlBurst();
+
+    /**
+     * \brief Take the route decisions of an external agent for the
+     * budgeted packets, see AgentChannel.
+     * \param channel the channel, or null to stop
+     * \param node the row of this router in the channel
+     */
+    void SetAgentChannel(const AgentChannel* channel, uint32_t node);
+
+    /**
+     * \brief Write the features of this router for an AgentChannel.
+     * \param ifaces filled with the AgentChannel::IFACE_FEATURES values of
+     * every interface below nIfaces, zero for the ones it has not
+     * \param nIfaces the interfaces of the rows
+     * \param routes filled with the AgentChannel::ROUTE_FEATURES values of
+     * every destination and interface, -1 if no candidate route to the
+     * destination goes through the interface
+     * \param dests the destinations
+     */
+    void FillAgentFeatures(float* ifaces,
+                           uint32_t nIfaces,
+                           float* routes,
+                           const std::vector<Ipv4Address>& dests);
+
     void InitializeSocketList();
 
   protected:
@@ -118,35 +186,413 @@ class DDRRouting : public RomamRouting
     void DoDispose(void) override;
 
   private:
+    friend class RomamRoutingCore<DDRRouting, ShortestPathForestRIE>;
+
+    /**
+     * \brief Have the RouteManager recompute the routes of the network after
+     * an interface event, incrementally if the IncrementalUpdates attribute is
+     * set.  The events of a burst are coalesced into one recompute.
+     */
+    void RecomputeRoutes();
+
+    /**
+     * \param size the number of slots of the decision cache, 0 to disable it
+     */
+    void SetDecisionCacheSize(uint32_t size);
+
+    /**
+     * \return the number of slots of the decision cache
+     */
+    uint32_t GetDecisionCacheSize() const;
+
+    /**
+     * \param timeout the age after which a cached decision is taken again
+     */
+    void SetDecisionCacheTimeout(Time timeout);
+
+    /**
+     * \return the age after which a cached decision is taken again
+     */
+    Time GetDecisionCacheTimeout() const;
+
+    /**
+     * \param size the number of slots of the output route cache, 0 to
+     * disable it
+     */
+    void SetOutputRouteCacheSize(uint32_t size);
+
+    /**
+     * \return the number of slots of the output route cache
+     */
+    uint32_t GetOutputRouteCacheSize() const;
+
     /// Set to true if packets are randomly routed among ECMP; set to false for using only one route
     /// consistently
     bool m_randomEcmpRouting;
     /// Set to true if this interface should respond to interface events by globallly recomputing
     /// routes
     bool m_respondToInterfaceEvents;
+    /// Set to true to update only the routes an interface event changes
+    bool m_incrementalUpdates;
+    /// Set to true to forward on the loop-free alternates of the routes of the interfaces down
+    bool m_fastReroute;
+    /// number of interfaces down, as of the last refresh of the bindings
+    uint32_t m_nDownInterfaces;
     /// A uniform random number generator for randomly routing packets among ECMP
     Ptr<UniformRandomVariable> m_rand;
 
-    /// container of Ipv4RoutingTableEntry (routes to hosts)
-    typedef std::list<ShortestPathForestRIE*> HostRoutes;
-    /// const iterator of container of Ipv4RoutingTableEntry (routes to hosts)
-    typedef std::list<ShortestPathForestRIE*>::const_iterator HostRoutesCI;
-    /// iterator of container of Ipv4RoutingTableEntry (routes to hosts)
-    typedef std::list<ShortestPathForestRIE*>::iterator HostRoutesI;
+    /// pool of the route entries
+    typedef RouteEntryPool<ShortestPathForestRIE> RoutePool;
+
+    /// a host route, as its destination and its rank in the next-hop group of the destination
+    struct HostRouteRef
+    {
+        uint32_t dest; //!< destination address (Ipv4Address::Get ())
+        uint32_t rank; //!< index of the route in NextHopGroup::routes
+    };
+
+    /// the host routes, in insertion order
+    typedef std::vector<HostRouteRef> HostRoutes;
+
+    /// candidate host routes towards one destination, in insertion order
+    typedef std::vector<RoutePool::Handle> HostRouteCandidates;
+
+    /// a candidate host route, with the static part of its delay estimate
+    struct RankedHostRoute
+    {
+        ShortestPathForestRIE* route; //!< the host route
+        uint32_t distance;            //!< route->GetDistance (), the delay lower bound
+        uint64_t sequence;            //!< rank of the route in insertion order
+    };
+
+    /// candidate host routes towards one destination, by increasing distance
+    typedef std::vector<RankedHostRoute> RankedHostRoutes;
+
+    /**
+     * \brief The fields of the host routes of a next-hop group the delay
+     * evaluation reads, as contiguous arrays in the order of byDistance.
+     */
+    struct CandidateArrays
+    {
+        std::vector<uint32_t> distance;        //!< distance of the route
+        std::vector<uint32_t> iface;           //!< output interface of the route
+        std::vector<uint32_t> nextIface;       //!< interface of the next hop, 0xffffffff if unknown
+        std::vector<uint32_t> downstream;      //!< downstream delay the next hop sent, in us
+        std::vector<uint32_t> downstreamEpoch; //!< update of iface it came in, 0 for none
+    };
+
+    /**
+     * \brief The host routes towards the addresses of a router.
+     *
+     * The routes towards every address of a router go through the same
+     * neighbors with the same distances, so InstallRoutes () has the
+     * destinations whose routes match share one group.  The entries of a
+     * shared group carry the address of one of the destinations only.
+     *
+     * In the DGR_DAG and DDR_DAG route select modes, the group also keeps
+     * the loop-free successors, the routes through the neighbors strictly
+     * closer to the destination than this router: forwarding on them only,
+     * the distance decreases at every hop, and the packets need no loop
+     * limit.  With a SplitPolicy, the NONE mode splits the packets among
+     * them by the split table of the group.
+     */
+    struct NextHopGroup
+    {
+        /**
+         * \brief The DGR decision table of the group, with DgrDecisionTables.
+         *
+         * A row lists the candidates, in insertion order, whose delay
+         * estimate meets the lowest budget of a DecisionBudgetBucket, for a
+         * loop limit and an input interface, which a lookup draws from.  The
+         * rows are dropped once the routes, or the neighbor state or the
+         * local queue level of an interface of the candidates, changed.
+         */
+        struct DecisionTable
+        {
+            uint32_t generation;          //!< m_tableGeneration the interfaces are of
+            uint64_t stamp;               //!< m_stateStamp the rows were last checked at
+            uint64_t epochs;              //!< sum of the m_stateEpochs of the interfaces
+            std::vector<uint32_t> ifaces; //!< the output interfaces of the candidates
+            /// the feasible candidates, by budget bucket, loop limit and input interface
+            std::unordered_map<uint64_t, std::vector<uint32_t>> rows;
+        };
+
+        HostRouteCandidates routes;          //!< in insertion order, owned by the group
+        RankedHostRoutes byDistance;         //!< by increasing distance, then insertion order
+        CandidateArrays candidates;          //!< byDistance, as arrays
+        RankedHostRoutes successors;         //!< the loop-free successors, in byDistance order
+        CandidateArrays successorCandidates; //!< successors, as arrays
+        uint32_t split;                      //!< the split table of successors, or NO_SPLIT
+        uint32_t nDests;                     //!< destinations that share the group
+        DecisionTable dgrTable;              //!< DGR decisions, not shared by the copies
+    };
 
-    /// container of Ipv4RoutingTableEntry (routes to networks)
-    typedef std::list<ShortestPathForestRIE*> NetworkRoutes;
-    /// const iterator of container of Ipv4RoutingTableEntry (routes to networks)
-    typedef std::list<ShortestPathForestRIE*>::const_iterator NetworkRoutesCI;
-    /// iterator of container of Ipv4RoutingTableEntry (routes to networks)
-    typedef std::list<ShortestPathForestRIE*>::iterator NetworkRoutesI;
+    /// the split table of a next-hop group whose successors are not split among
+    static const uint32_t NO_SPLIT = 0xffffffff;
 
-    /// container of RoutingTableEntry (routes to external AS)
-    typedef std::list<ShortestPathForestRIE*> ASExternalRoutes;
-    /// const iterator of container of Ipv4RoutingTableEntry (routes to external AS)
-    typedef std::list<ShortestPathForestRIE*>::const_iterator ASExternalRoutesCI;
-    /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
-    typedef std::list<ShortestPathForestRIE*>::iterator ASExternalRoutesI;
+    /// the next-hop groups by AddressInterner index of the destination, null if no route
+    typedef std::vector<NextHopGroup*> HostRouteIndex;
+
+    // These methods called by RomamRoutingCore
+    Ptr<Ipv4Route> SelectOutputRoute(Ptr<Packet> p,
+                                     const Ipv4Header& header,
+                                     Ptr<NetDevice> oif);
+    Ptr<Ipv4Route> SelectInputRoute(Ptr<const Packet>& p,
+                                    const Ipv4Header& header,
+                                    Ptr<const NetDevice> idev);
+    uint32_t GetNHostRoutes() const;
+    void RemoveHostRoute(uint32_t i);
+    void ClearHostRoutes();
+    void NotifyRoutesChanged();
+    void NotifyRoutesInstalled();
+
+    /**
+     * \brief Add a host route to the next-hop group of its destination.
+     * \param route the host route
+     */
+    void AddHostRoute(const ShortestPathForestRIE& route);
+    /**
+     * \brief Get a host route, in insertion order.
+     *
+     * The route is built from its next-hop group on every call, so the entry
+     * returned is only valid until the next call.
+     *
+     * \param i the index of the host route
+     * \return the route
+     */
+    ShortestPathForestRIE* GetHostRoute(uint32_t i) const;
+    /**
+     * \brief Get the next-hop group of a destination for writing, after
+     * copying it if other destinations share it.
+     * \param dest destination address
+     * \return the group of dest, owned by dest alone
+     */
+    NextHopGroup* UnshareNextHopGroup(uint32_t dest);
+    /**
+     * \brief Have the destinations whose host routes match share one
+     * next-hop group, and delete the copies.
+     */
+    void ShareNextHopGroups();
+    /**
+     * \brief Rebuild the candidate arrays of a next-hop group from its
+     * routes by distance, and its loop-free successors in the DAG route
+     * select modes.
+     *
+     * The SPF tree of the route through the neighbor N leaves this router S
+     * out, so dist (N, D) is its distance less the metric of the link to N;
+     * N is a successor when that is less than dist (S, D), the distance of
+     * the shortest route.  The shortest routes always are.
+     *
+     * \param group the next-hop group
+     */
+    void IndexCandidates(NextHopGroup* group);
+    /**
+     * \brief Rebuild candidate arrays from the routes they are the arrays of.
+     * \param routes the routes, by increasing distance
+     * \param candidates the arrays
+     */
+    static void FillCandidateArrays(const RankedHostRoutes& routes, CandidateArrays& candidates);
+    /**
+     * \param candidates candidate arrays
+     * \return the number of bytes of the arrays
+     */
+    static std::size_t GetCandidateArraysFootprint(const CandidateArrays& candidates);
+    /**
+     * \param table a DGR decision table
+     * \return the number of bytes of its interfaces and rows
+     */
+    static std::size_t GetDecisionTableFootprint(const NextHopGroup::DecisionTable& table);
+    /**
+     * \return true in the route select modes that forward on the loop-free
+     * successors, DGR_DAG and DDR_DAG
+     */
+    bool IsLoopFreeMode() const;
+    /**
+     * \brief Rebuild the split tables of the successors of the next-hop
+     * groups, once the routes are installed.
+     */
+    void BuildHostRouteSplits();
+    /**
+     * \brief Rebuild the split tables of the k shortest paths, at the first
+     * lookup after the KShortestPathAlgorithm refilled them.
+     */
+    void BuildKShortestSplits();
+    /**
+     * \brief Count a KSHORT lookup of a destination, restoring its paths if
+     * it is trimmed and fewer than KShortestHotDestinations are full, and
+     * review the destinations at the end of the window.
+     *
+     * The references to the paths of the destination are no longer valid.
+     *
+     * \param d the destination in m_kShortestPaths
+     */
+    void CountKShortestLookup(uint32_t d);
+    /**
+     * \brief Keep the k shortest paths of the destinations looked up the most
+     * in the window, trim the others to their best path, and start a window.
+     */
+    void ReviewHotDestinations();
+    /**
+     * \param iface the output interface of a route
+     * \param distance the distance of the route
+     * \return the weight of the route in the splits, by the SplitPolicy
+     */
+    double GetSplitWeight(uint32_t iface, uint32_t distance) const;
+    /**
+     * \param header the IP header of a packet
+     * \param p the packet
+     * \return the hash that picks the route of the packet in a split table:
+     * that of its flow with SplitByFlow, a random draw otherwise
+     */
+    uint32_t GetSplitHash(const Ipv4Header& header, Ptr<const Packet> p);
+    /**
+     * \brief Lookup the successor a split table gives a packet, in the NONE
+     * route select mode with a SplitPolicy.
+     *
+     * A packet whose successor is down or goes back through its input
+     * device, or towards a destination with no split, goes on the shortest
+     * route instead.
+     *
+     * \param dest destination address
+     * \param idev the input device, which the route must not go back through
+     * \param hash the hash of the packet, from GetSplitHash ()
+     * \return Ipv4Route to route the packet to reach dest address
+     */
+    Ptr<Ipv4Route> LookupSplitRoute(Ipv4Address dest, Ptr<const NetDevice> idev, uint32_t hash);
+    /**
+     * \brief Get the candidate host routes towards a destination.
+     * \param dest destination address
+     * \return the candidates, empty if there is no host route to dest
+     */
+    const HostRouteCandidates& FindHostRoutes(Ipv4Address dest) const;
+    /**
+     * \brief Get the candidate host routes towards a destination, shortest first.
+     *
+     * The queueing delays DDR and DGR add to the distance of a route are never
+     * negative, so a lookup can stop at the first route whose distance alone is
+     * over the budget: no route after it fits either.
+     *
+     * \param dest destination address
+     * \return the candidates, empty if there is no host route to dest
+     */
+    const RankedHostRoutes& FindHostRoutesByDistance(Ipv4Address dest) const;
+    /**
+     * \brief Get the next-hop group of a destination.
+     * \param dest destination address
+     * \return the group, empty if there is no host route to dest
+     */
+    const NextHopGroup& FindNextHopGroup(Ipv4Address dest) const;
+    /**
+     * \brief Whether a budgeted packet may meet its budget on a host route.
+     *
+     * The distance of the shortest host route to the destination bounds the
+     * delay of all of them, the queueing delays only adding to it.
+     *
+     * \param dest destination address
+     * \param metaTag the metadata of the packet
+     * \return false if the packet has less budget left than the bound, true
+     * otherwise or if there is no host route to dest
+     */
+    bool IsBudgetFeasible(Ipv4Address dest, const RomamMetaTag& metaTag) const;
+
+    /// number of candidates LookupDDRRoute and LookupDGRRoute evaluate at once
+    static const uint32_t CANDIDATE_BLOCK = 8;
+
+    /// the delays of a block of candidates, as EvaluateCandidateBlock () gathers them
+    struct CandidateBlock
+    {
+        uint32_t hops[CANDIDATE_BLOCK];   //!< the delay bounds of the distances, in us
+        uint32_t delays[CANDIDATE_BLOCK]; //!< the queueing delays in us, UINT32_MAX if unusable
+        uint32_t looping;                 //!< bitmask of the candidates through the input device
+        uint32_t usable;                  //!< bitmask of the candidates that may be taken
+    };
+
+    /**
+     * \brief Estimate the delays of a block of candidates, and find those
+     * that meet a budget.
+     *
+     * The queueing delays are gathered one candidate at a time, from the
+     * queue discs and the TSDB; the budget test is then a branch-free loop
+     * over the block, which the compiler vectorizes.
+     *
+     * \param candidates the candidate arrays of a next-hop group
+     * \param begin the first candidate of the block
+     * \param end the candidate after the block, at most CANDIDATE_BLOCK after begin
+     * \param bgt the budget, in us
+     * \param hopOffset the hops added to the distance of a candidate for its delay bound
+     * \param predicted true for the predicted delays of the neighbors (DDR), false for the
+     * last ones (DGR)
+     * \param inputIface the input interface, which the route must not go back
+     * through, or NO_INTERFACE
+     * \param block set to the delays of the block
+     * \return the bitmask of the candidates of the block that meet the budget
+     */
+    uint32_t EvaluateCandidateBlock(const CandidateArrays& candidates,
+                                    uint32_t begin,
+                                    uint32_t end,
+                                    uint32_t bgt,
+                                    uint32_t hopOffset,
+                                    bool predicted,
+                                    uint32_t inputIface,
+                                    CandidateBlock& block);
+    /**
+     * \brief Get the best delay towards the destination of a next-hop group,
+     * over the delay bound of its shortest route, that the neighbors may add
+     * to the delay through this router.
+     *
+     * It is the smallest over the usable candidates of the local queue delay,
+     * the predicted one of the next hop and the delay bound of the distance
+     * over the shortest one: the neighbors see the queues two hops away.
+     *
+     * \param candidates the candidate arrays of a next-hop group
+     * \return the delay in us, UINT32_MAX if no candidate is usable
+     */
+    uint32_t GetDownstreamDelay(const CandidateArrays& candidates);
+    /**
+     * \brief Add the largest downstream delays to an update, if the
+     * DownstreamDelays attribute asks for them.
+     *
+     * A next-hop group goes by one of its destinations, which the neighbors
+     * route the same, the distances of the group being those to one router.
+     *
+     * \param hdr the header of the update
+     */
+    void AddDownstreamDelays(DgrHeader& hdr);
+    /**
+     * \brief Record the downstream delays of a neighbor in the candidates
+     * through it, in place of those it sent before.
+     * \param hdr the header of the update
+     * \param incomingInterface the interface of the neighbor
+     */
+    void HandleDownstreamDelays(const DgrHeader& hdr, uint32_t incomingInterface);
+    /**
+     * \brief Count the leading candidates of a next-hop group within the loop
+     * limit whose delay bounds alone meet a budget.
+     *
+     * The candidates are sorted by distance, so no candidate after them is
+     * within both limits.
+     *
+     * \param candidates the candidate arrays of a next-hop group
+     * \param dist the loop limit, the largest distance a candidate may have
+     * \param bgt the budget, in us
+     * \param hopOffset the hops added to the distance of a candidate for its delay bound
+     * \param metricDelay the delay of a unit of link metric, in us
+     * \param reason set to the limit the first candidate left out is over, if any
+     * \return the number of candidates within both limits
+     */
+    static uint32_t CountWithinLimits(const CandidateArrays& candidates,
+                                      uint32_t dist,
+                                      uint32_t bgt,
+                                      uint32_t hopOffset,
+                                      uint32_t metricDelay,
+                                      DecisionTrace::Reason& reason);
+    /**
+     * \brief Count the candidates of a block scanned and rejected.
+     * \param block the delays of the block
+     * \param feasible the bitmask of the candidates that meet the budget
+     * \param n the number of candidates of the block scanned
+     */
+    void CountCandidateBlock(const CandidateBlock& block, uint32_t feasible, uint32_t n) const;
 
     /**
      * \brief Lookup in the forwarding table for destination.
@@ -155,19 +601,313 @@ class DDRRouting : public RomamRouting
      * \return Ipv4Route to route the packet to reach dest address
      */
     Ptr<Ipv4Route> LookupECMPRoute(Ipv4Address dest, Ptr<NetDevice> oif = 0);
+
+    /**
+     * \brief Look up the shortest route of a packet the node sends, in the
+     * output route cache first.
+     *
+     * The shortest routes only change with the routing table, whatever the
+     * neighbor states, so the route of a destination, output interface and
+     * route select mode is kept until m_tableGeneration moves, and a source
+     * sending to one peer looks it up once.
+     *
+     * \param dest destination address
+     * \param oif output interface if any (put 0 otherwise)
+     * \return Ipv4Route to route the packet to reach dest address
+     */
+    Ptr<Ipv4Route> LookupOutputECMPRoute(Ipv4Address dest, Ptr<NetDevice> oif);
+
+    /**
+     * \brief Lookup a route for a delay guaranteed packet, in the
+     * KSHORT, DGR or DDR route select mode.
+     *
+     * The packet is left alone; the caller writes the metadata back if
+     * it changed.  In the DGR_DAG and DDR_DAG modes, the candidates are the
+     * loop-free successors alone, and the distance of the packet is neither
+     * read nor set.
+     *
+     * \param dest destination address
+     * \param metaTag the metadata of the packet, whose distance is set to
+     * that of the route found
+     * \param idev the input device, which the route must not go back through
+     * \param splitHash the hash of the packet, from GetSplitHash (), that
+     * picks its path by the split table of the k shortest paths with a
+     * SplitPolicy (KSHORT only)
+     * \return Ipv4Route to route the packet to reach dest address
+     */
     Ptr<Ipv4Route> LookupKShortRoute(Ipv4Address dest,
-                                     Ptr<Packet> p,
-                                     Ptr<const NetDevice> idev = 0);
-    Ptr<Ipv4Route> LookupDGRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev = 0);
-    Ptr<Ipv4Route> LookupDDRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev = 0);
+                                     RomamMetaTag& metaTag,
+                                     Ptr<const NetDevice> idev = 0,
+                                     uint32_t splitHash = 0);
+    /**
+     * \brief Lookup a random host route among the ones whose estimated
+     * delay meets the budget of the packet.
+     *
+     * With DgrDecisionTables, the routes are drawn from the row of the
+     * decision table of the destination, unless it is empty, when the
+     * candidates are evaluated for the budget itself.
+     *
+     * \param dest destination address
+     * \param metaTag the metadata of the packet, whose distance is set to
+     * that of the route found
+     * \param idev the input device, which the route must not go back through
+     * \return Ipv4Route to route the packet to reach dest address
+     */
+    Ptr<Ipv4Route> LookupDGRRoute(Ipv4Address dest,
+                                  RomamMetaTag& metaTag,
+                                  Ptr<const NetDevice> idev = 0);
+    /**
+     * \brief Find the DGR candidates whose delay estimate meets a budget,
+     * into m_feasibleRoutes, in insertion order.
+     * \param ranked the candidates
+     * \param arrays the same, as arrays
+     * \param dist the loop limit
+     * \param bgt the budget, in us
+     * \param inputIface the input interface, which the routes must not use
+     * \param considered incremented by the candidates evaluated
+     * \param reason set to why the candidates evaluated last were rejected
+     */
+    void CollectDgrRoutes(const RankedHostRoutes& ranked,
+                          const CandidateArrays& arrays,
+                          uint32_t dist,
+                          uint32_t bgt,
+                          uint32_t inputIface,
+                          uint32_t& considered,
+                          DecisionTrace::Reason& reason);
+    /**
+     * \brief Get the row of the DGR decision table of a group, dropping
+     * the stale rows and filling the row if needed.
+     * \param group the next-hop group of the destination
+     * \param loopFree whether the candidates are the loop-free successors
+     * \param dist the loop limit
+     * \param bgt the budget, in us
+     * \param inputIface the input interface
+     * \return the indices in ranked of the feasible candidates, or null if
+     * the lookup has no row
+     */
+    const std::vector<uint32_t>* FindDecisionRow(NextHopGroup& group,
+                                                 bool loopFree,
+                                                 uint32_t dist,
+                                                 uint32_t bgt,
+                                                 uint32_t inputIface);
+    /**
+     * \brief Lookup the feasible host route of the smallest distance whose
+     * estimated delay meets the budget of the packet.
+     *
+     * With a decision cache, the decision is kept for the next packets of
+     * the flow with the same budget bucket and loop limit, until the
+     * neighbor states, a local queue level or the routes change, or it
+     * times out.
+     *
+     * In the DDR_DAG mode, the candidates are the loop-free successors,
+     * with no loop limit.
+     *
+     * \param dest destination address
+     * \param metaTag the metadata of the packet, whose distance is set to
+     * that of the route found
+     * \param idev the input device, which the route must not go back through
+     * \param flowHash the hash of the flow of the packet, for the decision cache
+     * \return Ipv4Route to route the packet to reach dest address
+     */
+    Ptr<Ipv4Route> LookupDDRRoute(Ipv4Address dest,
+                                  RomamMetaTag& metaTag,
+                                  Ptr<const NetDevice> idev = 0,
+                                  uint32_t flowHash = 0);
 
-    HostRoutes m_hostRoutes;             //!< Routes to hosts
-    NetworkRoutes m_networkRoutes;       //!< Routes to networks
-    ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
-    Ptr<Ipv4> m_ipv4;                    //!< associated IPv4 instance
+    /**
+     * \brief Look up the route through the interface the agent decided on, if
+     * a candidate of the route select mode goes through it
+     * \param dest destination address
+     * \param metaTag the metadata of the packet, whose distance is set to
+     * that of the route found
+     * \param idev the input device, which the route must not go back through
+     * \return the route, or null if the agent decided none or no candidate
+     */
+    Ptr<Ipv4Route> LookupAgentRoute(Ipv4Address dest,
+                                    RomamMetaTag& metaTag,
+                                    Ptr<const NetDevice> idev);
+
+    /**
+     * \brief Look up the route through the interface the PolicyTable
+     * decided on for the destination, the states and the budget, if a
+     * candidate of the DDR mode goes through it
+     * \param dest destination address
+     * \param metaTag the metadata of the packet, whose distance is set to
+     * that of the route found
+     * \param idev the input device, which the route must not go back through
+     * \return the route, or null if the table has no decision for the key or
+     * no candidate
+     */
+    Ptr<Ipv4Route> LookupPolicyRoute(Ipv4Address dest,
+                                     RomamMetaTag& metaTag,
+                                     Ptr<const NetDevice> idev);
+
+    /**
+     * \brief Look up the shortest candidate of the route select mode through
+     * an interface, within the loop limit of the packet
+     * \param dest destination address
+     * \param iface the output interface, 0 for none
+     * \param metaTag the metadata of the packet, whose distance is set to
+     * that of the route found
+     * \param idev the input device, which the route must not go back through
+     * \param counter the RoutingStats counter of the lookups that found a route
+     * \return the route, or null if no candidate goes through the interface
+     */
+    Ptr<Ipv4Route> LookupInterfaceRoute(Ipv4Address dest,
+                                        uint32_t iface,
+                                        RomamMetaTag& metaTag,
+                                        Ptr<const NetDevice> idev,
+                                        RoutingStats::Counter counter);
+
+    /**
+     * \brief Load the PolicyTable of the PolicyTable attribute, and map the
+     * addresses of the routers to their node IDs.
+     */
+    void BindPolicyTable();
 
+    /**
+     * \return the packed states of this router in m_policy, computed again
+     * once a neighbor state or a local queue level changed
+     */
+    uint32_t GetPolicyState();
+
+    /**
+     * \brief Handles of one interface used by the forwarding fast path.
+     *
+     * Resolving these through the Node/TrafficControlLayer chain costs
+     * several object lookups, so they are cached here and refreshed on
+     * interface events.
+     */
+    struct InterfaceBinding
+    {
+        Ptr<NetDevice> device;   //!< the output net device
+        Ptr<DDRQueueDisc> qdisc; //!< root queue disc of the device, if a DDRQueueDisc
+        bool up;                 //!< whether the interface is up
+        uint16_t metric;         //!< the metric of the interface
+    };
+
+    /// interface bindings, indexed by interface number
+    typedef std::vector<InterfaceBinding> InterfaceBindings;
+
+    /**
+     * \brief (Re)build the cached interface bindings from m_ipv4, and make
+     * room for their neighbors in the TSDB.
+     *
+     * The neighbor status units already learnt are kept.
+     */
+    void BuildInterfaceBindings();
+    /**
+     * \brief Build the table of the queue discs of the neighbors that the
+     * OracleNeighborState mode reads, by interface and interface of the
+     * neighbor.
+     *
+     * The neighbor of an interface is the other end of its channel, if it
+     * has exactly two devices; its interfaces that have no DDRQueueDisc, and
+     * the interfaces with no such neighbor, get none.
+     */
+    void BuildOracleQueues();
+    /**
+     * \brief Get the queue delay of a neighbor from its queue disc, in the
+     * OracleNeighborState mode.
+     * \param iface the interface of the neighbor
+     * \param nextIface the interface of the neighbor towards the destination
+     * \return the delay in us, 0 if the interface has no DDRQueueDisc
+     */
+    uint32_t GetOracleDelay(uint32_t iface, uint32_t nextIface) const;
+    /**
+     * \brief Whether a host route is a loop-free alternate (RFC 5286) to the
+     * routes of its destination.
+     *
+     * The route through the neighbor N towards D is one when
+     * dist (N, D) < dist (N, S) + dist (S, D), S being this router.  Its SPF
+     * tree leaves S out, so dist (N, D) is its distance less the metric of
+     * the link to N, and dist (N, S) is taken as that metric, the links being
+     * symmetric.  A route on an interface that is down is none.
+     *
+     * \param route the host route
+     * \param primary the distance of the shortest routes to the destination
+     * \return true if the route can replace the shortest ones
+     */
+    bool IsLoopFreeAlternate(const ShortestPathForestRIE* route, uint32_t primary);
+    /**
+     * \brief Get the cached bindings of an interface.
+     * \param iface the interface number
+     * \return the interface binding
+     */
+    const InterfaceBinding& GetInterfaceBinding(uint32_t iface);
+
+    /**
+     * \brief Get the next-hop group of a destination.
+     * \param dest the destination address (Ipv4Address::Get ())
+     * \return the group, or null if there is no route to the destination
+     */
+    NextHopGroup* LookupNextHopGroup(uint32_t dest) const;
+
+    RoutePool m_routePool;                         //!< the host route entries
+    HostRoutes m_hostRoutes;                       //!< Routes to hosts
+    HostRouteIndex m_hostRouteIndex;               //!< Next-hop groups by destination
+    mutable ShortestPathForestRIE m_hostRouteView; //!< the host route GetHostRoute () built
+    uint64_t m_hostRouteSequence;                  //!< rank of the next host route
+    KShortestPathTable m_kShortestPaths;           //!< k shortest paths by destination
+    std::vector<uint32_t> m_feasibleRoutes;        //!< scratch candidates of CollectDgrRoutes ()
+    SplitTable m_hostRouteSplits;                  //!< splits among the successors, by group
+    SplitTable m_kShortestSplits;                  //!< splits among the k shortest paths
+
+    InterfaceBindings m_bindings;        //!< cached per-interface handles
     RouteSelectMode_t m_routeSelectMode; //!< route select mode
     TSDB m_tsdb;                         //!< the Neighbor State DataBase (NSDB) of the DGR Rout
+    uint32_t m_stateLevels;              //!< queue occupancy levels of the neighbor states
+    bool m_compactStatusCounters;        //!< whether the TSDB counts on 16 bits
+    StatusEstimator m_statusEstimator;   //!< how the TSDB weighs the transitions
+    uint32_t m_statusEstimatorLength;    //!< half-life or window of m_statusEstimator
+    uint32_t m_predictionHorizon;        //!< updates ahead the DDR mode predicts the delay for
+    bool m_compactStatusUpdates;         //!< whether the neighbor states go in compact deltas
+    bool m_triggeredStatusUpdates;       //!< whether queue level changes trigger updates
+    bool m_oracleNeighborState;          //!< whether the neighbor queues are read directly
+    bool m_useControlChannel;            //!< whether the updates bypass the UDP sockets
+    uint32_t m_fullStatusRefresh;        //!< updates from one full compact refresh to the next
+    uint32_t m_updatesSinceRefresh;      //!< compact updates sent since the last full one
+    FlowCache m_decisionCache;           //!< DDR decisions by flow, budget bucket and limit
+    Time m_decisionCacheTimeout;         //!< age after which a cached decision is taken again
+    FlowCache m_outputRouteCache;        //!< shortest output routes by dest, oif and mode
+    Time m_decisionBudgetBucket;         //!< budgets of a flow that share a cached decision
+    uint32_t m_decisionGeneration;       //!< bumped when the routes or a local queue level change
+    bool m_dgrDecisionTables;            //!< whether the DGR lookups read decision tables
+    uint32_t m_tableGeneration;          //!< bumped when the routes or the bindings change
+    uint64_t m_stateStamp;               //!< bumped with any of m_stateEpochs
+    std::vector<uint32_t> m_stateEpochs; //!< delay state changes, by interface
+    std::vector<uint32_t> m_localLevels; //!< last local queue level, by interface
+    BudgetAdmission_t m_budgetAdmission; //!< what the source does with infeasible budgets
+    SplitPolicy_t m_splitPolicy;         //!< weights of the routes NONE and KSHORT split among
+    bool m_splitByFlow;                  //!< whether a flow keeps to one route of a split
+    uint32_t m_metricDelay;              //!< delay of a unit of link metric, in us
+    uint32_t m_downstreamDelays;         //!< downstream delays an update carries, 0 for none
+    std::vector<int32_t> m_sentStates;   //!< last state sent by interface, -1 for none
+    std::vector<DgrNse> m_receivedNses;  //!< NSEs of the last update received
+    std::vector<int> m_deltaStates;      //!< scratch states of a delta update received
+
+    uint32_t m_hotDestinations;        //!< destinations keeping their k paths, 0 for all
+    Time m_hotWindow;                  //!< period the KSHORT lookups are counted over
+    Time m_hotWindowEnd;               //!< end of the current window
+    std::vector<uint32_t> m_hotCounts; //!< KSHORT lookups in the window, by destination
+    uint32_t m_nFull;                  //!< destinations kept or restored full in the window
+
+    std::vector<uint32_t> m_downstreamEpochs;     //!< downstream updates received by interface
+    std::vector<DgrDownstream> m_sentDownstreams; //!< scratch downstream delays of an update
+
+    std::vector<Ptr<DDRQueueDisc>> m_oracleQueues; //!< neighbor queue discs, by interface
+    std::vector<uint32_t> m_oracleOffsets;         //!< first of m_oracleQueues of an interface
+
+    const AgentChannel* m_agentChannel; //!< the decisions of an external agent, or null
+    uint32_t m_agentNode;               //!< row of this router in m_agentChannel
+
+    std::string m_policyPath;                    //!< file of the PolicyTable, for POLICY
+    std::shared_ptr<const PolicyTable> m_policy; //!< the policy of POLICY, null until bound
+    uint32_t m_policyNode;                       //!< node ID of this router
+    std::vector<uint32_t> m_policyDests;         //!< node ID by AddressInterner index
+    uint64_t m_policyStamp;                      //!< m_stateStamp m_policyState is of
+    uint32_t m_policyState;                      //!< the packed states of this router
+    std::vector<uint32_t> m_policyNeighbors;     //!< scratch neighbor states, by interface
 
     // use a socket list neighbors
     /// One socket per interface, each bound to that interface's address
@@ -181,12 +921,31 @@ class DDRRouting : public RomamRouting
 
     SocketList
         m_unicastSocketList; //!< list of sockets for unicast messages (socket, interface index)
-    Ptr<Socket> m_multicastRecvSocket; //!< multicast receive socket
+    Ptr<Socket> m_multicastRecvSocket;           //!< multicast receive socket
+    std::vector<Ptr<Socket>> m_interfaceSockets; //!< first unicast socket by interface, or null
+    Ptr<ControlChannel> m_controlChannel;        //!< the channel of the updates, or null
+    std::vector<bool> m_controlInterfaces;       //!< whether the channel sends on an interface
+
+    Ptr<TimerWheel> m_timerWheel;                //!< the wheel of the updates, null if unused
+    TimerWheel::TimerId m_nextUnsolicitedUpdate; //!< Next Unsolicited Update timer, on the wheel
+    EventId m_nextUnsolicitedUpdateEvent;        //!< Next Unsolicited Update event, off the wheel
+    EventId m_nextTriggeredUpdate;               //!< Next Triggered Update event
 
-    EventId m_nextUnsolicitedUpdate; //!< Next Unsolicited Update event
-    EventId m_nextTriggeredUpdate;   //!< Next Triggered Update event
+    Time m_unsolicitedUpdate;             //!< Time between two Unsolicited Neighbor State Updates.
+    bool m_adaptiveSamplePeriod;          //!< whether the period follows the state changes
+    Time m_minSamplePeriod;               //!< shortest adaptive period
+    Time m_maxSamplePeriod;               //!< longest adaptive period
+    Time m_samplePeriod;                  //!< current adaptive period, zero before the first
+    std::vector<int32_t> m_sampledStates; //!< state by interface at the last periodic update
+    bool m_randomStartPhase;              //!< whether the first update is at a random time
+    double m_updateJitter;                //!< fraction of a period jittered off
+    bool m_updateTimerWheel;              //!< whether the updates run on the wheel
+    Ptr<UniformRandomVariable> m_jitter;  //!< the draws of the phase and the jitter
 
-    Time m_unsolicitedUpdate; //!< Time between two Unsolicited Neighbor State Updates.
+    static int64_t s_burstWindow; //!< index of the window of the last update counted
+    static uint32_t s_burstCount; //!< updates counted in that window
+    static uint32_t s_burstPeak;  //!< the most updates counted in a window
+    static Time s_burstPeakTime;  //!< the start of that window
 
     // Time m_startupDelay;            //!< Random delay before protocol startup
     // Time m_minTriggeredUpdateDelay; //!< Min cooldown delay after a Triggered Update.
@@ -194,7 +953,21 @@ class DDRRouting : public RomamRouting
     // Time m_unsolicitedUpdate;       //!< time between two Unsolicited Routing Updates.
     // Time m_timeoutDelay;            //!< Delay before invalidating a status
 
-    std::set<uint32_t> m_interfaceExclusions; //!< Set of excluded interfaces
+    std::vector<bool> m_interfaceExclusions; //!< whether an interface is excluded, by interface
+
+    /**
+     * \param interface the interface index
+     * \return true if the protocol leaves the interface out
+     */
+    bool IsExcludedInterface(uint32_t interface) const;
+
+    /**
+     * \brief Record a unicast socket of an interface, the one it sends on
+     * if it is the first.
+     * \param socket the socket
+     * \param interface the interface index
+     */
+    void AddInterfaceSocket(Ptr<Socket> socket, uint32_t interface);
 
     /**
      * Receive an DGR message
@@ -203,12 +976,46 @@ class DDRRouting : public RomamRouting
      */
     void Receive(Ptr<Socket> socket);
 
+    /**
+     * \brief Handle a message received by a socket or the control channel.
+     * \param packet the message
+     * \param senderAddress the address of the sender
+     * \param interface the interface the message came in on
+     * \param hopLimit the TTL of the message
+     */
+    void ReceiveControl(Ptr<Packet> packet,
+                        Ipv4Address senderAddress,
+                        uint32_t interface,
+                        uint8_t hopLimit);
+
+    /**
+     * \param interface the interface index
+     * \return true if the updates are sent on the interface
+     */
+    bool IsControlInterface(uint32_t interface) const;
+
+    /**
+     * \brief Send an update to the neighbors on an interface, by the
+     * control channel or the first socket of the interface.
+     * \param p the update
+     * \param interface the interface index
+     */
+    void SendControl(Ptr<Packet> p, uint32_t interface);
+
     /**
      * \brief Sending Neighbor Status Updates on all interfaces.
      * \param periodic true for periodic update, else triggered.
      */
     void DoSendNeighborStatusUpdate(bool periodic);
 
+    /**
+     * \brief Fill a compact update with the states of the interfaces, only
+     * those that changed since the last update unless a full refresh is due.
+     * \param hdr the header to fill
+     * \return false if the compact format is off or does not fit the node
+     */
+    bool BuildCompactStatusUpdate(DgrHeader& hdr);
+
     // /**
     //  * \brief Send Neighbor Status Request on all interfaces
     // */
@@ -216,14 +1023,56 @@ class DDRRouting : public RomamRouting
 
     /**
      * \brief Send Triggered Routing Updates on all interfaces.
+     *
+     * The update goes out from its own event, once however many times it is
+     * triggered before.
      */
     void SendTriggeredNeighborStatusUpdate();
 
+    /**
+     * \brief Handle a change of occupancy level of a local queue disc.
+     * \param state the new level
+     */
+    void NotifyQueueState(uint32_t state);
+
     /**
      * \brief Send Unsolicited neighbor status information Updates on all interfaces.
      */
     void SendUnsolicitedUpdate();
 
+    /**
+     * \brief Schedule the next unsolicited update, on the timer wheel if
+     * UpdateTimerWheel is set, in place of the pending one.
+     * \param delay the time until the update
+     */
+    void ScheduleUnsolicitedUpdate(Time delay);
+
+    /**
+     * \brief Take a random part of UpdateJitter off a period, as RFC 4271
+     * jitters its timers, so the updates of the nodes drift apart.
+     * \param period the period
+     * \return the jittered period
+     */
+    Time JitterPeriod(Time period);
+
+    /**
+     * \brief Count an unsolicited update in the control burst of its window.
+     */
+    static void CountControlBurst();
+
+    /**
+     * \brief Get the time to the next unsolicited update.
+     *
+     * It is SamplePeriod, unless AdaptiveSamplePeriod is set: the period is
+     * then halved when a local queue changed of state since the last
+     * periodic update, so the neighbors sample the volatile queues more
+     * often, and lengthened by a quarter when none did, within
+     * MinSamplePeriod and MaxSamplePeriod.
+     *
+     * \return the period
+     */
+    Time GetNextSamplePeriod();
+
     // /**
     //  * \brief Handle DGR requests.
     //  *
@@ -247,7 +1096,7 @@ class DDRRouting : public RomamRouting
      * \param incomingInterface incoming interface
      * \param hopLimit packet's hop limit
      */
-    void HandleResponses(DgrHeader hdr,
+    void HandleResponses(const DgrHeader& hdr,
                          Ipv4Address senderAddress,
                          uint32_t incomingInterface,
                          uint8_t hopLimit);
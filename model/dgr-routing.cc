@@ -21,7 +21,9 @@
 #include "ns3/timestamp-tag.h"
 #include "ns3/traffic-control-module.h"
 
+#include <algorithm>
 #include <iomanip>
+#include <iterator>
 #include <vector>
 
 namespace ns3
@@ -49,13 +51,21 @@ DGRRouting::GetTypeId()
                           "Interface notification events (up/down, or add/remove address)",
                           BooleanValue(false),
                           MakeBooleanAccessor(&DGRRouting::m_respondToInterfaceEvents),
+                          MakeBooleanChecker())
+            .AddAttribute("IncrementalUpdates",
+                          "Set to true to update only the SPF trees and forwarding tables "
+                          "an interface event changes, instead of recomputing all the routes",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&DGRRouting::m_incrementalUpdates),
                           MakeBooleanChecker());
     return tid;
 }
 
 DGRRouting::DGRRouting()
     : m_randomEcmpRouting(false),
-      m_respondToInterfaceEvents(false)
+      m_respondToInterfaceEvents(false),
+      m_incrementalUpdates(false),
+      m_metricDelay(std::max<int64_t>(1, RouteManager::GetMetricDelay().GetMicroSeconds()))
 {
     NS_LOG_FUNCTION(this);
     m_rand = CreateObject<UniformRandomVariable>();
@@ -67,133 +77,66 @@ DGRRouting::~DGRRouting()
 }
 
 Ptr<Ipv4Route>
-DGRRouting::RouteOutput(Ptr<Packet> p,
-                        const Ipv4Header& header,
-                        Ptr<NetDevice> oif,
-                        Socket::SocketErrno& sockerr)
+DGRRouting::SelectOutputRoute(Ptr<Packet> p, const Ipv4Header& header, Ptr<NetDevice> oif)
 {
-    NS_LOG_FUNCTION(this << p << &header << oif << &sockerr);
-    //
-    // First, see if this is a multicast packet we have a route for.  If we
-    // have a route, then send the packet down each of the specified interfaces.
-    //
-    if (header.GetDestination().IsMulticast())
-    {
-        NS_LOG_LOGIC("Multicast destination-- returning false");
-        return nullptr; // Let other routing protocols try to handle this
-    }
-    //
-    // See if this is a unicast packet we have a route for.
-    //
-    NS_LOG_LOGIC("Unicast destination- looking up");
     Ptr<Ipv4Route> rtentry;
-    BudgetTag budgetTag;
+    RomamMetaTag metaTag;
     if (!p)
     {
         rtentry = LookupShortestRoute(header.GetDestination(), oif);
     }
-    else if (p->PeekPacketTag(budgetTag))
+    else if (RomamMetaTag::Peek(p, metaTag) && metaTag.HasBudget())
     {
-        rtentry = LookupDGRRoute(header.GetDestination(), p, oif);
+        RomamMetaTag routed = metaTag;
+        rtentry = LookupDGRRoute(header.GetDestination(), routed, oif);
+        if (rtentry && !(routed == metaTag))
+        {
+            p->ReplacePacketTag(routed);
+        }
     }
     else
     {
         rtentry = LookupShortestRoute(header.GetDestination(), oif);
     }
-
-    if (rtentry)
-    {
-        sockerr = Socket::ERROR_NOTERROR;
-    }
-    else
-    {
-        sockerr = Socket::ERROR_NOROUTETOHOST;
-    }
     return rtentry;
 }
 
-bool
-DGRRouting::RouteInput(Ptr<const Packet> p,
-                       const Ipv4Header& header,
-                       Ptr<const NetDevice> idev,
-                       const UnicastForwardCallback& ucb,
-                       const MulticastForwardCallback& mcb,
-                       const LocalDeliverCallback& lcb,
-                       const ErrorCallback& ecb)
+Ptr<Ipv4Route>
+DGRRouting::SelectInputRoute(Ptr<const Packet>& p,
+                             const Ipv4Header& header,
+                             Ptr<const NetDevice> idev)
 {
-    NS_LOG_FUNCTION(this << p << header << header.GetSource() << header.GetDestination() << idev
-                         << &lcb << &ecb);
-    NS_ASSERT(m_ipv4->GetInterfaceForDevice(idev) >= 0);
-    Ptr<Packet> p_copy = p->Copy();
-
-    // Check if input device supports IP
-    uint32_t iif = m_ipv4->GetInterfaceForDevice(idev);
-
-    if (m_ipv4->IsDestinationAddress(header.GetDestination(), iif))
+    Ptr<Ipv4Route> rtentry;
+    RomamMetaTag metaTag;
+    if (RomamMetaTag::Peek(p, metaTag) && metaTag.HasBudget() && metaTag.GetBudget() != 0)
     {
-        if (!lcb.IsNull())
-        {
-            NS_LOG_LOGIC("Local delivery to " << header.GetDestination());
-            lcb(p, header, iif);
-            return true;
-        }
-        else
+        RomamMetaTag routed = metaTag;
+        rtentry = LookupDGRRoute(header.GetDestination(), routed, idev);
+        if (rtentry && !(routed == metaTag))
         {
-            // The local delivery callback is null.  This may be a multicast
-            // or broadcast packet, so return false so that another
-            // multicast routing protocol can handle it.  It should be possible
-            // to extend this to explicitly check whether it is a unicast
-            // packet, and invoke the error callback if so
-            return false;
+            // the one copy of the packet, to write its new metadata
+            Ptr<Packet> copy = p->Copy();
+            copy->ReplacePacketTag(routed);
+            p = copy;
         }
     }
-
-    // Check if input device supports IP forwarding
-    if (!m_ipv4->IsForwarding(iif))
-    {
-        NS_LOG_LOGIC("Forwarding disabled for this interface");
-        ecb(p, header, Socket::ERROR_NOROUTETOHOST);
-        return true;
-    }
-
-    // Next, try to find a route
-    NS_LOG_LOGIC("Unicast destination- looking up global route");
-    Ptr<Ipv4Route> rtentry;
-    BudgetTag budgetTag;
-    if (p->PeekPacketTag(budgetTag) && budgetTag.GetBudget() != 0)
-    {
-        rtentry = LookupDGRRoute(header.GetDestination(), p_copy, idev);
-    }
     else
     {
         rtentry = LookupShortestRoute(header.GetDestination());
     }
-
-    if (rtentry)
-    {
-        const Ptr<Packet> p_c = p_copy->Copy();
-        NS_LOG_LOGIC("Found unicast destination- calling unicast callback");
-        ucb(rtentry, p_c, header);
-        return true;
-    }
-    else
-    {
-        NS_LOG_LOGIC("Did not find unicast destination- returning false");
-        return false; // Let other routing protocols try to handle this
-                      // route request.
-    }
+    return rtentry;
 }
 
 void
 DGRRouting::NotifyInterfaceUp(uint32_t i)
 {
     NS_LOG_FUNCTION(this << i);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_LOGIC("update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeDijkstraRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -201,12 +144,12 @@ void
 DGRRouting::NotifyInterfaceDown(uint32_t i)
 {
     NS_LOG_FUNCTION(this << i);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_LOGIC("update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeDijkstraRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -214,12 +157,13 @@ void
 DGRRouting::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this << interface << address);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    InvalidateIpv4Routes();
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_LOGIC("update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeDijkstraRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -227,21 +171,27 @@ void
 DGRRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this << interface << address);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    InvalidateIpv4Routes();
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_LOGIC("update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeSPFRoutes();
+        uint32_t nodeId = m_ipv4->GetObject<Node>()->GetId();
+        RouteManager::ScheduleRecompute(nodeId,
+                                        m_incrementalUpdates ? &RouteManager::UpdateSPFRoutes
+                                                             : &RouteManager::RecomputeSPFRoutes);
     }
 }
 
 void
-DGRRouting::SetIpv4(Ptr<Ipv4> ipv4)
+DGRRouting::RecomputeRoutes()
 {
-    NS_LOG_FUNCTION(this << ipv4);
-    NS_ASSERT(!m_ipv4 && ipv4);
-    m_ipv4 = ipv4;
+    NS_LOG_FUNCTION(this);
+    uint32_t nodeId = m_ipv4->GetObject<Node>()->GetId();
+    RouteManager::ScheduleRecompute(nodeId,
+                                    m_incrementalUpdates ? &RouteManager::UpdateDijkstraRoutes
+                                                         : &RouteManager::RecomputeDijkstraRoutes);
 }
 
 void
@@ -318,177 +268,50 @@ DGRRouting::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit)
 }
 
 void
-DGRRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
-{
-    NS_LOG_FUNCTION(this << dest << nextHop << interface);
-    auto route = new ShortestPathForestRIE();
-    *route = ShortestPathForestRIE::CreateHostRouteTo(dest, nextHop, interface);
-    m_hostRoutes.push_back(route);
-}
-
-void
-DGRRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
+DGRRouting::AddHostRoute(const ShortestPathForestRIE& route)
 {
-    NS_LOG_FUNCTION(this << dest << interface);
-    auto route = new ShortestPathForestRIE();
-    *route = ShortestPathForestRIE::CreateHostRouteTo(dest, interface);
-    m_hostRoutes.push_back(route);
+    m_hostRoutes.push_back(new ShortestPathForestRIE(route));
 }
 
-void
-DGRRouting::AddHostRouteTo(Ipv4Address dest,
-                           Ipv4Address nextHop,
-                           uint32_t interface,
-                           uint32_t nextIface,
-                           uint32_t distance)
+uint32_t
+DGRRouting::GetNHostRoutes() const
 {
-    NS_LOG_FUNCTION(this << dest << interface << nextIface << distance);
-    auto route = new ShortestPathForestRIE();
-    *route =
-        ShortestPathForestRIE::CreateHostRouteTo(dest, nextHop, interface, nextIface, distance);
-    m_hostRoutes.push_back(route);
+    return m_hostRoutes.size();
 }
 
-void
-DGRRouting::AddNetworkRouteTo(Ipv4Address network,
-                              Ipv4Mask networkMask,
-                              Ipv4Address nextHop,
-                              uint32_t interface)
+ShortestPathForestRIE*
+DGRRouting::GetHostRoute(uint32_t index) const
 {
-    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
-    auto route = new ShortestPathForestRIE();
-    *route = ShortestPathForestRIE::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
-    m_networkRoutes.push_back(route);
+    HostRoutesCI i = m_hostRoutes.begin();
+    std::advance(i, index);
+    return *i;
 }
 
 void
-DGRRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface)
+DGRRouting::RemoveHostRoute(uint32_t index)
 {
-    NS_LOG_FUNCTION(this << network << networkMask << interface);
-    auto route = new ShortestPathForestRIE();
-    *route = ShortestPathForestRIE::CreateNetworkRouteTo(network, networkMask, interface);
-    m_networkRoutes.push_back(route);
+    NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
+    HostRoutesI i = m_hostRoutes.begin();
+    std::advance(i, index);
+    delete *i;
+    m_hostRoutes.erase(i);
+    NS_LOG_LOGIC("Done removing host route "
+                 << index << "; host route remaining size = " << m_hostRoutes.size());
 }
 
 void
-DGRRouting::AddASExternalRouteTo(Ipv4Address network,
-                                 Ipv4Mask networkMask,
-                                 Ipv4Address nextHop,
-                                 uint32_t interface)
-{
-    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
-    auto route = new ShortestPathForestRIE();
-    *route = ShortestPathForestRIE::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
-    m_ASexternalRoutes.push_back(route);
-}
-
-uint32_t
-DGRRouting::GetNRoutes() const
+DGRRouting::ClearHostRoutes()
 {
-    NS_LOG_FUNCTION(this);
-    uint32_t n = 0;
-    n += m_hostRoutes.size();
-    n += m_networkRoutes.size();
-    n += m_ASexternalRoutes.size();
-    return n;
-}
-
-ShortestPathForestRIE*
-DGRRouting::GetRoute(uint32_t index) const
-{
-    NS_LOG_FUNCTION(this << index);
-    if (index < m_hostRoutes.size())
-    {
-        uint32_t tmp = 0;
-        for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
-        {
-            if (tmp == index)
-            {
-                return *i;
-            }
-            tmp++;
-        }
-    }
-    index -= m_hostRoutes.size();
-    uint32_t tmp = 0;
-    if (index < m_networkRoutes.size())
-    {
-        for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
-        {
-            if (tmp == index)
-            {
-                return *j;
-            }
-            tmp++;
-        }
-    }
-    index -= m_networkRoutes.size();
-    tmp = 0;
-    for (auto k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i = m_hostRoutes.erase(i))
     {
-        if (tmp == index)
-        {
-            return *k;
-        }
-        tmp++;
+        delete (*i);
     }
-    NS_ASSERT(false);
-    // quiet compiler.
-    return nullptr;
 }
 
-void
-DGRRouting::RemoveRoute(uint32_t index)
+std::size_t
+DGRRouting::GetMemoryFootprint() const
 {
-    NS_LOG_FUNCTION(this << index);
-    if (index < m_hostRoutes.size())
-    {
-        uint32_t tmp = 0;
-        for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
-        {
-            if (tmp == index)
-            {
-                NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
-                delete *i;
-                m_hostRoutes.erase(i);
-                NS_LOG_LOGIC("Done removing host route "
-                             << index << "; host route remaining size = " << m_hostRoutes.size());
-                return;
-            }
-            tmp++;
-        }
-    }
-    index -= m_hostRoutes.size();
-    uint32_t tmp = 0;
-    for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
-    {
-        if (tmp == index)
-        {
-            NS_LOG_LOGIC("Removing route " << index << "; size = " << m_networkRoutes.size());
-            delete *j;
-            m_networkRoutes.erase(j);
-            NS_LOG_LOGIC("Done removing network route "
-                         << index << "; network route remaining size = " << m_networkRoutes.size());
-            return;
-        }
-        tmp++;
-    }
-    index -= m_networkRoutes.size();
-    tmp = 0;
-    for (auto k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
-    {
-        if (tmp == index)
-        {
-            NS_LOG_LOGIC("Removing route " << index << "; size = " << m_ASexternalRoutes.size());
-            delete *k;
-            m_ASexternalRoutes.erase(k);
-            NS_LOG_LOGIC("Done removing network route "
-                         << index << "; network route remaining size = " << m_networkRoutes.size());
-            return;
-        }
-        tmp++;
-    }
-    NS_ASSERT(false);
+    return GetRouteListFootprint(m_hostRoutes) + GetPrefixRouteFootprint();
 }
 
 int64_t
@@ -502,51 +325,43 @@ DGRRouting::AssignStreams(int64_t stream)
 Ptr<Ipv4Route>
 DGRRouting::LookupShortestRoute(Ipv4Address dest, Ptr<NetDevice> oif)
 {
-    NS_LOG_FUNCTION(this << dest << oif);
-    NS_LOG_LOGIC("Looking for route for destination " << dest);
+    ROMAM_HOT_LOG_FUNCTION(this << dest << oif);
+    ROMAM_HOT_LOG_LOGIC("Looking for route for destination " << dest);
     Ptr<Ipv4Route> rtentry = 0;
-    // store all available routes that bring packets to their destination
-    typedef std::vector<ShortestPathForestRIE*> RouteVec_t;
-    RouteVec_t allRoutes;
+    // the shortest route, taken in one pass over the candidates
+    ShortestPathForestRIE* best = nullptr;
+    uint32_t outputIface = GetCachedInterfaceIndex(m_ipv4, oif);
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
+    ROMAM_HOT_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
     for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
     {
         NS_ASSERT((*i)->IsHost());
         if ((*i)->GetDest() == dest)
         {
-            if (oif != nullptr)
+            CountLookup(RoutingStats::CANDIDATES_SCANNED);
+            if (oif != nullptr && (*i)->GetInterface() != outputIface)
             {
-                if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
+                ROMAM_HOT_LOG_LOGIC("Not on requested interface, skipping");
+                continue;
             }
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found DGR host route" << *i);
-        }
-    }
-    if (allRoutes.size() > 0) // if route(s) is found
-    {
-        uint32_t routRef = 0;
-        uint32_t shortestDist = allRoutes.at(0)->GetDistance();
-        for (uint32_t i = 0; i < allRoutes.size(); i++)
-        {
-            if (allRoutes.at(i)->GetDistance() < shortestDist)
+            ROMAM_HOT_LOG_LOGIC("Found DGR host route " << *i);
+            if (!best || (*i)->GetDistance() < best->GetDistance())
             {
-                routRef = i;
+                best = *i;
             }
         }
-        ShortestPathForestRIE* route = allRoutes.at(routRef);
-
+    }
+    if (!best) // no host route, fall back to the matching prefixes
+    {
+        auto onRequestedInterface = [oif, outputIface](ShortestPathForestRIE* route) {
+            return !oif || route->GetInterface() == outputIface;
+        };
+        best = LookupShortestPrefixRoute(dest, onRequestedInterface);
+    }
+    if (best) // if route(s) is found
+    {
         // create a Ipv4Route object from the selected routing table entry
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        rtentry->SetSource(m_ipv4->GetAddress(route->GetInterface(), 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        uint32_t interfaceIdx = route->GetInterface();
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+        rtentry = GetIpv4Route(best, m_ipv4);
         return rtentry;
     }
     else
@@ -556,164 +371,146 @@ DGRRouting::LookupShortestRoute(Ipv4Address dest, Ptr<NetDevice> oif)
 }
 
 Ptr<Ipv4Route>
-DGRRouting::LookupDGRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
+DGRRouting::LookupDGRRoute(Ipv4Address dest, RomamMetaTag& metaTag, Ptr<const NetDevice> idev)
 {
-    PriorityTag prioTag;
-    BudgetTag bgtTag;
-    TimestampTag timeTag;
-    p->PeekPacketTag(prioTag);
-    p->PeekPacketTag(bgtTag);
-    p->PeekPacketTag(timeTag);
-    DistTag distTag;
     uint32_t dist = UINT32_MAX;
     dist -= 1;
-    if (p->PeekPacketTag(distTag))
-        dist = distTag.GetDistance();
+    if (metaTag.HasDistance())
+        dist = metaTag.GetDistance();
     // budget in microseconds
     uint32_t bgt;
-    if (bgtTag.GetBudget() + timeTag.GetTimestamp().GetMicroSeconds() <
+    if (metaTag.GetBudget() + metaTag.GetTimestamp().GetMicroSeconds() <
         Simulator::Now().GetMicroSeconds())
     {
         bgt = 0;
     }
     else
-        bgt = (bgtTag.GetBudget() + timeTag.GetTimestamp().GetMicroSeconds() -
-               Simulator::Now().GetMicroSeconds()) /
-              100;
+        bgt = metaTag.GetBudget() + metaTag.GetTimestamp().GetMicroSeconds() -
+              Simulator::Now().GetMicroSeconds();
     /**
      * Lookup a Route to forward the DGR packets.
      */
-    NS_LOG_FUNCTION(this << dest << idev);
-    NS_LOG_LOGIC("Looking for route for destination " << dest);
+    ROMAM_HOT_LOG_FUNCTION(this << dest << idev);
+    ROMAM_HOT_LOG_LOGIC("Looking for route for destination " << dest);
     Ptr<Ipv4Route> rtentry = 0;
-    // store all available routes that bring packets to their destination
-    typedef std::vector<ShortestPathForestRIE*> RouteVec_t;
-    RouteVec_t allRoutes;
-
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
+    ROMAM_HOT_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
+    uint32_t considered = 0;
+    // the shortest route, taken in one pass over the candidates
+    ShortestPathForestRIE* best = nullptr;
+    uint32_t inputIface = GetCachedInterfaceIndex(m_ipv4, idev);
     for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
     {
         NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        if ((*i)->GetDest() != dest)
         {
-            if (idev != nullptr)
-            {
-                if (idev == m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
-            }
+            continue;
+        }
+        CountLookup(RoutingStats::CANDIDATES_SCANNED);
+        considered++;
+        if ((*i)->GetInterface() == inputIface)
+        {
+            ROMAM_HOT_LOG_LOGIC("Not on requested interface, skipping");
+            CountLookup(RoutingStats::LOOP_REJECTS);
+            continue;
+        }
 
-            // if interface is down, continue
-            if (!m_ipv4->IsUp((*i)->GetInterface()))
-                continue;
+        // if interface is down, continue
+        const CachedInterface& iface = GetCachedInterface(m_ipv4, (*i)->GetInterface());
+        if (!iface.up)
+            continue;
 
-            // get the local queue delay in microseconds
-            Ptr<NetDevice> dev_loc = m_ipv4->GetNetDevice((*i)->GetInterface());
-            Ptr<QueueDisc> disc = m_ipv4->GetObject<Node>()
-                                      ->GetObject<TrafficControlLayer>()
-                                      ->GetRootQueueDiscOnDevice(dev_loc);
-            Ptr<DGRQueueDisc> dgr_q = DynamicCast<DGRQueueDisc>(disc);
-
-            // Get the Slow lane length
-            uint32_t queue_len = dgr_q->GetInternalQueue(1)->GetCurrentSize().GetValue();
-            uint32_t queue_max = dgr_q->GetInternalQueue(1)->GetMaxSize().GetValue();
-            if (queue_len >= queue_max * 0.75)
-            {
-                NS_LOG_LOGIC("Congestion happened, skipping");
-                continue;
-            }
+        // get the local queue delay in microseconds
+        Ptr<NetDevice> dev_loc = iface.device;
+        Ptr<QueueDisc> disc = m_ipv4->GetObject<Node>()
+                                  ->GetObject<TrafficControlLayer>()
+                                  ->GetRootQueueDiscOnDevice(dev_loc);
+        Ptr<DGRQueueDisc> dgr_q = DynamicCast<DGRQueueDisc>(disc);
 
-            // get the next hop slow queue infomation
-            if ((*i)->GetNextIface() != 0xffffffff)
+        // Get the Slow lane congestion
+        if (dgr_q->IsCongested(1))
+        {
+            ROMAM_HOT_LOG_LOGIC("Congestion happened, skipping");
+            continue;
+        }
+
+        // get the next hop slow queue infomation
+        if ((*i)->GetNextIface() != 0xffffffff)
+        {
+            Ptr<Channel> channel = dev_loc->GetChannel();
+            PointToPointChannel* p2pchannel =
+                dynamic_cast<PointToPointChannel*>(PeekPointer(channel));
+            if (p2pchannel != 0)
             {
-                Ptr<Channel> channel = dev_loc->GetChannel();
-                PointToPointChannel* p2pchannel =
-                    dynamic_cast<PointToPointChannel*>(PeekPointer(channel));
-                if (p2pchannel != 0)
+                // Get the remote netdevice
+                Ptr<NetDevice> dev_rmt = p2pchannel->GetDevice(0);
+                if (dev_rmt == dev_loc)
+                {
+                    dev_rmt = p2pchannel->GetDevice(1);
+                }
+                Ptr<Node> node_rmt = dev_rmt->GetNode();
+                Ptr<QueueDisc> disc_rmt =
+                    node_rmt->GetObject<TrafficControlLayer>()->GetRootQueueDiscOnDevice(dev_rmt);
+                Ptr<DGRQueueDisc> dgr_q_rmt = DynamicCast<DGRQueueDisc>(disc_rmt);
+                if (dgr_q_rmt->IsCongested(1) || dgr_q_rmt->IsCongested(2))
                 {
-                    // Get the remote netdevice
-                    Ptr<NetDevice> dev_rmt = p2pchannel->GetDevice(0);
-                    if (dev_rmt == dev_loc)
-                    {
-                        dev_rmt = p2pchannel->GetDevice(1);
-                    }
-                    Ptr<Node> node_rmt = dev_rmt->GetNode();
-                    Ptr<QueueDisc> disc_rmt =
-                        node_rmt->GetObject<TrafficControlLayer>()->GetRootQueueDiscOnDevice(
-                            dev_rmt);
-                    Ptr<DGRQueueDisc> dgr_q_rmt = DynamicCast<DGRQueueDisc>(disc_rmt);
-                    uint32_t remot_queue_len =
-                        dgr_q_rmt->GetInternalQueue(1)->GetCurrentSize().GetValue();
-                    uint32_t remot_queue_max =
-                        dgr_q_rmt->GetInternalQueue(1)->GetMaxSize().GetValue();
-                    uint32_t remot_slow_len =
-                        dgr_q_rmt->GetInternalQueue(2)->GetCurrentSize().GetValue();
-                    uint32_t remot_slow_max =
-                        dgr_q_rmt->GetInternalQueue(2)->GetMaxSize().GetValue();
-                    if (remot_queue_len >= remot_queue_max * 0.75 ||
-                        remot_slow_len >= remot_slow_max * 0.75)
-                    {
-                        NS_LOG_LOGIC("Congestion over 75\% in next hop, skipping");
-                        continue;
-                    }
+                    ROMAM_HOT_LOG_LOGIC("Congestion over 75\% in next hop, skipping");
+                    continue;
                 }
             }
         }
-        if ((*i)->GetDistance() > bgt || (*i)->GetDistance() > dist)
+        if ((*i)->GetDistance() > dist)
         {
-            NS_LOG_LOGIC("Too far to the destination, skipping");
+            ROMAM_HOT_LOG_LOGIC("Farther than the previous hop, skipping");
+            CountLookup(RoutingStats::LOOP_REJECTS);
             continue;
         }
-        allRoutes.push_back(*i);
-        NS_LOG_LOGIC(allRoutes.size()
-                     << "Found DGR host route" << *i << " with Cost: " << (*i)->GetDistance());
-    }
-
-    if (allRoutes.size() > 0) // if route(s) is found
-    {
-        // random select
-        // uint32_t selectIndex = m_rand->GetInteger(0, allRoutes.size() - 1);
-
-        uint32_t selectIndex = 0;
-        uint32_t shortestDist = allRoutes.at(0)->GetDistance();
-        for (uint32_t i = 0; i < allRoutes.size(); i++)
+        if (static_cast<uint64_t>((*i)->GetDistance()) * m_metricDelay > bgt)
         {
-            if (allRoutes.at(i)->GetDistance() < shortestDist)
-            {
-                selectIndex = i;
-                shortestDist = allRoutes.at(i)->GetDistance();
-            }
+            ROMAM_HOT_LOG_LOGIC("Too far to the destination, skipping");
+            CountLookup(RoutingStats::BUDGET_REJECTS);
+            continue;
         }
+        ROMAM_HOT_LOG_LOGIC("Found DGR host route " << *i << " with Cost: " << (*i)->GetDistance());
+        if (!best || (*i)->GetDistance() < best->GetDistance())
+        {
+            best = *i;
+        }
+    }
 
-        ShortestPathForestRIE* route = allRoutes.at(selectIndex);
-        uint32_t interfaceIdx = route->GetInterface();
-
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(route->GetInterface(), 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+    if (best) // if route(s) is found
+    {
+        ShortestPathForestRIE* route = best;
+        rtentry = GetIpv4Route(route, m_ipv4);
+        TraceDecision(dest,
+                      route->GetInterface(),
+                      considered,
+                      bgt,
+                      DecisionTrace::NO_VALUE,
+                      route->GetDistance(),
+                      DecisionTrace::FEASIBLE);
 
-        if (bgt - route->GetDistance() <= 20)
+        // the slack of the budget over the propagation delay, in us
+        if (bgt - static_cast<uint64_t>(route->GetDistance()) * m_metricDelay <= 2000)
         {
-            prioTag.SetPriority(0);
+            metaTag.SetPriority(0);
         }
         else
         {
-            prioTag.SetPriority(1);
+            metaTag.SetPriority(1);
         }
 
-        distTag.SetDistance(route->GetDistance());
-        p->ReplacePacketTag(prioTag);
-
-        p->ReplacePacketTag(distTag);
+        metaTag.SetDistance(route->GetDistance());
         return rtentry;
     }
     else
     {
+        TraceDecision(dest,
+                      -1,
+                      considered,
+                      bgt,
+                      DecisionTrace::NO_VALUE,
+                      DecisionTrace::NO_VALUE,
+                      DecisionTrace::EXHAUSTED);
         return 0;
     }
 }
@@ -722,6 +519,10 @@ void
 DGRRouting::DoInitialize(void)
 {
     NS_LOG_FUNCTION(this);
+    if (m_ipv4)
+    {
+        StartDecisionTrace(m_ipv4->GetObject<Node>()->GetId());
+    }
     Ipv4RoutingProtocol::DoInitialize();
 }
 
@@ -729,21 +530,21 @@ void
 DGRRouting::DoDispose()
 {
     NS_LOG_FUNCTION(this);
-    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i = m_hostRoutes.erase(i))
-    {
-        delete (*i);
-    }
-    for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j = m_networkRoutes.erase(j))
-    {
-        delete (*j);
-    }
-    for (auto l = m_ASexternalRoutes.begin(); l != m_ASexternalRoutes.end();
-         l = m_ASexternalRoutes.erase(l))
-    {
-        delete (*l);
-    }
+    ClearRoutes();
+    InvalidateInterfaceCache();
+    StopDecisionTrace();
 
     Ipv4RoutingProtocol::DoDispose();
 }
 
 } // namespace ns3
+
+// the members of the core, logged under the component of the protocol
+#include "romam-routing-core-impl.h"
+
+namespace ns3
+{
+
+template class RomamRoutingCore<DGRRouting, ShortestPathForestRIE>;
+
+} // namespace ns3
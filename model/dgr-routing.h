@@ -3,7 +3,8 @@
 #ifndef DGR_ROUTING_H
 #define DGR_ROUTING_H
 
-#include "romam-routing.h"
+#include "romam-routing-core.h"
+#include "routing_algorithm/spf-route-info-entry.h"
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -22,10 +23,10 @@ class NetDevice;
 class Ipv4Interface;
 class Ipv4Address;
 class Ipv4Header;
-class ShortestPathForestRIE;
+class RomamMetaTag;
 class Node;
 
-class DGRRouting : public RomamRouting
+class DGRRouting : public RomamRoutingCore<DGRRouting, ShortestPathForestRIE>
 {
   public:
     /**
@@ -45,22 +46,10 @@ class DGRRouting : public RomamRouting
     ~DGRRouting() override;
 
     // These methods inherited from Ipv4RoutingProtocol class
-    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
-                               const Ipv4Header& header,
-                               Ptr<NetDevice> oif,
-                               Socket::SocketErrno& sockerr) override;
-    bool RouteInput(Ptr<const Packet> p,
-                    const Ipv4Header& header,
-                    Ptr<const NetDevice> idev,
-                    const UnicastForwardCallback& ucb,
-                    const MulticastForwardCallback& mcb,
-                    const LocalDeliverCallback& lcb,
-                    const ErrorCallback& ecb) override;
     void NotifyInterfaceUp(uint32_t interface) override;
     void NotifyInterfaceDown(uint32_t interface) override;
     void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
     void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
-    void SetIpv4(Ptr<Ipv4> ipv4) override;
     void PrintRoutingTable(Ptr<OutputStreamWrapper> stream,
                            Time::Unit unit = Time::S) const override;
 
@@ -68,24 +57,7 @@ class DGRRouting : public RomamRouting
     void DoInitialize(void) override;
 
     // These methods inherited from RomamRouting class
-    void AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface) override;
-    void AddHostRouteTo(Ipv4Address dest, uint32_t interface) override;
-    void AddHostRouteTo(Ipv4Address dest,
-                        Ipv4Address nextHop,
-                        uint32_t interface,
-                        uint32_t nextIface,
-                        uint32_t distance) override;
-    void AddNetworkRouteTo(Ipv4Address network,
-                           Ipv4Mask networkMask,
-                           Ipv4Address nextHop,
-                           uint32_t interface) override;
-    void AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface) override;
-    void AddASExternalRouteTo(Ipv4Address network,
-                              Ipv4Mask networkMask,
-                              Ipv4Address nextHop,
-                              uint32_t interface) override;
-    uint32_t GetNRoutes(void) const override;
-    void RemoveRoute(uint32_t i) override;
+    std::size_t GetMemoryFootprint() const override;
 
     /**
      * Assign a fixed random variable stream number to the random variables
@@ -97,19 +69,28 @@ class DGRRouting : public RomamRouting
      */
     int64_t AssignStreams(int64_t stream);
 
-    ShortestPathForestRIE* GetRoute(uint32_t i) const;
-
   protected:
     // These methods inherited from Objective class
     void DoDispose(void) override;
 
   private:
+    friend class RomamRoutingCore<DGRRouting, ShortestPathForestRIE>;
+
+    /**
+     * \brief Have the RouteManager recompute the routes of the network after
+     * an interface event, incrementally if the IncrementalUpdates attribute is
+     * set.  The events of a burst are coalesced into one recompute.
+     */
+    void RecomputeRoutes();
+
     /// Set to true if packets are randomly routed among ECMP; set to false for using only one route
     /// consistently
     bool m_randomEcmpRouting;
     /// Set to true if this interface should respond to interface events by globallly recomputing
     /// routes
     bool m_respondToInterfaceEvents;
+    /// Set to true to update only the routes an interface event changes
+    bool m_incrementalUpdates;
     /// A uniform random number generator for randomly routing packets among ECMP
     Ptr<UniformRandomVariable> m_rand;
 
@@ -120,19 +101,18 @@ class DGRRouting : public RomamRouting
     /// iterator of container of Ipv4RoutingTableEntry (routes to hosts)
     typedef std::list<ShortestPathForestRIE*>::iterator HostRoutesI;
 
-    /// container of Ipv4RoutingTableEntry (routes to networks)
-    typedef std::list<ShortestPathForestRIE*> NetworkRoutes;
-    /// const iterator of container of Ipv4RoutingTableEntry (routes to networks)
-    typedef std::list<ShortestPathForestRIE*>::const_iterator NetworkRoutesCI;
-    /// iterator of container of Ipv4RoutingTableEntry (routes to networks)
-    typedef std::list<ShortestPathForestRIE*>::iterator NetworkRoutesI;
-
-    /// container of Ipv4RoutingTableEntry (routes to external AS)
-    typedef std::list<ShortestPathForestRIE*> ASExternalRoutes;
-    /// const iterator of container of Ipv4RoutingTableEntry (routes to external AS)
-    typedef std::list<ShortestPathForestRIE*>::const_iterator ASExternalRoutesCI;
-    /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
-    typedef std::list<ShortestPathForestRIE*>::iterator ASExternalRoutesI;
+    // These methods called by RomamRoutingCore
+    Ptr<Ipv4Route> SelectOutputRoute(Ptr<Packet> p,
+                                     const Ipv4Header& header,
+                                     Ptr<NetDevice> oif);
+    Ptr<Ipv4Route> SelectInputRoute(Ptr<const Packet>& p,
+                                    const Ipv4Header& header,
+                                    Ptr<const NetDevice> idev);
+    void AddHostRoute(const ShortestPathForestRIE& route);
+    uint32_t GetNHostRoutes() const;
+    ShortestPathForestRIE* GetHostRoute(uint32_t i) const;
+    void RemoveHostRoute(uint32_t i);
+    void ClearHostRoutes();
 
     /**
      * \brief Lookup in the route infomation base (RIB) for destination.
@@ -142,12 +122,22 @@ class DGRRouting : public RomamRouting
      */
     // Ptr<Ipv4Route> LookupRoute(Ipv4Address dest, Ptr<NetDevice> oif = 0) const;
     Ptr<Ipv4Route> LookupShortestRoute(Ipv4Address dest, Ptr<NetDevice> oif = 0);
-    Ptr<Ipv4Route> LookupDGRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev = 0);
 
-    HostRoutes m_hostRoutes;             //!< Routes to hosts
-    NetworkRoutes m_networkRoutes;       //!< Routes to networks
-    ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
-    Ptr<Ipv4> m_ipv4;                    //!< associated IPv4 instance
+    /**
+     * \brief Lookup a route for a delay guaranteed packet, leaving the
+     * packet alone.
+     * \param dest destination address
+     * \param metaTag the metadata of the packet, whose distance and priority
+     * are set for the route found
+     * \param idev the input device, which the route must not go back through
+     * \return Ipv4Route to route the packet to reach dest address
+     */
+    Ptr<Ipv4Route> LookupDGRRoute(Ipv4Address dest,
+                                  RomamMetaTag& metaTag,
+                                  Ptr<const NetDevice> idev = 0);
+
+    HostRoutes m_hostRoutes; //!< Routes to hosts
+    uint32_t m_metricDelay;  //!< delay of a unit of link metric, in us
 };
 
 } // namespace ns3
@@ -5,10 +5,16 @@
 #include "datapath/octopus-headers.h"
 #include "datapath/romam-tags.h"
 #include "priority_manage/ddr-queue-disc.h"
+#include "routing_algorithm/arm-set.h"
 #include "routing_algorithm/armed-spf-rie.h"
+#include "utility/event-accounting.h"
+#include "utility/memory-footprint.h"
 #include "utility/route-manager.h"
 
 #include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
 #include "ns3/fifo-queue-disc.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/ipv4-packet-info-tag.h"
@@ -26,14 +32,19 @@
 #include "ns3/traffic-control-module.h"
 #include "ns3/udp-header.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
 
+#include <algorithm>
 #include <iomanip>
+#include <iterator>
 #include <random>
 #include <string>
 #include <vector>
 
 #define OCTOPUS_PORT 666
 #define OCTOPUS_BROAD_CAST "224.0.0.17"
+#define OCTOPUS_CONTROL_PROTOCOL 254 // RFC 3692 experimental, for the ControlChannel
+#define OCTOPUS_MAX_BATCH 100 // rewards per ACK_BATCH message, keeps it below the MTU
 
 namespace ns3
 {
@@ -45,15 +56,97 @@ NS_OBJECT_ENSURE_REGISTERED(OctopusRouting);
 TypeId
 OctopusRouting::GetTypeId(void)
 {
-    static TypeId tid = TypeId("ns3::OctopusRouting")
-                            .SetParent<RomamRouting>()
-                            .SetGroupName("romam")
-                            .AddConstructor<OctopusRouting>();
+    static TypeId tid =
+        TypeId("ns3::OctopusRouting")
+            .SetParent<RomamRouting>()
+            .SetGroupName("romam")
+            .AddConstructor<OctopusRouting>()
+            .AddAttribute("RewardFeedback",
+                          "How rewards are fed back to the upstream neighbor: one ACK per "
+                          "packet, ACKs coalesced over RewardWindow, or rewards piggybacked on "
+                          "reverse data packets (the remaining ones coalesced as well)",
+                          EnumValue(PER_PACKET_ACK),
+                          MakeEnumAccessor(&OctopusRouting::m_rewardFeedback),
+                          MakeEnumChecker(PER_PACKET_ACK,
+                                          "PerPacket",
+                                          AGGREGATED_ACK,
+                                          "Aggregated",
+                                          PIGGYBACKED_ACK,
+                                          "Piggybacked"))
+            .AddAttribute("RewardWindow",
+                          "Time rewards towards the same (destination, interface) are coalesced "
+                          "before being sent in one ACK",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&OctopusRouting::m_rewardWindow),
+                          MakeTimeChecker())
+            .AddAttribute("RewardDelay",
+                          "How the queueing delay a reward carries is estimated: the bytes "
+                          "queued at 100 bytes per ms, or the bytes queued over the dequeue "
+                          "rate the queue disc measures (the rate of the device until then)",
+                          EnumValue(DRAIN_RATE_DELAY),
+                          MakeEnumAccessor(&OctopusRouting::m_rewardDelay),
+                          MakeEnumChecker(BYTE_COUNT_DELAY,
+                                          "ByteCount",
+                                          DRAIN_RATE_DELAY,
+                                          "DrainRate"))
+            .AddAttribute("NormalizeRewards",
+                          "Set to true to take the queueing delay of a link over the one of its "
+                          "full queue disc, so the rewards are in [0, 1] on links of any rate "
+                          "and size",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&OctopusRouting::m_normalizeRewards),
+                          MakeBooleanChecker())
+            .AddAttribute("PruneArms",
+                          "Set to true to suspend the arms towards a destination whose mean loss "
+                          "exceeds the one of the best arm by PruneMargin, beyond the confidence "
+                          "radii, and retry them at exponentially spaced times",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&OctopusRouting::m_pruneArms),
+                          MakeBooleanChecker())
+            .AddAttribute("PruneMargin",
+                          "How much higher than the mean loss of the best arm the one of an arm "
+                          "must be, relatively, for PruneArms to suspend it",
+                          DoubleValue(0.5),
+                          MakeDoubleAccessor(&OctopusRouting::m_pruneMargin),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("PruneMinPulls",
+                          "Pulls an arm and the best arm need before PruneArms suspends the arm",
+                          UintegerValue(100),
+                          MakeUintegerAccessor(&OctopusRouting::m_pruneMinPulls),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("PruneRetry",
+                          "Lookups towards a destination after which an arm suspended once is "
+                          "retried, doubled at every further suspension of the arm",
+                          UintegerValue(1000),
+                          MakeUintegerAccessor(&OctopusRouting::m_pruneRetry),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("IncrementalUpdates",
+                          "Set to true to update only the SPF trees and forwarding tables "
+                          "an interface event changes, instead of recomputing all the routes",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&OctopusRouting::m_incrementalUpdates),
+                          MakeBooleanChecker())
+            .AddAttribute("UseControlChannel",
+                          "Set to true to exchange the ACKs through a ControlChannel, IP "
+                          "protocol 254 delivered straight to the router, instead of a UDP "
+                          "socket per interface address",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&OctopusRouting::m_useControlChannel),
+                          MakeBooleanChecker());
     return tid;
 }
 
 OctopusRouting::OctopusRouting()
     : m_armDatabase(),
+      m_rewardDelay(DRAIN_RATE_DELAY),
+      m_normalizeRewards(false),
+      m_pruneArms(false),
+      m_pruneMargin(0.5),
+      m_pruneMinPulls(100),
+      m_pruneRetry(1000),
+      m_rewardFeedback(PER_PACKET_ACK),
+      m_incrementalUpdates(false),
+      m_useControlChannel(false),
       m_initialized(false)
 {
     NS_LOG_FUNCTION(this);
@@ -66,107 +159,60 @@ OctopusRouting::~OctopusRouting()
 }
 
 Ptr<Ipv4Route>
-OctopusRouting::RouteOutput(Ptr<Packet> p,
-                            const Ipv4Header& header,
-                            Ptr<NetDevice> oif,
-                            Socket::SocketErrno& sockerr)
+OctopusRouting::SelectOutputRoute(Ptr<Packet> p, const Ipv4Header& header, Ptr<NetDevice> oif)
 {
-    NS_LOG_FUNCTION(this << p << &header << oif << &sockerr);
-    //
-    // First, see if this is a multicast packet we have a route for.  If we
-    // have a route, then send the packet down each of the specified interfaces.
-    //
-    if (header.GetDestination().IsMulticast())
-    {
-        NS_LOG_LOGIC("Multicast destination-- returning false");
-        return 0; // Let other routing protocols try to handle this
-    }
+    return LookupRoute(header.GetDestination());
+}
 
-    //
-    // See if this is a unicast packet we have a route for.
-    //
-    NS_LOG_LOGIC("Looking up route");
-    Ptr<Ipv4Route> rtentry = LookupRoute(header.GetDestination());
-    if (rtentry)
-    {
-        sockerr = Socket::ERROR_NOTERROR;
-    }
-    else
-    {
-        sockerr = Socket::ERROR_NOROUTETOHOST;
-    }
-    return rtentry;
+Ptr<Ipv4Route>
+OctopusRouting::SelectInputRoute(Ptr<const Packet>& p,
+                                 const Ipv4Header& header,
+                                 Ptr<const NetDevice> idev)
+{
+    return LookupRoute(header.GetDestination());
 }
 
-bool
-OctopusRouting::RouteInput(Ptr<const Packet> p,
-                           const Ipv4Header& header,
-                           Ptr<const NetDevice> idev,
-                           const UnicastForwardCallback& ucb,
-                           const MulticastForwardCallback& mcb,
-                           const LocalDeliverCallback& lcb,
-                           const ErrorCallback& ecb)
-{
-    NS_LOG_FUNCTION(this << p << header << header.GetSource() << header.GetDestination() << idev
-                         << &lcb << &ecb);
-    // Check if input device supports IP
-    NS_ASSERT(m_ipv4->GetInterfaceForDevice(idev) >= 0);
-    uint32_t iif = m_ipv4->GetInterfaceForDevice(idev);
-
-    if (m_ipv4->IsDestinationAddress(header.GetDestination(), iif))
-    {
-        if (!lcb.IsNull())
-        {
-            NS_LOG_LOGIC("Local delivery to " << header.GetDestination());
-            lcb(p, header, iif);
-            return true;
-        }
-        else
-        {
-            // The local delivery callback is null.  This may be a multicast
-            // or broadcast packet, so return false so that another
-            // multicast routing protocol can handle it.  It should be possible
-            // to extend this to explicitly check whether it is a unicast
-            // packet, and invoke the error callback if so
-            return false;
-        }
-    }
-    // Check if input device supports IP forwarding
-    if (m_ipv4->IsForwarding(iif) == false)
-    {
-        NS_LOG_LOGIC("Forwarding disabled for this interface");
-        ecb(p, header, Socket::ERROR_NOROUTETOHOST);
-        return true;
-    }
-    // Next, try to find a route
-    NS_LOG_LOGIC("Unicast destination- looking up global route");
-    Ptr<Ipv4Route> rtentry = LookupRoute(header.GetDestination());
-    if (rtentry)
+void
+OctopusRouting::ReceiveInput(Ptr<const Packet> p, uint32_t iif)
+{
+    RewardTag rewardTag;
+    if (p->PeekPacketTag(rewardTag))
     {
-        uint32_t oif = rtentry->GetOutputDevice()->GetIfIndex();
-        NS_LOG_LOGIC("Found unicast destination- calling unicast callback");
-        ucb(rtentry, p, header);
-        SendOneHopAck(header.GetDestination(), iif, oif);
-        return true;
+        // the tag is only meaningful on this hop
+        ConstCast<Packet>(p)->RemovePacketTag(rewardTag);
+        HandleUpdate(rewardTag.GetDestination(),
+                     iif,
+                     rewardTag.GetReward(),
+                     rewardTag.GetCount());
     }
-    else
+}
+
+void
+OctopusRouting::ForwardInput(Ptr<Ipv4Route> rtentry,
+                             Ptr<const Packet> p,
+                             const Ipv4Header& header,
+                             uint32_t iif,
+                             const UnicastForwardCallback& ucb)
+{
+    uint32_t oif = rtentry->GetOutputDevice()->GetIfIndex();
+    if (m_rewardFeedback == PIGGYBACKED_ACK)
     {
-        NS_LOG_LOGIC("Did not find unicast destination- returning false");
-        return false; // Let other routing protocols try to handle this
-                      // route request.
+        PiggybackReward(p, GetCachedInterfaceIndex(m_ipv4, rtentry->GetOutputDevice()));
     }
+    ucb(rtentry, p, header);
+    SendOneHopAck(header.GetDestination(), iif, oif);
 }
 
 void
 OctopusRouting::NotifyInterfaceUp(uint32_t i)
 {
     NS_LOG_FUNCTION(this << i);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_FUNCTION("Update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeSPFRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -174,12 +220,12 @@ void
 OctopusRouting::NotifyInterfaceDown(uint32_t i)
 {
     NS_LOG_FUNCTION(this << i);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_FUNCTION("Update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeSPFRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -187,12 +233,15 @@ void
 OctopusRouting::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this << interface << address);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    InvalidateIpv4Routes();
+    // the interface may be new, or have another device
+    m_linkDelays.clear();
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_FUNCTION("Update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeSPFRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -200,21 +249,24 @@ void
 OctopusRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this << interface << address);
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    InvalidateIpv4Routes();
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
         NS_LOG_FUNCTION("Update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeSPFRoutes();
+        RecomputeRoutes();
     }
 }
 
 void
-OctopusRouting::SetIpv4(Ptr<Ipv4> ipv4)
+OctopusRouting::RecomputeRoutes()
 {
-    NS_LOG_FUNCTION(this << ipv4);
-    NS_ASSERT(!m_ipv4 && ipv4);
-    m_ipv4 = ipv4;
+    NS_LOG_FUNCTION(this);
+    uint32_t nodeId = m_ipv4->GetObject<Node>()->GetId();
+    RouteManager::ScheduleRecompute(nodeId,
+                                    m_incrementalUpdates ? &RouteManager::UpdateSPFRoutes
+                                                         : &RouteManager::RecomputeSPFRoutes);
 }
 
 // Formatted like output of "route -n" command
@@ -289,179 +341,82 @@ OctopusRouting::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit un
 }
 
 void
-OctopusRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
-{
-    NS_LOG_FUNCTION(this << dest << nextHop << interface);
-    ArmedSpfRIE* route = new ArmedSpfRIE();
-    *route = ArmedSpfRIE::CreateHostRouteTo(dest, nextHop, interface);
-    m_hostRoutes.push_back(route);
-}
-
-void
-OctopusRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
+OctopusRouting::AddHostRoute(const ArmedSpfRIE& route)
 {
-    NS_LOG_FUNCTION(this << dest << interface);
-    ArmedSpfRIE* route = new ArmedSpfRIE();
-    *route = ArmedSpfRIE::CreateHostRouteTo(dest, interface);
-    m_hostRoutes.push_back(route);
-}
-
-void
-OctopusRouting::AddHostRouteTo(Ipv4Address dest,
-                               Ipv4Address nextHop,
-                               uint32_t interface,
-                               uint32_t nextInterface,
-                               uint32_t distance)
-{
-    NS_LOG_FUNCTION(this << dest << nextHop << interface << nextInterface << distance);
-    ArmedSpfRIE* route = new ArmedSpfRIE();
-    *route = ArmedSpfRIE::CreateHostRouteTo(dest, nextHop, interface, nextInterface, distance);
-    m_hostRoutes.push_back(route);
+    ArmedSpfRIE* entry = new ArmedSpfRIE(route);
+    m_hostRoutes.push_back(entry);
+    ArmSet& armSet = m_armSets[route.GetDest().Get()];
+    if (m_pruneArms)
+    {
+        armSet.SetPruning(m_pruneMargin, m_pruneMinPulls, m_pruneRetry);
+    }
+    armSet.AddArm(entry);
 }
 
-void
-OctopusRouting::AddNetworkRouteTo(Ipv4Address network,
-                                  Ipv4Mask networkMask,
-                                  Ipv4Address nextHop,
-                                  uint32_t interface)
+uint32_t
+OctopusRouting::GetNHostRoutes() const
 {
-    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
-    ArmedSpfRIE* route = new ArmedSpfRIE();
-    *route = ArmedSpfRIE::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
-    m_networkRoutes.push_back(route);
+    return m_hostRoutes.size();
 }
 
-void
-OctopusRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface)
+ArmedSpfRIE*
+OctopusRouting::GetHostRoute(uint32_t index) const
 {
-    NS_LOG_FUNCTION(this << network << networkMask << interface);
-    ArmedSpfRIE* route = new ArmedSpfRIE();
-    *route = ArmedSpfRIE::CreateNetworkRouteTo(network, networkMask, interface);
-    m_networkRoutes.push_back(route);
+    HostRoutes::const_iterator i = m_hostRoutes.begin();
+    std::advance(i, index);
+    return *i;
 }
 
 void
-OctopusRouting::AddASExternalRouteTo(Ipv4Address network,
-                                     Ipv4Mask networkMask,
-                                     Ipv4Address nextHop,
-                                     uint32_t interface)
-{
-    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
-    ArmedSpfRIE* route = new ArmedSpfRIE();
-    *route = ArmedSpfRIE::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
-    m_ASexternalRoutes.push_back(route);
-}
-
-uint32_t
-OctopusRouting::GetNRoutes(void) const
-{
-    NS_LOG_FUNCTION(this);
-    uint32_t n = 0;
-    n += m_hostRoutes.size();
-    n += m_networkRoutes.size();
-    n += m_ASexternalRoutes.size();
-    return n;
-}
-
-ArmedSpfRIE*
-OctopusRouting::GetRoute(uint32_t index) const
+OctopusRouting::RemoveHostRoute(uint32_t index)
 {
-    NS_LOG_FUNCTION(this << index);
-    if (index < m_hostRoutes.size())
-    {
-        uint32_t tmp = 0;
-        HostRoutes::const_iterator i = m_hostRoutes.begin();
-        for (; i != m_hostRoutes.end(); i++)
-        {
-            if (tmp == index)
-            {
-                return *i;
-            }
-            tmp++;
-        }
-    }
-    index -= m_hostRoutes.size();
-    uint32_t tmp = 0;
-    if (index < m_networkRoutes.size())
-    {
-        NetworkRoutes::const_iterator j = m_networkRoutes.begin();
-        for (; j != m_networkRoutes.end(); j++)
+    NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
+    HostRoutes::iterator i = m_hostRoutes.begin();
+    std::advance(i, index);
+    ArmSets::iterator arms = m_armSets.find((*i)->GetDest().Get());
+    if (arms != m_armSets.end())
+    {
+        arms->second.RemoveArm(*i);
+        if (arms->second.GetN() == 0)
         {
-            if (tmp == index)
-            {
-                return *j;
-            }
-            tmp++;
-        }
-    }
-    index -= m_networkRoutes.size();
-    tmp = 0;
-    ASExternalRoutes::const_iterator k = m_ASexternalRoutes.begin();
-    for (; k != m_ASexternalRoutes.end(); k++)
-    {
-        if (tmp == index)
-        {
-            return *k;
+            m_armSets.erase(arms);
         }
-        tmp++;
     }
-    NS_ASSERT(false);
-    // quiet compiler.
-    return 0;
+    delete *i;
+    m_hostRoutes.erase(i);
+    NS_LOG_LOGIC("Done removing host route "
+                 << index << "; host route remaining size = " << m_hostRoutes.size());
 }
 
 void
-OctopusRouting::RemoveRoute(uint32_t index)
+OctopusRouting::ClearHostRoutes()
 {
-    NS_LOG_FUNCTION(this << index);
-    if (index < m_hostRoutes.size())
+    m_armSets.clear();
+    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i = m_hostRoutes.erase(i))
     {
-        uint32_t tmp = 0;
-        for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
-        {
-            if (tmp == index)
-            {
-                NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
-                delete *i;
-                m_hostRoutes.erase(i);
-                NS_LOG_LOGIC("Done removing host route "
-                             << index << "; host route remaining size = " << m_hostRoutes.size());
-                return;
-            }
-            tmp++;
-        }
+        delete (*i);
     }
-    index -= m_hostRoutes.size();
-    uint32_t tmp = 0;
-    for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+}
+
+std::size_t
+OctopusRouting::GetMemoryFootprint() const
+{
+    std::size_t bytes = GetRouteListFootprint(m_hostRoutes) + GetPrefixRouteFootprint();
+    bytes += GetHashMapFootprint(m_armSets);
+    for (const auto& entry : m_armSets)
     {
-        if (tmp == index)
-        {
-            NS_LOG_LOGIC("Removing route " << index << "; size = " << m_networkRoutes.size());
-            delete *j;
-            m_networkRoutes.erase(j);
-            NS_LOG_LOGIC("Done removing network route "
-                         << index << "; network route remaining size = " << m_networkRoutes.size());
-            return;
-        }
-        tmp++;
+        bytes += entry.second.GetMemoryUsage();
     }
-    index -= m_networkRoutes.size();
-    tmp = 0;
-    for (auto k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+    bytes += m_armDatabase.GetMemoryFootprint() +
+             m_pendingRewards.capacity() * sizeof(PendingRewards);
+    // a map node holds the pair, the three links and the color
+    for (const PendingRewards& rewards : m_pendingRewards)
     {
-        if (tmp == index)
-        {
-            NS_LOG_LOGIC("Removing route " << index << "; size = " << m_ASexternalRoutes.size());
-            delete *k;
-            m_ASexternalRoutes.erase(k);
-            NS_LOG_LOGIC("Done removing network route "
-                         << index << "; network route remaining size = " << m_networkRoutes.size());
-            return;
-        }
-        tmp++;
+        bytes += rewards.size() * (sizeof(PendingRewards::value_type) + 4 * sizeof(void*));
     }
-    NS_ASSERT(false);
+    bytes += m_lookupRoutes.capacity() * sizeof(ArmedSpfRIE*) +
+             m_lookupWeights.capacity() * sizeof(double);
+    return bytes;
 }
 
 int64_t
@@ -475,74 +430,81 @@ OctopusRouting::AssignStreams(int64_t stream)
 Ptr<Ipv4Route>
 OctopusRouting::LookupRoute(Ipv4Address dest, Ptr<NetDevice> oif)
 {
-    NS_LOG_FUNCTION(this << dest << oif);
-    NS_LOG_LOGIC("Looking for route for destination " << dest);
+    ROMAM_HOT_LOG_FUNCTION(this << dest << oif);
+    ROMAM_HOT_LOG_LOGIC("Looking for route for destination " << dest);
     Ptr<Ipv4Route> rtentry = nullptr;
-    // store all available routes that bring packets to their destination
-    typedef std::vector<ArmedSpfRIE*> RouteVec_t;
-    RouteVec_t allRoutes;
+    // store all available routes that bring packets to their destination, in
+    // storage reused from lookup to lookup
+    std::vector<ArmedSpfRIE*>& allRoutes = m_lookupRoutes;
+    allRoutes.clear();
+    uint32_t outputIface = GetCachedInterfaceIndex(m_ipv4, oif);
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    ArmSets::iterator arms = m_armSets.find(dest.Get());
+    if (arms != m_armSets.end())
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        ArmSet& armSet = arms->second;
+        if (!oif)
+        {
+            CountLookup(RoutingStats::CANDIDATES_SCANNED, armSet.GetNActive());
+            armSet.PullArms();
+            ArmedSpfRIE* route = armSet.GetArm(armSet.Sample(m_rand->GetValue(0, 1)));
+            ROMAM_HOT_LOG_LOGIC("Selected global host route " << *route);
+            return GetIpv4Route(route, m_ipv4);
+        }
+        CountLookup(RoutingStats::CANDIDATES_SCANNED, armSet.GetN());
+        for (uint32_t i = 0; i < armSet.GetN(); i++)
         {
-            if (oif)
+            ArmedSpfRIE* route = armSet.GetArm(i);
+            if (route->GetInterface() != outputIface)
             {
-                if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
+                ROMAM_HOT_LOG_LOGIC("Not on requested interface, skipping");
+                continue;
             }
-            (*i)->PullArm();
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << *i);
+            route->PullArm();
+            allRoutes.push_back(route);
+            ROMAM_HOT_LOG_LOGIC(allRoutes.size() << "Found global host route" << route);
+        }
+    }
+    if (allRoutes.empty()) // no host route, fall back to the matching prefixes
+    {
+        auto onRequestedInterface = [oif, outputIface](ArmedSpfRIE* route) {
+            return !oif || route->GetInterface() == outputIface;
+        };
+        LookupPrefixRoutes(dest, onRequestedInterface, allRoutes);
+        for (auto j = allRoutes.begin(); j != allRoutes.end(); j++)
+        {
+            (*j)->PullArm();
         }
     }
 
     if (!allRoutes.empty()) // if route(s) is found
     {
-        int nRoutes = (int)allRoutes.size();
-        double p[nRoutes];
-        int ref = 0;
+        uint32_t nRoutes = allRoutes.size();
+        std::vector<double>& p = m_lookupWeights;
+        p.resize(nRoutes);
         double p_total = 0.0;
         double chances = nRoutes * log(nRoutes);
-        for (auto i = allRoutes.begin(); i != allRoutes.end(); i++)
+        for (uint32_t ref = 0; ref < nRoutes; ref++)
         {
             // Get the number of pulls
-            uint32_t nPulls = (*i)->GetNumPulls();
-            double loss = (*i)->GetCumulativeLoss();
+            uint32_t nPulls = allRoutes[ref]->GetNumPulls();
+            double loss = allRoutes[ref]->GetCumulativeLoss();
             double eta = sqrt(chances / (double)nPulls);
             p[ref] = exp(-eta * loss);
             p_total += p[ref];
-            ref += 1;
         }
         // norm the probabilities
         p[0] = p[0] / p_total;
-        for (int j = 1; j < nRoutes; j++)
+        for (uint32_t j = 1; j < nRoutes; j++)
         {
             p[j] = p[j] / p_total + p[j - 1];
         }
         double random = m_rand->GetValue(0, 1);
-        int j = 0;
-        while (p[j] < random)
-            j++;
-        if (j >= nRoutes)
-        {
-            j = nRoutes - 1;
-        }
-        uint32_t selectIndex = j;
+        uint32_t j = std::lower_bound(p.begin(), p.end(), random) - p.begin();
+        uint32_t selectIndex = std::min(j, nRoutes - 1);
         ArmedSpfRIE* route = allRoutes.at(selectIndex);
         // create a Ipv4Route object from the selected routing table entry
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(route->GetInterface(), 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        uint32_t interfaceIdx = route->GetInterface();
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+        rtentry = GetIpv4Route(route, m_ipv4);
         return rtentry;
     }
     else
@@ -551,6 +513,73 @@ OctopusRouting::LookupRoute(Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+void
+OctopusRouting::SaveArmStates(std::vector<ArmState>& routeArms,
+                              std::vector<ArmState>& valueArms) const
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t nodeId = m_ipv4->GetObject<Node>()->GetId();
+    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    {
+        routeArms.push_back(ArmState{nodeId,
+                                     (*i)->GetDest().Get(),
+                                     (*i)->GetInterface(),
+                                     (*i)->GetNumPulls(),
+                                     (*i)->GetCumulativeLoss()});
+    }
+    for (uint32_t iface = 0; iface < m_armDatabase.GetNInterfaces(); iface++)
+    {
+        const NeighborArms* arms = m_armDatabase.GetNeighborArms(iface);
+        if (!arms)
+        {
+            continue;
+        }
+        for (uint32_t n = 0; n < arms->GetNArms(); n++)
+        {
+            if (arms->HasArm(n))
+            {
+                valueArms.push_back(ArmState{nodeId,
+                                             n,
+                                             iface,
+                                             arms->GetNumPulls()[n],
+                                             arms->GetCumulativeLosses()[n]});
+            }
+        }
+    }
+}
+
+uint32_t
+OctopusRouting::RestoreArmStates(const std::vector<ArmState>& routeArms,
+                                 const std::vector<ArmState>& valueArms)
+{
+    NS_LOG_FUNCTION(this << routeArms.size() << valueArms.size());
+    uint32_t nRestored = 0;
+    for (const ArmState& state : routeArms)
+    {
+        ArmSets::iterator arms = m_armSets.find(state.dest);
+        if (arms == m_armSets.end())
+        {
+            continue;
+        }
+        uint32_t i = arms->second.FindArm(state.iface);
+        if (i == arms->second.GetN())
+        {
+            continue;
+        }
+        arms->second.RestoreArm(i, state.cumulativeLoss, state.nPulls);
+        nRestored++;
+    }
+    for (const ArmState& state : valueArms)
+    {
+        m_armDatabase.SetArmValue(state.iface,
+                                  state.dest,
+                                  ArmValue(state.cumulativeLoss, state.nPulls));
+        nRestored++;
+    }
+    NS_LOG_LOGIC("Restored " << nRestored << " arms");
+    return nRestored;
+}
+
 void
 OctopusRouting::InitializeSocketList()
 {
@@ -564,7 +593,7 @@ OctopusRouting::InitializeSocketList()
         }
 
         bool activeInterface = false;
-        if (m_interfaceExclusions.find(i) == m_interfaceExclusions.end())
+        if (!IsExcludedInterface(i))
         {
             activeInterface = true;
             m_ipv4->SetForwarding(i, true);
@@ -577,6 +606,16 @@ OctopusRouting::InitializeSocketList()
 
             if (address.GetScope() != Ipv4InterfaceAddress::HOST && activeInterface == true)
             {
+                if (m_useControlChannel)
+                {
+                    // the channel sends from the first address, without a socket
+                    if (i >= m_controlInterfaces.size())
+                    {
+                        m_controlInterfaces.resize(i + 1, false);
+                    }
+                    m_controlInterfaces[i] = true;
+                    continue;
+                }
                 NS_LOG_LOGIC("Octopus: add socket to " << address.GetLocal());
                 TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
                 Ptr<Node> theNode = m_ipv4->GetObject<Node>();
@@ -591,12 +630,19 @@ OctopusRouting::InitializeSocketList()
                 socket->SetIpRecvTtl(true);
                 socket->SetRecvPktInfo(true);
 
-                m_unicastSocketList[socket] = i;
+                AddInterfaceSocket(socket, i);
             }
         }
     }
+    // the forwarding flags changed under the interface cache
+    InvalidateInterfaceCache();
 
-    if (!m_multicastRecvSocket)
+    if (m_useControlChannel)
+    {
+        m_controlChannel = ControlChannel::GetChannel(m_ipv4, OCTOPUS_CONTROL_PROTOCOL);
+        m_controlChannel->SetReceiveCallback(MakeCallback(&OctopusRouting::ReceiveControl, this));
+    }
+    else if (!m_multicastRecvSocket)
     {
         NS_LOG_LOGIC("DGR: adding receiving socket");
         TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
@@ -610,6 +656,26 @@ OctopusRouting::InitializeSocketList()
     }
 }
 
+bool
+OctopusRouting::IsExcludedInterface(uint32_t interface) const
+{
+    return interface < m_interfaceExclusions.size() && m_interfaceExclusions[interface];
+}
+
+void
+OctopusRouting::AddInterfaceSocket(Ptr<Socket> socket, uint32_t interface)
+{
+    m_unicastSocketList[socket] = interface;
+    if (interface >= m_interfaceSockets.size())
+    {
+        m_interfaceSockets.resize(interface + 1);
+    }
+    if (!m_interfaceSockets[interface])
+    {
+        m_interfaceSockets[interface] = socket;
+    }
+}
+
 void
 OctopusRouting::DoInitialize()
 {
@@ -622,20 +688,18 @@ void
 OctopusRouting::DoDispose(void)
 {
     NS_LOG_FUNCTION(this);
-    // TODO: Realise memorys
-    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i = m_hostRoutes.erase(i))
-    {
-        delete (*i);
-    }
-    for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j = m_networkRoutes.erase(j))
+    ClearRoutes();
+    m_rewardFlushEvent.Cancel();
+    m_pendingRewards.clear();
+    m_linkDelays.clear();
+    if (m_controlChannel)
     {
-        delete (*j);
-    }
-    for (auto l = m_ASexternalRoutes.begin(); l != m_ASexternalRoutes.end();
-         l = m_ASexternalRoutes.erase(l))
-    {
-        delete (*l);
+        // the channel stays in the Ipv4 of the node
+        m_controlChannel->SetReceiveCallback(ControlChannel::ReceiveCallback());
+        m_controlChannel = nullptr;
     }
+    m_controlInterfaces.clear();
+    InvalidateInterfaceCache();
 
     Ipv4RoutingProtocol::DoDispose();
 }
@@ -644,6 +708,7 @@ void
 OctopusRouting::Receive(Ptr<Socket> socket)
 {
     NS_LOG_FUNCTION(this << socket);
+    EventAccounting::Scope scope(EventAccounting::OCTOPUS_ACK);
 
     Address sender;
     Ptr<Packet> packet = socket->RecvFrom(sender);
@@ -671,6 +736,19 @@ OctopusRouting::Receive(Ptr<Socket> socket)
     Ptr<Node> node = m_ipv4->GetObject<Node>();
     Ptr<NetDevice> dev = node->GetDevice(incomingIf);
     // uint32_t ipInterfaceIndex = m_ipv4->GetInterfaceForDevice(dev);
+    SocketIpTtlTag hoplimitTag;
+    packet->RemovePacketTag(hoplimitTag);
+    ReceiveControl(packet, senderAddress, incomingIf, hoplimitTag.GetTtl());
+}
+
+void
+OctopusRouting::ReceiveControl(Ptr<Packet> packet,
+                               Ipv4Address senderAddress,
+                               uint32_t interface,
+                               uint8_t hopLimit)
+{
+    NS_LOG_FUNCTION(this << packet << senderAddress << interface << int(hopLimit));
+    EventAccounting::Scope scope(EventAccounting::OCTOPUS_ACK);
 
     int32_t interfaceForAddress = m_ipv4->GetInterfaceForAddress(senderAddress);
     if (interfaceForAddress != -1)
@@ -687,7 +765,16 @@ OctopusRouting::Receive(Ptr<Socket> socket)
                                                        << hdr.GetReward());
         Ipv4Address dest = hdr.GetDestination();
         double reward = hdr.GetReward();
-        HandleUpdate(dest, incomingIf, reward);
+        HandleUpdate(dest, interface, reward);
+    }
+    else if (hdr.GetCommand() == OctopusHeader::ACK_BATCH)
+    {
+        NS_LOG_LOGIC("Update the cumulative loss with " << hdr.GetNBatchEntries() << " rewards");
+        for (uint16_t i = 0; i < hdr.GetNBatchEntries(); i++)
+        {
+            const OctopusHeader::BatchEntry& entry = hdr.GetBatchEntry(i);
+            HandleUpdate(entry.destination, interface, entry.reward, entry.count);
+        }
     }
     else
     {
@@ -697,108 +784,131 @@ OctopusRouting::Receive(Ptr<Socket> socket)
 }
 
 void
-OctopusRouting::HandleUpdate(Ipv4Address dest, uint32_t interface, double reward)
+OctopusRouting::HandleUpdate(Ipv4Address dest, uint32_t interface, double reward, uint16_t count)
 {
-    NS_LOG_FUNCTION(this << dest << interface << reward);
+    NS_LOG_FUNCTION(this << dest << interface << reward << count);
 
-    NS_LOG_LOGIC("Looking for route for destination " << dest);
+    ArmSets::iterator arms = m_armSets.find(dest.Get());
+    if (arms == m_armSets.end())
+    {
+        NS_LOG_LOGIC("No host route towards " << dest);
+        return;
+    }
+    ArmSet& armSet = arms->second;
+    uint32_t selected = armSet.FindArm(interface);
+    if (selected == armSet.GetN())
+    {
+        NS_LOG_LOGIC("No host route towards " << dest << " on interface " << interface);
+        return;
+    }
+    if (armSet.IsSuspended(selected))
+    {
+        // a packet sent before the suspension, the arm has no probability to weigh it with
+        NS_LOG_LOGIC("Arm towards " << dest << " on interface " << interface << " suspended");
+        return;
+    }
+    ArmedSpfRIE* route = armSet.GetArm(selected);
 
-    // store all available routes that bring packets to their destination
-    typedef std::vector<ArmedSpfRIE*> RouteVec_t;
-    RouteVec_t allRoutes;
+    // update arm's cumulative loss
+    // check the queueing delay of current node.
+    reward += GetLocalDelay(interface);
+    double delta = (1 - exp(-(route->GetDistance() + reward))) / armSet.GetProbability(selected);
+    // the importance-weighted loss and the raw reward are both added to the arm, once per
+    // coalesced ACK
+    armSet.UpdateArm(selected, (delta + reward) * count);
+}
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
-    {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+double
+OctopusRouting::GetLocalDelay(uint32_t interface)
+{
+    if (interface >= m_linkDelays.size())
+    {
+        m_linkDelays.resize(m_ipv4->GetNInterfaces(), LinkDelay{false, nullptr, nullptr, 0, 0});
+    }
+    NS_ASSERT(interface < m_linkDelays.size());
+    LinkDelay& link = m_linkDelays[interface];
+    if (!link.cached)
+    {
+        // the queue disc and the device of an interface only change with its addresses
+        Ptr<NetDevice> device = m_ipv4->GetNetDevice(interface);
+        Ptr<TrafficControlLayer> tc = m_ipv4->GetObject<Node>()->GetObject<TrafficControlLayer>();
+        link.qdisc = tc ? tc->GetRootQueueDiscOnDevice(device) : nullptr;
+        link.ddr = DynamicCast<DDRQueueDisc>(link.qdisc);
+        DataRateValue rate;
+        link.rate = device->GetAttributeFailSafe("DataRate", rate)
+                        ? rate.Get().GetBitRate() / 8.0
+                        : 0.0;
+        link.capacity = 0.0;
+        for (uint32_t i = 0; link.qdisc && i < link.qdisc->GetNInternalQueues(); i++)
         {
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << *i);
+            QueueSize size = link.qdisc->GetInternalQueue(i)->GetMaxSize();
+            link.capacity += size.GetUnit() == QueueSizeUnit::BYTES
+                                 ? size.GetValue()
+                                 : double(size.GetValue()) * device->GetMtu();
         }
+        link.cached = true;
+    }
+    if (!link.qdisc)
+    {
+        return 0.0;
+    }
+    uint32_t bytes = link.qdisc->GetNBytes();
+    if (m_normalizeRewards && link.capacity > 0.0)
+    {
+        // the drain times of the queue and of the full queue share the rate
+        return std::min(bytes / link.capacity, 1.0);
     }
+    double rate = link.ddr && link.ddr->GetDrainRate() > 0.0 ? link.ddr->GetDrainRate() : link.rate;
+    if (m_rewardDelay == BYTE_COUNT_DELAY || rate <= 0.0)
+    {
+        return bytes / 100.0;
+    }
+    return 1000.0 * bytes / rate;
+}
 
-    if (!allRoutes.empty()) // if route(s) is found
+Ptr<Socket>
+OctopusRouting::GetInterfaceSocket(uint32_t interface) const
+{
+    return interface < m_interfaceSockets.size() ? m_interfaceSockets[interface] : nullptr;
+}
+
+bool
+OctopusRouting::IsControlInterface(uint32_t interface) const
+{
+    if (m_controlChannel)
     {
-        int nRoutes = (int)allRoutes.size();
-        double p[nRoutes];
-        int ref = 0;
-        double p_total = 0.0;
-        double chances = nRoutes * log(nRoutes);
-        ArmedSpfRIE* route;
-        int route_ref = 0;
-        for (auto i = allRoutes.begin(); i != allRoutes.end(); i++)
-        {
-            // record the right route we are finding
-            if ((*i)->GetInterface() == interface)
-            {
-                route = *i;
-                route_ref = ref;
-            }
-            // Get the number of pulls
-            uint32_t nPulls = (*i)->GetNumPulls();
-            double loss = (*i)->GetCumulativeLoss();
-            double eta = sqrt(chances / (double)nPulls);
-            p[ref] = exp(-eta * loss);
-            p_total += p[ref];
-            ref += 1;
-        }
-        // norm the probabilities
-        for (int j = 0; j < nRoutes; j++)
-        {
-            p[j] = p[j] / p_total;
-        }
-        // update arm's cumulative loss
-        // check the queueing delay of current node.
-        Ptr<NetDevice> odev = m_ipv4->GetNetDevice(interface);
-        Ptr<QueueDisc> disc =
-            m_ipv4->GetObject<Node>()->GetObject<TrafficControlLayer>()->GetRootQueueDiscOnDevice(
-                odev);
-        uint32_t length = disc->GetNBytes();
-        double delay = length / 100.0; // delay in milliseconds
-        reward += delay;
-        double delta = (1 - exp(-(route->GetDistance() + reward))) / p[route_ref];
-        route->UpdateArm(delta);
-    }
-
-    // Find the route and upate arm
-    NS_LOG_FUNCTION(this << dest << interface << reward);
-    NS_LOG_LOGIC("Looking for this route");
-    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+        return interface < m_controlInterfaces.size() && m_controlInterfaces[interface];
+    }
+    return GetInterfaceSocket(interface) != nullptr;
+}
+
+void
+OctopusRouting::SendControl(Ptr<Packet> p, uint32_t interface)
+{
+    if (m_controlChannel)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
-        {
-            if ((*i)->GetInterface() == interface)
-            {
-                (*i)->UpdateArm(reward);
-                return;
-            }
-        }
+        m_controlChannel->Send(p, interface, Ipv4Address(OCTOPUS_BROAD_CAST));
+        return;
     }
+    GetInterfaceSocket(interface)->SendTo(p,
+                                          0,
+                                          InetSocketAddress(OCTOPUS_BROAD_CAST, OCTOPUS_PORT));
 }
 
 void
 OctopusRouting::SendOneHopAck(Ipv4Address dest, uint32_t iif, uint32_t oif)
 {
     NS_LOG_FUNCTION(this);
-    auto iter = m_unicastSocketList.begin();
-    for (; iter != m_unicastSocketList.end(); iter++)
+    EventAccounting::Scope scope(EventAccounting::OCTOPUS_ACK);
+    if (IsControlInterface(iif))
     {
-        if (iter->second == iif)
+        double delay = GetLocalDelay(oif);
+
+        if (m_rewardFeedback != PER_PACKET_ACK)
         {
-            break;
+            QueueReward(dest, iif, delay);
+            return;
         }
-    }
-
-    if (iter != m_unicastSocketList.end())
-    {
-        Ptr<NetDevice> odev = m_ipv4->GetNetDevice(oif);
-        Ptr<QueueDisc> disc =
-            m_ipv4->GetObject<Node>()->GetObject<TrafficControlLayer>()->GetRootQueueDiscOnDevice(
-                odev);
-        uint32_t length = disc->GetNBytes();
-        double delay = length / 100.0; // delay in milliseconds
 
         Ptr<Packet> p = Create<Packet>();
         SocketIpTtlTag ttlTag;
@@ -810,7 +920,104 @@ OctopusRouting::SendOneHopAck(Ipv4Address dest, uint32_t iif, uint32_t oif)
         hdr.SetDestination(dest);
         hdr.SetReward(delay);
         p->AddHeader(hdr);
-        iter->first->SendTo(p, 0, InetSocketAddress(OCTOPUS_BROAD_CAST, OCTOPUS_PORT));
+        SendControl(p, iif);
+    }
+}
+
+void
+OctopusRouting::QueueReward(Ipv4Address dest, uint32_t iif, double reward)
+{
+    NS_LOG_FUNCTION(this << dest << iif << reward);
+    if (iif >= m_pendingRewards.size())
+    {
+        m_pendingRewards.resize(iif + 1);
+    }
+    PendingReward& pending = m_pendingRewards[iif][dest.Get()];
+    pending.reward += reward;
+    pending.count++;
+    if (pending.count == UINT16_MAX)
+    {
+        // the counter would overflow, send this interface's rewards right away
+        FlushRewards(iif);
+    }
+    if (!m_rewardFlushEvent.IsRunning())
+    {
+        m_rewardFlushEvent =
+            Simulator::Schedule(m_rewardWindow, &OctopusRouting::FlushAllRewards, this);
+    }
+}
+
+void
+OctopusRouting::PiggybackReward(Ptr<const Packet> p, int32_t oif)
+{
+    if (oif < 0 || (uint32_t)oif >= m_pendingRewards.size() || m_pendingRewards[oif].empty())
+    {
+        return;
+    }
+    PendingRewards& pending = m_pendingRewards[oif];
+    PendingRewards::iterator i = pending.begin();
+    RewardTag rewardTag;
+    rewardTag.SetDestination(Ipv4Address(i->first));
+    rewardTag.SetReward(i->second.reward / i->second.count);
+    rewardTag.SetCount(i->second.count);
+    p->AddPacketTag(rewardTag);
+    pending.erase(i);
+}
+
+void
+OctopusRouting::FlushRewards(uint32_t iif)
+{
+    NS_LOG_FUNCTION(this << iif);
+    EventAccounting::Scope scope(EventAccounting::OCTOPUS_ACK);
+    PendingRewards& pending = m_pendingRewards[iif];
+    if (!IsControlInterface(iif) || pending.empty())
+    {
+        pending.clear();
+        return;
+    }
+    PendingRewards::iterator i = pending.begin();
+    while (i != pending.end())
+    {
+        OctopusHeader hdr;
+        hdr.SetCommand(OctopusHeader::ACK_BATCH);
+        for (; i != pending.end() && hdr.GetNBatchEntries() < OCTOPUS_MAX_BATCH; i++)
+        {
+            hdr.AddBatchEntry(Ipv4Address(i->first),
+                              i->second.reward / i->second.count,
+                              i->second.count);
+        }
+        Ptr<Packet> p = Create<Packet>();
+        SocketIpTtlTag ttlTag;
+        ttlTag.SetTtl(1);
+        p->AddPacketTag(ttlTag);
+        p->AddHeader(hdr);
+        SendControl(p, iif);
     }
+    pending.clear();
 }
-} // namespace ns3
\ No newline at end of file
+
+void
+OctopusRouting::FlushAllRewards()
+{
+    NS_LOG_FUNCTION(this);
+    EventAccounting::Scope scope(EventAccounting::OCTOPUS_ACK);
+    for (uint32_t iif = 0; iif < m_pendingRewards.size(); iif++)
+    {
+        if (!m_pendingRewards[iif].empty())
+        {
+            FlushRewards(iif);
+        }
+    }
+}
+
+} // namespace ns3
+
+// the members of the core, logged under the component of the protocol
+#include "romam-routing-core-impl.h"
+
+namespace ns3
+{
+
+template class RomamRoutingCore<OctopusRouting, ArmedSpfRIE>;
+
+} // namespace ns3
@@ -3,11 +3,16 @@
 #ifndef OCTOPUS_ROUTING_H
 #define OCTOPUS_ROUTING_H
 
+#include "datapath/arm-state-file.h"
 #include "datapath/arm-value-db.h"
-#include "romam-routing.h"
+#include "romam-routing-core.h"
+#include "routing_algorithm/arm-set.h"
+#include "routing_algorithm/armed-spf-rie.h"
+#include "utility/control-channel.h"
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
+#include "ns3/event-id.h"
 #include "ns3/ipv4.h"
 #include "ns3/nstime.h"
 #include "ns3/ptr.h"
@@ -16,20 +21,38 @@
 #include <list>
 #include <map>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
 
+/// how Octopus feeds rewards back to the upstream neighbor
+typedef enum
+{
+    PER_PACKET_ACK,  //!< one ACK message per forwarded packet
+    AGGREGATED_ACK,  //!< ACKs coalesced per (destination, interface) over a window
+    PIGGYBACKED_ACK, //!< rewards carried by reverse data packets, the rest coalesced
+} RewardFeedback_t;
+
+/// how Octopus estimates the queueing delay of a link for its rewards
+typedef enum
+{
+    BYTE_COUNT_DELAY, //!< the bytes queued over 100 bytes/ms, whatever the link rate
+    DRAIN_RATE_DELAY, //!< the bytes queued over the measured dequeue rate of the queue disc
+} RewardDelay_t;
+
 class Packet;
 class NetDevice;
 class Ipv4Interface;
 class Ipv4Address;
 class Ipv4Header;
 class Node;
-class ArmedSpfRIE;
 class ArmValueDB;
+class QueueDisc;
+class DDRQueueDisc;
 
-class OctopusRouting : public RomamRouting
+class OctopusRouting : public RomamRoutingCore<OctopusRouting, ArmedSpfRIE>
 {
   public:
     /**
@@ -49,44 +72,15 @@ class OctopusRouting : public RomamRouting
     ~OctopusRouting() override;
 
     // These methods inherited from Ipv4Routing Protocol class
-    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
-                               const Ipv4Header& header,
-                               Ptr<NetDevice> oif,
-                               Socket::SocketErrno& sockerr) override;
-    bool RouteInput(Ptr<const Packet> p,
-                    const Ipv4Header& header,
-                    Ptr<const NetDevice> idev,
-                    const UnicastForwardCallback& ucb,
-                    const MulticastForwardCallback& mcb,
-                    const LocalDeliverCallback& lcb,
-                    const ErrorCallback& ecb) override;
     void NotifyInterfaceUp(uint32_t interface) override;
     void NotifyInterfaceDown(uint32_t interface) override;
     void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
     void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
-    void SetIpv4(Ptr<Ipv4> ipv4) override;
     void PrintRoutingTable(Ptr<OutputStreamWrapper> stream,
                            Time::Unit unit = Time::S) const override;
 
     // These methods inherited from RomamRouting class
-    void AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface) override;
-    void AddHostRouteTo(Ipv4Address dest, uint32_t interface) override;
-    void AddHostRouteTo(Ipv4Address dest,
-                        Ipv4Address nextHop,
-                        uint32_t interface,
-                        uint32_t nextInterface,
-                        uint32_t distance) override;
-    void AddNetworkRouteTo(Ipv4Address network,
-                           Ipv4Mask networkMask,
-                           Ipv4Address nextHop,
-                           uint32_t interface) override;
-    void AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface) override;
-    void AddASExternalRouteTo(Ipv4Address network,
-                              Ipv4Mask networkMask,
-                              Ipv4Address nextHop,
-                              uint32_t interface) override;
-    uint32_t GetNRoutes(void) const override;
-    void RemoveRoute(uint32_t i) override;
+    std::size_t GetMemoryFootprint() const override;
 
     /**
      * Assign a fixed random variable stream number to the random variables
@@ -98,10 +92,27 @@ class OctopusRouting : public RomamRouting
      */
     int64_t AssignStreams(int64_t stream);
 
-    ArmedSpfRIE* GetRoute(uint32_t i) const;
-
     void InitializeSocketList();
 
+    /**
+     * \brief Append the statistics of the arms of the node: those of its host
+     * routes, keyed by destination and interface, and those of its
+     * ArmValueDB, keyed by interface and neighbor interface.
+     * \param routeArms extended with the arms of the host routes
+     * \param valueArms extended with the arms of the ArmValueDB
+     */
+    void SaveArmStates(std::vector<ArmState>& routeArms, std::vector<ArmState>& valueArms) const;
+
+    /**
+     * \brief Set the statistics of the arms of the node to saved ones.  The
+     * saved arms of a host route the node no longer has are ignored.
+     * \param routeArms the saved arms of the host routes of the node
+     * \param valueArms the saved arms of the ArmValueDB of the node
+     * \return the number of arms restored
+     */
+    uint32_t RestoreArmStates(const std::vector<ArmState>& routeArms,
+                              const std::vector<ArmState>& valueArms);
+
   protected:
     /**
      * \brief Dispose this object
@@ -113,20 +124,30 @@ class OctopusRouting : public RomamRouting
     void DoInitialize() override;
 
   private:
+    friend class RomamRoutingCore<OctopusRouting, ArmedSpfRIE>;
+
+    /**
+     * \brief Have the RouteManager recompute the routes of the network after
+     * an interface event, incrementally if the IncrementalUpdates attribute is
+     * set.  The events of a burst are coalesced into one recompute.
+     */
+    void RecomputeRoutes();
+
     bool m_randomEcmpRouting;
 
     bool m_respondToInterfaceEvents;
+    /// Set to true to update only the routes an interface event changes
+    bool m_incrementalUpdates;
+    /// Set to true to send the ACKs through a ControlChannel rather than sockets
+    bool m_useControlChannel;
     /// A uniform random number generator for randomly routing packets among ECMP
     Ptr<UniformRandomVariable> m_rand;
 
     /// container of Ipv4RoutingTableEntry (routes to hosts)
     typedef std::list<ArmedSpfRIE*> HostRoutes;
 
-    /// container of Ipv4RoutingTableEntry (routes to networks)
-    typedef std::list<ArmedSpfRIE*> NetworkRoutes;
-
-    /// container of RoutingTableEntry (routes to external AS)
-    typedef std::list<ArmedSpfRIE*> ASExternalRoutes;
+    /// Exp3 arm sets of the host routes, by destination
+    typedef std::unordered_map<uint32_t, ArmSet> ArmSets;
 
     /**
      * \brief Lookup in the forwarding table for destination.
@@ -136,10 +157,46 @@ class OctopusRouting : public RomamRouting
      */
     Ptr<Ipv4Route> LookupRoute(Ipv4Address dest, Ptr<NetDevice> oif = nullptr);
 
-    HostRoutes m_hostRoutes;             //!< Routes to hosts
-    NetworkRoutes m_networkRoutes;       //!< Routes to networks
-    ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
-    Ptr<Ipv4> m_ipv4;                    //!< associated IPv4 instance
+    // These methods called by RomamRoutingCore
+    Ptr<Ipv4Route> SelectOutputRoute(Ptr<Packet> p,
+                                     const Ipv4Header& header,
+                                     Ptr<NetDevice> oif);
+    Ptr<Ipv4Route> SelectInputRoute(Ptr<const Packet>& p,
+                                    const Ipv4Header& header,
+                                    Ptr<const NetDevice> idev);
+    void AddHostRoute(const ArmedSpfRIE& route);
+    uint32_t GetNHostRoutes() const;
+    ArmedSpfRIE* GetHostRoute(uint32_t i) const;
+    void RemoveHostRoute(uint32_t i);
+    void ClearHostRoutes();
+
+    /**
+     * \brief Take the reward a packet carries for the neighbor it came from.
+     * \param p the packet received
+     * \param iif the input interface
+     */
+    void ReceiveInput(Ptr<const Packet> p, uint32_t iif);
+
+    /**
+     * \brief Forward a packet, with a pending reward of the neighbor it goes
+     * to, and send the one-hop ACK of the arm it was taken on.
+     * \param rtentry the route
+     * \param p the packet
+     * \param header the IP header of the packet
+     * \param iif the input interface
+     * \param ucb the unicast forward callback
+     */
+    void ForwardInput(Ptr<Ipv4Route> rtentry,
+                      Ptr<const Packet> p,
+                      const Ipv4Header& header,
+                      uint32_t iif,
+                      const UnicastForwardCallback& ucb);
+
+    HostRoutes m_hostRoutes; //!< Routes to hosts
+    ArmSets m_armSets;       //!< Host routes, by destination
+
+    std::vector<ArmedSpfRIE*> m_lookupRoutes; //!< scratch candidates of a lookup
+    std::vector<double> m_lookupWeights;      //!< scratch cumulative probabilities of a lookup
 
     ArmValueDB m_armDatabase; //!< arm cumulative loss database
 
@@ -155,9 +212,26 @@ class OctopusRouting : public RomamRouting
 
     SocketList
         m_unicastSocketList; //!< list of sockets for unicast messages (socket, interface index)
-    Ptr<Socket> m_multicastRecvSocket; //!< multicast receive socket
+    Ptr<Socket> m_multicastRecvSocket;           //!< multicast receive socket
+    std::vector<Ptr<Socket>> m_interfaceSockets; //!< first unicast socket by interface, or null
+    Ptr<ControlChannel> m_controlChannel;        //!< the channel of the ACKs, or null
+    std::vector<bool> m_controlInterfaces;       //!< whether the channel sends on an interface
 
-    std::set<uint32_t> m_interfaceExclusions; //!< Set of excluded interfaces
+    std::vector<bool> m_interfaceExclusions; //!< whether an interface is excluded, by interface
+
+    /**
+     * \param interface the interface index
+     * \return true if the protocol leaves the interface out
+     */
+    bool IsExcludedInterface(uint32_t interface) const;
+
+    /**
+     * \brief Record a unicast socket of an interface, the one it sends on
+     * if it is the first.
+     * \param socket the socket
+     * \param interface the interface index
+     */
+    void AddInterfaceSocket(Ptr<Socket> socket, uint32_t interface);
 
     /**
      * Receive an DGR message
@@ -165,9 +239,121 @@ class OctopusRouting : public RomamRouting
      * \param socket the socket the packet was received from.
      */
     void Receive(Ptr<Socket> socket);
-    void HandleUpdate(Ipv4Address dest, uint32_t interface, double reward);
+
+    /**
+     * \brief Handle a message received by a socket or the control channel.
+     * \param packet the message
+     * \param senderAddress the address of the sender
+     * \param interface the interface the message came in on
+     * \param hopLimit the TTL of the message
+     */
+    void ReceiveControl(Ptr<Packet> packet,
+                        Ipv4Address senderAddress,
+                        uint32_t interface,
+                        uint8_t hopLimit);
+    /**
+     * \brief Add a reward to the arm towards dest through interface.
+     * \param dest the destination
+     * \param interface the output interface of the arm
+     * \param reward the (mean) reward
+     * \param count the number of coalesced ACKs the reward stands for
+     */
+    void HandleUpdate(Ipv4Address dest, uint32_t interface, double reward, uint16_t count = 1);
+
+    /**
+     * \brief Estimate the queueing delay of an interface, in O(1).
+     *
+     * The bytes of the queue disc of the interface are drained at the
+     * dequeue rate a DDRQueueDisc measures, or at the rate of the device
+     * until it did.  With NormalizeRewards, the delay is over the one of a
+     * full queue disc, in [0, 1] on every link.
+     *
+     * \param interface the interface index
+     * \return the delay in milliseconds, or normalized
+     */
+    double GetLocalDelay(uint32_t interface);
     void SendOneHopAck(Ipv4Address dest, uint32_t iif, uint32_t oif);
 
+    /**
+     * \param interface the interface index
+     * \return the first unicast socket bound to interface, or null
+     */
+    Ptr<Socket> GetInterfaceSocket(uint32_t interface) const;
+
+    /**
+     * \param interface the interface index
+     * \return true if the ACKs are sent on the interface
+     */
+    bool IsControlInterface(uint32_t interface) const;
+
+    /**
+     * \brief Send an ACK to the neighbors on an interface, by the control
+     * channel or the first socket of the interface.
+     * \param p the ACK
+     * \param interface the interface index
+     */
+    void SendControl(Ptr<Packet> p, uint32_t interface);
+
+    /**
+     * \brief Coalesce a reward until the next flush.
+     * \param dest the destination the reward applies to
+     * \param iif the interface towards the neighbor the reward is for
+     * \param reward the reward
+     */
+    void QueueReward(Ipv4Address dest, uint32_t iif, double reward);
+
+    /**
+     * \brief Move one pending reward of the neighbor on oif to a forwarded packet.
+     * \param p the forwarded packet
+     * \param oif the output interface of the packet
+     */
+    void PiggybackReward(Ptr<const Packet> p, int32_t oif);
+
+    /**
+     * \brief Send the pending rewards of an interface in ACK_BATCH messages.
+     * \param iif the interface
+     */
+    void FlushRewards(uint32_t iif);
+
+    /**
+     * \brief Send the pending rewards of all the interfaces.
+     */
+    void FlushAllRewards();
+
+    /// rewards coalesced towards one destination
+    struct PendingReward
+    {
+        double reward;  //!< sum of the rewards
+        uint16_t count; //!< number of rewards
+    };
+
+    /// pending rewards of one interface, by destination
+    typedef std::map<uint32_t, PendingReward> PendingRewards;
+
+    /// what the queueing delay of an interface is estimated from
+    struct LinkDelay
+    {
+        bool cached;           //!< whether the entry was filled
+        Ptr<QueueDisc> qdisc;  //!< root queue disc of the device, null if none
+        Ptr<DDRQueueDisc> ddr; //!< the same, if it measures its dequeue rate
+        double rate;           //!< rate of the device in bytes/s, 0 if unknown
+        double capacity;       //!< bytes the queue disc holds when full, 0 if unknown
+    };
+
+    RewardDelay_t m_rewardDelay;         //!< how the queueing delays are estimated
+    bool m_normalizeRewards;             //!< whether the delays are over those of full queues
+    std::vector<LinkDelay> m_linkDelays; //!< delay estimation state, by interface
+
+    bool m_pruneArms;         //!< whether the dominated arms are suspended
+    double m_pruneMargin;     //!< relative loss margin of a dominated arm
+    uint32_t m_pruneMinPulls; //!< pulls needed before a suspension
+    uint32_t m_pruneRetry;    //!< lookups before a first retry
+
+    RewardFeedback_t m_rewardFeedback;            //!< how rewards are sent back
+    Time m_rewardWindow;                          //!< coalescing window of the rewards
+    std::vector<PendingRewards> m_pendingRewards; //!< pending rewards, by interface
+    EventId m_rewardFlushEvent;                   //!< next flush of the pending rewards
+
     // Ptr<OutputStreamWrapper> m_outStream = Create<OutputStreamWrapper>
     // ("queueStatusErr.txt", std::ios::out);
 
@@ -1,22 +1,39 @@
 #include "ospf-routing.h"
 
+#include "datapath/lsdb.h"
 #include "routing_algorithm/dijkstra-route-info-entry.h"
 #include "routing_algorithm/route-info-entry.h"
+#include "utility/address-interner.h"
+#include "utility/event-accounting.h"
+#include "utility/next-hop-columns.h"
+#include "utility/romam-router.h"
 #include "utility/route-manager.h"
 
+#include "ns3/abort.h"
 #include "ns3/boolean.h"
+#include "ns3/global-value.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/log.h"
+#include "ns3/loopback-net-device.h"
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/uinteger.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <vector>
 
+#define OSPF_PORT 89
+#define OSPF_ALL_SPF_ROUTERS "224.0.0.5"
+#define OSPF_UDP_IP_HEADERS 28 // bytes of the IP and UDP headers of an LSU or LSAck
+
 namespace ns3
 {
 
@@ -24,6 +41,15 @@ NS_LOG_COMPONENT_DEFINE("OSPFRouting");
 
 NS_OBJECT_ENSURE_REGISTERED(OSPFRouting);
 
+/// whether the host routes of the OSPF nodes are kept in the NextHopColumns
+static GlobalValue g_columnHostRoutes(
+    "RomamColumnHostRoutes",
+    "Keep the host routes of the OSPF nodes that go directly on an interface in columns of "
+    "16-bit interfaces per destination shared by the nodes, instead of an entry per route "
+    "(read when a node is created)",
+    BooleanValue(false),
+    MakeBooleanChecker());
+
 TypeId
 OSPFRouting::GetTypeId()
 {
@@ -37,20 +63,103 @@ OSPFRouting::GetTypeId()
                           BooleanValue(false),
                           MakeBooleanAccessor(&OSPFRouting::m_randomEcmpRouting),
                           MakeBooleanChecker())
+            .AddAttribute("FlowHashEcmpRouting",
+                          "Set to true to route the packets of a flow on the ECMP route the hash "
+                          "of its 5-tuple selects, cached per flow; takes precedence over "
+                          "RandomEcmpRouting",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&OSPFRouting::m_flowHashEcmpRouting),
+                          MakeBooleanChecker())
+            .AddAttribute("FlowCacheSize",
+                          "The number of flows whose route FlowHashEcmpRouting caches",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&OSPFRouting::SetFlowCacheSize,
+                                               &OSPFRouting::GetFlowCacheSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("FlowletGap",
+                          "The idle time after which FlowHashEcmpRouting may move a flow to "
+                          "another route; 0 keeps a flow on its route",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&OSPFRouting::SetFlowletGap,
+                                           &OSPFRouting::GetFlowletGap),
+                          MakeTimeChecker())
             .AddAttribute("RespondToInterfaceEvents",
                           "Set to true if you want to dynamically recompute the global routes upon "
                           "Interface notification events (up/down, or add/remove address)",
                           BooleanValue(false),
                           MakeBooleanAccessor(&OSPFRouting::m_respondToInterfaceEvents),
-                          MakeBooleanChecker());
+                          MakeBooleanChecker())
+            .AddAttribute("IncrementalUpdates",
+                          "Set to true to update only the SPF trees and forwarding tables "
+                          "an interface event changes, instead of recomputing all the routes",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&OSPFRouting::m_incrementalUpdates),
+                          MakeBooleanChecker())
+            .AddAttribute("DistributedFlooding",
+                          "Set to true to flood the LSAs between the nodes and compute the "
+                          "routes from the LSDB of each node, instead of the global LSDB",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&OSPFRouting::m_distributedFlooding),
+                          MakeBooleanChecker())
+            .AddAttribute("AckDelay",
+                          "The time the acknowledgments of an interface wait to be batched "
+                          "into one LSAck",
+                          TimeValue(MilliSeconds(5)),
+                          MakeTimeAccessor(&OSPFRouting::m_ackDelay),
+                          MakeTimeChecker())
+            .AddAttribute("RetransmitInterval",
+                          "The time after which the LSAs a neighbor did not acknowledge are "
+                          "sent again",
+                          TimeValue(MilliSeconds(50)),
+                          MakeTimeAccessor(&OSPFRouting::m_retransmitInterval),
+                          MakeTimeChecker(MilliSeconds(1)))
+            .AddAttribute("SpfDelay",
+                          "The time the routes wait for the LSDB of the node to stop changing "
+                          "before they are computed again",
+                          TimeValue(MilliSeconds(5)),
+                          MakeTimeAccessor(&OSPFRouting::m_spfDelay),
+                          MakeTimeChecker())
+            .AddAttribute("HelloInterval",
+                          "The time between two Hellos on an interface",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&OSPFRouting::m_helloInterval),
+                          MakeTimeChecker(MilliSeconds(1)))
+            .AddAttribute("RouterDeadInterval",
+                          "The time without a Hello after which a neighbor is down",
+                          TimeValue(MilliSeconds(400)),
+                          MakeTimeAccessor(&OSPFRouting::m_routerDeadInterval),
+                          MakeTimeChecker())
+            .AddTraceSource("FloodingTx",
+                            "An LSU, LSAck or Hello sent",
+                            MakeTraceSourceAccessor(&OSPFRouting::m_floodingTxTrace),
+                            "ns3::OSPFRouting::FloodingTxTracedCallback")
+            .AddTraceSource("FloodedSpf",
+                            "A computation of the routes from the LSDB of the node",
+                            MakeTraceSourceAccessor(&OSPFRouting::m_floodedSpfTrace),
+                            "ns3::OSPFRouting::FloodedSpfTracedCallback")
+            .AddTraceSource("NeighborState",
+                            "A change of the state of a neighbor",
+                            MakeTraceSourceAccessor(&OSPFRouting::m_neighborStateTrace),
+                            "ns3::OSPFRouting::NeighborStateTracedCallback");
     return tid;
 }
 
 OSPFRouting::OSPFRouting()
     : m_randomEcmpRouting(false),
-      m_respondToInterfaceEvents(false)
+      m_flowHashEcmpRouting(false),
+      m_routeGeneration(0),
+      m_respondToInterfaceEvents(false),
+      m_incrementalUpdates(false),
+      m_columnNode(NO_COLUMN_NODE),
+      m_distributedFlooding(false),
+      m_helloTimer(0),
+      m_retransmitTimer(0),
+      m_nPooledHostRoutes(0)
 {
     NS_LOG_FUNCTION(this);
+    BooleanValue columns;
+    g_columnHostRoutes.GetValue(columns);
+    m_columnRoutes = columns.Get();
 
     m_rand = CreateObject<UniformRandomVariable>();
 }
@@ -61,105 +170,40 @@ OSPFRouting::~OSPFRouting()
 }
 
 Ptr<Ipv4Route>
-OSPFRouting::RouteOutput(Ptr<Packet> p,
-                         const Ipv4Header& header,
-                         Ptr<NetDevice> oif,
-                         Socket::SocketErrno& sockerr)
-{
-    NS_LOG_FUNCTION(this << p << &header << oif << &sockerr);
-    //
-    // First, see if this is a multicast packet we have a route for.  If we
-    // have a route, then send the packet down each of the specified interfaces.
-    //
-    if (header.GetDestination().IsMulticast())
-    {
-        NS_LOG_LOGIC("Multicast destination-- returning false");
-        return nullptr; // Let other routing protocols try to handle this
-    }
-    //
-    // See if this is a unicast packet we have a route for.
-    //
-    NS_LOG_LOGIC("Unicast destination- looking up");
-    Ptr<Ipv4Route> rtentry = LookupRoute(header.GetDestination(), oif);
-    if (rtentry)
-    {
-        sockerr = Socket::ERROR_NOTERROR;
-    }
-    else
-    {
-        sockerr = Socket::ERROR_NOROUTETOHOST;
-    }
-    return rtentry;
+OSPFRouting::SelectOutputRoute(Ptr<Packet> p, const Ipv4Header& header, Ptr<NetDevice> oif)
+{
+    return m_flowHashEcmpRouting ? LookupFlowRoute(header, p, oif)
+                                 : LookupRoute(header.GetDestination(), oif);
 }
 
-bool
-OSPFRouting::RouteInput(Ptr<const Packet> p,
-                        const Ipv4Header& header,
-                        Ptr<const NetDevice> idev,
-                        const UnicastForwardCallback& ucb,
-                        const MulticastForwardCallback& mcb,
-                        const LocalDeliverCallback& lcb,
-                        const ErrorCallback& ecb)
+Ptr<Ipv4Route>
+OSPFRouting::SelectInputRoute(Ptr<const Packet>& p,
+                              const Ipv4Header& header,
+                              Ptr<const NetDevice> idev)
 {
-    NS_LOG_FUNCTION(this << p << header << header.GetSource() << header.GetDestination() << idev
-                         << &lcb << &ecb);
-    // Check if input device supports IP
-    NS_ASSERT(m_ipv4->GetInterfaceForDevice(idev) >= 0);
-    uint32_t iif = m_ipv4->GetInterfaceForDevice(idev);
-
-    if (m_ipv4->IsDestinationAddress(header.GetDestination(), iif))
-    {
-        if (!lcb.IsNull())
-        {
-            NS_LOG_LOGIC("Local delivery to " << header.GetDestination());
-            lcb(p, header, iif);
-            return true;
-        }
-        else
-        {
-            // The local delivery callback is null.  This may be a multicast
-            // or broadcast packet, so return false so that another
-            // multicast routing protocol can handle it.  It should be possible
-            // to extend this to explicitly check whether it is a unicast
-            // packet, and invoke the error callback if so
-            return false;
-        }
-    }
-
-    // Check if input device supports IP forwarding
-    if (!m_ipv4->IsForwarding(iif))
-    {
-        NS_LOG_LOGIC("Forwarding disabled for this interface");
-        ecb(p, header, Socket::ERROR_NOROUTETOHOST);
-        return true;
-    }
-    // Next, try to find a route
-    NS_LOG_LOGIC("Unicast destination- looking up global route");
-    Ptr<Ipv4Route> rtentry = LookupRoute(header.GetDestination());
-    if (rtentry)
-    {
-        NS_LOG_LOGIC("Found unicast destination- calling unicast callback");
-        ucb(rtentry, p, header);
-        return true;
-    }
-    else
-    {
-        NS_LOG_LOGIC("Did not find unicast destination- returning false");
-        return false; // Let other routing protocols try to handle this
-                      // route request.
-    }
+    return m_flowHashEcmpRouting ? LookupFlowRoute(header, p)
+                                 : LookupRoute(header.GetDestination());
 }
 
 void
 OSPFRouting::NotifyInterfaceUp(uint32_t i)
 {
     NS_LOG_FUNCTION(this << i);
-    if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    m_routeGeneration++;
+    if (m_distributedFlooding && m_multicastRecvSocket)
+    {
+        InitializeFloodingSockets();
+    }
+    if (m_distributedFlooding)
+    {
+        ScheduleOrigination();
+    }
+    else if (m_respondToInterfaceEvents && Simulator::Now() > Seconds(0)) // avoid startup events
     {
         NS_LOG_LOGIC("update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeDijkstraRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -167,12 +211,18 @@ void
 OSPFRouting::NotifyInterfaceDown(uint32_t i)
 {
     NS_LOG_FUNCTION(this << i);
-    if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    m_routeGeneration++;
+    if (m_distributedFlooding)
+    {
+        DispatchNeighborEvent(i, NeighborFsm::KILL_NBR);
+        ScheduleOrigination();
+    }
+    else if (m_respondToInterfaceEvents && Simulator::Now() > Seconds(0)) // avoid startup events
     {
         NS_LOG_LOGIC("update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeDijkstraRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -180,12 +230,18 @@ void
 OSPFRouting::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this << interface << address);
-    if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    InvalidateIpv4Routes();
+    m_routeGeneration++;
+    if (m_distributedFlooding)
+    {
+        ScheduleOrigination();
+    }
+    else if (m_respondToInterfaceEvents && Simulator::Now() > Seconds(0)) // avoid startup events
     {
         NS_LOG_LOGIC("update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeDijkstraRoutes();
+        RecomputeRoutes();
     }
 }
 
@@ -193,21 +249,29 @@ void
 OSPFRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this << interface << address);
-    if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
+    MarkRouterDirty(m_ipv4);
+    InvalidateInterfaceCache();
+    InvalidateIpv4Routes();
+    m_routeGeneration++;
+    if (m_distributedFlooding)
+    {
+        ScheduleOrigination();
+    }
+    else if (m_respondToInterfaceEvents && Simulator::Now() > Seconds(0)) // avoid startup events
     {
         NS_LOG_LOGIC("update routing table");
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildLSDB();
-        RouteManager::InitializeDijkstraRoutes();
+        RecomputeRoutes();
     }
 }
 
 void
-OSPFRouting::SetIpv4(Ptr<Ipv4> ipv4)
+OSPFRouting::RecomputeRoutes()
 {
-    NS_LOG_FUNCTION(this << ipv4);
-    NS_ASSERT(!m_ipv4 && ipv4);
-    m_ipv4 = ipv4;
+    NS_LOG_FUNCTION(this);
+    uint32_t nodeId = m_ipv4->GetObject<Node>()->GetId();
+    RouteManager::ScheduleRecompute(nodeId,
+                                    m_incrementalUpdates ? &RouteManager::UpdateDijkstraRoutes
+                                                         : &RouteManager::RecomputeDijkstraRoutes);
 }
 
 void
@@ -275,174 +339,137 @@ OSPFRouting::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit)
 }
 
 void
-OSPFRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
+OSPFRouting::AddHostRoute(const DijkstraRIE& route)
 {
-    NS_LOG_FUNCTION(this << dest << nextHop << interface);
-    auto route = new DijkstraRIE();
-    *route = DijkstraRIE::CreateHostRouteTo(dest, nextHop, interface);
-    m_hostRoutes.push_back(route);
+    if (m_columnRoutes && !route.IsGateway())
+    {
+        if (m_columnNode == NO_COLUMN_NODE)
+        {
+            m_columnNode = m_ipv4->GetObject<Node>()->GetId();
+        }
+        uint32_t dest = AddressInterner::Get()->InternAddress(route.GetDest());
+        NS_ASSERT(dest < COLUMN_ROUTE);
+        // the slot is taken by the first route to the destination
+        if (NextHopColumns::Get()->Set(dest, m_columnNode, route.GetInterface()))
+        {
+            m_hostRoutes.push_back(COLUMN_ROUTE | dest);
+            return;
+        }
+    }
+    RoutePool::Handle handle = m_routePool.Allocate(route);
+    NS_ASSERT(handle < COLUMN_ROUTE);
+    m_hostRoutes.push_back(handle);
+    m_nPooledHostRoutes++;
 }
 
-void
-OSPFRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
+DijkstraRIE*
+OSPFRouting::GetColumnRoute(uint32_t dest, uint32_t iface) const
 {
-    NS_LOG_FUNCTION(this << dest << interface);
-    auto route = new DijkstraRIE();
-    *route = DijkstraRIE::CreateHostRouteTo(dest, interface);
-    m_hostRoutes.push_back(route);
+    Ipv4Address address = AddressInterner::Get()->GetAddress(dest);
+    if (m_hostRouteView.GetDest() != address || m_hostRouteView.GetInterface() != iface)
+    {
+        m_hostRouteView = DijkstraRIE::CreateHostRouteTo(address, iface);
+    }
+    return &m_hostRouteView;
 }
 
-void
-OSPFRouting::AddNetworkRouteTo(Ipv4Address network,
-                               Ipv4Mask networkMask,
-                               Ipv4Address nextHop,
-                               uint32_t interface)
+DijkstraRIE
+OSPFRouting::MakeHostRoute(Ipv4Address dest,
+                           Ipv4Address nextHop,
+                           uint32_t interface,
+                           uint32_t nextIface,
+                           uint32_t distance)
 {
-    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
-    auto route = new DijkstraRIE();
-    *route = DijkstraRIE::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
-    m_networkRoutes.push_back(route);
+    return DijkstraRIE::CreateHostRouteTo(dest, interface);
 }
 
-void
-OSPFRouting::AddHostRouteTo(Ipv4Address dest,
-                            Ipv4Address nextHop,
-                            uint32_t interface,
-                            uint32_t nextIface,
-                            uint32_t distance)
+uint32_t
+OSPFRouting::GetNHostRoutes() const
 {
-    NS_LOG_FUNCTION(this << dest << nextHop << interface << nextIface << distance);
-    AddHostRouteTo(dest, interface);
+    return m_hostRoutes.size();
 }
 
-void
-OSPFRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface)
+DijkstraRIE*
+OSPFRouting::GetHostRoute(uint32_t index) const
 {
-    NS_LOG_FUNCTION(this << network << networkMask << interface);
-    auto route = new DijkstraRIE();
-    *route = DijkstraRIE::CreateNetworkRouteTo(network, networkMask, interface);
-    m_networkRoutes.push_back(route);
+    uint32_t ref = m_hostRoutes[index];
+    if (ref & COLUMN_ROUTE)
+    {
+        uint32_t dest = ref & ~COLUMN_ROUTE;
+        return GetColumnRoute(dest, NextHopColumns::Get()->Find(dest, m_columnNode));
+    }
+    return m_routePool.Get(ref);
 }
 
 void
-OSPFRouting::AddASExternalRouteTo(Ipv4Address network,
-                                  Ipv4Mask networkMask,
-                                  Ipv4Address nextHop,
-                                  uint32_t interface)
-{
-    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
-    auto route = new DijkstraRIE();
-    *route = DijkstraRIE::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
-    m_ASexternalRoutes.push_back(route);
-}
-
-uint32_t
-OSPFRouting::GetNRoutes() const
+OSPFRouting::RemoveHostRoute(uint32_t index)
 {
-    NS_LOG_FUNCTION(this);
-    uint32_t n = 0;
-    n += m_hostRoutes.size();
-    n += m_networkRoutes.size();
-    n += m_ASexternalRoutes.size();
-    return n;
+    NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
+    uint32_t ref = m_hostRoutes[index];
+    if (ref & COLUMN_ROUTE)
+    {
+        NextHopColumns::Get()->Clear(ref & ~COLUMN_ROUTE, m_columnNode);
+    }
+    else
+    {
+        m_routePool.Free(ref);
+        m_nPooledHostRoutes--;
+    }
+    m_hostRoutes.erase(m_hostRoutes.begin() + index);
+    NS_LOG_LOGIC("Done removing host route "
+                 << index << "; host route remaining size = " << m_hostRoutes.size());
 }
 
-DijkstraRIE*
-OSPFRouting::GetRoute(uint32_t index) const
+void
+OSPFRouting::ClearHostRoutes()
 {
-    NS_LOG_FUNCTION(this << index);
-    if (index < m_hostRoutes.size())
-    {
-        uint32_t tmp = 0;
-        for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
-        {
-            if (tmp == index)
-            {
-                return *i;
-            }
-            tmp++;
-        }
-    }
-    index -= m_hostRoutes.size();
-    uint32_t tmp = 0;
-    if (index < m_networkRoutes.size())
+    if (m_nPooledHostRoutes < m_hostRoutes.size())
     {
-        for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+        NextHopColumns* columns = NextHopColumns::Get();
+        for (uint32_t ref : m_hostRoutes)
         {
-            if (tmp == index)
+            if (ref & COLUMN_ROUTE)
             {
-                return *j;
+                columns->Clear(ref & ~COLUMN_ROUTE, m_columnNode);
             }
-            tmp++;
-        }
-    }
-    index -= m_networkRoutes.size();
-    tmp = 0;
-    for (auto k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
-    {
-        if (tmp == index)
-        {
-            return *k;
         }
-        tmp++;
     }
-    NS_ASSERT(false);
-    // quiet compiler.
-    return nullptr;
+    m_hostRoutes.clear();
+    m_routePool.Clear();
+    m_nPooledHostRoutes = 0;
 }
 
 void
-OSPFRouting::RemoveRoute(uint32_t index)
+OSPFRouting::NotifyRoutesChanged()
+{
+    m_routeGeneration++;
+}
+
+std::size_t
+OSPFRouting::GetMemoryFootprint() const
 {
-    NS_LOG_FUNCTION(this << index);
-    if (index < m_hostRoutes.size())
+    std::size_t bytes = m_routePool.GetMemoryUsage() + GetPrefixRouteFootprint() +
+                        m_flowCache.GetMemoryUsage() +
+                        m_floodingDb.size() * sizeof(FloodingDb::value_type) +
+                        m_floodedSpf.GetMemoryUsage();
+    if (m_nPooledHostRoutes == m_hostRoutes.size())
     {
-        uint32_t tmp = 0;
-        for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
-        {
-            if (tmp == index)
-            {
-                NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
-                delete *i;
-                m_hostRoutes.erase(i);
-                NS_LOG_LOGIC("Done removing host route "
-                             << index << "; host route remaining size = " << m_hostRoutes.size());
-                return;
-            }
-            tmp++;
-        }
+        return bytes + GetRouteTableFootprint(m_hostRoutes, m_routePool);
     }
-    index -= m_hostRoutes.size();
-    uint32_t tmp = 0;
-    for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    bytes += m_hostRoutes.capacity() * sizeof(RoutePool::Handle);
+    for (uint32_t ref : m_hostRoutes)
     {
-        if (tmp == index)
+        // a route of the columns takes the slot of the node in its column
+        if (ref & COLUMN_ROUTE)
         {
-            NS_LOG_LOGIC("Removing route " << index << "; size = " << m_networkRoutes.size());
-            delete *j;
-            m_networkRoutes.erase(j);
-            NS_LOG_LOGIC("Done removing network route "
-                         << index << "; network route remaining size = " << m_networkRoutes.size());
-            return;
+            bytes += sizeof(uint16_t);
         }
-        tmp++;
-    }
-    index -= m_networkRoutes.size();
-    tmp = 0;
-    for (auto k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
-    {
-        if (tmp == index)
+        else if (m_routePool.Get(ref)->HasCachedRoute())
         {
-            NS_LOG_LOGIC("Removing route " << index << "; size = " << m_ASexternalRoutes.size());
-            delete *k;
-            m_ASexternalRoutes.erase(k);
-            NS_LOG_LOGIC("Done removing network route "
-                         << index << "; network route remaining size = " << m_networkRoutes.size());
-            return;
+            bytes += sizeof(Ipv4Route);
         }
-        tmp++;
     }
-    NS_ASSERT(false);
+    return bytes;
 }
 
 int64_t
@@ -454,84 +481,94 @@ OSPFRouting::AssignStreams(int64_t stream)
 }
 
 Ptr<Ipv4Route>
-OSPFRouting::LookupRoute(Ipv4Address dest, Ptr<NetDevice> oif) const
+OSPFRouting::LookupRoute(Ipv4Address dest,
+                         Ptr<NetDevice> oif,
+                         uint32_t flowHash,
+                         uint32_t flowlet) const
 {
-    NS_LOG_FUNCTION(this << dest << oif);
-    NS_LOG_LOGIC("Looking for route for destination " << dest);
+    ROMAM_HOT_LOG_FUNCTION(this << dest << oif << flowHash << flowlet);
+    ROMAM_HOT_LOG_LOGIC("Looking for route for destination " << dest);
     Ptr<Ipv4Route> rtentry = nullptr;
     // store all available routes that bring packets to their destination
     typedef std::vector<DijkstraRIE*> RouteVec_t;
     RouteVec_t allRoutes;
+    uint32_t outputIface = GetCachedInterfaceIndex(m_ipv4, oif);
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    ROMAM_HOT_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
+    uint32_t destIndex = AddressInterner::NO_INDEX;
+    uint32_t columnIface = NextHopColumns::NO_IFACE;
+    if (m_nPooledHostRoutes < m_hostRoutes.size())
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        destIndex = AddressInterner::Get()->FindAddress(dest);
+        columnIface = NextHopColumns::Get()->Find(destIndex, m_columnNode);
+    }
+    if (m_nPooledHostRoutes == 0)
+    {
+        // every host route is in the columns, the one to dest is a single read
+        if (columnIface != NextHopColumns::NO_IFACE)
         {
-            if (oif)
+            CountLookup(RoutingStats::CANDIDATES_SCANNED);
+            if (!oif || columnIface == outputIface)
             {
-                if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
+                allRoutes.push_back(GetColumnRoute(destIndex, columnIface));
             }
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << *i);
         }
     }
-    if (allRoutes.empty()) // if no host route is found
+    for (uint32_t i = 0; m_nPooledHostRoutes > 0 && i < m_hostRoutes.size(); i++)
     {
-        NS_LOG_LOGIC("Number of m_networkRoutes" << m_networkRoutes.size());
-        for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+        // the routes of the columns keep their rank among the pooled ones
+        uint32_t ref = m_hostRoutes[i];
+        DijkstraRIE* route = nullptr;
+        if (!(ref & COLUMN_ROUTE))
+        {
+            route = m_routePool.Get(ref);
+        }
+        else if ((ref & ~COLUMN_ROUTE) == destIndex)
         {
-            Ipv4Mask mask = (*j)->GetDestNetworkMask();
-            Ipv4Address entry = (*j)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
+            route = GetColumnRoute(destIndex, columnIface);
+        }
+        else
+        {
+            continue;
+        }
+        NS_ASSERT(route->IsHost());
+        if (route->GetDest() == dest)
+        {
+            CountLookup(RoutingStats::CANDIDATES_SCANNED);
+            if (oif && route->GetInterface() != outputIface)
             {
-                if (oif)
-                {
-                    if (oif != m_ipv4->GetNetDevice((*j)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
-                }
-                allRoutes.push_back(*j);
-                NS_LOG_LOGIC(allRoutes.size() << "Found global network route" << *j);
+                ROMAM_HOT_LOG_LOGIC("Not on requested interface, skipping");
+                continue;
             }
+            allRoutes.push_back(route);
+            ROMAM_HOT_LOG_LOGIC(allRoutes.size() << "Found global host route" << route);
         }
     }
-    if (allRoutes.empty()) // consider external if no host/network found
+    if (allRoutes.empty()) // no host route, fall back to the matching prefixes
     {
-        for (auto k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
-        {
-            Ipv4Mask mask = (*k)->GetDestNetworkMask();
-            Ipv4Address entry = (*k)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
+        // skip the routes that are not on the requested interface
+        auto onRequestedInterface = [oif, outputIface](DijkstraRIE* route) {
+            if (oif && route->GetInterface() != outputIface)
             {
-                NS_LOG_LOGIC("Found external route" << *k);
-                if (oif)
-                {
-                    if (oif != m_ipv4->GetNetDevice((*k)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
-                }
-                allRoutes.push_back(*k);
-                break;
+                ROMAM_HOT_LOG_LOGIC("Not on requested interface, skipping");
+                return false;
             }
-        }
+            return true;
+        };
+        LookupPrefixRoutes(dest, onRequestedInterface, allRoutes);
     }
     if (!allRoutes.empty()) // if route(s) is found
     {
-        // pick up one of the routes uniformly at random if random
+        // pick up the route the flow hashes to if flow hash ECMP routing
+        // is enabled, one of the routes uniformly at random if random
         // ECMP routing is enabled, or always select the first route
-        // consistently if random ECMP routing is disabled
+        // consistently if ECMP routing is disabled
         uint32_t selectIndex;
-        if (m_randomEcmpRouting)
+        if (m_flowHashEcmpRouting)
+        {
+            selectIndex = FlowCache::Select(flowHash, flowlet, allRoutes.size());
+        }
+        else if (m_randomEcmpRouting)
         {
             selectIndex = m_rand->GetInteger(0, allRoutes.size() - 1);
         }
@@ -541,13 +578,7 @@ OSPFRouting::LookupRoute(Ipv4Address dest, Ptr<NetDevice> oif) const
         }
         DijkstraRIE* route = allRoutes.at(selectIndex);
         // create a Ipv4Route object from the selected routing table entry
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(route->GetInterface(), 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        uint32_t interfaceIdx = route->GetInterface();
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+        rtentry = GetIpv4Route(route, m_ipv4);
         return rtentry;
     }
     else
@@ -556,10 +587,637 @@ OSPFRouting::LookupRoute(Ipv4Address dest, Ptr<NetDevice> oif) const
     }
 }
 
+Ptr<Ipv4Route>
+OSPFRouting::LookupFlowRoute(const Ipv4Header& header,
+                             Ptr<const Packet> p,
+                             Ptr<NetDevice> oif) const
+{
+    uint32_t hash = FlowCache::HashFlow(header, p);
+    Ipv4Address dest = header.GetDestination();
+    if (oif)
+    {
+        // the decisions of the cache are taken on all the interfaces
+        return LookupRoute(dest, oif, hash);
+    }
+    uint32_t flowlet;
+    Ptr<Ipv4Route> rtentry = m_flowCache.Lookup(hash, dest, m_routeGeneration, flowlet);
+    if (rtentry)
+    {
+        ROMAM_HOT_LOG_LOGIC("Found the route of flow " << hash << " in the flow cache");
+        return rtentry;
+    }
+    rtentry = LookupRoute(dest, nullptr, hash, flowlet);
+    if (rtentry)
+    {
+        m_flowCache.Insert(hash, dest, m_routeGeneration, flowlet, rtentry);
+    }
+    return rtentry;
+}
+
+void
+OSPFRouting::SetFlowCacheSize(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    m_flowCache.SetSize(size);
+}
+
+uint32_t
+OSPFRouting::GetFlowCacheSize() const
+{
+    return m_flowCache.GetSize();
+}
+
+void
+OSPFRouting::SetFlowletGap(Time gap)
+{
+    NS_LOG_FUNCTION(this << gap);
+    m_flowletGap = gap;
+    m_flowCache.SetFlowletGap(gap);
+}
+
+Time
+OSPFRouting::GetFlowletGap() const
+{
+    return m_flowletGap;
+}
+
+OSPFRouting::LsaKey
+OSPFRouting::GetLsaKey(const LSA* lsa)
+{
+    return LsaKey(lsa->GetLSType(),
+                  lsa->GetLinkStateId().Get(),
+                  lsa->GetAdvertisingRouter().Get());
+}
+
+void
+OSPFRouting::InitializeFloodingSockets()
+{
+    NS_LOG_FUNCTION(this);
+    Ptr<Node> theNode = m_ipv4->GetObject<Node>();
+    TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
+    for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+    {
+        if (DynamicCast<LoopbackNetDevice>(m_ipv4->GetNetDevice(i)) || GetInterfaceSocket(i))
+        {
+            continue;
+        }
+        for (uint32_t j = 0; j < m_ipv4->GetNAddresses(i); j++)
+        {
+            Ipv4InterfaceAddress address = m_ipv4->GetAddress(i, j);
+            if (address.GetScope() == Ipv4InterfaceAddress::HOST)
+            {
+                continue;
+            }
+            NS_LOG_LOGIC("OSPF: add socket to " << address.GetLocal());
+            Ptr<Socket> socket = Socket::CreateSocket(theNode, tid);
+            socket->BindToNetDevice(m_ipv4->GetNetDevice(i));
+            int ret = socket->Bind(InetSocketAddress(address.GetLocal(), OSPF_PORT));
+            NS_ASSERT_MSG(ret == 0, "Bind unsuccessful");
+            socket->SetRecvCallback(MakeCallback(&OSPFRouting::Receive, this));
+            socket->SetRecvPktInfo(true);
+            if (i >= m_interfaceSockets.size())
+            {
+                m_interfaceSockets.resize(i + 1);
+            }
+            m_interfaceSockets[i] = socket;
+            break;
+        }
+    }
+
+    if (!m_multicastRecvSocket)
+    {
+        NS_LOG_LOGIC("OSPF: adding receiving socket");
+        m_multicastRecvSocket = Socket::CreateSocket(theNode, tid);
+        m_multicastRecvSocket->Bind(InetSocketAddress(OSPF_ALL_SPF_ROUTERS, OSPF_PORT));
+        m_multicastRecvSocket->SetRecvCallback(MakeCallback(&OSPFRouting::Receive, this));
+        m_multicastRecvSocket->SetRecvPktInfo(true);
+    }
+}
+
+Ptr<Socket>
+OSPFRouting::GetInterfaceSocket(uint32_t interface) const
+{
+    return interface < m_interfaceSockets.size() ? m_interfaceSockets[interface] : nullptr;
+}
+
+OSPFRouting::FloodingNeighbor&
+OSPFRouting::GetFloodingNeighbor(uint32_t interface)
+{
+    if (interface >= m_floodingNeighbors.size())
+    {
+        uint32_t n = m_floodingNeighbors.size();
+        m_floodingNeighbors.resize(interface + 1);
+        for (; n <= interface; n++)
+        {
+            m_floodingNeighbors[n].fsm.SetDeadInterval(m_routerDeadInterval);
+        }
+    }
+    return m_floodingNeighbors[interface];
+}
+
+Ipv4Address
+OSPFRouting::GetFloodingRouterId() const
+{
+    Ptr<RomamRouter> rtr = m_ipv4->GetObject<Node>()->GetObject<RomamRouter>();
+    NS_ABORT_MSG_IF(!rtr, "OSPFRouting: the node has no router");
+    return rtr->GetRouterId();
+}
+
+void
+OSPFRouting::ScheduleOrigination()
+{
+    if (m_multicastRecvSocket && !m_originateEvent.IsRunning())
+    {
+        m_originateEvent = Simulator::ScheduleNow(&OSPFRouting::OriginateLSAs, this);
+    }
+}
+
+void
+OSPFRouting::OriginateLSAs()
+{
+    NS_LOG_FUNCTION(this);
+    Ptr<RomamRouter> rtr = m_ipv4->GetObject<Node>()->GetObject<RomamRouter>();
+    Ipv4Address routerId = GetFloodingRouterId();
+    rtr->DiscoverLSAs();
+
+    bool changed = false;
+    std::set<LsaKey> originated;
+    for (uint32_t j = 0; j < rtr->GetNumLSAs(); j++)
+    {
+        Ptr<LSA> discovered = rtr->GetLSA(j);
+        LsaKey key = GetLsaKey(PeekPointer(discovered));
+        originated.insert(key);
+        auto found = m_floodingDb.find(key);
+        if (found != m_floodingDb.end() && !found->second.withdrawn &&
+            found->second.lsa->IsSameAdvertisement(*discovered))
+        {
+            continue;
+        }
+        // the LSA of the router is shared with the global LSDB, which stamps
+        // its own sequence numbers on what it holds
+        LsuEntry entry;
+        entry.lsa = Create<LSA>();
+        *entry.lsa = *discovered;
+        entry.seq = found != m_floodingDb.end() ? found->second.seq + 1 : 1;
+        entry.withdrawn = false;
+        m_floodingDb[key] = entry;
+        FloodLsa(key, m_interfaceSockets.size());
+        changed = true;
+    }
+    for (auto i = m_floodingDb.begin(); i != m_floodingDb.end(); i++)
+    {
+        if (std::get<2>(i->first) == routerId.Get() && !i->second.withdrawn &&
+            originated.count(i->first) == 0)
+        {
+            NS_LOG_LOGIC("Withdrawing LSA " << i->second.lsa->GetLinkStateId());
+            i->second.seq++;
+            i->second.withdrawn = true;
+            FloodLsa(i->first, m_interfaceSockets.size());
+            changed = true;
+        }
+    }
+    if (changed)
+    {
+        ScheduleFloodedSpf();
+    }
+}
+
+void
+OSPFRouting::SynchronizeNeighbor(uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << interface);
+    if (!GetInterfaceSocket(interface) || m_floodingDb.empty())
+    {
+        return;
+    }
+    FloodingNeighbor& neighbor = GetFloodingNeighbor(interface);
+    for (auto i = m_floodingDb.begin(); i != m_floodingDb.end(); i++)
+    {
+        neighbor.pendingLsas.insert(i->first);
+    }
+    if (!m_floodEvent.IsRunning())
+    {
+        m_floodEvent = Simulator::ScheduleNow(&OSPFRouting::SendPendingLsus, this);
+    }
+}
+
+void
+OSPFRouting::FloodLsa(const LsaKey& key, uint32_t except)
+{
+    for (uint32_t i = 0; i < m_interfaceSockets.size(); i++)
+    {
+        FloodingNeighbor& neighbor = GetFloodingNeighbor(i);
+        if (i != except && m_interfaceSockets[i] &&
+            neighbor.fsm.GetState() >= NeighborFsm::EXCHANGE)
+        {
+            neighbor.pendingLsas.insert(key);
+        }
+    }
+    // the LSAs flooded by the same event share the LSUs
+    if (!m_floodEvent.IsRunning())
+    {
+        m_floodEvent = Simulator::ScheduleNow(&OSPFRouting::SendPendingLsus, this);
+    }
+}
+
+void
+OSPFRouting::SendPendingLsus()
+{
+    NS_LOG_FUNCTION(this);
+    EventAccounting::Scope scope(EventAccounting::LINK_STATE);
+    for (uint32_t i = 0; i < m_floodingNeighbors.size(); i++)
+    {
+        FloodingNeighbor& neighbor = m_floodingNeighbors[i];
+        if (!neighbor.pendingLsas.empty())
+        {
+            std::vector<LsaKey> keys(neighbor.pendingLsas.begin(), neighbor.pendingLsas.end());
+            neighbor.pendingLsas.clear();
+            SendLsus(i, keys);
+        }
+    }
+}
+
+void
+OSPFRouting::SendLsus(uint32_t interface, const std::vector<LsaKey>& keys)
+{
+    NS_LOG_FUNCTION(this << interface << keys.size());
+    FloodingNeighbor& neighbor = GetFloodingNeighbor(interface);
+    uint32_t limit = m_ipv4->GetMtu(interface) - OSPF_UDP_IP_HEADERS;
+    LsuHeader hdr;
+    for (auto i = keys.begin(); i != keys.end(); i++)
+    {
+        auto found = m_floodingDb.find(*i);
+        if (found == m_floodingDb.end())
+        {
+            continue;
+        }
+        const LsuEntry& entry = found->second;
+        if (hdr.GetNEntries() > 0 &&
+            (hdr.GetSerializedSize() + LsuHeader::GetLsaSize(entry) > limit ||
+             hdr.GetNEntries() == LsuHeader::MAX_ENTRIES))
+        {
+            SendFloodingPacket(interface, hdr);
+            hdr.SetCommand(LsuHeader::LSU);
+        }
+        hdr.AddLsa(entry);
+        neighbor.retransmit[*i] = entry.seq;
+    }
+    if (hdr.GetNEntries() > 0)
+    {
+        SendFloodingPacket(interface, hdr);
+    }
+    if (!neighbor.retransmit.empty() && !m_timerWheel->IsPending(m_retransmitTimer))
+    {
+        m_retransmitTimer =
+            m_timerWheel->Schedule(m_retransmitInterval,
+                                   MakeCallback(&OSPFRouting::RetransmitLsas, this));
+    }
+}
+
+void
+OSPFRouting::RetransmitLsas()
+{
+    NS_LOG_FUNCTION(this);
+    for (uint32_t i = 0; i < m_floodingNeighbors.size(); i++)
+    {
+        FloodingNeighbor& neighbor = m_floodingNeighbors[i];
+        if (neighbor.retransmit.empty())
+        {
+            continue;
+        }
+        std::vector<LsaKey> keys;
+        keys.reserve(neighbor.retransmit.size());
+        for (auto j = neighbor.retransmit.begin(); j != neighbor.retransmit.end(); j++)
+        {
+            keys.push_back(j->first);
+        }
+        SendLsus(i, keys);
+    }
+}
+
+void
+OSPFRouting::QueueAck(uint32_t interface, const LsuSummary& lsa)
+{
+    LsAckEntry ack;
+    ack.type = lsa.type;
+    ack.linkStateId = lsa.linkStateId;
+    ack.advertisingRouter = lsa.advertisingRouter;
+    ack.seq = lsa.seq;
+    GetFloodingNeighbor(interface).pendingAcks.push_back(ack);
+    if (!m_ackEvent.IsRunning())
+    {
+        m_ackEvent = Simulator::Schedule(m_ackDelay, &OSPFRouting::SendPendingAcks, this);
+    }
+}
+
+void
+OSPFRouting::SendPendingAcks()
+{
+    NS_LOG_FUNCTION(this);
+    EventAccounting::Scope scope(EventAccounting::LINK_STATE);
+    for (uint32_t i = 0; i < m_floodingNeighbors.size(); i++)
+    {
+        std::vector<LsAckEntry>& acks = m_floodingNeighbors[i].pendingAcks;
+        if (acks.empty() || !GetInterfaceSocket(i))
+        {
+            acks.clear();
+            continue;
+        }
+        uint32_t limit = m_ipv4->GetMtu(i) - OSPF_UDP_IP_HEADERS;
+        LsuHeader hdr;
+        hdr.SetCommand(LsuHeader::LSACK);
+        for (auto j = acks.begin(); j != acks.end(); j++)
+        {
+            if (hdr.GetNEntries() > 0 &&
+                (hdr.GetSerializedSize() + LsuHeader::GetAckSize() > limit ||
+                 hdr.GetNEntries() == LsuHeader::MAX_ENTRIES))
+            {
+                SendFloodingPacket(i, hdr);
+                hdr.SetCommand(LsuHeader::LSACK);
+            }
+            hdr.AddAck(*j);
+        }
+        SendFloodingPacket(i, hdr);
+        acks.clear();
+    }
+}
+
+void
+OSPFRouting::SendFloodingPacket(uint32_t interface, const LsuHeader& hdr)
+{
+    Ptr<Socket> socket = GetInterfaceSocket(interface);
+    if (!socket)
+    {
+        return;
+    }
+    Ptr<Packet> p = Create<Packet>();
+    SocketIpTtlTag ttlTag;
+    ttlTag.SetTtl(1);
+    p->AddPacketTag(ttlTag);
+    p->AddHeader(hdr);
+    NS_LOG_LOGIC("Sending " << hdr << " on interface " << interface);
+    m_floodingTxTrace(hdr.GetCommand(), hdr.GetNEntries(), p->GetSize());
+    socket->SendTo(p, 0, InetSocketAddress(OSPF_ALL_SPF_ROUTERS, OSPF_PORT));
+}
+
+void
+OSPFRouting::Receive(Ptr<Socket> socket)
+{
+    NS_LOG_FUNCTION(this << socket);
+    EventAccounting::Scope scope(EventAccounting::LINK_STATE);
+    Address sender;
+    Ptr<Packet> packet = socket->RecvFrom(sender);
+    Ipv4Address senderAddress = InetSocketAddress::ConvertFrom(sender).GetIpv4();
+    if (m_ipv4->GetInterfaceForAddress(senderAddress) != -1)
+    {
+        NS_LOG_LOGIC("Ignoring a packet sent by myself.");
+        return;
+    }
+    Ipv4PacketInfoTag interfaceInfo;
+    if (!packet->RemovePacketTag(interfaceInfo))
+    {
+        NS_ABORT_MSG("No incoming interface on This message, aborting,");
+    }
+    uint32_t incomingIf = m_ipv4->GetInterfaceForDevice(
+        m_ipv4->GetObject<Node>()->GetDevice(interfaceInfo.GetRecvIf()));
+
+    LsuHeader hdr;
+    if (packet->RemoveHeader(hdr) == 0)
+    {
+        NS_LOG_LOGIC("Ignoring a malformed packet from " << senderAddress);
+        return;
+    }
+    if (hdr.GetCommand() == LsuHeader::HELLO)
+    {
+        HandleHello(hdr, incomingIf);
+    }
+    else if (GetFloodingNeighbor(incomingIf).fsm.GetState() < NeighborFsm::EXCHANGE)
+    {
+        NS_LOG_LOGIC("Ignoring " << hdr << " from a neighbor with no adjacency");
+    }
+    else if (hdr.GetCommand() == LsuHeader::LSU)
+    {
+        HandleLsu(hdr, incomingIf);
+    }
+    else
+    {
+        HandleLsAck(hdr, incomingIf);
+    }
+}
+
+void
+OSPFRouting::HandleLsu(const LsuHeader& hdr, uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << interface << hdr.GetNEntries());
+    Ipv4Address routerId = GetFloodingRouterId();
+    FloodingNeighbor& neighbor = GetFloodingNeighbor(interface);
+    bool changed = false;
+    // only the instances kept are decoded
+    const std::vector<LsuSummary>& lsas = hdr.GetLsaSummaries();
+    for (uint32_t n = 0; n < lsas.size(); n++)
+    {
+        const LsuSummary& lsa = lsas[n];
+        LsaKey key(lsa.type, lsa.linkStateId.Get(), lsa.advertisingRouter.Get());
+        auto found = m_floodingDb.find(key);
+        if (found != m_floodingDb.end() && lsa.seq < found->second.seq)
+        {
+            // the neighbor holds an older instance, it gets the current one
+            neighbor.pendingLsas.insert(key);
+            if (!m_floodEvent.IsRunning())
+            {
+                m_floodEvent = Simulator::ScheduleNow(&OSPFRouting::SendPendingLsus, this);
+            }
+            continue;
+        }
+        if (found != m_floodingDb.end() && lsa.seq == found->second.seq)
+        {
+            // a duplicate acknowledges the instance the neighbor was sent
+            auto pending = neighbor.retransmit.find(key);
+            if (pending != neighbor.retransmit.end() && pending->second == lsa.seq)
+            {
+                neighbor.retransmit.erase(pending);
+            }
+            else
+            {
+                QueueAck(interface, lsa);
+            }
+            continue;
+        }
+        QueueAck(interface, lsa);
+        if (lsa.advertisingRouter == routerId)
+        {
+            // an instance of ours from before, which a newer one supersedes
+            LsuEntry entry = found != m_floodingDb.end() ? found->second : hdr.DecodeLsa(n);
+            entry.seq = lsa.seq + 1;
+            entry.withdrawn = found == m_floodingDb.end() || found->second.withdrawn;
+            m_floodingDb[key] = entry;
+            FloodLsa(key, m_interfaceSockets.size());
+            continue;
+        }
+        m_floodingDb[key] = hdr.DecodeLsa(n);
+        neighbor.retransmit.erase(key);
+        FloodLsa(key, interface);
+        changed = true;
+    }
+    if (changed)
+    {
+        ScheduleFloodedSpf();
+    }
+    CheckExchangeDone(interface);
+}
+
+void
+OSPFRouting::HandleLsAck(const LsuHeader& hdr, uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << interface << hdr.GetNEntries());
+    FloodingNeighbor& neighbor = GetFloodingNeighbor(interface);
+    const std::vector<LsAckEntry>& acks = hdr.GetAcks();
+    for (auto i = acks.begin(); i != acks.end(); i++)
+    {
+        LsaKey key(i->type, i->linkStateId.Get(), i->advertisingRouter.Get());
+        auto pending = neighbor.retransmit.find(key);
+        if (pending != neighbor.retransmit.end() && pending->second == i->seq)
+        {
+            neighbor.retransmit.erase(pending);
+        }
+    }
+    CheckExchangeDone(interface);
+}
+
+void
+OSPFRouting::SendHellos()
+{
+    NS_LOG_FUNCTION(this);
+    EventAccounting::Scope scope(EventAccounting::LINK_STATE);
+    Ipv4Address routerId = GetFloodingRouterId();
+    for (uint32_t i = 0; i < m_interfaceSockets.size(); i++)
+    {
+        if (!m_interfaceSockets[i] || !m_ipv4->IsUp(i))
+        {
+            continue;
+        }
+        FloodingNeighbor& neighbor = GetFloodingNeighbor(i);
+        if (neighbor.fsm.IsInactive(Simulator::Now()))
+        {
+            NS_LOG_LOGIC("Neighbor " << neighbor.routerId << " of interface " << i << " is dead");
+            DispatchNeighborEvent(i, NeighborFsm::INACTIVITY_TIMER);
+        }
+        LsuHeader hdr;
+        hdr.SetCommand(LsuHeader::HELLO);
+        hdr.SetRouterId(routerId);
+        if (neighbor.fsm.GetState() != NeighborFsm::DOWN)
+        {
+            hdr.AddNeighbor(neighbor.routerId);
+        }
+        SendFloodingPacket(i, hdr);
+    }
+    m_helloTimer =
+        m_timerWheel->Schedule(m_helloInterval, MakeCallback(&OSPFRouting::SendHellos, this));
+}
+
+void
+OSPFRouting::HandleHello(const LsuHeader& hdr, uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << interface << hdr.GetRouterId());
+    GetFloodingNeighbor(interface).routerId = hdr.GetRouterId();
+    DispatchNeighborEvent(interface, NeighborFsm::HELLO_RECEIVED);
+    const std::vector<Ipv4Address>& heard = hdr.GetNeighbors();
+    if (std::find(heard.begin(), heard.end(), GetFloodingRouterId()) == heard.end())
+    {
+        DispatchNeighborEvent(interface, NeighborFsm::ONE_WAY_RECEIVED);
+        return;
+    }
+    DispatchNeighborEvent(interface, NeighborFsm::TWO_WAY_RECEIVED);
+    if (GetFloodingNeighbor(interface).fsm.GetState() == NeighborFsm::EXSTART)
+    {
+        // a point-to-point adjacency has no database description to negotiate
+        DispatchNeighborEvent(interface, NeighborFsm::NEGOTIATION_DONE);
+    }
+}
+
+void
+OSPFRouting::DispatchNeighborEvent(uint32_t interface, NeighborFsm::Event event)
+{
+    FloodingNeighbor& neighbor = GetFloodingNeighbor(interface);
+    NeighborFsm::State previous = neighbor.fsm.GetState();
+    NeighborFsm::Action action = neighbor.fsm.Dispatch(event, Simulator::Now());
+    if (neighbor.fsm.GetState() != previous)
+    {
+        NS_LOG_LOGIC("Neighbor " << neighbor.routerId << " of interface " << interface << ": "
+                                 << previous << " -> " << neighbor.fsm.GetState());
+        m_neighborStateTrace(interface, previous, neighbor.fsm.GetState());
+    }
+    switch (action)
+    {
+    case NeighborFsm::START_EXCHANGE:
+        SynchronizeNeighbor(interface);
+        CheckExchangeDone(interface);
+        break;
+    case NeighborFsm::CLEAR_ADJACENCY:
+    case NeighborFsm::NEIGHBOR_DOWN:
+        // the neighbor is gone, with what it had to acknowledge
+        neighbor.pendingLsas.clear();
+        neighbor.retransmit.clear();
+        neighbor.pendingAcks.clear();
+        break;
+    default:
+        break;
+    }
+}
+
+void
+OSPFRouting::CheckExchangeDone(uint32_t interface)
+{
+    FloodingNeighbor& neighbor = GetFloodingNeighbor(interface);
+    if (neighbor.fsm.GetState() == NeighborFsm::EXCHANGE && neighbor.pendingLsas.empty() &&
+        neighbor.retransmit.empty())
+    {
+        DispatchNeighborEvent(interface, NeighborFsm::EXCHANGE_DONE);
+        DispatchNeighborEvent(interface, NeighborFsm::LOADING_DONE);
+    }
+}
+
+void
+OSPFRouting::ScheduleFloodedSpf()
+{
+    if (!m_spfEvent.IsRunning())
+    {
+        m_spfEvent = Simulator::Schedule(m_spfDelay, &OSPFRouting::ComputeFloodedRoutes, this);
+    }
+}
+
+void
+OSPFRouting::ComputeFloodedRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    Ptr<LSDB> lsdb = Create<LSDB>();
+    uint32_t nLsas = 0;
+    for (auto i = m_floodingDb.begin(); i != m_floodingDb.end(); i++)
+    {
+        if (!i->second.withdrawn)
+        {
+            lsdb->Insert(i->second.lsa->GetLinkStateId(), i->second.lsa);
+            nLsas++;
+        }
+    }
+    m_floodedSpf.InsertLSDB(PeekPointer(lsdb));
+    m_floodedLsdb = lsdb;
+    m_floodedSpf.InitializeRoutes(GetFloodingRouterId());
+    m_floodedSpfTrace(nLsas);
+}
+
 void
 OSPFRouting::DoInitialize(void)
 {
     NS_LOG_FUNCTION(this);
+    if (m_distributedFlooding)
+    {
+        m_timerWheel = TimerWheel::GetWheel(m_ipv4->GetObject<Node>());
+        InitializeFloodingSockets();
+        ScheduleOrigination();
+        m_helloTimer = m_timerWheel->Schedule(Seconds(0),
+                                              MakeCallback(&OSPFRouting::SendHellos, this));
+    }
     // Initialize the routing protocol
     Ipv4RoutingProtocol::DoInitialize();
 }
@@ -568,21 +1226,46 @@ void
 OSPFRouting::DoDispose()
 {
     NS_LOG_FUNCTION(this);
-    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i = m_hostRoutes.erase(i))
+    ClearRoutes();
+    m_originateEvent.Cancel();
+    if (m_timerWheel)
     {
-        delete (*i);
+        m_timerWheel->Cancel(m_helloTimer);
+        m_timerWheel->Cancel(m_retransmitTimer);
+        m_timerWheel = nullptr;
     }
-    for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j = m_networkRoutes.erase(j))
+    m_floodEvent.Cancel();
+    m_ackEvent.Cancel();
+    m_spfEvent.Cancel();
+    for (auto i = m_interfaceSockets.begin(); i != m_interfaceSockets.end(); i++)
     {
-        delete (*j);
+        if (*i)
+        {
+            (*i)->Close();
+        }
     }
-    for (auto l = m_ASexternalRoutes.begin(); l != m_ASexternalRoutes.end();
-         l = m_ASexternalRoutes.erase(l))
+    m_interfaceSockets.clear();
+    if (m_multicastRecvSocket)
     {
-        delete (*l);
+        m_multicastRecvSocket->Close();
+        m_multicastRecvSocket = nullptr;
     }
+    m_floodingNeighbors.clear();
+    m_floodingDb.clear();
+    m_floodedLsdb = nullptr;
+    InvalidateInterfaceCache();
 
     Ipv4RoutingProtocol::DoDispose();
 }
 
 } // namespace ns3
+
+// the members of the core, logged under the component of the protocol
+#include "romam-routing-core-impl.h"
+
+namespace ns3
+{
+
+template class RomamRoutingCore<OSPFRouting, DijkstraRIE>;
+
+} // namespace ns3
@@ -3,17 +3,31 @@
 #ifndef OSPF_ROUTING_H
 #define OSPF_ROUTING_H
 
+#include "datapath/lsu-headers.h"
+#include "datapath/neighbor-fsm.h"
 #include "datapath/tsdb.h"
-#include "romam-routing.h"
+#include "romam-routing-core.h"
+#include "routing_algorithm/dijkstra-algorithm.h"
+#include "routing_algorithm/dijkstra-route-info-entry.h"
+#include "utility/flow-cache.h"
+#include "utility/route-entry-pool.h"
+#include "utility/timer-wheel.h"
 
+#include "ns3/event-id.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4.h"
+#include "ns3/nstime.h"
 #include "ns3/ptr.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
 
-#include <list>
+#include <map>
+#include <set>
 #include <stdint.h>
+#include <tuple>
+#include <vector>
 
 namespace ns3
 {
@@ -23,10 +37,41 @@ class NetDevice;
 class Ipv4Interface;
 class Ipv4Address;
 class Ipv4Header;
-class DijkstraRIE;
 class Node;
+class LSDB;
 
-class OSPFRouting : public RomamRouting
+/**
+ * \brief OSPF routing, from the routes RouteManager computes on the global
+ * LSDB, or from an LSDB of its own.
+ *
+ * With the DistributedFlooding attribute set, the node originates the LSAs
+ * of its router, floods them to its neighbors in Link State Updates (LSUs)
+ * and floods on the LSAs it learns, so every node builds its own LSDB; its
+ * routes are then computed from that LSDB, SpfDelay after it last changed.
+ * The LSAs flooded on an interface in one event are packed into as few LSUs
+ * as its MTU allows.  The LSAs sent to a neighbor stay on its retransmit
+ * list until it acknowledges them, and are sent again every
+ * RetransmitInterval; the acknowledgments are batched into one LSAck per
+ * interface, AckDelay after the first.
+ *
+ * The neighbor of an interface is the router at the other end of its
+ * point-to-point link, found by the Hellos sent every HelloInterval, and lost
+ * after RouterDeadInterval without one.  Its NeighborFsm drives the
+ * adjacency: once the Hellos are bidirectional the neighbor is sent all the
+ * LSAs of the node, and it is Full once it acknowledged them.  Only the
+ * neighbors in Exchange or above are flooded to and listened to.  The Hello
+ * and retransmit timers run on the TimerWheel of the node.
+ *
+ * With the RomamColumnHostRoutes global value set, the host routes without a
+ * gateway, which are all the routes Dijkstra installs to the routers, are
+ * kept in the NextHopColumns the nodes share, a 16-bit interface per
+ * destination and node, and the table only lists their destinations.  A
+ * lookup of a node whose other host routes all went there reads its
+ * interface from the column of the destination; the host routes with a
+ * gateway and the ECMP routes after the first one of a destination keep
+ * their entry.
+ */
+class OSPFRouting : public RomamRoutingCore<OSPFRouting, DijkstraRIE>
 {
   public:
     /**
@@ -46,22 +91,10 @@ class OSPFRouting : public RomamRouting
     ~OSPFRouting() override;
 
     // These methods inherited from Ipv4RoutingProtocol class
-    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
-                               const Ipv4Header& header,
-                               Ptr<NetDevice> oif,
-                               Socket::SocketErrno& sockerr) override;
-    bool RouteInput(Ptr<const Packet> p,
-                    const Ipv4Header& header,
-                    Ptr<const NetDevice> idev,
-                    const UnicastForwardCallback& ucb,
-                    const MulticastForwardCallback& mcb,
-                    const LocalDeliverCallback& lcb,
-                    const ErrorCallback& ecb) override;
     void NotifyInterfaceUp(uint32_t interface) override;
     void NotifyInterfaceDown(uint32_t interface) override;
     void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
     void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
-    void SetIpv4(Ptr<Ipv4> ipv4) override;
     void PrintRoutingTable(Ptr<OutputStreamWrapper> stream,
                            Time::Unit unit = Time::S) const override;
 
@@ -69,24 +102,7 @@ class OSPFRouting : public RomamRouting
     void DoInitialize(void) override;
 
     // These methods inherited from RomamRouting class
-    void AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface) override;
-    void AddHostRouteTo(Ipv4Address dest, uint32_t interface) override;
-    void AddHostRouteTo(Ipv4Address dest,
-                        Ipv4Address nextHop,
-                        uint32_t interface,
-                        uint32_t nextIface,
-                        uint32_t distance) override;
-    void AddNetworkRouteTo(Ipv4Address network,
-                           Ipv4Mask networkMask,
-                           Ipv4Address nextHop,
-                           uint32_t interface) override;
-    void AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface) override;
-    void AddASExternalRouteTo(Ipv4Address network,
-                              Ipv4Mask networkMask,
-                              Ipv4Address nextHop,
-                              uint32_t interface) override;
-    uint32_t GetNRoutes(void) const override;
-    void RemoveRoute(uint32_t i) override;
+    std::size_t GetMemoryFootprint() const override;
 
     /**
      * Assign a fixed random variable stream number to the random variables
@@ -98,55 +114,381 @@ class OSPFRouting : public RomamRouting
      */
     int64_t AssignStreams(int64_t stream);
 
-    DijkstraRIE* GetRoute(uint32_t i) const;
+    /**
+     * TracedCallback signature for an LSU, LSAck or Hello sent.
+     *
+     * \param [in] command the LsuHeader::Command of the packet
+     * \param [in] entries the number of LSAs or acknowledgments it carries
+     * \param [in] bytes the size of the packet
+     */
+    typedef void (*FloodingTxTracedCallback)(uint8_t command, uint32_t entries, uint32_t bytes);
+
+    /**
+     * TracedCallback signature for a computation of the routes from the LSDB
+     * of the node.
+     *
+     * \param [in] lsas the number of LSAs of the LSDB
+     */
+    typedef void (*FloodedSpfTracedCallback)(uint32_t lsas);
+
+    /**
+     * TracedCallback signature for a change of the state of a neighbor.
+     *
+     * \param [in] interface the interface of the neighbor
+     * \param [in] previous the NeighborFsm::State it left
+     * \param [in] state the NeighborFsm::State it entered
+     */
+    typedef void (*NeighborStateTracedCallback)(uint32_t interface,
+                                                uint8_t previous,
+                                                uint8_t state);
 
   protected:
     // These methods inherited from Objective class
     void DoDispose(void) override;
 
   private:
+    friend class RomamRoutingCore<OSPFRouting, DijkstraRIE>;
+
+    /**
+     * \brief Have the RouteManager recompute the routes of the network after
+     * an interface event, incrementally if the IncrementalUpdates attribute is
+     * set.  The events of a burst are coalesced into one recompute.
+     */
+    void RecomputeRoutes();
+
+    /**
+     * \param size the number of slots of the flow cache
+     */
+    void SetFlowCacheSize(uint32_t size);
+
+    /**
+     * \return the number of slots of the flow cache
+     */
+    uint32_t GetFlowCacheSize() const;
+
+    /**
+     * \param gap the idle time after which a flow may move to another route
+     */
+    void SetFlowletGap(Time gap);
+
+    /**
+     * \return the idle time after which a flow may move to another route
+     */
+    Time GetFlowletGap() const;
+
     /// Set to true if packets are randomly routed among ECMP; set to false for using only one route
     /// consistently
     bool m_randomEcmpRouting;
+    /// Set to true to route the packets of a flow on the ECMP route its 5-tuple hashes to
+    bool m_flowHashEcmpRouting;
+    /// the idle time after which a flow may move to another route, 0 to keep it on its route
+    Time m_flowletGap;
+    /// the ECMP decisions of the flows, checked before the tables
+    mutable FlowCache m_flowCache;
+    /// bumped on every change of the routes, which invalidates the decisions of m_flowCache
+    uint32_t m_routeGeneration;
     /// Set to true if this interface should respond to interface events by globallly recomputing
     /// routes
     bool m_respondToInterfaceEvents;
+    /// Set to true to update only the routes an interface event changes
+    bool m_incrementalUpdates;
+    /// the RomamColumnHostRoutes global value when the node was created
+    bool m_columnRoutes;
+    /// the node ID, the index of the node in the NextHopColumns, once a route went there
+    uint32_t m_columnNode;
     /// A uniform random number generator for randomly routing packets among ECMP
     Ptr<UniformRandomVariable> m_rand;
 
-    /// container of Ipv4RoutingTableEntry (routes to hosts)
-    typedef std::list<DijkstraRIE*> HostRoutes;
-    /// const iterator of container of Ipv4RoutingTableEntry (routes to hosts)
-    typedef std::list<DijkstraRIE*>::const_iterator HostRoutesCI;
-    /// iterator of container of Ipv4RoutingTableEntry (routes to hosts)
-    typedef std::list<DijkstraRIE*>::iterator HostRoutesI;
+    /// an LSA, by its type, link state ID and advertising router
+    typedef std::tuple<uint8_t, uint32_t, uint32_t> LsaKey;
+    /// the LSAs of the LSDB of the node, with their instance
+    typedef std::map<LsaKey, LsuEntry> FloodingDb;
+
+    /// the flooding state of the neighbor of an interface
+    struct FloodingNeighbor
+    {
+        std::set<LsaKey> pendingLsas;          //!< the LSAs to send in the next LSUs
+        std::map<LsaKey, uint32_t> retransmit; //!< the LSAs not acknowledged, to their seq
+        std::vector<LsAckEntry> pendingAcks;   //!< the acknowledgments of the next LSAck
+        NeighborFsm fsm;                       //!< the state of the adjacency
+        Ipv4Address routerId;                  //!< the router ID of the neighbor
+    };
+
+    /**
+     * \param lsa an LSA
+     * \return its key
+     */
+    static LsaKey GetLsaKey(const LSA* lsa);
+
+    /**
+     * \return the router ID of the router of the node
+     */
+    Ipv4Address GetFloodingRouterId() const;
+
+    /**
+     * \brief Create the sockets of the interfaces that have none.
+     */
+    void InitializeFloodingSockets();
+
+    /**
+     * \param interface an interface
+     * \return the socket of the interface, or null
+     */
+    Ptr<Socket> GetInterfaceSocket(uint32_t interface) const;
+
+    /**
+     * \brief Discover the LSAs of the router of the node again, and flood the
+     * ones that changed, with a new instance.
+     */
+    void OriginateLSAs();
+
+    /**
+     * \brief Have OriginateLSAs () run once the events of the current time
+     * are handled, if the flooding started.
+     */
+    void ScheduleOrigination();
+
+    /**
+     * \brief Queue all the LSAs of the LSDB for the neighbor of an interface
+     * whose database exchange starts.
+     * \param interface the interface
+     */
+    void SynchronizeNeighbor(uint32_t interface);
+
+    /**
+     * \brief Queue an LSA for the next LSUs of the interfaces.
+     * \param key the LSA
+     * \param except the interface not to send it on, the one it came from, or
+     * the number of sockets of the interfaces to send it on all of them
+     */
+    void FloodLsa(const LsaKey& key, uint32_t except);
+
+    /**
+     * \brief Send the LSAs queued on every interface, as LSUs.
+     */
+    void SendPendingLsus();
+
+    /**
+     * \brief Send the current instances of LSAs on an interface, packed into
+     * as few LSUs as its MTU allows, and put them on the retransmit list of
+     * its neighbor.
+     * \param interface the interface
+     * \param keys the LSAs
+     */
+    void SendLsus(uint32_t interface, const std::vector<LsaKey>& keys);
+
+    /**
+     * \brief Send the LSAs no neighbor acknowledged again.
+     */
+    void RetransmitLsas();
+
+    /**
+     * \brief Queue the acknowledgment of an LSA instance, for the next LSAck of
+     * an interface.
+     * \param interface the interface
+     * \param lsa the LSA instance
+     */
+    void QueueAck(uint32_t interface, const LsuSummary& lsa);
+
+    /**
+     * \brief Send the acknowledgments queued on every interface, as LSAcks.
+     */
+    void SendPendingAcks();
+
+    /**
+     * \brief Send an LSU or LSAck to the neighbor of an interface.
+     * \param interface the interface
+     * \param hdr the header
+     */
+    void SendFloodingPacket(uint32_t interface, const LsuHeader& hdr);
+
+    /**
+     * \brief Send a Hello on every interface, listing its neighbor if one was
+     * heard from, take down the neighbors whose dead interval expired, and
+     * schedule the next Hellos.
+     */
+    void SendHellos();
+
+    /**
+     * \brief Drive the adjacency of an interface by a Hello of its neighbor.
+     * \param hdr the Hello
+     * \param interface the interface it came from
+     */
+    void HandleHello(const LsuHeader& hdr, uint32_t interface);
+
+    /**
+     * \brief Have the neighbor of an interface handle an event, and run the
+     * part of the action of its transition on the adjacency.
+     * \param interface the interface
+     * \param event the event
+     */
+    void DispatchNeighborEvent(uint32_t interface, NeighborFsm::Event event);
 
-    /// container of Ipv4RoutingTableEntry (routes to networks)
-    typedef std::list<DijkstraRIE*> NetworkRoutes;
-    /// const iterator of container of Ipv4RoutingTableEntry (routes to networks)
-    typedef std::list<DijkstraRIE*>::const_iterator NetworkRoutesCI;
-    /// iterator of container of Ipv4RoutingTableEntry (routes to networks)
-    typedef std::list<DijkstraRIE*>::iterator NetworkRoutesI;
+    /**
+     * \brief Bring the neighbor of an interface to Full if it is in Exchange
+     * and has all the LSAs it was sent: the flooding sends it what it lacks,
+     * so it has nothing to request.
+     * \param interface the interface
+     */
+    void CheckExchangeDone(uint32_t interface);
 
-    /// container of Ipv4RoutingTableEntry (routes to external AS)
-    typedef std::list<DijkstraRIE*> ASExternalRoutes;
-    /// const iterator of container of Ipv4RoutingTableEntry (routes to external AS)
-    typedef std::list<DijkstraRIE*>::const_iterator ASExternalRoutesCI;
-    /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
-    typedef std::list<DijkstraRIE*>::iterator ASExternalRoutesI;
+    /**
+     * \brief Receive an LSU, LSAck or Hello.
+     * \param socket the socket it came from
+     */
+    void Receive(Ptr<Socket> socket);
+
+    /**
+     * \brief Install the LSA instances of an LSU that are newer than the
+     * ones of the LSDB, flood them on, and acknowledge them.
+     * \param hdr the LSU
+     * \param interface the interface it came from
+     */
+    void HandleLsu(const LsuHeader& hdr, uint32_t interface);
+
+    /**
+     * \brief Take the LSAs an LSAck acknowledges off the retransmit list.
+     * \param hdr the LSAck
+     * \param interface the interface it came from
+     */
+    void HandleLsAck(const LsuHeader& hdr, uint32_t interface);
+
+    /**
+     * \brief Compute the routes from the LSDB of the node SpfDelay from now,
+     * unless a computation is scheduled.
+     */
+    void ScheduleFloodedSpf();
+
+    /**
+     * \brief Compute the routes from the LSDB of the node, and install them.
+     */
+    void ComputeFloodedRoutes();
+
+    /**
+     * \param interface an interface
+     * \return the flooding state of its neighbor
+     */
+    FloodingNeighbor& GetFloodingNeighbor(uint32_t interface);
+
+    /// Set to true to flood the LSAs and compute the routes from the LSDB of the node
+    bool m_distributedFlooding;
+    /// the time the acknowledgments of an interface wait to be batched
+    Time m_ackDelay;
+    /// the time after which the LSAs not acknowledged are sent again
+    Time m_retransmitInterval;
+    /// the time the routes wait for the LSDB of the node to stop changing
+    Time m_spfDelay;
+    /// the time between two Hellos on an interface
+    Time m_helloInterval;
+    /// the time without a Hello after which a neighbor is down
+    Time m_routerDeadInterval;
+
+    FloodingDb m_floodingDb;                           //!< the LSDB of the node
+    std::vector<FloodingNeighbor> m_floodingNeighbors; //!< the neighbors, by interface
+    std::vector<Ptr<Socket>> m_interfaceSockets;       //!< the socket of an interface, or null
+    Ptr<Socket> m_multicastRecvSocket;                 //!< the socket of the LSUs and LSAcks
+    EventId m_originateEvent;                          //!< the next OriginateLSAs ()
+    Ptr<TimerWheel> m_timerWheel;                      //!< the wheel of the Hello and LSA timers
+    TimerWheel::TimerId m_helloTimer;                  //!< the next SendHellos ()
+    EventId m_floodEvent;                              //!< the next SendPendingLsus ()
+    EventId m_ackEvent;                                //!< the next SendPendingAcks ()
+    TimerWheel::TimerId m_retransmitTimer;             //!< the next RetransmitLsas ()
+    EventId m_spfEvent;                                //!< the next ComputeFloodedRoutes ()
+    DijkstraAlgorithm m_floodedSpf;                    //!< the engine of ComputeFloodedRoutes ()
+    Ptr<LSDB> m_floodedLsdb;                           //!< the LSDB m_floodedSpf last ran on
+
+    /// the LSUs, LSAcks and Hellos sent
+    TracedCallback<uint8_t, uint32_t, uint32_t> m_floodingTxTrace;
+    /// the changes of the state of the neighbors
+    TracedCallback<uint32_t, uint8_t, uint8_t> m_neighborStateTrace;
+    /// the computations of the routes from the LSDB of the node
+    TracedCallback<uint32_t> m_floodedSpfTrace;
+
+    /// pool of the host route entries
+    typedef RouteEntryPool<DijkstraRIE> RoutePool;
+    /**
+     * the host routes, in insertion order: the handle of an entry of the pool,
+     * or COLUMN_ROUTE and the AddressInterner index of the destination of a
+     * route of the NextHopColumns
+     */
+    typedef std::vector<RoutePool::Handle> HostRoutes;
+
+    /// the flag of a host route of the NextHopColumns
+    static const uint32_t COLUMN_ROUTE = 0x80000000;
+    /// m_columnNode while no route of the node went to the NextHopColumns
+    static const uint32_t NO_COLUMN_NODE = UINT32_MAX;
+
+    // These methods called by RomamRoutingCore
+    Ptr<Ipv4Route> SelectOutputRoute(Ptr<Packet> p,
+                                     const Ipv4Header& header,
+                                     Ptr<NetDevice> oif);
+    Ptr<Ipv4Route> SelectInputRoute(Ptr<const Packet>& p,
+                                    const Ipv4Header& header,
+                                    Ptr<const NetDevice> idev);
+    void AddHostRoute(const DijkstraRIE& route);
+    uint32_t GetNHostRoutes() const;
+    DijkstraRIE* GetHostRoute(uint32_t i) const;
+    void RemoveHostRoute(uint32_t i);
+    void ClearHostRoutes();
+    void NotifyRoutesChanged();
+
+    /**
+     * \brief Build the host route of the five-argument AddHostRouteTo (),
+     * which goes directly on the interface: a DijkstraRIE keeps no distance.
+     * \param dest destination address
+     * \param nextHop next hop address, unused
+     * \param interface output interface
+     * \param nextIface interface of the next hop, unused
+     * \param distance distance to the destination, unused
+     * \return the host route
+     */
+    static DijkstraRIE MakeHostRoute(Ipv4Address dest,
+                                     Ipv4Address nextHop,
+                                     uint32_t interface,
+                                     uint32_t nextIface,
+                                     uint32_t distance);
+
+    /**
+     * \brief Get the entry of a host route of the NextHopColumns.
+     *
+     * The entry is m_hostRouteView, built again unless it is the one of the
+     * same route, so that the lookups of a destination keep its Ipv4Route.
+     *
+     * \param dest the AddressInterner index of the destination
+     * \param iface the output interface
+     * \return the entry, valid until the next call
+     */
+    DijkstraRIE* GetColumnRoute(uint32_t dest, uint32_t iface) const;
 
     /**
      * \brief Lookup in the route infomation base (RIB) for destination.
      * \param dest destination address
      * \param oif output interface if any (put 0 otherwise)
+     * \param flowHash the hash of the flow of the packet, for FlowHashEcmpRouting
+     * \param flowlet the number of the flowlet of the packet, for FlowHashEcmpRouting
      * \return Ipv4Route to route the packet to reach dest address
      */
-    Ptr<Ipv4Route> LookupRoute(Ipv4Address dest, Ptr<NetDevice> oif = 0) const;
+    Ptr<Ipv4Route> LookupRoute(Ipv4Address dest,
+                               Ptr<NetDevice> oif = 0,
+                               uint32_t flowHash = 0,
+                               uint32_t flowlet = 0) const;
+
+    /**
+     * \brief Lookup the route of a packet in the flow cache, and in the RIB
+     * if its flow has no route cached or starts a new flowlet.
+     * \param header the IP header of the packet
+     * \param p the payload of the packet
+     * \param oif output interface if any (put 0 otherwise), which bypasses the cache
+     * \return Ipv4Route to route the packet to reach its destination
+     */
+    Ptr<Ipv4Route> LookupFlowRoute(const Ipv4Header& header,
+                                   Ptr<const Packet> p,
+                                   Ptr<NetDevice> oif = 0) const;
 
+    RoutePool m_routePool;               //!< the host route entries
     HostRoutes m_hostRoutes;             //!< Routes to hosts
-    NetworkRoutes m_networkRoutes;       //!< Routes to networks
-    ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
-    Ptr<Ipv4> m_ipv4;                    //!< associated IPv4 instance
+    uint32_t m_nPooledHostRoutes;        //!< the host routes with an entry of the pool
+    mutable DijkstraRIE m_hostRouteView; //!< the last entry GetColumnRoute () built
 };
 
 } // namespace ns3
@@ -1,8 +1,10 @@
 #include "ddr-queue-disc.h"
 
 #include "../datapath/romam-tags.h"
+#include "occupancy-sampler.h"
 
 #include "ns3/attribute.h"
+#include "ns3/double.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/enum.h"
 #include "ns3/log.h"
@@ -11,6 +13,8 @@
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+
 #define DELAY_SENSITIVE 0
 #define BEST_EFFORT 1
 
@@ -33,13 +37,129 @@ DDRQueueDisc::GetTypeId()
                           "The maximum number of packets accepted by this queue disc.",
                           QueueSizeValue(QueueSize("3MB")),
                           MakeQueueSizeAccessor(&QueueDisc::SetMaxSize, &QueueDisc::GetMaxSize),
-                          MakeQueueSizeChecker());
+                          MakeQueueSizeChecker())
+            .AddAttribute("StateHysteresis",
+                          "Fraction of an occupancy level the queue must go past a level "
+                          "boundary by before its reported level changes",
+                          DoubleValue(0.5),
+                          MakeDoubleAccessor(&DDRQueueDisc::m_stateHysteresis),
+                          MakeDoubleChecker<double>(0, 1))
+            .AddAttribute("StateMinInterval",
+                          "Minimum time between two reports of a change of occupancy level",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&DDRQueueDisc::m_stateMinInterval),
+                          MakeTimeChecker())
+            .AddAttribute("DelayEstimator",
+                          "How the queueing delay of the delay sensitive band is estimated: "
+                          "from its occupancy, from the sojourn time of the packets, or from "
+                          "the bytes queued and the dequeue rate",
+                          EnumValue(OCCUPANCY_DELAY),
+                          MakeEnumAccessor(&DDRQueueDisc::m_delayEstimator),
+                          MakeEnumChecker(OCCUPANCY_DELAY,
+                                          "Occupancy",
+                                          SOJOURN_DELAY,
+                                          "Sojourn",
+                                          DRAIN_DELAY,
+                                          "Drain"))
+            .AddAttribute("DelayEstimatorGain",
+                          "Weight of a new sample in the moving averages of the sojourn time "
+                          "and of the dequeue rate",
+                          DoubleValue(0.125),
+                          MakeDoubleAccessor(&DDRQueueDisc::m_delayGain),
+                          MakeDoubleChecker<double>(0, 1))
+            .AddAttribute("Classifier",
+                          "How the delay sensitive packets are found: by their PriorityTag, or "
+                          "by the DSCP of their IPv4 header, which takes a constant time",
+                          EnumValue(PRIORITY_TAG_CLASSIFIER),
+                          MakeEnumAccessor(&DDRQueueDisc::m_classifier),
+                          MakeEnumChecker(PRIORITY_TAG_CLASSIFIER,
+                                          "PriorityTag",
+                                          TOS_CLASSIFIER,
+                                          "Tos"))
+            .AddAttribute("Scheduler",
+                          "How the bands share the link: strict priority to the delay "
+                          "sensitive band, or deficit round robin with the band weights",
+                          EnumValue(STRICT_PRIORITY),
+                          MakeEnumAccessor(&DDRQueueDisc::m_scheduler),
+                          MakeEnumChecker(STRICT_PRIORITY,
+                                          "StrictPriority",
+                                          DEFICIT_ROUND_ROBIN,
+                                          "DeficitRoundRobin"))
+            .AddAttribute("FastWeight",
+                          "Quanta the delay sensitive band may send per round robin round",
+                          UintegerValue(10),
+                          MakeUintegerAccessor(&DDRQueueDisc::m_fastWeight),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("NormalWeight",
+                          "Quanta the best effort band may send per round robin round",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&DDRQueueDisc::m_normalWeight),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("Quantum",
+                          "Bytes of a round robin quantum, at least the largest packet to keep "
+                          "a dequeue to one visit of each band",
+                          UintegerValue(1500),
+                          MakeUintegerAccessor(&DDRQueueDisc::m_quantum),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("FastLaneRate",
+                          "Rate of the token bucket that polices the delay sensitive band, "
+                          "whose packets out of profile go to the best effort band; 0 for no "
+                          "policing",
+                          DataRateValue(DataRate(0)),
+                          MakeDataRateAccessor(&DDRQueueDisc::m_fastLaneRate),
+                          MakeDataRateChecker())
+            .AddAttribute("FastLaneBurst",
+                          "Size of the token bucket of FastLaneRate, in bytes",
+                          UintegerValue(15000),
+                          MakeUintegerAccessor(&DDRQueueDisc::m_fastLaneBurst),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("BackgroundBand",
+                          "Band of the fluid background load of AddBackgroundRate ()",
+                          UintegerValue(BEST_EFFORT),
+                          MakeUintegerAccessor(&DDRQueueDisc::m_backgroundBand),
+                          MakeUintegerChecker<uint32_t>(DELAY_SENSITIVE, BEST_EFFORT))
+            .AddAttribute("BackgroundLinkRate",
+                          "Rate the link sends the fluid background load at; 0 for the "
+                          "DataRate attribute of the device",
+                          DataRateValue(DataRate(0)),
+                          MakeDataRateAccessor(&DDRQueueDisc::m_backgroundLinkRate),
+                          MakeDataRateChecker())
+            .AddTraceSource("QueueState",
+                            "Occupancy level of the delay sensitive band, in the levels of "
+                            "SetStateChangeCallback ()",
+                            MakeTraceSourceAccessor(&DDRQueueDisc::m_queueState),
+                            "ns3::TracedValueCallback::Uint32")
+            .AddTraceSource("QueueDelay",
+                            "Delay estimate of the delay sensitive band, in microseconds",
+                            MakeTraceSourceAccessor(&DDRQueueDisc::m_queueDelay),
+                            "ns3::TracedValueCallback::Uint32");
 
     return tid;
 }
 
 DDRQueueDisc::DDRQueueDisc()
-    : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::BYTES)
+    : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::BYTES),
+      m_scheduler(STRICT_PRIORITY),
+      m_fastWeight(10),
+      m_normalWeight(1),
+      m_quantum(1500),
+      m_activeBand(0),
+      m_quantumGiven(false),
+      m_classifier(PRIORITY_TAG_CLASSIFIER),
+      m_fastLaneRate(0),
+      m_fastLaneBurst(15000),
+      m_delayEstimator(OCCUPANCY_DELAY),
+      m_drainRate(0.0),
+      m_lastDequeueSize(0),
+      m_backlogged(false),
+      m_fastMaxBytes(0),
+      m_queueState(0),
+      m_queueDelay(0),
+      m_levelGeneration(0),
+      m_stateLevels(10),
+      m_reportedState(0),
+      m_backgroundBand(BEST_EFFORT),
+      m_backgroundLinkRate(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -50,26 +170,285 @@ DDRQueueDisc::~DDRQueueDisc()
 }
 
 uint32_t
-DDRQueueDisc::GetQueueStatus()
+DDRQueueDisc::GetQueueStatus(uint32_t levels)
 {
-    uint32_t currentSize = GetInternalQueue(0)->GetCurrentSize().GetValue();
-    uint32_t maxSize = GetInternalQueue(0)->GetMaxSize().GetValue();
-    return currentSize * 10 / maxSize;
+    if (m_background.IsEnabled())
+    {
+        UpdateQueueState(); // the load moved since the last packet
+    }
+    if (levels == m_stateLevels)
+    {
+        return m_queueState.Get();
+    }
+    return GetOccupancy(levels);
 }
 
 uint32_t
 DDRQueueDisc::GetQueueDelay()
 {
+    if (m_background.IsEnabled())
+    {
+        UpdateQueueState();
+    }
+    return m_queueDelay.Get();
+}
+
+uint32_t
+DDRQueueDisc::GetOccupancy(uint32_t levels) const
+{
+    if (m_fastMaxBytes == 0)
+    {
+        return 0; // not initialized, so empty
+    }
+    return static_cast<uint64_t>(GetBandBytes(DELAY_SENSITIVE)) * levels / m_fastMaxBytes;
+}
+
+uint32_t
+DDRQueueDisc::GetBandBytes(uint32_t band) const
+{
+    if (band != m_backgroundBand)
+    {
+        return m_bandBytes[band];
+    }
+    return m_bandBytes[band] + m_background.GetBacklog();
+}
+
+void
+DDRQueueDisc::UpdateQueueState()
+{
+    uint32_t level = GetOccupancy(m_stateLevels);
+    if (level != m_queueState.Get())
+    {
+        m_queueState = level;
+        m_levelGeneration++;
+    }
     // in microsecond
-    uint32_t currentSize = GetInternalQueue(0)->GetCurrentSize().GetValue();
-    uint32_t maxSize = GetInternalQueue(0)->GetMaxSize().GetValue();
-    return currentSize * 10 * 2000 / maxSize;
+    switch (m_delayEstimator)
+    {
+    case SOJOURN_DELAY:
+        m_queueDelay = GetSojournTime(DELAY_SENSITIVE).GetMicroSeconds();
+        return;
+    case DRAIN_DELAY:
+        if (m_drainRate > 0.0)
+        {
+            m_queueDelay = GetDrainTime(DELAY_SENSITIVE).GetMicroSeconds();
+            return;
+        }
+        break; // not measured yet
+    default:
+        break;
+    }
+    m_queueDelay = GetOccupancy(10 * 2000);
+}
+
+Time
+DDRQueueDisc::GetSojournTime(uint32_t band) const
+{
+    NS_ASSERT(band < m_sojourn.size());
+    return m_bandBytes[band] > 0 ? Seconds(m_sojourn[band]) : Time(0);
+}
+
+Time
+DDRQueueDisc::GetDrainTime(uint32_t band) const
+{
+    NS_ASSERT(band < m_bandBytes.size());
+    if (m_drainRate <= 0.0)
+    {
+        return Time(0);
+    }
+    if (m_scheduler == DEFICIT_ROUND_ROBIN)
+    {
+        // the band gets the share of its weight among the backlogged bands
+        uint32_t bytes = GetBandBytes(band);
+        uint64_t weights = 0;
+        for (uint32_t b = 0; b < m_bandBytes.size(); b++)
+        {
+            weights += GetBandBytes(b) > 0 ? m_weights[b] : 0;
+        }
+        return bytes > 0 ? Seconds(bytes * weights / (m_drainRate * m_weights[band])) : Time(0);
+    }
+    // the bands are served in strict priority
+    uint64_t bytes = 0;
+    for (uint32_t b = 0; b <= band; b++)
+    {
+        bytes += GetBandBytes(b);
+    }
+    return Seconds(bytes / m_drainRate);
+}
+
+double
+DDRQueueDisc::GetDrainRate() const
+{
+    return m_drainRate;
+}
+
+uint64_t
+DDRQueueDisc::GetFastLaneDemotions() const
+{
+    return m_policer.GetDemotions();
+}
+
+void
+DDRQueueDisc::AddBackgroundRate(Time start, DataRate rate)
+{
+    NS_LOG_FUNCTION(this << start << rate);
+    m_background.AddRate(start, rate);
+    if (m_fastMaxBytes > 0)
+    {
+        // initialized, so the checks may have stopped
+        m_backgroundCheck.Cancel();
+        CheckBackground();
+    }
+}
+
+const FluidLoad&
+DDRQueueDisc::GetBackgroundLoad() const
+{
+    return m_background;
+}
+
+bool
+DDRQueueDisc::HoldBand(uint32_t band)
+{
+    if (!m_background.IsEnabled() || band < m_backgroundBand)
+    {
+        return false;
+    }
+    Time now = Simulator::Now();
+    Time ready = now;
+    if (band == m_backgroundBand)
+    {
+        ready = m_background.GetReadyTime();
+    }
+    else if (m_background.GetBacklog() > 0)
+    {
+        // the load of a band served before waits for no packet of this one
+        ready = now + m_background.GetDrainTime();
+    }
+    if (ready <= now)
+    {
+        return false;
+    }
+    if (!m_backgroundWake.IsRunning() || Simulator::GetDelayLeft(m_backgroundWake) > ready - now)
+    {
+        m_backgroundWake.Cancel();
+        m_backgroundWake = Simulator::Schedule(ready - now, &QueueDisc::Run, this);
+    }
+    NS_LOG_LOGIC("Band " << band << " held behind the background load until " << ready);
+    return true;
+}
+
+void
+DDRQueueDisc::CheckBackground()
+{
+    if (!m_background.IsEnabled())
+    {
+        return;
+    }
+    m_background.Advance();
+    UpdateQueueState();
+    CheckState();
+    Time now = Simulator::Now();
+    Time next = m_background.GetNextStep();
+    if (!m_background.IsIdle())
+    {
+        Time interval =
+            m_stateMinInterval.IsStrictlyPositive() ? m_stateMinInterval : MilliSeconds(1);
+        next = std::min(next, now + interval);
+    }
+    if (next != Time::Max())
+    {
+        m_backgroundCheck = Simulator::Schedule(next - now, &DDRQueueDisc::CheckBackground, this);
+    }
+}
+
+void
+DDRQueueDisc::UpdateDelayEstimates(uint32_t band, Ptr<const QueueDiscItem> item)
+{
+    Time now = Simulator::Now();
+    double sojourn = (now - item->GetTimeStamp()).GetSeconds();
+    m_sojourn[band] += m_delayGain * (sojourn - m_sojourn[band]);
+    m_bandBytes[band] -= item->GetSize();
+    if (band == m_backgroundBand)
+    {
+        m_background.Depart();
+    }
+    m_background.Serve(item->GetSize());
+
+    // back to back dequeues are one transmission apart, which measures the
+    // link rate; after an idle period the gap measures nothing, and the
+    // background load holding the link measures less
+    if (m_backlogged && now > m_lastDequeue && !m_background.IsEnabled())
+    {
+        double rate = m_lastDequeueSize / (now - m_lastDequeue).GetSeconds();
+        m_drainRate = m_drainRate > 0.0 ? m_drainRate + m_delayGain * (rate - m_drainRate) : rate;
+    }
+    m_lastDequeue = now;
+    m_lastDequeueSize = item->GetSize();
+    m_backlogged = false;
+    for (uint32_t b = 0; b < m_bandBytes.size(); b++)
+    {
+        m_backlogged = m_backlogged || m_bandBytes[b] > 0;
+    }
+    UpdateQueueState();
+}
+
+void
+DDRQueueDisc::SetStateChangeCallback(uint32_t levels, Callback<void, uint32_t> cb)
+{
+    NS_LOG_FUNCTION(this << levels);
+    m_stateChange = cb;
+    m_stateLevels = levels;
+    m_queueState = GetOccupancy(levels);
+    m_levelGeneration++; // the levels changed
+    m_reportedState = m_queueState.Get();
+    m_lastStateReport = Simulator::Now() - m_stateMinInterval;
+    m_stateCheck.Cancel();
+}
+
+void
+DDRQueueDisc::CheckState()
+{
+    if (m_stateChange.IsNull())
+    {
+        return;
+    }
+    if (m_fastMaxBytes == 0)
+    {
+        return;
+    }
+    double level =
+        static_cast<double>(GetBandBytes(DELAY_SENSITIVE)) * m_stateLevels / m_fastMaxBytes;
+    if (level < m_reportedState + 1 + m_stateHysteresis &&
+        level >= m_reportedState - m_stateHysteresis)
+    {
+        return;
+    }
+    Time next = m_lastStateReport + m_stateMinInterval;
+    if (Simulator::Now() < next)
+    {
+        if (!m_stateCheck.IsRunning())
+        {
+            m_stateCheck =
+                Simulator::Schedule(next - Simulator::Now(), &DDRQueueDisc::CheckState, this);
+        }
+        return;
+    }
+    m_reportedState = m_queueState.Get();
+    m_lastStateReport = Simulator::Now();
+    NS_LOG_LOGIC("Occupancy level " << m_reportedState);
+    m_stateChange(m_reportedState);
 }
 
 void
 DDRQueueDisc::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    m_stateCheck.Cancel();
+    m_backgroundWake.Cancel();
+    m_backgroundCheck.Cancel();
+    m_stateChange = MakeNullCallback<void, uint32_t>();
+    OccupancySampler::Remove(this);
     QueueDisc::DoDispose();
 }
 
@@ -90,13 +469,40 @@ DDRQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     //     NS_LOG_LOGIC ("Queue disc limit exceeded -- drop packet");
     //     DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
     //   }
+    item->SetTimeStamp(Simulator::Now());
+    uint32_t size = item->GetSize();
+    if (band == DELAY_SENSITIVE && !m_policer.Conform(size))
+    {
+        NS_LOG_LOGIC("Out of profile, demoted to the best effort band");
+        band = BEST_EFFORT;
+    }
+    if (band == m_backgroundBand && m_background.IsEnabled())
+    {
+        m_background.Advance();
+        if (GetBandBytes(band) + size > GetInternalQueue(band)->GetMaxSize().GetValue())
+        {
+            NS_LOG_LOGIC("Band full of background load -- drop packet");
+            DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP);
+            return false;
+        }
+    }
     bool retval = GetInternalQueue(band)->Enqueue(item);
     if (!retval)
     {
         NS_LOG_WARN("Packet enqueue failed. Check the size of the internal queues");
     }
+    else
+    {
+        if (band == m_backgroundBand)
+        {
+            m_background.Arrive();
+        }
+        m_bandBytes[band] += size;
+        UpdateQueueState();
+    }
 
-    NS_LOG_LOGIC("Band current size " << band << ": " << GetInternalQueue(band)->GetCurrentSize());
+    NS_LOG_LOGIC("Band current size " << band << ": " << m_bandBytes[band]);
+    CheckState();
     return retval;
 }
 
@@ -105,16 +511,27 @@ DDRQueueDisc::DoDequeue()
 {
     NS_LOG_FUNCTION(this);
 
+    if (m_scheduler == DEFICIT_ROUND_ROBIN)
+    {
+        return DequeueRoundRobin();
+    }
+
     Ptr<QueueDiscItem> item;
 
     for (uint32_t i = 0; i < GetNInternalQueues(); i++)
     {
+        if (!GetInternalQueue(i)->IsEmpty() && HoldBand(i))
+        {
+            return nullptr; // the bands after it wait as well
+        }
         item = GetInternalQueue(i)->Dequeue();
         if (item)
         {
             // if (i == 0) std::cout << "Popped from band" << i << std::endl;
             NS_LOG_LOGIC("Popped from band " << i << ": " << item);
             NS_LOG_LOGIC("Number packets band " << i << ": " << GetInternalQueue(i)->GetNPackets());
+            UpdateDelayEstimates(i, item);
+            CheckState();
             return item;
         }
     }
@@ -123,11 +540,91 @@ DDRQueueDisc::DoDequeue()
     return item;
 }
 
+uint32_t
+DDRQueueDisc::SelectRoundRobinBand()
+{
+    bool empty = true;
+    for (uint32_t i = 0; i < GetNInternalQueues() && empty; i++)
+    {
+        empty = GetInternalQueue(i)->IsEmpty();
+    }
+    if (empty)
+    {
+        return GetNInternalQueues();
+    }
+
+    // a band with packets gets at least one quantum per visit, so with a
+    // quantum of a packet or more this finds a packet within one round
+    while (true)
+    {
+        uint32_t band = m_activeBand;
+        Ptr<const QueueDiscItem> head = GetInternalQueue(band)->Peek();
+        if (!head)
+        {
+            // an idle band does not save up its deficit
+            m_deficits[band] = 0;
+            NextBand();
+            continue;
+        }
+        if (!m_quantumGiven)
+        {
+            m_deficits[band] += m_weights[band] * m_quantum;
+            m_quantumGiven = true;
+        }
+        if (head->GetSize() <= m_deficits[band])
+        {
+            return band;
+        }
+        NextBand();
+    }
+}
+
+Ptr<QueueDiscItem>
+DDRQueueDisc::DequeueRoundRobin()
+{
+    uint32_t band = SelectRoundRobinBand();
+    if (band == GetNInternalQueues())
+    {
+        NS_LOG_LOGIC("Queue empty");
+        return nullptr;
+    }
+    if (HoldBand(band))
+    {
+        return nullptr;
+    }
+    Ptr<QueueDiscItem> item = GetInternalQueue(band)->Dequeue();
+    m_deficits[band] -= item->GetSize();
+    if (GetInternalQueue(band)->IsEmpty())
+    {
+        m_deficits[band] = 0;
+        NextBand();
+    }
+    NS_LOG_LOGIC("Popped from band " << band << ": " << item);
+    UpdateDelayEstimates(band, item);
+    CheckState();
+    return item;
+}
+
+void
+DDRQueueDisc::NextBand()
+{
+    m_activeBand = (m_activeBand + 1) % GetNInternalQueues();
+    m_quantumGiven = false;
+}
+
 Ptr<const QueueDiscItem>
 DDRQueueDisc::DoPeek()
 {
     NS_LOG_FUNCTION(this);
 
+    if (m_scheduler == DEFICIT_ROUND_ROBIN)
+    {
+        // moving the round robin to the band of the next packet does not
+        // change which packet the next dequeue returns
+        uint32_t band = SelectRoundRobinBand();
+        return band < GetNInternalQueues() ? GetInternalQueue(band)->Peek() : nullptr;
+    }
+
     Ptr<const QueueDiscItem> item;
 
     for (uint32_t i = 0; i < GetNInternalQueues(); i++)
@@ -195,17 +692,48 @@ void
 DDRQueueDisc::InitializeParams()
 {
     NS_LOG_FUNCTION(this);
-    m_fastWeight = 10;
-    m_normalWeight = 1;
-    m_currentFastWeight = m_fastWeight;
-    m_currentNormalWeight = m_normalWeight;
+    m_weights.assign(GetNInternalQueues(), 1);
+    m_weights[DELAY_SENSITIVE] = m_fastWeight;
+    m_weights[BEST_EFFORT] = m_normalWeight;
+    m_deficits.assign(GetNInternalQueues(), 0);
+    m_activeBand = 0;
+    m_quantumGiven = false;
+    m_bandBytes.assign(GetNInternalQueues(), 0);
+    m_sojourn.assign(GetNInternalQueues(), 0.0);
+    m_drainRate = 0.0;
+    m_backlogged = false;
+    m_fastMaxBytes = GetInternalQueue(DELAY_SENSITIVE)->GetMaxSize().GetValue();
+    m_policer.SetProfile(m_fastLaneRate, m_fastLaneBurst);
+    DataRate linkRate = m_backgroundLinkRate.GetBitRate() > 0 ? m_backgroundLinkRate
+                                                              : FluidLoad::GetDeviceRate(this);
+    m_background.SetLinkRate(linkRate);
+    m_background.SetLimit(GetInternalQueue(m_backgroundBand)->GetMaxSize().GetValue());
+    if (m_background.IsEnabled())
+    {
+        // the load holds the link, so the dequeues would measure less
+        m_drainRate = linkRate.GetBitRate() / 8.0;
+    }
+    UpdateQueueState();
+    CheckBackground();
+    OccupancySampler::Add(this);
 }
 
 uint32_t
 DDRQueueDisc::EnqueueClassify(Ptr<QueueDiscItem> item)
 {
-    PriorityTag priorityTag;
-    if (item->GetPacket()->PeekPacketTag(priorityTag))
+    if (m_classifier == TOS_CLASSIFIER)
+    {
+        // the DSCP is the upper six bits of the ToS byte
+        uint8_t tos;
+        if (item->GetUint8Value(QueueItem::IP_DSFIELD, tos) &&
+            (tos >> 2) == (PriorityTag::PRIORITY_TOS >> 2))
+        {
+            return DELAY_SENSITIVE;
+        }
+        return BEST_EFFORT;
+    }
+    RomamMetaTag metaTag;
+    if (RomamMetaTag::Peek(item->GetPacket(), metaTag) && metaTag.HasPriority())
     {
         return DELAY_SENSITIVE;
     }
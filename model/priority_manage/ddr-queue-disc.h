@@ -1,7 +1,11 @@
 #ifndef DDR_QUEUE_DISC_H
 #define DDR_QUEUE_DISC_H
 
+#include "fast-lane-policer.h"
+#include "fluid-load.h"
+
 #include "ns3/boolean.h"
+#include "ns3/callback.h"
 #include "ns3/data-rate.h"
 #include "ns3/event-id.h"
 #include "ns3/nstime.h"
@@ -10,6 +14,8 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/traced-value.h"
 
+#include <vector>
+
 namespace ns3
 {
 
@@ -41,13 +47,124 @@ class DDRQueueDisc : public QueueDisc
      */
     ~DDRQueueDisc() override;
 
+    /// How GetQueueDelay () estimates the delay of the delay sensitive band
+    enum DelayEstimator
+    {
+        OCCUPANCY_DELAY, //!< from the occupancy of the band, ignoring the link rate
+        SOJOURN_DELAY,   //!< moving average of the sojourn time of the packets dequeued
+        DRAIN_DELAY      //!< bytes queued over the moving average of the dequeue rate
+    };
+
+    /// How DoDequeue () shares the link between the bands
+    enum Scheduler
+    {
+        STRICT_PRIORITY,     //!< always serve the lowest band with a packet
+        DEFICIT_ROUND_ROBIN, //!< serve each band in turn, up to its weight times Quantum bytes
+    };
+
+    /// How EnqueueClassify () finds the delay sensitive packets
+    enum Classifier
+    {
+        PRIORITY_TAG_CLASSIFIER, //!< the packets with a PriorityTag
+        TOS_CLASSIFIER           //!< the packets with the DSCP of PriorityTag::PRIORITY_TOS
+    };
+
     // Reasons for dropping packets
     static constexpr const char* LIMIT_EXCEEDED_DROP =
         "Queue disc limit exceeded"; //!< Packet dropped due to queue disc limit exceeded
 
-    uint32_t GetQueueStatus();
+    /**
+     * The level in the levels of SetStateChangeCallback () is kept up to date
+     * by the enqueues and dequeues, and traced as QueueState.
+     *
+     * \param levels the number of queue occupancy levels
+     * \return the occupancy level of the queue, levels when it is full
+     */
+    uint32_t GetQueueStatus(uint32_t levels = 10);
+
+    /**
+     * \brief Get a counter of the moves of the occupancy level in the levels
+     * of SetStateChangeCallback (), for the caches of values derived from it.
+     *
+     * The counter is bumped whenever the level traced as QueueState moves,
+     * hysteresis and report interval aside, and never goes back, so a cache
+     * keeps the counter it was filled at and compares it to this one.
+     *
+     * \return the generation of the occupancy level
+     */
+    uint32_t GetLevelGeneration();
+
+    /**
+     * \brief Estimate the delay of a packet of the delay sensitive band, in
+     * O(1) and without looking at the internal queues.
+     *
+     * The estimate is kept up to date by the enqueues and dequeues, and
+     * traced as QueueDelay.
+     *
+     * \return the delay in microseconds, according to DelayEstimator
+     */
     uint32_t GetQueueDelay();
 
+    /**
+     * \param band the band
+     * \return the moving average of the sojourn time of the packets
+     * dequeued from the band, zero while the band is empty
+     */
+    Time GetSojournTime(uint32_t band) const;
+
+    /**
+     * \param band the band
+     * \return the time to send the bytes of the band and of the bands
+     * served before it at the measured dequeue rate, zero until the rate is
+     * measured; with DeficitRoundRobin, the time to send the bytes of the
+     * band alone at its weight's share of the rate among the backlogged bands
+     */
+    Time GetDrainTime(uint32_t band) const;
+
+    /**
+     * \return the moving average of the dequeue rate in bytes/s, zero until
+     * it is measured
+     */
+    double GetDrainRate() const;
+
+    /**
+     * \brief Be told when the occupancy level of the queue changes.
+     *
+     * The level only moves once the occupancy is StateHysteresis of a level
+     * past the boundary, and the callback is raised at most once per
+     * StateMinInterval; a change within the interval is reported at its end.
+     *
+     * \param levels the number of queue occupancy levels
+     * \param cb called with the new level, or a null callback to stop
+     */
+    void SetStateChangeCallback(uint32_t levels, Callback<void, uint32_t> cb);
+
+    /**
+     * \return the delay sensitive packets the FastLaneRate policer demoted to
+     * the best effort band
+     */
+    uint64_t GetFastLaneDemotions() const;
+
+    /**
+     * \brief Add a step to the schedule of the fluid background load of the
+     * BackgroundBand.
+     *
+     * The load counts in the occupancy and the delay estimates of the band,
+     * and the real packets of the band and of the bands after it wait for
+     * the load queued before them to be sent, which makes the real packets
+     * see the background load of the schedule without it being simulated
+     * packet by packet.  See FluidLoad.
+     *
+     * \param start the time the rate starts at
+     * \param rate the rate of the load from start to the next step
+     */
+    void AddBackgroundRate(Time start, DataRate rate);
+
+    /**
+     * \return the fluid background load
+     */
+    const FluidLoad& GetBackgroundLoad() const;
+
   protected:
     /**
      * \brief Dispose of the object
@@ -55,10 +172,14 @@ class DDRQueueDisc : public QueueDisc
     void DoDispose() override;
 
   private:
-    uint32_t m_fastWeight;
-    uint32_t m_normalWeight;
-    uint32_t m_currentFastWeight;
-    uint32_t m_currentNormalWeight;
+    Scheduler m_scheduler;            //!< how the bands share the link
+    uint32_t m_fastWeight;            //!< quanta of the delay sensitive band per round
+    uint32_t m_normalWeight;          //!< quanta of the best effort band per round
+    uint32_t m_quantum;               //!< bytes of a quantum
+    std::vector<uint32_t> m_weights;  //!< quanta per round, by band
+    std::vector<uint32_t> m_deficits; //!< bytes a band may still send this round, by band
+    uint32_t m_activeBand;            //!< band served by the round robin
+    bool m_quantumGiven;              //!< whether the active band got its quanta this round
 
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
     Ptr<QueueDiscItem> DoDequeue() override;
@@ -67,8 +188,113 @@ class DDRQueueDisc : public QueueDisc
     void InitializeParams() override;
 
     uint32_t EnqueueClassify(Ptr<QueueDiscItem> item);
+
+    Classifier m_classifier; //!< how the delay sensitive packets are found
+
+    DataRate m_fastLaneRate;   //!< rate of the delay sensitive band, 0 for no policing
+    uint32_t m_fastLaneBurst;  //!< burst of the delay sensitive band, in bytes
+    FastLanePolicer m_policer; //!< polices the delay sensitive band
+
+    /**
+     * \brief Move the round robin to the band of the next packet to send,
+     * giving the bands on the way their quanta.
+     * \return the band, or the number of bands if the queue disc is empty
+     */
+    uint32_t SelectRoundRobinBand();
+
+    /**
+     * \brief Dequeue the next packet in deficit round robin order.
+     * \return the packet, or null if the queue disc is empty
+     */
+    Ptr<QueueDiscItem> DequeueRoundRobin();
+
+    /**
+     * \brief Move the round robin to the next band.
+     */
+    void NextBand();
+
+    /**
+     * \brief Raise the state change callback if the level moved far enough.
+     */
+    void CheckState();
+
+    /**
+     * \brief Fold a dequeued packet into the sojourn time and rate averages.
+     * \param band the band the packet left
+     * \param item the packet
+     */
+    void UpdateDelayEstimates(uint32_t band, Ptr<const QueueDiscItem> item);
+
+    /**
+     * \param levels the number of queue occupancy levels
+     * \return the occupancy level of the delay sensitive band, from m_bandBytes
+     */
+    uint32_t GetOccupancy(uint32_t levels) const;
+
+    /**
+     * \brief Recompute m_queueState and m_queueDelay after the bands changed.
+     */
+    void UpdateQueueState();
+
+    /**
+     * \param band the band
+     * \return the bytes of the band, its background load included
+     */
+    uint32_t GetBandBytes(uint32_t band) const;
+
+    /**
+     * \brief Keep the packets of a band while the background load ahead of
+     * them is sent, and run the queue disc again once it is.
+     * \param band the band of the next packet to send
+     * \return true if the packet must wait
+     */
+    bool HoldBand(uint32_t band);
+
+    /**
+     * \brief Update the occupancy level with the background load, until the
+     * load is idle or its next step.
+     */
+    void CheckBackground();
+
+    DelayEstimator m_delayEstimator;   //!< how GetQueueDelay () estimates delay
+    double m_delayGain;                //!< weight of a new sample in the moving averages
+    std::vector<uint32_t> m_bandBytes; //!< bytes queued, by band
+    std::vector<double> m_sojourn;     //!< average sojourn time in seconds, by band
+    double m_drainRate;                //!< average dequeue rate in bytes/s, 0 until measured
+    Time m_lastDequeue;                //!< time of the last dequeue
+    uint32_t m_lastDequeueSize;        //!< size of the last packet dequeued
+    bool m_backlogged;                 //!< whether a packet was left after the last dequeue
+    uint32_t m_fastMaxBytes;           //!< limit of the delay sensitive band, 0 until initialized
+
+    TracedValue<uint32_t> m_queueState; //!< occupancy level, in m_stateLevels levels
+    TracedValue<uint32_t> m_queueDelay; //!< delay estimate in microseconds
+    uint32_t m_levelGeneration;         //!< bumped when m_queueState moves
+
+    Callback<void, uint32_t> m_stateChange; //!< called when the level changes
+    uint32_t m_stateLevels;                 //!< number of occupancy levels
+    uint32_t m_reportedState;               //!< level last reported
+    double m_stateHysteresis;               //!< fraction of a level past a boundary to move
+    Time m_stateMinInterval;                //!< minimum time between two reports
+    Time m_lastStateReport;                 //!< time of the last report
+    EventId m_stateCheck;                   //!< check at the end of the interval
+
+    FluidLoad m_background;        //!< the fluid background load
+    uint32_t m_backgroundBand;     //!< band of the background load
+    DataRate m_backgroundLinkRate; //!< rate draining the load, 0 for the one of the device
+    EventId m_backgroundWake;      //!< runs the queue disc once the load ahead is sent
+    EventId m_backgroundCheck;     //!< next update of the level with the load
 };
 
+inline uint32_t
+DDRQueueDisc::GetLevelGeneration()
+{
+    if (m_background.IsEnabled())
+    {
+        UpdateQueueState(); // the load moved since the last packet
+    }
+    return m_levelGeneration;
+}
+
 } // namespace ns3
 
 #endif /* DDR_QUEUE_DISC_H */
@@ -0,0 +1,267 @@
+#include "deadline-queue-disc.h"
+
+#include "../datapath/romam-tags.h"
+
+#include "ns3/drop-tail-queue.h"
+#include "ns3/enum.h"
+#include "ns3/log.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DeadlineQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED(DeadlineQueueDisc);
+
+TypeId
+DeadlineQueueDisc::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::DeadlineQueueDisc")
+            .SetParent<QueueDisc>()
+            .SetGroupName("TrafficControl")
+            .AddConstructor<DeadlineQueueDisc>()
+            .AddAttribute("MaxSize",
+                          "The maximum number of bytes accepted by this queue disc.",
+                          QueueSizeValue(QueueSize("3MB")),
+                          MakeQueueSizeAccessor(&QueueDisc::SetMaxSize, &QueueDisc::GetMaxSize),
+                          MakeQueueSizeChecker())
+            .AddAttribute("Mode",
+                          "How the packets are ordered: strict priority bands of remaining "
+                          "budget, or earliest deadline first",
+                          EnumValue(BANDS),
+                          MakeEnumAccessor(&DeadlineQueueDisc::m_mode),
+                          MakeEnumChecker(BANDS, "Bands", EDF, "Edf"))
+            .AddAttribute("NBands",
+                          "Number of bands in Bands mode",
+                          UintegerValue(4),
+                          MakeUintegerAccessor(&DeadlineQueueDisc::m_nBands),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("BandWidth",
+                          "Remaining budget covered by a band in Bands mode",
+                          TimeValue(MilliSeconds(5)),
+                          MakeTimeAccessor(&DeadlineQueueDisc::m_bandWidth),
+                          MakeTimeChecker(TimeStep(1)))
+            .AddAttribute("NBuckets",
+                          "Number of buckets of the calendar in Edf mode",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&DeadlineQueueDisc::m_nBuckets),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("BucketWidth",
+                          "Deadlines covered by a bucket of the calendar in Edf mode",
+                          TimeValue(MicroSeconds(500)),
+                          MakeTimeAccessor(&DeadlineQueueDisc::m_bucketWidth),
+                          MakeTimeChecker(TimeStep(1)));
+
+    return tid;
+}
+
+DeadlineQueueDisc::DeadlineQueueDisc()
+    : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::BYTES),
+      m_mode(BANDS),
+      m_nBands(4),
+      m_nBuckets(64),
+      m_firstSlot(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+DeadlineQueueDisc::~DeadlineQueueDisc()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+DeadlineQueueDisc::GetQueueStatus(uint32_t levels)
+{
+    return static_cast<uint64_t>(GetNBytes()) * levels / GetMaxSize().GetValue();
+}
+
+uint32_t
+DeadlineQueueDisc::GetBandStatus(uint32_t band, uint32_t levels)
+{
+    NS_ASSERT(band < GetNInternalQueues());
+    uint64_t bytes = GetInternalQueue(band)->GetNBytes();
+    return bytes * levels / GetMaxSize().GetValue();
+}
+
+Time
+DeadlineQueueDisc::GetDeadline(Ptr<const QueueDiscItem> item)
+{
+    RomamMetaTag metaTag;
+    if (!RomamMetaTag::Peek(item->GetPacket(), metaTag) || !metaTag.HasBudget())
+    {
+        return Time::Max();
+    }
+    return metaTag.GetTimestamp() + MicroSeconds(metaTag.GetBudget());
+}
+
+uint32_t
+DeadlineQueueDisc::EnqueueClassify(Ptr<QueueDiscItem> item)
+{
+    Time deadline = GetDeadline(item);
+    Time now = Simulator::Now();
+    if (m_mode == BANDS)
+    {
+        if (deadline == Time::Max())
+        {
+            return m_nBands - 1;
+        }
+        Time remaining = std::max(deadline - now, Time(0));
+        int64_t band = remaining.GetTimeStep() / m_bandWidth.GetTimeStep();
+        return std::min<int64_t>(band, m_nBands - 1);
+    }
+
+    // the calendar only goes m_nBuckets slots past the earliest bucket
+    uint64_t slot = m_firstSlot + m_nBuckets - 1;
+    if (deadline != Time::Max())
+    {
+        int64_t deadlineSlot = std::max<int64_t>(deadline.GetTimeStep(), 0) /
+                               m_bucketWidth.GetTimeStep();
+        slot = std::min<uint64_t>(std::max<uint64_t>(deadlineSlot, m_firstSlot), slot);
+    }
+    return slot % m_nBuckets;
+}
+
+bool
+DeadlineQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
+{
+    NS_LOG_FUNCTION(this << item);
+    if (GetCurrentSize() + item > GetMaxSize())
+    {
+        NS_LOG_LOGIC("Queue disc limit exceeded -- dropping packet");
+        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP);
+        return false;
+    }
+    if (m_mode == EDF && GetNPackets() == 0)
+    {
+        // an empty calendar restarts from the current time
+        m_firstSlot = std::max<uint64_t>(m_firstSlot,
+                                         Simulator::Now().GetTimeStep() /
+                                             m_bucketWidth.GetTimeStep());
+    }
+    uint32_t band = EnqueueClassify(item);
+    bool retval = GetInternalQueue(band)->Enqueue(item);
+    if (!retval)
+    {
+        NS_LOG_WARN("Packet enqueue failed. Check the size of the internal queues");
+    }
+    NS_LOG_LOGIC("Number packets band " << band << ": " << GetInternalQueue(band)->GetNPackets());
+    return retval;
+}
+
+uint32_t
+DeadlineQueueDisc::FindFirstQueue()
+{
+    if (GetNPackets() == 0)
+    {
+        return GetNInternalQueues();
+    }
+    if (m_mode == BANDS)
+    {
+        for (uint32_t i = 0; i < GetNInternalQueues(); i++)
+        {
+            if (!GetInternalQueue(i)->IsEmpty())
+            {
+                return i;
+            }
+        }
+        return GetNInternalQueues();
+    }
+
+    // the calendar moves forward only, over at most m_nBuckets empty buckets
+    for (uint32_t n = 0; n < m_nBuckets; n++, m_firstSlot++)
+    {
+        uint32_t bucket = m_firstSlot % m_nBuckets;
+        if (!GetInternalQueue(bucket)->IsEmpty())
+        {
+            return bucket;
+        }
+    }
+    return GetNInternalQueues();
+}
+
+Ptr<QueueDiscItem>
+DeadlineQueueDisc::DoDequeue()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t band = FindFirstQueue();
+    if (band == GetNInternalQueues())
+    {
+        NS_LOG_LOGIC("Queue empty");
+        return nullptr;
+    }
+    Ptr<QueueDiscItem> item = GetInternalQueue(band)->Dequeue();
+    NS_LOG_LOGIC("Popped from band " << band << ": " << item);
+    return item;
+}
+
+Ptr<const QueueDiscItem>
+DeadlineQueueDisc::DoPeek()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t band = FindFirstQueue();
+    if (band == GetNInternalQueues())
+    {
+        NS_LOG_LOGIC("Queue empty");
+        return nullptr;
+    }
+    return GetInternalQueue(band)->Peek();
+}
+
+bool
+DeadlineQueueDisc::CheckConfig()
+{
+    NS_LOG_FUNCTION(this);
+    if (GetNQueueDiscClasses() > 0)
+    {
+        NS_LOG_ERROR("DeadlineQueueDisc cannot have classes");
+        return false;
+    }
+
+    if (GetNPacketFilters() != 0)
+    {
+        NS_LOG_ERROR("DeadlineQueueDisc needs no packet filter");
+        return false;
+    }
+
+    if (GetMaxSize().GetUnit() != QueueSizeUnit::BYTES)
+    {
+        NS_LOG_ERROR("DeadlineQueueDisc operates in BYTES mode");
+        return false;
+    }
+
+    uint32_t nQueues = m_mode == BANDS ? m_nBands : m_nBuckets;
+    if (GetNInternalQueues() == 0)
+    {
+        // the queue disc enforces the limit, any queue may take all of it
+        ObjectFactory factory;
+        factory.SetTypeId("ns3::DropTailQueue<QueueDiscItem>");
+        factory.Set("MaxSize", QueueSizeValue(GetMaxSize()));
+        for (uint32_t i = 0; i < nQueues; i++)
+        {
+            AddInternalQueue(factory.Create<InternalQueue>());
+        }
+    }
+
+    if (GetNInternalQueues() != nQueues)
+    {
+        NS_LOG_ERROR("DeadlineQueueDisc needs " << nQueues << " internal queues");
+        return false;
+    }
+    return true;
+}
+
+void
+DeadlineQueueDisc::InitializeParams()
+{
+    NS_LOG_FUNCTION(this);
+    m_firstSlot = Simulator::Now().GetTimeStep() / m_bucketWidth.GetTimeStep();
+}
+
+} // namespace ns3
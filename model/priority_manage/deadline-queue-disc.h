@@ -0,0 +1,111 @@
+#ifndef DEADLINE_QUEUE_DISC_H
+#define DEADLINE_QUEUE_DISC_H
+
+#include "ns3/nstime.h"
+#include "ns3/queue-disc.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A queue disc that orders packets by their remaining delay budget.
+ *
+ * The remaining budget of a packet is its BudgetTag past its TimestampTag.
+ * In BANDS mode, the packets go to NBands internal queues served in strict
+ * priority: band b holds the packets with b BandWidth of budget left, the
+ * last band also the packets that are further from their deadline or carry
+ * no budget.  In EDF mode, the internal queues are the NBuckets buckets of a
+ * calendar queue of BucketWidth each: a packet goes to the bucket of its
+ * deadline, and the earliest non-empty bucket is served first, in FIFO order
+ * within a bucket.  Deadlines already past go to the earliest bucket and
+ * deadlines beyond the calendar, or missing, to the latest, so that both
+ * enqueue and dequeue take constant time.
+ *
+ * Like DDRQueueDisc, GetQueueStatus () reports the occupancy level of the
+ * queue disc, and GetBandStatus () that of one band or bucket.
+ */
+class DeadlineQueueDisc : public QueueDisc
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \brief DeadlineQueueDisc Constructor
+     */
+    DeadlineQueueDisc();
+
+    /**
+     * \brief Destructor
+     */
+    ~DeadlineQueueDisc() override;
+
+    /// How the packets are ordered
+    enum Mode
+    {
+        BANDS, //!< strict priority bands of remaining budget
+        EDF    //!< earliest deadline first, in a calendar queue
+    };
+
+    // Reasons for dropping packets
+    static constexpr const char* LIMIT_EXCEEDED_DROP =
+        "Queue disc limit exceeded"; //!< Packet dropped due to queue disc limit exceeded
+
+    /**
+     * \param levels the number of queue occupancy levels
+     * \return the occupancy level of the queue disc, levels when it is full
+     */
+    uint32_t GetQueueStatus(uint32_t levels = 10);
+
+    /**
+     * \param band the band, or the bucket in EDF mode
+     * \param levels the number of queue occupancy levels
+     * \return the share of the queue disc limit the band takes, in levels
+     */
+    uint32_t GetBandStatus(uint32_t band, uint32_t levels = 10);
+
+    /**
+     * \param item a packet
+     * \return the deadline of the packet, or Time::Max () if it has no budget
+     */
+    static Time GetDeadline(Ptr<const QueueDiscItem> item);
+
+  private:
+    bool DoEnqueue(Ptr<QueueDiscItem> item) override;
+    Ptr<QueueDiscItem> DoDequeue() override;
+    Ptr<const QueueDiscItem> DoPeek() override;
+    bool CheckConfig() override;
+    void InitializeParams() override;
+
+    /**
+     * \param item a packet
+     * \return the internal queue of the packet
+     */
+    uint32_t EnqueueClassify(Ptr<QueueDiscItem> item);
+
+    /**
+     * \brief Find the first internal queue with a packet, moving the calendar
+     * past the empty buckets in EDF mode.
+     * \return the queue, or the number of queues if the queue disc is empty
+     */
+    uint32_t FindFirstQueue();
+
+    Mode m_mode;          //!< how the packets are ordered
+    uint32_t m_nBands;    //!< number of bands in BANDS mode
+    Time m_bandWidth;     //!< budget covered by a band
+    uint32_t m_nBuckets;  //!< number of buckets in EDF mode
+    Time m_bucketWidth;   //!< deadlines covered by a bucket
+    uint64_t m_firstSlot; //!< calendar slot of the earliest bucket
+};
+
+} // namespace ns3
+
+#endif /* DEADLINE_QUEUE_DISC_H */
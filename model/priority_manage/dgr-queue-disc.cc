@@ -1,6 +1,7 @@
 #include "dgr-queue-disc.h"
 
 #include "../datapath/romam-tags.h"
+#include "occupancy-sampler.h"
 
 #include "ns3/attribute.h"
 #include "ns3/drop-tail-queue.h"
@@ -11,6 +12,8 @@
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+
 #define FAST_LANE 0
 #define SLOW_LANE 1
 #define NORMAL_LANE 2
@@ -34,15 +37,56 @@ DGRQueueDisc::GetTypeId()
                           "The maximum number of packets accepted by this queue disc.",
                           QueueSizeValue(QueueSize("1085p")),
                           MakeQueueSizeAccessor(&QueueDisc::SetMaxSize, &QueueDisc::GetMaxSize),
-                          MakeQueueSizeChecker());
+                          MakeQueueSizeChecker())
+            .AddAttribute("FastLaneRate",
+                          "Rate of the token bucket that polices the fast lane, whose packets "
+                          "out of profile go to the slow lane; 0 for no policing",
+                          DataRateValue(DataRate(0)),
+                          MakeDataRateAccessor(&DGRQueueDisc::m_fastLaneRate),
+                          MakeDataRateChecker())
+            .AddAttribute("FastLaneBurst",
+                          "Size of the token bucket of FastLaneRate, in bytes",
+                          UintegerValue(15000),
+                          MakeUintegerAccessor(&DGRQueueDisc::m_fastLaneBurst),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("BackgroundLane",
+                          "Lane of the fluid background load of AddBackgroundRate ()",
+                          UintegerValue(NORMAL_LANE),
+                          MakeUintegerAccessor(&DGRQueueDisc::m_backgroundLane),
+                          MakeUintegerChecker<uint32_t>(FAST_LANE, NORMAL_LANE))
+            .AddAttribute("BackgroundLinkRate",
+                          "Rate the link sends the fluid background load at; 0 for the "
+                          "DataRate attribute of the device",
+                          DataRateValue(DataRate(0)),
+                          MakeDataRateAccessor(&DGRQueueDisc::m_backgroundLinkRate),
+                          MakeDataRateChecker())
+            .AddAttribute("BackgroundPacketSize",
+                          "Bytes of the fluid background load counted as a packet of its lane",
+                          UintegerValue(1500),
+                          MakeUintegerAccessor(&DGRQueueDisc::m_backgroundPacketSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddTraceSource("Congestion",
+                            "The congested lanes, bit i for lane i, a lane being congested "
+                            "when it holds 3/4 of its limit or more",
+                            MakeTraceSourceAccessor(&DGRQueueDisc::m_congestion),
+                            "ns3::TracedValueCallback::Uint32");
 
     return tid;
 }
 
 DGRQueueDisc::DGRQueueDisc()
-    : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS)
+    : QueueDisc(QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
+      m_congestion(0),
+      m_levelGeneration(0),
+      m_fastLaneRate(0),
+      m_fastLaneBurst(15000),
+      m_backgroundLane(NORMAL_LANE),
+      m_backgroundLinkRate(0),
+      m_backgroundPacketSize(1500)
 {
     NS_LOG_FUNCTION(this);
+    std::fill(m_laneLength, m_laneLength + N_LANES, 0);
+    std::fill(m_laneLimit, m_laneLimit + N_LANES, 0);
 }
 
 DGRQueueDisc::~DGRQueueDisc()
@@ -50,10 +94,99 @@ DGRQueueDisc::~DGRQueueDisc()
     NS_LOG_FUNCTION(this);
 }
 
+bool
+DGRQueueDisc::IsCongested(uint32_t lane) const
+{
+    NS_ASSERT(lane < N_LANES);
+    if (lane == m_backgroundLane && m_background.IsEnabled())
+    {
+        return GetLaneLength(lane) * 4 >= m_laneLimit[lane] * 3;
+    }
+    return (m_congestion.Get() >> lane) & 1;
+}
+
+uint32_t
+DGRQueueDisc::GetLaneLength(uint32_t lane) const
+{
+    NS_ASSERT(lane < N_LANES);
+    if (lane != m_backgroundLane)
+    {
+        return m_laneLength[lane];
+    }
+    return m_laneLength[lane] + m_background.GetBacklog() / m_backgroundPacketSize;
+}
+
+uint64_t
+DGRQueueDisc::GetFastLaneDemotions() const
+{
+    return m_policer.GetDemotions();
+}
+
+void
+DGRQueueDisc::AddBackgroundRate(Time start, DataRate rate)
+{
+    NS_LOG_FUNCTION(this << start << rate);
+    m_background.AddRate(start, rate);
+}
+
+const FluidLoad&
+DGRQueueDisc::GetBackgroundLoad() const
+{
+    return m_background;
+}
+
+bool
+DGRQueueDisc::HoldLane(uint32_t lane)
+{
+    if (!m_background.IsEnabled() || lane < m_backgroundLane)
+    {
+        return false;
+    }
+    Time now = Simulator::Now();
+    Time ready = now;
+    if (lane == m_backgroundLane)
+    {
+        ready = m_background.GetReadyTime();
+    }
+    else if (m_background.GetBacklog() > 0)
+    {
+        // the load of a lane served before waits for no packet of this one
+        ready = now + m_background.GetDrainTime();
+    }
+    if (ready <= now)
+    {
+        return false;
+    }
+    if (!m_backgroundWake.IsRunning() || Simulator::GetDelayLeft(m_backgroundWake) > ready - now)
+    {
+        m_backgroundWake.Cancel();
+        m_backgroundWake = Simulator::Schedule(ready - now, &QueueDisc::Run, this);
+    }
+    NS_LOG_LOGIC("Lane " << lane << " held behind the background load until " << ready);
+    return true;
+}
+
+void
+DGRQueueDisc::UpdateCongestion(uint32_t lane)
+{
+    uint32_t bit = 1u << lane;
+    // integer form of m_laneLength >= m_laneLimit * 0.75
+    uint32_t congestion = GetLaneLength(lane) * 4 >= m_laneLimit[lane] * 3
+                              ? m_congestion.Get() | bit
+                              : m_congestion.Get() & ~bit;
+    if (congestion != m_congestion.Get())
+    {
+        m_congestion = congestion;
+        m_levelGeneration++;
+    }
+}
+
 void
 DGRQueueDisc::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    m_backgroundWake.Cancel();
+    OccupancySampler::Remove(this);
     QueueDisc::DoDispose();
 }
 
@@ -62,17 +195,41 @@ DGRQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
 {
     NS_LOG_FUNCTION(this << item);
     uint32_t lane = EnqueueClassify(item);
-    if (lane == 0 && GetInternalQueue(lane)->GetCurrentSize().GetValue() >= LinesSize[lane])
+    if (lane == FAST_LANE && m_laneLength[lane] >= LinesSize[lane])
     {
         lane += 1;
     }
+    else if (lane == FAST_LANE && !m_policer.Conform(item->GetSize()))
+    {
+        NS_LOG_LOGIC("Out of profile, demoted to the slow lane");
+        lane = SLOW_LANE;
+    }
+    if (lane == m_backgroundLane && m_background.IsEnabled())
+    {
+        m_background.Advance();
+        if (GetLaneLength(lane) >= m_laneLimit[lane])
+        {
+            NS_LOG_LOGIC("Lane full of background load -- drop packet");
+            DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP);
+            return false;
+        }
+    }
     bool retval = GetInternalQueue(lane)->Enqueue(item);
     if (!retval)
     {
         NS_LOG_WARN("Packet enqueue failed. Check the size of the internal queues");
     }
+    else
+    {
+        if (lane == m_backgroundLane)
+        {
+            m_background.Arrive();
+        }
+        m_laneLength[lane]++;
+        UpdateCongestion(lane);
+    }
 
-    NS_LOG_LOGIC("Number packets lane" << lane << ":" << GetInternalQueue(lane)->GetNPackets());
+    NS_LOG_LOGIC("Number packets lane" << lane << ":" << m_laneLength[lane]);
     return retval;
 }
 
@@ -83,11 +240,26 @@ DGRQueueDisc::DoDequeue()
     Ptr<QueueDiscItem> item;
     for (uint32_t i = 0; i < GetNInternalQueues(); i++)
     {
+        if (m_laneLength[i] == 0)
+        {
+            continue;
+        }
+        if (HoldLane(i))
+        {
+            return nullptr; // the lanes after it wait as well
+        }
         item = GetInternalQueue(i)->Dequeue();
         if (item != nullptr)
         {
+            if (i == m_backgroundLane)
+            {
+                m_background.Depart();
+            }
+            m_background.Serve(item->GetSize());
+            m_laneLength[i]--;
+            UpdateCongestion(i);
             NS_LOG_LOGIC("Popped from band " << i << ": " << item);
-            NS_LOG_LOGIC("Number packets band " << i << ": " << GetInternalQueue(i)->GetNPackets());
+            NS_LOG_LOGIC("Number packets band " << i << ": " << m_laneLength[i]);
             return item;
         }
     }
@@ -168,15 +340,29 @@ void
 DGRQueueDisc::InitializeParams()
 {
     NS_LOG_FUNCTION(this);
+    m_congestion = 0;
+    m_background.SetLinkRate(m_backgroundLinkRate.GetBitRate() > 0
+                                 ? m_backgroundLinkRate
+                                 : FluidLoad::GetDeviceRate(this));
+    m_background.SetLimit(GetInternalQueue(m_backgroundLane)->GetMaxSize().GetValue() *
+                          m_backgroundPacketSize);
+    for (uint32_t lane = 0; lane < N_LANES; lane++)
+    {
+        m_laneLength[lane] = GetInternalQueue(lane)->GetNPackets();
+        m_laneLimit[lane] = GetInternalQueue(lane)->GetMaxSize().GetValue();
+        UpdateCongestion(lane);
+    }
+    m_policer.SetProfile(m_fastLaneRate, m_fastLaneBurst);
+    OccupancySampler::Add(this);
 }
 
 uint32_t
 DGRQueueDisc::EnqueueClassify(Ptr<QueueDiscItem> item)
 {
-    PriorityTag priorityTag;
-    if (item->GetPacket()->PeekPacketTag(priorityTag))
+    RomamMetaTag metaTag;
+    if (RomamMetaTag::Peek(item->GetPacket(), metaTag) && metaTag.HasPriority())
     {
-        uint32_t priority = priorityTag.GetPriority();
+        uint32_t priority = metaTag.GetPriority();
         switch (priority)
         {
         case 0x00:
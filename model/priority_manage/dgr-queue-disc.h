@@ -1,6 +1,9 @@
 #ifndef TEST_QUEUE_DISC_H
 #define TEST_QUEUE_DISC_H
 
+#include "fast-lane-policer.h"
+#include "fluid-load.h"
+
 #include "ns3/boolean.h"
 #include "ns3/data-rate.h"
 #include "ns3/event-id.h"
@@ -45,6 +48,63 @@ class DGRQueueDisc : public QueueDisc
     static constexpr const char* LIMIT_EXCEEDED_DROP =
         "Queue disc limit exceeded"; //!< Packet dropped due to queue disc limit exceeded
 
+    /// the lanes, fast, slow and normal
+    static const uint32_t N_LANES = 3;
+
+    /**
+     * \brief Whether a lane holds 3/4 of its limit or more, which the
+     * enqueues and dequeues keep up to date and trace as Congestion.
+     *
+     * The background load counts at the time of the call, while the trace
+     * only follows it at the packets.
+     *
+     * \param lane the lane
+     * \return true if the lane is congested
+     */
+    bool IsCongested(uint32_t lane) const;
+
+    /**
+     * \brief Get a counter of the changes of the Congestion trace, which
+     * never goes back, for the caches of the decisions taken on it.
+     *
+     * Like the trace, the counter follows the background load at the packets
+     * only.
+     *
+     * \return the generation of the congested lanes
+     */
+    uint32_t GetLevelGeneration() const;
+
+    /**
+     * \param lane the lane
+     * \return the packets queued in the lane, the background load included in
+     * packets of BackgroundPacketSize
+     */
+    uint32_t GetLaneLength(uint32_t lane) const;
+
+    /**
+     * \return the fast lane packets the FastLaneRate policer demoted to the
+     * slow lane
+     */
+    uint64_t GetFastLaneDemotions() const;
+
+    /**
+     * \brief Add a step to the schedule of the fluid background load of the
+     * BackgroundLane.
+     *
+     * The load counts in the length of the lane, and the real packets of the
+     * lane and of the lanes after it wait for the load queued before them to
+     * be sent.  See FluidLoad.
+     *
+     * \param start the time the rate starts at
+     * \param rate the rate of the load from start to the next step
+     */
+    void AddBackgroundRate(Time start, DataRate rate);
+
+    /**
+     * \return the fluid background load
+     */
+    const FluidLoad& GetBackgroundLoad() const;
+
   protected:
     /**
      * \brief Dispose of the object
@@ -59,9 +119,43 @@ class DGRQueueDisc : public QueueDisc
     Ptr<const QueueDiscItem> DoPeek();
     uint32_t EnqueueClassify(Ptr<QueueDiscItem> item);
 
+    /**
+     * \brief Update the bit of a lane in m_congestion after its length changed.
+     * \param lane the lane
+     */
+    void UpdateCongestion(uint32_t lane);
+
+    /**
+     * \brief Keep the packets of a lane while the background load ahead of
+     * them is sent, and run the queue disc again once it is.
+     * \param lane the lane of the next packet to send
+     * \return true if the packet must wait
+     */
+    bool HoldLane(uint32_t lane);
+
     uint32_t LinesSize[3] = {17, 28, 1000};
+
+    uint32_t m_laneLength[N_LANES];     //!< packets queued, by lane
+    uint32_t m_laneLimit[N_LANES];      //!< limit in packets, by lane, 0 until initialized
+    TracedValue<uint32_t> m_congestion; //!< bit i set if lane i is congested
+    uint32_t m_levelGeneration;         //!< bumped when m_congestion changes
+    DataRate m_fastLaneRate;            //!< rate of the fast lane, 0 for no policing
+    uint32_t m_fastLaneBurst;           //!< burst of the fast lane, in bytes
+    FastLanePolicer m_policer;          //!< polices the fast lane
+
+    FluidLoad m_background;          //!< the fluid background load
+    uint32_t m_backgroundLane;       //!< lane of the background load
+    DataRate m_backgroundLinkRate;   //!< rate draining the load, 0 for the one of the device
+    uint32_t m_backgroundPacketSize; //!< bytes of load counted as a packet of the lane
+    EventId m_backgroundWake;        //!< runs the queue disc once the load ahead is sent
 };
 
+inline uint32_t
+DGRQueueDisc::GetLevelGeneration() const
+{
+    return m_levelGeneration;
+}
+
 } // namespace ns3
 
 #endif /* TEST_QUEUE_DISC_H */
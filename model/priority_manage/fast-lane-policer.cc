@@ -0,0 +1,65 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "fast-lane-policer.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FastLanePolicer");
+
+FastLanePolicer::FastLanePolicer()
+    : m_rate(0),
+      m_burst(0),
+      m_tokens(0),
+      m_demotions(0)
+{
+}
+
+void
+FastLanePolicer::SetProfile(DataRate rate, uint32_t burst)
+{
+    NS_LOG_FUNCTION(this << rate << burst);
+    m_rate = rate.GetBitRate() / 8.0;
+    m_burst = burst;
+    m_tokens = burst;
+    m_last = Simulator::Now();
+}
+
+bool
+FastLanePolicer::IsEnabled() const
+{
+    return m_rate > 0;
+}
+
+bool
+FastLanePolicer::Conform(uint32_t size)
+{
+    if (m_rate <= 0)
+    {
+        return true;
+    }
+    Time now = Simulator::Now();
+    m_tokens = std::min(m_burst, m_tokens + m_rate * (now - m_last).GetSeconds());
+    m_last = now;
+    if (size <= m_tokens)
+    {
+        m_tokens -= size;
+        return true;
+    }
+    NS_LOG_LOGIC("Packet of " << size << " bytes out of profile, " << m_tokens << " tokens");
+    m_demotions++;
+    return false;
+}
+
+uint64_t
+FastLanePolicer::GetDemotions() const
+{
+    return m_demotions;
+}
+
+} // namespace ns3
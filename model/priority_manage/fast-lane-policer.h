@@ -0,0 +1,67 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef FAST_LANE_POLICER_H
+#define FAST_LANE_POLICER_H
+
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+
+namespace ns3
+{
+
+/**
+ * \brief A token bucket that polices the delay sensitive lane of the DDR and
+ * DGR queue discs.
+ *
+ * The bucket fills at the rate up to the burst, in bytes, and a packet that
+ * finds the tokens of its size in it is in profile and takes them.  The queue
+ * disc demotes the packets out of profile to the next lane, so the fast lane
+ * takes in at most burst plus rate times t bytes in a time t, whatever the
+ * priority senders send, and its delay stays bounded.  The tokens
+ * are brought up to date at the packets, so a packet costs O(1) and the
+ * policer needs no event.
+ *
+ * A policer with a zero rate is off and finds every packet in profile.
+ */
+class FastLanePolicer
+{
+  public:
+    FastLanePolicer();
+
+    /**
+     * \brief Set the profile and fill the bucket.
+     * \param rate the rate of the tokens, zero for no policing
+     * \param burst the size of the bucket, in bytes
+     */
+    void SetProfile(DataRate rate, uint32_t burst);
+
+    /**
+     * \return true if the policer polices the packets
+     */
+    bool IsEnabled() const;
+
+    /**
+     * \brief Take the tokens of a packet now, if there are enough of them.
+     * \param size the size of the packet, in bytes
+     * \return true if the packet is in profile
+     */
+    bool Conform(uint32_t size);
+
+    /**
+     * \return the number of packets found out of profile
+     */
+    uint64_t GetDemotions() const;
+
+  private:
+    double m_rate;        //!< tokens per second, in bytes, 0 if off
+    double m_burst;       //!< size of the bucket, in bytes
+    double m_tokens;      //!< tokens in the bucket at m_last
+    Time m_last;          //!< when the tokens were last brought up to date
+    uint64_t m_demotions; //!< packets out of profile
+};
+
+} // namespace ns3
+
+#endif /* FAST_LANE_POLICER_H */
@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "fluid-load.h"
+
+#include "ns3/log.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/net-device.h"
+#include "ns3/queue-disc.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FluidLoad");
+
+FluidLoad::FluidLoad()
+    : m_linkRate(0),
+      m_limit(0)
+{
+    m_state.backlog = 0;
+    m_state.rate = 0;
+    m_state.next = 0;
+    m_state.offered = 0;
+    m_state.dropped = 0;
+}
+
+void
+FluidLoad::SetLinkRate(DataRate rate)
+{
+    NS_LOG_FUNCTION(this << rate);
+    Advance();
+    m_linkRate = rate.GetBitRate() / 8.0;
+}
+
+void
+FluidLoad::SetLimit(uint32_t limit)
+{
+    NS_LOG_FUNCTION(this << limit);
+    Advance();
+    m_limit = limit;
+    m_state.backlog = std::min(m_state.backlog, m_limit);
+}
+
+void
+FluidLoad::AddRate(Time start, DataRate rate)
+{
+    NS_LOG_FUNCTION(this << start << rate);
+    Advance();
+    NS_ABORT_MSG_IF(start < m_state.time, "The step at " << start << " is in the past");
+    auto step = std::make_pair(start, rate.GetBitRate() / 8.0);
+    // after the steps of the same start, which the new one overrides
+    auto i = std::upper_bound(m_steps.begin(),
+                              m_steps.end(),
+                              step,
+                              [](const std::pair<Time, double>& a,
+                                 const std::pair<Time, double>& b) { return a.first < b.first; });
+    m_steps.insert(i, step);
+}
+
+bool
+FluidLoad::IsEnabled() const
+{
+    return m_linkRate > 0 && !m_steps.empty();
+}
+
+void
+FluidLoad::Integrate(State& state, Time now) const
+{
+    while (true)
+    {
+        while (state.next < m_steps.size() && m_steps[state.next].first <= state.time)
+        {
+            state.rate = m_steps[state.next].second;
+            state.next++;
+        }
+        if (state.time >= now)
+        {
+            return;
+        }
+        Time end = now;
+        if (state.next < m_steps.size())
+        {
+            end = std::min(end, m_steps[state.next].first);
+        }
+        if (m_linkRate <= 0)
+        {
+            state.time = end; // off, the load is not offered yet
+            continue;
+        }
+        // the load only queues while the link sends the real packets, then
+        // drains at the rest of the link rate
+        Time busy = std::min(end, std::max(state.time, m_busyUntil));
+        double backlog = state.backlog + state.rate * (busy - state.time).GetSeconds();
+        if (backlog > m_limit)
+        {
+            state.dropped += backlog - m_limit;
+            backlog = m_limit;
+        }
+        // the backlog moves one way at a constant rate then, so it only
+        // crosses the limit or zero at the end
+        backlog += (state.rate - m_linkRate) * (end - busy).GetSeconds();
+        if (backlog > m_limit)
+        {
+            state.dropped += backlog - m_limit;
+            backlog = m_limit;
+        }
+        state.offered += state.rate * (end - state.time).GetSeconds();
+        state.backlog = std::max(0.0, backlog);
+        state.time = end;
+    }
+}
+
+FluidLoad::State
+FluidLoad::GetState() const
+{
+    State state = m_state;
+    Integrate(state, Simulator::Now());
+    return state;
+}
+
+void
+FluidLoad::Advance()
+{
+    Integrate(m_state, Simulator::Now());
+}
+
+uint32_t
+FluidLoad::GetBacklog() const
+{
+    if (!IsEnabled())
+    {
+        return 0;
+    }
+    return GetState().backlog;
+}
+
+Time
+FluidLoad::GetDrainTime() const
+{
+    if (!IsEnabled())
+    {
+        return Time(0);
+    }
+    Time now = Simulator::Now();
+    Time busy = m_busyUntil > now ? m_busyUntil - now : Time(0);
+    return busy + Seconds(GetState().backlog / m_linkRate);
+}
+
+bool
+FluidLoad::IsIdle() const
+{
+    if (!IsEnabled())
+    {
+        return true;
+    }
+    State state = GetState();
+    return state.backlog <= 0 && state.rate <= m_linkRate;
+}
+
+Time
+FluidLoad::GetNextStep() const
+{
+    State state = GetState();
+    return state.next < m_steps.size() ? m_steps[state.next].first : Time::Max();
+}
+
+void
+FluidLoad::Serve(uint32_t size)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+    Advance();
+    Time now = Simulator::Now();
+    m_busyUntil = std::max(now, m_busyUntil) + Seconds(size / m_linkRate);
+}
+
+void
+FluidLoad::Arrive()
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+    Advance();
+    // behind no load, the packet only waits for the real packets ahead,
+    // which the band sends in order anyway
+    Time ready = Simulator::Now();
+    if (m_state.backlog > 0)
+    {
+        ready += GetDrainTime();
+    }
+    if (!m_ready.empty())
+    {
+        ready = std::max(ready, m_ready.back());
+    }
+    m_ready.push_back(ready);
+}
+
+void
+FluidLoad::Depart()
+{
+    if (!m_ready.empty())
+    {
+        m_ready.pop_front();
+    }
+}
+
+Time
+FluidLoad::GetReadyTime() const
+{
+    return m_ready.empty() ? Simulator::Now() : m_ready.front();
+}
+
+uint64_t
+FluidLoad::GetOfferedBytes() const
+{
+    return GetState().offered;
+}
+
+uint64_t
+FluidLoad::GetDroppedBytes() const
+{
+    return GetState().dropped;
+}
+
+DataRate
+FluidLoad::GetDeviceRate(QueueDisc* disc)
+{
+    // the queue interface of a device is aggregated to it
+    Ptr<NetDeviceQueueInterface> queues = disc->GetNetDeviceQueueInterface();
+    Ptr<NetDevice> device = queues ? queues->GetObject<NetDevice>() : nullptr;
+    DataRateValue rate;
+    if (!device || !device->GetAttributeFailSafe("DataRate", rate))
+    {
+        return DataRate(0);
+    }
+    return rate.Get();
+}
+
+} // namespace ns3
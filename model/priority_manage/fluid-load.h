@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef FLUID_LOAD_H
+#define FLUID_LOAD_H
+
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+
+#include <deque>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+class QueueDisc;
+
+/**
+ * \brief A background load of a band of the DDR and DGR queue discs, as a
+ * fluid instead of packets.
+ *
+ * The load arrives at the rates of a schedule, each from its start time to
+ * the next, and queues in a virtual backlog the link drains at its rate
+ * when it is not sending the real packets.  The backlog is brought up to
+ * date at the packets from the schedule steps in between, so the load costs
+ * no event and a packet O(1) plus the steps it crosses.  The backlog is
+ * limited to the bytes of the band, the load beyond being dropped.
+ *
+ * The queue disc counts the backlog in the occupancy of the band, and holds
+ * the real packets of the band until the load queued before them is sent:
+ * Arrive () gives a packet the time the backlog it finds drains at, which
+ * GetReadyTime () returns for the packet at the head of the band.
+ *
+ * A load without steps or link rate is off.
+ */
+class FluidLoad
+{
+  public:
+    FluidLoad();
+
+    /**
+     * \param rate the rate the link sends at, zero for no load
+     */
+    void SetLinkRate(DataRate rate);
+
+    /**
+     * \param limit the largest backlog, in bytes
+     */
+    void SetLimit(uint32_t limit);
+
+    /**
+     * \brief Make the load arrive at a rate from a time until the next step.
+     * \param start the time, not before the last update of the backlog
+     * \param rate the rate of the load
+     */
+    void AddRate(Time start, DataRate rate);
+
+    /**
+     * \return true if the load has steps and a link rate
+     */
+    bool IsEnabled() const;
+
+    /**
+     * \brief Bring the backlog up to date.
+     */
+    void Advance();
+
+    /**
+     * \return the backlog now, in bytes
+     */
+    uint32_t GetBacklog() const;
+
+    /**
+     * \return the time from now until the link sent the backlog now and the
+     * real packets it sends now
+     */
+    Time GetDrainTime() const;
+
+    /**
+     * \return true if the backlog is empty and stays so until the next step
+     */
+    bool IsIdle() const;
+
+    /**
+     * \return the start of the next step, or Time::Max () if none is left
+     */
+    Time GetNextStep() const;
+
+    /**
+     * \brief The link sends a real packet now, so does not drain the backlog
+     * for the time of the packet.
+     * \param size the size of the packet, in bytes
+     */
+    void Serve(uint32_t size);
+
+    /**
+     * \brief A real packet enters the band now, behind the backlog.
+     */
+    void Arrive();
+
+    /**
+     * \brief The real packet at the head of the band leaves it.
+     */
+    void Depart();
+
+    /**
+     * \return the time the packet at the head of the band may leave at, now
+     * if the band has none
+     */
+    Time GetReadyTime() const;
+
+    /**
+     * \return the bytes of load that arrived until now
+     */
+    uint64_t GetOfferedBytes() const;
+
+    /**
+     * \return the bytes of load dropped until now
+     */
+    uint64_t GetDroppedBytes() const;
+
+    /**
+     * \param disc a queue disc at the root of a device
+     * \return the DataRate attribute of the device, zero if none
+     */
+    static DataRate GetDeviceRate(QueueDisc* disc);
+
+  private:
+    /// the backlog at a time
+    struct State
+    {
+        Time time;      //!< the time
+        double backlog; //!< bytes queued
+        double rate;    //!< rate of the load in bytes/s
+        uint32_t next;  //!< index of the first step after the time
+        double offered; //!< bytes arrived
+        double dropped; //!< bytes dropped
+    };
+
+    /**
+     * \brief Bring a state up to a time.
+     * \param state the state
+     * \param now the time, not before the one of the state
+     */
+    void Integrate(State& state, Time now) const;
+
+    /**
+     * \return the state now
+     */
+    State GetState() const;
+
+    double m_linkRate;                            //!< rate of the link in bytes/s, 0 if off
+    double m_limit;                               //!< largest backlog, in bytes
+    std::vector<std::pair<Time, double>> m_steps; //!< start and rate in bytes/s, by start
+    State m_state;                                //!< the backlog at the last update
+    Time m_busyUntil;                             //!< end of the real packets sent
+    std::deque<Time> m_ready;                     //!< leave time of the real packets, in order
+};
+
+} // namespace ns3
+
+#endif /* FLUID_LOAD_H */
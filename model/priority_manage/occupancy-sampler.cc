@@ -0,0 +1,342 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "occupancy-sampler.h"
+
+#include "ns3/assert.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/queue-disc.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("OccupancySampler");
+
+/// time from one sample of the queue discs to the next
+static GlobalValue g_occupancyInterval(
+    "RomamOccupancyInterval",
+    "Time from one sample of the occupancy of the DDR and DGR queue discs to the next "
+    "(0 to not sample them)",
+    TimeValue(Seconds(0)),
+    MakeTimeChecker(Seconds(0)));
+
+/// samples of a bucket of the occupancy series
+static GlobalValue g_occupancySamples("RomamOccupancySamples",
+                                      "Samples of the occupancy of a queue disc a bucket of "
+                                      "its series takes the minimum, maximum and mean of",
+                                      UintegerValue(10),
+                                      MakeUintegerChecker<uint32_t>(1));
+
+/// buckets kept of the occupancy series of a queue disc
+static GlobalValue g_occupancyBuckets("RomamOccupancyBuckets",
+                                      "Buckets of the occupancy series of a queue disc kept "
+                                      "for the file, the oldest being overwritten beyond",
+                                      UintegerValue(4096),
+                                      MakeUintegerChecker<uint32_t>(1));
+
+/// file the occupancy series are written to
+static GlobalValue g_occupancyFile("RomamOccupancyFile",
+                                   "File the occupancy series of the queue discs are written "
+                                   "to when the simulator is destroyed",
+                                   StringValue("romam-occupancy.bin"),
+                                   MakeStringChecker());
+
+/// the magic of a file of occupancy series
+static const char OCCUPANCY_MAGIC[8] = {'R', 'O', 'M', 'A', 'M', 'O', 'C', 'C'};
+/// layout of the file, to be changed along with the structures below
+static const uint32_t OCCUPANCY_FORMAT = 1;
+
+/// beginning of the file
+struct OccupancyFileHeader
+{
+    char magic[8];             //!< OCCUPANCY_MAGIC
+    uint32_t format;           //!< OCCUPANCY_FORMAT
+    uint32_t nSeries;          //!< series that follow
+    int64_t start;             //!< time of the first sample, in ns
+    int64_t interval;          //!< time from one sample to the next, in ns
+    uint32_t samplesPerBucket; //!< samples of a full bucket
+    uint32_t reserved;         //!< 0
+};
+
+static_assert(sizeof(OccupancyFileHeader) == 40, "OccupancyFileHeader must have no padding");
+static_assert(sizeof(OccupancySampler::SeriesHeader) == 40, "SeriesHeader must have no padding");
+static_assert(sizeof(OccupancySampler::Bucket) == 16, "Bucket must have no padding");
+
+OccupancySampler* OccupancySampler::s_sampler = nullptr;
+
+OccupancySampler::OccupancySampler()
+    : m_bucket(0),
+      m_nSamples(0),
+      m_nLive(0)
+{
+    TimeValue interval;
+    g_occupancyInterval.GetValue(interval);
+    m_interval = interval.Get();
+    UintegerValue samples;
+    g_occupancySamples.GetValue(samples);
+    m_samplesPerBucket = samples.Get();
+    UintegerValue buckets;
+    g_occupancyBuckets.GetValue(buckets);
+    m_capacity = buckets.Get();
+    StringValue path;
+    g_occupancyFile.GetValue(path);
+    m_path = path.Get();
+    m_start = Simulator::Now() + m_interval;
+}
+
+bool
+OccupancySampler::IsEnabled()
+{
+    TimeValue interval;
+    g_occupancyInterval.GetValue(interval);
+    return interval.Get().IsStrictlyPositive();
+}
+
+void
+OccupancySampler::Add(Ptr<QueueDisc> qdisc)
+{
+    NS_LOG_FUNCTION(qdisc);
+    if (!IsEnabled())
+    {
+        return;
+    }
+    if (!s_sampler)
+    {
+        s_sampler = new OccupancySampler();
+        Simulator::ScheduleDestroy(&OccupancySampler::Destroy);
+    }
+    OccupancySampler& sampler = *s_sampler;
+    if (sampler.m_nLive++ == 0)
+    {
+        sampler.Start();
+    }
+
+    Series series;
+    series.qdisc = PeekPointer(qdisc);
+    series.header.nodeId = UINT32_MAX;
+    series.header.ifIndex = UINT32_MAX;
+    Ptr<NetDeviceQueueInterface> queueInterface = qdisc->GetNetDeviceQueueInterface();
+    Ptr<NetDevice> device = queueInterface ? queueInterface->GetObject<NetDevice>() : nullptr;
+    if (device)
+    {
+        series.header.nodeId = device->GetNode()->GetId();
+        series.header.ifIndex = device->GetIfIndex();
+    }
+    series.header.bytes = qdisc->GetMaxSize().GetUnit() == QueueSizeUnit::BYTES;
+    series.header.limit = qdisc->GetMaxSize().GetValue();
+    series.header.firstBucket = sampler.m_bucket;
+    series.header.nLost = 0;
+    series.header.nBuckets = 0;
+    series.header.reserved = 0;
+    series.head = 0;
+    series.min = UINT32_MAX;
+    series.max = 0;
+    series.sum = 0;
+    series.nSamples = 0;
+    sampler.m_series.push_back(series);
+    sampler.m_buckets.resize(sampler.m_series.size() * sampler.m_capacity);
+}
+
+void
+OccupancySampler::Remove(const QueueDisc* qdisc)
+{
+    if (!s_sampler)
+    {
+        return;
+    }
+    for (Series& series : s_sampler->m_series)
+    {
+        if (series.qdisc == qdisc)
+        {
+            NS_LOG_FUNCTION(qdisc);
+            s_sampler->CloseBucket(series);
+            series.qdisc = nullptr;
+            if (--s_sampler->m_nLive == 0)
+            {
+                s_sampler->m_event.Cancel();
+            }
+            return;
+        }
+    }
+}
+
+void
+OccupancySampler::Start()
+{
+    // the samples missed while no queue disc was left are skipped, not taken
+    Time now = Simulator::Now();
+    uint64_t next = 0;
+    if (now >= m_start)
+    {
+        next = (now - m_start).GetTimeStep() / m_interval.GetTimeStep() + 1;
+    }
+    m_bucket = next / m_samplesPerBucket;
+    m_nSamples = next % m_samplesPerBucket;
+    Time at = TimeStep(m_start.GetTimeStep() + m_interval.GetTimeStep() * next);
+    m_event = Simulator::Schedule(at - now, &OccupancySampler::Sample, this);
+}
+
+void
+OccupancySampler::Sample()
+{
+    for (Series& series : m_series)
+    {
+        if (!series.qdisc)
+        {
+            continue;
+        }
+        // O(1): the queue disc counts its packets and bytes
+        uint32_t value = series.qdisc->GetCurrentSize().GetValue();
+        series.min = std::min(series.min, value);
+        series.max = std::max(series.max, value);
+        series.sum += value;
+        series.nSamples++;
+    }
+    if (++m_nSamples == m_samplesPerBucket)
+    {
+        for (Series& series : m_series)
+        {
+            CloseBucket(series);
+        }
+        m_bucket++;
+        m_nSamples = 0;
+    }
+    if (m_nLive > 0)
+    {
+        m_event = Simulator::Schedule(m_interval, &OccupancySampler::Sample, this);
+    }
+}
+
+void
+OccupancySampler::CloseBucket(Series& series)
+{
+    if (series.nSamples == 0)
+    {
+        return;
+    }
+    std::size_t ring = (&series - m_series.data()) * static_cast<std::size_t>(m_capacity);
+    uint32_t slot = series.head + series.header.nBuckets;
+    if (slot >= m_capacity)
+    {
+        slot -= m_capacity;
+    }
+    if (series.header.nBuckets == m_capacity)
+    {
+        // the ring is full, the new bucket takes the place of the oldest one
+        series.head = series.head + 1 == m_capacity ? 0 : series.head + 1;
+        series.header.firstBucket++;
+        series.header.nLost++;
+    }
+    else
+    {
+        series.header.nBuckets++;
+    }
+    Bucket& bucket = m_buckets[ring + slot];
+    bucket.min = series.min;
+    bucket.max = series.max;
+    bucket.mean = static_cast<float>(static_cast<double>(series.sum) / series.nSamples);
+    bucket.nSamples = series.nSamples;
+    series.min = UINT32_MAX;
+    series.max = 0;
+    series.sum = 0;
+    series.nSamples = 0;
+}
+
+void
+OccupancySampler::Destroy()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT(s_sampler);
+    OccupancySampler& sampler = *s_sampler;
+    sampler.m_event.Cancel();
+    for (Series& series : sampler.m_series)
+    {
+        sampler.CloseBucket(series);
+    }
+
+    OccupancyFileHeader header;
+    std::memcpy(header.magic, OCCUPANCY_MAGIC, sizeof(header.magic));
+    header.format = OCCUPANCY_FORMAT;
+    header.nSeries = sampler.m_series.size();
+    header.start = sampler.m_start.GetNanoSeconds();
+    header.interval = sampler.m_interval.GetNanoSeconds();
+    header.samplesPerBucket = sampler.m_samplesPerBucket;
+    header.reserved = 0;
+    std::ofstream out(sampler.m_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (std::size_t i = 0; i < sampler.m_series.size(); i++)
+    {
+        const Series& series = sampler.m_series[i];
+        out.write(reinterpret_cast<const char*>(&series.header), sizeof(series.header));
+        const Bucket* ring = sampler.m_buckets.data() + i * sampler.m_capacity;
+        uint32_t first = std::min(series.header.nBuckets, sampler.m_capacity - series.head);
+        out.write(reinterpret_cast<const char*>(ring + series.head), first * sizeof(Bucket));
+        out.write(reinterpret_cast<const char*>(ring),
+                  (series.header.nBuckets - first) * sizeof(Bucket));
+    }
+    if (!out)
+    {
+        NS_LOG_WARN("Cannot write the occupancy series to " << sampler.m_path);
+    }
+    else
+    {
+        NS_LOG_LOGIC("Wrote " << sampler.m_series.size() << " occupancy series to "
+                              << sampler.m_path);
+    }
+    delete s_sampler;
+    s_sampler = nullptr;
+}
+
+bool
+OccupancySampler::Decode(std::istream& is, std::ostream& os)
+{
+    OccupancyFileHeader header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, OCCUPANCY_MAGIC, sizeof(header.magic)) != 0 ||
+        header.format != OCCUPANCY_FORMAT)
+    {
+        return false;
+    }
+    int64_t span = header.interval * header.samplesPerBucket;
+    os << "node,ifindex,unit,limit,start_ns,min,max,mean,samples\n";
+    std::vector<Bucket> buckets;
+    for (uint32_t i = 0; i < header.nSeries; i++)
+    {
+        SeriesHeader series;
+        if (!is.read(reinterpret_cast<char*>(&series), sizeof(series)))
+        {
+            return false;
+        }
+        if (series.nLost > 0)
+        {
+            os << "# " << series.nLost << " buckets lost\n";
+        }
+        buckets.resize(series.nBuckets);
+        if (!is.read(reinterpret_cast<char*>(buckets.data()), buckets.size() * sizeof(Bucket)))
+        {
+            return false;
+        }
+        for (uint32_t b = 0; b < series.nBuckets; b++)
+        {
+            const Bucket& bucket = buckets[b];
+            os << static_cast<int32_t>(series.nodeId) << ','
+               << static_cast<int32_t>(series.ifIndex) << ','
+               << (series.bytes ? "bytes" : "packets") << ',' << series.limit << ','
+               << header.start + (series.firstBucket + b) * span << ',' << bucket.min << ','
+               << bucket.max << ',' << bucket.mean << ',' << bucket.nSamples << '\n';
+        }
+    }
+    return true;
+}
+
+} // namespace ns3
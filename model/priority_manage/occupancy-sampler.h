@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef OCCUPANCY_SAMPLER_H
+#define OCCUPANCY_SAMPLER_H
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <istream>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class QueueDisc;
+
+/**
+ * \brief Time series of the occupancy of the DDR and DGR queue discs,
+ * sampled at fixed intervals.
+ *
+ * A single simulator event samples every queue disc registered, every
+ * RomamOccupancyInterval, reading the size the queue disc keeps of itself,
+ * so the enqueues and dequeues pay nothing.  RomamOccupancySamples samples
+ * make a bucket of their minimum, maximum and mean, kept in a ring of
+ * RomamOccupancyBuckets buckets per queue disc allocated when the queue disc
+ * registers; the oldest buckets of a ring are overwritten, and counted as
+ * lost, when a run takes more buckets than that.
+ *
+ * The series are written to RomamOccupancyFile when the simulator is
+ * destroyed: a header of the magic "ROMAMOCC", the format, the number of
+ * series, the interval and the samples per bucket, then each series as a
+ * SeriesHeader and its buckets, oldest first, all in the byte order of the
+ * host that wrote it.  Decode () prints the file as CSV.
+ *
+ * The sampler is off while RomamOccupancyInterval is zero.  Once on, its event
+ * runs until the last queue disc is disposed, so a run is to be ended with
+ * Simulator::Stop ().
+ */
+class OccupancySampler
+{
+  public:
+    /// a bucket of samples
+    struct Bucket
+    {
+        uint32_t min;      //!< smallest sample
+        uint32_t max;      //!< largest sample
+        float mean;        //!< mean of the samples
+        uint32_t nSamples; //!< samples of the bucket, less than a full bucket at the ends
+    };
+
+    /// the description of a series in the file
+    struct SeriesHeader
+    {
+        uint32_t nodeId;      //!< node of the queue disc, UINT32_MAX if unknown
+        uint32_t ifIndex;     //!< device of the queue disc, UINT32_MAX if unknown
+        uint32_t bytes;       //!< 1 if the samples are bytes, 0 if packets
+        uint32_t limit;       //!< limit of the queue disc, in the unit of the samples
+        uint64_t firstBucket; //!< index of the first bucket kept, from the first sample
+        uint64_t nLost;       //!< buckets overwritten before the first one kept
+        uint32_t nBuckets;    //!< buckets that follow
+        uint32_t reserved;    //!< 0
+    };
+
+    /**
+     * \return true if the occupancy of the queue discs is to be sampled
+     */
+    static bool IsEnabled();
+
+    /**
+     * \brief Start sampling a queue disc, if the sampler is enabled.
+     * \param qdisc the queue disc, initialized
+     */
+    static void Add(Ptr<QueueDisc> qdisc);
+
+    /**
+     * \brief Stop sampling a queue disc, keeping its series for the file.
+     * \param qdisc the queue disc
+     */
+    static void Remove(const QueueDisc* qdisc);
+
+    /**
+     * \brief Print a file of series as CSV: a header line, then a line per
+     * bucket.
+     * \param is the file
+     * \param os the output stream
+     * \return false if the file is not a file of series or is truncated
+     */
+    static bool Decode(std::istream& is, std::ostream& os);
+
+  private:
+    /// a queue disc sampled
+    struct Series
+    {
+        const QueueDisc* qdisc; //!< the queue disc, null once it is disposed
+        SeriesHeader header;    //!< the description of the series
+        uint32_t head;          //!< index in the ring of the oldest bucket
+        uint32_t min;           //!< smallest sample of the open bucket
+        uint32_t max;           //!< largest sample of the open bucket
+        uint64_t sum;           //!< sum of the samples of the open bucket
+        uint32_t nSamples;      //!< samples of the open bucket
+    };
+
+    OccupancySampler();
+
+    OccupancySampler(const OccupancySampler&) = delete;
+    OccupancySampler& operator=(const OccupancySampler&) = delete;
+
+    /**
+     * \brief Schedule the next sample, on the grid of the samples from
+     * m_start, when the first queue disc is added or one is added again.
+     */
+    void Start();
+
+    /**
+     * \brief Sample the queue discs, and schedule the next sample while one
+     * of them is left.
+     */
+    void Sample();
+
+    /**
+     * \brief Close the open bucket of a series, if it has samples.
+     * \param series the series
+     */
+    void CloseBucket(Series& series);
+
+    /**
+     * \brief Write the series to the file, and delete the sampler.
+     */
+    static void Destroy();
+
+    static OccupancySampler* s_sampler; //!< the sampler of the simulation, if one
+
+    Time m_start;                  //!< time of the first sample
+    Time m_interval;               //!< time from one sample to the next
+    uint32_t m_samplesPerBucket;   //!< samples of a full bucket
+    uint32_t m_capacity;           //!< buckets of the ring of a series
+    std::string m_path;            //!< the file of the series
+    std::vector<Series> m_series;  //!< the series, by registration
+    std::vector<Bucket> m_buckets; //!< the rings of the series, m_capacity each
+    uint64_t m_bucket;             //!< index of the open bucket, from the first sample
+    uint32_t m_nSamples;           //!< samples taken in the open bucket
+    uint32_t m_nLive;              //!< series whose queue disc is not disposed
+    EventId m_event;               //!< the next Sample ()
+};
+
+} // namespace ns3
+
+#endif /* OCCUPANCY_SAMPLER_H */
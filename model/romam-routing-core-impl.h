@@ -0,0 +1,519 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROMAM_ROUTING_CORE_IMPL_H
+#define ROMAM_ROUTING_CORE_IMPL_H
+
+/*
+ * The members of RomamRoutingCore.  Only the .cc file of a routing protocol
+ * includes this file, after its NS_LOG_COMPONENT_DEFINE, whose g_log the core
+ * logs with; it is not installed with the public headers.
+ */
+
+#include "romam-routing-core.h"
+#include "utility/phase-profiler.h"
+
+#include "ns3/assert.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+
+namespace ns3
+{
+
+template <typename Derived, typename RIE>
+RomamRoutingCore<Derived, RIE>::RomamRoutingCore()
+    : m_installedRoutesKnown(true)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+template <typename Derived, typename RIE>
+RomamRoutingCore<Derived, RIE>::~RomamRoutingCore()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+template <typename Derived, typename RIE>
+Ptr<Ipv4Route>
+RomamRoutingCore<Derived, RIE>::RouteOutput(Ptr<Packet> p,
+                                            const Ipv4Header& header,
+                                            Ptr<NetDevice> oif,
+                                            Socket::SocketErrno& sockerr)
+{
+    ROMAM_HOT_LOG_FUNCTION(this << p << &header << oif << &sockerr);
+    //
+    // First, see if this is a multicast packet we have a route for.  If we
+    // have a route, then send the packet down each of the specified interfaces.
+    //
+    if (header.GetDestination().IsMulticast())
+    {
+        ROMAM_HOT_LOG_LOGIC("Multicast destination-- returning false");
+        return nullptr; // Let other routing protocols try to handle this
+    }
+    //
+    // Then if the node sends the packet to itself, the protocol being the
+    // only one of the node.
+    //
+    Ptr<Ipv4Route> local = GetLocalRoute(m_ipv4, header.GetDestination(), oif);
+    if (local)
+    {
+        ROMAM_HOT_LOG_LOGIC("Local destination- through the loopback");
+        sockerr = Socket::ERROR_NOTERROR;
+        return local;
+    }
+    //
+    // See if this is a unicast packet we have a route for.
+    //
+    ROMAM_HOT_LOG_LOGIC("Unicast destination- looking up");
+    ROMAM_LOOKUP_SCOPE();
+    int64_t start = StartLookup();
+    Ptr<Ipv4Route> rtentry = GetDerived()->SelectOutputRoute(p, header, oif);
+    FinishLookup(header.GetDestination(), start);
+    if (rtentry)
+    {
+        sockerr = Socket::ERROR_NOTERROR;
+    }
+    else
+    {
+        sockerr = Socket::ERROR_NOROUTETOHOST;
+    }
+    return rtentry;
+}
+
+template <typename Derived, typename RIE>
+bool
+RomamRoutingCore<Derived, RIE>::RouteInput(Ptr<const Packet> p,
+                                           const Ipv4Header& header,
+                                           Ptr<const NetDevice> idev,
+                                           const UnicastForwardCallback& ucb,
+                                           const MulticastForwardCallback& mcb,
+                                           const LocalDeliverCallback& lcb,
+                                           const ErrorCallback& ecb)
+{
+    ROMAM_HOT_LOG_FUNCTION(this << p << header << header.GetSource() << header.GetDestination()
+                                << idev << &lcb << &ecb);
+    // Check if input device supports IP
+    uint32_t iif = GetCachedInterfaceIndex(m_ipv4, idev);
+    NS_ASSERT(iif != NO_INTERFACE);
+    GetDerived()->ReceiveInput(p, iif);
+
+    if (IsCachedDestination(m_ipv4, header.GetDestination(), iif))
+    {
+        if (!lcb.IsNull())
+        {
+            ROMAM_HOT_LOG_LOGIC("Local delivery to " << header.GetDestination());
+            lcb(p, header, iif);
+            return true;
+        }
+        else
+        {
+            // The local delivery callback is null.  This may be a multicast
+            // or broadcast packet, so return false so that another
+            // multicast routing protocol can handle it.  It should be possible
+            // to extend this to explicitly check whether it is a unicast
+            // packet, and invoke the error callback if so
+            return false;
+        }
+    }
+
+    // Check if input device supports IP forwarding
+    if (!GetCachedInterface(m_ipv4, iif).forwarding)
+    {
+        ROMAM_HOT_LOG_LOGIC("Forwarding disabled for this interface");
+        ecb(p, header, Socket::ERROR_NOROUTETOHOST);
+        return true;
+    }
+    // Next, try to find a route
+    ROMAM_HOT_LOG_LOGIC("Unicast destination- looking up global route");
+    Ptr<Ipv4Route> rtentry;
+    {
+        ROMAM_LOOKUP_SCOPE();
+        int64_t start = StartLookup();
+        rtentry = GetDerived()->SelectInputRoute(p, header, idev);
+        FinishLookup(header.GetDestination(), start);
+    }
+    if (rtentry)
+    {
+        ROMAM_HOT_LOG_LOGIC("Found unicast destination- calling unicast callback");
+        GetDerived()->ForwardInput(rtentry, p, header, iif, ucb);
+        return true;
+    }
+    else
+    {
+        ROMAM_HOT_LOG_LOGIC("Did not find unicast destination- returning false");
+        return false; // Let other routing protocols try to handle this
+                      // route request.
+    }
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::SetIpv4(Ptr<Ipv4> ipv4)
+{
+    NS_LOG_FUNCTION(this << ipv4);
+    NS_ASSERT(!m_ipv4 && ipv4);
+    m_ipv4 = ipv4;
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::AddHostRouteTo(Ipv4Address dest,
+                                               Ipv4Address nextHop,
+                                               uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << dest << nextHop << interface);
+    GetDerived()->AddHostRoute(RIE::CreateHostRouteTo(dest, nextHop, interface));
+    MarkRoutesChanged();
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << dest << interface);
+    GetDerived()->AddHostRoute(RIE::CreateHostRouteTo(dest, interface));
+    MarkRoutesChanged();
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::AddHostRouteTo(Ipv4Address dest,
+                                               Ipv4Address nextHop,
+                                               uint32_t interface,
+                                               uint32_t nextIface,
+                                               uint32_t distance)
+{
+    NS_LOG_FUNCTION(this << dest << nextHop << interface << nextIface << distance);
+    GetDerived()->AddHostRoute(
+        Derived::MakeHostRoute(dest, nextHop, interface, nextIface, distance));
+    MarkRoutesChanged();
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::AddNetworkRouteTo(Ipv4Address network,
+                                                  Ipv4Mask networkMask,
+                                                  Ipv4Address nextHop,
+                                                  uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
+    AddPrefixRoute(m_networkRoutes,
+                   m_networkRouteTrie,
+                   RIE::CreateNetworkRouteTo(network, networkMask, nextHop, interface));
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::AddNetworkRouteTo(Ipv4Address network,
+                                                  Ipv4Mask networkMask,
+                                                  uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << network << networkMask << interface);
+    AddPrefixRoute(m_networkRoutes,
+                   m_networkRouteTrie,
+                   RIE::CreateNetworkRouteTo(network, networkMask, interface));
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::AddASExternalRouteTo(Ipv4Address network,
+                                                     Ipv4Mask networkMask,
+                                                     Ipv4Address nextHop,
+                                                     uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
+    AddPrefixRoute(m_ASexternalRoutes,
+                   m_ASexternalRouteTrie,
+                   RIE::CreateNetworkRouteTo(network, networkMask, nextHop, interface));
+}
+
+template <typename Derived, typename RIE>
+uint32_t
+RomamRoutingCore<Derived, RIE>::GetNRoutes() const
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t n = 0;
+    n += GetDerived()->GetNHostRoutes();
+    n += m_networkRoutes.size();
+    n += m_ASexternalRoutes.size();
+    return n;
+}
+
+template <typename Derived, typename RIE>
+RIE*
+RomamRoutingCore<Derived, RIE>::GetRoute(uint32_t index) const
+{
+    NS_LOG_FUNCTION(this << index);
+    uint32_t nHostRoutes = GetDerived()->GetNHostRoutes();
+    if (index < nHostRoutes)
+    {
+        return GetDerived()->GetHostRoute(index);
+    }
+    index -= nHostRoutes;
+    if (index < m_networkRoutes.size())
+    {
+        return m_prefixRoutePool.Get(m_networkRoutes[index]);
+    }
+    index -= m_networkRoutes.size();
+    NS_ASSERT(index < m_ASexternalRoutes.size());
+    return m_prefixRoutePool.Get(m_ASexternalRoutes[index]);
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::ForEachRoute(RouteCallback cb) const
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t nHostRoutes = GetDerived()->GetNHostRoutes();
+    for (uint32_t i = 0; i < nHostRoutes; i++)
+    {
+        cb(*GetDerived()->GetHostRoute(i));
+    }
+    for (typename RoutePool::Handle handle : m_networkRoutes)
+    {
+        cb(*m_prefixRoutePool.Get(handle));
+    }
+    for (typename RoutePool::Handle handle : m_ASexternalRoutes)
+    {
+        cb(*m_prefixRoutePool.Get(handle));
+    }
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::RemoveRoute(uint32_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+    MarkRoutesChanged();
+    uint32_t nHostRoutes = GetDerived()->GetNHostRoutes();
+    if (index < nHostRoutes)
+    {
+        GetDerived()->RemoveHostRoute(index);
+        return;
+    }
+    index -= nHostRoutes;
+    if (index < m_networkRoutes.size())
+    {
+        RemovePrefixRoute(m_networkRoutes, m_networkRouteTrie, index);
+        return;
+    }
+    index -= m_networkRoutes.size();
+    NS_ASSERT(index < m_ASexternalRoutes.size());
+    RemovePrefixRoute(m_ASexternalRoutes, m_ASexternalRouteTrie, index);
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::ClearRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    GetDerived()->ClearHostRoutes();
+    m_networkRouteTrie.Clear();
+    m_ASexternalRouteTrie.Clear();
+    m_networkRoutes.clear();
+    m_ASexternalRoutes.clear();
+    m_prefixRoutePool.Clear();
+    MarkRoutesChanged();
+    m_installedRoutes.Clear();
+    m_installedRoutesKnown = true;
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::InstallRoutes(const RouteBatch& batch)
+{
+    NS_LOG_FUNCTION(this << batch.GetN());
+    ClearRoutes();
+    batch.Apply(this);
+    m_installedRoutes = batch;
+    m_installedRoutesKnown = true;
+    GetDerived()->NotifyRoutesInstalled();
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::UpdateRoutes(const RouteBatch& batch)
+{
+    NS_LOG_FUNCTION(this << batch.GetN());
+    if (!m_installedRoutesKnown)
+    {
+        // the routes were changed one by one since the last batch
+        uint32_t nRoutes = GetNRoutes();
+        InstallRoutes(batch);
+        TraceRouteDiff(batch.GetN(), nRoutes, 0);
+        return;
+    }
+    if (m_installedRoutes == batch)
+    {
+        return;
+    }
+    std::vector<uint32_t> removed;
+    RouteBatch added;
+    uint32_t modified = m_installedRoutes.Diff(batch, removed, added);
+    if (removed.empty() && added.GetN() == 0)
+    {
+        NS_LOG_LOGIC("The same routes in another order");
+        return;
+    }
+    TraceRouteDiff(added.GetN() - modified, removed.size() - modified, modified);
+    if (removed.size() + added.GetN() >= batch.GetN())
+    {
+        // most of the table changes, installing it whole is cheaper
+        InstallRoutes(batch);
+        return;
+    }
+    NS_LOG_LOGIC("Removing " << removed.size() << " routes and adding " << added.GetN());
+    for (auto i = removed.begin(); i != removed.end(); i++)
+    {
+        RemoveRoute(*i);
+    }
+    added.Apply(this);
+    m_installedRoutes.Patch(removed, added);
+    m_installedRoutesKnown = true;
+    GetDerived()->NotifyRoutesInstalled();
+}
+
+template <typename Derived, typename RIE>
+template <typename Filter>
+uint32_t
+RomamRoutingCore<Derived, RIE>::LookupPrefixRoutes(Ipv4Address dest,
+                                                   Filter filter,
+                                                   std::vector<RIE*>& routes) const
+{
+    // every matching network route, whatever its prefix length
+    uint32_t n = m_networkRouteTrie.Lookup(dest, filter, routes);
+    if (n == 0)
+    {
+        // consider external if no network route is found, the first one only
+        n = m_ASexternalRouteTrie.Lookup(dest, filter, routes, true);
+    }
+    ROMAM_HOT_LOG_LOGIC(n << " network/external route(s) found");
+    return n;
+}
+
+template <typename Derived, typename RIE>
+template <typename Filter>
+RIE*
+RomamRoutingCore<Derived, RIE>::LookupShortestPrefixRoute(Ipv4Address dest, Filter filter)
+{
+    std::size_t capacity = m_prefixScratch.capacity();
+    m_prefixScratch.clear();
+    LookupPrefixRoutes(dest, filter, m_prefixScratch);
+    CountScratchGrowth(capacity, m_prefixScratch.capacity());
+    RIE* best = nullptr;
+    for (RIE* route : m_prefixScratch)
+    {
+        if (!best || route->GetDistance() < best->GetDistance())
+        {
+            best = route;
+        }
+    }
+    return best;
+}
+
+template <typename Derived, typename RIE>
+std::size_t
+RomamRoutingCore<Derived, RIE>::GetPrefixRouteFootprint() const
+{
+    return m_prefixRoutePool.GetMemoryUsage() +
+           GetRouteTableFootprint(m_networkRoutes, m_prefixRoutePool) +
+           GetRouteTableFootprint(m_ASexternalRoutes, m_prefixRoutePool) +
+           m_networkRouteTrie.GetMemoryUsage() + m_ASexternalRouteTrie.GetMemoryUsage() +
+           m_installedRoutes.GetMemoryUsage() + m_prefixScratch.capacity() * sizeof(RIE*);
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::ReceiveInput(Ptr<const Packet> p, uint32_t iif)
+{
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::ForwardInput(Ptr<Ipv4Route> rtentry,
+                                             Ptr<const Packet> p,
+                                             const Ipv4Header& header,
+                                             uint32_t iif,
+                                             const UnicastForwardCallback& ucb)
+{
+    ucb(rtentry, p, header);
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::NotifyRoutesChanged()
+{
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::NotifyRoutesInstalled()
+{
+}
+
+template <typename Derived, typename RIE>
+template <typename Entry>
+Entry
+RomamRoutingCore<Derived, RIE>::MakeHostRoute(Ipv4Address dest,
+                                              Ipv4Address nextHop,
+                                              uint32_t interface,
+                                              uint32_t nextIface,
+                                              uint32_t distance)
+{
+    return Entry::CreateHostRouteTo(dest, nextHop, interface, nextIface, distance);
+}
+
+template <typename Derived, typename RIE>
+Derived*
+RomamRoutingCore<Derived, RIE>::GetDerived()
+{
+    return static_cast<Derived*>(this);
+}
+
+template <typename Derived, typename RIE>
+const Derived*
+RomamRoutingCore<Derived, RIE>::GetDerived() const
+{
+    return static_cast<const Derived*>(this);
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::MarkRoutesChanged()
+{
+    m_installedRoutesKnown = false;
+    BumpRouteGeneration();
+    GetDerived()->NotifyRoutesChanged();
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::AddPrefixRoute(PrefixRoutes& routes,
+                                               RouteTrie<RIE>& trie,
+                                               const RIE& route)
+{
+    typename RoutePool::Handle handle = m_prefixRoutePool.Allocate(route);
+    routes.push_back(handle);
+    trie.Insert(route.GetDestNetwork(), route.GetDestNetworkMask(), m_prefixRoutePool.Get(handle));
+    MarkRoutesChanged();
+}
+
+template <typename Derived, typename RIE>
+void
+RomamRoutingCore<Derived, RIE>::RemovePrefixRoute(PrefixRoutes& routes,
+                                                  RouteTrie<RIE>& trie,
+                                                  uint32_t index)
+{
+    NS_LOG_LOGIC("Removing route " << index << "; size = " << routes.size());
+    RIE* route = m_prefixRoutePool.Get(routes[index]);
+    trie.Remove(route->GetDestNetwork(), route->GetDestNetworkMask(), route);
+    m_prefixRoutePool.Free(routes[index]);
+    routes.erase(routes.begin() + index);
+    NS_LOG_LOGIC("Done removing network route " << index
+                                                << "; remaining size = " << routes.size());
+}
+
+} // namespace ns3
+
+#endif /* ROMAM_ROUTING_CORE_IMPL_H */
@@ -0,0 +1,250 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROMAM_ROUTING_CORE_H
+#define ROMAM_ROUTING_CORE_H
+
+#include "romam-routing.h"
+#include "utility/route-entry-pool.h"
+#include "utility/route-trie.h"
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4.h"
+#include "ns3/ptr.h"
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+class Packet;
+class NetDevice;
+
+/**
+ * \brief The parts the Romam routing protocols share, with static dispatch
+ * to the protocol.
+ *
+ * The core keeps the Ipv4 instance, the network and AS external routes with
+ * their pool and tries, and the shells of RouteOutput () and RouteInput ():
+ * the multicast, local delivery and forwarding checks and the counting and
+ * timing of the lookups.  It keeps a copy of the routes it installed, so
+ * UpdateRoutes () only changes the routes that differ.  The protocol keeps
+ * its host routes, its state databases and its route selection, and provides
+ * the members the core calls by name:
+ *
+ * - Ptr<Ipv4Route> SelectOutputRoute (Ptr<Packet> p, const Ipv4Header& header,
+ *   Ptr<NetDevice> oif), the route of a local packet, p may be null;
+ * - Ptr<Ipv4Route> SelectInputRoute (Ptr<const Packet>& p, const Ipv4Header&
+ *   header, Ptr<const NetDevice> idev), the route of a packet to forward,
+ *   which may replace p by a copy with new tags;
+ * - void AddHostRoute (const RIE& route), uint32_t GetNHostRoutes () const,
+ *   RIE* GetHostRoute (uint32_t i) const, void RemoveHostRoute (uint32_t i)
+ *   and void ClearHostRoutes (), the host routes, which come first in the
+ *   indices of the table.
+ *
+ * The protocol may hide the hooks of the core: ReceiveInput (), ForwardInput (),
+ * NotifyRoutesChanged (), NotifyRoutesInstalled () and MakeHostRoute ().  It
+ * befriends the core, so its members may stay private.
+ *
+ * The members are defined in romam-routing-core-impl.h, which the .cc file of
+ * each protocol includes after its log component, so the core logs under the
+ * component of the protocol, and follows with the explicit instantiation of
+ * the core for the protocol.
+ *
+ * \tparam Derived the routing protocol
+ * \tparam RIE the route entry type of the protocol (DijkstraRIE,
+ * ShortestPathForestRIE, ArmedSpfRIE)
+ */
+template <typename Derived, typename RIE>
+class RomamRoutingCore : public RomamRouting
+{
+  public:
+    RomamRoutingCore();
+    ~RomamRoutingCore() override;
+
+    // These methods inherited from Ipv4RoutingProtocol class
+    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
+                               const Ipv4Header& header,
+                               Ptr<NetDevice> oif,
+                               Socket::SocketErrno& sockerr) override;
+    bool RouteInput(Ptr<const Packet> p,
+                    const Ipv4Header& header,
+                    Ptr<const NetDevice> idev,
+                    const UnicastForwardCallback& ucb,
+                    const MulticastForwardCallback& mcb,
+                    const LocalDeliverCallback& lcb,
+                    const ErrorCallback& ecb) override;
+    void SetIpv4(Ptr<Ipv4> ipv4) override;
+
+    // These methods inherited from RomamRouting class
+    void AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface) override;
+    void AddHostRouteTo(Ipv4Address dest, uint32_t interface) override;
+    void AddHostRouteTo(Ipv4Address dest,
+                        Ipv4Address nextHop,
+                        uint32_t interface,
+                        uint32_t nextIface,
+                        uint32_t distance) override;
+    void AddNetworkRouteTo(Ipv4Address network,
+                           Ipv4Mask networkMask,
+                           Ipv4Address nextHop,
+                           uint32_t interface) override;
+    void AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface) override;
+    void AddASExternalRouteTo(Ipv4Address network,
+                              Ipv4Mask networkMask,
+                              Ipv4Address nextHop,
+                              uint32_t interface) override;
+    uint32_t GetNRoutes(void) const override;
+    void RemoveRoute(uint32_t i) override;
+    void ClearRoutes() override;
+    void InstallRoutes(const RouteBatch& batch) override;
+    void UpdateRoutes(const RouteBatch& batch) override;
+    void ForEachRoute(RouteCallback cb) const override;
+
+    /**
+     * \brief Get a route of the table: the host routes, then the network
+     * routes, then the AS external routes.
+     * \param i the index of the route
+     * \return the route
+     */
+    RIE* GetRoute(uint32_t i) const;
+
+  protected:
+    /**
+     * \brief Find the network routes of all the prefixes that match a
+     * destination, in the order they were added, or else the first AS
+     * external route added that matches it.
+     * \tparam Filter predicate on the RIE* of the routes to keep
+     * \param dest destination address
+     * \param filter the routes to keep
+     * \param routes where the routes found are appended
+     * \return the number of routes found
+     */
+    template <typename Filter>
+    uint32_t LookupPrefixRoutes(Ipv4Address dest, Filter filter, std::vector<RIE*>& routes) const;
+
+    /**
+     * \brief Find the shortest of the routes LookupPrefixRoutes () finds,
+     * collected in storage reused across the lookups.
+     * \tparam Filter predicate on the RIE* of the routes to keep
+     * \param dest destination address
+     * \param filter the routes to keep
+     * \return the first route of the least distance, or nullptr if none
+     */
+    template <typename Filter>
+    RIE* LookupShortestPrefixRoute(Ipv4Address dest, Filter filter);
+
+    /**
+     * \return the number of bytes of the network and AS external routes, with
+     * their pool and tries, and of the copy of the table UpdateRoutes () diffs
+     */
+    std::size_t GetPrefixRouteFootprint() const;
+
+    /**
+     * \brief Hook of RouteInput () before the local delivery check, for the
+     * tags of the hop.
+     * \param p the packet received
+     * \param iif the input interface
+     */
+    void ReceiveInput(Ptr<const Packet> p, uint32_t iif);
+
+    /**
+     * \brief Hook of RouteInput () that forwards a packet on the route found.
+     * \param rtentry the route
+     * \param p the packet
+     * \param header the IP header of the packet
+     * \param iif the input interface
+     * \param ucb the unicast forward callback
+     */
+    void ForwardInput(Ptr<Ipv4Route> rtentry,
+                      Ptr<const Packet> p,
+                      const Ipv4Header& header,
+                      uint32_t iif,
+                      const UnicastForwardCallback& ucb);
+
+    /**
+     * \brief Hook called on every change of the routes.
+     */
+    void NotifyRoutesChanged();
+
+    /**
+     * \brief Hook called once InstallRoutes () or UpdateRoutes () changed the
+     * routes of the table to a batch.
+     */
+    void NotifyRoutesInstalled();
+
+    /**
+     * \brief Build the host route of the five-argument AddHostRouteTo ().
+     *
+     * A template, so only the protocols that do not hide it need a route
+     * entry type with the five-argument CreateHostRouteTo ().
+     *
+     * \param dest destination address
+     * \param nextHop next hop address
+     * \param interface output interface
+     * \param nextIface interface of the next hop
+     * \param distance distance to the destination
+     * \return the host route
+     */
+    template <typename Entry = RIE>
+    static Entry MakeHostRoute(Ipv4Address dest,
+                               Ipv4Address nextHop,
+                               uint32_t interface,
+                               uint32_t nextIface,
+                               uint32_t distance);
+
+    Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
+
+  private:
+    /// pool of the network and AS external route entries
+    typedef RouteEntryPool<RIE> RoutePool;
+    /// container of the network or AS external routes
+    typedef std::vector<typename RoutePool::Handle> PrefixRoutes;
+
+    /**
+     * \return the protocol
+     */
+    Derived* GetDerived();
+
+    /**
+     * \return the protocol
+     */
+    const Derived* GetDerived() const;
+
+    /**
+     * \brief Have the protocol know the routes changed, which leaves
+     * m_installedRoutes out of date.
+     */
+    void MarkRoutesChanged();
+
+    /**
+     * \brief Add a network or AS external route to a table and its trie.
+     * \param routes the table
+     * \param trie the trie of the table
+     * \param route the route
+     */
+    void AddPrefixRoute(PrefixRoutes& routes, RouteTrie<RIE>& trie, const RIE& route);
+
+    /**
+     * \brief Remove a network or AS external route from its table and trie,
+     * and free it.
+     * \param routes the table of the route
+     * \param trie the trie of the route
+     * \param index the index of the route in the table
+     */
+    void RemovePrefixRoute(PrefixRoutes& routes, RouteTrie<RIE>& trie, uint32_t index);
+
+    RoutePool m_prefixRoutePool;          //!< the network and AS external route entries
+    PrefixRoutes m_networkRoutes;         //!< Routes to networks
+    PrefixRoutes m_ASexternalRoutes;      //!< External routes imported
+    RouteTrie<RIE> m_networkRouteTrie;    //!< Routes to networks, by prefix
+    RouteTrie<RIE> m_ASexternalRouteTrie; //!< External routes, by prefix
+    RouteBatch m_installedRoutes;         //!< the routes of the table, in its order
+    bool m_installedRoutesKnown;          //!< m_installedRoutes is up to date
+    std::vector<RIE*> m_prefixScratch;    //!< the routes of LookupShortestPrefixRoute ()
+};
+
+} // namespace ns3
+
+#endif /* ROMAM_ROUTING_CORE_H */
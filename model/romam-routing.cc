@@ -1,5 +1,10 @@
 #include "romam-routing.h"
 
+#include "routing_algorithm/route-info-entry.h"
+#include "utility/romam-router.h"
+#include "utility/route-manager.h"
+
+#include "ns3/assert.h"
 #include "ns3/boolean.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/log.h"
@@ -9,8 +14,18 @@
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/uinteger.h"
 
+#include <algorithm>
+#include <functional>
 #include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ns3
@@ -20,19 +35,712 @@ NS_LOG_COMPONENT_DEFINE("RomamRouting");
 
 NS_OBJECT_ENSURE_REGISTERED(RomamRouting);
 
+/// stamp of the last lookup of a node whose routes are computed lazily
+static uint64_t g_lazyLookupStamp = 0;
+
 TypeId
 RomamRouting::GetTypeId()
 {
     static TypeId tid =
-        TypeId("ns3::RomamRouting").SetParent<Ipv4RoutingProtocol>().SetGroupName("Romam");
+        TypeId("ns3::RomamRouting")
+            .SetParent<Ipv4RoutingProtocol>()
+            .SetGroupName("Romam")
+            .AddAttribute("LookupSampleInterval",
+                          "Number of route lookups from one lookup whose wall-clock time "
+                          "is measured to the next, 0 to measure none",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&RomamRouting::m_lookupSampleInterval),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("DecisionTracePrefix",
+                          "Prefix of the binary trace files of the budgeted route decisions, "
+                          "<prefix>-<node id>.rdt, or empty to trace none",
+                          StringValue(""),
+                          MakeStringAccessor(&RomamRouting::m_decisionTracePrefix),
+                          MakeStringChecker())
+            .AddAttribute("DecisionTraceCapacity",
+                          "Number of decisions the trace buffers between two flushes, the "
+                          "oldest ones being overwritten beyond",
+                          UintegerValue(65536),
+                          MakeUintegerAccessor(&RomamRouting::m_decisionTraceCapacity),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("DecisionTraceInterval",
+                          "Simulation time from one flush of the decision trace to the next",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&RomamRouting::m_decisionTraceInterval),
+                          MakeTimeChecker())
+            .AddAttribute("MaxCandidates",
+                          "Number of host routes with a distance the engines install per "
+                          "destination at most, the shortest ones on as many output interfaces "
+                          "as possible, or 0 to install them all",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RomamRouting::m_maxCandidates),
+                          MakeUintegerChecker<uint32_t>())
+            .AddTraceSource("LookupLatency",
+                            "The wall-clock time of a sampled route lookup",
+                            MakeTraceSourceAccessor(&RomamRouting::m_lookupLatencyTrace),
+                            "ns3::RomamRouting::LookupLatencyTracedCallback")
+            .AddTraceSource("EcmpFallback",
+                            "A budgeted route lookup fell back to the shortest routes",
+                            MakeTraceSourceAccessor(&RomamRouting::m_ecmpFallbackTrace),
+                            "ns3::RomamRouting::EcmpFallbackTracedCallback")
+            .AddTraceSource("RouteDiff",
+                            "The routes a recompute added, removed and replaced in the table",
+                            MakeTraceSourceAccessor(&RomamRouting::m_routeDiffTrace),
+                            "ns3::RomamRouting::RouteDiffTracedCallback");
     return tid;
 }
 
+RouteBatch::RouteBatch()
+{
+}
+
+void
+RouteBatch::Push(RouteType type,
+                 Ipv4Address dest,
+                 Ipv4Mask mask,
+                 Ipv4Address nextHop,
+                 uint32_t interface,
+                 uint32_t nextIface,
+                 uint32_t distance)
+{
+    Route route;
+    route.type = type;
+    route.dest = dest;
+    route.mask = mask;
+    route.nextHop = nextHop;
+    route.interface = interface;
+    route.nextIface = nextIface;
+    route.distance = distance;
+    m_routes.push_back(route);
+}
+
+void
+RouteBatch::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
+{
+    Push(HOST_GATEWAY, dest, Ipv4Mask::GetOnes(), nextHop, interface, 0, 0);
+}
+
+void
+RouteBatch::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
+{
+    Push(HOST_DIRECT, dest, Ipv4Mask::GetOnes(), Ipv4Address::GetZero(), interface, 0, 0);
+}
+
+void
+RouteBatch::AddHostRouteTo(Ipv4Address dest,
+                           Ipv4Address nextHop,
+                           uint32_t interface,
+                           uint32_t nextIface,
+                           uint32_t distance)
+{
+    Push(HOST_DISTANCE, dest, Ipv4Mask::GetOnes(), nextHop, interface, nextIface, distance);
+}
+
+void
+RouteBatch::AddNetworkRouteTo(Ipv4Address network,
+                              Ipv4Mask networkMask,
+                              Ipv4Address nextHop,
+                              uint32_t interface)
+{
+    Push(NETWORK_GATEWAY, network, networkMask, nextHop, interface, 0, 0);
+}
+
+void
+RouteBatch::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface)
+{
+    Push(NETWORK_DIRECT, network, networkMask, Ipv4Address::GetZero(), interface, 0, 0);
+}
+
+void
+RouteBatch::AddASExternalRouteTo(Ipv4Address network,
+                                 Ipv4Mask networkMask,
+                                 Ipv4Address nextHop,
+                                 uint32_t interface)
+{
+    Push(AS_EXTERNAL, network, networkMask, nextHop, interface, 0, 0);
+}
+
+uint32_t
+RouteBatch::GetN() const
+{
+    return m_routes.size();
+}
+
+std::size_t
+RouteBatch::GetMemoryUsage() const
+{
+    return m_routes.capacity() * sizeof(Route);
+}
+
+void
+RouteBatch::Clear()
+{
+    m_routes.clear();
+}
+
+void
+RouteBatch::Append(const RouteBatch& batch)
+{
+    m_routes.insert(m_routes.end(), batch.m_routes.begin(), batch.m_routes.end());
+}
+
+uint32_t
+RouteBatch::CapHostRoutes(uint32_t maxRoutes)
+{
+    if (maxRoutes == 0)
+    {
+        return 0;
+    }
+    // the candidates of every destination, in the order they were recorded
+    std::unordered_map<uint32_t, std::vector<uint32_t>> candidates;
+    for (uint32_t i = 0; i < m_routes.size(); i++)
+    {
+        if (m_routes[i].type == HOST_DISTANCE)
+        {
+            candidates[m_routes[i].dest.Get()].push_back(i);
+        }
+    }
+    std::vector<bool> pruned(m_routes.size(), false);
+    uint32_t nPruned = 0;
+    std::vector<bool> kept;
+    std::vector<uint32_t> interfaces;
+    for (auto i = candidates.begin(); i != candidates.end(); i++)
+    {
+        std::vector<uint32_t>& routes = i->second;
+        if (routes.size() <= maxRoutes)
+        {
+            continue;
+        }
+        std::stable_sort(routes.begin(), routes.end(), [this](uint32_t a, uint32_t b) {
+            return m_routes[a].distance < m_routes[b].distance;
+        });
+        kept.assign(routes.size(), false);
+        interfaces.clear();
+        uint32_t nKept = 0;
+        for (uint32_t j = 0; j < routes.size() && nKept < maxRoutes; j++)
+        {
+            uint32_t interface = m_routes[routes[j]].interface;
+            if (std::find(interfaces.begin(), interfaces.end(), interface) == interfaces.end())
+            {
+                interfaces.push_back(interface);
+                kept[j] = true;
+                nKept++;
+            }
+        }
+        for (uint32_t j = 0; j < routes.size() && nKept < maxRoutes; j++)
+        {
+            if (!kept[j])
+            {
+                kept[j] = true;
+                nKept++;
+            }
+        }
+        for (uint32_t j = 0; j < routes.size(); j++)
+        {
+            pruned[routes[j]] = !kept[j];
+        }
+        nPruned += routes.size() - maxRoutes;
+    }
+    if (nPruned == 0)
+    {
+        return 0;
+    }
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < m_routes.size(); i++)
+    {
+        if (!pruned[i])
+        {
+            m_routes[n++] = m_routes[i];
+        }
+    }
+    m_routes.resize(n);
+    // the batch holds no more than the table it is installed as
+    m_routes.shrink_to_fit();
+    return nPruned;
+}
+
+bool
+RouteBatch::Route::operator==(const Route& other) const
+{
+    return type == other.type && dest == other.dest && mask == other.mask &&
+           nextHop == other.nextHop && interface == other.interface &&
+           nextIface == other.nextIface && distance == other.distance;
+}
+
+bool
+RouteBatch::Route::operator<(const Route& other) const
+{
+    if (type != other.type)
+    {
+        return type < other.type;
+    }
+    if (dest != other.dest)
+    {
+        return dest < other.dest;
+    }
+    if (mask != other.mask)
+    {
+        return mask.Get() < other.mask.Get();
+    }
+    if (nextHop != other.nextHop)
+    {
+        return nextHop < other.nextHop;
+    }
+    if (interface != other.interface)
+    {
+        return interface < other.interface;
+    }
+    if (nextIface != other.nextIface)
+    {
+        return nextIface < other.nextIface;
+    }
+    return distance < other.distance;
+}
+
+bool
+RouteBatch::operator==(const RouteBatch& other) const
+{
+    return m_routes == other.m_routes;
+}
+
+bool
+RouteBatch::operator!=(const RouteBatch& other) const
+{
+    return !(*this == other);
+}
+
+void
+RouteBatch::Apply(RomamRouting* routing) const
+{
+    for (auto i = m_routes.begin(); i != m_routes.end(); i++)
+    {
+        switch (i->type)
+        {
+        case HOST_GATEWAY:
+            routing->AddHostRouteTo(i->dest, i->nextHop, i->interface);
+            break;
+        case HOST_DIRECT:
+            routing->AddHostRouteTo(i->dest, i->interface);
+            break;
+        case HOST_DISTANCE:
+            routing->AddHostRouteTo(i->dest, i->nextHop, i->interface, i->nextIface, i->distance);
+            break;
+        case NETWORK_GATEWAY:
+            routing->AddNetworkRouteTo(i->dest, i->mask, i->nextHop, i->interface);
+            break;
+        case NETWORK_DIRECT:
+            routing->AddNetworkRouteTo(i->dest, i->mask, i->interface);
+            break;
+        case AS_EXTERNAL:
+            routing->AddASExternalRouteTo(i->dest, i->mask, i->nextHop, i->interface);
+            break;
+        }
+    }
+}
+
+void
+RouteBatch::GetTableIndices(std::vector<uint32_t>& indices) const
+{
+    uint32_t nHostRoutes = 0;
+    uint32_t nNetworkRoutes = 0;
+    for (auto i = m_routes.begin(); i != m_routes.end(); i++)
+    {
+        if (i->type == HOST_GATEWAY || i->type == HOST_DIRECT || i->type == HOST_DISTANCE)
+        {
+            nHostRoutes++;
+        }
+        else if (i->type != AS_EXTERNAL)
+        {
+            nNetworkRoutes++;
+        }
+    }
+    // every kind of route is numbered after the kinds the table puts first
+    uint32_t nextHost = 0;
+    uint32_t nextNetwork = nHostRoutes;
+    uint32_t nextExternal = nHostRoutes + nNetworkRoutes;
+    indices.resize(m_routes.size());
+    for (uint32_t i = 0; i < m_routes.size(); i++)
+    {
+        switch (m_routes[i].type)
+        {
+        case HOST_GATEWAY:
+        case HOST_DIRECT:
+        case HOST_DISTANCE:
+            indices[i] = nextHost++;
+            break;
+        case NETWORK_GATEWAY:
+        case NETWORK_DIRECT:
+            indices[i] = nextNetwork++;
+            break;
+        case AS_EXTERNAL:
+            indices[i] = nextExternal++;
+            break;
+        }
+    }
+}
+
+uint32_t
+RouteBatch::Diff(const RouteBatch& batch, std::vector<uint32_t>& removed, RouteBatch& added) const
+{
+    removed.clear();
+    added.Clear();
+    // the copies of every route of the table the batch does not match yet
+    std::map<Route, uint32_t> unmatched;
+    for (auto i = m_routes.begin(); i != m_routes.end(); i++)
+    {
+        unmatched[*i]++;
+    }
+    for (auto i = batch.m_routes.begin(); i != batch.m_routes.end(); i++)
+    {
+        auto copies = unmatched.find(*i);
+        if (copies != unmatched.end() && copies->second > 0)
+        {
+            copies->second--;
+        }
+        else
+        {
+            added.m_routes.push_back(*i);
+        }
+    }
+    std::vector<uint32_t> indices;
+    GetTableIndices(indices);
+    std::multiset<std::pair<uint32_t, uint32_t>> removedDests;
+    for (uint32_t i = 0; i < m_routes.size(); i++)
+    {
+        uint32_t& copies = unmatched[m_routes[i]];
+        if (copies > 0)
+        {
+            copies--;
+            removed.push_back(indices[i]);
+            removedDests.emplace(m_routes[i].dest.Get(), m_routes[i].mask.Get());
+        }
+    }
+    std::sort(removed.begin(), removed.end(), std::greater<uint32_t>());
+    uint32_t modified = 0;
+    for (auto i = added.m_routes.begin(); i != added.m_routes.end() && !removedDests.empty(); i++)
+    {
+        auto dest = removedDests.find(std::make_pair(i->dest.Get(), i->mask.Get()));
+        if (dest != removedDests.end())
+        {
+            removedDests.erase(dest);
+            modified++;
+        }
+    }
+    return modified;
+}
+
+void
+RouteBatch::Patch(const std::vector<uint32_t>& removed, const RouteBatch& added)
+{
+    std::vector<uint32_t> indices;
+    GetTableIndices(indices);
+    std::vector<bool> isRemoved(m_routes.size(), false);
+    for (auto i = removed.begin(); i != removed.end(); i++)
+    {
+        NS_ASSERT_MSG(*i < m_routes.size(), "No route " << *i << " in the table");
+        isRemoved[*i] = true;
+    }
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < m_routes.size(); i++)
+    {
+        if (!isRemoved[indices[i]])
+        {
+            m_routes[kept++] = m_routes[i];
+        }
+    }
+    m_routes.resize(kept);
+    Append(added);
+}
+
+RomamRouting::RomamRouting()
+    : m_routeEpoch(1),
+      m_routeGeneration(1),
+      m_maxCandidates(0),
+      m_prunedRoutes(0),
+      m_lookupSampleInterval(1024),
+      m_lookupsSinceSample(0),
+      m_decisionTraceCapacity(65536),
+      m_decisionTraceInterval(Seconds(1)),
+      m_lazyNodeId(NO_LAZY_NODE),
+      m_lazyPending(false),
+      m_lastLookupStamp(0),
+      m_weakEsModel(true)
+{
+    NS_LOG_FUNCTION(this);
+}
+
 RomamRouting::~RomamRouting()
 {
     NS_LOG_FUNCTION(this);
 }
 
+const RoutingStats&
+RomamRouting::GetRoutingStats() const
+{
+    return m_routingStats;
+}
+
+void
+RomamRouting::ResetRoutingStats()
+{
+    NS_LOG_FUNCTION(this);
+    m_routingStats.Reset();
+    m_lookupsSinceSample = 0;
+}
+
+void
+RomamRouting::RequestLazyRoutes(uint32_t nodeId)
+{
+    NS_LOG_FUNCTION(this << nodeId);
+    m_lazyNodeId = nodeId;
+    m_lazyPending = true;
+    m_lastLookupStamp = ++g_lazyLookupStamp;
+}
+
+void
+RomamRouting::CancelLazyRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    m_lazyNodeId = NO_LAZY_NODE;
+    m_lazyPending = false;
+}
+
+uint64_t
+RomamRouting::GetLastLookupStamp() const
+{
+    return m_lastLookupStamp;
+}
+
+uint32_t
+RomamRouting::GetMaxCandidates() const
+{
+    return m_maxCandidates;
+}
+
+void
+RomamRouting::SetNPrunedRoutes(uint32_t n)
+{
+    m_prunedRoutes = n;
+}
+
+uint32_t
+RomamRouting::GetNPrunedRoutes() const
+{
+    return m_prunedRoutes;
+}
+
+void
+RomamRouting::TouchLazyRoutes() const
+{
+    m_lastLookupStamp = ++g_lazyLookupStamp;
+    if (m_lazyPending)
+    {
+        m_lazyPending = false;
+        NS_LOG_LOGIC("Computing the routes of node " << m_lazyNodeId << " on its first lookup");
+        RouteManager::ComputeLazyRoutes(m_lazyNodeId);
+    }
+}
+
+void
+RomamRouting::StartDecisionTrace(uint32_t nodeId)
+{
+    NS_LOG_FUNCTION(this << nodeId);
+    if (m_decisionTracePrefix.empty() || m_decisionTrace)
+    {
+        return;
+    }
+    std::ostringstream path;
+    path << m_decisionTracePrefix << '-' << nodeId << ".rdt";
+    m_decisionTrace.reset(
+        new DecisionTrace(path.str(), nodeId, m_decisionTraceCapacity, m_decisionTraceInterval));
+}
+
+void
+RomamRouting::StopDecisionTrace()
+{
+    NS_LOG_FUNCTION(this);
+    m_decisionTrace.reset();
+}
+
+void
+RomamRouting::CountEcmpFallback(Ipv4Address dest) const
+{
+    m_routingStats.Count(RoutingStats::ECMP_FALLBACKS);
+    m_ecmpFallbackTrace(dest);
+}
+
+void
+RomamRouting::TraceRouteDiff(uint32_t added, uint32_t removed, uint32_t modified) const
+{
+    NS_LOG_LOGIC(added << " routes added, " << removed << " removed, " << modified << " replaced");
+    m_routeDiffTrace(added, removed, modified);
+}
+
+void
+RomamRouting::SampleLookup(Ipv4Address dest, int64_t start) const
+{
+    int64_t elapsed = GetWallClock() - start;
+    m_routingStats.AddSample(elapsed);
+    m_lookupLatencyTrace(dest, elapsed);
+}
+
+Ptr<Ipv4Route>
+RomamRouting::GetIpv4Route(const RouteInfoEntry* entry, Ptr<Ipv4> ipv4) const
+{
+    Ptr<Ipv4Route> rtentry = entry->GetCachedRoute(m_routeEpoch);
+    if (rtentry)
+    {
+        return rtentry;
+    }
+    // create a Ipv4Route object from the selected routing table entry
+    const CachedInterface& iface = GetCachedInterface(ipv4, entry->GetInterface());
+    rtentry = Create<Ipv4Route>();
+    rtentry->SetDestination(entry->GetDest());
+    /// \todo handle multi-address case
+    rtentry->SetSource(iface.source);
+    rtentry->SetGateway(entry->GetGateway());
+    rtentry->SetOutputDevice(iface.device);
+    entry->SetCachedRoute(rtentry, m_routeEpoch);
+    return rtentry;
+}
+
+void
+RomamRouting::InvalidateIpv4Routes()
+{
+    NS_LOG_FUNCTION(this);
+    m_routeEpoch++;
+    BumpRouteGeneration();
+}
+
+uint32_t
+RomamRouting::GetCachedInterfaceIndex(Ptr<Ipv4> ipv4, Ptr<const NetDevice> device) const
+{
+    if (!device)
+    {
+        return NO_INTERFACE;
+    }
+    if (m_interfaces.empty())
+    {
+        RefreshInterfaceCache(ipv4);
+    }
+    auto found = m_devices.find(PeekPointer(device));
+    if (found != m_devices.end())
+    {
+        return found->second;
+    }
+    if (m_interfaces.size() != ipv4->GetNInterfaces())
+    {
+        // an interface was added after the last refresh
+        RefreshInterfaceCache(ipv4);
+        return GetCachedInterfaceIndex(ipv4, device);
+    }
+    return NO_INTERFACE;
+}
+
+bool
+RomamRouting::IsCachedDestination(Ptr<Ipv4> ipv4, Ipv4Address address, uint32_t iif) const
+{
+    if (address.IsMulticast() || address.IsBroadcast())
+    {
+        return true;
+    }
+    if (m_interfaces.empty() || iif >= m_interfaces.size())
+    {
+        RefreshInterfaceCache(ipv4);
+    }
+    if (m_weakEsModel)
+    {
+        return m_localAddresses.count(address.Get()) > 0;
+    }
+    return m_interfaceAddresses.count((static_cast<uint64_t>(address.Get()) << 32) | iif) > 0;
+}
+
+Ptr<Ipv4Route>
+RomamRouting::GetLocalRoute(Ptr<Ipv4> ipv4, Ipv4Address dest, Ptr<NetDevice> oif) const
+{
+    // 127.0.0.0/8 is the host loopback of every node
+    bool localhost = (dest.Get() >> 24) == 127;
+    if (!localhost)
+    {
+        if (m_interfaces.empty())
+        {
+            RefreshInterfaceCache(ipv4);
+        }
+        // the cache also holds the subnet broadcasts, which go out
+        if (m_localAddresses.count(dest.Get()) == 0 || ipv4->GetInterfaceForAddress(dest) < 0)
+        {
+            return nullptr;
+        }
+    }
+    // interface 0 is the loopback of every node
+    const CachedInterface& loopback = GetCachedInterface(ipv4, 0);
+    if (oif && oif != loopback.device)
+    {
+        return nullptr;
+    }
+    Ptr<Ipv4Route> rtentry = Create<Ipv4Route>();
+    rtentry->SetDestination(dest);
+    rtentry->SetSource(localhost ? Ipv4Address::GetLoopback() : dest);
+    rtentry->SetGateway(Ipv4Address::GetZero());
+    rtentry->SetOutputDevice(loopback.device);
+    return rtentry;
+}
+
+void
+RomamRouting::InvalidateInterfaceCache()
+{
+    NS_LOG_FUNCTION(this);
+    m_interfaces.clear();
+    m_devices.clear();
+    m_localAddresses.clear();
+    m_interfaceAddresses.clear();
+}
+
+void
+RomamRouting::RefreshInterfaceCache(Ptr<Ipv4> ipv4) const
+{
+    NS_LOG_FUNCTION(this << ipv4);
+    uint32_t nInterfaces = ipv4->GetNInterfaces();
+    m_interfaces.resize(nInterfaces);
+    m_devices.clear();
+    m_localAddresses.clear();
+    m_interfaceAddresses.clear();
+    for (uint32_t i = 0; i < nInterfaces; i++)
+    {
+        CachedInterface& iface = m_interfaces[i];
+        iface.source = ipv4->GetNAddresses(i) > 0 ? ipv4->GetAddress(i, 0).GetLocal()
+                                                  : Ipv4Address::GetAny();
+        iface.device = ipv4->GetNetDevice(i);
+        iface.up = ipv4->IsUp(i);
+        iface.forwarding = ipv4->IsForwarding(i);
+        m_devices[PeekPointer(iface.device)] = i;
+        for (uint32_t j = 0; j < ipv4->GetNAddresses(i); j++)
+        {
+            Ipv4InterfaceAddress address = ipv4->GetAddress(i, j);
+            for (Ipv4Address local : {address.GetLocal(), address.GetBroadcast()})
+            {
+                m_localAddresses.insert(local.Get());
+                m_interfaceAddresses.insert((static_cast<uint64_t>(local.Get()) << 32) | i);
+            }
+        }
+    }
+    BooleanValue weakEsModel;
+    ipv4->GetAttribute("WeakEsModel", weakEsModel);
+    m_weakEsModel = weakEsModel.Get();
+}
+
+void
+RomamRouting::MarkRouterDirty(Ptr<Ipv4> ipv4) const
+{
+    NS_LOG_FUNCTION(this << ipv4);
+    Ptr<Node> node = ipv4 ? ipv4->GetObject<Node>() : nullptr;
+    Ptr<RomamRouter> rtr = node ? node->GetObject<RomamRouter>() : nullptr;
+    if (rtr)
+    {
+        rtr->MarkDirty();
+    }
+}
+
 // void
 // RomamRouting::DoDispose()
 // {
@@ -5,28 +5,226 @@
 
 #include "datapath/dgr-headers.h"
 #include "datapath/tsdb.h"
+#include "utility/decision-trace.h"
+#include "utility/route-entry-pool.h"
+#include "utility/routing-stats.h"
 
+#include "ns3/assert.h"
+#include "ns3/callback.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4.h"
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
 #include "ns3/ptr.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
 
+#include <chrono>
+#include <cstddef>
 #include <list>
+#include <memory>
 #include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace ns3
 {
 
 class Packet;
-class NetDevice;
 class Ipv4Interface;
 class Ipv4Address;
 class Ipv4Header;
 
 class RouteInfoEntry;
 class Node;
+class RomamRouting;
+
+/**
+ * \brief A set of routes to be installed in one step by RomamRouting::InstallRoutes ()
+ * or RomamRouting::UpdateRoutes ().
+ *
+ * The Add* methods mirror the ones of RomamRouting, so a route computation can
+ * record its results here and hand the whole table over at once.
+ */
+class RouteBatch
+{
+  public:
+    RouteBatch();
+
+    /// \copydoc RomamRouting::AddHostRouteTo(Ipv4Address,Ipv4Address,uint32_t)
+    void AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface);
+    /// \copydoc RomamRouting::AddHostRouteTo(Ipv4Address,uint32_t)
+    void AddHostRouteTo(Ipv4Address dest, uint32_t interface);
+    /// \copydoc RomamRouting::AddHostRouteTo(Ipv4Address,Ipv4Address,uint32_t,uint32_t,uint32_t)
+    void AddHostRouteTo(Ipv4Address dest,
+                        Ipv4Address nextHop,
+                        uint32_t interface,
+                        uint32_t nextIface,
+                        uint32_t distance);
+    /// \copydoc RomamRouting::AddNetworkRouteTo(Ipv4Address,Ipv4Mask,Ipv4Address,uint32_t)
+    void AddNetworkRouteTo(Ipv4Address network,
+                           Ipv4Mask networkMask,
+                           Ipv4Address nextHop,
+                           uint32_t interface);
+    /// \copydoc RomamRouting::AddNetworkRouteTo(Ipv4Address,Ipv4Mask,uint32_t)
+    void AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface);
+    /// \copydoc RomamRouting::AddASExternalRouteTo
+    void AddASExternalRouteTo(Ipv4Address network,
+                              Ipv4Mask networkMask,
+                              Ipv4Address nextHop,
+                              uint32_t interface);
+
+    /**
+     * \return the number of routes in the batch
+     */
+    uint32_t GetN() const;
+
+    /**
+     * \return the number of bytes the routes of the batch take
+     */
+    std::size_t GetMemoryUsage() const;
+
+    /**
+     * \brief Remove all the routes from the batch.
+     */
+    void Clear();
+
+    /**
+     * \brief Append the routes of another batch, keeping their order.
+     * \param batch the routes to append
+     */
+    void Append(const RouteBatch& batch);
+
+    /**
+     * \brief Keep at most a number of the host routes with a distance of
+     * every destination, the candidates of the forests.
+     *
+     * The shortest route through every output interface is kept first, by
+     * distance, then the shortest of the other routes, so that the routes
+     * kept still spread over the interfaces.  The routes kept stay in their
+     * order, and the other routes are untouched.
+     *
+     * \param maxRoutes the routes to keep per destination, 0 for all
+     * \return the number of routes removed
+     */
+    uint32_t CapHostRoutes(uint32_t maxRoutes);
+
+    /**
+     * \param other the batch to compare with
+     * \return true if both batches hold the same routes in the same order
+     */
+    bool operator==(const RouteBatch& other) const;
+
+    /**
+     * \param other the batch to compare with
+     * \return true if the batches differ
+     */
+    bool operator!=(const RouteBatch& other) const;
+
+    /**
+     * \brief Add the routes of the batch to a routing protocol, in the order
+     * they were recorded.
+     * \param routing the routing protocol
+     */
+    void Apply(RomamRouting* routing) const;
+
+    /**
+     * \brief Find the changes that turn a routing table into another batch.
+     *
+     * This batch lists the routes of the table in its order, as after Apply ():
+     * the host routes come first in the indices of the table, then the network
+     * routes, then the AS external routes.  The batches are compared as
+     * multisets, so the routes that only moved are left alone.
+     *
+     * \param batch the new routes
+     * \param removed set to the indices in the table of the routes batch does
+     * not hold, from the last, so RomamRouting::RemoveRoute () can take them in
+     * order
+     * \param added set to the routes of batch the table does not hold, in the
+     * order of batch
+     * \return the number of the added routes that replace a removed route to
+     * the same destination
+     */
+    uint32_t Diff(const RouteBatch& batch, std::vector<uint32_t>& removed, RouteBatch& added) const;
+
+    /**
+     * \brief Follow the changes Diff () found, once they are made to the table.
+     *
+     * The routes removed leave the batch and the routes added come after the
+     * others, as in the table.
+     *
+     * \param removed the indices in the table of the routes removed
+     * \param added the routes added
+     */
+    void Patch(const std::vector<uint32_t>& removed, const RouteBatch& added);
+
+  private:
+    /// the RomamRouting method a route was recorded with
+    enum RouteType
+    {
+        HOST_GATEWAY,    //!< AddHostRouteTo with a next hop
+        HOST_DIRECT,     //!< AddHostRouteTo without a next hop
+        HOST_DISTANCE,   //!< AddHostRouteTo with the next interface and distance
+        NETWORK_GATEWAY, //!< AddNetworkRouteTo with a next hop
+        NETWORK_DIRECT,  //!< AddNetworkRouteTo without a next hop
+        AS_EXTERNAL,     //!< AddASExternalRouteTo
+    };
+
+    /// a recorded route
+    struct Route
+    {
+        RouteType type;      //!< how the route is installed
+        Ipv4Address dest;    //!< destination host or network
+        Ipv4Mask mask;       //!< network mask
+        Ipv4Address nextHop; //!< next hop
+        uint32_t interface;  //!< output interface
+        uint32_t nextIface;  //!< interface of the next hop
+        uint32_t distance;   //!< distance to the destination
+
+        /**
+         * \param other the route to compare with
+         * \return true if both routes are installed the same way
+         */
+        bool operator==(const Route& other) const;
+
+        /**
+         * \param other the route to compare with
+         * \return true if the route sorts before the other one
+         */
+        bool operator<(const Route& other) const;
+    };
+
+    /**
+     * \brief Get the indices the routes have in a table the batch was
+     * applied to.
+     * \param indices set to the index in the table of every route
+     */
+    void GetTableIndices(std::vector<uint32_t>& indices) const;
+
+    /**
+     * \brief Record a route.
+     * \param type how the route is installed
+     * \param dest destination host or network
+     * \param mask network mask
+     * \param nextHop next hop
+     * \param interface output interface
+     * \param nextIface interface of the next hop
+     * \param distance distance to the destination
+     */
+    void Push(RouteType type,
+              Ipv4Address dest,
+              Ipv4Mask mask,
+              Ipv4Address nextHop,
+              uint32_t interface,
+              uint32_t nextIface,
+              uint32_t distance);
+
+    std::vector<Route> m_routes; //!< recorded routes, in insertion order
+};
 
 class RomamRouting : public Ipv4RoutingProtocol
 {
@@ -36,6 +234,7 @@ class RomamRouting : public Ipv4RoutingProtocol
      * \return the object TypeId
      */
     static TypeId GetTypeId(void);
+    RomamRouting();
     ~RomamRouting() override;
 
     /**
@@ -147,6 +346,414 @@ class RomamRouting : public Ipv4RoutingProtocol
      */
     virtual void RemoveRoute(uint32_t i) = 0;
 
+    /**
+     * \brief Remove and delete all the routes of the routing table.
+     *
+     * Equivalent to calling RemoveRoute (0) GetNRoutes () times, without
+     * looking up every single entry.
+     */
+    virtual void ClearRoutes() = 0;
+
+    /**
+     * \brief Replace the whole routing table with a batch of routes.
+     * \param batch the new routes
+     */
+    virtual void InstallRoutes(const RouteBatch& batch) = 0;
+
+    /**
+     * \brief Bring the routing table to a batch of routes, changing only the
+     * routes that differ.
+     *
+     * The routes the table and the batch share stay in place, and so do the
+     * lookup caches built on them.  The RouteDiff trace source reports the
+     * size of the change.
+     *
+     * \param batch the new routes
+     */
+    virtual void UpdateRoutes(const RouteBatch& batch) = 0;
+
+    /**
+     * \brief Get the memory the routing state of the node takes.
+     *
+     * The footprint covers the route entries with the Ipv4Routes they cache,
+     * the lists, tries and indices they are kept in, and the neighbor state
+     * tables of the protocol.  The object itself, its sockets and the Link
+     * State Database (LSDB) all the nodes share are not counted.
+     *
+     * \return the number of bytes
+     */
+    virtual std::size_t GetMemoryFootprint() const = 0;
+
+    /// callback of ForEachRoute (), with a route of the table
+    typedef Callback<void, const RouteInfoEntry&> RouteCallback;
+
+    /**
+     * \brief Visit the routes of the table in the order of their indices: the
+     * host routes, then the network routes, then the AS external routes.
+     *
+     * The traversal walks the lists of the table once, rather than finding
+     * every route from its index, and needs no route entry type, so a caller
+     * that only holds a RomamRouting can export any table.
+     *
+     * \param cb called once per route, with an entry only valid during the call
+     */
+    virtual void ForEachRoute(RouteCallback cb) const = 0;
+
+    /**
+     * \return the counters of the route lookups of the node
+     */
+    const RoutingStats& GetRoutingStats() const;
+
+    /**
+     * \brief Set the counters of the route lookups of the node to 0.
+     */
+    void ResetRoutingStats();
+
+    /**
+     * \brief Have RouteManager compute the routes of the node on its next
+     * route lookup, which then goes on with them.
+     *
+     * This is how the lazy route computation of RouteManager starts, and how
+     * it frees the routes of a node until the node needs them again.
+     *
+     * \param nodeId the ID of the node
+     */
+    void RequestLazyRoutes(uint32_t nodeId);
+
+    /**
+     * \brief Stop asking RouteManager for the routes of the node.
+     */
+    void CancelLazyRoutes();
+
+    /**
+     * \return the stamp of the last route lookup since RequestLazyRoutes (),
+     * which grows with the lookups of all the nodes whose routes are computed
+     * lazily, and by which RouteManager evicts the least recently used tables
+     */
+    uint64_t GetLastLookupStamp() const;
+
+    /**
+     * \brief Get the generation of the routes of the node, for the caches of
+     * anything derived from them.
+     *
+     * The generation is bumped whenever a route is added or removed, the
+     * table cleared or the cached Ipv4Routes dropped, and never goes back, so
+     * a cache keeps the generation it was filled at and validates with one
+     * compare.
+     *
+     * \return the generation of the routes
+     */
+    uint32_t GetRouteGeneration() const;
+
+    /**
+     * \return the candidate routes the engines install per destination at
+     * most, 0 for all, see RouteBatch::CapHostRoutes ()
+     */
+    uint32_t GetMaxCandidates() const;
+
+    /**
+     * \param n the candidate routes the MaxCandidates cap kept out of the
+     * last table the engines installed
+     */
+    void SetNPrunedRoutes(uint32_t n);
+
+    /**
+     * \return the candidate routes the MaxCandidates cap kept out of the
+     * last table the engines installed
+     */
+    uint32_t GetNPrunedRoutes() const;
+
+    /**
+     * TracedCallback signature for the wall-clock time of a sampled lookup.
+     *
+     * \param [in] dest the destination looked up
+     * \param [in] nanoseconds the wall-clock time the lookup took
+     */
+    typedef void (*LookupLatencyTracedCallback)(Ipv4Address dest, int64_t nanoseconds);
+
+    /**
+     * TracedCallback signature for a budgeted lookup that fell back to the
+     * shortest routes.
+     *
+     * \param [in] dest the destination looked up
+     */
+    typedef void (*EcmpFallbackTracedCallback)(Ipv4Address dest);
+
+    /**
+     * TracedCallback signature for a change of the routing table.
+     *
+     * \param [in] added the number of routes added to new destinations
+     * \param [in] removed the number of routes removed and not replaced
+     * \param [in] modified the number of routes replaced by another route to
+     * the same destination
+     */
+    typedef void (*RouteDiffTracedCallback)(uint32_t added, uint32_t removed, uint32_t modified);
+
+  protected:
+    /**
+     * \brief Count an event of the route lookups.
+     * \param counter the counter
+     * \param n the number of events
+     */
+    void CountLookup(RoutingStats::Counter counter, uint64_t n = 1) const;
+
+    /**
+     * \brief Count a heap allocation of a lookup if its scratch storage grew;
+     * a no-op unless asserts are enabled.
+     * \param capacity the capacity of the storage before the lookup
+     * \param grown its capacity after the lookup
+     */
+    void CountScratchGrowth(std::size_t capacity, std::size_t grown) const;
+
+    /**
+     * \brief Count a route lookup, and start timing it if it is sampled.
+     *
+     * The routes of a node computed lazily are computed here, before the
+     * lookup reads them.
+     *
+     * \return the wall-clock start of the lookup in nanoseconds, or -1 if it
+     * is not sampled
+     */
+    int64_t StartLookup() const;
+
+    /**
+     * \brief Record the time of a lookup, if it is sampled.
+     * \param dest the destination looked up
+     * \param start what StartLookup () returned for the lookup
+     */
+    void FinishLookup(Ipv4Address dest, int64_t start) const;
+
+    /**
+     * \brief Count a budgeted lookup that fell back to the shortest routes.
+     * \param dest the destination looked up
+     */
+    void CountEcmpFallback(Ipv4Address dest) const;
+
+    /**
+     * \brief Report a change of the routing table.
+     * \param added the number of routes added to new destinations
+     * \param removed the number of routes removed and not replaced
+     * \param modified the number of routes replaced by another route to the
+     * same destination
+     */
+    void TraceRouteDiff(uint32_t added, uint32_t removed, uint32_t modified) const;
+
+    /**
+     * \brief Open the decision trace of the node, if DecisionTracePrefix is set.
+     * \param nodeId the id of the node
+     */
+    void StartDecisionTrace(uint32_t nodeId);
+
+    /**
+     * \brief Flush and close the decision trace of the node, if any.
+     */
+    void StopDecisionTrace();
+
+    /**
+     * \return true if the budgeted decisions of the node are traced
+     */
+    bool IsDecisionTraced() const;
+
+    /**
+     * \brief Record a budgeted decision in the decision trace, if any.
+     * \param dest destination address
+     * \param iface interface of the route taken, -1 if none
+     * \param candidates candidate routes considered
+     * \param budget budget left to the packet, in us
+     * \param estimate estimated delay of the route taken, in us, or
+     * DecisionTrace::NO_VALUE
+     * \param distance distance of the route taken, or DecisionTrace::NO_VALUE
+     * \param reason why the lookup ended
+     */
+    void TraceDecision(Ipv4Address dest,
+                       int32_t iface,
+                       uint32_t candidates,
+                       uint32_t budget,
+                       uint32_t estimate,
+                       uint32_t distance,
+                       DecisionTrace::Reason reason) const;
+
+    /**
+     * \brief Get the memory a list of route entries takes.
+     * \tparam T the route entry type
+     * \param routes the route entries, owned by the list
+     * \return the number of bytes of the list nodes, of the entries and of the
+     * Ipv4Routes they cache
+     */
+    template <typename T>
+    static std::size_t GetRouteListFootprint(const std::list<T*>& routes);
+
+    /**
+     * \brief Get the memory a table of pooled route entries takes.
+     * \tparam T the route entry type
+     * \param routes the handles of the route entries
+     * \param pool the pool of the route entries, counted apart
+     * \return the number of bytes of the handles and of the Ipv4Routes the
+     * entries cache
+     */
+    template <typename T>
+    static std::size_t GetRouteTableFootprint(
+        const std::vector<typename RouteEntryPool<T>::Handle>& routes,
+        const RouteEntryPool<T>& pool);
+
+    /**
+     * \brief Get the Ipv4Route to hand out for a route entry.
+     *
+     * The route is built once per entry and reused until the entry is deleted
+     * or InvalidateIpv4Routes () is called.
+     *
+     * \param entry the selected route entry
+     * \param ipv4 the Ipv4 instance the protocol is attached to
+     * \return the Ipv4Route for entry
+     */
+    Ptr<Ipv4Route> GetIpv4Route(const RouteInfoEntry* entry, Ptr<Ipv4> ipv4) const;
+
+    /**
+     * \brief Drop all cached Ipv4Routes, e.g., when an interface address changes.
+     */
+    void InvalidateIpv4Routes();
+
+    /**
+     * \brief Tell the caches that the routes changed, see GetRouteGeneration ().
+     */
+    void BumpRouteGeneration();
+
+    /// what the lookups read of an interface, cached from the Ipv4 instance
+    struct CachedInterface
+    {
+        Ipv4Address source;    //!< the first address of the interface, the source of its routes
+        Ptr<NetDevice> device; //!< the net device of the interface
+        bool up;               //!< whether the interface is up
+        bool forwarding;       //!< whether the interface forwards the packets it receives
+    };
+
+    /// GetCachedInterfaceIndex () of a device that is no interface of the node
+    static const uint32_t NO_INTERFACE = UINT32_MAX;
+
+    /**
+     * \brief Get the cached source address, device and state of an interface.
+     *
+     * The cache is rebuilt from the Ipv4 instance on the first call after
+     * InvalidateInterfaceCache (), or for an interface added since.
+     *
+     * \param ipv4 the Ipv4 instance the protocol is attached to
+     * \param iface the interface number
+     * \return the cached interface
+     */
+    const CachedInterface& GetCachedInterface(Ptr<Ipv4> ipv4, uint32_t iface) const;
+
+    /**
+     * \brief Get the interface number of a device from the cache, so that the
+     * lookups filter their candidates on integers.
+     * \param ipv4 the Ipv4 instance the protocol is attached to
+     * \param device a net device, or nullptr
+     * \return the interface of the device, or NO_INTERFACE
+     */
+    uint32_t GetCachedInterfaceIndex(Ptr<Ipv4> ipv4, Ptr<const NetDevice> device) const;
+
+    /**
+     * \brief Tell from the cache whether a packet received on an interface is
+     * for the node, as Ipv4::IsDestinationAddress () does, in O(1).
+     *
+     * The address is one of the node if it is multicast, broadcast, or a local
+     * or subnet broadcast address of the interface, or of another interface
+     * under the weak end system model of the Ipv4 instance.
+     *
+     * \param ipv4 the Ipv4 instance the protocol is attached to
+     * \param address the destination address
+     * \param iif the interface the packet was received on
+     * \return true if the packet is to be delivered locally
+     */
+    bool IsCachedDestination(Ptr<Ipv4> ipv4, Ipv4Address address, uint32_t iif) const;
+
+    /**
+     * \brief Get the route of a packet the node sends to itself, through its
+     * loopback interface.
+     *
+     * Ipv4StaticRouting routes them when an Ipv4ListRouting runs it beside
+     * the protocol; a protocol installed alone on the node routes them with
+     * this, so that it needs no list in front of it.
+     *
+     * \param ipv4 the Ipv4 instance the protocol is attached to
+     * \param dest the destination address
+     * \param oif the output device the packet is bound to, or nullptr
+     * \return the route, or nullptr if dest is not an address of the node
+     */
+    Ptr<Ipv4Route> GetLocalRoute(Ptr<Ipv4> ipv4, Ipv4Address dest, Ptr<NetDevice> oif) const;
+
+    /**
+     * \brief Drop the cached interfaces, on an interface or address event, or
+     * once the forwarding of an interface changed.
+     */
+    void InvalidateInterfaceCache();
+
+    /**
+     * \brief Mark the LSAs of the RomamRouter of a node as out of date, e.g.,
+     * when an interface goes up or down, so that the next LSDB build
+     * discovers them again.
+     * \param ipv4 the Ipv4 instance the protocol is attached to
+     */
+    void MarkRouterDirty(Ptr<Ipv4> ipv4) const;
+
+  private:
+    /**
+     * \brief Stamp a lookup of a node whose routes are computed lazily, and
+     * have its routes computed if they are not.
+     */
+    void TouchLazyRoutes() const;
+
+    /**
+     * \brief Record the time of a sampled lookup.
+     * \param dest the destination looked up
+     * \param start the wall-clock start of the lookup, in nanoseconds
+     */
+    void SampleLookup(Ipv4Address dest, int64_t start) const;
+
+    /**
+     * \return the wall-clock time, in nanoseconds
+     */
+    static int64_t GetWallClock();
+
+    /**
+     * \brief Rebuild the cached interfaces.
+     * \param ipv4 the Ipv4 instance the protocol is attached to
+     */
+    void RefreshInterfaceCache(Ptr<Ipv4> ipv4) const;
+
+    uint32_t m_routeEpoch;                          //!< route cache epoch, see GetIpv4Route ()
+    uint32_t m_routeGeneration;                     //!< see GetRouteGeneration ()
+    uint32_t m_maxCandidates;                       //!< candidates kept per destination, 0 for all
+    uint32_t m_prunedRoutes;                        //!< candidates the cap kept out of the table
+    mutable RoutingStats m_routingStats;            //!< counters of the route lookups
+    uint32_t m_lookupSampleInterval;                //!< lookups from one sampled lookup to the next
+    mutable uint32_t m_lookupsSinceSample;          //!< lookups since the last sampled one
+    std::string m_decisionTracePrefix;              //!< prefix of the decision trace files
+    uint32_t m_decisionTraceCapacity;               //!< records of the decision trace ring
+    Time m_decisionTraceInterval;                   //!< time between decision trace flushes
+    std::unique_ptr<DecisionTrace> m_decisionTrace; //!< decision trace, if enabled
+    uint32_t m_lazyNodeId;                          //!< node of the lazy routes, or NO_LAZY_NODE
+    mutable bool m_lazyPending;                     //!< the routes wait for the next lookup
+    mutable uint64_t m_lastLookupStamp;             //!< stamp of the last lazy lookup
+
+    mutable std::vector<CachedInterface> m_interfaces; //!< see GetCachedInterface ()
+    mutable bool m_weakEsModel;                        //!< the Ipv4 follows the weak ES model
+    /// the interface of every device, see GetCachedInterfaceIndex ()
+    mutable std::unordered_map<const NetDevice*, uint32_t> m_devices;
+    /// the local and subnet broadcast addresses of the interfaces, see IsCachedDestination ()
+    mutable std::unordered_set<uint32_t> m_localAddresses;
+    /// the same addresses by interface, the address shifted by 32 bits or'ed with the interface
+    mutable std::unordered_set<uint64_t> m_interfaceAddresses;
+
+    /// m_lazyNodeId of a node whose routes are not computed lazily
+    static const uint32_t NO_LAZY_NODE = UINT32_MAX;
+
+    /// the wall-clock time of the lookups sampled
+    TracedCallback<Ipv4Address, int64_t> m_lookupLatencyTrace;
+    /// the budgeted lookups that fell back to the shortest routes
+    TracedCallback<Ipv4Address> m_ecmpFallbackTrace;
+    /// the changes of the routing table
+    TracedCallback<uint32_t, uint32_t, uint32_t> m_routeDiffTrace;
+
     // protected:
     //   /**
     //    * \brief Dispose this object
@@ -156,6 +763,132 @@ class RomamRouting : public Ipv4RoutingProtocol
     //   virtual void DoInitialize() override;
 };
 
+inline uint32_t
+RomamRouting::GetRouteGeneration() const
+{
+    return m_routeGeneration;
+}
+
+inline void
+RomamRouting::BumpRouteGeneration()
+{
+    m_routeGeneration++;
+}
+
+inline void
+RomamRouting::CountLookup(RoutingStats::Counter counter, uint64_t n) const
+{
+    m_routingStats.Count(counter, n);
+}
+
+inline const RomamRouting::CachedInterface&
+RomamRouting::GetCachedInterface(Ptr<Ipv4> ipv4, uint32_t iface) const
+{
+    if (iface >= m_interfaces.size())
+    {
+        RefreshInterfaceCache(ipv4);
+    }
+    NS_ASSERT(iface < m_interfaces.size());
+    return m_interfaces[iface];
+}
+
+inline void
+RomamRouting::CountScratchGrowth(std::size_t capacity, std::size_t grown) const
+{
+#ifdef NS3_ASSERT_ENABLE
+    if (grown != capacity)
+    {
+        m_routingStats.Count(RoutingStats::LOOKUP_ALLOCATIONS);
+    }
+#endif
+}
+
+inline int64_t
+RomamRouting::StartLookup() const
+{
+    m_routingStats.Count(RoutingStats::LOOKUPS);
+    if (m_lazyNodeId != NO_LAZY_NODE)
+    {
+        TouchLazyRoutes();
+    }
+    if (m_lookupSampleInterval == 0 || ++m_lookupsSinceSample < m_lookupSampleInterval)
+    {
+        return -1;
+    }
+    m_lookupsSinceSample = 0;
+    return GetWallClock();
+}
+
+inline void
+RomamRouting::FinishLookup(Ipv4Address dest, int64_t start) const
+{
+    if (start >= 0)
+    {
+        SampleLookup(dest, start);
+    }
+}
+
+inline int64_t
+RomamRouting::GetWallClock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline bool
+RomamRouting::IsDecisionTraced() const
+{
+    return m_decisionTrace != nullptr;
+}
+
+inline void
+RomamRouting::TraceDecision(Ipv4Address dest,
+                            int32_t iface,
+                            uint32_t candidates,
+                            uint32_t budget,
+                            uint32_t estimate,
+                            uint32_t distance,
+                            DecisionTrace::Reason reason) const
+{
+    if (m_decisionTrace)
+    {
+        m_decisionTrace->Add(dest, iface, candidates, budget, estimate, distance, reason);
+    }
+}
+
+template <typename T>
+std::size_t
+RomamRouting::GetRouteListFootprint(const std::list<T*>& routes)
+{
+    // a list node holds the pointer and the two links
+    std::size_t bytes = routes.size() * (sizeof(T*) + 2 * sizeof(void*) + sizeof(T));
+    for (const T* route : routes)
+    {
+        if (route->HasCachedRoute())
+        {
+            bytes += sizeof(Ipv4Route);
+        }
+    }
+    return bytes;
+}
+
+template <typename T>
+std::size_t
+RomamRouting::GetRouteTableFootprint(const std::vector<typename RouteEntryPool<T>::Handle>& routes,
+                                     const RouteEntryPool<T>& pool)
+{
+    std::size_t bytes = routes.capacity() * sizeof(typename RouteEntryPool<T>::Handle);
+    for (typename RouteEntryPool<T>::Handle handle : routes)
+    {
+        if (pool.Get(handle)->HasCachedRoute())
+        {
+            bytes += sizeof(Ipv4Route);
+        }
+    }
+    return bytes;
+}
+
 } // namespace ns3
 
 #endif /* ROMAM_ROUTING_H */
@@ -0,0 +1,331 @@
+#include "arm-set.h"
+
+#include "armed-spf-rie.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ArmSet");
+
+ArmSet::ArmSet()
+    : m_chances(0.0),
+      m_pruning(false),
+      m_pruneMargin(0.0),
+      m_pruneMinPulls(0),
+      m_pruneRetry(0),
+      m_round(0),
+      m_nSuspended(0),
+      m_nextResume(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+ArmSet::AddArm(ArmedSpfRIE* arm)
+{
+    NS_LOG_FUNCTION(this << arm);
+    m_arms.push_back(arm);
+    m_resumeRound.push_back(0);
+    m_suspensions.push_back(0);
+    Reweight();
+}
+
+bool
+ArmSet::RemoveArm(ArmedSpfRIE* arm)
+{
+    NS_LOG_FUNCTION(this << arm);
+    auto i = std::find(m_arms.begin(), m_arms.end(), arm);
+    if (i == m_arms.end())
+    {
+        return false;
+    }
+    std::size_t index = i - m_arms.begin();
+    m_arms.erase(i);
+    m_resumeRound.erase(m_resumeRound.begin() + index);
+    m_suspensions.erase(m_suspensions.begin() + index);
+    Schedule();
+    Reweight();
+    return true;
+}
+
+void
+ArmSet::SetPruning(double margin, uint32_t minPulls, uint32_t retry)
+{
+    NS_LOG_FUNCTION(this << margin << minPulls << retry);
+    m_pruning = true;
+    m_pruneMargin = margin;
+    m_pruneMinPulls = std::max<uint32_t>(minPulls, 1);
+    m_pruneRetry = std::max<uint32_t>(retry, 1);
+}
+
+uint32_t
+ArmSet::GetN() const
+{
+    return m_arms.size();
+}
+
+uint32_t
+ArmSet::GetNActive() const
+{
+    return m_arms.size() - m_nSuspended;
+}
+
+bool
+ArmSet::IsSuspended(uint32_t i) const
+{
+    NS_ASSERT(i < m_arms.size());
+    return m_resumeRound[i] != 0;
+}
+
+ArmedSpfRIE*
+ArmSet::GetArm(uint32_t i) const
+{
+    NS_ASSERT(i < m_arms.size());
+    return m_arms[i];
+}
+
+uint32_t
+ArmSet::FindArm(uint32_t interface) const
+{
+    for (uint32_t i = 0; i < m_arms.size(); i++)
+    {
+        if (m_arms[i]->GetInterface() == interface)
+        {
+            return i;
+        }
+    }
+    return m_arms.size();
+}
+
+double
+ArmSet::GetProbability(uint32_t i) const
+{
+    NS_ASSERT(i < m_arms.size());
+    if (IsSuspended(i))
+    {
+        return 0.0;
+    }
+    double total = m_cumulative.back();
+    if (total <= 0.0)
+    {
+        // all weights underflowed, fall back to a uniform choice
+        return 1.0 / GetNActive();
+    }
+    return m_weights[i] / total;
+}
+
+void
+ArmSet::PullArms()
+{
+    m_round++;
+    if (m_nSuspended > 0 && m_round >= m_nextResume)
+    {
+        Resume();
+    }
+    for (uint32_t i = 0; i < m_arms.size(); i++)
+    {
+        if (m_resumeRound[i] == 0)
+        {
+            m_arms[i]->PullArm();
+        }
+    }
+}
+
+uint32_t
+ArmSet::Sample(double u) const
+{
+    NS_ASSERT(!m_arms.empty());
+    double total = m_cumulative.back();
+    if (total <= 0.0)
+    {
+        // the k-th active arm
+        uint32_t k = std::min<uint32_t>(u * GetNActive(), GetNActive() - 1);
+        for (uint32_t i = 0; i < m_arms.size(); i++)
+        {
+            if (m_resumeRound[i] == 0 && k-- == 0)
+            {
+                return i;
+            }
+        }
+    }
+    auto i = std::upper_bound(m_cumulative.begin(), m_cumulative.end(), u * total);
+    return std::min<uint32_t>(i - m_cumulative.begin(), m_arms.size() - 1);
+}
+
+void
+ArmSet::UpdateArm(uint32_t i, double loss)
+{
+    NS_LOG_FUNCTION(this << i << loss);
+    NS_ASSERT(i < m_arms.size());
+    m_arms[i]->UpdateArm(loss);
+    m_weights[i] = ComputeWeight(i);
+    Accumulate(i);
+    if (m_pruning)
+    {
+        Prune();
+    }
+}
+
+void
+ArmSet::RestoreArm(uint32_t i, double cumulativeLoss, uint32_t nPulls)
+{
+    NS_LOG_FUNCTION(this << i << cumulativeLoss << nPulls);
+    NS_ASSERT(i < m_arms.size());
+    m_arms[i]->SetArm(cumulativeLoss, nPulls);
+    m_weights[i] = ComputeWeight(i);
+    Accumulate(i);
+}
+
+std::size_t
+ArmSet::GetMemoryUsage() const
+{
+    return m_arms.capacity() * sizeof(ArmedSpfRIE*) +
+           (m_weights.capacity() + m_cumulative.capacity()) * sizeof(double) +
+           m_resumeRound.capacity() * sizeof(uint64_t) +
+           m_suspensions.capacity() * sizeof(uint32_t);
+}
+
+double
+ArmSet::ComputeWeight(uint32_t i) const
+{
+    if (m_resumeRound[i] != 0)
+    {
+        return 0.0;
+    }
+    // an arm is pulled at least once by the time its weight is used
+    uint32_t nPulls = std::max<uint32_t>(m_arms[i]->GetNumPulls(), 1);
+    double eta = sqrt(m_chances / (double)nPulls);
+    return exp(-eta * m_arms[i]->GetCumulativeLoss());
+}
+
+void
+ArmSet::Reweight()
+{
+    uint32_t n = m_arms.size();
+    m_chances = n > 0 ? n * log(n) : 0.0;
+    m_weights.resize(n);
+    m_cumulative.resize(n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        m_weights[i] = ComputeWeight(i);
+    }
+    Accumulate(0);
+}
+
+void
+ArmSet::Accumulate(uint32_t from)
+{
+    double sum = from > 0 ? m_cumulative[from - 1] : 0.0;
+    for (uint32_t i = from; i < m_weights.size(); i++)
+    {
+        sum += m_weights[i];
+        m_cumulative[i] = sum;
+    }
+}
+
+/**
+ * \param arm an arm
+ * \return its mean loss per pull
+ */
+static double
+GetMeanLoss(const ArmedSpfRIE* arm)
+{
+    return arm->GetCumulativeLoss() / std::max<uint32_t>(arm->GetNumPulls(), 1);
+}
+
+uint32_t
+ArmSet::FindBestArm() const
+{
+    uint32_t best = m_arms.size();
+    for (uint32_t i = 0; i < m_arms.size(); i++)
+    {
+        if (m_resumeRound[i] == 0 &&
+            (best == m_arms.size() || GetMeanLoss(m_arms[i]) < GetMeanLoss(m_arms[best])))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void
+ArmSet::Prune()
+{
+    uint32_t best = FindBestArm();
+    if (best == m_arms.size() || m_arms[best]->GetNumPulls() < m_pruneMinPulls)
+    {
+        return;
+    }
+    double bestLoss = GetMeanLoss(m_arms[best]);
+    double logRound = log(std::max<uint64_t>(m_round, 2));
+    bool suspended = false;
+    for (uint32_t i = 0; i < m_arms.size(); i++)
+    {
+        uint32_t nPulls = m_arms[i]->GetNumPulls();
+        if (i == best || m_resumeRound[i] != 0 || nPulls < m_pruneMinPulls)
+        {
+            continue;
+        }
+        // the relative gap, less the confidence radius of the arm pulled least
+        double radius = sqrt(logRound / std::min(nPulls, m_arms[best]->GetNumPulls()));
+        if (GetMeanLoss(m_arms[i]) <= bestLoss * (1 + m_pruneMargin + radius))
+        {
+            continue;
+        }
+        uint32_t shift = std::min<uint32_t>(m_suspensions[i]++, 16);
+        m_resumeRound[i] = m_round + (static_cast<uint64_t>(m_pruneRetry) << shift);
+        m_weights[i] = 0.0;
+        suspended = true;
+        NS_LOG_LOGIC("Suspending arm " << i << " until round " << m_resumeRound[i]);
+    }
+    if (suspended)
+    {
+        Schedule();
+        Accumulate(0);
+    }
+}
+
+void
+ArmSet::Resume()
+{
+    uint32_t best = FindBestArm();
+    for (uint32_t i = 0; i < m_arms.size(); i++)
+    {
+        if (m_resumeRound[i] == 0 || m_resumeRound[i] > m_round)
+        {
+            continue;
+        }
+        NS_LOG_LOGIC("Retrying arm " << i << " at round " << m_round);
+        m_resumeRound[i] = 0;
+        if (best != m_arms.size())
+        {
+            m_arms[i]->SetArm(m_arms[best]->GetCumulativeLoss(), m_arms[best]->GetNumPulls());
+        }
+        m_weights[i] = ComputeWeight(i);
+    }
+    Schedule();
+    Accumulate(0);
+}
+
+void
+ArmSet::Schedule()
+{
+    m_nSuspended = 0;
+    m_nextResume = 0;
+    for (uint64_t round : m_resumeRound)
+    {
+        if (round != 0)
+        {
+            m_nSuspended++;
+            m_nextResume = m_nSuspended == 1 ? round : std::min(m_nextResume, round);
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ARM_SET_H
+#define ARM_SET_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+class ArmedSpfRIE;
+
+/**
+ * \brief The Exp3 arms (host routes) Octopus holds towards one destination.
+ *
+ * The Exp3 weight exp (-eta * loss) of every arm and the cumulative sum of the
+ * weights are kept in contiguous arrays.  A weight is only recomputed when the
+ * loss of its arm changes, so selecting an arm for a packet is a binary search
+ * over the cumulative weights and involves no transcendental math.
+ *
+ * With SetPruning (), an arm whose mean loss per pull stays above the one of
+ * the best arm by more than a margin, beyond the confidence radii of both, is
+ * suspended: its weight is 0, so it is neither selected nor pulled.  The
+ * suspended arms are retried after a number of pulls of the set that doubles
+ * at every suspension of the arm, restarting from the statistics of the best
+ * arm.  The selections and pulls then only involve the arms still active.
+ *
+ * The set does not own the arms, the routing protocol still deletes them.
+ */
+class ArmSet
+{
+  public:
+    ArmSet();
+
+    /**
+     * \brief Add an arm to the set.
+     * \param arm the host route
+     */
+    void AddArm(ArmedSpfRIE* arm);
+
+    /**
+     * \brief Remove an arm from the set.
+     * \param arm the host route
+     * \return true if the arm was found and removed
+     */
+    bool RemoveArm(ArmedSpfRIE* arm);
+
+    /**
+     * \brief Suspend the dominated arms from now on.
+     * \param margin how much higher than the one of the best arm the mean loss
+     * of an arm must be, relatively, to suspend it
+     * \param minPulls the pulls both arms need before an arm is suspended
+     * \param retry the pulls of the set after which an arm suspended once is
+     * retried, doubled at every further suspension
+     */
+    void SetPruning(double margin, uint32_t minPulls, uint32_t retry);
+
+    /**
+     * \return the number of arms
+     */
+    uint32_t GetN() const;
+
+    /**
+     * \return the number of arms not suspended
+     */
+    uint32_t GetNActive() const;
+
+    /**
+     * \param i the arm index
+     * \return true if the i-th arm is suspended
+     */
+    bool IsSuspended(uint32_t i) const;
+
+    /**
+     * \param i the arm index
+     * \return the i-th arm
+     */
+    ArmedSpfRIE* GetArm(uint32_t i) const;
+
+    /**
+     * \brief Find the arm leaving through an interface.
+     * \param interface the output interface
+     * \return the arm index, or GetN () if no arm uses interface
+     */
+    uint32_t FindArm(uint32_t interface) const;
+
+    /**
+     * \param i the arm index
+     * \return the probability to select the i-th arm
+     */
+    double GetProbability(uint32_t i) const;
+
+    /**
+     * \brief Count one pull on every active arm of the set, retrying the
+     * suspended arms that are due first.
+     */
+    void PullArms();
+
+    /**
+     * \brief Draw an arm according to the current weights.
+     * \param u a uniform random value in [0, 1)
+     * \return the selected arm index
+     */
+    uint32_t Sample(double u) const;
+
+    /**
+     * \brief Add a loss to an arm and refresh its weight.
+     * \param i the arm index
+     * \param loss the loss to add to the arm cumulative loss
+     */
+    void UpdateArm(uint32_t i, double loss);
+
+    /**
+     * \brief Set the loss and pulls of an arm, e.g., to those of an earlier
+     * run, and refresh its weight.
+     * \param i the arm index
+     * \param cumulativeLoss the cumulative loss
+     * \param nPulls the number of pulls
+     */
+    void RestoreArm(uint32_t i, double cumulativeLoss, uint32_t nPulls);
+
+    /**
+     * \return the number of bytes of the arrays of the set, not counting the
+     * arms themselves
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    /**
+     * \brief Compute the Exp3 weight of an arm from its loss and pulls.
+     * \param i the arm index
+     * \return the weight
+     */
+    double ComputeWeight(uint32_t i) const;
+
+    /**
+     * \brief Recompute all the weights, after the number of arms changed.
+     */
+    void Reweight();
+
+    /**
+     * \brief Refresh the cumulative weights from an arm onwards.
+     * \param from the first arm index whose weight changed
+     */
+    void Accumulate(uint32_t from);
+
+    /**
+     * \return the index of the active arm with the lowest mean loss per pull
+     */
+    uint32_t FindBestArm() const;
+
+    /**
+     * \brief Suspend the active arms the best arm dominates.
+     */
+    void Prune();
+
+    /**
+     * \brief Give the suspended arms that are due the statistics of the best
+     * arm and make them active again.
+     */
+    void Resume();
+
+    /**
+     * \brief Refresh the number of suspended arms and the next retry, after
+     * the suspensions changed.
+     */
+    void Schedule();
+
+    std::vector<ArmedSpfRIE*> m_arms; //!< arms, in insertion order
+    std::vector<double> m_weights;    //!< Exp3 weight of each arm
+    std::vector<double> m_cumulative; //!< m_cumulative[i] = sum of m_weights[0..i]
+    double m_chances;                 //!< n log (n) for n arms
+
+    bool m_pruning;                      //!< whether the dominated arms are suspended
+    double m_pruneMargin;                //!< relative loss margin of a dominated arm
+    uint32_t m_pruneMinPulls;            //!< pulls needed before a suspension
+    uint32_t m_pruneRetry;               //!< pulls of the set before a first retry
+    uint64_t m_round;                    //!< pulls of the set
+    std::vector<uint64_t> m_resumeRound; //!< round an arm is retried at, 0 if active
+    std::vector<uint32_t> m_suspensions; //!< times each arm was suspended
+    uint32_t m_nSuspended;               //!< arms suspended
+    uint64_t m_nextResume;               //!< the lowest round of m_resumeRound
+};
+
+} // namespace ns3
+
+#endif /* ARM_SET_H */
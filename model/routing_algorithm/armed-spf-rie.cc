@@ -25,12 +25,7 @@ ArmedSpfRIE::~ArmedSpfRIE()
 }
 
 ArmedSpfRIE::ArmedSpfRIE(const ArmedSpfRIE& route)
-    : m_dest(route.m_dest),
-      m_destNetworkMask(route.m_destNetworkMask),
-      m_gateway(route.m_gateway),
-      m_interface(route.m_interface),
-      m_nextIface(route.m_nextIface),
-      m_distance(route.m_distance),
+    : RouteInfoEntry(route),
       m_cumulative_loss(route.m_cumulative_loss),
       m_num_pulls(route.m_num_pulls)
 {
@@ -38,12 +33,7 @@ ArmedSpfRIE::ArmedSpfRIE(const ArmedSpfRIE& route)
 }
 
 ArmedSpfRIE::ArmedSpfRIE(const ArmedSpfRIE* route)
-    : m_dest(route->m_dest),
-      m_destNetworkMask(route->m_destNetworkMask),
-      m_gateway(route->m_gateway),
-      m_interface(route->m_interface),
-      m_nextIface(route->m_nextIface),
-      m_distance(route->m_distance),
+    : RouteInfoEntry(*route),
       m_cumulative_loss(route->m_cumulative_loss),
       m_num_pulls(route->m_num_pulls)
 {
@@ -51,12 +41,7 @@ ArmedSpfRIE::ArmedSpfRIE(const ArmedSpfRIE* route)
 }
 
 ArmedSpfRIE::ArmedSpfRIE(Ipv4Address dest, Ipv4Address gateway, uint32_t interface)
-    : m_dest(dest),
-      m_destNetworkMask(Ipv4Mask::GetOnes()),
-      m_gateway(gateway),
-      m_interface(interface),
-      m_nextIface(MAX_UINT32),
-      m_distance(MAX_UINT32),
+    : RouteInfoEntry(dest, Ipv4Mask::GetOnes(), gateway, interface, MAX_UINT32, MAX_UINT32),
       m_cumulative_loss(0.0),
       m_num_pulls(0)
 {
@@ -64,12 +49,12 @@ ArmedSpfRIE::ArmedSpfRIE(Ipv4Address dest, Ipv4Address gateway, uint32_t interfa
 }
 
 ArmedSpfRIE::ArmedSpfRIE(Ipv4Address dest, uint32_t interface)
-    : m_dest(dest),
-      m_destNetworkMask(Ipv4Mask::GetOnes()),
-      m_gateway(Ipv4Address::GetZero()),
-      m_interface(interface),
-      m_nextIface(MAX_UINT32),
-      m_distance(MAX_UINT32),
+    : RouteInfoEntry(dest,
+                     Ipv4Mask::GetOnes(),
+                     Ipv4Address::GetZero(),
+                     interface,
+                     MAX_UINT32,
+                     MAX_UINT32),
       m_cumulative_loss(0.0),
       m_num_pulls(0)
 {
@@ -80,12 +65,7 @@ ArmedSpfRIE::ArmedSpfRIE(Ipv4Address network,
                          Ipv4Mask networkMask,
                          Ipv4Address gateway,
                          uint32_t interface)
-    : m_dest(network),
-      m_destNetworkMask(networkMask),
-      m_gateway(gateway),
-      m_interface(interface),
-      m_nextIface(MAX_UINT32),
-      m_distance(MAX_UINT32),
+    : RouteInfoEntry(network, networkMask, gateway, interface, MAX_UINT32, MAX_UINT32),
       m_cumulative_loss(0.0),
       m_num_pulls(0)
 {
@@ -93,12 +73,12 @@ ArmedSpfRIE::ArmedSpfRIE(Ipv4Address network,
 }
 
 ArmedSpfRIE::ArmedSpfRIE(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface)
-    : m_dest(network),
-      m_destNetworkMask(networkMask),
-      m_gateway(Ipv4Address::GetZero()),
-      m_interface(interface),
-      m_nextIface(MAX_UINT32),
-      m_distance(MAX_UINT32),
+    : RouteInfoEntry(network,
+                     networkMask,
+                     Ipv4Address::GetZero(),
+                     interface,
+                     MAX_UINT32,
+                     MAX_UINT32),
       m_cumulative_loss(0.0),
       m_num_pulls(0)
 {
@@ -110,12 +90,7 @@ ArmedSpfRIE::ArmedSpfRIE(Ipv4Address dest,
                          uint32_t interface,
                          uint32_t nextIface,
                          uint32_t distance)
-    : m_dest(dest),
-      m_destNetworkMask(Ipv4Mask::GetOnes()),
-      m_gateway(gateway),
-      m_interface(interface),
-      m_nextIface(nextIface),
-      m_distance(distance),
+    : RouteInfoEntry(dest, Ipv4Mask::GetOnes(), gateway, interface, nextIface, distance),
       m_cumulative_loss(0.0),
       m_num_pulls(0)
 {
@@ -123,83 +98,6 @@ ArmedSpfRIE::ArmedSpfRIE(Ipv4Address dest,
     m_cumulative_loss = 1 - exp(-(double)distance);
 }
 
-bool
-ArmedSpfRIE::IsHost() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_destNetworkMask == Ipv4Mask::GetOnes();
-}
-
-Ipv4Address
-ArmedSpfRIE::GetDest() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_dest;
-}
-
-bool
-ArmedSpfRIE::IsNetwork() const
-{
-    NS_LOG_FUNCTION(this);
-    return !IsHost();
-}
-
-bool
-ArmedSpfRIE::IsDefault() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_dest == Ipv4Address::GetZero();
-}
-
-Ipv4Address
-ArmedSpfRIE::GetDestNetwork() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_dest;
-}
-
-Ipv4Mask
-ArmedSpfRIE::GetDestNetworkMask() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_destNetworkMask;
-}
-
-bool
-ArmedSpfRIE::IsGateway() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_gateway != Ipv4Address::GetZero();
-}
-
-Ipv4Address
-ArmedSpfRIE::GetGateway() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_gateway;
-}
-
-uint32_t
-ArmedSpfRIE::GetInterface() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_interface;
-}
-
-uint32_t
-ArmedSpfRIE::GetNextIface() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_nextIface;
-}
-
-uint32_t
-ArmedSpfRIE::GetDistance() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_distance;
-}
-
 double
 ArmedSpfRIE::GetCumulativeLoss() const
 {
@@ -224,6 +122,13 @@ ArmedSpfRIE::PullArm()
     m_num_pulls += 1;
 }
 
+void
+ArmedSpfRIE::SetArm(double cumulativeLoss, uint32_t nPulls)
+{
+    m_cumulative_loss = cumulativeLoss;
+    m_num_pulls = nPulls;
+}
+
 ArmedSpfRIE
 ArmedSpfRIE::CreateHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
 {
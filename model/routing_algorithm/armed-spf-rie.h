@@ -25,7 +25,7 @@ class ArmedSpfRIE : public RouteInfoEntry
     /**
      * \brief destructor.
      */
-    ~ArmedSpfRIE() override;
+    ~ArmedSpfRIE();
 
     /**
      * \brief Copy Constructor
@@ -39,35 +39,38 @@ class ArmedSpfRIE : public RouteInfoEntry
      */
     ArmedSpfRIE(const ArmedSpfRIE* route);
 
-    // These methods inherited from base class
-    bool IsHost() const override;
-    bool IsNetwork() const override;
-    bool IsDefault() const override;
-    bool IsGateway() const override;
-    Ipv4Address GetGateway() const override;
-    Ipv4Address GetDest() const override;
-    Ipv4Address GetDestNetwork() const override;
-    Ipv4Mask GetDestNetworkMask() const override;
-    uint32_t GetInterface() const override;
-
     /**
      * \brief Get the output interface at next hop
      *
      * \return index of the interface
      */
-    uint32_t GetNextIface() const;
+    uint32_t GetNextIface() const
+    {
+        return GetRecordNextIface();
+    }
 
     /**
      * @brief Get the Distance to the destination
      *
      * @return the distance value
      */
-    uint32_t GetDistance() const;
+    uint32_t GetDistance() const
+    {
+        return GetRecordDistance();
+    }
 
     double GetCumulativeLoss() const;
     uint32_t GetNumPulls() const;
     void PullArm();
     void UpdateArm(double reward);
+
+    /**
+     * \brief Set the statistics of the arm, e.g., to those of an earlier run.
+     * \param cumulativeLoss the cumulative loss
+     * \param nPulls the number of pulls
+     */
+    void SetArm(double cumulativeLoss, uint32_t nPulls);
+
     /**
      * \return An ArmedSpfRIE object corresponding to the input parameters.
      * \param dest Ipv4Address of the destination
@@ -172,13 +175,7 @@ class ArmedSpfRIE : public RouteInfoEntry
                 uint32_t nextIface,
                 uint32_t distance);
 
-    Ipv4Address m_dest;         //!< destination address
-    Ipv4Mask m_destNetworkMask; //!< destination network mask
-    Ipv4Address m_gateway;      //!< gateway
-    uint32_t m_interface;       //!< output interface
-    uint32_t m_nextIface;       //!< output interface in next hop
-    uint32_t m_distance;        //!< the distance from current node to the destination
-    double m_cumulative_loss;   //!< The arm cumulative loss
+    double m_cumulative_loss; //!< The arm cumulative loss
     uint32_t m_num_pulls;
 };
 
@@ -4,7 +4,9 @@
 
 #include "../romam-routing.h"
 #include "../utility/ospf-router.h"
+#include "../utility/phase-profiler.h"
 #include "../utility/romam-router.h"
+#include "route-batch-queue.h"
 #include "route-candidate-queue.h"
 
 #include "ns3/assert.h"
@@ -16,10 +18,15 @@
 #include "ns3/node-list.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <iostream>
+#include <map>
 #include <queue>
+#include <set>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -29,19 +36,25 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE("DijkstraAlgorithm");
 
 DijkstraAlgorithm::DijkstraAlgorithm()
-    : m_spfroot(nullptr)
+    : m_spfroot(nullptr),
+      m_lsdb(nullptr),
+      m_epoch(0),
+      m_directory(nullptr),
+      m_areas(nullptr),
+      m_areasVersion(0),
+      m_rootArea(AreaDirectory::BACKBONE),
+      m_rootBackbone(true),
+      m_incremental(false),
+      m_threads(1),
+      m_tree(nullptr),
+      m_sharedTrees(nullptr)
 {
     NS_LOG_FUNCTION(this);
-    m_lsdb = new LSDB();
 }
 
 DijkstraAlgorithm::~DijkstraAlgorithm()
 {
     NS_LOG_FUNCTION(this);
-    if (m_lsdb)
-    {
-        delete m_lsdb;
-    }
 }
 
 void
@@ -58,25 +71,10 @@ DijkstraAlgorithm::DeleteRoutes()
             continue;
         }
         Ptr<RomamRouting> gr = router->GetRoutingProtocol();
-        uint32_t j = 0;
-        uint32_t nRoutes = gr->GetNRoutes();
         NS_LOG_LOGIC("Deleting " << gr->GetNRoutes() << " routes from node " << node->GetId());
-        // Each time we delete route 0, the route index shifts downward
-        // We can delete all routes if we delete the route numbered 0
-        // nRoutes times
-        for (j = 0; j < nRoutes; j++)
-        {
-            NS_LOG_LOGIC("Deleting route " << j << " from node " << node->GetId());
-            gr->RemoveRoute(0);
-        }
-        NS_LOG_LOGIC("Deleted " << j << " routes from node " << node->GetId());
-    }
-    if (m_lsdb)
-    {
-        NS_LOG_LOGIC("Deleting LSDB, creating new one");
-        delete m_lsdb;
-        m_lsdb = new LSDB();
+        gr->ClearRoutes();
     }
+    m_records.clear();
 }
 
 void
@@ -86,6 +84,49 @@ DijkstraAlgorithm::InsertLSDB(LSDB* lsdb)
     // lsdb->Print(std::cout);
 }
 
+void
+DijkstraAlgorithm::InsertRouterDirectory(const RouterDirectory* directory)
+{
+    m_directory = directory;
+}
+
+void
+DijkstraAlgorithm::InsertAreaDirectory(const AreaDirectory* areas)
+{
+    m_areas = areas;
+}
+
+void
+DijkstraAlgorithm::SetIncremental(bool incremental)
+{
+    m_incremental = incremental;
+    if (!incremental)
+    {
+        m_records.clear();
+    }
+}
+
+void
+DijkstraAlgorithm::ClearTrees()
+{
+    NS_LOG_FUNCTION(this);
+    m_records.clear();
+}
+
+void
+DijkstraAlgorithm::SetThreads(uint32_t nThreads)
+{
+    NS_LOG_FUNCTION(this << nThreads);
+    m_threads = nThreads > 0 ? nThreads : std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+void
+DijkstraAlgorithm::InsertSharedTrees(SharedTreeTable* trees)
+{
+    NS_LOG_FUNCTION(this << trees);
+    m_sharedTrees = trees;
+}
+
 void
 DijkstraAlgorithm::InitializeRoutes()
 {
@@ -98,6 +139,13 @@ DijkstraAlgorithm::InitializeRoutes()
         NS_LOG_LOGIC("Empty LSDB, please insert LSDB.");
         return;
     }
+    UpdateGraph();
+    if (!m_directory)
+    {
+        m_localDirectory.Build();
+        m_directory = &m_localDirectory;
+    }
+    m_records.clear();
 
     NS_LOG_INFO("About to start SPF calculation");
     for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
@@ -120,13 +168,398 @@ DijkstraAlgorithm::InitializeRoutes()
         //
         if (rtr && rtr->GetNumLSAs())
         {
-            SPFCalculate(rtr->GetRouterId());
+            m_records.emplace_back(rtr->GetRouterId());
+        }
+    }
+    uint32_t nThreads = std::min<uint32_t>(m_threads, m_records.size());
+    if (nThreads > 1)
+    {
+        ComputeTreesInParallel(nThreads);
+    }
+    else
+    {
+        for (auto i = m_records.begin(); i != m_records.end(); i++)
+        {
+            ComputeTree(*i);
         }
+        InstallTables(nullptr);
+    }
+    if (!m_incremental)
+    {
+        m_records.clear();
     }
     std::cout << "---Finished initialize routes with Dijkstra algorithm---\n";
     NS_LOG_INFO("Finished SPF calculation");
 }
 
+void
+DijkstraAlgorithm::InitializeRoutes(Ipv4Address routerId)
+{
+    NS_LOG_FUNCTION(this << routerId);
+    if (m_lsdb == nullptr)
+    {
+        NS_LOG_LOGIC("Empty LSDB, please insert LSDB.");
+        return;
+    }
+    UpdateGraph();
+    if (!m_directory)
+    {
+        m_localDirectory.Build();
+        m_directory = &m_localDirectory;
+    }
+    if (m_graph.GetVertex(routerId) == LSDBGraph::NO_VERTEX)
+    {
+        NS_LOG_LOGIC("No LSA for router " << routerId);
+        return;
+    }
+    NS_ASSERT_MSG(!m_incremental, "Only a full engine computes the routes of one router");
+    m_records.clear();
+    m_records.emplace_back(routerId);
+    ComputeTree(m_records.back());
+    std::set<uint32_t> nodes;
+    nodes.insert(m_directory->GetNodeIdByRouterId(routerId));
+    InstallTables(&nodes);
+    m_records.clear();
+}
+
+void
+DijkstraAlgorithm::UpdateRoutes(const std::set<uint32_t>& changed)
+{
+    NS_LOG_FUNCTION(this << changed.size());
+    if (m_records.empty())
+    {
+        NS_LOG_LOGIC("No SPF trees kept, computing all the routes");
+        InitializeRoutes();
+        return;
+    }
+    UpdateGraph();
+    std::unordered_map<uint32_t, RouteTreeRecord> previous;
+    for (auto i = m_records.begin(); i != m_records.end(); i++)
+    {
+        previous.emplace(i->GetRoot().Get(), std::move(*i));
+    }
+    m_records.clear();
+
+    std::set<uint32_t> nodes;
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<Node> node = *i;
+        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
+        uint32_t systemId = Simulator::GetSystemId();
+        if (node->GetSystemId() != systemId || !rtr || !rtr->GetNumLSAs())
+        {
+            continue;
+        }
+        Ipv4Address root = rtr->GetRouterId();
+        auto old = previous.find(root.Get());
+        if (old != previous.end() && !old->second.IsAffected(m_lsdb, changed, root))
+        {
+            m_records.push_back(std::move(old->second));
+            PatchTree(m_records.back(), changed);
+            m_records.back().GetNodes(nodes);
+        }
+        else
+        {
+            if (old != previous.end())
+            {
+                old->second.GetNodes(nodes);
+            }
+            m_records.emplace_back(root);
+            ComputeTree(m_records.back());
+            m_records.back().GetNodes(nodes);
+        }
+        if (old != previous.end())
+        {
+            previous.erase(old);
+        }
+    }
+    // routers that left the simulation
+    for (auto i = previous.begin(); i != previous.end(); i++)
+    {
+        i->second.GetNodes(nodes);
+    }
+    InstallTables(&nodes);
+    NS_LOG_INFO("Finished incremental SPF update");
+}
+
+void
+DijkstraAlgorithm::ComputeTree(RouteTreeRecord& tree)
+{
+    m_tree = &tree;
+    SPFCalculate(tree.GetRoot());
+    m_tree = nullptr;
+}
+
+void
+DijkstraAlgorithm::ComputeTreesInParallel(uint32_t nThreads)
+{
+    NS_LOG_FUNCTION(this << nThreads);
+    //
+    // The SPF runs only read the LSDB, so the workers share it; each keeps the
+    // SPF status of the vertices, its root pointer and tree record itself.
+    // The roots are handed out one at a time and every worker writes to the
+    // records of its roots only.  The table of a root is pushed to a queue as
+    // soon as its tree is done, and the tree freed unless the engine keeps
+    // it; the simulator thread, which computes trees too, installs the tables
+    // of the queue between its trees, so only the trees being computed and
+    // the tables not installed yet are held at a time.  The shared trees, if
+    // any, are looked up and added under the lock of their table.
+    //
+    // the workers are kept, so their graph and vertex storage outlive the run
+    while (m_workers.size() < nThreads - 1)
+    {
+        m_workers.emplace_back(new DijkstraAlgorithm());
+    }
+    LoadCandidateCaps();
+    std::atomic<uint32_t> next(0);
+    RouteBatchQueue queue;
+    auto compute = [this, &next, &queue](DijkstraAlgorithm* engine) {
+        uint32_t k = next++;
+        if (k >= m_records.size())
+        {
+            return false;
+        }
+        engine->ComputeTree(m_records[k]);
+        std::map<uint32_t, RouteBatch> tables;
+        m_records[k].CollectRoutes(tables, nullptr);
+        if (!m_incremental)
+        {
+            m_records[k] = RouteTreeRecord(m_records[k].GetRoot());
+        }
+        for (auto i = tables.begin(); i != tables.end(); i++)
+        {
+            // capped before it waits in the queue, which then holds no more
+            CapCandidates(i->first, i->second);
+            queue.Push(i->first, std::move(i->second));
+        }
+        queue.Complete();
+        return true;
+    };
+    auto work = [this, &compute](DijkstraAlgorithm* worker) {
+        worker->m_lsdb = m_lsdb;
+        worker->m_areas = m_areas;
+        worker->m_sharedTrees = m_sharedTrees;
+        worker->UpdateGraph();
+        worker->m_directory = m_directory;
+        while (compute(worker))
+        {
+        }
+    };
+    std::vector<std::thread> workers;
+    for (uint32_t i = 0; i < nThreads - 1; i++)
+    {
+        workers.emplace_back(work, m_workers[i].get());
+    }
+
+    if (m_tableCopy)
+    {
+        m_tableCopy->clear();
+    }
+    std::vector<bool> installed(NodeList::GetNNodes(), false);
+    auto install = [this, &installed](uint32_t node, RouteBatch& routes) {
+        // a table replaces the routes of the node, so a node has one
+        NS_ASSERT_MSG(!installed[node], "Two tables computed for node " << node);
+        installed[node] = true;
+        InstallTable(node, routes);
+    };
+    while (compute(this))
+    {
+        queue.Drain(install);
+    }
+    // sleep until the workers push tables or complete their last roots
+    while (queue.WaitForTables(m_records.size()))
+    {
+        queue.Drain(install);
+    }
+    for (auto i = workers.begin(); i != workers.end(); i++)
+    {
+        i->join();
+    }
+    queue.Drain(install);
+    InstallEmptyTables(installed);
+}
+
+void
+DijkstraAlgorithm::PatchTree(RouteTreeRecord& tree, const std::set<uint32_t>& changed)
+{
+    NS_LOG_FUNCTION(this << tree.GetRoot());
+    std::vector<Ipv4Address> vertices = tree.GetChangedVertices(changed);
+    if (vertices.empty())
+    {
+        return;
+    }
+    //
+    // The shortest paths of the tree did not change, so the vertices keep their
+    // distance and root exits; only the routes derived from the links of the
+    // changed vertices have to be regenerated.
+    //
+    Vertex root(m_graph.GetLSA(tree.GetRoot()));
+    m_spfroot = &root;
+    m_tree = &tree;
+    for (auto i = vertices.begin(); i != vertices.end(); i++)
+    {
+        NS_LOG_LOGIC("Regenerating the routes of vertex " << *i);
+        Vertex v(m_graph.GetLSA(*i));
+        tree.RestoreVertex(&v);
+        tree.ClearSegments(*i);
+        tree.BeginSegment(*i, RouteTreeRecord::TRANSIT);
+        SPFIntraAddRouter(&v);
+        tree.BeginSegment(*i, RouteTreeRecord::STUB);
+        SPFIntraAddStubs(&v, m_graph.GetVertex(*i));
+    }
+    m_tree = nullptr;
+    m_spfroot = nullptr;
+}
+
+void
+DijkstraAlgorithm::UpdateGraph()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_graph.IsCurrent(m_lsdb))
+    {
+        m_graph.Build(m_lsdb);
+        m_statusEpochs.assign(m_graph.GetNVertices(), 0);
+        m_status.assign(m_graph.GetNVertices(), LSA::LSA_SPF_NOT_EXPLORED);
+        m_epoch = 0;
+        m_areasVersion = 0;
+    }
+    if (!m_areas || !m_areas->IsEnabled())
+    {
+        m_vertexAreas.clear();
+        m_vertexBackbone.clear();
+        m_areasVersion = 0;
+    }
+    else if (m_areasVersion != m_areas->GetVersion())
+    {
+        m_areas->Classify(m_graph, m_vertexAreas, m_vertexBackbone);
+        m_areasVersion = m_areas->GetVersion();
+    }
+    if (m_sharedTrees)
+    {
+        m_sharedTrees->Bind(m_lsdb);
+    }
+}
+
+void
+DijkstraAlgorithm::SetRootAreas(Ipv4Address root)
+{
+    uint32_t index = m_graph.GetVertex(root);
+    if (!m_vertexAreas.empty() && index != LSDBGraph::NO_VERTEX)
+    {
+        m_rootArea = m_vertexAreas[index];
+        m_rootBackbone = m_vertexBackbone[index] != 0;
+    }
+}
+
+bool
+DijkstraAlgorithm::IsInRootAreas(uint32_t v) const
+{
+    return m_vertexAreas.empty() || m_vertexAreas[v] == m_rootArea ||
+           (m_rootBackbone && m_vertexBackbone[v]);
+}
+
+void
+DijkstraAlgorithm::ResetStatus()
+{
+    if (++m_epoch == 0)
+    {
+        // the epochs wrapped around, so the oldest stamps could look current
+        std::fill(m_statusEpochs.begin(), m_statusEpochs.end(), 0);
+        m_epoch = 1;
+    }
+}
+
+LSA::SPFStatus
+DijkstraAlgorithm::GetStatus(uint32_t v) const
+{
+    return m_statusEpochs[v] == m_epoch ? m_status[v] : LSA::LSA_SPF_NOT_EXPLORED;
+}
+
+void
+DijkstraAlgorithm::SetStatus(uint32_t v, LSA::SPFStatus status)
+{
+    NS_ASSERT(v < m_status.size());
+    m_statusEpochs[v] = m_epoch;
+    m_status[v] = status;
+}
+
+std::size_t
+DijkstraAlgorithm::GetMemoryUsage() const
+{
+    std::size_t bytes = m_graph.GetMemoryUsage() + m_vertices.GetMemoryUsage();
+    bytes += m_statusEpochs.capacity() * sizeof(uint32_t) +
+             m_status.capacity() * sizeof(LSA::SPFStatus);
+    bytes += m_vertexAreas.capacity() * sizeof(uint32_t) + m_vertexBackbone.capacity();
+    bytes += m_treeRouters.capacity() * sizeof(uint32_t) +
+             m_routerVertices.capacity() * sizeof(Vertex*);
+    bytes += m_records.capacity() * sizeof(m_records[0]);
+    for (auto i = m_records.begin(); i != m_records.end(); i++)
+    {
+        bytes += i->GetMemoryUsage();
+    }
+    for (auto i = m_workers.begin(); i != m_workers.end(); i++)
+    {
+        bytes += sizeof(**i) + (*i)->GetMemoryUsage();
+    }
+    return bytes;
+}
+
+void
+DijkstraAlgorithm::InstallTables(const std::set<uint32_t>* nodes)
+{
+    NS_LOG_FUNCTION(this);
+    PhaseProfiler::Scope scope(PhaseProfiler::ROUTE_INSTALL);
+    LoadCandidateCaps();
+    std::map<uint32_t, RouteBatch> tables;
+    std::map<uint32_t, RouteBatch> rootTables;
+    for (auto i = m_records.begin(); i != m_records.end(); i++)
+    {
+        // the table of a root is capped before the next one is collected
+        rootTables.clear();
+        i->CollectRoutes(rootTables, nodes);
+        for (auto j = rootTables.begin(); j != rootTables.end(); j++)
+        {
+            NS_ASSERT_MSG(!tables.count(j->first), "Two tables computed for node " << j->first);
+            CapCandidates(j->first, j->second);
+            tables[j->first] = std::move(j->second);
+        }
+    }
+    // the nodes that lost all their routes get an empty table
+    if (nodes)
+    {
+        for (auto i = nodes->begin(); i != nodes->end(); i++)
+        {
+            tables[*i];
+        }
+    }
+    else
+    {
+        uint32_t systemId = Simulator::GetSystemId();
+        for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+        {
+            if ((*i)->GetSystemId() == systemId && (*i)->GetObject<RomamRouter>())
+            {
+                tables[(*i)->GetId()];
+            }
+        }
+    }
+    // the nodes only change the routes that differ from the ones they hold
+    for (auto i = tables.begin(); i != tables.end(); i++)
+    {
+        Ptr<RomamRouter> router = NodeList::GetNode(i->first)->GetObject<RomamRouter>();
+        NS_ASSERT(router);
+        Ptr<RomamRouting> gr = router->GetRoutingProtocol();
+        NS_ASSERT(gr);
+        NS_LOG_LOGIC("Updating node " << i->first << " to " << i->second.GetN() << " routes");
+        gr->UpdateRoutes(i->second);
+        gr->SetNPrunedRoutes(GetNPrunedCandidates(i->first));
+    }
+    if (m_tableCopy && !nodes)
+    {
+        m_tableCopy->swap(tables);
+    }
+}
+
 //
 // This method is derived from quagga ospf_spf_next ().  See RFC2328 Section
 // 16.1 (2) for further details.
@@ -147,79 +580,36 @@ DijkstraAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
 
     Vertex* w = nullptr;
     LSA* w_lsa = nullptr;
-    LinkRecord* l = nullptr;
     uint32_t distance = 0;
-    uint32_t numRecordsInVertex = 0;
     //
     // V points to a Router-LSA or Network-LSA
-    // Loop over the links in router LSA or attached routers in Network LSA
+    // Loop over the edges the graph keeps for it, in the order of the LSA: the
+    // point-to-point and transit network records of a router LSA, or the
+    // routers attached to a network LSA.
     //
-    if (v->GetVertexType() == Vertex::VertexRouter)
-    {
-        numRecordsInVertex = v->GetLSA()->GetNLinkRecords();
-    }
-    if (v->GetVertexType() == Vertex::VertexNetwork)
-    {
-        numRecordsInVertex = v->GetLSA()->GetNAttachedRouters();
-    }
-
-    for (uint32_t i = 0; i < numRecordsInVertex; i++)
+    // (a) Links to stub networks are not edges of the graph.  They will be
+    // considered in the second stage of the shortest path calculation.
+    //
+    uint32_t index = m_graph.GetVertex(v->GetVertexId());
+    NS_ASSERT_MSG(index != LSDBGraph::NO_VERTEX, "No LSA for vertex " << v->GetVertexId());
+    for (uint32_t e = m_graph.GetEdgesBegin(index); e < m_graph.GetEdgesEnd(index); e++)
     {
-        // Get w_lsa:  In case of V is Router-LSA
-        if (v->GetVertexType() == Vertex::VertexRouter)
-        {
-            NS_LOG_LOGIC("Examining link " << i << " of " << v->GetVertexId() << "'s "
-                                           << v->GetLSA()->GetNLinkRecords() << " link records");
-            //
-            // (a) If this is a link to a stub network, examine the next link in V's LSA.
-            // Links to stub networks will be considered in the second stage of the
-            // shortest path calculation.
-            //
-            l = v->GetLSA()->GetLinkRecord(i);
-            NS_ASSERT(l != nullptr);
-            if (l->GetLinkType() == LinkRecord::StubNetwork)
-            {
-                NS_LOG_LOGIC("Found a Stub record to " << l->GetLinkId());
-                continue;
-            }
-            //
-            // (b) Otherwise, W is a transit vertex (router or transit network).  Look up
-            // the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
-            // database.
-            //
-            if (l->GetLinkType() == LinkRecord::PointToPoint)
-            {
-                //
-                // Lookup the link state advertisement of the new link -- we call it <w> in
-                // the link state database.
-                //
-                w_lsa = m_lsdb->GetLSA(l->GetLinkId());
-                NS_ASSERT(w_lsa);
-                NS_LOG_LOGIC("Found a P2P record from " << v->GetVertexId() << " to "
-                                                        << w_lsa->GetLinkStateId());
-            }
-            else if (l->GetLinkType() == LinkRecord::TransitNetwork)
-            {
-                w_lsa = m_lsdb->GetLSA(l->GetLinkId());
-                NS_ASSERT(w_lsa);
-                NS_LOG_LOGIC("Found a Transit record from " << v->GetVertexId() << " to "
-                                                            << w_lsa->GetLinkStateId());
-            }
-            else
-            {
-                NS_ASSERT_MSG(0, "illegal Link Type");
-            }
-        }
-        // Get w_lsa:  In case of V is Network-LSA
-        if (v->GetVertexType() == Vertex::VertexNetwork)
+        //
+        // (b) W is a transit vertex (router or transit network), or a router
+        // attached to the network V.  Its LSA is the target of the edge.
+        //
+        uint32_t target = m_graph.GetTarget(e);
+        w_lsa = m_graph.GetLSA(target);
+        NS_LOG_LOGIC("Found a link from " << v->GetVertexId() << " to "
+                                          << w_lsa->GetLinkStateId());
+        //
+        // With areas, the tree does not leave the areas of the root: the other
+        // areas are reached through the summaries of the border routers.
+        //
+        if (!IsInRootAreas(target))
         {
-            w_lsa = m_lsdb->GetLSAByLinkData(v->GetLSA()->GetAttachedRouter(i));
-            if (!w_lsa)
-            {
-                continue;
-            }
-            NS_LOG_LOGIC("Found a Network LSA from " << v->GetVertexId() << " to "
-                                                     << w_lsa->GetLinkStateId());
+            NS_LOG_LOGIC("Skipping ->  LSA " << w_lsa->GetLinkStateId() << " out of the area");
+            continue;
         }
 
         // Note:  w_lsa at this point may be either RouterLSA or NetworkLSA
@@ -230,7 +620,7 @@ DijkstraAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
         // If the link is to a router that is already in the shortest path first tree
         // then we have it covered -- ignore it.
         //
-        if (w_lsa->GetStatus() == LSA::LSA_SPF_IN_SPFTREE)
+        if (GetStatus(target) == LSA::LSA_SPF_IN_SPFTREE)
         {
             NS_LOG_LOGIC("Skipping ->  LSA " << w_lsa->GetLinkStateId() << " already in SPF tree");
             continue;
@@ -241,20 +631,14 @@ DijkstraAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
         // calculated) shortest path to vertex V and the advertised cost of the link
         // between vertices V and W.
         //
-        if (v->GetLSA()->GetLSType() == LSA::RouterLSA)
-        {
-            NS_ASSERT(l != nullptr);
-            distance = v->GetDistanceFromRoot() + l->GetMetric();
-        }
-        else
-        {
-            distance = v->GetDistanceFromRoot();
-        }
+        // The edges leaving a network have a metric of 0.
+        //
+        distance = v->GetDistanceFromRoot() + m_graph.GetMetric(e);
 
         NS_LOG_LOGIC("Considering w_lsa " << w_lsa->GetLinkStateId());
 
         // Is there already vertex w in candidate list?
-        if (w_lsa->GetStatus() == LSA::LSA_SPF_NOT_EXPLORED)
+        if (GetStatus(target) == LSA::LSA_SPF_NOT_EXPLORED)
         {
             // Calculate nexthop to w
             // We need to figure out how to actually get to the new router represented
@@ -263,10 +647,10 @@ DijkstraAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
             // used to forward the packets.
 
             // prepare vertex w
-            w = new Vertex(w_lsa);
-            if (SPFNexthopCalculation(v, w, l, distance))
+            w = m_vertices.Allocate(w_lsa);
+            if (SPFNexthopCalculation(v, w, e, distance))
             {
-                w_lsa->SetStatus(LSA::LSA_SPF_CANDIDATE);
+                SetStatus(target, LSA::LSA_SPF_CANDIDATE);
                 //
                 // Push this new vertex onto the priority queue (ordered by distance from the
                 // root node).
@@ -282,7 +666,7 @@ DijkstraAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
                               "SPFNexthopCalculation never " << "return false, but it does now!");
             }
         }
-        else if (w_lsa->GetStatus() == LSA::LSA_SPF_CANDIDATE)
+        else if (GetStatus(target) == LSA::LSA_SPF_CANDIDATE)
         {
             //
             // We have already considered the link represented by <w>.  What wse have to
@@ -327,16 +711,11 @@ DijkstraAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
                 // (ospf_spf.c::859), although the detail implementation
                 // is very different from quagga (blame ns3::DijkstraAlgorithm)
 
-                // prepare vertex w
-                w = new Vertex(w_lsa);
-                SPFNexthopCalculation(v, w, l, distance);
+                // prepare vertex w; the arena releases it along with the tree
+                w = m_vertices.Allocate(w_lsa);
+                SPFNexthopCalculation(v, w, e, distance);
                 cw->MergeRootExitDirections(w);
                 cw->MergeParent(w);
-                // SPFVertexAddParent (w) is necessary as the destructor of
-                // SPFVertex checks if the vertex and its parent is linked
-                // bidirectionally
-                SPFVertexAddParent(w);
-                delete w;
             }
             else // cw->GetDistanceFromRoot () > w->GetDistanceFromRoot ()
             {
@@ -348,13 +727,13 @@ DijkstraAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
                 // N.B. the nexthop_calculation is conditional, if it finds a valid nexthop
                 // it will call spf_add_parents, which will flush the old parents
                 //
-                if (SPFNexthopCalculation(v, cw, l, distance))
+                if (SPFNexthopCalculation(v, cw, e, distance))
                 {
                     //
                     // If we've changed the cost to get to the vertex represented by <w>, we
                     // must reorder the priority queue keyed to that cost.
                     //
-                    candidate.Reorder();
+                    candidate.Update(cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -372,9 +751,9 @@ DijkstraAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
 // For now, this is greatly simplified from the quagga code
 //
 int
-DijkstraAlgorithm::SPFNexthopCalculation(Vertex* v, Vertex* w, LinkRecord* l, uint32_t distance)
+DijkstraAlgorithm::SPFNexthopCalculation(Vertex* v, Vertex* w, uint32_t e, uint32_t distance)
 {
-    NS_LOG_FUNCTION(this << v << w << l << distance);
+    NS_LOG_FUNCTION(this << v << w << e << distance);
     //
     // If w is a NetworkVertex, l should be null
     /*
@@ -428,31 +807,30 @@ DijkstraAlgorithm::SPFNexthopCalculation(Vertex* v, Vertex* w, LinkRecord* l, ui
             // address -- the next hop address to get from <v> to <w> and all networks
             // accessed through that path.
             //
-            // SPFGetNextLink () is a little odd.  used in this way it is just going to
-            // return the link record describing the link from <w> to <v>.  Think of it as
-            // SPFGetLink.
+            // The graph keeps, for each edge, the first edge leading back from its
+            // target: here the link from <w> to <v>.
             //
-            NS_ASSERT(l);
-            LinkRecord* linkRemote = nullptr;
-            linkRemote = SPFGetNextLink(w, v, linkRemote);
+            NS_ASSERT(m_graph.GetLinkRecord(e));
+            uint32_t remote = m_graph.GetReverse(e);
+            NS_ASSERT_MSG(remote != LSDBGraph::NO_EDGE, "No link back to " << v->GetVertexId());
             //
-            // At this point, <l> is the Romam Router Link Record describing the point-
-            // to point link from <v> to <w> from the perspective of <v>; and <linkRemote>
-            // is the Romam Router Link Record describing that same link from the
-            // perspective of <w> (back to <v>).  Now we can just copy the next hop
-            // address from the m_linkData member variable.
+            // At this point, <e> is the edge describing the point-to point link from
+            // <v> to <w> from the perspective of <v>; and <remote> is the edge
+            // describing that same link from the perspective of <w> (back to <v>).
+            // Now we can just copy the next hop address from the link data of the
+            // edge.
             //
             // The next hop member variable we put in <w> has the sense "in order to get
             // from the root node to the host represented by vertex <w>, you have to send
             // the packet to the next hop address specified in w->m_nextHop.
             //
-            Ipv4Address nextHop = linkRemote->GetLinkData();
+            Ipv4Address nextHop = m_graph.GetLinkData(remote);
             //
             // Now find the outgoing interface corresponding to the point to point link
-            // from the perspective of <v> -- remember that <l> is the link "from"
+            // from the perspective of <v> -- remember that <e> is the link "from"
             // <v> "to" <w>.
             //
-            uint32_t outIf = FindOutgoingInterfaceId(l->GetLinkData());
+            uint32_t outIf = FindOutgoingInterfaceId(m_graph.GetLinkData(e));
 
             w->SetRootExitDirection(nextHop, outIf);
             w->SetDistanceFromRoot(distance);
@@ -492,22 +870,24 @@ DijkstraAlgorithm::SPFNexthopCalculation(Vertex* v, Vertex* w, LinkRecord* l, ui
             // router.  The list of next hops is then determined by
             // examining the destination's router-LSA...
             NS_ASSERT(w->GetVertexType() == Vertex::VertexRouter);
-            LinkRecord* linkRemote = nullptr;
-            while ((linkRemote = SPFGetNextLink(w, v, linkRemote)))
-            {
-                /* ...For each link in the router-LSA that points back to the
-                 * parent network, the link's Link Data field provides the IP
-                 * address of a next hop router.  The outgoing interface to
-                 * use can then be derived from the next hop IP address (or
-                 * it can be inherited from the parent network).
-                 */
-                Ipv4Address nextHop = linkRemote->GetLinkData();
-                uint32_t outIf = v->GetRootExitDirection().second;
-                w->SetRootExitDirection(nextHop, outIf);
-                NS_LOG_LOGIC("Next hop from " << v->GetVertexId() << " to " << w->GetVertexId()
-                                              << " goes through next hop " << nextHop
-                                              << " via outgoing interface " << outIf);
-            }
+            //
+            // The first link in the router-LSA that points back to the parent
+            // network is the reverse of the edge from the network.
+            //
+            uint32_t remote = m_graph.GetReverse(e);
+            NS_ASSERT_MSG(remote != LSDBGraph::NO_EDGE, "No link back to " << v->GetVertexId());
+            /* ...For each link in the router-LSA that points back to the
+             * parent network, the link's Link Data field provides the IP
+             * address of a next hop router.  The outgoing interface to
+             * use can then be derived from the next hop IP address (or
+             * it can be inherited from the parent network).
+             */
+            Ipv4Address nextHop = m_graph.GetLinkData(remote);
+            uint32_t outIf = v->GetRootExitDirection().second;
+            w->SetRootExitDirection(nextHop, outIf);
+            NS_LOG_LOGIC("Next hop from " << v->GetVertexId() << " to " << w->GetVertexId()
+                                          << " goes through next hop " << nextHop
+                                          << " via outgoing interface " << outIf);
         }
         else
         {
@@ -541,106 +921,22 @@ DijkstraAlgorithm::SPFNexthopCalculation(Vertex* v, Vertex* w, LinkRecord* l, ui
 }
 
 //
-// This method is derived from quagga ospf_get_next_link ()
-//
-// First search the Romam Router Link Records of vertex <v> for one
-// representing a point-to point link to vertex <w>.
-//
-// What is done depends on prev_link.  Contrary to appearances, prev_link just
-// acts as a flag here.  If prev_link is NULL, we return the first Global
-// Router Link Record we find that describes a point-to-point link from <v>
-// to <w>.  If prev_link is not NULL, we return a Romam Router Link Record
-// representing a possible *second* link from <v> to <w>.
-//
-LinkRecord*
-DijkstraAlgorithm::SPFGetNextLink(Vertex* v, Vertex* w, LinkRecord* prev_link)
-{
-    NS_LOG_FUNCTION(this << v << w << prev_link);
-
-    bool skip = true;
-    bool found_prev_link = false;
-    LinkRecord* l;
-    //
-    // If prev_link is 0, we are really looking for the first link, not the next
-    // link.
-    //
-    if (prev_link == nullptr)
-    {
-        skip = false;
-        found_prev_link = true;
-    }
-    //
-    // Iterate through the Romam Router Link Records advertised by the vertex
-    // <v> looking for records representing the point-to-point links off of this
-    // vertex.
-    //
-    for (uint32_t i = 0; i < v->GetLSA()->GetNLinkRecords(); ++i)
-    {
-        l = v->GetLSA()->GetLinkRecord(i);
-        //
-        // The link ID of a link record representing a point-to-point link is set to
-        // the router ID of the neighboring router -- the router to which the link
-        // connects from the perspective of <v> in this case.  The vertex ID is also
-        // set to the router ID (using the link state advertisement of a router node).
-        // We're just checking to see if the link <l> is actually the link from <v> to
-        // <w>.
-        //
-        if (l->GetLinkId() == w->GetVertexId())
-        {
-            if (!found_prev_link)
-            {
-                NS_LOG_LOGIC("Skipping links before prev_link found");
-                found_prev_link = true;
-                continue;
-            }
-
-            NS_LOG_LOGIC("Found matching link l:  linkId = " << l->GetLinkId()
-                                                             << " linkData = " << l->GetLinkData());
-            //
-            // If skip is false, don't (not too surprisingly) skip the link found -- it's
-            // the one we're interested in.  That's either because we didn't pass in a
-            // previous link, and we're interested in the first one, or because we've
-            // skipped a previous link and moved forward to the next (which is then the
-            // one we want).
-            //
-            if (!skip)
-            {
-                NS_LOG_LOGIC("Returning the found link");
-                return l;
-            }
-            else
-            {
-                //
-                // Skip is true and we've found a link from <v> to <w>.  We want the next one.
-                // Setting skip to false gets us the next point-to-point Romam Router link
-                // record in the LSA from <v>.
-                //
-                NS_LOG_LOGIC("Skipping the found link");
-                skip = false;
-                continue;
-            }
-        }
-    }
-    return nullptr;
-}
-
-//
-// Used to test if a node is a stub, from an OSPF sense.
-// If there is only one link of type 1 or 2, then a default route
-// can safely be added to the next-hop router and SPF does not need
-// to be run
+// Used to test if a node is a stub, from an OSPF sense.
+// If there is only one link of type 1 or 2, then a default route
+// can safely be added to the next-hop router and SPF does not need
+// to be run
 //
 bool
 DijkstraAlgorithm::CheckForStubNode(Ipv4Address root)
 {
     NS_LOG_FUNCTION(this << root);
-    LSA* rlsa = m_lsdb->GetLSA(root);
+    LSA* rlsa = m_graph.GetLSA(root);
     Ipv4Address myRouterId = rlsa->GetLinkStateId();
     int transits = 0;
-    LinkRecord* transitLink = nullptr;
+    const LinkRecord* transitLink = nullptr;
     for (uint32_t i = 0; i < rlsa->GetNLinkRecords(); i++)
     {
-        LinkRecord* l = rlsa->GetLinkRecord(i);
+        const LinkRecord* l = rlsa->GetLinkRecord(i);
         if (l->GetLinkType() == LinkRecord::TransitNetwork)
         {
             transits++;
@@ -678,14 +974,14 @@ DijkstraAlgorithm::CheckForStubNode(Ipv4Address root)
             // Install default route to next hop
             // The link record LinkID is the router ID of the peer.
             // The Link Data is the local IP interface address
-            LSA* w_lsa = m_lsdb->GetLSA(transitLink->GetLinkId());
+            LSA* w_lsa = m_graph.GetLSA(transitLink->GetLinkId());
             uint32_t nLinkRecords = w_lsa->GetNLinkRecords();
             for (uint32_t j = 0; j < nLinkRecords; ++j)
             {
                 //
                 // We are only concerned about point-to-point links
                 //
-                LinkRecord* lr = w_lsa->GetLinkRecord(j);
+                const LinkRecord* lr = w_lsa->GetLinkRecord(j);
                 if (lr->GetLinkType() != LinkRecord::PointToPoint)
                 {
                     continue;
@@ -694,14 +990,13 @@ DijkstraAlgorithm::CheckForStubNode(Ipv4Address root)
                 if (lr->GetLinkId() == myRouterId)
                 {
                     // Next hop is stored in the LinkID field of lr
-                    Ptr<RomamRouter> router = rlsa->GetNode()->GetObject<RomamRouter>();
-                    NS_ASSERT(router);
-                    Ptr<RomamRouting> gr = router->GetRoutingProtocol();
-                    NS_ASSERT(gr);
-                    gr->AddNetworkRouteTo(Ipv4Address("0.0.0.0"),
-                                          Ipv4Mask("0.0.0.0"),
-                                          lr->GetLinkData(),
-                                          FindOutgoingInterfaceId(transitLink->GetLinkData()));
+                    uint32_t nodeId = m_directory->GetNodeIdByRouterId(myRouterId);
+                    NS_ASSERT(nodeId != RouterDirectory::NO_NODE);
+                    m_tree->GetRoutes(nodeId)
+                        .AddNetworkRouteTo(Ipv4Address("0.0.0.0"),
+                                           Ipv4Mask("0.0.0.0"),
+                                           lr->GetLinkData(),
+                                           FindOutgoingInterfaceId(transitLink->GetLinkData()));
                     NS_LOG_LOGIC("Inserting default route for node "
                                  << myRouterId << " to next hop " << lr->GetLinkData()
                                  << " via interface "
@@ -719,11 +1014,13 @@ void
 DijkstraAlgorithm::SPFCalculate(Ipv4Address root)
 {
     NS_LOG_FUNCTION(this << root);
+    PhaseProfiler::Scope scope(PhaseProfiler::SPF_CALCULATE);
     Vertex* v;
     //
-    // Initialize the Link State Database.
+    // Start with all the vertices unexplored.
     //
-    m_lsdb->Initialize();
+    ResetStatus();
+    SetRootAreas(root);
     //
     // The candidate queue is a priority queue of SPFVertex objects, with the top
     // of the queue being the closest vertex in terms of distance from the root
@@ -736,15 +1033,17 @@ DijkstraAlgorithm::SPFCalculate(Ipv4Address root)
     // calculation.  Each router (and corresponding network) is a vertex in the
     // shortest path first (SPF) tree.
     //
-    v = new Vertex(m_lsdb->GetLSA(root));
+    v = m_vertices.Allocate(m_graph.GetLSA(root));
     //
     // This vertex is the root of the SPF tree and it is distance 0 from the root.
     // We also mark this vertex as being in the SPF tree.
     //
     m_spfroot = v;
     v->SetDistanceFromRoot(0);
-    v->GetLSA()->SetStatus(LSA::LSA_SPF_IN_SPFTREE);
+    SetStatus(m_graph.GetVertex(v->GetVertexId()), LSA::LSA_SPF_IN_SPFTREE);
     NS_LOG_LOGIC("Starting SPFCalculate for node " << root);
+    m_tree->AddVertex(v);
+    m_tree->BeginSegment(root, RouteTreeRecord::TRANSIT);
 
     //
     // Optimize SPF calculation, for ns-3.
@@ -753,12 +1052,34 @@ DijkstraAlgorithm::SPFCalculate(Ipv4Address root)
     // reached.  Instead, short-circuit this computation and just install
     // a default route in the CheckForStubNode() method.
     //
-    if (NodeList::GetNNodes() > 0 && CheckForStubNode(root))
+    if (CheckForStubNode(root))
     {
         NS_LOG_LOGIC("SPFCalculate truncated for stub node " << root);
-        delete m_spfroot;
+        m_tree->SetTruncated();
+        m_vertices.Clear();
+        m_spfroot = nullptr;
         return;
     }
+    //
+    // The shared trees are not bound to the areas of a router.  A tree another
+    // engine searched is replayed; otherwise the tree searched here is recorded
+    // for them, by the index of every vertex in it.
+    //
+    bool share = m_sharedTrees && m_vertexAreas.empty();
+    const SharedTreeTable::Tree* shared = share ? m_sharedTrees->Find(root) : nullptr;
+    bool recording = share && !shared;
+    SharedTreeTable::Tree record;
+    std::unordered_map<uint32_t, uint32_t> index;
+    if (shared)
+    {
+        SPFReplaySharedTree(*shared);
+        v = nullptr;
+    }
+    else if (recording)
+    {
+        index[root.Get()] = 0;
+        record.vertices.push_back(SharedTreeTable::Tree::Entry{m_graph.GetVertex(root), 0, {}});
+    }
 
     for (;;)
     {
@@ -776,7 +1097,10 @@ DijkstraAlgorithm::SPFCalculate(Ipv4Address root)
         // shortest path).  If the new vertices represent shorter paths, we use them
         // and update the path cost.
         //
-        SPFNext(v, candidate);
+        if (v)
+        {
+            SPFNext(v, candidate);
+        }
         //
         // RFC2328 16.1. (3).
         //
@@ -804,7 +1128,7 @@ DijkstraAlgorithm::SPFCalculate(Ipv4Address root)
         // Update the status field of the vertex to indicate that it is in the SPF
         // tree.
         //
-        v->GetLSA()->SetStatus(LSA::LSA_SPF_IN_SPFTREE);
+        SetStatus(m_graph.GetVertex(v->GetVertexId()), LSA::LSA_SPF_IN_SPFTREE);
         //
         // The current vertex has a parent pointer.  By calling this rather oddly
         // named method (blame quagga) we add the current vertex to the list of
@@ -813,6 +1137,20 @@ DijkstraAlgorithm::SPFCalculate(Ipv4Address root)
         // to now.
         //
         SPFVertexAddParent(v);
+        m_tree->AddVertex(v);
+        m_tree->BeginSegment(v->GetVertexId(), RouteTreeRecord::TRANSIT);
+        if (recording)
+        {
+            index[v->GetVertexId().Get()] = record.vertices.size();
+            record.vertices.emplace_back();
+            SharedTreeTable::Tree::Entry& entry = record.vertices.back();
+            entry.vertex = m_graph.GetVertex(v->GetVertexId());
+            entry.distance = v->GetDistanceFromRoot();
+            for (uint32_t i = 0; v->GetParent(i); i++)
+            {
+                entry.parents.push_back(index.at(v->GetParent(i)->GetVertexId().Get()));
+            }
+        }
         //
         // Note that when there is a choice of vertices closest to the root, network
         // vertices must be chosen before router vertices in order to necessarily
@@ -860,51 +1198,80 @@ DijkstraAlgorithm::SPFCalculate(Ipv4Address root)
         // candidate vertices.
 
     } // end for loop
+    if (recording)
+    {
+        m_sharedTrees->Insert(root, std::move(record));
+    }
 
     // Second stage of SPF calculation procedure
-    SPFProcessStubs(m_spfroot);
-    for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs(); i++)
+    SPFProcessStubs();
+    if (!m_vertexAreas.empty())
     {
-        m_spfroot->ClearVertexProcessed();
-        LSA* extlsa = m_lsdb->GetExtLSA(i);
-        NS_LOG_LOGIC("Processing External LSA with id " << extlsa->GetLinkStateId());
-        ProcessASExternals(m_spfroot, extlsa);
+        SPFAddSummaries();
     }
 
     //
     // We're all done setting the routing information for the node at the root of
-    // the SPF tree.  Delete all of the vertices and corresponding resources.  Go
-    // possibly do it again for the next router.
+    // the SPF tree.  Release all of the vertices at once.  Go possibly do it
+    // again for the next router.
     //
-    delete m_spfroot;
+    m_vertices.Clear();
     m_spfroot = nullptr;
 }
 
 void
-DijkstraAlgorithm::ProcessASExternals(Vertex* v, LSA* extlsa)
+DijkstraAlgorithm::SPFReplaySharedTree(const SharedTreeTable::Tree& shared)
 {
-    NS_LOG_FUNCTION(this << v << extlsa);
-    NS_LOG_LOGIC("Processing external for destination "
-                 << extlsa->GetLinkStateId() << ", for router " << v->GetVertexId()
-                 << ", advertised by " << extlsa->GetAdvertisingRouter());
-    if (v->GetVertexType() == Vertex::VertexRouter)
+    NS_LOG_FUNCTION(this << m_spfroot->GetVertexId());
+    //
+    // The shared tree is the tree of the root: its vertices join in their
+    // order, and the next hop calculation of SPFNext () is repeated for every
+    // edge from a parent on a shortest path, merging the equal cost paths.
+    //
+    std::vector<Vertex*> vertices(shared.vertices.size(), nullptr);
+    vertices[0] = m_spfroot;
+    for (uint32_t i = 1; i < shared.vertices.size(); i++)
     {
-        LSA* rlsa = v->GetLSA();
-        NS_LOG_LOGIC("Processing router LSA with id " << rlsa->GetLinkStateId());
-        if ((rlsa->GetLinkStateId()) == (extlsa->GetAdvertisingRouter()))
+        const SharedTreeTable::Tree::Entry& entry = shared.vertices[i];
+        LSA* w_lsa = m_graph.GetLSA(entry.vertex);
+        Vertex* w = nullptr;
+        for (auto p = entry.parents.begin(); p != entry.parents.end(); p++)
+        {
+            Vertex* v = vertices[*p];
+            uint32_t index = shared.vertices[*p].vertex;
+            for (uint32_t e = m_graph.GetEdgesBegin(index); e < m_graph.GetEdgesEnd(index); e++)
+            {
+                if (m_graph.GetTarget(e) != entry.vertex ||
+                    v->GetDistanceFromRoot() + m_graph.GetMetric(e) != entry.distance)
+                {
+                    continue;
+                }
+                if (!w)
+                {
+                    w = m_vertices.Allocate(w_lsa);
+                    SPFNexthopCalculation(v, w, e, entry.distance);
+                    continue;
+                }
+                Vertex cw(w_lsa);
+                SPFNexthopCalculation(v, &cw, e, entry.distance);
+                w->MergeRootExitDirections(&cw);
+                w->MergeParent(&cw);
+            }
+        }
+        NS_ASSERT_MSG(w, "No parent edge to vertex " << w_lsa->GetLinkStateId());
+        SetStatus(entry.vertex, LSA::LSA_SPF_IN_SPFTREE);
+        SPFVertexAddParent(w);
+        m_tree->AddVertex(w);
+        m_tree->BeginSegment(w->GetVertexId(), RouteTreeRecord::TRANSIT);
+        if (w->GetVertexType() == Vertex::VertexRouter)
         {
-            NS_LOG_LOGIC("Found advertising router to destination");
-            SPFAddASExternal(extlsa, v);
+            SPFIntraAddRouter(w);
         }
-    }
-    for (uint32_t i = 0; i < v->GetNChildren(); i++)
-    {
-        if (!v->GetChild(i)->IsVertexProcessed())
+        else
         {
-            NS_LOG_LOGIC("Vertex's child " << i << " not yet processed, processing...");
-            ProcessASExternals(v->GetChild(i), extlsa);
-            v->GetChild(i)->SetVertexProcessed(true);
+            SPFIntraAddTransit(w);
         }
+        vertices[i] = w;
     }
 }
 
@@ -934,143 +1301,232 @@ DijkstraAlgorithm::SPFAddASExternal(LSA* extlsa, Vertex* v)
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Look up the node that has the router ID corresponding to the root vertex.
+    // This is the one we're going to write the routing information to.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(routerId);
+    if (nodeId != RouterDirectory::NO_NODE)
     {
-        Ptr<Node> node = *i;
+        NS_LOG_LOGIC("Setting routes for node " << nodeId);
         //
-        // The router ID is accessible through the RomamRouter interface, so we need
-        // to QI for that interface.  If there's no RomamRouter interface, the node
-        // in question cannot be the router we want, so we continue.
+        // Get the Romam Router Link State Advertisement from the vertex we're
+        // adding the routes to.  The LSA will have a number of attached Romam Router
+        // Link Records corresponding to links off of that vertex / node.  We're going
+        // to be interested in the records corresponding to point-to-point links.
         //
-        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
+        NS_ASSERT_MSG(v->GetLSA(),
+                      "DijkstraAlgorithm::SPFIntraAddRouter (): "
+                      "Expected valid LSA in SPFVertex* v");
+        Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
+        Ipv4Address tempip = extlsa->GetLinkStateId();
+        tempip = tempip.CombineMask(tempmask);
 
-        if (!rtr)
-        {
-            NS_LOG_LOGIC("No RomamRouter interface on node " << node->GetId());
-            continue;
-        }
         //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
+        // Here's why we did all of that work.  We're going to add a host route to the
+        // host address found in the m_linkData field of the point-to-point link
+        // record.  In the case of a point-to-point link, this is the local IP address
+        // of the node connected to the link.  Each of these point-to-point links
+        // will correspond to a local interface that has an IP address to which
+        // the node at the root of the SPF tree can send packets.  The vertex <v>
+        // (corresponding to the node that has these links and interfaces) has
+        // an m_nextHop address precalculated for us that is the address to which the
+        // root node should send packets to be forwarded to these IP addresses.
+        // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
+        // which the packets should be send for forwarding.
         //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        // walk through all next-hop-IPs and out-going-interfaces for reaching
+        // the stub network gateway 'v' from the root node
+        for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "DijkstraAlgorithm::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Romam Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Romam Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "DijkstraAlgorithm::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = extlsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
+            Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
+            Ipv4Address nextHop = exit.first;
+            int32_t outIf = exit.second;
+            if (outIf >= 0)
+            {
+                m_tree->GetRoutes(nodeId)
+                    .AddASExternalRouteTo(tempip, tempmask, nextHop, outIf);
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " add external network route to " << tempip
+                                       << " using next hop " << nextHop << " via interface "
+                                       << outIf);
+            }
+            else
+            {
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " NOT able to add network route to " << tempip
+                                       << " using next hop " << nextHop
+                                       << " since outgoing interface id is negative");
+            }
+        }
+        return;
+    }
+}
 
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-            Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
-            if (!router)
+void
+DijkstraAlgorithm::SPFAddSummaries()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT_MSG(m_spfroot, "DijkstraAlgorithm::SPFAddSummaries (): Root pointer not set");
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(m_spfroot->GetVertexId());
+    if (nodeId == RouterDirectory::NO_NODE)
+    {
+        return;
+    }
+    // an area border router only takes the summaries of the backbone
+    uint32_t area = m_rootBackbone ? AreaDirectory::BACKBONE : m_rootArea;
+    //
+    // Walk the tree for the border routers that advertise into the area, and
+    // keep for every prefix the lowest cost and the borders that reach it at
+    // that cost.  The prefixes the tree reaches by itself are left out.
+    //
+    // the borders a prefix is routed through
+    struct Choice
+    {
+        const AreaDirectory::Summary* summary; // the summary of the first border
+        uint32_t cost;                         // the cost through the borders
+        std::vector<Vertex*> borders;          // the borders
+    };
+    std::map<uint32_t, Choice> choices;
+    std::vector<Vertex*> stack(1, m_spfroot);
+    m_vertices.ClearProcessed();
+    m_spfroot->SetVertexProcessed(true);
+    while (!stack.empty())
+    {
+        Vertex* v = stack.back();
+        stack.pop_back();
+        v->ForEachChild([&stack](Vertex* child) {
+            if (!child->IsVertexProcessed())
+            {
+                child->SetVertexProcessed(true);
+                stack.push_back(child);
+            }
+        });
+        const std::vector<AreaDirectory::Summary>* summaries =
+            v != m_spfroot && v->GetVertexType() == Vertex::VertexRouter
+                ? m_areas->GetSummaries(v->GetVertexId(), area)
+                : nullptr;
+        for (uint32_t i = 0; summaries && i < summaries->size(); i++)
+        {
+            const AreaDirectory::Summary& summary = (*summaries)[i];
+            if (m_areas->IsVisible(summary.prefix, m_rootArea, m_rootBackbone))
             {
                 continue;
             }
-            Ptr<RomamRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+            uint32_t cost = v->GetDistanceFromRoot() + summary.cost;
+            auto j = choices.emplace(summary.prefix, Choice{&summary, cost, {}}).first;
+            if (cost < j->second.cost)
             {
-                Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddASExternalRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add external network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
+                j->second = Choice{&summary, cost, {}};
+            }
+            if (cost == j->second.cost)
+            {
+                j->second.borders.push_back(v);
+            }
+        }
+    }
+    for (auto i = choices.begin(); i != choices.end(); i++)
+    {
+        Ipv4Address network = i->second.summary->network;
+        Ipv4Mask mask = i->second.summary->mask;
+        // the borders reached through the same exit add one route
+        std::set<Vertex::NodeExit_t> exits;
+        for (Vertex* border : i->second.borders)
+        {
+            m_tree->BeginSegment(border->GetVertexId(), RouteTreeRecord::SUMMARY);
+            for (uint32_t j = 0; j < border->GetNRootExitDirections(); j++)
+            {
+                Vertex::NodeExit_t exit = border->GetRootExitDirection(j);
+                if (exit.second >= 0 && exits.insert(exit).second)
                 {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
+                    m_tree->GetRoutes(nodeId).AddNetworkRouteTo(network,
+                                                                mask,
+                                                                exit.first,
+                                                                exit.second);
+                    NS_LOG_LOGIC("Node " << nodeId << " add summary route to " << network
+                                         << " through " << border->GetVertexId()
+                                         << " using next hop " << exit.first
+                                         << " via interface " << exit.second);
                 }
             }
-            return;
-        } // if
-    } // for
+        }
+    }
 }
 
 // Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
 // stub link records will exist for point-to-point interfaces and for
 // broadcast interfaces for which no neighboring router can be found
 void
-DijkstraAlgorithm::SPFProcessStubs(Vertex* v)
+DijkstraAlgorithm::SPFProcessStubs()
 {
-    NS_LOG_FUNCTION(this << v);
-    NS_LOG_LOGIC("Processing stubs for " << v->GetVertexId());
-    if (v->GetVertexType() == Vertex::VertexRouter)
+    NS_LOG_FUNCTION(this);
+    //
+    // The stubs and the externals of the routers were extracted with m_graph,
+    // so the tree is walked once, in the order the recursive walks of the
+    // stubs and of every external LSA had, and the prefixes attached from the
+    // routers found.
+    //
+    m_treeRouters.clear();
+    m_routerVertices.resize(m_graph.GetNVertices(), nullptr);
+    SPFCollectRouters(m_spfroot);
+    for (uint32_t index : m_treeRouters)
     {
-        LSA* rlsa = v->GetLSA();
-        NS_LOG_LOGIC("Processing router LSA with id " << rlsa->GetLinkStateId());
-        for (uint32_t i = 0; i < rlsa->GetNLinkRecords(); i++)
+        Vertex* v = m_routerVertices[index];
+        m_tree->BeginSegment(v->GetVertexId(), RouteTreeRecord::STUB);
+        SPFIntraAddStubs(v, index);
+    }
+    for (uint32_t a = 0; a < m_graph.GetNAdvertisers(); a++)
+    {
+        Vertex* v = m_routerVertices[m_graph.GetAdvertiser(a)];
+        if (!v)
         {
-            NS_LOG_LOGIC("Examining link " << i << " of " << v->GetVertexId() << "'s "
-                                           << v->GetLSA()->GetNLinkRecords() << " link records");
-            LinkRecord* l = v->GetLSA()->GetLinkRecord(i);
-            if (l->GetLinkType() == LinkRecord::StubNetwork)
-            {
-                NS_LOG_LOGIC("Found a Stub record to " << l->GetLinkId());
-                SPFIntraAddStub(l, v);
-                continue;
-            }
+            continue; // not reached by the tree
+        }
+        m_tree->BeginSegment(v->GetVertexId(), RouteTreeRecord::EXTERNAL);
+        for (uint32_t x = m_graph.GetExternalsBegin(a); x < m_graph.GetExternalsEnd(a); x++)
+        {
+            NS_LOG_LOGIC("Processing External LSA with id "
+                         << m_graph.GetExternal(x)->GetLinkStateId());
+            SPFAddASExternal(m_graph.GetExternal(x), v);
         }
     }
-    for (uint32_t i = 0; i < v->GetNChildren(); i++)
+    for (uint32_t index : m_treeRouters)
+    {
+        m_routerVertices[index] = nullptr;
+    }
+}
+
+void
+DijkstraAlgorithm::SPFCollectRouters(Vertex* v)
+{
+    if (v->GetVertexType() == Vertex::VertexRouter)
     {
-        if (!v->GetChild(i)->IsVertexProcessed())
+        uint32_t index = m_graph.GetVertex(v->GetVertexId());
+        m_routerVertices[index] = v;
+        m_treeRouters.push_back(index);
+    }
+    v->ForEachChild([this](Vertex* child) {
+        if (!child->IsVertexProcessed())
         {
-            SPFProcessStubs(v->GetChild(i));
-            v->GetChild(i)->SetVertexProcessed(true);
+            SPFCollectRouters(child);
+            child->SetVertexProcessed(true);
         }
+    });
+}
+
+void
+DijkstraAlgorithm::SPFIntraAddStubs(Vertex* v, uint32_t index)
+{
+    NS_LOG_FUNCTION(this << v << index);
+    for (uint32_t s = m_graph.GetStubsBegin(index); s < m_graph.GetStubsEnd(index); s++)
+    {
+        NS_LOG_LOGIC("Found a Stub record to " << m_graph.GetStub(s)->GetLinkId());
+        SPFIntraAddStub(m_graph.GetStub(s), v);
     }
 }
 
 // RFC2328 16.1. second stage.
 void
-DijkstraAlgorithm::SPFIntraAddStub(LinkRecord* l, Vertex* v)
+DijkstraAlgorithm::SPFIntraAddStub(const LinkRecord* l, Vertex* v)
 {
     NS_LOG_FUNCTION(this << l << v);
 
@@ -1098,103 +1554,65 @@ DijkstraAlgorithm::SPFIntraAddStub(LinkRecord* l, Vertex* v)
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Look up the node that has the router ID corresponding to the root vertex.
+    // This is the one we're going to write the routing information to.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(routerId);
+    if (nodeId != RouterDirectory::NO_NODE)
     {
-        Ptr<Node> node = *i;
+        NS_LOG_LOGIC("Setting routes for node " << nodeId);
         //
-        // The router ID is accessible through the RomamRouter interface, so we need
-        // to QI for that interface.  If there's no RomamRouter interface, the node
-        // in question cannot be the router we want, so we continue.
+        // Get the Romam Router Link State Advertisement from the vertex we're
+        // adding the routes to.  The LSA will have a number of attached Romam Router
+        // Link Records corresponding to links off of that vertex / node.  We're going
+        // to be interested in the records corresponding to point-to-point links.
         //
-        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
-
-        if (!rtr)
-        {
-            NS_LOG_LOGIC("No RomamRouter interface on node " << node->GetId());
-            continue;
-        }
+        NS_ASSERT_MSG(v->GetLSA(),
+                      "DijkstraAlgorithm::SPFIntraAddRouter (): "
+                      "Expected valid LSA in Vertex* v");
+        Ipv4Mask tempmask(l->GetLinkData().Get());
+        Ipv4Address tempip = l->GetLinkId();
+        tempip = tempip.CombineMask(tempmask);
         //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
+        // Here's why we did all of that work.  We're going to add a host route to the
+        // host address found in the m_linkData field of the point-to-point link
+        // record.  In the case of a point-to-point link, this is the local IP address
+        // of the node connected to the link.  Each of these point-to-point links
+        // will correspond to a local interface that has an IP address to which
+        // the node at the root of the SPF tree can send packets.  The vertex <v>
+        // (corresponding to the node that has these links and interfaces) has
+        // an m_nextHop address precalculated for us that is the address to which the
+        // root node should send packets to be forwarded to these IP addresses.
+        // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
+        // which the packets should be send for forwarding.
         //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
 
-        if (rtr->GetRouterId() == routerId)
+        // walk through all next-hop-IPs and out-going-interfaces for reaching
+        // the stub network gateway 'v' from the root node
+        for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "DijkstraAlgorithm::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Romam Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Romam Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "DijkstraAlgorithm::SPFIntraAddRouter (): "
-                          "Expected valid LSA in Vertex* v");
-            Ipv4Mask tempmask(l->GetLinkData().Get());
-            Ipv4Address tempip = l->GetLinkId();
-            tempip = tempip.CombineMask(tempmask);
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-
-            Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
-            if (!router)
+            Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
+            Ipv4Address nextHop = exit.first;
+            int32_t outIf = exit.second;
+            if (outIf >= 0)
             {
-                continue;
+                m_tree->GetRoutes(nodeId)
+                    .AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " add network route to " << tempip
+                                       << " using next hop " << nextHop << " via interface "
+                                       << outIf);
             }
-            Ptr<RomamRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+            else
             {
-                Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
-                }
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " NOT able to add network route to " << tempip
+                                       << " using next hop " << nextHop
+                                       << " since outgoing interface id is negative");
             }
-            return;
-        } // if
-    } // for
+        }
+        return;
+    }
 }
 
 //
@@ -1211,59 +1629,33 @@ DijkstraAlgorithm::FindOutgoingInterfaceId(Ipv4Address a, Ipv4Mask amask)
     //
     // We have an IP address <a> and a vertex ID of the root of the SPF tree.
     // The question is what interface index does this address correspond to.
-    // The answer is a little complicated since we have to find a pointer to
-    // the node corresponding to the vertex ID, find the Ipv4 interface on that
-    // node in order to iterate the interfaces and find the one corresponding to
-    // the address in question.
+    // The router directory indexed the interface addresses of the node
+    // corresponding to the vertex ID when the LSDB was built, so we look for
+    // the interface corresponding to the address in question there.
     //
     Ipv4Address routerId = m_spfroot->GetVertexId();
     //
-    // Walk the list of nodes in the system looking for the one corresponding to
-    // the node at the root of the SPF tree.  This is the node for which we are
-    // building the routing table.
+    // Look up the node at the root of the SPF tree.  This is the node for which
+    // we are building the routing table.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(routerId);
+    if (nodeId != RouterDirectory::NO_NODE)
     {
-        Ptr<Node> node = *i;
-
-        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
         //
-        // If the node doesn't have a RomamRouter interface it can't be the one
-        // we're interested in.
+        // Look through the interfaces on this node for one that has the IP address
+        // we're looking for.  If we find one, return the corresponding interface
+        // index, or -1 if not found.
         //
-        if (!rtr)
-        {
-            continue;
-        }
-
-        if (rtr->GetRouterId() == routerId)
-        {
-            //
-            // This is the node we're building the routing table for.  We're going to need
-            // the Ipv4 interface to look for the ipv4 interface index.  Since this node
-            // is participating in routing IP version 4 packets, it certainly must have
-            // an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "DijkstraAlgorithm::FindOutgoingInterfaceId (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Look through the interfaces on this node for one that has the IP address
-            // we're looking for.  If we find one, return the corresponding interface
-            // index, or -1 if not found.
-            //
-            int32_t interface = ipv4->GetInterfaceForPrefix(a, amask);
+        int32_t interface = m_directory->GetInterfaceForPrefix(nodeId, a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("DijkstraAlgorithm::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif
-            return interface;
+      if (interface < 0)
+        {
+          NS_FATAL_ERROR ("DijkstraAlgorithm::FindOutgoingInterfaceId(): "
+                          "Expected an interface associated with address a:" << a);
         }
+#endif
+        return interface;
     }
     //
     // Couldn't find it.
@@ -1305,128 +1697,100 @@ DijkstraAlgorithm::SPFIntraAddRouter(Vertex* v)
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Look up the node that has the router ID corresponding to the root vertex.
+    // This is the one we're going to write the routing information to.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(routerId);
+    if (nodeId != RouterDirectory::NO_NODE)
     {
-        Ptr<Node> node = *i;
+        NS_LOG_LOGIC("Setting routes for node " << nodeId);
         //
-        // The router ID is accessible through the RomamRouter interface, so we need
-        // to GetObject for that interface.  If there's no RomamRouter interface,
-        // the node in question cannot be the router we want, so we continue.
+        // Get the Romam Router Link State Advertisement from the vertex we're
+        // adding the routes to.  The LSA will have a number of attached Romam Router
+        // Link Records corresponding to links off of that vertex / node.  We're going
+        // to be interested in the records corresponding to point-to-point links.
         //
-        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
-
-        if (!rtr)
+        LSA* lsa = v->GetLSA();
+        NS_ASSERT_MSG(lsa,
+                      "DijkstraAlgorithm::SPFIntraAddRouter (): "
+                      "Expected valid LSA in Vertex* v");
+        //
+        // A router with a loopback address is reached at it, by the route its
+        // stub record adds, and not at the addresses of its links.
+        //
+        uint32_t vNodeId = m_directory->GetNodeIdByRouterId(v->GetVertexId());
+        if (vNodeId != RouterDirectory::NO_NODE &&
+            m_directory->GetLoopback(vNodeId) != Ipv4Address::GetAny())
         {
-            NS_LOG_LOGIC("No RomamRouter interface on node " << node->GetId());
-            continue;
+            return;
         }
+
+        uint32_t nLinkRecords = lsa->GetNLinkRecords();
         //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
+        // Iterate through the link records on the vertex to which we're going to add
+        // routes.  To make sure we're being clear, we're going to add routing table
+        // entries to the tables on the node corresping to the root of the SPF tree.
+        // These entries will have routes to the IP addresses we find from looking at
+        // the local side of the point-to-point links found on the node described by
+        // the vertex <v>.
         //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        NS_LOG_LOGIC(" Node " << nodeId << " found " << nLinkRecords
+                              << " link records in LSA " << lsa << "with LinkStateId "
+                              << lsa->GetLinkStateId());
+        for (uint32_t j = 0; j < nLinkRecords; ++j)
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
             //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
+            // We are only concerned about point-to-point links
             //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "DijkstraAlgorithm::SPFIntraAddRouter (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Romam Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Romam Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            LSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "DijkstraAlgorithm::SPFIntraAddRouter (): "
-                          "Expected valid LSA in Vertex* v");
-
-            uint32_t nLinkRecords = lsa->GetNLinkRecords();
+            const LinkRecord* lr = lsa->GetLinkRecord(j);
+            if (lr->GetLinkType() != LinkRecord::PointToPoint)
+            {
+                continue;
+            }
             //
-            // Iterate through the link records on the vertex to which we're going to add
-            // routes.  To make sure we're being clear, we're going to add routing table
-            // entries to the tables on the node corresping to the root of the SPF tree.
-            // These entries will have routes to the IP addresses we find from looking at
-            // the local side of the point-to-point links found on the node described by
-            // the vertex <v>.
+            // Here's why we did all of that work.  We're going to add a host route to the
+            // host address found in the m_linkData field of the point-to-point link
+            // record.  In the case of a point-to-point link, this is the local IP address
+            // of the node connected to the link.  Each of these point-to-point links
+            // will correspond to a local interface that has an IP address to which
+            // the node at the root of the SPF tree can send packets.  The vertex <v>
+            // (corresponding to the node that has these links and interfaces) has
+            // an m_nextHop address precalculated for us that is the address to which the
+            // root node should send packets to be forwarded to these IP addresses.
+            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
+            // which the packets should be send for forwarding.
             //
-            NS_LOG_LOGIC(" Node " << node->GetId() << " found " << nLinkRecords
-                                  << " link records in LSA " << lsa << "with LinkStateId "
-                                  << lsa->GetLinkStateId());
-            for (uint32_t j = 0; j < nLinkRecords; ++j)
+            // walk through all available exit directions due to ECMP,
+            // and add host route for each of the exit direction toward
+            // the vertex 'v'
+            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
             {
-                //
-                // We are only concerned about point-to-point links
-                //
-                LinkRecord* lr = lsa->GetLinkRecord(j);
-                if (lr->GetLinkType() != LinkRecord::PointToPoint)
+                Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
+                Ipv4Address nextHop = exit.first;
+                int32_t outIf = exit.second;
+                if (outIf >= 0)
                 {
-                    continue;
+                    m_tree->GetRoutes(nodeId)
+                        .AddHostRouteTo(lr->GetLinkData(), nextHop, outIf);
+                    NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                           << " adding host route to " << lr->GetLinkData()
+                                           << " using next hop " << nextHop
+                                           << " and outgoing interface " << outIf);
                 }
-                //
-                // Here's why we did all of that work.  We're going to add a host route to the
-                // host address found in the m_linkData field of the point-to-point link
-                // record.  In the case of a point-to-point link, this is the local IP address
-                // of the node connected to the link.  Each of these point-to-point links
-                // will correspond to a local interface that has an IP address to which
-                // the node at the root of the SPF tree can send packets.  The vertex <v>
-                // (corresponding to the node that has these links and interfaces) has
-                // an m_nextHop address precalculated for us that is the address to which the
-                // root node should send packets to be forwarded to these IP addresses.
-                // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-                // which the packets should be send for forwarding.
-                //
-                Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
-                if (!router)
+                else
                 {
-                    continue;
+                    NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                           << " NOT able to add host route to "
+                                           << lr->GetLinkData() << " using next hop " << nextHop
+                                           << " since outgoing interface id is negative "
+                                           << outIf);
                 }
-                Ptr<RomamRouting> gr = router->GetRoutingProtocol();
-                NS_ASSERT(gr);
-                // walk through all available exit directions due to ECMP,
-                // and add host route for each of the exit direction toward
-                // the vertex 'v'
-                for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-                {
-                    Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                    Ipv4Address nextHop = exit.first;
-                    int32_t outIf = exit.second;
-                    if (outIf >= 0)
-                    {
-                        gr->AddHostRouteTo(lr->GetLinkData(), nextHop, outIf);
-                        NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                               << " adding host route to " << lr->GetLinkData()
-                                               << " using next hop " << nextHop
-                                               << " and outgoing interface " << outIf);
-                    }
-                    else
-                    {
-                        NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                               << " NOT able to add host route to "
-                                               << lr->GetLinkData() << " using next hop " << nextHop
-                                               << " since outgoing interface id is negative "
-                                               << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
-            }
-            //
-            // Done adding the routes for the selected node.
-            //
-            return;
+            } // for all routes from the root the vertex 'v'
         }
+        //
+        // Done adding the routes for the selected node.
+        //
+        return;
     }
 }
 
@@ -1447,88 +1811,50 @@ DijkstraAlgorithm::SPFIntraAddTransit(Vertex* v)
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Look up the node that has the router ID corresponding to the root vertex.
+    // This is the one we're going to write the routing information to.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(routerId);
+    if (nodeId != RouterDirectory::NO_NODE)
     {
-        Ptr<Node> node = *i;
+        NS_LOG_LOGIC("setting routes for node " << nodeId);
         //
-        // The router ID is accessible through the RomamRouter interface, so we need
-        // to GetObject for that interface.  If there's no RomamRouter interface,
-        // the node in question cannot be the router we want, so we continue.
+        // Get the Romam Router Link State Advertisement from the vertex we're
+        // adding the routes to.  The LSA will have a number of attached Romam Router
+        // Link Records corresponding to links off of that vertex / node.  We're going
+        // to be interested in the records corresponding to point-to-point links.
         //
-        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
-
-        if (!rtr)
+        LSA* lsa = v->GetLSA();
+        NS_ASSERT_MSG(lsa,
+                      "DijkstraAlgorithm::SPFIntraAddTransit (): "
+                      "Expected valid LSA in SPFVertex* v");
+        Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
+        Ipv4Address tempip = lsa->GetLinkStateId();
+        tempip = tempip.CombineMask(tempmask);
+        // walk through all available exit directions due to ECMP,
+        // and add host route for each of the exit direction toward
+        // the vertex 'v'
+        for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
         {
-            NS_LOG_LOGIC("No RomamRouter interface on node " << node->GetId());
-            continue;
-        }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
+            Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
+            Ipv4Address nextHop = exit.first;
+            int32_t outIf = exit.second;
 
-        if (rtr->GetRouterId() == routerId)
-        {
-            NS_LOG_LOGIC("setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "DijkstraAlgorithm::SPFIntraAddTransit (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Romam Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Romam Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            LSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "DijkstraAlgorithm::SPFIntraAddTransit (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = lsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
-            Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
-            if (!router)
+            if (outIf >= 0)
             {
-                continue;
+                m_tree->GetRoutes(nodeId)
+                    .AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " add network route to " << tempip
+                                       << " using next hop " << nextHop << " via interface "
+                                       << outIf);
             }
-            Ptr<RomamRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all available exit directions due to ECMP,
-            // and add host route for each of the exit direction toward
-            // the vertex 'v'
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+            else
             {
-                Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative " << outIf);
-                }
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " NOT able to add network route to " << tempip
+                                       << " using next hop " << nextHop
+                                       << " since outgoing interface id is negative " << outIf);
             }
         }
     }
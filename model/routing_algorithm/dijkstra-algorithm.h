@@ -3,8 +3,13 @@
 #ifndef DIJKSTRA_ALGORITHM_H
 #define DIJKSTRA_ALGORITHM_H
 
+#include "../datapath/area-directory.h"
+#include "../datapath/lsdb-graph.h"
+#include "../utility/router-directory.h"
 #include "route-candidate-queue.h"
+#include "route-tree-record.h"
 #include "routing-algorithm.h"
+#include "shared-tree-table.h"
 
 #include "ns3/ipv4-address.h"
 #include "ns3/object.h"
@@ -12,7 +17,9 @@
 
 #include <list>
 #include <map>
+#include <memory>
 #include <queue>
+#include <set>
 #include <stdint.h>
 #include <vector>
 
@@ -49,11 +56,192 @@ class DijkstraAlgorithm : public RoutingAlgorithm
      */
     void InitializeRoutes() override;
 
+    /**
+     * \brief Compute the routes of one router and install them on its node,
+     * leaving the tables of the other nodes as they are.
+     *
+     * This is the unit of the lazy route computation of RouteManager, on an
+     * engine that is not incremental.
+     *
+     * \param routerId the router ID of the router
+     */
+    void InitializeRoutes(Ipv4Address routerId);
+
+    /**
+     * \brief Compute the routes from an LSDB, which the engine does not own.
+     * \param lsdb the LSDB, which must outlive the computations
+     */
     void InsertLSDB(LSDB* lsdb);
 
+    /**
+     * \brief Use a directory built along with the LSDB to find the nodes.
+     *
+     * If none is inserted, InitializeRoutes () builds its own.
+     *
+     * \param directory the router directory, not owned
+     */
+    void InsertRouterDirectory(const RouterDirectory* directory);
+
+    /**
+     * \brief Use the areas built along with the LSDB to bound the trees.
+     *
+     * With areas, the tree of a router only spans its area, plus the
+     * backbone for an area border router, and the other areas are reached
+     * through the summaries of the border routers the tree reaches.
+     *
+     * \param areas the area directory, not owned, or null for a flat network
+     */
+    void InsertAreaDirectory(const AreaDirectory* areas);
+
+    /**
+     * \brief Keep the SPF trees between runs, so UpdateRoutes () only
+     * recomputes what a change touches.
+     * \param incremental true to keep them
+     */
+    void SetIncremental(bool incremental);
+
+    /**
+     * \brief Drop the SPF trees kept between runs, so the next UpdateRoutes ()
+     * computes all the trees again.
+     */
+    void ClearTrees();
+
+    /**
+     * \brief Compute the SPF trees of the different roots on worker threads
+     * in InitializeRoutes ().
+     *
+     * The workers share the LSDB, which they only read, and look nodes up in the
+     * router directory only; the routes are installed on the nodes by the
+     * calling thread once all the trees are computed.
+     *
+     * \param nThreads the number of worker threads, 1 to compute on the calling
+     * thread, 0 for one per hardware thread
+     */
+    void SetThreads(uint32_t nThreads);
+
+    /**
+     * \brief Share the shortest path trees with the engines using the same
+     * table.
+     *
+     * The tree of a router over the whole LSDB is the one the shared trees of
+     * SPFAlgorithm::SetSharedTrees () hold.  With a table, the tree of a
+     * router found in it is replayed, every vertex joining the tree in the
+     * same order with the same parents, and only the next hops and routes are
+     * computed; a tree not found is searched as usual and added.  The routes
+     * are the same as without the table.  The trees are not shared while the
+     * routers are in areas.
+     *
+     * \param trees the table, not owned, or null to not share the trees
+     */
+    void InsertSharedTrees(SharedTreeTable* trees);
+
+    /**
+     * \brief Update the routes after the LSAs of some vertices changed.
+     *
+     * Trees whose shortest paths may go through a changed link are computed
+     * again; in the others only the routes derived from the changed LSAs are
+     * regenerated.  Only the nodes whose table changed are reinstalled.
+     * Without trees kept by a previous run, all the routes are computed.
+     *
+     * \param changed the link state IDs of the changed LSAs
+     */
+    void UpdateRoutes(const std::set<uint32_t>& changed) override;
+
+    /**
+     * \brief Get the memory the engine keeps between runs: the graph, the vertex
+     * storage, the trees and tables of an incremental engine and the buffers
+     * of its worker engines.  The LSDB, which it does not own, is not counted.
+     * \return the number of bytes
+     */
+    std::size_t GetMemoryUsage() const;
+
   private:
-    Vertex* m_spfroot; //!< the root node
-    LSDB* m_lsdb;      //!< the Link State DataBase (LSDB)
+    /**
+     * \brief Compute the SPF tree of a root and the routes it gives.
+     * \param tree the record to fill, whose root is the router ID of the node
+     */
+    void ComputeTree(RouteTreeRecord& tree);
+
+    /**
+     * \brief Compute the trees of m_records on worker threads and the
+     * simulator thread, and install the table of every tree as it is done.
+     * \param nThreads the number of threads computing trees
+     */
+    void ComputeTreesInParallel(uint32_t nThreads);
+
+    /**
+     * \brief Regenerate the routes of the changed vertices of a tree whose
+     * shortest paths did not change.
+     * \param tree the tree
+     * \param changed the link state IDs of the changed LSAs
+     */
+    void PatchTree(RouteTreeRecord& tree, const std::set<uint32_t>& changed);
+
+    /**
+     * \brief Rebuild the graph of the LSDB if the LSDB changed since it was
+     * built, and drop the shared trees of another LSDB.
+     */
+    void UpdateGraph();
+
+    /**
+     * \brief Start an SPF run with all the vertices unexplored, in O(1).
+     *
+     * The SPF status of a vertex is kept by the engine, stamped with the run
+     * it was set in, so the LSDB is only read by the computations.
+     */
+    void ResetStatus();
+
+    /**
+     * \param v a vertex index in m_graph
+     * \return the SPF status of the vertex in the current run
+     */
+    LSA::SPFStatus GetStatus(uint32_t v) const;
+
+    /**
+     * \brief Set the SPF status of a vertex for the current run.
+     * \param v a vertex index in m_graph
+     * \param status the status
+     */
+    void SetStatus(uint32_t v, LSA::SPFStatus status);
+
+    /**
+     * \brief Grow the tree of m_spfroot from its shared tree, adding the
+     * routes of its vertices.
+     * \param shared the shared tree of m_spfroot
+     */
+    void SPFReplaySharedTree(const SharedTreeTable::Tree& shared);
+
+    /**
+     * \brief Bring the tables of the nodes to the routes of the kept trees,
+     * changing only the routes that differ.
+     * \param nodes the nodes to consider, or all of them if null
+     */
+    void InstallTables(const std::set<uint32_t>* nodes);
+
+    Vertex* m_spfroot;                      //!< the root node
+    LSDB* m_lsdb;                           //!< the Link State DataBase (LSDB)
+    LSDBGraph m_graph;                      //!< snapshot of the transit links of m_lsdb
+    std::vector<uint32_t> m_statusEpochs;   //!< run the status of a vertex was set in
+    std::vector<LSA::SPFStatus> m_status;   //!< SPF status by vertex, valid in its run
+    uint32_t m_epoch;                       //!< the current SPF run
+    VertexArena m_vertices;                 //!< storage of the vertices of a tree
+    const RouterDirectory* m_directory;     //!< router ID and address lookups
+    RouterDirectory m_localDirectory;       //!< fallback when no directory is inserted
+    const AreaDirectory* m_areas;           //!< the areas of the routers, if any
+    uint64_t m_areasVersion;                //!< version of m_areas the vertices were classified by
+    std::vector<uint32_t> m_vertexAreas;    //!< area by vertex, empty without areas
+    std::vector<uint8_t> m_vertexBackbone;  //!< whether every vertex is in the backbone
+    uint32_t m_rootArea;                    //!< area of the root of the SPF run
+    bool m_rootBackbone;                    //!< the root of the SPF run is in the backbone
+    bool m_incremental;                     //!< keep the trees between runs
+    uint32_t m_threads;                     //!< worker threads of InitializeRoutes ()
+    RouteTreeRecord* m_tree;                //!< tree the routes being computed go to
+    std::vector<RouteTreeRecord> m_records; //!< trees of the last run
+    SharedTreeTable* m_sharedTrees;         //!< the trees shared with other engines, if any
+    std::vector<uint32_t> m_treeRouters;    //!< graph indices of the routers of the tree
+    std::vector<Vertex*> m_routerVertices;  //!< tree vertex by graph index, or null
+    /// worker engines of InitializeRoutes (), kept for their buffers
+    std::vector<std::unique_ptr<DijkstraAlgorithm>> m_workers;
 
     /**
      * \brief Test if a node is a stub, from an OSPF sense.
@@ -76,23 +264,31 @@ class DijkstraAlgorithm : public RoutingAlgorithm
     void SPFCalculate(Ipv4Address root);
 
     /**
-     * \brief Process Stub nodes
+     * \brief Process Stub nodes and Autonomous Systems (AS) External LSAs
      *
      * Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
      * stub link records will exist for point-to-point interfaces and for
-     * broadcast interfaces for which no neighboring router can be found
+     * broadcast interfaces for which no neighboring router can be found.  The
+     * stubs and the external LSAs of every router come from m_graph, and the
+     * tree of m_spfroot is walked once to attach them.
+     */
+    void SPFProcessStubs();
+
+    /**
+     * \brief Collect the routers of the subtree of a vertex into
+     * m_treeRouters and m_routerVertices, the vertices before their children.
      *
      * \param v vertex to be processed
      */
-    void SPFProcessStubs(Vertex* v);
+    void SPFCollectRouters(Vertex* v);
 
     /**
-     * \brief Process Autonomous Systems (AS) External LSA
+     * \brief Add the routes to the stub networks of a vertex
      *
-     * \param v vertex to be processed
-     * \param extlsa external LSA
+     * \param v the vertex
+     * \param index the index of the vertex in m_graph
      */
-    void ProcessASExternals(Vertex* v, LSA* extlsa);
+    void SPFIntraAddStubs(Vertex* v, uint32_t index);
 
     /**
      * \brief Examine the links in v's LSA and update the list of candidates with any
@@ -126,11 +322,11 @@ class DijkstraAlgorithm : public RoutingAlgorithm
      *
      * \param v the parent
      * \param w the destination
-     * \param l the link record
+     * \param e the index of the edge from v to w in m_graph
      * \param distance the target distance
      * \returns 1 on success
      */
-    int SPFNexthopCalculation(Vertex* v, Vertex* w, LinkRecord* l, uint32_t distance);
+    int SPFNexthopCalculation(Vertex* v, Vertex* w, uint32_t e, uint32_t distance);
 
     /**
      * \brief Adds a vertex to the list of children *in* each of its parents
@@ -148,27 +344,6 @@ class DijkstraAlgorithm : public RoutingAlgorithm
      */
     void SPFVertexAddParent(Vertex* v);
 
-    /**
-     * \brief Search for a link between two vertices.
-     *
-     * This method is derived from quagga ospf_get_next_link ()
-     *
-     * First search the Global Router Link Records of vertex \a v for one
-     * representing a point-to point link to vertex \a w.
-     *
-     * What is done depends on prev_link.  Contrary to appearances, prev_link just
-     * acts as a flag here.  If prev_link is NULL, we return the first Global
-     * Router Link Record we find that describes a point-to-point link from \a v
-     * to \a w.  If prev_link is not NULL, we return a Global Router Link Record
-     * representing a possible *second* link from \a v to \a w.
-     *
-     * \param v first vertex
-     * \param w second vertex
-     * \param prev_link the previous link in the list
-     * \returns the link's record
-     */
-    LinkRecord* SPFGetNextLink(Vertex* v, Vertex* w, LinkRecord* prev_link);
-
     /**
      * \brief Add a host route to the routing tables
      *
@@ -206,7 +381,7 @@ class DijkstraAlgorithm : public RoutingAlgorithm
      * \param l the global routing link record
      * \param v the vertex
      */
-    void SPFIntraAddStub(LinkRecord* l, Vertex* v);
+    void SPFIntraAddStub(const LinkRecord* l, Vertex* v);
 
     /**
      * \brief Add an external route to the routing tables
@@ -216,6 +391,25 @@ class DijkstraAlgorithm : public RoutingAlgorithm
      */
     void SPFAddASExternal(LSA* extlsa, Vertex* v);
 
+    /**
+     * \brief Add the routes to the prefixes out of the areas of the root,
+     * through the area border routers of the tree, at the lowest cost of
+     * their summaries.
+     */
+    void SPFAddSummaries();
+
+    /**
+     * \brief Give the root of the next SPF run its areas.
+     * \param root the router ID of the router the tree is computed for
+     */
+    void SetRootAreas(Ipv4Address root);
+
+    /**
+     * \param v a vertex index in m_graph
+     * \return true if the trees of the root may span the vertex
+     */
+    bool IsInRootAreas(uint32_t v) const;
+
     /**
      * \brief Return the interface number corresponding to a given IP address and mask
      *
@@ -3,6 +3,8 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#define MAX_UINT32 0xffffffff
+
 namespace ns3
 {
 
@@ -19,36 +21,29 @@ DijkstraRIE::~DijkstraRIE()
 }
 
 DijkstraRIE::DijkstraRIE(const DijkstraRIE& route)
-    : m_dest(route.m_dest),
-      m_destNetworkMask(route.m_destNetworkMask),
-      m_gateway(route.m_gateway),
-      m_interface(route.m_interface)
+    : RouteInfoEntry(route)
 {
     NS_LOG_FUNCTION(this << route);
 }
 
 DijkstraRIE::DijkstraRIE(const DijkstraRIE* route)
-    : m_dest(route->m_dest),
-      m_destNetworkMask(route->m_destNetworkMask),
-      m_gateway(route->m_gateway),
-      m_interface(route->m_interface)
+    : RouteInfoEntry(*route)
 {
     NS_LOG_FUNCTION(this << route);
 }
 
 DijkstraRIE::DijkstraRIE(Ipv4Address dest, Ipv4Address gateway, uint32_t interface)
-    : m_dest(dest),
-      m_destNetworkMask(Ipv4Mask::GetOnes()),
-      m_gateway(gateway),
-      m_interface(interface)
+    : RouteInfoEntry(dest, Ipv4Mask::GetOnes(), gateway, interface, MAX_UINT32, MAX_UINT32)
 {
 }
 
 DijkstraRIE::DijkstraRIE(Ipv4Address dest, uint32_t interface)
-    : m_dest(dest),
-      m_destNetworkMask(Ipv4Mask::GetOnes()),
-      m_gateway(Ipv4Address::GetZero()),
-      m_interface(interface)
+    : RouteInfoEntry(dest,
+                     Ipv4Mask::GetOnes(),
+                     Ipv4Address::GetZero(),
+                     interface,
+                     MAX_UINT32,
+                     MAX_UINT32)
 {
 }
 
@@ -56,86 +51,22 @@ DijkstraRIE::DijkstraRIE(Ipv4Address network,
                          Ipv4Mask networkMask,
                          Ipv4Address gateway,
                          uint32_t interface)
-    : m_dest(network),
-      m_destNetworkMask(networkMask),
-      m_gateway(gateway),
-      m_interface(interface)
+    : RouteInfoEntry(network, networkMask, gateway, interface, MAX_UINT32, MAX_UINT32)
 {
     NS_LOG_FUNCTION(this << network << networkMask << gateway << interface);
 }
 
 DijkstraRIE::DijkstraRIE(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface)
-    : m_dest(network),
-      m_destNetworkMask(networkMask),
-      m_gateway(Ipv4Address::GetZero()),
-      m_interface(interface)
+    : RouteInfoEntry(network,
+                     networkMask,
+                     Ipv4Address::GetZero(),
+                     interface,
+                     MAX_UINT32,
+                     MAX_UINT32)
 {
     NS_LOG_FUNCTION(this << network << networkMask << interface);
 }
 
-bool
-DijkstraRIE::IsHost() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_destNetworkMask == Ipv4Mask::GetOnes();
-}
-
-Ipv4Address
-DijkstraRIE::GetDest() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_dest;
-}
-
-bool
-DijkstraRIE::IsNetwork() const
-{
-    NS_LOG_FUNCTION(this);
-    return !IsHost();
-}
-
-bool
-DijkstraRIE::IsDefault() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_dest == Ipv4Address::GetZero();
-}
-
-Ipv4Address
-DijkstraRIE::GetDestNetwork() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_dest;
-}
-
-Ipv4Mask
-DijkstraRIE::GetDestNetworkMask() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_destNetworkMask;
-}
-
-bool
-DijkstraRIE::IsGateway() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_gateway != Ipv4Address::GetZero();
-}
-
-Ipv4Address
-DijkstraRIE::GetGateway() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_gateway;
-}
-
-uint32_t
-DijkstraRIE::GetInterface() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_interface;
-}
-
 DijkstraRIE
 DijkstraRIE::CreateHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
 {
@@ -30,7 +30,7 @@ class DijkstraRIE : public RouteInfoEntry
     /**
      * \brief destructor.
      */
-    ~DijkstraRIE() override;
+    ~DijkstraRIE();
 
     /**
      * \brief Copy Constructor
@@ -44,17 +44,6 @@ class DijkstraRIE : public RouteInfoEntry
      */
     DijkstraRIE(const DijkstraRIE* route);
 
-    // These methods inherited from base class
-    bool IsHost() const override;
-    bool IsNetwork() const override;
-    bool IsDefault() const override;
-    bool IsGateway() const override;
-    Ipv4Address GetGateway() const override;
-    Ipv4Address GetDest() const override;
-    Ipv4Address GetDestNetwork() const override;
-    Ipv4Mask GetDestNetworkMask() const override;
-    uint32_t GetInterface() const override;
-
     /**
      * \return An DijkstraRIE object corresponding to the input parameters.
      * \param dest Ipv4Address of the destination
@@ -130,11 +119,6 @@ class DijkstraRIE : public RouteInfoEntry
      * \param interface the interface index
      */
     DijkstraRIE(Ipv4Address dest, uint32_t interface);
-
-    Ipv4Address m_dest;         //!< destination address
-    Ipv4Mask m_destNetworkMask; //!< destination network mask
-    Ipv4Address m_gateway;      //!< gateway
-    uint32_t m_interface;       //!< output interface
 };
 
 /**
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "distance-matrix.h"
+
+#include "../datapath/lsdb-graph.h"
+#include "../datapath/lsdb.h"
+#include "../utility/memory-footprint.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DistanceMatrix");
+
+DistanceMatrix::DistanceMatrix()
+    : m_version(0),
+      m_lsdb(nullptr),
+      m_stride(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+DistanceMatrix::Build(const LSDB* lsdb)
+{
+    NS_LOG_FUNCTION(this << lsdb);
+    LSDBGraph graph;
+    graph.Build(lsdb);
+    m_lsdb = lsdb;
+    m_version = lsdb->GetVersion();
+
+    m_routerIds.clear();
+    m_index.clear();
+    std::vector<uint32_t> routers(graph.GetNVertices(), NO_ROUTER);
+    for (uint32_t v = 0; v < graph.GetNVertices(); v++)
+    {
+        LSA* lsa = graph.GetLSA(v);
+        if (lsa->GetLSType() == LSA::RouterLSA)
+        {
+            routers[v] = m_routerIds.size();
+            m_index[lsa->GetLinkStateId().Get()] = m_routerIds.size();
+            m_routerIds.push_back(lsa->GetLinkStateId());
+        }
+    }
+    uint32_t n = m_routerIds.size();
+    uint32_t nBlocks = (n + BLOCK - 1) / BLOCK;
+    m_stride = nBlocks * BLOCK;
+    m_distances.assign(static_cast<std::size_t>(m_stride) * m_stride, INFINITE_DISTANCE);
+
+    for (uint32_t v = 0; v < graph.GetNVertices(); v++)
+    {
+        uint32_t r = routers[v];
+        if (r == NO_ROUTER)
+        {
+            continue;
+        }
+        uint32_t* row = &m_distances[static_cast<std::size_t>(r) * m_stride];
+        row[r] = 0;
+        for (uint32_t e = graph.GetEdgesBegin(v); e < graph.GetEdgesEnd(v); e++)
+        {
+            uint32_t w = graph.GetTarget(e);
+            uint32_t metric = std::min(graph.GetMetric(e), INFINITE_DISTANCE);
+            if (routers[w] != NO_ROUTER)
+            {
+                row[routers[w]] = std::min(row[routers[w]], metric);
+                continue;
+            }
+            // through a transit network, whose edges to its routers cost nothing
+            for (uint32_t f = graph.GetEdgesBegin(w); f < graph.GetEdgesEnd(w); f++)
+            {
+                uint32_t s = routers[graph.GetTarget(f)];
+                if (s != NO_ROUTER && s != r)
+                {
+                    row[s] = std::min(row[s], metric);
+                }
+            }
+        }
+    }
+
+    //
+    // Blocked Floyd-Warshall: for each tile of intermediate routers, relax the
+    // tile on the diagonal first, then the tiles of its row and column, which
+    // only depend on it, and last all the others, which depend on those.
+    //
+    for (uint32_t kb = 0; kb < nBlocks; kb++)
+    {
+        Relax(kb, kb, kb);
+        for (uint32_t b = 0; b < nBlocks; b++)
+        {
+            if (b != kb)
+            {
+                Relax(kb, kb, b);
+                Relax(kb, b, kb);
+            }
+        }
+        for (uint32_t ib = 0; ib < nBlocks; ib++)
+        {
+            if (ib == kb)
+            {
+                continue;
+            }
+            for (uint32_t jb = 0; jb < nBlocks; jb++)
+            {
+                if (jb != kb)
+                {
+                    Relax(kb, ib, jb);
+                }
+            }
+        }
+    }
+    NS_LOG_LOGIC("Computed the distances between " << n << " routers in " << GetMemoryUsage()
+                                                   << " bytes");
+}
+
+void
+DistanceMatrix::Relax(uint32_t kb, uint32_t ib, uint32_t jb)
+{
+    uint32_t* distances = m_distances.data();
+    for (uint32_t k = kb * BLOCK; k < (kb + 1) * BLOCK; k++)
+    {
+        const uint32_t* rowK = distances + static_cast<std::size_t>(k) * m_stride + jb * BLOCK;
+        for (uint32_t i = ib * BLOCK; i < (ib + 1) * BLOCK; i++)
+        {
+            uint32_t* rowI = distances + static_cast<std::size_t>(i) * m_stride;
+            uint32_t dik = rowI[k];
+            if (dik == INFINITE_DISTANCE)
+            {
+                continue;
+            }
+            rowI += jb * BLOCK;
+            // both terms are at most INFINITE_DISTANCE, so the sum cannot wrap
+            for (uint32_t j = 0; j < BLOCK; j++)
+            {
+                rowI[j] = std::min(rowI[j], dik + rowK[j]);
+            }
+        }
+    }
+}
+
+bool
+DistanceMatrix::IsCurrent(const LSDB* lsdb) const
+{
+    return lsdb == m_lsdb && lsdb->GetVersion() == m_version;
+}
+
+uint32_t
+DistanceMatrix::GetNRouters() const
+{
+    return m_routerIds.size();
+}
+
+uint32_t
+DistanceMatrix::GetRouter(Ipv4Address routerId) const
+{
+    auto i = m_index.find(routerId.Get());
+    return i == m_index.end() ? NO_ROUTER : i->second;
+}
+
+Ipv4Address
+DistanceMatrix::GetRouterId(uint32_t r) const
+{
+    NS_ASSERT(r < m_routerIds.size());
+    return m_routerIds[r];
+}
+
+uint32_t
+DistanceMatrix::GetDistance(uint32_t from, uint32_t to) const
+{
+    NS_ASSERT(from < m_routerIds.size() && to < m_routerIds.size());
+    return m_distances[static_cast<std::size_t>(from) * m_stride + to];
+}
+
+uint32_t
+DistanceMatrix::GetDistance(Ipv4Address from, Ipv4Address to) const
+{
+    uint32_t r = GetRouter(from);
+    uint32_t s = GetRouter(to);
+    if (r == NO_ROUTER || s == NO_ROUTER)
+    {
+        return INFINITE_DISTANCE;
+    }
+    return GetDistance(r, s);
+}
+
+std::size_t
+DistanceMatrix::GetMemoryUsage() const
+{
+    return m_distances.capacity() * sizeof(uint32_t) +
+           m_routerIds.capacity() * sizeof(Ipv4Address) + GetHashMapFootprint(m_index);
+}
+
+} // namespace ns3
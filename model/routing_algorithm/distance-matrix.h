@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include "ns3/ipv4-address.h"
+
+#include <cstddef>
+#include <limits>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class LSDB;
+
+/**
+ * \brief Dense matrix of the shortest distances between all the routers of an
+ * LSDB.
+ *
+ * The distances are the sums of the link metrics, as in the DistTag of a
+ * packet.  They are computed with a cache-blocked Floyd-Warshall: the matrix
+ * is split in BLOCK x BLOCK tiles, and the min-plus relaxation of a tile runs
+ * along contiguous rows, which the compiler turns into vector instructions.
+ * A transit network is folded into the links between the routers attached to
+ * it, so that the matrix only has a row per router.
+ *
+ * The matrix takes 4 n^2 bytes and O(n^3) time for n routers, which is meant
+ * for topologies of up to a few thousand routers.
+ */
+class DistanceMatrix
+{
+  public:
+    /// distance between two routers that cannot reach each other
+    static constexpr uint32_t INFINITE_DISTANCE = std::numeric_limits<uint32_t>::max() / 2;
+    /// router index returned for an unknown router ID
+    static constexpr uint32_t NO_ROUTER = std::numeric_limits<uint32_t>::max();
+
+    DistanceMatrix();
+
+    /**
+     * \brief Compute the distances between the routers of an LSDB, replacing
+     * the current content.
+     * \param lsdb the database
+     */
+    void Build(const LSDB* lsdb);
+
+    /**
+     * \param lsdb a database
+     * \return true if the matrix was built from the current content of lsdb
+     */
+    bool IsCurrent(const LSDB* lsdb) const;
+
+    /**
+     * \return the number of routers
+     */
+    uint32_t GetNRouters() const;
+
+    /**
+     * \param routerId a router ID
+     * \return the index of the router, or NO_ROUTER if none
+     */
+    uint32_t GetRouter(Ipv4Address routerId) const;
+
+    /**
+     * \param r a router index
+     * \return the router ID of the router
+     */
+    Ipv4Address GetRouterId(uint32_t r) const;
+
+    /**
+     * \param from the index of the source router
+     * \param to the index of the destination router
+     * \return the distance, or INFINITE_DISTANCE if to cannot be reached
+     */
+    uint32_t GetDistance(uint32_t from, uint32_t to) const;
+
+    /**
+     * \param from the router ID of the source
+     * \param to the router ID of the destination
+     * \return the distance, or INFINITE_DISTANCE if to cannot be reached or
+     * either router is unknown
+     */
+    uint32_t GetDistance(Ipv4Address from, Ipv4Address to) const;
+
+    /**
+     * \return the number of bytes the matrix and the router index take
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    /// side of the tiles, in routers
+    static constexpr uint32_t BLOCK = 64;
+
+    /**
+     * \brief Relax the distances of a tile through the routers of another.
+     *
+     * D[i][j] = min (D[i][j], D[i][k] + D[k][j]) for the i of the row of tiles
+     * ib, the j of the column jb and the k of the tile kb, k varying slowest.
+     *
+     * \param kb the tile of the intermediate routers
+     * \param ib the row of tiles of the sources
+     * \param jb the column of tiles of the destinations
+     */
+    void Relax(uint32_t kb, uint32_t ib, uint32_t jb);
+
+    uint64_t m_version;                             //!< version of the LSDB built from
+    const LSDB* m_lsdb;                             //!< the LSDB built from
+    uint32_t m_stride;                              //!< row length, a multiple of BLOCK
+    std::vector<uint32_t> m_distances;              //!< distances, row by source router
+    std::vector<Ipv4Address> m_routerIds;           //!< router ID by router index
+    std::unordered_map<uint32_t, uint32_t> m_index; //!< router index by router ID
+};
+
+} // namespace ns3
+
+#endif /* DISTANCE_MATRIX_H */
@@ -0,0 +1,477 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "kshortest-path-algorithm.h"
+
+#include "../datapath/lsdb.h"
+#include "../ddr-routing.h"
+#include "../utility/romam-router.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <utility>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("KShortestPathAlgorithm");
+
+bool
+KShortestPathAlgorithm::Path::operator<(const Path& other) const
+{
+    if (distance != other.distance)
+    {
+        return distance < other.distance;
+    }
+    if (edges.size() != other.edges.size())
+    {
+        return edges.size() < other.edges.size();
+    }
+    return edges < other.edges;
+}
+
+KShortestPathAlgorithm::KShortestPathAlgorithm()
+    : m_lsdb(nullptr),
+      m_directory(nullptr),
+      m_k(1),
+      m_memoryBound(0),
+      m_searchEpoch(0),
+      m_banEpoch(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+KShortestPathAlgorithm::~KShortestPathAlgorithm()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+KShortestPathAlgorithm::DeleteRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouter> router = (*i)->GetObject<RomamRouter>();
+        if (!router)
+        {
+            continue;
+        }
+        Ptr<DDRRouting> ddr = DynamicCast<DDRRouting>(router->GetRoutingProtocol());
+        if (ddr)
+        {
+            ddr->GetKShortestPathTable().Clear();
+        }
+    }
+}
+
+void
+KShortestPathAlgorithm::InitializeRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_lsdb)
+    {
+        NS_LOG_LOGIC("Empty LSDB, please insert LSDB.");
+        return;
+    }
+    if (!m_directory)
+    {
+        m_localDirectory.Build();
+        m_directory = &m_localDirectory;
+    }
+    UpdateGraph();
+    uint32_t systemId = Simulator::GetSystemId();
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouter> router = (*i)->GetObject<RomamRouter>();
+        // Ignore nodes that are not assigned to our systemId (distributed sim)
+        if (!router || (*i)->GetSystemId() != systemId)
+        {
+            continue;
+        }
+        Ptr<DDRRouting> ddr = DynamicCast<DDRRouting>(router->GetRoutingProtocol());
+        if (!ddr)
+        {
+            continue;
+        }
+        KShortestPathTable& table = ddr->GetKShortestPathTable();
+        table.Clear();
+        uint32_t source = m_graph.GetVertex(router->GetRouterId());
+        if (source == LSDBGraph::NO_VERTEX)
+        {
+            NS_LOG_LOGIC("No LSA for router " << router->GetRouterId());
+            continue;
+        }
+        // the destinations of a node with hot destinations start with their best path
+        FillTable(source, table, ddr->GetKShortestHotDestinations() > 0);
+        NS_LOG_LOGIC("Node " << (*i)->GetId() << " keeps the paths to "
+                             << table.GetNDestinations() << " routers in "
+                             << table.GetMemoryUsage() << " bytes");
+    }
+    NS_LOG_INFO("Finished k shortest paths calculation");
+}
+
+void
+KShortestPathAlgorithm::InsertLSDB(LSDB* lsdb)
+{
+    m_lsdb = lsdb;
+}
+
+void
+KShortestPathAlgorithm::InsertRouterDirectory(const RouterDirectory* directory)
+{
+    m_directory = directory;
+}
+
+void
+KShortestPathAlgorithm::SetK(uint32_t k)
+{
+    NS_LOG_FUNCTION(this << k);
+    m_k = k;
+}
+
+void
+KShortestPathAlgorithm::SetMemoryBound(uint32_t bytes)
+{
+    NS_LOG_FUNCTION(this << bytes);
+    m_memoryBound = bytes;
+}
+
+void
+KShortestPathAlgorithm::ComputePaths(Ipv4Address source,
+                                     Ipv4Address destination,
+                                     std::vector<Path>& paths)
+{
+    NS_LOG_FUNCTION(this << source << destination);
+    UpdateGraph();
+    paths.clear();
+    uint32_t s = m_graph.GetVertex(source);
+    uint32_t t = m_graph.GetVertex(destination);
+    if (s == LSDBGraph::NO_VERTEX || t == LSDBGraph::NO_VERTEX)
+    {
+        return;
+    }
+    ComputeVertexPaths(s, t, m_k, paths);
+}
+
+std::size_t
+KShortestPathAlgorithm::GetMemoryUsage() const
+{
+    return m_graph.GetMemoryUsage() +
+           (m_sources.capacity() + m_distances.capacity() + m_previous.capacity() +
+            m_reached.capacity() + m_vertexBans.capacity() + m_edgeBans.capacity()) *
+               sizeof(uint32_t) +
+           m_heap.capacity() * sizeof(m_heap[0]);
+}
+
+void
+KShortestPathAlgorithm::UpdateGraph()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_graph.IsCurrent(m_lsdb))
+    {
+        return;
+    }
+    m_graph.Build(m_lsdb);
+    uint32_t nVertices = m_graph.GetNVertices();
+    uint32_t nEdges = nVertices ? m_graph.GetEdgesEnd(nVertices - 1) : 0;
+    m_sources.resize(nEdges);
+    for (uint32_t v = 0; v < nVertices; v++)
+    {
+        for (uint32_t e = m_graph.GetEdgesBegin(v); e < m_graph.GetEdgesEnd(v); e++)
+        {
+            m_sources[e] = v;
+        }
+    }
+    m_distances.assign(nVertices, 0);
+    m_previous.assign(nVertices, LSDBGraph::NO_EDGE);
+    m_reached.assign(nVertices, 0);
+    m_vertexBans.assign(nVertices, 0);
+    m_edgeBans.assign(nEdges, 0);
+    m_searchEpoch = 0;
+    m_banEpoch = 0;
+}
+
+void
+KShortestPathAlgorithm::ComputeVertexPaths(uint32_t source,
+                                           uint32_t target,
+                                           uint32_t k,
+                                           std::vector<Path>& paths)
+{
+    NS_LOG_FUNCTION(this << source << target << k);
+    paths.clear();
+    if (k == 0 || source == target)
+    {
+        return;
+    }
+    ClearBans();
+    Path first;
+    first.deviation = 0;
+    if (!ShortestPath(source, target, first.edges, first.distance))
+    {
+        return;
+    }
+    paths.push_back(std::move(first));
+
+    std::set<Path> candidates;
+    std::vector<uint32_t> vertices;
+    std::vector<uint32_t> spur;
+    while (paths.size() < k)
+    {
+        // copied, as the paths grow below
+        const Path last = paths.back();
+        vertices.assign(1, source);
+        for (auto e = last.edges.begin(); e != last.edges.end(); e++)
+        {
+            vertices.push_back(m_graph.GetTarget(*e));
+        }
+        uint32_t rootDistance = 0;
+        for (uint32_t i = 0; i < last.deviation; i++)
+        {
+            rootDistance += m_graph.GetMetric(last.edges[i]);
+        }
+        //
+        // Lawler: the spur vertices before the deviation of the last path were
+        // tried from the path it derives from already.
+        //
+        for (uint32_t i = last.deviation; i < last.edges.size(); i++)
+        {
+            ClearBans();
+            // the spur path must not go back through the root path
+            for (uint32_t j = 0; j < i; j++)
+            {
+                m_vertexBans[vertices[j]] = m_banEpoch;
+            }
+            // nor take the next edge of a path found with the same root path
+            for (auto p = paths.begin(); p != paths.end(); p++)
+            {
+                if (p->edges.size() > i &&
+                    std::equal(last.edges.begin(), last.edges.begin() + i, p->edges.begin()))
+                {
+                    m_edgeBans[p->edges[i]] = m_banEpoch;
+                }
+            }
+            uint32_t spurDistance = 0;
+            if (ShortestPath(vertices[i], target, spur, spurDistance))
+            {
+                Path candidate;
+                candidate.edges.reserve(i + spur.size());
+                candidate.edges.assign(last.edges.begin(), last.edges.begin() + i);
+                candidate.edges.insert(candidate.edges.end(), spur.begin(), spur.end());
+                candidate.distance = rootDistance + spurDistance;
+                candidate.deviation = i;
+                auto same = candidates.find(candidate);
+                if (same == candidates.end() || same->deviation > i)
+                {
+                    if (same != candidates.end())
+                    {
+                        candidates.erase(same);
+                    }
+                    candidates.insert(std::move(candidate));
+                }
+                // only the best of the candidates can still make it
+                while (candidates.size() > k - paths.size())
+                {
+                    candidates.erase(std::prev(candidates.end()));
+                }
+            }
+            rootDistance += m_graph.GetMetric(last.edges[i]);
+        }
+        if (candidates.empty())
+        {
+            break;
+        }
+        paths.push_back(*candidates.begin());
+        candidates.erase(candidates.begin());
+    }
+    NS_LOG_LOGIC("Found " << paths.size() << " paths from "
+                          << m_graph.GetLSA(source)->GetLinkStateId() << " to "
+                          << m_graph.GetLSA(target)->GetLinkStateId());
+}
+
+bool
+KShortestPathAlgorithm::ShortestPath(uint32_t source,
+                                     uint32_t target,
+                                     std::vector<uint32_t>& path,
+                                     uint32_t& distance)
+{
+    m_searchEpoch++;
+    typedef std::pair<uint32_t, uint32_t> Entry;
+    std::vector<Entry>& heap = m_heap;
+    heap.clear();
+    heap.emplace_back(0, source);
+    m_distances[source] = 0;
+    m_previous[source] = LSDBGraph::NO_EDGE;
+    m_reached[source] = m_searchEpoch;
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        Entry top = heap.back();
+        heap.pop_back();
+        uint32_t v = top.second;
+        if (top.first > m_distances[v])
+        {
+            continue;
+        }
+        if (v == target)
+        {
+            distance = top.first;
+            path.clear();
+            for (uint32_t w = target; w != source; w = m_sources[m_previous[w]])
+            {
+                path.push_back(m_previous[w]);
+            }
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+        for (uint32_t e = m_graph.GetEdgesBegin(v); e < m_graph.GetEdgesEnd(v); e++)
+        {
+            uint32_t w = m_graph.GetTarget(e);
+            if (m_edgeBans[e] == m_banEpoch || m_vertexBans[w] == m_banEpoch)
+            {
+                continue;
+            }
+            uint32_t d = top.first + m_graph.GetMetric(e);
+            if (m_reached[w] != m_searchEpoch || d < m_distances[w])
+            {
+                m_reached[w] = m_searchEpoch;
+                m_distances[w] = d;
+                m_previous[w] = e;
+                heap.emplace_back(d, w);
+                std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+            }
+        }
+    }
+    return false;
+}
+
+void
+KShortestPathAlgorithm::ClearBans()
+{
+    m_banEpoch++;
+}
+
+uint32_t
+KShortestPathAlgorithm::GetLimit() const
+{
+    if (m_memoryBound == 0)
+    {
+        return m_k;
+    }
+    // the shortest path is kept whatever the bound
+    return std::min<uint32_t>(
+        m_k,
+        std::max<uint32_t>(m_memoryBound / sizeof(KShortestPathTable::Path), 1));
+}
+
+void
+KShortestPathAlgorithm::FillTable(uint32_t source, KShortestPathTable& table, bool trimmed)
+{
+    NS_LOG_FUNCTION(this << source << trimmed);
+    std::vector<Path> paths;
+    std::vector<Ipv4Address> addresses;
+    uint32_t limit = GetLimit();
+    for (uint32_t t = 0; t < m_graph.GetNVertices(); t++)
+    {
+        LSA* lsa = m_graph.GetLSA(t);
+        if (t == source || lsa->GetLSType() != LSA::RouterLSA)
+        {
+            continue;
+        }
+        uint32_t nodeId = m_directory->GetNodeIdByRouterId(lsa->GetLinkStateId());
+        if (nodeId == RouterDirectory::NO_NODE)
+        {
+            continue;
+        }
+        addresses.clear();
+        // a router with a loopback address is only reached at it
+        Ipv4Address loopback = m_directory->GetLoopback(nodeId);
+        if (loopback != Ipv4Address::GetAny())
+        {
+            addresses.push_back(loopback);
+        }
+        else
+        {
+            for (uint32_t i = 1; i < m_directory->GetNInterfaces(nodeId); i++)
+            {
+                for (uint32_t j = 0; j < m_directory->GetNAddresses(nodeId, i); j++)
+                {
+                    addresses.push_back(m_directory->GetAddress(nodeId, i, j).GetLocal());
+                }
+            }
+        }
+        ComputeVertexPaths(source, t, trimmed ? 1 : limit, paths);
+        table.AddDestination(addresses, lsa->GetLinkStateId(), trimmed && limit > 1);
+        AddPaths(source, paths, table);
+    }
+}
+
+bool
+KShortestPathAlgorithm::RestorePaths(Ipv4Address source, uint32_t d, KShortestPathTable& table)
+{
+    NS_LOG_FUNCTION(this << source << d);
+    if (!m_lsdb)
+    {
+        return false;
+    }
+    UpdateGraph();
+    uint32_t s = m_graph.GetVertex(source);
+    uint32_t t = m_graph.GetVertex(table.GetRouter(d));
+    if (s == LSDBGraph::NO_VERTEX || t == LSDBGraph::NO_VERTEX)
+    {
+        return false;
+    }
+    std::vector<Path> paths;
+    ComputeVertexPaths(s, t, GetLimit(), paths);
+    table.BeginRestore(d);
+    AddPaths(s, paths, table);
+    return true;
+}
+
+void
+KShortestPathAlgorithm::AddPaths(uint32_t source,
+                                 const std::vector<Path>& paths,
+                                 KShortestPathTable& table)
+{
+    for (uint32_t k = 0; k < paths.size(); k++)
+    {
+        const std::vector<uint32_t>& edges = paths[k].edges;
+        //
+        // A point-to-point link goes to the address of the other end, a
+        // transit network to the address of the router it leads to.
+        //
+        Ipv4Address gateway;
+        if (m_graph.GetLinkRecord(edges[0])->GetLinkType() == LinkRecord::PointToPoint)
+        {
+            uint32_t remote = m_graph.GetReverse(edges[0]);
+            NS_ASSERT_MSG(remote != LSDBGraph::NO_EDGE, "No link back to " << source);
+            gateway = m_graph.GetLinkData(remote);
+        }
+        else
+        {
+            NS_ASSERT(edges.size() > 1);
+            gateway = m_graph.GetLinkData(edges[1]);
+        }
+        int32_t iface = m_directory->GetInterfaceForAddress(m_graph.GetLinkData(edges[0]));
+        if (iface < 0)
+        {
+            NS_LOG_LOGIC("No interface for " << m_graph.GetLinkData(edges[0]));
+            continue;
+        }
+        // the edges leaving a network do not count as links
+        uint32_t hops = 0;
+        for (auto e = edges.begin(); e != edges.end(); e++)
+        {
+            hops += m_graph.GetLinkRecord(*e) ? 1 : 0;
+        }
+        table.AddPath(iface, gateway, paths[k].distance, hops);
+    }
+}
+
+} // namespace ns3
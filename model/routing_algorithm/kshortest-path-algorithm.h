@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef KSHORTEST_PATH_ALGORITHM_H
+#define KSHORTEST_PATH_ALGORITHM_H
+
+#include "../datapath/lsdb-graph.h"
+#include "../utility/router-directory.h"
+#include "kshortest-path-table.h"
+#include "routing-algorithm.h"
+
+#include "ns3/ipv4-address.h"
+
+#include <cstddef>
+#include <set>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+class LSDB;
+
+/**
+ * \brief Loopless k shortest paths between every pair of routers.
+ *
+ * The paths are computed with Yen's algorithm on the graph of the LSDB, with
+ * Lawler's refinement: the spur paths of a path only start at or after the
+ * vertex where it deviates from the path it was derived from.  The candidate
+ * set never keeps more paths than are still to be found.
+ *
+ * The first hops of the paths of every DDRRouting node go to its
+ * KShortestPathTable, from which the KSHORT route select mode forwards.  The
+ * other routes and protocols are left alone.  A node with the
+ * KShortestHotDestinations attribute set gets the best path of every
+ * destination only, and the k shortest paths of the destinations it forwards
+ * the most to from RestorePaths ().
+ */
+class KShortestPathAlgorithm : public RoutingAlgorithm
+{
+  public:
+    KShortestPathAlgorithm();
+    ~KShortestPathAlgorithm() override;
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    KShortestPathAlgorithm(const KShortestPathAlgorithm&) = delete;
+    KShortestPathAlgorithm& operator=(const KShortestPathAlgorithm&) = delete;
+
+    /**
+     * @brief Empty the k shortest path tables of all the DDRRouting nodes.
+     */
+    void DeleteRoutes() override;
+
+    /**
+     * @brief Compute the k shortest paths of every router and fill the path
+     * tables of the DDRRouting nodes.
+     */
+    void InitializeRoutes() override;
+
+    /**
+     * \brief Use an LSDB, which the algorithm does not own.
+     * \param lsdb the LSDB
+     */
+    void InsertLSDB(LSDB* lsdb);
+
+    /**
+     * \brief Use a directory built along with the LSDB to find the nodes.
+     *
+     * If none is inserted, InitializeRoutes () builds its own.
+     *
+     * \param directory the directory, which must outlive the computation
+     */
+    void InsertRouterDirectory(const RouterDirectory* directory);
+
+    /**
+     * \param k the number of paths to find per pair of routers
+     */
+    void SetK(uint32_t k);
+
+    /**
+     * \param bytes the size the paths of a destination may take in a table,
+     * which caps their number below k, or 0 for no bound.  The shortest path
+     * is kept whatever the bound.
+     */
+    void SetMemoryBound(uint32_t bytes);
+
+    /**
+     * \brief A loopless path of the graph.
+     */
+    struct Path
+    {
+        std::vector<uint32_t> edges; //!< edge indices in m_graph, from the source
+        uint32_t distance;           //!< cost of the path
+        uint32_t deviation;          //!< first edge where it leaves the path it derives from
+
+        /**
+         * \param other another path
+         * \return true if this path is cheaper, then shorter, then first in edge order
+         */
+        bool operator<(const Path& other) const;
+    };
+
+    /**
+     * \brief Compute the k shortest loopless paths between two routers.
+     *
+     * An LSDB must have been inserted.
+     *
+     * \param source the router ID of the source
+     * \param destination the router ID of the destination
+     * \param paths filled with at most k paths, in increasing order
+     */
+    void ComputePaths(Ipv4Address source, Ipv4Address destination, std::vector<Path>& paths);
+
+    /**
+     * \brief Compute again the paths of a destination of a table, after it
+     * was trimmed to its best path.
+     *
+     * The LSDB the table was filled from must still be inserted.
+     *
+     * \param source the router ID of the node of the table
+     * \param d the destination in the table
+     * \param table the table
+     * \return false if the routers are no longer in the graph
+     */
+    bool RestorePaths(Ipv4Address source, uint32_t d, KShortestPathTable& table);
+
+    /**
+     * \brief Get the memory the engine keeps between runs: the graph and the
+     * Dijkstra buffers.  The LSDB and the path tables are not counted.
+     * \return the number of bytes
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    /**
+     * \brief Rebuild the graph of the LSDB if the LSDB changed since it was built.
+     */
+    void UpdateGraph();
+
+    /**
+     * \brief Compute the k shortest paths between two vertices of the graph.
+     * \param source the source vertex
+     * \param target the target vertex
+     * \param k the number of paths to find
+     * \param paths filled with at most k paths, in increasing order
+     */
+    void ComputeVertexPaths(uint32_t source,
+                            uint32_t target,
+                            uint32_t k,
+                            std::vector<Path>& paths);
+
+    /**
+     * \brief Dijkstra between two vertices, avoiding the banned vertices and edges.
+     * \param source the source vertex
+     * \param target the target vertex
+     * \param path filled with the edges of the path if one is found
+     * \param distance set to the cost of the path if one is found
+     * \return true if the target is reachable
+     */
+    bool ShortestPath(uint32_t source,
+                      uint32_t target,
+                      std::vector<uint32_t>& path,
+                      uint32_t& distance);
+
+    /**
+     * \brief Lift all the bans, in O(1).
+     */
+    void ClearBans();
+
+    /**
+     * \return the number of paths kept per destination, k capped by the
+     * memory bound
+     */
+    uint32_t GetLimit() const;
+
+    /**
+     * \brief Fill the table of a router with its paths to every other router.
+     * \param source the vertex of the router
+     * \param table the table
+     * \param trimmed whether to keep the best path of every destination only
+     */
+    void FillTable(uint32_t source, KShortestPathTable& table, bool trimmed);
+
+    /**
+     * \brief Add the first hops of paths to the destination of a table
+     * AddPath () adds to.
+     * \param source the vertex of the router of the table
+     * \param paths the paths
+     * \param table the table
+     */
+    void AddPaths(uint32_t source, const std::vector<Path>& paths, KShortestPathTable& table);
+
+    LSDB* m_lsdb;                       //!< the Link State DataBase (LSDB)
+    LSDBGraph m_graph;                  //!< snapshot of the transit links of m_lsdb
+    const RouterDirectory* m_directory; //!< router ID and address lookups
+    RouterDirectory m_localDirectory;   //!< fallback when no directory is inserted
+    uint32_t m_k;                       //!< paths per pair of routers
+    uint32_t m_memoryBound;             //!< bytes of paths per destination, 0 for no bound
+    std::vector<uint32_t> m_sources;    //!< source vertex by edge
+    std::vector<uint32_t> m_distances;  //!< Dijkstra distance by vertex
+    std::vector<uint32_t> m_previous;   //!< Dijkstra edge to the vertex, by vertex
+    std::vector<uint32_t> m_reached;    //!< epoch m_distances is valid in, by vertex
+    std::vector<uint32_t> m_vertexBans; //!< epoch the vertex is banned in, by vertex
+    std::vector<uint32_t> m_edgeBans;   //!< epoch the edge is banned in, by edge
+    uint32_t m_searchEpoch;             //!< epoch of the current Dijkstra
+    uint32_t m_banEpoch;                //!< epoch of the current bans
+    /// Dijkstra queue of (distance, vertex), kept for its storage
+    std::vector<std::pair<uint32_t, uint32_t>> m_heap;
+};
+
+} // namespace ns3
+
+#endif /* KSHORTEST_PATH_ALGORITHM_H */
@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "kshortest-path-table.h"
+
+#include "../utility/memory-footprint.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("KShortestPathTable");
+
+KShortestPathTable::KShortestPathTable()
+    : m_current(0),
+      m_garbage(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+KShortestPathTable::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    m_offsets.clear();
+    m_counts.clear();
+    m_routers.clear();
+    m_trimmed.clear();
+    m_paths.clear();
+    m_addresses.clear();
+    m_current = 0;
+    m_garbage = 0;
+}
+
+void
+KShortestPathTable::AddDestination(const std::vector<Ipv4Address>& addresses,
+                                   Ipv4Address router,
+                                   bool trimmed)
+{
+    NS_LOG_FUNCTION(this << addresses.size() << router << trimmed);
+    uint32_t d = m_offsets.size();
+    m_offsets.push_back(m_paths.size());
+    m_counts.push_back(0);
+    m_routers.push_back(router.Get());
+    m_trimmed.push_back(trimmed);
+    m_current = d;
+    for (auto i = addresses.begin(); i != addresses.end(); i++)
+    {
+        m_addresses.emplace(i->Get(), d);
+    }
+}
+
+void
+KShortestPathTable::Trim(uint32_t d)
+{
+    NS_LOG_FUNCTION(this << d);
+    NS_ASSERT(d < m_offsets.size());
+    if (m_counts[d] > 1)
+    {
+        m_garbage += m_counts[d] - 1;
+        m_counts[d] = 1;
+    }
+    m_trimmed[d] = true;
+    if (m_garbage > m_paths.size() / 2)
+    {
+        Compact();
+    }
+}
+
+void
+KShortestPathTable::BeginRestore(uint32_t d)
+{
+    NS_LOG_FUNCTION(this << d);
+    NS_ASSERT(d < m_offsets.size());
+    m_garbage += m_counts[d];
+    m_counts[d] = 0;
+    if (m_garbage > m_paths.size() / 2)
+    {
+        Compact();
+    }
+    m_offsets[d] = m_paths.size();
+    m_trimmed[d] = false;
+    m_current = d;
+}
+
+void
+KShortestPathTable::Compact()
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<Path> paths;
+    paths.reserve(m_paths.size() - m_garbage);
+    for (uint32_t d = 0; d < m_offsets.size(); d++)
+    {
+        uint32_t offset = paths.size();
+        paths.insert(paths.end(),
+                     m_paths.begin() + m_offsets[d],
+                     m_paths.begin() + m_offsets[d] + m_counts[d]);
+        m_offsets[d] = offset;
+    }
+    m_paths.swap(paths);
+    m_garbage = 0;
+}
+
+void
+KShortestPathTable::AddPath(uint32_t iface, Ipv4Address gateway, uint32_t distance, uint32_t hops)
+{
+    NS_LOG_FUNCTION(this << iface << gateway << distance << hops);
+    NS_ASSERT_MSG(!m_offsets.empty(), "No destination to add the path to");
+    NS_ASSERT_MSG(m_offsets[m_current] + m_counts[m_current] == m_paths.size(),
+                  "The paths of destination " << m_current << " are not the last ones");
+    NS_ASSERT(iface <= std::numeric_limits<uint16_t>::max());
+    NS_ASSERT(m_counts[m_current] < std::numeric_limits<uint16_t>::max());
+    Path path;
+    path.gateway = gateway.Get();
+    path.distance = distance;
+    path.iface = iface;
+    path.hops = std::min<uint32_t>(hops, std::numeric_limits<uint16_t>::max());
+    m_paths.push_back(path);
+    m_counts[m_current]++;
+}
+
+bool
+KShortestPathTable::IsEmpty() const
+{
+    return m_offsets.empty();
+}
+
+uint32_t
+KShortestPathTable::Find(Ipv4Address address) const
+{
+    auto i = m_addresses.find(address.Get());
+    return i == m_addresses.end() ? NO_DESTINATION : i->second;
+}
+
+uint32_t
+KShortestPathTable::GetNPaths(uint32_t d) const
+{
+    NS_ASSERT(d < m_offsets.size());
+    return m_counts[d];
+}
+
+const KShortestPathTable::Path&
+KShortestPathTable::GetPath(uint32_t d, uint32_t i) const
+{
+    NS_ASSERT(i < GetNPaths(d));
+    return m_paths[m_offsets[d] + i];
+}
+
+Ipv4Address
+KShortestPathTable::GetRouter(uint32_t d) const
+{
+    NS_ASSERT(d < m_routers.size());
+    return Ipv4Address(m_routers[d]);
+}
+
+bool
+KShortestPathTable::IsTrimmed(uint32_t d) const
+{
+    NS_ASSERT(d < m_trimmed.size());
+    return m_trimmed[d];
+}
+
+uint32_t
+KShortestPathTable::GetNDestinations() const
+{
+    return m_offsets.size();
+}
+
+std::size_t
+KShortestPathTable::GetMemoryUsage() const
+{
+    return m_offsets.capacity() * sizeof(uint32_t) + m_counts.capacity() * sizeof(uint16_t) +
+           m_routers.capacity() * sizeof(uint32_t) + m_trimmed.capacity() / 8 +
+           m_paths.capacity() * sizeof(Path) + GetHashMapFootprint(m_addresses);
+}
+
+} // namespace ns3
@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef KSHORTEST_PATH_TABLE_H
+#define KSHORTEST_PATH_TABLE_H
+
+#include "ns3/ipv4-address.h"
+
+#include <cstddef>
+#include <limits>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief The k shortest paths of a node to every destination router.
+ *
+ * Forwarding only needs the first hop of a path, so a path is kept as its
+ * outgoing interface, gateway, cost and hop count.  The paths of all the
+ * destinations are stored contiguously, and every interface address of a
+ * destination router maps to its paths.
+ *
+ * A destination may be trimmed to its best path, to save the memory of the
+ * destinations no traffic goes to, and restored later: BeginRestore () moves
+ * its paths to the end of the storage, where AddPath () adds them again.  The
+ * storage is compacted once the paths left behind take half of it.
+ */
+class KShortestPathTable
+{
+  public:
+    /// destination returned for an unknown address
+    static constexpr uint32_t NO_DESTINATION = std::numeric_limits<uint32_t>::max();
+
+    /// the first hop of a path
+    struct Path
+    {
+        uint32_t gateway;  //!< next hop address, as Ipv4Address::Get () gives it
+        uint32_t distance; //!< cost of the whole path
+        uint16_t iface;    //!< outgoing interface
+        uint16_t hops;     //!< number of links of the path
+    };
+
+    KShortestPathTable();
+
+    /**
+     * \brief Remove all the destinations and paths.
+     */
+    void Clear();
+
+    /**
+     * \brief Start the paths of a new destination.
+     * \param addresses the addresses the destination is reached at
+     * \param router the router ID of the destination
+     * \param trimmed whether the paths added are the best one only
+     */
+    void AddDestination(const std::vector<Ipv4Address>& addresses,
+                        Ipv4Address router = Ipv4Address(),
+                        bool trimmed = false);
+
+    /**
+     * \brief Keep the best path of a destination only.
+     * \param d a destination
+     */
+    void Trim(uint32_t d);
+
+    /**
+     * \brief Drop the paths of a destination, the next AddPath () calls
+     * adding its paths again, and mark it as not trimmed.
+     *
+     * The references GetPath () returned are no longer valid.
+     *
+     * \param d a destination
+     */
+    void BeginRestore(uint32_t d);
+
+    /**
+     * \brief Add a path to the last destination added, or restored.
+     * \param iface the outgoing interface
+     * \param gateway the next hop address
+     * \param distance the cost of the path
+     * \param hops the number of links of the path
+     */
+    void AddPath(uint32_t iface, Ipv4Address gateway, uint32_t distance, uint32_t hops);
+
+    /**
+     * \return true if there is no destination
+     */
+    bool IsEmpty() const;
+
+    /**
+     * \param address an address
+     * \return the destination reached at address, or NO_DESTINATION
+     */
+    uint32_t Find(Ipv4Address address) const;
+
+    /**
+     * \param d a destination
+     * \return the number of paths to the destination
+     */
+    uint32_t GetNPaths(uint32_t d) const;
+
+    /**
+     * \param d a destination
+     * \param i the index of the path, in increasing order of cost
+     * \return the path
+     */
+    const Path& GetPath(uint32_t d, uint32_t i) const;
+
+    /**
+     * \param d a destination
+     * \return the router ID of the destination
+     */
+    Ipv4Address GetRouter(uint32_t d) const;
+
+    /**
+     * \param d a destination
+     * \return true if the destination keeps its best path only
+     */
+    bool IsTrimmed(uint32_t d) const;
+
+    /**
+     * \return the number of destinations
+     */
+    uint32_t GetNDestinations() const;
+
+    /**
+     * \return the number of bytes the paths and the address index take
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    /**
+     * \brief Store the paths of the destinations in their order again,
+     * without the paths left behind.
+     */
+    void Compact();
+
+    std::vector<uint32_t> m_offsets;                    //!< first path by destination
+    std::vector<uint16_t> m_counts;                     //!< number of paths by destination
+    std::vector<uint32_t> m_routers;                    //!< router ID by destination
+    std::vector<bool> m_trimmed;                        //!< trimmed, by destination
+    std::vector<Path> m_paths;                          //!< paths of all the destinations
+    std::unordered_map<uint32_t, uint32_t> m_addresses; //!< destination by address
+    uint32_t m_current;                                 //!< destination AddPath () adds to
+    uint32_t m_garbage;                                 //!< paths left behind in m_paths
+};
+
+} // namespace ns3
+
+#endif /* KSHORTEST_PATH_TABLE_H */
@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "policy-table.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PolicyTable");
+
+/// "ROMAMPOL", which also tells the byte order of the file
+static const uint64_t POLICY_FILE_MAGIC = 0x4c4f504d414d4f52ULL;
+/// layout of the file, to be changed along with the structure below
+static const uint32_t POLICY_FILE_FORMAT = 1;
+/// most decisions of a table, so that a malformed header allocates no more
+static const std::size_t MAX_DECISIONS = std::size_t(1) << 31;
+
+/// beginning of the file
+struct PolicyFileHeader
+{
+    uint64_t magic;         //!< POLICY_FILE_MAGIC
+    uint32_t format;        //!< POLICY_FILE_FORMAT
+    uint32_t nodes;         //!< node IDs of the routers and destinations
+    uint32_t levels;        //!< levels of a state
+    uint32_t interfaces;    //!< interfaces whose neighbor states key a decision
+    uint32_t budgetBuckets; //!< buckets of the remaining budgets
+    uint32_t bucketWidth;   //!< width of a bucket, in us
+};
+
+static_assert(sizeof(PolicyFileHeader) == 32, "PolicyFileHeader must have no padding");
+
+/**
+ * \param nodes the node IDs of a layout
+ * \param levels the levels of a state
+ * \param interfaces the interfaces of the neighbor states
+ * \param budgetBuckets the budget buckets
+ * \return the decisions of the layout, 0 if they are more than MAX_DECISIONS
+ */
+static std::size_t
+CountDecisions(uint32_t nodes, uint32_t levels, uint32_t interfaces, uint32_t budgetBuckets)
+{
+    double count = double(nodes) * nodes * budgetBuckets;
+    for (uint32_t i = 0; i <= interfaces && count <= MAX_DECISIONS; i++)
+    {
+        count *= levels;
+    }
+    return count > MAX_DECISIONS ? 0 : static_cast<std::size_t>(count);
+}
+
+PolicyTable::PolicyTable(uint32_t nodes,
+                         uint32_t levels,
+                         uint32_t interfaces,
+                         uint32_t budgetBuckets,
+                         Time bucketWidth)
+    : m_nodes(nodes),
+      m_levels(levels),
+      m_interfaces(interfaces),
+      m_budgetBuckets(budgetBuckets),
+      m_bucketWidth(bucketWidth.GetMicroSeconds())
+{
+    NS_LOG_FUNCTION(this << nodes << levels << interfaces << budgetBuckets << bucketWidth);
+    NS_ABORT_MSG_IF(levels < 2, "A state needs two levels");
+    NS_ABORT_MSG_IF(budgetBuckets == 0 || m_bucketWidth == 0, "The budgets need a bucket");
+    NS_ABORT_MSG_IF(CountDecisions(nodes, levels, interfaces, budgetBuckets) == 0,
+                    "The policy table would take more than " << MAX_DECISIONS << " bytes");
+    Allocate();
+}
+
+void
+PolicyTable::Allocate()
+{
+    m_nStateKeys = 1;
+    for (uint32_t i = 0; i <= m_interfaces; i++)
+    {
+        m_nStateKeys *= m_levels;
+    }
+    m_decisions.assign(CountDecisions(m_nodes, m_levels, m_interfaces, m_budgetBuckets),
+                       NO_DECISION);
+}
+
+std::shared_ptr<const PolicyTable>
+PolicyTable::Get(const std::string& path)
+{
+    // the tables stay loaded for the runs of the simulation to come
+    static std::map<std::string, std::shared_ptr<const PolicyTable>> tables;
+    auto i = tables.find(path);
+    if (i == tables.end())
+    {
+        i = tables.emplace(path, std::shared_ptr<const PolicyTable>(Load(path))).first;
+    }
+    return i->second;
+}
+
+std::unique_ptr<PolicyTable>
+PolicyTable::Load(const std::string& path)
+{
+    NS_LOG_FUNCTION(path);
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+    {
+        NS_LOG_WARN("No policy table " << path);
+        return nullptr;
+    }
+    std::size_t size = in.tellg();
+    in.seekg(0);
+    PolicyFileHeader header;
+    if (size < sizeof(header) || !in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        return nullptr;
+    }
+    std::size_t decisions =
+        header.levels < 2 || header.budgetBuckets == 0 || header.bucketWidth == 0
+            ? 0
+            : CountDecisions(header.nodes, header.levels, header.interfaces, header.budgetBuckets);
+    if (header.magic != POLICY_FILE_MAGIC || header.format != POLICY_FILE_FORMAT ||
+        decisions == 0 || size != sizeof(header) + decisions)
+    {
+        NS_LOG_WARN("The policy table " << path << " is malformed");
+        return nullptr;
+    }
+    std::unique_ptr<PolicyTable> table(new PolicyTable());
+    table->m_nodes = header.nodes;
+    table->m_levels = header.levels;
+    table->m_interfaces = header.interfaces;
+    table->m_budgetBuckets = header.budgetBuckets;
+    table->m_bucketWidth = header.bucketWidth;
+    table->Allocate();
+    in.read(reinterpret_cast<char*>(table->m_decisions.data()), table->m_decisions.size());
+    if (!in)
+    {
+        NS_LOG_WARN("Cannot read the policy table " << path);
+        return nullptr;
+    }
+    NS_LOG_LOGIC("Loaded " << decisions << " decisions from " << path);
+    return table;
+}
+
+bool
+PolicyTable::Save(const std::string& path) const
+{
+    NS_LOG_FUNCTION(this << path);
+    PolicyFileHeader header;
+    header.magic = POLICY_FILE_MAGIC;
+    header.format = POLICY_FILE_FORMAT;
+    header.nodes = m_nodes;
+    header.levels = m_levels;
+    header.interfaces = m_interfaces;
+    header.budgetBuckets = m_budgetBuckets;
+    header.bucketWidth = m_bucketWidth;
+
+    // as for an ArmStateFile, write a private file and rename it
+    std::ostringstream tmp;
+    tmp << path << ".tmp." << getpid();
+    {
+        std::ofstream out(tmp.str(), std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(m_decisions.data()), m_decisions.size());
+        if (!out)
+        {
+            NS_LOG_WARN("Cannot write the policy table " << tmp.str());
+            std::remove(tmp.str().c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp.str().c_str(), path.c_str()) != 0)
+    {
+        NS_LOG_WARN("Cannot replace the policy table " << path);
+        std::remove(tmp.str().c_str());
+        return false;
+    }
+    return true;
+}
+
+uint32_t
+PolicyTable::GetNNodes() const
+{
+    return m_nodes;
+}
+
+uint32_t
+PolicyTable::GetNInterfaces() const
+{
+    return m_interfaces;
+}
+
+uint32_t
+PolicyTable::Quantize(uint32_t level, uint32_t nStates) const
+{
+    return nStates == 0 ? 0 : std::min(level, nStates - 1) * m_levels / nStates;
+}
+
+uint32_t
+PolicyTable::GetStateKey(uint32_t local, const std::vector<uint32_t>& neighbors) const
+{
+    uint32_t key = 0;
+    for (uint32_t i = m_interfaces; i >= 1; i--)
+    {
+        uint32_t state = i < neighbors.size() ? neighbors[i] : 0;
+        key = key * m_levels + std::min(state, m_levels - 1);
+    }
+    return key * m_levels + std::min(local, m_levels - 1);
+}
+
+uint32_t
+PolicyTable::GetBudgetBucket(uint32_t budget) const
+{
+    return std::min(budget / m_bucketWidth, m_budgetBuckets - 1);
+}
+
+void
+PolicyTable::SetDecision(uint32_t node,
+                         uint32_t dest,
+                         uint32_t state,
+                         uint32_t bucket,
+                         uint32_t iface)
+{
+    NS_ABORT_MSG_IF(node >= m_nodes || dest >= m_nodes, "Node not in the policy table");
+    NS_ABORT_MSG_IF(state >= m_nStateKeys || bucket >= m_budgetBuckets, "Key out of the table");
+    NS_ABORT_MSG_IF(iface > UINT8_MAX, "Interface " << iface << " does not fit the table");
+    m_decisions[((static_cast<std::size_t>(node) * m_nodes + dest) * m_nStateKeys + state) *
+                    m_budgetBuckets +
+                bucket] = iface;
+}
+
+uint32_t
+PolicyTable::GetDecision(uint32_t node, uint32_t dest, uint32_t state, uint32_t bucket) const
+{
+    if (node >= m_nodes || dest >= m_nodes)
+    {
+        return NO_DECISION;
+    }
+    NS_ASSERT(state < m_nStateKeys && bucket < m_budgetBuckets);
+    return m_decisions[((static_cast<std::size_t>(node) * m_nodes + dest) * m_nStateKeys + state) *
+                           m_budgetBuckets +
+                       bucket];
+}
+
+} // namespace ns3
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef POLICY_TABLE_H
+#define POLICY_TABLE_H
+
+#include "ns3/nstime.h"
+
+#include <cstddef>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief A routing policy compiled offline into a table of next hops, which
+ * the POLICY route select mode of DDRRouting looks up instead of evaluating
+ * the candidates.
+ *
+ * A decision is the output interface of a router for a key: the node ID of
+ * the destination router, the quantized local state of the router, the
+ * quantized neighbor states of its first interfaces and the bucket of the
+ * remaining budget of the packet.  The local state is the highest occupancy
+ * level of the local queue discs, the neighbor state of an interface the
+ * highest level the neighbor on it reported, and a level of n is quantized to
+ * level q / n of the levels of the table.  The states of a key are packed
+ * into one number, local state first, so that a lookup is one indexed load
+ * into a dense array of uint8_t by router, destination, state and bucket; 0
+ * is no decision.
+ *
+ * The array takes n^2 q^(k + 1) b bytes, for n nodes, q levels, k interfaces
+ * and b budget buckets, so a policy is compiled with few levels and
+ * interfaces.  The file holds a header, then the array, in host byte order.
+ */
+class PolicyTable
+{
+  public:
+    /// the output interface of no decision
+    static const uint32_t NO_DECISION = 0;
+
+    /**
+     * \brief Make an empty table of a layout.
+     * \param nodes the node IDs of the routers and destinations, from 0
+     * \param levels the levels the states are quantized in, at least 2
+     * \param interfaces the interfaces whose neighbor states key a decision,
+     * from 1
+     * \param budgetBuckets the buckets of the remaining budgets
+     * \param bucketWidth the width of a bucket, the last one holding all the
+     * larger budgets
+     */
+    PolicyTable(uint32_t nodes,
+                uint32_t levels,
+                uint32_t interfaces,
+                uint32_t budgetBuckets,
+                Time bucketWidth);
+
+    /**
+     * \brief Get the table of a file, which the routers of a simulation share.
+     * \param path the file
+     * \return the table, loaded once, or null if the file is missing or
+     * malformed
+     */
+    static std::shared_ptr<const PolicyTable> Get(const std::string& path);
+
+    /**
+     * \param path the file
+     * \return the table of the file, or null if it is missing or malformed
+     */
+    static std::unique_ptr<PolicyTable> Load(const std::string& path);
+
+    /**
+     * \brief Write the table to a file, replacing it atomically.
+     * \param path the file
+     * \return true if the file was written
+     */
+    bool Save(const std::string& path) const;
+
+    /**
+     * \return the node IDs of the routers and destinations
+     */
+    uint32_t GetNNodes() const;
+
+    /**
+     * \return the interfaces whose neighbor states key a decision
+     */
+    uint32_t GetNInterfaces() const;
+
+    /**
+     * \param level an occupancy level
+     * \param nStates the levels it is of
+     * \return the level of the table
+     */
+    uint32_t Quantize(uint32_t level, uint32_t nStates) const;
+
+    /**
+     * \param local the quantized local state
+     * \param neighbors the quantized neighbor states, by interface from 1,
+     * the ones of the interfaces beyond GetNInterfaces () being ignored and
+     * the missing ones 0
+     * \return the packed states
+     */
+    uint32_t GetStateKey(uint32_t local, const std::vector<uint32_t>& neighbors) const;
+
+    /**
+     * \param budget a remaining budget, in us
+     * \return its bucket
+     */
+    uint32_t GetBudgetBucket(uint32_t budget) const;
+
+    /**
+     * \param node the node ID of a router
+     * \param dest the node ID of a destination
+     * \param state the packed states
+     * \param bucket the budget bucket
+     * \param iface the output interface, NO_DECISION for none
+     */
+    void SetDecision(uint32_t node, uint32_t dest, uint32_t state, uint32_t bucket, uint32_t iface);
+
+    /**
+     * \param node the node ID of a router
+     * \param dest the node ID of a destination
+     * \param state the packed states
+     * \param bucket the budget bucket
+     * \return the output interface, NO_DECISION if none or if a node is not
+     * in the table
+     */
+    uint32_t GetDecision(uint32_t node, uint32_t dest, uint32_t state, uint32_t bucket) const;
+
+  private:
+    PolicyTable() = default;
+
+    /**
+     * \brief Size the decisions of the layout, none taken.
+     */
+    void Allocate();
+
+    uint32_t m_nodes;                 //!< node IDs of the routers and destinations
+    uint32_t m_levels;                //!< levels of a state
+    uint32_t m_interfaces;            //!< interfaces whose neighbor states key a decision
+    uint32_t m_budgetBuckets;         //!< buckets of the remaining budgets
+    uint32_t m_bucketWidth;           //!< width of a bucket, in us
+    uint32_t m_nStateKeys;            //!< packed states, m_levels^(m_interfaces + 1)
+    std::vector<uint8_t> m_decisions; //!< the output interfaces, by node, dest, state and bucket
+};
+
+} // namespace ns3
+
+#endif /* POLICY_TABLE_H */
@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "route-batch-queue.h"
+
+#include <utility>
+
+namespace ns3
+{
+
+RouteBatchQueue::RouteBatchQueue()
+    : m_head(nullptr),
+      m_completed(0)
+{
+}
+
+RouteBatchQueue::~RouteBatchQueue()
+{
+    Entry* entry = m_head.exchange(nullptr);
+    while (entry)
+    {
+        Entry* next = entry->next;
+        delete entry;
+        entry = next;
+    }
+}
+
+void
+RouteBatchQueue::Push(uint32_t node, RouteBatch&& routes)
+{
+    Entry* head = m_head.load(std::memory_order_relaxed);
+    auto entry = new Entry{node, std::move(routes), head};
+    // the entry may be drained as soon as it is in, so the old head is kept aside
+    while (!m_head.compare_exchange_weak(head,
+                                         entry,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed))
+    {
+        entry->next = head;
+    }
+    // a waiter only sleeps on an empty queue, so the other pushes need no wake-up
+    if (head == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wake.notify_one();
+    }
+}
+
+uint32_t
+RouteBatchQueue::Drain(const std::function<void(uint32_t, RouteBatch&)>& install)
+{
+    Entry* entry = m_head.exchange(nullptr, std::memory_order_acquire);
+    // the list runs from the last push to the first
+    Entry* first = nullptr;
+    while (entry)
+    {
+        Entry* next = entry->next;
+        entry->next = first;
+        first = entry;
+        entry = next;
+    }
+    uint32_t n = 0;
+    while (first)
+    {
+        Entry* next = first->next;
+        install(first->node, first->routes);
+        delete first;
+        first = next;
+        n++;
+    }
+    return n;
+}
+
+void
+RouteBatchQueue::Complete()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_completed++;
+    m_wake.notify_one();
+}
+
+bool
+RouteBatchQueue::WaitForTables(uint32_t nRoots)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wake.wait(lock, [this, nRoots]() {
+        return m_head.load(std::memory_order_relaxed) != nullptr || m_completed >= nRoots;
+    });
+    return m_head.load(std::memory_order_relaxed) != nullptr;
+}
+
+} // namespace ns3
@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROUTE_BATCH_QUEUE_H
+#define ROUTE_BATCH_QUEUE_H
+
+#include "../romam-routing.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+
+namespace ns3
+{
+
+/**
+ * \brief A lock-free queue of node tables, from the worker threads of a
+ * parallel route computation to the simulator thread.
+ *
+ * A worker pushes the table of a node as soon as the trees giving it are
+ * computed, and the simulator thread drains the queue between its own trees,
+ * so the tables are installed while the workers go on.  A push is a compare
+ * and swap on the head of a list; a drain takes the whole list in one
+ * exchange and hands the tables over in the order they were pushed.
+ *
+ * While it has no root of its own left, the simulator thread sleeps in
+ * WaitForTables () until a push finds the queue empty or a worker completes
+ * a root, both of which wake it up under the mutex of the queue.
+ */
+class RouteBatchQueue
+{
+  public:
+    RouteBatchQueue();
+    ~RouteBatchQueue();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    RouteBatchQueue(const RouteBatchQueue&) = delete;
+    RouteBatchQueue& operator=(const RouteBatchQueue&) = delete;
+
+    /**
+     * \brief Push the table of a node, from any thread.
+     * \param node the node ID
+     * \param routes the table, moved into the queue
+     */
+    void Push(uint32_t node, RouteBatch&& routes);
+
+    /**
+     * \brief Pop the tables pushed so far, from one thread at a time.
+     * \param install called with every node and its table, which it may move
+     * \return the number of tables popped
+     */
+    uint32_t Drain(const std::function<void(uint32_t, RouteBatch&)>& install);
+
+    /**
+     * \brief Record that a root is completed, its tables pushed, from any thread.
+     */
+    void Complete();
+
+    /**
+     * \brief Wait for tables to drain, or for all the roots to be completed.
+     * \param nRoots the number of roots of the run
+     * \return true if there are tables to drain, false if the roots are all
+     * completed and their tables drained
+     */
+    bool WaitForTables(uint32_t nRoots);
+
+  private:
+    /// a table in the queue
+    struct Entry
+    {
+        uint32_t node;     //!< the node ID
+        RouteBatch routes; //!< the table
+        Entry* next;       //!< the table pushed before
+    };
+
+    std::atomic<Entry*> m_head;     //!< the table pushed last
+    uint32_t m_completed;           //!< the number of roots completed
+    std::mutex m_mutex;             //!< guards m_completed and the wake-ups
+    std::condition_variable m_wake; //!< signalled on pushes and completions
+};
+
+} // namespace ns3
+
+#endif /* ROUTE_BATCH_QUEUE_H */
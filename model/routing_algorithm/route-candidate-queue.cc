@@ -48,24 +48,32 @@ operator<< (std::ostream& os, const Vertex::VertexType& t)
 std::ostream& 
 operator<< (std::ostream& os, const RouteCandidateQueue& q)
 {
-  typedef RouteCandidateQueue::DGRCandidateList_t List_t;
-  typedef List_t::const_iterator CIter_t;
-  const RouteCandidateQueue::DGRCandidateList_t& list = q.m_candidates;
+  // print the candidates in the order they will be popped
+  std::vector<uint32_t> slots (q.m_candidates.size ());
+  for (uint32_t i = 0; i < slots.size (); i++)
+    {
+      slots[i] = i;
+    }
+  std::sort (slots.begin (), slots.end (),
+             [&q] (uint32_t i, uint32_t j) { return q.Before (i, j); });
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
-  for (CIter_t iter = list.begin (); iter != list.end (); iter++)
+  for (std::vector<uint32_t>::const_iterator iter = slots.begin (); iter != slots.end (); iter++)
     {
+      const Vertex *v = q.m_candidates[*iter].vertex;
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << v->GetVertexId () << ", "
+      << v->GetDistanceFromRoot () << ", "
+      << v->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 RouteCandidateQueue::RouteCandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_slots (),
+    m_order (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -80,12 +88,13 @@ void
 RouteCandidateQueue::Clear (void)
 {
   NS_LOG_FUNCTION (this);
-  while (!m_candidates.empty ())
+  for (DGRCandidateList_t::iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
     {
-      Vertex *p = Pop ();
-      delete p;
-      p = 0;
+      delete i->vertex;
     }
+  m_candidates.clear ();
+  m_slots.clear ();
+  m_order = 0;
 }
 
 void
@@ -93,11 +102,14 @@ RouteCandidateQueue::Push (Vertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  DGRCandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &RouteCandidateQueue::CompareVertex
-      );
-  m_candidates.insert (i, vNew);
+  HeapEntry entry;
+  entry.vertex = vNew;
+  entry.order = m_order++;
+  m_candidates.push_back (entry);
+  uint32_t slot = m_candidates.size () - 1;
+  // keep the first vertex pushed with a given id, as the former linear Find () did
+  m_slots.emplace (vNew->GetVertexId ().Get (), slot);
+  SiftUp (slot);
 }
 
 Vertex *
@@ -109,8 +121,18 @@ RouteCandidateQueue::Pop (void)
       return 0;
     }
 
-  Vertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  Vertex *v = m_candidates.front ().vertex;
+  Swap (0, m_candidates.size () - 1);
+  SlotIndex_t::iterator slot = m_slots.find (v->GetVertexId ().Get ());
+  if (slot != m_slots.end () && slot->second == m_candidates.size () - 1)
+    {
+      m_slots.erase (slot);
+    }
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -123,7 +145,7 @@ RouteCandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().vertex;
 }
 
 bool
@@ -144,18 +166,24 @@ Vertex *
 RouteCandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  DGRCandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  SlotIndex_t::const_iterator slot = m_slots.find (addr.Get ());
+  if (slot == m_slots.end ())
     {
-      Vertex *v = *i;
-      if (v->GetVertexId () == addr)
-        {
-          return v;
-        }
+      return 0;
     }
+  return m_candidates[slot->second].vertex;
+}
 
-  return 0;
+void
+RouteCandidateQueue::Update (Vertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+  SlotIndex_t::iterator slot = m_slots.find (v->GetVertexId ().Get ());
+  NS_ASSERT_MSG (slot != m_slots.end () && m_candidates[slot->second].vertex == v,
+                 "RouteCandidateQueue::Update (): vertex not in the queue");
+  // a re-inserted vertex went behind the vertices it now ties with
+  m_candidates[slot->second].order = m_order++;
+  SiftUp (slot->second);
 }
 
 void
@@ -163,11 +191,107 @@ RouteCandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&RouteCandidateQueue::CompareVertex);
+  for (uint32_t i = m_candidates.size () / 2; i > 0; i--)
+    {
+      SiftDown (i - 1);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+bool
+RouteCandidateQueue::Before (uint32_t i, uint32_t j) const
+{
+  const HeapEntry& a = m_candidates[i];
+  const HeapEntry& b = m_candidates[j];
+  if (CompareVertex (a.vertex, b.vertex))
+    {
+      return true;
+    }
+  if (CompareVertex (b.vertex, a.vertex))
+    {
+      return false;
+    }
+  return a.order < b.order;
+}
+
+void
+RouteCandidateQueue::Swap (uint32_t i, uint32_t j)
+{
+  if (i == j)
+    {
+      return;
+    }
+  uint32_t idI = m_candidates[i].vertex->GetVertexId ().Get ();
+  uint32_t idJ = m_candidates[j].vertex->GetVertexId ().Get ();
+  std::swap (m_candidates[i], m_candidates[j]);
+  // a vertex pushed twice has both slots under one id, move its index once only
+  SwapSlot (idI, i, j);
+  if (idJ != idI)
+    {
+      SwapSlot (idJ, i, j);
+    }
+}
+
+void
+RouteCandidateQueue::SwapSlot (uint32_t id, uint32_t i, uint32_t j)
+{
+  SlotIndex_t::iterator slot = m_slots.find (id);
+  if (slot == m_slots.end ())
+    {
+      return;
+    }
+  if (slot->second == i)
+    {
+      slot->second = j;
+    }
+  else if (slot->second == j)
+    {
+      slot->second = i;
+    }
+}
+
+void
+RouteCandidateQueue::SiftUp (uint32_t i)
+{
+  while (i > 0)
+    {
+      uint32_t parent = (i - 1) / 2;
+      if (!Before (i, parent))
+        {
+          break;
+        }
+      Swap (i, parent);
+      i = parent;
+    }
+}
+
+void
+RouteCandidateQueue::SiftDown (uint32_t i)
+{
+  uint32_t n = m_candidates.size ();
+  while (true)
+    {
+      uint32_t first = i;
+      uint32_t left = 2 * i + 1;
+      uint32_t right = left + 1;
+      if (left < n && Before (left, first))
+        {
+          first = left;
+        }
+      if (right < n && Before (right, first))
+        {
+          first = right;
+        }
+      if (first == i)
+        {
+          break;
+        }
+      Swap (i, first);
+      i = first;
+    }
+}
+
 /*
  * In this implementation, Vertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -4,7 +4,8 @@
 #define ROUTE_CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 #include "../datapath/lsdb.h"
 
@@ -28,8 +29,13 @@ namespace ns3 {
  *
  * Although a STL priority_queue almost does what we want, the requirement
  * for a Find () operation, the dynamic nature of the data and the derived
- * requirement for a Reorder () operation led us to implement this simple 
- * enhanced priority queue.
+ * requirement for a decrease-key operation led us to implement this
+ * indexed binary heap.  Push (), Pop () and Update () are O(log n); Find ()
+ * goes through a vertex id to heap slot index and is O(1).
+ *
+ * Vertices that compare equal are popped in the order they were pushed
+ * (or last updated), the same order the former sorted list gave, so ECMP
+ * results do not depend on the heap layout.
  */
 class RouteCandidateQueue
 {
@@ -122,6 +128,15 @@ public:
  */
   Vertex* Find (const Ipv4Address addr) const;
 
+/**
+ * @brief Restore the priority of a vertex whose m_distanceFromRoot was
+ * lowered during the routing calculations (decrease-key).
+ *
+ * @see Vertex
+ * @param v The Shortest Path First Vertex, already in the queue.
+ */
+  void Update (Vertex *v);
+
 /**
  * @brief Reorders the Candidate Queue according to the priority scheme.
  * 
@@ -130,8 +145,9 @@ public:
  * m_distanceFromRoot.  Remaining vertices are ordered according to 
  * increasing distance.
  *
- * This method is provided in case the values of m_distanceFromRoot change
- * during the routing calculations.
+ * This method is provided in case the values of m_distanceFromRoot of
+ * several vertices change during the routing calculations; prefer Update ()
+ * when a single vertex changed.
  *
  * @see Vertex
  */
@@ -167,8 +183,53 @@ private:
  */
   static bool CompareVertex (const Vertex* v1, const Vertex* v2);
 
-  typedef std::list<Vertex*> DGRCandidateList_t; //!< container of Vertex pointers
+  /// a heap slot
+  struct HeapEntry
+  {
+    Vertex *vertex;  //!< the candidate
+    uint32_t order;  //!< push (or update) sequence number, breaks ties
+  };
+
+/**
+ * \brief return true if the entry in slot i should be popped before the one in slot j
+ * \param i first slot
+ * \param j second slot
+ * \return True if slot i ranks first
+ */
+  bool Before (uint32_t i, uint32_t j) const;
+
+/**
+ * \brief Swap two heap slots and keep the index up to date.
+ * \param i first slot
+ * \param j second slot
+ */
+  void Swap (uint32_t i, uint32_t j);
+
+/**
+ * \brief Follow a swap of two heap slots in the index of a vertex id.
+ * \param id the vertex id
+ * \param i first slot
+ * \param j second slot
+ */
+  void SwapSlot (uint32_t id, uint32_t i, uint32_t j);
+
+/**
+ * \brief Move the entry in slot i up to its place.
+ * \param i the slot
+ */
+  void SiftUp (uint32_t i);
+
+/**
+ * \brief Move the entry in slot i down to its place.
+ * \param i the slot
+ */
+  void SiftDown (uint32_t i);
+
+  typedef std::vector<HeapEntry> DGRCandidateList_t; //!< binary heap of Vertex pointers
+  typedef std::unordered_map<uint32_t, uint32_t> SlotIndex_t; //!< vertex id to heap slot
   DGRCandidateList_t m_candidates;  //!< Vertex candidates
+  SlotIndex_t m_slots;              //!< heap slot of each candidate, by vertex id
+  uint32_t m_order;                 //!< next sequence number
 
   /**
    * \brief Stream insertion operator.
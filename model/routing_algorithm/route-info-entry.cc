@@ -2,17 +2,100 @@
 
 #include "route-info-entry.h"
 
+#include "ns3/abort.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("RouteInfoEntry");
 
+/**
+ * \param interface an interface, or 0xffffffff if unknown
+ * \return the interface as a RouteRecord keeps it
+ */
+static uint16_t
+PackInterface(uint32_t interface)
+{
+    if (interface == 0xffffffff)
+    {
+        return RouteRecord::NO_IFACE;
+    }
+    NS_ABORT_MSG_IF(interface >= RouteRecord::NO_IFACE,
+                    "RouteInfoEntry: interface " << interface << " too large for a route");
+    return interface;
+}
+
+RouteInfoEntry::RouteInfoEntry()
+    : m_cachedEpoch(0),
+      m_cachedRoute(nullptr)
+{
+    m_record.dest = 0;
+    m_record.gateway = 0;
+    m_record.distance = 0xffffffff;
+    m_record.iface = RouteRecord::NO_IFACE;
+    m_record.nextIface = RouteRecord::NO_IFACE;
+    m_record.prefixLength = 32;
+    std::fill(m_record.reserved, m_record.reserved + 3, 0);
+}
+
+RouteInfoEntry::RouteInfoEntry(const RouteInfoEntry& entry)
+    : m_record(entry.m_record),
+      m_cachedEpoch(0),
+      m_cachedRoute(nullptr)
+{
+}
+
+RouteInfoEntry::RouteInfoEntry(Ipv4Address dest,
+                               Ipv4Mask mask,
+                               Ipv4Address gateway,
+                               uint32_t interface,
+                               uint32_t nextIface,
+                               uint32_t distance)
+    : m_cachedEpoch(0),
+      m_cachedRoute(nullptr)
+{
+    uint8_t prefixLength = mask.GetPrefixLength();
+    NS_ABORT_MSG_IF(PrefixToMask(prefixLength) != mask.Get(),
+                    "RouteInfoEntry: the mask " << mask << " is not contiguous");
+    m_record.dest = dest.Get();
+    m_record.gateway = gateway.Get();
+    m_record.distance = distance;
+    m_record.iface = PackInterface(interface);
+    m_record.nextIface = PackInterface(nextIface);
+    m_record.prefixLength = prefixLength;
+    std::fill(m_record.reserved, m_record.reserved + 3, 0);
+}
+
 RouteInfoEntry::~RouteInfoEntry()
 {
     NS_LOG_FUNCTION(this);
 }
 
+Ptr<Ipv4Route>
+RouteInfoEntry::GetCachedRoute(uint32_t epoch) const
+{
+    if (m_cachedEpoch != epoch)
+    {
+        return nullptr;
+    }
+    return m_cachedRoute;
+}
+
+void
+RouteInfoEntry::SetCachedRoute(Ptr<Ipv4Route> route, uint32_t epoch) const
+{
+    m_cachedRoute = route;
+    m_cachedEpoch = epoch;
+}
+
+bool
+RouteInfoEntry::HasCachedRoute() const
+{
+    return m_cachedRoute != nullptr;
+}
+
 } // namespace ns3
@@ -3,6 +3,8 @@
 #define ROUTE_INFO_ENTRY_H
 
 #include "ns3/ipv4-address.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ptr.h"
 
 #include <list>
 #include <ostream>
@@ -10,63 +12,203 @@
 
 namespace ns3
 {
+/**
+ * \brief The packed fields of a RouteInfoEntry.
+ *
+ * The mask of the destination is kept as its prefix length, which is 32 for
+ * a host route, and the interfaces as 16 bits, NO_IFACE standing for an
+ * unknown one (0xffffffff in the accessors).  Only contiguous masks and
+ * interfaces below NO_IFACE can be stored.
+ */
+struct RouteRecord
+{
+    /// an unknown interface
+    static const uint16_t NO_IFACE = 0xffff;
+
+    uint32_t dest;        //!< destination address, host byte order
+    uint32_t gateway;     //!< gateway address, 0 for a direct route
+    uint32_t distance;    //!< distance to the destination, 0xffffffff if unknown
+    uint16_t iface;       //!< output interface
+    uint16_t nextIface;   //!< output interface at the next hop
+    uint8_t prefixLength; //!< prefix length of the destination network mask
+    uint8_t reserved[3];  //!< 0
+};
+
+static_assert(sizeof(RouteRecord) == 20, "RouteRecord must have no padding");
+
 /**
  * @brief This class is the entry of RoutInfoBase (RIB)
  *
+ * The entry is a view over a RouteRecord, with no virtual member: the
+ * lookups test the type of the routes without an indirect call, and an entry
+ * takes 32 bytes with the Ipv4Route it caches.  The entries of the routing
+ * protocols derive from it, but are never deleted or compared through it.
  */
 class RouteInfoEntry
 {
   public:
-    /**
-     * \brief virtual destructor.
-     */
-    virtual ~RouteInfoEntry();
-
     /**
      * \return True if this route is a host route (mask of all ones); false otherwise
      */
-    virtual bool IsHost() const = 0;
+    bool IsHost() const
+    {
+        return m_record.prefixLength == 32;
+    }
 
     /**
      * \return True if this route is not a host route (mask is not all ones); false otherwise
      *
      * This method is implemented as !IsHost ().
      */
-    virtual bool IsNetwork() const = 0;
+    bool IsNetwork() const
+    {
+        return !IsHost();
+    }
 
     /**
      * \return True if this route is a default route; false otherwise
      */
-    virtual bool IsDefault() const = 0;
+    bool IsDefault() const
+    {
+        return m_record.dest == 0;
+    }
 
     /**
      * \return True if this route is a gateway route; false otherwise
      */
-    virtual bool IsGateway() const = 0;
+    bool IsGateway() const
+    {
+        return m_record.gateway != 0;
+    }
 
     /**
      * \return address of the gateway stored in this entry
      */
-    virtual Ipv4Address GetGateway() const = 0;
+    Ipv4Address GetGateway() const
+    {
+        return Ipv4Address(m_record.gateway);
+    }
 
     /**
      * \return The IPv4 address of the destination of this route
      */
-    virtual Ipv4Address GetDest() const = 0;
+    Ipv4Address GetDest() const
+    {
+        return Ipv4Address(m_record.dest);
+    }
 
     /**
      * \return The IPv4 network number of the destination of this route
      */
-    virtual Ipv4Address GetDestNetwork() const = 0;
+    Ipv4Address GetDestNetwork() const
+    {
+        return Ipv4Address(m_record.dest);
+    }
 
     /**
      * \return The IPv4 network mask of the destination of this route
      */
-    virtual Ipv4Mask GetDestNetworkMask() const = 0;
+    Ipv4Mask GetDestNetworkMask() const
+    {
+        return Ipv4Mask(PrefixToMask(m_record.prefixLength));
+    }
+
     /**
      * \return The Ipv4 interface number used for sending outgoing packets
      */
-    virtual uint32_t GetInterface() const = 0;
+    uint32_t GetInterface() const
+    {
+        return UnpackInterface(m_record.iface);
+    }
+
+    /**
+     * \brief Get the Ipv4Route built for this entry.
+     *
+     * The forwarding fast path hands the same Ipv4Route to every packet that
+     * uses this entry instead of allocating a new one per lookup.
+     *
+     * \param epoch the current route cache epoch of the routing protocol
+     * \return the cached route, or null if none was cached in this epoch
+     */
+    Ptr<Ipv4Route> GetCachedRoute(uint32_t epoch) const;
+
+    /**
+     * \brief Cache the Ipv4Route built for this entry.
+     * \param route the route, must not be modified afterwards
+     * \param epoch the current route cache epoch of the routing protocol
+     */
+    void SetCachedRoute(Ptr<Ipv4Route> route, uint32_t epoch) const;
+
+    /**
+     * \return true if an Ipv4Route is cached, whatever its epoch
+     */
+    bool HasCachedRoute() const;
+
+  protected:
+    RouteInfoEntry();
+
+    /**
+     * \brief Copy the route of an entry, but not its cached Ipv4Route.
+     * \param entry the entry to copy
+     */
+    RouteInfoEntry(const RouteInfoEntry& entry);
+
+    /**
+     * \brief Constructor.
+     * \param dest destination address
+     * \param mask destination network mask, contiguous
+     * \param gateway the gateway, 0 for a direct route
+     * \param interface the output interface
+     * \param nextIface the output interface at the next hop, 0xffffffff if unknown
+     * \param distance the distance to the destination, 0xffffffff if unknown
+     */
+    RouteInfoEntry(Ipv4Address dest,
+                   Ipv4Mask mask,
+                   Ipv4Address gateway,
+                   uint32_t interface,
+                   uint32_t nextIface,
+                   uint32_t distance);
+
+    ~RouteInfoEntry();
+
+    /**
+     * \return the output interface at the next hop, 0xffffffff if unknown
+     */
+    uint32_t GetRecordNextIface() const
+    {
+        return UnpackInterface(m_record.nextIface);
+    }
+
+    /**
+     * \return the distance to the destination, 0xffffffff if unknown
+     */
+    uint32_t GetRecordDistance() const
+    {
+        return m_record.distance;
+    }
+
+  private:
+    /**
+     * \param iface an interface of a RouteRecord
+     * \return the interface, 0xffffffff for RouteRecord::NO_IFACE
+     */
+    static uint32_t UnpackInterface(uint16_t iface)
+    {
+        return iface == RouteRecord::NO_IFACE ? 0xffffffff : iface;
+    }
+
+    /**
+     * \param prefixLength a prefix length, up to 32
+     * \return the bits of the mask of that prefix length
+     */
+    static uint32_t PrefixToMask(uint8_t prefixLength)
+    {
+        return prefixLength == 0 ? 0 : 0xffffffff << (32 - prefixLength);
+    }
+
+    RouteRecord m_record;                 //!< the route
+    mutable uint32_t m_cachedEpoch;       //!< epoch m_cachedRoute was built in
+    mutable Ptr<Ipv4Route> m_cachedRoute; //!< cached Ipv4Route of this entry
 };
 } // namespace ns3
 
@@ -0,0 +1,272 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "route-tree-record.h"
+
+#include "../utility/memory-footprint.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RouteTreeRecord");
+
+/// node ID of a segment no route was added to yet
+static const uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+RouteTreeRecord::RouteTreeRecord(Ipv4Address root)
+    : m_root(root),
+      m_truncated(false),
+      m_current(0)
+{
+    NS_LOG_FUNCTION(this << root);
+}
+
+Ipv4Address
+RouteTreeRecord::GetRoot() const
+{
+    return m_root;
+}
+
+void
+RouteTreeRecord::SetTruncated()
+{
+    m_truncated = true;
+}
+
+void
+RouteTreeRecord::AddVertex(const Vertex* v)
+{
+    NS_LOG_FUNCTION(this << v->GetVertexId());
+    uint32_t id = v->GetVertexId().Get();
+    VertexRecord& record = m_vertices[id];
+    record.distance = v->GetDistanceFromRoot();
+    record.network = v->GetVertexType() == Vertex::VertexNetwork;
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+    {
+        record.exits.push_back(v->GetRootExitDirection(i));
+    }
+    for (uint32_t i = 0; v->GetParent(i); i++)
+    {
+        uint32_t parent = v->GetParent(i)->GetVertexId().Get();
+        record.parents.push_back(parent);
+        auto p = m_vertices.find(parent);
+        NS_ASSERT_MSG(p != m_vertices.end(), "Parent recorded after its child");
+        p->second.children.push_back(id);
+    }
+}
+
+bool
+RouteTreeRecord::IsAffected(const LSDB* lsdb,
+                            const std::set<uint32_t>& changed,
+                            Ipv4Address excluded) const
+{
+    NS_LOG_FUNCTION(this << m_root);
+    if (m_truncated && !changed.empty())
+    {
+        return true;
+    }
+    for (auto i = changed.begin(); i != changed.end(); i++)
+    {
+        if (*i == m_root.Get())
+        {
+            return true;
+        }
+        auto v = m_vertices.find(*i);
+        if (v == m_vertices.end())
+        {
+            // a vertex out of the tree can only join it through a link of a
+            // vertex in the tree, whose LSA then changed as well
+            continue;
+        }
+        const VertexRecord& record = v->second;
+        LSA* lsa = lsdb->GetLSA(Ipv4Address(*i));
+        if (!lsa || lsa->GetLSType() != LSA::RouterLSA || record.network)
+        {
+            return true;
+        }
+        // the root exits are derived from the links of the vertices next to the
+        // root, and from the links of the networks
+        for (auto p = record.parents.begin(); p != record.parents.end(); p++)
+        {
+            if (*p == m_root.Get() || m_vertices.at(*p).network)
+            {
+                return true;
+            }
+        }
+        // the tree links leaving the vertex must keep their cost
+        for (auto c = record.children.begin(); c != record.children.end(); c++)
+        {
+            uint32_t cost = m_vertices.at(*c).distance - record.distance;
+            bool found = false;
+            for (uint32_t j = 0; j < lsa->GetNLinkRecords() && !found; j++)
+            {
+                const LinkRecord* l = lsa->GetLinkRecord(j);
+                found = l->GetLinkType() != LinkRecord::StubNetwork &&
+                        l->GetLinkId().Get() == *c && l->GetMetric() == cost;
+            }
+            if (!found)
+            {
+                return true;
+            }
+        }
+        // and no other link of the vertex may offer a path as short as the tree
+        for (uint32_t j = 0; j < lsa->GetNLinkRecords(); j++)
+        {
+            const LinkRecord* l = lsa->GetLinkRecord(j);
+            if (l->GetLinkType() == LinkRecord::StubNetwork || l->GetLinkId() == excluded)
+            {
+                continue;
+            }
+            auto w = m_vertices.find(l->GetLinkId().Get());
+            if (w == m_vertices.end())
+            {
+                return true;
+            }
+            uint32_t distance = record.distance + l->GetMetric();
+            const std::vector<uint32_t>& parents = w->second.parents;
+            if (distance < w->second.distance ||
+                (distance == w->second.distance &&
+                 std::find(parents.begin(), parents.end(), *i) == parents.end()))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::vector<Ipv4Address>
+RouteTreeRecord::GetChangedVertices(const std::set<uint32_t>& changed) const
+{
+    std::vector<Ipv4Address> vertices;
+    for (auto i = changed.begin(); i != changed.end(); i++)
+    {
+        if (*i != m_root.Get() && m_vertices.count(*i))
+        {
+            vertices.emplace_back(*i);
+        }
+    }
+    return vertices;
+}
+
+void
+RouteTreeRecord::RestoreVertex(Vertex* v) const
+{
+    NS_LOG_FUNCTION(this << v->GetVertexId());
+    auto i = m_vertices.find(v->GetVertexId().Get());
+    NS_ASSERT_MSG(i != m_vertices.end(), "Vertex " << v->GetVertexId() << " not in the tree");
+    v->SetDistanceFromRoot(i->second.distance);
+    const std::vector<Vertex::NodeExit_t>& exits = i->second.exits;
+    if (exits.empty())
+    {
+        return;
+    }
+    v->SetRootExitDirection(exits[0]);
+    for (uint32_t j = 1; j < exits.size(); j++)
+    {
+        Vertex exit;
+        exit.SetRootExitDirection(exits[j]);
+        v->MergeRootExitDirections(&exit);
+    }
+}
+
+uint64_t
+RouteTreeRecord::GetSegmentKey(Ipv4Address vertex, Stage stage)
+{
+    return (static_cast<uint64_t>(vertex.Get()) << 3) | stage;
+}
+
+void
+RouteTreeRecord::BeginSegment(Ipv4Address vertex, Stage stage)
+{
+    uint64_t key = GetSegmentKey(vertex, stage);
+    auto i = m_segmentIndex.find(key);
+    if (i != m_segmentIndex.end())
+    {
+        m_current = i->second;
+        return;
+    }
+    Segment segment;
+    segment.vertex = vertex;
+    segment.stage = stage;
+    segment.node = NO_NODE;
+    m_current = m_segments.size();
+    m_segmentIndex[key] = m_current;
+    m_segments.push_back(segment);
+}
+
+void
+RouteTreeRecord::ClearSegments(Ipv4Address vertex)
+{
+    NS_LOG_FUNCTION(this << vertex);
+    for (Stage stage : {TRANSIT, STUB})
+    {
+        auto i = m_segmentIndex.find(GetSegmentKey(vertex, stage));
+        if (i != m_segmentIndex.end())
+        {
+            m_segments[i->second].routes.Clear();
+        }
+    }
+}
+
+RouteBatch&
+RouteTreeRecord::GetRoutes(uint32_t node)
+{
+    NS_ASSERT_MSG(m_current < m_segments.size(), "No segment begun");
+    Segment& segment = m_segments[m_current];
+    NS_ASSERT_MSG(segment.node == NO_NODE || segment.node == node,
+                  "A segment installs routes on a single node");
+    segment.node = node;
+    return segment.routes;
+}
+
+void
+RouteTreeRecord::GetNodes(std::set<uint32_t>& nodes) const
+{
+    for (auto i = m_segments.begin(); i != m_segments.end(); i++)
+    {
+        if (i->node != NO_NODE)
+        {
+            nodes.insert(i->node);
+        }
+    }
+}
+
+std::size_t
+RouteTreeRecord::GetMemoryUsage() const
+{
+    std::size_t bytes = GetHashMapFootprint(m_vertices);
+    for (auto i = m_vertices.begin(); i != m_vertices.end(); i++)
+    {
+        bytes += (i->second.parents.capacity() + i->second.children.capacity()) * sizeof(uint32_t);
+        bytes += i->second.exits.capacity() * sizeof(Vertex::NodeExit_t);
+    }
+    bytes += m_segments.capacity() * sizeof(Segment);
+    for (auto i = m_segments.begin(); i != m_segments.end(); i++)
+    {
+        bytes += i->routes.GetMemoryUsage();
+    }
+    bytes += GetHashMapFootprint(m_segmentIndex);
+    return bytes;
+}
+
+void
+RouteTreeRecord::CollectRoutes(std::map<uint32_t, RouteBatch>& tables,
+                               const std::set<uint32_t>* nodes) const
+{
+    for (auto i = m_segments.begin(); i != m_segments.end(); i++)
+    {
+        if (i->node == NO_NODE || (nodes && !nodes->count(i->node)))
+        {
+            continue;
+        }
+        tables[i->node].Append(i->routes);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROUTE_TREE_RECORD_H
+#define ROUTE_TREE_RECORD_H
+
+#include "../datapath/lsdb.h"
+#include "../romam-routing.h"
+
+#include "ns3/ipv4-address.h"
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief What one SPF run left behind, kept to update its routes incrementally.
+ *
+ * The record holds the distance, parents and root exits of every vertex of the
+ * tree, and the routes the run added, split in segments by vertex and stage of
+ * the computation.  When the LSDB changes, IsAffected () tells whether the
+ * shortest paths of the tree may have changed.  If they did not, only the
+ * segments of the changed vertices have to be regenerated, from a vertex
+ * rebuilt with RestoreVertex ().
+ */
+class RouteTreeRecord
+{
+  public:
+    /// the step of the route computation that added a segment of routes
+    enum Stage
+    {
+        LOCAL,    //!< routes added before the SPF run
+        TRANSIT,  //!< routes added when the vertex joined the tree
+        STUB,     //!< routes to the stub networks of the vertex
+        EXTERNAL, //!< routes to the AS-external destinations advertised by the vertex
+        SUMMARY,  //!< routes to the other areas, through the vertex, an area border router
+    };
+
+    /**
+     * \param root the vertex ID of the root of the tree
+     */
+    RouteTreeRecord(Ipv4Address root);
+
+    /**
+     * \return the vertex ID of the root of the tree
+     */
+    Ipv4Address GetRoot() const;
+
+    /**
+     * \brief Mark the SPF run as short-circuited for a stub root.
+     */
+    void SetTruncated();
+
+    /**
+     * \brief Record a vertex that joined the tree, after its parents did.
+     * \param v the vertex
+     */
+    void AddVertex(const Vertex* v);
+
+    /**
+     * \brief Check whether the shortest paths of the tree may have changed.
+     * \param lsdb the updated LSDB
+     * \param changed the link state IDs of the changed LSAs
+     * \param excluded a vertex the SPF run never enters, or the root
+     * \return true if the tree has to be computed again
+     */
+    bool IsAffected(const LSDB* lsdb,
+                    const std::set<uint32_t>& changed,
+                    Ipv4Address excluded) const;
+
+    /**
+     * \param changed the link state IDs of the changed LSAs
+     * \return the changed vertices of the tree, except its root
+     */
+    std::vector<Ipv4Address> GetChangedVertices(const std::set<uint32_t>& changed) const;
+
+    /**
+     * \brief Give a vertex the distance and root exits it has in the tree.
+     * \param v a vertex built from the updated LSA of a vertex of the tree
+     */
+    void RestoreVertex(Vertex* v) const;
+
+    /**
+     * \brief Make a segment the one GetRoutes () adds to, creating it if needed.
+     * \param vertex the vertex the routes are computed from
+     * \param stage the step of the computation
+     */
+    void BeginSegment(Ipv4Address vertex, Stage stage);
+
+    /**
+     * \brief Remove the transit and stub routes of a vertex, keeping their place.
+     * \param vertex the vertex
+     */
+    void ClearSegments(Ipv4Address vertex);
+
+    /**
+     * \brief Get the routes of the current segment.
+     * \param node the ID of the node the routes are installed on
+     * \return the routes of the current segment
+     */
+    RouteBatch& GetRoutes(uint32_t node);
+
+    /**
+     * \brief Add the IDs of the nodes the tree installs routes on.
+     * \param nodes the set to add the node IDs to
+     */
+    void GetNodes(std::set<uint32_t>& nodes) const;
+
+    /**
+     * \brief Append the routes of the tree to per-node tables, in the order
+     * they were computed.
+     * \param tables the routes by node ID
+     * \param nodes the nodes to collect the routes of, or all of them if null
+     */
+    void CollectRoutes(std::map<uint32_t, RouteBatch>& tables,
+                       const std::set<uint32_t>* nodes) const;
+
+    /**
+     * \return the number of bytes the vertices and routes of the tree take
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    /// a vertex of the tree
+    struct VertexRecord
+    {
+        uint32_t distance;                     //!< distance from the root
+        bool network;                          //!< true for a network vertex
+        std::vector<uint32_t> parents;         //!< vertex IDs of the parents
+        std::vector<uint32_t> children;        //!< vertex IDs of the children
+        std::vector<Vertex::NodeExit_t> exits; //!< root exit directions
+    };
+
+    /// the routes added for one vertex at one stage
+    struct Segment
+    {
+        Ipv4Address vertex; //!< vertex the routes are computed from
+        Stage stage;        //!< step of the computation
+        uint32_t node;      //!< node the routes are installed on
+        RouteBatch routes;  //!< the routes
+    };
+
+    /**
+     * \param vertex the vertex
+     * \param stage the step of the computation
+     * \return the key of the segment in m_segmentIndex
+     */
+    static uint64_t GetSegmentKey(Ipv4Address vertex, Stage stage);
+
+    Ipv4Address m_root;                                    //!< root of the tree
+    bool m_truncated;                                      //!< the run stopped at a stub root
+    std::unordered_map<uint32_t, VertexRecord> m_vertices; //!< vertices by vertex ID
+    std::vector<Segment> m_segments;                       //!< routes, in computation order
+    std::unordered_map<uint64_t, uint32_t> m_segmentIndex; //!< segment by vertex and stage
+    uint32_t m_current;                                    //!< segment GetRoutes () adds to
+};
+
+} // namespace ns3
+
+#endif /* ROUTE_TREE_RECORD_H */
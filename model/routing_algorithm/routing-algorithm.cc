@@ -2,17 +2,108 @@
 
 #include "routing-algorithm.h"
 
+#include "../romam-routing.h"
+#include "../utility/phase-profiler.h"
+#include "../utility/romam-router.h"
+
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+
+#include <utility>
 
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("RoutingAlgorithm");
 
+RoutingAlgorithm::RoutingAlgorithm()
+    : m_tableCopy(nullptr)
+{
+}
+
 RoutingAlgorithm::~RoutingAlgorithm()
 {
     NS_LOG_LOGIC(this);
 }
 
+void
+RoutingAlgorithm::UpdateRoutes(const std::set<uint32_t>& changed)
+{
+    NS_LOG_FUNCTION(this << changed.size());
+    InitializeRoutes();
+}
+
+void
+RoutingAlgorithm::SetTableCopy(std::map<uint32_t, RouteBatch>* tables)
+{
+    m_tableCopy = tables;
+}
+
+void
+RoutingAlgorithm::InstallTable(uint32_t node, RouteBatch& routes)
+{
+    PhaseProfiler::Scope scope(PhaseProfiler::ROUTE_INSTALL);
+    Ptr<RomamRouter> router = NodeList::GetNode(node)->GetObject<RomamRouter>();
+    NS_ASSERT(router);
+    Ptr<RomamRouting> gr = router->GetRoutingProtocol();
+    NS_ASSERT(gr);
+    CapCandidates(node, routes);
+    NS_LOG_LOGIC("Updating node " << node << " to " << routes.GetN() << " routes");
+    gr->UpdateRoutes(routes);
+    gr->SetNPrunedRoutes(GetNPrunedCandidates(node));
+    if (m_tableCopy)
+    {
+        (*m_tableCopy)[node] = std::move(routes);
+    }
+}
+
+void
+RoutingAlgorithm::LoadCandidateCaps()
+{
+    m_candidateCaps.assign(NodeList::GetNNodes(), 0);
+    m_prunedCandidates.assign(NodeList::GetNNodes(), 0);
+    uint32_t systemId = Simulator::GetSystemId();
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouter> router = (*i)->GetObject<RomamRouter>();
+        if (router && router->GetRoutingProtocol() && (*i)->GetSystemId() == systemId)
+        {
+            m_candidateCaps[(*i)->GetId()] = router->GetRoutingProtocol()->GetMaxCandidates();
+        }
+    }
+}
+
+void
+RoutingAlgorithm::CapCandidates(uint32_t node, RouteBatch& routes)
+{
+    if (node < m_candidateCaps.size() && m_candidateCaps[node] > 0)
+    {
+        m_prunedCandidates[node] += routes.CapHostRoutes(m_candidateCaps[node]);
+    }
+}
+
+uint32_t
+RoutingAlgorithm::GetNPrunedCandidates(uint32_t node) const
+{
+    return node < m_prunedCandidates.size() ? m_prunedCandidates[node] : 0;
+}
+
+void
+RoutingAlgorithm::InstallEmptyTables(const std::vector<bool>& installed)
+{
+    uint32_t systemId = Simulator::GetSystemId();
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        uint32_t node = (*i)->GetId();
+        if ((node >= installed.size() || !installed[node]) &&
+            (*i)->GetSystemId() == systemId && (*i)->GetObject<RomamRouter>())
+        {
+            RouteBatch routes;
+            InstallTable(node, routes);
+        }
+    }
+}
+
 } // namespace ns3
@@ -3,14 +3,21 @@
 #ifndef ROUTING_ALGORITHM_H
 #define ROUTING_ALGORITHM_H
 
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <vector>
+
 namespace ns3
 {
 
 class LSDB;
+class RouteBatch;
 
 class RoutingAlgorithm
 {
   public:
+    RoutingAlgorithm();
     virtual ~RoutingAlgorithm();
     /**
      * @brief Delete all static routes on all nodes that have a
@@ -26,6 +33,72 @@ class RoutingAlgorithm
      * populate per-node forwarding tables
      */
     virtual void InitializeRoutes() = 0;
+
+    /**
+     * @brief Update the routes after the LSAs of some vertices changed
+     *
+     * The default computes all the routes again with InitializeRoutes (),
+     * which has to replace the tables it installs rather than add to them.
+     *
+     * \param changed the link state IDs of the changed LSAs
+     */
+    virtual void UpdateRoutes(const std::set<uint32_t>& changed);
+
+    /**
+     * \brief Copy the tables the engine installs on all the nodes at once.
+     *
+     * This is how RouteManager keeps the tables of a topology for a later
+     * simulation of it.
+     *
+     * \param tables set to the routes of every node by node ID on each full
+     * install, or null to not copy them
+     */
+    void SetTableCopy(std::map<uint32_t, RouteBatch>* tables);
+
+  protected:
+    /**
+     * \brief Install the table of a node computed by a full run, and move it
+     * to the tables of SetTableCopy ().
+     * \param node the node ID
+     * \param routes the table
+     */
+    void InstallTable(uint32_t node, RouteBatch& routes);
+
+    /**
+     * \brief Read the MaxCandidates cap of every local router, and set the
+     * candidates pruned from the tables to none, before a run.
+     *
+     * The caps are read on the simulator thread, so that the workers of a
+     * run cap the tables with CapCandidates () without the routers.
+     */
+    void LoadCandidateCaps();
+
+    /**
+     * \brief Keep the candidate routes of the table of a node within the cap
+     * of its router, see RouteBatch::CapHostRoutes ().  The tables of
+     * different nodes may be capped on different threads.
+     * \param node the node ID
+     * \param routes the table
+     */
+    void CapCandidates(uint32_t node, RouteBatch& routes);
+
+    /**
+     * \param node the node ID
+     * \return the candidates CapCandidates () pruned from the table of the
+     * node since LoadCandidateCaps ()
+     */
+    uint32_t GetNPrunedCandidates(uint32_t node) const;
+
+    /**
+     * \brief Give an empty table to the local routers a full run installed
+     * no table on.
+     * \param installed whether a table was installed, by node ID
+     */
+    void InstallEmptyTables(const std::vector<bool>& installed);
+
+    std::map<uint32_t, RouteBatch>* m_tableCopy; //!< where the installed tables go, if set
+    std::vector<uint32_t> m_candidateCaps;       //!< MaxCandidates of the routers, by node ID
+    std::vector<uint32_t> m_prunedCandidates;    //!< candidates pruned, by node ID
 };
 
 } // namespace ns3
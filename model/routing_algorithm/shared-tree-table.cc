@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shared-tree-table.h"
+
+#include "../datapath/lsdb.h"
+#include "../utility/memory-footprint.h"
+
+#include "ns3/log.h"
+
+#include <utility>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SharedTreeTable");
+
+SharedTreeTable::SharedTreeTable()
+    : m_lsdb(nullptr),
+      m_version(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+SharedTreeTable::Bind(const LSDB* lsdb)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (lsdb == m_lsdb && lsdb && lsdb->GetVersion() == m_version)
+    {
+        return;
+    }
+    NS_LOG_LOGIC("Dropping " << m_trees.size() << " trees of another LSDB");
+    m_trees.clear();
+    m_lsdb = lsdb;
+    m_version = lsdb ? lsdb->GetVersion() : 0;
+}
+
+const SharedTreeTable::Tree*
+SharedTreeTable::Find(Ipv4Address root) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_trees.find(root.Get());
+    return i == m_trees.end() ? nullptr : &i->second;
+}
+
+const SharedTreeTable::Tree*
+SharedTreeTable::Insert(Ipv4Address root, Tree&& tree)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // the elements of an unordered_map stay in place, so the tree can be read
+    // while others are added
+    return &m_trees.emplace(root.Get(), std::move(tree)).first->second;
+}
+
+void
+SharedTreeTable::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trees.clear();
+    m_lsdb = nullptr;
+    m_version = 0;
+}
+
+uint32_t
+SharedTreeTable::GetNTrees() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_trees.size();
+}
+
+std::size_t
+SharedTreeTable::GetMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t bytes = GetHashMapFootprint(m_trees);
+    for (auto i = m_trees.begin(); i != m_trees.end(); i++)
+    {
+        bytes += i->second.vertices.capacity() * sizeof(Tree::Entry);
+        for (auto j = i->second.vertices.begin(); j != i->second.vertices.end(); j++)
+        {
+            bytes += j->parents.capacity() * sizeof(uint32_t);
+        }
+    }
+    return bytes;
+}
+
+} // namespace ns3
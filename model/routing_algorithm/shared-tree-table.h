@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHARED_TREE_TABLE_H
+#define SHARED_TREE_TABLE_H
+
+#include "ns3/ipv4-address.h"
+
+#include <cstddef>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class LSDB;
+
+/**
+ * \brief The shortest path trees of the vertices of an LSDB over its whole
+ * graph, for the route engines computing from it to share.
+ *
+ * A tree lists the vertices in the order they joined it, with their distance
+ * from the root and their parents on the shortest paths, the vertex indices
+ * being the ones of the LSDBGraph of the LSDB.  DijkstraAlgorithm derives the
+ * routes of a router from the tree of the router, and SPFAlgorithm the trees
+ * of its forest from the trees of the neighbors of the router, so that the
+ * engines computing the routes of an LSDB version run one shortest path
+ * search per router between them, whichever runs first.
+ *
+ * The trees may be looked up and added from several threads.  The table
+ * takes O(n^2) memory for n vertices once it holds every tree.
+ */
+class SharedTreeTable
+{
+  public:
+    /// the shortest path tree of a vertex
+    struct Tree
+    {
+        /// a vertex of the tree
+        struct Entry
+        {
+            uint32_t vertex;               //!< vertex index in the graph
+            uint32_t distance;             //!< distance from the root
+            std::vector<uint32_t> parents; //!< indices of the parents in vertices
+        };
+
+        std::vector<Entry> vertices; //!< vertices in the order they joined the tree, root first
+    };
+
+    SharedTreeTable();
+
+    /**
+     * \brief Keep the trees of an LSDB only, removing them if they were
+     * computed from another LSDB or version.
+     * \param lsdb the database the next trees are computed from
+     */
+    void Bind(const LSDB* lsdb);
+
+    /**
+     * \param root the vertex ID of a root
+     * \return the tree of the root, or null if none was added
+     */
+    const Tree* Find(Ipv4Address root) const;
+
+    /**
+     * \brief Add the tree of a root, unless another thread added one first.
+     * \param root the vertex ID of the root
+     * \param tree the tree, moved from
+     * \return the tree of the root in the table
+     */
+    const Tree* Insert(Ipv4Address root, Tree&& tree);
+
+    /**
+     * \brief Remove all the trees.
+     */
+    void Clear();
+
+    /**
+     * \return the number of trees
+     */
+    uint32_t GetNTrees() const;
+
+    /**
+     * \return the number of bytes the trees take
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    mutable std::mutex m_mutex;                 //!< guards the trees
+    const LSDB* m_lsdb;                         //!< the LSDB the trees are computed from
+    uint64_t m_version;                         //!< version of m_lsdb
+    std::unordered_map<uint32_t, Tree> m_trees; //!< the trees by root vertex ID
+};
+
+} // namespace ns3
+
+#endif /* SHARED_TREE_TABLE_H */
@@ -6,6 +6,8 @@
 #include "../dgr-routing.h"
 #include "../utility/ddr-router.h"
 #include "../utility/dgr-router.h"
+#include "../utility/phase-profiler.h"
+#include "route-batch-queue.h"
 #include "route-candidate-queue.h"
 
 #include "ns3/assert.h"
@@ -17,10 +19,15 @@
 #include "ns3/node-list.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <iostream>
+#include <map>
 #include <queue>
+#include <set>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -30,19 +37,26 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE("SPFAlgorithm");
 
 SPFAlgorithm::SPFAlgorithm()
-    : m_spfroot(nullptr)
+    : m_spfroot(nullptr),
+      m_lsdb(nullptr),
+      m_epoch(0),
+      m_directory(nullptr),
+      m_areas(nullptr),
+      m_areasVersion(0),
+      m_rootArea(AreaDirectory::BACKBONE),
+      m_rootBackbone(true),
+      m_incremental(false),
+      m_threads(1),
+      m_shareTrees(false),
+      m_tree(nullptr),
+      m_sharedTrees(&m_localTrees)
 {
     NS_LOG_FUNCTION(this);
-    m_lsdb = new LSDB();
 }
 
 SPFAlgorithm::~SPFAlgorithm()
 {
     NS_LOG_FUNCTION(this);
-    if (m_lsdb)
-    {
-        delete m_lsdb;
-    }
 }
 
 void
@@ -58,25 +72,11 @@ SPFAlgorithm::DeleteRoutes()
             continue;
         }
         Ptr<RomamRouting> gr = router->GetRoutingProtocol();
-        uint32_t j = 0;
-        uint32_t nRoutes = gr->GetNRoutes();
         NS_LOG_LOGIC("Deleting " << gr->GetNRoutes() << " routes from node " << node->GetId());
-        // Each time we delete route 0, the route index shifts downward
-        // We can delete all routes if we delete the route numbered 0
-        // nRoutes times
-        for (j = 0; j < nRoutes; j++)
-        {
-            NS_LOG_LOGIC("Deleting route " << j << " from node " << node->GetId());
-            gr->RemoveRoute(0);
-        }
-        NS_LOG_LOGIC("Deleted " << j << " routes from node " << node->GetId());
-    }
-    if (m_lsdb)
-    {
-        NS_LOG_LOGIC("Deleting LSDB, creating new one");
-        delete m_lsdb;
-        m_lsdb = new LSDB();
+        gr->ClearRoutes();
     }
+    m_records.clear();
+    m_localTrees.Clear();
 }
 
 void
@@ -85,10 +85,69 @@ SPFAlgorithm::InsertLSDB(LSDB* lsdb)
     m_lsdb = lsdb;
 }
 
+void
+SPFAlgorithm::InsertRouterDirectory(const RouterDirectory* directory)
+{
+    m_directory = directory;
+}
+
+void
+SPFAlgorithm::InsertAreaDirectory(const AreaDirectory* areas)
+{
+    m_areas = areas;
+}
+
+void
+SPFAlgorithm::SetIncremental(bool incremental)
+{
+    m_incremental = incremental;
+    if (!incremental)
+    {
+        m_records.clear();
+    }
+}
+
+void
+SPFAlgorithm::ClearTrees()
+{
+    NS_LOG_FUNCTION(this);
+    m_records.clear();
+}
+
+void
+SPFAlgorithm::SetThreads(uint32_t nThreads)
+{
+    NS_LOG_FUNCTION(this << nThreads);
+    m_threads = nThreads > 0 ? nThreads : std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+void
+SPFAlgorithm::SetSharedTrees(bool shared)
+{
+    NS_LOG_FUNCTION(this << shared);
+    m_shareTrees = shared;
+    m_localTrees.Clear();
+}
+
+void
+SPFAlgorithm::InsertSharedTrees(SharedTreeTable* trees)
+{
+    NS_LOG_FUNCTION(this << trees);
+    m_sharedTrees = trees ? trees : &m_localTrees;
+}
+
 void
 SPFAlgorithm::InitializeRoutes()
 {
     NS_LOG_FUNCTION(this);
+    if (!m_directory)
+    {
+        m_localDirectory.Build();
+        m_directory = &m_localDirectory;
+    }
+    UpdateGraph();
+    m_records.clear();
+    m_localTrees.Clear();
     //
     // Walk the list of nodes in the system.
     //
@@ -109,119 +168,31 @@ SPFAlgorithm::InitializeRoutes()
 
         uint32_t systemId = Simulator::GetSystemId();
         // Ignore nodes that are not assigned to our systemId (distributed sim)
-        if (node->GetSystemId() != systemId)
+        if (!rtr || node->GetSystemId() != systemId)
         {
             continue;
         }
-        // -------- Initialize routing table --------------
-        //
-        // if the node has a DGR router interface, then run the DGR routing
-        // algorithms.
-        //
-        Vertex* v;
-        LSA* w_lsa = 0;
-        LinkRecord* l = 0;
-        uint32_t numRecordsInVertex = 0;
-        v = new Vertex(m_lsdb->GetLSA(rtr->GetRouterId()));
-        //
-        // V points to a Router-LSA or Network-LSA
-        // Loop over the links in router LSA or attached routers in Network LSA
-        //
-        if (v->GetVertexType() == Vertex::VertexRouter)
-        {
-            numRecordsInVertex = v->GetLSA()->GetNLinkRecords();
-        }
-        if (v->GetVertexType() == Vertex::VertexNetwork)
-        {
-            numRecordsInVertex = v->GetLSA()->GetNAttachedRouters();
-        }
-        for (uint32_t i = 0; i < numRecordsInVertex; i++)
+        m_records.emplace_back();
+        m_records.back().routerId = rtr->GetRouterId();
+    }
+    uint32_t nThreads = std::min<uint32_t>(m_threads, m_records.size());
+    if (nThreads > 1)
+    {
+        ComputeRootsInParallel(nThreads);
+    }
+    else
+    {
+        for (auto i = m_records.begin(); i != m_records.end(); i++)
         {
-            // std::cout << "i = " << i << std::endl;
-            if (v->GetVertexType() == Vertex::VertexRouter)
-            {
-                NS_LOG_LOGIC("Examining link " << i << " of " << v->GetVertexId() << "'s "
-                                               << v->GetLSA()->GetNLinkRecords()
-                                               << " link records");
-                //
-                // (a) If this is a link to a stub network, examine the next link in V's LSA.
-                // Links to stub networks will be considered in the second stage of the
-                // shortest path calculation.
-                //
-                l = v->GetLSA()->GetLinkRecord(i);
-                NS_ASSERT(l != 0);
-                if (l->GetLinkType() == LinkRecord::StubNetwork)
-                {
-                    NS_LOG_LOGIC("Found a Stub record to " << l->GetLinkId());
-                    continue;
-                }
-                //
-                // (b) Otherwise, W is a transit vertex (router or transit network).  Look up
-                // the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
-                // database.
-                //
-                if (l->GetLinkType() == LinkRecord::PointToPoint)
-                {
-                    //
-                    // Lookup the link state advertisement of the new link -- we call it <w> in
-                    // the link state database.
-                    //
-                    w_lsa = m_lsdb->GetLSA(l->GetLinkId());
-                    NS_ASSERT(w_lsa);
-                    NS_LOG_LOGIC("Found a P2P record from " << v->GetVertexId() << " to "
-                                                            << w_lsa->GetLinkStateId());
-                    Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
-                    if (!router)
-                    {
-                        continue;
-                    }
-                    Ptr<RomamRouting> routing = router->GetRoutingProtocol();
-                    NS_ASSERT(routing);
-                    LinkRecord* linkRemote = 0;
-                    Vertex* w = new Vertex(w_lsa);
-                    linkRemote = SPFGetNextLink(w, v, linkRemote);
-                    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-                    int32_t Iface = ipv4->GetInterfaceForAddress(l->GetLinkData());
-
-                    for (auto j = NodeList::Begin(); j != NodeList::End(); j++)
-                    {
-                        Ptr<Node> nextNode = *j;
-                        Ptr<Ipv4> nextIpv4 = nextNode->GetObject<Ipv4>();
-                        for (uint32_t iter = 0; iter < nextIpv4->GetNInterfaces(); iter++)
-                        {
-                            Ipv4InterfaceAddress ifc = nextIpv4->GetAddress(iter, 0);
-                            Ipv4Address addr = ifc.GetLocal();
-                            if (addr == linkRemote->GetLinkData())
-                            {
-                                for (uint32_t nIfc = 1; nIfc < nextIpv4->GetNInterfaces(); nIfc++)
-                                {
-                                    routing->AddHostRouteTo(
-                                        nextIpv4->GetAddress(nIfc, 0).GetLocal(),
-                                        linkRemote->GetLinkData(),
-                                        Iface,
-                                        -1,
-                                        l->GetMetric());
-                                }
-                            }
-                        }
-                    }
-                    SPFCalculate(w_lsa->GetLinkStateId(), rtr->GetRouterId(), linkRemote, Iface);
-                }
-                else if (l->GetLinkType() == LinkRecord::TransitNetwork)
-                {
-                    w_lsa = m_lsdb->GetLSA(l->GetLinkId());
-                    NS_ASSERT(w_lsa);
-                    NS_LOG_LOGIC("Found a Transit record from " << v->GetVertexId() << " to "
-                                                                << w_lsa->GetLinkStateId());
-                    SPFCalculate(w_lsa->GetLinkStateId(), rtr->GetRouterId(), l, i + 1);
-                }
-                else
-                {
-                    NS_ASSERT_MSG(0, "illegal Link Type");
-                }
-            }
+            ComputeRoot(*i, nullptr, nullptr, nullptr);
         }
+        InstallTables(nullptr);
+    }
+    if (!m_incremental)
+    {
+        m_records.clear();
     }
+    m_localTrees.Clear();
     // auto end = std::chrono::system_clock::now();
     // int64_t end_microseconds =
     //     std::chrono::duration_cast<std::chrono::microseconds>(end.time_since_epoch()).count();
@@ -235,28 +206,213 @@ SPFAlgorithm::InitializeRoutes()
     NS_LOG_INFO("Finished Shortest Path Forest calculation");
 }
 
-//
-// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section
-// 16.1 (2) for further details.
-//
-// We're passed a parameter <v> that is a vertex which is already in the SPF
-// tree.  A vertex represents a router node.  We also get a reference to the
-// SPF candidate queue, which is a priority queue containing the shortest paths
-// to the networks we know about.
-//
-// We examine the links in v's LSA and update the list of candidates with any
-// vertices not already on the list.  If a lower-cost path is found to a
-// vertex already on the candidate list, store the new (lower) cost.
-//
 void
-SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
+SPFAlgorithm::InitializeRoutes(Ipv4Address routerId)
 {
-    NS_LOG_FUNCTION(this << v << &candidate);
+    NS_LOG_FUNCTION(this << routerId);
+    if (m_lsdb == nullptr)
+    {
+        NS_LOG_LOGIC("Empty LSDB, please insert LSDB.");
+        return;
+    }
+    UpdateGraph();
+    if (!m_directory)
+    {
+        m_localDirectory.Build();
+        m_directory = &m_localDirectory;
+    }
+    if (m_graph.GetVertex(routerId) == LSDBGraph::NO_VERTEX)
+    {
+        NS_LOG_LOGIC("No LSA for router " << routerId);
+        return;
+    }
+    NS_ASSERT_MSG(!m_incremental, "Only a full engine computes the routes of one router");
+    m_records.clear();
+    m_records.emplace_back();
+    m_records.back().routerId = routerId;
+    ComputeRoot(m_records.back(), nullptr, nullptr, nullptr);
+    m_localTrees.Clear();
+    std::set<uint32_t> nodes;
+    nodes.insert(m_directory->GetNodeIdByRouterId(routerId));
+    InstallTables(&nodes);
+    m_records.clear();
+}
 
-    Vertex* w = nullptr;
-    LSA* w_lsa = nullptr;
-    LinkRecord* l = nullptr;
-    uint32_t distance = 0;
+void
+SPFAlgorithm::UpdateRoutes(const std::set<uint32_t>& changed)
+{
+    NS_LOG_FUNCTION(this << changed.size());
+    if (m_records.empty())
+    {
+        NS_LOG_LOGIC("No SPF trees kept, computing all the routes");
+        InitializeRoutes();
+        return;
+    }
+    UpdateGraph();
+    std::unordered_map<uint32_t, RootRecord> previous;
+    for (auto i = m_records.begin(); i != m_records.end(); i++)
+    {
+        previous[i->routerId.Get()] = std::move(*i);
+    }
+    m_records.clear();
+    m_localTrees.Clear();
+
+    std::set<uint32_t> nodes;
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<Node> node = *i;
+        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
+        uint32_t systemId = Simulator::GetSystemId();
+        if (!rtr || node->GetSystemId() != systemId)
+        {
+            continue;
+        }
+        m_records.emplace_back();
+        m_records.back().routerId = rtr->GetRouterId();
+        auto old = previous.find(rtr->GetRouterId().Get());
+        if (old == previous.end())
+        {
+            ComputeRoot(m_records.back(), nullptr, &changed, &nodes);
+        }
+        else
+        {
+            ComputeRoot(m_records.back(), &old->second, &changed, &nodes);
+            previous.erase(old);
+        }
+    }
+    // routers that left the simulation
+    for (auto i = previous.begin(); i != previous.end(); i++)
+    {
+        for (auto j = i->second.trees.begin(); j != i->second.trees.end(); j++)
+        {
+            j->GetNodes(nodes);
+        }
+    }
+    InstallTables(&nodes);
+    NS_LOG_INFO("Finished incremental Shortest Path Forest update");
+}
+
+void
+SPFAlgorithm::ComputeRootsInParallel(uint32_t nThreads)
+{
+    NS_LOG_FUNCTION(this << nThreads);
+    //
+    // The SPF runs only read the LSDB, so the workers share it; each keeps the
+    // SPF status of the vertices, its root pointer and tree record itself.
+    // The roots are handed out one at a time and every worker writes to the
+    // records of its roots only.  The table of a root is pushed to a queue as
+    // soon as its trees are done, and the trees freed unless the engine keeps
+    // them; the simulator thread, which computes roots too, installs the
+    // tables of the queue between its roots, so only the trees being computed
+    // and the tables not installed yet are held at a time.  The shared trees
+    // go to the table of this engine, which the workers look up and add to
+    // under its lock.
+    //
+    // the workers are kept, so their graph and vertex storage outlive the run
+    while (m_workers.size() < nThreads - 1)
+    {
+        m_workers.emplace_back(new SPFAlgorithm());
+    }
+    LoadCandidateCaps();
+    std::atomic<uint32_t> next(0);
+    RouteBatchQueue queue;
+    auto compute = [this, &next, &queue](SPFAlgorithm* engine) {
+        uint32_t k = next++;
+        if (k >= m_records.size())
+        {
+            return false;
+        }
+        RootRecord& record = m_records[k];
+        engine->ComputeRoot(record, nullptr, nullptr, nullptr);
+        std::map<uint32_t, RouteBatch> tables;
+        for (auto j = record.trees.begin(); j != record.trees.end(); j++)
+        {
+            j->CollectRoutes(tables, nullptr);
+        }
+        if (!m_incremental)
+        {
+            std::vector<RouteTreeRecord>().swap(record.trees);
+        }
+        for (auto i = tables.begin(); i != tables.end(); i++)
+        {
+            // capped before it waits in the queue, which then holds no more
+            CapCandidates(i->first, i->second);
+            queue.Push(i->first, std::move(i->second));
+        }
+        queue.Complete();
+        return true;
+    };
+    auto work = [this, &compute](SPFAlgorithm* worker) {
+        worker->m_lsdb = m_lsdb;
+        worker->m_areas = m_areas;
+        worker->UpdateGraph();
+        worker->m_directory = m_directory;
+        worker->m_shareTrees = m_shareTrees;
+        worker->m_sharedTrees = m_sharedTrees;
+        while (compute(worker))
+        {
+        }
+        worker->m_sharedTrees = &worker->m_localTrees;
+    };
+    std::vector<std::thread> workers;
+    for (uint32_t i = 0; i < nThreads - 1; i++)
+    {
+        workers.emplace_back(work, m_workers[i].get());
+    }
+
+    if (m_tableCopy)
+    {
+        m_tableCopy->clear();
+    }
+    std::vector<bool> installed(NodeList::GetNNodes(), false);
+    auto install = [this, &installed](uint32_t node, RouteBatch& routes) {
+        // a table replaces the routes of the node, so a node has one
+        NS_ASSERT_MSG(!installed[node], "Two tables computed for node " << node);
+        installed[node] = true;
+        InstallTable(node, routes);
+    };
+    while (compute(this))
+    {
+        queue.Drain(install);
+    }
+    // sleep until the workers push tables or complete their last roots
+    while (queue.WaitForTables(m_records.size()))
+    {
+        queue.Drain(install);
+    }
+    for (auto i = workers.begin(); i != workers.end(); i++)
+    {
+        i->join();
+    }
+    queue.Drain(install);
+    InstallEmptyTables(installed);
+}
+
+void
+SPFAlgorithm::ComputeRoot(RootRecord& record,
+                          RootRecord* previous,
+                          const std::set<uint32_t>* changed,
+                          std::set<uint32_t>* nodes)
+{
+    NS_LOG_FUNCTION(this << record.routerId);
+    Ipv4Address routerId = record.routerId;
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(routerId);
+    //
+    // The trees of the root can only be kept if the links of the root did not
+    // change, they are then computed from the same links in the same order.
+    //
+    bool reuse = previous && !changed->count(record.routerId.Get());
+    std::vector<bool> reused(previous ? previous->trees.size() : 0, false);
+    // -------- Initialize routing table --------------
+    //
+    // if the node has a DGR router interface, then run the DGR routing
+    // algorithms.
+    //
+    Vertex root(m_graph.GetLSA(routerId));
+    Vertex* v = &root;
+    SetRootAreas(routerId);
+    LSA* w_lsa = 0;
+    const LinkRecord* l = 0;
     uint32_t numRecordsInVertex = 0;
     //
     // V points to a Router-LSA or Network-LSA
@@ -270,10 +426,9 @@ SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
     {
         numRecordsInVertex = v->GetLSA()->GetNAttachedRouters();
     }
-
     for (uint32_t i = 0; i < numRecordsInVertex; i++)
     {
-        // Get w_lsa:  In case of V is Router-LSA
+        // std::cout << "i = " << i << std::endl;
         if (v->GetVertexType() == Vertex::VertexRouter)
         {
             NS_LOG_LOGIC("Examining link " << i << " of " << v->GetVertexId() << "'s "
@@ -284,12 +439,19 @@ SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
             // shortest path calculation.
             //
             l = v->GetLSA()->GetLinkRecord(i);
-            NS_ASSERT(l != nullptr);
+            NS_ASSERT(l != 0);
             if (l->GetLinkType() == LinkRecord::StubNetwork)
             {
                 NS_LOG_LOGIC("Found a Stub record to " << l->GetLinkId());
                 continue;
             }
+            // no tree grows from a neighbor out of the areas of the root
+            uint32_t neighbor = m_graph.GetVertex(l->GetLinkId());
+            if (neighbor != LSDBGraph::NO_VERTEX && !IsInRootAreas(neighbor))
+            {
+                NS_LOG_LOGIC("Skipping the link to " << l->GetLinkId() << " out of the area");
+                continue;
+            }
             //
             // (b) Otherwise, W is a transit vertex (router or transit network).  Look up
             // the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
@@ -301,33 +463,340 @@ SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
                 // Lookup the link state advertisement of the new link -- we call it <w> in
                 // the link state database.
                 //
-                w_lsa = m_lsdb->GetLSA(l->GetLinkId());
+                w_lsa = m_graph.GetLSA(l->GetLinkId());
                 NS_ASSERT(w_lsa);
                 NS_LOG_LOGIC("Found a P2P record from " << v->GetVertexId() << " to "
                                                         << w_lsa->GetLinkStateId());
+                const LinkRecord* linkRemote = 0;
+                Vertex w(w_lsa);
+                linkRemote = SPFGetNextLink(&w, v, linkRemote);
+                int32_t Iface = m_directory->GetInterfaceForAddress(l->GetLinkData());
+
+                uint32_t k = record.trees.size();
+                if (reuse && k < previous->trees.size() &&
+                    previous->trees[k].GetRoot() == w_lsa->GetLinkStateId() &&
+                    !previous->trees[k].IsAffected(m_lsdb, *changed, routerId))
+                {
+                    reused[k] = true;
+                    record.trees.push_back(std::move(previous->trees[k]));
+                    PatchTree(record.trees.back(), routerId, linkRemote, Iface, *changed);
+                    record.trees.back().GetNodes(*nodes);
+                    continue;
+                }
+                record.trees.emplace_back(w_lsa->GetLinkStateId());
+                m_tree = &record.trees.back();
+                m_tree->BeginSegment(w_lsa->GetLinkStateId(), RouteTreeRecord::LOCAL);
+
+                Ipv4Address remote = linkRemote->GetLinkData();
+                uint32_t nextNodeId = m_directory->GetNodeIdByAddress(remote);
+                Ipv4Address loopback = nextNodeId != RouterDirectory::NO_NODE
+                                           ? m_directory->GetLoopback(nextNodeId)
+                                           : Ipv4Address::GetAny();
+                if (loopback != Ipv4Address::GetAny())
+                {
+                    // the stub of the loopback is on the root of the tree
+                    m_tree->GetRoutes(nodeId)
+                        .AddHostRouteTo(loopback, remote, Iface, -1, l->GetMetric());
+                }
+                else if (nextNodeId != RouterDirectory::NO_NODE)
+                {
+                    uint32_t nInterfaces = m_directory->GetNInterfaces(nextNodeId);
+                    for (uint32_t nIfc = 1; nIfc < nInterfaces; nIfc++)
+                    {
+                        m_tree->GetRoutes(nodeId)
+                            .AddHostRouteTo(m_directory->GetAddress(nextNodeId, nIfc, 0).GetLocal(),
+                                            remote,
+                                            Iface,
+                                            -1,
+                                            l->GetMetric());
+                    }
+                }
+                SPFCalculate(w_lsa->GetLinkStateId(), routerId, linkRemote, Iface);
             }
             else if (l->GetLinkType() == LinkRecord::TransitNetwork)
             {
-                w_lsa = m_lsdb->GetLSA(l->GetLinkId());
+                w_lsa = m_graph.GetLSA(l->GetLinkId());
                 NS_ASSERT(w_lsa);
                 NS_LOG_LOGIC("Found a Transit record from " << v->GetVertexId() << " to "
                                                             << w_lsa->GetLinkStateId());
+                uint32_t k = record.trees.size();
+                if (reuse && k < previous->trees.size() &&
+                    previous->trees[k].GetRoot() == w_lsa->GetLinkStateId() &&
+                    !previous->trees[k].IsAffected(m_lsdb, *changed, routerId))
+                {
+                    reused[k] = true;
+                    record.trees.push_back(std::move(previous->trees[k]));
+                    PatchTree(record.trees.back(), routerId, l, i + 1, *changed);
+                    record.trees.back().GetNodes(*nodes);
+                    continue;
+                }
+                record.trees.emplace_back(w_lsa->GetLinkStateId());
+                m_tree = &record.trees.back();
+                SPFCalculate(w_lsa->GetLinkStateId(), routerId, l, i + 1);
             }
             else
             {
                 NS_ASSERT_MSG(0, "illegal Link Type");
             }
+            if (nodes)
+            {
+                m_tree->GetNodes(*nodes);
+            }
+            m_tree = nullptr;
+        }
+    }
+    for (uint32_t k = 0; k < reused.size(); k++)
+    {
+        if (!reused[k])
+        {
+            previous->trees[k].GetNodes(*nodes);
+        }
+    }
+}
+
+void
+SPFAlgorithm::PatchTree(RouteTreeRecord& tree,
+                        Ipv4Address initroot,
+                        const LinkRecord* l,
+                        uint32_t Iface,
+                        const std::set<uint32_t>& changed)
+{
+    NS_LOG_FUNCTION(this << tree.GetRoot() << initroot);
+    std::vector<Ipv4Address> vertices = tree.GetChangedVertices(changed);
+    if (vertices.empty())
+    {
+        return;
+    }
+    //
+    // The shortest paths of the tree did not change, so the vertices keep their
+    // distance and root exits; only the routes derived from the links of the
+    // changed vertices have to be regenerated.
+    //
+    Vertex root(m_graph.GetLSA(tree.GetRoot()));
+    Vertex init(m_graph.GetLSA(initroot));
+    m_spfroot = &root;
+    m_tree = &tree;
+    for (auto i = vertices.begin(); i != vertices.end(); i++)
+    {
+        NS_LOG_LOGIC("Regenerating the routes of vertex " << *i);
+        Vertex v(m_graph.GetLSA(*i));
+        tree.RestoreVertex(&v);
+        tree.ClearSegments(*i);
+        tree.BeginSegment(*i, RouteTreeRecord::TRANSIT);
+        SPFIntraAddRouter(&v, &init, l->GetLinkData(), Iface);
+        tree.BeginSegment(*i, RouteTreeRecord::STUB);
+        SPFIntraAddStubs(&v, m_graph.GetVertex(*i));
+    }
+    m_tree = nullptr;
+    m_spfroot = nullptr;
+}
+
+void
+SPFAlgorithm::UpdateGraph()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_graph.IsCurrent(m_lsdb))
+    {
+        m_graph.Build(m_lsdb);
+        m_statusEpochs.assign(m_graph.GetNVertices(), 0);
+        m_status.assign(m_graph.GetNVertices(), LSA::LSA_SPF_NOT_EXPLORED);
+        m_epoch = 0;
+        m_areasVersion = 0;
+    }
+    if (!m_areas || !m_areas->IsEnabled())
+    {
+        m_vertexAreas.clear();
+        m_vertexBackbone.clear();
+        m_areasVersion = 0;
+    }
+    else if (m_areasVersion != m_areas->GetVersion())
+    {
+        m_areas->Classify(m_graph, m_vertexAreas, m_vertexBackbone);
+        m_areasVersion = m_areas->GetVersion();
+    }
+    m_sharedTrees->Bind(m_lsdb);
+}
+
+void
+SPFAlgorithm::SetRootAreas(Ipv4Address root)
+{
+    uint32_t index = m_graph.GetVertex(root);
+    if (!m_vertexAreas.empty() && index != LSDBGraph::NO_VERTEX)
+    {
+        m_rootArea = m_vertexAreas[index];
+        m_rootBackbone = m_vertexBackbone[index] != 0;
+    }
+}
+
+bool
+SPFAlgorithm::IsInRootAreas(uint32_t v) const
+{
+    return m_vertexAreas.empty() || m_vertexAreas[v] == m_rootArea ||
+           (m_rootBackbone && m_vertexBackbone[v]);
+}
+
+void
+SPFAlgorithm::ResetStatus()
+{
+    if (++m_epoch == 0)
+    {
+        // the epochs wrapped around, so the oldest stamps could look current
+        std::fill(m_statusEpochs.begin(), m_statusEpochs.end(), 0);
+        m_epoch = 1;
+    }
+}
+
+LSA::SPFStatus
+SPFAlgorithm::GetStatus(uint32_t v) const
+{
+    return m_statusEpochs[v] == m_epoch ? m_status[v] : LSA::LSA_SPF_NOT_EXPLORED;
+}
+
+void
+SPFAlgorithm::SetStatus(uint32_t v, LSA::SPFStatus status)
+{
+    NS_ASSERT(v < m_status.size());
+    m_statusEpochs[v] = m_epoch;
+    m_status[v] = status;
+}
+
+std::size_t
+SPFAlgorithm::GetMemoryUsage() const
+{
+    std::size_t bytes = m_graph.GetMemoryUsage() + m_vertices.GetMemoryUsage();
+    bytes += m_statusEpochs.capacity() * sizeof(uint32_t) +
+             m_status.capacity() * sizeof(LSA::SPFStatus);
+    bytes += m_vertexAreas.capacity() * sizeof(uint32_t) + m_vertexBackbone.capacity();
+    bytes += m_treeRouters.capacity() * sizeof(uint32_t) +
+             m_routerVertices.capacity() * sizeof(Vertex*);
+    bytes += m_records.capacity() * sizeof(m_records[0]);
+    for (auto i = m_records.begin(); i != m_records.end(); i++)
+    {
+        bytes += i->trees.capacity() * sizeof(RouteTreeRecord);
+        for (auto j = i->trees.begin(); j != i->trees.end(); j++)
+        {
+            bytes += j->GetMemoryUsage();
+        }
+    }
+    // a table inserted is counted by its owner
+    bytes += m_localTrees.GetMemoryUsage();
+    for (auto i = m_workers.begin(); i != m_workers.end(); i++)
+    {
+        bytes += sizeof(**i) + (*i)->GetMemoryUsage();
+    }
+    return bytes;
+}
+
+void
+SPFAlgorithm::InstallTables(const std::set<uint32_t>* nodes)
+{
+    NS_LOG_FUNCTION(this);
+    PhaseProfiler::Scope scope(PhaseProfiler::ROUTE_INSTALL);
+    LoadCandidateCaps();
+    std::map<uint32_t, RouteBatch> tables;
+    std::map<uint32_t, RouteBatch> rootTables;
+    for (auto i = m_records.begin(); i != m_records.end(); i++)
+    {
+        // the table of a root is capped before the next one is collected
+        rootTables.clear();
+        for (auto j = i->trees.begin(); j != i->trees.end(); j++)
+        {
+            j->CollectRoutes(rootTables, nodes);
+        }
+        for (auto j = rootTables.begin(); j != rootTables.end(); j++)
+        {
+            NS_ASSERT_MSG(!tables.count(j->first), "Two tables computed for node " << j->first);
+            CapCandidates(j->first, j->second);
+            tables[j->first] = std::move(j->second);
+        }
+    }
+    // the nodes that lost all their routes get an empty table
+    if (nodes)
+    {
+        for (auto i = nodes->begin(); i != nodes->end(); i++)
+        {
+            tables[*i];
+        }
+    }
+    else
+    {
+        uint32_t systemId = Simulator::GetSystemId();
+        for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+        {
+            if ((*i)->GetSystemId() == systemId && (*i)->GetObject<RomamRouter>())
+            {
+                tables[(*i)->GetId()];
+            }
         }
-        // Get w_lsa:  In case of V is Network-LSA
-        if (v->GetVertexType() == Vertex::VertexNetwork)
+    }
+    // the nodes only change the routes that differ from the ones they hold
+    for (auto i = tables.begin(); i != tables.end(); i++)
+    {
+        Ptr<RomamRouter> router = NodeList::GetNode(i->first)->GetObject<RomamRouter>();
+        NS_ASSERT(router);
+        Ptr<RomamRouting> gr = router->GetRoutingProtocol();
+        NS_ASSERT(gr);
+        NS_LOG_LOGIC("Updating node " << i->first << " to " << i->second.GetN() << " routes");
+        gr->UpdateRoutes(i->second);
+        gr->SetNPrunedRoutes(GetNPrunedCandidates(i->first));
+    }
+    if (m_tableCopy && !nodes)
+    {
+        m_tableCopy->swap(tables);
+    }
+}
+
+//
+// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section
+// 16.1 (2) for further details.
+//
+// We're passed a parameter <v> that is a vertex which is already in the SPF
+// tree.  A vertex represents a router node.  We also get a reference to the
+// SPF candidate queue, which is a priority queue containing the shortest paths
+// to the networks we know about.
+//
+// We examine the links in v's LSA and update the list of candidates with any
+// vertices not already on the list.  If a lower-cost path is found to a
+// vertex already on the candidate list, store the new (lower) cost.
+//
+void
+SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
+{
+    NS_LOG_FUNCTION(this << v << &candidate);
+
+    Vertex* w = nullptr;
+    LSA* w_lsa = nullptr;
+    uint32_t distance = 0;
+    //
+    // V points to a Router-LSA or Network-LSA
+    // Loop over the edges the graph keeps for it, in the order of the LSA: the
+    // point-to-point and transit network records of a router LSA, or the
+    // routers attached to a network LSA.
+    //
+    // (a) Links to stub networks are not edges of the graph.  They will be
+    // considered in the second stage of the shortest path calculation.
+    //
+    uint32_t index = m_graph.GetVertex(v->GetVertexId());
+    NS_ASSERT_MSG(index != LSDBGraph::NO_VERTEX, "No LSA for vertex " << v->GetVertexId());
+    for (uint32_t e = m_graph.GetEdgesBegin(index); e < m_graph.GetEdgesEnd(index); e++)
+    {
+        //
+        // (b) W is a transit vertex (router or transit network), or a router
+        // attached to the network V.  Its LSA is the target of the edge.
+        //
+        uint32_t target = m_graph.GetTarget(e);
+        w_lsa = m_graph.GetLSA(target);
+        NS_LOG_LOGIC("Found a link from " << v->GetVertexId() << " to "
+                                          << w_lsa->GetLinkStateId());
+        //
+        // With areas, the tree does not leave the areas of the router it is
+        // computed for: the other areas are reached through the summaries of
+        // the border routers.
+        //
+        if (!IsInRootAreas(target))
         {
-            w_lsa = m_lsdb->GetLSAByLinkData(v->GetLSA()->GetAttachedRouter(i));
-            if (!w_lsa)
-            {
-                continue;
-            }
-            NS_LOG_LOGIC("Found a Network LSA from " << v->GetVertexId() << " to "
-                                                     << w_lsa->GetLinkStateId());
+            NS_LOG_LOGIC("Skipping ->  LSA " << w_lsa->GetLinkStateId() << " out of the area");
+            continue;
         }
 
         // Note:  w_lsa at this point may be either RouterLSA or NetworkLSA
@@ -338,7 +807,7 @@ SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
         // If the link is to a router that is already in the shortest path first tree
         // then we have it covered -- ignore it.
         //
-        if (w_lsa->GetStatus() == LSA::LSA_SPF_IN_SPFTREE)
+        if (GetStatus(target) == LSA::LSA_SPF_IN_SPFTREE)
         {
             NS_LOG_LOGIC("Skipping ->  LSA " << w_lsa->GetLinkStateId() << " already in SPF tree");
             continue;
@@ -349,20 +818,14 @@ SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
         // calculated) shortest path to vertex V and the advertised cost of the link
         // between vertices V and W.
         //
-        if (v->GetLSA()->GetLSType() == LSA::RouterLSA)
-        {
-            NS_ASSERT(l != nullptr);
-            distance = v->GetDistanceFromRoot() + l->GetMetric();
-        }
-        else
-        {
-            distance = v->GetDistanceFromRoot();
-        }
+        // The edges leaving a network have a metric of 0.
+        //
+        distance = v->GetDistanceFromRoot() + m_graph.GetMetric(e);
 
         NS_LOG_LOGIC("Considering w_lsa " << w_lsa->GetLinkStateId());
 
         // Is there already vertex w in candidate list?
-        if (w_lsa->GetStatus() == LSA::LSA_SPF_NOT_EXPLORED)
+        if (GetStatus(target) == LSA::LSA_SPF_NOT_EXPLORED)
         {
             // Calculate nexthop to w
             // We need to figure out how to actually get to the new router represented
@@ -371,10 +834,10 @@ SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
             // used to forward the packets.
 
             // prepare vertex w
-            w = new Vertex(w_lsa);
-            if (SPFNexthopCalculation(v, w, l, distance))
+            w = m_vertices.Allocate(w_lsa);
+            if (SPFNexthopCalculation(v, w, e, distance))
             {
-                w_lsa->SetStatus(LSA::LSA_SPF_CANDIDATE);
+                SetStatus(target, LSA::LSA_SPF_CANDIDATE);
                 //
                 // Push this new vertex onto the priority queue (ordered by distance from the
                 // root node).
@@ -390,7 +853,7 @@ SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
                               "SPFNexthopCalculation never " << "return false, but it does now!");
             }
         }
-        else if (w_lsa->GetStatus() == LSA::LSA_SPF_CANDIDATE)
+        else if (GetStatus(target) == LSA::LSA_SPF_CANDIDATE)
         {
             //
             // We have already considered the link represented by <w>.  What wse have to
@@ -435,16 +898,11 @@ SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
                 // (ospf_spf.c::859), although the detail implementation
                 // is very different from quagga (blame ns3::SPFAlgorithm)
 
-                // prepare vertex w
-                w = new Vertex(w_lsa);
-                SPFNexthopCalculation(v, w, l, distance);
+                // prepare vertex w; the arena releases it along with the tree
+                w = m_vertices.Allocate(w_lsa);
+                SPFNexthopCalculation(v, w, e, distance);
                 cw->MergeRootExitDirections(w);
                 cw->MergeParent(w);
-                // SPFVertexAddParent (w) is necessary as the destructor of
-                // SPFVertex checks if the vertex and its parent is linked
-                // bidirectionally
-                SPFVertexAddParent(w);
-                delete w;
             }
             else // cw->GetDistanceFromRoot () > w->GetDistanceFromRoot ()
             {
@@ -456,13 +914,13 @@ SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
                 // N.B. the nexthop_calculation is conditional, if it finds a valid nexthop
                 // it will call spf_add_parents, which will flush the old parents
                 //
-                if (SPFNexthopCalculation(v, cw, l, distance))
+                if (SPFNexthopCalculation(v, cw, e, distance))
                 {
                     //
                     // If we've changed the cost to get to the vertex represented by <w>, we
                     // must reorder the priority queue keyed to that cost.
                     //
-                    candidate.Reorder();
+                    candidate.Update(cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -480,9 +938,9 @@ SPFAlgorithm::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
 // For now, this is greatly simplified from the quagga code
 //
 int
-SPFAlgorithm::SPFNexthopCalculation(Vertex* v, Vertex* w, LinkRecord* l, uint32_t distance)
+SPFAlgorithm::SPFNexthopCalculation(Vertex* v, Vertex* w, uint32_t e, uint32_t distance)
 {
-    NS_LOG_FUNCTION(this << v << w << l << distance);
+    NS_LOG_FUNCTION(this << v << w << e << distance);
     //
     // If w is a NetworkVertex, l should be null
     /*
@@ -536,31 +994,30 @@ SPFAlgorithm::SPFNexthopCalculation(Vertex* v, Vertex* w, LinkRecord* l, uint32_
             // address -- the next hop address to get from <v> to <w> and all networks
             // accessed through that path.
             //
-            // SPFGetNextLink () is a little odd.  used in this way it is just going to
-            // return the link record describing the link from <w> to <v>.  Think of it as
-            // SPFGetLink.
+            // The graph keeps, for each edge, the first edge leading back from its
+            // target: here the link from <w> to <v>.
             //
-            NS_ASSERT(l);
-            LinkRecord* linkRemote = nullptr;
-            linkRemote = SPFGetNextLink(w, v, linkRemote);
+            NS_ASSERT(m_graph.GetLinkRecord(e));
+            uint32_t remote = m_graph.GetReverse(e);
+            NS_ASSERT_MSG(remote != LSDBGraph::NO_EDGE, "No link back to " << v->GetVertexId());
             //
-            // At this point, <l> is the Romam Router Link Record describing the point-
-            // to point link from <v> to <w> from the perspective of <v>; and <linkRemote>
-            // is the Romam Router Link Record describing that same link from the
-            // perspective of <w> (back to <v>).  Now we can just copy the next hop
-            // address from the m_linkData member variable.
+            // At this point, <e> is the edge describing the point-to point link from
+            // <v> to <w> from the perspective of <v>; and <remote> is the edge
+            // describing that same link from the perspective of <w> (back to <v>).
+            // Now we can just copy the next hop address from the link data of the
+            // edge.
             //
             // The next hop member variable we put in <w> has the sense "in order to get
             // from the root node to the host represented by vertex <w>, you have to send
             // the packet to the next hop address specified in w->m_nextHop.
             //
-            Ipv4Address nextHop = linkRemote->GetLinkData();
+            Ipv4Address nextHop = m_graph.GetLinkData(remote);
             //
             // Now find the outgoing interface corresponding to the point to point link
-            // from the perspective of <v> -- remember that <l> is the link "from"
+            // from the perspective of <v> -- remember that <e> is the link "from"
             // <v> "to" <w>.
             //
-            uint32_t outIf = FindOutgoingInterfaceId(l->GetLinkData());
+            uint32_t outIf = FindOutgoingInterfaceId(m_graph.GetLinkData(e));
 
             w->SetRootExitDirection(nextHop, outIf);
             w->SetDistanceFromRoot(distance);
@@ -600,22 +1057,24 @@ SPFAlgorithm::SPFNexthopCalculation(Vertex* v, Vertex* w, LinkRecord* l, uint32_
             // router.  The list of next hops is then determined by
             // examining the destination's router-LSA...
             NS_ASSERT(w->GetVertexType() == Vertex::VertexRouter);
-            LinkRecord* linkRemote = nullptr;
-            while ((linkRemote = SPFGetNextLink(w, v, linkRemote)))
-            {
-                /* ...For each link in the router-LSA that points back to the
-                 * parent network, the link's Link Data field provides the IP
-                 * address of a next hop router.  The outgoing interface to
-                 * use can then be derived from the next hop IP address (or
-                 * it can be inherited from the parent network).
-                 */
-                Ipv4Address nextHop = linkRemote->GetLinkData();
-                uint32_t outIf = v->GetRootExitDirection().second;
-                w->SetRootExitDirection(nextHop, outIf);
-                NS_LOG_LOGIC("Next hop from " << v->GetVertexId() << " to " << w->GetVertexId()
-                                              << " goes through next hop " << nextHop
-                                              << " via outgoing interface " << outIf);
-            }
+            //
+            // The first link in the router-LSA that points back to the parent
+            // network is the reverse of the edge from the network.
+            //
+            uint32_t remote = m_graph.GetReverse(e);
+            NS_ASSERT_MSG(remote != LSDBGraph::NO_EDGE, "No link back to " << v->GetVertexId());
+            /* ...For each link in the router-LSA that points back to the
+             * parent network, the link's Link Data field provides the IP
+             * address of a next hop router.  The outgoing interface to
+             * use can then be derived from the next hop IP address (or
+             * it can be inherited from the parent network).
+             */
+            Ipv4Address nextHop = m_graph.GetLinkData(remote);
+            uint32_t outIf = v->GetRootExitDirection().second;
+            w->SetRootExitDirection(nextHop, outIf);
+            NS_LOG_LOGIC("Next hop from " << v->GetVertexId() << " to " << w->GetVertexId()
+                                          << " goes through next hop " << nextHop
+                                          << " via outgoing interface " << outIf);
         }
         else
         {
@@ -660,14 +1119,14 @@ SPFAlgorithm::SPFNexthopCalculation(Vertex* v, Vertex* w, LinkRecord* l, uint32_
 // to <w>.  If prev_link is not NULL, we return a Romam Router Link Record
 // representing a possible *second* link from <v> to <w>.
 //
-LinkRecord*
-SPFAlgorithm::SPFGetNextLink(Vertex* v, Vertex* w, LinkRecord* prev_link)
+const LinkRecord*
+SPFAlgorithm::SPFGetNextLink(Vertex* v, Vertex* w, const LinkRecord* prev_link)
 {
     NS_LOG_FUNCTION(this << v << w << prev_link);
 
     bool skip = true;
     bool found_prev_link = false;
-    LinkRecord* l;
+    const LinkRecord* l;
     //
     // If prev_link is 0, we are really looking for the first link, not the next
     // link.
@@ -742,13 +1201,13 @@ bool
 SPFAlgorithm::CheckForStubNode(Ipv4Address root)
 {
     NS_LOG_FUNCTION(this << root);
-    LSA* rlsa = m_lsdb->GetLSA(root);
+    LSA* rlsa = m_graph.GetLSA(root);
     Ipv4Address myRouterId = rlsa->GetLinkStateId();
     int transits = 0;
-    LinkRecord* transitLink = nullptr;
+    const LinkRecord* transitLink = nullptr;
     for (uint32_t i = 0; i < rlsa->GetNLinkRecords(); i++)
     {
-        LinkRecord* l = rlsa->GetLinkRecord(i);
+        const LinkRecord* l = rlsa->GetLinkRecord(i);
         if (l->GetLinkType() == LinkRecord::TransitNetwork)
         {
             transits++;
@@ -786,14 +1245,14 @@ SPFAlgorithm::CheckForStubNode(Ipv4Address root)
             // Install default route to next hop
             // The link record LinkID is the router ID of the peer.
             // The Link Data is the local IP interface address
-            LSA* w_lsa = m_lsdb->GetLSA(transitLink->GetLinkId());
+            LSA* w_lsa = m_graph.GetLSA(transitLink->GetLinkId());
             uint32_t nLinkRecords = w_lsa->GetNLinkRecords();
             for (uint32_t j = 0; j < nLinkRecords; ++j)
             {
                 //
                 // We are only concerned about point-to-point links
                 //
-                LinkRecord* lr = w_lsa->GetLinkRecord(j);
+                const LinkRecord* lr = w_lsa->GetLinkRecord(j);
                 if (lr->GetLinkType() != LinkRecord::PointToPoint)
                 {
                     continue;
@@ -802,14 +1261,13 @@ SPFAlgorithm::CheckForStubNode(Ipv4Address root)
                 if (lr->GetLinkId() == myRouterId)
                 {
                     // Next hop is stored in the LinkID field of lr
-                    Ptr<RomamRouter> router = rlsa->GetNode()->GetObject<RomamRouter>();
-                    NS_ASSERT(router);
-                    Ptr<RomamRouting> gr = router->GetRoutingProtocol();
-                    NS_ASSERT(gr);
-                    gr->AddNetworkRouteTo(Ipv4Address("0.0.0.0"),
-                                          Ipv4Mask("0.0.0.0"),
-                                          lr->GetLinkData(),
-                                          FindOutgoingInterfaceId(transitLink->GetLinkData()));
+                    uint32_t nodeId = m_directory->GetNodeIdByRouterId(myRouterId);
+                    NS_ASSERT(nodeId != RouterDirectory::NO_NODE);
+                    m_tree->GetRoutes(nodeId)
+                        .AddNetworkRouteTo(Ipv4Address("0.0.0.0"),
+                                           Ipv4Mask("0.0.0.0"),
+                                           lr->GetLinkData(),
+                                           FindOutgoingInterfaceId(transitLink->GetLinkData()));
                     NS_LOG_LOGIC("Inserting default route for node "
                                  << myRouterId << " to next hop " << lr->GetLinkData()
                                  << " via interface "
@@ -823,15 +1281,20 @@ SPFAlgorithm::CheckForStubNode(Ipv4Address root)
 }
 
 void
-SPFAlgorithm::SPFCalculate(Ipv4Address root, Ipv4Address initroot, LinkRecord* l, uint32_t Iface)
+SPFAlgorithm::SPFCalculate(Ipv4Address root,
+                           Ipv4Address initroot,
+                           const LinkRecord* l,
+                           uint32_t Iface)
 {
     NS_LOG_FUNCTION(this << root);
+    PhaseProfiler::Scope scope(PhaseProfiler::SPF_CALCULATE);
     // std::cout << "The interface = " << Iface << std::endl;
     Vertex* v;
     //
-    // Initialize the Link State Database.
+    // Start with all the vertices unexplored.
     //
-    m_lsdb->Initialize();
+    ResetStatus();
+    SetRootAreas(initroot);
     //
     // The candidate queue is a priority queue of DGRVertex objects, with the top
     // of the queue being the closest vertex in terms of distance from the root
@@ -844,22 +1307,24 @@ SPFAlgorithm::SPFCalculate(Ipv4Address root, Ipv4Address initroot, LinkRecord* l
     // calculation.  Each router (and corresponding network) is a vertex in the
     // shortest path first (SPF) tree.
     //
-    v = new Vertex(m_lsdb->GetLSA(root));
+    v = m_vertices.Allocate(m_graph.GetLSA(root));
 
     /**
      * @brief add the initroot for DGR
      * \author Pu Yang
      */
     Vertex* v_init;
-    v_init = new Vertex(m_lsdb->GetLSA(initroot));
-    v_init->GetLSA()->SetStatus(LSA::LSA_SPF_IN_SPFTREE);
+    v_init = m_vertices.Allocate(m_graph.GetLSA(initroot));
+    SetStatus(m_graph.GetVertex(v_init->GetVertexId()), LSA::LSA_SPF_IN_SPFTREE);
     //
     // This vertex is the root of the SPF tree and it is distance 0 from the root.
     // We also mark this vertex as being in the SPF tree.
     //
     m_spfroot = v;
     v->SetDistanceFromRoot(l->GetMetric());
-    v->GetLSA()->SetStatus(LSA::LSA_SPF_IN_SPFTREE);
+    SetStatus(m_graph.GetVertex(v->GetVertexId()), LSA::LSA_SPF_IN_SPFTREE);
+    m_tree->AddVertex(v);
+    m_tree->BeginSegment(root, RouteTreeRecord::TRANSIT);
     NS_LOG_LOGIC("Starting SPFCalculate for node " << root);
 
     //
@@ -869,12 +1334,25 @@ SPFAlgorithm::SPFCalculate(Ipv4Address root, Ipv4Address initroot, LinkRecord* l
     // reached.  Instead, short-circuit this computation and just install
     // a default route in the CheckForStubNode() method.
     //
-    if (NodeList::GetNNodes() > 0 && CheckForStubNode(root))
+    if (CheckForStubNode(root))
     {
         NS_LOG_LOGIC("SPFCalculate truncated for stub node " << root);
-        delete m_spfroot;
+        m_tree->SetTruncated();
+        m_vertices.Clear();
+        m_spfroot = nullptr;
         return;
     }
+    // the shared trees are not bound to the areas of a router
+    if (m_shareTrees && m_vertexAreas.empty())
+    {
+        //
+        // Take over the part of the shared tree of the root that does not go
+        // through the excluded vertex.  The candidates left are the vertices
+        // the excluded vertex shadows.
+        //
+        SPFReplaySharedTree(v_init, l, Iface, candidate);
+        v = nullptr;
+    }
 
     for (;;)
     {
@@ -892,7 +1370,10 @@ SPFAlgorithm::SPFCalculate(Ipv4Address root, Ipv4Address initroot, LinkRecord* l
         // shortest path).  If the new vertices represent shorter paths, we use them
         // and update the path cost.
         //
-        SPFNext(v, candidate);
+        if (v)
+        {
+            SPFNext(v, candidate);
+        }
         //
         // RFC2328 16.1. (3).
         //
@@ -920,7 +1401,7 @@ SPFAlgorithm::SPFCalculate(Ipv4Address root, Ipv4Address initroot, LinkRecord* l
         // Update the status field of the vertex to indicate that it is in the SPF
         // tree.
         //
-        v->GetLSA()->SetStatus(LSA::LSA_SPF_IN_SPFTREE);
+        SetStatus(m_graph.GetVertex(v->GetVertexId()), LSA::LSA_SPF_IN_SPFTREE);
         //
         // The current vertex has a parent pointer.  By calling this rather oddly
         // named method (blame quagga) we add the current vertex to the list of
@@ -929,6 +1410,8 @@ SPFAlgorithm::SPFCalculate(Ipv4Address root, Ipv4Address initroot, LinkRecord* l
         // to now.
         //
         SPFVertexAddParent(v);
+        m_tree->AddVertex(v);
+        m_tree->BeginSegment(v->GetVertexId(), RouteTreeRecord::TRANSIT);
         //
         // Note that when there is a choice of vertices closest to the root, network
         // vertices must be chosen before router vertices in order to necessarily
@@ -978,48 +1461,161 @@ SPFAlgorithm::SPFCalculate(Ipv4Address root, Ipv4Address initroot, LinkRecord* l
     } // end for loop
 
     // Second stage of SPF calculation procedure
-    SPFProcessStubs(m_spfroot);
-    for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs(); i++)
+    SPFProcessStubs();
+    if (!m_vertexAreas.empty())
     {
-        m_spfroot->ClearVertexProcessed();
-        LSA* extlsa = m_lsdb->GetExtLSA(i);
-        NS_LOG_LOGIC("Processing External LSA with id " << extlsa->GetLinkStateId());
-        ProcessASExternals(m_spfroot, extlsa);
+        SPFAddSummaries();
     }
 
     //
     // We're all done setting the routing information for the node at the root of
-    // the SPF tree.  Delete all of the vertices and corresponding resources.  Go
-    // possibly do it again for the next router.
+    // the SPF tree.  Release all of the vertices at once, the excluded vertex
+    // and those of a shared tree computed on the way included.  Go possibly do
+    // it again for the next router.
     //
-    delete m_spfroot;
+    m_vertices.Clear();
     m_spfroot = 0;
 }
 
 void
-SPFAlgorithm::ProcessASExternals(Vertex* v, LSA* extlsa)
+SPFAlgorithm::ComputeSharedTree(Ipv4Address root, SharedTreeTable::Tree& tree)
 {
-    NS_LOG_FUNCTION(this << v << extlsa);
-    NS_LOG_LOGIC("Processing external for destination "
-                 << extlsa->GetLinkStateId() << ", for router " << v->GetVertexId()
-                 << ", advertised by " << extlsa->GetAdvertisingRouter());
-    if (v->GetVertexType() == Vertex::VertexRouter)
+    NS_LOG_FUNCTION(this << root);
+    ResetStatus();
+    RouteCandidateQueue candidate;
+    std::unordered_map<uint32_t, uint32_t> index;
+    Vertex* v = m_vertices.Allocate(m_graph.GetLSA(root));
+    m_spfroot = v;
+    v->SetDistanceFromRoot(0);
+    SetStatus(m_graph.GetVertex(v->GetVertexId()), LSA::LSA_SPF_IN_SPFTREE);
+    for (;;)
     {
-        LSA* rlsa = v->GetLSA();
-        NS_LOG_LOGIC("Processing router LSA with id " << rlsa->GetLinkStateId());
-        if ((rlsa->GetLinkStateId()) == (extlsa->GetAdvertisingRouter()))
+        index[v->GetVertexId().Get()] = tree.vertices.size();
+        tree.vertices.emplace_back();
+        SharedTreeTable::Tree::Entry& entry = tree.vertices.back();
+        entry.vertex = m_graph.GetVertex(v->GetVertexId());
+        entry.distance = v->GetDistanceFromRoot();
+        for (uint32_t i = 0; v->GetParent(i); i++)
+        {
+            entry.parents.push_back(index.at(v->GetParent(i)->GetVertexId().Get()));
+        }
+        SPFNext(v, candidate);
+        if (candidate.Size() == 0)
+        {
+            break;
+        }
+        v = candidate.Pop();
+        SetStatus(m_graph.GetVertex(v->GetVertexId()), LSA::LSA_SPF_IN_SPFTREE);
+        SPFVertexAddParent(v);
+    }
+    // the vertices are released along with those of the calling SPFCalculate ()
+    m_spfroot = nullptr;
+}
+
+void
+SPFAlgorithm::SPFReplaySharedTree(Vertex* v_init,
+                                  const LinkRecord* l,
+                                  uint32_t Iface,
+                                  RouteCandidateQueue& candidate)
+{
+    NS_LOG_FUNCTION(this << m_spfroot->GetVertexId() << v_init->GetVertexId());
+    Vertex* root = m_spfroot;
+    const SharedTreeTable::Tree* found = m_sharedTrees->Find(root->GetVertexId());
+    if (!found)
+    {
+        SharedTreeTable::Tree tree;
+        ComputeSharedTree(root->GetVertexId(), tree);
+        found = m_sharedTrees->Insert(root->GetVertexId(), std::move(tree));
+        // restore the state of the run the shared tree was computed for
+        m_spfroot = root;
+        ResetStatus();
+        SetStatus(m_graph.GetVertex(root->GetVertexId()), LSA::LSA_SPF_IN_SPFTREE);
+        SetStatus(m_graph.GetVertex(v_init->GetVertexId()), LSA::LSA_SPF_IN_SPFTREE);
+    }
+    const SharedTreeTable::Tree& shared = *found;
+    //
+    // Without the excluded vertex, a vertex of the shared tree keeps its
+    // distance as long as one of its parents does, and its parents are the
+    // ones that kept theirs: paths through the other parents got longer.  The
+    // distances of the tree only differ from the shared ones by the distance
+    // of the root.
+    //
+    uint32_t offset = root->GetDistanceFromRoot();
+    std::vector<Vertex*> vertices(shared.vertices.size(), nullptr);
+    vertices[0] = root;
+    bool shadowed = false;
+    for (uint32_t i = 1; i < shared.vertices.size(); i++)
+    {
+        const SharedTreeTable::Tree::Entry& entry = shared.vertices[i];
+        LSA* w_lsa = m_graph.GetLSA(entry.vertex);
+        if (w_lsa == v_init->GetLSA())
+        {
+            continue;
+        }
+        uint32_t distance = entry.distance + offset;
+        Vertex* w = nullptr;
+        for (auto p = entry.parents.begin(); p != entry.parents.end(); p++)
+        {
+            Vertex* v = vertices[*p];
+            if (!v)
+            {
+                continue;
+            }
+            //
+            // Repeat the next hop calculation of SPFNext () for every edge from
+            // the parent on a shortest path, merging the equal cost paths.
+            //
+            uint32_t index = shared.vertices[*p].vertex;
+            for (uint32_t e = m_graph.GetEdgesBegin(index); e < m_graph.GetEdgesEnd(index); e++)
+            {
+                if (m_graph.GetTarget(e) != entry.vertex ||
+                    v->GetDistanceFromRoot() + m_graph.GetMetric(e) != distance)
+                {
+                    continue;
+                }
+                if (!w)
+                {
+                    w = m_vertices.Allocate(w_lsa);
+                    SPFNexthopCalculation(v, w, e, distance);
+                    continue;
+                }
+                Vertex cw(w_lsa);
+                SPFNexthopCalculation(v, &cw, e, distance);
+                w->MergeRootExitDirections(&cw);
+                w->MergeParent(&cw);
+            }
+        }
+        if (!w)
+        {
+            NS_LOG_LOGIC("Vertex " << w_lsa->GetLinkStateId() << " shadowed by "
+                                   << v_init->GetVertexId());
+            shadowed = true;
+            continue;
+        }
+        SetStatus(entry.vertex, LSA::LSA_SPF_IN_SPFTREE);
+        SPFVertexAddParent(w);
+        m_tree->AddVertex(w);
+        m_tree->BeginSegment(w->GetVertexId(), RouteTreeRecord::TRANSIT);
+        if (w->GetVertexType() == Vertex::VertexRouter)
+        {
+            SPFIntraAddRouter(w, v_init, l->GetLinkData(), Iface);
+        }
+        else
         {
-            NS_LOG_LOGIC("Found advertising router to destination");
-            SPFAddASExternal(extlsa, v);
+            SPFIntraAddTransit(w);
         }
+        vertices[i] = w;
     }
-    for (uint32_t i = 0; i < v->GetNChildren(); i++)
+    if (!shadowed)
     {
-        if (!v->GetChild(i)->IsVertexProcessed())
+        return;
+    }
+    // the shadowed vertices can only be reached from the vertices in the tree
+    for (auto i = vertices.begin(); i != vertices.end(); i++)
+    {
+        if (*i)
         {
-            NS_LOG_LOGIC("Vertex's child " << i << " not yet processed, processing...");
-            ProcessASExternals(v->GetChild(i), extlsa);
-            v->GetChild(i)->SetVertexProcessed(true);
+            SPFNext(*i, candidate);
         }
     }
 }
@@ -1050,143 +1646,232 @@ SPFAlgorithm::SPFAddASExternal(LSA* extlsa, Vertex* v)
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Look up the node that has the router ID corresponding to the root vertex.
+    // This is the one we're going to write the routing information to.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(routerId);
+    if (nodeId != RouterDirectory::NO_NODE)
     {
-        Ptr<Node> node = *i;
+        NS_LOG_LOGIC("Setting routes for node " << nodeId);
         //
-        // The router ID is accessible through the RomamRouter interface, so we need
-        // to QI for that interface.  If there's no RomamRouter interface, the node
-        // in question cannot be the router we want, so we continue.
+        // Get the Romam Router Link State Advertisement from the vertex we're
+        // adding the routes to.  The LSA will have a number of attached Romam Router
+        // Link Records corresponding to links off of that vertex / node.  We're going
+        // to be interested in the records corresponding to point-to-point links.
         //
-        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
+        NS_ASSERT_MSG(v->GetLSA(),
+                      "SPFAlgorithm::SPFIntraAddRouter (): "
+                      "Expected valid LSA in SPFVertex* v");
+        Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
+        Ipv4Address tempip = extlsa->GetLinkStateId();
+        tempip = tempip.CombineMask(tempmask);
 
-        if (!rtr)
-        {
-            NS_LOG_LOGIC("No RomamRouter interface on node " << node->GetId());
-            continue;
-        }
         //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
+        // Here's why we did all of that work.  We're going to add a host route to the
+        // host address found in the m_linkData field of the point-to-point link
+        // record.  In the case of a point-to-point link, this is the local IP address
+        // of the node connected to the link.  Each of these point-to-point links
+        // will correspond to a local interface that has an IP address to which
+        // the node at the root of the SPF tree can send packets.  The vertex <v>
+        // (corresponding to the node that has these links and interfaces) has
+        // an m_nextHop address precalculated for us that is the address to which the
+        // root node should send packets to be forwarded to these IP addresses.
+        // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
+        // which the packets should be send for forwarding.
         //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        // walk through all next-hop-IPs and out-going-interfaces for reaching
+        // the stub network gateway 'v' from the root node
+        for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "SPFAlgorithm::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Romam Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Romam Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "SPFAlgorithm::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = extlsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
+            Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
+            Ipv4Address nextHop = exit.first;
+            int32_t outIf = exit.second;
+            if (outIf >= 0)
+            {
+                m_tree->GetRoutes(nodeId)
+                    .AddASExternalRouteTo(tempip, tempmask, nextHop, outIf);
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " add external network route to " << tempip
+                                       << " using next hop " << nextHop << " via interface "
+                                       << outIf);
+            }
+            else
+            {
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " NOT able to add network route to " << tempip
+                                       << " using next hop " << nextHop
+                                       << " since outgoing interface id is negative");
+            }
+        }
+        return;
+    }
+}
 
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-            Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
-            if (!router)
+void
+SPFAlgorithm::SPFAddSummaries()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT_MSG(m_spfroot, "SPFAlgorithm::SPFAddSummaries (): Root pointer not set");
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(m_spfroot->GetVertexId());
+    if (nodeId == RouterDirectory::NO_NODE)
+    {
+        return;
+    }
+    // an area border router only takes the summaries of the backbone
+    uint32_t area = m_rootBackbone ? AreaDirectory::BACKBONE : m_rootArea;
+    //
+    // Walk the tree for the border routers that advertise into the area, and
+    // keep for every prefix the lowest cost and the borders that reach it at
+    // that cost.  The prefixes the tree reaches by itself are left out.
+    //
+    // the borders a prefix is routed through
+    struct Choice
+    {
+        const AreaDirectory::Summary* summary; // the summary of the first border
+        uint32_t cost;                         // the cost through the borders
+        std::vector<Vertex*> borders;          // the borders
+    };
+    std::map<uint32_t, Choice> choices;
+    std::vector<Vertex*> stack(1, m_spfroot);
+    m_vertices.ClearProcessed();
+    m_spfroot->SetVertexProcessed(true);
+    while (!stack.empty())
+    {
+        Vertex* v = stack.back();
+        stack.pop_back();
+        v->ForEachChild([&stack](Vertex* child) {
+            if (!child->IsVertexProcessed())
+            {
+                child->SetVertexProcessed(true);
+                stack.push_back(child);
+            }
+        });
+        const std::vector<AreaDirectory::Summary>* summaries =
+            v != m_spfroot && v->GetVertexType() == Vertex::VertexRouter
+                ? m_areas->GetSummaries(v->GetVertexId(), area)
+                : nullptr;
+        for (uint32_t i = 0; summaries && i < summaries->size(); i++)
+        {
+            const AreaDirectory::Summary& summary = (*summaries)[i];
+            if (m_areas->IsVisible(summary.prefix, m_rootArea, m_rootBackbone))
             {
                 continue;
             }
-            Ptr<RomamRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+            uint32_t cost = v->GetDistanceFromRoot() + summary.cost;
+            auto j = choices.emplace(summary.prefix, Choice{&summary, cost, {}}).first;
+            if (cost < j->second.cost)
             {
-                Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddASExternalRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add external network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
+                j->second = Choice{&summary, cost, {}};
+            }
+            if (cost == j->second.cost)
+            {
+                j->second.borders.push_back(v);
+            }
+        }
+    }
+    for (auto i = choices.begin(); i != choices.end(); i++)
+    {
+        Ipv4Address network = i->second.summary->network;
+        Ipv4Mask mask = i->second.summary->mask;
+        // the borders reached through the same exit add one route
+        std::set<Vertex::NodeExit_t> exits;
+        for (Vertex* border : i->second.borders)
+        {
+            m_tree->BeginSegment(border->GetVertexId(), RouteTreeRecord::SUMMARY);
+            for (uint32_t j = 0; j < border->GetNRootExitDirections(); j++)
+            {
+                Vertex::NodeExit_t exit = border->GetRootExitDirection(j);
+                if (exit.second >= 0 && exits.insert(exit).second)
                 {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
+                    m_tree->GetRoutes(nodeId).AddNetworkRouteTo(network,
+                                                                mask,
+                                                                exit.first,
+                                                                exit.second);
+                    NS_LOG_LOGIC("Node " << nodeId << " add summary route to " << network
+                                         << " through " << border->GetVertexId()
+                                         << " using next hop " << exit.first
+                                         << " via interface " << exit.second);
                 }
             }
-            return;
-        } // if
-    } // for
+        }
+    }
 }
 
 // Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
 // stub link records will exist for point-to-point interfaces and for
 // broadcast interfaces for which no neighboring router can be found
 void
-SPFAlgorithm::SPFProcessStubs(Vertex* v)
+SPFAlgorithm::SPFProcessStubs()
 {
-    NS_LOG_FUNCTION(this << v);
-    NS_LOG_LOGIC("Processing stubs for " << v->GetVertexId());
-    if (v->GetVertexType() == Vertex::VertexRouter)
+    NS_LOG_FUNCTION(this);
+    //
+    // The stubs and the externals of the routers were extracted with m_graph,
+    // so the tree is walked once, in the order the recursive walks of the
+    // stubs and of every external LSA had, and the prefixes attached from the
+    // routers found.
+    //
+    m_treeRouters.clear();
+    m_routerVertices.resize(m_graph.GetNVertices(), nullptr);
+    SPFCollectRouters(m_spfroot);
+    for (uint32_t index : m_treeRouters)
     {
-        LSA* rlsa = v->GetLSA();
-        NS_LOG_LOGIC("Processing router LSA with id " << rlsa->GetLinkStateId());
-        for (uint32_t i = 0; i < rlsa->GetNLinkRecords(); i++)
+        Vertex* v = m_routerVertices[index];
+        m_tree->BeginSegment(v->GetVertexId(), RouteTreeRecord::STUB);
+        SPFIntraAddStubs(v, index);
+    }
+    for (uint32_t a = 0; a < m_graph.GetNAdvertisers(); a++)
+    {
+        Vertex* v = m_routerVertices[m_graph.GetAdvertiser(a)];
+        if (!v)
         {
-            NS_LOG_LOGIC("Examining link " << i << " of " << v->GetVertexId() << "'s "
-                                           << v->GetLSA()->GetNLinkRecords() << " link records");
-            LinkRecord* l = v->GetLSA()->GetLinkRecord(i);
-            if (l->GetLinkType() == LinkRecord::StubNetwork)
-            {
-                NS_LOG_LOGIC("Found a Stub record to " << l->GetLinkId());
-                SPFIntraAddStub(l, v);
-                continue;
-            }
+            continue; // not reached by the tree
+        }
+        m_tree->BeginSegment(v->GetVertexId(), RouteTreeRecord::EXTERNAL);
+        for (uint32_t x = m_graph.GetExternalsBegin(a); x < m_graph.GetExternalsEnd(a); x++)
+        {
+            NS_LOG_LOGIC("Processing External LSA with id "
+                         << m_graph.GetExternal(x)->GetLinkStateId());
+            SPFAddASExternal(m_graph.GetExternal(x), v);
         }
     }
-    for (uint32_t i = 0; i < v->GetNChildren(); i++)
+    for (uint32_t index : m_treeRouters)
+    {
+        m_routerVertices[index] = nullptr;
+    }
+}
+
+void
+SPFAlgorithm::SPFCollectRouters(Vertex* v)
+{
+    if (v->GetVertexType() == Vertex::VertexRouter)
     {
-        if (!v->GetChild(i)->IsVertexProcessed())
+        uint32_t index = m_graph.GetVertex(v->GetVertexId());
+        m_routerVertices[index] = v;
+        m_treeRouters.push_back(index);
+    }
+    v->ForEachChild([this](Vertex* child) {
+        if (!child->IsVertexProcessed())
         {
-            SPFProcessStubs(v->GetChild(i));
-            v->GetChild(i)->SetVertexProcessed(true);
+            SPFCollectRouters(child);
+            child->SetVertexProcessed(true);
         }
-    }
+    });
 }
 
 // RFC2328 16.1. second stage.
 void
-SPFAlgorithm::SPFIntraAddStub(LinkRecord* l, Vertex* v)
+SPFAlgorithm::SPFIntraAddStubs(Vertex* v, uint32_t index)
+{
+    NS_LOG_FUNCTION(this << v << index);
+    for (uint32_t s = m_graph.GetStubsBegin(index); s < m_graph.GetStubsEnd(index); s++)
+    {
+        NS_LOG_LOGIC("Found a Stub record to " << m_graph.GetStub(s)->GetLinkId());
+        SPFIntraAddStub(m_graph.GetStub(s), v);
+    }
+}
+
+void
+SPFAlgorithm::SPFIntraAddStub(const LinkRecord* l, Vertex* v)
 {
     NS_LOG_FUNCTION(this << l << v);
 
@@ -1214,103 +1899,65 @@ SPFAlgorithm::SPFIntraAddStub(LinkRecord* l, Vertex* v)
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Look up the node that has the router ID corresponding to the root vertex.
+    // This is the one we're going to write the routing information to.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(routerId);
+    if (nodeId != RouterDirectory::NO_NODE)
     {
-        Ptr<Node> node = *i;
+        NS_LOG_LOGIC("Setting routes for node " << nodeId);
         //
-        // The router ID is accessible through the RomamRouter interface, so we need
-        // to QI for that interface.  If there's no RomamRouter interface, the node
-        // in question cannot be the router we want, so we continue.
+        // Get the Romam Router Link State Advertisement from the vertex we're
+        // adding the routes to.  The LSA will have a number of attached Romam Router
+        // Link Records corresponding to links off of that vertex / node.  We're going
+        // to be interested in the records corresponding to point-to-point links.
         //
-        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
-
-        if (!rtr)
-        {
-            NS_LOG_LOGIC("No RomamRouter interface on node " << node->GetId());
-            continue;
-        }
+        NS_ASSERT_MSG(v->GetLSA(),
+                      "SPFAlgorithm::SPFIntraAddRouter (): "
+                      "Expected valid LSA in Vertex* v");
+        Ipv4Mask tempmask(l->GetLinkData().Get());
+        Ipv4Address tempip = l->GetLinkId();
+        tempip = tempip.CombineMask(tempmask);
         //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
+        // Here's why we did all of that work.  We're going to add a host route to the
+        // host address found in the m_linkData field of the point-to-point link
+        // record.  In the case of a point-to-point link, this is the local IP address
+        // of the node connected to the link.  Each of these point-to-point links
+        // will correspond to a local interface that has an IP address to which
+        // the node at the root of the SPF tree can send packets.  The vertex <v>
+        // (corresponding to the node that has these links and interfaces) has
+        // an m_nextHop address precalculated for us that is the address to which the
+        // root node should send packets to be forwarded to these IP addresses.
+        // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
+        // which the packets should be send for forwarding.
         //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
 
-        if (rtr->GetRouterId() == routerId)
+        // walk through all next-hop-IPs and out-going-interfaces for reaching
+        // the stub network gateway 'v' from the root node
+        for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "SPFAlgorithm::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Romam Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Romam Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "SPFAlgorithm::SPFIntraAddRouter (): "
-                          "Expected valid LSA in Vertex* v");
-            Ipv4Mask tempmask(l->GetLinkData().Get());
-            Ipv4Address tempip = l->GetLinkId();
-            tempip = tempip.CombineMask(tempmask);
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-
-            Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
-            if (!router)
+            Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
+            Ipv4Address nextHop = exit.first;
+            int32_t outIf = exit.second;
+            if (outIf >= 0)
             {
-                continue;
+                m_tree->GetRoutes(nodeId)
+                    .AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " add network route to " << tempip
+                                       << " using next hop " << nextHop << " via interface "
+                                       << outIf);
             }
-            Ptr<RomamRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+            else
             {
-                Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
-                }
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " NOT able to add network route to " << tempip
+                                       << " using next hop " << nextHop
+                                       << " since outgoing interface id is negative");
             }
-            return;
-        } // if
-    } // for
+        }
+        return;
+    }
 }
 
 //
@@ -1327,59 +1974,33 @@ SPFAlgorithm::FindOutgoingInterfaceId(Ipv4Address a, Ipv4Mask amask)
     //
     // We have an IP address <a> and a vertex ID of the root of the SPF tree.
     // The question is what interface index does this address correspond to.
-    // The answer is a little complicated since we have to find a pointer to
-    // the node corresponding to the vertex ID, find the Ipv4 interface on that
-    // node in order to iterate the interfaces and find the one corresponding to
-    // the address in question.
+    // The router directory indexed the interface addresses of the node
+    // corresponding to the vertex ID when the LSDB was built, so we look for
+    // the interface corresponding to the address in question there.
     //
     Ipv4Address routerId = m_spfroot->GetVertexId();
     //
-    // Walk the list of nodes in the system looking for the one corresponding to
-    // the node at the root of the SPF tree.  This is the node for which we are
-    // building the routing table.
+    // Look up the node at the root of the SPF tree.  This is the node for which
+    // we are building the routing table.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(routerId);
+    if (nodeId != RouterDirectory::NO_NODE)
     {
-        Ptr<Node> node = *i;
-
-        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
         //
-        // If the node doesn't have a RomamRouter interface it can't be the one
-        // we're interested in.
+        // Look through the interfaces on this node for one that has the IP address
+        // we're looking for.  If we find one, return the corresponding interface
+        // index, or -1 if not found.
         //
-        if (!rtr)
-        {
-            continue;
-        }
-
-        if (rtr->GetRouterId() == routerId)
-        {
-            //
-            // This is the node we're building the routing table for.  We're going to need
-            // the Ipv4 interface to look for the ipv4 interface index.  Since this node
-            // is participating in routing IP version 4 packets, it certainly must have
-            // an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "SPFAlgorithm::FindOutgoingInterfaceId (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Look through the interfaces on this node for one that has the IP address
-            // we're looking for.  If we find one, return the corresponding interface
-            // index, or -1 if not found.
-            //
-            int32_t interface = ipv4->GetInterfaceForPrefix(a, amask);
+        int32_t interface = m_directory->GetInterfaceForPrefix(nodeId, a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("SPFAlgorithm::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif
-            return interface;
+      if (interface < 0)
+        {
+          NS_FATAL_ERROR ("SPFAlgorithm::FindOutgoingInterfaceId(): "
+                          "Expected an interface associated with address a:" << a);
         }
+#endif
+        return interface;
     }
     //
     // Couldn't find it.
@@ -1427,96 +2048,68 @@ SPFAlgorithm::SPFIntraAddRouter(Vertex* v, Vertex* v_init, Ipv4Address nextHop,
     NS_LOG_LOGIC("Vertex ID = " << routerId);
 
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Look up the node that has the router ID corresponding to the root vertex.
+    // This is the one we're going to write the routing information to.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(routerId_init);
+    if (nodeId != RouterDirectory::NO_NODE)
     {
-        Ptr<Node> node = *i;
+        NS_LOG_LOGIC("Setting routes for node " << nodeId);
         //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to GetObject for that interface.  If there's no GlobalRouter interface,
-        // the node in question cannot be the router we want, so we continue.
+        // Get the Global Router Link State Advertisement from the vertex we're
+        // adding the routes to.  The LSA will have a number of attached Global Router
+        // Link Records corresponding to links off of that vertex / node.  We're going
+        // to be interested in the records corresponding to point-to-point links.
         //
-        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
-        if (!rtr)
+        LSA* lsa = v->GetLSA();
+        NS_ASSERT_MSG(lsa,
+                      "SPFAlgorithm::SPFIntraAddRouter (): "
+                      "Expected valid LSA in DGRVertex* v");
+        //
+        // A router with a loopback address is reached at it, by the route its
+        // stub record adds, and not at the addresses of its links.
+        //
+        uint32_t vNodeId = m_directory->GetNodeIdByRouterId(v->GetVertexId());
+        if (vNodeId != RouterDirectory::NO_NODE &&
+            m_directory->GetLoopback(vNodeId) != Ipv4Address::GetAny())
         {
-            NS_LOG_LOGIC("No SPFRouter interface on node " << node->GetId());
-            continue;
+            return;
         }
-        // std::cout << "The neighbour node " << node->GetId () << std::endl;
+
+        uint32_t nLinkRecords = lsa->GetNLinkRecords();
         //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
+        // Iterate through the link records on the vertex to which we're going to add
+        // routes.  To make sure we're being clear, we're going to add routing table
+        // entries to the tables on the node corresping to the root of the SPF tree.
+        // These entries will have routes to the IP addresses we find from looking at
+        // the local side of the point-to-point links found on the node described by
+        // the vertex <v>.
         //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId_init)
+        NS_LOG_LOGIC(" Node " << nodeId << " found " << nLinkRecords
+                              << " link records in LSA " << lsa << "with LinkStateId "
+                              << lsa->GetLinkStateId());
+        for (uint32_t j = 0; j < nLinkRecords; ++j)
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "SPFAlgorithm::SPFIntraAddRouter (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
             //
-            LSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "SPFAlgorithm::SPFIntraAddRouter (): "
-                          "Expected valid LSA in DGRVertex* v");
-
-            uint32_t nLinkRecords = lsa->GetNLinkRecords();
-            //
-            // Iterate through the link records on the vertex to which we're going to add
-            // routes.  To make sure we're being clear, we're going to add routing table
-            // entries to the tables on the node corresping to the root of the SPF tree.
-            // These entries will have routes to the IP addresses we find from looking at
-            // the local side of the point-to-point links found on the node described by
-            // the vertex <v>.
+            // We are only concerned about point-to-point links
             //
-            NS_LOG_LOGIC(" Node " << node->GetId() << " found " << nLinkRecords
-                                  << " link records in LSA " << lsa << "with LinkStateId "
-                                  << lsa->GetLinkStateId());
-            for (uint32_t j = 0; j < nLinkRecords; ++j)
+            const LinkRecord* lr = lsa->GetLinkRecord(j);
+            if (lr->GetLinkType() != LinkRecord::PointToPoint)
             {
-                //
-                // We are only concerned about point-to-point links
-                //
-                LinkRecord* lr = lsa->GetLinkRecord(j);
-                if (lr->GetLinkType() != LinkRecord::PointToPoint)
-                {
-                    continue;
-                }
-                Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
-                if (!router)
-                {
-                    continue;
-                }
-                Ptr<RomamRouting> routing = router->GetRoutingProtocol();
-                NS_ASSERT(routing);
-                uint32_t distance = v->GetDistanceFromRoot();
-                if (v->GetNRootExitDirections() >= 1)
-                {
-                    int32_t nextIface = v->GetRootExitDirection(0).second;
-                    routing->AddHostRouteTo(lr->GetLinkData(), nextHop, Iface, nextIface, distance);
-                }
+                continue;
+            }
+            uint32_t distance = v->GetDistanceFromRoot();
+            if (v->GetNRootExitDirections() >= 1)
+            {
+                int32_t nextIface = v->GetRootExitDirection(0).second;
+                m_tree->GetRoutes(nodeId)
+                    .AddHostRouteTo(lr->GetLinkData(), nextHop, Iface, nextIface, distance);
             }
-            //
-            // Done adding the routes for the selected node.
-            //
-            return;
         }
+        //
+        // Done adding the routes for the selected node.
+        //
+        return;
     }
 }
 
@@ -1537,88 +2130,50 @@ SPFAlgorithm::SPFIntraAddTransit(Vertex* v)
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Look up the node that has the router ID corresponding to the root vertex.
+    // This is the one we're going to write the routing information to.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    uint32_t nodeId = m_directory->GetNodeIdByRouterId(routerId);
+    if (nodeId != RouterDirectory::NO_NODE)
     {
-        Ptr<Node> node = *i;
+        NS_LOG_LOGIC("setting routes for node " << nodeId);
         //
-        // The router ID is accessible through the RomamRouter interface, so we need
-        // to GetObject for that interface.  If there's no RomamRouter interface,
-        // the node in question cannot be the router we want, so we continue.
+        // Get the Romam Router Link State Advertisement from the vertex we're
+        // adding the routes to.  The LSA will have a number of attached Romam Router
+        // Link Records corresponding to links off of that vertex / node.  We're going
+        // to be interested in the records corresponding to point-to-point links.
         //
-        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
-
-        if (!rtr)
+        LSA* lsa = v->GetLSA();
+        NS_ASSERT_MSG(lsa,
+                      "SPFAlgorithm::SPFIntraAddTransit (): "
+                      "Expected valid LSA in SPFVertex* v");
+        Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
+        Ipv4Address tempip = lsa->GetLinkStateId();
+        tempip = tempip.CombineMask(tempmask);
+        // walk through all available exit directions due to ECMP,
+        // and add host route for each of the exit direction toward
+        // the vertex 'v'
+        for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
         {
-            NS_LOG_LOGIC("No RomamRouter interface on node " << node->GetId());
-            continue;
-        }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
+            Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
+            Ipv4Address nextHop = exit.first;
+            int32_t outIf = exit.second;
 
-        if (rtr->GetRouterId() == routerId)
-        {
-            NS_LOG_LOGIC("setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "SPFAlgorithm::SPFIntraAddTransit (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Romam Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Romam Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            LSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "SPFAlgorithm::SPFIntraAddTransit (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = lsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
-            Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
-            if (!router)
+            if (outIf >= 0)
             {
-                continue;
+                m_tree->GetRoutes(nodeId)
+                    .AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " add network route to " << tempip
+                                       << " using next hop " << nextHop << " via interface "
+                                       << outIf);
             }
-            Ptr<RomamRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all available exit directions due to ECMP,
-            // and add host route for each of the exit direction toward
-            // the vertex 'v'
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+            else
             {
-                Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative " << outIf);
-                }
+                NS_LOG_LOGIC("(Route " << i << ") Node " << nodeId
+                                       << " NOT able to add network route to " << tempip
+                                       << " using next hop " << nextHop
+                                       << " since outgoing interface id is negative " << outIf);
             }
         }
     }
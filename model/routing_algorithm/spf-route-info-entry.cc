@@ -21,23 +21,13 @@ ShortestPathForestRIE::~ShortestPathForestRIE()
 }
 
 ShortestPathForestRIE::ShortestPathForestRIE(const ShortestPathForestRIE& route)
-    : m_dest(route.m_dest),
-      m_destNetworkMask(route.m_destNetworkMask),
-      m_gateway(route.m_gateway),
-      m_interface(route.m_interface),
-      m_nextIface(route.m_nextIface),
-      m_distance(route.m_distance)
+    : RouteInfoEntry(route)
 {
     NS_LOG_FUNCTION(this << route);
 }
 
 ShortestPathForestRIE::ShortestPathForestRIE(const ShortestPathForestRIE* route)
-    : m_dest(route->m_dest),
-      m_destNetworkMask(route->m_destNetworkMask),
-      m_gateway(route->m_gateway),
-      m_interface(route->m_interface),
-      m_nextIface(route->m_nextIface),
-      m_distance(route->m_distance)
+    : RouteInfoEntry(*route)
 {
     NS_LOG_FUNCTION(this << route);
 }
@@ -45,22 +35,17 @@ ShortestPathForestRIE::ShortestPathForestRIE(const ShortestPathForestRIE* route)
 ShortestPathForestRIE::ShortestPathForestRIE(Ipv4Address dest,
                                              Ipv4Address gateway,
                                              uint32_t interface)
-    : m_dest(dest),
-      m_destNetworkMask(Ipv4Mask::GetOnes()),
-      m_gateway(gateway),
-      m_interface(interface),
-      m_nextIface(MAX_UINT32),
-      m_distance(MAX_UINT32)
+    : RouteInfoEntry(dest, Ipv4Mask::GetOnes(), gateway, interface, MAX_UINT32, MAX_UINT32)
 {
 }
 
 ShortestPathForestRIE::ShortestPathForestRIE(Ipv4Address dest, uint32_t interface)
-    : m_dest(dest),
-      m_destNetworkMask(Ipv4Mask::GetOnes()),
-      m_gateway(Ipv4Address::GetZero()),
-      m_interface(interface),
-      m_nextIface(MAX_UINT32),
-      m_distance(MAX_UINT32)
+    : RouteInfoEntry(dest,
+                     Ipv4Mask::GetOnes(),
+                     Ipv4Address::GetZero(),
+                     interface,
+                     MAX_UINT32,
+                     MAX_UINT32)
 {
 }
 
@@ -68,12 +53,7 @@ ShortestPathForestRIE::ShortestPathForestRIE(Ipv4Address network,
                                              Ipv4Mask networkMask,
                                              Ipv4Address gateway,
                                              uint32_t interface)
-    : m_dest(network),
-      m_destNetworkMask(networkMask),
-      m_gateway(gateway),
-      m_interface(interface),
-      m_nextIface(MAX_UINT32),
-      m_distance(MAX_UINT32)
+    : RouteInfoEntry(network, networkMask, gateway, interface, MAX_UINT32, MAX_UINT32)
 {
     NS_LOG_FUNCTION(this << network << networkMask << gateway << interface);
 }
@@ -81,12 +61,12 @@ ShortestPathForestRIE::ShortestPathForestRIE(Ipv4Address network,
 ShortestPathForestRIE::ShortestPathForestRIE(Ipv4Address network,
                                              Ipv4Mask networkMask,
                                              uint32_t interface)
-    : m_dest(network),
-      m_destNetworkMask(networkMask),
-      m_gateway(Ipv4Address::GetZero()),
-      m_interface(interface),
-      m_nextIface(MAX_UINT32),
-      m_distance(MAX_UINT32)
+    : RouteInfoEntry(network,
+                     networkMask,
+                     Ipv4Address::GetZero(),
+                     interface,
+                     MAX_UINT32,
+                     MAX_UINT32)
 {
     NS_LOG_FUNCTION(this << network << networkMask << interface);
 }
@@ -96,94 +76,12 @@ ShortestPathForestRIE::ShortestPathForestRIE(Ipv4Address dest,
                                              uint32_t interface,
                                              uint32_t nextIface,
                                              uint32_t distance)
-    : m_dest(dest),
-      m_destNetworkMask(Ipv4Mask::GetOnes()),
-      m_gateway(gateway),
-      m_interface(interface),
-      m_nextIface(nextIface),
-      m_distance(distance)
+    : RouteInfoEntry(dest, Ipv4Mask::GetOnes(), gateway, interface, nextIface, distance)
 {
     // std::cout << "CreateNetworkRouteTo with distance" << distance << std::endl;
     NS_LOG_FUNCTION(this << dest << gateway << interface << distance);
 }
 
-bool
-ShortestPathForestRIE::IsHost() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_destNetworkMask == Ipv4Mask::GetOnes();
-}
-
-Ipv4Address
-ShortestPathForestRIE::GetDest() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_dest;
-}
-
-bool
-ShortestPathForestRIE::IsNetwork() const
-{
-    NS_LOG_FUNCTION(this);
-    return !IsHost();
-}
-
-bool
-ShortestPathForestRIE::IsDefault() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_dest == Ipv4Address::GetZero();
-}
-
-Ipv4Address
-ShortestPathForestRIE::GetDestNetwork() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_dest;
-}
-
-Ipv4Mask
-ShortestPathForestRIE::GetDestNetworkMask() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_destNetworkMask;
-}
-
-bool
-ShortestPathForestRIE::IsGateway() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_gateway != Ipv4Address::GetZero();
-}
-
-Ipv4Address
-ShortestPathForestRIE::GetGateway() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_gateway;
-}
-
-uint32_t
-ShortestPathForestRIE::GetInterface() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_interface;
-}
-
-uint32_t
-ShortestPathForestRIE::GetNextIface() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_nextIface;
-}
-
-uint32_t
-ShortestPathForestRIE::GetDistance() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_distance;
-}
-
 ShortestPathForestRIE
 ShortestPathForestRIE::CreateHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
 {
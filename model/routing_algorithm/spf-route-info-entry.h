@@ -25,7 +25,7 @@ class ShortestPathForestRIE : public RouteInfoEntry
     /**
      * \brief destructor.
      */
-    ~ShortestPathForestRIE() override;
+    ~ShortestPathForestRIE();
 
     /**
      * \brief Copy Constructor
@@ -39,30 +39,25 @@ class ShortestPathForestRIE : public RouteInfoEntry
      */
     ShortestPathForestRIE(const ShortestPathForestRIE* route);
 
-    // These methods inherited from base class
-    bool IsHost() const override;
-    bool IsNetwork() const override;
-    bool IsDefault() const override;
-    bool IsGateway() const override;
-    Ipv4Address GetGateway() const override;
-    Ipv4Address GetDest() const override;
-    Ipv4Address GetDestNetwork() const override;
-    Ipv4Mask GetDestNetworkMask() const override;
-    uint32_t GetInterface() const override;
-
     /**
      * \brief Get the output interface at next hop
      *
      * \return index of the interface
      */
-    uint32_t GetNextIface() const;
+    uint32_t GetNextIface() const
+    {
+        return GetRecordNextIface();
+    }
 
     /**
      * @brief Get the Distance to the destination
      *
      * @return the distance value
      */
-    uint32_t GetDistance() const;
+    uint32_t GetDistance() const
+    {
+        return GetRecordDistance();
+    }
 
     /**
      * \return An ShortestPathForestRIE object corresponding to the input parameters.
@@ -172,13 +167,6 @@ class ShortestPathForestRIE : public RouteInfoEntry
                           uint32_t interface,
                           uint32_t nextIface,
                           uint32_t distance);
-
-    Ipv4Address m_dest;         //!< destination address
-    Ipv4Mask m_destNetworkMask; //!< destination network mask
-    Ipv4Address m_gateway;      //!< gateway
-    uint32_t m_interface;       //!< output interface
-    uint32_t m_nextIface;       //!< output interface in next hop
-    uint32_t m_distance;        //!< the distance from current node to the destination
 };
 
 /**
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "address-interner.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulation-singleton.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AddressInterner");
+
+/// log2 of the slots of an empty table
+static const uint32_t INITIAL_SLOT_BITS = 6;
+
+AddressInterner::Table::Table()
+    : m_slots(1u << INITIAL_SLOT_BITS, Slot{0, NO_INDEX}),
+      m_shift(32 - INITIAL_SLOT_BITS)
+{
+}
+
+uint32_t
+AddressInterner::Table::GetHome(uint32_t key) const
+{
+    // Fibonacci hashing: the upper bits of the product mix all the key bits
+    return (key * 0x9e3779b1u) >> m_shift;
+}
+
+uint32_t
+AddressInterner::Table::Find(uint32_t key) const
+{
+    uint32_t mask = m_slots.size() - 1;
+    for (uint32_t slot = GetHome(key);; slot = (slot + 1) & mask)
+    {
+        const Slot& s = m_slots[slot];
+        if (s.index == NO_INDEX || s.key == key)
+        {
+            return s.index;
+        }
+    }
+}
+
+uint32_t
+AddressInterner::Table::Intern(uint32_t key)
+{
+    uint32_t mask = m_slots.size() - 1;
+    uint32_t slot = GetHome(key);
+    for (; m_slots[slot].index != NO_INDEX; slot = (slot + 1) & mask)
+    {
+        if (m_slots[slot].key == key)
+        {
+            return m_slots[slot].index;
+        }
+    }
+    uint32_t index = m_keys.size();
+    NS_ASSERT_MSG(index != NO_INDEX, "AddressInterner: too many keys");
+    m_keys.push_back(key);
+    m_slots[slot] = Slot{key, index};
+    // at most half full, so that a probe ends within a few slots
+    if (m_keys.size() * 2 > m_slots.size())
+    {
+        Grow();
+    }
+    return index;
+}
+
+void
+AddressInterner::Table::Grow()
+{
+    m_slots.assign(m_slots.size() * 2, Slot{0, NO_INDEX});
+    m_shift--;
+    uint32_t mask = m_slots.size() - 1;
+    for (uint32_t index = 0; index < m_keys.size(); index++)
+    {
+        uint32_t slot = GetHome(m_keys[index]);
+        while (m_slots[slot].index != NO_INDEX)
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = Slot{m_keys[index], index};
+    }
+}
+
+uint32_t
+AddressInterner::Table::GetKey(uint32_t index) const
+{
+    NS_ASSERT(index < m_keys.size());
+    return m_keys[index];
+}
+
+uint32_t
+AddressInterner::Table::GetN() const
+{
+    return m_keys.size();
+}
+
+std::size_t
+AddressInterner::Table::GetMemoryUsage() const
+{
+    return m_slots.capacity() * sizeof(Slot) + m_keys.capacity() * sizeof(uint32_t);
+}
+
+AddressInterner::AddressInterner()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+AddressInterner*
+AddressInterner::Get()
+{
+    return SimulationSingleton<AddressInterner>::Get();
+}
+
+uint32_t
+AddressInterner::InternRouter(Ipv4Address routerId)
+{
+    return m_routers.Intern(routerId.Get());
+}
+
+uint32_t
+AddressInterner::FindRouter(Ipv4Address routerId) const
+{
+    return m_routers.Find(routerId.Get());
+}
+
+Ipv4Address
+AddressInterner::GetRouterId(uint32_t index) const
+{
+    return Ipv4Address(m_routers.GetKey(index));
+}
+
+uint32_t
+AddressInterner::GetNRouters() const
+{
+    return m_routers.GetN();
+}
+
+uint32_t
+AddressInterner::InternAddress(Ipv4Address address)
+{
+    return m_addresses.Intern(address.Get());
+}
+
+uint32_t
+AddressInterner::FindAddress(Ipv4Address address) const
+{
+    return m_addresses.Find(address.Get());
+}
+
+Ipv4Address
+AddressInterner::GetAddress(uint32_t index) const
+{
+    return Ipv4Address(m_addresses.GetKey(index));
+}
+
+uint32_t
+AddressInterner::GetNAddresses() const
+{
+    return m_addresses.GetN();
+}
+
+std::size_t
+AddressInterner::GetMemoryUsage() const
+{
+    return m_routers.GetMemoryUsage() + m_addresses.GetMemoryUsage();
+}
+
+} // namespace ns3
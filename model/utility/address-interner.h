@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ADDRESS_INTERNER_H
+#define ADDRESS_INTERNER_H
+
+#include "ns3/ipv4-address.h"
+
+#include <cstddef>
+#include <limits>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Dense indices of the router IDs and interface addresses of the
+ * simulation, shared by the routing state of every node.
+ *
+ * RouterDirectory::Build () interns the router ID and the interface addresses
+ * of every node, in NodeList order, so that they get the indices 0, 1, ...;
+ * an address a route is later installed towards is interned then.  An index
+ * is never reused nor changed until the simulation is destroyed, so a table
+ * keyed by destination can be a plain array indexed by the index of the
+ * address, whatever happens to the LSDB or to the routes.
+ *
+ * Each namespace is a flat open-addressing table probed with one
+ * multiplication, whose slots hold the address and its index side by side:
+ * a packet finds the index of its destination once, and every table of the
+ * routing protocol then reads its entry by index instead of hashing the
+ * address again.
+ *
+ * Get () returns the interner of the simulation.  Find () only reads the
+ * tables and may be called by the worker threads of a route computation;
+ * Intern () is for the simulation thread only.
+ */
+class AddressInterner
+{
+  public:
+    /// index returned for an address that is not interned
+    static constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+    AddressInterner();
+
+    /**
+     * \return the interner of the simulation
+     */
+    static AddressInterner* Get();
+
+    /**
+     * \param routerId a router ID
+     * \return its index, interned on the first call
+     */
+    uint32_t InternRouter(Ipv4Address routerId);
+
+    /**
+     * \param routerId a router ID
+     * \return its index, or NO_INDEX if it is not interned
+     */
+    uint32_t FindRouter(Ipv4Address routerId) const;
+
+    /**
+     * \param index the index of a router ID
+     * \return the router ID
+     */
+    Ipv4Address GetRouterId(uint32_t index) const;
+
+    /**
+     * \return the number of router IDs interned, the bound of their indices
+     */
+    uint32_t GetNRouters() const;
+
+    /**
+     * \param address an address
+     * \return its index, interned on the first call
+     */
+    uint32_t InternAddress(Ipv4Address address);
+
+    /**
+     * \param address an address
+     * \return its index, or NO_INDEX if it is not interned
+     */
+    uint32_t FindAddress(Ipv4Address address) const;
+
+    /**
+     * \param index the index of an address
+     * \return the address
+     */
+    Ipv4Address GetAddress(uint32_t index) const;
+
+    /**
+     * \return the number of addresses interned, the bound of their indices
+     */
+    uint32_t GetNAddresses() const;
+
+    /**
+     * \return the number of bytes of the tables
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    /// the indices of one namespace
+    class Table
+    {
+      public:
+        Table();
+
+        /**
+         * \param key a key
+         * \return its index, interned on the first call
+         */
+        uint32_t Intern(uint32_t key);
+
+        /**
+         * \param key a key
+         * \return its index, or NO_INDEX if it is not interned
+         */
+        uint32_t Find(uint32_t key) const;
+
+        /**
+         * \param index an index
+         * \return the key of the index
+         */
+        uint32_t GetKey(uint32_t index) const;
+
+        /**
+         * \return the number of keys interned
+         */
+        uint32_t GetN() const;
+
+        /**
+         * \return the number of bytes of the table
+         */
+        std::size_t GetMemoryUsage() const;
+
+      private:
+        /// a slot of the table, empty while index is NO_INDEX
+        struct Slot
+        {
+            uint32_t key;   //!< the key
+            uint32_t index; //!< its index
+        };
+
+        /**
+         * \param key a key
+         * \return the first slot to probe for the key
+         */
+        uint32_t GetHome(uint32_t key) const;
+
+        /**
+         * \brief Double the slots and place the keys again.
+         */
+        void Grow();
+
+        std::vector<Slot> m_slots;    //!< the slots, a power of two of them
+        uint32_t m_shift;             //!< 32 minus log2 of the slots
+        std::vector<uint32_t> m_keys; //!< the keys, by index
+    };
+
+    Table m_routers;   //!< the router IDs
+    Table m_addresses; //!< the interface and destination addresses
+};
+
+} // namespace ns3
+
+#endif /* ADDRESS_INTERNER_H */
@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "agent-channel.h"
+
+#include "../ddr-routing.h"
+#include "address-interner.h"
+#include "romam-router.h"
+
+#include "ns3/ipv4.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AgentChannel");
+
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t) &&
+                  sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "the shared atomics must have the layout of their values");
+
+/// column of the addresses of no destination
+static const uint32_t NO_COLUMN = UINT32_MAX;
+
+/**
+ * \param bytes a size
+ * \return the size rounded up to a cache line
+ */
+static std::size_t
+AlignToLine(std::size_t bytes)
+{
+    return (bytes + 63) & ~static_cast<std::size_t>(63);
+}
+
+/**
+ * \param node a node
+ * \return its DDR routing, or null if it has none
+ */
+static Ptr<DDRRouting>
+GetDDRRouting(Ptr<Node> node)
+{
+    Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
+    return router ? DynamicCast<DDRRouting>(router->GetRoutingProtocol()) : nullptr;
+}
+
+AgentChannel::AgentChannel()
+    : m_interval(MilliSeconds(10)),
+      m_slots(16),
+      m_map(nullptr),
+      m_size(0),
+      m_header(nullptr),
+      m_decisions(nullptr)
+{
+}
+
+AgentChannel::~AgentChannel()
+{
+    Close();
+}
+
+void
+AgentChannel::SetInterval(Time interval)
+{
+    NS_ABORT_MSG_IF(!interval.IsStrictlyPositive(), "The export interval must be positive");
+    m_interval = interval;
+}
+
+void
+AgentChannel::SetSlots(uint32_t slots)
+{
+    NS_ABORT_MSG_IF(slots == 0, "The ring needs a slot");
+    m_slots = slots;
+}
+
+uint32_t
+AgentChannel::Install(const std::string& path)
+{
+    NS_LOG_FUNCTION(this << path);
+    Close();
+    uint32_t nInterfaces = 0;
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<Ipv4> ipv4 = (*i)->GetObject<Ipv4>();
+        Ptr<RomamRouter> router = (*i)->GetObject<RomamRouter>();
+        if (!ipv4 || !router || !router->GetRoutingProtocol())
+        {
+            continue;
+        }
+        // a packet to any address of a router is a packet to the router
+        uint32_t column = m_dests.size();
+        m_dests.push_back(RomamRouter::GetNodeAddress(ipv4));
+        AddressInterner* interner = AddressInterner::Get();
+        std::vector<uint32_t> indices(1, interner->InternAddress(m_dests.back()));
+        for (uint32_t j = 1; j < ipv4->GetNInterfaces(); j++)
+        {
+            for (uint32_t a = 0; a < ipv4->GetNAddresses(j); a++)
+            {
+                indices.push_back(interner->InternAddress(ipv4->GetAddress(j, a).GetLocal()));
+            }
+        }
+        for (uint32_t index : indices)
+        {
+            if (index >= m_columns.size())
+            {
+                m_columns.resize(index + 1, NO_COLUMN);
+            }
+            m_columns[index] = column;
+        }
+        if (GetDDRRouting(*i))
+        {
+            m_nodes.push_back((*i)->GetId());
+            nInterfaces = std::max(nInterfaces, ipv4->GetNInterfaces());
+        }
+    }
+    uint32_t nNodes = m_nodes.size();
+    uint32_t nDests = m_dests.size();
+    if (nNodes == 0)
+    {
+        NS_LOG_WARN("No DDR router to attach");
+        Close();
+        return 0;
+    }
+
+    std::size_t rowFloats = nInterfaces * (IFACE_FEATURES + nDests * ROUTE_FEATURES);
+    std::size_t directory = AlignToLine(sizeof(Header));
+    std::size_t slots = directory + AlignToLine((nNodes + nDests) * sizeof(uint32_t));
+    std::size_t slotBytes = AlignToLine(sizeof(SlotHeader) + nNodes * rowFloats * sizeof(float));
+    std::size_t decisions = slots + m_slots * slotBytes;
+    std::size_t size = decisions + AlignToLine(nNodes * nDests * sizeof(int32_t));
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        NS_LOG_WARN("Cannot create " << path);
+        Close();
+        return 0;
+    }
+    void* map = MAP_FAILED;
+    if (ftruncate(fd, size) == 0)
+    {
+        map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd); // the mapping keeps the file
+    if (map == MAP_FAILED)
+    {
+        NS_LOG_WARN("Cannot map " << size << " bytes of " << path);
+        Close();
+        return 0;
+    }
+    m_map = static_cast<char*>(map);
+    m_size = size;
+
+    // the file is zeroed, so the slots are unwritten and there is no decision
+    m_header = new (m_map) Header();
+    std::memcpy(m_header->magic, "ROMAMAGT", sizeof(m_header->magic));
+    m_header->format = FORMAT;
+    m_header->nodes = nNodes;
+    m_header->interfaces = nInterfaces;
+    m_header->destinations = nDests;
+    m_header->slots = m_slots;
+    m_header->interfaceFeatures = IFACE_FEATURES;
+    m_header->routeFeatures = ROUTE_FEATURES;
+    m_header->padding = 0;
+    m_header->directoryOffset = directory;
+    m_header->slotOffset = slots;
+    m_header->slotBytes = slotBytes;
+    m_header->decisionOffset = decisions;
+    m_header->interval = m_interval.GetNanoSeconds();
+    m_header->published.store(0);
+    m_header->decisions.store(0);
+    uint32_t* ids = reinterpret_cast<uint32_t*>(m_map + directory);
+    std::copy(m_nodes.begin(), m_nodes.end(), ids);
+    for (uint32_t d = 0; d < nDests; d++)
+    {
+        ids[nNodes + d] = m_dests[d].Get();
+    }
+    m_decisions = reinterpret_cast<std::atomic<int32_t>*>(m_map + decisions);
+
+    for (uint32_t row = 0; row < nNodes; row++)
+    {
+        GetDDRRouting(NodeList::GetNode(m_nodes[row]))->SetAgentChannel(this, row);
+    }
+    NS_LOG_INFO("Mapped " << size << " bytes for " << nNodes << " routers and " << nDests
+                          << " destinations");
+    // once the nodes started
+    m_exportEvent = Simulator::ScheduleNow(&AgentChannel::Export, this);
+    return nNodes;
+}
+
+uint32_t
+AgentChannel::GetDecision(uint32_t node, Ipv4Address dest) const
+{
+    NS_ASSERT(node < m_nodes.size());
+    uint32_t index = AddressInterner::Get()->FindAddress(dest);
+    if (index >= m_columns.size() || m_columns[index] == NO_COLUMN)
+    {
+        return 0;
+    }
+    // the agent may write it at any time, the last value written is as good
+    int32_t iface =
+        m_decisions[node * m_dests.size() + m_columns[index]].load(std::memory_order_relaxed);
+    return iface > 0 ? iface : 0;
+}
+
+uint64_t
+AgentChannel::GetNPublished() const
+{
+    return m_header ? m_header->published.load(std::memory_order_relaxed) : 0;
+}
+
+std::size_t
+AgentChannel::GetSize() const
+{
+    return m_size;
+}
+
+void
+AgentChannel::Export()
+{
+    uint64_t n = m_header->published.load(std::memory_order_relaxed);
+    SlotHeader* slot = reinterpret_cast<SlotHeader*>(m_map + m_header->slotOffset +
+                                                     (n % m_slots) * m_header->slotBytes);
+    slot->sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->time = Simulator::Now().GetNanoSeconds();
+    uint32_t nInterfaces = m_header->interfaces;
+    std::size_t rowFloats = nInterfaces * (IFACE_FEATURES + m_dests.size() * ROUTE_FEATURES);
+    float* features = reinterpret_cast<float*>(slot + 1);
+    for (uint32_t row = 0; row < m_nodes.size(); row++)
+    {
+        float* ifaces = features + row * rowFloats;
+        GetDDRRouting(NodeList::GetNode(m_nodes[row]))
+            ->FillAgentFeatures(ifaces,
+                                nInterfaces,
+                                ifaces + nInterfaces * IFACE_FEATURES,
+                                m_dests);
+    }
+    slot->sequence.store(2 * n + 2, std::memory_order_release);
+    m_header->published.store(n + 1, std::memory_order_release);
+    m_exportEvent = Simulator::Schedule(m_interval, &AgentChannel::Export, this);
+}
+
+void
+AgentChannel::Close()
+{
+    m_exportEvent.Cancel();
+    for (uint32_t row = 0; row < m_nodes.size(); row++)
+    {
+        // the nodes are gone once the simulator is destroyed
+        Ptr<DDRRouting> routing = m_nodes[row] < NodeList::GetNNodes()
+                                      ? GetDDRRouting(NodeList::GetNode(m_nodes[row]))
+                                      : nullptr;
+        if (routing)
+        {
+            routing->SetAgentChannel(nullptr, 0);
+        }
+    }
+    if (m_map)
+    {
+        munmap(m_map, m_size);
+    }
+    m_map = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_decisions = nullptr;
+    m_nodes.clear();
+    m_dests.clear();
+    m_columns.clear();
+}
+
+} // namespace ns3
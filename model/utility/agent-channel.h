@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef AGENT_CHANNEL_H
+#define AGENT_CHANNEL_H
+
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief A shared memory channel between the DDR routers and an external
+ * learning agent: the routers publish their state in it, and read back the
+ * route decisions of the agent.
+ *
+ * Install () maps a file, /dev/shm/... for POSIX shared memory, and lays it
+ * out as a Header, the node IDs and destination addresses, a ring of slots
+ * and a table of decisions, all in the byte order of the host, which the
+ * agent maps too.  Every interval of simulation time, the features of every
+ * router are written in place into the next slot of the ring, as float
+ * tensors: by interface, whether it is up, the occupancy level and the delay
+ * estimate of its queue disc; by destination and interface, the distance of
+ * the shortest candidate route through the interface and its delay estimate
+ * from the queue disc and the TSDB, -1 for no candidate.  A slot is guarded
+ * by a sequence number, odd while it is written, that the agent reads before
+ * and after copying it; Header::published counts the slots written.
+ *
+ * The agent writes the decision of a router for a destination as the
+ * interface to send its budgeted packets on, 0 for none.  A lookup takes it
+ * if a candidate route of its route select mode goes through the interface,
+ * and not back through the incoming one, and looks the route up as usual
+ * otherwise.  The decisions are read with relaxed atomics, so neither side
+ * ever waits for the other, and nothing is serialized.
+ *
+ * The export events refer to the channel, which must outlive the
+ * simulation.  The file is left for the agent when the channel goes.
+ */
+class AgentChannel
+{
+  public:
+    /// the start of the channel
+    struct Header
+    {
+        char magic[8];                   //!< "ROMAMAGT"
+        uint32_t format;                 //!< FORMAT
+        uint32_t nodes;                  //!< routers, the rows of the tensors
+        uint32_t interfaces;             //!< interfaces of a row, the most of a router
+        uint32_t destinations;           //!< destinations of a row
+        uint32_t slots;                  //!< slots of the ring
+        uint32_t interfaceFeatures;      //!< values of an interface, IFACE_FEATURES
+        uint32_t routeFeatures;          //!< values of a destination and interface
+        uint32_t padding;                //!< unused, 0
+        uint64_t directoryOffset;        //!< offset of the node IDs then the destinations
+        uint64_t slotOffset;             //!< offset of the first slot
+        uint64_t slotBytes;              //!< bytes of a slot, its SlotHeader included
+        uint64_t decisionOffset;         //!< offset of the int32 decisions, node by destination
+        int64_t interval;                //!< simulation time between two slots, in ns
+        std::atomic<uint64_t> published; //!< slots written so far
+        std::atomic<uint64_t> decisions; //!< free for the agent to count its decision rounds
+    };
+
+    /// the start of a slot, followed by the float features of the nodes
+    struct SlotHeader
+    {
+        std::atomic<uint64_t> sequence; //!< 2 n + 1 while the n-th slot is written, then 2 n + 2
+        int64_t time;                   //!< simulation time of the features, in ns
+    };
+
+    /// the format of the layout
+    static const uint32_t FORMAT = 1;
+
+    /// features of an interface: up, occupancy level, delay estimate in us
+    static const uint32_t IFACE_FEATURES = 3;
+
+    /// features of a destination and interface: distance, delay estimate in us
+    static const uint32_t ROUTE_FEATURES = 2;
+
+    AgentChannel();
+
+    /**
+     * \brief Unmap the file, keeping it.
+     */
+    ~AgentChannel();
+
+    /**
+     * \param interval the time from one slot to the next, 10 ms by default
+     */
+    void SetInterval(Time interval);
+
+    /**
+     * \param slots the slots of the ring, 16 by default
+     */
+    void SetSlots(uint32_t slots);
+
+    /**
+     * \brief Map the file, attach the DDR routers of all the nodes to the
+     * channel and write the first slot at the current time.
+     *
+     * The routes must be installed.  The destinations are the
+     * RomamRouter::GetNodeAddress () of the routers, a destination standing
+     * for every address of its router.
+     *
+     * \param path the file, created or replaced
+     * \return the number of routers attached, 0 if the file cannot be mapped
+     */
+    uint32_t Install(const std::string& path);
+
+    /**
+     * \param node the row of a router
+     * \param dest the destination address of a packet
+     * \return the interface the agent decided for the router and the
+     * destination, 0 for none
+     */
+    uint32_t GetDecision(uint32_t node, Ipv4Address dest) const;
+
+    /**
+     * \return the slots written so far
+     */
+    uint64_t GetNPublished() const;
+
+    /**
+     * \return the bytes of the file
+     */
+    std::size_t GetSize() const;
+
+  private:
+    /**
+     * \brief Write the features of the routers into the next slot, and
+     * schedule the next export.
+     */
+    void Export();
+
+    /**
+     * \brief Unmap the file.
+     */
+    void Close();
+
+    AgentChannel(const AgentChannel&) = delete;
+    AgentChannel& operator=(const AgentChannel&) = delete;
+
+    Time m_interval;                   //!< time from one slot to the next
+    uint32_t m_slots;                  //!< slots of the ring
+    char* m_map;                       //!< the mapped file, null until installed
+    std::size_t m_size;                //!< bytes of the mapping
+    Header* m_header;                  //!< the header, in the mapping
+    std::atomic<int32_t>* m_decisions; //!< the decisions, in the mapping
+    std::vector<uint32_t> m_nodes;     //!< the node IDs of the rows
+    std::vector<Ipv4Address> m_dests;  //!< the destinations, by column
+    std::vector<uint32_t> m_columns;   //!< column of an address, by interned index
+    EventId m_exportEvent;             //!< the next export
+};
+
+} // namespace ns3
+
+#endif /* AGENT_CHANNEL_H */
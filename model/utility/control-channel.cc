@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "control-channel.h"
+
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ControlChannel");
+
+NS_OBJECT_ENSURE_REGISTERED(ControlChannel);
+
+TypeId
+ControlChannel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::ControlChannel").SetParent<IpL4Protocol>().SetGroupName("Romam");
+    return tid;
+}
+
+ControlChannel::ControlChannel()
+    : m_protocol(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+ControlChannel::~ControlChannel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+Ptr<ControlChannel>
+ControlChannel::GetChannel(Ptr<Ipv4> ipv4, uint8_t protocol)
+{
+    Ptr<IpL4Protocol> existing = ipv4->GetProtocol(protocol);
+    if (existing)
+    {
+        Ptr<ControlChannel> channel = DynamicCast<ControlChannel>(existing);
+        NS_ABORT_MSG_IF(!channel, "IP protocol " << int(protocol) << " is already in use");
+        return channel;
+    }
+    Ptr<ControlChannel> channel = CreateObject<ControlChannel>();
+    channel->m_ipv4 = ipv4;
+    channel->m_protocol = protocol;
+    channel->SetDownTarget(MakeCallback(&Ipv4::Send, ipv4));
+    ipv4->Insert(channel);
+    return channel;
+}
+
+void
+ControlChannel::SetReceiveCallback(ReceiveCallback cb)
+{
+    m_receive = cb;
+}
+
+void
+ControlChannel::Send(Ptr<Packet> p, uint32_t interface, Ipv4Address group)
+{
+    NS_LOG_FUNCTION(this << p << interface << group);
+    Ipv4Address source;
+    for (uint32_t j = 0; j < m_ipv4->GetNAddresses(interface); j++)
+    {
+        if (m_ipv4->GetAddress(interface, j).GetScope() != Ipv4InterfaceAddress::HOST)
+        {
+            source = m_ipv4->GetAddress(interface, j).GetLocal();
+            break;
+        }
+    }
+    if (!source.IsInitialized())
+    {
+        NS_LOG_WARN("No address to send from on interface " << interface);
+        return;
+    }
+    // the neighbors only, and the group needs no next hop
+    Ptr<Ipv4Route> route = Create<Ipv4Route>();
+    route->SetDestination(group);
+    route->SetGateway(group);
+    route->SetSource(source);
+    route->SetOutputDevice(m_ipv4->GetNetDevice(interface));
+    SocketIpTtlTag ttlTag;
+    p->RemovePacketTag(ttlTag);
+    ttlTag.SetTtl(1);
+    p->AddPacketTag(ttlTag);
+    m_downTarget(p, source, group, m_protocol, route);
+}
+
+int
+ControlChannel::GetProtocolNumber() const
+{
+    return m_protocol;
+}
+
+IpL4Protocol::RxStatus
+ControlChannel::Receive(Ptr<Packet> p,
+                        const Ipv4Header& header,
+                        Ptr<Ipv4Interface> incomingInterface)
+{
+    NS_LOG_FUNCTION(this << p << header << incomingInterface);
+    if (m_receive.IsNull())
+    {
+        return IpL4Protocol::RX_ENDPOINT_UNREACH;
+    }
+    int32_t interface = m_ipv4->GetInterfaceForDevice(incomingInterface->GetDevice());
+    NS_ASSERT(interface >= 0);
+    m_receive(p, header.GetSource(), interface, header.GetTtl());
+    return IpL4Protocol::RX_OK;
+}
+
+IpL4Protocol::RxStatus
+ControlChannel::Receive(Ptr<Packet> p,
+                        const Ipv6Header& header,
+                        Ptr<Ipv6Interface> incomingInterface)
+{
+    NS_LOG_FUNCTION(this << p << incomingInterface);
+    return IpL4Protocol::RX_ENDPOINT_UNREACH;
+}
+
+void
+ControlChannel::SetDownTarget(IpL4Protocol::DownTargetCallback cb)
+{
+    m_downTarget = cb;
+}
+
+void
+ControlChannel::SetDownTarget6(IpL4Protocol::DownTargetCallback6 cb)
+{
+    m_downTarget6 = cb;
+}
+
+IpL4Protocol::DownTargetCallback
+ControlChannel::GetDownTarget() const
+{
+    return m_downTarget;
+}
+
+IpL4Protocol::DownTargetCallback6
+ControlChannel::GetDownTarget6() const
+{
+    return m_downTarget6;
+}
+
+void
+ControlChannel::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_receive = MakeNullCallback<void, Ptr<Packet>, Ipv4Address, uint32_t, uint8_t>();
+    m_downTarget = IpL4Protocol::DownTargetCallback();
+    m_ipv4 = nullptr;
+    IpL4Protocol::DoDispose();
+}
+
+} // namespace ns3
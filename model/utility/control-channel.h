@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef CONTROL_CHANNEL_H
+#define CONTROL_CHANNEL_H
+
+#include "ns3/callback.h"
+#include "ns3/ip-l4-protocol.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ptr.h"
+
+#include <stdint.h>
+
+namespace ns3
+{
+
+class Ipv4;
+
+/**
+ * \brief A link-local channel for the control messages of a routing
+ * protocol, an IP protocol of its own in place of UDP sockets.
+ *
+ * With sockets, a router binds a UDP socket to every address of every
+ * interface, plus one to the multicast group of its protocol, and a message
+ * climbs through a UDP endpoint demux, the receive buffer of a socket and
+ * the packet info and TTL tags before the protocol sees it.  The channel is
+ * instead one IpL4Protocol per node and protocol number, which the local
+ * delivery of Ipv4L3Protocol hands the messages to directly, along with the
+ * IP header and the interface they came in on.  A message is sent to the
+ * neighbors on an interface with a TTL of 1, through an explicit route to the
+ * multicast group of the protocol out of the device of the interface, so no
+ * route is looked up either.
+ *
+ * GetChannel () returns the channel of a protocol number of a node, inserted
+ * into its Ipv4 on the first call.  A channel has one receiver, the routing
+ * protocol of the node using the number.
+ */
+class ControlChannel : public IpL4Protocol
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    /// a message: the packet, the sender, the interface it came in on, its TTL
+    typedef Callback<void, Ptr<Packet>, Ipv4Address, uint32_t, uint8_t> ReceiveCallback;
+
+    ControlChannel();
+    ~ControlChannel() override;
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    ControlChannel(const ControlChannel&) = delete;
+    ControlChannel& operator=(const ControlChannel&) = delete;
+
+    /**
+     * \param ipv4 the Ipv4 of a node
+     * \param protocol an IP protocol number, which no other protocol of the
+     * node may use
+     * \return the channel of the number, inserted into ipv4 on the first call
+     */
+    static Ptr<ControlChannel> GetChannel(Ptr<Ipv4> ipv4, uint8_t protocol);
+
+    /**
+     * \param cb what to call with every message received, null for nothing
+     */
+    void SetReceiveCallback(ReceiveCallback cb);
+
+    /**
+     * \brief Send a message to the neighbors on an interface, from its first
+     * address and with a TTL of 1.
+     * \param p the message
+     * \param interface the interface index
+     * \param group the multicast group of the protocol
+     */
+    void Send(Ptr<Packet> p, uint32_t interface, Ipv4Address group);
+
+    // inherited from IpL4Protocol
+    int GetProtocolNumber() const override;
+    IpL4Protocol::RxStatus Receive(Ptr<Packet> p,
+                                   const Ipv4Header& header,
+                                   Ptr<Ipv4Interface> incomingInterface) override;
+    IpL4Protocol::RxStatus Receive(Ptr<Packet> p,
+                                   const Ipv6Header& header,
+                                   Ptr<Ipv6Interface> incomingInterface) override;
+    void SetDownTarget(IpL4Protocol::DownTargetCallback cb) override;
+    void SetDownTarget6(IpL4Protocol::DownTargetCallback6 cb) override;
+    IpL4Protocol::DownTargetCallback GetDownTarget() const override;
+    IpL4Protocol::DownTargetCallback6 GetDownTarget6() const override;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    Ptr<Ipv4> m_ipv4;                                //!< the Ipv4 the channel is inserted into
+    uint8_t m_protocol;                              //!< the IP protocol number
+    ReceiveCallback m_receive;                       //!< the receiver of the messages
+    IpL4Protocol::DownTargetCallback m_downTarget;   //!< the Ipv4 send
+    IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< unused, the channel is IPv4 only
+};
+
+} // namespace ns3
+
+#endif /* CONTROL_CHANNEL_H */
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "decision-trace.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DecisionTrace");
+
+/// the magic of a decision trace
+static const char DECISION_TRACE_MAGIC[8] = {'R', 'D', 'T', 'R', 'A', 'C', 'E', '1'};
+
+/// the header of a decision trace
+struct DecisionTraceHeader
+{
+    char magic[8];       //!< DECISION_TRACE_MAGIC
+    uint32_t recordSize; //!< sizeof (DecisionTrace::Record)
+    uint32_t nodeId;     //!< the node traced
+};
+
+/// the header of a block of records
+struct DecisionTraceBlock
+{
+    uint64_t nRecords; //!< records of the block
+    uint64_t nLost;    //!< records lost before the block
+};
+
+static_assert(sizeof(DecisionTrace::Record) == 32, "A decision record takes 32 bytes");
+
+DecisionTrace::DecisionTrace(const std::string& path,
+                             uint32_t nodeId,
+                             uint32_t capacity,
+                             Time interval)
+    : m_out(path, std::ios::binary | std::ios::trunc),
+      m_ring(capacity),
+      m_head(0),
+      m_size(0),
+      m_nLost(0),
+      m_totalLost(0),
+      m_interval(interval)
+{
+    NS_LOG_FUNCTION(this << path << nodeId << capacity << interval);
+    NS_ABORT_MSG_IF(capacity == 0, "A decision trace needs room for a record");
+    NS_ABORT_MSG_IF(!m_out, "Cannot write the decision trace " << path);
+    DecisionTraceHeader header;
+    std::memcpy(header.magic, DECISION_TRACE_MAGIC, sizeof(header.magic));
+    header.recordSize = sizeof(Record);
+    header.nodeId = nodeId;
+    m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_pending.reserve(capacity);
+    if (m_interval.IsStrictlyPositive())
+    {
+        m_flushEvent = Simulator::Schedule(m_interval, &DecisionTrace::PeriodicFlush, this);
+    }
+}
+
+DecisionTrace::~DecisionTrace()
+{
+    NS_LOG_FUNCTION(this);
+    m_flushEvent.Cancel();
+    Flush();
+    Join();
+    if (m_totalLost > 0)
+    {
+        NS_LOG_WARN(m_totalLost << " decisions were overwritten before their flush");
+    }
+}
+
+void
+DecisionTrace::Add(Ipv4Address dest,
+                   int32_t iface,
+                   uint32_t candidates,
+                   uint32_t budget,
+                   uint32_t estimate,
+                   uint32_t distance,
+                   Reason reason)
+{
+    uint32_t capacity = m_ring.size();
+    uint32_t slot = m_head + m_size;
+    if (slot >= capacity)
+    {
+        slot -= capacity;
+    }
+    if (m_size == capacity)
+    {
+        // the ring is full, the new record takes the place of the oldest one
+        m_head = m_head + 1 == capacity ? 0 : m_head + 1;
+        m_nLost++;
+    }
+    else
+    {
+        m_size++;
+    }
+    Record& record = m_ring[slot];
+    record.time = Simulator::Now().GetNanoSeconds();
+    record.dest = dest.Get();
+    record.iface = iface;
+    record.budget = budget;
+    record.estimate = estimate;
+    record.distance = distance;
+    record.candidates = std::min<uint32_t>(candidates, UINT16_MAX);
+    record.reason = reason;
+    record.padding = 0;
+}
+
+void
+DecisionTrace::Flush()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_size == 0 && m_nLost == 0)
+    {
+        return;
+    }
+    Join();
+    m_pending.clear();
+    uint32_t capacity = m_ring.size();
+    uint32_t first = std::min(m_size, capacity - m_head);
+    m_pending.insert(m_pending.end(), m_ring.begin() + m_head, m_ring.begin() + m_head + first);
+    m_pending.insert(m_pending.end(), m_ring.begin(), m_ring.begin() + (m_size - first));
+    m_writer = std::thread(&DecisionTrace::WriteBlock, &m_out, &m_pending, m_nLost);
+    m_totalLost += m_nLost;
+    m_head = 0;
+    m_size = 0;
+    m_nLost = 0;
+}
+
+uint64_t
+DecisionTrace::GetNLost() const
+{
+    return m_totalLost + m_nLost;
+}
+
+const char*
+DecisionTrace::GetReasonName(Reason reason)
+{
+    switch (reason)
+    {
+    case FEASIBLE:
+        return "feasible";
+    case LOOP_LIMIT:
+        return "loop_limit";
+    case BUDGET_LIMIT:
+        return "budget_limit";
+    case EXHAUSTED:
+        return "exhausted";
+    default:
+        NS_ASSERT_MSG(false, "Unknown reason " << reason);
+        return "";
+    }
+}
+
+bool
+DecisionTrace::Decode(std::istream& is, std::ostream& os)
+{
+    DecisionTraceHeader header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, DECISION_TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.recordSize != sizeof(Record))
+    {
+        return false;
+    }
+    os << "node,time_ns,dest,iface,candidates,budget_us,estimate_us,distance,reason\n";
+    DecisionTraceBlock block;
+    std::vector<Record> records;
+    while (is.read(reinterpret_cast<char*>(&block), sizeof(block)))
+    {
+        if (block.nLost > 0)
+        {
+            os << "# " << block.nLost << " decisions lost\n";
+        }
+        records.resize(block.nRecords);
+        if (!is.read(reinterpret_cast<char*>(records.data()), block.nRecords * sizeof(Record)))
+        {
+            return false;
+        }
+        for (const Record& record : records)
+        {
+            os << header.nodeId << ',' << record.time << ',' << Ipv4Address(record.dest) << ','
+               << record.iface << ',' << record.candidates << ',' << record.budget << ',';
+            if (record.estimate != NO_VALUE)
+            {
+                os << record.estimate;
+            }
+            os << ',';
+            if (record.distance != NO_VALUE)
+            {
+                os << record.distance;
+            }
+            os << ','
+               << (record.reason < N_REASONS ? GetReasonName(static_cast<Reason>(record.reason))
+                                             : "unknown")
+               << '\n';
+        }
+    }
+    return is.eof() && is.gcount() == 0;
+}
+
+void
+DecisionTrace::WriteBlock(std::ofstream* out, const std::vector<Record>* records, uint64_t nLost)
+{
+    DecisionTraceBlock block;
+    block.nRecords = records->size();
+    block.nLost = nLost;
+    out->write(reinterpret_cast<const char*>(&block), sizeof(block));
+    out->write(reinterpret_cast<const char*>(records->data()), records->size() * sizeof(Record));
+    out->flush();
+}
+
+void
+DecisionTrace::PeriodicFlush()
+{
+    Flush();
+    m_flushEvent = Simulator::Schedule(m_interval, &DecisionTrace::PeriodicFlush, this);
+}
+
+void
+DecisionTrace::Join()
+{
+    if (m_writer.joinable())
+    {
+        m_writer.join();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef DECISION_TRACE_H
+#define DECISION_TRACE_H
+
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief A compact binary trace of the budgeted route decisions of a node.
+ *
+ * Every decision is a fixed 32-byte record, kept in a ring buffer of a
+ * bounded number of records.  At every interval of simulation time, the
+ * records buffered are handed to a writer thread that appends them to the
+ * file as one block while the simulation goes on; when more decisions are
+ * taken in an interval than the ring holds, the oldest ones are overwritten
+ * and the block counts them as lost.
+ *
+ * The file starts with a header of the magic "RDTRACE1", the size of a
+ * record and the node id, all in the byte order of the host that wrote it.
+ * Decode () prints a trace as CSV, and the romam-decision-trace-decoder
+ * example wraps it as a tool.
+ */
+class DecisionTrace
+{
+  public:
+    /// why a lookup ended
+    enum Reason
+    {
+        FEASIBLE,     //!< the route taken is estimated to meet the budget
+        LOOP_LIMIT,   //!< the candidates left are farther than the previous hop
+        BUDGET_LIMIT, //!< the candidates left cannot meet the budget
+        EXHAUSTED,    //!< every candidate was rejected
+        N_REASONS     //!< number of reasons
+    };
+
+    /// a decision
+    struct Record
+    {
+        int64_t time;        //!< simulation time of the decision, in ns
+        uint32_t dest;       //!< destination address
+        int32_t iface;       //!< interface of the route taken, -1 if none
+        uint32_t budget;     //!< budget left to the packet, in us
+        uint32_t estimate;   //!< estimated delay of the route taken, NO_VALUE if none
+        uint32_t distance;   //!< distance of the route taken, NO_VALUE if none
+        uint16_t candidates; //!< candidate routes considered, saturated
+        uint8_t reason;      //!< the Reason
+        uint8_t padding;     //!< unused, 0
+    };
+
+    /// value of the estimate or the distance of a record that has none
+    static const uint32_t NO_VALUE = UINT32_MAX;
+
+    /**
+     * \param path the file the trace is written to
+     * \param nodeId the id of the node traced
+     * \param capacity the number of records of the ring buffer
+     * \param interval the simulation time from one flush of the buffer to the next
+     */
+    DecisionTrace(const std::string& path, uint32_t nodeId, uint32_t capacity, Time interval);
+
+    /**
+     * \brief Flush the records left and wait for them to be written.
+     */
+    ~DecisionTrace();
+
+    /**
+     * \brief Record a decision, at the current simulation time.
+     * \param dest destination address
+     * \param iface interface of the route taken, -1 if none
+     * \param candidates candidate routes considered
+     * \param budget budget left to the packet, in us
+     * \param estimate estimated delay of the route taken, in us, or NO_VALUE
+     * \param distance distance of the route taken, or NO_VALUE
+     * \param reason why the lookup ended
+     */
+    void Add(Ipv4Address dest,
+             int32_t iface,
+             uint32_t candidates,
+             uint32_t budget,
+             uint32_t estimate,
+             uint32_t distance,
+             Reason reason);
+
+    /**
+     * \brief Hand the records buffered to the writer thread, after the
+     * previous block is written.
+     */
+    void Flush();
+
+    /**
+     * \return the number of records overwritten before their flush so far
+     */
+    uint64_t GetNLost() const;
+
+    /**
+     * \param reason a reason
+     * \return the name of the reason
+     */
+    static const char* GetReasonName(Reason reason);
+
+    /**
+     * \brief Print a trace as CSV: a header line, then a line per record.
+     * \param is the trace
+     * \param os the output stream
+     * \return false if the trace is not a decision trace or is truncated
+     */
+    static bool Decode(std::istream& is, std::ostream& os);
+
+  private:
+    /**
+     * \brief Write a block of records, on the writer thread.
+     * \param out the trace file
+     * \param records the records, oldest first
+     * \param nLost the records lost since the previous block
+     */
+    static void WriteBlock(std::ofstream* out, const std::vector<Record>* records, uint64_t nLost);
+
+    /**
+     * \brief Flush, and schedule the next flush.
+     */
+    void PeriodicFlush();
+
+    /**
+     * \brief Wait until the block handed to the writer thread is written.
+     */
+    void Join();
+
+    DecisionTrace(const DecisionTrace&) = delete;
+    DecisionTrace& operator=(const DecisionTrace&) = delete;
+
+    std::ofstream m_out;           //!< the trace file, written by the writer thread
+    std::vector<Record> m_ring;    //!< the ring buffer
+    uint32_t m_head;               //!< index of the oldest record of the ring
+    uint32_t m_size;               //!< records in the ring
+    uint64_t m_nLost;              //!< records overwritten since the last flush
+    uint64_t m_totalLost;          //!< records overwritten so far
+    std::vector<Record> m_pending; //!< the block the writer thread writes
+    std::thread m_writer;          //!< the writer thread of the last block
+    Time m_interval;               //!< time from one flush to the next
+    EventId m_flushEvent;          //!< the next flush
+};
+
+} // namespace ns3
+
+#endif /* DECISION_TRACE_H */
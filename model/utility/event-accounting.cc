@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "event-accounting.h"
+
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EventAccounting");
+
+/// whether the events of the Romam code are accounted for
+static GlobalValue g_eventAccounting("RomamEventAccounting",
+                                     "Count the calls and the wall time of the events of the "
+                                     "Romam code by category, and write a summary when the "
+                                     "simulator is destroyed",
+                                     BooleanValue(false),
+                                     MakeBooleanChecker());
+
+/// file the summary of the events is written to
+static GlobalValue g_eventAccountingFile("RomamEventAccountingFile",
+                                         "File the summary of RomamEventAccounting is written "
+                                         "to (empty for the standard output)",
+                                         StringValue(""),
+                                         MakeStringChecker());
+
+bool EventAccounting::s_started = false;
+EventAccounting* EventAccounting::s_accounting = nullptr;
+
+EventAccounting::EventAccounting()
+    : m_current(-1),
+      m_start(Clock::now()),
+      m_startEvents(Simulator::GetEventCount())
+{
+    for (uint32_t i = 0; i < N_CATEGORIES; i++)
+    {
+        m_calls[i] = 0;
+        m_times[i] = Clock::duration::zero();
+    }
+    m_since = m_start;
+}
+
+const char*
+EventAccounting::GetCategoryName(Category category)
+{
+    switch (category)
+    {
+    case APPLICATION:
+        return "application";
+    case NEIGHBOR_STATE:
+        return "neighbor-state";
+    case OCTOPUS_ACK:
+        return "octopus-ack";
+    case LINK_STATE:
+        return "link-state";
+    case RECOMPUTE:
+        return "recompute";
+    default:
+        return "unknown";
+    }
+}
+
+void
+EventAccounting::Start()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    s_started = true;
+    // read again by the next simulation, whether on or off
+    Simulator::ScheduleDestroy(&EventAccounting::Destroy);
+    BooleanValue enabled;
+    g_eventAccounting.GetValue(enabled);
+    if (enabled.Get())
+    {
+        s_accounting = new EventAccounting();
+    }
+}
+
+void
+EventAccounting::Print(std::ostream& os) const
+{
+    Clock::duration total = Clock::now() - m_start;
+    Clock::duration tagged = Clock::duration::zero();
+    double totalSeconds = std::chrono::duration<double>(total).count();
+    os << "category,calls,wall_seconds,share\n";
+    for (uint32_t i = 0; i < N_CATEGORIES; i++)
+    {
+        tagged += m_times[i];
+        double seconds = std::chrono::duration<double>(m_times[i]).count();
+        os << GetCategoryName(static_cast<Category>(i)) << ',' << m_calls[i] << ',' << seconds
+           << ',' << seconds / totalSeconds << '\n';
+    }
+    double untagged = std::chrono::duration<double>(total - tagged).count();
+    os << "untagged,," << untagged << ',' << untagged / totalSeconds << '\n';
+    os << "total," << Simulator::GetEventCount() - m_startEvents << ',' << totalSeconds << ",1\n";
+}
+
+void
+EventAccounting::Destroy()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    s_started = false;
+    if (!s_accounting)
+    {
+        return;
+    }
+    StringValue path;
+    g_eventAccountingFile.GetValue(path);
+    if (path.Get().empty())
+    {
+        s_accounting->Print(std::cout);
+    }
+    else
+    {
+        std::ofstream os(path.Get());
+        s_accounting->Print(os);
+        if (!os)
+        {
+            NS_LOG_WARN("Cannot write the event accounting to " << path.Get());
+        }
+    }
+    delete s_accounting;
+    s_accounting = nullptr;
+}
+
+} // namespace ns3
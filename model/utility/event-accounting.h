@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef EVENT_ACCOUNTING_H
+#define EVENT_ACCOUNTING_H
+
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+
+namespace ns3
+{
+
+/**
+ * \brief Calls and wall time of the events of the Romam code, by category.
+ *
+ * The handlers of the events the Romam code schedules open a Scope of their
+ * category, which counts the call and charges the wall time spent until it
+ * closes to the category.  A scope opened in another one charges its own
+ * time only, so the times of the categories add up.  The rest of the wall
+ * time of the simulation, the forwarding of the packets through the devices,
+ * queues and routing lookups mostly, is reported as untagged.
+ *
+ * The accounting is off unless RomamEventAccounting is set; a scope then
+ * costs a test.  The summary goes to RomamEventAccountingFile, or to the
+ * standard output, when the simulator is destroyed.
+ */
+class EventAccounting
+{
+  public:
+    /// the kinds of work the events do
+    enum Category
+    {
+        APPLICATION,    //!< the sends of the Romam applications
+        NEIGHBOR_STATE, //!< the neighbor state updates of DDRRouting, sent and received
+        OCTOPUS_ACK,    //!< the rewards of Octopus, sent and received
+        LINK_STATE,     //!< the hellos and link state updates of OSPF, sent and received
+        RECOMPUTE,      //!< the route recomputes after interface events
+        N_CATEGORIES,   //!< the number of categories
+    };
+
+    /**
+     * \brief The time an event handler runs, charged to a category.
+     */
+    class Scope
+    {
+      public:
+        /**
+         * \brief Start charging the time to a category.
+         * \param category the category
+         */
+        explicit Scope(Category category);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        EventAccounting* m_accounting; //!< the accounting, null if it is off
+        Category m_category;           //!< the category charged
+        int m_outer;                   //!< the category of the enclosing scope, -1 for none
+    };
+
+    /**
+     * \param category a category
+     * \return the name of the category in the summary
+     */
+    static const char* GetCategoryName(Category category);
+
+    /**
+     * \brief Print the summary: a CSV line per category, then the untagged
+     * time and the totals of the simulation, since the first scope.
+     * \param os the output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    EventAccounting();
+
+    EventAccounting(const EventAccounting&) = delete;
+    EventAccounting& operator=(const EventAccounting&) = delete;
+
+    /**
+     * \return the accounting of the simulation, null if it is off
+     */
+    static EventAccounting* Get();
+
+    /**
+     * \brief Read RomamEventAccounting for the simulation, and create the
+     * accounting if it is set.
+     */
+    static void Start();
+
+    /**
+     * \brief Write the summary, and delete the accounting.
+     */
+    static void Destroy();
+
+    /// the clock of the wall times
+    typedef std::chrono::steady_clock Clock;
+
+    static bool s_started;                //!< RomamEventAccounting was read for the simulation
+    static EventAccounting* s_accounting; //!< the accounting of the simulation, if on
+
+    uint64_t m_calls[N_CATEGORIES];        //!< the scopes opened, by category
+    Clock::duration m_times[N_CATEGORIES]; //!< the wall time charged, by category
+    int m_current;                         //!< the category charged now, -1 for none
+    Clock::time_point m_since;             //!< when m_current was last charged up to
+    Clock::time_point m_start;             //!< when the accounting started
+    uint64_t m_startEvents;                //!< events the simulator ran before it started
+};
+
+inline EventAccounting*
+EventAccounting::Get()
+{
+    if (!s_started)
+    {
+        Start();
+    }
+    return s_accounting;
+}
+
+inline EventAccounting::Scope::Scope(Category category)
+    : m_accounting(Get()),
+      m_category(category),
+      m_outer(-1)
+{
+    if (!m_accounting)
+    {
+        return;
+    }
+    Clock::time_point now = Clock::now();
+    m_outer = m_accounting->m_current;
+    if (m_outer >= 0)
+    {
+        m_accounting->m_times[m_outer] += now - m_accounting->m_since;
+    }
+    m_accounting->m_current = category;
+    m_accounting->m_since = now;
+    m_accounting->m_calls[category]++;
+}
+
+inline EventAccounting::Scope::~Scope()
+{
+    if (!m_accounting)
+    {
+        return;
+    }
+    Clock::time_point now = Clock::now();
+    m_accounting->m_times[m_category] += now - m_accounting->m_since;
+    m_accounting->m_current = m_outer;
+    m_accounting->m_since = now;
+}
+
+} // namespace ns3
+
+#endif /* EVENT_ACCOUNTING_H */
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "flow-cache.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowCache");
+
+/// the IP protocol numbers of the transports whose ports name a flow
+static const uint8_t TCP_PROTOCOL = 6;
+static const uint8_t UDP_PROTOCOL = 17;
+
+/**
+ * \brief Mix the bits of a word, the finalizer of MurmurHash3.
+ * \param h the word
+ * \return the mixed word
+ */
+static uint32_t
+MixFlowHash(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+FlowCache::FlowCache()
+    : m_gap(0),
+      m_timeout(0)
+{
+}
+
+void
+FlowCache::SetSize(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    m_slots.assign(size, Slot());
+}
+
+uint32_t
+FlowCache::GetSize() const
+{
+    return m_slots.size();
+}
+
+void
+FlowCache::SetFlowletGap(Time gap)
+{
+    NS_LOG_FUNCTION(this << gap);
+    m_gap = gap.IsStrictlyPositive() ? gap.GetNanoSeconds() : 0;
+}
+
+void
+FlowCache::SetTimeout(Time timeout)
+{
+    NS_LOG_FUNCTION(this << timeout);
+    m_timeout = timeout.IsStrictlyPositive() ? timeout.GetNanoSeconds() : 0;
+}
+
+uint32_t
+FlowCache::HashFlow(const Ipv4Header& header, Ptr<const Packet> p)
+{
+    uint8_t protocol = header.GetProtocol();
+    uint32_t h = MixFlowHash(header.GetSource().Get() ^ 0x9e3779b9);
+    h = MixFlowHash(h ^ header.GetDestination().Get());
+    h = MixFlowHash(h ^ protocol);
+    // only the first fragment carries the ports
+    if (p && (protocol == TCP_PROTOCOL || protocol == UDP_PROTOCOL) &&
+        header.GetFragmentOffset() == 0 && p->GetSize() >= 4)
+    {
+        uint8_t ports[4];
+        p->CopyData(ports, sizeof(ports));
+        h = MixFlowHash(h ^ (uint32_t(ports[0]) << 24 | uint32_t(ports[1]) << 16 |
+                             uint32_t(ports[2]) << 8 | ports[3]));
+    }
+    return h;
+}
+
+uint32_t
+FlowCache::Combine(uint32_t hash, uint32_t value)
+{
+    return MixFlowHash(hash ^ MixFlowHash(value + 0x9e3779b9));
+}
+
+Ptr<Ipv4Route>
+FlowCache::Lookup(uint32_t hash,
+                  Ipv4Address dest,
+                  uint32_t generation,
+                  uint32_t& flowlet,
+                  uint32_t* value)
+{
+    flowlet = 0;
+    if (m_slots.empty())
+    {
+        return nullptr;
+    }
+    Slot& slot = m_slots[hash % m_slots.size()];
+    if (!slot.route || slot.hash != hash || slot.dest != dest.Get())
+    {
+        return nullptr;
+    }
+    int64_t now = Simulator::Now().GetNanoSeconds();
+    flowlet = slot.flowlet;
+    if (m_gap > 0 && now - slot.lastSeen > m_gap)
+    {
+        // the flow was idle long enough to move without reordering
+        flowlet++;
+        return nullptr;
+    }
+    if (slot.generation != generation || (m_timeout > 0 && now - slot.created > m_timeout))
+    {
+        // the routes or their state changed, the flowlet is placed again
+        return nullptr;
+    }
+    slot.lastSeen = now;
+    if (value)
+    {
+        *value = slot.value;
+    }
+    return slot.route;
+}
+
+void
+FlowCache::Insert(uint32_t hash,
+                  Ipv4Address dest,
+                  uint32_t generation,
+                  uint32_t flowlet,
+                  Ptr<Ipv4Route> route,
+                  uint32_t value)
+{
+    if (m_slots.empty())
+    {
+        return;
+    }
+    Slot& slot = m_slots[hash % m_slots.size()];
+    slot.route = route;
+    slot.lastSeen = Simulator::Now().GetNanoSeconds();
+    slot.created = slot.lastSeen;
+    slot.hash = hash;
+    slot.dest = dest.Get();
+    slot.generation = generation;
+    slot.flowlet = flowlet;
+    slot.value = value;
+}
+
+uint32_t
+FlowCache::Select(uint32_t hash, uint32_t flowlet, uint32_t n)
+{
+    NS_ASSERT_MSG(n > 0, "FlowCache::Select (): no route to select");
+    return MixFlowHash(hash ^ flowlet * 0x9e3779b9) % n;
+}
+
+std::size_t
+FlowCache::GetMemoryUsage() const
+{
+    return m_slots.capacity() * sizeof(Slot);
+}
+
+} // namespace ns3
@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef FLOW_CACHE_H
+#define FLOW_CACHE_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief A direct-mapped cache of the ECMP decisions of the flows of a node.
+ *
+ * A flow is named by the hash of its 5-tuple.  Its slot keeps the route
+ * picked for it and the time of its last packet, so the next packets of the
+ * flow skip the candidate scan.  A packet that comes more than the flowlet
+ * gap after the previous one of its flow starts a new flowlet, which may be
+ * sent on another route; a gap of 0 keeps a flow on its route.  A flow takes
+ * the slot of the one it collides with.
+ *
+ * The owner passes the generation of its routes with every call: the
+ * decisions taken on another generation, or older than the timeout, are
+ * misses.  A decision may keep a value of the owner along with its route.
+ */
+class FlowCache
+{
+  public:
+    FlowCache();
+
+    /**
+     * \brief Resize the cache, which drops the decisions.
+     * \param size the number of slots, 0 for none
+     */
+    void SetSize(uint32_t size);
+
+    /**
+     * \return the number of slots
+     */
+    uint32_t GetSize() const;
+
+    /**
+     * \param gap the time after which a flow may change of route
+     */
+    void SetFlowletGap(Time gap);
+
+    /**
+     * \param timeout the age after which a decision is a miss, 0 for none
+     */
+    void SetTimeout(Time timeout);
+
+    /**
+     * \param header the IP header of a packet
+     * \param p the payload of the packet, which starts with the transport header
+     * \return the hash of the 5-tuple of the packet, or of its addresses and
+     * protocol if it has no TCP or UDP ports
+     */
+    static uint32_t HashFlow(const Ipv4Header& header, Ptr<const Packet> p);
+
+    /**
+     * \brief Mix a value in the key of a flow, to cache different decisions
+     * for the packets of a flow that differ by the value.
+     * \param hash the hash of a flow
+     * \param value the value
+     * \return the hash of the flow and the value
+     */
+    static uint32_t Combine(uint32_t hash, uint32_t value);
+
+    /**
+     * \brief Find the route of a flow, and refresh the time of its last packet.
+     * \param hash the hash of the flow
+     * \param dest the destination of the flow
+     * \param generation the generation of the routes of the owner
+     * \param flowlet set to the number of the flowlet of the packet
+     * \param value set to the value kept with the route, if not null
+     * \return the route of the flow, or null if the flow has none or starts a
+     * new flowlet
+     */
+    Ptr<Ipv4Route> Lookup(uint32_t hash,
+                          Ipv4Address dest,
+                          uint32_t generation,
+                          uint32_t& flowlet,
+                          uint32_t* value = nullptr);
+
+    /**
+     * \brief Record the route of a flowlet, at the current time.
+     * \param hash the hash of the flow
+     * \param dest the destination of the flow
+     * \param generation the generation of the routes of the owner
+     * \param flowlet the number of the flowlet, from Lookup ()
+     * \param route the route picked
+     * \param value a value to keep with the route
+     */
+    void Insert(uint32_t hash,
+                Ipv4Address dest,
+                uint32_t generation,
+                uint32_t flowlet,
+                Ptr<Ipv4Route> route,
+                uint32_t value = 0);
+
+    /**
+     * \param hash the hash of a flow
+     * \param flowlet the number of a flowlet of the flow
+     * \param n the number of equal-cost routes
+     * \return the index of the route of the flowlet among them
+     */
+    static uint32_t Select(uint32_t hash, uint32_t flowlet, uint32_t n);
+
+    /**
+     * \return the number of bytes of the slots
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    /// the decision of a flow
+    struct Slot
+    {
+        Ptr<Ipv4Route> route; //!< the route of the flow, null if the slot is free
+        int64_t lastSeen;     //!< time of the last packet, in ns
+        int64_t created;      //!< time the decision was taken, in ns
+        uint32_t hash;        //!< the hash of the flow
+        uint32_t dest;        //!< the destination of the flow
+        uint32_t generation;  //!< the generation of the routes the decision was taken on
+        uint32_t flowlet;     //!< the number of the flowlet
+        uint32_t value;       //!< the value of the owner kept with the route
+    };
+
+    std::vector<Slot> m_slots; //!< the slots, indexed by hash
+    int64_t m_gap;             //!< the flowlet gap in ns, 0 for none
+    int64_t m_timeout;         //!< the age of a decision that is a miss in ns, 0 for none
+};
+
+} // namespace ns3
+
+#endif /* FLOW_CACHE_H */
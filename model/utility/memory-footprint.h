@@ -0,0 +1,31 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef MEMORY_FOOTPRINT_H
+#define MEMORY_FOOTPRINT_H
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace ns3
+{
+
+/**
+ * \brief Get the memory the nodes and the buckets of a hash map take.
+ *
+ * An unordered_map node holds the pair and the next pointer, and a bucket a
+ * pointer; what the keys and the values own is counted apart by the caller.
+ *
+ * \param map the hash map
+ * \return the number of bytes of the nodes and of the bucket array
+ */
+template <typename K, typename V, typename H, typename E, typename A>
+std::size_t
+GetHashMapFootprint(const std::unordered_map<K, V, H, E, A>& map)
+{
+    typedef typename std::unordered_map<K, V, H, E, A>::value_type Value;
+    return map.size() * (sizeof(Value) + sizeof(void*)) + map.bucket_count() * sizeof(void*);
+}
+
+} // namespace ns3
+
+#endif /* MEMORY_FOOTPRINT_H */
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "next-hop-columns.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/simulation-singleton.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NextHopColumns");
+
+NextHopColumns::NextHopColumns()
+    : m_nNodes(0),
+      m_nDests(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+NextHopColumns*
+NextHopColumns::Get()
+{
+    return SimulationSingleton<NextHopColumns>::Get();
+}
+
+bool
+NextHopColumns::Set(uint32_t dest, uint32_t node, uint32_t iface)
+{
+    if (iface >= NO_IFACE)
+    {
+        return false;
+    }
+    if (node >= m_nNodes)
+    {
+        AddNode(node);
+    }
+    if (dest >= m_nDests)
+    {
+        // the vector grows geometrically, the columns are added one by one
+        m_nDests = dest + 1;
+        m_ifaces.resize(static_cast<std::size_t>(m_nDests) * m_nNodes, NO_IFACE);
+    }
+    uint16_t& slot = m_ifaces[static_cast<std::size_t>(dest) * m_nNodes + node];
+    if (slot != NO_IFACE)
+    {
+        return false;
+    }
+    slot = iface;
+    return true;
+}
+
+void
+NextHopColumns::Clear(uint32_t dest, uint32_t node)
+{
+    NS_ASSERT(dest < m_nDests && node < m_nNodes);
+    m_ifaces[static_cast<std::size_t>(dest) * m_nNodes + node] = NO_IFACE;
+}
+
+void
+NextHopColumns::AddNode(uint32_t node)
+{
+    // the nodes are all created before the routes are installed, so this
+    // runs once unless nodes are added later
+    uint32_t nNodes = std::max(node + 1, NodeList::GetNNodes());
+    NS_LOG_FUNCTION(this << m_nNodes << nNodes);
+    std::vector<uint16_t> ifaces(static_cast<std::size_t>(m_nDests) * nNodes, NO_IFACE);
+    for (uint32_t dest = 0; dest < m_nDests; dest++)
+    {
+        std::copy(m_ifaces.begin() + static_cast<std::size_t>(dest) * m_nNodes,
+                  m_ifaces.begin() + static_cast<std::size_t>(dest + 1) * m_nNodes,
+                  ifaces.begin() + static_cast<std::size_t>(dest) * nNodes);
+    }
+    m_ifaces.swap(ifaces);
+    m_nNodes = nNodes;
+}
+
+std::size_t
+NextHopColumns::GetMemoryUsage() const
+{
+    return m_ifaces.capacity() * sizeof(uint16_t);
+}
+
+} // namespace ns3
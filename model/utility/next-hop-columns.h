@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef NEXT_HOP_COLUMNS_H
+#define NEXT_HOP_COLUMNS_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief The output interfaces of the host routes of every node, one column
+ * per destination, shared by the routing protocols that keep their host
+ * routes in it.
+ *
+ * A host route that goes directly on an interface, as the routes Dijkstra
+ * installs on the OSPF nodes, is a destination, a node and an interface.
+ * Rather than an entry per route and per node, the columns keep a 16-bit
+ * interface per destination and node: the column of a destination, indexed
+ * by the node ID, is the forest of the routes to it, as the predecessor
+ * arrays of the trees give it.  The columns follow each other, by
+ * AddressInterner index of their destination, in one array: a node looks up
+ * its route to a destination in one read, and the situation of all the
+ * nodes towards a destination is one contiguous row.
+ *
+ * A slot holds one route: a second route of a node to a destination, e.g.,
+ * an ECMP route, is for the node to keep apart.
+ *
+ * Get () returns the columns of the simulation.
+ */
+class NextHopColumns
+{
+  public:
+    /// the interface of an empty slot, and the bound of the interfaces a slot holds
+    static const uint16_t NO_IFACE = 0xffff;
+
+    NextHopColumns();
+
+    /**
+     * \return the columns of the simulation
+     */
+    static NextHopColumns* Get();
+
+    /**
+     * \brief Add the route of a node to a destination, if it has none.
+     * \param dest the AddressInterner index of the destination
+     * \param node the node ID
+     * \param iface the output interface
+     * \return false if the slot holds a route or iface is NO_IFACE or more,
+     * leaving it unchanged
+     */
+    bool Set(uint32_t dest, uint32_t node, uint32_t iface);
+
+    /**
+     * \param dest the AddressInterner index of the destination, or
+     * AddressInterner::NO_INDEX
+     * \param node the node ID
+     * \return the output interface of the route, or NO_IFACE if none
+     */
+    uint32_t Find(uint32_t dest, uint32_t node) const;
+
+    /**
+     * \brief Remove the route of a node to a destination.
+     * \param dest the AddressInterner index of the destination
+     * \param node the node ID
+     */
+    void Clear(uint32_t dest, uint32_t node);
+
+    /**
+     * \return the number of bytes of the columns
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    /**
+     * \brief Make room for a node, moving the columns to a longer stride.
+     * \param node the node ID
+     */
+    void AddNode(uint32_t node);
+
+    uint32_t m_nNodes;              //!< the length of a column
+    uint32_t m_nDests;              //!< the number of columns
+    std::vector<uint16_t> m_ifaces; //!< the columns, m_nNodes interfaces each
+};
+
+inline uint32_t
+NextHopColumns::Find(uint32_t dest, uint32_t node) const
+{
+    if (dest >= m_nDests || node >= m_nNodes)
+    {
+        return NO_IFACE;
+    }
+    return m_ifaces[static_cast<std::size_t>(dest) * m_nNodes + node];
+}
+
+} // namespace ns3
+
+#endif /* NEXT_HOP_COLUMNS_H */
@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "phase-profiler.h"
+
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+
+#include <iostream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PhaseProfiler");
+
+/// whether the phases of the route computation are timed
+static GlobalValue g_phaseTimer("RomamPhaseTimer",
+                                "Time the phases of the route computation, and print their "
+                                "breakdown when the helpers finish populating the routing tables",
+                                BooleanValue(false),
+                                MakeBooleanChecker());
+
+bool PhaseProfiler::s_timing = false;
+PhaseProfiler::Marker PhaseProfiler::s_begin = nullptr;
+PhaseProfiler::Marker PhaseProfiler::s_end = nullptr;
+std::atomic<uint64_t> PhaseProfiler::s_calls[PhaseProfiler::N_PHASES];
+std::atomic<int64_t> PhaseProfiler::s_nanos[PhaseProfiler::N_PHASES];
+
+PhaseProfiler::Scope::Scope(Phase phase)
+    : m_phase(phase),
+      m_timed(s_timing)
+{
+#ifdef ROMAM_PROFILER_MARKERS
+    if (s_begin)
+    {
+        s_begin(phase, GetPhaseName(phase));
+    }
+#endif
+    if (m_timed)
+    {
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+PhaseProfiler::Scope::~Scope()
+{
+    if (m_timed)
+    {
+        // the trees computed on worker threads close their scopes together
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - m_start;
+        s_calls[m_phase].fetch_add(1, std::memory_order_relaxed);
+        s_nanos[m_phase].fetch_add(elapsed.count(), std::memory_order_relaxed);
+    }
+#ifdef ROMAM_PROFILER_MARKERS
+    if (s_end)
+    {
+        s_end(m_phase, GetPhaseName(m_phase));
+    }
+#endif
+}
+
+const char*
+PhaseProfiler::GetPhaseName(Phase phase)
+{
+    switch (phase)
+    {
+    case BUILD_LSDB:
+        return "build-lsdb";
+    case DISCOVER_LSAS:
+        return "discover-lsas";
+    case SPF_CALCULATE:
+        return "spf-calculate";
+    case ROUTE_INSTALL:
+        return "route-install";
+    case ROUTE_LOOKUP:
+        return "route-lookup";
+    default:
+        return "unknown";
+    }
+}
+
+void
+PhaseProfiler::SetMarkers(Marker begin, Marker end)
+{
+    NS_LOG_FUNCTION_NOARGS();
+#ifndef ROMAM_PROFILER_MARKERS
+    NS_LOG_WARN("Built without ROMAM_PROFILER_MARKERS, the markers are not called");
+#endif
+    s_begin = begin;
+    s_end = end;
+}
+
+void
+PhaseProfiler::Reset()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    BooleanValue timing;
+    g_phaseTimer.GetValue(timing);
+    s_timing = timing.Get();
+    for (uint32_t i = 0; i < N_PHASES; i++)
+    {
+        s_calls[i].store(0, std::memory_order_relaxed);
+        s_nanos[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void
+PhaseProfiler::Print(std::ostream& os)
+{
+    os << "phase,calls,wall_seconds\n";
+    for (uint32_t i = 0; i < N_PHASES; i++)
+    {
+        os << GetPhaseName(static_cast<Phase>(i)) << ','
+           << s_calls[i].load(std::memory_order_relaxed) << ','
+           << s_nanos[i].load(std::memory_order_relaxed) * 1e-9 << '\n';
+    }
+}
+
+void
+PhaseProfiler::Report()
+{
+    if (s_timing)
+    {
+        Print(std::cout);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef PHASE_PROFILER_H
+#define PHASE_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+
+/**
+ * \brief Markers of the phases of the route computation, for the profilers.
+ *
+ * A build configured with ROMAM_PROFILER_MARKERS on defines the macro of the
+ * same name, and every PhaseProfiler::Scope then calls the begin and end
+ * markers PhaseProfiler::SetMarkers () installs, which a program maps to the
+ * zones of Tracy, the tasks of VTune or the probes of perf; the trees
+ * computed on worker threads call them from those threads.  The per-packet
+ * route lookups only open a scope in such a build: ROMAM_LOOKUP_SCOPE ()
+ * compiles to nothing otherwise.
+ */
+#ifdef ROMAM_PROFILER_MARKERS
+#define ROMAM_LOOKUP_SCOPE()                                                                       \
+    ns3::PhaseProfiler::Scope romamLookupScope(ns3::PhaseProfiler::ROUTE_LOOKUP)
+#else
+#define ROMAM_LOOKUP_SCOPE()
+#endif
+
+namespace ns3
+{
+
+/**
+ * \brief Wall time of the phases of the route computation.
+ *
+ * The code of a phase opens a Scope of it, which counts the call and, when
+ * RomamPhaseTimer is set, charges the wall time until it closes to the
+ * phase.  The phases nest: DiscoverLSAs () runs within the building of the
+ * LSDB, so its time is also part of that phase.  The trees computed on
+ * worker threads add their times together, which can make the time of a
+ * phase larger than the wall time of the computation.
+ *
+ * The helpers reset the times when they start populating the routing tables
+ * and Report () prints the breakdown when they finish.  With the timer off,
+ * a scope costs a test, plus the markers in a build with them.
+ */
+class PhaseProfiler
+{
+  public:
+    /// the phases of the route computation
+    enum Phase
+    {
+        BUILD_LSDB,    //!< RouteManager::BuildLSDB () and the updates of the LSDB
+        DISCOVER_LSAS, //!< RomamRouter::DiscoverLSAs ()
+        SPF_CALCULATE, //!< the SPFCalculate () of the SPF and Dijkstra algorithms
+        ROUTE_INSTALL, //!< the installation of the tables on the nodes
+        ROUTE_LOOKUP,  //!< the route lookups of the packets, with markers only
+        N_PHASES,      //!< the number of phases
+    };
+
+    /// a marker, called with the phase and its name
+    typedef void (*Marker)(Phase phase, const char* name);
+
+    /**
+     * \brief A phase, timed until the scope closes.
+     */
+    class Scope
+    {
+      public:
+        /**
+         * \brief Start the phase.
+         * \param phase the phase
+         */
+        explicit Scope(Phase phase);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        Phase m_phase;                                 //!< the phase
+        bool m_timed;                                  //!< whether the timer was on at the start
+        std::chrono::steady_clock::time_point m_start; //!< when the phase started
+    };
+
+    /**
+     * \param phase a phase
+     * \return the name of the phase in the breakdown
+     */
+    static const char* GetPhaseName(Phase phase);
+
+    /**
+     * \brief Install the markers the scopes call in a build with
+     * ROMAM_PROFILER_MARKERS.
+     * \param begin called when a phase starts, or null
+     * \param end called when it ends, or null
+     */
+    static void SetMarkers(Marker begin, Marker end);
+
+    /**
+     * \brief Zero the calls and times, and read RomamPhaseTimer again.
+     */
+    static void Reset();
+
+    /**
+     * \brief Print the breakdown: a CSV line per phase with the calls and the
+     * wall time since Reset ().
+     * \param os the output stream
+     */
+    static void Print(std::ostream& os);
+
+    /**
+     * \brief Print the breakdown to the standard output, if RomamPhaseTimer
+     * is set.
+     */
+    static void Report();
+
+  private:
+    static bool s_timing;                           //!< whether the scopes are timed
+    static Marker s_begin;                          //!< marker of the phase starts, or null
+    static Marker s_end;                            //!< marker of the phase ends, or null
+    static std::atomic<uint64_t> s_calls[N_PHASES]; //!< scopes opened, by phase
+    static std::atomic<int64_t> s_nanos[N_PHASES];  //!< wall time in ns, by phase
+};
+
+} // namespace ns3
+
+#endif /* PHASE_PROFILER_H */
@@ -3,6 +3,7 @@
 
 #include "../datapath/lsa.h"
 #include "../routing_algorithm/dijkstra-route-info-entry.h"
+#include "phase-profiler.h"
 #include "route-manager.h"
 
 #include "ns3/abort.h"
@@ -15,7 +16,9 @@
 #include "ns3/net-device.h"
 #include "ns3/node-list.h"
 #include "ns3/node.h"
+#include "ns3/uinteger.h"
 
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -25,15 +28,29 @@ NS_LOG_COMPONENT_DEFINE("RomamRouter");
 
 NS_OBJECT_ENSURE_REGISTERED(RomamRouter);
 
+bool RomamRouter::s_linkCacheRunning = false;
+std::unordered_map<const Channel*, RomamRouter::LinkInfo> RomamRouter::s_linkCache;
+std::mutex RomamRouter::s_linkCacheMutex;
+
 TypeId
 RomamRouter::GetTypeId()
 {
-    static TypeId tid = TypeId("ns3::RomamRouter").SetParent<Object>().SetGroupName("Romam");
+    static TypeId tid = TypeId("ns3::RomamRouter")
+                            .SetParent<Object>()
+                            .SetGroupName("Romam")
+                            .AddAttribute("AreaId",
+                                          "The area of the router, 0 for the backbone",
+                                          UintegerValue(0),
+                                          MakeUintegerAccessor(&RomamRouter::SetAreaId,
+                                                               &RomamRouter::GetAreaId),
+                                          MakeUintegerChecker<uint32_t>());
     return tid;
 }
 
 RomamRouter::RomamRouter()
-    : m_LSAs()
+    : m_LSAs(),
+      m_dirty(true),
+      m_areaId(0)
 {
     NS_LOG_FUNCTION(this);
     m_routerId.Set(RouteManager::AllocateRouterId());
@@ -50,11 +67,12 @@ RomamRouter::DoDispose()
 {
     // TODO: need to be override in the subclasses
     NS_LOG_FUNCTION(this);
-    for (auto k = m_injectedRoutes.begin(); k != m_injectedRoutes.end();
-         k = m_injectedRoutes.erase(k))
+    for (auto k = m_injectedRoutes.begin(); k != m_injectedRoutes.end(); k++)
     {
-        delete (*k);
+        delete k->route;
     }
+    m_injectedRoutes.clear();
+    m_injectedIndex.clear();
     Object::DoDispose();
 }
 
@@ -62,16 +80,7 @@ void
 RomamRouter::ClearLSAs()
 {
     NS_LOG_FUNCTION(this);
-    for (auto i = m_LSAs.begin(); i != m_LSAs.end(); i++)
-    {
-        NS_LOG_LOGIC("Free LSA");
-
-        LSA* p = *i;
-        delete p;
-        p = nullptr;
-
-        *i = nullptr;
-    }
+    // the LSDB may still share some of them
     NS_LOG_LOGIC("Clear list of LSAs");
     m_LSAs.clear();
 }
@@ -83,6 +92,38 @@ RomamRouter::GetRouterId() const
     return m_routerId;
 }
 
+Ipv4Address
+RomamRouter::GetLoopbackAddress(Ptr<Ipv4> ipv4)
+{
+    if (ipv4->GetNInterfaces() == 0)
+    {
+        return Ipv4Address::GetAny();
+    }
+    for (uint32_t i = 0; i < ipv4->GetNAddresses(0); i++)
+    {
+        Ipv4InterfaceAddress address = ipv4->GetAddress(0, i);
+        // 127.0.0.0/8 is the host loopback of every node
+        if (address.GetMask() == Ipv4Mask::GetOnes() && (address.GetLocal().Get() >> 24) != 127)
+        {
+            return address.GetLocal();
+        }
+    }
+    return Ipv4Address::GetAny();
+}
+
+Ipv4Address
+RomamRouter::GetNodeAddress(Ptr<Ipv4> ipv4)
+{
+    Ipv4Address loopback = GetLoopbackAddress(ipv4);
+    if (loopback != Ipv4Address::GetAny())
+    {
+        return loopback;
+    }
+    NS_ABORT_MSG_IF(ipv4->GetNInterfaces() < 2 || ipv4->GetNAddresses(1) == 0,
+                    "RomamRouter::GetNodeAddress (): the node has no address");
+    return ipv4->GetAddress(1, 0).GetLocal();
+}
+
 //
 // DiscoverLSAs is called on all nodes in the system that have a RomamRouter
 // interface aggregated.  We need to go out and discover any adjacent routers
@@ -93,12 +134,15 @@ uint32_t
 RomamRouter::DiscoverLSAs()
 {
     NS_LOG_FUNCTION(this);
+    PhaseProfiler::Scope scope(PhaseProfiler::DISCOVER_LSAS);
     Ptr<Node> node = GetObject<Node>();
     NS_ABORT_MSG_UNLESS(node,
                         "RomamRouter::DiscoverLSAs (): GetObject for <Node> interface failed");
     NS_LOG_LOGIC("For node " << node->GetId());
 
-    ClearLSAs();
+    ListOfLSAs_t previous;
+    previous.swap(m_LSAs);
+    m_dirty = false;
 
     //
     // While building the Router-LSA, keep a list of those NetDevices for
@@ -202,9 +246,25 @@ RomamRouter::DiscoverLSAs()
         }
     }
 
+    //
+    // A router with a loopback address is reached at it, which stands for the
+    // stub networks of its point-to-point links.
+    //
+    Ipv4Address loopback = GetLoopbackAddress(ipv4Local);
+    if (loopback != Ipv4Address::GetAny())
+    {
+        NS_LOG_LOGIC("Loopback address " << loopback);
+        auto plr = new LinkRecord;
+        plr->SetLinkType(LinkRecord::StubNetwork);
+        plr->SetLinkId(loopback);
+        plr->SetLinkData(Ipv4Address(Ipv4Mask::GetOnes().Get()));
+        plr->SetMetric(0);
+        pLSA->AddLinkRecord(plr);
+    }
+
     NS_LOG_LOGIC("========== LSA for node " << node->GetId() << " ==========");
     NS_LOG_LOGIC(*pLSA);
-    m_LSAs.push_back(pLSA);
+    m_LSAs.push_back(Ptr<LSA>(pLSA, false));
     pLSA = nullptr;
 
     //
@@ -218,23 +278,130 @@ RomamRouter::DiscoverLSAs()
         BuildNetworkLSAs(c);
     }
 
+    //
+    // Keep the instances of the LSAs that did not change, which the LSDB
+    // shares, so that it only has to replace the ones that did.  The
+    // AS-external LSAs keep theirs with their injected route.
+    //
+    for (auto i = m_LSAs.begin(); i != m_LSAs.end(); i++)
+    {
+        for (auto j = previous.begin(); j != previous.end(); j++)
+        {
+            if (*j && (*j)->IsSameAdvertisement(**i))
+            {
+                *i = *j;
+                *j = nullptr;
+                break;
+            }
+        }
+    }
+
     //
     // Build injected route LSAs as external routes
     // RFC 2328, section 12.4.4
     //
+    m_LSAs.reserve(m_LSAs.size() + m_injectedRoutes.size());
     for (auto i = m_injectedRoutes.begin(); i != m_injectedRoutes.end(); i++)
     {
-        auto pLSA = new LSA;
-        pLSA->SetLSType(LSA::ASExternalLSAs);
-        pLSA->SetLinkStateId((*i)->GetDestNetwork());
-        pLSA->SetAdvertisingRouter(m_routerId);
-        pLSA->SetNetworkLSANetworkMask((*i)->GetDestNetworkMask());
-        pLSA->SetStatus(LSA::LSA_SPF_NOT_EXPLORED);
-        m_LSAs.push_back(pLSA);
+        m_LSAs.push_back(i->lsa);
     }
     return m_LSAs.size();
 }
 
+bool
+RomamRouter::GetDiscoveryNodes(std::vector<uint32_t>& nodes) const
+{
+    NS_LOG_FUNCTION(this);
+    Ptr<Node> node = GetObject<Node>();
+    nodes.clear();
+    nodes.push_back(node->GetId());
+    for (uint32_t i = 0; i < node->GetNDevices(); i++)
+    {
+        Ptr<NetDevice> nd = node->GetDevice(i);
+        if (NetDeviceIsBridged(nd))
+        {
+            return false;
+        }
+        Ptr<Channel> ch = nd->GetChannel();
+        if (!ch)
+        {
+            continue;
+        }
+        for (std::size_t j = 0; j < ch->GetNDevices(); j++)
+        {
+            Ptr<NetDevice> other = ch->GetDevice(j);
+            if (NetDeviceIsBridged(other))
+            {
+                return false;
+            }
+            nodes.push_back(other->GetNode()->GetId());
+        }
+    }
+    return true;
+}
+
+void
+RomamRouter::MarkDirty()
+{
+    NS_LOG_FUNCTION(this);
+    m_dirty = true;
+    Ptr<Node> node = GetObject<Node>();
+    if (!node)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < node->GetNDevices(); i++)
+    {
+        Ptr<Channel> ch = node->GetDevice(i)->GetChannel();
+        if (!ch)
+        {
+            continue;
+        }
+        ClearBridgesVisited();
+        NetDeviceContainer c = FindAllNonBridgedDevicesOnLink(ch);
+        for (uint32_t j = 0; j < c.GetN(); j++)
+        {
+            Ptr<RomamRouter> rtr = c.Get(j)->GetNode()->GetObject<RomamRouter>();
+            if (rtr)
+            {
+                rtr->m_dirty = true;
+            }
+        }
+    }
+    ClearBridgesVisited();
+}
+
+bool
+RomamRouter::IsDirty() const
+{
+    return m_dirty;
+}
+
+uint32_t
+RomamRouter::GetAreaId() const
+{
+    return m_areaId;
+}
+
+void
+RomamRouter::SetAreaId(uint32_t areaId)
+{
+    NS_LOG_FUNCTION(this << areaId);
+    if (areaId != m_areaId)
+    {
+        m_areaId = areaId;
+        // the LSAs stay the same, but the next update has to see the router
+        m_dirty = true;
+    }
+}
+
+void
+RomamRouter::MarkClean()
+{
+    NS_LOG_FUNCTION(this);
+    m_dirty = false;
+}
+
 void
 RomamRouter::ProcessBroadcastLink(Ptr<NetDevice> nd, LSA* pLSA, NetDeviceContainer& c)
 {
@@ -293,8 +460,9 @@ RomamRouter::ProcessSingleBroadcastLink(Ptr<NetDevice> nd, LSA* pLSA, NetDeviceC
     // this is a stub network.  If we find another router, then what we have here
     // is a transit network.
     //
+    const LinkInfo* link = GetLinkInfo(nd->GetChannel());
     ClearBridgesVisited();
-    if (!AnotherRouterOnLink(nd))
+    if (link ? link->nRouterDevices < 2 : !AnotherRouterOnLink(nd))
     {
         //
         // This is a net device connected to a stub network
@@ -335,7 +503,7 @@ RomamRouter::ProcessSingleBroadcastLink(Ptr<NetDevice> nd, LSA* pLSA, NetDeviceC
         //
         ClearBridgesVisited();
         Ipv4Address designatedRtr;
-        designatedRtr = FindDesignatedRouterForLink(nd);
+        designatedRtr = link ? link->designatedRouter : FindDesignatedRouterForLink(nd);
 
         //
         // Let's double-check that any designated router we find out on our
@@ -648,6 +816,15 @@ RomamRouter::ProcessPointToPointLink(Ptr<NetDevice> ndLocal, LSA* pLSA)
         plr = nullptr;
     }
 
+    //
+    // The link is unnumbered for the routers reached at their loopback
+    // address: no route to its subnet is needed.
+    //
+    if (GetLoopbackAddress(ipv4Local) != Ipv4Address::GetAny())
+    {
+        return;
+    }
+
     // Regardless of state of peer, add a type 3 link (RFC 2328: 12.4.1.1)
     plr = new LinkRecord;
     NS_ABORT_MSG_IF(plr == nullptr,
@@ -714,6 +891,19 @@ RomamRouter::BuildNetworkLSAs(NetDeviceContainer c)
         Ptr<Channel> ch = ndLocal->GetChannel();
         std::size_t nDevices = ch->GetNDevices();
         NS_ASSERT(nDevices);
+        const LinkInfo* link = GetLinkInfo(ch);
+        if (link)
+        {
+            for (auto j = link->routers.begin(); j != link->routers.end(); j++)
+            {
+                NS_LOG_LOGIC("Adding " << j->address << " to Network LSA");
+                pLSA->AddAttachedRouter(j->device == ndLocal ? addrLocal : j->address);
+            }
+            m_LSAs.push_back(Ptr<LSA>(pLSA, false));
+            NS_LOG_LOGIC("========== LSA for node " << node->GetId() << " ==========");
+            NS_LOG_LOGIC(*pLSA);
+            continue;
+        }
         NetDeviceContainer deviceList = FindAllNonBridgedDevicesOnLink(ch);
         NS_LOG_LOGIC("Found " << deviceList.GetN() << " non-bridged devices on channel");
 
@@ -773,7 +963,7 @@ RomamRouter::BuildNetworkLSAs(NetDeviceContainer c)
                                      << " does not have IPv4 interface; skipping");
             }
         }
-        m_LSAs.push_back(pLSA);
+        m_LSAs.push_back(Ptr<LSA>(pLSA, false));
         NS_LOG_LOGIC("========== LSA for node " << node->GetId() << " ==========");
         NS_LOG_LOGIC(*pLSA);
         pLSA = nullptr;
@@ -1102,56 +1292,65 @@ RomamRouter::GetLSA(uint32_t n, LSA& lsa) const
     NS_ASSERT_MSG(lsa.IsEmpty(), "RomamRouter::GetLSA (): Must pass empty LSA");
     //
     // All of the work was done in GetNumLSAs.  All we have to do here is to
-    // walk the list of link state advertisements created there and return the
-    // one the client is interested in.
+    // copy the link state advertisement created there that the client is
+    // interested in.
     //
-    auto i = m_LSAs.begin();
-    uint32_t j = 0;
-
-    for (; i != m_LSAs.end(); i++, j++)
+    if (n < m_LSAs.size())
     {
-        if (j == n)
-        {
-            LSA* p = *i;
-            lsa = *p;
-            return true;
-        }
+        lsa = *m_LSAs[n];
+        return true;
     }
 
     return false;
 }
 
+Ptr<LSA>
+RomamRouter::GetLSA(uint32_t n) const
+{
+    NS_LOG_FUNCTION(this << n);
+    return n < m_LSAs.size() ? m_LSAs[n] : nullptr;
+}
+
+uint64_t
+RomamRouter::GetPrefixKey(Ipv4Address network, Ipv4Mask networkMask)
+{
+    return (uint64_t(network.Get()) << 32) | networkMask.Get();
+}
+
 void
 RomamRouter::InjectRoute(Ipv4Address network, Ipv4Mask networkMask)
 {
     NS_LOG_FUNCTION(this << network << networkMask);
-    auto route = new DijkstraRIE();
+    auto inserted =
+        m_injectedIndex.emplace(GetPrefixKey(network, networkMask), m_injectedRoutes.size());
+    if (!inserted.second)
+    {
+        NS_LOG_LOGIC("Route to network/mask " << network << "/" << networkMask
+                                              << " injected already");
+        return;
+    }
+    InjectedRoute injected;
+    injected.route = new DijkstraRIE();
     //
     // Interface number does not matter here, using 1.
     //
-    *route = DijkstraRIE::CreateNetworkRouteTo(network, networkMask, 1);
-    m_injectedRoutes.push_back(route);
+    *injected.route = DijkstraRIE::CreateNetworkRouteTo(network, networkMask, 1);
+    injected.lsa = Create<LSA>();
+    injected.lsa->SetLSType(LSA::ASExternalLSAs);
+    injected.lsa->SetLinkStateId(network);
+    injected.lsa->SetAdvertisingRouter(m_routerId);
+    injected.lsa->SetNetworkLSANetworkMask(networkMask);
+    injected.lsa->SetStatus(LSA::LSA_SPF_NOT_EXPLORED);
+    m_injectedRoutes.push_back(injected);
+    m_dirty = true;
 }
 
 DijkstraRIE*
 RomamRouter::GetInjectedRoute(uint32_t index)
 {
     NS_LOG_FUNCTION(this << index);
-    if (index < m_injectedRoutes.size())
-    {
-        uint32_t tmp = 0;
-        for (auto i = m_injectedRoutes.begin(); i != m_injectedRoutes.end(); i++)
-        {
-            if (tmp == index)
-            {
-                return *i;
-            }
-            tmp++;
-        }
-    }
-    NS_ASSERT(false);
-    // quiet compiler.
-    return nullptr;
+    NS_ASSERT(index < m_injectedRoutes.size());
+    return m_injectedRoutes[index].route;
 }
 
 uint32_t
@@ -1166,35 +1365,40 @@ RomamRouter::RemoveInjectedRoute(uint32_t index)
 {
     NS_LOG_FUNCTION(this << index);
     NS_ASSERT(index < m_injectedRoutes.size());
-    uint32_t tmp = 0;
-    for (auto i = m_injectedRoutes.begin(); i != m_injectedRoutes.end(); i++)
-    {
-        if (tmp == index)
-        {
-            NS_LOG_LOGIC("Removing route " << index << "; size = " << m_injectedRoutes.size());
-            delete *i;
-            m_injectedRoutes.erase(i);
-            return;
-        }
-        tmp++;
-    }
+    NS_LOG_LOGIC("Removing route " << index << "; size = " << m_injectedRoutes.size());
+    EraseInjectedRoute(index);
 }
 
 bool
 RomamRouter::WithdrawRoute(Ipv4Address network, Ipv4Mask networkMask)
 {
     NS_LOG_FUNCTION(this << network << networkMask);
-    for (auto i = m_injectedRoutes.begin(); i != m_injectedRoutes.end(); i++)
+    auto i = m_injectedIndex.find(GetPrefixKey(network, networkMask));
+    if (i == m_injectedIndex.end())
     {
-        if ((*i)->GetDestNetwork() == network && (*i)->GetDestNetworkMask() == networkMask)
-        {
-            NS_LOG_LOGIC("Withdrawing route to network/mask " << network << "/" << networkMask);
-            delete *i;
-            m_injectedRoutes.erase(i);
-            return true;
-        }
+        return false;
     }
-    return false;
+    NS_LOG_LOGIC("Withdrawing route to network/mask " << network << "/" << networkMask);
+    EraseInjectedRoute(i->second);
+    return true;
+}
+
+void
+RomamRouter::EraseInjectedRoute(uint32_t index)
+{
+    InjectedRoute& erased = m_injectedRoutes[index];
+    m_injectedIndex.erase(
+        GetPrefixKey(erased.route->GetDestNetwork(), erased.route->GetDestNetworkMask()));
+    delete erased.route;
+    if (index + 1 < m_injectedRoutes.size())
+    {
+        erased = m_injectedRoutes.back();
+        DijkstraRIE* moved = erased.route;
+        m_injectedIndex[GetPrefixKey(moved->GetDestNetwork(), moved->GetDestNetworkMask())] =
+            index;
+    }
+    m_injectedRoutes.pop_back();
+    m_dirty = true;
 }
 
 //
@@ -1292,13 +1496,10 @@ RomamRouter::ClearBridgesVisited() const
 bool
 RomamRouter::BridgeHasAlreadyBeenVisited(Ptr<BridgeNetDevice> bridgeNetDevice) const
 {
-    for (auto iter = m_bridgesVisited.begin(); iter != m_bridgesVisited.end(); ++iter)
+    if (m_bridgesVisited.count(PeekPointer(bridgeNetDevice)) != 0)
     {
-        if (bridgeNetDevice == *iter)
-        {
-            NS_LOG_LOGIC("Bridge " << bridgeNetDevice << " has been visited.");
-            return true;
-        }
+        NS_LOG_LOGIC("Bridge " << bridgeNetDevice << " has been visited.");
+        return true;
     }
     return false;
 }
@@ -1310,7 +1511,82 @@ void
 RomamRouter::MarkBridgeAsVisited(Ptr<BridgeNetDevice> bridgeNetDevice) const
 {
     NS_LOG_FUNCTION(this << bridgeNetDevice);
-    m_bridgesVisited.push_back(bridgeNetDevice);
+    m_bridgesVisited.insert(PeekPointer(bridgeNetDevice));
+}
+
+void
+RomamRouter::StartLinkCache()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    s_linkCache.clear();
+    s_linkCacheRunning = true;
+}
+
+void
+RomamRouter::StopLinkCache()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    s_linkCache.clear();
+    s_linkCacheRunning = false;
+}
+
+const RomamRouter::LinkInfo*
+RomamRouter::GetLinkInfo(Ptr<Channel> ch) const
+{
+    if (!s_linkCacheRunning || !ch)
+    {
+        return nullptr;
+    }
+    // the entries stay in place, and a link is only walked by one thread at a time
+    std::pair<std::unordered_map<const Channel*, LinkInfo>::iterator, bool> cached;
+    {
+        std::lock_guard<std::mutex> lock(s_linkCacheMutex);
+        cached = s_linkCache.emplace(PeekPointer(ch), LinkInfo());
+    }
+    LinkInfo& link = cached.first->second;
+    if (!cached.second)
+    {
+        return link.bridged ? nullptr : &link;
+    }
+    //
+    // The walk of FindDesignatedRouterForLink () and AnotherRouterOnLink ()
+    // on a link without bridges, done once for all the routers on it.
+    //
+    link.bridged = false;
+    link.nRouterDevices = 0;
+    link.designatedRouter = Ipv4Address("255.255.255.255");
+    for (std::size_t i = 0; i < ch->GetNDevices(); i++)
+    {
+        Ptr<NetDevice> nd = ch->GetDevice(i);
+        if (NetDeviceIsBridged(nd))
+        {
+            NS_LOG_LOGIC("Channel " << ch << " has bridged devices, not cached");
+            link.bridged = true;
+            link.routers.clear();
+            return nullptr;
+        }
+        Ptr<Node> node = nd->GetNode();
+        if (!node->GetObject<RomamRouter>())
+        {
+            continue;
+        }
+        link.nRouterDevices++;
+        Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+        int32_t interface = ipv4 ? ipv4->GetInterfaceForDevice(nd) : -1;
+        if (interface == -1 || !ipv4->IsUp(interface))
+        {
+            continue;
+        }
+        LinkRouter router;
+        router.device = nd;
+        router.address = ipv4->GetAddress(interface, 0).GetLocal();
+        link.routers.push_back(router);
+        link.designatedRouter =
+            router.address < link.designatedRouter ? router.address : link.designatedRouter;
+    }
+    NS_LOG_LOGIC("Channel " << ch << ": " << link.routers.size() << " routers up, designated "
+                            << link.designatedRouter);
+    return &link;
 }
 
 } // namespace ns3
@@ -11,14 +11,18 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 
-#include <list>
+#include <mutex>
 #include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace ns3
 {
 
 class LSA;
 class DijkstraRIE;
+class Ipv4;
 class RomamRouting;
 
 class RomamRouter : public Object
@@ -50,6 +54,31 @@ class RomamRouter : public Object
      */
     Ipv4Address GetRouterId() const;
 
+    /**
+     * @brief Get the loopback address of a router, a /32 on its loopback
+     * interface outside 127.0.0.0/8.
+     *
+     * A router with one, such as the ones RomamTopologyHelper::SetLoopbackBase ()
+     * numbers, is reached at it: DiscoverLSAs () advertises it as a stub
+     * instead of the subnets of its point-to-point links, and the route
+     * computations install a route to it instead of host routes to the
+     * addresses of its links.
+     *
+     * @param ipv4 the Ipv4 of the router
+     * @returns the loopback address, or 0.0.0.0 if none
+     */
+    static Ipv4Address GetLoopbackAddress(Ptr<Ipv4> ipv4);
+
+    /**
+     * @brief Get the address the traffic to a node is sent to: its loopback
+     * address if it has one, else the first address of its first interface
+     * after the loopback.
+     *
+     * @param ipv4 the Ipv4 of the node
+     * @returns the address
+     */
+    static Ipv4Address GetNodeAddress(Ptr<Ipv4> ipv4);
+
     /**
      * @brief Walk the connected channels, discover the adjacent routers and build
      * the associated number of Global Routing Link State Advertisements that
@@ -69,6 +98,81 @@ class RomamRouter : public Object
      */
     uint32_t DiscoverLSAs();
 
+    /**
+     * @brief Get the nodes DiscoverLSAs () reads, so that the discoveries of
+     * routers that read none in common can run on threads of their own.
+     *
+     * A discovery reads the node of the router and the nodes on its links,
+     * their devices and their channels, unless a link is bridged, in which
+     * case it walks the bridges further.
+     *
+     * @param nodes filled with the IDs of the node of the router and of the
+     * nodes on its links, some possibly more than once
+     * @returns false if a device on the links is bridged
+     */
+    bool GetDiscoveryNodes(std::vector<uint32_t>& nodes) const;
+
+    /**
+     * @brief Share the walks of the broadcast links among the routers, until
+     * StopLinkCache ().
+     *
+     * Every router on a LAN walks it to elect its designated router and to
+     * find out whether it is a transit network, which makes an LSDB build
+     * quadratic in the routers of the LAN.  While the cache runs, the first
+     * router to walk a link without bridges keeps what it found for the
+     * others.  The links must not change meanwhile; GlobalLsdbManager runs
+     * the cache for one LSDB build.  Routers that share no link may walk
+     * theirs on different threads at the same time.
+     */
+    static void StartLinkCache();
+
+    /**
+     * @brief Drop the walks of the links StartLinkCache () kept.
+     */
+    static void StopLinkCache();
+
+    /**
+     * @brief Mark the LSAs of this router, and of the routers on its links,
+     * as out of date.
+     *
+     * The routing protocols call it when an interface or an address of the
+     * node changes.  The LSAs of the other routers on a link describe the
+     * interfaces of this one too, so they are marked as well.
+     */
+    void MarkDirty();
+
+    /**
+     * @brief Tell whether the LSAs must be discovered again.
+     *
+     * A router starts dirty, and DiscoverLSAs () cleans it.
+     *
+     * @returns true if something changed since the last DiscoverLSAs ()
+     */
+    bool IsDirty() const;
+
+    /**
+     * @brief Get the area of the router, of its AreaId attribute.
+     *
+     * With routers in several areas, the route computations of a router only
+     * span its area, and reach the others through the area border routers,
+     * as AreaDirectory tells.
+     *
+     * @returns the area ID, 0 for the backbone
+     */
+    uint32_t GetAreaId() const;
+
+    /**
+     * @brief Move the router to another area, from the next LSDB update on.
+     * @param areaId the area ID, 0 for the backbone
+     */
+    void SetAreaId(uint32_t areaId);
+
+    /**
+     * @brief Tell the router its LSAs are known from elsewhere, such as a
+     * saved LSDB of the same topology, so that it is not asked for them.
+     */
+    void MarkClean();
+
     /**
      * @brief Get the Number of Global Routing Link State Advertisements that this
      * router can export.
@@ -106,10 +210,24 @@ class RomamRouter : public Object
      */
     bool GetLSA(uint32_t n, LSA& lsa) const;
 
+    /**
+     * @brief Get a Global Routing Link State Advertisements that this router has
+     * said that it can export, without copying it.
+     *
+     * The LSA is shared with the router, and must not be modified.  An LSA
+     * that did not change keeps its instance across DiscoverLSAs () calls.
+     *
+     * @param n The index number of the LSA you want to read.
+     * @returns the LSA, or null if n is out of range
+     */
+    Ptr<LSA> GetLSA(uint32_t n) const;
+
     /**
      * @brief Inject a route to be circulated to other routers as an external
      * route
      *
+     * A prefix already injected is not injected again.
+     *
      * @param network The Network to inject
      * @param networkMask The Network Mask to inject
      */
@@ -133,9 +251,9 @@ class RomamRouter : public Object
     /**
      * @brief Withdraw a route from the global unicast routing table.
      *
-     * Calling this function will cause all indexed routes numbered above
-     * index i to have their index decremented.  For instance, it is possible to
-     * remove N injected routes by calling RemoveInjectedRoute (0) N times.
+     * The last injected route takes the index i, so the removal is O(1).  It
+     * is still possible to remove N injected routes by calling
+     * RemoveInjectedRoute (0) N times.
      *
      * @param i The index (into the injected routing list) of the route to remove.
      *
@@ -280,25 +398,70 @@ class RomamRouter : public Object
      */
     Ptr<BridgeNetDevice> NetDeviceIsBridged(Ptr<NetDevice> nd) const;
 
-    typedef std::list<LSA*> ListOfLSAs_t; //!< container for the GlobalRoutingLSAs
-    ListOfLSAs_t m_LSAs;                  //!< database of GlobalRoutingLSAs
+    typedef std::vector<Ptr<LSA>> ListOfLSAs_t; //!< container for the GlobalRoutingLSAs
+    ListOfLSAs_t m_LSAs;                        //!< database of GlobalRoutingLSAs
 
     Ipv4Address m_routerId; //!< router ID (its IPv4 address)
+    bool m_dirty;           //!< the LSAs must be discovered again
+    uint32_t m_areaId;      //!< the area of the router
     // Ptr<Ipv4GlobalRouting> m_routingProtocol; //!< the Ipv4GlobalRouting in use
 
-    typedef std::list<DijkstraRIE*> InjectedRoutes; //!< container of Ipv4RoutingTableEntry
-    typedef std::list<DijkstraRIE*>::const_iterator
-        InjectedRoutesCI; //!< Const Iterator to container of Ipv4RoutingTableEntry
-    typedef std::list<DijkstraRIE*>::iterator
-        InjectedRoutesI;             //!< Iterator to container of Ipv4RoutingTableEntry
-    InjectedRoutes m_injectedRoutes; //!< Routes we are exporting
+    /// a route we are exporting, with the AS-external LSA advertising it
+    struct InjectedRoute
+    {
+        DijkstraRIE* route; //!< the route, owned by the router
+        Ptr<LSA> lsa;       //!< the LSA, kept across DiscoverLSAs () calls
+    };
+
+    /**
+     * \param network a network
+     * \param networkMask its mask
+     * \return the key of the prefix in m_injectedIndex
+     */
+    static uint64_t GetPrefixKey(Ipv4Address network, Ipv4Mask networkMask);
+
+    /**
+     * \brief Remove an injected route, the last one taking its index.
+     * \param index the index of the route
+     */
+    void EraseInjectedRoute(uint32_t index);
+
+    std::vector<InjectedRoute> m_injectedRoutes;            //!< Routes we are exporting
+    std::unordered_map<uint64_t, uint32_t> m_injectedIndex; //!< index of a route, by prefix
+
+    /// an interface of a router on a broadcast link, which is up
+    struct LinkRouter
+    {
+        Ptr<NetDevice> device; //!< the device of the interface
+        Ipv4Address address;   //!< the primary address of the interface
+    };
+
+    /// what the walk of a broadcast link finds
+    struct LinkInfo
+    {
+        bool bridged;                    //!< a device is bridged, so the walks are not kept
+        uint32_t nRouterDevices;         //!< the devices on a node with a RomamRouter
+        Ipv4Address designatedRouter;    //!< the lowest router address, or 255.255.255.255
+        std::vector<LinkRouter> routers; //!< the router interfaces that are up, by device
+    };
+
+    /**
+     * \param ch a channel
+     * \return what the walk of the link finds, or null if the cache is not
+     * running or the link has bridges
+     */
+    const LinkInfo* GetLinkInfo(Ptr<Channel> ch) const;
+
+    static bool s_linkCacheRunning;                                  //!< StartLinkCache () ran
+    static std::unordered_map<const Channel*, LinkInfo> s_linkCache; //!< the walks, by channel
+    static std::mutex s_linkCacheMutex; //!< guards s_linkCache, not the walks
 
     // Declared mutable so that const member functions can clear it
     // (supporting the logical constness of the search methods of this class)
     /**
      * Container of bridges visited.
      */
-    mutable std::vector<Ptr<BridgeNetDevice>> m_bridgesVisited;
+    mutable std::unordered_set<const BridgeNetDevice*> m_bridgesVisited;
     /**
      * Clear the list of bridges visited on the link
      */
@@ -0,0 +1,385 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "route-consistency.h"
+
+#include "../romam-routing.h"
+#include "../routing_algorithm/route-info-entry.h"
+#include "romam-router.h"
+
+#include "ns3/channel.h"
+#include "ns3/ipv4.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RouteConsistency");
+
+/// a node of no next hop, or of no known address
+static const uint32_t NO_NODE = UINT32_MAX;
+
+/// a route of a table, as the check sees it
+struct CheckedRoute
+{
+    uint32_t dest;      //!< the destination, masked
+    uint32_t mask;      //!< the mask of the destination
+    uint32_t gateway;   //!< the gateway, 0 for on-link
+    uint32_t interface; //!< the output interface
+};
+
+/// the routes of a node, indexed by their prefix
+struct CheckedTable
+{
+    std::vector<CheckedRoute> routes;                             //!< the routes
+    std::unordered_map<uint64_t, std::vector<uint32_t>> prefixes; //!< the routes of every prefix
+    std::vector<uint32_t> masks;                                  //!< the masks, longest first
+};
+
+/**
+ * \brief Record a route of a table, the callback of RomamRouting::ForEachRoute ().
+ * \param routes where to record it
+ * \param route the route
+ */
+static void
+CollectRoute(std::vector<CheckedRoute>* routes, const RouteInfoEntry& route)
+{
+    uint32_t mask = route.GetDestNetworkMask().Get();
+    routes->push_back(CheckedRoute{route.GetDest().Get() & mask,
+                                   mask,
+                                   route.GetGateway().Get(),
+                                   route.GetInterface()});
+}
+
+/**
+ * \param device a device
+ * \return the device at the other end of its point-to-point channel, or null
+ */
+static Ptr<NetDevice>
+GetPeerDevice(Ptr<NetDevice> device)
+{
+    Ptr<Channel> channel = device->GetChannel();
+    if (!channel || channel->GetNDevices() != 2)
+    {
+        return nullptr;
+    }
+    return channel->GetDevice(channel->GetDevice(0) == device ? 1 : 0);
+}
+
+/**
+ * \param ipv4 the Ipv4 of a node
+ * \param interface an interface of the node
+ * \return the ID of the node across the interface, if both ends are up, or NO_NODE
+ */
+static uint32_t
+GetPeerNode(Ptr<Ipv4> ipv4, uint32_t interface)
+{
+    if (interface >= ipv4->GetNInterfaces() || !ipv4->IsUp(interface))
+    {
+        return NO_NODE;
+    }
+    Ptr<NetDevice> peer = GetPeerDevice(ipv4->GetNetDevice(interface));
+    Ptr<Ipv4> peerIpv4 = peer ? peer->GetNode()->GetObject<Ipv4>() : nullptr;
+    int32_t peerInterface = peerIpv4 ? peerIpv4->GetInterfaceForDevice(peer) : -1;
+    if (peerInterface < 0 || !peerIpv4->IsUp(peerInterface))
+    {
+        return NO_NODE;
+    }
+    return peer->GetNode()->GetId();
+}
+
+RouteConsistency::Report::Report()
+    : destinations(0),
+      loops(0),
+      blackHoles(0),
+      unreachable(0)
+{
+}
+
+bool
+RouteConsistency::Report::IsConsistent() const
+{
+    return loops == 0 && blackHoles == 0;
+}
+
+RouteConsistency::Report
+RouteConsistency::Check()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    uint32_t nNodes = NodeList::GetNNodes();
+    // the owner of every address, the destinations, the tables and the links up
+    std::unordered_map<uint32_t, uint32_t> owners;
+    std::vector<uint32_t> destinations;
+    std::vector<CheckedTable> tables(nNodes);
+    std::vector<bool> routed(nNodes, false);
+    std::vector<std::vector<uint32_t>> links(nNodes);
+    for (uint32_t n = 0; n < nNodes; n++)
+    {
+        Ptr<Node> node = NodeList::GetNode(n);
+        Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+        Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
+        if (!ipv4 || !router || !router->GetRoutingProtocol())
+        {
+            continue;
+        }
+        routed[n] = true;
+        for (uint32_t i = 1; i < ipv4->GetNInterfaces(); i++)
+        {
+            for (uint32_t a = 0; a < ipv4->GetNAddresses(i); a++)
+            {
+                owners[ipv4->GetAddress(i, a).GetLocal().Get()] = n;
+            }
+            uint32_t peer = GetPeerNode(ipv4, i);
+            if (peer != NO_NODE)
+            {
+                links[n].push_back(peer);
+            }
+        }
+        if (ipv4->GetNInterfaces() > 1 && ipv4->GetNAddresses(1) > 0)
+        {
+            destinations.push_back(n);
+        }
+        CheckedTable& table = tables[n];
+        router->GetRoutingProtocol()->ForEachRoute(MakeBoundCallback(&CollectRoute,
+                                                                       &table.routes));
+        for (uint32_t r = 0; r < table.routes.size(); r++)
+        {
+            const CheckedRoute& route = table.routes[r];
+            table.prefixes[(uint64_t(route.dest) << 32) | route.mask].push_back(r);
+            table.masks.push_back(route.mask);
+        }
+        std::sort(table.masks.begin(), table.masks.end(), std::greater<uint32_t>());
+        table.masks.erase(std::unique(table.masks.begin(), table.masks.end()), table.masks.end());
+    }
+
+    Report report;
+    std::vector<uint32_t> reached(nNodes);
+    std::vector<uint32_t> offsets(nNodes + 1);
+    std::vector<uint32_t> hops;
+    std::vector<uint8_t> colors(nNodes);
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    for (uint32_t d : destinations)
+    {
+        report.destinations++;
+        Ptr<Ipv4> destIpv4 = NodeList::GetNode(d)->GetObject<Ipv4>();
+        uint32_t address = RomamRouter::GetNodeAddress(destIpv4).Get();
+        // the nodes the destination is connected to by links up, breadth first
+        std::fill(reached.begin(), reached.end(), 0);
+        std::vector<uint32_t> queue(1, d);
+        reached[d] = 1;
+        for (std::size_t q = 0; q < queue.size(); q++)
+        {
+            for (uint32_t peer : links[queue[q]])
+            {
+                if (!reached[peer])
+                {
+                    reached[peer] = 1;
+                    queue.push_back(peer);
+                }
+            }
+        }
+        // the next hops of every node, the routes up of the longest prefix
+        hops.clear();
+        for (uint32_t n = 0; n < nNodes; n++)
+        {
+            offsets[n] = hops.size();
+            if (n == d || !routed[n])
+            {
+                continue;
+            }
+            const CheckedTable& table = tables[n];
+            Ptr<Ipv4> ipv4 = NodeList::GetNode(n)->GetObject<Ipv4>();
+            for (uint32_t mask : table.masks)
+            {
+                auto prefix = table.prefixes.find((uint64_t(address & mask) << 32) | mask);
+                if (prefix == table.prefixes.end())
+                {
+                    continue;
+                }
+                for (uint32_t r : prefix->second)
+                {
+                    const CheckedRoute& route = table.routes[r];
+                    uint32_t next = GetPeerNode(ipv4, route.interface);
+                    if (route.gateway != 0)
+                    {
+                        auto owner = owners.find(route.gateway);
+                        next = owner != owners.end() && owner->second == next ? next : NO_NODE;
+                    }
+                    if (next != NO_NODE)
+                    {
+                        hops.push_back(next);
+                    }
+                }
+                if (hops.size() > offsets[n])
+                {
+                    break;
+                }
+            }
+            if (!reached[n])
+            {
+                report.unreachable++;
+            }
+            else if (hops.size() == offsets[n])
+            {
+                NS_LOG_WARN("Node " << n << " has no way to node " << d);
+                report.blackHoles++;
+            }
+        }
+        offsets[nNodes] = hops.size();
+        // a cycle of the next hops, depth first: 1 on the stack, 2 done
+        std::fill(colors.begin(), colors.end(), 0);
+        bool loop = false;
+        for (uint32_t s = 0; s < nNodes && !loop; s++)
+        {
+            if (colors[s] != 0)
+            {
+                continue;
+            }
+            colors[s] = 1;
+            stack.assign(1, std::make_pair(s, offsets[s]));
+            while (!stack.empty() && !loop)
+            {
+                uint32_t n = stack.back().first;
+                uint32_t& edge = stack.back().second;
+                if (edge == offsets[n + 1])
+                {
+                    colors[n] = 2;
+                    stack.pop_back();
+                    continue;
+                }
+                uint32_t next = hops[edge++];
+                if (colors[next] == 1)
+                {
+                    NS_LOG_WARN("Forwarding loop to node " << d << " through node " << next);
+                    loop = true;
+                }
+                else if (colors[next] == 0)
+                {
+                    colors[next] = 1;
+                    stack.emplace_back(next, offsets[next]);
+                }
+            }
+        }
+        report.loops += loop ? 1 : 0;
+    }
+    NS_LOG_INFO(report.destinations << " destinations, " << report.loops << " with loops, "
+                                    << report.blackHoles << " black holes");
+    return report;
+}
+
+RouteConvergenceTracker::RouteConvergenceTracker()
+    : m_check(false)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+RouteConvergenceTracker::Install()
+{
+    NS_LOG_FUNCTION(this);
+    m_changed.assign(NodeList::GetNNodes(), 0);
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouter> router = (*i)->GetObject<RomamRouter>();
+        Ptr<RomamRouting> routing = router ? router->GetRoutingProtocol() : nullptr;
+        if (routing)
+        {
+            routing->TraceConnect("RouteDiff",
+                                  std::to_string((*i)->GetId()),
+                                  MakeCallback(&RouteConvergenceTracker::RouteChanged, this));
+        }
+    }
+}
+
+void
+RouteConvergenceTracker::SetCheckConsistency(bool check)
+{
+    m_check = check;
+}
+
+void
+RouteConvergenceTracker::MarkEvent(const std::string& label)
+{
+    NS_LOG_FUNCTION(this << label);
+    m_events.push_back(
+        Convergence{label, Simulator::Now(), Time(), Time(), 0, 0, 0, 0, 0, 0, true});
+}
+
+const std::vector<RouteConvergenceTracker::Convergence>&
+RouteConvergenceTracker::GetEvents() const
+{
+    return m_events;
+}
+
+void
+RouteConvergenceTracker::RouteChanged(std::string context,
+                                      uint32_t added,
+                                      uint32_t removed,
+                                      uint32_t modified)
+{
+    if (m_events.empty())
+    {
+        // the changes before any event, of the first routes say
+        MarkEvent("start");
+    }
+    Convergence& event = m_events.back();
+    Time now = Simulator::Now();
+    if (event.changes == 0)
+    {
+        event.firstChange = now;
+    }
+    event.lastChange = now;
+    event.changes++;
+    event.routes += added + removed + modified;
+    uint32_t nodeId = std::stoul(context);
+    if (nodeId >= m_changed.size())
+    {
+        m_changed.resize(nodeId + 1, 0);
+    }
+    if (m_changed[nodeId] != m_events.size())
+    {
+        m_changed[nodeId] = m_events.size();
+        event.nodes++;
+    }
+    // the trace fires before the table changes, and other tables may change now too
+    if (m_check && !m_checkEvent.IsRunning())
+    {
+        m_checkEvent = Simulator::ScheduleNow(&RouteConvergenceTracker::CheckTables, this);
+    }
+}
+
+void
+RouteConvergenceTracker::CheckTables()
+{
+    NS_LOG_FUNCTION(this);
+    RouteConsistency::Report report = RouteConsistency::Check();
+    Convergence& event = m_events.back();
+    event.checks++;
+    event.loopChecks += report.loops > 0 ? 1 : 0;
+    event.blackHoleChecks += report.blackHoles > 0 ? 1 : 0;
+    event.consistent = report.IsConsistent();
+}
+
+void
+RouteConvergenceTracker::Print(std::ostream& os) const
+{
+    os << "event,time_s,first_change_s,last_change_s,convergence_s,changes,nodes,routes,checks,"
+          "loop_checks,black_hole_checks,consistent\n";
+    for (const Convergence& event : m_events)
+    {
+        Time convergence = event.changes > 0 ? event.lastChange - event.time : Time();
+        os << event.label << ',' << event.time.GetSeconds() << ','
+           << event.firstChange.GetSeconds() << ',' << event.lastChange.GetSeconds() << ','
+           << convergence.GetSeconds() << ',' << event.changes << ',' << event.nodes << ','
+           << event.routes << ',' << event.checks << ',' << event.loopChecks << ','
+           << event.blackHoleChecks << ',' << event.consistent << '\n';
+    }
+}
+
+} // namespace ns3
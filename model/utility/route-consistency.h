@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROUTE_CONSISTENCY_H
+#define ROUTE_CONSISTENCY_H
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Checks that the routing tables of all the nodes together deliver
+ * the packets to every node.
+ *
+ * The destinations are the addresses of RomamRouter::GetNodeAddress () of
+ * every node with a RomamRouting.
+ * For a destination, the routes every node would take, the ones through
+ * interfaces up of the longest prefix matching it, ECMP routes included,
+ * make a graph of next hops.  A cycle in the graph is a forwarding loop,
+ * and a node the destination is connected to by interfaces up, with no
+ * route to it or only routes through interfaces down, is a black hole.  A
+ * destination takes O(V + E) after the tables are indexed once, E being the
+ * routes to it.
+ */
+class RouteConsistency
+{
+  public:
+    /// the outcome of a check
+    struct Report
+    {
+        uint32_t destinations; //!< destinations checked
+        uint32_t loops;        //!< destinations some nodes loop on
+        uint32_t blackHoles;   //!< nodes and destinations without a way there, the pairs
+        uint32_t unreachable;  //!< nodes and destinations with no path up between them
+
+        Report();
+
+        /**
+         * \return true if no loop and no black hole was found
+         */
+        bool IsConsistent() const;
+    };
+
+    /**
+     * \brief Check the tables the nodes hold now.
+     *
+     * The loops and black holes found are logged at the warning level.
+     *
+     * \return the report
+     */
+    static Report Check();
+};
+
+/**
+ * \brief Times the changes of the routing tables that follow an event.
+ *
+ * After Install () the tracker follows the RouteDiff trace of the
+ * RomamRouting of every node.  MarkEvent () starts an event, such as a
+ * failure or a recompute, to which the table changes are attributed until
+ * the next one: the tracker records the times of the first and last of them
+ * and the nodes and routes they changed, so the last change is when the
+ * network converged.
+ *
+ * With SetCheckConsistency (), the tables are checked by RouteConsistency
+ * at every time a table changes, once its changes are made, which tells
+ * whether transient loops or black holes existed during the convergence and
+ * whether the tables were consistent after it.
+ *
+ * The trace sinks refer to the tracker, which must outlive the simulation.
+ */
+class RouteConvergenceTracker
+{
+  public:
+    /// the table changes attributed to an event
+    struct Convergence
+    {
+        std::string label;        //!< name of the event
+        Time time;                //!< when the event happened
+        Time firstChange;         //!< the first table change, if changes is not 0
+        Time lastChange;          //!< the last table change, if changes is not 0
+        uint32_t changes;         //!< table changes
+        uint32_t nodes;           //!< nodes whose table changed
+        uint64_t routes;          //!< routes added, removed or replaced
+        uint32_t checks;          //!< consistency checks
+        uint32_t loopChecks;      //!< checks that found a loop
+        uint32_t blackHoleChecks; //!< checks that found a black hole
+        bool consistent;          //!< the last check found no loop and no black hole
+    };
+
+    RouteConvergenceTracker();
+
+    /**
+     * \brief Follow the table changes of all the nodes with a RomamRouting.
+     */
+    void Install();
+
+    /**
+     * \param check whether to check the consistency of the tables at every
+     * table change
+     */
+    void SetCheckConsistency(bool check);
+
+    /**
+     * \brief Start an event now, to which the next table changes are
+     * attributed.
+     * \param label the name of the event
+     */
+    void MarkEvent(const std::string& label);
+
+    /**
+     * \return the events, in time order
+     */
+    const std::vector<Convergence>& GetEvents() const;
+
+    /**
+     * \brief Print a CSV line per event.
+     * \param os the output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    /**
+     * \brief Record a table change, the sink of the RouteDiff traces.
+     * \param context the ID of the node
+     * \param added the routes added
+     * \param removed the routes removed
+     * \param modified the routes replaced
+     */
+    void RouteChanged(std::string context, uint32_t added, uint32_t removed, uint32_t modified);
+
+    /**
+     * \brief Check the tables, once the changes of the time are made.
+     */
+    void CheckTables();
+
+    bool m_check;                      //!< check the tables at every change
+    std::vector<Convergence> m_events; //!< the events
+    std::vector<uint32_t> m_changed;   //!< the event a node last changed in, by node ID, plus 1
+    EventId m_checkEvent;              //!< the pending check
+};
+
+} // namespace ns3
+
+#endif /* ROUTE_CONSISTENCY_H */
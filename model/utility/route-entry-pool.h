@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROUTE_ENTRY_POOL_H
+#define ROUTE_ENTRY_POOL_H
+
+#include "ns3/assert.h"
+
+#include <cstddef>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Slab allocator of the route entries of a routing protocol.
+ *
+ * The entries are allocated by slabs of SLAB_SIZE and named by 32-bit
+ * handles, so a table of routes is a vector of handles instead of a list of
+ * separately allocated entries.  A slab never moves, so the pointer Get ()
+ * returns stays valid until the entry is freed; the route tries and the
+ * candidate vectors keep such pointers.  Freed entries are reused first.
+ *
+ * \tparam T route entry type (DijkstraRIE, ShortestPathForestRIE)
+ */
+template <typename T>
+class RouteEntryPool
+{
+  public:
+    /// the name of an entry of the pool
+    typedef uint32_t Handle;
+
+    RouteEntryPool();
+
+    /**
+     * \brief Allocate an entry.
+     * \param entry the value of the entry
+     * \return the handle of the entry
+     */
+    Handle Allocate(const T& entry);
+
+    /**
+     * \brief Free an entry, which drops its cached Ipv4Route.
+     * \param handle the handle of the entry
+     */
+    void Free(Handle handle);
+
+    /**
+     * \param handle the handle of an allocated entry
+     * \return the entry
+     */
+    T* Get(Handle handle) const;
+
+    /**
+     * \brief Free all the entries, and release the slabs.
+     */
+    void Clear();
+
+    /**
+     * \return the number of allocated entries
+     */
+    uint32_t GetN() const;
+
+    /**
+     * \return the number of bytes of the slabs and of the free list
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    static const uint32_t SLAB_BITS = 8;                 //!< log2 of the entries of a slab
+    static const uint32_t SLAB_SIZE = 1u << SLAB_BITS;  //!< entries of a slab
+
+    std::vector<std::unique_ptr<T[]>> m_slabs; //!< the slabs
+    std::vector<Handle> m_free;                //!< the freed entries, reused last freed first
+    uint32_t m_used;                           //!< entries handed out from the slabs so far
+};
+
+template <typename T>
+RouteEntryPool<T>::RouteEntryPool()
+    : m_used(0)
+{
+}
+
+template <typename T>
+typename RouteEntryPool<T>::Handle
+RouteEntryPool<T>::Allocate(const T& entry)
+{
+    Handle handle;
+    if (!m_free.empty())
+    {
+        handle = m_free.back();
+        m_free.pop_back();
+    }
+    else
+    {
+        if (m_used == m_slabs.size() * SLAB_SIZE)
+        {
+            m_slabs.emplace_back(new T[SLAB_SIZE]);
+        }
+        handle = m_used++;
+    }
+    *Get(handle) = entry;
+    return handle;
+}
+
+template <typename T>
+void
+RouteEntryPool<T>::Free(Handle handle)
+{
+    NS_ASSERT_MSG(handle < m_used, "RouteEntryPool::Free (): unknown handle " << handle);
+    *Get(handle) = T();
+    m_free.push_back(handle);
+}
+
+template <typename T>
+T*
+RouteEntryPool<T>::Get(Handle handle) const
+{
+    return &m_slabs[handle >> SLAB_BITS][handle & (SLAB_SIZE - 1)];
+}
+
+template <typename T>
+void
+RouteEntryPool<T>::Clear()
+{
+    m_slabs.clear();
+    m_free.clear();
+    m_used = 0;
+}
+
+template <typename T>
+uint32_t
+RouteEntryPool<T>::GetN() const
+{
+    return m_used - m_free.size();
+}
+
+template <typename T>
+std::size_t
+RouteEntryPool<T>::GetMemoryUsage() const
+{
+    return m_slabs.capacity() * sizeof(std::unique_ptr<T[]>) +
+           m_slabs.size() * SLAB_SIZE * sizeof(T) + m_free.capacity() * sizeof(Handle);
+}
+
+} // namespace ns3
+
+#endif /* ROUTE_ENTRY_POOL_H */
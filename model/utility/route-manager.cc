@@ -3,62 +3,1011 @@
 #include "route-manager.h"
 
 #include "../datapath/global-lsdb-manager.h"
+#include "../datapath/lsdb-file.h"
+#include "../ddr-routing.h"
 #include "../romam-routing.h"
 #include "../routing_algorithm/dijkstra-algorithm.h"
+#include "../routing_algorithm/distance-matrix.h"
+#include "../routing_algorithm/kshortest-path-algorithm.h"
+#include "../routing_algorithm/route-info-entry.h"
 #include "../routing_algorithm/spf-algorithm.h"
+#include "phase-profiler.h"
 #include "romam-router.h"
 
+#include "ns3/abort.h"
 #include "ns3/assert.h"
+#include "ns3/boolean.h"
+#include "ns3/channel.h"
+#include "ns3/global-value.h"
+#include "ns3/ipv4.h"
 #include "ns3/log.h"
+#include "ns3/net-device.h"
 #include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
 #include "ns3/simulation-singleton.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
 
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("RouteManager");
 
+/// number of worker threads computing the SPF trees of the routers
+static GlobalValue g_routeComputationThreads(
+    "RomamRouteComputationThreads",
+    "Number of worker threads computing the SPF trees of the different routers when "
+    "the routes are initialized (1 computes them on the simulation thread, 0 uses one "
+    "thread per hardware thread)",
+    UintegerValue(1),
+    MakeUintegerChecker<uint32_t>());
+
+/**
+ * \return the value of the RomamRouteComputationThreads global value
+ */
+static uint32_t
+GetRouteComputationThreads()
+{
+    UintegerValue threads;
+    g_routeComputationThreads.GetValue(threads);
+    return threads.Get();
+}
+
+/// whether the SPF trees of the neighbors of a router are derived from one tree
+static GlobalValue g_sharedSpfTrees(
+    "RomamSharedSpfTrees",
+    "Compute one shortest path tree per router and derive from it the trees the "
+    "routers next to it use to reach the others through it",
+    BooleanValue(false),
+    MakeBooleanChecker());
+
+/**
+ * \return the value of the RomamSharedSpfTrees global value
+ */
+static bool
+GetSharedSpfTrees()
+{
+    BooleanValue shared;
+    g_sharedSpfTrees.GetValue(shared);
+    return shared.Get();
+}
+
+/// whether InitializeDijkstraRoutes () and InitializeSPFRoutes () share their trees
+static GlobalValue g_sharedRouteTrees(
+    "RomamSharedRouteTrees",
+    "Keep one shortest path tree per router for a version of the LSDB, from which "
+    "InitializeDijkstraRoutes derives the routes of the router and InitializeSPFRoutes "
+    "the trees of its neighbors, so that running both searches the shortest paths once",
+    BooleanValue(false),
+    MakeBooleanChecker());
+
+/**
+ * \return the value of the RomamSharedRouteTrees global value
+ */
+static bool
+GetSharedRouteTrees()
+{
+    BooleanValue shared;
+    g_sharedRouteTrees.GetValue(shared);
+    return shared.Get();
+}
+
+/// number of shortest paths the KSHORT route select mode spreads the traffic on
+static GlobalValue g_kShortestPaths(
+    "RomamKShortestPaths",
+    "Number of loopless shortest paths to every router computed for the KSHORT route "
+    "select mode of DDR (0 picks among the shortest path forest routes instead)",
+    UintegerValue(0),
+    MakeUintegerChecker<uint32_t>());
+
+/**
+ * \return the value of the RomamKShortestPaths global value
+ */
+static uint32_t
+GetKShortestPaths()
+{
+    UintegerValue k;
+    g_kShortestPaths.GetValue(k);
+    return k.Get();
+}
+
+/// bound on the memory the k shortest paths to one router take in a table
+static GlobalValue g_kShortestPathMemory(
+    "RomamKShortestPathMemory",
+    "Number of bytes the k shortest paths of a node to one router may take, which "
+    "keeps less than RomamKShortestPaths paths if needed (0 for no bound)",
+    UintegerValue(0),
+    MakeUintegerChecker<uint32_t>());
+
+/**
+ * \return the value of the RomamKShortestPathMemory global value
+ */
+static uint32_t
+GetKShortestPathMemory()
+{
+    UintegerValue bytes;
+    g_kShortestPathMemory.GetValue(bytes);
+    return bytes.Get();
+}
+
+/// file a sweep over one topology saves the LSDB to and starts the later runs from
+static GlobalValue g_lsdbCacheFile(
+    "RomamLSDBCacheFile",
+    "File the LSDB is read from instead of being built, when it was saved by a run on "
+    "the same topology, and saved to otherwise (empty to always build it)",
+    StringValue(""),
+    MakeStringChecker());
+
+/**
+ * \return the value of the RomamLSDBCacheFile global value
+ */
+static std::string
+GetLSDBCacheFile()
+{
+    StringValue file;
+    g_lsdbCacheFile.GetValue(file);
+    return file.Get();
+}
+
+/// whether the routes of a node are only computed on its first route lookup
+static GlobalValue g_lazyRoutes(
+    "RomamLazyRoutes",
+    "Only build the LSDB when the routes are initialized, and compute the routes of a "
+    "node on its first route lookup",
+    BooleanValue(false),
+    MakeBooleanChecker());
+
+/**
+ * \return the value of the RomamLazyRoutes global value
+ */
+static bool
+GetLazyRoutes()
+{
+    BooleanValue lazy;
+    g_lazyRoutes.GetValue(lazy);
+    return lazy.Get();
+}
+
+/// bound on the number of nodes holding routes computed lazily
+static GlobalValue g_lazyRouteTables(
+    "RomamLazyRouteTables",
+    "Number of nodes whose lazily computed routes are kept, the routes of the node "
+    "whose last lookup is the oldest being freed beyond (0 for no bound)",
+    UintegerValue(0),
+    MakeUintegerChecker<uint32_t>());
+
+/**
+ * \return the value of the RomamLazyRouteTables global value
+ */
+static uint32_t
+GetLazyRouteTables()
+{
+    UintegerValue tables;
+    g_lazyRouteTables.GetValue(tables);
+    return tables.Get();
+}
+
+/// whether the tables of a topology are kept for the later simulations of it
+static GlobalValue g_routeTableCache(
+    "RomamRouteTableCache",
+    "Keep the tables InitializeDijkstraRoutes and InitializeSPFRoutes install past the "
+    "end of the simulation, and install them again instead of computing them in a "
+    "later simulation of the same topology",
+    BooleanValue(false),
+    MakeBooleanChecker());
+
+/**
+ * \return the value of the RomamRouteTableCache global value
+ */
+static bool
+GetRouteTableCache()
+{
+    BooleanValue cache;
+    g_routeTableCache.GetValue(cache);
+    return cache.Get();
+}
+
+/// propagation delay of a unit of link metric
+static GlobalValue g_metricDelay(
+    "RomamMetricDelay",
+    "The propagation delay of a unit of link metric: the helpers derive the metric of "
+    "an interface from the delay of its channel, and the delay budgets of DDR and DGR "
+    "count the distances in it",
+    TimeValue(MilliSeconds(1)),
+    MakeTimeChecker(NanoSeconds(1)));
+
+/**
+ * \brief The route engines of the simulation.
+ *
+ * The engines are reused by every computation, so that they keep their graph
+ * and buffers from one recompute to the next, and are deleted along with the
+ * simulation.  None of them owns the LSDB of the GlobalLSDBManager.
+ */
+struct RouteEngines
+{
+    RouteEngines();
+
+    DijkstraAlgorithm dijkstra;       //!< engine of InitializeDijkstraRoutes ()
+    SPFAlgorithm spf;                 //!< engine of InitializeSPFRoutes ()
+    DijkstraAlgorithm dijkstraUpdate; //!< incremental engine of UpdateDijkstraRoutes ()
+    SPFAlgorithm spfUpdate;           //!< incremental engine of UpdateSPFRoutes ()
+    KShortestPathAlgorithm kShortest; //!< engine of InitializeKShortestPaths ()
+    SharedTreeTable sharedTrees;      //!< the trees of dijkstra and spf, see RomamSharedRouteTrees
+    Ptr<LSDB> kShortestLSDB;          //!< the version the k shortest paths are computed from
+    bool dijkstraUpdateStarted;       //!< dijkstraUpdate keeps the trees of the routes
+    bool spfUpdateStarted;            //!< spfUpdate keeps the trees of the routes
+    uint32_t nextRouterId;            //!< the router ID AllocateRouterId () gives next
+
+    /// the engine the routes are computed lazily with
+    enum LazyEngine
+    {
+        LAZY_NONE,     //!< the routes are not computed lazily
+        LAZY_DIJKSTRA, //!< dijkstra computes them
+        LAZY_SPF,      //!< spf computes them
+    };
+
+    LazyEngine lazy;                 //!< the engine of the lazy routes
+    Ptr<LSDB> lazyLSDB;              //!< the version the lazy routes are computed from
+    std::vector<uint32_t> lazyNodes; //!< IDs of the nodes holding lazy routes
+};
+
+RouteEngines::RouteEngines()
+    : dijkstraUpdateStarted(false),
+      spfUpdateStarted(false),
+      nextRouterId(0),
+      lazy(LAZY_NONE)
+{
+    dijkstraUpdate.SetIncremental(true);
+    spfUpdate.SetIncremental(true);
+}
+
+/**
+ * \return the route engines of the simulation
+ */
+static RouteEngines*
+GetRouteEngines()
+{
+    return SimulationSingleton<RouteEngines>::Get();
+}
+
+/**
+ * \return the trees InitializeDijkstraRoutes () and InitializeSPFRoutes ()
+ * share, or null, the trees kept being freed, if RomamSharedRouteTrees is
+ * not set
+ */
+static SharedTreeTable*
+GetSharedTreeTable()
+{
+    SharedTreeTable* trees = &GetRouteEngines()->sharedTrees;
+    if (!GetSharedRouteTrees())
+    {
+        trees->Clear();
+        return nullptr;
+    }
+    return trees;
+}
+
+/**
+ * \brief The tables an engine installed on a topology, kept past the end of
+ * the simulation while RomamRouteTableCache is set.
+ */
+struct CachedRouteTables
+{
+    CachedRouteTables();
+
+    bool valid;                            //!< the tables of a topology are kept
+    uint64_t topologyHash;                 //!< LSDBFile::ComputeTopologyHash () of it
+    std::map<uint32_t, RouteBatch> tables; //!< the routes of every node by node ID
+};
+
+CachedRouteTables::CachedRouteTables()
+    : valid(false),
+      topologyHash(0)
+{
+}
+
+/// the tables the engines of InitializeDijkstraRoutes () and InitializeSPFRoutes () keep
+struct RouteTableCache
+{
+    CachedRouteTables dijkstra; //!< the tables of InitializeDijkstraRoutes ()
+    CachedRouteTables spf;      //!< the tables of InitializeSPFRoutes ()
+};
+
+/**
+ * \return the tables kept by the engines, which outlive the simulations
+ */
+static RouteTableCache&
+GetRouteTableCacheStore()
+{
+    static RouteTableCache cache;
+    return cache;
+}
+
+/**
+ * \param node a node
+ * \return the Romam routing protocol of the node, or null if it is not a router
+ */
+static Ptr<RomamRouting>
+GetRomamRouting(Ptr<Node> node)
+{
+    Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
+    return router ? router->GetRoutingProtocol() : nullptr;
+}
+
+/**
+ * \brief Install the tables an engine kept, if they were computed on the
+ * current topology.
+ * \param cached the tables
+ * \return true if the tables were installed, false if they are to be computed
+ */
+static bool
+InstallCachedTables(const CachedRouteTables& cached)
+{
+    if (!GetRouteTableCache() || !cached.valid ||
+        cached.topologyHash != LSDBFile::ComputeTopologyHash())
+    {
+        return false;
+    }
+    NS_LOG_FUNCTION_NOARGS();
+    uint32_t systemId = Simulator::GetSystemId();
+    static const RouteBatch empty;
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouting> routing = GetRomamRouting(*i);
+        if (routing && (*i)->GetSystemId() == systemId)
+        {
+            auto table = cached.tables.find((*i)->GetId());
+            routing->InstallRoutes(table != cached.tables.end() ? table->second : empty);
+        }
+    }
+    NS_LOG_INFO("Installed the tables kept for the topology");
+    return true;
+}
+
+/**
+ * \brief Run an engine that installs tables on all the nodes, keeping them
+ * if RomamRouteTableCache is set.
+ * \param engine the engine, ready to compute
+ * \param cached set to the tables it installs
+ */
+static void
+InitializeAndCacheTables(RoutingAlgorithm& engine, CachedRouteTables& cached)
+{
+    if (!GetRouteTableCache())
+    {
+        engine.InitializeRoutes();
+        return;
+    }
+    cached.valid = false;
+    cached.tables.clear();
+    engine.SetTableCopy(&cached.tables);
+    engine.InitializeRoutes();
+    engine.SetTableCopy(nullptr);
+    cached.topologyHash = LSDBFile::ComputeTopologyHash();
+    cached.valid = true;
+}
+
+/**
+ * \brief Clear the routes of the local routers and have each computed on
+ * the first route lookup of its node, from the current LSDB.
+ * \param lazy the engine that computes them
+ */
+static void
+StartLazyRoutes(RouteEngines::LazyEngine lazy)
+{
+    NS_LOG_FUNCTION(lazy);
+    RouteEngines* engines = GetRouteEngines();
+    GlobalLSDBManager* manager = SimulationSingleton<GlobalLSDBManager>::Get();
+    engines->lazy = lazy;
+    // pin the version the routes are computed from
+    engines->lazyLSDB = manager->GetSnapshot();
+    engines->lazyNodes.clear();
+    if (lazy == RouteEngines::LAZY_DIJKSTRA)
+    {
+        engines->dijkstra.InsertLSDB(PeekPointer(engines->lazyLSDB));
+        engines->dijkstra.InsertRouterDirectory(manager->GetRouterDirectory());
+        engines->dijkstra.InsertAreaDirectory(manager->GetAreaDirectory());
+        // the lazy tables are bounded, the trees of all the routers are not
+        engines->dijkstra.InsertSharedTrees(nullptr);
+    }
+    else
+    {
+        engines->spf.InsertLSDB(PeekPointer(engines->lazyLSDB));
+        engines->spf.InsertRouterDirectory(manager->GetRouterDirectory());
+        engines->spf.InsertAreaDirectory(manager->GetAreaDirectory());
+        engines->spf.SetSharedTrees(GetSharedSpfTrees());
+        engines->spf.InsertSharedTrees(nullptr);
+    }
+    uint32_t systemId = Simulator::GetSystemId();
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouting> routing = GetRomamRouting(*i);
+        // Ignore nodes that are not assigned to our systemId (distributed sim)
+        if (routing && (*i)->GetSystemId() == systemId)
+        {
+            routing->ClearRoutes();
+            routing->RequestLazyRoutes((*i)->GetId());
+        }
+    }
+    NS_LOG_INFO("The routes are computed on the first lookup of every node");
+}
+
+/**
+ * \brief Stop computing the routes lazily, keeping the routes computed.
+ */
+static void
+StopLazyRoutes()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    RouteEngines* engines = GetRouteEngines();
+    if (engines->lazy == RouteEngines::LAZY_NONE)
+    {
+        return;
+    }
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouting> routing = GetRomamRouting(*i);
+        if (routing)
+        {
+            routing->CancelLazyRoutes();
+        }
+    }
+    engines->lazy = RouteEngines::LAZY_NONE;
+    engines->lazyLSDB = nullptr;
+    engines->lazyNodes.clear();
+}
+
 uint32_t
 RouteManager::AllocateRouterId(void)
 {
     NS_LOG_FUNCTION_NOARGS();
-    static uint32_t routerId = 0;
-    return routerId++;
+    // the IDs start over with the node IDs in every simulation
+    return GetRouteEngines()->nextRouterId++;
 }
 
 void
 RouteManager::DeleteRoutes()
 {
     NS_LOG_FUNCTION_NOARGS();
-    SimulationSingleton<DijkstraAlgorithm>::Get()->DeleteRoutes();
+    RouteEngines* engines = GetRouteEngines();
+    StopLazyRoutes();
+    engines->dijkstra.DeleteRoutes();
+    // the tables the incremental engines installed are gone
+    engines->dijkstraUpdateStarted = false;
+    engines->spfUpdateStarted = false;
 }
 
 void
 RouteManager::BuildLSDB(void)
 {
     NS_LOG_FUNCTION_NOARGS();
-    SimulationSingleton<GlobalLSDBManager>::Get()->BuildLinkStateDatabase();
+    PhaseProfiler::Scope scope(PhaseProfiler::BUILD_LSDB);
+    GlobalLSDBManager* manager = SimulationSingleton<GlobalLSDBManager>::Get();
+    std::string file = GetLSDBCacheFile();
+    if (file.empty())
+    {
+        manager->BuildLinkStateDatabase();
+        return;
+    }
+    manager->BuildLinkStateDatabase(file);
+}
+
+void
+RouteManager::AddAreaRange(uint32_t area, Ipv4Address network, Ipv4Mask mask)
+{
+    NS_LOG_FUNCTION(area << network << mask);
+    NS_ABORT_MSG_IF(area == AreaDirectory::BACKBONE, "The backbone has no ranges");
+    SimulationSingleton<GlobalLSDBManager>::Get()->AddAreaRange(area, network, mask);
 }
 
 void
 RouteManager::InitializeDijkstraRoutes(void)
 {
     NS_LOG_FUNCTION_NOARGS();
-    LSDB* lsdb = SimulationSingleton<GlobalLSDBManager>::Get()->GetLSDB();
+    if (GetLazyRoutes())
+    {
+        StartLazyRoutes(RouteEngines::LAZY_DIJKSTRA);
+        return;
+    }
+    StopLazyRoutes();
+    RouteTableCache& cache = GetRouteTableCacheStore();
+    if (InstallCachedTables(cache.dijkstra))
+    {
+        return;
+    }
+    GlobalLSDBManager* manager = SimulationSingleton<GlobalLSDBManager>::Get();
+    // pin the version the routes are computed from
+    Ptr<LSDB> lsdb = manager->GetSnapshot();
     // lsdb->Print(std::cout);
-    DijkstraAlgorithm* dijkstra = new DijkstraAlgorithm();
-    dijkstra->InsertLSDB(lsdb);
-    dijkstra->InitializeRoutes();
+    DijkstraAlgorithm& dijkstra = GetRouteEngines()->dijkstra;
+    dijkstra.InsertLSDB(PeekPointer(lsdb));
+    dijkstra.InsertRouterDirectory(manager->GetRouterDirectory());
+    dijkstra.InsertAreaDirectory(manager->GetAreaDirectory());
+    dijkstra.SetThreads(GetRouteComputationThreads());
+    dijkstra.InsertSharedTrees(GetSharedTreeTable());
+    InitializeAndCacheTables(dijkstra, cache.dijkstra);
+    NS_LOG_LOGIC("The route engines keep " << GetRouteEngineMemoryUsage() << " bytes");
 }
 
 void
 RouteManager::InitializeSPFRoutes(void)
 {
     NS_LOG_FUNCTION_NOARGS();
+    if (GetLazyRoutes())
+    {
+        StartLazyRoutes(RouteEngines::LAZY_SPF);
+        return;
+    }
+    StopLazyRoutes();
+    RouteTableCache& cache = GetRouteTableCacheStore();
+    if (!InstallCachedTables(cache.spf))
+    {
+        GlobalLSDBManager* manager = SimulationSingleton<GlobalLSDBManager>::Get();
+        // pin the version the routes are computed from
+        Ptr<LSDB> lsdb = manager->GetSnapshot();
+        SPFAlgorithm& spf = GetRouteEngines()->spf;
+        spf.InsertLSDB(PeekPointer(lsdb));
+        spf.InsertRouterDirectory(manager->GetRouterDirectory());
+        spf.InsertAreaDirectory(manager->GetAreaDirectory());
+        spf.SetThreads(GetRouteComputationThreads());
+        spf.SetSharedTrees(GetSharedSpfTrees() || GetSharedRouteTrees());
+        spf.InsertSharedTrees(GetSharedTreeTable());
+        InitializeAndCacheTables(spf, cache.spf);
+    }
+    // the k shortest path tables are not kept, they are computed again
+    if (GetKShortestPaths() > 0)
+    {
+        InitializeKShortestPaths();
+    }
+    NS_LOG_LOGIC("The route engines keep " << GetRouteEngineMemoryUsage() << " bytes");
+}
+
+void
+RouteManager::ClearRouteTableCache(void)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    RouteTableCache& cache = GetRouteTableCacheStore();
+    cache.dijkstra = CachedRouteTables();
+    cache.spf = CachedRouteTables();
+}
+
+void
+RouteManager::UpdateDijkstraRoutes(void)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    // the engine keeps the SPF trees of the previous run between updates
+    RouteEngines* engines = GetRouteEngines();
+    if (GetLazyRoutes())
+    {
+        // the routes are computed again as the nodes look them up
+        std::set<uint32_t> changed;
+        SimulationSingleton<GlobalLSDBManager>::Get()->UpdateLinkStateDatabase(changed);
+        engines->dijkstraUpdateStarted = false;
+        StartLazyRoutes(RouteEngines::LAZY_DIJKSTRA);
+        return;
+    }
+    StopLazyRoutes();
+    DijkstraAlgorithm& dijkstra = engines->dijkstraUpdate;
+    if (!engines->dijkstraUpdateStarted)
+    {
+        // the trees of an older run are out of date, the nodes diff their tables
+        dijkstra.ClearTrees();
+        engines->dijkstraUpdateStarted = true;
+    }
+    GlobalLSDBManager* manager = SimulationSingleton<GlobalLSDBManager>::Get();
+    std::set<uint32_t> changed;
+    bool externals = manager->UpdateLinkStateDatabase(changed);
+    Ptr<LSDB> lsdb = manager->GetSnapshot();
+    dijkstra.InsertLSDB(PeekPointer(lsdb));
+    dijkstra.InsertRouterDirectory(manager->GetRouterDirectory());
+    dijkstra.InsertAreaDirectory(manager->GetAreaDirectory());
+    dijkstra.SetThreads(GetRouteComputationThreads());
+    if (externals)
+    {
+        dijkstra.InitializeRoutes();
+    }
+    else
+    {
+        dijkstra.UpdateRoutes(changed);
+    }
+}
+
+void
+RouteManager::UpdateSPFRoutes(void)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    // the engine keeps the SPF trees of the previous run between updates
+    RouteEngines* engines = GetRouteEngines();
+    if (GetLazyRoutes())
+    {
+        // the routes are computed again as the nodes look them up
+        std::set<uint32_t> changed;
+        SimulationSingleton<GlobalLSDBManager>::Get()->UpdateLinkStateDatabase(changed);
+        engines->spfUpdateStarted = false;
+        StartLazyRoutes(RouteEngines::LAZY_SPF);
+        return;
+    }
+    StopLazyRoutes();
+    SPFAlgorithm& spf = engines->spfUpdate;
+    if (!engines->spfUpdateStarted)
+    {
+        // the trees of an older run are out of date, the nodes diff their tables
+        spf.ClearTrees();
+        engines->spfUpdateStarted = true;
+    }
+    GlobalLSDBManager* manager = SimulationSingleton<GlobalLSDBManager>::Get();
+    std::set<uint32_t> changed;
+    bool externals = manager->UpdateLinkStateDatabase(changed);
+    Ptr<LSDB> lsdb = manager->GetSnapshot();
+    spf.InsertLSDB(PeekPointer(lsdb));
+    spf.InsertRouterDirectory(manager->GetRouterDirectory());
+    spf.InsertAreaDirectory(manager->GetAreaDirectory());
+    spf.SetThreads(GetRouteComputationThreads());
+    spf.SetSharedTrees(GetSharedSpfTrees());
+    if (externals)
+    {
+        spf.InitializeRoutes();
+    }
+    else
+    {
+        spf.UpdateRoutes(changed);
+    }
+    if (GetKShortestPaths() > 0)
+    {
+        InitializeKShortestPaths();
+    }
+}
+
+void
+RouteManager::ComputeLazyRoutes(uint32_t nodeId)
+{
+    NS_LOG_FUNCTION(nodeId);
+    RouteEngines* engines = GetRouteEngines();
+    if (engines->lazy == RouteEngines::LAZY_NONE)
+    {
+        return;
+    }
+    uint32_t bound = GetLazyRouteTables();
+    if (bound > 0 && engines->lazyNodes.size() >= bound)
+    {
+        // free the routes of the least recently used node until it needs them again
+        std::vector<uint32_t>& nodes = engines->lazyNodes;
+        uint32_t lru = 0;
+        uint64_t oldest = GetRomamRouting(NodeList::GetNode(nodes[0]))->GetLastLookupStamp();
+        for (uint32_t i = 1; i < nodes.size(); i++)
+        {
+            uint64_t last = GetRomamRouting(NodeList::GetNode(nodes[i]))->GetLastLookupStamp();
+            if (last < oldest)
+            {
+                lru = i;
+                oldest = last;
+            }
+        }
+        NS_LOG_LOGIC("Freeing the routes of node " << nodes[lru]);
+        Ptr<RomamRouting> evicted = GetRomamRouting(NodeList::GetNode(nodes[lru]));
+        evicted->ClearRoutes();
+        evicted->RequestLazyRoutes(nodes[lru]);
+        nodes[lru] = nodes.back();
+        nodes.pop_back();
+    }
+    Ptr<RomamRouter> router = NodeList::GetNode(nodeId)->GetObject<RomamRouter>();
+    NS_ASSERT(router);
+    if (engines->lazy == RouteEngines::LAZY_DIJKSTRA)
+    {
+        engines->dijkstra.InitializeRoutes(router->GetRouterId());
+    }
+    else
+    {
+        engines->spf.InitializeRoutes(router->GetRouterId());
+    }
+    engines->lazyNodes.push_back(nodeId);
+}
+
+void
+RouteManager::InitializeKShortestPaths(void)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    GlobalLSDBManager* manager = SimulationSingleton<GlobalLSDBManager>::Get();
+    RouteEngines* engines = GetRouteEngines();
+    KShortestPathAlgorithm& kShortest = engines->kShortest;
+    // pinned for the paths the nodes restore later
+    engines->kShortestLSDB = manager->GetSnapshot();
+    kShortest.InsertLSDB(PeekPointer(engines->kShortestLSDB));
+    kShortest.InsertRouterDirectory(manager->GetRouterDirectory());
+    kShortest.SetK(GetKShortestPaths());
+    kShortest.SetMemoryBound(GetKShortestPathMemory());
+    kShortest.InitializeRoutes();
+}
+
+bool
+RouteManager::RestoreKShortestPaths(uint32_t nodeId, uint32_t d)
+{
+    NS_LOG_FUNCTION(nodeId << d);
+    RouteEngines* engines = GetRouteEngines();
+    if (!engines->kShortestLSDB)
+    {
+        return false;
+    }
+    Ptr<Node> node = NodeList::GetNode(nodeId);
+    Ptr<RomamRouter> router = node->GetObject<RomamRouter>();
+    Ptr<DDRRouting> ddr = router ? DynamicCast<DDRRouting>(router->GetRoutingProtocol()) : nullptr;
+    NS_ASSERT_MSG(ddr, "Node " << nodeId << " has no DDRRouting");
+    return engines->kShortest.RestorePaths(router->GetRouterId(),
+                                           d,
+                                           ddr->GetKShortestPathTable());
+}
+
+void
+RouteManager::RecomputeDijkstraRoutes(void)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    // the nodes keep the routes the recompute does not change
+    RouteEngines* engines = GetRouteEngines();
+    engines->dijkstraUpdateStarted = false;
+    engines->spfUpdateStarted = false;
+    BuildLSDB();
+    InitializeDijkstraRoutes();
+}
+
+void
+RouteManager::RecomputeSPFRoutes(void)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    // the nodes keep the routes the recompute does not change
+    RouteEngines* engines = GetRouteEngines();
+    engines->dijkstraUpdateStarted = false;
+    engines->spfUpdateStarted = false;
+    BuildLSDB();
+    InitializeSPFRoutes();
+}
+
+void
+RouteManager::ScheduleRecompute(uint32_t nodeId, RouteRecomputeScheduler::Recompute recompute)
+{
+    NS_LOG_FUNCTION(nodeId);
+    GetRecomputeScheduler()->Schedule(nodeId, recompute);
+}
+
+std::size_t
+RouteManager::GetRouteEngineMemoryUsage(void)
+{
+    RouteEngines* engines = GetRouteEngines();
+    return engines->dijkstra.GetMemoryUsage() + engines->spf.GetMemoryUsage() +
+           engines->dijkstraUpdate.GetMemoryUsage() + engines->spfUpdate.GetMemoryUsage() +
+           engines->kShortest.GetMemoryUsage() + engines->sharedTrees.GetMemoryUsage();
+}
+
+std::size_t
+RouteManager::GetRoutingMemoryFootprint(void)
+{
+    std::size_t bytes = 0;
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouting> routing = GetRomamRouting(*i);
+        if (routing)
+        {
+            bytes += routing->GetMemoryFootprint();
+        }
+    }
+    return bytes;
+}
+
+uint32_t
+RouteManager::GetNPrunedRoutes()
+{
+    uint32_t pruned = 0;
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouting> routing = GetRomamRouting(*i);
+        if (routing)
+        {
+            pruned += routing->GetNPrunedRoutes();
+        }
+    }
+    return pruned;
+}
+
+std::size_t
+RouteManager::GetLSDBMemoryFootprint(void)
+{
     LSDB* lsdb = SimulationSingleton<GlobalLSDBManager>::Get()->GetLSDB();
-    SPFAlgorithm* spf = new SPFAlgorithm();
-    spf->InsertLSDB(lsdb);
-    spf->InitializeRoutes();
+    return lsdb ? lsdb->GetMemoryFootprint() : 0;
+}
+
+/// where ExportRoute () writes a route to
+struct RouteExport
+{
+    std::ostream* os;                      //!< the output stream
+    RouteManager::RouteTableFormat format; //!< the format of the routes
+    uint32_t nodeId;                       //!< the ID of the node of the table
+};
+
+/**
+ * \brief Write a 32-bit word in big-endian order.
+ * \param os the output stream
+ * \param value the word
+ */
+static void
+WriteExportWord(std::ostream& os, uint32_t value)
+{
+    char bytes[4] = {char(value >> 24), char(value >> 16), char(value >> 8), char(value)};
+    os.write(bytes, sizeof(bytes));
+}
+
+/**
+ * \brief Write a route of a table, the callback of RomamRouting::ForEachRoute ().
+ * \param out where to write it
+ * \param route the route
+ */
+static void
+ExportRoute(RouteExport* out, const RouteInfoEntry& route)
+{
+    std::ostream& os = *out->os;
+    if (out->format == RouteManager::ROUTE_TABLE_BINARY)
+    {
+        WriteExportWord(os, out->nodeId);
+        WriteExportWord(os, route.GetDest().Get());
+        WriteExportWord(os, route.GetDestNetworkMask().Get());
+        WriteExportWord(os, route.GetGateway().Get());
+        WriteExportWord(os, route.GetInterface());
+        return;
+    }
+    // no flush per line, the tables of large topologies hold millions of routes
+    os << out->nodeId << ',' << route.GetDest() << ',' << route.GetDestNetworkMask() << ','
+       << route.GetGateway() << ',' << route.GetInterface() << ",U"
+       << (route.IsHost() ? "H" : (route.IsGateway() ? "G" : "")) << '\n';
+}
+
+void
+RouteManager::ExportRoutingTables(std::ostream& os, RouteTableFormat format)
+{
+    NS_LOG_FUNCTION(format);
+    if (format == ROUTE_TABLE_CSV)
+    {
+        os << "node,destination,mask,gateway,interface,flags\n";
+    }
+    RouteExport out = {&os, format, 0};
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouting> routing = GetRomamRouting(*i);
+        if (routing)
+        {
+            out.nodeId = (*i)->GetId();
+            routing->ForEachRoute(MakeBoundCallback(&ExportRoute, &out));
+        }
+    }
+    os.flush();
+}
+
+void
+RouteManager::PrintRoutingStats(std::ostream& os)
+{
+    RoutingStats total;
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouting> routing = GetRomamRouting(*i);
+        if (routing)
+        {
+            os << "node=" << (*i)->GetId() << ' ';
+            routing->GetRoutingStats().Print(os);
+            os << std::endl;
+            total.Merge(routing->GetRoutingStats());
+        }
+    }
+    os << "node=all ";
+    total.Print(os);
+    os << std::endl;
+}
+
+void
+RouteManager::GetRoutingStats(RoutingStats& stats)
+{
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouting> routing = GetRomamRouting(*i);
+        if (routing)
+        {
+            stats.Merge(routing->GetRoutingStats());
+        }
+    }
+}
+
+void
+RouteManager::ResetRoutingStats(void)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<RomamRouting> routing = GetRomamRouting(*i);
+        if (routing)
+        {
+            routing->ResetRoutingStats();
+        }
+    }
+}
+
+RouteRecomputeScheduler*
+RouteManager::GetRecomputeScheduler(void)
+{
+    return SimulationSingleton<RouteRecomputeScheduler>::Get();
+}
+
+const DistanceMatrix*
+RouteManager::GetDistanceMatrix(void)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    Ptr<LSDB> lsdb = SimulationSingleton<GlobalLSDBManager>::Get()->GetSnapshot();
+    DistanceMatrix* matrix = SimulationSingleton<DistanceMatrix>::Get();
+    if (lsdb && !matrix->IsCurrent(PeekPointer(lsdb)))
+    {
+        matrix->Build(PeekPointer(lsdb));
+    }
+    return matrix;
+}
+
+uint32_t
+RouteManager::GetDistance(Ipv4Address fromRouterId, Ipv4Address toRouterId)
+{
+    return GetDistanceMatrix()->GetDistance(fromRouterId, toRouterId);
+}
+
+uint32_t
+RouteManager::GetNodeDistance(uint32_t fromNodeId, uint32_t toNodeId)
+{
+    Ptr<RomamRouter> from = NodeList::GetNode(fromNodeId)->GetObject<RomamRouter>();
+    Ptr<RomamRouter> to = NodeList::GetNode(toNodeId)->GetObject<RomamRouter>();
+    if (!from || !to)
+    {
+        return DistanceMatrix::INFINITE_DISTANCE;
+    }
+    return GetDistance(from->GetRouterId(), to->GetRouterId());
+}
+
+Time
+RouteManager::GetMetricDelay()
+{
+    TimeValue delay;
+    g_metricDelay.GetValue(delay);
+    return delay.Get();
+}
+
+uint16_t
+RouteManager::GetDelayMetric(Time delay)
+{
+    int64_t unit = GetMetricDelay().GetTimeStep();
+    int64_t metric = (delay.GetTimeStep() + unit / 2) / unit;
+    return std::min<int64_t>(std::max<int64_t>(metric, 1), 0xffff);
+}
+
+void
+RouteManager::SetDelayMetrics()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<Ipv4> ipv4 = (*i)->GetObject<Ipv4>();
+        if (!ipv4)
+        {
+            continue;
+        }
+        for (uint32_t j = 0; j < ipv4->GetNInterfaces(); j++)
+        {
+            Ptr<Channel> channel = ipv4->GetNetDevice(j)->GetChannel();
+            TimeValue delay;
+            if (channel && channel->GetAttributeFailSafe("Delay", delay))
+            {
+                ipv4->SetMetric(j, GetDelayMetric(delay.Get()));
+            }
+        }
+    }
 }
 
 } // namespace ns3
@@ -3,11 +3,20 @@
 #ifndef ROUTE_MANAGER_H
 #define ROUTE_MANAGER_H
 
+#include "route-recompute-scheduler.h"
+
 #include "ns3/core-module.h"
+#include "ns3/ipv4-address.h"
+
+#include <cstddef>
+#include <ostream>
 
 namespace ns3
 {
 
+class DistanceMatrix;
+class RoutingStats;
+
 /**
  * \ingroup Romam Routing Framework
  *
@@ -35,18 +44,284 @@ class RouteManager
      */
     static void BuildLSDB();
 
+    /**
+     * @brief Advertise a range instead of the prefixes of an area it covers,
+     * to the other areas, from the next LSDB build or update on.
+     *
+     * The areas are the ones of the RomamRouter AreaId attributes, see
+     * AreaDirectory.
+     *
+     * @param area the area ID, not the backbone
+     * @param network the network of the range
+     * @param mask its mask
+     */
+    static void AddAreaRange(uint32_t area, Ipv4Address network, Ipv4Mask mask);
+
     /**
      * @brief Compute routes using a Dijkstra algorithm computation and populate
      * per-node forwarding tables
+     *
+     * The trees of the different routers are computed on as many worker threads
+     * as the RomamRouteComputationThreads global value gives.  If the
+     * RomamSharedRouteTrees global value is set, the trees are kept for
+     * InitializeSPFRoutes () on the same LSDB version, or taken from it.
+     *
+     * If the RomamLazyRoutes global value is set, the tables are only cleared,
+     * and the routes of a node are computed on its first route lookup, see
+     * ComputeLazyRoutes ().  Otherwise, if the RomamRouteTableCache global
+     * value is set, the tables are kept past the end of the simulation, and a
+     * later simulation of the same topology installs them instead of
+     * computing them.
      */
     static void InitializeDijkstraRoutes();
 
     /**
      * @brief Compute routes using a Shortest path forest algorithm computation and populate
      * per-node forwarding tables
+     *
+     * The trees of the different routers are computed on as many worker threads
+     * as the RomamRouteComputationThreads global value gives, from shared trees
+     * if the RomamSharedSpfTrees or RomamSharedRouteTrees global value is set,
+     * the latter sharing them with InitializeDijkstraRoutes ().  The k shortest paths of
+     * the KSHORT route select mode follow if RomamKShortestPaths is not 0.
+     *
+     * If the RomamLazyRoutes global value is set, the tables are only cleared,
+     * and the routes of a node are computed on its first route lookup, see
+     * ComputeLazyRoutes (); the k shortest paths are not computed then.
+     * Otherwise the tables are kept as by InitializeDijkstraRoutes () if
+     * RomamRouteTableCache is set, the k shortest paths being computed again.
      */
     static void InitializeSPFRoutes();
 
+    /**
+     * @brief Free the tables RomamRouteTableCache kept, so the next
+     * initialization computes them.
+     */
+    static void ClearRouteTableCache();
+
+    /**
+     * @brief Rebuild the Link State Database (LSDB) and update the routes computed
+     * with the Dijkstra algorithm, recomputing only the SPF trees the change crosses.
+     *
+     * Unlike DeleteRoutes (), BuildLSDB () and InitializeDijkstraRoutes (), only the
+     * routes that changed are removed from and added to the forwarding tables.
+     */
+    static void UpdateDijkstraRoutes();
+
+    /**
+     * @brief Rebuild the Link State Database (LSDB) and update the routes computed
+     * with the Shortest path forest algorithm, recomputing only the SPF trees the
+     * change crosses.
+     *
+     * Unlike DeleteRoutes (), BuildLSDB () and InitializeSPFRoutes (), only the
+     * routes that changed are removed from and added to the forwarding tables.
+     */
+    static void UpdateSPFRoutes();
+
+    /**
+     * @brief Compute the routes of a node whose routes are computed lazily,
+     * and install them on it.
+     *
+     * The routing protocol of the node calls it on its first route lookup
+     * after the routes were initialized with RomamLazyRoutes set, from the
+     * Link State Database (LSDB) of the initialization.  When the
+     * RomamLazyRouteTables global value bounds the number of nodes holding
+     * lazy routes, the routes of the node whose last lookup is the oldest
+     * are freed first, and computed again on its next lookup.  An update of
+     * the routes in lazy mode only brings the LSDB up to date and frees all
+     * the routes.
+     *
+     * @param nodeId the ID of the node
+     */
+    static void ComputeLazyRoutes(uint32_t nodeId);
+
+    /**
+     * @brief Compute the RomamKShortestPaths shortest paths between the routers
+     * of the Link State Database (LSDB) and fill the tables the KSHORT route
+     * select mode of the DDRRouting nodes forwards from.
+     *
+     * The paths a node keeps to a router are bounded by the
+     * RomamKShortestPathMemory global value.
+     */
+    static void InitializeKShortestPaths();
+
+    /**
+     * @brief Compute again the k shortest paths of a destination a node
+     * trimmed to its best path, from the LSDB the paths were computed from.
+     *
+     * @param nodeId the ID of the node
+     * @param d the destination in the KShortestPathTable of the node
+     * @returns false if the paths of the node are not computed or the
+     * routers are gone
+     */
+    static bool RestoreKShortestPaths(uint32_t nodeId, uint32_t d);
+
+    /**
+     * @brief Rebuild the Link State Database (LSDB) and compute the routes
+     * again with the Dijkstra algorithm.
+     *
+     * Every node only removes and adds the routes that differ from the ones it
+     * holds, see RomamRouting::UpdateRoutes ().
+     */
+    static void RecomputeDijkstraRoutes();
+
+    /**
+     * @brief Rebuild the Link State Database (LSDB) and compute the routes
+     * again with the Shortest path forest algorithm.
+     *
+     * Every node only removes and adds the routes that differ from the ones it
+     * holds, see RomamRouting::UpdateRoutes ().
+     */
+    static void RecomputeSPFRoutes();
+
+    /**
+     * @brief Ask for a recompute of the routes after an interface event.
+     *
+     * The events of a node failure arrive in bursts: the scheduler of the
+     * simulation collects them and runs each recompute function once after its
+     * hold-down, minding the backoff between recomputes.
+     *
+     * @param nodeId the ID of the node that saw the event
+     * @param recompute the function to run, such as UpdateSPFRoutes ()
+     */
+    static void ScheduleRecompute(uint32_t nodeId, RouteRecomputeScheduler::Recompute recompute);
+
+    /**
+     * @brief Get the scheduler of the route recomputes of the simulation.
+     * @returns the scheduler, deleted when the simulation is destroyed
+     */
+    static RouteRecomputeScheduler* GetRecomputeScheduler();
+
+    /**
+     * @brief Get the memory the route engines keep between recomputes.
+     *
+     * The engines of the different Initialize and Update functions live as
+     * long as the simulation and are reused by every recompute, so this is
+     * what the computations add to the Link State Database (LSDB) they share.
+     *
+     * @returns the number of bytes
+     */
+    static std::size_t GetRouteEngineMemoryUsage();
+
+    /**
+     * @brief Get the memory the routing state of all the nodes takes.
+     *
+     * This is the sum of RomamRouting::GetMemoryFootprint () over the routers
+     * of the NodeList: their route entries, indices and neighbor state
+     * tables, without the Link State Database (LSDB) they share.
+     *
+     * @returns the number of bytes
+     */
+    static std::size_t GetRoutingMemoryFootprint();
+
+    /**
+     * @brief Get the candidate routes the MaxCandidates caps of the routers
+     * kept out of their tables.
+     *
+     * This is the sum of RomamRouting::GetNPrunedRoutes () over the routers
+     * of the NodeList, for the last tables the engines installed on them.
+     *
+     * @returns the number of routes
+     */
+    static uint32_t GetNPrunedRoutes();
+
+    /**
+     * @brief Get the memory the Link State Database (LSDB) takes.
+     * @returns the number of bytes of its LSAs and indices, or 0 if it was
+     * not built
+     */
+    static std::size_t GetLSDBMemoryFootprint();
+
+    /// the formats of ExportRoutingTables ()
+    enum RouteTableFormat
+    {
+        ROUTE_TABLE_CSV,   //!< a header line, then one line per route
+        ROUTE_TABLE_BINARY //!< five big-endian 32-bit words per route
+    };
+
+    /**
+     * @brief Write the routes of every router, node after node, in one pass
+     * over each table.
+     *
+     * A route is its node ID, destination, mask, gateway, output interface
+     * and, in CSV, its flags as PrintRoutingTable () shows them: U, then H
+     * for a host route or G for a gateway route.  In binary, the addresses
+     * are the words of Ipv4Address::Get () and Ipv4Mask::Get (), without a
+     * header, so the size of the output counts the routes.
+     *
+     * @param os the output stream
+     * @param format the format of the routes
+     */
+    static void ExportRoutingTables(std::ostream& os, RouteTableFormat format = ROUTE_TABLE_CSV);
+
+    /**
+     * @brief Print the counters of the route lookups of every router, one
+     * line per node, then their sum.
+     * @param os the output stream
+     */
+    static void PrintRoutingStats(std::ostream& os);
+
+    /**
+     * @brief Sum the counters of the route lookups of all the routers.
+     * @param stats the sum is added to it
+     */
+    static void GetRoutingStats(RoutingStats& stats);
+
+    /**
+     * @brief Set the counters of the route lookups of all the routers to 0,
+     * e.g., at the end of a warm-up.
+     */
+    static void ResetRoutingStats();
+
+    /**
+     * @brief Get the distances between all the routers of the Link State
+     * Database (LSDB), computed on the first call after the LSDB changed.
+     * @returns the matrix, deleted when the simulation is destroyed
+     */
+    static const DistanceMatrix* GetDistanceMatrix();
+
+    /**
+     * @brief Get the shortest distance between two routers, as a DistTag
+     * counts it.
+     * @param fromRouterId the router ID of the source
+     * @param toRouterId the router ID of the destination
+     * @returns the sum of the link metrics, or DistanceMatrix::INFINITE_DISTANCE
+     * if the destination cannot be reached
+     */
+    static uint32_t GetDistance(Ipv4Address fromRouterId, Ipv4Address toRouterId);
+
+    /**
+     * @brief Get the shortest distance between the routers of two nodes.
+     * @param fromNodeId the ID of the source node
+     * @param toNodeId the ID of the destination node
+     * @returns the sum of the link metrics, or DistanceMatrix::INFINITE_DISTANCE
+     * if the destination cannot be reached or either node is not a router
+     */
+    static uint32_t GetNodeDistance(uint32_t fromNodeId, uint32_t toNodeId);
+
+    /**
+     * @brief Get the propagation delay of a unit of link metric, the
+     * RomamMetricDelay global value.
+     * @returns the delay
+     */
+    static Time GetMetricDelay();
+
+    /**
+     * @brief Get the link metric of a propagation delay.
+     * @param delay the propagation delay of a link
+     * @returns the delay in units of GetMetricDelay (), rounded and clamped to
+     * the range of a link metric, [1, 65535]
+     */
+    static uint16_t GetDelayMetric(Time delay);
+
+    /**
+     * @brief Set the metric of every interface of the nodes in the simulation
+     * whose channel has a Delay attribute to GetDelayMetric () of the delay,
+     * so the distances of the SPF trees are propagation delays.  It is to be
+     * called before the LSDB is built.
+     */
+    static void SetDelayMetrics();
+
   private:
     /**
      * @brief Global Route Manager copy construction is disallowed.  There's no
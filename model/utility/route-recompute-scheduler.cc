@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "route-recompute-scheduler.h"
+
+#include "event-accounting.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RouteRecomputeScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(RouteRecomputeScheduler);
+
+TypeId
+RouteRecomputeScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::RouteRecomputeScheduler")
+            .SetParent<ObjectBase>()
+            .SetGroupName("Romam")
+            .AddAttribute("InitialDelay",
+                          "Delay between the first interface event after a quiet period and "
+                          "the route recompute it triggers",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RouteRecomputeScheduler::m_initialDelay),
+                          MakeTimeChecker())
+            .AddAttribute("HoldTime",
+                          "Minimum time between two route recomputes, doubled every time an "
+                          "event arrives within it",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RouteRecomputeScheduler::m_holdTime),
+                          MakeTimeChecker())
+            .AddAttribute("MaxDelay",
+                          "Maximum time between two route recomputes",
+                          TimeValue(Seconds(5)),
+                          MakeTimeAccessor(&RouteRecomputeScheduler::m_maxDelay),
+                          MakeTimeChecker());
+    return tid;
+}
+
+RouteRecomputeScheduler::RouteRecomputeScheduler()
+    : m_ran(false)
+{
+    NS_LOG_FUNCTION(this);
+    ObjectBase::ConstructSelf(AttributeConstructionList());
+    m_currentHold = m_holdTime;
+}
+
+RouteRecomputeScheduler::~RouteRecomputeScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+TypeId
+RouteRecomputeScheduler::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+void
+RouteRecomputeScheduler::Schedule(uint32_t nodeId, Recompute recompute)
+{
+    NS_LOG_FUNCTION(this << nodeId);
+    m_dirty.insert(nodeId);
+    if (std::find(m_recomputes.begin(), m_recomputes.end(), recompute) == m_recomputes.end())
+    {
+        m_recomputes.push_back(recompute);
+    }
+    if (m_event.IsRunning())
+    {
+        NS_LOG_LOGIC("Recompute pending, " << m_dirty.size() << " nodes changed");
+        return;
+    }
+    Time now = Simulator::Now();
+    Time delay = m_initialDelay;
+    if (m_ran && now < m_lastRun + m_currentHold)
+    {
+        delay = std::max(delay, m_lastRun + m_currentHold - now);
+        m_currentHold = std::min(m_currentHold + m_currentHold, m_maxDelay);
+    }
+    else
+    {
+        m_currentHold = m_holdTime;
+    }
+    NS_LOG_LOGIC("Recomputing the routes in " << delay.As(Time::S) << ", hold time "
+                                              << m_currentHold.As(Time::S));
+    m_event = Simulator::Schedule(delay, &RouteRecomputeScheduler::Run, this);
+}
+
+void
+RouteRecomputeScheduler::Flush()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_event.IsRunning())
+    {
+        m_event.Cancel();
+        Run();
+    }
+}
+
+bool
+RouteRecomputeScheduler::IsPending() const
+{
+    return m_event.IsRunning();
+}
+
+const std::set<uint32_t>&
+RouteRecomputeScheduler::GetDirtyNodes() const
+{
+    return m_dirty;
+}
+
+void
+RouteRecomputeScheduler::Run()
+{
+    NS_LOG_FUNCTION(this);
+    EventAccounting::Scope scope(EventAccounting::RECOMPUTE);
+    NS_LOG_INFO("Recomputing the routes after events on " << m_dirty.size() << " nodes");
+    m_lastRun = Simulator::Now();
+    m_ran = true;
+    // the recompute functions may report new events, which go to the next run
+    std::vector<Recompute> recomputes;
+    recomputes.swap(m_recomputes);
+    m_dirty.clear();
+    for (auto i = recomputes.begin(); i != recomputes.end(); i++)
+    {
+        (*i)();
+    }
+}
+
+} // namespace ns3
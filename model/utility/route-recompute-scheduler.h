@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROUTE_RECOMPUTE_SCHEDULER_H
+#define ROUTE_RECOMPUTE_SCHEDULER_H
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object-base.h"
+
+#include <set>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Coalesces the route recomputations the interface events ask for.
+ *
+ * A node failure notifies every interface of every neighbor, and each of the
+ * notifications used to recompute the routes of the whole network.  The
+ * scheduler instead collects the nodes that saw an event and the recompute
+ * functions they asked for, and runs each function once after a hold-down.
+ *
+ * The delays follow the OSPF SPF throttling: the first recompute after a
+ * quiet period runs InitialDelay after the event.  An event arriving within
+ * the hold time of the last recompute waits for the end of it, and doubles
+ * the hold time for the next one, up to MaxDelay.  An event arriving once the
+ * hold time elapsed resets it to HoldTime.
+ *
+ * RouteManager owns the scheduler of the simulation, which the attributes of
+ * ns3::RouteRecomputeScheduler configure through Config::SetDefault ().
+ */
+class RouteRecomputeScheduler : public ObjectBase
+{
+  public:
+    /// a function recomputing the routes of the network
+    typedef void (*Recompute)();
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    RouteRecomputeScheduler();
+    ~RouteRecomputeScheduler() override;
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    RouteRecomputeScheduler(const RouteRecomputeScheduler&) = delete;
+    RouteRecomputeScheduler& operator=(const RouteRecomputeScheduler&) = delete;
+
+    TypeId GetInstanceTypeId() const override;
+
+    /**
+     * \brief Mark a node as changed and schedule a recompute, unless one is
+     * pending already.
+     * \param nodeId the ID of the node that saw an interface event
+     * \param recompute the function to run, once per pending recompute
+     */
+    void Schedule(uint32_t nodeId, Recompute recompute);
+
+    /**
+     * \brief Run the pending recompute now, if any.
+     */
+    void Flush();
+
+    /**
+     * \return true if a recompute is pending
+     */
+    bool IsPending() const;
+
+    /**
+     * \return the IDs of the nodes that saw an event since the last recompute
+     */
+    const std::set<uint32_t>& GetDirtyNodes() const;
+
+  private:
+    /**
+     * \brief Run the recompute functions collected since the last run.
+     */
+    void Run();
+
+    Time m_initialDelay;                 //!< delay of the first recompute after a quiet period
+    Time m_holdTime;                     //!< initial minimum time between two recomputes
+    Time m_maxDelay;                     //!< maximum time between two recomputes
+    Time m_currentHold;                  //!< minimum time between the last recompute and the next
+    Time m_lastRun;                      //!< time of the last recompute
+    bool m_ran;                          //!< a recompute ran already
+    EventId m_event;                     //!< the pending recompute
+    std::set<uint32_t> m_dirty;          //!< nodes that saw an event since the last recompute
+    std::vector<Recompute> m_recomputes; //!< functions to run, in the order asked for
+};
+
+} // namespace ns3
+
+#endif /* ROUTE_RECOMPUTE_SCHEDULER_H */
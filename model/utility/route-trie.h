@@ -0,0 +1,420 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROUTE_TRIE_H
+#define ROUTE_TRIE_H
+
+#include "ns3/assert.h"
+#include "ns3/ipv4-address.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Path-compressed binary trie (a Patricia trie) holding network (and
+ * AS-external) route entries.
+ *
+ * A node stands either for a prefix routes are installed for, or for the
+ * branch of two longer prefixes; a chain of bits no prefix ends on is
+ * skipped, so the trie has fewer than two nodes per prefix whatever the
+ * prefix lengths.  A node left with neither entries nor a branch when an
+ * entry is removed is freed, and reused by the next insert.
+ *
+ * A lookup visits the prefixes covering a destination, at most 33, and
+ * returns their entries in the order they were inserted, as the former scan
+ * of the std::list of the routes did: every matching prefix takes part in the
+ * ECMP set, whatever its length, and a first-only lookup takes the entry
+ * inserted first among all the matching ones.
+ *
+ * The trie does not own the entries, the routing protocol still deletes them.
+ *
+ * \tparam T route entry type (DijkstraRIE, ShortestPathForestRIE, ArmedSpfRIE)
+ */
+template <typename T>
+class RouteTrie
+{
+  public:
+    RouteTrie();
+
+    /**
+     * \brief Install a route entry for network/networkMask.
+     * \param network the network address
+     * \param networkMask the network mask, must be contiguous
+     * \param entry the route entry
+     */
+    void Insert(Ipv4Address network, Ipv4Mask networkMask, T* entry);
+
+    /**
+     * \brief Remove a route entry previously installed for network/networkMask.
+     * \param network the network address
+     * \param networkMask the network mask
+     * \param entry the route entry
+     * \return true if the entry was found and removed
+     */
+    bool Remove(Ipv4Address network, Ipv4Mask networkMask, T* entry);
+
+    /**
+     * \brief Remove all the entries.
+     */
+    void Clear();
+
+    /**
+     * \return the number of installed entries
+     */
+    uint32_t GetN() const;
+
+    /**
+     * \return the number of nodes in use, the root included
+     */
+    uint32_t GetNNodes() const;
+
+    /**
+     * \return the number of bytes of the nodes and of their entry vectors
+     */
+    std::size_t GetMemoryUsage() const;
+
+    /**
+     * \brief Collect the routes of the prefixes covering dest.
+     *
+     * The entries accepted by the filter are appended in the order they were
+     * inserted, whatever the length of their prefix; with firstOnly, only the
+     * accepted entry inserted first is.
+     *
+     * \param dest the destination address
+     * \param filter callable taking a T* and returning true to accept it
+     * \param routes vector the accepted entries are appended to
+     * \param firstOnly append the first accepted entry only
+     * \return the number of entries appended
+     */
+    template <typename Filter, typename Route>
+    uint32_t Lookup(Ipv4Address dest,
+                    Filter filter,
+                    std::vector<Route*>& routes,
+                    bool firstOnly = false) const;
+
+  private:
+    /// an installed entry
+    struct Entry
+    {
+        T* route;     //!< the route entry
+        uint64_t seq; //!< insertion number, the order of the lookups
+    };
+
+    /// entries installed for a single prefix, in insertion order
+    typedef std::vector<Entry> Entries;
+
+    /// trie node, children are indices into m_nodes (0 means none)
+    struct Node
+    {
+        uint32_t key;      //!< the prefix, its bits beyond length cleared
+        uint8_t length;    //!< the prefix length
+        uint32_t child[2]; //!< child indices for the bit after the prefix
+        Entries entries;   //!< entries installed for this exact prefix
+    };
+
+    /// the most nodes on the path of an address, the root included
+    static const uint32_t MAX_DEPTH = 33;
+
+    /**
+     * \param length a prefix length
+     * \return the mask of the length
+     */
+    static uint32_t GetMask(uint8_t length);
+
+    /**
+     * \param key an address
+     * \param depth a bit index, from the most significant bit, below 32
+     * \return the bit
+     */
+    static uint32_t GetBit(uint32_t key, uint8_t depth);
+
+    /**
+     * \param key the prefix
+     * \param length the prefix length
+     * \return the index of a new node for the prefix
+     */
+    uint32_t AllocateNode(uint32_t key, uint8_t length);
+
+    /**
+     * \brief Find the path to the node of an exact prefix.
+     * \param key the prefix
+     * \param length the prefix length
+     * \param path set to the nodes from the root to the prefix
+     * \return the number of nodes on the path, 0 if the prefix has no node
+     */
+    uint32_t FindPath(uint32_t key, uint8_t length, uint32_t* path) const;
+
+    std::vector<Node> m_nodes;    //!< node pool, m_nodes[0] is the /0 prefix
+    std::vector<uint32_t> m_free; //!< nodes of the pool not in use
+    uint32_t m_size;              //!< number of installed entries
+    uint64_t m_nextSeq;           //!< insertion number of the next entry
+};
+
+template <typename T>
+RouteTrie<T>::RouteTrie()
+    : m_size(0),
+      m_nextSeq(0)
+{
+    Clear();
+}
+
+template <typename T>
+uint32_t
+RouteTrie<T>::GetMask(uint8_t length)
+{
+    return length == 0 ? 0 : 0xffffffffu << (32 - length);
+}
+
+template <typename T>
+uint32_t
+RouteTrie<T>::GetBit(uint32_t key, uint8_t depth)
+{
+    return (key >> (31 - depth)) & 1;
+}
+
+template <typename T>
+uint32_t
+RouteTrie<T>::AllocateNode(uint32_t key, uint8_t length)
+{
+    uint32_t index;
+    if (m_free.empty())
+    {
+        index = m_nodes.size();
+        m_nodes.push_back(Node());
+    }
+    else
+    {
+        index = m_free.back();
+        m_free.pop_back();
+    }
+    Node& node = m_nodes[index];
+    node.key = key;
+    node.length = length;
+    node.child[0] = 0;
+    node.child[1] = 0;
+    return index;
+}
+
+template <typename T>
+uint32_t
+RouteTrie<T>::FindPath(uint32_t key, uint8_t length, uint32_t* path) const
+{
+    uint32_t depth = 0;
+    uint32_t index = 0;
+    path[depth++] = index;
+    while (m_nodes[index].length < length)
+    {
+        index = m_nodes[index].child[GetBit(key, m_nodes[index].length)];
+        if (index == 0 || m_nodes[index].length > length ||
+            (key & GetMask(m_nodes[index].length)) != m_nodes[index].key)
+        {
+            return 0;
+        }
+        path[depth++] = index;
+    }
+    return depth;
+}
+
+template <typename T>
+void
+RouteTrie<T>::Insert(Ipv4Address network, Ipv4Mask networkMask, T* entry)
+{
+    uint8_t length = networkMask.GetPrefixLength();
+    NS_ASSERT_MSG(length == 32 || (networkMask.Get() << length) == 0,
+                  "RouteTrie::Insert (): non-contiguous network mask " << networkMask);
+    uint32_t key = network.Get() & GetMask(length);
+    uint32_t index = 0;
+    while (m_nodes[index].length < length)
+    {
+        uint32_t bit = GetBit(key, m_nodes[index].length);
+        uint32_t next = m_nodes[index].child[bit];
+        if (next == 0)
+        {
+            next = AllocateNode(key, length);
+            m_nodes[index].child[bit] = next;
+            index = next;
+            break;
+        }
+        // the bits the prefix shares with the child, up to the shorter one
+        uint8_t limit = std::min(length, m_nodes[next].length);
+        uint32_t differ = (key ^ m_nodes[next].key) & GetMask(limit);
+        uint8_t common = m_nodes[index].length;
+        while (common < limit && GetBit(differ, common) == 0)
+        {
+            common++;
+        }
+        if (common == m_nodes[next].length)
+        {
+            index = next;
+            continue;
+        }
+        // the prefix ends, or branches off, before the child
+        uint32_t split = AllocateNode(key & GetMask(common), common);
+        m_nodes[split].child[GetBit(m_nodes[next].key, common)] = next;
+        m_nodes[index].child[bit] = split;
+        index = split;
+        if (common < length)
+        {
+            uint32_t leaf = AllocateNode(key, length);
+            m_nodes[split].child[GetBit(key, common)] = leaf;
+            index = leaf;
+        }
+        break;
+    }
+    m_nodes[index].entries.push_back(Entry{entry, m_nextSeq++});
+    m_size++;
+}
+
+template <typename T>
+bool
+RouteTrie<T>::Remove(Ipv4Address network, Ipv4Mask networkMask, T* entry)
+{
+    uint8_t length = networkMask.GetPrefixLength();
+    uint32_t path[MAX_DEPTH];
+    uint32_t depth = FindPath(network.Get() & GetMask(length), length, path);
+    if (depth == 0 || m_nodes[path[depth - 1]].length != length)
+    {
+        return false;
+    }
+    Entries& entries = m_nodes[path[depth - 1]].entries;
+    typename Entries::iterator i = entries.begin();
+    while (i != entries.end() && i->route != entry)
+    {
+        i++;
+    }
+    if (i == entries.end())
+    {
+        return false;
+    }
+    entries.erase(i);
+    m_size--;
+    // free the nodes left with no entries and no branch, from the prefix up
+    while (depth > 1)
+    {
+        uint32_t index = path[depth - 1];
+        Node& node = m_nodes[index];
+        if (!node.entries.empty() || (node.child[0] != 0 && node.child[1] != 0))
+        {
+            break;
+        }
+        Node& parent = m_nodes[path[depth - 2]];
+        parent.child[GetBit(node.key, parent.length)] = node.child[0] | node.child[1];
+        Entries().swap(node.entries);
+        m_free.push_back(index);
+        depth--;
+    }
+    return true;
+}
+
+template <typename T>
+void
+RouteTrie<T>::Clear()
+{
+    m_nodes.clear();
+    m_free.clear();
+    AllocateNode(0, 0);
+    m_size = 0;
+    m_nextSeq = 0;
+}
+
+template <typename T>
+uint32_t
+RouteTrie<T>::GetN() const
+{
+    return m_size;
+}
+
+template <typename T>
+uint32_t
+RouteTrie<T>::GetNNodes() const
+{
+    return m_nodes.size() - m_free.size();
+}
+
+template <typename T>
+std::size_t
+RouteTrie<T>::GetMemoryUsage() const
+{
+    std::size_t bytes = m_nodes.capacity() * sizeof(Node) + m_free.capacity() * sizeof(uint32_t);
+    for (const Node& node : m_nodes)
+    {
+        bytes += node.entries.capacity() * sizeof(Entry);
+    }
+    return bytes;
+}
+
+template <typename T>
+template <typename Filter, typename Route>
+uint32_t
+RouteTrie<T>::Lookup(Ipv4Address dest,
+                     Filter filter,
+                     std::vector<Route*>& routes,
+                     bool firstOnly) const
+{
+    if (m_size == 0)
+    {
+        return 0;
+    }
+    // collect the nodes of the prefixes covering dest, shortest prefix first
+    uint32_t path[MAX_DEPTH];
+    uint32_t next[MAX_DEPTH];
+    uint32_t depth = 0;
+    uint32_t bits = dest.Get();
+    uint32_t index = 0;
+    while (true)
+    {
+        if (!m_nodes[index].entries.empty())
+        {
+            next[depth] = 0;
+            path[depth++] = index;
+        }
+        if (m_nodes[index].length == 32)
+        {
+            break;
+        }
+        index = m_nodes[index].child[GetBit(bits, m_nodes[index].length)];
+        if (index == 0 || (bits & GetMask(m_nodes[index].length)) != m_nodes[index].key)
+        {
+            break;
+        }
+    }
+    // merge their entries by insertion number
+    uint32_t found = 0;
+    while (true)
+    {
+        uint32_t best = MAX_DEPTH;
+        for (uint32_t d = 0; d < depth; d++)
+        {
+            const Entries& entries = m_nodes[path[d]].entries;
+            if (next[d] < entries.size() &&
+                (best == MAX_DEPTH ||
+                 entries[next[d]].seq < m_nodes[path[best]].entries[next[best]].seq))
+            {
+                best = d;
+            }
+        }
+        if (best == MAX_DEPTH)
+        {
+            return found;
+        }
+        T* route = m_nodes[path[best]].entries[next[best]++].route;
+        if (!filter(route))
+        {
+            continue;
+        }
+        routes.push_back(route);
+        found++;
+        if (firstOnly)
+        {
+            return found;
+        }
+    }
+}
+
+} // namespace ns3
+
+#endif /* ROUTE_TRIE_H */
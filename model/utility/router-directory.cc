@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "router-directory.h"
+
+#include "address-interner.h"
+#include "romam-router.h"
+
+#include "ns3/ipv4.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RouterDirectory");
+
+RouterDirectory::RouterDirectory()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+RouterDirectory::Build()
+{
+    NS_LOG_FUNCTION(this);
+    Clear();
+    // the indices of the routers and addresses follow the NodeList, and outlive a Clear ()
+    AddressInterner* interner = AddressInterner::Get();
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<Node> node = *i;
+        Ptr<RomamRouter> rtr = node->GetObject<RomamRouter>();
+        if (rtr)
+        {
+            m_routers[rtr->GetRouterId().Get()] = node;
+            interner->InternRouter(rtr->GetRouterId());
+        }
+        Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+        if (!ipv4)
+        {
+            continue;
+        }
+        std::vector<std::vector<Ipv4InterfaceAddress>>& interfaces = m_interfaces[node->GetId()];
+        interfaces.resize(ipv4->GetNInterfaces());
+        for (uint32_t j = 0; j < ipv4->GetNInterfaces(); j++)
+        {
+            for (uint32_t k = 0; k < ipv4->GetNAddresses(j); k++)
+            {
+                Ipv4InterfaceAddress address = ipv4->GetAddress(j, k);
+                interfaces[j].push_back(address);
+                interner->InternAddress(address.GetLocal());
+                // keep the first owner, as the former NodeList scans did
+                m_addresses.insert({address.GetLocal().Get(), {node, j}});
+            }
+        }
+        Ipv4Address loopback = RomamRouter::GetLoopbackAddress(ipv4);
+        if (loopback != Ipv4Address::GetAny())
+        {
+            m_loopbacks[node->GetId()] = loopback;
+        }
+    }
+    NS_LOG_LOGIC("Indexed " << m_routers.size() << " routers and " << m_addresses.size()
+                            << " addresses, " << interner->GetNAddresses() << " interned");
+}
+
+void
+RouterDirectory::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    m_routers.clear();
+    m_addresses.clear();
+    m_interfaces.clear();
+    m_loopbacks.clear();
+}
+
+Ptr<Node>
+RouterDirectory::GetNodeByRouterId(Ipv4Address routerId) const
+{
+    auto i = m_routers.find(routerId.Get());
+    if (i == m_routers.end())
+    {
+        return nullptr;
+    }
+    return i->second;
+}
+
+Ptr<Node>
+RouterDirectory::GetNodeByAddress(Ipv4Address address) const
+{
+    auto i = m_addresses.find(address.Get());
+    if (i == m_addresses.end())
+    {
+        return nullptr;
+    }
+    return i->second.node;
+}
+
+int32_t
+RouterDirectory::GetInterfaceForAddress(Ipv4Address address) const
+{
+    auto i = m_addresses.find(address.Get());
+    if (i == m_addresses.end())
+    {
+        return -1;
+    }
+    return i->second.ifIndex;
+}
+
+uint32_t
+RouterDirectory::GetNodeIdByRouterId(Ipv4Address routerId) const
+{
+    auto i = m_routers.find(routerId.Get());
+    if (i == m_routers.end())
+    {
+        return NO_NODE;
+    }
+    return i->second->GetId();
+}
+
+uint32_t
+RouterDirectory::GetNodeIdByAddress(Ipv4Address address) const
+{
+    auto i = m_addresses.find(address.Get());
+    if (i == m_addresses.end())
+    {
+        return NO_NODE;
+    }
+    return i->second.node->GetId();
+}
+
+uint32_t
+RouterDirectory::GetNInterfaces(uint32_t nodeId) const
+{
+    auto i = m_interfaces.find(nodeId);
+    if (i == m_interfaces.end())
+    {
+        return 0;
+    }
+    return i->second.size();
+}
+
+uint32_t
+RouterDirectory::GetNAddresses(uint32_t nodeId, uint32_t ifIndex) const
+{
+    return m_interfaces.at(nodeId).at(ifIndex).size();
+}
+
+Ipv4InterfaceAddress
+RouterDirectory::GetAddress(uint32_t nodeId, uint32_t ifIndex, uint32_t addressIndex) const
+{
+    return m_interfaces.at(nodeId).at(ifIndex).at(addressIndex);
+}
+
+int32_t
+RouterDirectory::GetInterfaceForPrefix(uint32_t nodeId, Ipv4Address address, Ipv4Mask mask) const
+{
+    auto i = m_interfaces.find(nodeId);
+    if (i == m_interfaces.end())
+    {
+        return -1;
+    }
+    const std::vector<std::vector<Ipv4InterfaceAddress>>& interfaces = i->second;
+    for (uint32_t j = 0; j < interfaces.size(); j++)
+    {
+        for (auto k = interfaces[j].begin(); k != interfaces[j].end(); k++)
+        {
+            if (k->GetLocal().CombineMask(mask) == address.CombineMask(mask))
+            {
+                return j;
+            }
+        }
+    }
+    return -1;
+}
+
+Ipv4Address
+RouterDirectory::GetLoopback(uint32_t nodeId) const
+{
+    auto i = m_loopbacks.find(nodeId);
+    if (i == m_loopbacks.end())
+    {
+        return Ipv4Address::GetAny();
+    }
+    return i->second;
+}
+
+} // namespace ns3
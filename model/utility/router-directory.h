@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROUTER_DIRECTORY_H
+#define ROUTER_DIRECTORY_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/node.h"
+#include "ns3/ptr.h"
+
+#include <limits>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Index of the routers and interface addresses of the simulation.
+ *
+ * The route computations keep looking up the node owning a router ID or an
+ * interface address.  The directory walks the NodeList once, when the LSDB
+ * is built, so that each of these lookups is a hash table access instead of
+ * a scan over every interface of every node.
+ *
+ * The lookups returning node IDs, interface indices and addresses only read
+ * the tables of the directory, never the ns-3 objects, so the worker threads
+ * of a parallel route computation may call them concurrently.
+ */
+class RouterDirectory
+{
+  public:
+    /// node ID returned for an unknown router ID or address
+    static constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+    RouterDirectory();
+
+    /**
+     * \brief Index all the nodes of the NodeList, replacing the current content.
+     */
+    void Build();
+
+    /**
+     * \brief Remove all the entries.
+     */
+    void Clear();
+
+    /**
+     * \param routerId the router ID
+     * \return the node exporting a RomamRouter with routerId, or 0 if none
+     */
+    Ptr<Node> GetNodeByRouterId(Ipv4Address routerId) const;
+
+    /**
+     * \param address a local interface address
+     * \return the node owning address, or 0 if none
+     */
+    Ptr<Node> GetNodeByAddress(Ipv4Address address) const;
+
+    /**
+     * \param address a local interface address
+     * \return the interface index of address on its node, or -1 if none
+     */
+    int32_t GetInterfaceForAddress(Ipv4Address address) const;
+
+    /**
+     * \param routerId the router ID
+     * \return the ID of the node exporting a RomamRouter with routerId, or NO_NODE
+     */
+    uint32_t GetNodeIdByRouterId(Ipv4Address routerId) const;
+
+    /**
+     * \param address a local interface address
+     * \return the ID of the node owning address, or NO_NODE
+     */
+    uint32_t GetNodeIdByAddress(Ipv4Address address) const;
+
+    /**
+     * \param nodeId the node ID
+     * \return the number of Ipv4 interfaces of the node, 0 if it is unknown
+     */
+    uint32_t GetNInterfaces(uint32_t nodeId) const;
+
+    /**
+     * \param nodeId the node ID
+     * \param ifIndex the interface index
+     * \return the number of addresses of the interface
+     */
+    uint32_t GetNAddresses(uint32_t nodeId, uint32_t ifIndex) const;
+
+    /**
+     * \param nodeId the node ID
+     * \param ifIndex the interface index
+     * \param addressIndex the index of the address on the interface
+     * \return the address, as Ipv4::GetAddress () returned it on Build ()
+     */
+    Ipv4InterfaceAddress GetAddress(uint32_t nodeId,
+                                    uint32_t ifIndex,
+                                    uint32_t addressIndex) const;
+
+    /**
+     * \brief Same as Ipv4::GetInterfaceForPrefix () on the node.
+     * \param nodeId the node ID
+     * \param address the address to match
+     * \param mask the mask of the prefix
+     * \return the first interface with an address in the prefix, or -1 if none
+     */
+    int32_t GetInterfaceForPrefix(uint32_t nodeId, Ipv4Address address, Ipv4Mask mask) const;
+
+    /**
+     * \param nodeId the node ID
+     * \return the address of RomamRouter::GetLoopbackAddress () on the node, or
+     * 0.0.0.0 if none
+     */
+    Ipv4Address GetLoopback(uint32_t nodeId) const;
+
+  private:
+    /// the owner of an interface address
+    struct InterfaceEntry
+    {
+        Ptr<Node> node;   //!< node owning the address
+        uint32_t ifIndex; //!< interface index on node
+    };
+
+    std::unordered_map<uint32_t, Ptr<Node>> m_routers;        //!< router ID -> node
+    std::unordered_map<uint32_t, InterfaceEntry> m_addresses; //!< address -> interface
+    /// node ID -> addresses of each interface
+    std::unordered_map<uint32_t, std::vector<std::vector<Ipv4InterfaceAddress>>> m_interfaces;
+    std::unordered_map<uint32_t, Ipv4Address> m_loopbacks; //!< node ID -> loopback address
+};
+
+} // namespace ns3
+
+#endif /* ROUTER_DIRECTORY_H */
@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "routing-stats.h"
+
+#include "ns3/assert.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+RoutingStats::RoutingStats()
+{
+    Reset();
+}
+
+void
+RoutingStats::AddSample(int64_t nanoseconds)
+{
+    Add(m_nSamples, 1);
+    Add(m_sampleSum, nanoseconds);
+    if (nanoseconds > m_sampleMax.load(std::memory_order_relaxed))
+    {
+        m_sampleMax.store(nanoseconds, std::memory_order_relaxed);
+    }
+}
+
+uint64_t
+RoutingStats::GetNSamples() const
+{
+    return m_nSamples.load(std::memory_order_relaxed);
+}
+
+double
+RoutingStats::GetMeanSample() const
+{
+    uint64_t nSamples = GetNSamples();
+    return nSamples == 0
+               ? 0
+               : static_cast<double>(m_sampleSum.load(std::memory_order_relaxed)) / nSamples;
+}
+
+int64_t
+RoutingStats::GetMaxSample() const
+{
+    return m_sampleMax.load(std::memory_order_relaxed);
+}
+
+void
+RoutingStats::Merge(const RoutingStats& stats)
+{
+    for (uint32_t i = 0; i < N_COUNTERS; i++)
+    {
+        Add(m_counters[i], stats.m_counters[i].load(std::memory_order_relaxed));
+    }
+    Add(m_nSamples, stats.GetNSamples());
+    Add(m_sampleSum, stats.m_sampleSum.load(std::memory_order_relaxed));
+    m_sampleMax.store(std::max(GetMaxSample(), stats.GetMaxSample()), std::memory_order_relaxed);
+}
+
+void
+RoutingStats::Reset()
+{
+    for (uint32_t i = 0; i < N_COUNTERS; i++)
+    {
+        m_counters[i].store(0, std::memory_order_relaxed);
+    }
+    m_nSamples.store(0, std::memory_order_relaxed);
+    m_sampleSum.store(0, std::memory_order_relaxed);
+    m_sampleMax.store(0, std::memory_order_relaxed);
+}
+
+const char*
+RoutingStats::GetCounterName(Counter counter)
+{
+    switch (counter)
+    {
+    case LOOKUPS:
+        return "lookups";
+    case CANDIDATES_SCANNED:
+        return "candidates_scanned";
+    case BUDGET_REJECTS:
+        return "budget_rejects";
+    case LOOP_REJECTS:
+        return "loop_rejects";
+    case ECMP_FALLBACKS:
+        return "ecmp_fallbacks";
+    case ADMISSION_REJECTS:
+        return "admission_rejects";
+    case AGENT_DECISIONS:
+        return "agent_decisions";
+    case POLICY_DECISIONS:
+        return "policy_decisions";
+    case POLICY_MISSES:
+        return "policy_misses";
+    case OUTPUT_CACHE_HITS:
+        return "output_cache_hits";
+    case LOOKUP_ALLOCATIONS:
+        return "lookup_allocations";
+    default:
+        NS_ASSERT_MSG(false, "Unknown counter " << counter);
+        return "";
+    }
+}
+
+void
+RoutingStats::Print(std::ostream& os) const
+{
+    for (uint32_t i = 0; i < N_COUNTERS; i++)
+    {
+        os << GetCounterName(static_cast<Counter>(i)) << '=' << Get(static_cast<Counter>(i))
+           << ' ';
+    }
+    os << "sampled_lookups=" << GetNSamples() << " mean_lookup_ns=" << GetMeanSample()
+       << " max_lookup_ns=" << GetMaxSample();
+}
+
+} // namespace ns3
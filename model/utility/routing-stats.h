@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ROUTING_STATS_H
+#define ROUTING_STATS_H
+
+#include "ns3/log.h"
+
+#include <atomic>
+#include <ostream>
+#include <stdint.h>
+
+/**
+ * \brief Logging of the per-packet route lookups.
+ *
+ * The NS_LOG calls of the lookups are evaluated for every candidate route
+ * even when the component is not enabled, so a build configured with
+ * ROMAM_HOT_PATH_LOGGING off defines ROMAM_NO_HOT_PATH_LOGGING and compiles
+ * them out entirely.
+ */
+#ifdef ROMAM_NO_HOT_PATH_LOGGING
+#define ROMAM_HOT_LOG_FUNCTION(parameters)
+#define ROMAM_HOT_LOG_LOGIC(msg)
+#else
+#define ROMAM_HOT_LOG_FUNCTION(parameters) NS_LOG_FUNCTION(parameters)
+#define ROMAM_HOT_LOG_LOGIC(msg) NS_LOG_LOGIC(msg)
+#endif
+
+namespace ns3
+{
+
+/**
+ * \brief Counters of the route lookups of a node, and the wall-clock time of
+ * the lookups sampled.
+ *
+ * Only the simulation thread counts, so a counter is bumped with a relaxed
+ * load and store rather than a locked read-modify-write, which keeps the
+ * cost of a count to a plain increment while another thread may still read
+ * the counters.
+ */
+class RoutingStats
+{
+  public:
+    /// what is counted
+    enum Counter
+    {
+        LOOKUPS,            //!< route lookups of packets
+        CANDIDATES_SCANNED, //!< candidate routes examined by the lookups
+        BUDGET_REJECTS,     //!< candidates that could not meet the budget of a packet
+        LOOP_REJECTS,       //!< candidates going back or farther than the previous hop
+        ECMP_FALLBACKS,     //!< budgeted lookups that fell back to the shortest routes
+        ADMISSION_REJECTS,  //!< budgeted packets the source dropped or downgraded
+        AGENT_DECISIONS,    //!< budgeted lookups that took the decision of an AgentChannel
+        POLICY_DECISIONS,   //!< budgeted lookups that took the decision of a PolicyTable
+        POLICY_MISSES,      //!< POLICY lookups left to DDR, with no usable decision
+        OUTPUT_CACHE_HITS,  //!< output lookups answered by the output route cache
+        LOOKUP_ALLOCATIONS, //!< heap allocations of the lookups, counted in builds with asserts
+        N_COUNTERS          //!< number of counters
+    };
+
+    RoutingStats();
+
+    /**
+     * \brief Count events.
+     * \param counter the counter
+     * \param n the number of events
+     */
+    void Count(Counter counter, uint64_t n = 1);
+
+    /**
+     * \param counter the counter
+     * \return the events counted
+     */
+    uint64_t Get(Counter counter) const;
+
+    /**
+     * \brief Record the wall-clock time of a sampled lookup.
+     * \param nanoseconds the time of the lookup
+     */
+    void AddSample(int64_t nanoseconds);
+
+    /**
+     * \return the number of lookups sampled
+     */
+    uint64_t GetNSamples() const;
+
+    /**
+     * \return the mean wall-clock time of the lookups sampled, in nanoseconds,
+     * or 0 if none was
+     */
+    double GetMeanSample() const;
+
+    /**
+     * \return the longest wall-clock time of the lookups sampled, in
+     * nanoseconds
+     */
+    int64_t GetMaxSample() const;
+
+    /**
+     * \brief Add the counters and samples of other stats to these ones.
+     * \param stats the other stats
+     */
+    void Merge(const RoutingStats& stats);
+
+    /**
+     * \brief Set all the counters and samples to 0.
+     */
+    void Reset();
+
+    /**
+     * \param counter the counter
+     * \return the name of the counter
+     */
+    static const char* GetCounterName(Counter counter);
+
+    /**
+     * \brief Print the counters and samples on one line, as name=value pairs.
+     * \param os the output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    /**
+     * \brief Add to a counter only the simulation thread writes.
+     * \param value the counter
+     * \param n the value to add
+     */
+    static void Add(std::atomic<uint64_t>& value, uint64_t n);
+
+    std::atomic<uint64_t> m_counters[N_COUNTERS]; //!< the counters
+    std::atomic<uint64_t> m_nSamples;             //!< lookups sampled
+    std::atomic<uint64_t> m_sampleSum;            //!< sum of the sampled times, in ns
+    std::atomic<int64_t> m_sampleMax;             //!< longest sampled time, in ns
+};
+
+inline void
+RoutingStats::Add(std::atomic<uint64_t>& value, uint64_t n)
+{
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void
+RoutingStats::Count(Counter counter, uint64_t n)
+{
+    Add(m_counters[counter], n);
+}
+
+inline uint64_t
+RoutingStats::Get(Counter counter) const
+{
+    return m_counters[counter].load(std::memory_order_relaxed);
+}
+
+} // namespace ns3
+
+#endif /* ROUTING_STATS_H */
@@ -0,0 +1,79 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "split-table.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SplitTable");
+
+SplitTable::SplitTable()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+SplitTable::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    m_buckets.clear();
+}
+
+uint32_t
+SplitTable::Add(const std::vector<double>& weights)
+{
+    NS_LOG_FUNCTION(this << weights.size());
+    NS_ASSERT_MSG(!weights.empty() && weights.size() <= N_BUCKETS,
+                  "SplitTable: " << weights.size() << " routes to split among");
+    uint32_t table = GetNTables();
+    double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    uint32_t n = weights.size();
+    // the whole buckets of every route, then the remainders by decreasing size
+    std::vector<uint32_t> counts(n);
+    std::vector<double> remainders(n);
+    uint32_t assigned = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        NS_ASSERT_MSG(weights[i] >= 0, "SplitTable: negative weight");
+        double share = total > 0 ? weights[i] / total * N_BUCKETS : double(N_BUCKETS) / n;
+        counts[i] = std::min(static_cast<uint32_t>(share), N_BUCKETS - assigned);
+        remainders[i] = share - counts[i];
+        assigned += counts[i];
+    }
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&remainders](uint32_t a, uint32_t b) {
+        return remainders[a] > remainders[b];
+    });
+    for (uint32_t k = 0; assigned < N_BUCKETS; k = (k + 1) % n)
+    {
+        counts[order[k]]++;
+        assigned++;
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        m_buckets.insert(m_buckets.end(), counts[i], static_cast<uint8_t>(i));
+    }
+    NS_ASSERT(m_buckets.size() == static_cast<std::size_t>(table + 1) * N_BUCKETS);
+    return table;
+}
+
+uint32_t
+SplitTable::GetNTables() const
+{
+    return m_buckets.size() / N_BUCKETS;
+}
+
+std::size_t
+SplitTable::GetMemoryUsage() const
+{
+    return m_buckets.capacity() * sizeof(uint8_t);
+}
+
+} // namespace ns3
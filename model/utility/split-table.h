@@ -0,0 +1,79 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SPLIT_TABLE_H
+#define SPLIT_TABLE_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Tables that split the packets towards a destination among its
+ * routes, in the ratios of their weights.
+ *
+ * A table is N_BUCKETS buckets, each naming one of the routes, so many of
+ * them as the share of the route in the weights, the remainders of the
+ * division going to the largest ones.  A packet picks the route of the
+ * bucket of a hash, a random draw or the hash of its flow, which takes one
+ * read whatever the number of routes.  The tables of all the destinations
+ * follow each other in one array.
+ */
+class SplitTable
+{
+  public:
+    /// the number of buckets of a table, and the bound of the routes it splits among
+    static constexpr uint32_t N_BUCKETS = 256;
+
+    SplitTable();
+
+    /**
+     * \brief Remove all the tables.
+     */
+    void Clear();
+
+    /**
+     * \brief Add the table of a destination.
+     *
+     * The routes split evenly if no weight is positive.
+     *
+     * \param weights the weights of the routes, none negative, at most N_BUCKETS of them
+     * \return the index of the table, the number of tables before it
+     */
+    uint32_t Add(const std::vector<double>& weights);
+
+    /**
+     * \param table the index of a table
+     * \param hash the hash of the packet, of which all the bits count
+     * \return the index of the route the packet takes
+     */
+    uint32_t Pick(uint32_t table, uint32_t hash) const;
+
+    /**
+     * \return the number of tables
+     */
+    uint32_t GetNTables() const;
+
+    /**
+     * \return the number of bytes of the tables
+     */
+    std::size_t GetMemoryUsage() const;
+
+  private:
+    std::vector<uint8_t> m_buckets; //!< the tables, N_BUCKETS route indices each
+};
+
+inline uint32_t
+SplitTable::Pick(uint32_t table, uint32_t hash) const
+{
+    // fold the hash, so that its high bits pick the bucket as well
+    hash ^= hash >> 16;
+    hash ^= hash >> 8;
+    return m_buckets[static_cast<std::size_t>(table) * N_BUCKETS + (hash & (N_BUCKETS - 1))];
+}
+
+} // namespace ns3
+
+#endif /* SPLIT_TABLE_H */
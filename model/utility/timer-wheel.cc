@@ -0,0 +1,314 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "timer-wheel.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TimerWheel");
+
+NS_OBJECT_ENSURE_REGISTERED(TimerWheel);
+
+TypeId
+TimerWheel::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::TimerWheel")
+                            .SetParent<Object>()
+                            .SetGroupName("Romam")
+                            .AddConstructor<TimerWheel>()
+                            .AddAttribute("Resolution",
+                                          "The duration of a tick of the wheel, the granularity "
+                                          "of its timers",
+                                          TimeValue(MilliSeconds(1)),
+                                          MakeTimeAccessor(&TimerWheel::m_resolution),
+                                          MakeTimeChecker(NanoSeconds(1)));
+    return tid;
+}
+
+TimerWheel::TimerWheel()
+    : m_tick(0),
+      m_nPending(0),
+      m_eventTick(UINT64_MAX)
+{
+    NS_LOG_FUNCTION(this);
+    std::fill(m_heads, m_heads + N_LISTS, NONE);
+    std::fill(m_occupied, m_occupied + N_LEVELS, 0);
+}
+
+TimerWheel::~TimerWheel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+Ptr<TimerWheel>
+TimerWheel::GetWheel(Ptr<Node> node)
+{
+    Ptr<TimerWheel> wheel = node->GetObject<TimerWheel>();
+    if (!wheel)
+    {
+        wheel = CreateObject<TimerWheel>();
+        node->AggregateObject(wheel);
+    }
+    return wheel;
+}
+
+TimerWheel::TimerId
+TimerWheel::Schedule(const Time& delay, const Callback<void>& callback)
+{
+    NS_LOG_FUNCTION(this << delay);
+    NS_ASSERT_MSG(!delay.IsStrictlyNegative(), "TimerWheel::Schedule (): negative delay");
+    int64_t resolution = m_resolution.GetTimeStep();
+    uint64_t now = Simulator::Now().GetTimeStep();
+    if (m_nPending == 0)
+    {
+        // an empty wheel has no slot to keep consistent
+        m_tick = now / resolution;
+    }
+    uint32_t index;
+    if (!m_free.empty())
+    {
+        index = m_free.back();
+        m_free.pop_back();
+    }
+    else
+    {
+        index = m_entries.size();
+        m_entries.emplace_back();
+        m_entries[index].generation = 1;
+    }
+    Entry& entry = m_entries[index];
+    uint64_t expiry = now + delay.GetTimeStep();
+    entry.expiry = std::max((expiry + resolution - 1) / resolution, m_tick + 1);
+    entry.callback = callback;
+    Place(index);
+    m_nPending++;
+    ScheduleEvent();
+    return (uint64_t(entry.generation) << 32) | index;
+}
+
+bool
+TimerWheel::Cancel(TimerId id)
+{
+    uint32_t index = Find(id);
+    if (index == NONE)
+    {
+        return false;
+    }
+    NS_LOG_FUNCTION(this << id);
+    Unlink(index);
+    Entry& entry = m_entries[index];
+    entry.callback = Callback<void>();
+    entry.generation = entry.generation == UINT32_MAX ? 1 : entry.generation + 1;
+    m_free.push_back(index);
+    m_nPending--;
+    // the event may fire on a tick with nothing due, which only reschedules it
+    return true;
+}
+
+bool
+TimerWheel::IsPending(TimerId id) const
+{
+    return Find(id) != NONE;
+}
+
+Time
+TimerWheel::GetDelayLeft(TimerId id) const
+{
+    uint32_t index = Find(id);
+    NS_ASSERT_MSG(index != NONE, "TimerWheel::GetDelayLeft (): the timer is not pending");
+    Time expiry = TimeStep(m_entries[index].expiry * m_resolution.GetTimeStep());
+    return std::max(expiry - Simulator::Now(), Seconds(0));
+}
+
+uint32_t
+TimerWheel::GetNPending() const
+{
+    return m_nPending;
+}
+
+std::size_t
+TimerWheel::GetMemoryUsage() const
+{
+    return m_entries.capacity() * sizeof(Entry) + m_free.capacity() * sizeof(uint32_t);
+}
+
+void
+TimerWheel::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_event.Cancel();
+    m_eventTick = UINT64_MAX;
+    m_entries.clear();
+    m_free.clear();
+    std::fill(m_heads, m_heads + N_LISTS, NONE);
+    std::fill(m_occupied, m_occupied + N_LEVELS, 0);
+    m_nPending = 0;
+    Object::DoDispose();
+}
+
+uint32_t
+TimerWheel::Find(TimerId id) const
+{
+    uint32_t index = id & 0xffffffff;
+    if (index >= m_entries.size() || m_entries[index].generation != (id >> 32) ||
+        m_entries[index].list == NONE)
+    {
+        return NONE;
+    }
+    return index;
+}
+
+void
+TimerWheel::Place(uint32_t index)
+{
+    uint64_t expiry = m_entries[index].expiry;
+    if (expiry <= m_tick)
+    {
+        Link(index, DUE_LIST);
+        return;
+    }
+    // the level is the highest slot where the expiry and the current tick
+    // differ, so the slot of the timer comes after the current one
+    uint64_t diff = expiry ^ m_tick;
+    for (uint32_t level = 0; level < N_LEVELS; level++)
+    {
+        if ((diff >> (SLOT_BITS * (level + 1))) == 0)
+        {
+            uint32_t slot = (expiry >> (SLOT_BITS * level)) & (N_SLOTS - 1);
+            Link(index, level * N_SLOTS + slot);
+            return;
+        }
+    }
+    Link(index, OVERFLOW_LIST);
+}
+
+void
+TimerWheel::Link(uint32_t index, uint32_t list)
+{
+    Entry& entry = m_entries[index];
+    entry.list = list;
+    entry.prev = NONE;
+    entry.next = m_heads[list];
+    if (entry.next != NONE)
+    {
+        m_entries[entry.next].prev = index;
+    }
+    m_heads[list] = index;
+    if (list < OVERFLOW_LIST)
+    {
+        m_occupied[list / N_SLOTS] |= uint64_t(1) << (list % N_SLOTS);
+    }
+}
+
+void
+TimerWheel::Unlink(uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    if (entry.prev != NONE)
+    {
+        m_entries[entry.prev].next = entry.next;
+    }
+    else
+    {
+        m_heads[entry.list] = entry.next;
+    }
+    if (entry.next != NONE)
+    {
+        m_entries[entry.next].prev = entry.prev;
+    }
+    if (entry.list < OVERFLOW_LIST && m_heads[entry.list] == NONE)
+    {
+        m_occupied[entry.list / N_SLOTS] &= ~(uint64_t(1) << (entry.list % N_SLOTS));
+    }
+    entry.list = NONE;
+}
+
+void
+TimerWheel::Cascade(uint32_t list)
+{
+    uint32_t index = m_heads[list];
+    while (index != NONE)
+    {
+        uint32_t next = m_entries[index].next;
+        Unlink(index);
+        Place(index);
+        index = next;
+    }
+}
+
+uint64_t
+TimerWheel::GetNextTick() const
+{
+    uint64_t next = UINT64_MAX;
+    for (uint32_t level = 0; level < N_LEVELS; level++)
+    {
+        uint32_t shift = SLOT_BITS * level;
+        uint32_t current = (m_tick >> shift) & (N_SLOTS - 1);
+        // by Place (), the occupied slots of a level all come after the current one
+        uint64_t later =
+            current == N_SLOTS - 1 ? 0 : m_occupied[level] & (~uint64_t(0) << (current + 1));
+        if (later != 0)
+        {
+            uint64_t base = (m_tick >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+            next = std::min(next, base | (uint64_t(__builtin_ctzll(later)) << shift));
+        }
+    }
+    if (m_heads[OVERFLOW_LIST] != NONE)
+    {
+        next = std::min(next, ((m_tick >> SPAN_BITS) + 1) << SPAN_BITS);
+    }
+    return next;
+}
+
+void
+TimerWheel::ScheduleEvent()
+{
+    uint64_t next = GetNextTick();
+    if (next >= m_eventTick)
+    {
+        return;
+    }
+    m_event.Cancel();
+    m_eventTick = next;
+    Time at = TimeStep(next * m_resolution.GetTimeStep());
+    m_event = Simulator::Schedule(at - Simulator::Now(), &TimerWheel::Expire, this);
+}
+
+void
+TimerWheel::Expire()
+{
+    NS_LOG_FUNCTION(this << m_eventTick);
+    m_tick = m_eventTick;
+    m_eventTick = UINT64_MAX;
+    if ((m_tick & ((uint64_t(1) << SPAN_BITS) - 1)) == 0)
+    {
+        Cascade(OVERFLOW_LIST);
+    }
+    // the upper levels first, so their timers reach the slots of this tick
+    for (uint32_t level = N_LEVELS; level-- > 0;)
+    {
+        uint32_t shift = SLOT_BITS * level;
+        if ((m_tick & ((uint64_t(1) << shift) - 1)) == 0)
+        {
+            Cascade(level * N_SLOTS + ((m_tick >> shift) & (N_SLOTS - 1)));
+        }
+    }
+    // a timer may start or stop others, the due ones included
+    while (m_heads[DUE_LIST] != NONE)
+    {
+        uint32_t index = m_heads[DUE_LIST];
+        Callback<void> callback = m_entries[index].callback;
+        Cancel((uint64_t(m_entries[index].generation) << 32) | index);
+        callback();
+    }
+    ScheduleEvent();
+}
+
+} // namespace ns3
@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+class Node;
+
+/**
+ * \brief Hierarchical timing wheel multiplexing the protocol timers of a node
+ * onto one simulator event.
+ *
+ * Every neighbor of a distributed protocol has its Hello, dead, retransmit or
+ * update timers, and each of them used to be an entry of the event heap of
+ * the simulator, which grows with the adjacencies of the network.  The wheel
+ * of a node instead keeps its timers in N_LEVELS levels of N_SLOTS slots,
+ * whose slots of level L span N_SLOTS^L ticks of Resolution, and schedules a
+ * single simulator event on the next tick a slot is due.  A due slot of an
+ * upper level cascades its timers to the lower levels, and a due slot of
+ * level 0 fires them.  The timers beyond the span of the top level wait in
+ * an overflow list, cascaded when the top level wraps.
+ *
+ * A timer is an entry of a pool, linked in the list of its slot, so Schedule
+ * () and Cancel () are O(1): neither touches the simulator, unless Schedule
+ * () makes the wheel due earlier.  A bitmap of the occupied slots of every
+ * level finds the next due slot without walking the empty ones.
+ *
+ * A timer fires on the first tick at or after its expiry, so up to one
+ * Resolution late, and the timers of the same tick fire in no defined
+ * order.  Resolution is to be set before the first timer.
+ *
+ * GetWheel () returns the wheel aggregated to a node, which all the routing
+ * protocols of the node share.
+ */
+class TimerWheel : public Object
+{
+  public:
+    /// the name of a timer, 0 for none; a name is never reused
+    typedef uint64_t TimerId;
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    TimerWheel();
+    ~TimerWheel() override;
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * \param node a node
+     * \return the wheel of the node, aggregated to it on the first call
+     */
+    static Ptr<TimerWheel> GetWheel(Ptr<Node> node);
+
+    /**
+     * \brief Start a timer.
+     * \param delay the time until the timer expires
+     * \param callback what to run when it expires
+     * \return the name of the timer
+     */
+    TimerId Schedule(const Time& delay, const Callback<void>& callback);
+
+    /**
+     * \brief Stop a timer, if it is pending.
+     * \param id the name of the timer, or 0
+     * \return true if the timer was pending
+     */
+    bool Cancel(TimerId id);
+
+    /**
+     * \param id the name of a timer, or 0
+     * \return true if the timer is pending
+     */
+    bool IsPending(TimerId id) const;
+
+    /**
+     * \param id the name of a pending timer
+     * \return the time until the tick it fires on
+     */
+    Time GetDelayLeft(TimerId id) const;
+
+    /**
+     * \return the number of pending timers
+     */
+    uint32_t GetNPending() const;
+
+    /**
+     * \return the number of bytes of the pool of the timers
+     */
+    std::size_t GetMemoryUsage() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    static const uint32_t SLOT_BITS = 6;                      //!< log2 of the slots of a level
+    static const uint32_t N_SLOTS = 1u << SLOT_BITS;          //!< slots of a level
+    static const uint32_t N_LEVELS = 4;                       //!< levels of the wheel
+    static const uint32_t SPAN_BITS = SLOT_BITS * N_LEVELS;   //!< log2 of the ticks of the wheel
+    static const uint32_t OVERFLOW_LIST = N_SLOTS * N_LEVELS; //!< the list beyond the top level
+    static const uint32_t DUE_LIST = OVERFLOW_LIST + 1;       //!< the list of the timers to fire
+    static const uint32_t N_LISTS = DUE_LIST + 1;             //!< lists of the wheel
+    static const uint32_t NONE = 0xffffffff;                  //!< no entry, or no list
+
+    /// a timer, linked in the list of its slot
+    struct Entry
+    {
+        uint64_t expiry;         //!< the tick the timer fires on
+        Callback<void> callback; //!< what to run then
+        uint32_t prev;           //!< the previous entry of the list, or NONE
+        uint32_t next;           //!< the next entry of the list, or NONE
+        uint32_t list;           //!< the list of the entry, NONE if it is free
+        uint32_t generation;     //!< the generation of the name of the entry, never 0
+    };
+
+    /**
+     * \param id the name of a timer
+     * \return its entry if it is pending, else NONE
+     */
+    uint32_t Find(TimerId id) const;
+
+    /**
+     * \brief Link an entry in the list of its expiry, relative to m_tick.
+     * \param index the entry, linked in no list
+     */
+    void Place(uint32_t index);
+
+    /**
+     * \brief Link an entry at the head of a list.
+     * \param index the entry, linked in no list
+     * \param list the list
+     */
+    void Link(uint32_t index, uint32_t list);
+
+    /**
+     * \brief Unlink an entry from its list.
+     * \param index the entry, linked in a list
+     */
+    void Unlink(uint32_t index);
+
+    /**
+     * \brief Place again the entries of a list, relative to m_tick.
+     * \param list the list
+     */
+    void Cascade(uint32_t list);
+
+    /**
+     * \return the next tick a list of the wheel is due on, or UINT64_MAX if
+     * no timer is pending
+     */
+    uint64_t GetNextTick() const;
+
+    /**
+     * \brief Schedule the event of the wheel on its next due tick, if it is
+     * earlier than the scheduled one.
+     */
+    void ScheduleEvent();
+
+    /**
+     * \brief Advance the wheel to the tick of its event, and fire the timers
+     * due on it.
+     */
+    void Expire();
+
+    Time m_resolution;             //!< the duration of a tick
+    uint64_t m_tick;               //!< the last tick the wheel advanced to
+    std::vector<Entry> m_entries;  //!< the pool of the timers
+    std::vector<uint32_t> m_free;  //!< the free entries of the pool
+    uint32_t m_heads[N_LISTS];     //!< the first entry of a list, or NONE
+    uint64_t m_occupied[N_LEVELS]; //!< the slots of a level whose list is not empty
+    uint32_t m_nPending;           //!< the pending timers
+    EventId m_event;               //!< the next Expire ()
+    uint64_t m_eventTick;          //!< the tick of m_event, UINT64_MAX if it is not running
+};
+
+} // namespace ns3
+
+#endif /* TIMER_WHEEL_H */
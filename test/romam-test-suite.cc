@@ -1,9 +1,28 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 
-// Include a header file from your module to test.
-#include "ns3/romam.h"
-
-// An essential include is test.h
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/romam-module.h"
 #include "ns3/test.h"
+#include "ns3/traffic-control-module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
 
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
@@ -17,6 +36,3421 @@ using namespace ns3;
  * \ingroup tests
  */
 
+/// the output interfaces of the host routes of the routers, by node and destination
+typedef std::map<std::pair<uint32_t, Ipv4Address>, std::set<uint32_t>> RouteInterfaces;
+
+/// a route decision: the output interface and the gateway, or -1 without route
+typedef std::pair<int32_t, Ipv4Address> RouteDecision;
+
+/**
+ * \param name the name of a topology file of the topo directory
+ * \return the path of the file
+ */
+static std::string
+GetTopologyPath(const std::string& name)
+{
+    return std::string(NS_TEST_SOURCEDIR) + "/../topo/" + name;
+}
+
+/**
+ * \brief The factor the thresholds of the performance guards are scaled by:
+ * the ROMAM_PERF_SCALE environment variable, 1 by default, to be raised on
+ * slow or instrumented builds.
+ * \return the factor
+ */
+static double
+GetPerformanceScale()
+{
+    const char* scale = std::getenv("ROMAM_PERF_SCALE");
+    return scale ? std::atof(scale) : 1.0;
+}
+
+/**
+ * \brief Build the network of a topology file, as the NSDI2025 experiments do.
+ * \param topo the name of the topology file
+ * \param routing the routing protocol of the routers
+ * \param queueDiscs whether to install the DDRQueueDisc on the devices
+ * \param listRouting whether to install the protocol in an Ipv4ListRouting,
+ * rather than alone
+ * \return the routers
+ */
+static NodeContainer
+BuildNetwork(const std::string& topo,
+             const Ipv4RoutingHelper& routing,
+             bool queueDiscs,
+             bool listRouting = true)
+{
+    RomamTopologyHelper topology;
+    bool read = topology.Read(GetTopologyPath(topo));
+    NS_ABORT_MSG_IF(!read, "Cannot read the topology " << topo);
+    NodeContainer nodes = topology.CreateNodes();
+    Ipv4ListRoutingHelper list;
+    list.Add(routing, 10);
+    InternetStackHelper internet;
+    if (listRouting)
+    {
+        internet.SetRoutingHelper(list);
+    }
+    else
+    {
+        internet.SetRoutingHelper(routing);
+    }
+    internet.Install(nodes);
+    topology.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+    if (queueDiscs)
+    {
+        TrafficControlHelper tch;
+        tch.SetRootQueueDisc("ns3::DDRQueueDisc");
+        topology.SetTrafficControl(tch);
+    }
+    topology.Install(nodes);
+    return nodes;
+}
+
+/**
+ * \param node a router
+ * \return the routing protocol of the router
+ */
+static Ptr<RomamRouting>
+GetRouting(Ptr<Node> node)
+{
+    return node->GetObject<RomamRouter>()->GetRoutingProtocol();
+}
+
+/**
+ * \ingroup romam-tests
+ * \brief The global values a test binds, restored when it leaves the scope,
+ * then the simulator destroyed: a failed assertion returns from DoRun, so
+ * only a guard leaves the next tests the default values and no nodes.
+ */
+class RomamTestScope
+{
+  public:
+    RomamTestScope() = default;
+    ~RomamTestScope();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    RomamTestScope(const RomamTestScope&) = delete;
+    RomamTestScope& operator=(const RomamTestScope&) = delete;
+
+    /**
+     * \brief Bind a global value until the end of the scope.
+     * \param name the name of the global value
+     * \param value the value for the scope
+     */
+    void Bind(const std::string& name, const AttributeValue& value);
+
+  private:
+    /// the names of the values bound and their former values, in binding order
+    std::vector<std::pair<std::string, std::string>> m_saved;
+};
+
+RomamTestScope::~RomamTestScope()
+{
+    for (auto i = m_saved.rbegin(); i != m_saved.rend(); i++)
+    {
+        GlobalValue::Bind(i->first, StringValue(i->second));
+    }
+    Simulator::Destroy();
+}
+
+void
+RomamTestScope::Bind(const std::string& name, const AttributeValue& value)
+{
+    StringValue saved;
+    GlobalValue::GetValueByName(name, saved);
+    m_saved.emplace_back(name, saved.Get());
+    GlobalValue::Bind(name, value);
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the SPF engine gives, among the routes of every destination,
+ * the same shortest ones as the Dijkstra engine on the bundled topologies.
+ */
+class RomamSpfDijkstraTestCase : public TestCase
+{
+  public:
+    /**
+     * \param topo the name of the topology file
+     */
+    RomamSpfDijkstraTestCase(const std::string& topo);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \return the interfaces of the Dijkstra routes of OSPFRouting
+     */
+    RouteInterfaces GetDijkstraRoutes();
+
+    /**
+     * \return the interfaces of the shortest SPF routes of DDRRouting
+     */
+    RouteInterfaces GetSpfRoutes();
+
+    std::string m_topo; //!< name of the topology file
+};
+
+RomamSpfDijkstraTestCase::RomamSpfDijkstraTestCase(const std::string& topo)
+    : TestCase("Same shortest routes from SPF and Dijkstra on " + topo),
+      m_topo(topo)
+{
+}
+
+RouteInterfaces
+RomamSpfDijkstraTestCase::GetDijkstraRoutes()
+{
+    NodeContainer nodes = BuildNetwork(m_topo, OSPFHelper(), false);
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    RouteManager::InitializeDijkstraRoutes();
+    RouteInterfaces routes;
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        Ptr<OSPFRouting> ospf = DynamicCast<OSPFRouting>(GetRouting(nodes.Get(n)));
+        NS_ABORT_MSG_IF(!ospf, "Node " << n << " runs no OSPFRouting");
+        for (uint32_t i = 0; i < ospf->GetNRoutes(); i++)
+        {
+            DijkstraRIE* route = ospf->GetRoute(i);
+            if (route->IsHost())
+            {
+                routes[std::make_pair(n, route->GetDest())].insert(route->GetInterface());
+            }
+        }
+    }
+    Simulator::Destroy();
+    return routes;
+}
+
+RouteInterfaces
+RomamSpfDijkstraTestCase::GetSpfRoutes()
+{
+    NodeContainer nodes = BuildNetwork(m_topo, DDRHelper(), true);
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    RouteManager::InitializeSPFRoutes();
+    RouteInterfaces routes;
+    std::map<std::pair<uint32_t, Ipv4Address>, uint32_t> distances;
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        Ptr<DDRRouting> ddr = DynamicCast<DDRRouting>(GetRouting(nodes.Get(n)));
+        NS_ABORT_MSG_IF(!ddr, "Node " << n << " runs no DDRRouting");
+        for (uint32_t i = 0; i < ddr->GetNRoutes(); i++)
+        {
+            ShortestPathForestRIE* route = ddr->GetRoute(i);
+            if (!route->IsHost())
+            {
+                continue;
+            }
+            // the forest has a route through every neighbor, keep the shortest
+            std::pair<uint32_t, Ipv4Address> key(n, route->GetDest());
+            auto found = distances.find(key);
+            if (found == distances.end() || route->GetDistance() < found->second)
+            {
+                distances[key] = route->GetDistance();
+                routes[key].clear();
+            }
+            if (distances[key] == route->GetDistance())
+            {
+                routes[key].insert(route->GetInterface());
+            }
+        }
+    }
+    Simulator::Destroy();
+    return routes;
+}
+
+void
+RomamSpfDijkstraTestCase::DoRun()
+{
+    RouteInterfaces dijkstra = GetDijkstraRoutes();
+    RouteInterfaces spf = GetSpfRoutes();
+    NS_TEST_ASSERT_MSG_GT(dijkstra.size(), 0, "No Dijkstra route on " << m_topo);
+    NS_TEST_ASSERT_MSG_EQ(spf.size(),
+                          dijkstra.size(),
+                          "SPF and Dijkstra route different destinations on " << m_topo);
+    for (const auto& entry : dijkstra)
+    {
+        auto found = spf.find(entry.first);
+        NS_TEST_ASSERT_MSG_EQ((found != spf.end()),
+                              true,
+                              "No SPF route of node " << entry.first.first << " to "
+                                                      << entry.first.second);
+        NS_TEST_ASSERT_MSG_EQ((found->second == entry.second),
+                              true,
+                              "Other shortest interfaces of node " << entry.first.first
+                                                                   << " to "
+                                                                   << entry.first.second);
+    }
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the budgeted lookups of DDRRouting take the same decisions on
+ * a first lookup, on a lookup served by the route caches and indices, and
+ * after the routes are recomputed, with the random streams reset in between.
+ */
+class RomamDdrDecisionTestCase : public TestCase
+{
+  public:
+    /**
+     * \param topo the name of the topology file
+     * \param mode the RouteSelectMode of DDRRouting
+     * \param tables the DgrDecisionTables of DDRRouting
+     */
+    RomamDdrDecisionTestCase(const std::string& topo, const std::string& mode, bool tables = false);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Look up a route from every router to every other one, for each
+     * budget.
+     * \param nodes the routers
+     * \return the decisions, in the order of the lookups
+     */
+    std::vector<RouteDecision> Decide(NodeContainer nodes);
+
+    /**
+     * \brief Take the decisions three times and compare them.
+     * \param nodes the routers
+     */
+    void CheckDecisions(NodeContainer nodes);
+
+    std::string m_topo; //!< name of the topology file
+    std::string m_mode; //!< route select mode
+    bool m_tables;      //!< whether the DGR lookups read decision tables
+};
+
+RomamDdrDecisionTestCase::RomamDdrDecisionTestCase(const std::string& topo,
+                                                   const std::string& mode,
+                                                   bool tables)
+    : TestCase("Same " + mode + " decisions from the caches and indices on " + topo +
+               (tables ? ", with decision tables" : "")),
+      m_topo(topo),
+      m_mode(mode),
+      m_tables(tables)
+{
+}
+
+std::vector<RouteDecision>
+RomamDdrDecisionTestCase::Decide(NodeContainer nodes)
+{
+    static const uint32_t budgets[] = {1000, 5000, 20000, 100000};
+    std::vector<RouteDecision> decisions;
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        DynamicCast<DDRRouting>(GetRouting(nodes.Get(n)))->AssignStreams(n);
+    }
+    Ipv4Header header;
+    header.SetProtocol(17);
+    Socket::SocketErrno sockerr;
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        Ptr<RomamRouting> routing = GetRouting(nodes.Get(n));
+        Ptr<Ipv4> ipv4 = nodes.Get(n)->GetObject<Ipv4>();
+        for (uint32_t d = 0; d < nodes.GetN(); d++)
+        {
+            if (d == n)
+            {
+                continue;
+            }
+            header.SetDestination(nodes.Get(d)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal());
+            for (uint32_t budget : budgets)
+            {
+                Ptr<Packet> packet = Create<Packet>(512);
+                RomamMetaTag metaTag;
+                metaTag.SetTimestamp(Simulator::Now());
+                metaTag.SetBudget(budget);
+                metaTag.SetFlag(true);
+                packet->AddPacketTag(metaTag);
+                Ptr<Ipv4Route> route = routing->RouteOutput(packet, header, nullptr, sockerr);
+                if (route)
+                {
+                    int32_t iface = ipv4->GetInterfaceForDevice(route->GetOutputDevice());
+                    decisions.emplace_back(iface, route->GetGateway());
+                }
+                else
+                {
+                    decisions.emplace_back(-1, Ipv4Address());
+                }
+            }
+        }
+    }
+    return decisions;
+}
+
+void
+RomamDdrDecisionTestCase::CheckDecisions(NodeContainer nodes)
+{
+    std::vector<RouteDecision> first = Decide(nodes);
+    std::vector<RouteDecision> cached = Decide(nodes);
+    RouteManager::RecomputeSPFRoutes();
+    std::vector<RouteDecision> recomputed = Decide(nodes);
+    NS_TEST_ASSERT_MSG_GT(first.size(), 0, "No lookup on " << m_topo);
+    uint32_t found = 0;
+    for (std::size_t i = 0; i < first.size(); i++)
+    {
+        found += first[i].first != -1 ? 1 : 0;
+        NS_TEST_ASSERT_MSG_EQ((cached[i] == first[i]),
+                              true,
+                              "Lookup " << i << " changed once the routes are cached");
+        NS_TEST_ASSERT_MSG_EQ((recomputed[i] == first[i]),
+                              true,
+                              "Lookup " << i << " changed once the routes are recomputed");
+    }
+    NS_TEST_ASSERT_MSG_GT(found, 0, "No lookup found a route on " << m_topo);
+}
+
+void
+RomamDdrDecisionTestCase::DoRun()
+{
+    NodeContainer nodes = BuildNetwork(m_topo, DDRHelper(), true);
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        GetRouting(nodes.Get(n))->SetAttribute("RouteSelectMode", StringValue(m_mode));
+        GetRouting(nodes.Get(n))->SetAttribute("DgrDecisionTables", BooleanValue(m_tables));
+    }
+    DDRHelper::PopulateRoutingTables();
+    // the routers are started and have exchanged their first states
+    Time decisionTime = MilliSeconds(100);
+    Simulator::Schedule(decisionTime, &RomamDdrDecisionTestCase::CheckDecisions, this, nodes);
+    Simulator::Stop(decisionTime);
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that a random start phase and a jitter of the unsolicited updates
+ * lower the control burst of the nodes started together.
+ */
+class RomamControlBurstTestCase : public TestCase
+{
+  public:
+    RomamControlBurstTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Run the DDR nodes of abilene for 100 ms.
+     * \param jitter whether to jitter their unsolicited updates
+     * \return the peak control burst
+     */
+    uint32_t RunUpdates(bool jitter);
+};
+
+RomamControlBurstTestCase::RomamControlBurstTestCase()
+    : TestCase("Unsolicited updates desynchronized by their phase and jitter, on abilene")
+{
+}
+
+uint32_t
+RomamControlBurstTestCase::RunUpdates(bool jitter)
+{
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", DDRHelper(), true);
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        GetRouting(nodes.Get(n))->SetAttribute("RandomStartPhase", BooleanValue(jitter));
+        GetRouting(nodes.Get(n))->SetAttribute("UpdateJitter", DoubleValue(jitter ? 0.25 : 0));
+    }
+    DDRRouting::ResetControlBurst();
+    DDRHelper::PopulateRoutingTables();
+    Simulator::Stop(MilliSeconds(100));
+    Simulator::Run();
+    uint32_t peak = DDRRouting::GetControlBurstPeak();
+    Simulator::Destroy();
+    return peak;
+}
+
+void
+RomamControlBurstTestCase::DoRun()
+{
+    uint32_t lockstep = RunUpdates(false);
+    uint32_t jittered = RunUpdates(true);
+    NS_TEST_ASSERT_MSG_EQ(lockstep, 11, "The nodes did not all update together");
+    NS_TEST_ASSERT_MSG_LT(jittered, lockstep, "The jitter left the updates together");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the ECMP lookups of DDRRouting leave an interface that went down
+ * for a loop-free alternate, before the routes are recomputed.
+ */
+class RomamFastRerouteTestCase : public TestCase
+{
+  public:
+    RomamFastRerouteTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Take down the interface of the route from the first router to
+     * every other one in turn, and look the route up again.
+     * \param nodes the routers
+     */
+    void CheckReroutes(NodeContainer nodes);
+};
+
+RomamFastRerouteTestCase::RomamFastRerouteTestCase()
+    : TestCase("Loop-free alternates of the routes of an interface down, on abilene")
+{
+}
+
+void
+RomamFastRerouteTestCase::CheckReroutes(NodeContainer nodes)
+{
+    Ptr<RomamRouting> routing = GetRouting(nodes.Get(0));
+    Ptr<Ipv4> ipv4 = nodes.Get(0)->GetObject<Ipv4>();
+    Ipv4Header header;
+    Socket::SocketErrno sockerr;
+    uint32_t rerouted = 0;
+    for (uint32_t d = 1; d < nodes.GetN(); d++)
+    {
+        header.SetDestination(nodes.Get(d)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal());
+        Ptr<Ipv4Route> route = routing->RouteOutput(nullptr, header, nullptr, sockerr);
+        NS_TEST_ASSERT_MSG_EQ((route != nullptr), true, "No route to node " << d);
+        int32_t iface = ipv4->GetInterfaceForDevice(route->GetOutputDevice());
+        ipv4->SetDown(iface);
+        Ptr<Ipv4Route> backup = routing->RouteOutput(nullptr, header, nullptr, sockerr);
+        ipv4->SetUp(iface);
+        if (backup)
+        {
+            NS_TEST_ASSERT_MSG_NE(ipv4->GetInterfaceForDevice(backup->GetOutputDevice()),
+                                  iface,
+                                  "The route to node " << d << " stays on its interface down");
+            rerouted++;
+        }
+    }
+    NS_TEST_ASSERT_MSG_GT(rerouted, 0, "No route has a loop-free alternate");
+}
+
+void
+RomamFastRerouteTestCase::DoRun()
+{
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", DDRHelper(), true);
+    GetRouting(nodes.Get(0))->SetAttribute("FastReroute", BooleanValue(true));
+    DDRHelper::PopulateRoutingTables();
+    Time checkTime = MilliSeconds(10);
+    Simulator::Schedule(checkTime, &RomamFastRerouteTestCase::CheckReroutes, this, nodes);
+    Simulator::Stop(checkTime);
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the routes are free of loops and black holes, and stay so once
+ * a node fails and is repaired, each batch costing one recompute.
+ */
+class RomamRouteConsistencyTestCase : public TestCase
+{
+  public:
+    RomamRouteConsistencyTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RomamRouteConsistencyTestCase::RomamRouteConsistencyTestCase()
+    : TestCase("Consistent routes through a node failure and repair, on abilene")
+{
+}
+
+void
+RomamRouteConsistencyTestCase::DoRun()
+{
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", DDRHelper(), true);
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        GetRouting(nodes.Get(n))->SetAttribute("RespondToInterfaceEvents", BooleanValue(true));
+    }
+    DDRHelper::PopulateRoutingTables();
+    RouteConsistency::Report report = RouteConsistency::Check();
+    NS_TEST_ASSERT_MSG_EQ(report.destinations, nodes.GetN(), "Not every node is checked");
+    NS_TEST_ASSERT_MSG_EQ(report.loops, 0, "Loops in the initial routes");
+    NS_TEST_ASSERT_MSG_EQ(report.blackHoles, 0, "Black holes in the initial routes");
+
+    RouteConvergenceTracker tracker;
+    tracker.SetCheckConsistency(true);
+    tracker.Install();
+    FailureScenarioHelper failures;
+    failures.SetConvergenceTracker(&tracker);
+    failures.AddNodeFailure(MilliSeconds(10), MilliSeconds(10), 0);
+    failures.Install(nodes);
+    Simulator::Stop(MilliSeconds(30));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(failures.GetBatches().size(), 2, "Not one batch per failure and repair");
+    NS_TEST_ASSERT_MSG_EQ(failures.GetRecomputes(), 2, "Not one recompute per batch");
+    const std::vector<RouteConvergenceTracker::Convergence>& events = tracker.GetEvents();
+    NS_TEST_ASSERT_MSG_EQ(events.size(), 2, "Not an event per batch");
+    for (const RouteConvergenceTracker::Convergence& event : events)
+    {
+        NS_TEST_ASSERT_MSG_GT(event.changes, 0, "No table change after " << event.label);
+        NS_TEST_ASSERT_MSG_GT(event.checks, 0, "No check after " << event.label);
+        NS_TEST_ASSERT_MSG_EQ(event.loopChecks, 0, "Loops after " << event.label);
+        NS_TEST_ASSERT_MSG_EQ(event.blackHoleChecks, 0, "Black holes after " << event.label);
+    }
+    Simulator::Destroy();
+}
+
+/**
+ * \param nodes the routers
+ * \return the routing tables of the routers, as printed
+ */
+static std::string
+PrintTables(NodeContainer nodes)
+{
+    std::ostringstream os;
+    Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper>(&os);
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        GetRouting(nodes.Get(n))->PrintRoutingTable(stream);
+    }
+    return os.str();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the Dijkstra and SPF engines sharing their shortest path trees
+ * install the tables they install alone, whichever computes the trees.
+ */
+class RomamSharedRouteTreesTestCase : public TestCase
+{
+  public:
+    RomamSharedRouteTreesTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RomamSharedRouteTreesTestCase::RomamSharedRouteTreesTestCase()
+    : TestCase("Same tables from the trees shared by Dijkstra and SPF, on abilene")
+{
+}
+
+void
+RomamSharedRouteTreesTestCase::DoRun()
+{
+    {
+        RomamTestScope scope;
+        NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", OSPFHelper(), false);
+        RouteManager::DeleteRoutes();
+        RouteManager::BuildLSDB();
+        RouteManager::InitializeDijkstraRoutes();
+        std::string alone = PrintTables(nodes);
+        scope.Bind("RomamSharedRouteTrees", BooleanValue(true));
+        // the first run searches the trees, the second one replays them
+        RouteManager::InitializeDijkstraRoutes();
+        NS_TEST_ASSERT_MSG_EQ(PrintTables(nodes), alone, "Other tables searching the trees");
+        RouteManager::InitializeDijkstraRoutes();
+        NS_TEST_ASSERT_MSG_EQ(PrintTables(nodes), alone, "Other tables from the shared trees");
+    }
+
+    RomamTestScope scope;
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", DDRHelper(), true);
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    RouteManager::InitializeSPFRoutes();
+    std::string alone = PrintTables(nodes);
+    scope.Bind("RomamSharedRouteTrees", BooleanValue(true));
+    // the forests replay the trees of the Dijkstra routes
+    RouteManager::InitializeDijkstraRoutes();
+    RouteManager::InitializeSPFRoutes();
+    NS_TEST_ASSERT_MSG_EQ(PrintTables(nodes), alone, "Other forests from the Dijkstra trees");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the routes computed in areas, the others reached through the
+ * summaries of their border routers, still reach every node without loops.
+ */
+class RomamAreasTestCase : public TestCase
+{
+  public:
+    RomamAreasTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RomamAreasTestCase::RomamAreasTestCase()
+    : TestCase("Consistent routes in three areas, on abilene")
+{
+}
+
+void
+RomamAreasTestCase::DoRun()
+{
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", OSPFHelper(), false);
+    // the backbone is the core of the topology, 2, 3, 6 and 9 its border routers
+    const uint32_t areas[] = {1, 1, 1, 1, 0, 0, 2, 0, 0, 2, 2};
+    NS_TEST_ASSERT_MSG_EQ(nodes.GetN(), 11, "Not the abilene topology");
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        nodes.Get(n)->GetObject<RomamRouter>()->SetAttribute("AreaId", UintegerValue(areas[n]));
+    }
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    RouteManager::InitializeDijkstraRoutes();
+    GlobalLSDBManager* manager = SimulationSingleton<GlobalLSDBManager>::Get();
+    NS_TEST_ASSERT_MSG_EQ(manager->GetAreaDirectory()->IsEnabled(), true, "No areas");
+    RouteConsistency::Report report = RouteConsistency::Check();
+    NS_TEST_ASSERT_MSG_EQ(report.destinations, nodes.GetN(), "Not every node is checked");
+    NS_TEST_ASSERT_MSG_EQ(report.loops, 0, "Loops in the routes of the areas");
+    NS_TEST_ASSERT_MSG_EQ(report.blackHoles, 0, "Black holes in the routes of the areas");
+    NS_TEST_ASSERT_MSG_EQ(report.unreachable, 0, "Nodes unreachable through the summaries");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the lazy routes of a node are the ones computed for all the
+ * nodes at once, and that only the tables of the nodes that looked a route up
+ * last are kept.
+ */
+class RomamLazyRoutesTestCase : public TestCase
+{
+  public:
+    RomamLazyRoutesTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+/// number of nodes keeping their lazy routes
+static const uint32_t LAZY_ROUTE_TABLES = 3;
+
+RomamLazyRoutesTestCase::RomamLazyRoutesTestCase()
+    : TestCase("Same lazy routes, bounded to the tables used last, on abilene")
+{
+}
+
+void
+RomamLazyRoutesTestCase::DoRun()
+{
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", OSPFHelper(), false);
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    RouteManager::InitializeDijkstraRoutes();
+    std::vector<uint32_t> eager;
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        eager.push_back(GetRouting(nodes.Get(n))->GetNRoutes());
+    }
+
+    RomamTestScope scope;
+    scope.Bind("RomamLazyRoutes", BooleanValue(true));
+    scope.Bind("RomamLazyRouteTables", UintegerValue(LAZY_ROUTE_TABLES));
+    RouteManager::RecomputeDijkstraRoutes();
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(GetRouting(nodes.Get(n))->GetNRoutes(),
+                              0,
+                              "Node " << n << " has routes before its first lookup");
+    }
+    Ipv4Header header;
+    Socket::SocketErrno sockerr;
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        Ptr<Node> dest = nodes.Get((n + 1) % nodes.GetN());
+        header.SetDestination(dest->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal());
+        Ptr<RomamRouting> routing = GetRouting(nodes.Get(n));
+        Ptr<Ipv4Route> route = routing->RouteOutput(nullptr, header, nullptr, sockerr);
+        NS_TEST_ASSERT_MSG_EQ((route != nullptr), true, "No lazy route from node " << n);
+        NS_TEST_ASSERT_MSG_EQ(routing->GetNRoutes(),
+                              eager[n],
+                              "Other lazy routes on node " << n);
+    }
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        bool kept = n + LAZY_ROUTE_TABLES >= nodes.GetN();
+        NS_TEST_ASSERT_MSG_EQ((GetRouting(nodes.Get(n))->GetNRoutes() > 0),
+                              kept,
+                              "Node " << n << (kept ? " lost" : " kept") << " its lazy routes");
+    }
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the host routes kept in the NextHopColumns make the tables and
+ * the decisions of the routes kept as entries, in less memory.
+ */
+class RomamColumnRoutesTestCase : public TestCase
+{
+  public:
+    RomamColumnRoutesTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Compute the Dijkstra routes of the OSPF routers of abilene.
+     * \param columns whether the host routes are kept in the NextHopColumns
+     * \param tables set to the tables, as RouteManager::ExportRoutingTables () writes them
+     * \param decisions set to the output interface from every router to every other one
+     * \return the memory the routing state of the nodes takes, the columns included
+     */
+    std::size_t ComputeRoutes(bool columns,
+                              std::string& tables,
+                              std::vector<int32_t>& decisions) const;
+};
+
+RomamColumnRoutesTestCase::RomamColumnRoutesTestCase()
+    : TestCase("Same OSPF routes from the next-hop columns, on abilene")
+{
+}
+
+std::size_t
+RomamColumnRoutesTestCase::ComputeRoutes(bool columns,
+                                         std::string& tables,
+                                         std::vector<int32_t>& decisions) const
+{
+    GlobalValue::Bind("RomamColumnHostRoutes", BooleanValue(columns));
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", OSPFHelper(), false);
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    RouteManager::InitializeDijkstraRoutes();
+    std::ostringstream os;
+    RouteManager::ExportRoutingTables(os);
+    tables = os.str();
+    Ipv4Header header;
+    Socket::SocketErrno sockerr;
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        for (uint32_t d = 0; d < nodes.GetN(); d++)
+        {
+            header.SetDestination(nodes.Get(d)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal());
+            Ptr<Ipv4Route> route =
+                GetRouting(nodes.Get(n))->RouteOutput(nullptr, header, nullptr, sockerr);
+            decisions.push_back(route ? route->GetOutputDevice()->GetIfIndex() : -1);
+        }
+    }
+    std::size_t bytes = RouteManager::GetRoutingMemoryFootprint();
+    if (columns)
+    {
+        bytes += NextHopColumns::Get()->GetMemoryUsage();
+    }
+    Simulator::Destroy();
+    GlobalValue::Bind("RomamColumnHostRoutes", BooleanValue(false));
+    return bytes;
+}
+
+void
+RomamColumnRoutesTestCase::DoRun()
+{
+    std::string entryTables;
+    std::vector<int32_t> entryDecisions;
+    std::size_t entryBytes = ComputeRoutes(false, entryTables, entryDecisions);
+    std::string columnTables;
+    std::vector<int32_t> columnDecisions;
+    std::size_t columnBytes = ComputeRoutes(true, columnTables, columnDecisions);
+    NS_TEST_ASSERT_MSG_EQ(columnTables, entryTables, "Other tables from the columns");
+    NS_TEST_ASSERT_MSG_EQ((columnDecisions == entryDecisions),
+                          true,
+                          "Other decisions from the columns");
+    NS_TEST_ASSERT_MSG_LT(columnBytes, entryBytes, "The columns take more memory");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the split tables share their buckets in the ratios of the
+ * weights, and that a hash picks every bucket.
+ */
+class RomamSplitTableTestCase : public TestCase
+{
+  public:
+    RomamSplitTableTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RomamSplitTableTestCase::RomamSplitTableTestCase()
+    : TestCase("Split tables in the ratios of the weights")
+{
+}
+
+void
+RomamSplitTableTestCase::DoRun()
+{
+    SplitTable splits;
+    std::vector<std::vector<double>> weights = {{3, 1}, {0, 0, 0}, {1, 1, 1}, {5, 0, 2, 1}};
+    // the buckets of each route, the remainders to the largest ones
+    std::vector<std::vector<uint32_t>> expected = {{192, 64},
+                                                   {86, 85, 85},
+                                                   {86, 85, 85},
+                                                   {160, 0, 64, 32}};
+    for (uint32_t t = 0; t < weights.size(); t++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(splits.Add(weights[t]), t, "Tables out of order");
+    }
+    NS_TEST_ASSERT_MSG_EQ(splits.GetNTables(), weights.size(), "Tables missing");
+    for (uint32_t t = 0; t < weights.size(); t++)
+    {
+        std::vector<uint32_t> counts(weights[t].size(), 0);
+        for (uint32_t bucket = 0; bucket < SplitTable::N_BUCKETS; bucket++)
+        {
+            uint32_t route = splits.Pick(t, bucket);
+            NS_TEST_ASSERT_MSG_LT(route, counts.size(), "Route out of table " << t);
+            counts[route]++;
+        }
+        NS_TEST_ASSERT_MSG_EQ((counts == expected[t]), true, "Other shares in table " << t);
+    }
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that a route trie returns the routes of every matching prefix in the
+ * order they were inserted, and frees the nodes of the prefixes removed.
+ */
+class RomamRouteTrieTestCase : public TestCase
+{
+  public:
+    RomamRouteTrieTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \param trie the trie
+     * \param dest a destination
+     * \param firstOnly look the first route up only
+     * \param skipped a route the lookup skips, or -1
+     * \return the routes found, by value
+     */
+    static std::vector<int> Lookup(const RouteTrie<int>& trie,
+                                   const char* dest,
+                                   bool firstOnly = false,
+                                   int skipped = -1);
+};
+
+RomamRouteTrieTestCase::RomamRouteTrieTestCase()
+    : TestCase("Routes of all the matching prefixes in insertion order from the trie")
+{
+}
+
+std::vector<int>
+RomamRouteTrieTestCase::Lookup(const RouteTrie<int>& trie,
+                               const char* dest,
+                               bool firstOnly,
+                               int skipped)
+{
+    std::vector<int*> routes;
+    trie.Lookup(
+        Ipv4Address(dest),
+        [skipped](int* route) { return *route != skipped; },
+        routes,
+        firstOnly);
+    std::vector<int> values;
+    for (int* route : routes)
+    {
+        values.push_back(*route);
+    }
+    return values;
+}
+
+void
+RomamRouteTrieTestCase::DoRun()
+{
+    std::vector<int> routes = {0, 1, 2, 3, 4, 5};
+    std::vector<std::pair<const char*, const char*>> prefixes = {{"10.0.0.0", "255.0.0.0"},
+                                                                 {"10.1.0.0", "255.255.0.0"},
+                                                                 {"10.1.2.0", "255.255.255.0"},
+                                                                 {"10.0.0.0", "255.0.0.0"},
+                                                                 {"0.0.0.0", "0.0.0.0"},
+                                                                 {"11.0.0.0", "255.0.0.0"}};
+    RouteTrie<int> trie;
+    for (uint32_t i = 0; i < routes.size(); i++)
+    {
+        trie.Insert(Ipv4Address(prefixes[i].first), Ipv4Mask(prefixes[i].second), &routes[i]);
+    }
+    NS_TEST_ASSERT_MSG_EQ(trie.GetN(), routes.size(), "Routes missing");
+    // the root, the five prefixes but a repeated one, the branch of 10/8 and 11/8
+    NS_TEST_ASSERT_MSG_EQ(trie.GetNNodes(), 6, "The trie is not path-compressed");
+
+    NS_TEST_ASSERT_MSG_EQ((Lookup(trie, "10.1.2.3") == std::vector<int>{0, 1, 2, 3, 4}),
+                          true,
+                          "Not every matching prefix, in insertion order");
+    NS_TEST_ASSERT_MSG_EQ((Lookup(trie, "10.2.0.1") == std::vector<int>{0, 3, 4}),
+                          true,
+                          "Other routes for 10.2.0.1");
+    NS_TEST_ASSERT_MSG_EQ((Lookup(trie, "12.0.0.1") == std::vector<int>{4}),
+                          true,
+                          "Other routes for 12.0.0.1");
+    NS_TEST_ASSERT_MSG_EQ((Lookup(trie, "10.1.2.3", true) == std::vector<int>{0}),
+                          true,
+                          "Not the route inserted first");
+    NS_TEST_ASSERT_MSG_EQ((Lookup(trie, "10.1.2.3", true, 0) == std::vector<int>{1}),
+                          true,
+                          "Not the first route the filter accepts");
+
+    NS_TEST_ASSERT_MSG_EQ(
+        trie.Remove(Ipv4Address(prefixes[2].first), Ipv4Mask(prefixes[2].second), &routes[1]),
+        false,
+        "Route removed from another prefix");
+    for (uint32_t i : {2, 1, 5})
+    {
+        NS_TEST_ASSERT_MSG_EQ(
+            trie.Remove(Ipv4Address(prefixes[i].first), Ipv4Mask(prefixes[i].second), &routes[i]),
+            true,
+            "Route " << i << " not removed");
+    }
+    NS_TEST_ASSERT_MSG_EQ((Lookup(trie, "10.1.2.3") == std::vector<int>{0, 3, 4}),
+                          true,
+                          "Removed routes still looked up");
+    // the branch went with 11/8, which left it a single child
+    NS_TEST_ASSERT_MSG_EQ(trie.GetNNodes(), 2, "Nodes of the removed prefixes kept");
+    for (uint32_t i : {0, 3, 4})
+    {
+        trie.Remove(Ipv4Address(prefixes[i].first), Ipv4Mask(prefixes[i].second), &routes[i]);
+    }
+    NS_TEST_ASSERT_MSG_EQ(trie.GetN(), 0, "Routes left");
+    NS_TEST_ASSERT_MSG_EQ(trie.GetNNodes(), 1, "Nodes left but the root");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that an arm set suspends a dominated arm, never selects it while
+ * suspended, and retries it once its suspension is over.
+ */
+class RomamArmPruningTestCase : public TestCase
+{
+  public:
+    RomamArmPruningTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RomamArmPruningTestCase::RomamArmPruningTestCase()
+    : TestCase("Dominated arms suspended and retried")
+{
+}
+
+void
+RomamArmPruningTestCase::DoRun()
+{
+    std::vector<ArmedSpfRIE> routes;
+    for (uint32_t iface = 1; iface <= 3; iface++)
+    {
+        routes.push_back(ArmedSpfRIE::CreateHostRouteTo(Ipv4Address("10.0.0.1"), iface));
+    }
+    ArmSet arms;
+    arms.SetPruning(0.5, 10, 100);
+    for (ArmedSpfRIE& route : routes)
+    {
+        arms.AddArm(&route);
+    }
+    for (uint32_t round = 0; round < 50; round++)
+    {
+        arms.PullArms();
+        arms.UpdateArm(0, 1.0);
+        arms.UpdateArm(1, 1.0);
+        if (!arms.IsSuspended(2))
+        {
+            arms.UpdateArm(2, 10.0);
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(arms.IsSuspended(2), true, "Dominated arm still active");
+    NS_TEST_ASSERT_MSG_EQ(arms.IsSuspended(0) || arms.IsSuspended(1), false, "Best arm suspended");
+    NS_TEST_ASSERT_MSG_EQ(arms.GetNActive(), 2, "Other arms suspended");
+    NS_TEST_ASSERT_MSG_EQ(arms.GetProbability(2), 0.0, "Suspended arm weighed");
+    for (uint32_t draw = 0; draw < 100; draw++)
+    {
+        NS_TEST_ASSERT_MSG_NE(arms.Sample(draw / 100.0), 2, "Suspended arm selected");
+    }
+    for (uint32_t round = 0; round < 100; round++)
+    {
+        arms.PullArms();
+    }
+    NS_TEST_ASSERT_MSG_EQ(arms.IsSuspended(2), false, "Suspended arm not retried");
+    NS_TEST_ASSERT_MSG_GT(arms.GetProbability(2), 0.0, "Retried arm not weighed");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that a fluid background load queues at the rate above the link,
+ * overflows its limit, waits while the link sends a real packet, drains, and
+ * holds a real packet until the load ahead of it is sent.
+ */
+class RomamFluidLoadTestCase : public TestCase
+{
+  public:
+    RomamFluidLoadTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Check the backlog now.
+     * \param backlog the bytes expected
+     * \param dropped the bytes dropped expected
+     */
+    void CheckBacklog(double backlog, double dropped);
+
+    /**
+     * \brief Put a real packet behind the load, and check when it may leave.
+     * \param ready the time expected
+     */
+    void CheckArrival(Time ready);
+
+    /**
+     * \brief Send a real packet, which keeps the link from the load.
+     * \param size the bytes of the packet
+     */
+    void Serve(uint32_t size);
+
+    FluidLoad m_load; //!< the load
+};
+
+RomamFluidLoadTestCase::RomamFluidLoadTestCase()
+    : TestCase("Fluid background load queued, dropped and drained")
+{
+}
+
+void
+RomamFluidLoadTestCase::CheckBacklog(double backlog, double dropped)
+{
+    NS_TEST_ASSERT_MSG_EQ_TOL(double(m_load.GetBacklog()), backlog, 1, "Wrong backlog");
+    NS_TEST_ASSERT_MSG_EQ_TOL(double(m_load.GetDroppedBytes()), dropped, 1, "Wrong bytes dropped");
+}
+
+void
+RomamFluidLoadTestCase::CheckArrival(Time ready)
+{
+    m_load.Arrive();
+    NS_TEST_ASSERT_MSG_EQ(m_load.GetReadyTime(), ready, "Packet not held behind the load");
+    m_load.Depart();
+    NS_TEST_ASSERT_MSG_EQ(m_load.GetReadyTime(), Simulator::Now(), "Departed packet still held");
+}
+
+void
+RomamFluidLoadTestCase::Serve(uint32_t size)
+{
+    m_load.Serve(size);
+}
+
+void
+RomamFluidLoadTestCase::DoRun()
+{
+    // 1000 bytes a millisecond over the link until 2 ms, then none
+    m_load.SetLinkRate(DataRate("8Mbps"));
+    m_load.SetLimit(1500);
+    m_load.AddRate(Seconds(0), DataRate("16Mbps"));
+    m_load.AddRate(MilliSeconds(2), DataRate(0));
+    NS_TEST_ASSERT_MSG_EQ(m_load.IsEnabled(), true, "Load off");
+    // the backlog, and the bytes dropped once it reached the limit
+    const double checks[][3] = {{1000, 1000, 0},
+                                {2000, 1500, 500},
+                                {2500, 1000, 500},
+                                {3500, 1000, 500},
+                                {4500, 0, 500}};
+    for (const auto& check : checks)
+    {
+        Simulator::Schedule(MicroSeconds(check[0]),
+                            &RomamFluidLoadTestCase::CheckBacklog,
+                            this,
+                            check[1],
+                            check[2]);
+    }
+    Simulator::Schedule(MilliSeconds(1),
+                        &RomamFluidLoadTestCase::CheckArrival,
+                        this,
+                        MilliSeconds(2));
+    // the link sends a packet from 2.5 to 3.5 ms, so the backlog holds
+    Simulator::Schedule(MicroSeconds(2500), &RomamFluidLoadTestCase::Serve, this, 1000);
+    Simulator::Stop(MilliSeconds(5));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(m_load.IsIdle(), true, "Drained load not idle");
+    NS_TEST_ASSERT_MSG_EQ(m_load.GetNextStep(), Time::Max(), "Steps left");
+    NS_TEST_ASSERT_MSG_EQ_TOL(double(m_load.GetOfferedBytes()), 4000.0, 1, "Wrong bytes offered");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check the layout and the slots of an AgentChannel from the side of the
+ * agent, and that a router reads back the decisions of the agent.
+ */
+class RomamAgentChannelTestCase : public TestCase
+{
+  public:
+    RomamAgentChannelTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RomamAgentChannelTestCase::RomamAgentChannelTestCase()
+    : TestCase("DDR state exported to an agent and its decisions read back, on abilene")
+{
+}
+
+void
+RomamAgentChannelTestCase::DoRun()
+{
+    BuildNetwork("Inet_abilene_topo.txt", DDRHelper(), true);
+    DDRHelper::PopulateRoutingTables();
+    std::string path = CreateTempDirFilename("romam-agent");
+    AgentChannel channel;
+    channel.SetInterval(MilliSeconds(10));
+    NS_TEST_ASSERT_MSG_EQ(channel.Install(path), 11, "Routers not attached");
+    Simulator::Stop(MilliSeconds(25));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(channel.GetNPublished(), 3, "Slots not written every interval");
+
+    // map the file as the agent does
+    int fd = open(path.c_str(), O_RDWR);
+    NS_TEST_ASSERT_MSG_NE(fd, -1, "File not created");
+    void* map = mmap(nullptr, channel.GetSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    NS_TEST_ASSERT_MSG_NE(map, MAP_FAILED, "File not mapped");
+    char* bytes = static_cast<char*>(map);
+    auto header = reinterpret_cast<AgentChannel::Header*>(bytes);
+    NS_TEST_ASSERT_MSG_EQ(std::string(header->magic, 8), "ROMAMAGT", "Wrong magic");
+    NS_TEST_ASSERT_MSG_EQ(header->nodes, 11, "Wrong rows");
+    NS_TEST_ASSERT_MSG_EQ(header->destinations, 11, "Wrong destinations");
+    uint64_t n = header->published.load() - 1;
+    auto slot = reinterpret_cast<AgentChannel::SlotHeader*>(
+        bytes + header->slotOffset + (n % header->slots) * header->slotBytes);
+    NS_TEST_ASSERT_MSG_EQ(slot->sequence.load(), 2 * n + 2, "Last slot not complete");
+    NS_TEST_ASSERT_MSG_EQ(slot->time, MilliSeconds(20).GetNanoSeconds(), "Wrong slot time");
+
+    // the first candidate interface of the first router to the second destination
+    uint32_t nIfaces = header->interfaces;
+    const float* routes =
+        reinterpret_cast<const float*>(slot + 1) + nIfaces * AgentChannel::IFACE_FEATURES;
+    const float* dest = routes + nIfaces * AgentChannel::ROUTE_FEATURES;
+    uint32_t iface = 0;
+    for (uint32_t i = 1; i < nIfaces && iface == 0; i++)
+    {
+        iface = dest[i * AgentChannel::ROUTE_FEATURES] >= 0 ? i : 0;
+    }
+    NS_TEST_ASSERT_MSG_NE(iface, 0, "No candidate exported");
+    auto ids = reinterpret_cast<const uint32_t*>(bytes + header->directoryOffset);
+    Ipv4Address address(ids[header->nodes + 1]);
+    NS_TEST_ASSERT_MSG_EQ(channel.GetDecision(0, address), 0, "Decision before the agent");
+    auto decisions = reinterpret_cast<int32_t*>(bytes + header->decisionOffset);
+    decisions[1] = iface;
+    NS_TEST_ASSERT_MSG_EQ(channel.GetDecision(0, address), iface, "Decision not read back");
+    NS_TEST_ASSERT_MSG_EQ(channel.GetDecision(0, Ipv4Address("192.0.2.1")),
+                          0,
+                          "Decision for no destination");
+    munmap(map, channel.GetSize());
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the POLICY route select mode takes the next hops of its
+ * PolicyTable, and the DDR ones for the keys without a decision.
+ */
+class RomamPolicyTableTestCase : public TestCase
+{
+  public:
+    RomamPolicyTableTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Compile a policy sending the packets of the first router to the
+     * second one on its longest route, and look the routes up.
+     * \param nodes the routers
+     */
+    void CheckDecisions(NodeContainer nodes);
+
+    /**
+     * \param nodes the routers
+     * \param n the router looking up
+     * \param d the destination router
+     * \return the output interface of a budgeted packet, -1 for none
+     */
+    int32_t Lookup(NodeContainer nodes, uint32_t n, uint32_t d);
+
+    std::string m_path; //!< the file of the policy
+};
+
+RomamPolicyTableTestCase::RomamPolicyTableTestCase()
+    : TestCase("POLICY next hops from a compiled table, DDR ones for its missing keys")
+{
+}
+
+int32_t
+RomamPolicyTableTestCase::Lookup(NodeContainer nodes, uint32_t n, uint32_t d)
+{
+    Ipv4Header header;
+    header.SetProtocol(17);
+    header.SetDestination(nodes.Get(d)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal());
+    Ptr<Packet> packet = Create<Packet>(512);
+    RomamMetaTag metaTag;
+    metaTag.SetTimestamp(Simulator::Now());
+    metaTag.SetBudget(20000);
+    metaTag.SetFlag(true);
+    packet->AddPacketTag(metaTag);
+    Socket::SocketErrno sockerr;
+    Ptr<Ipv4Route> route = GetRouting(nodes.Get(n))->RouteOutput(packet, header, nullptr, sockerr);
+    return route ? nodes.Get(n)->GetObject<Ipv4>()->GetInterfaceForDevice(route->GetOutputDevice())
+                 : -1;
+}
+
+void
+RomamPolicyTableTestCase::CheckDecisions(NodeContainer nodes)
+{
+    Ipv4Address dest = nodes.Get(1)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+    Ptr<DDRRouting> ddr = DynamicCast<DDRRouting>(GetRouting(nodes.Get(0)));
+    uint32_t longest = 0;
+    uint32_t iface = 0;
+    for (uint32_t i = 0; i < ddr->GetNRoutes(); i++)
+    {
+        ShortestPathForestRIE* route = ddr->GetRoute(i);
+        if (route->IsHost() && route->GetDest() == dest && route->GetDistance() >= longest)
+        {
+            longest = route->GetDistance();
+            iface = route->GetInterface();
+        }
+    }
+    NS_TEST_ASSERT_MSG_NE(iface, 0, "No route to the second router");
+
+    // the same interface whatever the states and the budget
+    PolicyTable policy(nodes.GetN(), 2, 2, 2, MilliSeconds(10));
+    for (uint32_t state = 0; state < 8; state++)
+    {
+        for (uint32_t bucket = 0; bucket < 2; bucket++)
+        {
+            policy.SetDecision(0, 1, state, bucket, iface);
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(policy.Save(m_path), true, "Policy not saved");
+    NS_TEST_ASSERT_MSG_EQ(Lookup(nodes, 0, 1), int32_t(iface), "Policy decision not taken");
+    NS_TEST_ASSERT_MSG_EQ(ddr->GetRoutingStats().Get(RoutingStats::POLICY_DECISIONS),
+                          1,
+                          "Policy decision not counted");
+    // no decision of the first router to the third one, nor of the second one
+    NS_TEST_ASSERT_MSG_NE(Lookup(nodes, 0, 2), -1, "No DDR route for a missing key");
+    NS_TEST_ASSERT_MSG_NE(Lookup(nodes, 1, 0), -1, "No DDR route for a missing router");
+    NS_TEST_ASSERT_MSG_EQ(ddr->GetRoutingStats().Get(RoutingStats::POLICY_MISSES),
+                          1,
+                          "Missing key not counted");
+}
+
+void
+RomamPolicyTableTestCase::DoRun()
+{
+    m_path = CreateTempDirFilename("romam-policy.bin");
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", DDRHelper(), true);
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        GetRouting(nodes.Get(n))->SetAttribute("RouteSelectMode", StringValue("POLICY"));
+        GetRouting(nodes.Get(n))->SetAttribute("PolicyTable", StringValue(m_path));
+    }
+    DDRHelper::PopulateRoutingTables();
+    Simulator::Schedule(MilliSeconds(100), &RomamPolicyTableTestCase::CheckDecisions, this, nodes);
+    Simulator::Stop(MilliSeconds(100));
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that a received LSU identifies its LSA instances without decoding
+ * them, and decodes the same LSAs as were sent.
+ */
+class RomamLsuDecodingTestCase : public TestCase
+{
+  public:
+    RomamLsuDecodingTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RomamLsuDecodingTestCase::RomamLsuDecodingTestCase()
+    : TestCase("LSU instances identified before their lazy decoding")
+{
+}
+
+void
+RomamLsuDecodingTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    LsuEntry sent;
+    sent.lsa = Create<LSA>();
+    sent.lsa->SetLSType(LSA::RouterLSA);
+    sent.lsa->SetLinkStateId(Ipv4Address("10.0.0.1"));
+    sent.lsa->SetAdvertisingRouter(Ipv4Address("10.0.0.1"));
+    sent.lsa->SetNode(node);
+    sent.lsa->AddLinkRecord(new LinkRecord(LinkRecord::PointToPoint,
+                                           Ipv4Address("10.0.0.2"),
+                                           Ipv4Address("10.1.1.1"),
+                                           3));
+    sent.lsa->AddLinkRecord(new LinkRecord(LinkRecord::StubNetwork,
+                                           Ipv4Address("10.1.1.0"),
+                                           Ipv4Address("255.255.255.0"),
+                                           1));
+    sent.seq = 7;
+    sent.withdrawn = false;
+    LsuEntry withdrawn = sent;
+    withdrawn.seq = 8;
+    withdrawn.withdrawn = true;
+    LsuHeader hdr;
+    hdr.AddLsa(sent);
+    hdr.AddLsa(withdrawn);
+    Ptr<Packet> packet = Create<Packet>();
+    packet->AddHeader(hdr);
+
+    LsuHeader received;
+    NS_TEST_ASSERT_MSG_EQ(packet->RemoveHeader(received), hdr.GetSerializedSize(), "Bad size");
+    NS_TEST_ASSERT_MSG_EQ(received.GetNEntries(), 2, "Instances lost");
+    const std::vector<LsuSummary>& summaries = received.GetLsaSummaries();
+    NS_TEST_ASSERT_MSG_EQ(summaries[0].advertisingRouter, Ipv4Address("10.0.0.1"), "Bad router");
+    NS_TEST_ASSERT_MSG_EQ(summaries[0].seq, 7, "Bad sequence number");
+    NS_TEST_ASSERT_MSG_EQ(summaries[1].withdrawn, true, "Withdrawal lost");
+    LsuEntry decoded = received.DecodeLsa(0);
+    NS_TEST_ASSERT_MSG_EQ(decoded.lsa->IsSameAdvertisement(*sent.lsa), true, "Bad LSA decoded");
+    NS_TEST_ASSERT_MSG_EQ(decoded.lsa->GetNode(), node, "Bad node decoded");
+    NS_TEST_ASSERT_MSG_EQ(received.DecodeLsa(1).lsa->GetNLinkRecords(), 0, "Withdrawn records");
+
+    // a received LSU serializes as it came
+    Ptr<Packet> again = Create<Packet>();
+    again->AddHeader(received);
+    NS_TEST_ASSERT_MSG_EQ(again->GetSize(), hdr.GetSerializedSize(), "Bad size sent again");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the DDR neighbor states go through the ControlChannel, and as
+ * many of them as through the UDP sockets.
+ */
+class RomamControlChannelTestCase : public TestCase
+{
+  public:
+    RomamControlChannelTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Run the DDR nodes of abilene for 100 ms.
+     * \param channel whether to send the updates through the ControlChannel
+     * \return the packets the nodes delivered locally, by IP protocol
+     */
+    std::map<uint8_t, uint32_t> RunUpdates(bool channel);
+
+    /**
+     * \brief Count a packet delivered locally.
+     * \param header the IP header of the packet
+     * \param packet the packet
+     * \param interface the interface it came in on
+     */
+    void Deliver(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface);
+
+    std::map<uint8_t, uint32_t> m_delivered; //!< packets delivered locally, by IP protocol
+};
+
+RomamControlChannelTestCase::RomamControlChannelTestCase()
+    : TestCase("DDR neighbor states through the ControlChannel instead of UDP sockets")
+{
+}
+
+void
+RomamControlChannelTestCase::Deliver(const Ipv4Header& header,
+                                     Ptr<const Packet> packet,
+                                     uint32_t interface)
+{
+    m_delivered[header.GetProtocol()]++;
+}
+
+std::map<uint8_t, uint32_t>
+RomamControlChannelTestCase::RunUpdates(bool channel)
+{
+    m_delivered.clear();
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", DDRHelper(), true);
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        // the updates of the two runs at the same times
+        GetRouting(nodes.Get(n))->SetAttribute("RandomStartPhase", BooleanValue(false));
+        GetRouting(nodes.Get(n))->SetAttribute("UpdateJitter", DoubleValue(0));
+        GetRouting(nodes.Get(n))->SetAttribute("UseControlChannel", BooleanValue(channel));
+        nodes.Get(n)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+            "LocalDeliver",
+            MakeCallback(&RomamControlChannelTestCase::Deliver, this));
+    }
+    DDRHelper::PopulateRoutingTables();
+    Simulator::Stop(MilliSeconds(100));
+    Simulator::Run();
+    Simulator::Destroy();
+    return m_delivered;
+}
+
+void
+RomamControlChannelTestCase::DoRun()
+{
+    std::map<uint8_t, uint32_t> sockets = RunUpdates(false);
+    std::map<uint8_t, uint32_t> channel = RunUpdates(true);
+    NS_TEST_ASSERT_MSG_GT(sockets[UdpL4Protocol::PROT_NUMBER], 0, "No update through the sockets");
+    NS_TEST_ASSERT_MSG_EQ(channel[UdpL4Protocol::PROT_NUMBER], 0, "Updates through the sockets");
+    NS_TEST_ASSERT_MSG_EQ(channel[253],
+                          sockets[UdpL4Protocol::PROT_NUMBER],
+                          "Updates lost by the channel");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that DDRRouting installed without an Ipv4ListRouting forwards the
+ * packets to the other routers and delivers the ones a router sends itself.
+ */
+class RomamSoleRoutingTestCase : public TestCase
+{
+  public:
+    RomamSoleRoutingTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Count the packets of a socket.
+     * \param socket the socket
+     */
+    void Receive(Ptr<Socket> socket);
+
+    /**
+     * \param node a router
+     * \return a socket receiving on port 9 of the router
+     */
+    Ptr<Socket> CreateSink(Ptr<Node> node);
+
+    /**
+     * \brief Send a packet to port 9.
+     * \param socket the socket sending
+     * \param dest the destination address
+     */
+    static void Send(Ptr<Socket> socket, Ipv4Address dest);
+
+    std::map<uint32_t, uint32_t> m_received; //!< packets received, by node ID
+};
+
+RomamSoleRoutingTestCase::RomamSoleRoutingTestCase()
+    : TestCase("DDR routing installed as the only protocol of the nodes, on abilene")
+{
+}
+
+void
+RomamSoleRoutingTestCase::Receive(Ptr<Socket> socket)
+{
+    while (socket->Recv())
+    {
+        m_received[socket->GetNode()->GetId()]++;
+    }
+}
+
+Ptr<Socket>
+RomamSoleRoutingTestCase::CreateSink(Ptr<Node> node)
+{
+    Ptr<Socket> socket = Socket::CreateSocket(node, UdpSocketFactory::GetTypeId());
+    socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+    socket->SetRecvCallback(MakeCallback(&RomamSoleRoutingTestCase::Receive, this));
+    return socket;
+}
+
+void
+RomamSoleRoutingTestCase::Send(Ptr<Socket> socket, Ipv4Address dest)
+{
+    socket->SendTo(Create<Packet>(100), 0, InetSocketAddress(dest, 9));
+}
+
+void
+RomamSoleRoutingTestCase::DoRun()
+{
+    RomamTestScope scope;
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", DDRHelper(), true, false);
+    Ptr<Ipv4> ipv4 = nodes.Get(0)->GetObject<Ipv4>();
+    NS_TEST_ASSERT_MSG_NE(DynamicCast<DDRRouting>(ipv4->GetRoutingProtocol()),
+                          nullptr,
+                          "DDR routing behind another protocol");
+    DDRHelper::PopulateRoutingTables();
+    CreateSink(nodes.Get(0));
+    CreateSink(nodes.Get(5));
+    Ptr<Socket> sender = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+    sender->Bind();
+    Ipv4Address self = ipv4->GetAddress(1, 0).GetLocal();
+    Ipv4Address other = nodes.Get(5)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+    for (Ipv4Address dest : {self, Ipv4Address::GetLoopback(), other})
+    {
+        Simulator::Schedule(MilliSeconds(10), &RomamSoleRoutingTestCase::Send, sender, dest);
+    }
+    Simulator::Stop(MilliSeconds(100));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(m_received[0], 2, "Packets to the router itself not delivered");
+    NS_TEST_ASSERT_MSG_EQ(m_received[5], 1, "Packet to another router not delivered");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the output route cache of DDRRouting answers the lookups of a
+ * source sending to one peer, until the routes change.
+ */
+class RomamOutputRouteCacheTestCase : public TestCase
+{
+  public:
+    RomamOutputRouteCacheTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Look the routes of the first router to the sixth one up.
+     * \param nodes the routers
+     */
+    void CheckLookups(NodeContainer nodes);
+
+    /**
+     * \param nodes the routers
+     * \return the route of a packet of the first router to the sixth one
+     */
+    Ptr<Ipv4Route> Lookup(NodeContainer nodes);
+};
+
+RomamOutputRouteCacheTestCase::RomamOutputRouteCacheTestCase()
+    : TestCase("DDR output routes of a source cached until the routes change")
+{
+}
+
+Ptr<Ipv4Route>
+RomamOutputRouteCacheTestCase::Lookup(NodeContainer nodes)
+{
+    Ipv4Header header;
+    header.SetProtocol(17);
+    header.SetDestination(nodes.Get(5)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal());
+    Socket::SocketErrno sockerr;
+    return GetRouting(nodes.Get(0))->RouteOutput(Create<Packet>(512), header, nullptr, sockerr);
+}
+
+void
+RomamOutputRouteCacheTestCase::CheckLookups(NodeContainer nodes)
+{
+    Ptr<RomamRouting> routing = GetRouting(nodes.Get(0));
+    Ptr<Ipv4Route> first = Lookup(nodes);
+    NS_TEST_ASSERT_MSG_NE(first, nullptr, "No route to the sixth router");
+    NS_TEST_ASSERT_MSG_EQ(routing->GetRoutingStats().Get(RoutingStats::OUTPUT_CACHE_HITS),
+                          0,
+                          "First lookup taken from the cache");
+    NS_TEST_ASSERT_MSG_EQ(Lookup(nodes), first, "Other route from the cache");
+    NS_TEST_ASSERT_MSG_EQ(Lookup(nodes), first, "Other route from the cache");
+    NS_TEST_ASSERT_MSG_EQ(routing->GetRoutingStats().Get(RoutingStats::OUTPUT_CACHE_HITS),
+                          2,
+                          "Next lookups not taken from the cache");
+
+    // an interface event rebuilds the bindings of the routes
+    Ptr<Ipv4> ipv4 = nodes.Get(0)->GetObject<Ipv4>();
+    ipv4->SetDown(ipv4->GetInterfaceForDevice(first->GetOutputDevice()));
+    Lookup(nodes);
+    NS_TEST_ASSERT_MSG_EQ(routing->GetRoutingStats().Get(RoutingStats::OUTPUT_CACHE_HITS),
+                          2,
+                          "Route kept across a change of the routes");
+}
+
+void
+RomamOutputRouteCacheTestCase::DoRun()
+{
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", DDRHelper(), true);
+    DDRHelper::PopulateRoutingTables();
+    Simulator::Schedule(MilliSeconds(10),
+                        &RomamOutputRouteCacheTestCase::CheckLookups,
+                        this,
+                        nodes);
+    Simulator::Stop(MilliSeconds(10));
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the route generation of a router moves with its routes.
+ */
+class RomamRouteGenerationTestCase : public TestCase
+{
+  public:
+    RomamRouteGenerationTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Add then remove a route of the first router.
+     * \param nodes the routers
+     */
+    void CheckGenerations(NodeContainer nodes);
+};
+
+RomamRouteGenerationTestCase::RomamRouteGenerationTestCase()
+    : TestCase("Route generation bumped by every route added or removed")
+{
+}
+
+void
+RomamRouteGenerationTestCase::CheckGenerations(NodeContainer nodes)
+{
+    Ptr<RomamRouting> routing = GetRouting(nodes.Get(0));
+    uint32_t generation = routing->GetRouteGeneration();
+    Ipv4Header header;
+    header.SetProtocol(17);
+    header.SetDestination(nodes.Get(5)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal());
+    Socket::SocketErrno sockerr;
+    routing->RouteOutput(Create<Packet>(512), header, nullptr, sockerr);
+    NS_TEST_ASSERT_MSG_EQ(routing->GetRouteGeneration(),
+                          generation,
+                          "Generation moved by a lookup");
+
+    routing->AddHostRouteTo(Ipv4Address("10.255.0.1"), 1);
+    NS_TEST_ASSERT_MSG_GT(routing->GetRouteGeneration(), generation, "Route added unseen");
+    generation = routing->GetRouteGeneration();
+    routing->RemoveRoute(routing->GetNRoutes() - 1);
+    NS_TEST_ASSERT_MSG_GT(routing->GetRouteGeneration(), generation, "Route removed unseen");
+}
+
+void
+RomamRouteGenerationTestCase::DoRun()
+{
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", DDRHelper(), true);
+    DDRHelper::PopulateRoutingTables();
+    Simulator::Schedule(MilliSeconds(10),
+                        &RomamRouteGenerationTestCase::CheckGenerations,
+                        this,
+                        nodes);
+    Simulator::Stop(MilliSeconds(10));
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the LSAs discovered on several threads install the tables of
+ * the ones discovered on the simulation thread.
+ */
+class RomamParallelDiscoveryTestCase : public TestCase
+{
+  public:
+    RomamParallelDiscoveryTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RomamParallelDiscoveryTestCase::RomamParallelDiscoveryTestCase()
+    : TestCase("Same tables from the LSAs discovered on several threads, on abilene")
+{
+}
+
+void
+RomamParallelDiscoveryTestCase::DoRun()
+{
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", OSPFHelper(), false);
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    RouteManager::InitializeDijkstraRoutes();
+    std::string serial = PrintTables(nodes);
+    Simulator::Destroy();
+
+    RomamTestScope scope;
+    scope.Bind("RomamLsaDiscoveryThreads", UintegerValue(4));
+    nodes = BuildNetwork("Inet_abilene_topo.txt", OSPFHelper(), false);
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    RouteManager::InitializeDijkstraRoutes();
+    NS_TEST_ASSERT_MSG_EQ(PrintTables(nodes), serial, "Other tables from the parallel LSAs");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the MaxCandidates cap keeps the shortest candidate of every
+ * destination and as many interfaces as it can, and counts what it pruned.
+ */
+class RomamCandidateCapTestCase : public TestCase
+{
+  public:
+    RomamCandidateCapTestCase();
+
+  private:
+    void DoRun() override;
+
+    /// the candidates of a destination of a router
+    struct Candidates
+    {
+        uint32_t n;                //!< number of candidates
+        uint32_t shortest;         //!< distance of the shortest one
+        std::set<uint32_t> ifaces; //!< their output interfaces
+    };
+
+    /// the candidates by node and destination
+    typedef std::map<std::pair<uint32_t, Ipv4Address>, Candidates> CandidateMap;
+
+    /**
+     * \param helper the helper of the routers
+     * \param pruned set to the candidates the routers pruned
+     * \return the candidates the routers of abilene installed
+     */
+    static CandidateMap GetCandidates(const DDRHelper& helper, uint32_t& pruned);
+};
+
+/// the candidates kept per destination
+static const uint32_t MAX_CANDIDATES = 2;
+
+RomamCandidateCapTestCase::RomamCandidateCapTestCase()
+    : TestCase("Shortest and most diverse candidates kept by MaxCandidates, on abilene")
+{
+}
+
+RomamCandidateCapTestCase::CandidateMap
+RomamCandidateCapTestCase::GetCandidates(const DDRHelper& helper, uint32_t& pruned)
+{
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", helper, true);
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    RouteManager::InitializeSPFRoutes();
+    CandidateMap candidates;
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        Ptr<DDRRouting> ddr = DynamicCast<DDRRouting>(GetRouting(nodes.Get(n)));
+        NS_ABORT_MSG_IF(!ddr, "Node " << n << " runs no DDRRouting");
+        for (uint32_t i = 0; i < ddr->GetNRoutes(); i++)
+        {
+            ShortestPathForestRIE* route = ddr->GetRoute(i);
+            if (!route->IsHost())
+            {
+                continue;
+            }
+            auto found = candidates.emplace(std::make_pair(n, route->GetDest()),
+                                            Candidates{0, route->GetDistance(), {}});
+            Candidates& dest = found.first->second;
+            dest.n++;
+            dest.shortest = std::min(dest.shortest, route->GetDistance());
+            dest.ifaces.insert(route->GetInterface());
+        }
+    }
+    pruned = RouteManager::GetNPrunedRoutes();
+    Simulator::Destroy();
+    return candidates;
+}
+
+void
+RomamCandidateCapTestCase::DoRun()
+{
+    uint32_t pruned;
+    CandidateMap all = GetCandidates(DDRHelper(), pruned);
+    NS_TEST_ASSERT_MSG_EQ(pruned, 0, "Candidates pruned with no cap");
+    DDRHelper helper;
+    helper.SetMaxCandidates(MAX_CANDIDATES);
+    CandidateMap capped = GetCandidates(helper, pruned);
+    NS_TEST_ASSERT_MSG_EQ(capped.size(), all.size(), "A destination lost all its candidates");
+
+    uint32_t removed = 0;
+    for (auto i = all.begin(); i != all.end(); i++)
+    {
+        auto j = capped.find(i->first);
+        NS_TEST_ASSERT_MSG_EQ((j != capped.end()), true, "A destination lost its candidates");
+        const Candidates& kept = j->second;
+        NS_TEST_ASSERT_MSG_EQ(kept.n, std::min(i->second.n, MAX_CANDIDATES), "Cap not applied");
+        NS_TEST_ASSERT_MSG_EQ(kept.shortest, i->second.shortest, "Shortest candidate pruned");
+        NS_TEST_ASSERT_MSG_EQ(kept.ifaces.size(),
+                              std::min<std::size_t>(i->second.ifaces.size(), MAX_CANDIDATES),
+                              "Interfaces lost to the cap");
+        removed += i->second.n - kept.n;
+    }
+    NS_TEST_ASSERT_MSG_GT(removed, 0, "Nothing over the cap on abilene");
+    NS_TEST_ASSERT_MSG_EQ(pruned, removed, "Pruned candidates miscounted");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the candidate queue pops by distance and keeps the index of a
+ * vertex pushed twice on the first one pushed, whatever the heap moves.
+ */
+class RomamCandidateQueueTestCase : public TestCase
+{
+  public:
+    RomamCandidateQueueTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \param id the vertex id
+     * \param distance the distance from the root
+     * \return a new router vertex
+     */
+    static Vertex* CreateVertex(const char* id, uint32_t distance);
+};
+
+RomamCandidateQueueTestCase::RomamCandidateQueueTestCase()
+    : TestCase("Candidate queue with vertices pushed twice")
+{
+}
+
+Vertex*
+RomamCandidateQueueTestCase::CreateVertex(const char* id, uint32_t distance)
+{
+    Vertex* v = new Vertex();
+    v->SetVertexType(Vertex::VertexRouter);
+    v->SetVertexId(Ipv4Address(id));
+    v->SetDistanceFromRoot(distance);
+    return v;
+}
+
+void
+RomamCandidateQueueTestCase::DoRun()
+{
+    RouteCandidateQueue queue;
+    Vertex* a = CreateVertex("10.0.0.1", 10);
+    queue.Push(a);
+    // the second copy of a sifts up past the first one
+    Vertex* twice = CreateVertex("10.0.0.1", 2);
+    queue.Push(twice);
+    NS_TEST_ASSERT_MSG_EQ(queue.Find(a->GetVertexId()), a, "Index moved to the second copy");
+    queue.Push(CreateVertex("10.0.0.2", 5));
+    queue.Push(CreateVertex("10.0.0.3", 1));
+    queue.Push(CreateVertex("10.0.0.4", 7));
+    NS_TEST_ASSERT_MSG_EQ(queue.Find(a->GetVertexId()), a, "Index lost by the sifts");
+
+    a->SetDistanceFromRoot(3);
+    queue.Update(a);
+    NS_TEST_ASSERT_MSG_EQ(queue.Find(a->GetVertexId()), a, "Index lost by the update");
+
+    std::vector<uint32_t> distances;
+    while (!queue.Empty())
+    {
+        Vertex* v = queue.Pop();
+        distances.push_back(v->GetDistanceFromRoot());
+        if (v == twice)
+        {
+            NS_TEST_ASSERT_MSG_EQ(queue.Find(a->GetVertexId()), a, "Index lost by the pop");
+        }
+        delete v;
+    }
+    NS_TEST_ASSERT_MSG_EQ((distances == std::vector<uint32_t>{1, 2, 3, 5, 7}),
+                          true,
+                          "Vertices not popped by distance");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the timers of a wheel fire on the ticks of their delays, from
+ * every level and from the overflow list, and that cancelled ones do not.
+ */
+class RomamTimerWheelTestCase : public TestCase
+{
+  public:
+    RomamTimerWheelTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Record the time a timer fired.
+     * \param test the test case
+     * \param timer the index of the timer
+     */
+    static void Fire(RomamTimerWheelTestCase* test, uint32_t timer);
+
+    std::map<uint32_t, Time> m_fired; //!< the time every timer fired, by index
+};
+
+RomamTimerWheelTestCase::RomamTimerWheelTestCase()
+    : TestCase("Timer wheel firing on the ticks of the delays, through the cascades")
+{
+}
+
+void
+RomamTimerWheelTestCase::Fire(RomamTimerWheelTestCase* test, uint32_t timer)
+{
+    test->m_fired[timer] = Simulator::Now();
+}
+
+void
+RomamTimerWheelTestCase::DoRun()
+{
+    RomamTestScope scope;
+    Ptr<TimerWheel> wheel = CreateObject<TimerWheel>();
+    wheel->SetAttribute("Resolution", TimeValue(MilliSeconds(1)));
+    // on level 0, then the next tick, then levels 1 and 2 and the overflow list
+    const Time delays[] = {MilliSeconds(3),
+                           MicroSeconds(500),
+                           MilliSeconds(100),
+                           MilliSeconds(100),
+                           Seconds(5),
+                           Seconds(20000)};
+    const Time fired[] = {MilliSeconds(3),
+                          MilliSeconds(1),
+                          MilliSeconds(100),
+                          MilliSeconds(100),
+                          Seconds(5),
+                          Seconds(20000)};
+    std::vector<TimerWheel::TimerId> timers;
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        timers.push_back(
+            wheel->Schedule(delays[i], MakeBoundCallback(&RomamTimerWheelTestCase::Fire, this, i)));
+    }
+    NS_TEST_ASSERT_MSG_EQ(wheel->GetNPending(), 6, "Timers not pending");
+    NS_TEST_ASSERT_MSG_EQ(wheel->GetDelayLeft(timers[2]), MilliSeconds(100), "Other delay left");
+
+    NS_TEST_ASSERT_MSG_EQ(wheel->Cancel(timers[3]), true, "Pending timer not cancelled");
+    NS_TEST_ASSERT_MSG_EQ(wheel->Cancel(timers[3]), false, "Timer cancelled twice");
+    NS_TEST_ASSERT_MSG_EQ(wheel->IsPending(timers[3]), false, "Cancelled timer pending");
+    // the entry of the cancelled timer is reused, under another name
+    timers[3] = wheel->Schedule(MilliSeconds(50),
+                                MakeBoundCallback(&RomamTimerWheelTestCase::Fire, this, 6));
+    NS_TEST_ASSERT_MSG_EQ(wheel->IsPending(timers[3]), true, "Reused entry not pending");
+    NS_TEST_ASSERT_MSG_EQ(wheel->GetNPending(), 6, "Other pending timers");
+
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(wheel->GetNPending(), 0, "Timers left pending");
+    NS_TEST_ASSERT_MSG_EQ(m_fired.count(3), 0, "Cancelled timer fired");
+    NS_TEST_ASSERT_MSG_EQ(m_fired.count(6), 1, "Timer of the reused entry did not fire");
+    NS_TEST_ASSERT_MSG_EQ(m_fired[6], MilliSeconds(50), "Timer of the reused entry fired late");
+    for (uint32_t i : {0, 1, 2, 4, 5})
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_fired.count(i), 1, "Timer " << i << " did not fire");
+        NS_TEST_ASSERT_MSG_EQ(m_fired[i], fired[i], "Timer " << i << " not on its tick");
+    }
+    wheel->Dispose();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the LSDBs the OSPF nodes flood give the routes of the global
+ * LSDB, and that the LSAs acknowledged late are sent again until they are.
+ */
+class RomamFloodingTestCase : public TestCase
+{
+  public:
+    RomamFloodingTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Compute the routes of the OSPF nodes of abilene.
+     * \param flooding whether the nodes flood their LSAs, rather than take
+     * the routes of the global LSDB
+     * \param ackDelay the AckDelay of the nodes
+     * \return the interfaces of the host routes of the nodes
+     */
+    RouteInterfaces GetRoutes(bool flooding, Time ackDelay);
+
+    /**
+     * \brief Count an LSU, LSAck or Hello sent.
+     * \param command the command of the packet
+     * \param entries the LSA instances or acknowledgments it carries
+     * \param bytes the size of the packet
+     */
+    void CountTx(uint8_t command, uint32_t entries, uint32_t bytes);
+
+    /**
+     * \brief Count the adjacencies that are full.
+     * \param interface the interface of the neighbor
+     * \param previous the state it left
+     * \param state the state it entered
+     */
+    void CountFull(uint32_t interface, uint8_t previous, uint8_t state);
+
+    uint32_t m_lsuEntries;  //!< the LSA instances sent in LSUs
+    uint32_t m_ackEntries;  //!< the acknowledgments sent in LSAcks
+    Time m_lastLsu;         //!< the time the last LSU was sent
+    uint32_t m_full;        //!< the neighbors in the FULL state
+    uint32_t m_adjacencies; //!< the ends of the point-to-point links
+};
+
+/// the retransmit interval of the flooding runs, in milliseconds
+static const uint32_t FLOODING_RETRANSMIT_MS = 10;
+
+RomamFloodingTestCase::RomamFloodingTestCase()
+    : TestCase("Same routes from the flooded LSDBs, with retransmissions, on abilene"),
+      m_lsuEntries(0),
+      m_ackEntries(0),
+      m_full(0),
+      m_adjacencies(0)
+{
+}
+
+void
+RomamFloodingTestCase::CountTx(uint8_t command, uint32_t entries, uint32_t bytes)
+{
+    if (command == LsuHeader::LSU)
+    {
+        m_lsuEntries += entries;
+        m_lastLsu = Simulator::Now();
+    }
+    else if (command == LsuHeader::LSACK)
+    {
+        m_ackEntries += entries;
+    }
+}
+
+void
+RomamFloodingTestCase::CountFull(uint32_t interface, uint8_t previous, uint8_t state)
+{
+    if (state == NeighborFsm::FULL)
+    {
+        m_full++;
+    }
+    else if (previous == NeighborFsm::FULL)
+    {
+        m_full--;
+    }
+}
+
+RouteInterfaces
+RomamFloodingTestCase::GetRoutes(bool flooding, Time ackDelay)
+{
+    m_lsuEntries = 0;
+    m_ackEntries = 0;
+    m_lastLsu = Seconds(0);
+    m_full = 0;
+    m_adjacencies = 0;
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", OSPFHelper(), false);
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        Ptr<OSPFRouting> ospf = DynamicCast<OSPFRouting>(GetRouting(nodes.Get(n)));
+        NS_ABORT_MSG_IF(!ospf, "Node " << n << " runs no OSPFRouting");
+        // the nodes are initialized when the simulation starts
+        ospf->SetAttribute("DistributedFlooding", BooleanValue(flooding));
+        ospf->SetAttribute("AckDelay", TimeValue(ackDelay));
+        ospf->SetAttribute("RetransmitInterval", TimeValue(MilliSeconds(FLOODING_RETRANSMIT_MS)));
+        ospf->TraceConnectWithoutContext("FloodingTx",
+                                         MakeCallback(&RomamFloodingTestCase::CountTx, this));
+        ospf->TraceConnectWithoutContext("NeighborState",
+                                         MakeCallback(&RomamFloodingTestCase::CountFull, this));
+        for (uint32_t d = 0; d < nodes.Get(n)->GetNDevices(); d++)
+        {
+            Ptr<Channel> channel = nodes.Get(n)->GetDevice(d)->GetChannel();
+            m_adjacencies += channel && channel->GetNDevices() == 2;
+        }
+    }
+    if (flooding)
+    {
+        Simulator::Stop(Seconds(2));
+        Simulator::Run();
+    }
+    else
+    {
+        RouteManager::DeleteRoutes();
+        RouteManager::BuildLSDB();
+        RouteManager::InitializeDijkstraRoutes();
+    }
+    RouteInterfaces routes;
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        Ptr<OSPFRouting> ospf = DynamicCast<OSPFRouting>(GetRouting(nodes.Get(n)));
+        for (uint32_t i = 0; i < ospf->GetNRoutes(); i++)
+        {
+            DijkstraRIE* route = ospf->GetRoute(i);
+            if (route->IsHost())
+            {
+                routes[std::make_pair(n, route->GetDest())].insert(route->GetInterface());
+            }
+        }
+    }
+    Simulator::Destroy();
+    return routes;
+}
+
+void
+RomamFloodingTestCase::DoRun()
+{
+    RouteInterfaces global = GetRoutes(false, MilliSeconds(5));
+    NS_TEST_ASSERT_MSG_GT(global.size(), 0, "No routes from the global LSDB");
+
+    // acknowledged within the retransmit interval, every instance is sent once
+    RouteInterfaces flooded = GetRoutes(true, MilliSeconds(5));
+    uint32_t lsuEntries = m_lsuEntries;
+    NS_TEST_ASSERT_MSG_EQ((flooded == global), true, "Other routes from the flooded LSDBs");
+    NS_TEST_ASSERT_MSG_EQ(m_full, m_adjacencies, "Adjacencies not full");
+    NS_TEST_ASSERT_MSG_GT(m_ackEntries, 0, "No LSA acknowledged");
+
+    // acknowledged after three intervals, the instances are sent again meanwhile
+    flooded = GetRoutes(true, MilliSeconds(3 * FLOODING_RETRANSMIT_MS + 5));
+    NS_TEST_ASSERT_MSG_EQ((flooded == global), true, "Other routes with retransmissions");
+    NS_TEST_ASSERT_MSG_GT(m_lsuEntries, lsuEntries, "No LSA sent again");
+    NS_TEST_ASSERT_MSG_EQ(m_full, m_adjacencies, "Adjacencies not full after retransmissions");
+    // the acknowledgments ended the retransmissions
+    NS_TEST_ASSERT_MSG_LT(m_lastLsu, Seconds(1), "LSAs still sent again");
+}
+
+/// a point-to-point link of a router
+struct RouterLink
+{
+    uint32_t neighbor; //!< the node ID of the router at the other end
+    uint32_t metric;   //!< the metric of the link
+    uint32_t iface;    //!< the interface of the link
+};
+
+/// the links of the routers, by node ID
+typedef std::vector<std::vector<RouterLink>> RouterLinks;
+
+/**
+ * \param nodes the routers
+ * \return the point-to-point links of the routers, read from their interfaces
+ */
+static RouterLinks
+GetRouterLinks(NodeContainer nodes)
+{
+    RouterLinks links(nodes.GetN());
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        Ptr<Ipv4> ipv4 = nodes.Get(n)->GetObject<Ipv4>();
+        for (uint32_t i = 0; i < ipv4->GetNInterfaces(); i++)
+        {
+            Ptr<NetDevice> device = ipv4->GetNetDevice(i);
+            Ptr<Channel> channel = device->GetChannel();
+            if (!channel || channel->GetNDevices() != 2)
+            {
+                continue;
+            }
+            Ptr<NetDevice> other = channel->GetDevice(channel->GetDevice(0) == device ? 1 : 0);
+            links[n].push_back(RouterLink{other->GetNode()->GetId(), ipv4->GetMetric(i), i});
+        }
+    }
+    return links;
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the k shortest paths of the DDR nodes cost what the k cheapest
+ * loopless paths of the topology do, found by enumerating them all.
+ */
+class RomamKShortestPathsTestCase : public TestCase
+{
+  public:
+    RomamKShortestPathsTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Collect the costs of all the loopless paths to a router.
+     * \param links the links of the routers
+     * \param at the router the paths have reached
+     * \param dest the destination router
+     * \param cost the cost of the path so far
+     * \param visited the routers of the path so far
+     * \param costs the costs the paths reaching dest are appended to
+     */
+    static void CollectPathCosts(const RouterLinks& links,
+                                 uint32_t at,
+                                 uint32_t dest,
+                                 uint32_t cost,
+                                 std::vector<bool>& visited,
+                                 std::vector<uint32_t>& costs);
+};
+
+/// the paths computed to every router
+static const uint32_t K_SHORTEST_PATHS = 3;
+
+RomamKShortestPathsTestCase::RomamKShortestPathsTestCase()
+    : TestCase("K shortest paths of the cheapest loopless paths, on abilene")
+{
+}
+
+void
+RomamKShortestPathsTestCase::CollectPathCosts(const RouterLinks& links,
+                                              uint32_t at,
+                                              uint32_t dest,
+                                              uint32_t cost,
+                                              std::vector<bool>& visited,
+                                              std::vector<uint32_t>& costs)
+{
+    if (at == dest)
+    {
+        costs.push_back(cost);
+        return;
+    }
+    visited[at] = true;
+    for (const RouterLink& link : links[at])
+    {
+        if (!visited[link.neighbor])
+        {
+            CollectPathCosts(links, link.neighbor, dest, cost + link.metric, visited, costs);
+        }
+    }
+    visited[at] = false;
+}
+
+void
+RomamKShortestPathsTestCase::DoRun()
+{
+    RomamTestScope scope;
+    scope.Bind("RomamKShortestPaths", UintegerValue(K_SHORTEST_PATHS));
+    NodeContainer nodes = BuildNetwork("Inet_abilene_topo.txt", DDRHelper(), true);
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    RouteManager::InitializeSPFRoutes();
+    RouterLinks links = GetRouterLinks(nodes);
+    uint32_t alternates = 0;
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        Ptr<DDRRouting> ddr = DynamicCast<DDRRouting>(GetRouting(nodes.Get(n)));
+        NS_TEST_ASSERT_MSG_NE(ddr, nullptr, "Node " << n << " runs no DDRRouting");
+        const KShortestPathTable& table = ddr->GetKShortestPathTable();
+        for (uint32_t m = 0; m < nodes.GetN(); m++)
+        {
+            if (m == n)
+            {
+                continue;
+            }
+            Ipv4Address dest = nodes.Get(m)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+            uint32_t d = table.Find(dest);
+            NS_TEST_ASSERT_MSG_NE(d, KShortestPathTable::NO_DESTINATION, "No paths to " << dest);
+            std::vector<uint32_t> costs;
+            std::vector<bool> visited(nodes.GetN(), false);
+            CollectPathCosts(links, n, m, 0, visited, costs);
+            std::sort(costs.begin(), costs.end());
+            costs.resize(std::min<std::size_t>(costs.size(), K_SHORTEST_PATHS));
+            std::vector<uint32_t> found;
+            for (uint32_t i = 0; i < table.GetNPaths(d); i++)
+            {
+                found.push_back(table.GetPath(d, i).distance);
+            }
+            NS_TEST_ASSERT_MSG_EQ((found == costs),
+                                  true,
+                                  "Not the cheapest loopless paths from " << n << " to " << m);
+            alternates += found.size() - 1;
+        }
+    }
+    NS_TEST_ASSERT_MSG_GT(alternates, 0, "No path but the shortest ones");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the blocked Floyd-Warshall of the distance matrix finds the
+ * distances of a plain one, on a grid of more routers than a tile holds.
+ */
+class RomamDistanceMatrixTestCase : public TestCase
+{
+  public:
+    RomamDistanceMatrixTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RomamDistanceMatrixTestCase::RomamDistanceMatrixTestCase()
+    : TestCase("Distance matrix of the plain Floyd-Warshall, on the 10 by 10 grid")
+{
+}
+
+void
+RomamDistanceMatrixTestCase::DoRun()
+{
+    RomamTestScope scope;
+    NodeContainer nodes = BuildNetwork("Inet_10by10_topo.txt", OSPFHelper(), false);
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    uint32_t n = nodes.GetN();
+    std::vector<uint32_t> expected(n * n, DistanceMatrix::INFINITE_DISTANCE);
+    RouterLinks links = GetRouterLinks(nodes);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        expected[i * n + i] = 0;
+        for (const RouterLink& link : links[i])
+        {
+            expected[i * n + link.neighbor] =
+                std::min(expected[i * n + link.neighbor], link.metric);
+        }
+    }
+    for (uint32_t k = 0; k < n; k++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            for (uint32_t j = 0; j < n; j++)
+            {
+                expected[i * n + j] =
+                    std::min(expected[i * n + j], expected[i * n + k] + expected[k * n + j]);
+            }
+        }
+    }
+
+    const DistanceMatrix* matrix = RouteManager::GetDistanceMatrix();
+    NS_TEST_ASSERT_MSG_EQ(matrix->GetNRouters(), n, "Not a row per router");
+    for (uint32_t i = 0; i < n; i++)
+    {
+        for (uint32_t j = 0; j < n; j++)
+        {
+            NS_TEST_ASSERT_MSG_EQ(RouteManager::GetNodeDistance(i, j),
+                                  expected[i * n + j],
+                                  "Other distance from " << i << " to " << j);
+        }
+    }
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the LSDB file warm-starts the LSDB of its topology, and that a
+ * file of another topology, or a malformed one, falls back to a full build.
+ */
+class RomamLSDBFileTestCase : public TestCase
+{
+  public:
+    RomamLSDBFileTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Compute the Dijkstra routes of a topology.
+     * \param topo the name of the topology file
+     * \return the routing tables of the routers, as printed
+     */
+    std::string GetTables(const std::string& topo);
+
+    std::string m_path; //!< the LSDB file
+    bool m_warm;        //!< whether the file matched the topology before the build
+    bool m_saved;       //!< whether it matched it after the build
+};
+
+RomamLSDBFileTestCase::RomamLSDBFileTestCase()
+    : TestCase("LSDB warm-started from its file, rebuilt from another topology's"),
+      m_path("romam-test-" + std::to_string(getpid()) + ".lsdb"),
+      m_warm(false),
+      m_saved(false)
+{
+}
+
+std::string
+RomamLSDBFileTestCase::GetTables(const std::string& topo)
+{
+    NodeContainer nodes = BuildNetwork(topo, OSPFHelper(), false);
+    uint64_t hash = LSDBFile::ComputeTopologyHash();
+    m_warm = LSDBFile::Load(m_path, hash) != nullptr;
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildLSDB();
+    RouteManager::InitializeDijkstraRoutes();
+    std::string tables = PrintTables(nodes);
+    m_saved = LSDBFile::Load(m_path, hash) != nullptr;
+    Simulator::Destroy();
+    return tables;
+}
+
+void
+RomamLSDBFileTestCase::DoRun()
+{
+    RomamTestScope scope;
+    std::string abilene = GetTables("Inet_abilene_topo.txt");
+    std::string grid = GetTables("Inet_4by4_topo.txt");
+    std::remove(m_path.c_str());
+    scope.Bind("RomamLSDBCacheFile", StringValue(m_path));
+
+    // the first run saves the file, the second one starts from it
+    std::string first = GetTables("Inet_abilene_topo.txt");
+    bool firstWarm = m_warm;
+    bool firstSaved = m_saved;
+    std::string second = GetTables("Inet_abilene_topo.txt");
+    bool secondWarm = m_warm;
+    // the hash of the grid does not match, nor does a malformed file
+    std::string other = GetTables("Inet_4by4_topo.txt");
+    bool otherWarm = m_warm;
+    bool otherSaved = m_saved;
+    std::ofstream(m_path, std::ios::trunc) << "not an LSDB file";
+    std::string malformed = GetTables("Inet_4by4_topo.txt");
+    bool malformedWarm = m_warm;
+    std::remove(m_path.c_str());
+
+    NS_TEST_ASSERT_MSG_EQ(firstWarm, false, "LSDB loaded before any was saved");
+    NS_TEST_ASSERT_MSG_EQ(firstSaved, true, "LSDB not saved");
+    NS_TEST_ASSERT_MSG_EQ(first, abilene, "Other tables from the LSDB saved");
+    NS_TEST_ASSERT_MSG_EQ(secondWarm, true, "LSDB file not loaded");
+    NS_TEST_ASSERT_MSG_EQ(second, abilene, "Other tables from the loaded LSDB");
+    NS_TEST_ASSERT_MSG_EQ(otherWarm, false, "LSDB of another topology loaded");
+    NS_TEST_ASSERT_MSG_EQ(otherSaved, true, "LSDB of the new topology not saved");
+    NS_TEST_ASSERT_MSG_EQ(other, grid, "Other tables from the rebuilt LSDB");
+    NS_TEST_ASSERT_MSG_EQ(malformedWarm, false, "Malformed LSDB file loaded");
+    NS_TEST_ASSERT_MSG_EQ(malformed, grid, "Other tables after the malformed file");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the compact neighbor status messages, deltas or not, read back
+ * as they were written, in 4 + 1.5 n bytes, and that the old format still does.
+ */
+class RomamCompactStatusTestCase : public TestCase
+{
+  public:
+    RomamCompactStatusTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Write a message and read it back.
+     * \param sent the message
+     * \return the message read
+     */
+    static DgrHeader RoundTrip(const DgrHeader& sent);
+};
+
+RomamCompactStatusTestCase::RomamCompactStatusTestCase()
+    : TestCase("Compact and delta neighbor status messages read back as written")
+{
+}
+
+DgrHeader
+RomamCompactStatusTestCase::RoundTrip(const DgrHeader& sent)
+{
+    Ptr<Packet> packet = Create<Packet>();
+    packet->AddHeader(sent);
+    DgrHeader received;
+    packet->RemoveHeader(received);
+    return received;
+}
+
+void
+RomamCompactStatusTestCase::DoRun()
+{
+    // an odd count leaves half a byte of states, and more than 8 NSEs go out of line
+    for (uint32_t n : {1u, 4u, 9u, DgrHeader::COMPACT_MAX_NSES})
+    {
+        for (bool compact : {true, false})
+        {
+            DgrHeader sent;
+            sent.SetCommand(DgrHeader::RESPONSE);
+            sent.SetCompact(compact);
+            sent.SetDelta(compact && n % 2 == 1);
+            for (uint32_t k = 0; k < n; k++)
+            {
+                DgrNse nse;
+                nse.SetInterface((k * 7 + 1) % (DgrHeader::COMPACT_MAX_INTERFACE + 1));
+                nse.SetState(k % (DgrHeader::COMPACT_MAX_STATE + 1));
+                sent.AddNse(nse);
+            }
+            if (n == 4)
+            {
+                DgrDownstream downstream = {Ipv4Address("10.0.0.9"), 1500};
+                sent.AddDownstream(downstream);
+            }
+            DgrHeader received = RoundTrip(sent);
+            NS_TEST_ASSERT_MSG_EQ(received.GetSerializedSize(),
+                                  sent.GetSerializedSize(),
+                                  "Other size read for " << n << " NSEs");
+            NS_TEST_ASSERT_MSG_EQ(received.IsCompact(), compact, "Other format read");
+            NS_TEST_ASSERT_MSG_EQ(received.IsDelta(), sent.IsDelta(), "Delta flag lost");
+            NS_TEST_ASSERT_MSG_EQ(received.GetCommand(), DgrHeader::RESPONSE, "Command lost");
+            NS_TEST_ASSERT_MSG_EQ(received.GetNseNumber(), n, "NSEs lost");
+            for (uint32_t k = 0; k < n; k++)
+            {
+                NS_TEST_ASSERT_MSG_EQ(received.GetNses()[k].GetInterface(),
+                                      sent.GetNses()[k].GetInterface(),
+                                      "Other interface in NSE " << k);
+                NS_TEST_ASSERT_MSG_EQ(received.GetNses()[k].GetState(),
+                                      sent.GetNses()[k].GetState(),
+                                      "Other state in NSE " << k);
+            }
+            NS_TEST_ASSERT_MSG_EQ(received.HasDownstream(), n == 4, "Downstream flag lost");
+            if (n == 4)
+            {
+                NS_TEST_ASSERT_MSG_EQ(received.GetNDownstreams(), 1, "Downstream delays lost");
+                NS_TEST_ASSERT_MSG_EQ(received.GetDownstreams()[0].dest,
+                                      Ipv4Address("10.0.0.9"),
+                                      "Other downstream destination");
+                NS_TEST_ASSERT_MSG_EQ(received.GetDownstreams()[0].delay,
+                                      1500,
+                                      "Other downstream delay");
+            }
+            else if (compact)
+            {
+                NS_TEST_ASSERT_MSG_EQ(sent.GetSerializedSize(),
+                                      4 + n + (n + 1) / 2,
+                                      "Compact message of " << n << " NSEs not 4 + 1.5 n bytes");
+            }
+        }
+    }
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the deficit round robin of DDRQueueDisc shares the link between
+ * the bands by their weights, and estimates the delay of a band from its
+ * share, and that the strict priority does not.
+ */
+class RomamDrrQueueDiscTestCase : public TestCase
+{
+  public:
+    RomamDrrQueueDiscTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \param scheduler the Scheduler of the queue disc
+     * \return an initialized DDRQueueDisc with the DRR_ weights
+     */
+    static Ptr<DDRQueueDisc> CreateQueueDisc(const std::string& scheduler);
+
+    /**
+     * \brief Enqueue DRR_PACKETS packets of DRR_QUANTUM bytes in each band,
+     * the best effort ones first.
+     * \param qdisc the queue disc
+     */
+    static void Fill(Ptr<DDRQueueDisc> qdisc);
+
+    /**
+     * \brief Fill the two bands of a DDRQueueDisc and drain it.
+     * \param scheduler the Scheduler of the queue disc
+     * \return whether every dequeued packet was delay sensitive, in order
+     */
+    static std::vector<bool> Drain(const std::string& scheduler);
+};
+
+/// packets queued in each band
+static const uint32_t DRR_PACKETS = 30;
+/// bytes of a packet with its IPv4 header, one quantum
+static const uint32_t DRR_QUANTUM = 1000;
+/// quanta of the delay sensitive band per round, the best effort band has one
+static const uint32_t DRR_FAST_WEIGHT = 3;
+
+RomamDrrQueueDiscTestCase::RomamDrrQueueDiscTestCase()
+    : TestCase("Deficit round robin of DDRQueueDisc sharing the link by the band weights")
+{
+}
+
+Ptr<DDRQueueDisc>
+RomamDrrQueueDiscTestCase::CreateQueueDisc(const std::string& scheduler)
+{
+    Ptr<DDRQueueDisc> qdisc = CreateObject<DDRQueueDisc>();
+    qdisc->SetAttribute("Scheduler", StringValue(scheduler));
+    qdisc->SetAttribute("Quantum", UintegerValue(DRR_QUANTUM));
+    qdisc->SetAttribute("FastWeight", UintegerValue(DRR_FAST_WEIGHT));
+    qdisc->SetAttribute("NormalWeight", UintegerValue(1));
+    qdisc->Initialize();
+    return qdisc;
+}
+
+void
+RomamDrrQueueDiscTestCase::Fill(Ptr<DDRQueueDisc> qdisc)
+{
+    Ipv4Header header;
+    header.SetProtocol(17);
+    // the best effort packets first, the order of the bands must not depend on it
+    for (bool priority : {false, true})
+    {
+        for (uint32_t i = 0; i < DRR_PACKETS; i++)
+        {
+            Ptr<Packet> packet = Create<Packet>(DRR_QUANTUM - header.GetSerializedSize());
+            if (priority)
+            {
+                RomamMetaTag metaTag;
+                metaTag.SetPriority(true);
+                packet->AddPacketTag(metaTag);
+            }
+            qdisc->Enqueue(Create<Ipv4QueueDiscItem>(packet, Address(), 0x0800, header));
+        }
+    }
+}
+
+std::vector<bool>
+RomamDrrQueueDiscTestCase::Drain(const std::string& scheduler)
+{
+    Ptr<DDRQueueDisc> qdisc = CreateQueueDisc(scheduler);
+    Fill(qdisc);
+    std::vector<bool> bands;
+    while (true)
+    {
+        // a peek between the dequeues must not change the packet they return
+        Ptr<const QueueDiscItem> peeked = qdisc->Peek();
+        Ptr<QueueDiscItem> item = qdisc->Dequeue();
+        if (!item || item != peeked)
+        {
+            break;
+        }
+        RomamMetaTag metaTag;
+        bands.push_back(RomamMetaTag::Peek(item->GetPacket(), metaTag) && metaTag.HasPriority());
+    }
+    qdisc->Dispose();
+    return bands;
+}
+
+void
+RomamDrrQueueDiscTestCase::DoRun()
+{
+    RomamTestScope scope;
+    std::vector<bool> bands = Drain("DeficitRoundRobin");
+    NS_TEST_ASSERT_MSG_EQ(bands.size(), 2 * DRR_PACKETS, "Packets lost or peeked out of order");
+    // rounds of DRR_FAST_WEIGHT delay sensitive packets and a best effort one,
+    // then the rest of the best effort band
+    for (uint32_t i = 0; i < bands.size(); i++)
+    {
+        uint32_t round = DRR_FAST_WEIGHT + 1;
+        bool priority = i < DRR_PACKETS / DRR_FAST_WEIGHT * round && i % round < DRR_FAST_WEIGHT;
+        NS_TEST_ASSERT_MSG_EQ(bands[i], priority, "Packet " << i << " not from its band");
+    }
+
+    bands = Drain("StrictPriority");
+    NS_TEST_ASSERT_MSG_EQ(bands.size(), 2 * DRR_PACKETS, "Packets lost or peeked out of order");
+    for (uint32_t i = 0; i < bands.size(); i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(bands[i], i < DRR_PACKETS, "Packet " << i << " not from its band");
+    }
+
+    // one round dequeued a millisecond apart measures a rate of a packet per
+    // millisecond, of which each band gets the share of its weight
+    Ptr<DDRQueueDisc> qdisc = CreateQueueDisc("DeficitRoundRobin");
+    Fill(qdisc);
+    uint32_t round = DRR_FAST_WEIGHT + 1;
+    for (uint32_t i = 1; i <= round; i++)
+    {
+        Simulator::Schedule(MilliSeconds(i), &QueueDisc::Dequeue, qdisc);
+    }
+    Simulator::Stop(MilliSeconds(round + 1));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ_TOL(qdisc->GetDrainRate(),
+                              DRR_QUANTUM * 1000.0,
+                              1,
+                              "Dequeue rate not measured");
+    uint32_t fastBytes = (DRR_PACKETS - DRR_FAST_WEIGHT) * DRR_QUANTUM;
+    uint32_t normalBytes = (DRR_PACKETS - 1) * DRR_QUANTUM;
+    Time fastDrain = MicroSeconds(fastBytes * round * 1000 / (DRR_QUANTUM * DRR_FAST_WEIGHT));
+    Time normalDrain = MicroSeconds(normalBytes * round * 1000 / DRR_QUANTUM);
+    // band 0 is the delay sensitive one
+    NS_TEST_ASSERT_MSG_EQ_TOL(qdisc->GetDrainTime(0),
+                              fastDrain,
+                              MicroSeconds(1),
+                              "Delay sensitive band not drained at its share");
+    NS_TEST_ASSERT_MSG_EQ_TOL(qdisc->GetDrainTime(1),
+                              normalDrain,
+                              MicroSeconds(1),
+                              "Best effort band not drained at its share");
+    qdisc->Dispose();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that DeadlineQueueDisc serves the packets by their deadlines, from
+ * its bands and from the buckets of its calendar, and enforces its limit.
+ */
+class RomamDeadlineQueueDiscTestCase : public TestCase
+{
+  public:
+    RomamDeadlineQueueDiscTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Enqueue a packet of DEADLINE_PACKET_SIZE bytes.
+     * \param qdisc the queue disc
+     * \param budget the budget of the packet in microseconds, or
+     * DEADLINE_NO_BUDGET
+     * \param uid set to the uid of the packet
+     * \return whether the packet was queued
+     */
+    static bool Enqueue(Ptr<DeadlineQueueDisc> qdisc, uint32_t budget, uint64_t& uid);
+
+    /**
+     * \brief Drain a queue disc.
+     * \param qdisc the queue disc
+     * \return the uids of the dequeued packets, in order
+     */
+    static std::vector<uint64_t> Drain(Ptr<DeadlineQueueDisc> qdisc);
+};
+
+/// bytes of a packet with its IPv4 header
+static const uint32_t DEADLINE_PACKET_SIZE = 1000;
+/// the budget of the packets without one
+static const uint32_t DEADLINE_NO_BUDGET = UINT32_MAX;
+
+RomamDeadlineQueueDiscTestCase::RomamDeadlineQueueDiscTestCase()
+    : TestCase("DeadlineQueueDisc serving by deadline in its Bands and Edf modes")
+{
+}
+
+bool
+RomamDeadlineQueueDiscTestCase::Enqueue(Ptr<DeadlineQueueDisc> qdisc,
+                                        uint32_t budget,
+                                        uint64_t& uid)
+{
+    Ipv4Header header;
+    header.SetProtocol(17);
+    Ptr<Packet> packet = Create<Packet>(DEADLINE_PACKET_SIZE - header.GetSerializedSize());
+    if (budget != DEADLINE_NO_BUDGET)
+    {
+        RomamMetaTag metaTag;
+        metaTag.SetTimestamp(Simulator::Now());
+        metaTag.SetBudget(budget);
+        packet->AddPacketTag(metaTag);
+    }
+    uid = packet->GetUid();
+    return qdisc->Enqueue(Create<Ipv4QueueDiscItem>(packet, Address(), 0x0800, header));
+}
+
+std::vector<uint64_t>
+RomamDeadlineQueueDiscTestCase::Drain(Ptr<DeadlineQueueDisc> qdisc)
+{
+    std::vector<uint64_t> uids;
+    while (Ptr<QueueDiscItem> item = qdisc->Dequeue())
+    {
+        uids.push_back(item->GetPacket()->GetUid());
+    }
+    return uids;
+}
+
+void
+RomamDeadlineQueueDiscTestCase::DoRun()
+{
+    RomamTestScope scope;
+    // bands of 5 ms: the budgets left go to bands 3, 2, 0, 3 (beyond the last
+    // band) and 1, the packet without a budget to the last band
+    Ptr<DeadlineQueueDisc> bands = CreateObject<DeadlineQueueDisc>();
+    bands->SetAttribute("Mode", StringValue("Bands"));
+    bands->SetAttribute("NBands", UintegerValue(4));
+    bands->SetAttribute("BandWidth", TimeValue(MilliSeconds(5)));
+    bands->SetAttribute("MaxSize", QueueSizeValue(QueueSize("5000B")));
+    bands->Initialize();
+    const uint32_t bandBudgets[] = {DEADLINE_NO_BUDGET, 12000, 1000, 30000, 6000};
+    std::vector<uint64_t> uids(5);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(Enqueue(bands, bandBudgets[i], uids[i]), true, "Packet dropped");
+    }
+    NS_TEST_ASSERT_MSG_EQ(bands->GetQueueStatus(5), 5, "Full queue disc not reported full");
+    NS_TEST_ASSERT_MSG_EQ(bands->GetBandStatus(3, 5), 2, "Packets not in the last band");
+    uint64_t dropped;
+    NS_TEST_ASSERT_MSG_EQ(Enqueue(bands, 1000, dropped), false, "Packet over the limit queued");
+    NS_TEST_ASSERT_MSG_EQ(bands->GetStats().GetNDroppedPackets(
+                              DeadlineQueueDisc::LIMIT_EXCEEDED_DROP),
+                          1,
+                          "Packet over the limit not counted");
+    const uint32_t bandOrder[] = {2, 4, 1, 0, 3};
+    std::vector<uint64_t> served = Drain(bands);
+    NS_TEST_ASSERT_MSG_EQ(served.size(), 5, "Packets lost");
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(served[i], uids[bandOrder[i]], "Band " << i << " out of order");
+    }
+    bands->Dispose();
+
+    // buckets of 1 ms: the deadlines go to buckets 7, 15 (no budget), 2, 15
+    // (beyond the calendar), 2 and 5, served in FIFO order within a bucket
+    Ptr<DeadlineQueueDisc> edf = CreateObject<DeadlineQueueDisc>();
+    edf->SetAttribute("Mode", StringValue("Edf"));
+    edf->SetAttribute("NBuckets", UintegerValue(16));
+    edf->SetAttribute("BucketWidth", TimeValue(MilliSeconds(1)));
+    edf->Initialize();
+    const uint32_t edfBudgets[] = {7000, DEADLINE_NO_BUDGET, 2500, 50000, 2000, 5000};
+    uids.resize(6);
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(Enqueue(edf, edfBudgets[i], uids[i]), true, "Packet dropped");
+    }
+    const uint32_t edfOrder[] = {2, 4, 5, 0, 1, 3};
+    served = Drain(edf);
+    NS_TEST_ASSERT_MSG_EQ(served.size(), 6, "Packets lost");
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(served[i], uids[edfOrder[i]], "Deadline " << i << " out of order");
+    }
+    edf->Dispose();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check the percentiles, mean and merges of DelayHistogram against the exact
+ * statistics of the sorted delays, and its clamping of the largest delays.
+ */
+class RomamDelayHistogramTestCase : public TestCase
+{
+  public:
+    RomamDelayHistogramTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+/// delays recorded
+static const uint32_t HISTOGRAM_DELAYS = 10000;
+/// log2 of the buckets of the first power of two of the histograms
+static const uint32_t HISTOGRAM_SUB_BUCKET_BITS = 7;
+
+RomamDelayHistogramTestCase::RomamDelayHistogramTestCase()
+    : TestCase("Delay histogram percentiles within their precision of the exact ones")
+{
+}
+
+void
+RomamDelayHistogramTestCase::DoRun()
+{
+    DelayHistogram histogram(HISTOGRAM_SUB_BUCKET_BITS, 40);
+    DelayHistogram first(HISTOGRAM_SUB_BUCKET_BITS, 40);
+    DelayHistogram second(HISTOGRAM_SUB_BUCKET_BITS, 40);
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetPercentile(50), Time(0), "Percentile of no delay");
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetMin(), Time(0), "Minimum of no delay");
+
+    // delays of every power of two up to 2^30 ns, from a fixed generator
+    std::vector<uint64_t> delays;
+    uint64_t state = 1;
+    long double sum = 0;
+    for (uint32_t i = 0; i < HISTOGRAM_DELAYS; i++)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t exponent = (state >> 58) % 31;
+        uint64_t delay = (uint64_t(1) << exponent) + ((state >> 16) & ((1ULL << exponent) - 1));
+        delays.push_back(delay);
+        sum += delay;
+        histogram.Record(NanoSeconds(delay));
+        (i % 2 == 0 ? first : second).Record(NanoSeconds(delay));
+    }
+    first.Merge(second);
+    std::sort(delays.begin(), delays.end());
+
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetCount(), HISTOGRAM_DELAYS, "Delays not counted");
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetMin(), NanoSeconds(delays.front()), "Other minimum");
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetMax(), NanoSeconds(delays.back()), "Other maximum");
+    NS_TEST_ASSERT_MSG_EQ_TOL(histogram.GetMean().GetNanoSeconds(),
+                              static_cast<int64_t>(sum / HISTOGRAM_DELAYS),
+                              1,
+                              "Mean not exact");
+    NS_TEST_ASSERT_MSG_EQ(first.GetCount(), HISTOGRAM_DELAYS, "Merged delays not counted");
+    for (double percentile : {0.0, 1.0, 25.0, 50.0, 90.0, 99.0, 99.9, 100.0})
+    {
+        uint64_t rank = std::max<uint64_t>(1, std::ceil(percentile / 100.0 * HISTOGRAM_DELAYS));
+        uint64_t exact = delays[rank - 1];
+        uint64_t value = histogram.GetPercentile(percentile).GetNanoSeconds();
+        // the largest value of the bucket of the exact delay
+        NS_TEST_ASSERT_MSG_GT_OR_EQ(value, exact, "Percentile " << percentile << " too small");
+        NS_TEST_ASSERT_MSG_LT_OR_EQ(value - exact,
+                                    exact >> (HISTOGRAM_SUB_BUCKET_BITS - 1),
+                                    "Percentile " << percentile << " beyond its precision");
+        NS_TEST_ASSERT_MSG_EQ(first.GetPercentile(percentile),
+                              histogram.GetPercentile(percentile),
+                              "Merged percentile " << percentile << " differs");
+    }
+
+    // the delays past 2^maxBits ns share the last bucket, the negative ones
+    // count as 0
+    DelayHistogram clamped(HISTOGRAM_SUB_BUCKET_BITS, 20);
+    clamped.Record(Seconds(1));
+    clamped.Record(NanoSeconds(-5));
+    NS_TEST_ASSERT_MSG_EQ(clamped.GetMax(), Seconds(1), "Largest delay clamped");
+    NS_TEST_ASSERT_MSG_EQ(clamped.GetMin(), Time(0), "Negative delay not counted as 0");
+    NS_TEST_ASSERT_MSG_EQ(clamped.GetPercentile(100),
+                          NanoSeconds((1 << 20) - 1),
+                          "Delay past the last bucket not clamped");
+    clamped.Reset();
+    NS_TEST_ASSERT_MSG_EQ(clamped.GetCount(), 0, "Delays left after a reset");
+    NS_TEST_ASSERT_MSG_EQ(clamped.GetPercentile(100), Time(0), "Percentile left after a reset");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the state machine of an OSPF neighbor takes the transitions and
+ * the actions of RFC 2328 on a point-to-point link, and runs its timer.
+ */
+class RomamNeighborFsmTestCase : public TestCase
+{
+  public:
+    RomamNeighborFsmTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RomamNeighborFsmTestCase::RomamNeighborFsmTestCase()
+    : TestCase("Neighbor state machine transitions, actions and inactivity timer")
+{
+}
+
+void
+RomamNeighborFsmTestCase::DoRun()
+{
+    /// an event at a time, and the state and action it must give
+    struct Step
+    {
+        NeighborFsm::Event event;   //!< the event
+        uint32_t ms;                //!< the time of the event, in milliseconds
+        NeighborFsm::State state;   //!< the state after the event
+        NeighborFsm::Action action; //!< the action of the transition
+        bool inactive;              //!< whether the timer expired 25 ms after the event
+    };
+
+    // the timer only runs from the first Hello, a Hello starts it again and
+    // the neighbor going down stops it; the events of the other states are
+    // ignored
+    const Step steps[] = {
+        {NeighborFsm::INACTIVITY_TIMER, 0, NeighborFsm::DOWN, NeighborFsm::NO_ACTION, false},
+        {NeighborFsm::HELLO_RECEIVED, 10, NeighborFsm::INIT, NeighborFsm::RESET_INACTIVITY, false},
+        {NeighborFsm::NEGOTIATION_DONE, 20, NeighborFsm::INIT, NeighborFsm::NO_ACTION, false},
+        {NeighborFsm::TWO_WAY_RECEIVED, 20, NeighborFsm::EXSTART, NeighborFsm::NO_ACTION, false},
+        {NeighborFsm::NEGOTIATION_DONE,
+         30,
+         NeighborFsm::EXCHANGE,
+         NeighborFsm::START_EXCHANGE,
+         true},
+        {NeighborFsm::HELLO_RECEIVED, 40, NeighborFsm::EXCHANGE, NeighborFsm::RESET_INACTIVITY,
+         false},
+        {NeighborFsm::LOADING_DONE, 40, NeighborFsm::EXCHANGE, NeighborFsm::NO_ACTION, false},
+        {NeighborFsm::EXCHANGE_DONE, 50, NeighborFsm::LOADING, NeighborFsm::NO_ACTION, false},
+        {NeighborFsm::LOADING_DONE, 60, NeighborFsm::FULL, NeighborFsm::ADJACENCY_FULL, true},
+        {NeighborFsm::ONE_WAY_RECEIVED, 70, NeighborFsm::INIT, NeighborFsm::CLEAR_ADJACENCY, true},
+        {NeighborFsm::INACTIVITY_TIMER, 80, NeighborFsm::DOWN, NeighborFsm::NEIGHBOR_DOWN, false},
+        {NeighborFsm::HELLO_RECEIVED, 90, NeighborFsm::INIT, NeighborFsm::RESET_INACTIVITY, false},
+        {NeighborFsm::TWO_WAY_RECEIVED, 90, NeighborFsm::EXSTART, NeighborFsm::NO_ACTION, false},
+        {NeighborFsm::KILL_NBR, 100, NeighborFsm::DOWN, NeighborFsm::NEIGHBOR_DOWN, false},
+        {NeighborFsm::KILL_NBR, 110, NeighborFsm::DOWN, NeighborFsm::NO_ACTION, false},
+    };
+
+    NeighborFsm fsm;
+    fsm.SetDeadInterval(MilliSeconds(40));
+    NS_TEST_ASSERT_MSG_EQ(fsm.GetState(), NeighborFsm::DOWN, "New neighbor not down");
+    for (const Step& step : steps)
+    {
+        NeighborFsm::State from = fsm.GetState();
+        NeighborFsm::Action action = fsm.Dispatch(step.event, MilliSeconds(step.ms));
+        NS_TEST_ASSERT_MSG_EQ(fsm.GetState(),
+                              step.state,
+                              "Event " << static_cast<uint32_t>(step.event) << " in " << from
+                                       << " to another state");
+        NS_TEST_ASSERT_MSG_EQ(static_cast<uint32_t>(action),
+                              static_cast<uint32_t>(step.action),
+                              "Event " << static_cast<uint32_t>(step.event) << " in " << from
+                                       << " with another action");
+        NS_TEST_ASSERT_MSG_EQ(fsm.IsInactive(MilliSeconds(step.ms + 25)),
+                              step.inactive,
+                              "Inactivity timer after event " << static_cast<uint32_t>(step.event)
+                                                              << " in " << from);
+    }
+    NS_TEST_ASSERT_MSG_EQ(std::string(NeighborFsm::GetStateName(NeighborFsm::FULL)),
+                          "Full",
+                          "Other state name");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that the topology reader parses the header, node and link lines of
+ * the Inet files, whatever their blank lines and trailing fields, and
+ * rejects the malformed ones.
+ */
+class RomamTopologyReaderTestCase : public TestCase
+{
+  public:
+    RomamTopologyReaderTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Parse a topology held in a string.
+     * \param reader the reader
+     * \param topology the content of the topology file
+     * \return the result of Parse ()
+     */
+    static bool Parse(RomamTopologyReader& reader, const std::string& topology);
+};
+
+RomamTopologyReaderTestCase::RomamTopologyReaderTestCase()
+    : TestCase("Topology reader parsing the Inet files from memory")
+{
+}
+
+bool
+RomamTopologyReaderTestCase::Parse(RomamTopologyReader& reader, const std::string& topology)
+{
+    return reader.Parse(topology.data(), topology.size());
+}
+
+void
+RomamTopologyReaderTestCase::DoRun()
+{
+    RomamTopologyReader reader;
+    // blank lines before the header and between the links, a CR LF, a field
+    // after the weight and no newline after the last link
+    NS_TEST_ASSERT_MSG_EQ(Parse(reader,
+                                "\n4 3\n0 0 0\n1 1 0\n2 0 1\n3 1 1\n0 1 5\n\n"
+                                "1 2 7 9\r\n \t\n2 3 65535"),
+                          true,
+                          "Topology not parsed");
+    NS_TEST_ASSERT_MSG_EQ(reader.GetNNodes(), 4, "Other number of nodes");
+    const uint32_t links[][3] = {{0, 1, 5}, {1, 2, 7}, {2, 3, 65535}};
+    NS_TEST_ASSERT_MSG_EQ(reader.GetLinks().size(), 3, "Other number of links");
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        const RomamTopologyReader::Link& link = reader.GetLinks()[i];
+        NS_TEST_ASSERT_MSG_EQ(link.from, links[i][0], "Other end of link " << i);
+        NS_TEST_ASSERT_MSG_EQ(link.to, links[i][1], "Other end of link " << i);
+        NS_TEST_ASSERT_MSG_EQ(link.weight, links[i][2], "Other weight of link " << i);
+    }
+
+    // fewer links than the header counts end the topology
+    NS_TEST_ASSERT_MSG_EQ(Parse(reader, "2 5\n0 0 0\n1 1 0\n0 1 1\n"), true, "Short topology");
+    NS_TEST_ASSERT_MSG_EQ(reader.GetNNodes(), 2, "Other number of nodes");
+    NS_TEST_ASSERT_MSG_EQ(reader.GetLinks().size(), 1, "Other number of links");
+
+    // a weight past 32 bits, a link to an unknown node, a malformed link and
+    // no link are rejected, and leave no topology
+    for (const char* malformed : {"2 1\n0 0 0\n1 1 0\n0 1 4294967296\n",
+                                  "2 1\n0 0 0\n1 1 0\n0 2 1\n",
+                                  "2 1\n0 0 0\n1 1 0\n0 x 1\n",
+                                  "2 0\n0 0 0\n1 1 0\n",
+                                  ""})
+    {
+        NS_TEST_ASSERT_MSG_EQ(Parse(reader, malformed),
+                              false,
+                              "Malformed topology parsed: " << malformed);
+        NS_TEST_ASSERT_MSG_EQ(reader.GetNNodes(), 0, "Nodes left by a malformed topology");
+        NS_TEST_ASSERT_MSG_EQ(reader.GetLinks().size(), 0, "Links left by a malformed topology");
+    }
+
+    // a file reads as its content parses: the last node line is not a link,
+    // and the last link has no newline
+    NS_TEST_ASSERT_MSG_EQ(reader.Read(GetTopologyPath("4point_topo.txt")), true, "File not read");
+    std::ifstream file(GetTopologyPath("4point_topo.txt"));
+    std::stringstream content;
+    content << file.rdbuf();
+    RomamTopologyReader parsed;
+    NS_TEST_ASSERT_MSG_EQ(Parse(parsed, content.str()), true, "File content not parsed");
+    NS_TEST_ASSERT_MSG_EQ(reader.GetNNodes(), 4, "Other number of nodes in the file");
+    NS_TEST_ASSERT_MSG_EQ(reader.GetLinks().size(), 4, "Other number of links in the file");
+    NS_TEST_ASSERT_MSG_EQ(parsed.GetLinks().size(), 4, "Other number of links parsed");
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(reader.GetLinks()[i].from == parsed.GetLinks()[i].from &&
+                                  reader.GetLinks()[i].to == parsed.GetLinks()[i].to &&
+                                  reader.GetLinks()[i].weight == parsed.GetLinks()[i].weight,
+                              true,
+                              "Link " << i << " of the file read otherwise");
+    }
+    NS_TEST_ASSERT_MSG_EQ(reader.GetLinks()[0].from, 0, "Node line read as a link");
+    NS_TEST_ASSERT_MSG_EQ(reader.GetLinks()[3].weight, 2, "Last link without newline lost");
+    NS_TEST_ASSERT_MSG_EQ(reader.Read(GetTopologyPath("no_such_topo.txt")),
+                          false,
+                          "Missing file read");
+}
+
+/**
+ * \ingroup romam-tests
+ * Check the moving averages of the sojourn time and of the dequeue rate of
+ * DDRQueueDisc, and the delay its Drain estimator reports before and after
+ * the rate is measured.
+ */
+class RomamDelayEstimatorTestCase : public TestCase
+{
+  public:
+    RomamDelayEstimatorTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Enqueue a delay sensitive packet of DRR_QUANTUM bytes.
+     * \param qdisc the queue disc
+     */
+    static void Enqueue(Ptr<DDRQueueDisc> qdisc);
+};
+
+/// weight of a new sample in the moving averages
+static const double ESTIMATOR_GAIN = 0.5;
+
+RomamDelayEstimatorTestCase::RomamDelayEstimatorTestCase()
+    : TestCase("Sojourn time and dequeue rate estimators of DDRQueueDisc")
+{
+}
+
+void
+RomamDelayEstimatorTestCase::Enqueue(Ptr<DDRQueueDisc> qdisc)
+{
+    Ipv4Header header;
+    header.SetProtocol(17);
+    Ptr<Packet> packet = Create<Packet>(DRR_QUANTUM - header.GetSerializedSize());
+    RomamMetaTag metaTag;
+    metaTag.SetPriority(true);
+    packet->AddPacketTag(metaTag);
+    qdisc->Enqueue(Create<Ipv4QueueDiscItem>(packet, Address(), 0x0800, header));
+}
+
+void
+RomamDelayEstimatorTestCase::DoRun()
+{
+    RomamTestScope scope;
+    Ptr<DDRQueueDisc> qdisc = CreateObject<DDRQueueDisc>();
+    qdisc->SetAttribute("DelayEstimator", StringValue("Drain"));
+    qdisc->SetAttribute("DelayEstimatorGain", DoubleValue(ESTIMATOR_GAIN));
+    qdisc->Initialize();
+    uint32_t limit = qdisc->GetInternalQueue(0)->GetMaxSize().GetValue();
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        Simulator::Schedule(MilliSeconds(i), &RomamDelayEstimatorTestCase::Enqueue, qdisc);
+    }
+    Simulator::Stop(MilliSeconds(5));
+    Simulator::Run();
+    // no dequeue measured a rate, so the delay comes from the occupancy
+    NS_TEST_ASSERT_MSG_EQ(qdisc->GetDrainRate(), 0, "Rate measured without a dequeue");
+    NS_TEST_ASSERT_MSG_EQ(qdisc->GetSojournTime(0), Time(0), "Sojourn without a dequeue");
+    NS_TEST_ASSERT_MSG_EQ(qdisc->GetQueueDelay(),
+                          4 * DRR_QUANTUM * 20000 / limit,
+                          "Drain estimate without a rate not from the occupancy");
+
+    // the first dequeue follows an idle queue, so only the second one, 2 ms
+    // later, measures the rate
+    Simulator::Schedule(MilliSeconds(5), &QueueDisc::Dequeue, qdisc);
+    Simulator::Schedule(MilliSeconds(7), &QueueDisc::Dequeue, qdisc);
+    Simulator::Stop(MilliSeconds(8));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ_TOL(qdisc->GetDrainRate(),
+                              DRR_QUANTUM / 0.002,
+                              1e-6,
+                              "Rate not the packet size over the dequeue gap");
+    // the packets queued at 0 and 1 ms waited 10 and 11 ms
+    double sojourn = ESTIMATOR_GAIN * 0.010;
+    sojourn += ESTIMATOR_GAIN * (0.011 - sojourn);
+    NS_TEST_ASSERT_MSG_EQ_TOL(qdisc->GetSojournTime(0),
+                              Seconds(sojourn),
+                              NanoSeconds(1),
+                              "Sojourn not the moving average of the gain");
+    // the two packets left take 2 ms each at the rate, in microseconds
+    NS_TEST_ASSERT_MSG_EQ_TOL(static_cast<int64_t>(qdisc->GetQueueDelay()),
+                              4000,
+                              1,
+                              "Drain estimate not the bytes over the rate");
+    qdisc->Dispose();
+}
+
+/**
+ * \ingroup romam-tests
+ * Check that RomamSink follows the SeqTsSize messages of a byte stream across
+ * the segments it receives: a header split over two segments, and two
+ * messages in one.
+ */
+class RomamSinkStreamTestCase : public TestCase
+{
+  public:
+    RomamSinkStreamTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Record a message of the stream.
+     * \param p the payload of the message
+     * \param from the address of the sender
+     * \param local the address of the sink
+     * \param header the header of the message
+     */
+    void Message(Ptr<const Packet> p,
+                 const Address& from,
+                 const Address& local,
+                 const SeqTsSizeHeader& header);
+
+    /**
+     * \brief Record the delay of a segment.
+     * \param p the segment
+     * \param from the address of the sender
+     * \param delay the delay of the segment
+     */
+    void Delay(Ptr<const Packet> p, const Address& from, Time delay);
+
+    /**
+     * \brief Send a flagged segment.
+     * \param socket the socket of the sender
+     * \param segment the segment
+     */
+    static void Send(Ptr<Socket> socket, Ptr<Packet> segment);
+
+    std::vector<uint32_t> m_seqs;    //!< the sequence numbers of the messages
+    std::vector<uint64_t> m_sizes;   //!< the sizes of the messages
+    std::vector<Time> m_delays;      //!< the delays of the segments
+    std::vector<uint32_t> m_lengths; //!< the sizes of the segments
+};
+
+RomamSinkStreamTestCase::RomamSinkStreamTestCase()
+    : TestCase("RomamSink following the SeqTsSize messages across the segments")
+{
+}
+
+void
+RomamSinkStreamTestCase::Message(Ptr<const Packet> p,
+                                 const Address& from,
+                                 const Address& local,
+                                 const SeqTsSizeHeader& header)
+{
+    m_seqs.push_back(header.GetSeq());
+    m_sizes.push_back(header.GetSize());
+    NS_TEST_EXPECT_MSG_EQ(p->GetSize() + header.GetSerializedSize(),
+                          header.GetSize(),
+                          "Payload not the message less its header");
+}
+
+void
+RomamSinkStreamTestCase::Delay(Ptr<const Packet> p, const Address& from, Time delay)
+{
+    m_delays.push_back(delay);
+    m_lengths.push_back(p->GetSize());
+}
+
+void
+RomamSinkStreamTestCase::Send(Ptr<Socket> socket, Ptr<Packet> segment)
+{
+    RomamMetaTag metaTag;
+    metaTag.SetTimestamp(Simulator::Now());
+    metaTag.SetFlag(true);
+    metaTag.SetSampled(true);
+    segment->AddPacketTag(metaTag);
+    socket->Send(segment);
+}
+
+void
+RomamSinkStreamTestCase::DoRun()
+{
+    RomamTestScope scope;
+    NodeContainer nodes;
+    nodes.Create(2);
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("1Gbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("1ms"));
+    NetDeviceContainer devices = p2p.Install(nodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ipv4AddressHelper addresses("10.0.0.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = addresses.Assign(devices);
+
+    Ptr<RomamSink> sink = CreateObject<RomamSink>();
+    sink->SetAttribute("Local", AddressValue(InetSocketAddress(Ipv4Address::GetAny(), 9)));
+    sink->SetAttribute("Protocol", TypeIdValue(UdpSocketFactory::GetTypeId()));
+    sink->SetAttribute("EnableSeqTsSizeHeader", BooleanValue(true));
+    sink->SetAttribute("DelayLogFormat", StringValue("None"));
+    sink->TraceConnectWithoutContext("RxWithSeqTsSize",
+                                     MakeCallback(&RomamSinkStreamTestCase::Message, this));
+    sink->TraceConnectWithoutContext("Delay", MakeCallback(&RomamSinkStreamTestCase::Delay, this));
+    nodes.Get(1)->AddApplication(sink);
+
+    // the datagrams reach the sink as they are sent, so they stand for the
+    // segments of a stream whose boundaries the test chooses
+    Ptr<Socket> socket = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+    socket->Bind();
+    socket->Connect(InetSocketAddress(interfaces.GetAddress(1), 9));
+    std::vector<Ptr<Packet>> messages;
+    const uint32_t sizes[] = {120, 60, 40};
+    for (uint32_t seq = 0; seq < 3; seq++)
+    {
+        SeqTsSizeHeader header;
+        header.SetSeq(seq);
+        header.SetSize(sizes[seq]);
+        Ptr<Packet> message = Create<Packet>(sizes[seq] - header.GetSerializedSize());
+        message->AddHeader(header);
+        messages.push_back(message);
+    }
+    // the header of the first message over two segments, the last two
+    // messages in one
+    std::vector<Ptr<Packet>> segments = {messages[0]->CreateFragment(0, 7),
+                                         messages[0]->CreateFragment(7, sizes[0] - 7),
+                                         messages[1]->Copy()};
+    segments[2]->AddAtEnd(messages[2]);
+    for (uint32_t i = 0; i < segments.size(); i++)
+    {
+        Simulator::Schedule(MilliSeconds(10 * (i + 1)),
+                            &RomamSinkStreamTestCase::Send,
+                            socket,
+                            segments[i]);
+    }
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_seqs.size(), 3, "Other number of messages");
+    for (uint32_t seq = 0; seq < 3; seq++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_seqs[seq], seq, "Message " << seq << " out of order");
+        NS_TEST_ASSERT_MSG_EQ(m_sizes[seq], sizes[seq], "Other size of message " << seq);
+    }
+    NS_TEST_ASSERT_MSG_EQ(m_delays.size(), segments.size(), "Delay of a segment not traced");
+    DataRate rate("1Gbps");
+    for (uint32_t i = 0; i < segments.size(); i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_lengths[i], segments[i]->GetSize(), "Other segment traced");
+        // the segment with its UDP, IPv4 and PPP headers over an idle link
+        Time delay = MilliSeconds(1) + rate.CalculateBytesTxTime(segments[i]->GetSize() + 30);
+        NS_TEST_ASSERT_MSG_EQ(m_delays[i], delay, "Other delay of segment " << i);
+    }
+}
+
+/**
+ * \ingroup romam-tests
+ * Guard the route computation time and the routing state bytes on the
+ * 10 by 10 grid, with thresholds scaled by GetPerformanceScale ().
+ */
+class RomamPerformanceTestCase : public TestCase
+{
+  public:
+    /**
+     * \param engine dijkstra or spf
+     */
+    RomamPerformanceTestCase(const std::string& engine);
+
+  private:
+    void DoRun() override;
+
+    std::string m_engine; //!< the route engine
+};
+
+/// seconds the route computation of the grid may take
+static const double MAX_COMPUTATION_SECONDS = 2.0;
+
+/// bytes of routing state a route installed may take, with its share of the tables
+static const double MAX_BYTES_PER_ROUTE = 1024;
+
+/// bytes of LSDB a link may take
+static const double MAX_LSDB_BYTES_PER_LINK = 4096;
+
+RomamPerformanceTestCase::RomamPerformanceTestCase(const std::string& engine)
+    : TestCase("Computation time and routing state of " + engine + " on the 10 by 10 grid"),
+      m_engine(engine)
+{
+}
+
+void
+RomamPerformanceTestCase::DoRun()
+{
+    std::string topo("Inet_10by10_topo.txt");
+    NodeContainer nodes = m_engine == "dijkstra" ? BuildNetwork(topo, OSPFHelper(), false)
+                                                 : BuildNetwork(topo, DDRHelper(), true);
+    RouteManager::DeleteRoutes();
+    auto start = std::chrono::steady_clock::now();
+    RouteManager::BuildLSDB();
+    if (m_engine == "dijkstra")
+    {
+        RouteManager::InitializeDijkstraRoutes();
+    }
+    else
+    {
+        RouteManager::InitializeSPFRoutes();
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double scale = GetPerformanceScale();
+    uint64_t routes = 0;
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        routes += GetRouting(nodes.Get(n))->GetNRoutes();
+    }
+    double routingBytes = RouteManager::GetRoutingMemoryFootprint();
+    double lsdbBytes = RouteManager::GetLSDBMemoryFootprint();
+    uint32_t nLinks = 180;
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_GT(routes, 0, "No route installed");
+    NS_TEST_ASSERT_MSG_LT_OR_EQ(seconds,
+                                MAX_COMPUTATION_SECONDS * scale,
+                                "The routes took " << seconds << " s to compute");
+    NS_TEST_ASSERT_MSG_LT_OR_EQ(routingBytes / routes,
+                                MAX_BYTES_PER_ROUTE * scale,
+                                "The routing state takes " << routingBytes << " bytes for "
+                                                           << routes << " routes");
+    NS_TEST_ASSERT_MSG_LT_OR_EQ(lsdbBytes / nLinks,
+                                MAX_LSDB_BYTES_PER_LINK * scale,
+                                "The LSDB takes " << lsdbBytes << " bytes");
+}
+
 // This is an example TestCase.
 /**
  * \ingroup romam-tests
@@ -76,6 +3510,58 @@ RomamTestSuite::RomamTestSuite()
 {
     // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
     AddTestCase(new RomamTestCase1, TestCase::QUICK);
+    for (const char* topo : {"Inet_3by3_topo_5.txt",
+                             "Inet_4by4_topo.txt",
+                             "Inet_abilene_topo.txt",
+                             "Inet_att_topo.txt",
+                             "Inet_cernet_topo.txt",
+                             "Inet_geant_topo.txt"})
+    {
+        AddTestCase(new RomamSpfDijkstraTestCase(topo), TestCase::QUICK);
+    }
+    for (const char* mode : {"DGR", "DDR"})
+    {
+        AddTestCase(new RomamDdrDecisionTestCase("Inet_abilene_topo.txt", mode), TestCase::QUICK);
+        AddTestCase(new RomamDdrDecisionTestCase("Inet_geant_topo.txt", mode), TestCase::QUICK);
+    }
+    AddTestCase(new RomamDdrDecisionTestCase("Inet_abilene_topo.txt", "DGR", true),
+                TestCase::QUICK);
+    AddTestCase(new RomamControlBurstTestCase, TestCase::QUICK);
+    AddTestCase(new RomamFastRerouteTestCase, TestCase::QUICK);
+    AddTestCase(new RomamRouteConsistencyTestCase, TestCase::QUICK);
+    AddTestCase(new RomamSharedRouteTreesTestCase, TestCase::QUICK);
+    AddTestCase(new RomamAreasTestCase, TestCase::QUICK);
+    AddTestCase(new RomamLazyRoutesTestCase, TestCase::QUICK);
+    AddTestCase(new RomamColumnRoutesTestCase, TestCase::QUICK);
+    AddTestCase(new RomamSplitTableTestCase, TestCase::QUICK);
+    AddTestCase(new RomamArmPruningTestCase, TestCase::QUICK);
+    AddTestCase(new RomamFluidLoadTestCase, TestCase::QUICK);
+    AddTestCase(new RomamAgentChannelTestCase, TestCase::QUICK);
+    AddTestCase(new RomamPolicyTableTestCase, TestCase::QUICK);
+    AddTestCase(new RomamLsuDecodingTestCase, TestCase::QUICK);
+    AddTestCase(new RomamControlChannelTestCase, TestCase::QUICK);
+    AddTestCase(new RomamSoleRoutingTestCase, TestCase::QUICK);
+    AddTestCase(new RomamOutputRouteCacheTestCase, TestCase::QUICK);
+    AddTestCase(new RomamRouteGenerationTestCase, TestCase::QUICK);
+    AddTestCase(new RomamParallelDiscoveryTestCase, TestCase::QUICK);
+    AddTestCase(new RomamCandidateCapTestCase, TestCase::QUICK);
+    AddTestCase(new RomamRouteTrieTestCase, TestCase::QUICK);
+    AddTestCase(new RomamCandidateQueueTestCase, TestCase::QUICK);
+    AddTestCase(new RomamTimerWheelTestCase, TestCase::QUICK);
+    AddTestCase(new RomamFloodingTestCase, TestCase::QUICK);
+    AddTestCase(new RomamKShortestPathsTestCase, TestCase::QUICK);
+    AddTestCase(new RomamDistanceMatrixTestCase, TestCase::QUICK);
+    AddTestCase(new RomamLSDBFileTestCase, TestCase::QUICK);
+    AddTestCase(new RomamCompactStatusTestCase, TestCase::QUICK);
+    AddTestCase(new RomamDrrQueueDiscTestCase, TestCase::QUICK);
+    AddTestCase(new RomamDeadlineQueueDiscTestCase, TestCase::QUICK);
+    AddTestCase(new RomamDelayHistogramTestCase, TestCase::QUICK);
+    AddTestCase(new RomamNeighborFsmTestCase, TestCase::QUICK);
+    AddTestCase(new RomamTopologyReaderTestCase, TestCase::QUICK);
+    AddTestCase(new RomamDelayEstimatorTestCase, TestCase::QUICK);
+    AddTestCase(new RomamSinkStreamTestCase, TestCase::QUICK);
+    AddTestCase(new RomamPerformanceTestCase("dijkstra"), TestCase::EXTENSIVE);
+    AddTestCase(new RomamPerformanceTestCase("spf"), TestCase::EXTENSIVE);
 }
 
 // Do not forget to allocate an instance of this TestSuite